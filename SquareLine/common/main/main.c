@@ -12,6 +12,11 @@
 
 #define TAG "ESP-EXAMPLE"
 
+#if UI_ASSETS_PRELOAD
+/* Generated by ui_assets.py */
+void ui_assets_preload(void);
+#endif
+
 /*******************************************************************************
 * Private functions
 *******************************************************************************/
@@ -30,6 +35,11 @@ void app_main(void)
 {{
     {__ESP_BOARD_I2C_INIT__}
 
+#if UI_ASSETS_PRELOAD
+    /* Copy images placed in PSRAM or RAM (ui_assets.json) */
+    ui_assets_preload();
+#endif
+
     /* Initialize display and LVGL */
     bsp_display_start();
 
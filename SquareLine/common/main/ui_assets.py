@@ -0,0 +1,293 @@
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+"""
+Re-encode images exported by SquareLine (C arrays, LVGL9) and select their placement.
+
+Placement of each asset:
+  flash  - raw pixels stay in flash, they are read through the flash cache on every draw
+  psram  - raw pixels are copied from flash into PSRAM by ui_assets_preload() at boot
+  sram   - raw pixels are copied from flash into internal RAM by ui_assets_preload() at boot
+  cache  - compressed (RLE/LZ4) or indexed data stay in flash, LVGL decodes them on the first use
+           into its image cache in RAM (CONFIG_LV_CACHE_DEF_SIZE), used only for images fitting into the cache
+
+All images are written into one C file with ui_assets_preload(). Decisions are printed and written
+into a report, they can be overridden per asset in ui_assets.json.
+"""
+import argparse
+import glob
+import json
+import os
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+
+# LVGL9 color formats (lv_color_format_t)
+CF_RGB565 = 0x12
+CF_RGB565A8 = 0x14
+CF_ARGB8888 = 0x10
+CF_I4 = 0x09
+CF_I8 = 0x0A
+# Color format names of LVGLImage.py
+CF_NAMES = {CF_RGB565: "RGB565", CF_RGB565A8: "RGB565A8", CF_ARGB8888: "ARGB8888", CF_I4: "I4", CF_I8: "I8"}
+# Color formats in SquareLine export
+CF_EXPORT = {
+    "LV_COLOR_FORMAT_NATIVE": CF_RGB565,
+    "LV_COLOR_FORMAT_RGB565": CF_RGB565,
+    "LV_COLOR_FORMAT_NATIVE_WITH_ALPHA": CF_RGB565A8,
+    "LV_COLOR_FORMAT_RGB565A8": CF_RGB565A8,
+    "LV_COLOR_FORMAT_ARGB8888": CF_ARGB8888,
+}
+# lv_image_header_t: magic, cf, flags, w, h, stride, reserved
+IMAGE_HEADER = struct.Struct("<BBHHHHH")
+
+DEFAULT_CONFIG = {
+    "psram_min_size": 32768,    # Raw images from this size are preloaded into PSRAM (when it is available)
+    "compress_min_size": 8192,  # Images from this size are compressed, when it saves at least the half
+    "assets": {},               # Per asset overrides: {"ui_img_name_png": {"placement": "...", "format": "...", "compress": "..."}}
+}
+
+
+class Image:
+    def __init__(self, name, cf, w, h, data, source):
+        self.name = name
+        self.cf = cf
+        self.w = w
+        self.h = h
+        self.data = data
+        self.source = source
+
+    def pixels_rgba(self):
+        """ Rows of RGBA pixels for PNG """
+        rows = []
+        n = self.w * self.h
+        for y in range(self.h):
+            row = []
+            for x in range(self.w):
+                i = y * self.w + x
+                if self.cf == CF_ARGB8888:
+                    b, g, r, a = self.data[i * 4:i * 4 + 4]
+                else:
+                    c = self.data[i * 2] | (self.data[i * 2 + 1] << 8)
+                    r = ((c >> 11) & 0x1F) * 255 // 31
+                    g = ((c >> 5) & 0x3F) * 255 // 63
+                    b = (c & 0x1F) * 255 // 31
+                    a = self.data[n * 2 + i] if self.cf == CF_RGB565A8 else 255
+                row += [r, g, b, a]
+            rows.append(row)
+        return rows
+
+    def opaque(self):
+        if self.cf == CF_RGB565:
+            return True
+        if self.cf == CF_RGB565A8:
+            return all(a == 255 for a in self.data[self.w * self.h * 2:])
+        return all(a == 255 for a in self.data[3::4])
+
+    def color_count(self, limit):
+        """ Count of unique colors (stops counting above the limit) """
+        bpp = 4 if self.cf == CF_ARGB8888 else 2
+        colors = set()
+        for i in range(self.w * self.h):
+            colors.add(bytes(self.data[i * bpp:i * bpp + bpp]))
+            if len(colors) > limit:
+                break
+        return len(colors)
+
+
+def parse_export(path):
+    """ Parse image C file exported by SquareLine, None when the format is not known """
+    with open(path, "r") as f:
+        text = f.read()
+    arrays = {m.group(1): m.group(2) for m in re.finditer(r"uint8_t\s+(\w+)\s*\[\s*\]\s*=\s*\{([^}]*)\}", text)}
+    dsc = re.search(r"lv_image_dsc_t\s+(\w+)\s*=\s*\{(.*?)\};", text, re.S)
+    if not dsc:
+        return None
+    fields = dict(re.findall(r"\.(?:header\.)?(\w+)\s*=\s*([\w()]+)", dsc.group(2)))
+    cf = CF_EXPORT.get(fields.get("cf"))
+    array = re.match(r"\w+", fields.get("data", ""))
+    if cf is None or not array or array.group(0) not in arrays:
+        return None
+    data = bytes(int(v, 0) for v in re.findall(r"0x[0-9a-fA-F]+|\d+", arrays[array.group(0)]))
+    w, h = int(fields["w"]), int(fields["h"])
+    expected = w * h * {CF_RGB565: 2, CF_RGB565A8: 3, CF_ARGB8888: 4}[cf]
+    if len(data) != expected:
+        return None
+    return Image(dsc.group(1), cf, w, h, data, path)
+
+
+def lvglimage_encode(lvglimage, image, cf, compress, tmp):
+    """ Encode image by LVGL converter, returns (header, data) of the LVGL binary image """
+    import png
+    png_path = os.path.join(tmp, image.name + ".png")
+    rows = image.pixels_rgba()
+    with open(png_path, "wb") as f:
+        if cf in (CF_I4, CF_I8):
+            # Indexed formats are converted from palette PNG
+            palette = []
+            index = {}
+            indexed = []
+            for row in rows:
+                out = []
+                for i in range(0, len(row), 4):
+                    color = tuple(row[i:i + 4])
+                    if color not in index:
+                        index[color] = len(palette)
+                        palette.append(color)
+                    out.append(index[color])
+                indexed.append(out)
+            png.Writer(image.w, image.h, palette=palette, bitdepth=4 if cf == CF_I4 else 8).write(f, indexed)
+        else:
+            png.Writer(image.w, image.h, alpha=True, greyscale=False).write(f, rows)
+    subprocess.run([sys.executable, lvglimage, "--ofmt", "BIN", "--cf", CF_NAMES[cf], "--compress", compress, "-o", tmp, png_path],
+                   check=True, stdout=subprocess.DEVNULL)
+    with open(os.path.join(tmp, image.name + ".bin"), "rb") as f:
+        binary = f.read()
+    return IMAGE_HEADER.unpack(binary[:IMAGE_HEADER.size]), binary[IMAGE_HEADER.size:]
+
+
+def decide(image, config, psram, cache_size, lvglimage, tmp):
+    """ Select format, compression and placement, returns (placement, header, data) """
+    raw_size = len(image.data)
+    override = config["assets"].get(image.name, {})
+    # Without the image cache, decoding would be repeated on every draw
+    encode = raw_size >= config["compress_min_size"] and raw_size <= cache_size
+    cf = image.cf
+    if "format" in override:
+        cf = {v: k for k, v in CF_NAMES.items()}[override["format"]]
+    elif encode and image.opaque():
+        # Indexed colors for images with few colors (icons, flat graphics)
+        colors = image.color_count(256)
+        if colors <= 16:
+            cf = CF_I4
+        elif colors <= 256:
+            cf = CF_I8
+    compress = override.get("compress", "NONE")
+    if "compress" not in override and cf == image.cf and encode:
+        header, data = lvglimage_encode(lvglimage, image, cf, "RLE", tmp)
+        if len(data) * 2 <= raw_size:
+            compress = "RLE"
+    header, data = lvglimage_encode(lvglimage, image, cf, compress, tmp)
+
+    placement = override.get("placement")
+    if placement is None:
+        if cf != image.cf or compress != "NONE":
+            placement = "cache"
+        elif psram and raw_size >= config["psram_min_size"]:
+            placement = "psram"
+        else:
+            placement = "flash"
+    if placement == "psram" and not psram:
+        placement = "flash"
+    if placement in ("psram", "sram") and (cf != image.cf or compress != "NONE"):
+        # LVGL decodes compressed and indexed images into its cache anyway
+        placement = "cache"
+    return placement, header, data
+
+
+def c_bytes(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join(f"0x{b:02x}" for b in data[i:i + 16]) + ",")
+    return "\n".join(lines)
+
+
+def write_c(path, entries):
+    out = [
+        "/* Generated by ui_assets.py from images exported by SquareLine, do not edit */",
+        "",
+        "#include <string.h>",
+        "#include \"esp_attr.h\"",
+        "#include \"lvgl.h\"",
+        "",
+        "#ifndef LV_ATTRIBUTE_MEM_ALIGN",
+        "#define LV_ATTRIBUTE_MEM_ALIGN",
+        "#endif",
+        "",
+    ]
+    preload = []
+    for image, placement, header, data in entries:
+        magic, cf, flags, w, h, stride, _ = header
+        out.append(f"/* {os.path.basename(image.source)}: {w}x{h}, {placement} */")
+        if placement in ("psram", "sram"):
+            attr = "EXT_RAM_BSS_ATTR " if placement == "psram" else ""
+            out.append(f"static const uint8_t {image.name}_flash[] = {{")
+            out.append(c_bytes(data))
+            out.append("};")
+            out.append(f"{attr}static LV_ATTRIBUTE_MEM_ALIGN uint8_t {image.name}_data[sizeof({image.name}_flash)];")
+            preload.append(image.name)
+        else:
+            out.append(f"static const LV_ATTRIBUTE_MEM_ALIGN uint8_t {image.name}_data[] = {{")
+            out.append(c_bytes(data))
+            out.append("};")
+        out += [
+            f"const lv_image_dsc_t {image.name} = {{",
+            "    .header.magic = LV_IMAGE_HEADER_MAGIC,",
+            f"    .header.cf = {cf},",
+            f"    .header.flags = {flags},",
+            f"    .header.w = {w},",
+            f"    .header.h = {h},",
+            f"    .header.stride = {stride},",
+            f"    .data_size = {len(data)},",
+            f"    .data = {image.name}_data,",
+            "};",
+            "",
+        ]
+    out.append("void ui_assets_preload(void)")
+    out.append("{")
+    for name in preload:
+        out.append(f"    memcpy({name}_data, {name}_flash, sizeof({name}_flash));")
+    out.append("}")
+    with open(path, "w") as f:
+        f.write("\n".join(out) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Re-encodes SquareLine images and selects their placement.")
+    parser.add_argument("--images", required=True, help="Directory with images exported by SquareLine")
+    parser.add_argument("--config", help="Placement configuration (ui_assets.json)")
+    parser.add_argument("--lvglimage", required=True, help="Path to LVGLImage.py of LVGL")
+    parser.add_argument("--psram", action="store_true", help="PSRAM is available for static data (EXT_RAM_BSS_ATTR)")
+    parser.add_argument("--cache-size", type=int, default=0, help="Size of LVGL image cache (CONFIG_LV_CACHE_DEF_SIZE)")
+    parser.add_argument("-o", "--output", required=True, help="Output C file")
+    parser.add_argument("--report", help="Output report of the decisions")
+    args = parser.parse_args()
+
+    config = dict(DEFAULT_CONFIG)
+    if args.config and os.path.exists(args.config):
+        with open(args.config, "r") as f:
+            config.update(json.load(f))
+
+    entries = []
+    skipped = []
+    with tempfile.TemporaryDirectory() as tmp:
+        for path in sorted(glob.glob(os.path.join(args.images, "*.c"))):
+            image = parse_export(path)
+            if image is None:
+                skipped.append(path)
+                continue
+            placement, header, data = decide(image, config, args.psram, args.cache_size, args.lvglimage, tmp)
+            entries.append((image, placement, header, data))
+
+    write_c(args.output, entries)
+
+    report = ["%-32s %-9s %-8s %-6s %-6s %8s %8s" % ("asset", "size", "format", "comp", "place", "raw", "stored")]
+    for image, placement, header, data in entries:
+        flags = header[2]
+        report.append("%-32s %-9s %-8s %-6s %-6s %8d %8d" % (
+            image.name, f"{image.w}x{image.h}", CF_NAMES.get(header[1], str(header[1])),
+            "yes" if flags & 0x08 else "no", placement, len(image.data), len(data)))
+    for path in skipped:
+        report.append(f"{os.path.basename(path)}: unknown format, compiled as exported")
+    print("\n".join(report))
+    if args.report:
+        with open(args.report, "w") as f:
+            f.write("\n".join(report) + "\n")
+    # Files, which must be compiled as exported
+    with open(args.output + ".skipped", "w") as f:
+        f.write(";".join(skipped))
+
+
+if __name__ == "__main__":
+    main()
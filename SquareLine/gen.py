@@ -18,6 +18,8 @@ BOARD_GENFILE = "manifest.json"
 COMPONENTS_SPECIFIC_FILES = "components"
 # Files, which are specific for each board. Will be copied from boards/BOARD/ directory
 BOARD_SPECIFIC_FILES = {"sdkconfig.defaults", "main/idf_component.yml", "partitions.csv"}
+# Common files copied without placeholder replacement (Python code with braces)
+NO_TRANSLATE_FILES = {"ui_assets.py"}
 # Generated output directory
 OUT_DIR = "espressif"
 # SquareLine output directory
@@ -49,6 +51,19 @@ SLB_FILE = {
     "long_description": ""
 }
 
+# Optional JSON object in manifest with performance preset of the board, it is merged into sdkconfig.defaults
+PERFORMANCE_KEY = "performance"
+# Header of the generated part of sdkconfig.defaults
+PERFORMANCE_HEADER = "## Performance preset (generated from manifest.json) ##"
+# Optional JSON object in manifest with image placement settings, it is written into main/ui_assets.json (LVGL9 only)
+ASSETS_KEY = "assets"
+ASSETS_FILE = "main/ui_assets.json"
+ASSETS_DEFAULTS = {
+    "psram_min_size": 32768,
+    "compress_min_size": 8192,
+    "assets": {}
+}
+
 # ANSI terminal codes
 ANSI_RED = '\033[1;31m'
 ANSI_YELLOW = '\033[0;33m'
@@ -118,7 +133,7 @@ def copy_directory(from_dir, to_dir, placeholders, translate=1):
         if os.path.isdir(f):
             copy_directory(f, out_f, placeholders, translate)
         else:
-            copy_file(f, out_f, placeholders, translate)
+            copy_file(f, out_f, placeholders, translate and filename not in NO_TRANSLATE_FILES)
 
 
 # Add folder into ZIP archive recursively
@@ -191,6 +206,117 @@ def create_slb_file(output, output_filename, manifest):
     print(f"  File {output_filename}.slb created.")
 
 
+# Get major version of LVGL supported by the board
+def get_lvgl_major(manifest):
+    check_json_key(manifest, "supported_lvgl_version")
+    return int(manifest["supported_lvgl_version"].strip()[0])
+
+
+# Translate performance preset from manifest into sdkconfig options (ordered dict: option -> value)
+def get_performance_options(preset, lvgl_major):
+    options = {}
+    for key, value in preset.items():
+        if key == "compiler_optimization":
+            # perf, size, debug or none
+            options["CONFIG_COMPILER_OPTIMIZATION_" + value.upper()] = True
+        elif key == "cpu_freq_mhz":
+            options[f"CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ_{value}"] = True
+        elif key == "flash_qio":
+            options["CONFIG_ESPTOOLPY_FLASHMODE_QIO"] = value
+        elif key == "freertos_hz":
+            options["CONFIG_FREERTOS_HZ"] = value
+        elif key == "main_task_cpu1":
+            options["CONFIG_ESP_MAIN_TASK_AFFINITY_CPU1"] = value
+        elif key == "draw_buf_height":
+            # Only BSPs with this option in Kconfig
+            options["CONFIG_BSP_LCD_DRAW_BUF_HEIGHT"] = value
+        elif key == "draw_buf_double":
+            options["CONFIG_BSP_LCD_DRAW_BUF_DOUBLE"] = value
+        elif key == "lvgl_fast_mem_iram":
+            # Hot LVGL functions (LV_ATTRIBUTE_FAST_MEM) in IRAM
+            options["CONFIG_LV_ATTRIBUTE_FAST_MEM_USE_IRAM"] = value
+        elif key == "lvgl_std_mem":
+            # malloc, memcpy and memset from esp-idf instead of LVGL pool and loops
+            if lvgl_major >= 9:
+                options["CONFIG_LV_USE_CLIB_MALLOC"] = value
+                options["CONFIG_LV_USE_CLIB_STRING"] = value
+                options["CONFIG_LV_USE_CLIB_SPRINTF"] = value
+            else:
+                options["CONFIG_LV_MEM_CUSTOM"] = value
+                options["CONFIG_LV_MEMCPY_MEMSET_STD"] = value
+        elif key == "lvgl_refr_period_ms":
+            options["CONFIG_LV_DEF_REFR_PERIOD" if lvgl_major >= 9 else "CONFIG_LV_DISP_DEF_REFR_PERIOD"] = value
+        elif key == "lvgl_draw_units":
+            # Parallel rendering, LVGL9 only
+            if lvgl_major >= 9 and value > 1:
+                options["CONFIG_LV_OS_FREERTOS"] = True
+                options["CONFIG_LV_DRAW_SW_DRAW_UNIT_CNT"] = value
+                options["CONFIG_LV_DRAW_THREAD_STACK_SIZE"] = 8192
+        elif key == "lvgl_image_cache_size":
+            # Decoded (compressed or indexed) images, LVGL9 only
+            if lvgl_major >= 9:
+                options["CONFIG_LV_CACHE_DEF_SIZE"] = value
+        elif key == "lvgl_perf_monitor":
+            options["CONFIG_LV_USE_PERF_MONITOR"] = value
+            if lvgl_major >= 9:
+                options["CONFIG_LV_USE_SYSMON"] = value
+                options["CONFIG_LV_USE_OBSERVER"] = value
+        elif key == "sdkconfig":
+            # Other options (render mode, PSRAM, draw backends...) are used as they are
+            options.update(value)
+        else:
+            print_error(f"Unknown key {key} in {PERFORMANCE_KEY} of manifest JSON file")
+            raise SystemExit(1)
+    return options
+
+
+# Format one sdkconfig line
+def sdkconfig_line(option, value):
+    if value is True:
+        return f"{option}=y"
+    if value is False:
+        return f"# {option} is not set"
+    return f"{option}={value}"
+
+
+# Get name of the option in sdkconfig line (None for other lines)
+def sdkconfig_option(line):
+    line = line.strip()
+    if line.startswith("CONFIG_"):
+        return line.split("=", 1)[0]
+    if line.startswith("# CONFIG_") and line.endswith(" is not set"):
+        return line[2:-len(" is not set")]
+    return None
+
+
+# Merge performance options into sdkconfig.defaults, options of the preset replace the same options in the file
+def apply_performance_preset(file, options):
+    lines = []
+    if os.path.exists(file):
+        with open(file, "r") as f:
+            lines = [line.rstrip("\n") for line in f if sdkconfig_option(line) not in options]
+        while lines and not lines[-1].strip():
+            lines.pop()
+        lines.append("")
+    lines.append(PERFORMANCE_HEADER)
+    lines += [sdkconfig_line(option, value) for option, value in options.items()]
+    with open(file, "w") as f:
+        f.write("\n".join(lines) + "\n")
+    print(f"  {len(options)} performance options written into {file}")
+
+
+# Write image placement settings for ui_assets.py
+def write_assets_config(file, assets):
+    config = dict(ASSETS_DEFAULTS)
+    for key, value in assets.items():
+        if key not in ASSETS_DEFAULTS:
+            print_error(f"Unknown key {key} in {ASSETS_KEY} of manifest JSON file")
+            raise SystemExit(1)
+        config[key] = value
+    with open(file, "w") as f:
+        f.write(json.dumps(config, indent=4) + "\n")
+
+
 # Process of the board generating
 def process_board(board_name, output, dir):
     print(f"Processing board: {dir}")
@@ -217,6 +343,12 @@ def process_board(board_name, output, dir):
             board_specific_file = os.path.join(dir, file)
             if os.path.exists(board_specific_file):
                 copy_file(board_specific_file, os.path.join(squareline_dir_path, file), placeholders)
+        # Board tuned performance settings
+        if PERFORMANCE_KEY in manifest:
+            options = get_performance_options(manifest[PERFORMANCE_KEY], get_lvgl_major(manifest))
+            apply_performance_preset(os.path.join(squareline_dir_path, "sdkconfig.defaults"), options)
+        # Image placement settings
+        write_assets_config(os.path.join(squareline_dir_path, ASSETS_FILE), manifest.get(ASSETS_KEY, {}))
         # Copy components, if exists
         components_dir_path = os.path.join(dir, COMPONENTS_SPECIFIC_FILES)
         if os.path.exists(components_dir_path):
@@ -4,6 +4,13 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <sys/param.h>
 #include "driver/gpio.h"
 #include "driver/ledc.h"
 #include "driver/spi_master.h"
@@ -15,6 +22,14 @@
 #include "esp_lcd_panel_vendor.h"
 #include "esp_lcd_panel_ops.h"
 #include "esp_vfs_fat.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "sdmmc_cmd.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_pm.h"
+#include "esp_attr.h"
 
 #include "iot_button.h"
 #include "bsp/esp-box-3.h"
@@ -57,6 +72,12 @@ static lv_display_t *disp;
 static lv_indev_t *disp_indev = NULL;
 static esp_lcd_touch_handle_t tp;   // LCD touch handle
 static esp_lcd_panel_handle_t panel_handle = NULL;
+static SemaphoreHandle_t disp_init_done = NULL;   // Given after asynchronous panel initialization
+static StaticSemaphore_t disp_init_done_buf;
+static volatile esp_err_t disp_init_ret = ESP_OK;
+static bool disp_init_pending = false;
+static bool disp_sleeping = false;      // LVGL refreshing stopped by bsp_display_enter_sleep()
+static uint32_t disp_resume_us = 0;     // Duration of the last bsp_display_exit_sleep()
 
 sdmmc_card_t *bsp_sdcard = NULL;    // Global SD card handler
 static bool i2c_initialized = false;
@@ -130,6 +151,50 @@ static esp_err_t bsp_i2c_device_probe(uint8_t addr)
     return ret;
 }
 
+#if CONFIG_BSP_TOUCH_DETECT_CACHE
+/* Address of the detected touch controller in bits 7:0, kept over software resets and deep sleep */
+#define BSP_TOUCH_DETECT_MAGIC  (0xB0C53000)
+static RTC_NOINIT_ATTR uint32_t touch_detect_cache;
+#endif
+
+/* The touch controller identifies the board revision: GT911 on ESP-BOX-3 (ILI9341), TT21100 on ESP-BOX (ST7789) */
+static esp_err_t bsp_touch_detect(uint8_t *addr)
+{
+    static const uint8_t touch_addrs[] = {
+        ESP_LCD_TOUCH_IO_I2C_GT911_ADDRESS,
+        ESP_LCD_TOUCH_IO_I2C_GT911_ADDRESS_BACKUP,
+        ESP_LCD_TOUCH_IO_I2C_TT21100_ADDRESS,
+    };
+
+#if CONFIG_BSP_TOUCH_DETECT_CACHE
+    /* Only the cached address is verified, the absent controllers are not probed on each boot */
+    if ((touch_detect_cache & 0xFFFFFF00) == BSP_TOUCH_DETECT_MAGIC) {
+        const uint8_t cached = touch_detect_cache & 0xFF;
+        for (int i = 0; i < sizeof(touch_addrs) / sizeof(touch_addrs[0]); i++) {
+            if (touch_addrs[i] == cached && bsp_i2c_device_probe(cached) == ESP_OK) {
+                *addr = cached;
+                return ESP_OK;
+            }
+        }
+        ESP_LOGW(TAG, "Cached touch controller 0x%02x not found, scanning", cached);
+    }
+#endif
+
+    for (int i = 0; i < sizeof(touch_addrs) / sizeof(touch_addrs[0]); i++) {
+        if (bsp_i2c_device_probe(touch_addrs[i]) == ESP_OK) {
+            *addr = touch_addrs[i];
+#if CONFIG_BSP_TOUCH_DETECT_CACHE
+            touch_detect_cache = BSP_TOUCH_DETECT_MAGIC | touch_addrs[i];
+#endif
+            return ESP_OK;
+        }
+    }
+#if CONFIG_BSP_TOUCH_DETECT_CACHE
+    touch_detect_cache = 0;
+#endif
+    return ESP_ERR_NOT_FOUND;
+}
+
 esp_err_t bsp_spiffs_mount(void)
 {
     esp_vfs_spiffs_conf_t conf = {
@@ -163,8 +228,41 @@ esp_err_t bsp_spiffs_unmount(void)
     return esp_vfs_spiffs_unregister(CONFIG_BSP_SPIFFS_PARTITION_LABEL);
 }
 
-esp_err_t bsp_sdcard_mount(void)
+/* Cluster size recommended by SD Association for FAT, by card capacity */
+static size_t bsp_sdcard_allocation_unit(uint64_t capacity)
+{
+    if (capacity <= 64ULL * 1024 * 1024) {
+        return 16 * 1024;
+    } else if (capacity <= 32ULL * 1024 * 1024 * 1024) {
+        return 32 * 1024;
+    }
+    return 64 * 1024;
+}
+
+/* Initialize the card to read its capacity, the host is released again for mounting */
+static esp_err_t bsp_sdcard_probe_capacity(const sdmmc_host_t *host, const sdmmc_slot_config_t *slot_config, uint64_t *capacity)
 {
+    sdmmc_card_t card;
+    esp_err_t ret = sdmmc_host_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = sdmmc_host_init_slot(host->slot, slot_config);
+    if (ret == ESP_OK) {
+        ret = sdmmc_card_init(host, &card);
+    }
+    if (ret == ESP_OK) {
+        *capacity = (uint64_t)card.csd.capacity * card.csd.sector_size;
+    }
+    sdmmc_host_deinit();
+    return ret;
+}
+
+esp_err_t bsp_sdcard_mount_with_config(const bsp_sdcard_cfg_t *cfg)
+{
+    ESP_RETURN_ON_FALSE(cfg, ESP_ERR_INVALID_ARG, TAG, "Invalid configuration");
+    ESP_RETURN_ON_FALSE(cfg->speed != BSP_SD_SPEED_UHS_SDR50, ESP_ERR_NOT_SUPPORTED, TAG, "UHS-I is not supported by this board");
+
     gpio_config_t power_gpio_config = {
         .mode = GPIO_MODE_OUTPUT,
         .pin_bit_mask = 1ULL << BSP_SD_POWER
@@ -174,17 +272,16 @@ esp_err_t bsp_sdcard_mount(void)
     /* SD card power on first */
     ESP_ERROR_CHECK(gpio_set_level(BSP_SD_POWER, 0));
 
-    const esp_vfs_fat_sdmmc_mount_config_t mount_config = {
-#ifdef CONFIG_BSP_SD_FORMAT_ON_MOUNT_FAIL
-        .format_if_mount_failed = true,
-#else
+    esp_vfs_fat_sdmmc_mount_config_t mount_config = {
         .format_if_mount_failed = false,
-#endif
-        .max_files = 5,
-        .allocation_unit_size = 16 * 1024
+        .max_files = cfg->max_files,
+        .allocation_unit_size = cfg->allocation_unit_size ? cfg->allocation_unit_size : 16 * 1024
     };
 
     sdmmc_host_t host = SDMMC_HOST_DEFAULT();
+    if (cfg->speed == BSP_SD_SPEED_HIGH) {
+        host.max_freq_khz = SDMMC_FREQ_HIGHSPEED;
+    }
     sdmmc_slot_config_t slot_config = SDMMC_SLOT_CONFIG_DEFAULT();
     slot_config.width = 4;
     slot_config.cmd = BSP_SD_CMD;
@@ -194,7 +291,92 @@ esp_err_t bsp_sdcard_mount(void)
     slot_config.d2 = BSP_SD_D2;
     slot_config.d3 = BSP_SD_D3;
 
-    return esp_vfs_fat_sdmmc_mount(BSP_SD_MOUNT_POINT, &host, &slot_config, &mount_config, &bsp_sdcard);
+    /* The card is formatted only if there is no filesystem, cluster size can be chosen from the card then */
+    esp_err_t ret = esp_vfs_fat_sdmmc_mount(BSP_SD_MOUNT_POINT, &host, &slot_config, &mount_config, &bsp_sdcard);
+    if (ret == ESP_FAIL && cfg->format_if_mount_failed) {
+        uint64_t capacity;
+        if (cfg->allocation_unit_size == 0 && bsp_sdcard_probe_capacity(&host, &slot_config, &capacity) == ESP_OK) {
+            mount_config.allocation_unit_size = bsp_sdcard_allocation_unit(capacity);
+        }
+        ESP_LOGW(TAG, "Formatting SD card, allocation unit %u bytes", (unsigned)mount_config.allocation_unit_size);
+        mount_config.format_if_mount_failed = true;
+        ret = esp_vfs_fat_sdmmc_mount(BSP_SD_MOUNT_POINT, &host, &slot_config, &mount_config, &bsp_sdcard);
+    }
+    ESP_RETURN_ON_ERROR(ret, TAG, "SD card mount failed");
+    ESP_LOGI(TAG, "SD card mounted, %d kHz, %d-bit bus", bsp_sdcard->max_freq_khz, bsp_sdcard->log_bus_width == 2 ? 4 : 1);
+
+    if (cfg->throughput_test_size) {
+        bsp_sdcard_throughput_t throughput;
+        if (bsp_sdcard_measure_throughput(cfg->throughput_test_size, &throughput) == ESP_OK) {
+            ESP_LOGI(TAG, "SD card sequential write %.2f MB/s, read %.2f MB/s", throughput.write_mbps, throughput.read_mbps);
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t bsp_sdcard_mount(void)
+{
+    const bsp_sdcard_cfg_t cfg = {
+        .speed = BSP_SD_SPEED_DEFAULT,
+#ifdef CONFIG_BSP_SD_FORMAT_ON_MOUNT_FAIL
+        .format_if_mount_failed = true,
+#else
+        .format_if_mount_failed = false,
+#endif
+        .max_files = 5,
+        .allocation_unit_size = 16 * 1024,
+    };
+    return bsp_sdcard_mount_with_config(&cfg);
+}
+
+esp_err_t bsp_sdcard_measure_throughput(size_t test_size, bsp_sdcard_throughput_t *result)
+{
+    const size_t chunk_size = 32 * 1024; // Multiple of sector size, FATFS writes it directly to the card
+    const char *path = BSP_SD_MOUNT_POINT"/bsp_tput.tmp";
+    esp_err_t ret = ESP_OK;
+
+    ESP_RETURN_ON_FALSE(result && test_size, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(bsp_sdcard, ESP_ERR_INVALID_STATE, TAG, "SD card is not mounted");
+    uint8_t *buf = heap_caps_malloc(chunk_size, MALLOC_CAP_DMA);
+    ESP_RETURN_ON_FALSE(buf, ESP_ERR_NO_MEM, TAG, "Not enough memory for throughput test");
+    memset(buf, 0xA5, chunk_size);
+
+    FILE *f = fopen(path, "wb");
+    ESP_GOTO_ON_FALSE(f, ESP_FAIL, err, TAG, "Failed to create %s", path);
+    int64_t start = esp_timer_get_time();
+    for (size_t done = 0; done < test_size; done += chunk_size) {
+        const size_t len = MIN(chunk_size, test_size - done);
+        if (fwrite(buf, 1, len, f) != len) {
+            ret = ESP_FAIL;
+            break;
+        }
+    }
+    fsync(fileno(f));
+    fclose(f);
+    const int64_t write_us = esp_timer_get_time() - start;
+    ESP_GOTO_ON_ERROR(ret, err_file, TAG, "Write of %s failed", path);
+
+    f = fopen(path, "rb");
+    ESP_GOTO_ON_FALSE(f, ESP_FAIL, err_file, TAG, "Failed to open %s", path);
+    start = esp_timer_get_time();
+    size_t done = 0;
+    size_t len;
+    while ((len = fread(buf, 1, chunk_size, f)) > 0) {
+        done += len;
+    }
+    fclose(f);
+    const int64_t read_us = esp_timer_get_time() - start;
+    ESP_GOTO_ON_FALSE(done == test_size, ESP_FAIL, err_file, TAG, "Read of %s failed", path);
+
+    /* bytes per us equals MB/s */
+    result->write_mbps = (float)test_size / MAX(write_us, 1);
+    result->read_mbps = (float)test_size / MAX(read_us, 1);
+
+err_file:
+    unlink(path);
+err:
+    free(buf);
+    return ret;
 }
 
 esp_err_t bsp_sdcard_unmount(void)
@@ -290,6 +472,101 @@ esp_codec_dev_handle_t bsp_audio_codec_microphone_init(void)
 #define LCD_PARAM_BITS         8
 #define LCD_LEDC_CH            CONFIG_BSP_DISPLAY_BRIGHTNESS_LEDC_CH
 
+#define LCD_LEDC_DUTY_MAX      1023 // LEDC resolution set to 10bits, thus: 100% = 1023
+
+/* Backlight service: requests are only recorded, the task applies the latest one with hardware fade */
+static struct {
+    TaskHandle_t task;
+    int target;                 // Requested brightness [%]
+    int current;                // Brightness set by the last fade [%]
+    bool fade;                  // Fade to the target, otherwise set immediately
+    bool off;                   // Backlight turned off, automatic brightness paused
+    bool auto_on;               // Automatic brightness running
+    bsp_display_brightness_auto_cfg_t auto_cfg;
+    float lux;                  // Filtered ambient light
+} backlight;
+static portMUX_TYPE backlight_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void bsp_display_brightness_request(int brightness_percent, bool fade, bool off, bool auto_on)
+{
+    portENTER_CRITICAL(&backlight_lock);
+    if (brightness_percent >= 0) {
+        backlight.target = brightness_percent;
+    }
+    backlight.fade = fade;
+    backlight.off = off;
+    backlight.auto_on = auto_on;
+    portEXIT_CRITICAL(&backlight_lock);
+    xTaskNotifyGive(backlight.task);
+}
+
+/* Brightness follows the logarithm of ambient light, as perceived by the eye */
+static void bsp_display_brightness_auto_sample(void)
+{
+    bsp_display_brightness_auto_cfg_t cfg;
+    float lux;
+
+    portENTER_CRITICAL(&backlight_lock);
+    cfg = backlight.auto_cfg;
+    portEXIT_CRITICAL(&backlight_lock);
+
+    if (cfg.lux_get(cfg.lux_ctx, &lux) != ESP_OK) {
+        ESP_LOGW(TAG, "Ambient light read failed");
+        return;
+    }
+    lux = MIN(MAX(lux, cfg.lux_min), cfg.lux_max);
+    backlight.lux = backlight.lux > 0 ? backlight.lux + (lux - backlight.lux) / 4 : lux;
+
+    const float ratio = logf(backlight.lux / cfg.lux_min) / logf(cfg.lux_max / cfg.lux_min);
+    const int brightness = cfg.brightness_min + (int)(ratio * (cfg.brightness_max - cfg.brightness_min) + 0.5f);
+
+    portENTER_CRITICAL(&backlight_lock);
+    if (backlight.auto_on && !backlight.off && abs(brightness - backlight.target) >= 2) {
+        backlight.target = brightness;
+        backlight.fade = true;
+    }
+    portEXIT_CRITICAL(&backlight_lock);
+}
+
+static esp_err_t bsp_display_brightness_apply(int brightness_percent, bool fade)
+{
+    const uint32_t duty_cycle = (LCD_LEDC_DUTY_MAX * brightness_percent) / 100;
+    const int fade_ms = CONFIG_BSP_DISPLAY_BRIGHTNESS_FADE_MS * abs(brightness_percent - backlight.current) / 100;
+
+    ESP_LOGD(TAG, "Setting LCD backlight: %d%%", brightness_percent);
+    if (!fade || fade_ms == 0) {
+        ESP_RETURN_ON_ERROR(ledc_set_duty(LEDC_LOW_SPEED_MODE, LCD_LEDC_CH, duty_cycle), TAG, "Duty set failed");
+        return ledc_update_duty(LEDC_LOW_SPEED_MODE, LCD_LEDC_CH);
+    }
+    /* Duty is stepped by LEDC hardware, the task only waits for the end of the fade */
+    ESP_RETURN_ON_ERROR(ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, LCD_LEDC_CH, duty_cycle, fade_ms), TAG, "Fade set failed");
+    return ledc_fade_start(LEDC_LOW_SPEED_MODE, LCD_LEDC_CH, LEDC_FADE_WAIT_DONE);
+}
+
+static void bsp_display_brightness_task(void *arg)
+{
+    while (1) {
+        const TickType_t wait = backlight.auto_on && !backlight.off ? pdMS_TO_TICKS(backlight.auto_cfg.period_ms) : portMAX_DELAY;
+        ulTaskNotifyTake(pdTRUE, wait);
+        if (backlight.auto_on && !backlight.off) {
+            bsp_display_brightness_auto_sample();
+        }
+
+        /* Requests received during the previous fade are coalesced, only the latest one is applied */
+        portENTER_CRITICAL(&backlight_lock);
+        const int target = backlight.off ? 0 : backlight.target;
+        const bool fade = backlight.fade;
+        portEXIT_CRITICAL(&backlight_lock);
+        if (target != backlight.current) {
+            if (bsp_display_brightness_apply(target, fade) == ESP_OK) {
+                backlight.current = target;
+            } else {
+                ESP_LOGE(TAG, "Setting LCD backlight %d%% failed", target);
+            }
+        }
+    }
+}
+
 esp_err_t bsp_display_brightness_init(void)
 {
     // Setup LEDC peripheral for PWM backlight control
@@ -310,14 +587,24 @@ esp_err_t bsp_display_brightness_init(void)
         .clk_cfg = LEDC_AUTO_CLK
     };
 
+    if (backlight.task) {
+        return ESP_OK;
+    }
     BSP_ERROR_CHECK_RETURN_ERR(ledc_timer_config(&LCD_backlight_timer));
     BSP_ERROR_CHECK_RETURN_ERR(ledc_channel_config(&LCD_backlight_channel));
+    esp_err_t ret = ledc_fade_func_install(0);
+    ESP_RETURN_ON_FALSE(ret == ESP_OK || ret == ESP_ERR_INVALID_STATE, ret, TAG, "LEDC fade install failed"); // Fade may be already installed by the application
+    const bsp_task_profile_t *ui_profile = bsp_task_profile_get(BSP_TASK_UI);
+    ESP_RETURN_ON_FALSE(xTaskCreatePinnedToCore(bsp_display_brightness_task, "backlight", 3072, NULL, ui_profile->priority, &backlight.task,
+                        ui_profile->affinity < 0 ? tskNO_AFFINITY : ui_profile->affinity) == pdPASS,
+                        ESP_ERR_NO_MEM, TAG, "Backlight task create failed");
 
     return ESP_OK;
 }
 
 esp_err_t bsp_display_brightness_set(int brightness_percent)
 {
+    ESP_RETURN_ON_FALSE(backlight.task, ESP_ERR_INVALID_STATE, TAG, "Brightness not initialized");
     if (brightness_percent > 100) {
         brightness_percent = 100;
     }
@@ -325,22 +612,45 @@ esp_err_t bsp_display_brightness_set(int brightness_percent)
         brightness_percent = 0;
     }
 
-    ESP_LOGI(TAG, "Setting LCD backlight: %d%%", brightness_percent);
-    uint32_t duty_cycle = (1023 * brightness_percent) / 100; // LEDC resolution set to 10bits, thus: 100% = 1023
-    BSP_ERROR_CHECK_RETURN_ERR(ledc_set_duty(LEDC_LOW_SPEED_MODE, LCD_LEDC_CH, duty_cycle));
-    BSP_ERROR_CHECK_RETURN_ERR(ledc_update_duty(LEDC_LOW_SPEED_MODE, LCD_LEDC_CH));
+    bsp_display_brightness_request(brightness_percent, true, false, false);
+    return ESP_OK;
+}
 
+esp_err_t bsp_display_brightness_auto_start(const bsp_display_brightness_auto_cfg_t *cfg)
+{
+    ESP_RETURN_ON_FALSE(backlight.task, ESP_ERR_INVALID_STATE, TAG, "Brightness not initialized");
+    ESP_RETURN_ON_FALSE(cfg && cfg->lux_get && cfg->period_ms > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid configuration");
+    ESP_RETURN_ON_FALSE(cfg->lux_min > 0 && cfg->lux_max > cfg->lux_min, ESP_ERR_INVALID_ARG, TAG, "Invalid ambient light range");
+    ESP_RETURN_ON_FALSE(cfg->brightness_min >= 0 && cfg->brightness_max <= 100 && cfg->brightness_min <= cfg->brightness_max,
+                        ESP_ERR_INVALID_ARG, TAG, "Invalid brightness range");
+
+    portENTER_CRITICAL(&backlight_lock);
+    backlight.auto_cfg = *cfg;
+    backlight.lux = 0;
+    portEXIT_CRITICAL(&backlight_lock);
+    bsp_display_brightness_request(-1, true, backlight.off, true);
+    return ESP_OK;
+}
+
+esp_err_t bsp_display_brightness_auto_stop(void)
+{
+    ESP_RETURN_ON_FALSE(backlight.task, ESP_ERR_INVALID_STATE, TAG, "Brightness not initialized");
+    bsp_display_brightness_request(-1, true, backlight.off, false);
     return ESP_OK;
 }
 
 esp_err_t bsp_display_backlight_off(void)
 {
-    return bsp_display_brightness_set(0);
+    ESP_RETURN_ON_FALSE(backlight.task, ESP_ERR_INVALID_STATE, TAG, "Brightness not initialized");
+    bsp_display_brightness_request(-1, false, true, backlight.auto_on);
+    return ESP_OK;
 }
 
 esp_err_t bsp_display_backlight_on(void)
 {
-    return bsp_display_brightness_set(100);
+    ESP_RETURN_ON_FALSE(backlight.task, ESP_ERR_INVALID_STATE, TAG, "Brightness not initialized");
+    bsp_display_brightness_request(backlight.auto_on ? -1 : 100, false, false, backlight.auto_on);
+    return ESP_OK;
 }
 
 static esp_err_t bsp_lcd_enter_sleep(void)
@@ -355,6 +665,34 @@ static esp_err_t bsp_lcd_exit_sleep(void)
     return esp_lcd_panel_disp_on_off(panel_handle, true);
 }
 
+static esp_err_t bsp_display_panel_init(esp_lcd_panel_handle_t panel)
+{
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_reset(panel), TAG, "Panel reset failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_init(panel), TAG, "Panel init failed");
+    return esp_lcd_panel_mirror(panel, true, true);
+}
+
+static void bsp_display_init_task(void *arg)
+{
+    esp_lcd_panel_handle_t panel = (esp_lcd_panel_handle_t)arg;
+
+    disp_init_ret = bsp_display_panel_init(panel);
+    xSemaphoreGive(disp_init_done);
+    vTaskDelete(NULL);
+}
+
+esp_err_t bsp_display_wait_init(uint32_t timeout_ms)
+{
+    if (!disp_init_pending) {
+        return ESP_OK;
+    }
+    if (xSemaphoreTake(disp_init_done, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    disp_init_pending = false;
+    return disp_init_ret;
+}
+
 esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_handle_t *ret_panel, esp_lcd_panel_io_handle_t *ret_io)
 {
     esp_err_t ret = ESP_OK;
@@ -384,7 +722,7 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
         .lcd_cmd_bits = LCD_CMD_BITS,
         .lcd_param_bits = LCD_PARAM_BITS,
         .spi_mode = 0,
-        .trans_queue_depth = 10,
+        .trans_queue_depth = (config->trans_queue_depth > 0) ? config->trans_queue_depth : 10,
     };
     ESP_GOTO_ON_ERROR(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)BSP_LCD_SPI_NUM, &io_config, ret_io), err, TAG, "New panel IO failed");
 
@@ -401,16 +739,27 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
         .bits_per_pixel = BSP_LCD_BITS_PER_PIXEL,
     };
 
-    if (ESP_OK == bsp_i2c_device_probe(ESP_LCD_TOUCH_IO_I2C_TT21100_ADDRESS)) {
+    uint8_t touch_addr = 0;
+    if (ESP_OK == bsp_touch_detect(&touch_addr) && touch_addr == ESP_LCD_TOUCH_IO_I2C_TT21100_ADDRESS) {
         ESP_GOTO_ON_ERROR(esp_lcd_new_panel_st7789(*ret_io, (const esp_lcd_panel_dev_config_t *)&panel_config, ret_panel), err, TAG, "New panel failed");
     } else {
         panel_config.vendor_config = (void *)&vendor_config;
         ESP_GOTO_ON_ERROR(esp_lcd_new_panel_ili9341(*ret_io, (const esp_lcd_panel_dev_config_t *)&panel_config, ret_panel), err, TAG, "New panel failed");
     }
 
-    esp_lcd_panel_reset(*ret_panel);
-    esp_lcd_panel_init(*ret_panel);
-    esp_lcd_panel_mirror(*ret_panel, true, true);
+    if (config->flags.async_init) {
+        /* Reset and sleep out delays of the panel run in a task, the caller can initialize other peripherals meanwhile */
+        if (disp_init_done == NULL) {
+            disp_init_done = xSemaphoreCreateBinaryStatic(&disp_init_done_buf);
+        }
+        disp_init_pending = true;
+        if (xTaskCreate(bsp_display_init_task, "LCD init", 3072, *ret_panel, 5, NULL) != pdPASS) {
+            disp_init_pending = false;
+            ESP_GOTO_ON_FALSE(false, ESP_ERR_NO_MEM, err, TAG, "Create LCD init task failed");
+        }
+    } else {
+        ESP_GOTO_ON_ERROR(bsp_display_panel_init(*ret_panel), err, TAG, "Panel init failed");
+    }
     return ret;
 
 err:
@@ -510,21 +859,20 @@ esp_err_t bsp_touch_new(const bsp_touch_config_t *config, esp_lcd_touch_handle_t
     };
     esp_lcd_panel_io_handle_t tp_io_handle = NULL;
     esp_lcd_panel_io_i2c_config_t tp_io_config;
+    uint8_t touch_addr = 0;
 
-    if (ESP_OK == bsp_i2c_device_probe(ESP_LCD_TOUCH_IO_I2C_GT911_ADDRESS)) {
-        esp_lcd_panel_io_i2c_config_t config = ESP_LCD_TOUCH_IO_I2C_GT911_CONFIG();
-        memcpy(&tp_io_config, &config, sizeof(config));
-    } else if (ESP_OK == bsp_i2c_device_probe(ESP_LCD_TOUCH_IO_I2C_GT911_ADDRESS_BACKUP)) {
-        esp_lcd_panel_io_i2c_config_t config = ESP_LCD_TOUCH_IO_I2C_GT911_CONFIG();
-        config.dev_addr = ESP_LCD_TOUCH_IO_I2C_GT911_ADDRESS_BACKUP;
-        memcpy(&tp_io_config, &config, sizeof(config));
-    } else if (ESP_OK == bsp_i2c_device_probe(ESP_LCD_TOUCH_IO_I2C_TT21100_ADDRESS)) {
+    if (ESP_OK != bsp_touch_detect(&touch_addr)) {
+        ESP_LOGE(TAG, "Touch not found");
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (ESP_LCD_TOUCH_IO_I2C_TT21100_ADDRESS == touch_addr) {
         esp_lcd_panel_io_i2c_config_t config = ESP_LCD_TOUCH_IO_I2C_TT21100_CONFIG();
         memcpy(&tp_io_config, &config, sizeof(config));
         tp_cfg.flags.mirror_x = 1;
     } else {
-        ESP_LOGE(TAG, "Touch not found");
-        return ESP_ERR_NOT_FOUND;
+        esp_lcd_panel_io_i2c_config_t config = ESP_LCD_TOUCH_IO_I2C_GT911_CONFIG();
+        config.dev_addr = touch_addr;
+        memcpy(&tp_io_config, &config, sizeof(config));
     }
 
     ESP_RETURN_ON_ERROR(esp_lcd_new_panel_io_i2c((esp_lcd_i2c_bus_handle_t)BSP_I2C_NUM, &tp_io_config, &tp_io_handle), TAG, "");
@@ -566,6 +914,11 @@ lv_display_t *bsp_display_start(void)
             .buff_spiram = false,
         }
     };
+#if CONFIG_PM_ENABLE
+    /* CPU and APB clocks at maximum only while rendering and flushing */
+    cfg.lvgl_port_cfg.flags.pm_lock = true;
+#endif
+    BSP_TASK_PROFILE_APPLY(cfg.lvgl_port_cfg, BSP_TASK_UI);
     return bsp_display_start_with_config(&cfg);
 }
 
@@ -605,20 +958,46 @@ void bsp_display_unlock(void)
 
 esp_err_t bsp_display_enter_sleep(void)
 {
-    BSP_ERROR_CHECK_RETURN_ERR(bsp_lcd_enter_sleep());
+    /* Only refreshing is stopped, the frame stays in the panel memory and draw buffers are kept */
     BSP_ERROR_CHECK_RETURN_ERR(bsp_display_backlight_off());
+    if (!disp_sleeping) {
+        bsp_display_lock(0);
+        esp_err_t ret = lvgl_port_stop();
+        bsp_display_unlock();
+        ESP_RETURN_ON_ERROR(ret, TAG, "LVGL stop failed");
+        disp_sleeping = true;
+    }
+    BSP_ERROR_CHECK_RETURN_ERR(bsp_lcd_enter_sleep());
     BSP_ERROR_CHECK_RETURN_ERR(bsp_touch_enter_sleep());
     return ESP_OK;
 }
 
 esp_err_t bsp_display_exit_sleep(void)
 {
+    const int64_t start_us = esp_timer_get_time();
+
+    /* Retained frame is visible right after display on, LVGL redraws only areas invalidated during sleep */
     BSP_ERROR_CHECK_RETURN_ERR(bsp_lcd_exit_sleep());
     BSP_ERROR_CHECK_RETURN_ERR(bsp_display_backlight_on());
+    if (disp_sleeping) {
+        bsp_display_lock(0);
+        esp_err_t ret = lvgl_port_resume();
+        bsp_display_unlock();
+        ESP_RETURN_ON_ERROR(ret, TAG, "LVGL resume failed");
+        disp_sleeping = false;
+    }
     BSP_ERROR_CHECK_RETURN_ERR(bsp_touch_exit_sleep());
+
+    disp_resume_us = (uint32_t)(esp_timer_get_time() - start_us);
+    ESP_LOGI(TAG, "Display resumed in %" PRIu32 " us", disp_resume_us);
     return ESP_OK;
 }
 
+uint32_t bsp_display_get_resume_time_us(void)
+{
+    return disp_resume_us;
+}
+
 static uint8_t bsp_get_main_button(void *param)
 {
     assert(tp);
@@ -663,3 +1042,268 @@ esp_err_t bsp_iot_button_create(button_handle_t btn_array[], int *btn_cnt, int b
     }
     return ret;
 }
+
+esp_err_t bsp_pm_enable(bool light_sleep)
+{
+#if CONFIG_PM_ENABLE
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    const esp_pm_config_t pm_config = {
+#else
+    const esp_pm_config_esp32s3_t pm_config = {
+#endif
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = 40, // XTAL
+        .light_sleep_enable = light_sleep,
+    };
+    ESP_RETURN_ON_ERROR(esp_pm_configure(&pm_config), TAG, "PM configuration failed");
+    ESP_LOGI(TAG, "Power management: %d - %d MHz, light-sleep %s", pm_config.min_freq_mhz, pm_config.max_freq_mhz, light_sleep ? "on" : "off");
+    return ESP_OK;
+#else
+    ESP_LOGE(TAG, "CONFIG_PM_ENABLE is not set");
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/* Parallel initialization: one worker task per subsystem, started after the subsystems it depends on */
+typedef struct {
+    const char *name;
+    uint32_t depends;   // Subsystems, which must be finished before
+    esp_err_t (*init)(void **handle);
+} bsp_init_worker_t;
+
+static esp_err_t bsp_init_i2c_worker(void **handle)
+{
+    return bsp_i2c_init();
+}
+
+static esp_err_t bsp_init_display_worker(void **handle)
+{
+    *handle = bsp_display_start();
+    return *handle ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t bsp_init_speaker_worker(void **handle)
+{
+    *handle = bsp_audio_codec_speaker_init();
+    return *handle ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t bsp_init_microphone_worker(void **handle)
+{
+    *handle = bsp_audio_codec_microphone_init();
+    return *handle ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t bsp_init_sdcard_worker(void **handle)
+{
+    return bsp_sdcard_mount();
+}
+
+static esp_err_t bsp_init_spiffs_worker(void **handle)
+{
+    return bsp_spiffs_mount();
+}
+
+static const bsp_init_worker_t bsp_init_workers[BSP_INIT_NUM] = {
+    [BSP_INIT_I2C] = {"I2C", 0, bsp_init_i2c_worker},
+    [BSP_INIT_DISPLAY] = {"display", BSP_INIT_BIT(BSP_INIT_I2C), bsp_init_display_worker},
+    [BSP_INIT_SPEAKER] = {"speaker", BSP_INIT_BIT(BSP_INIT_I2C), bsp_init_speaker_worker},
+    [BSP_INIT_MICROPHONE] = {"microphone", BSP_INIT_BIT(BSP_INIT_I2C) | BSP_INIT_BIT(BSP_INIT_SPEAKER), bsp_init_microphone_worker},
+    [BSP_INIT_SDCARD] = {"SD card", 0, bsp_init_sdcard_worker},
+    [BSP_INIT_SPIFFS] = {"SPIFFS", 0, bsp_init_spiffs_worker},
+};
+
+/* Subsystems calling bsp_i2c_init() themselves, it is not thread-safe, so I2C is always initialized first for them */
+#define BSP_INIT_I2C_USERS  (BSP_INIT_BIT(BSP_INIT_DISPLAY) | BSP_INIT_BIT(BSP_INIT_SPEAKER) | BSP_INIT_BIT(BSP_INIT_MICROPHONE))
+
+static EventGroupHandle_t bsp_init_events = NULL;
+static StaticEventGroup_t bsp_init_events_buf;
+static uint32_t bsp_init_mask = 0;      // Subsystems started by bsp_init_async()
+static int64_t bsp_init_start_time = 0;
+static bsp_init_result_t bsp_init_results[BSP_INIT_NUM];
+
+static void bsp_init_task(void *arg)
+{
+    const bsp_init_subsystem_t subsystem = (bsp_init_subsystem_t)(intptr_t)arg;
+    const bsp_init_worker_t *worker = &bsp_init_workers[subsystem];
+    bsp_init_result_t *result = &bsp_init_results[subsystem];
+
+    /* Dependencies not requested (speaker of microphone) are not waited for, their init functions are called by the subsystem itself */
+    const uint32_t depends = worker->depends & bsp_init_mask;
+    if (depends) {
+        xEventGroupWaitBits(bsp_init_events, depends, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+
+    const int64_t start = esp_timer_get_time();
+    result->ret = worker->init(&result->handle);
+    result->duration_us = esp_timer_get_time() - start;
+    result->start_us = start - bsp_init_start_time;
+    ESP_LOGI(TAG, "Init of %s %s in %"PRIu32" ms", worker->name, result->ret == ESP_OK ? "done" : "failed",
+             result->duration_us / 1000);
+
+    xEventGroupSetBits(bsp_init_events, BSP_INIT_BIT(subsystem));
+    vTaskDelete(NULL);
+}
+
+EventGroupHandle_t bsp_init_async(uint32_t mask)
+{
+    mask &= BSP_INIT_MASK_ALL;
+    if (bsp_init_events == NULL) {
+        bsp_init_events = xEventGroupCreateStatic(&bsp_init_events_buf);
+    } else if ((xEventGroupGetBits(bsp_init_events) & bsp_init_mask) != bsp_init_mask) {
+        ESP_LOGE(TAG, "Initialization is already running");
+        return NULL;
+    }
+
+    if (mask & BSP_INIT_I2C_USERS) {
+        /* Workers must not install the I2C driver in parallel */
+        mask |= BSP_INIT_BIT(BSP_INIT_I2C);
+    }
+
+    xEventGroupClearBits(bsp_init_events, BSP_INIT_MASK_ALL);
+    bsp_init_mask = mask;
+    bsp_init_start_time = esp_timer_get_time();
+    for (int i = 0; i < BSP_INIT_NUM; i++) {
+        if (!(mask & BSP_INIT_BIT(i))) {
+            continue;
+        }
+        bsp_init_results[i] = (bsp_init_result_t) {
+            .ret = ESP_ERR_INVALID_STATE,
+        };
+        if (xTaskCreate(bsp_init_task, bsp_init_workers[i].name, 4096, (void *)(intptr_t)i, 5, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "Create init task of %s failed", bsp_init_workers[i].name);
+            bsp_init_results[i].ret = ESP_ERR_NO_MEM;
+            xEventGroupSetBits(bsp_init_events, BSP_INIT_BIT(i));
+        }
+    }
+    return bsp_init_events;
+}
+
+esp_err_t bsp_init_wait(uint32_t mask, uint32_t timeout_ms)
+{
+    ESP_RETURN_ON_FALSE(bsp_init_events && (mask & bsp_init_mask) == mask, ESP_ERR_INVALID_STATE, TAG, "Not started by bsp_init_async()");
+
+    const EventBits_t bits = xEventGroupWaitBits(bsp_init_events, mask, pdFALSE, pdTRUE, pdMS_TO_TICKS(timeout_ms));
+    if ((bits & mask) != mask) {
+        return ESP_ERR_TIMEOUT;
+    }
+    for (int i = 0; i < BSP_INIT_NUM; i++) {
+        if ((mask & BSP_INIT_BIT(i)) && bsp_init_results[i].ret != ESP_OK) {
+            return bsp_init_results[i].ret;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t bsp_init_get_result(bsp_init_subsystem_t subsystem, bsp_init_result_t *result)
+{
+    ESP_RETURN_ON_FALSE(subsystem < BSP_INIT_NUM && result, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(bsp_init_events && (bsp_init_mask & BSP_INIT_BIT(subsystem)) &&
+                        (xEventGroupGetBits(bsp_init_events) & BSP_INIT_BIT(subsystem)),
+                        ESP_ERR_INVALID_STATE, TAG, "Initialization of subsystem %d not finished", subsystem);
+    *result = bsp_init_results[subsystem];
+    return ESP_OK;
+}
+
+static const bsp_task_profile_t bsp_task_profiles[BSP_TASK_CLASS_NUM] = {
+    [BSP_TASK_UI] = {
+        .priority = CONFIG_BSP_TASK_UI_PRIORITY,
+        .stack = CONFIG_BSP_TASK_UI_STACK,
+        .affinity = CONFIG_BSP_TASK_UI_CORE,
+    },
+    [BSP_TASK_AUDIO] = {
+        .priority = CONFIG_BSP_TASK_AUDIO_PRIORITY,
+        .stack = CONFIG_BSP_TASK_AUDIO_STACK,
+        .affinity = CONFIG_BSP_TASK_AUDIO_CORE,
+    },
+    [BSP_TASK_SENSORS] = {
+        .priority = CONFIG_BSP_TASK_SENSORS_PRIORITY,
+        .stack = CONFIG_BSP_TASK_SENSORS_STACK,
+        .affinity = CONFIG_BSP_TASK_SENSORS_CORE,
+    },
+};
+
+const bsp_task_profile_t *bsp_task_profile_get(bsp_task_class_t task_class)
+{
+    if (task_class >= BSP_TASK_CLASS_NUM) {
+        return &bsp_task_profiles[BSP_TASK_UI];
+    }
+    return &bsp_task_profiles[task_class];
+}
+
+esp_err_t bsp_task_create(TaskFunction_t task, const char *name, void *arg, bsp_task_class_t task_class, TaskHandle_t *ret_task)
+{
+    ESP_RETURN_ON_FALSE(task && task_class < BSP_TASK_CLASS_NUM, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    const bsp_task_profile_t *profile = &bsp_task_profiles[task_class];
+    const BaseType_t core = profile->affinity < 0 ? tskNO_AFFINITY : profile->affinity;
+    ESP_RETURN_ON_FALSE(xTaskCreatePinnedToCore(task, name, profile->stack, arg, profile->priority, ret_task, core) == pdPASS,
+                        ESP_ERR_NO_MEM, TAG, "Create task %s failed", name);
+    return ESP_OK;
+}
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+static int bsp_task_status_cmp(const void *a, const void *b)
+{
+    const TaskStatus_t *ta = a;
+    const TaskStatus_t *tb = b;
+    return (ta->xHandle > tb->xHandle) - (ta->xHandle < tb->xHandle);
+}
+
+/* Snapshot of all tasks sorted by handle, so the two snapshots can be matched */
+static TaskStatus_t *bsp_task_snapshot(UBaseType_t *count, uint32_t *total)
+{
+    /* Room for a few tasks created during the snapshot */
+    const UBaseType_t len = uxTaskGetNumberOfTasks() + 4;
+    TaskStatus_t *tasks = malloc(len * sizeof(TaskStatus_t));
+    if (tasks) {
+        *count = uxTaskGetSystemState(tasks, len, total);
+        qsort(tasks, *count, sizeof(TaskStatus_t), bsp_task_status_cmp);
+    }
+    return tasks;
+}
+
+esp_err_t bsp_task_usage_print(uint32_t window_ms)
+{
+    esp_err_t ret = ESP_OK;
+    UBaseType_t start_cnt = 0;
+    UBaseType_t end_cnt = 0;
+    uint32_t start_total;
+    uint32_t end_total;
+    TaskStatus_t *end = NULL;
+    TaskStatus_t *start = bsp_task_snapshot(&start_cnt, &start_total);
+    ESP_RETURN_ON_FALSE(start, ESP_ERR_NO_MEM, TAG, "Not enough memory for task list");
+    vTaskDelay(pdMS_TO_TICKS(window_ms));
+    end = bsp_task_snapshot(&end_cnt, &end_total);
+    ESP_GOTO_ON_FALSE(end, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for task list");
+    ESP_GOTO_ON_FALSE(start_cnt == end_cnt && end_total != start_total, ESP_ERR_INVALID_STATE, err, TAG, "Tasks changed in the window");
+
+    /* Run time counter counts time of one core, each core has the whole window */
+    const uint32_t window = end_total - start_total;
+    printf("| Task             | Core | Prio | CPU [%%] | Stack free |\n");
+    for (UBaseType_t i = 0; i < end_cnt; i++) {
+        ESP_GOTO_ON_FALSE(start[i].xHandle == end[i].xHandle, ESP_ERR_INVALID_STATE, err, TAG, "Tasks changed in the window");
+        const uint32_t run = (uint32_t)end[i].ulRunTimeCounter - (uint32_t)start[i].ulRunTimeCounter;
+#if CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID
+        const BaseType_t core = end[i].xCoreID;
+        const char *core_str = core == tskNO_AFFINITY ? "any" : (core == 0 ? "0" : "1");
+#else
+        const char *core_str = "-";
+#endif
+        printf("| %-16s | %4s | %4u | %7.1f | %10u |\n", end[i].pcTaskName, core_str,
+               (unsigned)end[i].uxCurrentPriority, 100.0 * run / window,
+               (unsigned)end[i].usStackHighWaterMark);
+    }
+
+err:
+    free(start);
+    free(end);
+    return ret;
+}
+#else
+esp_err_t bsp_task_usage_print(uint32_t window_ms)
+{
+    ESP_LOGE(TAG, "Enable CONFIG_FREERTOS_USE_TRACE_FACILITY and CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+#endif
@@ -0,0 +1,391 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Read-ahead cache of the SD card
+ *
+ * Files are opened through a VFS at BSP_SD_CACHE_MOUNT_POINT, which forwards to the FATFS at BSP_SD_MOUNT_POINT.
+ * Small reads of files opened for reading only are served from a per-file window read ahead by one large read,
+ * so FATFS reads many sectors by one multi-block command. The window grows while the file is read sequentially
+ * and drops to the minimum after a seek. Files opened for writing and directories are forwarded without caching.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/param.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_vfs.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "bsp/esp-box-3.h"
+
+static const char *TAG = "ESP-BOX-3";
+
+#define BSP_SD_CACHE_WINDOW_MIN     (4 * 1024)  // Window after open and seek, multiple of sector size
+#define BSP_SD_CACHE_WINDOW_MAX     (64 * 1024)
+#define BSP_SD_CACHE_MAX_FILES      (4)
+#define BSP_SD_CACHE_SECTOR         (512)
+#define BSP_SD_CACHE_PATH_MAX       (ESP_VFS_PATH_MAX + 256)
+
+typedef struct {
+    int fd;                 // FATFS file, -1 if the slot is free
+    bool cached;            // Opened for reading only
+    uint8_t *buf;           // Read-ahead window
+    off_t buf_pos;          // File offset of buf[0]
+    size_t buf_len;         // Valid bytes in buf
+    size_t window;          // Size of the next read-ahead
+    off_t pos;              // Position of the application
+    off_t seq_end;          // End of the last read-ahead, reading from here is sequential
+} bsp_sd_cache_file_t;
+
+typedef struct {
+    DIR dir;                // Must be the first, VFS fills its index
+    DIR *inner;             // Directory of FATFS
+} bsp_sd_cache_dir_t;
+
+static bsp_sd_cache_file_t *sd_cache_files;
+static bsp_sdcard_cache_cfg_t sd_cache_cfg;
+static bsp_sdcard_cache_stats_t sd_cache_stats;
+static portMUX_TYPE sd_cache_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t sd_cache_mutex;    // Protects the file slots on open and close
+
+#define SD_CACHE_STATS_ADD(field, val) do {         \
+        portENTER_CRITICAL(&sd_cache_stats_lock);   \
+        sd_cache_stats.field += (val);              \
+        portEXIT_CRITICAL(&sd_cache_stats_lock);    \
+    } while (0)
+
+/* Path in FATFS, the VFS passes the path without the cache mount point */
+static void sd_cache_path(char *dst, size_t dst_len, const char *path)
+{
+    snprintf(dst, dst_len, "%s%s", BSP_SD_MOUNT_POINT, path);
+}
+
+static int sd_cache_open(const char *path, int flags, int mode)
+{
+    char full[BSP_SD_CACHE_PATH_MAX];
+    sd_cache_path(full, sizeof(full), path);
+
+    xSemaphoreTake(sd_cache_mutex, portMAX_DELAY);
+    int slot = -1;
+    for (int i = 0; i < sd_cache_cfg.max_files; i++) {
+        if (sd_cache_files[i].fd < 0) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        xSemaphoreGive(sd_cache_mutex);
+        errno = ENFILE;
+        return -1;
+    }
+    const int fd = open(full, flags, mode);
+    if (fd < 0) {
+        xSemaphoreGive(sd_cache_mutex);
+        return -1;
+    }
+    bsp_sd_cache_file_t *file = &sd_cache_files[slot];
+    memset(file, 0, sizeof(bsp_sd_cache_file_t));
+    file->fd = fd;
+    file->window = BSP_SD_CACHE_WINDOW_MIN;
+    if ((flags & O_ACCMODE) == O_RDONLY) {
+        file->buf = heap_caps_malloc(sd_cache_cfg.window_max, sd_cache_cfg.caps);
+        /* Without memory the file is read uncached */
+        file->cached = (file->buf != NULL);
+    }
+    xSemaphoreGive(sd_cache_mutex);
+    return slot;
+}
+
+static int sd_cache_close(int slot)
+{
+    bsp_sd_cache_file_t *file = &sd_cache_files[slot];
+    xSemaphoreTake(sd_cache_mutex, portMAX_DELAY);
+    const int ret = close(file->fd);
+    free(file->buf);
+    file->buf = NULL;
+    file->fd = -1;
+    xSemaphoreGive(sd_cache_mutex);
+    return ret;
+}
+
+/* Read the window at the application position, aligned to sector so FATFS reads whole sectors into the buffer */
+static ssize_t sd_cache_fill(bsp_sd_cache_file_t *file)
+{
+    if (file->pos == file->seq_end) {
+        file->window = MIN(file->window * 2, sd_cache_cfg.window_max);
+    } else {
+        file->window = BSP_SD_CACHE_WINDOW_MIN;
+    }
+    const off_t start = file->pos & ~(off_t)(BSP_SD_CACHE_SECTOR - 1);
+    if (lseek(file->fd, start, SEEK_SET) < 0) {
+        return -1;
+    }
+    const ssize_t len = read(file->fd, file->buf, file->window);
+    if (len < 0) {
+        file->buf_len = 0;
+        return -1;
+    }
+    file->buf_pos = start;
+    file->buf_len = len;
+    file->seq_end = start + len;
+    portENTER_CRITICAL(&sd_cache_stats_lock);
+    sd_cache_stats.card_reads++;
+    sd_cache_stats.card_bytes += len;
+    portEXIT_CRITICAL(&sd_cache_stats_lock);
+    return len;
+}
+
+static ssize_t sd_cache_read(int slot, void *dst, size_t size)
+{
+    bsp_sd_cache_file_t *file = &sd_cache_files[slot];
+    if (!file->cached) {
+        return read(file->fd, dst, size);
+    }
+
+    uint8_t *out = dst;
+    size_t done = 0;
+    bool hit = true;
+    while (done < size) {
+        if (file->pos >= file->buf_pos && file->pos < file->buf_pos + (off_t)file->buf_len) {
+            const size_t offset = file->pos - file->buf_pos;
+            const size_t len = MIN(size - done, file->buf_len - offset);
+            memcpy(out + done, file->buf + offset, len);
+            done += len;
+            file->pos += len;
+            continue;
+        }
+        hit = false;
+        if (size - done >= file->window) {
+            /* Large reads go to the application buffer directly, the window is kept */
+            if (lseek(file->fd, file->pos, SEEK_SET) < 0) {
+                return done ? done : -1;
+            }
+            const ssize_t len = read(file->fd, out + done, size - done);
+            if (len <= 0) {
+                return done ? done : len;
+            }
+            done += len;
+            file->pos += len;
+            file->seq_end = file->pos;
+            SD_CACHE_STATS_ADD(bypass_bytes, len);
+            break;
+        }
+        const ssize_t len = sd_cache_fill(file);
+        if (len < 0) {
+            return done ? done : -1;
+        }
+        if (file->pos >= file->buf_pos + (off_t)file->buf_len) {
+            break; // End of file
+        }
+    }
+
+    portENTER_CRITICAL(&sd_cache_stats_lock);
+    sd_cache_stats.reads++;
+    sd_cache_stats.hits += hit ? 1 : 0;
+    sd_cache_stats.read_bytes += done;
+    portEXIT_CRITICAL(&sd_cache_stats_lock);
+    return done;
+}
+
+static ssize_t sd_cache_write(int slot, const void *data, size_t size)
+{
+    return write(sd_cache_files[slot].fd, data, size);
+}
+
+static off_t sd_cache_lseek(int slot, off_t offset, int whence)
+{
+    bsp_sd_cache_file_t *file = &sd_cache_files[slot];
+    if (!file->cached) {
+        return lseek(file->fd, offset, whence);
+    }
+    /* The FATFS position is set by the next card read */
+    off_t pos;
+    switch (whence) {
+    case SEEK_SET:
+        pos = offset;
+        break;
+    case SEEK_CUR:
+        pos = file->pos + offset;
+        break;
+    default:
+        pos = lseek(file->fd, offset, whence);
+        break;
+    }
+    if (pos < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    file->pos = pos;
+    return pos;
+}
+
+static int sd_cache_fstat(int slot, struct stat *st)
+{
+    return fstat(sd_cache_files[slot].fd, st);
+}
+
+static int sd_cache_fsync(int slot)
+{
+    return fsync(sd_cache_files[slot].fd);
+}
+
+static int sd_cache_stat(const char *path, struct stat *st)
+{
+    char full[BSP_SD_CACHE_PATH_MAX];
+    sd_cache_path(full, sizeof(full), path);
+    return stat(full, st);
+}
+
+static int sd_cache_unlink(const char *path)
+{
+    char full[BSP_SD_CACHE_PATH_MAX];
+    sd_cache_path(full, sizeof(full), path);
+    return unlink(full);
+}
+
+static int sd_cache_rename(const char *src, const char *dst)
+{
+    char full_src[BSP_SD_CACHE_PATH_MAX];
+    char full_dst[BSP_SD_CACHE_PATH_MAX];
+    sd_cache_path(full_src, sizeof(full_src), src);
+    sd_cache_path(full_dst, sizeof(full_dst), dst);
+    return rename(full_src, full_dst);
+}
+
+static int sd_cache_mkdir(const char *path, mode_t mode)
+{
+    char full[BSP_SD_CACHE_PATH_MAX];
+    sd_cache_path(full, sizeof(full), path);
+    return mkdir(full, mode);
+}
+
+static DIR *sd_cache_opendir(const char *path)
+{
+    char full[BSP_SD_CACHE_PATH_MAX];
+    sd_cache_path(full, sizeof(full), path);
+    bsp_sd_cache_dir_t *dir = calloc(1, sizeof(bsp_sd_cache_dir_t));
+    if (dir == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    dir->inner = opendir(full);
+    if (dir->inner == NULL) {
+        free(dir);
+        return NULL;
+    }
+    return &dir->dir;
+}
+
+static struct dirent *sd_cache_readdir(DIR *pdir)
+{
+    return readdir(((bsp_sd_cache_dir_t *)pdir)->inner);
+}
+
+static int sd_cache_closedir(DIR *pdir)
+{
+    bsp_sd_cache_dir_t *dir = (bsp_sd_cache_dir_t *)pdir;
+    const int ret = closedir(dir->inner);
+    free(dir);
+    return ret;
+}
+
+esp_err_t bsp_sdcard_cache_register(const bsp_sdcard_cache_cfg_t *cfg)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(bsp_sdcard, ESP_ERR_INVALID_STATE, TAG, "SD card is not mounted");
+    ESP_RETURN_ON_FALSE(sd_cache_files == NULL, ESP_ERR_INVALID_STATE, TAG, "SD card cache is already registered");
+
+    sd_cache_cfg.window_max = BSP_SD_CACHE_WINDOW_MAX;
+    sd_cache_cfg.max_files = BSP_SD_CACHE_MAX_FILES;
+    sd_cache_cfg.caps = MALLOC_CAP_SPIRAM;
+    if (cfg) {
+        sd_cache_cfg.window_max = cfg->window_max ? cfg->window_max : sd_cache_cfg.window_max;
+        sd_cache_cfg.max_files = cfg->max_files ? cfg->max_files : sd_cache_cfg.max_files;
+        sd_cache_cfg.caps = cfg->caps ? cfg->caps : sd_cache_cfg.caps;
+    }
+    ESP_RETURN_ON_FALSE(sd_cache_cfg.window_max >= BSP_SD_CACHE_WINDOW_MIN && sd_cache_cfg.window_max % BSP_SD_CACHE_SECTOR == 0,
+                        ESP_ERR_INVALID_ARG, TAG, "Window must be a multiple of %d bytes, at least %d bytes", BSP_SD_CACHE_SECTOR, BSP_SD_CACHE_WINDOW_MIN);
+    if (!heap_caps_get_total_size(sd_cache_cfg.caps)) {
+        ESP_LOGW(TAG, "No memory with caps 0x%"PRIx32" for SD card cache, internal RAM is used", sd_cache_cfg.caps);
+        sd_cache_cfg.caps = MALLOC_CAP_DMA;
+    }
+
+    sd_cache_files = calloc(sd_cache_cfg.max_files, sizeof(bsp_sd_cache_file_t));
+    ESP_RETURN_ON_FALSE(sd_cache_files, ESP_ERR_NO_MEM, TAG, "Not enough memory for SD card cache");
+    for (int i = 0; i < sd_cache_cfg.max_files; i++) {
+        sd_cache_files[i].fd = -1;
+    }
+    sd_cache_mutex = xSemaphoreCreateMutex();
+    ESP_GOTO_ON_FALSE(sd_cache_mutex, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for SD card cache");
+
+    const esp_vfs_t vfs = {
+        .flags = ESP_VFS_FLAG_DEFAULT,
+        .open = sd_cache_open,
+        .close = sd_cache_close,
+        .read = sd_cache_read,
+        .write = sd_cache_write,
+        .lseek = sd_cache_lseek,
+        .fstat = sd_cache_fstat,
+        .fsync = sd_cache_fsync,
+        .stat = sd_cache_stat,
+        .unlink = sd_cache_unlink,
+        .rename = sd_cache_rename,
+        .mkdir = sd_cache_mkdir,
+        .opendir = sd_cache_opendir,
+        .readdir = sd_cache_readdir,
+        .closedir = sd_cache_closedir,
+    };
+    ESP_GOTO_ON_ERROR(esp_vfs_register(BSP_SD_CACHE_MOUNT_POINT, &vfs, NULL), err, TAG, "VFS register failed");
+    bsp_sdcard_cache_get_stats(NULL, true);
+    return ESP_OK;
+
+err:
+    if (sd_cache_mutex) {
+        vSemaphoreDelete(sd_cache_mutex);
+        sd_cache_mutex = NULL;
+    }
+    free(sd_cache_files);
+    sd_cache_files = NULL;
+    return ret;
+}
+
+esp_err_t bsp_sdcard_cache_unregister(void)
+{
+    ESP_RETURN_ON_FALSE(sd_cache_files, ESP_ERR_INVALID_STATE, TAG, "SD card cache is not registered");
+    for (int i = 0; i < sd_cache_cfg.max_files; i++) {
+        ESP_RETURN_ON_FALSE(sd_cache_files[i].fd < 0, ESP_ERR_INVALID_STATE, TAG, "Files are open in SD card cache");
+    }
+    ESP_RETURN_ON_ERROR(esp_vfs_unregister(BSP_SD_CACHE_MOUNT_POINT), TAG, "VFS unregister failed");
+    vSemaphoreDelete(sd_cache_mutex);
+    sd_cache_mutex = NULL;
+    free(sd_cache_files);
+    sd_cache_files = NULL;
+    return ESP_OK;
+}
+
+void bsp_sdcard_cache_get_stats(bsp_sdcard_cache_stats_t *stats, bool reset)
+{
+    portENTER_CRITICAL(&sd_cache_stats_lock);
+    if (stats) {
+        *stats = sd_cache_stats;
+    }
+    if (reset) {
+        memset(&sd_cache_stats, 0, sizeof(sd_cache_stats));
+    }
+    portEXIT_CRITICAL(&sd_cache_stats_lock);
+}
@@ -43,6 +43,10 @@ extern "C" {
  */
 typedef struct {
     int max_transfer_sz;    /*!< Maximum transfer size, in bytes. */
+    int trans_queue_depth;  /*!< Number of SPI transactions queued in the panel IO, commands and color chunks of all draw buffers in flight (0: 10) */
+    struct {
+        unsigned int async_init: 1; /*!< Reset and initialize the panel in a background task, bsp_display_new() returns immediately */
+    } flags;
 } bsp_display_config_t;
 
 /**
@@ -70,39 +74,125 @@ typedef struct {
  */
 esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_handle_t *ret_panel, esp_lcd_panel_io_handle_t *ret_io);
 
+/**
+ * @brief Wait for the end of asynchronous panel initialization
+ *
+ * Panel initialization started by bsp_display_new() with `flags.async_init` waits for reset and sleep out of the LCD
+ * (more than 100 ms). Other peripherals (audio, SD card, Wi-Fi) can be initialized meanwhile. The panel must not be used
+ * (e.g. esp_lcd_panel_disp_on_off() or adding into LVGL) before this function returns ESP_OK.
+ *
+ * @param[in] timeout_ms Maximum waiting time in milliseconds
+ * @return
+ *      - ESP_OK                On success or if no initialization is pending
+ *      - ESP_ERR_TIMEOUT       Initialization is not finished yet
+ *      - Else                  esp_lcd failure
+ */
+esp_err_t bsp_display_wait_init(uint32_t timeout_ms);
+
 /**
  * @brief Initialize display's brightness
  *
  * Brightness is controlled with PWM signal to a pin controlling backlight.
+ * LEDC fade is installed and the backlight task is created. Backlight is off after initialization.
  *
  * @return
  *      - ESP_OK                On success
  *      - ESP_ERR_INVALID_ARG   Parameter error
+ *      - ESP_ERR_NO_MEM        Not enough memory for the backlight task
  */
 esp_err_t bsp_display_brightness_init(void);
 
+/**
+ * @brief Ambient light reading for automatic brightness
+ *
+ * Signature matches bh1750_get_data(), so the BH1750 driver can be used directly with the sensor handle as `ctx`.
+ *
+ * @param[in]  ctx  User context from the configuration
+ * @param[out] lux  Ambient light [lx]
+ * @return ESP_OK on success, the sample is skipped otherwise
+ */
+typedef esp_err_t (*bsp_display_lux_get_t)(void *ctx, float *lux);
+
+/**
+ * @brief Automatic brightness configuration
+ *
+ * Brightness is interpolated between `brightness_min` and `brightness_max` on logarithm of the ambient light.
+ */
+typedef struct {
+    bsp_display_lux_get_t lux_get;  /*!< Ambient light reading, called from the backlight task */
+    void *lux_ctx;                  /*!< Passed to lux_get */
+    uint32_t period_ms;             /*!< Sampling period, e.g. 1000 ms */
+    float lux_min;                  /*!< Ambient light [lx] with brightness_min, must be > 0 */
+    float lux_max;                  /*!< Ambient light [lx] with brightness_max */
+    int brightness_min;             /*!< Brightness [%] in the dark */
+    int brightness_max;             /*!< Brightness [%] in bright light */
+} bsp_display_brightness_auto_cfg_t;
+
 /**
  * @brief Set display's brightness
  *
  * Brightness is controlled with PWM signal to a pin controlling backlight.
  * Brightness must be already initialized by calling bsp_display_brightness_init() or bsp_display_new()
  *
+ * The request is applied asynchronously by the backlight task with LEDC hardware fade
+ * (CONFIG_BSP_DISPLAY_BRIGHTNESS_FADE_MS for full range). Requests coming during a fade are coalesced,
+ * only the latest one is applied, so the function can be called on every slider event.
+ * Automatic brightness is stopped.
+ *
  * @param[in] brightness_percent Brightness in [%]
  * @return
  *      - ESP_OK                On success
- *      - ESP_ERR_INVALID_ARG   Parameter error
+ *      - ESP_ERR_INVALID_STATE Brightness not initialized
  */
 esp_err_t bsp_display_brightness_set(int brightness_percent);
 
+/**
+ * @brief Start automatic brightness
+ *
+ * Ambient light is sampled every `period_ms` in the backlight task, filtered and brightness is faded
+ * to the new value when it changes by 2 % or more.
+ *
+ * \code{.c}
+ * const bsp_display_brightness_auto_cfg_t cfg = {
+ *     .lux_get = bh1750_get_data,
+ *     .lux_ctx = bh1750,
+ *     .period_ms = 1000,
+ *     .lux_min = 5,
+ *     .lux_max = 1000,
+ *     .brightness_min = 10,
+ *     .brightness_max = 100,
+ * };
+ * bsp_display_brightness_auto_start(&cfg);
+ * \endcode
+ *
+ * @param[in] cfg Configuration, copied
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Parameter error
+ *      - ESP_ERR_INVALID_STATE Brightness not initialized
+ */
+esp_err_t bsp_display_brightness_auto_start(const bsp_display_brightness_auto_cfg_t *cfg);
+
+/**
+ * @brief Stop automatic brightness, the current brightness is kept
+ *
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_STATE Brightness not initialized
+ */
+esp_err_t bsp_display_brightness_auto_stop(void);
+
 /**
  * @brief Turn on display backlight
  *
  * Brightness is controlled with PWM signal to a pin controlling backlight.
  * Brightness must be already initialized by calling bsp_display_brightness_init() or bsp_display_new()
  *
+ * Backlight is set to 100 % without fade, or automatic brightness is resumed if it is running.
+ *
  * @return
  *      - ESP_OK                On success
- *      - ESP_ERR_INVALID_ARG   Parameter error
+ *      - ESP_ERR_INVALID_STATE Brightness not initialized
  */
 esp_err_t bsp_display_backlight_on(void);
 
@@ -112,9 +202,11 @@ esp_err_t bsp_display_backlight_on(void);
  * Brightness is controlled with PWM signal to a pin controlling backlight.
  * Brightness must be already initialized by calling bsp_display_brightness_init() or bsp_display_new()
  *
+ * Backlight is turned off without fade, automatic brightness is paused until bsp_display_backlight_on().
+ *
  * @return
  *      - ESP_OK                On success
- *      - ESP_ERR_INVALID_ARG   Parameter error
+ *      - ESP_ERR_INVALID_STATE Brightness not initialized
  */
 esp_err_t bsp_display_backlight_off(void);
 
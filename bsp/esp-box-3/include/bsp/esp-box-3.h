@@ -15,6 +15,8 @@
 #include "driver/gpio.h"
 #include "driver/i2c.h"
 #include "driver/sdmmc_host.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
 #include "soc/usb_pins.h"
 #include "lvgl.h"
 #include "esp_lvgl_port.h"
@@ -195,6 +197,30 @@ esp_err_t bsp_audio_init(const i2s_std_config_t *i2s_config);
  */
 const audio_codec_data_if_t *bsp_audio_get_codec_itf(void);
 
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+/**
+ * @brief Count of I2S DMA buffers of the audio channels (`dma_desc_num` of i2s_stream_config_t)
+ */
+#if CONFIG_BSP_I2S_LOW_LATENCY
+#define BSP_I2S_DMA_DESC_NUM    (CONFIG_BSP_I2S_DMA_DESC_NUM)
+#else
+#define BSP_I2S_DMA_DESC_NUM    (6)
+#endif
+
+/**
+ * @brief Get I2S channels (initialized in bsp_audio_init)
+ *
+ * The channels can be streamed by their DMA buffers with i2s_stream component, instead of esp_codec_dev_read/write.
+ *
+ * @param[out] tx_channel I2S TX channel (speaker), can be NULL
+ * @param[out] rx_channel I2S RX channel (microphone), can be NULL
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_STATE Audio is not initialized
+ */
+esp_err_t bsp_audio_get_i2s_channels(i2s_chan_handle_t *tx_channel, i2s_chan_handle_t *rx_channel);
+#endif
+
 /**
  * @brief Initialize speaker codec device
  *
@@ -209,6 +235,14 @@ esp_codec_dev_handle_t bsp_audio_codec_speaker_init(void);
  */
 esp_codec_dev_handle_t bsp_audio_codec_microphone_init(void);
 
+/**
+ * @brief Channel order of the bsp_audio_codec_microphone_init() capture for esp-sr AFE (`input_format`)
+ *
+ * Frames read from the microphone codec opened with 2 channels can be fed to the AFE without reordering
+ * (e.g. by the afe_feed component). The playback reference (ES7210 MIC3) is not captured in I2S standard mode.
+ */
+#define BSP_AFE_INPUT_FORMAT    "MM"
+
 /**************************************************************************************************
  *
  * I2C interface
@@ -302,9 +336,73 @@ esp_err_t bsp_spiffs_unmount(void);
 #define BSP_SD_MOUNT_POINT      CONFIG_BSP_SD_MOUNT_POINT
 extern sdmmc_card_t *bsp_sdcard;
 
+/**
+ * @brief SD card bus speed
+ */
+typedef enum {
+    BSP_SD_SPEED_DEFAULT = 0,   /*!< Default speed, 20 MHz */
+    BSP_SD_SPEED_HIGH,          /*!< High speed, 40 MHz. Card falls back to default speed if it doesn't support it */
+    BSP_SD_SPEED_UHS_SDR50,     /*!< UHS-I SDR50, not supported by ESP32-S3-BOX-3 (3.3 V signaling only) */
+} bsp_sdcard_speed_t;
+
+/**
+ * @brief SD card configuration
+ */
+typedef struct {
+    bsp_sdcard_speed_t speed;       /*!< Requested bus speed */
+    bool format_if_mount_failed;    /*!< Format the card (FAT) if there is no filesystem */
+    int max_files;                  /*!< Maximum count of open files */
+    size_t allocation_unit_size;    /*!< Cluster size used for formatting [bytes], 0 to choose it from card size */
+    size_t throughput_test_size;    /*!< Measure sequential read and write after mount with file of this size [bytes], 0 to skip */
+} bsp_sdcard_cfg_t;
+
+/**
+ * @brief Measured SD card throughput
+ */
+typedef struct {
+    float write_mbps;               /*!< Sequential write [MB/s] */
+    float read_mbps;                /*!< Sequential read [MB/s] */
+} bsp_sdcard_throughput_t;
+
+/**
+ * @brief Mount microSD card to virtual file system with configuration
+ *
+ * @note Large files are read faster with FATFS fast seek, enable CONFIG_FATFS_USE_FASTSEEK
+ *       (files opened for reading only).
+ *
+ * @param[in] cfg SD card configuration
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if cfg is NULL
+ *      - ESP_ERR_NOT_SUPPORTED if the speed is not supported by the board
+ *      - ESP_ERR_INVALID_STATE if esp_vfs_fat_sdmmc_mount was already called
+ *      - ESP_ERR_NO_MEM if memory can not be allocated
+ *      - ESP_FAIL if partition can not be mounted
+ *      - other error codes from SDMMC or SPI drivers, SDMMC protocol, or FATFS drivers
+ */
+esp_err_t bsp_sdcard_mount_with_config(const bsp_sdcard_cfg_t *cfg);
+
+/**
+ * @brief Measure sequential write and read throughput of mounted SD card
+ *
+ * A temporary file is written, read back and deleted.
+ *
+ * @param[in] test_size Size of the test file [bytes]
+ * @param[out] result Measured throughput
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if result is NULL or test_size is 0
+ *      - ESP_ERR_INVALID_STATE if the SD card is not mounted
+ *      - ESP_ERR_NO_MEM if memory can not be allocated
+ *      - ESP_FAIL if the file can not be written or read
+ */
+esp_err_t bsp_sdcard_measure_throughput(size_t test_size, bsp_sdcard_throughput_t *result);
+
 /**
  * @brief Mount microSD card to virtual file system
  *
+ * Default speed and configuration from menuconfig are used.
+ *
  * @return
  *      - ESP_OK on success
  *      - ESP_ERR_INVALID_STATE if esp_vfs_fat_sdmmc_mount was already called
@@ -314,6 +412,77 @@ extern sdmmc_card_t *bsp_sdcard;
  */
 esp_err_t bsp_sdcard_mount(void);
 
+/**
+ * @brief Mount point of the SD card read-ahead cache
+ */
+#define BSP_SD_CACHE_MOUNT_POINT    CONFIG_BSP_SD_CACHE_MOUNT_POINT
+
+/**
+ * @brief SD card read-ahead cache configuration
+ */
+typedef struct {
+    size_t window_max;              /*!< Maximum read-ahead of one file, multiple of 512 [bytes] (0: 64 kB) */
+    int max_files;                  /*!< Maximum count of files open through the cache (0: 4) */
+    uint32_t caps;                  /*!< Memory of the read-ahead windows (0: MALLOC_CAP_SPIRAM, internal RAM without PSRAM) */
+} bsp_sdcard_cache_cfg_t;
+
+/**
+ * @brief SD card read-ahead cache statistics
+ */
+typedef struct {
+    uint32_t reads;                 /*!< Reads of cached files by the application */
+    uint32_t hits;                  /*!< Reads served from the read-ahead window only */
+    uint32_t card_reads;            /*!< Read-ahead reads from the card */
+    uint64_t read_bytes;            /*!< Bytes read by the application from cached files */
+    uint64_t card_bytes;            /*!< Bytes read ahead from the card */
+    uint64_t bypass_bytes;          /*!< Bytes of large reads passed to the application buffer directly */
+} bsp_sdcard_cache_stats_t;
+
+/**
+ * @brief Register read-ahead cache of the mounted SD card to virtual file system
+ *
+ * Files of the SD card are available also at BSP_SD_CACHE_MOUNT_POINT. Files opened there for reading only are read
+ * ahead in large reads, so small sequential `fread` calls (media players, image decoders, file browser) do not cost
+ * one SD command each. The read-ahead window grows up to `window_max` while the file is read sequentially and it
+ * drops to 4 kB after a seek. Files opened for writing and directories are passed to the SD card without caching.
+ *
+ * \code{.c}
+ * ESP_ERROR_CHECK(bsp_sdcard_mount());
+ * ESP_ERROR_CHECK(bsp_sdcard_cache_register(NULL));
+ * FILE *f = fopen(BSP_SD_CACHE_MOUNT_POINT"/music.wav", "rb");
+ * \endcode
+ *
+ * @note Do not write a file through BSP_SD_MOUNT_POINT while it is open for reading through the cache.
+ *
+ * @param[in] cfg Cache configuration (NULL: default configuration)
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if the window size is not valid
+ *      - ESP_ERR_INVALID_STATE if the SD card is not mounted or the cache is already registered
+ *      - ESP_ERR_NO_MEM if memory can not be allocated
+ *      - other error codes from esp_vfs_register
+ */
+esp_err_t bsp_sdcard_cache_register(const bsp_sdcard_cache_cfg_t *cfg);
+
+/**
+ * @brief Unregister read-ahead cache of the SD card
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_STATE if the cache is not registered or some file is still open through it
+ */
+esp_err_t bsp_sdcard_cache_unregister(void);
+
+/**
+ * @brief Get statistics of SD card read-ahead cache
+ *
+ * Hit rate is `hits / reads`, commands saved by the cache are roughly `reads - card_reads`.
+ *
+ * @param[out] stats Statistics (NULL: only reset)
+ * @param[in] reset  Reset the statistics after reading
+ */
+void bsp_sdcard_cache_get_stats(bsp_sdcard_cache_stats_t *stats, bool reset);
+
 /**
  * @brief Unmount micorSD card from virtual file system
  *
@@ -393,6 +562,7 @@ void bsp_display_unlock(void);
  * @brief Set display enter sleep mode
  *
  * All the display (LCD, backlight, touch) will enter sleep mode.
+ * LVGL stops refreshing, the frame in the panel memory and the draw buffers are kept for fast resume.
  *
  * @return
  *      - ESP_OK on success
@@ -404,6 +574,7 @@ esp_err_t bsp_display_enter_sleep(void);
  * @brief Set display exit sleep mode
  *
  * All the display (LCD, backlight, touch) will exit sleep mode.
+ * The frame retained from sleep is visible at once, LVGL redraws only areas invalidated during sleep.
  *
  * @return
  *      - ESP_OK on success
@@ -411,6 +582,13 @@ esp_err_t bsp_display_enter_sleep(void);
  */
 esp_err_t bsp_display_exit_sleep(void);
 
+/**
+ * @brief Get duration of the last bsp_display_exit_sleep()
+ *
+ * @return Time from the wake request to the restored display and touch [us], 0 if the display hasn't resumed yet
+ */
+uint32_t bsp_display_get_resume_time_us(void);
+
 /**
  * @brief Rotate screen
  *
@@ -448,6 +626,199 @@ void bsp_display_rotate(lv_display_t *disp, lv_disp_rotation_t rotation);
  */
 esp_err_t bsp_iot_button_create(button_handle_t btn_array[], int *btn_cnt, int btn_array_size);
 
+/**************************************************************************************************
+ *
+ * Power management
+ *
+ * With dynamic frequency scaling, the CPU runs at CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ only while a driver
+ * or the LVGL port holds a power management lock:
+ * - LVGL task while rendering and display flushes (bsp_display_start() enables `pm_lock` of the LVGL port)
+ * - I2S channels while the audio codec device is open (esp_codec_dev_open() / esp_codec_dev_close())
+ * - I2C and SPI drivers during transactions
+ *
+ * Close the audio codec devices, when no audio is streamed, to release the I2S lock.
+ **************************************************************************************************/
+
+/**
+ * @brief Enable dynamic frequency scaling and optionally automatic light-sleep
+ *
+ * @note Needs CONFIG_PM_ENABLE, light-sleep needs CONFIG_FREERTOS_USE_TICKLESS_IDLE too
+ * @note Touch is read by the LVGL input device timer, so the chip is woken up at least every LVGL refresh period while the touch is used
+ *
+ * @param light_sleep Enter light-sleep, when all tasks wait
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_NOT_SUPPORTED if power management or light-sleep is not enabled in menuconfig
+ */
+esp_err_t bsp_pm_enable(bool light_sleep);
+
+/**************************************************************************************************
+ *
+ * Parallel board initialization
+ *
+ * Subsystems are initialized by worker tasks, so waits of one subsystem (LCD reset and sleep out,
+ * codec power up, SD card identification) overlap with the others. Subsystems sharing a bus or peripheral
+ * are ordered: display and audio start after I2C, microphone after speaker (shared I2S). I2C is always initialized,
+ * when display, speaker or microphone is requested.
+ *
+ * \code{.c}
+ * EventGroupHandle_t init_done = bsp_init_async(BSP_INIT_MASK_ALL);
+ * // ... application work
+ * ESP_ERROR_CHECK(bsp_init_wait(BSP_INIT_BIT(BSP_INIT_DISPLAY), 2000));
+ * \endcode
+ **************************************************************************************************/
+
+/**
+ * @brief Subsystems initialized by bsp_init_async()
+ */
+typedef enum {
+    BSP_INIT_I2C = 0,       /*!< bsp_i2c_init() */
+    BSP_INIT_DISPLAY,       /*!< bsp_display_start(), handle is lv_display_t * */
+    BSP_INIT_SPEAKER,       /*!< bsp_audio_codec_speaker_init(), handle is esp_codec_dev_handle_t */
+    BSP_INIT_MICROPHONE,    /*!< bsp_audio_codec_microphone_init(), handle is esp_codec_dev_handle_t */
+    BSP_INIT_SDCARD,        /*!< bsp_sdcard_mount() */
+    BSP_INIT_SPIFFS,        /*!< bsp_spiffs_mount() */
+    BSP_INIT_NUM,
+} bsp_init_subsystem_t;
+
+/**
+ * @brief Event group bit of a subsystem, set when its initialization finished (successfully or not)
+ */
+#define BSP_INIT_BIT(subsystem)     (1U << (subsystem))
+#define BSP_INIT_MASK_ALL           (BSP_INIT_BIT(BSP_INIT_NUM) - 1)
+
+/**
+ * @brief Result of subsystem initialization
+ */
+typedef struct {
+    esp_err_t ret;          /*!< Result of the initialization */
+    uint32_t start_us;      /*!< Start of the initialization, from bsp_init_async() call [us] */
+    uint32_t duration_us;   /*!< Duration of the initialization [us] */
+    void *handle;           /*!< Handle created by the subsystem (see bsp_init_subsystem_t), NULL otherwise */
+} bsp_init_result_t;
+
+/**
+ * @brief Start parallel initialization of subsystems
+ *
+ * @param[in] mask Subsystems to initialize, combination of BSP_INIT_BIT()
+ * @return Event group with bits of finished subsystems, NULL if initialization is already running or on error
+ */
+EventGroupHandle_t bsp_init_async(uint32_t mask);
+
+/**
+ * @brief Wait for subsystems started by bsp_init_async()
+ *
+ * @param[in] mask Subsystems to wait for, combination of BSP_INIT_BIT()
+ * @param[in] timeout_ms Timeout in [ms]
+ * @return
+ *      - ESP_OK if all subsystems were initialized successfully
+ *      - ESP_ERR_TIMEOUT if a subsystem is not finished in time
+ *      - ESP_ERR_INVALID_STATE if bsp_init_async() was not called
+ *      - error of the first failed subsystem
+ */
+esp_err_t bsp_init_wait(uint32_t mask, uint32_t timeout_ms);
+
+/**
+ * @brief Get result and duration of subsystem initialization
+ *
+ * @param[in] subsystem Subsystem
+ * @param[out] result Result of the finished initialization
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if parameter error
+ *      - ESP_ERR_INVALID_STATE if the subsystem was not initialized by bsp_init_async() or is not finished
+ */
+esp_err_t bsp_init_get_result(bsp_init_subsystem_t subsystem, bsp_init_result_t *result);
+
+/**************************************************************************************************
+ *
+ * Task scheduling profile
+ *
+ * Core, priority and stack of tasks are set per task class in menuconfig (Task scheduling), by default
+ * UI on core 1, audio and sensors on core 0, so latency-critical audio does not share the core with rendering.
+ * The BSP creates LVGL and backlight tasks with the UI profile. Tasks of components and the application
+ * get the profile from BSP_TASK_PROFILE_APPLY() or bsp_task_create().
+ *
+ * \code{.c}
+ * audio_duplex_config_t duplex_cfg = AUDIO_DUPLEX_CONFIG_DEFAULT();
+ * BSP_TASK_PROFILE_APPLY(duplex_cfg, BSP_TASK_AUDIO);
+ *
+ * sensor_hub_config_t hub_cfg = SENSOR_HUB_CONFIG_DEFAULT();
+ * BSP_TASK_PROFILE_APPLY(hub_cfg, BSP_TASK_SENSORS);
+ * \endcode
+ **************************************************************************************************/
+
+/**
+ * @brief Task classes
+ */
+typedef enum {
+    BSP_TASK_UI = 0,        /*!< LVGL and display tasks */
+    BSP_TASK_AUDIO,         /*!< Audio streaming, mixing and processing */
+    BSP_TASK_SENSORS,       /*!< Sensor sampling */
+    BSP_TASK_CLASS_NUM,
+} bsp_task_class_t;
+
+/**
+ * @brief Scheduling profile of a task class
+ */
+typedef struct {
+    int priority;           /*!< Task priority */
+    int stack;              /*!< Task stack size [bytes] */
+    int affinity;           /*!< Core of the task (-1 for no affinity) */
+} bsp_task_profile_t;
+
+/**
+ * @brief Set `task_priority`, `task_stack` and `task_affinity` of a component configuration by the task class
+ *
+ * Works with configurations of LVGL port, audio duplex, audio mixer, WAV player, sensor hub, IO expander, etc.
+ */
+#define BSP_TASK_PROFILE_APPLY(cfg, task_class) \
+    do { \
+        const bsp_task_profile_t *_profile = bsp_task_profile_get(task_class); \
+        (cfg).task_priority = _profile->priority; \
+        (cfg).task_stack = _profile->stack; \
+        (cfg).task_affinity = _profile->affinity; \
+    } while (0)
+
+/**
+ * @brief Get scheduling profile of a task class
+ *
+ * @param[in] task_class Task class
+ * @return Profile of the class (UI profile for invalid class)
+ */
+const bsp_task_profile_t *bsp_task_profile_get(bsp_task_class_t task_class);
+
+/**
+ * @brief Create task with scheduling profile of its class
+ *
+ * @param[in]  task       Task function
+ * @param[in]  name       Task name
+ * @param[in]  arg        Task argument
+ * @param[in]  task_class Task class
+ * @param[out] ret_task   Created task (can be NULL)
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if parameter error
+ *      - ESP_ERR_NO_MEM if the task can't be created
+ */
+esp_err_t bsp_task_create(TaskFunction_t task, const char *name, void *arg, bsp_task_class_t task_class, TaskHandle_t *ret_task);
+
+/**
+ * @brief Print CPU usage of all tasks per core in a time window
+ *
+ * Blocks the calling task for the window.
+ *
+ * @note Needs CONFIG_FREERTOS_USE_TRACE_FACILITY and CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+ *
+ * @param[in] window_ms Measured time window [ms]
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_NO_MEM if there is not enough memory for task lists
+ *      - ESP_ERR_INVALID_STATE if tasks were created or deleted in the window
+ *      - ESP_ERR_NOT_SUPPORTED if run time statistics are not enabled in menuconfig
+ */
+esp_err_t bsp_task_usage_print(uint32_t window_ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -219,6 +219,16 @@ static lv_display_t *bsp_display_lcd_init(const bsp_display_cfg_t *cfg)
         .panel_handle = panel_handle,
         .buffer_size = cfg->buffer_size,
         .double_buffer = cfg->double_buffer,
+#if CONFIG_BSP_LCD_LOW_RAM && LVGL_VERSION_MAJOR >= 9
+        /* Small strips are sent through a ring of transport buffers from the flush task */
+        .trans_size = BSP_LCD_H_RES * CONFIG_BSP_LCD_TRANS_BUF_HEIGHT,
+        .trans_count = 3,
+        .merge_overhead = BSP_LCD_H_RES * 8,
+        .flush_task = {
+            .task_priority = 4,
+            .task_affinity = -1,
+        },
+#endif
         .hres = BSP_LCD_H_RES,
         .vres = BSP_LCD_V_RES,
         .monochrome = false,
@@ -233,6 +243,9 @@ static lv_display_t *bsp_display_lcd_init(const bsp_display_cfg_t *cfg)
             .buff_spiram = cfg->flags.buff_spiram,
 #if LVGL_VERSION_MAJOR >= 9
             .swap_bytes = (BSP_LCD_BIGENDIAN ? true : false),
+#if CONFIG_BSP_LCD_LOW_RAM
+            .flush_in_task = true,
+#endif
 #endif
         }
     };
@@ -336,7 +349,7 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
         .lcd_cmd_bits = LCD_CMD_BITS,
         .lcd_param_bits = LCD_PARAM_BITS,
         .spi_mode = 0,
-        .trans_queue_depth = 10,
+        .trans_queue_depth = (config->trans_queue_depth > 0) ? config->trans_queue_depth : 10,
     };
     ESP_GOTO_ON_ERROR(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)BSP_LCD_SPI_NUM, &io_config, ret_io), err, TAG, "New panel IO failed");
 
@@ -376,13 +389,18 @@ lv_display_t *bsp_display_start(void)
     bsp_display_cfg_t cfg = {
         .lvgl_port_cfg = ESP_LVGL_PORT_INIT_CONFIG(),
         .buffer_size = BSP_LCD_H_RES * CONFIG_BSP_LCD_DRAW_BUF_HEIGHT,
-#if CONFIG_BSP_LCD_DRAW_BUF_DOUBLE
+#if CONFIG_BSP_LCD_DRAW_BUF_DOUBLE || CONFIG_BSP_LCD_LOW_RAM
         .double_buffer = 1,
 #else
         .double_buffer = 0,
 #endif
         .flags = {
+#if CONFIG_BSP_LCD_LOW_RAM
+            /* Data are sent from transport buffers */
+            .buff_dma = false,
+#else
             .buff_dma = true,
+#endif
             .buff_spiram = false,
         }
     };
@@ -4,6 +4,10 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/param.h>
 #include "sdkconfig.h"
 #include "driver/gpio.h"
 #include "driver/ledc.h"
@@ -17,6 +21,20 @@
 #include "esp_vfs_fat.h"
 #include "usb/usb_host.h"
 #include "sd_pwr_ctrl_by_on_chip_ldo.h"
+#include "esp_heap_caps.h"
+#include "esp_cache.h"
+#include "esp_timer.h"
+#include "freertos/queue.h"
+#include "driver/ppa.h"
+#include "driver/isp.h"
+#include "esp_cam_ctlr.h"
+#include "esp_cam_ctlr_csi.h"
+#include "esp_cam_sensor.h"
+#include "esp_cam_sensor_detect.h"
+#include "esp_sccb_intf.h"
+#include "esp_sccb_i2c.h"
+#include "driver/jpeg_encode.h"
+#include "avi_recorder.h"
 
 
 #if CONFIG_BSP_LCD_TYPE_1024_600
@@ -39,6 +57,7 @@ static lv_indev_t *disp_indev = NULL;
 
 sdmmc_card_t *bsp_sdcard = NULL;    // Global uSD card handler
 static bool i2c_initialized = false;
+static i2c_master_bus_handle_t i2c_handle = NULL;
 static TaskHandle_t usb_host_task;  // USB Host Library task
 
 esp_err_t bsp_i2c_init(void)
@@ -48,16 +67,16 @@ esp_err_t bsp_i2c_init(void)
         return ESP_OK;
     }
 
-    const i2c_config_t i2c_conf = {
-        .mode = I2C_MODE_MASTER,
+    /* New I2C driver, the camera sensor (SCCB) and touch share the bus */
+    const i2c_master_bus_config_t i2c_bus_conf = {
+        .clk_source = I2C_CLK_SRC_DEFAULT,
         .sda_io_num = BSP_I2C_SDA,
-        .sda_pullup_en = GPIO_PULLUP_DISABLE,
         .scl_io_num = BSP_I2C_SCL,
-        .scl_pullup_en = GPIO_PULLUP_DISABLE,
-        .master.clk_speed = CONFIG_BSP_I2C_CLK_SPEED_HZ
+        .i2c_port = BSP_I2C_NUM,
+        .glitch_ignore_cnt = 7,
+        .flags.enable_internal_pullup = false,
     };
-    BSP_ERROR_CHECK_RETURN_ERR(i2c_param_config(BSP_I2C_NUM, &i2c_conf));
-    BSP_ERROR_CHECK_RETURN_ERR(i2c_driver_install(BSP_I2C_NUM, i2c_conf.mode, 0, 0, 0));
+    BSP_ERROR_CHECK_RETURN_ERR(i2c_new_master_bus(&i2c_bus_conf, &i2c_handle));
 
     i2c_initialized = true;
 
@@ -66,11 +85,17 @@ esp_err_t bsp_i2c_init(void)
 
 esp_err_t bsp_i2c_deinit(void)
 {
-    BSP_ERROR_CHECK_RETURN_ERR(i2c_driver_delete(BSP_I2C_NUM));
+    BSP_ERROR_CHECK_RETURN_ERR(i2c_del_master_bus(i2c_handle));
+    i2c_handle = NULL;
     i2c_initialized = false;
     return ESP_OK;
 }
 
+i2c_master_bus_handle_t bsp_i2c_get_handle(void)
+{
+    return i2c_handle;
+}
+
 esp_err_t bsp_sdcard_mount(void)
 {
     const esp_vfs_fat_sdmmc_mount_config_t mount_config = {
@@ -158,6 +183,9 @@ esp_err_t bsp_spiffs_unmount(void)
 // Bit number used to represent command and parameter
 #define LCD_LEDC_CH            CONFIG_BSP_DISPLAY_BRIGHTNESS_LEDC_CH
 
+/* DPI frame buffer is RGB888, also when LVGL renders RGB565 and PPA converts it */
+#define BSP_LCD_FB_RGB888      (CONFIG_BSP_LCD_COLOR_FORMAT_RGB888 || CONFIG_BSP_LCD_COLOR_FORMAT_RGB565_FB_RGB888)
+
 esp_err_t bsp_display_brightness_init(void)
 {
     // Setup LEDC peripheral for PWM backlight control
@@ -213,7 +241,11 @@ static esp_err_t bsp_enable_dsi_phy_power(void)
 {
 #if BSP_MIPI_DSI_PHY_PWR_LDO_CHAN > 0
     // Turn on the power for MIPI DSI PHY, so it can go from "No Power" state to "Shutdown" state
+    // The same LDO powers MIPI CSI PHY of the camera, it is acquired only once
     static esp_ldo_channel_handle_t phy_pwr_chan = NULL;
+    if (phy_pwr_chan) {
+        return ESP_OK;
+    }
     esp_ldo_channel_config_t ldo_cfg = {
         .chan_id = BSP_MIPI_DSI_PHY_PWR_LDO_CHAN,
         .voltage_mv = BSP_MIPI_DSI_PHY_PWR_LDO_VOLTAGE_MV,
@@ -270,10 +302,14 @@ esp_err_t bsp_display_new_with_handles(const bsp_display_config_t *config, bsp_l
     // create EK79007 control panel
     ESP_LOGI(TAG, "Install EK79007 LCD control panel");
 
-#if CONFIG_BSP_LCD_COLOR_FORMAT_RGB888
-    const esp_lcd_dpi_panel_config_t dpi_config = EK79007_1024_600_PANEL_60HZ_CONFIG(LCD_COLOR_PIXEL_FORMAT_RGB888);
+#if BSP_LCD_FB_RGB888
+    esp_lcd_dpi_panel_config_t dpi_config = EK79007_1024_600_PANEL_60HZ_CONFIG(LCD_COLOR_PIXEL_FORMAT_RGB888);
 #else
-    const esp_lcd_dpi_panel_config_t dpi_config = EK79007_1024_600_PANEL_60HZ_CONFIG(LCD_COLOR_PIXEL_FORMAT_RGB565);
+    esp_lcd_dpi_panel_config_t dpi_config = EK79007_1024_600_PANEL_60HZ_CONFIG(LCD_COLOR_PIXEL_FORMAT_RGB565);
+#endif
+#if CONFIG_BSP_LCD_DPI_LOW_REFRESH
+    /* Panel without frame memory, lower refresh rate saves PSRAM bandwidth */
+    dpi_config.dpi_clock_freq_mhz /= 2;
 #endif
     ek79007_vendor_config_t vendor_config = {
         .flags = {
@@ -319,7 +355,7 @@ esp_err_t bsp_display_new_with_handles(const bsp_display_config_t *config, bsp_l
         .virtual_channel = 0,
         .dpi_clk_src = MIPI_DSI_DPI_CLK_SRC_DEFAULT,
         .dpi_clock_freq_mhz = BSP_LCD_PIXEL_CLOCK_MHZ,
-#if CONFIG_BSP_LCD_COLOR_FORMAT_RGB888
+#if BSP_LCD_FB_RGB888
         .pixel_format = LCD_COLOR_PIXEL_FORMAT_RGB888,
 #else
         .pixel_format = LCD_COLOR_PIXEL_FORMAT_RGB565,
@@ -393,8 +429,9 @@ esp_err_t bsp_touch_new(const bsp_touch_config_t *config, esp_lcd_touch_handle_t
         },
     };
     esp_lcd_panel_io_handle_t tp_io_handle = NULL;
-    const esp_lcd_panel_io_i2c_config_t tp_io_config = ESP_LCD_TOUCH_IO_I2C_GT911_CONFIG();
-    ESP_RETURN_ON_ERROR(esp_lcd_new_panel_io_i2c((esp_lcd_i2c_bus_handle_t)BSP_I2C_NUM, &tp_io_config, &tp_io_handle), TAG, "");
+    esp_lcd_panel_io_i2c_config_t tp_io_config = ESP_LCD_TOUCH_IO_I2C_GT911_CONFIG();
+    tp_io_config.scl_speed_hz = CONFIG_BSP_I2C_CLK_SPEED_HZ;
+    ESP_RETURN_ON_ERROR(esp_lcd_new_panel_io_i2c(i2c_handle, &tp_io_config, &tp_io_handle), TAG, "");
     return esp_lcd_touch_new_i2c_gt911(tp_io_handle, &tp_cfg, ret_touch);
 }
 
@@ -439,7 +476,15 @@ static lv_display_t *bsp_display_lcd_init(const bsp_display_cfg_t *cfg)
         }
     };
 
+#if CONFIG_BSP_LCD_COLOR_FORMAT_RGB565_FB_RGB888 && LVGL_VERSION_MAJOR >= 9
+    /* LVGL renders RGB565, PPA converts flushed areas into RGB888 frame buffer */
+    const lvgl_port_display_dsi_cfg_t dsi_cfg = {
+        .flags.fb_rgb888 = true,
+    };
+    return lvgl_port_add_disp_dsi(&disp_cfg, &dsi_cfg);
+#else
     return lvgl_port_add_disp_dsi(&disp_cfg, NULL);
+#endif
 }
 
 static lv_indev_t *bsp_display_indev_init(lv_display_t *disp)
@@ -489,6 +534,15 @@ lv_display_t *bsp_display_start_with_config(const bsp_display_cfg_t *cfg)
 
     BSP_NULL_CHECK(disp_indev = bsp_display_indev_init(disp), NULL);
 
+#if CONFIG_BSP_DISPLAY_LVGL_PPA_DRAW && LVGL_VERSION_MAJOR >= 9
+    if (lvgl_port_lock(0)) {
+        if (lvgl_port_ppa_draw_init(NULL) != ESP_OK) {
+            ESP_LOGW(TAG, "PPA draw unit not added, LVGL draws by CPU");
+        }
+        lvgl_port_unlock();
+    }
+#endif
+
     return disp;
 }
 
@@ -514,6 +568,505 @@ void bsp_display_unlock(void)
 
 #endif // (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
 
+/**************************************************************************************************
+ *
+ * Camera
+ *
+ **************************************************************************************************/
+
+typedef struct {
+    bsp_camera_frame_t      frames[BSP_CAMERA_FB_COUNT_MAX];
+    uint32_t                fb_count;
+    QueueHandle_t           free_queue;     /* Frames for the CSI controller */
+    QueueHandle_t           ready_queue;    /* Received frames for the application */
+    esp_sccb_io_handle_t    sccb;
+    esp_cam_sensor_device_t *sensor;
+    isp_proc_handle_t       isp;
+    esp_cam_ctlr_handle_t   csi;
+    ppa_client_handle_t     ppa;
+    volatile uint32_t       frame_cnt;
+    volatile uint32_t       drop_cnt;
+    uint32_t                scale_cnt;
+    uint64_t                scale_time_us;
+    uint32_t                stats_frame_cnt;    /* Counters at the previous statistics read */
+    uint32_t                stats_scale_cnt;
+    uint64_t                stats_scale_time_us;
+    int64_t                 stats_time_us;
+} bsp_camera_t;
+
+static bsp_camera_t *camera = NULL;
+
+/* Recording: frames are encoded by the HW JPEG encoder in the caller, the AVI recorder writes them from PSRAM ring */
+#define BSP_CAMERA_REC_QUALITY      (80)
+#define BSP_CAMERA_REC_BUFFER_SIZE  (2 * 1024 * 1024)
+#define BSP_CAMERA_REC_BLOCK_SIZE   (32 * 1024)
+#define BSP_CAMERA_REC_MAX_FRAMES   (36000)
+
+typedef struct {
+    avi_recorder_handle_t   avi;
+    jpeg_encoder_handle_t   jpeg;
+    jpeg_encode_cfg_t       enc_cfg;
+    uint8_t                 *out_buf;       /* Encoded frame (DMA capable) */
+    size_t                  out_size;
+    int64_t                 period_us;      /* Frame period of the recording (0: all frames are recorded) */
+    int64_t                 next_us;        /* Timestamp of the next recorded frame */
+    uint64_t                encode_time_us;
+    uint64_t                jpeg_bytes;
+    uint32_t                encode_cnt;
+    uint32_t                skip_cnt;
+} bsp_camera_rec_t;
+
+static bsp_camera_rec_t *camera_rec = NULL;
+static bsp_camera_record_stats_t camera_rec_stats;  /* Statistics of the last finished recording */
+static bool camera_rec_used = false;
+
+static bool bsp_camera_on_get_new_trans(esp_cam_ctlr_handle_t handle, esp_cam_ctlr_trans_t *trans, void *user_data)
+{
+    bsp_camera_t *cam = (bsp_camera_t *)user_data;
+    bsp_camera_frame_t *frame = NULL;
+    BaseType_t need_yield = pdFALSE;
+
+    if (xQueueReceiveFromISR(cam->free_queue, &frame, &need_yield) != pdTRUE) {
+        /* The application is slower than the sensor, the oldest received frame is overwritten */
+        if (xQueueReceiveFromISR(cam->ready_queue, &frame, &need_yield) != pdTRUE) {
+            /* All frames are held by the application, the driver receives into its backup buffer */
+            return need_yield == pdTRUE;
+        }
+        cam->drop_cnt++;
+    }
+    trans->buffer = frame->buf;
+    trans->buflen = frame->len;
+    return need_yield == pdTRUE;
+}
+
+static bool bsp_camera_on_trans_finished(esp_cam_ctlr_handle_t handle, esp_cam_ctlr_trans_t *trans, void *user_data)
+{
+    bsp_camera_t *cam = (bsp_camera_t *)user_data;
+    BaseType_t need_yield = pdFALSE;
+
+    for (uint32_t i = 0; i < cam->fb_count; i++) {
+        bsp_camera_frame_t *frame = &cam->frames[i];
+        if (frame->buf == trans->buffer) {
+            frame->timestamp_us = esp_timer_get_time();
+            cam->frame_cnt++;
+            xQueueSendFromISR(cam->ready_queue, &frame, &need_yield);
+            return need_yield == pdTRUE;
+        }
+    }
+    /* Frame in the backup buffer of the driver */
+    cam->drop_cnt++;
+    return false;
+}
+
+static esp_err_t bsp_camera_sensor_init(bsp_camera_t *cam, const char *format_name, esp_cam_sensor_format_t *ret_format)
+{
+    /* Detect the sensor by SCCB address of the registered sensor drivers */
+    for (esp_cam_sensor_detect_fn_t *p = &__esp_cam_sensor_detect_fn_array_start; p < &__esp_cam_sensor_detect_fn_array_end; ++p) {
+        if (p->port != ESP_CAM_SENSOR_MIPI_CSI) {
+            continue;
+        }
+        const sccb_i2c_config_t sccb_cfg = {
+            .scl_speed_hz = CONFIG_BSP_I2C_CLK_SPEED_HZ,
+            .device_address = p->sccb_addr,
+            .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        };
+        ESP_RETURN_ON_ERROR(sccb_new_i2c_io(i2c_handle, &sccb_cfg, &cam->sccb), TAG, "SCCB init failed");
+        esp_cam_sensor_config_t sensor_cfg = {
+            .sccb_handle = cam->sccb,
+            .reset_pin = -1,
+            .pwdn_pin = -1,
+            .xclk_pin = -1,
+            .sensor_port = ESP_CAM_SENSOR_MIPI_CSI,
+        };
+        cam->sensor = p->detect(&sensor_cfg);
+        if (cam->sensor) {
+            break;
+        }
+        esp_sccb_del_i2c_io(cam->sccb);
+        cam->sccb = NULL;
+    }
+    ESP_RETURN_ON_FALSE(cam->sensor, ESP_ERR_NOT_FOUND, TAG, "Camera sensor not detected");
+
+    if (format_name) {
+        esp_cam_sensor_format_array_t formats = {0};
+        ESP_RETURN_ON_ERROR(esp_cam_sensor_query_format(cam->sensor, &formats), TAG, "Query camera formats failed");
+        const esp_cam_sensor_format_t *format = NULL;
+        for (uint32_t i = 0; i < formats.count; i++) {
+            if (strcmp(formats.format_array[i].name, format_name) == 0) {
+                format = &formats.format_array[i];
+                break;
+            }
+        }
+        ESP_RETURN_ON_FALSE(format, ESP_ERR_NOT_FOUND, TAG, "Camera format %s not found", format_name);
+        ESP_RETURN_ON_ERROR(esp_cam_sensor_set_format(cam->sensor, format), TAG, "Set camera format failed");
+    }
+    ESP_RETURN_ON_ERROR(esp_cam_sensor_get_format(cam->sensor, ret_format), TAG, "Get camera format failed");
+    ESP_RETURN_ON_FALSE(ret_format->format == ESP_CAM_SENSOR_PIXFORMAT_RAW8 || ret_format->format == ESP_CAM_SENSOR_PIXFORMAT_RAW10,
+                        ESP_ERR_NOT_SUPPORTED, TAG, "Only RAW camera formats are supported");
+    ESP_LOGI(TAG, "Camera format %s (%"PRIu32"x%"PRIu32")", ret_format->name, (uint32_t)ret_format->width, (uint32_t)ret_format->height);
+    return ESP_OK;
+}
+
+static void bsp_camera_free(bsp_camera_t *cam)
+{
+    if (cam->csi) {
+        esp_cam_ctlr_stop(cam->csi);
+        esp_cam_ctlr_disable(cam->csi);
+        esp_cam_ctlr_del(cam->csi);
+    }
+    if (cam->isp) {
+        esp_isp_disable(cam->isp);
+        esp_isp_del_processor(cam->isp);
+    }
+    if (cam->sensor) {
+        int enable = 0;
+        esp_cam_sensor_ioctl(cam->sensor, ESP_CAM_SENSOR_IOC_S_STREAM, &enable);
+    }
+    if (cam->sccb) {
+        esp_sccb_del_i2c_io(cam->sccb);
+    }
+    if (cam->ppa) {
+        ppa_unregister_client(cam->ppa);
+    }
+    for (uint32_t i = 0; i < BSP_CAMERA_FB_COUNT_MAX; i++) {
+        free(cam->frames[i].buf);
+    }
+    if (cam->free_queue) {
+        vQueueDelete(cam->free_queue);
+    }
+    if (cam->ready_queue) {
+        vQueueDelete(cam->ready_queue);
+    }
+    free(cam);
+}
+
+esp_err_t bsp_camera_start(const bsp_camera_cfg_t *cfg)
+{
+    esp_err_t ret = ESP_OK;
+    const bsp_camera_cfg_t default_cfg = {0};
+    esp_cam_sensor_format_t format;
+    size_t align = 0;
+
+    ESP_RETURN_ON_FALSE(camera == NULL, ESP_ERR_INVALID_STATE, TAG, "Camera is already started");
+    if (cfg == NULL) {
+        cfg = &default_cfg;
+    }
+    const uint32_t fb_count = (cfg->fb_count ? cfg->fb_count : BSP_CAMERA_FB_COUNT_MIN);
+    ESP_RETURN_ON_FALSE(fb_count >= BSP_CAMERA_FB_COUNT_MIN && fb_count <= BSP_CAMERA_FB_COUNT_MAX, ESP_ERR_INVALID_ARG, TAG, "Invalid frame buffer count");
+
+    BSP_ERROR_CHECK_RETURN_ERR(bsp_i2c_init());
+    ESP_RETURN_ON_ERROR(bsp_enable_dsi_phy_power(), TAG, "MIPI PHY power failed");
+
+    bsp_camera_t *cam = calloc(1, sizeof(bsp_camera_t));
+    ESP_RETURN_ON_FALSE(cam, ESP_ERR_NO_MEM, TAG, "Not enough memory for camera");
+    cam->fb_count = fb_count;
+
+    ESP_GOTO_ON_ERROR(bsp_camera_sensor_init(cam, cfg->format, &format), err, TAG, "Camera sensor init failed");
+
+    /* Frame buffers in PSRAM, aligned to cache line for DMA of CSI and PPA */
+    const bool rgb888 = (cfg->color == BSP_CAMERA_COLOR_RGB888);
+    const size_t frame_size = format.width * format.height * (rgb888 ? 3 : 2);
+    ESP_GOTO_ON_ERROR(esp_cache_get_alignment(MALLOC_CAP_SPIRAM, &align), err, TAG, "Get cache alignment failed");
+    cam->free_queue = xQueueCreate(fb_count, sizeof(bsp_camera_frame_t *));
+    cam->ready_queue = xQueueCreate(fb_count, sizeof(bsp_camera_frame_t *));
+    ESP_GOTO_ON_FALSE(cam->free_queue && cam->ready_queue, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for camera queues");
+    for (uint32_t i = 0; i < fb_count; i++) {
+        bsp_camera_frame_t *frame = &cam->frames[i];
+        frame->buf = heap_caps_aligned_calloc(align, 1, frame_size, MALLOC_CAP_SPIRAM);
+        ESP_GOTO_ON_FALSE(frame->buf, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for camera frame buffers");
+        frame->len = frame_size;
+        frame->width = format.width;
+        frame->height = format.height;
+        frame->color = cfg->color;
+        xQueueSend(cam->free_queue, &frame, 0);
+    }
+
+    const ppa_client_config_t ppa_cfg = {
+        .oper_type = PPA_OPERATION_SRM,
+        .max_pending_trans_num = 1,
+    };
+    ESP_GOTO_ON_ERROR(ppa_register_client(&ppa_cfg, &cam->ppa), err, TAG, "PPA client register failed");
+
+    /* ISP converts RAW data from CSI to RGB */
+    const bool raw10 = (format.format == ESP_CAM_SENSOR_PIXFORMAT_RAW10);
+    const esp_isp_processor_cfg_t isp_cfg = {
+        .clk_hz = 80 * 1000 * 1000,
+        .input_data_source = ISP_INPUT_DATA_SOURCE_CSI,
+        .input_data_color_type = (raw10 ? ISP_COLOR_RAW10 : ISP_COLOR_RAW8),
+        .output_data_color_type = (rgb888 ? ISP_COLOR_RGB888 : ISP_COLOR_RGB565),
+        .has_line_start_packet = false,
+        .has_line_end_packet = false,
+        .h_res = format.width,
+        .v_res = format.height,
+    };
+    ESP_GOTO_ON_ERROR(esp_isp_new_processor(&isp_cfg, &cam->isp), err, TAG, "ISP init failed");
+    ESP_GOTO_ON_ERROR(esp_isp_enable(cam->isp), err, TAG, "ISP enable failed");
+
+    const esp_cam_ctlr_csi_config_t csi_cfg = {
+        .ctlr_id = 0,
+        .h_res = format.width,
+        .v_res = format.height,
+        .lane_bit_rate_mbps = format.mipi_info.mipi_clk / (1000 * 1000),
+        .input_data_color_type = (raw10 ? CAM_CTLR_COLOR_RAW10 : CAM_CTLR_COLOR_RAW8),
+        .output_data_color_type = (rgb888 ? CAM_CTLR_COLOR_RGB888 : CAM_CTLR_COLOR_RGB565),
+        .data_lane_num = format.mipi_info.lane_num,
+        .byte_swap_en = false,
+        .queue_items = 1,
+    };
+    ESP_GOTO_ON_ERROR(esp_cam_new_csi_ctlr(&csi_cfg, &cam->csi), err, TAG, "CSI init failed");
+    const esp_cam_ctlr_evt_cbs_t cbs = {
+        .on_get_new_trans = bsp_camera_on_get_new_trans,
+        .on_trans_finished = bsp_camera_on_trans_finished,
+    };
+    ESP_GOTO_ON_ERROR(esp_cam_ctlr_register_event_callbacks(cam->csi, &cbs, cam), err, TAG, "CSI callbacks failed");
+    ESP_GOTO_ON_ERROR(esp_cam_ctlr_enable(cam->csi), err, TAG, "CSI enable failed");
+
+    int enable = 1;
+    ESP_GOTO_ON_ERROR(esp_cam_sensor_ioctl(cam->sensor, ESP_CAM_SENSOR_IOC_S_STREAM, &enable), err, TAG, "Camera stream start failed");
+    cam->stats_time_us = esp_timer_get_time();
+    ESP_GOTO_ON_ERROR(esp_cam_ctlr_start(cam->csi), err, TAG, "CSI start failed");
+
+    camera = cam;
+    return ESP_OK;
+
+err:
+    bsp_camera_free(cam);
+    return ret;
+}
+
+esp_err_t bsp_camera_stop(void)
+{
+    ESP_RETURN_ON_FALSE(camera, ESP_ERR_INVALID_STATE, TAG, "Camera is not started");
+    if (camera_rec) {
+        bsp_camera_record_stop();
+    }
+    bsp_camera_free(camera);
+    camera = NULL;
+    return ESP_OK;
+}
+
+esp_err_t bsp_camera_frame_get(bsp_camera_frame_t **frame, uint32_t timeout_ms)
+{
+    ESP_RETURN_ON_FALSE(frame, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+    ESP_RETURN_ON_FALSE(camera, ESP_ERR_INVALID_STATE, TAG, "Camera is not started");
+    if (xQueueReceive(camera->ready_queue, frame, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+esp_err_t bsp_camera_frame_return(bsp_camera_frame_t *frame)
+{
+    ESP_RETURN_ON_FALSE(frame, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+    ESP_RETURN_ON_FALSE(camera, ESP_ERR_INVALID_STATE, TAG, "Camera is not started");
+    xQueueSend(camera->free_queue, &frame, 0);
+    return ESP_OK;
+}
+
+esp_err_t bsp_camera_frame_scale(const bsp_camera_frame_t *frame, const bsp_camera_dst_t *dst)
+{
+    ESP_RETURN_ON_FALSE(frame && dst && dst->buffer, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+    ESP_RETURN_ON_FALSE(camera, ESP_ERR_INVALID_STATE, TAG, "Camera is not started");
+
+    /* Fit into the picture with kept aspect ratio, PPA scales in 1/16 steps */
+    const uint32_t scale_x16 = MIN(dst->width * 16 / frame->width, dst->height * 16 / frame->height);
+    ESP_RETURN_ON_FALSE(scale_x16 > 0, ESP_ERR_INVALID_ARG, TAG, "Destination picture is too small");
+    const uint32_t out_w = frame->width * scale_x16 / 16;
+    const uint32_t out_h = frame->height * scale_x16 / 16;
+
+    const ppa_srm_oper_config_t srm_cfg = {
+        .in = {
+            .buffer = frame->buf,
+            .pic_w = frame->width,
+            .pic_h = frame->height,
+            .block_w = frame->width,
+            .block_h = frame->height,
+            .block_offset_x = 0,
+            .block_offset_y = 0,
+            .srm_cm = (frame->color == BSP_CAMERA_COLOR_RGB888 ? PPA_SRM_COLOR_MODE_RGB888 : PPA_SRM_COLOR_MODE_RGB565),
+        },
+        .out = {
+            .buffer = dst->buffer,
+            .buffer_size = dst->buffer_size,
+            .pic_w = dst->width,
+            .pic_h = dst->height,
+            .block_offset_x = (dst->width - out_w) / 2,
+            .block_offset_y = (dst->height - out_h) / 2,
+            .srm_cm = (dst->color == BSP_CAMERA_COLOR_RGB888 ? PPA_SRM_COLOR_MODE_RGB888 : PPA_SRM_COLOR_MODE_RGB565),
+        },
+        .rotation_angle = PPA_SRM_ROTATION_ANGLE_0,
+        .scale_x = scale_x16 / 16.0f,
+        .scale_y = scale_x16 / 16.0f,
+        .mode = PPA_TRANS_MODE_BLOCKING,
+    };
+    const int64_t start = esp_timer_get_time();
+    ESP_RETURN_ON_ERROR(ppa_do_scale_rotate_mirror(camera->ppa, &srm_cfg), TAG, "PPA scaling failed");
+    camera->scale_time_us += esp_timer_get_time() - start;
+    camera->scale_cnt++;
+    return ESP_OK;
+}
+
+esp_err_t bsp_camera_get_stats(bsp_camera_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+    ESP_RETURN_ON_FALSE(camera, ESP_ERR_INVALID_STATE, TAG, "Camera is not started");
+
+    const int64_t now = esp_timer_get_time();
+    const int64_t period_us = now - camera->stats_time_us;
+    const uint32_t frame_cnt = camera->frame_cnt;
+    const uint32_t scale_cnt = camera->scale_cnt - camera->stats_scale_cnt;
+
+    stats->frame_cnt = frame_cnt;
+    stats->drop_cnt = camera->drop_cnt;
+    stats->scale_cnt = camera->scale_cnt;
+    stats->fps = (period_us > 0 ? (uint64_t)(frame_cnt - camera->stats_frame_cnt) * 1000000 / period_us : 0);
+    stats->scale_avg_us = (scale_cnt ? (camera->scale_time_us - camera->stats_scale_time_us) / scale_cnt : 0);
+
+    camera->stats_time_us = now;
+    camera->stats_frame_cnt = frame_cnt;
+    camera->stats_scale_cnt = camera->scale_cnt;
+    camera->stats_scale_time_us = camera->scale_time_us;
+    return ESP_OK;
+}
+
+static void bsp_camera_rec_fill_stats(const bsp_camera_rec_t *rec, bsp_camera_record_stats_t *stats)
+{
+    avi_recorder_stats_t avi_stats;
+    avi_recorder_get_stats(rec->avi, &avi_stats);
+    stats->encode_cnt = rec->encode_cnt;
+    stats->skip_cnt = rec->skip_cnt;
+    stats->drop_cnt = avi_stats.drop_cnt;
+    stats->frame_cnt = avi_stats.frame_cnt;
+    stats->encode_avg_us = (rec->encode_cnt ? rec->encode_time_us / rec->encode_cnt : 0);
+    stats->frame_size_avg = (rec->encode_cnt ? rec->jpeg_bytes / rec->encode_cnt : 0);
+    stats->write_time_max = avi_stats.write_time_max;
+    stats->throughput = avi_stats.throughput;
+}
+
+static void bsp_camera_rec_free(bsp_camera_rec_t *rec)
+{
+    if (rec->avi) {
+        avi_recorder_delete(rec->avi);
+    }
+    if (rec->jpeg) {
+        jpeg_del_encoder_engine(rec->jpeg);
+    }
+    free(rec->out_buf);
+    free(rec);
+}
+
+esp_err_t bsp_camera_record_start(const bsp_camera_record_cfg_t *cfg)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(cfg && cfg->path && cfg->quality <= 100, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+    ESP_RETURN_ON_FALSE(camera, ESP_ERR_INVALID_STATE, TAG, "Camera is not started");
+    ESP_RETURN_ON_FALSE(camera_rec == NULL, ESP_ERR_INVALID_STATE, TAG, "Recording is already running");
+
+    bsp_camera_rec_t *rec = calloc(1, sizeof(bsp_camera_rec_t));
+    ESP_RETURN_ON_FALSE(rec, ESP_ERR_NO_MEM, TAG, "Not enough memory for recording");
+    const bsp_camera_frame_t *fb = &camera->frames[0];
+
+    const jpeg_encode_engine_cfg_t engine_cfg = {
+        .intr_priority = 0,
+        .timeout_ms = 100,
+    };
+    ESP_GOTO_ON_ERROR(jpeg_new_encoder_engine(&engine_cfg, &rec->jpeg), err, TAG, "JPEG encoder init failed");
+    rec->enc_cfg = (jpeg_encode_cfg_t) {
+        .width = fb->width,
+        .height = fb->height,
+        .src_type = (fb->color == BSP_CAMERA_COLOR_RGB888 ? JPEG_ENCODE_IN_FORMAT_RGB888 : JPEG_ENCODE_IN_FORMAT_RGB565),
+        .sub_sample = JPEG_DOWN_SAMPLING_YUV420,
+        .image_quality = (cfg->quality ? cfg->quality : BSP_CAMERA_REC_QUALITY),
+    };
+    /* One byte per pixel is far above JPEG size of camera pictures with YUV420 */
+    const jpeg_encode_memory_alloc_cfg_t mem_cfg = {
+        .buffer_direction = JPEG_ENC_ALLOC_OUTPUT_BUFFER,
+    };
+    rec->out_buf = jpeg_alloc_encoder_mem(fb->width * fb->height, &mem_cfg, &rec->out_size);
+    ESP_GOTO_ON_FALSE(rec->out_buf, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for JPEG buffer");
+
+    avi_recorder_config_t avi_cfg = AVI_RECORDER_CONFIG_DEFAULT();
+    avi_cfg.ring_size = (cfg->buffer_size ? cfg->buffer_size : BSP_CAMERA_REC_BUFFER_SIZE);
+    avi_cfg.block_size = BSP_CAMERA_REC_BLOCK_SIZE;
+    avi_cfg.max_frames = BSP_CAMERA_REC_MAX_FRAMES;
+    avi_cfg.flags.ring_spiram = 1;
+    ESP_GOTO_ON_ERROR(avi_recorder_create(&avi_cfg, &rec->avi), err, TAG, "AVI recorder init failed");
+
+    /* Without the frame rate, the file is played at the rate of the sensor */
+    uint32_t fps = cfg->fps;
+    if (fps == 0) {
+        bsp_camera_stats_t stats;
+        bsp_camera_get_stats(&stats);
+        fps = (stats.fps ? stats.fps : 30);
+    }
+    rec->period_us = (cfg->fps ? 1000000 / cfg->fps : 0);
+    ESP_GOTO_ON_ERROR(avi_recorder_start(rec->avi, cfg->path, fb->width, fb->height, fps), err, TAG, "Recording start failed");
+
+    camera_rec = rec;
+    camera_rec_used = true;
+    return ESP_OK;
+
+err:
+    bsp_camera_rec_free(rec);
+    return ret;
+}
+
+esp_err_t bsp_camera_record_frame(const bsp_camera_frame_t *frame)
+{
+    ESP_RETURN_ON_FALSE(frame, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+    bsp_camera_rec_t *rec = camera_rec;
+    if (rec == NULL || !avi_recorder_is_recording(rec->avi)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* Frames are skipped before encoding, half of the period is the tolerance of the sensor timing */
+    if (rec->period_us) {
+        if (rec->next_us && frame->timestamp_us < rec->next_us - rec->period_us / 2) {
+            rec->skip_cnt++;
+            return ESP_OK;
+        }
+        /* The cadence is kept, unless the frames came late by more than one period */
+        rec->next_us = ((rec->next_us && frame->timestamp_us < rec->next_us + rec->period_us) ? rec->next_us : frame->timestamp_us) + rec->period_us;
+    }
+
+    uint32_t jpeg_size = 0;
+    const int64_t start = esp_timer_get_time();
+    ESP_RETURN_ON_ERROR(jpeg_encoder_process(rec->jpeg, &rec->enc_cfg, frame->buf, frame->len, rec->out_buf, rec->out_size, &jpeg_size),
+                        TAG, "JPEG encoding failed");
+    rec->encode_time_us += esp_timer_get_time() - start;
+    rec->encode_cnt++;
+    rec->jpeg_bytes += jpeg_size;
+
+    return avi_recorder_write_frame(rec->avi, rec->out_buf, jpeg_size);
+}
+
+esp_err_t bsp_camera_record_stop(void)
+{
+    ESP_RETURN_ON_FALSE(camera_rec, ESP_ERR_INVALID_STATE, TAG, "Recording is not running");
+
+    const esp_err_t ret = avi_recorder_stop(camera_rec->avi);
+    bsp_camera_rec_fill_stats(camera_rec, &camera_rec_stats);
+    ESP_LOGI(TAG, "Recorded %"PRIu32" frames (%"PRIu32" dropped, %"PRIu32" skipped), encoding %"PRIu32" us, %"PRIu32" kB/s",
+             camera_rec_stats.frame_cnt, camera_rec_stats.drop_cnt, camera_rec_stats.skip_cnt, camera_rec_stats.encode_avg_us,
+             camera_rec_stats.throughput / 1024);
+    bsp_camera_rec_free(camera_rec);
+    camera_rec = NULL;
+    return ret;
+}
+
+esp_err_t bsp_camera_record_get_stats(bsp_camera_record_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+    ESP_RETURN_ON_FALSE(camera_rec_used, ESP_ERR_INVALID_STATE, TAG, "No recording was started");
+
+    if (camera_rec) {
+        bsp_camera_rec_fill_stats(camera_rec, stats);
+    } else {
+        *stats = camera_rec_stats;
+    }
+    return ESP_OK;
+}
+
 static void usb_lib_task(void *arg)
 {
     while (1) {
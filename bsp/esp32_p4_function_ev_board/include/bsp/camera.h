@@ -0,0 +1,274 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief BSP Camera
+ *
+ * MIPI-CSI camera (SC2336 on the board) is read by CSI controller through ISP (RAW to RGB) by DMA into frame buffers
+ * in PSRAM. PPA scales and converts the frames directly into the destination picture, e.g. LVGL canvas buffer
+ * or DPI frame buffer (esp_lcd_dpi_panel_get_frame_buffer). The CPU does not copy any pixels.
+ *
+ * \code{.c}
+ * bsp_camera_start(NULL);
+ * while (1) {
+ *     bsp_camera_frame_t *frame;
+ *     if (bsp_camera_frame_get(&frame, 1000) == ESP_OK) {
+ *         bsp_camera_frame_scale(frame, &dst);
+ *         bsp_camera_frame_return(frame);
+ *     }
+ * }
+ * \endcode
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+/* Frame buffers of the camera */
+#define BSP_CAMERA_FB_COUNT_MIN     (3)
+#define BSP_CAMERA_FB_COUNT_MAX     (6)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Color format of camera frames and scaling destination
+ */
+typedef enum {
+    BSP_CAMERA_COLOR_RGB565 = 0,    /*!< RGB565, 2 bytes per pixel (little-endian, as LVGL and DPI) */
+    BSP_CAMERA_COLOR_RGB888,        /*!< RGB888, 3 bytes per pixel */
+} bsp_camera_color_t;
+
+/**
+ * @brief BSP camera configuration structure
+ */
+typedef struct {
+    const char          *format;    /*!< Name of the sensor format (e.g. "MIPI_2lane_24Minput_RAW8_800x640_50fps"), NULL: default format of the sensor */
+    bsp_camera_color_t  color;      /*!< Color format of frames (ISP output) */
+    uint32_t            fb_count;   /*!< Count of frame buffers in PSRAM, BSP_CAMERA_FB_COUNT_MIN..MAX (0: BSP_CAMERA_FB_COUNT_MIN) */
+} bsp_camera_cfg_t;
+
+/**
+ * @brief Camera frame
+ */
+typedef struct {
+    uint8_t             *buf;           /*!< Pixels in PSRAM (cache line aligned) */
+    size_t              len;            /*!< Size of the frame in bytes */
+    uint32_t            width;          /*!< Horizontal resolution */
+    uint32_t            height;         /*!< Vertical resolution */
+    bsp_camera_color_t  color;          /*!< Color format */
+    int64_t             timestamp_us;   /*!< Time of the frame end (esp_timer) */
+} bsp_camera_frame_t;
+
+/**
+ * @brief Destination picture of the scaled frame
+ */
+typedef struct {
+    void                *buffer;        /*!< Picture buffer (DMA capable, buffer and size aligned to cache line) */
+    size_t              buffer_size;    /*!< Size of the buffer in bytes */
+    uint32_t            width;          /*!< Horizontal resolution of the picture */
+    uint32_t            height;         /*!< Vertical resolution of the picture */
+    bsp_camera_color_t  color;          /*!< Color format of the picture */
+} bsp_camera_dst_t;
+
+/**
+ * @brief Camera statistics
+ */
+typedef struct {
+    uint32_t frame_cnt;     /*!< Frames received from the sensor */
+    uint32_t drop_cnt;      /*!< Frames overwritten by newer frames before the application took them */
+    uint32_t scale_cnt;     /*!< Frames scaled by PPA */
+    uint32_t fps;           /*!< Received frames per second since the previous call */
+    uint32_t scale_avg_us;  /*!< Average time of scaling one frame since the previous call */
+} bsp_camera_stats_t;
+
+/**
+ * @brief Configuration of the camera recording
+ */
+typedef struct {
+    const char  *path;          /*!< Path of the created AVI file (e.g. BSP_SD_MOUNT_POINT"/rec.avi"), storage must be mounted */
+    uint32_t    fps;            /*!< Frame rate of the recording, frames are skipped to keep it (0: every frame passed to bsp_camera_record_frame) */
+    uint32_t    quality;        /*!< JPEG quality 1-100 (0: 80) */
+    size_t      buffer_size;    /*!< PSRAM buffer of encoded frames waiting for the storage in bytes (0: 2 MB) */
+} bsp_camera_record_cfg_t;
+
+/**
+ * @brief Statistics of the current or the last camera recording
+ */
+typedef struct {
+    uint32_t encode_cnt;        /*!< Frames encoded by the JPEG encoder */
+    uint32_t skip_cnt;          /*!< Frames skipped to keep the frame rate of the recording */
+    uint32_t drop_cnt;          /*!< Encoded frames dropped, because the storage was too slow */
+    uint32_t frame_cnt;         /*!< Frames stored in the file */
+    uint32_t encode_avg_us;     /*!< Average time of encoding one frame */
+    uint32_t frame_size_avg;    /*!< Average size of one JPEG frame in bytes */
+    uint32_t write_time_max;    /*!< Longest write of one block into the file [us] */
+    uint32_t throughput;        /*!< Average write throughput of the storage [bytes/s] */
+} bsp_camera_record_stats_t;
+
+/**
+ * @brief Start camera
+ *
+ * Detects the sensor on I2C (SCCB), sets its format and starts streaming through ISP into frame buffers.
+ * When the application is slower than the sensor, the oldest received frame is replaced by the new one.
+ *
+ * @note I2C is initialized by this function, if it was not before. It powers the MIPI PHY (shared with the display).
+ *
+ * @param[in] cfg Camera configuration (NULL: default configuration, RGB565)
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_STATE Camera is already started
+ *      - ESP_ERR_NOT_FOUND     Camera sensor or the format was not found
+ *      - ESP_ERR_NO_MEM        Not enough memory for frame buffers
+ *      - Else                  Driver failure
+ */
+esp_err_t bsp_camera_start(const bsp_camera_cfg_t *cfg);
+
+/**
+ * @brief Stop camera and free all its resources
+ *
+ * @note All frames must be returned before.
+ *
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_STATE Camera is not started
+ */
+esp_err_t bsp_camera_stop(void);
+
+/**
+ * @brief Get the oldest received frame
+ *
+ * The frame is not written by the camera, until it is returned by bsp_camera_frame_return().
+ *
+ * @param[out] frame      Received frame
+ * @param[in]  timeout_ms Timeout of waiting for the frame
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Invalid argument
+ *      - ESP_ERR_INVALID_STATE Camera is not started
+ *      - ESP_ERR_TIMEOUT       No frame received in timeout
+ */
+esp_err_t bsp_camera_frame_get(bsp_camera_frame_t **frame, uint32_t timeout_ms);
+
+/**
+ * @brief Return the frame to the camera
+ *
+ * @param[in] frame Frame from bsp_camera_frame_get()
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Invalid argument
+ *      - ESP_ERR_INVALID_STATE Camera is not started
+ */
+esp_err_t bsp_camera_frame_return(bsp_camera_frame_t *frame);
+
+/**
+ * @brief Scale frame into the destination picture by PPA
+ *
+ * The frame is scaled to fit the picture with kept aspect ratio (scale precision is 1/16) and centered.
+ * The color is converted to the color format of the picture. The rest of the picture is not changed.
+ *
+ * @note The function blocks until PPA finishes.
+ *
+ * @param[in] frame Frame from bsp_camera_frame_get()
+ * @param[in] dst   Destination picture
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Invalid argument (e.g. the picture is too small or not aligned)
+ *      - ESP_ERR_INVALID_STATE Camera is not started
+ *      - Else                  PPA failure
+ */
+esp_err_t bsp_camera_frame_scale(const bsp_camera_frame_t *frame, const bsp_camera_dst_t *dst);
+
+/**
+ * @brief Get camera statistics
+ *
+ * @param[out] stats Statistics (frame rate and average scaling time are computed since the previous call)
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Invalid argument
+ *      - ESP_ERR_INVALID_STATE Camera is not started
+ */
+esp_err_t bsp_camera_get_stats(bsp_camera_stats_t *stats);
+
+/**
+ * @brief Start recording of camera frames into MJPEG AVI file
+ *
+ * Frames passed to bsp_camera_record_frame() are encoded by the hardware JPEG encoder. Encoded frames are buffered
+ * in PSRAM and a writer task stores them into the file in large blocks, so the camera loop does not wait for the storage.
+ *
+ * \code{.c}
+ * bsp_sdcard_mount();
+ * bsp_camera_start(NULL);
+ * const bsp_camera_record_cfg_t rec_cfg = {.path = BSP_SD_MOUNT_POINT"/rec.avi", .fps = 15};
+ * bsp_camera_record_start(&rec_cfg);
+ * while (recording) {
+ *     bsp_camera_frame_t *frame;
+ *     if (bsp_camera_frame_get(&frame, 1000) == ESP_OK) {
+ *         bsp_camera_frame_scale(frame, &dst);    // Preview continues
+ *         bsp_camera_record_frame(frame);
+ *         bsp_camera_frame_return(frame);
+ *     }
+ * }
+ * bsp_camera_record_stop();
+ * \endcode
+ *
+ * @param[in] cfg Recording configuration
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Invalid argument
+ *      - ESP_ERR_INVALID_STATE Camera is not started or the recording is already running
+ *      - ESP_ERR_NOT_FOUND     The file cannot be created
+ *      - ESP_ERR_NO_MEM        Not enough memory for the buffers
+ *      - Else                  JPEG encoder failure
+ */
+esp_err_t bsp_camera_record_start(const bsp_camera_record_cfg_t *cfg);
+
+/**
+ * @brief Encode the frame and add it to the recording
+ *
+ * Frames arriving faster than the frame rate of the recording are skipped without encoding. When the storage is behind
+ * and the buffer is full, the encoded frame is dropped.
+ *
+ * @note The function blocks until the JPEG encoder finishes (the frame must not be returned to the camera before).
+ *
+ * @param[in] frame Frame from bsp_camera_frame_get()
+ * @return
+ *      - ESP_OK                On success (also when the frame was skipped)
+ *      - ESP_ERR_INVALID_ARG   Invalid argument
+ *      - ESP_ERR_INVALID_STATE Recording is not running (or it was stopped by a write error)
+ *      - ESP_ERR_NO_MEM        The frame was dropped, the storage is too slow
+ *      - Else                  JPEG encoder failure
+ */
+esp_err_t bsp_camera_record_frame(const bsp_camera_frame_t *frame);
+
+/**
+ * @brief Stop the recording, store the buffered frames and finish the AVI file
+ *
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_STATE Recording is not running
+ *      - ESP_FAIL              Writing of the file failed
+ */
+esp_err_t bsp_camera_record_stop(void);
+
+/**
+ * @brief Get statistics of the recording
+ *
+ * @param[out] stats Statistics
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Invalid argument
+ *      - ESP_ERR_INVALID_STATE No recording was started
+ */
+esp_err_t bsp_camera_record_get_stats(bsp_camera_record_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
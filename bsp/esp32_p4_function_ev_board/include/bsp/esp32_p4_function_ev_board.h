@@ -13,10 +13,11 @@
 
 #include "sdkconfig.h"
 #include "driver/gpio.h"
-#include "driver/i2c.h"
+#include "driver/i2c_master.h"
 #include "driver/sdmmc_host.h"
 #include "bsp/config.h"
 #include "bsp/display.h"
+#include "bsp/camera.h"
 #include "sdkconfig.h"
 
 #if (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
@@ -36,6 +37,7 @@
 #define BSP_CAPS_AUDIO_MIC      0
 #define BSP_CAPS_SDCARD         1
 #define BSP_CAPS_IMU            0
+#define BSP_CAPS_CAMERA         1
 
 /**************************************************************************************************
  *  ESP-BOX pinout
@@ -76,6 +78,7 @@ extern "C" {
  * There are multiple devices connected to I2C peripheral:
  *  - Codec ES8311 (configuration only)
  *  - LCD Touch controller
+ *  - Camera sensor (SCCB)
  **************************************************************************************************/
 #define BSP_I2C_NUM     CONFIG_BSP_I2C_NUM
 
@@ -100,6 +103,15 @@ esp_err_t bsp_i2c_init(void);
  */
 esp_err_t bsp_i2c_deinit(void);
 
+/**
+ * @brief Get I2C driver handle
+ *
+ * @return
+ *      - I2C handle
+ *
+ */
+i2c_master_bus_handle_t bsp_i2c_get_handle(void);
+
 /**************************************************************************************************
  *
  * SPIFFS
@@ -190,7 +202,11 @@ esp_err_t bsp_sdcard_unmount(void);
  *
  * Display's backlight must be enabled explicitly by calling bsp_display_backlight_on()
  **************************************************************************************************/
+#if CONFIG_BSP_LCD_DPI_LOW_REFRESH
+#define BSP_LCD_PIXEL_CLOCK_MHZ     (40)
+#else
 #define BSP_LCD_PIXEL_CLOCK_MHZ     (80)
+#endif
 
 #if (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
 
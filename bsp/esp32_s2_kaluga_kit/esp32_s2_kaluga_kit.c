@@ -9,6 +9,7 @@
 #include "esp_err.h"
 #include "esp_log.h"
 #include "esp_check.h"
+#include "esp_attr.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_vendor.h"
 #include "esp_lcd_panel_ops.h"
@@ -23,6 +24,7 @@
 static const char *TAG = "Kaluga";
 
 static bool i2c_initialized = false;
+static QueueHandle_t touchpad_queue = NULL;
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
 static adc_oneshot_unit_handle_t bsp_adc_handle = NULL;
 #endif
@@ -234,7 +236,7 @@ esp_codec_dev_handle_t bsp_audio_codec_microphone_init(void)
     return bsp_audio_codec_init();
 }
 
-esp_err_t bsp_touchpad_init(intr_handler_t fn)
+static esp_err_t bsp_touchpad_hw_init(intr_handler_t fn, void *arg, uint32_t debounce_cnt)
 {
     /*!< Initialize touch pad peripheral, it will start a timer to run a filter */
     BSP_ERROR_CHECK_RETURN_ERR(touch_pad_init());
@@ -264,14 +266,14 @@ esp_err_t bsp_touchpad_init(intr_handler_t fn)
     /*!< Filter setting */
     touch_filter_config_t filter_info = {
         .mode = TOUCH_PAD_FILTER_IIR_8,           /*!< Test jitter and filter 1/4. */
-        .debounce_cnt = 1,      /*!< 1 time count. */
+        .debounce_cnt = debounce_cnt,   /*!< Consecutive measurements over (under) the threshold for active (inactive) interrupt */
         .noise_thr = 0,         /*!< 50% */
         .jitter_step = 4,       /*!< use for jitter mode. */
     };
     BSP_ERROR_CHECK_RETURN_ERR(touch_pad_filter_set_config(&filter_info));
     BSP_ERROR_CHECK_RETURN_ERR(touch_pad_filter_enable());
     /*!< Register touch interrupt ISR, enable intr type. */
-    BSP_ERROR_CHECK_RETURN_ERR(touch_pad_isr_register(fn, NULL, TOUCH_PAD_INTR_MASK_ALL));
+    BSP_ERROR_CHECK_RETURN_ERR(touch_pad_isr_register(fn, arg, TOUCH_PAD_INTR_MASK_ALL));
     BSP_ERROR_CHECK_RETURN_ERR(touch_pad_intr_enable(TOUCH_PAD_INTR_MASK_ACTIVE | TOUCH_PAD_INTR_MASK_INACTIVE));
 
     /*!< Enable touch sensor clock. Work mode is "timer trigger". */
@@ -287,6 +289,67 @@ esp_err_t bsp_touchpad_init(intr_handler_t fn)
     return ESP_OK;
 }
 
+esp_err_t bsp_touchpad_init(intr_handler_t fn)
+{
+    return bsp_touchpad_hw_init(fn, NULL, 1);
+}
+
+/* Active and inactive interrupts come after the HW filter and debounce, they are only passed to the queue */
+static void IRAM_ATTR bsp_touchpad_isr(void *arg)
+{
+    QueueHandle_t queue = (QueueHandle_t)arg;
+    const uint32_t status = touch_pad_read_intr_status_mask();
+    const touch_pad_t pad = touch_pad_get_current_meas_channel();
+    BaseType_t need_yield = pdFALSE;
+
+    /* Guard ring only blocks the other pads (water on the board) */
+    if (pad == TOUCH_BUTTON_GUARD) {
+        return;
+    }
+    if (status & TOUCH_PAD_INTR_MASK_ACTIVE) {
+        const bsp_touchpad_event_t event = {.button = pad, .pressed = true};
+        xQueueSendFromISR(queue, &event, &need_yield);
+    }
+    if (status & TOUCH_PAD_INTR_MASK_INACTIVE) {
+        const bsp_touchpad_event_t event = {.button = pad, .pressed = false};
+        xQueueSendFromISR(queue, &event, &need_yield);
+    }
+    if (need_yield) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+esp_err_t bsp_touchpad_events_start(QueueHandle_t *ret_queue)
+{
+    ESP_RETURN_ON_FALSE(ret_queue, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(touchpad_queue == NULL, ESP_ERR_INVALID_STATE, TAG, "Touchpad events already started");
+
+    touchpad_queue = xQueueCreate(CONFIG_BSP_TOUCHPAD_EVENT_QUEUE_LEN, sizeof(bsp_touchpad_event_t));
+    ESP_RETURN_ON_FALSE(touchpad_queue, ESP_ERR_NO_MEM, TAG, "Not enough memory for touchpad queue");
+    const esp_err_t ret = bsp_touchpad_hw_init(bsp_touchpad_isr, touchpad_queue, CONFIG_BSP_TOUCHPAD_DEBOUNCE_CNT);
+    if (ret != ESP_OK) {
+        bsp_touchpad_deinit();
+        return ret;
+    }
+    *ret_queue = touchpad_queue;
+
+    return ESP_OK;
+}
+
+esp_err_t bsp_touchpad_deinit(void)
+{
+    touch_pad_intr_disable(TOUCH_PAD_INTR_MASK_ALL);
+    touch_pad_fsm_stop();
+    /* Not registered, if the touch pad was initialized without interrupt handler */
+    touch_pad_isr_deregister(bsp_touchpad_isr, touchpad_queue);
+    BSP_ERROR_CHECK_RETURN_ERR(touch_pad_deinit());
+    if (touchpad_queue) {
+        vQueueDelete(touchpad_queue);
+        touchpad_queue = NULL;
+    }
+    return ESP_OK;
+}
+
 esp_err_t bsp_touchpad_calibrate(bsp_touchpad_button_t tch_pad, float tch_threshold)
 {
     /*!< read baseline value */
@@ -326,7 +389,7 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
         .lcd_cmd_bits = LCD_CMD_BITS,
         .lcd_param_bits = LCD_PARAM_BITS,
         .spi_mode = 0,
-        .trans_queue_depth = 10,
+        .trans_queue_depth = (config->trans_queue_depth > 0) ? config->trans_queue_depth : 10,
     };
     ESP_GOTO_ON_ERROR(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)BSP_LCD_SPI_NUM, &io_config, ret_io), err, TAG, "New panel IO failed");
 
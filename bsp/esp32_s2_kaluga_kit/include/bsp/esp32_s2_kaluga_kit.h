@@ -14,6 +14,8 @@
 #include "sdkconfig.h"
 #include "driver/gpio.h"
 #include "driver/touch_pad.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 #include "iot_button.h"
 #include "lvgl.h"
 #include "esp_lvgl_port.h"
@@ -260,7 +262,8 @@ esp_err_t bsp_spiffs_unmount(void);
  * @brief Kaluga camera default configuration
  *
  * In this configuration we select RGB565 color format and 320x240 image size - matching the display.
- * We use double-buffering for the best performance.
+ * We use double-buffering for the best performance. In grab-latest mode esp_camera_fb_get() always returns the newest frame,
+ * older frames are dropped, so frames do not get stale when the display is slower than the camera.
  * Since ESP32-S2 has only 320kB of internal SRAM, we allocate the framebuffers in external PSRAM.
  * By setting XCLK to 16MHz, we configure the esp32-camera driver to use EDMA when accessing the PSRAM.
  *
@@ -291,6 +294,7 @@ esp_err_t bsp_spiffs_unmount(void);
         .frame_size = FRAMESIZE_QVGA,     \
         .jpeg_quality = 12,               \
         .fb_count = 2,                    \
+        .grab_mode = CAMERA_GRAB_LATEST,  \
         .fb_location = CAMERA_FB_IN_PSRAM,\
         .sccb_i2c_port = BSP_I2C_NUM,     \
     }
@@ -475,6 +479,14 @@ typedef enum {
     TOUCH_BUTTON_NUM      = 7
 } bsp_touchpad_button_t;
 
+/**
+ * @brief Touchpad button event
+ */
+typedef struct {
+    bsp_touchpad_button_t button;   /*!< Touched or released button */
+    bool pressed;                   /*!< True on press, false on release */
+} bsp_touchpad_event_t;
+
 /**
  * @brief Init buttons on Touchpad board
  *
@@ -489,9 +501,33 @@ typedef enum {
  */
 esp_err_t bsp_touchpad_init(intr_handler_t fn);
 
+/**
+ * @brief Init buttons on Touchpad board with debounced press and release events
+ *
+ * The touch sensor measures the pads by its own timer with HW filter, denoise channel and waterproof guard ring.
+ * A press (release) is reported after `CONFIG_BSP_TOUCHPAD_DEBOUNCE_CNT` consecutive measurements over (under)
+ * the threshold. The interrupt only passes the event to the queue, the CPU does not poll or filter the pads.
+ * The guard ring is not reported, it blocks the other pads while touched (e.g. water on the board).
+ *
+ * @attention The same conflicts as in bsp_touchpad_init() apply.
+ * @param[out] ret_queue Queue of `bsp_touchpad_event_t` events
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   NULL pointer
+ *      - ESP_ERR_INVALID_STATE Events are already started
+ *      - ESP_ERR_NO_MEM        No memory
+ *      - ESP_FAIL              Touch pad not initialized
+ */
+esp_err_t bsp_touchpad_events_start(QueueHandle_t *ret_queue);
+
 /**
  * @brief Deinit buttons on Touchpad board
  *
+ * @note The queue of bsp_touchpad_events_start() is deleted.
+ *
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_FAIL              Touch pad not initialized
  */
 esp_err_t bsp_touchpad_deinit(void);
 
@@ -9,6 +9,8 @@
 #include "driver/i2c.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
 
 #include "iot_button.h"
 #include "bsp/esp-bsp.h"
@@ -138,6 +140,145 @@ esp_codec_dev_handle_t bsp_audio_codec_microphone_init(void)
     return esp_codec_dev_new(&codec_es7210_dev_cfg);
 }
 
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+static esp_codec_dev_handle_t mic_array_dev = NULL;
+static int16_t *mic_array_raw = NULL;       // Interleaved frame read from I2S
+static int16_t *mic_array_planar = NULL;    // BSP_MIC_ARRAY_CHANNELS planes of frame_samples
+static size_t mic_array_samples = 0;
+static uint32_t mic_array_rate = 0;
+
+static esp_codec_dev_handle_t bsp_audio_mic_array_codec_init(void)
+{
+    const audio_codec_data_if_t *i2s_data_if = bsp_audio_get_codec_itf_mic();
+    if (i2s_data_if == NULL) {
+        BSP_ERROR_CHECK_RETURN_NULL(bsp_i2c_init());
+        BSP_ERROR_CHECK_RETURN_NULL(bsp_audio_init(NULL));
+        i2s_data_if = bsp_audio_get_codec_itf_mic();
+    }
+    assert(i2s_data_if);
+
+    audio_codec_i2c_cfg_t i2c_cfg = {
+        .port = BSP_I2C_NUM,
+        .addr = ES7210_CODEC_DEFAULT_ADDR,
+    };
+    const audio_codec_ctrl_if_t *i2c_ctrl_if = audio_codec_new_i2c_ctrl(&i2c_cfg);
+    BSP_NULL_CHECK(i2c_ctrl_if, NULL);
+
+    /* More than two inputs selected switches ES7210 to TDM output */
+    es7210_codec_cfg_t es7210_cfg = {
+        .ctrl_if = i2c_ctrl_if,
+        .mic_selected = ES7120_SEL_MIC1 | ES7120_SEL_MIC2 | ES7120_SEL_MIC3 | ES7120_SEL_MIC4,
+    };
+    const audio_codec_if_t *es7210_dev = es7210_codec_new(&es7210_cfg);
+    BSP_NULL_CHECK(es7210_dev, NULL);
+
+    esp_codec_dev_cfg_t codec_es7210_dev_cfg = {
+        .dev_type = ESP_CODEC_DEV_TYPE_IN,
+        .codec_if = es7210_dev,
+        .data_if = i2s_data_if,
+    };
+    return esp_codec_dev_new(&codec_es7210_dev_cfg);
+}
+
+/* Split frames of 4 x 16-bit samples, one 32-bit load carries two channels */
+static void bsp_audio_mic_array_deinterleave(const int16_t *src, int16_t *dst, size_t samples)
+{
+    const uint32_t *in = (const uint32_t *)src;
+    int16_t *ch0 = dst;
+    int16_t *ch1 = dst + samples;
+    int16_t *ch2 = dst + 2 * samples;
+    int16_t *ch3 = dst + 3 * samples;
+
+    for (size_t i = 0; i < samples; i++) {
+        const uint32_t lo = in[2 * i];
+        const uint32_t hi = in[2 * i + 1];
+        ch0[i] = (int16_t)(lo & 0xFFFF);
+        ch1[i] = (int16_t)(lo >> 16);
+        ch2[i] = (int16_t)(hi & 0xFFFF);
+        ch3[i] = (int16_t)(hi >> 16);
+    }
+}
+
+esp_err_t bsp_audio_mic_array_init(const bsp_mic_array_config_t *config)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(config && config->sample_rate > 0 && config->frame_samples > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid configuration");
+    ESP_RETURN_ON_FALSE(mic_array_raw == NULL, ESP_ERR_INVALID_STATE, TAG, "Microphone array is already initialized");
+
+    /* Codec device is kept for next initialization, its interfaces cannot be freed */
+    if (mic_array_dev == NULL) {
+        mic_array_dev = bsp_audio_mic_array_codec_init();
+        ESP_RETURN_ON_FALSE(mic_array_dev, ESP_FAIL, TAG, "Microphone array codec initialization failed");
+    }
+
+    const size_t frame_bytes = config->frame_samples * BSP_MIC_ARRAY_CHANNELS * sizeof(int16_t);
+    mic_array_raw = heap_caps_malloc(frame_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    mic_array_planar = heap_caps_malloc(frame_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    ESP_GOTO_ON_FALSE(mic_array_raw && mic_array_planar, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for microphone array");
+
+    /* All four TDM slots are enabled in the I2S by codec open */
+    esp_codec_dev_sample_info_t fs = {
+        .sample_rate = config->sample_rate,
+        .channel = BSP_MIC_ARRAY_CHANNELS,
+        .channel_mask = ESP_CODEC_DEV_MAKE_CHANNEL_MASK(0) | ESP_CODEC_DEV_MAKE_CHANNEL_MASK(1) |
+        ESP_CODEC_DEV_MAKE_CHANNEL_MASK(2) | ESP_CODEC_DEV_MAKE_CHANNEL_MASK(3),
+        .bits_per_sample = 16,
+    };
+    ESP_GOTO_ON_FALSE(esp_codec_dev_open(mic_array_dev, &fs) == ESP_CODEC_DEV_OK, ESP_FAIL, err, TAG, "Microphone array open failed");
+    esp_codec_dev_set_in_gain(mic_array_dev, config->in_gain);
+
+    mic_array_samples = config->frame_samples;
+    mic_array_rate = config->sample_rate;
+    return ESP_OK;
+
+err:
+    free(mic_array_raw);
+    free(mic_array_planar);
+    mic_array_raw = NULL;
+    mic_array_planar = NULL;
+    return ret;
+}
+
+esp_err_t bsp_audio_mic_array_read(bsp_mic_array_frame_t *frame, bool planar)
+{
+    ESP_RETURN_ON_FALSE(frame, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(mic_array_raw, ESP_ERR_INVALID_STATE, TAG, "Microphone array is not initialized");
+
+    const int frame_bytes = mic_array_samples * BSP_MIC_ARRAY_CHANNELS * sizeof(int16_t);
+    ESP_RETURN_ON_FALSE(esp_codec_dev_read(mic_array_dev, mic_array_raw, frame_bytes) == ESP_CODEC_DEV_OK, ESP_FAIL, TAG, "Microphone array read failed");
+    /* The read returns, when the last sample arrives */
+    frame->timestamp_us = esp_timer_get_time() - ((int64_t)mic_array_samples * 1000000 / mic_array_rate);
+    frame->interleaved = mic_array_raw;
+    frame->samples = mic_array_samples;
+
+    if (planar) {
+        bsp_audio_mic_array_deinterleave(mic_array_raw, mic_array_planar, mic_array_samples);
+    }
+    for (int i = 0; i < BSP_MIC_ARRAY_CHANNELS; i++) {
+        frame->channel[i] = planar ? (mic_array_planar + i * mic_array_samples) : NULL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t bsp_audio_mic_array_deinit(void)
+{
+    if (mic_array_raw == NULL) {
+        return ESP_OK;
+    }
+    esp_codec_dev_close(mic_array_dev);
+    free(mic_array_raw);
+    free(mic_array_planar);
+    mic_array_raw = NULL;
+    mic_array_planar = NULL;
+    return ESP_OK;
+}
+
+esp_codec_dev_handle_t bsp_audio_mic_array_get_codec(void)
+{
+    return mic_array_raw ? mic_array_dev : NULL;
+}
+#endif
+
 /**
  * @brief led configuration structure
  *
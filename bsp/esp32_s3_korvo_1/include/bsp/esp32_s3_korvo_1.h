@@ -179,6 +179,111 @@ esp_codec_dev_handle_t bsp_audio_codec_speaker_init(void);
  */
 esp_codec_dev_handle_t bsp_audio_codec_microphone_init(void);
 
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+/**************************************************************************************************
+ *
+ * Microphone array capture
+ *
+ * All four ES7210 inputs are captured over I2S TDM: three microphones of the array and the reference
+ * (playback loopback) for echo cancellation. One read returns the frame received from I2S and
+ * optionally planar view of each channel.
+ *
+ * \code{.c}
+ * const bsp_mic_array_config_t cfg = BSP_MIC_ARRAY_CONFIG_DEFAULT();
+ * bsp_audio_mic_array_init(&cfg);
+ * bsp_mic_array_frame_t frame;
+ * while (bsp_audio_mic_array_read(&frame, false) == ESP_OK) {
+ *     afe->feed(afe_data, frame.interleaved); // Interleaved data are passed without copy
+ * }
+ * \endcode
+ *
+ * @note Microphone array and bsp_audio_codec_microphone_init() share the ES7210 and I2S, do not use them together.
+ **************************************************************************************************/
+#define BSP_MIC_ARRAY_CHANNELS      (4)
+#define BSP_MIC_ARRAY_REF_CHANNEL   (3)     /* ES7210 MIC4 input is the reference signal */
+
+/**
+ * @brief Channel order of the microphone array frame for esp-sr AFE (`input_format`)
+ */
+#define BSP_AFE_INPUT_FORMAT        "MMMR"
+
+/**
+ * @brief Microphone array configuration
+ */
+typedef struct {
+    uint32_t sample_rate;   /*!< Sample rate [Hz] */
+    size_t frame_samples;   /*!< Count of samples of each channel in one frame */
+    float in_gain;          /*!< Input gain [dB] */
+} bsp_mic_array_config_t;
+
+#define BSP_MIC_ARRAY_CONFIG_DEFAULT()  \
+    {                                   \
+        .sample_rate = 16000,           \
+        .frame_samples = 512,           \
+        .in_gain = 42.0,                \
+    }
+
+/**
+ * @brief One frame of 16-bit samples of all channels
+ *
+ * @note The buffers are owned by BSP and they are valid until the next read
+ */
+typedef struct {
+    const int16_t *interleaved;                         /*!< Frame as received from I2S, channels are interleaved */
+    const int16_t *channel[BSP_MIC_ARRAY_CHANNELS];     /*!< Planar buffer of each channel (NULL, if not requested) */
+    size_t samples;                                     /*!< Count of samples of each channel */
+    int64_t timestamp_us;                               /*!< Capture time of the first sample (esp_timer time) */
+} bsp_mic_array_frame_t;
+
+/**
+ * @brief Initialize microphone array capture
+ *
+ * Enables all ES7210 inputs and all four TDM slots of I2S.
+ *
+ * @param[in] config Configuration
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Invalid configuration
+ *      - ESP_ERR_INVALID_STATE Already initialized
+ *      - ESP_ERR_NO_MEM        Not enough memory for buffers
+ *      - ESP_FAIL              Codec initialization failed
+ */
+esp_err_t bsp_audio_mic_array_init(const bsp_mic_array_config_t *config);
+
+/**
+ * @brief Read one frame of all channels
+ *
+ * @note Blocks until the whole frame is received
+ *
+ * @param[out] frame  Received frame
+ * @param[in]  planar Split the channels into planar buffers
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   NULL pointer
+ *      - ESP_ERR_INVALID_STATE Not initialized
+ *      - ESP_FAIL              I2S read failed
+ */
+esp_err_t bsp_audio_mic_array_read(bsp_mic_array_frame_t *frame, bool planar);
+
+/**
+ * @brief Stop microphone array capture and free buffers
+ *
+ * @return
+ *      - ESP_OK                On success
+ */
+esp_err_t bsp_audio_mic_array_deinit(void);
+
+/**
+ * @brief Get codec device of the microphone array
+ *
+ * Frames of all channels (BSP_AFE_INPUT_FORMAT order) can be read from the device directly into the buffer of
+ * the consumer, e.g. by the afe_feed component, instead of bsp_audio_mic_array_read().
+ *
+ * @return Codec device opened by bsp_audio_mic_array_init() or NULL if the microphone array is not initialized
+ */
+esp_codec_dev_handle_t bsp_audio_mic_array_get_codec(void);
+#endif
+
 /**************************************************************************************************
  *
  * I2C interface
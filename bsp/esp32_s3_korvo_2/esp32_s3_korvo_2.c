@@ -14,6 +14,9 @@
 #include "esp_lcd_panel_vendor.h"
 #include "esp_lcd_panel_ops.h"
 #include "esp_spiffs.h"
+#if CONFIG_BSP_FLASH_FS_LITTLEFS
+#include "esp_littlefs.h"
+#endif
 
 #include "bsp/esp32_s3_korvo_2.h"
 #include "bsp/display.h"
@@ -306,6 +309,8 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
     ESP_RETURN_ON_ERROR(spi_bus_initialize(BSP_LCD_SPI_NUM, &buscfg, SPI_DMA_CH_AUTO), TAG, "SPI init failed");
 
     ESP_LOGD(TAG, "Install panel IO");
+    /* CS is connected to the IO expander, it is asserted once below and held for the whole display session.
+       The LCD is the only device on this SPI bus, so the panel IO runs without CS line and no I2C access is done per transfer. */
     const esp_lcd_panel_io_spi_config_t io_config = {
         .dc_gpio_num = BSP_LCD_DC,
         .cs_gpio_num = BSP_LCD_CS,
@@ -313,7 +318,7 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
         .lcd_cmd_bits = LCD_CMD_BITS,
         .lcd_param_bits = LCD_PARAM_BITS,
         .spi_mode = 0,
-        .trans_queue_depth = 10,
+        .trans_queue_depth = (config->trans_queue_depth > 0) ? config->trans_queue_depth : 10,
     };
     ESP_GOTO_ON_ERROR(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)BSP_LCD_SPI_NUM, &io_config, ret_io), err, TAG, "New panel IO failed");
 
@@ -326,20 +331,18 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
     ESP_GOTO_ON_ERROR(esp_lcd_new_panel_ili9341(*ret_io, &panel_config, ret_panel), err, TAG, "New panel failed");
 
     BSP_NULL_CHECK(bsp_io_expander_init(), ESP_ERR_INVALID_STATE);
-    ESP_GOTO_ON_ERROR(esp_io_expander_set_dir(io_expander, BSP_LCD_IO_CS, IO_EXPANDER_OUTPUT), err, TAG, "");
-    ESP_GOTO_ON_ERROR(esp_io_expander_set_dir(io_expander, BSP_LCD_IO_RST, IO_EXPANDER_OUTPUT), err, TAG, "");
-    ESP_GOTO_ON_ERROR(esp_io_expander_set_dir(io_expander, BSP_LCD_IO_BACKLIGHT, IO_EXPANDER_OUTPUT), err, TAG, "");
-    ESP_GOTO_ON_ERROR(esp_io_expander_set_level(io_expander, BSP_LCD_IO_CS, 0), err, TAG, "");
 
-    // Reset LCD
-    ESP_GOTO_ON_ERROR(esp_io_expander_set_level(io_expander, BSP_LCD_IO_RST, 0), err, TAG, "");
+    // Set LCD control pins and start LCD reset (output and direction registers are written once)
+    // CS is asserted here and it stays low, the display is selected for all following transfers
+    esp_io_expander_transaction_t trans;
+    ESP_GOTO_ON_ERROR(esp_io_expander_transaction_begin(io_expander, &trans), err, TAG, "");
+    esp_io_expander_transaction_set_dir(&trans, BSP_LCD_IO_CS | BSP_LCD_IO_RST | BSP_LCD_IO_BACKLIGHT, IO_EXPANDER_OUTPUT);
+    esp_io_expander_transaction_set_level(&trans, BSP_LCD_IO_CS | BSP_LCD_IO_RST, 0);
+    ESP_GOTO_ON_ERROR(esp_io_expander_transaction_commit(&trans), err, TAG, "");
     vTaskDelay(pdMS_TO_TICKS(10));
     ESP_GOTO_ON_ERROR(esp_io_expander_set_level(io_expander, BSP_LCD_IO_RST, 1), err, TAG, "");
     vTaskDelay(pdMS_TO_TICKS(10));
 
-    // Enable display
-    ESP_GOTO_ON_ERROR(esp_io_expander_set_level(io_expander, BSP_LCD_IO_CS, 0), err, TAG, "");
-
     esp_lcd_panel_init(*ret_panel);
     esp_lcd_panel_mirror(*ret_panel, true, true);
     return ret;
@@ -510,10 +513,11 @@ void bsp_display_unlock(void)
 esp_err_t bsp_leds_init(void)
 {
     BSP_NULL_CHECK(bsp_io_expander_init(), ESP_ERR_INVALID_STATE);
-    BSP_ERROR_CHECK_RETURN_ERR(esp_io_expander_set_dir(io_expander, BSP_LED_RED, IO_EXPANDER_OUTPUT));
-    BSP_ERROR_CHECK_RETURN_ERR(esp_io_expander_set_dir(io_expander, BSP_LED_BLUE, IO_EXPANDER_OUTPUT));
-    BSP_ERROR_CHECK_RETURN_ERR(esp_io_expander_set_level(io_expander, BSP_LED_RED, true));
-    BSP_ERROR_CHECK_RETURN_ERR(esp_io_expander_set_level(io_expander, BSP_LED_BLUE, true));
+    esp_io_expander_transaction_t trans;
+    BSP_ERROR_CHECK_RETURN_ERR(esp_io_expander_transaction_begin(io_expander, &trans));
+    esp_io_expander_transaction_set_dir(&trans, BSP_LED_RED | BSP_LED_BLUE, IO_EXPANDER_OUTPUT);
+    esp_io_expander_transaction_set_level(&trans, BSP_LED_RED | BSP_LED_BLUE, true);
+    BSP_ERROR_CHECK_RETURN_ERR(esp_io_expander_transaction_commit(&trans));
     return ESP_OK;
 }
 
@@ -629,3 +633,43 @@ esp_err_t bsp_spiffs_unmount(void)
 {
     return esp_vfs_spiffs_unregister(CONFIG_BSP_SPIFFS_PARTITION_LABEL);
 }
+
+esp_err_t bsp_flash_fs_mount(void)
+{
+#if CONFIG_BSP_FLASH_FS_LITTLEFS
+    esp_vfs_littlefs_conf_t conf = {
+        .base_path = CONFIG_BSP_SPIFFS_MOUNT_POINT,
+        .partition_label = CONFIG_BSP_SPIFFS_PARTITION_LABEL,
+#ifdef CONFIG_BSP_SPIFFS_FORMAT_ON_MOUNT_FAIL
+        .format_if_mount_failed = true,
+#else
+        .format_if_mount_failed = false,
+#endif
+    };
+
+    esp_err_t ret_val = esp_vfs_littlefs_register(&conf);
+
+    BSP_ERROR_CHECK_RETURN_ERR(ret_val);
+
+    size_t total = 0, used = 0;
+    ret_val = esp_littlefs_info(conf.partition_label, &total, &used);
+    if (ret_val != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to get LittleFS partition information (%s)", esp_err_to_name(ret_val));
+    } else {
+        ESP_LOGI(TAG, "Partition size: total: %d, used: %d", total, used);
+    }
+
+    return ret_val;
+#else
+    return bsp_spiffs_mount();
+#endif
+}
+
+esp_err_t bsp_flash_fs_unmount(void)
+{
+#if CONFIG_BSP_FLASH_FS_LITTLEFS
+    return esp_vfs_littlefs_unregister(CONFIG_BSP_SPIFFS_PARTITION_LABEL);
+#else
+    return bsp_spiffs_unmount();
+#endif
+}
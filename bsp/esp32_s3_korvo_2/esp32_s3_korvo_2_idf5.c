@@ -52,6 +52,10 @@ esp_err_t bsp_audio_init(const i2s_std_config_t *i2s_config)
     /* Setup I2S peripheral */
     i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(CONFIG_BSP_I2S_NUM, I2S_ROLE_MASTER);
     chan_cfg.auto_clear = true; // Auto clear the legacy data in the DMA buffer
+#if CONFIG_BSP_I2S_LOW_LATENCY
+    chan_cfg.dma_desc_num = CONFIG_BSP_I2S_DMA_DESC_NUM;
+    chan_cfg.dma_frame_num = CONFIG_BSP_I2S_DMA_FRAME_NUM;
+#endif
     BSP_ERROR_CHECK_RETURN_ERR(i2s_new_channel(&chan_cfg, &i2s_tx_chan, &i2s_rx_chan));
 
     /* Setup I2S channels */
@@ -96,6 +100,20 @@ const audio_codec_data_if_t *bsp_audio_get_codec_itf(void)
     return i2s_data_if;
 }
 
+esp_err_t bsp_audio_get_i2s_channels(i2s_chan_handle_t *tx_channel, i2s_chan_handle_t *rx_channel)
+{
+    if (i2s_tx_chan == NULL || i2s_rx_chan == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (tx_channel) {
+        *tx_channel = i2s_tx_chan;
+    }
+    if (rx_channel) {
+        *rx_channel = i2s_rx_chan;
+    }
+    return ESP_OK;
+}
+
 esp_err_t bsp_adc_initialize(void)
 {
     /* ADC was initialized before */
@@ -228,6 +228,30 @@ esp_err_t bsp_audio_init(const i2s_std_config_t *i2s_config);
  */
 const audio_codec_data_if_t *bsp_audio_get_codec_itf(void);
 
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+/**
+ * @brief Count of I2S DMA buffers of the audio channels (`dma_desc_num` of i2s_stream_config_t)
+ */
+#if CONFIG_BSP_I2S_LOW_LATENCY
+#define BSP_I2S_DMA_DESC_NUM    (CONFIG_BSP_I2S_DMA_DESC_NUM)
+#else
+#define BSP_I2S_DMA_DESC_NUM    (6)
+#endif
+
+/**
+ * @brief Get I2S channels (initialized in bsp_audio_init)
+ *
+ * The channels can be streamed by their DMA buffers with i2s_stream component, instead of esp_codec_dev_read/write.
+ *
+ * @param[out] tx_channel I2S TX channel (speaker), can be NULL
+ * @param[out] rx_channel I2S RX channel (microphone), can be NULL
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_STATE Audio is not initialized
+ */
+esp_err_t bsp_audio_get_i2s_channels(i2s_chan_handle_t *tx_channel, i2s_chan_handle_t *rx_channel);
+#endif
+
 /**
  * @brief Initialize speaker codec device
  *
@@ -242,6 +266,14 @@ esp_codec_dev_handle_t bsp_audio_codec_speaker_init(void);
  */
 esp_codec_dev_handle_t bsp_audio_codec_microphone_init(void);
 
+/**
+ * @brief Channel order of the bsp_audio_codec_microphone_init() capture for esp-sr AFE (`input_format`)
+ *
+ * Frames read from the microphone codec opened with 2 channels can be fed to the AFE without reordering
+ * (e.g. by the afe_feed component). The playback reference (ES7210 MIC3) is not captured in I2S standard mode.
+ */
+#define BSP_AFE_INPUT_FORMAT    "MM"
+
 /**************************************************************************************************
  *
  * I2C interface
@@ -317,6 +349,37 @@ esp_err_t bsp_spiffs_mount(void);
  */
 esp_err_t bsp_spiffs_unmount(void);
 
+/**************************************************************************************************
+ *
+ * Flash filesystem
+ *
+ * SPIFFS or LittleFS, selected by CONFIG_BSP_FLASH_FS in menuconfig, is mounted to the same mount point
+ * and partition as SPIFFS, so file paths of the application don't depend on the choice.
+ **************************************************************************************************/
+#define BSP_FLASH_FS_MOUNT_POINT    CONFIG_BSP_SPIFFS_MOUNT_POINT
+
+/**
+ * @brief Mount flash filesystem selected in menuconfig to virtual file system
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_STATE if the filesystem was already mounted
+ *      - ESP_ERR_NO_MEM if memory can not be allocated
+ *      - ESP_FAIL if partition can not be mounted
+ *      - other error codes
+ */
+esp_err_t bsp_flash_fs_mount(void);
+
+/**
+ * @brief Unmount flash filesystem from virtual file system
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_STATE if the filesystem is not mounted
+ *      - other error codes
+ */
+esp_err_t bsp_flash_fs_unmount(void);
+
 /**************************************************************************************************
  *
  * IO Expander Interface
@@ -356,7 +419,8 @@ esp_io_expander_handle_t bsp_io_expander_init(void);
  * @brief ESP32-S3-Korvo-2 camera default configuration
  *
  * In this configuration we select RGB565 color format and 320x240 image size - matching the display.
- * We use double-buffering for the best performance.
+ * We use double-buffering for the best performance. In grab-latest mode esp_camera_fb_get() always returns the newest frame,
+ * older frames are dropped, so frames do not get stale when the display is slower than the camera.
  * Since we don't want to waste internal SRAM, we allocate the framebuffers in external PSRAM.
  * By setting XCLK to 16MHz, we configure the esp32-camera driver to use EDMA when accessing the PSRAM.
  *
@@ -387,6 +451,7 @@ esp_io_expander_handle_t bsp_io_expander_init(void);
         .frame_size = FRAMESIZE_QVGA,     \
         .jpeg_quality = 12,               \
         .fb_count = 2,                    \
+        .grab_mode = CAMERA_GRAB_LATEST,  \
         .fb_location = CAMERA_FB_IN_PSRAM,\
         .sccb_i2c_port = BSP_I2C_NUM,     \
     }
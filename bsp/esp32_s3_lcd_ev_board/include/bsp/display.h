@@ -29,6 +29,7 @@ extern "C" {
  */
 typedef struct {
     int max_transfer_sz;    /*!< Maximum transfer size, in bytes. */
+    int psram_trans_align;  /*!< Alignment of the RGB frame buffers in PSRAM, GDMA reads them directly (EDMA) in bursts of this size (0: 64) [bytes] */
 } bsp_display_config_t;
 
 /**
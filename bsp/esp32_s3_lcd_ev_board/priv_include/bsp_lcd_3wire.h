@@ -0,0 +1,44 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include "esp_err.h"
+#include "esp_io_expander.h"
+#include "esp_lcd_panel_io.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 3-wire SPI (9-bit, D/C bit first) panel IO on IO expander pins configuration
+ */
+typedef struct {
+    esp_io_expander_handle_t io_expander;   /*!< IO expander with CS, SCL and SDA lines */
+    uint32_t cs_pin;                        /*!< CS line (active low) */
+    uint32_t scl_pin;                       /*!< SCL line (idle low) */
+    uint32_t sda_pin;                       /*!< SDA line */
+    bool scl_falling_edge;                  /*!< Panel samples SDA on falling edge of SCL (rising edge if false) */
+} bsp_lcd_3wire_config_t;
+
+/**
+ * @brief Create panel IO for sending LCD commands and parameters by 3-wire SPI on IO expander pins
+ *
+ * @note Edges of each command are written in sequences by `esp_io_expander_set_level_seq`,
+ *       instead of one I2C transaction for each edge
+ * @note Only `esp_lcd_panel_io_tx_param` and `esp_lcd_panel_io_del` are supported
+ *
+ * @param[in]  config Configuration
+ * @param[out] ret_io Returned panel IO handle
+ *
+ * @return
+ *      - ESP_OK: Success, otherwise returns ESP_ERR_xxx
+ */
+esp_err_t bsp_lcd_new_panel_io_3wire(const bsp_lcd_3wire_config_t *config, esp_lcd_panel_io_handle_t *ret_io);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,117 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_lcd_panel_io_interface.h"
+
+#include "bsp_lcd_3wire.h"
+
+static const char *TAG = "bsp_lcd_3wire";
+
+/* Steps collected before writing to IO expander (two bytes with D/C bit) */
+#define LCD_3WIRE_STEPS_MAX     (36)
+
+typedef struct {
+    esp_lcd_panel_io_t base;
+    bsp_lcd_3wire_config_t config;
+    uint32_t steps[LCD_3WIRE_STEPS_MAX];    /* Levels of CS, SCL and SDA for each step */
+    size_t steps_cnt;
+} bsp_lcd_3wire_t;
+
+static esp_err_t lcd_3wire_flush(bsp_lcd_3wire_t *lcd)
+{
+    const uint32_t mask = lcd->config.cs_pin | lcd->config.scl_pin | lcd->config.sda_pin;
+    esp_err_t ret = esp_io_expander_set_level_seq(lcd->config.io_expander, mask, lcd->steps, lcd->steps_cnt);
+    lcd->steps_cnt = 0;
+    return ret;
+}
+
+static esp_err_t lcd_3wire_step(bsp_lcd_3wire_t *lcd, uint32_t levels)
+{
+    lcd->steps[lcd->steps_cnt++] = levels;
+    if (lcd->steps_cnt == LCD_3WIRE_STEPS_MAX) {
+        return lcd_3wire_flush(lcd);
+    }
+    return ESP_OK;
+}
+
+/* D/C bit and 8 data bits (MSB first), CS stays low */
+static esp_err_t lcd_3wire_write_9bit(bsp_lcd_3wire_t *lcd, bool dc, uint8_t data)
+{
+    const uint32_t scl = lcd->config.scl_pin;
+    /* SDA is set in the first step, the panel samples it in the second step */
+    const uint32_t scl_setup = lcd->config.scl_falling_edge ? scl : 0;
+    const uint32_t scl_sample = lcd->config.scl_falling_edge ? 0 : scl;
+    const uint16_t bits = (dc ? 0x100 : 0) | data;
+
+    for (int i = 8; i >= 0; i--) {
+        const uint32_t sda = (bits & (1 << i)) ? lcd->config.sda_pin : 0;
+        ESP_RETURN_ON_ERROR(lcd_3wire_step(lcd, scl_setup | sda), TAG, "Write step failed");
+        ESP_RETURN_ON_ERROR(lcd_3wire_step(lcd, scl_sample | sda), TAG, "Write step failed");
+    }
+    return ESP_OK;
+}
+
+static esp_err_t lcd_3wire_tx_param(esp_lcd_panel_io_t *io, int lcd_cmd, const void *param, size_t param_size)
+{
+    bsp_lcd_3wire_t *lcd = __containerof(io, bsp_lcd_3wire_t, base);
+    const uint8_t *data = (const uint8_t *)param;
+    esp_err_t ret = ESP_OK;
+
+    /* CS low with SCL idle */
+    lcd->steps_cnt = 0;
+    ESP_GOTO_ON_ERROR(lcd_3wire_step(lcd, 0), err, TAG, "Write step failed");
+    if (lcd_cmd >= 0) {
+        ESP_GOTO_ON_ERROR(lcd_3wire_write_9bit(lcd, false, lcd_cmd & 0xff), err, TAG, "Write command failed");
+    }
+    for (size_t i = 0; i < param_size; i++) {
+        ESP_GOTO_ON_ERROR(lcd_3wire_write_9bit(lcd, true, data[i]), err, TAG, "Write parameter failed");
+    }
+    /* SCL idle, then CS high */
+    ESP_GOTO_ON_ERROR(lcd_3wire_step(lcd, 0), err, TAG, "Write step failed");
+    ESP_GOTO_ON_ERROR(lcd_3wire_step(lcd, lcd->config.cs_pin), err, TAG, "Write step failed");
+    ESP_GOTO_ON_ERROR(lcd_3wire_flush(lcd), err, TAG, "Write steps failed");
+
+    return ESP_OK;
+
+err:
+    /* Release the bus */
+    lcd->steps_cnt = 0;
+    lcd_3wire_step(lcd, lcd->config.cs_pin);
+    lcd_3wire_flush(lcd);
+    return ret;
+}
+
+static esp_err_t lcd_3wire_del(esp_lcd_panel_io_t *io)
+{
+    bsp_lcd_3wire_t *lcd = __containerof(io, bsp_lcd_3wire_t, base);
+    free(lcd);
+    return ESP_OK;
+}
+
+esp_err_t bsp_lcd_new_panel_io_3wire(const bsp_lcd_3wire_config_t *config, esp_lcd_panel_io_handle_t *ret_io)
+{
+    ESP_RETURN_ON_FALSE(config && config->io_expander && ret_io, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    /* Idle: CS high, SCL low. Output levels are written before the lines become outputs. */
+    esp_io_expander_transaction_t trans;
+    ESP_RETURN_ON_ERROR(esp_io_expander_transaction_begin(config->io_expander, &trans), TAG, "Transaction begin failed");
+    esp_io_expander_transaction_set_dir(&trans, config->cs_pin | config->scl_pin | config->sda_pin, IO_EXPANDER_OUTPUT);
+    esp_io_expander_transaction_set_level(&trans, config->cs_pin, 1);
+    esp_io_expander_transaction_set_level(&trans, config->scl_pin | config->sda_pin, 0);
+    ESP_RETURN_ON_ERROR(esp_io_expander_transaction_commit(&trans), TAG, "Set idle levels failed");
+
+    bsp_lcd_3wire_t *lcd = calloc(1, sizeof(bsp_lcd_3wire_t));
+    ESP_RETURN_ON_FALSE(lcd, ESP_ERR_NO_MEM, TAG, "Not enough memory");
+    lcd->config = *config;
+    lcd->base.tx_param = lcd_3wire_tx_param;
+    lcd->base.del = lcd_3wire_del;
+
+    *ret_io = &lcd->base;
+    return ESP_OK;
+}
@@ -11,16 +11,17 @@
 #include "esp_io_expander_tca9554.h"
 #include "esp_lcd_gc9503.h"
 #include "esp_lcd_panel_io.h"
-#include "esp_lcd_panel_io_additions.h"
 #include "esp_lcd_panel_ops.h"
 #include "esp_lcd_panel_rgb.h"
 #include "esp_lcd_touch_ft5x06.h"
 #include "esp_lcd_touch_gt1151.h"
 #include "esp_log.h"
 #include "esp_rom_sys.h"
+#include "esp_timer.h"
 
 #include "sdkconfig.h"
 #include "bsp_err_check.h"
+#include "bsp_lcd_3wire.h"
 #include "bsp_probe.h"
 #include "bsp/display.h"
 #include "bsp/esp32_s3_lcd_ev_board.h"
@@ -30,10 +31,14 @@
 #warning "Due to significant updates of the RGB LCD drivers, it's recommended to develop using ESP-IDF v5.1.2 or later"
 #endif
 
-#if CONFIG_ESP32S3_DATA_CACHE_LINE_64B && !(CONFIG_SPIRAM_SPEED_120M || CONFIG_BSP_LCD_RGB_BOUNCE_BUFFER_MODE)
+#if CONFIG_ESP32S3_DATA_CACHE_LINE_64B && !(CONFIG_SPIRAM_SPEED_120M || CONFIG_BSP_LCD_RGB_BOUNCE_BUFFER_MODE || CONFIG_BSP_LCD_RGB_COMPRESSED_FB_MODE)
 #warning "Enabling the `ESP32S3_DATA_CACHE_LINE_64B` configuration when the PSRAM speed is not set to 120MHz (`SPIRAM_SPEED_120M`) and the LCD is not in bounce buffer mode (`BSP_LCD_RGB_BOUNCE_BUFFER_MODE`) may result in screen drift, please enable `ESP32S3_DATA_CACHE_LINE_32B` instead"
 #endif
 
+#if CONFIG_BSP_LCD_RGB_FLASH_WRITE_SAFE && !(CONFIG_SPIRAM_FETCH_INSTRUCTIONS && CONFIG_SPIRAM_RODATA)
+#warning "Enabling `BSP_LCD_RGB_FLASH_WRITE_SAFE` without `SPIRAM_FETCH_INSTRUCTIONS` and `SPIRAM_RODATA` may result in screen drift during flash writes, the frame buffer in PSRAM cannot be read while the cache is disabled"
+#endif
+
 static const char *TAG = "bsp_sub_board";
 
 /**************************************************************************************************
@@ -48,15 +53,23 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
     ESP_LOGW(TAG, "Due to significant updates of the RGB LCD drivers, it's recommended to develop using ESP-IDF v5.1.2 or later");
 #endif
 
-#if CONFIG_ESP32S3_DATA_CACHE_LINE_64B && !(CONFIG_SPIRAM_SPEED_120M || CONFIG_BSP_LCD_RGB_BOUNCE_BUFFER_MODE)
+#if CONFIG_ESP32S3_DATA_CACHE_LINE_64B && !(CONFIG_SPIRAM_SPEED_120M || CONFIG_BSP_LCD_RGB_BOUNCE_BUFFER_MODE || CONFIG_BSP_LCD_RGB_COMPRESSED_FB_MODE)
     ESP_LOGW(TAG, "Enabling the `ESP32S3_DATA_CACHE_LINE_64B` configuration when the PSRAM speed is not set to 120MHz \
 (`SPIRAM_SPEED_120M`) and the LCD is not in bounce buffer mode (`BSP_LCD_RGB_BOUNCE_BUFFER_MODE`) may result in screen \
 drift, please enable `ESP32S3_DATA_CACHE_LINE_32B` instead");
 #endif
 
+#if CONFIG_BSP_LCD_RGB_FLASH_WRITE_SAFE && !(CONFIG_SPIRAM_FETCH_INSTRUCTIONS && CONFIG_SPIRAM_RODATA)
+    ESP_LOGW(TAG, "Enabling `BSP_LCD_RGB_FLASH_WRITE_SAFE` without `SPIRAM_FETCH_INSTRUCTIONS` and `SPIRAM_RODATA` may \
+result in screen drift during flash writes");
+#endif
+
+    /* Frame buffers are read by GDMA directly from PSRAM, larger alignment allows longer bursts */
+    const size_t psram_trans_align = (config && config->psram_trans_align > 0) ? config->psram_trans_align : 64;
     esp_io_expander_handle_t expander = NULL;
     esp_lcd_panel_handle_t panel_handle = NULL;
     esp_lcd_panel_io_handle_t io_handle = NULL;
+    const int64_t init_start = esp_timer_get_time();
 
     bsp_module_type_t module_type = bsp_probe_module_type();
     if (module_type == MODULE_TYPE_UNKNOW) {
@@ -84,27 +97,20 @@ drift, please enable `ESP32S3_DATA_CACHE_LINE_32B` instead");
 
         BSP_NULL_CHECK(expander = bsp_io_expander_init(), ESP_FAIL);
         ESP_LOGI(TAG, "Install panel IO");
-        spi_line_config_t line_config = {
-            .cs_io_type = IO_TYPE_EXPANDER,
-            .cs_expander_pin = BSP_LCD_SUB_BOARD_2_SPI_CS,
-            .scl_io_type = IO_TYPE_EXPANDER,
-            .scl_expander_pin = BSP_LCD_SUB_BOARD_2_SPI_SCK,
-            .sda_io_type = IO_TYPE_EXPANDER,
-            .sda_expander_pin = BSP_LCD_SUB_BOARD_2_SPI_SDO,
+        /* SPI lines are on IO expander, edges of each command are sent in few I2C transactions */
+        const bsp_lcd_3wire_config_t io_config = {
             .io_expander = expander,
+            .cs_pin = BSP_LCD_SUB_BOARD_2_SPI_CS,
+            .scl_pin = BSP_LCD_SUB_BOARD_2_SPI_SCK,
+            .sda_pin = BSP_LCD_SUB_BOARD_2_SPI_SDO,
+            .scl_falling_edge = SUB_BOARD2_480_480_PANEL_SCL_ACTIVE_EDGE,
         };
-#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 2)
-        esp_lcd_panel_io_3wire_spi_config_t io_config = GC9503_PANEL_IO_3WIRE_SPI_CONFIG(
-                    line_config, SUB_BOARD2_480_480_PANEL_SCL_ACTIVE_EDGE);
-#else
-        esp_lcd_panel_io_3wire_spi_config_t io_config = GC9503_PANEL_IO_3WIRE_SPI_CONFIG(line_config);
-#endif
-        BSP_ERROR_CHECK_RETURN_ERR(esp_lcd_new_panel_io_3wire_spi(&io_config, &io_handle));
+        BSP_ERROR_CHECK_RETURN_ERR(bsp_lcd_new_panel_io_3wire(&io_config, &io_handle));
 
         ESP_LOGI(TAG, "Initialize RGB panel");
         esp_lcd_rgb_panel_config_t rgb_conf = {
             .clk_src = LCD_CLK_SRC_PLL160M,
-            .psram_trans_align = 64,
+            .psram_trans_align = psram_trans_align,
             .data_width = 16,
             .bits_per_pixel = 16,
             .de_gpio_num = BSP_LCD_SUB_BOARD_2_3_DE,
@@ -131,9 +137,14 @@ drift, please enable `ESP32S3_DATA_CACHE_LINE_32B` instead");
                 BSP_LCD_SUB_BOARD_2_3_DATA15,
             },
             .timings = SUB_BOARD2_480_480_PANEL_60HZ_RGB_TIMING(),
+#if CONFIG_BSP_LCD_RGB_COMPRESSED_FB_MODE
+            /* Bounce buffers are filled from the compressed frame buffer of LVGL port */
+            .flags.no_fb = 1,
+#else
             .flags.fb_in_psram = 1,
             .num_fbs = CONFIG_BSP_LCD_RGB_BUFFER_NUMS,
-#if CONFIG_BSP_LCD_RGB_BOUNCE_BUFFER_MODE
+#endif
+#if CONFIG_BSP_LCD_RGB_BOUNCE_BUFFER_MODE || CONFIG_BSP_LCD_RGB_COMPRESSED_FB_MODE
             .bounce_buffer_size_px = BSP_LCD_SUB_BOARD_2_H_RES * CONFIG_BSP_LCD_RGB_BOUNCE_BUFFER_HEIGHT,
 #endif
         };
@@ -166,7 +177,7 @@ drift, please enable `ESP32S3_DATA_CACHE_LINE_32B` instead");
         ESP_LOGI(TAG, "Initialize RGB panel");
         esp_lcd_rgb_panel_config_t panel_conf = {
             .clk_src = LCD_CLK_SRC_PLL160M,
-            .psram_trans_align = 64,
+            .psram_trans_align = psram_trans_align,
             .data_width = 16,
             .bits_per_pixel = 16,
             .de_gpio_num = BSP_LCD_SUB_BOARD_2_3_DE,
@@ -193,9 +204,14 @@ drift, please enable `ESP32S3_DATA_CACHE_LINE_32B` instead");
                 BSP_LCD_SUB_BOARD_2_3_DATA15,
             },
             .timings = SUB_BOARD3_800_480_PANEL_35HZ_RGB_TIMING(),
+#if CONFIG_BSP_LCD_RGB_COMPRESSED_FB_MODE
+            /* Bounce buffers are filled from the compressed frame buffer of LVGL port */
+            .flags.no_fb = 1,
+#else
             .flags.fb_in_psram = 1,
             .num_fbs = CONFIG_BSP_LCD_RGB_BUFFER_NUMS,
-#if CONFIG_BSP_LCD_RGB_BOUNCE_BUFFER_MODE
+#endif
+#if CONFIG_BSP_LCD_RGB_BOUNCE_BUFFER_MODE || CONFIG_BSP_LCD_RGB_COMPRESSED_FB_MODE
             .bounce_buffer_size_px = BSP_LCD_SUB_BOARD_3_H_RES * CONFIG_BSP_LCD_RGB_BOUNCE_BUFFER_HEIGHT,
 #endif
         };
@@ -211,6 +227,7 @@ drift, please enable `ESP32S3_DATA_CACHE_LINE_32B` instead");
         break;
     }
     BSP_ERROR_CHECK_RETURN_ERR(esp_lcd_panel_init(panel_handle));
+    ESP_LOGI(TAG, "LCD init took %d ms", (int)((esp_timer_get_time() - init_start) / 1000));
 
     if (ret_panel) {
         *ret_panel = panel_handle;
@@ -27,6 +27,10 @@
 
 #include "esp_lvgl_port.h"
 
+#if CONFIG_BSP_LCD_RGB_COMPRESSED_FB_MODE && LVGL_VERSION_MAJOR < 9
+#error "Compressed frame buffer mode (CONFIG_BSP_LCD_RGB_COMPRESSED_FB_MODE) needs LVGL9"
+#endif
+
 #define BSP_ES7210_CODEC_ADDR   (0x82)
 
 /* Can be used for `i2s_std_gpio_config_t` and/or `i2s_std_config_t` initialization */
@@ -335,6 +339,10 @@ static lv_display_t *bsp_display_lcd_init()
         .io_handle = io_handle,
         .panel_handle = panel_handle,
         .buffer_size = buffer_size,
+#if CONFIG_BSP_DISPLAY_LVGL_DMA_COPY
+        /* LVGL renders into the second buffer while the first one is copied */
+        .double_buffer = true,
+#endif
 
         .monochrome = false,
         .hres = BSP_LCD_H_RES,
@@ -347,7 +355,11 @@ static lv_display_t *bsp_display_lcd_init()
             .mirror_y = false,
         },
         .flags = {
+#if CONFIG_BSP_DISPLAY_LVGL_DMA_COPY
+            .buff_dma = true,
+#else
             .buff_dma = false,
+#endif
 #if CONFIG_BSP_DISPLAY_LVGL_PSRAM
             .buff_spiram = false,
 #endif
@@ -365,9 +377,14 @@ static lv_display_t *bsp_display_lcd_init()
         .flags = {
 #if CONFIG_BSP_LCD_RGB_BOUNCE_BUFFER_MODE
             .bb_mode = 1,
+#elif CONFIG_BSP_LCD_RGB_COMPRESSED_FB_MODE
+            .compressed_fb = 1,
 #else
             .bb_mode = 0,
 #endif
+#if CONFIG_BSP_DISPLAY_LVGL_DMA_COPY && LVGL_VERSION_MAJOR >= 9
+            .dma_copy = 1,
+#endif
 #if CONFIG_BSP_DISPLAY_LVGL_AVOID_TEAR
             .avoid_tearing = true,
 #else
@@ -0,0 +1,181 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <inttypes.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "driver/sdmmc_host.h"
+#include "sdmmc_cmd.h"
+#include "bsp/esp32_s3_usb_otg.h"
+#include "bsp_err_check.h"
+
+#if CONFIG_TINYUSB_MSC_ENABLED
+#include "tinyusb.h"
+#include "tusb_msc_storage.h"
+
+static const char *TAG = "S3-USB-OTG-MSC";
+
+static sdmmc_card_t msc_card;
+static bool msc_started = false;
+static bsp_usb_msc_stats_t msc_stats;
+static int64_t msc_stats_start_us;
+static portMUX_TYPE msc_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Sector access of the MSC storage is counted on the SDMMC layer, below TinyUSB (linked with --wrap) */
+esp_err_t __real_sdmmc_read_sectors(sdmmc_card_t *card, void *dst, size_t start_sector, size_t sector_count);
+esp_err_t __real_sdmmc_write_sectors(sdmmc_card_t *card, const void *src, size_t start_sector, size_t sector_count);
+
+esp_err_t __wrap_sdmmc_read_sectors(sdmmc_card_t *card, void *dst, size_t start_sector, size_t sector_count)
+{
+    const int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = __real_sdmmc_read_sectors(card, dst, start_sector, sector_count);
+    if (card == &msc_card && ret == ESP_OK) {
+        portENTER_CRITICAL(&msc_stats_lock);
+        msc_stats.bytes_read += (uint64_t)sector_count * card->csd.sector_size;
+        msc_stats.read_us += esp_timer_get_time() - start_us;
+        msc_stats.read_cmds++;
+        portEXIT_CRITICAL(&msc_stats_lock);
+    }
+    return ret;
+}
+
+esp_err_t __wrap_sdmmc_write_sectors(sdmmc_card_t *card, const void *src, size_t start_sector, size_t sector_count)
+{
+    const int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = __real_sdmmc_write_sectors(card, src, start_sector, sector_count);
+    if (card == &msc_card && ret == ESP_OK) {
+        portENTER_CRITICAL(&msc_stats_lock);
+        msc_stats.bytes_written += (uint64_t)sector_count * card->csd.sector_size;
+        msc_stats.write_us += esp_timer_get_time() - start_us;
+        msc_stats.write_cmds++;
+        portEXIT_CRITICAL(&msc_stats_lock);
+    }
+    return ret;
+}
+
+static esp_err_t bsp_usb_msc_card_init(void)
+{
+    /* Card is used without filesystem, so the highest bus clock and 4-bit width are used for raw sectors */
+    sdmmc_host_t host = SDMMC_HOST_DEFAULT();
+    host.max_freq_khz = SDMMC_FREQ_HIGHSPEED;
+    const sdmmc_slot_config_t slot_config = {
+        .clk = BSP_SD_CLK,
+        .cmd = BSP_SD_CMD,
+        .d0 = BSP_SD_D0,
+        .d1 = BSP_SD_D1,
+        .d2 = BSP_SD_D2,
+        .d3 = BSP_SD_D3,
+        .d4 = GPIO_NUM_NC,
+        .d5 = GPIO_NUM_NC,
+        .d6 = GPIO_NUM_NC,
+        .d7 = GPIO_NUM_NC,
+        .cd = SDMMC_SLOT_NO_CD,
+        .wp = SDMMC_SLOT_NO_WP,
+        .width = 4,
+        .flags = 0,
+    };
+
+    ESP_RETURN_ON_ERROR(sdmmc_host_init(), TAG, "SDMMC host init failed");
+    esp_err_t ret = sdmmc_host_init_slot(host.slot, &slot_config);
+    ESP_GOTO_ON_ERROR(ret, err, TAG, "SDMMC slot init failed");
+    ESP_GOTO_ON_ERROR(sdmmc_card_init(&host, &msc_card), err, TAG, "SD card init failed");
+    return ESP_OK;
+
+err:
+    sdmmc_host_deinit();
+    return ret;
+}
+
+esp_err_t bsp_usb_msc_start(void)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(!msc_started, ESP_ERR_INVALID_STATE, TAG, "USB MSC already started");
+    ESP_RETURN_ON_FALSE(bsp_sdcard == NULL, ESP_ERR_INVALID_STATE, TAG, "SD card is mounted, unmount it first");
+
+    BSP_ERROR_CHECK_RETURN_ERR(bsp_usb_mode_select_device());
+    ESP_RETURN_ON_ERROR(bsp_usb_msc_card_init(), TAG, "SD card init failed");
+
+    const tinyusb_msc_sdmmc_config_t msc_cfg = {
+        .card = &msc_card,
+    };
+    ESP_GOTO_ON_ERROR(tinyusb_msc_storage_init_sdmmc(&msc_cfg), err, TAG, "MSC storage init failed");
+
+    const tinyusb_config_t tusb_cfg = {
+        .device_descriptor = NULL,          // Default descriptors of esp_tinyusb
+        .string_descriptor = NULL,
+        .external_phy = false,
+        .configuration_descriptor = NULL,
+    };
+    ESP_GOTO_ON_ERROR(tinyusb_driver_install(&tusb_cfg), err_storage, TAG, "TinyUSB install failed");
+
+    bsp_usb_msc_get_stats(NULL, true);
+    msc_started = true;
+    ESP_LOGI(TAG, "SD card %" PRIu64 " MB exposed over USB, %d B per transfer",
+             (uint64_t)msc_card.csd.capacity * msc_card.csd.sector_size / (1024 * 1024), CONFIG_TINYUSB_MSC_BUFSIZE);
+    return ESP_OK;
+
+err_storage:
+    tinyusb_msc_storage_deinit();
+err:
+    sdmmc_host_deinit();
+    return ret;
+}
+
+esp_err_t bsp_usb_msc_stop(void)
+{
+    ESP_RETURN_ON_FALSE(msc_started, ESP_ERR_INVALID_STATE, TAG, "USB MSC not started");
+    ESP_RETURN_ON_ERROR(tinyusb_driver_uninstall(), TAG, "TinyUSB uninstall failed");
+    tinyusb_msc_storage_deinit();
+    sdmmc_host_deinit();
+    msc_started = false;
+    return ESP_OK;
+}
+
+esp_err_t bsp_usb_msc_get_stats(bsp_usb_msc_stats_t *stats, bool reset)
+{
+    const int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&msc_stats_lock);
+    if (stats) {
+        *stats = msc_stats;
+        stats->elapsed_us = now_us - msc_stats_start_us;
+    }
+    if (reset) {
+        memset(&msc_stats, 0, sizeof(msc_stats));
+        msc_stats_start_us = now_us;
+    }
+    portEXIT_CRITICAL(&msc_stats_lock);
+
+    if (stats) {
+        stats->read_kBps = stats->read_us ? (uint32_t)(stats->bytes_read * 1000000 / 1024 / stats->read_us) : 0;
+        stats->write_kBps = stats->write_us ? (uint32_t)(stats->bytes_written * 1000000 / 1024 / stats->write_us) : 0;
+    }
+    return ESP_OK;
+}
+
+#else // CONFIG_TINYUSB_MSC_ENABLED
+
+esp_err_t bsp_usb_msc_start(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t bsp_usb_msc_stop(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t bsp_usb_msc_get_stats(bsp_usb_msc_stats_t *stats, bool reset)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif // CONFIG_TINYUSB_MSC_ENABLED
@@ -426,6 +426,63 @@ esp_err_t bsp_usb_host_start(bsp_usb_host_power_mode_t mode, bool limit_500mA);
  */
 esp_err_t bsp_usb_host_stop(void);
 
+/**
+ * @brief USB Mass Storage statistics
+ *
+ * Throughput is computed from the time spent in SD card sector commands.
+ */
+typedef struct {
+    uint64_t bytes_read;        /*!< Bytes read from the SD card for USB host */
+    uint64_t bytes_written;     /*!< Bytes written to the SD card by USB host */
+    uint64_t read_us;           /*!< Time of SD card reads [us] */
+    uint64_t write_us;          /*!< Time of SD card writes [us] */
+    uint32_t read_cmds;         /*!< Count of multi-sector read commands */
+    uint32_t write_cmds;        /*!< Count of multi-sector write commands */
+    uint32_t read_kBps;         /*!< SD card read throughput [kB/s] */
+    uint32_t write_kBps;        /*!< SD card write throughput [kB/s] */
+    int64_t elapsed_us;         /*!< Time since start or reset of the statistics [us] */
+} bsp_usb_msc_stats_t;
+
+/**
+ * @brief Expose SD card to PC as USB Mass Storage device
+ *
+ * The board is switched to USB device mode and the SD card is initialized at high speed without filesystem.
+ * USB host reads and writes raw sectors, FATFS and VFS are not in the data path.
+ * Each SCSI transfer is split into SD card multi-sector commands of CONFIG_TINYUSB_MSC_BUFSIZE bytes,
+ * so set it to 8192 or more for high throughput.
+ *
+ * @note Requires ESP-IDF v5.0 or later and CONFIG_TINYUSB_MSC_ENABLED
+ * @note The SD card must not be mounted by bsp_sdcard_mount() at the same time
+ *
+ * @return
+ *     - ESP_OK                 On success
+ *     - ESP_ERR_INVALID_STATE  Already started or SD card mounted
+ *     - ESP_ERR_NOT_SUPPORTED  TinyUSB MSC is not enabled
+ *     - Others                 SD card or TinyUSB initialization failed
+ */
+esp_err_t bsp_usb_msc_start(void);
+
+/**
+ * @brief Stop USB Mass Storage device and release the SD card
+ *
+ * @return
+ *     - ESP_OK                 On success
+ *     - ESP_ERR_INVALID_STATE  Not started
+ *     - ESP_ERR_NOT_SUPPORTED  TinyUSB MSC is not enabled
+ */
+esp_err_t bsp_usb_msc_stop(void);
+
+/**
+ * @brief Get USB Mass Storage statistics
+ *
+ * @param[out] stats  Statistics, can be NULL for reset only
+ * @param[in]  reset  Reset the statistics after reading
+ * @return
+ *     - ESP_OK                 On success
+ *     - ESP_ERR_NOT_SUPPORTED  TinyUSB MSC is not enabled
+ */
+esp_err_t bsp_usb_msc_get_stats(bsp_usb_msc_stats_t *stats, bool reset);
+
 /**************************************************************************************************
  *
  * Voltage measurements
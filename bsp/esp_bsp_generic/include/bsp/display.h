@@ -48,6 +48,7 @@ extern "C" {
  */
 typedef struct {
     int max_transfer_sz;    /*!< Maximum transfer size, in bytes. */
+    int trans_queue_depth;  /*!< Number of SPI transactions queued in the panel IO, commands and color chunks of all draw buffers in flight (0: 10) */
 } bsp_display_config_t;
 
 /**
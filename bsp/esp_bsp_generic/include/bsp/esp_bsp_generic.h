@@ -391,6 +391,89 @@ esp_err_t bsp_led_set(led_indicator_handle_t handle, const bool on);
  */
 esp_err_t bsp_led_set_temperature(led_indicator_handle_t handle, const uint16_t temperature);
 
+#if CONFIG_BSP_LED_RGB_FRAMES
+/**
+ * @brief LED strip animation handle
+ */
+typedef struct bsp_led_frames_s *bsp_led_frames_handle_t;
+
+/**
+ * @brief Callback of rendering one frame of the animation
+ *
+ * @param frame     Index of the frame
+ * @param rgb       Colors of the LEDs (3 bytes R, G, B per LED), cleared to black before the call
+ * @param led_num   Count of the LEDs
+ * @param user_ctx  User data from the configuration
+ */
+typedef void (*bsp_led_frame_render_cb_t)(uint32_t frame, uint8_t *rgb, uint32_t led_num, void *user_ctx);
+
+/**
+ * @brief LED strip animation configuration
+ */
+typedef struct {
+    uint32_t led_num;                   /*!< Count of the LEDs in the strip (0: BSP_LED_NUM) */
+    uint32_t frame_num;                 /*!< Count of the frames, the animation is played in loop */
+    uint32_t fps;                       /*!< Frames per second */
+    bsp_led_frame_render_cb_t render_cb;/*!< Callback of rendering the frames */
+    void *user_ctx;                     /*!< User data for the callback */
+} bsp_led_frames_config_t;
+
+/**
+ * @brief Create LED strip animation
+ *
+ * All frames are rendered by the callback and encoded into the WS2812 waveform (RMT symbols or SPI bits) in advance.
+ * The playback only passes the encoded frames to the peripheral with DMA, there is no encoding while playing.
+ * Memory of the frames is 96 bytes (RMT) or 9 bytes (SPI) per LED and frame.
+ *
+ * @attention The strip is driven by its own RMT channel or SPI bus (SPI2), do not use bsp_led_indicator_create()
+ *            with the animation.
+ *
+ * @param[in]  config     Animation configuration
+ * @param[out] ret_frames Created animation
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Parameter error
+ *     - ESP_ERR_NO_MEM Not enough memory for the frames
+ *     - Else RMT or SPI failure
+ */
+esp_err_t bsp_led_frames_create(const bsp_led_frames_config_t *config, bsp_led_frames_handle_t *ret_frames);
+
+/**
+ * @brief Start playing the animation in loop
+ *
+ * A frame is skipped, if the previous frames were not sent yet (the strip is too long for the frame rate).
+ *
+ * @param frames Animation
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Parameter error
+ *     - ESP_ERR_INVALID_STATE Animation is already playing
+ */
+esp_err_t bsp_led_frames_start(bsp_led_frames_handle_t frames);
+
+/**
+ * @brief Stop playing the animation
+ *
+ * It waits until the last frame is sent, the LEDs keep it.
+ *
+ * @param frames Animation
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Parameter error
+ */
+esp_err_t bsp_led_frames_stop(bsp_led_frames_handle_t frames);
+
+/**
+ * @brief Stop and delete the animation and free its peripheral
+ *
+ * @param frames Animation
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Parameter error
+ */
+esp_err_t bsp_led_frames_delete(bsp_led_frames_handle_t frames);
+#endif // CONFIG_BSP_LED_RGB_FRAMES
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,180 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Board configuration resolved from menuconfig
+ *
+ * All board options are turned here into compile-time constants and initializers,
+ * so the BSP sources contain no runtime configuration and unselected drivers are not compiled.
+ */
+
+#pragma once
+
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************
+ *  Buttons
+ **************************************************************************************************/
+#define BSP_BUTTON_GPIO_CONFIG(io, level) \
+    { \
+        .type = BUTTON_TYPE_GPIO, \
+        .gpio_button_config.gpio_num = (io), \
+        .gpio_button_config.active_level = (level), \
+    }
+
+#define BSP_BUTTON_ADC_CONFIG(channel, index, value) \
+    { \
+        .type = BUTTON_TYPE_ADC, \
+        .adc_button_config.adc_channel = (channel), \
+        .adc_button_config.button_index = (index), \
+        .adc_button_config.min = ((value) - 100), \
+        .adc_button_config.max = ((value) + 100), \
+    }
+
+#if CONFIG_BSP_BUTTON_1_TYPE_GPIO
+#define BSP_BUTTON_1_CONFIG BSP_BUTTON_GPIO_CONFIG(BSP_BUTTON_1_IO, CONFIG_BSP_BUTTON_1_LEVEL)
+#elif CONFIG_BSP_BUTTON_1_TYPE_ADC
+#define BSP_BUTTON_1_CONFIG BSP_BUTTON_ADC_CONFIG(CONFIG_BSP_BUTTON_1_ADC_CHANNEL, BSP_BUTTON_1, CONFIG_BSP_BUTTON_1_ADC_VALUE)
+#endif
+
+#if CONFIG_BSP_BUTTON_2_TYPE_GPIO
+#define BSP_BUTTON_2_CONFIG BSP_BUTTON_GPIO_CONFIG(BSP_BUTTON_2_IO, CONFIG_BSP_BUTTON_2_LEVEL)
+#elif CONFIG_BSP_BUTTON_2_TYPE_ADC
+#define BSP_BUTTON_2_CONFIG BSP_BUTTON_ADC_CONFIG(CONFIG_BSP_BUTTON_2_ADC_CHANNEL, BSP_BUTTON_2, CONFIG_BSP_BUTTON_2_ADC_VALUE)
+#endif
+
+#if CONFIG_BSP_BUTTON_3_TYPE_GPIO
+#define BSP_BUTTON_3_CONFIG BSP_BUTTON_GPIO_CONFIG(BSP_BUTTON_3_IO, CONFIG_BSP_BUTTON_3_LEVEL)
+#elif CONFIG_BSP_BUTTON_3_TYPE_ADC
+#define BSP_BUTTON_3_CONFIG BSP_BUTTON_ADC_CONFIG(CONFIG_BSP_BUTTON_3_ADC_CHANNEL, BSP_BUTTON_3, CONFIG_BSP_BUTTON_3_ADC_VALUE)
+#endif
+
+#if CONFIG_BSP_BUTTON_4_TYPE_GPIO
+#define BSP_BUTTON_4_CONFIG BSP_BUTTON_GPIO_CONFIG(BSP_BUTTON_4_IO, CONFIG_BSP_BUTTON_4_LEVEL)
+#elif CONFIG_BSP_BUTTON_4_TYPE_ADC
+#define BSP_BUTTON_4_CONFIG BSP_BUTTON_ADC_CONFIG(CONFIG_BSP_BUTTON_4_ADC_CHANNEL, BSP_BUTTON_4, CONFIG_BSP_BUTTON_4_ADC_VALUE)
+#endif
+
+#if CONFIG_BSP_BUTTON_5_TYPE_GPIO
+#define BSP_BUTTON_5_CONFIG BSP_BUTTON_GPIO_CONFIG(BSP_BUTTON_5_IO, CONFIG_BSP_BUTTON_5_LEVEL)
+#elif CONFIG_BSP_BUTTON_5_TYPE_ADC
+#define BSP_BUTTON_5_CONFIG BSP_BUTTON_ADC_CONFIG(CONFIG_BSP_BUTTON_5_ADC_CHANNEL, BSP_BUTTON_5, CONFIG_BSP_BUTTON_5_ADC_VALUE)
+#endif
+
+/**************************************************************************************************
+ *  LEDs
+ **************************************************************************************************/
+#define BSP_LED_GPIO_CONFIG(io, level) \
+    { \
+        .is_active_level_high = (level), \
+        .gpio_num = (io), \
+    }
+
+#define BSP_LED_INDICATOR_CONFIG(led_mode, cfg_member, cfg) \
+    { \
+        .mode = (led_mode), \
+        .cfg_member = (cfg), \
+        .blink_lists = bsp_led_blink_defaults_lists, \
+        .blink_list_num = BSP_LED_MAX, \
+    }
+
+/**************************************************************************************************
+ *  Display
+ **************************************************************************************************/
+#if CONFIG_BSP_DISPLAY_ENABLED
+
+#if CONFIG_BSP_DISPLAY_DRIVER_ST7789
+#define BSP_LCD_DRIVER_NAME         "ST7789"
+#define bsp_lcd_new_panel           esp_lcd_new_panel_st7789
+#elif CONFIG_BSP_DISPLAY_DRIVER_ILI9341
+#define BSP_LCD_DRIVER_NAME         "ILI9341"
+#define bsp_lcd_new_panel           esp_lcd_new_panel_ili9341
+#elif CONFIG_BSP_DISPLAY_DRIVER_GC9A01
+#define BSP_LCD_DRIVER_NAME         "GC9A01"
+#define bsp_lcd_new_panel           esp_lcd_new_panel_gc9a01
+#endif
+
+#if CONFIG_BSP_DISPLAY_ROTATION_SWAP_XY
+#define BSP_LCD_SWAP_XY 1
+#else
+#define BSP_LCD_SWAP_XY 0
+#endif
+#if CONFIG_BSP_DISPLAY_ROTATION_MIRROR_X
+#define BSP_LCD_MIRROR_X 1
+#else
+#define BSP_LCD_MIRROR_X 0
+#endif
+#if CONFIG_BSP_DISPLAY_ROTATION_MIRROR_Y
+#define BSP_LCD_MIRROR_Y 1
+#else
+#define BSP_LCD_MIRROR_Y 0
+#endif
+#if CONFIG_BSP_DISPLAY_INVERT_COLOR
+#define BSP_LCD_INVERT_COLOR 1
+#else
+#define BSP_LCD_INVERT_COLOR 0
+#endif
+#if CONFIG_BSP_LCD_DRAW_BUF_DOUBLE
+#define BSP_LCD_DRAW_BUF_DOUBLE 1
+#else
+#define BSP_LCD_DRAW_BUF_DOUBLE 0
+#endif
+
+#endif // CONFIG_BSP_DISPLAY_ENABLED
+
+/**************************************************************************************************
+ *  Touch
+ **************************************************************************************************/
+#if CONFIG_BSP_TOUCH_ENABLED
+
+#if CONFIG_BSP_TOUCH_DRIVER_TT21100
+#define BSP_TOUCH_DRIVER_NAME       "TT21100"
+#define BSP_TOUCH_IO_I2C_CONFIG     ESP_LCD_TOUCH_IO_I2C_TT21100_CONFIG
+#define bsp_touch_new_i2c           esp_lcd_touch_new_i2c_tt21100
+#elif CONFIG_BSP_TOUCH_DRIVER_GT1151
+#define BSP_TOUCH_DRIVER_NAME       "GT1151"
+#define BSP_TOUCH_IO_I2C_CONFIG     ESP_LCD_TOUCH_IO_I2C_GT1151_CONFIG
+#define bsp_touch_new_i2c           esp_lcd_touch_new_i2c_gt1151
+#elif CONFIG_BSP_TOUCH_DRIVER_GT911
+#define BSP_TOUCH_DRIVER_NAME       "GT911"
+#define BSP_TOUCH_IO_I2C_CONFIG     ESP_LCD_TOUCH_IO_I2C_GT911_CONFIG
+#define bsp_touch_new_i2c           esp_lcd_touch_new_i2c_gt911
+#elif CONFIG_BSP_TOUCH_DRIVER_CST816S
+#define BSP_TOUCH_DRIVER_NAME       "CST816S"
+#define BSP_TOUCH_IO_I2C_CONFIG     ESP_LCD_TOUCH_IO_I2C_CST816S_CONFIG
+#define bsp_touch_new_i2c           esp_lcd_touch_new_i2c_cst816s
+#elif CONFIG_BSP_TOUCH_DRIVER_FT5X06
+#define BSP_TOUCH_DRIVER_NAME       "FT5X06"
+#define BSP_TOUCH_IO_I2C_CONFIG     ESP_LCD_TOUCH_IO_I2C_FT5X06_CONFIG
+#define bsp_touch_new_i2c           esp_lcd_touch_new_i2c_ft5x06
+#endif
+
+#if CONFIG_BSP_TOUCH_ROTATION_SWAP_XY
+#define BSP_TOUCH_SWAP_XY 1
+#else
+#define BSP_TOUCH_SWAP_XY 0
+#endif
+#if CONFIG_BSP_TOUCH_ROTATION_MIRROR_X
+#define BSP_TOUCH_MIRROR_X 1
+#else
+#define BSP_TOUCH_MIRROR_X 0
+#endif
+#if CONFIG_BSP_TOUCH_ROTATION_MIRROR_Y
+#define BSP_TOUCH_MIRROR_Y 1
+#else
+#define BSP_TOUCH_MIRROR_Y 0
+#endif
+
+#endif // CONFIG_BSP_TOUCH_ENABLED
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,330 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_attr.h"
+#include "esp_bit_defs.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "soc/soc_caps.h"
+
+#include "bsp/esp_bsp_generic.h"
+
+#if CONFIG_BSP_LED_RGB_BACKEND_RMT
+#include "driver/rmt_tx.h"
+#elif CONFIG_BSP_LED_RGB_BACKEND_SPI
+#include "driver/spi_master.h"
+#endif
+
+static const char *TAG = "BSP-LED-Frames";
+
+/* Frames queued in the peripheral, the next frame is queued while the previous one is sent */
+#define BSP_LED_FRAMES_QUEUE    (2)
+
+#if CONFIG_BSP_LED_RGB_BACKEND_RMT
+/* WS2812 timing in ticks of 10 MHz: 0 = 0.3 us high + 0.9 us low, 1 = 0.9 us high + 0.3 us low, reset 50 us low */
+#define BSP_LED_RMT_RESOLUTION  (10 * 1000 * 1000)
+#define BSP_LED_RMT_BIT0        ((rmt_symbol_word_t){.level0 = 1, .duration0 = 3, .level1 = 0, .duration1 = 9})
+#define BSP_LED_RMT_BIT1        ((rmt_symbol_word_t){.level0 = 1, .duration0 = 9, .level1 = 0, .duration1 = 3})
+#define BSP_LED_RMT_RESET       ((rmt_symbol_word_t){.level0 = 0, .duration0 = 250, .level1 = 0, .duration1 = 250})
+#define BSP_LED_FRAME_SIZE(n)   (((n) * 24 + 1) * sizeof(rmt_symbol_word_t))
+#elif CONFIG_BSP_LED_RGB_BACKEND_SPI
+/* WS2812 timing by 3 SPI bits of 2.5 MHz for one LED bit: 0 = 100, 1 = 110, reset 50 us (16 zero bytes) */
+#define BSP_LED_SPI_CLOCK       (2500 * 1000)
+#define BSP_LED_SPI_HOST        (SPI2_HOST)
+#define BSP_LED_SPI_RESET_BYTES (16)
+#define BSP_LED_FRAME_SIZE(n)   ((n) * 9 + BSP_LED_SPI_RESET_BYTES)
+#endif
+
+struct bsp_led_frames_s {
+    uint8_t *buf;               /* Encoded frames, one after the other */
+    size_t frame_size;          /* Size of one encoded frame in bytes */
+    uint32_t frame_num;         /* Count of frames */
+    uint32_t frame;             /* Next sent frame */
+    uint32_t period_us;         /* Frame period */
+    esp_timer_handle_t timer;
+    atomic_uint pending;        /* Frames queued in the peripheral */
+    bool running;
+#if CONFIG_BSP_LED_RGB_BACKEND_RMT
+    rmt_channel_handle_t chan;
+    rmt_encoder_handle_t encoder;
+#elif CONFIG_BSP_LED_RGB_BACKEND_SPI
+    spi_device_handle_t spi;
+    spi_transaction_t trans[BSP_LED_FRAMES_QUEUE];
+#endif
+};
+
+#if CONFIG_BSP_LED_RGB_BACKEND_RMT
+static void bsp_led_frame_encode(uint8_t *dst, const uint8_t *rgb, uint32_t led_num)
+{
+    rmt_symbol_word_t *symbol = (rmt_symbol_word_t *)dst;
+    for (uint32_t i = 0; i < led_num; i++) {
+        /* WS2812 pixel format is GRB, MSB first */
+        const uint8_t grb[3] = {rgb[i * 3 + 1], rgb[i * 3 + 0], rgb[i * 3 + 2]};
+        for (int c = 0; c < 3; c++) {
+            for (int bit = 7; bit >= 0; bit--) {
+                *symbol++ = (grb[c] & BIT(bit)) ? BSP_LED_RMT_BIT1 : BSP_LED_RMT_BIT0;
+            }
+        }
+    }
+    *symbol = BSP_LED_RMT_RESET;
+}
+
+static bool IRAM_ATTR bsp_led_frames_rmt_done(rmt_channel_handle_t chan, const rmt_tx_done_event_data_t *edata, void *user_ctx)
+{
+    bsp_led_frames_handle_t frames = (bsp_led_frames_handle_t)user_ctx;
+    atomic_fetch_sub(&frames->pending, 1);
+    return false;
+}
+
+static esp_err_t bsp_led_frames_periph_init(bsp_led_frames_handle_t frames)
+{
+    const rmt_tx_channel_config_t rmt_config = {
+        .gpio_num = CONFIG_BSP_LED_RGB_GPIO,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = BSP_LED_RMT_RESOLUTION,
+#if SOC_RMT_SUPPORT_DMA
+        .mem_block_symbols = 1024,
+        .flags.with_dma = true,
+#else
+        .mem_block_symbols = SOC_RMT_MEM_WORDS_PER_CHANNEL,
+#endif
+        .trans_queue_depth = BSP_LED_FRAMES_QUEUE,
+    };
+    ESP_RETURN_ON_ERROR(rmt_new_tx_channel(&rmt_config, &frames->chan), TAG, "RMT channel init failed");
+
+    /* Frames are already encoded into RMT symbols, they are only copied to the RMT memory (DMA buffer) */
+    const rmt_copy_encoder_config_t encoder_config = {};
+    ESP_RETURN_ON_ERROR(rmt_new_copy_encoder(&encoder_config, &frames->encoder), TAG, "RMT encoder init failed");
+
+    const rmt_tx_event_callbacks_t cbs = {
+        .on_trans_done = bsp_led_frames_rmt_done,
+    };
+    ESP_RETURN_ON_ERROR(rmt_tx_register_event_callbacks(frames->chan, &cbs, frames), TAG, "RMT callback failed");
+    return rmt_enable(frames->chan);
+}
+
+static void bsp_led_frames_periph_deinit(bsp_led_frames_handle_t frames)
+{
+    if (frames->encoder) {
+        rmt_del_encoder(frames->encoder);
+    }
+    if (frames->chan) {
+        rmt_disable(frames->chan);
+        rmt_del_channel(frames->chan);
+    }
+}
+
+static esp_err_t bsp_led_frames_send(bsp_led_frames_handle_t frames, const uint8_t *frame)
+{
+    const rmt_transmit_config_t tx_config = {
+        .loop_count = 0,
+    };
+    return rmt_transmit(frames->chan, frames->encoder, frame, frames->frame_size, &tx_config);
+}
+
+static void bsp_led_frames_wait_done(bsp_led_frames_handle_t frames)
+{
+    rmt_tx_wait_all_done(frames->chan, -1);
+}
+#elif CONFIG_BSP_LED_RGB_BACKEND_SPI
+static void bsp_led_frame_encode(uint8_t *dst, const uint8_t *rgb, uint32_t led_num)
+{
+    for (uint32_t i = 0; i < led_num; i++) {
+        /* WS2812 pixel format is GRB, MSB first */
+        const uint8_t grb[3] = {rgb[i * 3 + 1], rgb[i * 3 + 0], rgb[i * 3 + 2]};
+        for (int c = 0; c < 3; c++) {
+            /* 8 LED bits are 24 SPI bits */
+            uint32_t bits = 0;
+            for (int bit = 7; bit >= 0; bit--) {
+                bits = (bits << 3) | ((grb[c] & BIT(bit)) ? 0x6 : 0x4);
+            }
+            *dst++ = bits >> 16;
+            *dst++ = bits >> 8;
+            *dst++ = bits;
+        }
+    }
+    memset(dst, 0, BSP_LED_SPI_RESET_BYTES);
+}
+
+static void bsp_led_frames_spi_done(spi_transaction_t *trans)
+{
+    bsp_led_frames_handle_t frames = (bsp_led_frames_handle_t)trans->user;
+    atomic_fetch_sub(&frames->pending, 1);
+}
+
+static esp_err_t bsp_led_frames_periph_init(bsp_led_frames_handle_t frames)
+{
+    const spi_bus_config_t buscfg = {
+        .mosi_io_num = CONFIG_BSP_LED_RGB_GPIO,
+        .miso_io_num = GPIO_NUM_NC,
+        .sclk_io_num = GPIO_NUM_NC,
+        .quadwp_io_num = GPIO_NUM_NC,
+        .quadhd_io_num = GPIO_NUM_NC,
+        .max_transfer_sz = frames->frame_size,
+    };
+    ESP_RETURN_ON_ERROR(spi_bus_initialize(BSP_LED_SPI_HOST, &buscfg, SPI_DMA_CH_AUTO), TAG, "SPI init failed");
+
+    const spi_device_interface_config_t devcfg = {
+        .clock_speed_hz = BSP_LED_SPI_CLOCK,
+        .mode = 0,
+        .spics_io_num = GPIO_NUM_NC,
+        .queue_size = BSP_LED_FRAMES_QUEUE,
+        .post_cb = bsp_led_frames_spi_done,
+    };
+    const esp_err_t ret = spi_bus_add_device(BSP_LED_SPI_HOST, &devcfg, &frames->spi);
+    if (ret != ESP_OK) {
+        spi_bus_free(BSP_LED_SPI_HOST);
+    }
+    return ret;
+}
+
+static void bsp_led_frames_periph_deinit(bsp_led_frames_handle_t frames)
+{
+    if (frames->spi) {
+        spi_bus_remove_device(frames->spi);
+        spi_bus_free(BSP_LED_SPI_HOST);
+    }
+}
+
+static esp_err_t bsp_led_frames_send(bsp_led_frames_handle_t frames, const uint8_t *frame)
+{
+    spi_transaction_t *trans;
+
+    /* Collect finished transaction, its descriptor is used for this frame */
+    while (spi_device_get_trans_result(frames->spi, &trans, 0) == ESP_OK) {
+    }
+    trans = &frames->trans[frames->frame % BSP_LED_FRAMES_QUEUE];
+    memset(trans, 0, sizeof(spi_transaction_t));
+    trans->length = frames->frame_size * 8;
+    trans->tx_buffer = frame;
+    trans->user = frames;
+    return spi_device_queue_trans(frames->spi, trans, 0);
+}
+
+static void bsp_led_frames_wait_done(bsp_led_frames_handle_t frames)
+{
+    spi_transaction_t *trans;
+    while (atomic_load(&frames->pending) > 0) {
+        spi_device_get_trans_result(frames->spi, &trans, portMAX_DELAY);
+    }
+    while (spi_device_get_trans_result(frames->spi, &trans, 0) == ESP_OK) {
+    }
+}
+#endif
+
+static void bsp_led_frames_timer_cb(void *arg)
+{
+    bsp_led_frames_handle_t frames = (bsp_led_frames_handle_t)arg;
+
+    /* Frame is skipped, if the strip is longer than the frame period allows */
+    if (atomic_load(&frames->pending) >= BSP_LED_FRAMES_QUEUE) {
+        return;
+    }
+    atomic_fetch_add(&frames->pending, 1);
+    if (bsp_led_frames_send(frames, frames->buf + frames->frame * frames->frame_size) != ESP_OK) {
+        atomic_fetch_sub(&frames->pending, 1);
+        return;
+    }
+    frames->frame = (frames->frame + 1) % frames->frame_num;
+}
+
+esp_err_t bsp_led_frames_create(const bsp_led_frames_config_t *config, bsp_led_frames_handle_t *ret_frames)
+{
+    esp_err_t ret = ESP_OK;
+    uint8_t *rgb = NULL;
+    ESP_RETURN_ON_FALSE(config && ret_frames && config->render_cb, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+    ESP_RETURN_ON_FALSE(config->frame_num > 0 && config->fps > 0, ESP_ERR_INVALID_ARG, TAG, "invalid frame count or rate");
+
+    const uint32_t led_num = config->led_num ? config->led_num : BSP_LED_NUM;
+    bsp_led_frames_handle_t frames = calloc(1, sizeof(struct bsp_led_frames_s));
+    ESP_RETURN_ON_FALSE(frames, ESP_ERR_NO_MEM, TAG, "Not enough memory");
+    frames->frame_size = BSP_LED_FRAME_SIZE(led_num);
+    frames->frame_num = config->frame_num;
+    frames->period_us = 1000000 / config->fps;
+    atomic_init(&frames->pending, 0);
+
+#if CONFIG_BSP_LED_RGB_BACKEND_SPI
+    frames->buf = heap_caps_malloc(frames->frame_size * frames->frame_num, MALLOC_CAP_DMA);
+#else
+    frames->buf = heap_caps_malloc(frames->frame_size * frames->frame_num, MALLOC_CAP_DEFAULT);
+#endif
+    rgb = malloc(led_num * 3);
+    ESP_GOTO_ON_FALSE(frames->buf && rgb, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for frames");
+
+    /* All frames are rendered and encoded now, the playback only passes them to the peripheral */
+    for (uint32_t i = 0; i < frames->frame_num; i++) {
+        memset(rgb, 0, led_num * 3);
+        config->render_cb(i, rgb, led_num, config->user_ctx);
+        bsp_led_frame_encode(frames->buf + i * frames->frame_size, rgb, led_num);
+    }
+    free(rgb);
+    rgb = NULL;
+
+    ESP_GOTO_ON_ERROR(bsp_led_frames_periph_init(frames), err, TAG, "LED strip peripheral init failed");
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = bsp_led_frames_timer_cb,
+        .arg = frames,
+        .name = "bsp_led_frames",
+    };
+    ESP_GOTO_ON_ERROR(esp_timer_create(&timer_args, &frames->timer), err, TAG, "Timer create failed");
+
+    *ret_frames = frames;
+    return ESP_OK;
+
+err:
+    free(rgb);
+    bsp_led_frames_periph_deinit(frames);
+    free(frames->buf);
+    free(frames);
+    return ret;
+}
+
+esp_err_t bsp_led_frames_start(bsp_led_frames_handle_t frames)
+{
+    ESP_RETURN_ON_FALSE(frames, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+    ESP_RETURN_ON_FALSE(!frames->running, ESP_ERR_INVALID_STATE, TAG, "already running");
+
+    frames->frame = 0;
+    if (frames->frame_num == 1) {
+        /* Static picture, WS2812 keeps it until the next frame */
+        bsp_led_frames_timer_cb(frames);
+        return ESP_OK;
+    }
+    ESP_RETURN_ON_ERROR(esp_timer_start_periodic(frames->timer, frames->period_us), TAG, "Timer start failed");
+    frames->running = true;
+    return ESP_OK;
+}
+
+esp_err_t bsp_led_frames_stop(bsp_led_frames_handle_t frames)
+{
+    ESP_RETURN_ON_FALSE(frames, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+
+    if (frames->running) {
+        esp_timer_stop(frames->timer);
+        frames->running = false;
+    }
+    bsp_led_frames_wait_done(frames);
+    return ESP_OK;
+}
+
+esp_err_t bsp_led_frames_delete(bsp_led_frames_handle_t frames)
+{
+    ESP_RETURN_ON_FALSE(frames, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+
+    bsp_led_frames_stop(frames);
+    esp_timer_delete(frames->timer);
+    bsp_led_frames_periph_deinit(frames);
+    free(frames->buf);
+    free(frames);
+    return ESP_OK;
+}
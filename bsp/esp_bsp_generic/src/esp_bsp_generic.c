@@ -13,6 +13,7 @@
 
 #include "bsp/esp_bsp_generic.h"
 #include "bsp_err_check.h"
+#include "bsp_generic_config.h"
 
 #if CONFIG_BSP_DISPLAY_ENABLED
 #include "driver/spi_master.h"
@@ -57,136 +58,43 @@ static esp_lcd_touch_handle_t tp;   // LCD touch handle
 
 sdmmc_card_t *bsp_sdcard = NULL;    // Global uSD card handler
 static bool i2c_initialized = false;
+#if CONFIG_BSP_LEDS_NUM > 0
 extern blink_step_t const *bsp_led_blink_defaults_lists[];
+#endif
 
-static const button_config_t bsp_button_config[] = {
+static const button_config_t bsp_button_config[BSP_BUTTON_NUM] = {
 #if CONFIG_BSP_BUTTONS_NUM > 0
-#if CONFIG_BSP_BUTTON_1_TYPE_GPIO
-    {
-        .type = BUTTON_TYPE_GPIO,
-        .gpio_button_config.gpio_num = BSP_BUTTON_1_IO,
-        .gpio_button_config.active_level = CONFIG_BSP_BUTTON_1_LEVEL,
-    },
-#elif CONFIG_BSP_BUTTON_1_TYPE_ADC
-    {
-        .type = BUTTON_TYPE_ADC,
-        .adc_button_config.adc_channel = CONFIG_BSP_BUTTON_1_ADC_CHANNEL,
-        .adc_button_config.button_index = BSP_BUTTON_1,
-        .adc_button_config.min = (CONFIG_BSP_BUTTON_1_ADC_VALUE - 100),
-        .adc_button_config.max = (CONFIG_BSP_BUTTON_1_ADC_VALUE + 100)
-    },
-#endif // CONFIG_BSP_BUTTON_1_TYPE_x
-#endif // CONFIG_BSP_BUTTONS_NUM >= 0
-
+    BSP_BUTTON_1_CONFIG,
+#endif
 #if CONFIG_BSP_BUTTONS_NUM > 1
-#if CONFIG_BSP_BUTTON_2_TYPE_GPIO
-    {
-        .type = BUTTON_TYPE_GPIO,
-        .gpio_button_config.gpio_num = BSP_BUTTON_2_IO,
-        .gpio_button_config.active_level = CONFIG_BSP_BUTTON_2_LEVEL,
-    },
-
-#elif CONFIG_BSP_BUTTON_2_TYPE_ADC
-    {
-        .type = BUTTON_TYPE_ADC,
-        .adc_button_config.adc_channel = CONFIG_BSP_BUTTON_2_ADC_CHANNEL,
-        .adc_button_config.button_index = BSP_BUTTON_2,
-        .adc_button_config.min = (CONFIG_BSP_BUTTON_2_ADC_VALUE - 100),
-        .adc_button_config.max = (CONFIG_BSP_BUTTON_2_ADC_VALUE + 100)
-    },
-#endif // CONFIG_BSP_BUTTON_2_TYPE_x
-#endif // CONFIG_BSP_BUTTONS_NUM >= 1
-
+    BSP_BUTTON_2_CONFIG,
+#endif
 #if CONFIG_BSP_BUTTONS_NUM > 2
-#if CONFIG_BSP_BUTTON_3_TYPE_GPIO
-    {
-        .type = BUTTON_TYPE_GPIO,
-        .gpio_button_config.gpio_num = BSP_BUTTON_3_IO,
-        .gpio_button_config.active_level = CONFIG_BSP_BUTTON_3_LEVEL,
-    },
-
-#elif CONFIG_BSP_BUTTON_3_TYPE_ADC
-    {
-        .type = BUTTON_TYPE_ADC,
-        .adc_button_config.adc_channel = CONFIG_BSP_BUTTON_3_ADC_CHANNEL,
-        .adc_button_config.button_index = BSP_BUTTON_3,
-        .adc_button_config.min = (CONFIG_BSP_BUTTON_3_ADC_VALUE - 100),
-        .adc_button_config.max = (CONFIG_BSP_BUTTON_3_ADC_VALUE + 100)
-    },
-#endif // CONFIG_BSP_BUTTON_3_TYPE_x
-#endif // CONFIG_BSP_BUTTONS_NUM >= 2
-
+    BSP_BUTTON_3_CONFIG,
+#endif
 #if CONFIG_BSP_BUTTONS_NUM > 3
-#if CONFIG_BSP_BUTTON_4_TYPE_GPIO
-    {
-        .type = BUTTON_TYPE_GPIO,
-        .gpio_button_config.gpio_num = BSP_BUTTON_4_IO,
-        .gpio_button_config.active_level = CONFIG_BSP_BUTTON_4_LEVEL,
-    },
-
-#elif CONFIG_BSP_BUTTON_4_TYPE_ADC
-    {
-        .type = BUTTON_TYPE_ADC,
-        .adc_button_config.adc_channel = CONFIG_BSP_BUTTON_4_ADC_CHANNEL,
-        .adc_button_config.button_index = BSP_BUTTON_4,
-        .adc_button_config.min = (CONFIG_BSP_BUTTON_4_ADC_VALUE - 100),
-        .adc_button_config.max = (CONFIG_BSP_BUTTON_4_ADC_VALUE + 100)
-    },
-#endif // CONFIG_BSP_BUTTON_4_TYPE_x
-#endif // CONFIG_BSP_BUTTONS_NUM >= 3
-
+    BSP_BUTTON_4_CONFIG,
+#endif
 #if CONFIG_BSP_BUTTONS_NUM > 4
-#if CONFIG_BSP_BUTTON_5_TYPE_GPIO
-    {
-        .type = BUTTON_TYPE_GPIO,
-        .gpio_button_config.gpio_num = BSP_BUTTON_5_IO,
-        .gpio_button_config.active_level = CONFIG_BSP_BUTTON_5_LEVEL,
-    },
-
-#elif CONFIG_BSP_BUTTON_5_TYPE_ADC
-    {
-        .type = BUTTON_TYPE_ADC,
-        .adc_button_config.adc_channel = CONFIG_BSP_BUTTON_5_ADC_CHANNEL,
-        .adc_button_config.button_index = BSP_BUTTON_5,
-        .adc_button_config.min = (CONFIG_BSP_BUTTON_5_ADC_VALUE - 100),
-        .adc_button_config.max = (CONFIG_BSP_BUTTON_5_ADC_VALUE + 100)
-    }
-#endif // CONFIG_BSP_BUTTON_5_TYPE_x
-#endif // CONFIG_BSP_BUTTONS_NUM >= 4
+    BSP_BUTTON_5_CONFIG,
+#endif
 };
 
-#if CONFIG_BSP_LED_TYPE_GPIO
-static led_indicator_gpio_config_t bsp_leds_gpio_config[] = {
-    {
-#if CONFIG_BSP_LED_1_LEVEL && CONFIG_BSP_LED_1_GPIO
-        .is_active_level_high = CONFIG_BSP_LED_1_LEVEL,
-        .gpio_num = CONFIG_BSP_LED_1_GPIO,
-#endif
-    },
-    {
-#if CONFIG_BSP_LED_2_LEVEL && CONFIG_BSP_LED_2_GPIO
-        .is_active_level_high = CONFIG_BSP_LED_2_LEVEL,
-        .gpio_num = CONFIG_BSP_LED_2_GPIO,
+#if CONFIG_BSP_LED_TYPE_GPIO && CONFIG_BSP_LEDS_NUM > 0
+static led_indicator_gpio_config_t bsp_leds_gpio_config[BSP_LED_NUM] = {
+    BSP_LED_GPIO_CONFIG(BSP_LED_1_IO, CONFIG_BSP_LED_1_LEVEL),
+#if CONFIG_BSP_LEDS_NUM > 1
+    BSP_LED_GPIO_CONFIG(BSP_LED_2_IO, CONFIG_BSP_LED_2_LEVEL),
 #endif
-    },
-    {
-#if CONFIG_BSP_LED_3_LEVEL && CONFIG_BSP_LED_3_GPIO
-        .is_active_level_high = CONFIG_BSP_LED_3_LEVEL,
-        .gpio_num = CONFIG_BSP_LED_3_GPIO,
+#if CONFIG_BSP_LEDS_NUM > 2
+    BSP_LED_GPIO_CONFIG(BSP_LED_3_IO, CONFIG_BSP_LED_3_LEVEL),
 #endif
-    },
-    {
-#if CONFIG_BSP_LED_4_LEVEL && CONFIG_BSP_LED_4_GPIO
-        .is_active_level_high = CONFIG_BSP_LED_4_LEVEL,
-        .gpio_num = CONFIG_BSP_LED_4_GPIO,
+#if CONFIG_BSP_LEDS_NUM > 3
+    BSP_LED_GPIO_CONFIG(BSP_LED_4_IO, CONFIG_BSP_LED_4_LEVEL),
 #endif
-    },
-    {
-#if CONFIG_BSP_LED_5_LEVEL && CONFIG_BSP_LED_5_GPIO
-        .is_active_level_high = CONFIG_BSP_LED_5_LEVEL,
-        .gpio_num = CONFIG_BSP_LED_5_GPIO,
+#if CONFIG_BSP_LEDS_NUM > 4
+    BSP_LED_GPIO_CONFIG(BSP_LED_5_IO, CONFIG_BSP_LED_5_LEVEL),
 #endif
-    }
 };
 #endif // CONFIG_BSP_LED_TYPE_GPIO
 
@@ -244,65 +152,29 @@ static led_indicator_rgb_config_t bsp_leds_rgb_config = {
 
 #endif // CONFIG_BSP_LED_TYPE_RGB
 
+#if CONFIG_BSP_LEDS_NUM > 0
 static const led_indicator_config_t bsp_leds_config[BSP_LED_NUM] = {
 #if CONFIG_BSP_LED_TYPE_RGB
-    {
-        .mode = LED_STRIPS_MODE,
-        .led_indicator_strips_config = &bsp_leds_rgb_config,
-        .blink_lists = bsp_led_blink_defaults_lists,
-        .blink_list_num = BSP_LED_MAX,
-    },
+    BSP_LED_INDICATOR_CONFIG(LED_STRIPS_MODE, led_indicator_strips_config, &bsp_leds_rgb_config),
 #elif CONFIG_BSP_LED_TYPE_RGB_CLASSIC
-    {
-        .mode = LED_RGB_MODE,
-        .led_indicator_rgb_config = &bsp_leds_rgb_config,
-        .blink_lists = bsp_led_blink_defaults_lists,
-        .blink_list_num = BSP_LED_MAX,
-    },
+    BSP_LED_INDICATOR_CONFIG(LED_RGB_MODE, led_indicator_rgb_config, &bsp_leds_rgb_config),
 #elif CONFIG_BSP_LED_TYPE_GPIO
-
-#if CONFIG_BSP_LEDS_NUM > 0
-    {
-        .mode = LED_GPIO_MODE,
-        .led_indicator_gpio_config = &bsp_leds_gpio_config[0],
-        .blink_lists = bsp_led_blink_defaults_lists,
-        .blink_list_num = BSP_LED_MAX,
-    },
-#endif  // CONFIG_BSP_LEDS_NUM > 0
+    BSP_LED_INDICATOR_CONFIG(LED_GPIO_MODE, led_indicator_gpio_config, &bsp_leds_gpio_config[0]),
 #if CONFIG_BSP_LEDS_NUM > 1
-    {
-        .mode = LED_GPIO_MODE,
-        .led_indicator_gpio_config = &bsp_leds_gpio_config[1],
-        .blink_lists = bsp_led_blink_defaults_lists,
-        .blink_list_num = BSP_LED_MAX,
-    },
-#endif  // CONFIG_BSP_LEDS_NUM > 1
+    BSP_LED_INDICATOR_CONFIG(LED_GPIO_MODE, led_indicator_gpio_config, &bsp_leds_gpio_config[1]),
+#endif
 #if CONFIG_BSP_LEDS_NUM > 2
-    {
-        .mode = LED_GPIO_MODE,
-        .led_indicator_gpio_config = &bsp_leds_gpio_config[2],
-        .blink_lists = bsp_led_blink_defaults_lists,
-        .blink_list_num = BSP_LED_MAX,
-    },
-#endif  // CONFIG_BSP_LEDS_NUM > 2
+    BSP_LED_INDICATOR_CONFIG(LED_GPIO_MODE, led_indicator_gpio_config, &bsp_leds_gpio_config[2]),
+#endif
 #if CONFIG_BSP_LEDS_NUM > 3
-    {
-        .mode = LED_GPIO_MODE,
-        .led_indicator_gpio_config = &bsp_leds_gpio_config[3],
-        .blink_lists = bsp_led_blink_defaults_lists,
-        .blink_list_num = BSP_LED_MAX,
-    },
-#endif  // CONFIG_BSP_LEDS_NUM > 3
+    BSP_LED_INDICATOR_CONFIG(LED_GPIO_MODE, led_indicator_gpio_config, &bsp_leds_gpio_config[3]),
+#endif
 #if CONFIG_BSP_LEDS_NUM > 4
-    {
-        .mode = LED_GPIO_MODE,
-        .led_indicator_gpio_config = &bsp_leds_gpio_config[4],
-        .blink_lists = bsp_led_blink_defaults_lists,
-        .blink_list_num = BSP_LED_MAX,
-    },
-#endif  // CONFIG_BSP_LEDS_NUM > 4
+    BSP_LED_INDICATOR_CONFIG(LED_GPIO_MODE, led_indicator_gpio_config, &bsp_leds_gpio_config[4]),
+#endif
 #endif // CONFIG_BSP_LED_TYPE_RGB/CONFIG_BSP_LED_TYPE_GPIO
 };
+#endif // CONFIG_BSP_LEDS_NUM > 0
 
 esp_err_t bsp_i2c_init(void)
 {
@@ -505,7 +377,7 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
         .lcd_cmd_bits = LCD_CMD_BITS,
         .lcd_param_bits = LCD_PARAM_BITS,
         .spi_mode = 0,
-        .trans_queue_depth = 10,
+        .trans_queue_depth = (config->trans_queue_depth > 0) ? config->trans_queue_depth : 10,
     };
     ESP_GOTO_ON_ERROR(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)BSP_LCD_SPI_NUM, &io_config, ret_io), err, TAG, "New panel IO failed");
 
@@ -515,39 +387,14 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
         .color_space = BSP_LCD_COLOR_SPACE,
         .bits_per_pixel = BSP_LCD_BITS_PER_PIXEL,
     };
-#if CONFIG_BSP_DISPLAY_DRIVER_ST7789
-    ESP_GOTO_ON_ERROR(esp_lcd_new_panel_st7789(*ret_io, &panel_config, ret_panel), err, TAG, "New panel failed");
-    ESP_LOGI(TAG, "Initialize LCD: ST7789");
-#elif CONFIG_BSP_DISPLAY_DRIVER_ILI9341
-    ESP_GOTO_ON_ERROR(esp_lcd_new_panel_ili9341(*ret_io, &panel_config, ret_panel), err, TAG, "New panel failed");
-    ESP_LOGI(TAG, "Initialize LCD: ILI9341");
-#elif CONFIG_BSP_DISPLAY_DRIVER_GC9A01
-    ESP_GOTO_ON_ERROR(esp_lcd_new_panel_gc9a01(*ret_io, &panel_config, ret_panel), err, TAG, "New panel failed");
-    ESP_LOGI(TAG, "Initialize LCD: GC9A01");
-#endif
+    ESP_GOTO_ON_ERROR(bsp_lcd_new_panel(*ret_io, &panel_config, ret_panel), err, TAG, "New panel failed");
+    ESP_LOGI(TAG, "Initialize LCD: " BSP_LCD_DRIVER_NAME);
     esp_lcd_panel_reset(*ret_panel);
     esp_lcd_panel_init(*ret_panel);
 
-    bool disp_swap_xy = false;
-    bool disp_mirror_x = false;
-    bool disp_mirror_y = false;
-    bool disp_invert_color = false;
-#if CONFIG_BSP_DISPLAY_ROTATION_SWAP_XY
-    disp_swap_xy = true;
-#endif
-#if CONFIG_BSP_DISPLAY_ROTATION_MIRROR_X
-    disp_mirror_x = true;
-#endif
-#if CONFIG_BSP_DISPLAY_ROTATION_MIRROR_Y
-    disp_mirror_y = true;
-#endif
-#if CONFIG_BSP_DISPLAY_INVERT_COLOR
-    disp_invert_color = true;
-#endif
-
-    esp_lcd_panel_mirror(*ret_panel, disp_mirror_x, disp_mirror_y);
-    esp_lcd_panel_swap_xy(*ret_panel, disp_swap_xy);
-    esp_lcd_panel_invert_color(*ret_panel, disp_invert_color);
+    esp_lcd_panel_mirror(*ret_panel, BSP_LCD_MIRROR_X, BSP_LCD_MIRROR_Y);
+    esp_lcd_panel_swap_xy(*ret_panel, BSP_LCD_SWAP_XY);
+    esp_lcd_panel_invert_color(*ret_panel, BSP_LCD_INVERT_COLOR);
     return ret;
 
 err:
@@ -578,25 +425,15 @@ static lv_display_t *bsp_display_lcd_init(void)
         .io_handle = io_handle,
         .panel_handle = panel_handle,
         .buffer_size = BSP_LCD_H_RES * CONFIG_BSP_LCD_DRAW_BUF_HEIGHT,
-#if CONFIG_BSP_LCD_DRAW_BUF_DOUBLE
-        .double_buffer = 1,
-#else
-        .double_buffer = 0,
-#endif
+        .double_buffer = BSP_LCD_DRAW_BUF_DOUBLE,
         .hres = BSP_LCD_H_RES,
         .vres = BSP_LCD_V_RES,
         .monochrome = false,
         /* Rotation values must be same as used in esp_lcd for initial settings of the screen */
         .rotation = {
-#if CONFIG_BSP_DISPLAY_ROTATION_SWAP_XY
-            .swap_xy = true,
-#endif
-#if CONFIG_BSP_DISPLAY_ROTATION_MIRROR_X
-            .mirror_x = true,
-#endif
-#if CONFIG_BSP_DISPLAY_ROTATION_MIRROR_Y
-            .mirror_y = true,
-#endif
+            .swap_xy = BSP_LCD_SWAP_XY,
+            .mirror_x = BSP_LCD_MIRROR_X,
+            .mirror_y = BSP_LCD_MIRROR_Y,
         },
         .flags = {
             .buff_dma = true,
@@ -626,44 +463,16 @@ esp_err_t bsp_touch_new(const bsp_touch_config_t *config, esp_lcd_touch_handle_t
             .interrupt = 0,
         },
         .flags = {
-#if CONFIG_BSP_TOUCH_ROTATION_SWAP_XY
-            .swap_xy = true,
-#endif
-#if CONFIG_BSP_TOUCH_ROTATION_MIRROR_X
-            .mirror_x = true,
-#endif
-#if CONFIG_BSP_TOUCH_ROTATION_MIRROR_Y
-            .mirror_y = true,
-#endif
+            .swap_xy = BSP_TOUCH_SWAP_XY,
+            .mirror_x = BSP_TOUCH_MIRROR_X,
+            .mirror_y = BSP_TOUCH_MIRROR_Y,
         },
     };
     esp_lcd_panel_io_handle_t tp_io_handle = NULL;
-#if CONFIG_BSP_TOUCH_DRIVER_TT21100
-    ESP_LOGI(TAG, "Initialize LCD Touch: TT21100");
-    const esp_lcd_panel_io_i2c_config_t tp_io_config = ESP_LCD_TOUCH_IO_I2C_TT21100_CONFIG();
+    ESP_LOGI(TAG, "Initialize LCD Touch: " BSP_TOUCH_DRIVER_NAME);
+    const esp_lcd_panel_io_i2c_config_t tp_io_config = BSP_TOUCH_IO_I2C_CONFIG();
     ESP_RETURN_ON_ERROR(esp_lcd_new_panel_io_i2c((esp_lcd_i2c_bus_handle_t)BSP_I2C_NUM, &tp_io_config, &tp_io_handle), TAG, "");
-    return esp_lcd_touch_new_i2c_tt21100(tp_io_handle, &tp_cfg, ret_touch);
-#elif CONFIG_BSP_TOUCH_DRIVER_GT1151
-    ESP_LOGI(TAG, "Initialize LCD Touch: GT1151");
-    const esp_lcd_panel_io_i2c_config_t tp_io_config = ESP_LCD_TOUCH_IO_I2C_GT1151_CONFIG();
-    ESP_RETURN_ON_ERROR(esp_lcd_new_panel_io_i2c((esp_lcd_i2c_bus_handle_t)BSP_I2C_NUM, &tp_io_config, &tp_io_handle), TAG, "");
-    return esp_lcd_touch_new_i2c_gt1151(tp_io_handle, &tp_cfg, ret_touch);
-#elif CONFIG_BSP_TOUCH_DRIVER_GT911
-    ESP_LOGI(TAG, "Initialize LCD Touch: GT911");
-    const esp_lcd_panel_io_i2c_config_t tp_io_config = ESP_LCD_TOUCH_IO_I2C_GT911_CONFIG();
-    ESP_RETURN_ON_ERROR(esp_lcd_new_panel_io_i2c((esp_lcd_i2c_bus_handle_t)BSP_I2C_NUM, &tp_io_config, &tp_io_handle), TAG, "");
-    return esp_lcd_touch_new_i2c_gt911(tp_io_handle, &tp_cfg, ret_touch);
-#elif CONFIG_BSP_TOUCH_DRIVER_CST816S
-    ESP_LOGI(TAG, "Initialize LCD Touch: CST816S");
-    const esp_lcd_panel_io_i2c_config_t tp_io_config = ESP_LCD_TOUCH_IO_I2C_CST816S_CONFIG();
-    ESP_RETURN_ON_ERROR(esp_lcd_new_panel_io_i2c((esp_lcd_i2c_bus_handle_t)BSP_I2C_NUM, &tp_io_config, &tp_io_handle), TAG, "");
-    return esp_lcd_touch_new_i2c_cst816s(tp_io_handle, &tp_cfg, ret_touch);
-#elif CONFIG_BSP_TOUCH_DRIVER_FT5X06
-    ESP_LOGI(TAG, "Initialize LCD Touch: FT5X06");
-    const esp_lcd_panel_io_i2c_config_t tp_io_config = ESP_LCD_TOUCH_IO_I2C_FT5X06_CONFIG();
-    ESP_RETURN_ON_ERROR(esp_lcd_new_panel_io_i2c((esp_lcd_i2c_bus_handle_t)BSP_I2C_NUM, &tp_io_config, &tp_io_handle), TAG, "");
-    return esp_lcd_touch_new_i2c_ft5x06(tp_io_handle, &tp_cfg, ret_touch);
-#endif
+    return bsp_touch_new_i2c(tp_io_handle, &tp_cfg, ret_touch);
 }
 
 static lv_indev_t *bsp_display_indev_init(lv_display_t *disp)
@@ -760,6 +569,7 @@ esp_err_t bsp_led_indicator_create(led_indicator_handle_t led_array[], int *led_
     if (led_cnt) {
         *led_cnt = 0;
     }
+#if CONFIG_BSP_LEDS_NUM > 0
     for (int i = 0; i < BSP_LED_NUM; i++) {
         led_array[i] = led_indicator_create(&bsp_leds_config[i]);
         if (led_array[i] == NULL) {
@@ -770,17 +580,13 @@ esp_err_t bsp_led_indicator_create(led_indicator_handle_t led_array[], int *led_
             (*led_cnt)++;
         }
     }
+#endif
     return ret;
 }
 
 esp_err_t bsp_led_set(led_indicator_handle_t handle, const bool on)
 {
-    if (on) {
-        led_indicator_start(handle, BSP_LED_ON);
-    } else {
-        led_indicator_start(handle, BSP_LED_OFF);
-    }
-
+    led_indicator_start(handle, on ? BSP_LED_ON : BSP_LED_OFF);
     return ESP_OK;
 }
 
@@ -5,15 +5,25 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
 #include "esp_vfs_fat.h"
 #include "esp_log.h"
 #include "esp_check.h"
 #include "esp_spiffs.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_vendor.h"
 #include "esp_lcd_panel_ops.h"
+#include "esp_lcd_panel_commands.h"
 #include "driver/spi_master.h"
 #include "driver/ledc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_idf_version.h"
 
 #include "iot_button.h"
 #include "bsp/esp_wrover_kit.h"
@@ -154,6 +164,33 @@ esp_err_t bsp_iot_button_create(button_handle_t btn_array[], int *btn_cnt, int b
 #define LCD_PARAM_BITS       (8)
 #define LCD_LEDC_CH          (CONFIG_BSP_DISPLAY_BRIGHTNESS_LEDC_CH)
 
+/* Test block sent for measuring of the throughput and for the pixel clock check */
+#define LCD_TEST_LINES       (20)
+#define LCD_TEST_SIZE        (BSP_LCD_H_RES * LCD_TEST_LINES * sizeof(uint16_t))
+/* Lines of the test block read back from LCD memory */
+#define LCD_VERIFY_LINES     (2)
+/* LCD memory read is much slower than write */
+#define LCD_READ_CLOCK_HZ    (2 * 1000 * 1000)
+
+/* LCD memory readback needs esp_lcd_panel_io_rx_param() */
+#if CONFIG_BSP_LCD_PCLK_NEGOTIATION && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#define LCD_PCLK_NEGOTIATION (1)
+#else
+#define LCD_PCLK_NEGOTIATION (0)
+#endif
+
+#if LCD_PCLK_NEGOTIATION
+/* Pixel clocks tried from the fastest, LCD signals are routed through GPIO matrix (40 MHz maximum) */
+static const uint32_t lcd_pclk_list[] = {
+    40 * 1000 * 1000,
+    26 * 1000 * 1000,
+    20 * 1000 * 1000,
+    10 * 1000 * 1000,
+};
+#endif
+
+static bsp_display_bus_info_t lcd_bus_info;
+
 esp_err_t bsp_display_brightness_init(void)
 {
     // Setup LEDC peripheral for PWM backlight control
@@ -207,9 +244,145 @@ esp_err_t bsp_display_backlight_on(void)
     return bsp_display_brightness_set(100);
 }
 
+static esp_err_t bsp_display_new_io(uint32_t pclk_hz, int trans_queue_depth, esp_lcd_panel_io_handle_t *ret_io)
+{
+    const esp_lcd_panel_io_spi_config_t io_config = {
+        .dc_gpio_num = BSP_LCD_DC,
+        .cs_gpio_num = BSP_LCD_SPI_CS,
+        .pclk_hz = pclk_hz,
+        .lcd_cmd_bits = LCD_CMD_BITS,
+        .lcd_param_bits = LCD_PARAM_BITS,
+        .spi_mode = 0,
+        .trans_queue_depth = (trans_queue_depth > 0) ? trans_queue_depth : 10,
+    };
+    return esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)BSP_LCD_SPI_NUM, &io_config, ret_io);
+}
+
+static esp_err_t bsp_display_new_panel(esp_lcd_panel_io_handle_t io, esp_lcd_panel_handle_t *ret_panel)
+{
+    const esp_lcd_panel_dev_config_t panel_config = {
+        .reset_gpio_num = BSP_LCD_RST,
+        .color_space = BSP_LCD_COLOR_SPACE,
+        .bits_per_pixel = BSP_LCD_BITS_PER_PIXEL,
+    };
+    ESP_RETURN_ON_ERROR(esp_lcd_new_panel_st7789(io, &panel_config, ret_panel), TAG, "New panel failed");
+
+    esp_lcd_panel_reset(*ret_panel);
+    esp_lcd_panel_init(*ret_panel);
+#ifdef CONFIG_BSP_LCD_ILI9341
+    esp_lcd_panel_mirror(*ret_panel, true, false);
+#endif
+    return ESP_OK;
+}
+
+/* Pseudo-random RGB565 pixels, bytes are stored in order of sending */
+static void bsp_display_test_fill(uint8_t *buf)
+{
+    uint32_t seed = 0x2545F491;
+    for (size_t i = 0; i < LCD_TEST_SIZE; i++) {
+        seed = seed * 1664525 + 1013904223;
+        buf[i] = (uint8_t)(seed >> 24);
+    }
+}
+
+/* Send the test block at the top of the screen, returns time of the transfer in [us] */
+static int64_t bsp_display_test_write(esp_lcd_panel_handle_t panel, esp_lcd_panel_io_handle_t io, const uint8_t *buf)
+{
+    const int64_t start = esp_timer_get_time();
+    esp_lcd_panel_draw_bitmap(panel, 0, 0, BSP_LCD_H_RES, LCD_TEST_LINES, buf);
+    /* Command is sent after all queued color transfers */
+    esp_lcd_panel_io_tx_param(io, LCD_CMD_NOP, NULL, 0);
+    return esp_timer_get_time() - start;
+}
+
+#if LCD_PCLK_NEGOTIATION
+/* Read the first lines of the test block back at slow clock and compare them with the sent pixels */
+static bool bsp_display_test_verify(const uint8_t *buf)
+{
+    const size_t px = BSP_LCD_H_RES * LCD_VERIFY_LINES;
+    /* The first byte is dummy, then 3 bytes (RGB666) per pixel */
+    const size_t rd_size = px * 3 + 1;
+    const uint8_t caset[] = {0, 0, (BSP_LCD_H_RES - 1) >> 8, (BSP_LCD_H_RES - 1) & 0xFF};
+    const uint8_t raset[] = {0, 0, 0, LCD_VERIFY_LINES - 1};
+    esp_lcd_panel_io_handle_t io = NULL;
+    bool ok = false;
+
+    uint8_t *rd = heap_caps_malloc(rd_size, MALLOC_CAP_DMA);
+    if (rd == NULL || bsp_display_new_io(LCD_READ_CLOCK_HZ, 0, &io) != ESP_OK) {
+        goto end;
+    }
+    esp_lcd_panel_io_tx_param(io, LCD_CMD_CASET, caset, sizeof(caset));
+    esp_lcd_panel_io_tx_param(io, LCD_CMD_RASET, raset, sizeof(raset));
+    if (esp_lcd_panel_io_rx_param(io, LCD_CMD_RAMRD, rd, rd_size) != ESP_OK) {
+        goto end;
+    }
+
+    ok = true;
+    for (size_t i = 0; i < px && ok; i++) {
+        const uint8_t hi = buf[i * 2];
+        const uint8_t lo = buf[i * 2 + 1];
+        const uint8_t r = hi >> 3;
+        const uint8_t g = ((hi & 0x07) << 3) | (lo >> 5);
+        const uint8_t b = lo & 0x1F;
+        const uint8_t *p = &rd[1 + i * 3];
+        /* Order of red and blue in the read data depends on the panel color space */
+        ok = ((p[1] >> 2) == g) && (((p[0] >> 3) == r && (p[2] >> 3) == b) || ((p[0] >> 3) == b && (p[2] >> 3) == r));
+    }
+
+end:
+    if (io) {
+        esp_lcd_panel_io_del(io);
+    }
+    free(rd);
+    return ok;
+}
+
+/* Find the fastest pixel clock, which writes the test block into LCD memory without errors */
+static bool bsp_display_negotiate_pclk(const uint8_t *buf, uint32_t *ret_pclk)
+{
+    for (size_t i = 0; i < sizeof(lcd_pclk_list) / sizeof(lcd_pclk_list[0]); i++) {
+        esp_lcd_panel_io_handle_t io = NULL;
+        esp_lcd_panel_handle_t panel = NULL;
+        esp_err_t ret = bsp_display_new_io(lcd_pclk_list[i], 0, &io);
+        if (ret == ESP_OK) {
+            ret = bsp_display_new_panel(io, &panel);
+        }
+        if (ret == ESP_OK) {
+            bsp_display_test_write(panel, io, buf);
+        }
+        if (panel) {
+            esp_lcd_panel_del(panel);
+        }
+        if (io) {
+            esp_lcd_panel_io_del(io);
+        }
+
+        if (ret == ESP_OK && bsp_display_test_verify(buf)) {
+            *ret_pclk = lcd_pclk_list[i];
+            return true;
+        }
+        ESP_LOGW(TAG, "LCD readback failed at %"PRIu32" Hz", lcd_pclk_list[i]);
+    }
+
+    ESP_LOGW(TAG, "LCD readback failed at all clocks, default pixel clock is used");
+    return false;
+}
+#endif
+
+esp_err_t bsp_display_get_bus_info(bsp_display_bus_info_t *info)
+{
+    ESP_RETURN_ON_FALSE(info, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(lcd_bus_info.pclk_hz, ESP_ERR_INVALID_STATE, TAG, "Display is not initialized");
+    *info = lcd_bus_info;
+    return ESP_OK;
+}
+
 esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_handle_t *ret_panel, esp_lcd_panel_io_handle_t *ret_io)
 {
     esp_err_t ret = ESP_OK;
+    uint32_t pclk_hz = BSP_LCD_PIXEL_CLOCK_HZ;
+    bool verified = false;
+    uint8_t *test_buf = NULL;
     assert(config != NULL && config->max_transfer_sz > 0);
 
     ESP_RETURN_ON_ERROR(bsp_display_brightness_init(), TAG, "Brightness init failed");
@@ -225,34 +398,33 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
     };
     ESP_RETURN_ON_ERROR(spi_bus_initialize(BSP_LCD_SPI_NUM, &buscfg, SPI_DMA_CH_AUTO), TAG, "SPI init failed");
 
+    test_buf = heap_caps_malloc(LCD_TEST_SIZE, MALLOC_CAP_DMA);
+    ESP_GOTO_ON_FALSE(test_buf, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LCD test buffer");
+    bsp_display_test_fill(test_buf);
+
+#if LCD_PCLK_NEGOTIATION
+    ESP_LOGD(TAG, "Negotiate pixel clock");
+    verified = bsp_display_negotiate_pclk(test_buf, &pclk_hz);
+#endif
+
     ESP_LOGD(TAG, "Install panel IO");
-    const esp_lcd_panel_io_spi_config_t io_config = {
-        .dc_gpio_num = BSP_LCD_DC,
-        .cs_gpio_num = BSP_LCD_SPI_CS,
-        .pclk_hz = BSP_LCD_PIXEL_CLOCK_HZ,
-        .lcd_cmd_bits = LCD_CMD_BITS,
-        .lcd_param_bits = LCD_PARAM_BITS,
-        .spi_mode = 0,
-        .trans_queue_depth = 10,
-    };
-    ESP_GOTO_ON_ERROR(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)BSP_LCD_SPI_NUM, &io_config, ret_io), err, TAG, "New panel IO failed");
+    ESP_GOTO_ON_ERROR(bsp_display_new_io(pclk_hz, config->trans_queue_depth, ret_io), err, TAG, "New panel IO failed");
 
     ESP_LOGD(TAG, "Install LCD driver");
-    const esp_lcd_panel_dev_config_t panel_config = {
-        .reset_gpio_num = BSP_LCD_RST,
-        .color_space = BSP_LCD_COLOR_SPACE,
-        .bits_per_pixel = BSP_LCD_BITS_PER_PIXEL,
-    };
-    ESP_GOTO_ON_ERROR(esp_lcd_new_panel_st7789(*ret_io, &panel_config, ret_panel), err, TAG, "New panel failed");
+    ESP_GOTO_ON_ERROR(bsp_display_new_panel(*ret_io, ret_panel), err, TAG, "New panel failed");
 
-    esp_lcd_panel_reset(*ret_panel);
-    esp_lcd_panel_init(*ret_panel);
-#ifdef CONFIG_BSP_LCD_ILI9341
-    esp_lcd_panel_mirror(*ret_panel, true, false);
-#endif
+    /* Display is still off, the test block is not visible */
+    const int64_t time_us = bsp_display_test_write(*ret_panel, *ret_io, test_buf);
+    lcd_bus_info.pclk_hz = pclk_hz;
+    lcd_bus_info.throughput = (time_us > 0 ? (uint32_t)(LCD_TEST_SIZE * 1000000LL / time_us) : 0);
+    lcd_bus_info.verified = verified;
+    ESP_LOGI(TAG, "LCD pixel clock %"PRIu32" Hz%s, throughput %"PRIu32" kB/s", pclk_hz, verified ? " (verified)" : "", lcd_bus_info.throughput / 1000);
+
+    free(test_buf);
     return ret;
 
 err:
+    free(test_buf);
     if (*ret_panel) {
         esp_lcd_panel_del(*ret_panel);
     }
@@ -263,6 +435,266 @@ err:
     return ret;
 }
 
+/* Panel IO done callback is registered since IDF v4.4.4, except v5.0.0 */
+#if (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 4, 4)) && (ESP_IDF_VERSION != ESP_IDF_VERSION_VAL(5, 0, 0))
+#define BSP_DISPLAY_STREAM_SUPPORTED 1
+#else
+#define BSP_DISPLAY_STREAM_SUPPORTED 0
+#endif
+
+struct bsp_display_stream_s {
+    bsp_display_stream_config_t config;
+    QueueHandle_t free_bufs;            // Buffers ready to be acquired
+    volatile int sending_head;          // Next buffer to be released by transfer done, moved in ISR
+    volatile int sending_tail;          // Next free slot in the FIFO of buffers being sent
+    void **held;                        // Buffers held by bsp_display_stream_wait() (buffer_num slots)
+    void *sending[];                    // FIFO of buffers being sent (buffer_num + 1 slots), SPI transactions finish in order
+};
+
+static bool bsp_display_stream_done(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
+{
+    bsp_display_stream_handle_t stream = (bsp_display_stream_handle_t)user_ctx;
+    BaseType_t need_yield = pdFALSE;
+
+    if (stream->sending_head != stream->sending_tail) {
+        void *buf = stream->sending[stream->sending_head];
+        stream->sending_head = (stream->sending_head + 1) % (stream->config.buffer_num + 1);
+        xQueueSendFromISR(stream->free_bufs, &buf, &need_yield);
+    }
+    return (need_yield == pdTRUE);
+}
+
+static void bsp_display_stream_free(bsp_display_stream_handle_t stream)
+{
+    void *buf;
+    if (stream->free_bufs) {
+        while (xQueueReceive(stream->free_bufs, &buf, 0) == pdTRUE) {
+            heap_caps_free(buf);
+        }
+        vQueueDelete(stream->free_bufs);
+    }
+    free(stream);
+}
+
+esp_err_t bsp_display_stream_new(const bsp_display_stream_config_t *config, bsp_display_stream_handle_t *ret_stream)
+{
+#if BSP_DISPLAY_STREAM_SUPPORTED
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(config && ret_stream && config->panel && config->io, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->buffer_num >= 2 && config->buffer_size > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid buffers");
+
+    bsp_display_stream_handle_t stream = calloc(1, sizeof(struct bsp_display_stream_s) + (2 * config->buffer_num + 1) * sizeof(void *));
+    ESP_RETURN_ON_FALSE(stream, ESP_ERR_NO_MEM, TAG, "Not enough memory for display stream");
+    stream->config = *config;
+    stream->held = &stream->sending[config->buffer_num + 1];
+    stream->free_bufs = xQueueCreate(config->buffer_num, sizeof(void *));
+    ESP_GOTO_ON_FALSE(stream->free_bufs, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for display stream");
+    for (int i = 0; i < config->buffer_num; i++) {
+        void *buf = heap_caps_malloc(config->buffer_size, MALLOC_CAP_DMA);
+        ESP_GOTO_ON_FALSE(buf, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for strip buffer");
+        xQueueSend(stream->free_bufs, &buf, 0);
+    }
+
+    const esp_lcd_panel_io_callbacks_t cbs = {
+        .on_color_trans_done = bsp_display_stream_done,
+    };
+    ESP_GOTO_ON_ERROR(esp_lcd_panel_io_register_event_callbacks(config->io, &cbs, stream), err, TAG, "Register callback failed");
+    *ret_stream = stream;
+    return ESP_OK;
+
+err:
+    bsp_display_stream_free(stream);
+    return ret;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t bsp_display_stream_acquire(bsp_display_stream_handle_t stream, void **ret_buf, uint32_t timeout_ms)
+{
+    ESP_RETURN_ON_FALSE(stream && ret_buf, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    const TickType_t timeout_ticks = (timeout_ms == 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    return (xQueueReceive(stream->free_bufs, ret_buf, timeout_ticks) == pdTRUE) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t bsp_display_stream_submit(bsp_display_stream_handle_t stream, int x_start, int y_start, int x_end, int y_end, void *buf)
+{
+    ESP_RETURN_ON_FALSE(stream && buf && x_end > x_start && y_end > y_start, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE((size_t)(x_end - x_start) * (y_end - y_start) * BSP_LCD_BITS_PER_PIXEL / 8 <= stream->config.buffer_size,
+                        ESP_ERR_INVALID_ARG, TAG, "Area doesn't fit the buffer");
+
+    /* Buffer is queued before the transfer starts, the done callback may come before draw_bitmap returns */
+    const int tail = stream->sending_tail;
+    stream->sending[tail] = buf;
+    stream->sending_tail = (tail + 1) % (stream->config.buffer_num + 1);
+    esp_err_t ret = esp_lcd_panel_draw_bitmap(stream->config.panel, x_start, y_start, x_end, y_end, buf);
+    if (ret != ESP_OK) {
+        stream->sending_tail = tail;
+        xQueueSend(stream->free_bufs, &buf, 0);
+    }
+    return ret;
+}
+
+esp_err_t bsp_display_stream_wait(bsp_display_stream_handle_t stream, uint32_t timeout_ms)
+{
+    ESP_RETURN_ON_FALSE(stream, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    TickType_t timeout_ticks = (timeout_ms == 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    TimeOut_t timeout;
+    esp_err_t ret = ESP_OK;
+    int held = 0;
+
+    /* All transfers are done, when all buffers can be acquired */
+    vTaskSetTimeOutState(&timeout);
+    while (held < stream->config.buffer_num) {
+        if (xQueueReceive(stream->free_bufs, &stream->held[held], timeout_ticks) != pdTRUE ||
+                (held + 1 < stream->config.buffer_num && xTaskCheckForTimeOut(&timeout, &timeout_ticks) == pdTRUE)) {
+            ret = ESP_ERR_TIMEOUT;
+            break;
+        }
+        held++;
+    }
+    while (held > 0) {
+        held--;
+        xQueueSend(stream->free_bufs, &stream->held[held], 0);
+    }
+    return ret;
+}
+
+esp_err_t bsp_display_stream_del(bsp_display_stream_handle_t stream)
+{
+    ESP_RETURN_ON_FALSE(stream, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    bsp_display_stream_wait(stream, 0);
+
+    const esp_lcd_panel_io_callbacks_t cbs = {
+        .on_color_trans_done = NULL,
+    };
+    esp_lcd_panel_io_register_event_callbacks(stream->config.io, &cbs, NULL);
+    bsp_display_stream_free(stream);
+    return ESP_OK;
+}
+
+/* Lines of one splash strip buffer */
+#define SPLASH_LINES    (20)
+
+/* Display created by bsp_display_splash_show(), LVGL continues on it without reset */
+static esp_lcd_panel_handle_t splash_panel = NULL;
+static esp_lcd_panel_io_handle_t splash_io = NULL;
+
+typedef struct {
+    const bsp_display_splash_t *splash;
+    size_t pos;                         // Next word of the data
+    uint16_t run_left;                  // Pixels left in the current run
+    uint16_t run_color;                 // Pixel of the repeated run
+    bool run_repeat;                    // Current run repeats one pixel, else literal pixels follow
+} splash_decoder_t;
+
+static esp_err_t splash_decode(splash_decoder_t *dec, uint16_t *dst, size_t num)
+{
+    const bsp_display_splash_t *splash = dec->splash;
+    if (!splash->flags.rle) {
+        ESP_RETURN_ON_FALSE(dec->pos + num <= splash->data_len, ESP_ERR_INVALID_ARG, TAG, "Splash data truncated");
+        memcpy(dst, &splash->data[dec->pos], num * sizeof(uint16_t));
+        dec->pos += num;
+        return ESP_OK;
+    }
+
+    while (num > 0) {
+        if (dec->run_left == 0) {
+            ESP_RETURN_ON_FALSE(dec->pos + 1 < splash->data_len, ESP_ERR_INVALID_ARG, TAG, "Splash data truncated");
+            const uint16_t word = splash->data[dec->pos++];
+            dec->run_repeat = (word & 0x8000) != 0;
+            dec->run_left = word & 0x7fff;
+            if (dec->run_repeat) {
+                dec->run_color = splash->data[dec->pos++];
+            }
+            continue;
+        }
+        const size_t n = (num < dec->run_left) ? num : dec->run_left;
+        if (dec->run_repeat) {
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = dec->run_color;
+            }
+        } else {
+            ESP_RETURN_ON_FALSE(dec->pos + n <= splash->data_len, ESP_ERR_INVALID_ARG, TAG, "Splash data truncated");
+            memcpy(dst, &splash->data[dec->pos], n * sizeof(uint16_t));
+            dec->pos += n;
+        }
+        dst += n;
+        num -= n;
+        dec->run_left -= n;
+    }
+    return ESP_OK;
+}
+
+esp_err_t bsp_display_splash_show(const bsp_display_splash_t *splash, esp_lcd_panel_handle_t *ret_panel, esp_lcd_panel_io_handle_t *ret_io)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(splash && splash->data, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(splash->width <= BSP_LCD_H_RES && splash->height <= BSP_LCD_V_RES, ESP_ERR_INVALID_ARG, TAG, "Splash is larger than the screen");
+    const int64_t start = esp_timer_get_time();
+
+    if (splash_panel == NULL) {
+        const bsp_display_config_t bsp_disp_cfg = {
+            .max_transfer_sz = BSP_LCD_DRAW_BUFF_SIZE * sizeof(uint16_t),
+        };
+        ESP_RETURN_ON_ERROR(bsp_display_new(&bsp_disp_cfg, &splash_panel, &splash_io), TAG, "Display init failed");
+    }
+
+    const bsp_display_stream_config_t stream_cfg = {
+        .panel = splash_panel,
+        .io = splash_io,
+        .buffer_size = BSP_LCD_H_RES * SPLASH_LINES * sizeof(uint16_t),
+        .buffer_num = 2,
+    };
+    bsp_display_stream_handle_t stream = NULL;
+    ESP_RETURN_ON_ERROR(bsp_display_stream_new(&stream_cfg, &stream), TAG, "Display stream failed");
+
+    /* Whole screen is sent, so no content of the LCD memory from before the reset is visible */
+    const int x0 = (BSP_LCD_H_RES - splash->width) / 2;
+    const int y0 = (BSP_LCD_V_RES - splash->height) / 2;
+    splash_decoder_t dec = {
+        .splash = splash,
+    };
+    for (int y = 0; y < BSP_LCD_V_RES && ret == ESP_OK; y += SPLASH_LINES) {
+        const int lines = (BSP_LCD_V_RES - y < SPLASH_LINES) ? (BSP_LCD_V_RES - y) : SPLASH_LINES;
+        uint16_t *buf = NULL;
+        bsp_display_stream_acquire(stream, (void **)&buf, 0);
+        for (int line = 0; line < lines && ret == ESP_OK; line++) {
+            uint16_t *row = &buf[line * BSP_LCD_H_RES];
+            const bool in_image = (y + line >= y0 && y + line < y0 + splash->height);
+            for (int x = 0; x < BSP_LCD_H_RES; x++) {
+                row[x] = splash->background;
+            }
+            if (in_image) {
+                ret = splash_decode(&dec, &row[x0], splash->width);
+            }
+        }
+        if (ret == ESP_OK) {
+            ret = bsp_display_stream_submit(stream, 0, y, BSP_LCD_H_RES, y + lines, buf);
+        } else {
+            xQueueSend(stream->free_bufs, &buf, 0);
+        }
+    }
+    bsp_display_stream_del(stream);
+    ESP_RETURN_ON_ERROR(ret, TAG, "Splash draw failed");
+
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
+    esp_lcd_panel_disp_off(splash_panel, false);
+#else
+    esp_lcd_panel_disp_on_off(splash_panel, true);
+#endif
+    bsp_display_backlight_on();
+    ESP_LOGI(TAG, "Splash shown in %d ms", (int)((esp_timer_get_time() - start) / 1000));
+
+    if (ret_panel) {
+        *ret_panel = splash_panel;
+    }
+    if (ret_io) {
+        *ret_io = splash_io;
+    }
+    return ESP_OK;
+}
+
 #if (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
 static lv_display_t *bsp_display_lcd_init(const bsp_display_cfg_t *cfg)
 {
@@ -272,7 +704,13 @@ static lv_display_t *bsp_display_lcd_init(const bsp_display_cfg_t *cfg)
     const bsp_display_config_t bsp_disp_cfg = {
         .max_transfer_sz = BSP_LCD_DRAW_BUFF_SIZE * sizeof(uint16_t),
     };
-    BSP_ERROR_CHECK_RETURN_NULL(bsp_display_new(&bsp_disp_cfg, &panel_handle, &io_handle));
+    if (splash_panel) {
+        /* Panel is not reset, the splash stays on the screen until the first LVGL flush */
+        panel_handle = splash_panel;
+        io_handle = splash_io;
+    } else {
+        BSP_ERROR_CHECK_RETURN_NULL(bsp_display_new(&bsp_disp_cfg, &panel_handle, &io_handle));
+    }
 
 #if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
     esp_lcd_panel_disp_off(panel_handle, false);
@@ -15,6 +15,8 @@
  */
 
 #pragma once
+#include <stdbool.h>
+#include <stddef.h>
 #include "esp_lcd_types.h"
 #include "sdkconfig.h"
 
@@ -48,8 +50,19 @@ extern "C" {
  */
 typedef struct {
     int max_transfer_sz;    /*!< Maximum transfer size, in bytes. */
+    int trans_queue_depth;  /*!< Number of SPI transactions queued in the panel IO, commands and color chunks of all draw buffers in flight (0: 10) */
 } bsp_display_config_t;
 
+/**
+ * @brief BSP display bus information
+ *
+ */
+typedef struct {
+    uint32_t pclk_hz;       /*!< Pixel clock of the LCD SPI bus */
+    uint32_t throughput;    /*!< Throughput measured in display initialization, in bytes per second */
+    bool     verified;      /*!< True, if the pixel clock was verified by readback from LCD memory */
+} bsp_display_bus_info_t;
+
 /**
  * @brief Create new display panel
  *
@@ -75,6 +88,20 @@ typedef struct {
  */
 esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_handle_t *ret_panel, esp_lcd_panel_io_handle_t *ret_io);
 
+/**
+ * @brief Get pixel clock and measured throughput of the display bus
+ *
+ * With CONFIG_BSP_LCD_PCLK_NEGOTIATION, the fastest pixel clock is selected in bsp_display_new().
+ * The test pixels are sent on each clock and read back from LCD memory at a slow clock.
+ *
+ * @param[out] info Display bus information
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Parameter error
+ *      - ESP_ERR_INVALID_STATE Display was not initialized by bsp_display_new()
+ */
+esp_err_t bsp_display_get_bus_info(bsp_display_bus_info_t *info);
+
 /**
  * @brief Initialize display's brightness
  *
@@ -123,6 +150,145 @@ esp_err_t bsp_display_backlight_on(void);
  */
 esp_err_t bsp_display_backlight_off(void);
 
+/**
+ * @brief Display stream configuration
+ */
+typedef struct {
+    esp_lcd_panel_handle_t panel;       /*!< Panel from bsp_display_new() */
+    esp_lcd_panel_io_handle_t io;       /*!< Panel IO from bsp_display_new() */
+    size_t buffer_size;                 /*!< Size of one strip buffer [bytes], at most `max_transfer_sz` of bsp_display_new() */
+    int buffer_num;                     /*!< Number of strip buffers, at least 2 */
+} bsp_display_stream_config_t;
+
+/**
+ * @brief Display stream handle
+ */
+typedef struct bsp_display_stream_s *bsp_display_stream_handle_t;
+
+/**
+ * @brief Create stream of pixel strips to the display, for applications without LVGL
+ *
+ * The stream owns `buffer_num` DMA capable buffers. The application acquires a free buffer, computes pixels into it
+ * and submits it; the buffer returns to the stream when its SPI transfer is done (on_color_trans_done of the panel IO).
+ * So computing of the next strip overlaps with the transfer of the previous ones and no buffer is overwritten while
+ * it is being sent.
+ *
+ * \code{.c}
+ * for (int y = 0; y < BSP_LCD_V_RES; y += LINES) {
+ *     uint16_t *buf;
+ *     bsp_display_stream_acquire(stream, (void **)&buf, 0);
+ *     compute_lines(buf, y, LINES);
+ *     bsp_display_stream_submit(stream, 0, y, BSP_LCD_H_RES, y + LINES, buf);
+ * }
+ * bsp_display_stream_wait(stream, 0);
+ * \endcode
+ *
+ * @note The done callback of the panel IO is replaced, so the stream can't be used with LVGL on the same panel.
+ * @note Buffers must be acquired and submitted from one task and all color data must be sent through the stream.
+ *
+ * @param[in]  config     Stream configuration
+ * @param[out] ret_stream Created stream
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Parameter error
+ *      - ESP_ERR_NO_MEM        Not enough memory for the buffers
+ *      - ESP_ERR_NOT_SUPPORTED Not supported in this ESP-IDF version
+ */
+esp_err_t bsp_display_stream_new(const bsp_display_stream_config_t *config, bsp_display_stream_handle_t *ret_stream);
+
+/**
+ * @brief Acquire a free strip buffer
+ *
+ * @param[in]  stream     Stream
+ * @param[out] ret_buf    Buffer of `buffer_size` bytes
+ * @param[in]  timeout_ms Timeout in [ms]. 0 will block indefinitely.
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Parameter error
+ *      - ESP_ERR_TIMEOUT       All buffers are still being sent
+ */
+esp_err_t bsp_display_stream_acquire(bsp_display_stream_handle_t stream, void **ret_buf, uint32_t timeout_ms);
+
+/**
+ * @brief Submit acquired buffer to the display
+ *
+ * The function returns after the transfer is queued. The buffer must not be touched until it is acquired again.
+ *
+ * @param[in] stream  Stream
+ * @param[in] x_start Start column (included)
+ * @param[in] y_start Start row (included)
+ * @param[in] x_end   End column (excluded)
+ * @param[in] y_end   End row (excluded)
+ * @param[in] buf     Buffer from bsp_display_stream_acquire()
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Parameter error or the area doesn't fit the buffer
+ *      - Else                  esp_lcd failure, the buffer is released
+ */
+esp_err_t bsp_display_stream_submit(bsp_display_stream_handle_t stream, int x_start, int y_start, int x_end, int y_end, void *buf);
+
+/**
+ * @brief Wait until all submitted buffers are sent
+ *
+ * @param[in] stream     Stream
+ * @param[in] timeout_ms Timeout in [ms]. 0 will block indefinitely.
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Parameter error
+ *      - ESP_ERR_TIMEOUT       Transfers are not finished
+ */
+esp_err_t bsp_display_stream_wait(bsp_display_stream_handle_t stream, uint32_t timeout_ms);
+
+/**
+ * @brief Delete stream
+ *
+ * Waits for the submitted buffers and frees them. The panel IO done callback is unregistered.
+ *
+ * @param[in] stream Stream
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Parameter error
+ */
+esp_err_t bsp_display_stream_del(bsp_display_stream_handle_t stream);
+
+/**
+ * @brief Boot splash image
+ *
+ * Pixels are RGB565 in the byte order of the panel (`BSP_LCD_BIGENDIAN`), e.g. converted by
+ * `lvgl_port_create_c_image(... "RGB565" "NONE" SWAP_BYTES ...)` of esp_lvgl_port.
+ * With `flags.rle`, the data are run-length encoded in 16-bit words: a word with the bit 15 set is followed by one pixel
+ * repeated (word & 0x7fff) times, other word N is followed by N literal pixels.
+ */
+typedef struct {
+    const uint16_t *data;               /*!< Pixels or RLE words, constant data are read directly from flash */
+    size_t data_len;                    /*!< Number of 16-bit words in `data` */
+    uint16_t width;                     /*!< Image width, the image is centered on the screen */
+    uint16_t height;                    /*!< Image height */
+    uint16_t background;                /*!< Color of the screen around the image (panel byte order) */
+    struct {
+        unsigned int rle: 1;            /*!< Data are run-length encoded */
+    } flags;
+} bsp_display_splash_t;
+
+/**
+ * @brief Show boot splash image without LVGL and turn on the backlight
+ *
+ * The display is created by bsp_display_new() (if it was not created by this function before), the image is decoded
+ * into DMA strip buffers and sent through the display stream. It can be called early in app_main(), before the
+ * LVGL port is initialized. bsp_display_start() then uses the same panel without reset, so the splash stays on
+ * the screen until LVGL sends its first frame.
+ *
+ * @param[in]  splash    Splash image
+ * @param[out] ret_panel esp_lcd panel handle. Set to NULL if not needed.
+ * @param[out] ret_io    esp_lcd IO handle. Set to NULL if not needed.
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Parameter error, the image is larger than the screen or the RLE data are truncated
+ *      - ESP_ERR_NO_MEM        Not enough memory for the strip buffers
+ *      - Else                  esp_lcd failure
+ */
+esp_err_t bsp_display_splash_show(const bsp_display_splash_t *splash, esp_lcd_panel_handle_t *ret_panel, esp_lcd_panel_io_handle_t *ret_io);
+
 #ifdef __cplusplus
 }
 #endif
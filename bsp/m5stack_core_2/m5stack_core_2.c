@@ -24,13 +24,11 @@
 #include "esp_lcd_ili9341.h"
 #include "esp_lcd_touch_ft5x06.h"
 #include "bsp_err_check.h"
+#include "bsp_pmic.h"
 #include "esp_codec_dev_defaults.h"
 
 static const char *TAG = "M5Stack";
 
-#define BSP_AXP192_ADDR  0x34
-#define BSP_AXP2101_ADDR 0x34
-
 #if (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
 static lv_display_t *disp;
 static lv_indev_t *disp_indev = NULL;
@@ -71,16 +69,14 @@ esp_err_t bsp_i2c_deinit(void)
 
 uint8_t read8bit(uint8_t sub_addr)
 {
-    // Read register data
-    uint8_t reg_data[1] = {0};
-    esp_err_t err = i2c_master_write_read_device(BSP_I2C_NUM, BSP_AXP192_ADDR, &sub_addr, 1, reg_data, sizeof(reg_data),
-                    1000 / portTICK_PERIOD_MS);
+    // Read register data (from the PMIC register shadow)
+    uint8_t reg_data = 0;
+    esp_err_t err = bsp_pmic_read(sub_addr, &reg_data);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to write & read register address: %s", esp_err_to_name(err));
     }
-    ESP_LOGD(TAG, "AXP192 register %x: 0x%x", sub_addr, reg_data[0]);
 
-    return reg_data[0];
+    return reg_data;
 }
 
 esp_err_t bsp_feature_enable(bsp_feature_t feature, bool enable)
@@ -96,178 +92,45 @@ esp_err_t bsp_feature_enable(bsp_feature_t feature, bool enable)
     case BSP_FEATURE_SD:
 #if defined(CONFIG_BSP_PMU_AXP2101)
         /* AXP ALDO4 voltage / SD Card / Touch Pad / 3V3 */
-        const uint8_t aldo4_value = enable ? 0x1C : 0x00;
-        const uint8_t feature_ctr[] = {0x95, aldo4_value};  // axp: lcd logic and sdcard voltage preset to 3.3v
-        err |= i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, feature_ctr, sizeof(feature_ctr),
-                                          1000 / portTICK_PERIOD_MS);
-
+        err |= bsp_pmic_write(0x95, enable ? 0x1C : 0x00);  // axp: lcd logic and sdcard voltage preset to 3.3v
 #elif defined(CONFIG_BSP_PMU_AXP192)
-        const uint8_t pmu_value = enable ? (read8bit(0x28) & 0x0f) | 0xf0 : (read8bit(0x28) & 0x0f);
-        const uint8_t  pmu_ldo2[] = {
-            0x28, pmu_value
-        };
-
-        err |= i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, pmu_ldo2, sizeof(pmu_ldo2),
-                                          1000 / portTICK_PERIOD_MS);
+        err |= bsp_pmic_update_bits(0x28, 0xf0, enable ? 0xf0 : 0x00);  // axp: lcd logic and sdcard voltage preset to 3.3v
 #endif
         break;
     case BSP_FEATURE_SPEAKER:
 #if defined(CONFIG_BSP_PMU_AXP2101)
         /* AXP ALDO3 voltage / Codec+Mic / 3V3 */
-        const uint8_t aldo3_value = enable ? 0x1C : 0x00;
-        const uint8_t spk_ctr[] = {0x94, aldo3_value};  // axp: lcd logic and sdcard voltage preset to 3.3v
-        err |= i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, spk_ctr, sizeof(spk_ctr),
-                                          1000 / portTICK_PERIOD_MS);
+        err |= bsp_pmic_write(0x94, enable ? 0x1C : 0x00);
 #elif defined(CONFIG_BSP_PMU_AXP192)
-        const uint8_t led_gpio_value = enable ? (read8bit(0x94) | 0x04) | 0xf0 : (read8bit(0x94) & ~0x04);
-        const uint8_t led_gpio_set[] = {0x94, led_gpio_value};
-        ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, led_gpio_set,
-                            sizeof(led_gpio_set), 1000 / portTICK_PERIOD_MS),
-                            TAG, "I2C write failed");
+        /* AXP192 GPIO2 / speaker amplifier */
+        ESP_RETURN_ON_ERROR(bsp_pmic_update_bits(0x94, enable ? 0xf4 : 0x04, enable ? 0xf4 : 0x00), TAG, "I2C write failed");
 #endif
         break;
     case BSP_FEATURE_BATTERY:
 #if defined(CONFIG_BSP_PMU_AXP2101)
         // Battery detection enabled.
-        const uint8_t axp_bat_val = enable ? 0x01 : 0x00;
-        const uint8_t axp_bat_ctr[] = {0x68, axp_bat_val};
-        err |= i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, axp_bat_ctr, sizeof(axp_bat_ctr),
-                                          1000 / portTICK_PERIOD_MS);
+        err |= bsp_pmic_write(0x68, enable ? 0x01 : 0x00);
 #endif
         break;
     case BSP_FEATURE_VIBRATION:
 #if defined(CONFIG_BSP_PMU_AXP2101)
-        const uint8_t dldo1_vol[] = {0x99, 0x1C};  // AXP DLDO1 Voltage set
-        err |= i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, dldo1_vol, sizeof(dldo1_vol),
-                                          1000 / portTICK_PERIOD_MS);
-        const uint8_t dldo1_en_val = enable ? (read8bit(0x90) | 0x80) : (read8bit(0x90) & ~0x80);
-        const uint8_t dldo1_en[] = {0x90, dldo1_en_val};  // AXP DLDO1 Enable
-        err |= i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, dldo1_en, sizeof(dldo1_en),
-                                          1000 / portTICK_PERIOD_MS);
+        const bsp_pmic_reg_t dldo1[] = {
+            {0x99, 0xff, 0x1C},                 // AXP DLDO1 Voltage set
+            {0x90, 0x80, enable ? 0x80 : 0x00}, // AXP DLDO1 Enable
+        };
+        err |= bsp_pmic_update(dldo1, sizeof(dldo1) / sizeof(dldo1[0]));
 #elif defined(CONFIG_BSP_PMU_AXP192)
-        const uint8_t pmu_ldo3[] = {0x28, (read8bit(0x28) & 0xf0) | 0x0f};  // Vibrator power voltage preset
-        ESP_RETURN_ON_ERROR(
-            i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, pmu_ldo3, sizeof(pmu_ldo3), 1000 / portTICK_PERIOD_MS),
-            TAG, "I2C write failed");
-        const uint8_t pmu_ldo3_en_val = enable ? read8bit(0x12) | 0x08 : read8bit(0x12) & ~0x08;
-        const uint8_t pmu_ldo3_en[] = {0x12, pmu_ldo3_en_val};  // ldo3 enable
-        ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, pmu_ldo3_en, sizeof(pmu_ldo3_en),
-                            1000 / portTICK_PERIOD_MS),
-                            TAG, "I2C write failed");
+        const bsp_pmic_reg_t ldo3[] = {
+            {0x28, 0x0f, 0x0f},                 // Vibrator power voltage preset
+            {0x12, 0x08, enable ? 0x08 : 0x00}, // ldo3 enable
+        };
+        ESP_RETURN_ON_ERROR(bsp_pmic_update(ldo3, sizeof(ldo3) / sizeof(ldo3[0])), TAG, "I2C write failed");
 #endif
         break;
     }
     return err;
 }
 
-static esp_err_t bsp_spi_init(uint32_t max_transfer_sz)
-{
-    /* SPI was initialized before */
-    if (spi_initialized) {
-        return ESP_OK;
-    }
-
-    ESP_LOGD(TAG, "Initialize SPI bus");
-    const spi_bus_config_t buscfg = {
-        .sclk_io_num     = BSP_LCD_PCLK,
-        .mosi_io_num     = BSP_LCD_MOSI,
-        .miso_io_num     = BSP_LCD_MISO,
-        .quadwp_io_num   = GPIO_NUM_NC,
-        .quadhd_io_num   = GPIO_NUM_NC,
-        .max_transfer_sz = max_transfer_sz,
-    };
-    ESP_RETURN_ON_ERROR(spi_bus_initialize(BSP_LCD_SPI_NUM, &buscfg, SPI_DMA_CH_AUTO), TAG, "SPI init failed");
-
-    spi_initialized = true;
-
-    return ESP_OK;
-}
-
-esp_err_t bsp_spiffs_mount(void)
-{
-    esp_vfs_spiffs_conf_t conf = {
-        .base_path       = CONFIG_BSP_SPIFFS_MOUNT_POINT,
-        .partition_label = CONFIG_BSP_SPIFFS_PARTITION_LABEL,
-        .max_files       = CONFIG_BSP_SPIFFS_MAX_FILES,
-#ifdef CONFIG_BSP_SPIFFS_FORMAT_ON_MOUNT_FAIL
-        .format_if_mount_failed = true,
-#else
-        .format_if_mount_failed = false,
-#endif
-    };
-
-    esp_err_t ret_val = esp_vfs_spiffs_register(&conf);
-
-    BSP_ERROR_CHECK_RETURN_ERR(ret_val);
-
-    size_t total = 0, used = 0;
-    ret_val = esp_spiffs_info(conf.partition_label, &total, &used);
-    if (ret_val != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to get SPIFFS partition information (%s)", esp_err_to_name(ret_val));
-    } else {
-        ESP_LOGI(TAG, "Partition size: total: %d, used: %d", total, used);
-    }
-
-    return ret_val;
-}
-
-esp_err_t bsp_spiffs_unmount(void)
-{
-    return esp_vfs_spiffs_unregister(CONFIG_BSP_SPIFFS_PARTITION_LABEL);
-}
-
-esp_err_t bsp_sdcard_mount(void)
-{
-    BSP_ERROR_CHECK_RETURN_ERR(bsp_feature_enable(BSP_FEATURE_SD, true));
-
-    const esp_vfs_fat_sdmmc_mount_config_t mount_config = {
-#ifdef CONFIG_BSP_SD_FORMAT_ON_MOUNT_FAIL
-        .format_if_mount_failed = true,
-#else
-        .format_if_mount_failed = false,
-#endif
-        .max_files            = 5,
-        .allocation_unit_size = 16 * 1024
-    };
-
-    sdmmc_host_t host                 = SDSPI_HOST_DEFAULT();
-    host.slot                         = BSP_LCD_SPI_NUM;
-    sdspi_device_config_t slot_config = SDSPI_DEVICE_CONFIG_DEFAULT();
-    slot_config.gpio_cs               = BSP_SD_CS;
-    slot_config.host_id               = host.slot;
-
-    ESP_RETURN_ON_ERROR(bsp_spi_init((BSP_LCD_H_RES * BSP_LCD_V_RES) * sizeof(uint16_t)), TAG, "");
-
-    return esp_vfs_fat_sdspi_mount(BSP_SD_MOUNT_POINT, &host, &slot_config, &mount_config, &bsp_sdcard);
-}
-
-esp_err_t bsp_sdcard_unmount(void)
-{
-    return esp_vfs_fat_sdcard_unmount(BSP_SD_MOUNT_POINT, bsp_sdcard);
-}
-
-esp_codec_dev_handle_t bsp_audio_codec_speaker_init(void)
-{
-    const audio_codec_data_if_t *i2s_data_if = bsp_audio_get_codec_itf();
-    if (i2s_data_if == NULL) {
-        /* Initilize I2C */
-        BSP_ERROR_CHECK_RETURN_NULL(bsp_i2c_init());
-        /* Configure I2S peripheral and Power Amplifier */
-        BSP_ERROR_CHECK_RETURN_NULL(bsp_audio_init(NULL));
-        i2s_data_if = bsp_audio_get_codec_itf();
-    }
-    assert(i2s_data_if);
-
-    BSP_ERROR_CHECK_RETURN_ERR(bsp_feature_enable(BSP_FEATURE_SPEAKER, true));
-
-    esp_codec_dev_cfg_t codec_dev_cfg = {
-        .dev_type = ESP_CODEC_DEV_TYPE_OUT,
-        .codec_if = NULL,
-        .data_if  = i2s_data_if,
-    };
-    return esp_codec_dev_new(&codec_dev_cfg);
-}
-
 // Bit number used to represent command and parameter
 #define LCD_CMD_BITS   8
 #define LCD_PARAM_BITS 8
@@ -277,106 +140,37 @@ esp_err_t bsp_display_brightness_init(void)
 {
     /* Initilize I2C */
     BSP_ERROR_CHECK_RETURN_ERR(bsp_i2c_init());
+    /* Registers are written in one I2C transaction, partially changed registers are read once before */
 #if defined(CONFIG_BSP_PMU_AXP2101)
-    const uint8_t lcd_bl_en[] = {0x90, 0x3F};  // AXP ALDO1~4 BLDO1~2 Enable
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, lcd_bl_en, sizeof(lcd_bl_en),
-                        1000 / portTICK_PERIOD_MS),
-                        TAG, "I2C write failed");
-    const uint8_t lcd_bl_val[] = {0x96, 0b000011000};  // AXP BLDO1 voltage
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, lcd_bl_val, sizeof(lcd_bl_val),
-                        1000 / portTICK_PERIOD_MS),
-                        TAG, "I2C write failed");
-
-    // AXP2101
-    // PowerKey Hold=1sec / PowerOff=4sec IRQLEVEL/OFFLEVEL/ONLEVEL setting
-    const uint8_t axp_pwr_val[] = {0x27, 0b00000000};
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, axp_pwr_val, sizeof(axp_pwr_val),
-                        1000 / portTICK_PERIOD_MS),
-                        TAG, "I2C write failed");
-    // Internal off-discharge enable for DCDC & LDO & SWITCH
-    const uint8_t axp_en_val[] = {0x10, 0b00110000};
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, axp_en_val, sizeof(axp_en_val),
-                        1000 / portTICK_PERIOD_MS),
-                        TAG, "I2C write failed");
-    // BATFET disable
-    const uint8_t axp_bat_val[] = {0x12, 0b00000000};
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, axp_bat_val, sizeof(axp_bat_val),
-                        1000 / portTICK_PERIOD_MS),
-                        TAG, "I2C write failed");
-    // CHGLED setting
-    const uint8_t axp_hgled_val[] = {0x69, 0b00010011};
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, axp_hgled_val, sizeof(axp_hgled_val),
-                        1000 / portTICK_PERIOD_MS),
-                        TAG, "I2C write failed");
+    const bsp_pmic_reg_t pmic_init[] = {
+        {0x90, 0xff, 0x3F},         // AXP ALDO1~4 BLDO1~2 Enable
+        {0x96, 0xff, 0b00011000},   // AXP BLDO1 voltage
+        {0x27, 0xff, 0b00000000},   // PowerKey Hold=1sec / PowerOff=4sec IRQLEVEL/OFFLEVEL/ONLEVEL setting
+        {0x10, 0xff, 0b00110000},   // Internal off-discharge enable for DCDC & LDO & SWITCH
+        {0x12, 0xff, 0b00000000},   // BATFET disable
+        {0x69, 0xff, 0b00010011},   // CHGLED setting
+    };
+    ESP_RETURN_ON_ERROR(bsp_pmic_update(pmic_init, sizeof(pmic_init) / sizeof(pmic_init[0])), TAG, "I2C write failed");
 #elif defined(CONFIG_BSP_PMU_AXP192)
-    read8bit(0x12);
-
-    const uint8_t vbus_limit[] = {0x30, (read8bit(0x30) & 0x04) | 0x02};  // axp: vbus limit off
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, vbus_limit, sizeof(vbus_limit),
-                        1000 / portTICK_PERIOD_MS),
-                        TAG, "I2C write failed");
-    const uint8_t pmu_gpio1[] = {0x92, read8bit(0x92) & 0xf8};  // AXP192 GPIO1:OD OUTPUT
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, pmu_gpio1, sizeof(pmu_gpio1),
-                        1000 / portTICK_PERIOD_MS),
-                        TAG, "I2C write failed");
-    const uint8_t pmu_gpio2[] = {0x93, read8bit(0x93) & 0xf8};  // AXP192 GPIO2:OD OUTPUT
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, pmu_gpio2, sizeof(pmu_gpio2),
-                        1000 / portTICK_PERIOD_MS),
-                        TAG, "I2C write failed");
-    const uint8_t pmu_gpio3[] = {0x35, (read8bit(0x35) & 0x1c) | 0xa2};  // AXP192 RTC CHG
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, pmu_gpio3, sizeof(pmu_gpio3),
-                        1000 / portTICK_PERIOD_MS),
-                        TAG, "I2C write failed");
-    const uint8_t esp_vol[] = {0x26, 0x6a};  // AXP192 RTC CHG
-    ESP_RETURN_ON_ERROR(
-        i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, esp_vol, sizeof(esp_vol), 1000 / portTICK_PERIOD_MS),
-        TAG, "I2C write failed");
-    const uint8_t lcd_bl_val[] = {0x27, 0x68};  // Lcd backlight voltage
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, lcd_bl_val, sizeof(lcd_bl_val),
-                        1000 / portTICK_PERIOD_MS),
-                        TAG, "I2C write failed");
-    const uint8_t pmu_ldo2[] = {0x28,
-                                (read8bit(0x28) & 0x0f) | 0xf0
-                               };  // axp: lcd logic and sdcard voltage preset to 3.3v
-    ESP_RETURN_ON_ERROR(
-        i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, pmu_ldo2, sizeof(pmu_ldo2), 1000 / portTICK_PERIOD_MS),
-        TAG, "I2C write failed");
-    const uint8_t pmu_ldo2_en[] = {0x12, (read8bit(0x12) & 0xfb) | 0x04};  // ldo2 enable
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, pmu_ldo2_en, sizeof(pmu_ldo2_en),
-                        1000 / portTICK_PERIOD_MS),
-                        TAG, "I2C write failed");
-    const uint8_t lcd_bl_en[] = {0x12, (read8bit(0x12) & 0xfd) | 0x02};  // Lcd backlight enable
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, lcd_bl_en, sizeof(lcd_bl_en),
-                        1000 / portTICK_PERIOD_MS),
-                        TAG, "I2C write failed");
-
-    const uint8_t chg_current[] = {0x33, ((read8bit(0x33) & 0xf0)) | 0x0};
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, chg_current, sizeof(chg_current),
-                        1000 / portTICK_PERIOD_MS),
-                        TAG, "I2C write failed");
-
-    const uint8_t apx_gpio4[] = {0x95, (read8bit(0x95) & 0x72) | 0x84};
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, apx_gpio4, sizeof(apx_gpio4),
-                        1000 / portTICK_PERIOD_MS),
-                        TAG, "I2C write failed");
-    read8bit(0x95);
-    const uint8_t pek_key[] = {0x36, 0x4c};  // Lcd backlight enable
-    ESP_RETURN_ON_ERROR(
-        i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, pek_key, sizeof(pek_key), 1000 / portTICK_PERIOD_MS),
-        TAG, "I2C write failed");
-    const uint8_t adc_en[] = {0x82, 0xff};  // Lcd backlight enable
-    ESP_RETURN_ON_ERROR(
-        i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, adc_en, sizeof(adc_en), 1000 / portTICK_PERIOD_MS),
-        TAG, "I2C write failed");
-    const uint8_t lcd_rset2[] = {0x96, read8bit(0x96) &(~0x02)};   // Lcd backlight enable
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, lcd_rset2, sizeof(lcd_rset2),
-                        1000 / portTICK_PERIOD_MS),
-                        TAG, "I2C write failed");
+    const bsp_pmic_reg_t pmic_init[] = {
+        {0x30, 0xfb, 0x02},         // axp: vbus limit off
+        {0x92, 0x07, 0x00},         // AXP192 GPIO1:OD OUTPUT
+        {0x93, 0x07, 0x00},         // AXP192 GPIO2:OD OUTPUT
+        {0x35, 0xe3, 0xa2},         // AXP192 RTC CHG
+        {0x26, 0xff, 0x6a},         // ESP32 voltage (DCDC1)
+        {0x27, 0xff, 0x68},         // Lcd backlight voltage
+        {0x28, 0xf0, 0xf0},         // axp: lcd logic and sdcard voltage preset to 3.3v
+        {0x12, 0x04, 0x04},         // ldo2 enable
+        {0x12, 0x02, 0x02},         // Lcd backlight enable
+        {0x33, 0x0f, 0x00},         // Charging current
+        {0x95, 0x8d, 0x84},         // AXP192 GPIO4
+        {0x36, 0xff, 0x4c},         // PEK key
+        {0x82, 0xff, 0xff},         // ADC enable
+        {0x96, 0x02, 0x00},         // Lcd reset (GPIO4 low)
+    };
+    ESP_RETURN_ON_ERROR(bsp_pmic_update(pmic_init, sizeof(pmic_init) / sizeof(pmic_init[0])), TAG, "I2C write failed");
     vTaskDelay(pdMS_TO_TICKS(100));                            // 延迟100ms
-    const uint8_t lcd_rset[] = {0x96, read8bit(0x96) | 0x02};  // Lcd backlight enable
-    ESP_RETURN_ON_ERROR(
-        i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, lcd_rset, sizeof(lcd_rset), 1000 / portTICK_PERIOD_MS),
-        TAG, "I2C write failed");
+    ESP_RETURN_ON_ERROR(bsp_pmic_update_bits(0x96, 0x02, 0x02), TAG, "I2C write failed");  // Lcd reset release
 #endif
     return ESP_OK;
 }
@@ -390,19 +184,14 @@ esp_err_t bsp_display_brightness_set(int brightness_percent)
         brightness_percent = 0;
     }
 
-    ESP_LOGI(TAG, "Setting LCD backlight: %d%%", brightness_percent);
+    /* Brightness has only 9 steps, the register is written only when the step changes (e.g. while a slider is moved) */
+    ESP_LOGD(TAG, "Setting LCD backlight: %d%%", brightness_percent);
 #if defined(CONFIG_BSP_PMU_AXP2101)
-    const uint8_t reg_val      = 20 + ((8 * brightness_percent) / 100);  // 0b00000 ~ 0b11100; under 20, it is too dark
-    const uint8_t lcd_bl_val[] = {0x96, reg_val};                        // AXP BLDO1 voltage
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, lcd_bl_val, sizeof(lcd_bl_val),
-                        1000 / portTICK_PERIOD_MS),
-                        TAG, "I2C write failed");
+    const uint8_t reg_val = 20 + ((8 * brightness_percent) / 100);  // 0b00000 ~ 0b11100; under 20, it is too dark
+    ESP_RETURN_ON_ERROR(bsp_pmic_write(0x96, reg_val), TAG, "I2C write failed");  // AXP BLDO1 voltage
 #elif defined(CONFIG_BSP_PMU_AXP192)
-    const uint8_t reg_val      = 90 + ((8 * brightness_percent) / 100);  // 0b00000 ~ 0b11100; under 20, it is too dark
-    const uint8_t lcd_bl_val[] = {0x27, reg_val};                        // AXP DCDC3 voltage
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP192_ADDR, lcd_bl_val, sizeof(lcd_bl_val),
-                        1000 / portTICK_PERIOD_MS),
-                        TAG, "I2C write failed");
+    const uint8_t reg_val = 90 + ((8 * brightness_percent) / 100);  // 0b00000 ~ 0b11100; under 20, it is too dark
+    ESP_RETURN_ON_ERROR(bsp_pmic_write(0x27, reg_val), TAG, "I2C write failed");  // AXP DCDC3 voltage
 #endif
 
     return ESP_OK;
@@ -437,7 +226,7 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
         .lcd_cmd_bits      = LCD_CMD_BITS,
         .lcd_param_bits    = LCD_PARAM_BITS,
         .spi_mode          = 0,
-        .trans_queue_depth = 10,
+        .trans_queue_depth = (config->trans_queue_depth > 0) ? config->trans_queue_depth : 10,
     };
     ESP_GOTO_ON_ERROR(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)BSP_LCD_SPI_NUM, &io_config, ret_io), err, TAG,
                       "New panel IO failed");
@@ -0,0 +1,91 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Access to the PMIC registers through a register shadow
+ *
+ * Control registers are read from the PMIC only once, read-modify-write works on the shadow and writes of unchanged
+ * values are skipped. Several registers are written in one I2C transaction (repeated START between the registers).
+ *
+ * @note Only control registers set by this BSP are shadowed, status and ADC registers must be read directly.
+ * @note The functions are not thread-safe, like the rest of the BSP initialization.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Update of one PMIC register, bits set in `mask` are replaced by `value`
+ */
+typedef struct {
+    uint8_t reg;    /*!< Register address */
+    uint8_t mask;   /*!< Changed bits (0xFF: whole register, it is not read before) */
+    uint8_t value;  /*!< New value of the changed bits */
+} bsp_pmic_reg_t;
+
+/**
+ * @brief Read PMIC register from the shadow, it is read from the PMIC only the first time
+ *
+ * @param reg   Register address
+ * @param value Output register value
+ * @return
+ *      - ESP_OK on success
+ *      - Error of the I2C read
+ */
+esp_err_t bsp_pmic_read(uint8_t reg, uint8_t *value);
+
+/**
+ * @brief Update PMIC registers in one I2C transaction
+ *
+ * Registers with partial mask, which are not in the shadow yet, are read first. Registers, whose value does not change,
+ * are not written. The updates are applied in the order, one register can be listed more times.
+ *
+ * @param regs  Register updates
+ * @param count Count of the updates
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_NO_MEM if there is no memory for the I2C command link
+ *      - Error of the I2C transaction (the shadow of the written registers is dropped)
+ */
+esp_err_t bsp_pmic_update(const bsp_pmic_reg_t *regs, size_t count);
+
+/**
+ * @brief Update bits of one PMIC register
+ *
+ * @param reg   Register address
+ * @param mask  Changed bits
+ * @param value New value of the changed bits
+ * @return See bsp_pmic_update()
+ */
+static inline esp_err_t bsp_pmic_update_bits(uint8_t reg, uint8_t mask, uint8_t value)
+{
+    const bsp_pmic_reg_t update = {.reg = reg, .mask = mask, .value = value};
+    return bsp_pmic_update(&update, 1);
+}
+
+/**
+ * @brief Write one PMIC register, the write is skipped when the shadow holds the same value
+ *
+ * @param reg   Register address
+ * @param value New value
+ * @return See bsp_pmic_update()
+ */
+static inline esp_err_t bsp_pmic_write(uint8_t reg, uint8_t value)
+{
+    return bsp_pmic_update_bits(reg, 0xFF, value);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -211,7 +211,8 @@ esp_err_t bsp_i2c_deinit(void);
  * @brief Camera default configuration
  *
  * In this configuration we select RGB565 color format and 320x240 image size - matching the display.
- * We use double-buffering for the best performance.
+ * We use double-buffering for the best performance. In grab-latest mode esp_camera_fb_get() always returns the newest frame,
+ * older frames are dropped, so frames do not get stale when the display is slower than the camera.
  * Since we don't want to waste internal SRAM, we allocate the framebuffers in external PSRAM.
  * By setting XCLK to 16MHz, we configure the esp32-camera driver to use EDMA when accessing the PSRAM.
  *
@@ -242,6 +243,7 @@ esp_err_t bsp_i2c_deinit(void);
         .frame_size = FRAMESIZE_QVGA,  \
         .jpeg_quality = 12,               \
         .fb_count = 2,                    \
+        .grab_mode = CAMERA_GRAB_LATEST,  \
         .fb_location = CAMERA_FB_IN_PSRAM,\
         .sccb_i2c_port = BSP_I2C_NUM,     \
     }
@@ -24,11 +24,11 @@
 #include "esp_lcd_ili9341.h"
 #include "esp_lcd_touch_ft5x06.h"
 #include "bsp_err_check.h"
+#include "bsp_pmic.h"
 #include "esp_codec_dev_defaults.h"
 
 static const char *TAG = "M5Stack";
 
-#define BSP_AXP2101_ADDR    0x34
 #define BSP_AW9523_ADDR     0x58
 
 /* Features */
@@ -84,6 +84,8 @@ static esp_err_t bsp_enable_feature(bsp_feature_t feature)
     esp_err_t err = ESP_OK;
     static uint8_t aw9523_P0 = 0b10;
     static uint8_t aw9523_P1 = 0b10100000;
+    static int16_t aw9523_P0_written = -1;  // Last value written to the port (-1: not written yet)
+    static int16_t aw9523_P1_written = -1;
     uint8_t data[2];
 
     /* Initilize I2C */
@@ -100,25 +102,18 @@ static esp_err_t bsp_enable_feature(bsp_feature_t feature)
         break;
     case BSP_FEATURE_SD:
         /* AXP ALDO4 voltage / SD Card / 3V3 */
-        data[0] = 0x95;
-        data[1] = 0b00011100; //3V3
-        err |= i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, data, sizeof(data), 1000 / portTICK_PERIOD_MS);
+        err |= bsp_pmic_write(0x95, 0b00011100);
         /* Enable SD */
         aw9523_P0 |= (1 << 4);
         break;
-    case BSP_FEATURE_SPEAKER:
-        /* AXP ALDO1 voltage / PA PVDD / 1V8 */
-        data[0] = 0x92;
-        data[1] = 0b00001101; //1V8
-        err |= i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, data, sizeof(data), 1000 / portTICK_PERIOD_MS);
-        /* AXP ALDO2 voltage / Codec / 3V3 */
-        data[0] = 0x93;
-        data[1] = 0b00011100; //3V3
-        err |= i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, data, sizeof(data), 1000 / portTICK_PERIOD_MS);
-        /* AXP ALDO3 voltage / Codec+Mic / 3V3 */
-        data[0] = 0x94;
-        data[1] = 0b00011100; //3V3
-        err |= i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, data, sizeof(data), 1000 / portTICK_PERIOD_MS);
+    case BSP_FEATURE_SPEAKER: {
+        /* One I2C transaction for the three LDOs */
+        const bsp_pmic_reg_t speaker_ldo[] = {
+            {0x92, 0xff, 0b00001101},   // AXP ALDO1 voltage / PA PVDD / 1V8
+            {0x93, 0xff, 0b00011100},   // AXP ALDO2 voltage / Codec / 3V3
+            {0x94, 0xff, 0b00011100},   // AXP ALDO3 voltage / Codec+Mic / 3V3
+        };
+        err |= bsp_pmic_update(speaker_ldo, sizeof(speaker_ldo) / sizeof(speaker_ldo[0]));
         /* AW9523 P0 is in push-pull mode */
         data[0] = 0x11;
         data[1] = 0x10;
@@ -126,19 +121,29 @@ static esp_err_t bsp_enable_feature(bsp_feature_t feature)
         /* Enable Codec AW88298 */
         aw9523_P0 |= (1 << 2);
         break;
+    }
     case BSP_FEATURE_CAMERA:
         /* Enable Camera */
         aw9523_P1 |= (1);
         break;
     }
 
-    data[0] = 0x02;
-    data[1] = aw9523_P0;
-    err |= i2c_master_write_to_device(BSP_I2C_NUM, BSP_AW9523_ADDR, data, sizeof(data), 1000 / portTICK_PERIOD_MS);
+    /* Only the port with a changed output is written */
+    if (aw9523_P0_written != aw9523_P0) {
+        data[0] = 0x02;
+        data[1] = aw9523_P0;
+        esp_err_t ret = i2c_master_write_to_device(BSP_I2C_NUM, BSP_AW9523_ADDR, data, sizeof(data), 1000 / portTICK_PERIOD_MS);
+        aw9523_P0_written = (ret == ESP_OK ? aw9523_P0 : -1);
+        err |= ret;
+    }
 
-    data[0] = 0x03;
-    data[1] = aw9523_P1;
-    err |= i2c_master_write_to_device(BSP_I2C_NUM, BSP_AW9523_ADDR, data, sizeof(data), 1000 / portTICK_PERIOD_MS);
+    if (aw9523_P1_written != aw9523_P1) {
+        data[0] = 0x03;
+        data[1] = aw9523_P1;
+        esp_err_t ret = i2c_master_write_to_device(BSP_I2C_NUM, BSP_AW9523_ADDR, data, sizeof(data), 1000 / portTICK_PERIOD_MS);
+        aw9523_P1_written = (ret == ESP_OK ? aw9523_P1 : -1);
+        err |= ret;
+    }
 
     return err;
 }
@@ -311,10 +316,12 @@ esp_err_t bsp_display_brightness_init(void)
     /* Initilize I2C */
     BSP_ERROR_CHECK_RETURN_ERR(bsp_i2c_init());
 
-    const uint8_t lcd_bl_en[] = { 0x90, 0xBF }; // AXP DLDO1 Enable
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, lcd_bl_en, sizeof(lcd_bl_en), 1000 / portTICK_PERIOD_MS), TAG, "I2C write failed");
-    const uint8_t lcd_bl_val[] = { 0x99, 0b00011000 };  // AXP DLDO1 voltage
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, lcd_bl_val, sizeof(lcd_bl_val), 1000 / portTICK_PERIOD_MS), TAG, "I2C write failed");
+    /* Both registers are written in one I2C transaction */
+    const bsp_pmic_reg_t lcd_bl[] = {
+        {0x90, 0xff, 0xBF},         // AXP DLDO1 Enable
+        {0x99, 0xff, 0b00011000},   // AXP DLDO1 voltage
+    };
+    ESP_RETURN_ON_ERROR(bsp_pmic_update(lcd_bl, sizeof(lcd_bl) / sizeof(lcd_bl[0])), TAG, "I2C write failed");
 
     return ESP_OK;
 }
@@ -328,10 +335,10 @@ esp_err_t bsp_display_brightness_set(int brightness_percent)
         brightness_percent = 0;
     }
 
-    ESP_LOGI(TAG, "Setting LCD backlight: %d%%", brightness_percent);
+    /* Brightness has only 9 steps, the register is written only when the step changes (e.g. while a slider is moved) */
+    ESP_LOGD(TAG, "Setting LCD backlight: %d%%", brightness_percent);
     const uint8_t reg_val = 20 + ((8 * brightness_percent) / 100); // 0b00000 ~ 0b11100; under 20, it is too dark
-    const uint8_t lcd_bl_val[] = { 0x99, reg_val }; // AXP DLDO1 voltage
-    ESP_RETURN_ON_ERROR(i2c_master_write_to_device(BSP_I2C_NUM, BSP_AXP2101_ADDR, lcd_bl_val, sizeof(lcd_bl_val), 1000 / portTICK_PERIOD_MS), TAG, "I2C write failed");
+    ESP_RETURN_ON_ERROR(bsp_pmic_write(0x99, reg_val), TAG, "I2C write failed"); // AXP DLDO1 voltage
 
     return ESP_OK;
 }
@@ -365,7 +372,7 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_hand
         .lcd_cmd_bits = LCD_CMD_BITS,
         .lcd_param_bits = LCD_PARAM_BITS,
         .spi_mode = 0,
-        .trans_queue_depth = 10,
+        .trans_queue_depth = (config->trans_queue_depth > 0) ? config->trans_queue_depth : 10,
     };
     ESP_GOTO_ON_ERROR(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)BSP_LCD_SPI_NUM, &io_config, ret_io), err, TAG, "New panel IO failed");
 
@@ -0,0 +1,99 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <assert.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "driver/i2c.h"
+
+#include "bsp/m5stack_core_s3.h"
+#include "bsp_pmic.h"
+
+static const char *TAG = "M5Stack";
+
+/* AXP2101 */
+#define BSP_PMIC_ADDR       0x34
+#define BSP_PMIC_TIMEOUT    (1000 / portTICK_PERIOD_MS)
+
+static uint8_t pmic_shadow[256];        // Last value read from or written to each register
+static uint32_t pmic_valid[256 / 32];   // Registers with valid value in the shadow
+
+static inline bool bsp_pmic_is_valid(uint8_t reg)
+{
+    return (pmic_valid[reg / 32] & (1UL << (reg % 32))) != 0;
+}
+
+static inline void bsp_pmic_set_valid(uint8_t reg, bool valid)
+{
+    if (valid) {
+        pmic_valid[reg / 32] |= (1UL << (reg % 32));
+    } else {
+        pmic_valid[reg / 32] &= ~(1UL << (reg % 32));
+    }
+}
+
+esp_err_t bsp_pmic_read(uint8_t reg, uint8_t *value)
+{
+    if (!bsp_pmic_is_valid(reg)) {
+        ESP_RETURN_ON_ERROR(i2c_master_write_read_device(BSP_I2C_NUM, BSP_PMIC_ADDR, &reg, 1, &pmic_shadow[reg], 1, BSP_PMIC_TIMEOUT),
+                            TAG, "PMIC register 0x%02x read failed", reg);
+        bsp_pmic_set_valid(reg, true);
+        ESP_LOGD(TAG, "PMIC register 0x%02x: 0x%02x", reg, pmic_shadow[reg]);
+    }
+    *value = pmic_shadow[reg];
+    return ESP_OK;
+}
+
+esp_err_t bsp_pmic_update(const bsp_pmic_reg_t *regs, size_t count)
+{
+    esp_err_t ret = ESP_OK;
+    uint32_t written[256 / 32] = {0};
+    size_t writes = 0;
+    assert(regs);
+
+    /* Registers with partial mask must be known before the transaction */
+    for (size_t i = 0; i < count; i++) {
+        uint8_t value;
+        if (regs[i].mask != 0xFF) {
+            ESP_RETURN_ON_ERROR(bsp_pmic_read(regs[i].reg, &value), TAG, "");
+        }
+    }
+
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    ESP_RETURN_ON_FALSE(cmd, ESP_ERR_NO_MEM, TAG, "Not enough memory for I2C command link");
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t reg = regs[i].reg;
+        const uint8_t value = (pmic_shadow[reg] & ~regs[i].mask) | (regs[i].value & regs[i].mask);
+        if (bsp_pmic_is_valid(reg) && pmic_shadow[reg] == value) {
+            continue;
+        }
+        /* Each register is one write with repeated START, the data are stored in the command link */
+        ESP_GOTO_ON_ERROR(i2c_master_start(cmd), err, TAG, "");
+        ESP_GOTO_ON_ERROR(i2c_master_write_byte(cmd, (BSP_PMIC_ADDR << 1) | I2C_MASTER_WRITE, true), err, TAG, "");
+        ESP_GOTO_ON_ERROR(i2c_master_write_byte(cmd, reg, true), err, TAG, "");
+        ESP_GOTO_ON_ERROR(i2c_master_write_byte(cmd, value, true), err, TAG, "");
+        pmic_shadow[reg] = value;
+        bsp_pmic_set_valid(reg, true);
+        written[reg / 32] |= (1UL << (reg % 32));
+        writes++;
+    }
+
+    if (writes > 0) {
+        ESP_GOTO_ON_ERROR(i2c_master_stop(cmd), err, TAG, "");
+        ESP_GOTO_ON_ERROR(i2c_master_cmd_begin(BSP_I2C_NUM, cmd, BSP_PMIC_TIMEOUT), err, TAG, "PMIC write failed");
+    }
+
+err:
+    i2c_cmd_link_delete(cmd);
+    if (ret != ESP_OK) {
+        /* It is not known, which registers were written */
+        for (int i = 0; i < 256 / 32; i++) {
+            pmic_valid[i] &= ~written[i];
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,179 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "afe_feed.h"
+
+static const char *TAG = "afe_feed";
+
+struct afe_feed_s {
+    afe_feed_config_t config;
+    int16_t *frame;                     /* Feed buffer, the codec reads into it and the AFE is fed from it */
+    size_t frame_bytes;
+    uint64_t jitter_sum;                /* Sum of the deviations for the average */
+    uint32_t intervals;                 /* Count of the summed deviations */
+    afe_feed_stats_t stats;
+    portMUX_TYPE stats_lock;
+    SemaphoreHandle_t exited;
+    volatile bool running;
+};
+
+static void afe_feed_task(void *arg)
+{
+    afe_feed_handle_t handle = (afe_feed_handle_t)arg;
+    const afe_feed_config_t *cfg = &handle->config;
+    const int64_t period_us = handle->stats.period_us;
+    int64_t last = 0;
+
+    while (handle->running) {
+        if (esp_codec_dev_read(cfg->mic, handle->frame, handle->frame_bytes) != ESP_CODEC_DEV_OK) {
+            portENTER_CRITICAL(&handle->stats_lock);
+            handle->stats.read_errors++;
+            portEXIT_CRITICAL(&handle->stats_lock);
+            vTaskDelay(1);
+            last = 0;
+            continue;
+        }
+        /* The read returns when the last sample of the frame arrived, the interval follows the I2S clock */
+        const int64_t now = esp_timer_get_time();
+        cfg->feed_cb(handle->frame, cfg->user_ctx);
+        const uint32_t feed_time = esp_timer_get_time() - now;
+
+        portENTER_CRITICAL(&handle->stats_lock);
+        if (last != 0) {
+            const uint32_t jitter = llabs(now - last - period_us);
+            handle->stats.jitter_max_us = MAX(handle->stats.jitter_max_us, jitter);
+            handle->jitter_sum += jitter;
+            handle->intervals++;
+            /* Later frames wait in DMA buffers, which are overwritten when the task is late too long */
+            if (now - last > period_us + period_us / 2) {
+                handle->stats.late++;
+            }
+        }
+        handle->stats.feed_time_max_us = MAX(handle->stats.feed_time_max_us, feed_time);
+        handle->stats.frames++;
+        portEXIT_CRITICAL(&handle->stats_lock);
+        last = now;
+    }
+
+    xSemaphoreGive(handle->exited);
+    vTaskDelete(NULL);
+}
+
+static void afe_feed_free(afe_feed_handle_t handle)
+{
+    if (handle->exited) {
+        vSemaphoreDelete(handle->exited);
+    }
+    free(handle->frame);
+    free(handle);
+}
+
+esp_err_t afe_feed_parse_format(const char *input_format, uint8_t *mic_num, uint8_t *ref_num)
+{
+    ESP_RETURN_ON_FALSE(input_format, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    const size_t len = strlen(input_format);
+    ESP_RETURN_ON_FALSE(len > 0 && len <= AFE_FEED_CHANNELS_MAX, ESP_ERR_INVALID_ARG, TAG, "Invalid count of channels");
+
+    uint8_t mics = 0;
+    uint8_t refs = 0;
+    for (size_t i = 0; i < len; i++) {
+        switch (input_format[i]) {
+        case 'M':
+            mics++;
+            break;
+        case 'R':
+            refs++;
+            break;
+        case 'N':
+            break;
+        default:
+            ESP_RETURN_ON_FALSE(false, ESP_ERR_INVALID_ARG, TAG, "Invalid channel '%c' in input format", input_format[i]);
+        }
+    }
+    ESP_RETURN_ON_FALSE(mics > 0, ESP_ERR_INVALID_ARG, TAG, "No microphone in input format");
+    if (mic_num) {
+        *mic_num = mics;
+    }
+    if (ref_num) {
+        *ref_num = refs;
+    }
+    return ESP_OK;
+}
+
+esp_err_t afe_feed_create(const afe_feed_config_t *config, afe_feed_handle_t *ret_handle)
+{
+    esp_err_t ret = ESP_OK;
+    BaseType_t res;
+    ESP_RETURN_ON_FALSE(config && ret_handle && config->mic && config->feed_cb, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->chunk_samples > 0 && config->sample_rate > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid audio format");
+    ESP_RETURN_ON_ERROR(afe_feed_parse_format(config->input_format, NULL, NULL), TAG, "Invalid input format");
+
+    afe_feed_handle_t handle = calloc(1, sizeof(struct afe_feed_s));
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_NO_MEM, TAG, "Not enough memory for AFE feed");
+    handle->config = *config;
+    handle->frame_bytes = config->chunk_samples * strlen(config->input_format) * sizeof(int16_t);
+    handle->stats.period_us = (uint64_t)config->chunk_samples * 1000000 / config->sample_rate;
+    portMUX_INITIALIZE(&handle->stats_lock);
+
+    /* Internal RAM, the I2S driver copies the DMA buffers into it */
+    handle->frame = heap_caps_malloc(handle->frame_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    handle->exited = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(handle->frame && handle->exited, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for feed buffer");
+
+    handle->running = true;
+    if (config->task_affinity < 0) {
+        res = xTaskCreate(afe_feed_task, "afe_feed", config->task_stack, handle, config->task_priority, NULL);
+    } else {
+        res = xTaskCreatePinnedToCore(afe_feed_task, "afe_feed", config->task_stack, handle, config->task_priority, NULL, config->task_affinity);
+    }
+    ESP_GOTO_ON_FALSE(res == pdPASS, ESP_ERR_NO_MEM, err, TAG, "Create task failed");
+
+    *ret_handle = handle;
+    return ESP_OK;
+
+err:
+    afe_feed_free(handle);
+    return ret;
+}
+
+esp_err_t afe_feed_delete(afe_feed_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    /* The task finishes the running frame */
+    handle->running = false;
+    xSemaphoreTake(handle->exited, portMAX_DELAY);
+    afe_feed_free(handle);
+    return ESP_OK;
+}
+
+esp_err_t afe_feed_get_stats(afe_feed_handle_t handle, afe_feed_stats_t *stats, bool reset)
+{
+    ESP_RETURN_ON_FALSE(handle && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    portENTER_CRITICAL(&handle->stats_lock);
+    *stats = handle->stats;
+    stats->jitter_avg_us = handle->intervals ? handle->jitter_sum / handle->intervals : 0;
+    if (reset) {
+        const uint32_t period_us = handle->stats.period_us;
+        memset(&handle->stats, 0, sizeof(handle->stats));
+        handle->stats.period_us = period_us;
+        handle->jitter_sum = 0;
+        handle->intervals = 0;
+    }
+    portEXIT_CRITICAL(&handle->stats_lock);
+    return ESP_OK;
+}
@@ -0,0 +1,139 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Feed of microphone array frames to esp-sr AFE
+ *
+ * A pinned high priority task reads frames of the AFE feed chunk size from the microphone codec directly into
+ * the feed buffer and passes them to the AFE. The frames are passed in the channel order of the board (TDM slot
+ * order), the AFE is configured with the matching input format (e.g. "MMNR"), so the channels are not reordered
+ * and the reference is not copied into an extra buffer.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_codec_dev.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maximum count of channels in one frame
+ */
+#define AFE_FEED_CHANNELS_MAX   (8)
+
+/**
+ * @brief Callback feeding one frame to the AFE (e.g. `afe_handle->feed(afe_data, frame)`)
+ *
+ * @param[in] frame     Frame of `chunk_samples * channels` 16-bit samples in the order of `input_format`
+ * @param[in] user_ctx  User data from the configuration
+ */
+typedef void (*afe_feed_cb_t)(const int16_t *frame, void *user_ctx);
+
+/**
+ * @brief AFE feed configuration
+ */
+typedef struct {
+    esp_codec_dev_handle_t mic;     /*!< Opened microphone codec device with all channels of `input_format` */
+    const char *input_format;       /*!< Channel order of the board, one character per channel: 'M' microphone,
+                                         'R' playback reference, 'N' unused (e.g. BSP_AFE_INPUT_FORMAT) */
+    size_t chunk_samples;           /*!< Samples of each channel in one frame (`get_feed_chunksize` of the AFE) */
+    uint32_t sample_rate;           /*!< Sample rate of the codec [Hz] */
+    afe_feed_cb_t feed_cb;          /*!< Feed callback */
+    void *user_ctx;                 /*!< User data for the callback */
+    int task_priority;              /*!< Priority of the feed task */
+    int task_stack;                 /*!< Stack size of the feed task [bytes] */
+    int task_affinity;              /*!< Core of the feed task (-1 for no affinity) */
+} afe_feed_config_t;
+
+/**
+ * @brief Default AFE feed configuration (16 kHz, 512 samples = 32 ms frames, task pinned to core 0)
+ */
+#define AFE_FEED_CONFIG_DEFAULT(mic_dev, format, cb)    \
+    {                                                   \
+        .mic = (mic_dev),                               \
+        .input_format = (format),                       \
+        .chunk_samples = 512,                           \
+        .sample_rate = 16000,                           \
+        .feed_cb = (cb),                                \
+        .task_priority = 10,                            \
+        .task_stack = 4096,                             \
+        .task_affinity = 0,                             \
+    }
+
+/**
+ * @brief AFE feed statistics
+ */
+typedef struct {
+    uint32_t frames;                /*!< Count of fed frames */
+    uint32_t read_errors;           /*!< Count of failed codec reads */
+    uint32_t late;                  /*!< Frames read more than half period late (frames could be lost in DMA) */
+    uint32_t period_us;             /*!< Nominal period of the frames [us] */
+    uint32_t jitter_max_us;         /*!< Largest deviation of the frame interval from the period [us] */
+    uint32_t jitter_avg_us;         /*!< Average deviation of the frame interval from the period [us] */
+    uint32_t feed_time_max_us;      /*!< Longest time spent in the feed callback [us] */
+} afe_feed_stats_t;
+
+/**
+ * @brief AFE feed handle
+ */
+typedef struct afe_feed_s *afe_feed_handle_t;
+
+/**
+ * @brief Start feeding the AFE
+ *
+ * @param config        Configuration
+ * @param ret_handle    Created feed
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error or the input format is not valid
+ *      - ESP_ERR_NO_MEM        if there is no memory for the feed buffer or the task
+ */
+esp_err_t afe_feed_create(const afe_feed_config_t *config, afe_feed_handle_t *ret_handle);
+
+/**
+ * @brief Stop feeding, the codec stays open
+ *
+ * @param handle    Feed
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t afe_feed_delete(afe_feed_handle_t handle);
+
+/**
+ * @brief Get statistics of the feed
+ *
+ * @param handle    Feed
+ * @param stats     Output statistics
+ * @param reset     Reset the statistics after reading
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t afe_feed_get_stats(afe_feed_handle_t handle, afe_feed_stats_t *stats, bool reset);
+
+/**
+ * @brief Count microphone and reference channels of the input format
+ *
+ * @param[in]  input_format Input format (e.g. "MMNR")
+ * @param[out] mic_num      Count of microphone channels (can be NULL)
+ * @param[out] ref_num      Count of reference channels (can be NULL)
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if the format is not valid
+ */
+esp_err_t afe_feed_parse_format(const char *input_format, uint8_t *mic_num, uint8_t *ref_num);
+
+#ifdef __cplusplus
+}
+#endif
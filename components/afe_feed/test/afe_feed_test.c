@@ -0,0 +1,51 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "unity.h"
+#include "afe_feed.h"
+
+static void feed_cb(const int16_t *frame, void *user_ctx)
+{
+}
+
+TEST_CASE("AFE feed input format test", "[afe_feed]")
+{
+    uint8_t mics = 0;
+    uint8_t refs = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, afe_feed_parse_format("MMNR", &mics, &refs));
+    TEST_ASSERT_EQUAL(2, mics);
+    TEST_ASSERT_EQUAL(1, refs);
+    TEST_ASSERT_EQUAL(ESP_OK, afe_feed_parse_format("MMMR", &mics, NULL));
+    TEST_ASSERT_EQUAL(3, mics);
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, afe_feed_parse_format("", &mics, &refs));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, afe_feed_parse_format("NR", &mics, &refs));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, afe_feed_parse_format("MX", &mics, &refs));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, afe_feed_parse_format("MMMMMMMMM", &mics, &refs));
+}
+
+TEST_CASE("AFE feed invalid arguments test", "[afe_feed]")
+{
+    /* The codec is not read, when the configuration is invalid */
+    static int dummy_codec;
+    afe_feed_handle_t feed = NULL;
+
+    afe_feed_config_t config = AFE_FEED_CONFIG_DEFAULT(NULL, "MMNR", feed_cb);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, afe_feed_create(&config, &feed));
+
+    config.mic = (esp_codec_dev_handle_t)&dummy_codec;
+    config.input_format = "MMXR";
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, afe_feed_create(&config, &feed));
+
+    config.input_format = "MMNR";
+    config.chunk_samples = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, afe_feed_create(&config, &feed));
+    TEST_ASSERT_NULL(feed);
+
+    afe_feed_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, afe_feed_delete(NULL));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, afe_feed_get_stats(NULL, &stats, false));
+}
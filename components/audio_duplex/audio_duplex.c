@@ -0,0 +1,269 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "audio_duplex.h"
+#if CONFIG_AUDIO_DUPLEX_TRACE_SYSVIEW
+#include "SEGGER_SYSVIEW.h"
+#endif
+
+static const char *TAG = "audio_duplex";
+
+/* Latency measurement: frames to settle the codecs and measure the noise before the impulse is played */
+#define AUDIO_DUPLEX_MEASURE_SETTLE_FRAMES  (5)
+#define AUDIO_DUPLEX_MEASURE_NOISE_FRAMES   (10)
+#define AUDIO_DUPLEX_MEASURE_IMPULSE        (16)        /* Length of the impulse [samples] */
+#define AUDIO_DUPLEX_MEASURE_AMPLITUDE      (16384)
+#define AUDIO_DUPLEX_MEASURE_THRESHOLD_MIN  (1000)
+
+/* SystemView user event of the captured frame processing */
+#define AUDIO_DUPLEX_SV_FRAME               (5)
+#if CONFIG_AUDIO_DUPLEX_TRACE_SYSVIEW
+#define AUDIO_DUPLEX_SV_START(id)           SEGGER_SYSVIEW_OnUserStart(id)
+#define AUDIO_DUPLEX_SV_STOP(id)            SEGGER_SYSVIEW_OnUserStop(id)
+#else
+#define AUDIO_DUPLEX_SV_START(id)
+#define AUDIO_DUPLEX_SV_STOP(id)
+#endif
+
+typedef struct {
+    uint8_t spk_channels;
+    uint8_t mic_channels;
+    uint32_t spk_frames;                    /* Count of played frames */
+    uint32_t mic_pos;                       /* Count of captured samples */
+    uint32_t play_pos;                      /* Sample position of the impulse */
+    int32_t noise;                          /* Largest captured sample before the impulse */
+    uint32_t found_pos;
+    SemaphoreHandle_t found;
+} audio_duplex_measure_t;
+
+struct audio_duplex_s {
+    audio_duplex_config_t config;
+    int16_t *history;                       /* Last (ref_delay_frames + 1) playback frames */
+    int16_t *mic_buf;                       /* One captured frame */
+    size_t spk_frame_len;                   /* Count of samples of one playback frame (all channels) */
+    size_t mic_frame_len;
+    SemaphoreHandle_t exited;
+    audio_duplex_stats_t stats;
+    volatile bool running;
+};
+
+static void audio_duplex_task(void *arg)
+{
+    audio_duplex_handle_t handle = (audio_duplex_handle_t)arg;
+    const audio_duplex_config_t *cfg = &handle->config;
+    const uint32_t slots = cfg->ref_delay_frames + 1;
+    const int64_t frame_us = (int64_t)cfg->frame_samples * 1000000 / cfg->sample_rate;
+    int64_t last = 0;
+    uint32_t n = 0;
+
+    while (handle->running) {
+        /* Frame n is played now, frame (n - ref_delay_frames) is heard by the microphone now */
+        int16_t *play = &handle->history[(n % slots) * handle->spk_frame_len];
+        const int16_t *ref = &handle->history[((n + 1) % slots) * handle->spk_frame_len];
+
+        const int64_t start = esp_timer_get_time();
+        if (cfg->play_cb) {
+            cfg->play_cb(play, cfg->frame_samples, cfg->user_ctx);
+        }
+        uint32_t cb_time = esp_timer_get_time() - start;
+
+        /* Both directions run on the same I2S clock, one write and one read per frame keep them in lockstep */
+        esp_codec_dev_write(cfg->spk, play, handle->spk_frame_len * sizeof(int16_t));
+        if (esp_codec_dev_read(cfg->mic, handle->mic_buf, handle->mic_frame_len * sizeof(int16_t)) != ESP_CODEC_DEV_OK) {
+            ESP_LOGE(TAG, "Codec read failed");
+            break;
+        }
+
+        /* Captured buffer is done, the event lasts until the application processed it */
+        AUDIO_DUPLEX_SV_START(AUDIO_DUPLEX_SV_FRAME);
+        const int64_t cb_start = esp_timer_get_time();
+        cfg->capture_cb(handle->mic_buf, ref, cfg->frame_samples, cfg->user_ctx);
+        AUDIO_DUPLEX_SV_STOP(AUDIO_DUPLEX_SV_FRAME);
+        const int64_t now = esp_timer_get_time();
+        cb_time += now - cb_start;
+
+        handle->stats.cb_time_max = MAX(handle->stats.cb_time_max, cb_time);
+        /* DMA buffers hide small jitter, longer gap means dropped or repeated frame and moved reference */
+        if (last != 0 && now - last > 2 * frame_us) {
+            handle->stats.late_cnt++;
+        }
+        last = now;
+        handle->stats.frames++;
+        n++;
+    }
+
+    xSemaphoreGive(handle->exited);
+    vTaskDelete(NULL);
+}
+
+static void audio_duplex_free(audio_duplex_handle_t handle)
+{
+    if (handle->exited) {
+        vSemaphoreDelete(handle->exited);
+    }
+    free(handle->history);
+    free(handle->mic_buf);
+    free(handle);
+}
+
+esp_err_t audio_duplex_create(const audio_duplex_config_t *config, audio_duplex_handle_t *ret_handle)
+{
+    esp_err_t ret = ESP_OK;
+    BaseType_t res;
+    bool spk_open = false;
+    bool mic_open = false;
+    ESP_RETURN_ON_FALSE(config && ret_handle && config->spk && config->mic && config->capture_cb, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->sample_rate > 0 && config->frame_samples > 0 && config->spk_channels > 0 && config->mic_channels > 0,
+                        ESP_ERR_INVALID_ARG, TAG, "Invalid audio format");
+
+    audio_duplex_handle_t handle = calloc(1, sizeof(struct audio_duplex_s));
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_NO_MEM, TAG, "Not enough memory for audio duplex");
+    handle->config = *config;
+    handle->spk_frame_len = config->frame_samples * config->spk_channels;
+    handle->mic_frame_len = config->frame_samples * config->mic_channels;
+
+    /* Zeroed history is the reference of the first frames */
+    handle->history = calloc((config->ref_delay_frames + 1) * handle->spk_frame_len, sizeof(int16_t));
+    handle->mic_buf = malloc(handle->mic_frame_len * sizeof(int16_t));
+    handle->exited = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(handle->history && handle->mic_buf && handle->exited, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for buffers");
+
+    esp_codec_dev_sample_info_t fs = {
+        .sample_rate = config->sample_rate,
+        .channel = config->spk_channels,
+        .bits_per_sample = 16,
+    };
+    ESP_GOTO_ON_FALSE(esp_codec_dev_open(config->spk, &fs) == ESP_CODEC_DEV_OK, ESP_FAIL, err, TAG, "Speaker open failed");
+    spk_open = true;
+    fs.channel = config->mic_channels;
+    ESP_GOTO_ON_FALSE(esp_codec_dev_open(config->mic, &fs) == ESP_CODEC_DEV_OK, ESP_FAIL, err, TAG, "Microphone open failed");
+    mic_open = true;
+
+    handle->running = true;
+    if (config->task_affinity < 0) {
+        res = xTaskCreate(audio_duplex_task, "audio_duplex", config->task_stack, handle, config->task_priority, NULL);
+    } else {
+        res = xTaskCreatePinnedToCore(audio_duplex_task, "audio_duplex", config->task_stack, handle, config->task_priority, NULL, config->task_affinity);
+    }
+    ESP_GOTO_ON_FALSE(res == pdPASS, ESP_ERR_NO_MEM, err, TAG, "Create task failed");
+
+    *ret_handle = handle;
+    return ESP_OK;
+
+err:
+    if (mic_open) {
+        esp_codec_dev_close(config->mic);
+    }
+    if (spk_open) {
+        esp_codec_dev_close(config->spk);
+    }
+    audio_duplex_free(handle);
+    return ret;
+}
+
+esp_err_t audio_duplex_delete(audio_duplex_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    /* The task finishes the running frame */
+    handle->running = false;
+    xSemaphoreTake(handle->exited, portMAX_DELAY);
+    esp_codec_dev_close(handle->config.mic);
+    esp_codec_dev_close(handle->config.spk);
+    audio_duplex_free(handle);
+    return ESP_OK;
+}
+
+static void audio_duplex_measure_play_cb(int16_t *spk, size_t samples, void *user_ctx)
+{
+    audio_duplex_measure_t *m = (audio_duplex_measure_t *)user_ctx;
+
+    memset(spk, 0, samples * m->spk_channels * sizeof(int16_t));
+    if (m->spk_frames == AUDIO_DUPLEX_MEASURE_SETTLE_FRAMES + AUDIO_DUPLEX_MEASURE_NOISE_FRAMES) {
+        m->play_pos = m->spk_frames * samples;
+        for (size_t i = 0; i < MIN(samples, AUDIO_DUPLEX_MEASURE_IMPULSE) * m->spk_channels; i++) {
+            spk[i] = AUDIO_DUPLEX_MEASURE_AMPLITUDE;
+        }
+    }
+    m->spk_frames++;
+}
+
+static void audio_duplex_measure_capture_cb(const int16_t *mic, const int16_t *ref, size_t samples, void *user_ctx)
+{
+    audio_duplex_measure_t *m = (audio_duplex_measure_t *)user_ctx;
+    const uint32_t frame = m->mic_pos / samples;
+    const size_t len = samples * m->mic_channels;
+
+    /* Frames of the capture and of the playback have the same index, they are processed in the same cycle */
+    if (frame < AUDIO_DUPLEX_MEASURE_SETTLE_FRAMES) {
+        /* Startup of the codecs */
+    } else if (frame < AUDIO_DUPLEX_MEASURE_SETTLE_FRAMES + AUDIO_DUPLEX_MEASURE_NOISE_FRAMES) {
+        for (size_t i = 0; i < len; i++) {
+            m->noise = MAX(m->noise, abs(mic[i]));
+        }
+    } else if (m->found_pos == 0) {
+        const int32_t threshold = MAX(4 * m->noise, AUDIO_DUPLEX_MEASURE_THRESHOLD_MIN);
+        for (size_t i = 0; i < len; i++) {
+            if (abs(mic[i]) > threshold) {
+                m->found_pos = m->mic_pos + i / m->mic_channels;
+                xSemaphoreGive(m->found);
+                break;
+            }
+        }
+    }
+    m->mic_pos += samples;
+}
+
+esp_err_t audio_duplex_measure_latency(const audio_duplex_config_t *config, uint32_t timeout_ms, audio_duplex_latency_t *result)
+{
+    esp_err_t ret = ESP_OK;
+    audio_duplex_handle_t handle = NULL;
+    ESP_RETURN_ON_FALSE(config && result, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    audio_duplex_measure_t m = {
+        .spk_channels = config->spk_channels,
+        .mic_channels = config->mic_channels,
+        .found = xSemaphoreCreateBinary(),
+    };
+    ESP_RETURN_ON_FALSE(m.found, ESP_ERR_NO_MEM, TAG, "Not enough memory for semaphore");
+
+    audio_duplex_config_t cfg = *config;
+    cfg.play_cb = audio_duplex_measure_play_cb;
+    cfg.capture_cb = audio_duplex_measure_capture_cb;
+    cfg.user_ctx = &m;
+    ESP_GOTO_ON_ERROR(audio_duplex_create(&cfg, &handle), err, TAG, "Create engine failed");
+
+    const bool found = (xSemaphoreTake(m.found, pdMS_TO_TICKS(timeout_ms)) == pdTRUE);
+    audio_duplex_delete(handle);
+    ESP_GOTO_ON_FALSE(found && m.found_pos >= m.play_pos, ESP_ERR_TIMEOUT, err, TAG, "Impulse was not captured, check the loopback");
+
+    result->latency_samples = m.found_pos - m.play_pos;
+    result->latency_us = (uint64_t)result->latency_samples * 1000000 / config->sample_rate;
+    result->ref_delay_frames = result->latency_samples / config->frame_samples;
+    ESP_LOGI(TAG, "Loopback latency %" PRIu32 " us (%" PRIu32 " samples)", result->latency_us, result->latency_samples);
+
+err:
+    vSemaphoreDelete(m.found);
+    return ret;
+}
+
+esp_err_t audio_duplex_get_stats(audio_duplex_handle_t handle, audio_duplex_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(handle && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    *stats = handle->stats;
+    return ESP_OK;
+}
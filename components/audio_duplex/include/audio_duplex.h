@@ -0,0 +1,162 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Full-duplex audio engine
+ *
+ * One task writes the speaker and reads the microphone in lockstep with fixed frame size. Each captured
+ * frame is delivered together with the playback frame, which was sent to the speaker at the same time
+ * (reference signal for acoustic echo cancellation).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_codec_dev.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Callback filling the next playback frame
+ *
+ * @param[out] spk      Frame of `samples * spk_channels` 16-bit samples (interleaved)
+ * @param[in]  samples  Count of samples of each channel
+ * @param[in]  user_ctx User data from the configuration
+ */
+typedef void (*audio_duplex_play_cb_t)(int16_t *spk, size_t samples, void *user_ctx);
+
+/**
+ * @brief Callback of captured frame
+ *
+ * @param[in] mic       Captured frame of `samples * mic_channels` 16-bit samples (interleaved)
+ * @param[in] ref       Playback frame aligned with the captured frame (`samples * spk_channels`)
+ * @param[in] samples   Count of samples of each channel
+ * @param[in] user_ctx  User data from the configuration
+ */
+typedef void (*audio_duplex_capture_cb_t)(const int16_t *mic, const int16_t *ref, size_t samples, void *user_ctx);
+
+/**
+ * @brief Audio duplex engine configuration
+ */
+typedef struct {
+    esp_codec_dev_handle_t spk;             /*!< Speaker codec device (e.g. from `bsp_audio_codec_speaker_init`) */
+    esp_codec_dev_handle_t mic;             /*!< Microphone codec device (e.g. from `bsp_audio_codec_microphone_init`) */
+    uint32_t sample_rate;                   /*!< Sample rate of both directions [Hz] */
+    uint8_t spk_channels;                   /*!< Count of speaker channels */
+    uint8_t mic_channels;                   /*!< Count of microphone channels */
+    size_t frame_samples;                   /*!< Count of samples of each channel in one frame */
+    uint32_t ref_delay_frames;              /*!< Frames between speaker write and capture of the same sound (board latency) */
+    audio_duplex_play_cb_t play_cb;         /*!< Playback callback (NULL: silence is played) */
+    audio_duplex_capture_cb_t capture_cb;   /*!< Capture callback */
+    void *user_ctx;                         /*!< User data for the callbacks */
+    int task_priority;                      /*!< Priority of the engine task */
+    int task_stack;                         /*!< Stack size of the engine task [bytes] */
+    int task_affinity;                      /*!< Core of the task (-1 for no affinity) */
+} audio_duplex_config_t;
+
+/**
+ * @brief Default audio duplex configuration (16 kHz mono, 10 ms frames)
+ */
+#define AUDIO_DUPLEX_CONFIG_DEFAULT(spk_dev, mic_dev)   \
+    {                                                   \
+        .spk = (spk_dev),                               \
+        .mic = (mic_dev),                               \
+        .sample_rate = 16000,                           \
+        .spk_channels = 1,                              \
+        .mic_channels = 1,                              \
+        .frame_samples = 160,                           \
+        .ref_delay_frames = 2,                          \
+        .task_priority = 8,                             \
+        .task_stack = 4096,                             \
+        .task_affinity = -1,                            \
+    }
+
+/**
+ * @brief Audio duplex statistics
+ */
+typedef struct {
+    uint32_t frames;                        /*!< Count of processed frames */
+    uint32_t late_cnt;                      /*!< Count of frames, when the task was not in time and the alignment could be lost */
+    uint32_t cb_time_max;                   /*!< Longest time spent in the callbacks in one frame [us] */
+} audio_duplex_stats_t;
+
+/**
+ * @brief Result of loopback latency measurement
+ */
+typedef struct {
+    uint32_t latency_samples;               /*!< Samples between the speaker write and the capture of the same sound */
+    uint32_t latency_us;                    /*!< The same latency in [us] (speaker write to capture, round trip of DMA buffers and codecs) */
+    uint32_t ref_delay_frames;              /*!< Value of `ref_delay_frames` for this board and configuration */
+} audio_duplex_latency_t;
+
+/**
+ * @brief Audio duplex handle
+ */
+typedef struct audio_duplex_s *audio_duplex_handle_t;
+
+/**
+ * @brief Open both codecs and start full-duplex engine
+ *
+ * @param config        Configuration
+ * @param ret_handle    Created engine
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if there is no memory for the engine
+ *      - ESP_FAIL              if a codec cannot be opened
+ */
+esp_err_t audio_duplex_create(const audio_duplex_config_t *config, audio_duplex_handle_t *ret_handle);
+
+/**
+ * @brief Stop the engine and close both codecs
+ *
+ * @param handle    Engine
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t audio_duplex_delete(audio_duplex_handle_t handle);
+
+/**
+ * @brief Get statistics of the engine
+ *
+ * @param handle    Engine
+ * @param stats     Output statistics
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t audio_duplex_get_stats(audio_duplex_handle_t handle, audio_duplex_stats_t *stats);
+
+/**
+ * @brief Measure latency of the audio path by loopback
+ *
+ * An engine with the given configuration plays a short impulse and finds it in the captured signal (any
+ * microphone channel). Loopback is needed: the echo reference channel of the board, or speaker sound picked
+ * up by a microphone. Callbacks of the configuration are not used.
+ *
+ * @note The codecs are opened for the time of the measurement, the engine must not run meanwhile
+ *
+ * @param config        Configuration of the engine to be measured
+ * @param timeout_ms    Maximum duration of the measurement
+ * @param result        Measured latency
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_TIMEOUT       if the impulse was not captured in time
+ *      - ESP_ERR_NO_MEM        if there is no memory for the engine
+ *      - ESP_FAIL              if a codec cannot be opened
+ */
+esp_err_t audio_duplex_measure_latency(const audio_duplex_config_t *config, uint32_t timeout_ms, audio_duplex_latency_t *result);
+
+#ifdef __cplusplus
+}
+#endif
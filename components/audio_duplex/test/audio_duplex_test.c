@@ -0,0 +1,37 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "unity.h"
+#include "audio_duplex.h"
+
+static void capture_cb(const int16_t *mic, const int16_t *ref, size_t samples, void *user_ctx)
+{
+}
+
+TEST_CASE("Audio duplex invalid arguments test", "[audio_duplex]")
+{
+    /* Codecs are not opened, when the configuration is invalid */
+    static int dummy_codec;
+    audio_duplex_handle_t duplex = NULL;
+
+    audio_duplex_config_t config = AUDIO_DUPLEX_CONFIG_DEFAULT(NULL, NULL);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_duplex_create(&config, &duplex));
+
+    config.spk = (esp_codec_dev_handle_t)&dummy_codec;
+    config.mic = (esp_codec_dev_handle_t)&dummy_codec;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_duplex_create(&config, &duplex));
+
+    config.capture_cb = capture_cb;
+    config.frame_samples = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_duplex_create(&config, &duplex));
+    TEST_ASSERT_NULL(duplex);
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_duplex_delete(NULL));
+
+    audio_duplex_latency_t latency;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_duplex_measure_latency(NULL, 1000, &latency));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_duplex_measure_latency(&config, 1000, &latency));
+}
@@ -0,0 +1,310 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/ringbuf.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "audio_mixer.h"
+
+static const char *TAG = "audio_mixer";
+
+/* Resampler position is fixed point Q16 */
+#define AUDIO_MIXER_POS_ONE     (1 << 16)
+/* Gain is fixed point Q14, products with 16-bit samples fit into 32 bits up to gain 2.0 */
+#define AUDIO_MIXER_GAIN_SHIFT  (14)
+#define AUDIO_MIXER_GAIN_MAX    (2.0f)
+
+struct audio_mixer_stream_s {
+    audio_mixer_handle_t mixer;
+    RingbufHandle_t ring;
+    size_t ring_size;
+    uint8_t channels;
+    uint32_t step;                          /* Input samples per one output sample (Q16) */
+    uint32_t pos;                           /* Position of output sample between prev and cur (Q16) */
+    int32_t prev[2];                        /* Last two input samples converted to output channels */
+    int32_t cur[2];
+    const int16_t *item;                    /* Data received from the ring buffer */
+    size_t item_len;                        /* Count of sample frames in the item */
+    size_t item_idx;
+    volatile int32_t gain;                  /* Q14 */
+};
+
+struct audio_mixer_s {
+    esp_codec_dev_handle_t codec;
+    uint32_t sample_rate;
+    uint8_t channels;
+    size_t frame_samples;
+    uint8_t max_streams;
+    audio_mixer_stream_handle_t *streams;
+    SemaphoreHandle_t lock;                 /* Protects the streams array */
+    SemaphoreHandle_t exited;
+    int32_t *acc;                           /* Mixing accumulator */
+    int16_t *out;                           /* Frame written to the codec */
+    volatile bool running;
+};
+
+/* Move to next input sample frame, the data are read from the ring buffer without copying */
+static bool audio_mixer_stream_next(audio_mixer_stream_handle_t stream)
+{
+    const uint8_t out_channels = stream->mixer->channels;
+
+    if (stream->item && stream->item_idx == stream->item_len) {
+        vRingbufferReturnItem(stream->ring, (void *)stream->item);
+        stream->item = NULL;
+    }
+    if (stream->item == NULL) {
+        size_t len = 0;
+        stream->item = xRingbufferReceiveUpTo(stream->ring, &len, 0, stream->ring_size);
+        if (stream->item == NULL) {
+            return false;
+        }
+        stream->item_len = len / (stream->channels * sizeof(int16_t));
+        stream->item_idx = 0;
+        if (stream->item_len == 0) {
+            vRingbufferReturnItem(stream->ring, (void *)stream->item);
+            stream->item = NULL;
+            return false;
+        }
+    }
+
+    const int16_t *in = &stream->item[stream->item_idx * stream->channels];
+    stream->item_idx++;
+    stream->prev[0] = stream->cur[0];
+    stream->prev[1] = stream->cur[1];
+    if (stream->channels == out_channels) {
+        stream->cur[0] = in[0];
+        stream->cur[1] = (out_channels == 2) ? in[1] : 0;
+    } else if (stream->channels == 1) {
+        /* Mono to stereo */
+        stream->cur[0] = in[0];
+        stream->cur[1] = in[0];
+    } else {
+        /* Stereo to mono */
+        stream->cur[0] = (in[0] + in[1]) / 2;
+    }
+    return true;
+}
+
+/* Linear interpolation to the output rate and accumulation with gain */
+static void audio_mixer_stream_mix(audio_mixer_stream_handle_t stream, int32_t *acc, size_t samples, uint8_t channels)
+{
+    const int32_t gain = stream->gain;
+
+    for (size_t i = 0; i < samples; i++) {
+        while (stream->pos >= AUDIO_MIXER_POS_ONE) {
+            if (!audio_mixer_stream_next(stream)) {
+                /* Stream is empty, the rest of the frame is silence */
+                return;
+            }
+            stream->pos -= AUDIO_MIXER_POS_ONE;
+        }
+        /* Q15 fraction keeps the product of 17-bit difference in 32 bits */
+        const int32_t frac = stream->pos >> 1;
+        for (int c = 0; c < channels; c++) {
+            const int32_t value = stream->prev[c] + (((stream->cur[c] - stream->prev[c]) * frac) >> 15);
+            acc[i * channels + c] += (value * gain) >> AUDIO_MIXER_GAIN_SHIFT;
+        }
+        stream->pos += stream->step;
+    }
+}
+
+static void audio_mixer_task(void *arg)
+{
+    audio_mixer_handle_t handle = (audio_mixer_handle_t)arg;
+    const size_t len = handle->frame_samples * handle->channels;
+
+    while (handle->running) {
+        memset(handle->acc, 0, len * sizeof(int32_t));
+        xSemaphoreTake(handle->lock, portMAX_DELAY);
+        for (int i = 0; i < handle->max_streams; i++) {
+            if (handle->streams[i]) {
+                audio_mixer_stream_mix(handle->streams[i], handle->acc, handle->frame_samples, handle->channels);
+            }
+        }
+        xSemaphoreGive(handle->lock);
+
+        /* Saturation instead of wrap around, when loud streams overlap */
+        for (size_t i = 0; i < len; i++) {
+            const int32_t value = handle->acc[i];
+            handle->out[i] = (value > INT16_MAX) ? INT16_MAX : ((value < INT16_MIN) ? INT16_MIN : value);
+        }
+        /* Blocks until DMA has free space, it paces the mixer */
+        esp_codec_dev_write(handle->codec, handle->out, len * sizeof(int16_t));
+    }
+
+    xSemaphoreGive(handle->exited);
+    vTaskDelete(NULL);
+}
+
+static void audio_mixer_free(audio_mixer_handle_t handle)
+{
+    if (handle->lock) {
+        vSemaphoreDelete(handle->lock);
+    }
+    if (handle->exited) {
+        vSemaphoreDelete(handle->exited);
+    }
+    free(handle->streams);
+    free(handle->acc);
+    free(handle->out);
+    free(handle);
+}
+
+esp_err_t audio_mixer_create(const audio_mixer_config_t *config, audio_mixer_handle_t *ret_handle)
+{
+    esp_err_t ret = ESP_OK;
+    BaseType_t res;
+    bool codec_open = false;
+    ESP_RETURN_ON_FALSE(config && ret_handle && config->codec, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->sample_rate > 0 && config->frame_samples > 0 && config->max_streams > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid configuration");
+    ESP_RETURN_ON_FALSE(config->channels == 1 || config->channels == 2, ESP_ERR_INVALID_ARG, TAG, "Only mono and stereo are supported");
+
+    audio_mixer_handle_t handle = calloc(1, sizeof(struct audio_mixer_s));
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_NO_MEM, TAG, "Not enough memory for mixer");
+    handle->codec = config->codec;
+    handle->sample_rate = config->sample_rate;
+    handle->channels = config->channels;
+    handle->frame_samples = config->frame_samples;
+    handle->max_streams = config->max_streams;
+
+    handle->streams = calloc(config->max_streams, sizeof(audio_mixer_stream_handle_t));
+    handle->acc = malloc(config->frame_samples * config->channels * sizeof(int32_t));
+    handle->out = malloc(config->frame_samples * config->channels * sizeof(int16_t));
+    handle->lock = xSemaphoreCreateMutex();
+    handle->exited = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(handle->streams && handle->acc && handle->out && handle->lock && handle->exited, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for buffers");
+
+    esp_codec_dev_sample_info_t fs = {
+        .sample_rate = config->sample_rate,
+        .channel = config->channels,
+        .bits_per_sample = 16,
+        .mclk_multiple = config->mclk_multiple,
+    };
+    ESP_GOTO_ON_FALSE(esp_codec_dev_open(config->codec, &fs) == ESP_CODEC_DEV_OK, ESP_FAIL, err, TAG, "Codec open failed");
+    codec_open = true;
+
+    handle->running = true;
+    if (config->task_affinity < 0) {
+        res = xTaskCreate(audio_mixer_task, "audio_mixer", config->task_stack, handle, config->task_priority, NULL);
+    } else {
+        res = xTaskCreatePinnedToCore(audio_mixer_task, "audio_mixer", config->task_stack, handle, config->task_priority, NULL, config->task_affinity);
+    }
+    ESP_GOTO_ON_FALSE(res == pdPASS, ESP_ERR_NO_MEM, err, TAG, "Create task failed");
+
+    *ret_handle = handle;
+    return ESP_OK;
+
+err:
+    if (codec_open) {
+        esp_codec_dev_close(config->codec);
+    }
+    audio_mixer_free(handle);
+    return ret;
+}
+
+esp_err_t audio_mixer_delete(audio_mixer_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    for (int i = 0; i < handle->max_streams; i++) {
+        ESP_RETURN_ON_FALSE(handle->streams[i] == NULL, ESP_ERR_INVALID_STATE, TAG, "Streams must be deleted first");
+    }
+
+    handle->running = false;
+    xSemaphoreTake(handle->exited, portMAX_DELAY);
+    esp_codec_dev_close(handle->codec);
+    audio_mixer_free(handle);
+    return ESP_OK;
+}
+
+esp_err_t audio_mixer_stream_create(audio_mixer_handle_t handle, const audio_mixer_stream_config_t *config, audio_mixer_stream_handle_t *ret_stream)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(handle && config && ret_stream, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->sample_rate > 0 && (config->channels == 1 || config->channels == 2), ESP_ERR_INVALID_ARG, TAG, "Invalid stream format");
+    /* Ring buffer wraps on sample frame boundary */
+    ESP_RETURN_ON_FALSE(config->ring_size > 0 && (config->ring_size % 4) == 0, ESP_ERR_INVALID_ARG, TAG, "Ring size must be multiple of 4");
+
+    audio_mixer_stream_handle_t stream = calloc(1, sizeof(struct audio_mixer_stream_s));
+    ESP_RETURN_ON_FALSE(stream, ESP_ERR_NO_MEM, TAG, "Not enough memory for stream");
+    stream->mixer = handle;
+    stream->ring_size = config->ring_size;
+    stream->channels = config->channels;
+    stream->step = ((uint64_t)config->sample_rate << 16) / handle->sample_rate;
+    /* First output sample loads the first input sample */
+    stream->pos = AUDIO_MIXER_POS_ONE;
+    ESP_GOTO_ON_ERROR(audio_mixer_stream_set_gain(stream, config->gain), err, TAG, "Invalid gain");
+    stream->ring = xRingbufferCreate(config->ring_size, RINGBUF_TYPE_BYTEBUF);
+    ESP_GOTO_ON_FALSE(stream->ring, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for ring buffer");
+
+    ret = ESP_ERR_NOT_FOUND;
+    xSemaphoreTake(handle->lock, portMAX_DELAY);
+    for (int i = 0; i < handle->max_streams; i++) {
+        if (handle->streams[i] == NULL) {
+            handle->streams[i] = stream;
+            ret = ESP_OK;
+            break;
+        }
+    }
+    xSemaphoreGive(handle->lock);
+    ESP_GOTO_ON_ERROR(ret, err, TAG, "Maximum count of streams reached");
+
+    *ret_stream = stream;
+    return ESP_OK;
+
+err:
+    if (stream->ring) {
+        vRingbufferDelete(stream->ring);
+    }
+    free(stream);
+    return ret;
+}
+
+esp_err_t audio_mixer_stream_delete(audio_mixer_stream_handle_t stream)
+{
+    ESP_RETURN_ON_FALSE(stream, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    audio_mixer_handle_t handle = stream->mixer;
+
+    /* Mixer task does not use the stream after the lock is released */
+    xSemaphoreTake(handle->lock, portMAX_DELAY);
+    for (int i = 0; i < handle->max_streams; i++) {
+        if (handle->streams[i] == stream) {
+            handle->streams[i] = NULL;
+        }
+    }
+    xSemaphoreGive(handle->lock);
+
+    if (stream->item) {
+        vRingbufferReturnItem(stream->ring, (void *)stream->item);
+    }
+    vRingbufferDelete(stream->ring);
+    free(stream);
+    return ESP_OK;
+}
+
+esp_err_t audio_mixer_stream_write(audio_mixer_stream_handle_t stream, const void *data, size_t len, TickType_t timeout)
+{
+    ESP_RETURN_ON_FALSE(stream && data, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE((len % (stream->channels * sizeof(int16_t))) == 0, ESP_ERR_INVALID_ARG, TAG, "Length must be multiple of sample frame");
+    ESP_RETURN_ON_FALSE(len <= stream->ring_size, ESP_ERR_INVALID_ARG, TAG, "Data are bigger than the ring buffer");
+
+    if (xRingbufferSend(stream->ring, data, len, timeout) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+esp_err_t audio_mixer_stream_set_gain(audio_mixer_stream_handle_t stream, float gain)
+{
+    ESP_RETURN_ON_FALSE(stream && gain >= 0.0f && gain <= AUDIO_MIXER_GAIN_MAX, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    stream->gain = (int32_t)(gain * (1 << AUDIO_MIXER_GAIN_SHIFT));
+    return ESP_OK;
+}
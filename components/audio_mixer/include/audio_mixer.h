@@ -0,0 +1,168 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Software mixer of playback streams
+ *
+ * Each stream has its own ring buffer, sample rate, channel count and gain. A mixer task converts
+ * all streams to the output format, mixes them with saturation and writes one stream to the codec.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_codec_dev.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Audio mixer configuration
+ */
+typedef struct {
+    esp_codec_dev_handle_t codec;       /*!< Speaker codec device (e.g. from `bsp_audio_codec_speaker_init`) */
+    uint32_t sample_rate;               /*!< Output sample rate [Hz] */
+    uint8_t channels;                   /*!< Output channels (1 or 2) */
+    size_t frame_samples;               /*!< Count of samples of each channel written to the codec at once */
+    int mclk_multiple;                  /*!< MCLK multiple of the sample rate used in codec open (0: codec default) */
+    uint8_t max_streams;                /*!< Maximum count of streams */
+    int task_priority;                  /*!< Priority of the mixer task */
+    int task_stack;                     /*!< Stack size of the mixer task [bytes] */
+    int task_affinity;                  /*!< Core of the task (-1 for no affinity) */
+} audio_mixer_config_t;
+
+/**
+ * @brief Default audio mixer configuration (10 ms frames)
+ */
+#define AUDIO_MIXER_CONFIG_DEFAULT(codec_dev)   \
+    {                                           \
+        .codec = (codec_dev),                   \
+        .sample_rate = 22050,                   \
+        .channels = 1,                          \
+        .frame_samples = 220,                   \
+        .mclk_multiple = 0,                     \
+        .max_streams = 4,                       \
+        .task_priority = 6,                     \
+        .task_stack = 4096,                     \
+        .task_affinity = -1,                    \
+    }
+
+/**
+ * @brief Stream configuration
+ */
+typedef struct {
+    uint32_t sample_rate;               /*!< Sample rate of the written data [Hz] */
+    uint8_t channels;                   /*!< Channels of the written data (1 or 2), 16-bit samples */
+    size_t ring_size;                   /*!< Size of the stream ring buffer [bytes] */
+    float gain;                         /*!< Gain of the stream (0.0 - 1.0 is attenuation, up to 2.0) */
+} audio_mixer_stream_config_t;
+
+/**
+ * @brief Default stream configuration
+ */
+#define AUDIO_MIXER_STREAM_CONFIG_DEFAULT(rate, ch) \
+    {                                               \
+        .sample_rate = (rate),                      \
+        .channels = (ch),                           \
+        .ring_size = 8 * 1024,                      \
+        .gain = 1.0,                                \
+    }
+
+/**
+ * @brief Audio mixer handle
+ */
+typedef struct audio_mixer_s *audio_mixer_handle_t;
+
+/**
+ * @brief Audio mixer stream handle
+ */
+typedef struct audio_mixer_stream_s *audio_mixer_stream_handle_t;
+
+/**
+ * @brief Open the codec and start mixer
+ *
+ * @note Silence is written, when no stream has data, so new sounds start without opening the codec
+ *
+ * @param config        Configuration
+ * @param ret_handle    Created mixer
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if there is no memory for the mixer
+ *      - ESP_FAIL              if the codec cannot be opened
+ */
+esp_err_t audio_mixer_create(const audio_mixer_config_t *config, audio_mixer_handle_t *ret_handle);
+
+/**
+ * @brief Stop mixer and close the codec
+ *
+ * @note All streams must be deleted before
+ *
+ * @param handle    Mixer
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_INVALID_STATE if a stream exists
+ */
+esp_err_t audio_mixer_delete(audio_mixer_handle_t handle);
+
+/**
+ * @brief Create playback stream
+ *
+ * @param handle        Mixer
+ * @param config        Stream configuration
+ * @param ret_stream    Created stream
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NOT_FOUND     if maximum count of streams is reached
+ *      - ESP_ERR_NO_MEM        if there is no memory for the stream
+ */
+esp_err_t audio_mixer_stream_create(audio_mixer_handle_t handle, const audio_mixer_stream_config_t *config, audio_mixer_stream_handle_t *ret_stream);
+
+/**
+ * @brief Delete playback stream, its buffered data are discarded
+ *
+ * @param stream    Stream
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t audio_mixer_stream_delete(audio_mixer_stream_handle_t stream);
+
+/**
+ * @brief Write PCM data to stream
+ *
+ * @param stream    Stream
+ * @param data      Interleaved 16-bit samples
+ * @param len       Length of data in bytes (multiple of the sample frame: 2 bytes per channel)
+ * @param timeout   Time to wait for free space in the ring buffer
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_TIMEOUT       if there was not enough space in time
+ */
+esp_err_t audio_mixer_stream_write(audio_mixer_stream_handle_t stream, const void *data, size_t len, TickType_t timeout);
+
+/**
+ * @brief Set gain of stream
+ *
+ * @param stream    Stream
+ * @param gain      Gain (0.0 - 2.0)
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t audio_mixer_stream_set_gain(audio_mixer_stream_handle_t stream, float gain);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,30 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "unity.h"
+#include "audio_mixer.h"
+
+TEST_CASE("Audio mixer invalid arguments test", "[audio_mixer]")
+{
+    /* Codec is not opened, when the configuration is invalid */
+    static int dummy_codec;
+    audio_mixer_handle_t mixer = NULL;
+
+    audio_mixer_config_t config = AUDIO_MIXER_CONFIG_DEFAULT(NULL);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_mixer_create(&config, &mixer));
+
+    config.codec = (esp_codec_dev_handle_t)&dummy_codec;
+    config.channels = 4;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_mixer_create(&config, &mixer));
+
+    config.channels = 2;
+    config.max_streams = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_mixer_create(&config, &mixer));
+    TEST_ASSERT_NULL(mixer);
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_mixer_delete(NULL));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_mixer_stream_set_gain(NULL, 1.0));
+}
@@ -0,0 +1,313 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_dsp.h"
+#include "audio_spectrum.h"
+
+static const char *TAG = "audio_spectrum";
+
+/* Published levels are copied again by the reader, when the worker published twice during one copy */
+#define AUDIO_SPECTRUM_READ_TRIES   (3)
+/* Shortest wait of the worker for new samples, the levels decay when no samples come [ms] */
+#define AUDIO_SPECTRUM_IDLE_MS      (20)
+
+struct audio_spectrum_s {
+    audio_spectrum_config_t config;
+    int16_t *ring;                          /* Mono samples, written by the producer only */
+    uint32_t ring_mask;
+    atomic_uint head;                       /* Samples written by the producer (free running) */
+    atomic_uint tail;                       /* Oldest sample still needed by the worker (free running) */
+    uint32_t notified;                      /* Producer: head at the last wake up of the worker */
+    atomic_uint sample_rate;                /* Rate of the fed samples [Hz] */
+    atomic_uint dropped;                    /* Samples dropped by the producer */
+    uint32_t pos;                           /* Worker: end of the next analysed window */
+    uint32_t band_rate;                     /* Worker: sample rate of the band table */
+    uint16_t band_bins[AUDIO_SPECTRUM_BANDS_MAX + 1]; /* First FFT bin of each band, the last entry ends the last band */
+    float *window;                          /* Hann window */
+    float *fft;                             /* Complex FFT buffer (2 * fft_size) */
+    float current[AUDIO_SPECTRUM_BANDS_MAX]; /* Worker: levels after decay */
+    float levels[2][AUDIO_SPECTRUM_BANDS_MAX]; /* Published levels, the reader copies the buffer of the sequence number */
+    atomic_uint seq;                        /* Sequence number of the published levels */
+    uint64_t fft_time_sum;
+    audio_spectrum_stats_t stats;
+    portMUX_TYPE stats_lock;
+    TaskHandle_t task;
+    SemaphoreHandle_t exited;
+    volatile bool running;
+};
+
+static void audio_spectrum_bands_update(audio_spectrum_handle_t handle, uint32_t sample_rate)
+{
+    const audio_spectrum_config_t *cfg = &handle->config;
+    const uint32_t half = cfg->fft_size / 2;
+    const float bin_hz = (float)sample_rate / cfg->fft_size;
+    float max_freq = sample_rate / 2.0f;
+    if (cfg->max_freq > 0 && cfg->max_freq < max_freq) {
+        max_freq = cfg->max_freq;
+    }
+    const float min_freq = MIN((float)MAX(cfg->min_freq, 1), max_freq / 2);
+    const float ratio = max_freq / min_freq;
+
+    /* Logarithmic edges, each band has at least one bin (low bands are wider than their edges at small FFT) */
+    for (int i = 0; i <= cfg->bands; i++) {
+        const float edge = min_freq * powf(ratio, (float)i / cfg->bands);
+        uint32_t bin = (uint32_t)lroundf(edge / bin_hz);
+        if (i > 0) {
+            bin = MAX(bin, handle->band_bins[i - 1] + 1U);
+        }
+        handle->band_bins[i] = MIN(MAX(bin, 1U), half);
+    }
+    handle->band_rate = sample_rate;
+    ESP_LOGD(TAG, "%d bands %.0f - %.0f Hz, %.1f Hz per bin", cfg->bands, min_freq, max_freq, bin_hz);
+}
+
+static void audio_spectrum_publish(audio_spectrum_handle_t handle)
+{
+    /* Buffer of the previous sequence number is overwritten, the reader of the current one is not disturbed */
+    const uint32_t next = atomic_load_explicit(&handle->seq, memory_order_relaxed) + 1;
+    atomic_thread_fence(memory_order_release);
+    memcpy(handle->levels[next & 1], handle->current, handle->config.bands * sizeof(float));
+    atomic_store_explicit(&handle->seq, next, memory_order_release);
+}
+
+static void audio_spectrum_analyse(audio_spectrum_handle_t handle, float decay)
+{
+    const audio_spectrum_config_t *cfg = &handle->config;
+    const uint32_t n = cfg->fft_size;
+
+    /* Window of fft_size samples ending at pos, the ring keeps them until the tail moves */
+    const uint32_t start = handle->pos - n;
+    for (uint32_t i = 0; i < n; i++) {
+        handle->fft[2 * i] = handle->ring[(start + i) & handle->ring_mask] * handle->window[i];
+        handle->fft[2 * i + 1] = 0.0f;
+    }
+    atomic_store_explicit(&handle->tail, handle->pos + cfg->hop - n, memory_order_release);
+
+    dsps_fft2r_fc32(handle->fft, n);
+    dsps_bit_rev_fc32(handle->fft, n);
+
+    /* Full scale sine with Hann window has amplitude n / 4 in its bin (samples are not normalized) */
+    const float full_scale = 32768.0f * n / 4;
+    const float ref = full_scale * full_scale;
+    const float range = -cfg->floor_db;
+    for (int b = 0; b < cfg->bands; b++) {
+        float power = 0.0f;
+        for (uint32_t k = handle->band_bins[b]; k < MAX(handle->band_bins[b + 1], handle->band_bins[b] + 1U) && k < n / 2; k++) {
+            const float re = handle->fft[2 * k];
+            const float im = handle->fft[2 * k + 1];
+            power = MAX(power, re * re + im * im);
+        }
+        const float db = 10.0f * log10f(power / ref + 1e-12f);
+        const float level = MIN(MAX((db - cfg->floor_db) / range, 0.0f), 1.0f);
+        handle->current[b] = MAX(level, handle->current[b] - decay);
+    }
+}
+
+static bool audio_spectrum_decay(audio_spectrum_handle_t handle, float decay)
+{
+    bool changed = false;
+    for (int b = 0; b < handle->config.bands; b++) {
+        if (handle->current[b] > 0.0f) {
+            handle->current[b] = MAX(handle->current[b] - decay, 0.0f);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+static void audio_spectrum_task(void *arg)
+{
+    audio_spectrum_handle_t handle = (audio_spectrum_handle_t)arg;
+    const audio_spectrum_config_t *cfg = &handle->config;
+    int64_t last = esp_timer_get_time();
+
+    while (handle->running) {
+        const uint32_t rate = atomic_load_explicit(&handle->sample_rate, memory_order_relaxed);
+        /* The producer wakes the worker after each hop, the timeout only lets the levels fall in silence */
+        const uint32_t hop_ms = rate ? (uint32_t)cfg->hop * 1000 / rate : 0;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MAX(2 * hop_ms, AUDIO_SPECTRUM_IDLE_MS)));
+        if (!handle->running) {
+            break;
+        }
+
+        const int64_t now = esp_timer_get_time();
+        const float decay = cfg->decay * (now - last) / 1000000.0f;
+        last = now;
+
+        const uint32_t head = atomic_load_explicit(&handle->head, memory_order_acquire);
+        const uint32_t hops = (head - handle->pos) / cfg->hop;
+        if (hops == 0 || rate == 0) {
+            if (audio_spectrum_decay(handle, decay)) {
+                audio_spectrum_publish(handle);
+            }
+            continue;
+        }
+
+        /* Only the latest window is analysed, the GUI shows one spectrum per frame anyway */
+        handle->pos += hops * cfg->hop;
+        if (rate != handle->band_rate) {
+            audio_spectrum_bands_update(handle, rate);
+        }
+        audio_spectrum_analyse(handle, decay);
+        audio_spectrum_publish(handle);
+
+        const uint32_t fft_time = esp_timer_get_time() - now;
+        portENTER_CRITICAL(&handle->stats_lock);
+        handle->stats.spectra++;
+        handle->stats.skipped_hops += hops - 1;
+        handle->stats.fft_time_max = MAX(handle->stats.fft_time_max, fft_time);
+        handle->fft_time_sum += fft_time;
+        portEXIT_CRITICAL(&handle->stats_lock);
+    }
+
+    xSemaphoreGive(handle->exited);
+    vTaskDelete(NULL);
+}
+
+static void audio_spectrum_free(audio_spectrum_handle_t handle)
+{
+    if (handle->exited) {
+        vSemaphoreDelete(handle->exited);
+    }
+    free(handle->ring);
+    heap_caps_free(handle->window);
+    heap_caps_free(handle->fft);
+    free(handle);
+}
+
+esp_err_t audio_spectrum_create(const audio_spectrum_config_t *config, audio_spectrum_handle_t *ret_handle)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(config && ret_handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->fft_size >= 64 && config->fft_size <= CONFIG_DSP_MAX_FFT_SIZE && (config->fft_size & (config->fft_size - 1)) == 0,
+                        ESP_ERR_INVALID_ARG, TAG, "FFT size must be power of two between 64 and %d", CONFIG_DSP_MAX_FFT_SIZE);
+    ESP_RETURN_ON_FALSE(config->hop > 0 && config->hop <= config->fft_size, ESP_ERR_INVALID_ARG, TAG, "Hop must be 1 - FFT size");
+    ESP_RETURN_ON_FALSE(config->bands > 0 && config->bands <= AUDIO_SPECTRUM_BANDS_MAX && config->bands <= config->fft_size / 4,
+                        ESP_ERR_INVALID_ARG, TAG, "Bands must be 1 - %d and at most FFT size / 4", AUDIO_SPECTRUM_BANDS_MAX);
+    ESP_RETURN_ON_FALSE(config->floor_db < 0.0f && config->decay >= 0.0f, ESP_ERR_INVALID_ARG, TAG, "Floor must be negative and decay positive");
+    ESP_RETURN_ON_FALSE(config->ring_samples >= 2U * config->fft_size && (config->ring_samples & (config->ring_samples - 1)) == 0,
+                        ESP_ERR_INVALID_ARG, TAG, "Ring buffer must be power of two and hold two FFTs");
+
+    /* FFT tables are shared by all esp-dsp users, repeated initialization is accepted by esp-dsp */
+    ESP_RETURN_ON_ERROR(dsps_fft2r_init_fc32(NULL, CONFIG_DSP_MAX_FFT_SIZE), TAG, "FFT init failed");
+
+    audio_spectrum_handle_t handle = calloc(1, sizeof(struct audio_spectrum_s));
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_NO_MEM, TAG, "Not enough memory for spectrum");
+    handle->config = *config;
+    handle->stats_lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
+    handle->ring_mask = config->ring_samples - 1;
+    /* The first window is filled by silence, so the first spectrum comes after one hop */
+    handle->pos = config->fft_size;
+    atomic_init(&handle->head, config->fft_size);
+    atomic_init(&handle->tail, 0);
+    handle->notified = config->fft_size;
+
+    /* The worker reads the ring and the FFT buffer at every hop, they stay in internal RAM */
+    handle->ring = calloc(config->ring_samples, sizeof(int16_t));
+    handle->window = heap_caps_aligned_calloc(16, config->fft_size, sizeof(float), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    handle->fft = heap_caps_aligned_calloc(16, 2 * config->fft_size, sizeof(float), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    handle->exited = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(handle->ring && handle->window && handle->fft && handle->exited, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for spectrum");
+    dsps_wind_hann_f32(handle->window, config->fft_size);
+
+    handle->running = true;
+    const BaseType_t core = (config->task_affinity < 0) ? tskNO_AFFINITY : config->task_affinity;
+    ESP_GOTO_ON_FALSE(xTaskCreatePinnedToCore(audio_spectrum_task, "spectrum", config->task_stack, handle, config->task_priority,
+                      &handle->task, core) == pdPASS, ESP_ERR_NO_MEM, err, TAG, "Worker task creation failed");
+
+    *ret_handle = handle;
+    return ESP_OK;
+
+err:
+    audio_spectrum_free(handle);
+    return ret;
+}
+
+esp_err_t audio_spectrum_delete(audio_spectrum_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    handle->running = false;
+    xTaskNotifyGive(handle->task);
+    xSemaphoreTake(handle->exited, portMAX_DELAY);
+    audio_spectrum_free(handle);
+    return ESP_OK;
+}
+
+esp_err_t audio_spectrum_feed(audio_spectrum_handle_t handle, const int16_t *pcm, size_t frames, uint8_t channels, uint32_t sample_rate)
+{
+    ESP_RETURN_ON_FALSE(handle && (pcm || frames == 0) && channels > 0 && sample_rate > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    atomic_store_explicit(&handle->sample_rate, sample_rate, memory_order_relaxed);
+    const uint32_t head = atomic_load_explicit(&handle->head, memory_order_relaxed);
+    const uint32_t tail = atomic_load_explicit(&handle->tail, memory_order_acquire);
+    const uint32_t space = handle->config.ring_samples - (head - tail);
+    const uint32_t count = MIN(frames, space);
+
+    for (uint32_t i = 0; i < count; i++) {
+        int32_t sum = 0;
+        for (int c = 0; c < channels; c++) {
+            sum += pcm[i * channels + c];
+        }
+        handle->ring[(head + i) & handle->ring_mask] = sum / channels;
+    }
+    atomic_store_explicit(&handle->head, head + count, memory_order_release);
+
+    /* The worker is woken once per hop, not on every call */
+    if (head + count - handle->notified >= handle->config.hop) {
+        handle->notified = head + count;
+        xTaskNotifyGive(handle->task);
+    }
+    if (count < frames) {
+        atomic_fetch_add_explicit(&handle->dropped, frames - count, memory_order_relaxed);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+uint32_t audio_spectrum_get(audio_spectrum_handle_t handle, float *levels, size_t count)
+{
+    if (handle == NULL || levels == NULL) {
+        return 0;
+    }
+
+    count = MIN(count, handle->config.bands);
+    uint32_t seq = 0;
+    for (int i = 0; i < AUDIO_SPECTRUM_READ_TRIES; i++) {
+        seq = atomic_load_explicit(&handle->seq, memory_order_acquire);
+        memcpy(levels, handle->levels[seq & 1], count * sizeof(float));
+        atomic_thread_fence(memory_order_acquire);
+        /* The copied buffer is rewritten only after two newer spectra */
+        if (atomic_load_explicit(&handle->seq, memory_order_relaxed) - seq < 2) {
+            break;
+        }
+    }
+    return seq;
+}
+
+esp_err_t audio_spectrum_get_stats(audio_spectrum_handle_t handle, audio_spectrum_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(handle && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    portENTER_CRITICAL(&handle->stats_lock);
+    *stats = handle->stats;
+    stats->fft_time_avg = handle->stats.spectra ? (uint32_t)(handle->fft_time_sum / handle->stats.spectra) : 0;
+    portEXIT_CRITICAL(&handle->stats_lock);
+    stats->dropped_samples = atomic_load_explicit(&handle->dropped, memory_order_relaxed);
+    return ESP_OK;
+}
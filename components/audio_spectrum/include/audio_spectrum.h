@@ -0,0 +1,152 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Audio spectrum analyzer for visualizers
+ *
+ * The audio stream (playback or capture) is tapped into a lock-free ring buffer, the producer never waits.
+ * A worker task runs the esp-dsp FFT at a fixed hop and publishes the latest band levels. The GUI reads
+ * them once per frame, so the audio, the FFT and the rendering run at their own rates.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maximum count of bands
+ */
+#define AUDIO_SPECTRUM_BANDS_MAX    (64)
+
+/**
+ * @brief Audio spectrum configuration
+ */
+typedef struct {
+    uint16_t fft_size;                  /*!< Samples of one FFT, power of two (max CONFIG_DSP_MAX_FFT_SIZE) */
+    uint16_t hop;                       /*!< Samples between two FFTs (fft_size / 2 is 50 % overlap) */
+    uint8_t bands;                      /*!< Count of logarithmically spaced bands (max AUDIO_SPECTRUM_BANDS_MAX) */
+    uint16_t min_freq;                  /*!< Lower edge of the first band [Hz] */
+    uint16_t max_freq;                  /*!< Upper edge of the last band [Hz] (0: half of the sample rate) */
+    float floor_db;                     /*!< Level of the empty band [dBFS], 0 dBFS is the full band */
+    float decay;                        /*!< Fall of the band levels [full scale per second], the rise is immediate */
+    size_t ring_samples;                /*!< Size of the ring buffer, power of two and at least 2 * fft_size [samples] */
+    int task_priority;                  /*!< Priority of the worker task (lower than audio tasks) */
+    int task_stack;                     /*!< Stack size of the worker task [bytes] */
+    int task_affinity;                  /*!< Core of the worker task (-1 for no affinity) */
+} audio_spectrum_config_t;
+
+/**
+ * @brief Default audio spectrum configuration (512 samples FFT, 50 % overlap, 16 bands)
+ */
+#define AUDIO_SPECTRUM_CONFIG_DEFAULT()         \
+    {                                           \
+        .fft_size = 512,                        \
+        .hop = 256,                             \
+        .bands = 16,                            \
+        .min_freq = 60,                         \
+        .max_freq = 0,                          \
+        .floor_db = -60.0f,                     \
+        .decay = 2.0f,                          \
+        .ring_samples = 2048,                   \
+        .task_priority = 3,                     \
+        .task_stack = 3072,                     \
+        .task_affinity = -1,                    \
+    }
+
+/**
+ * @brief Audio spectrum statistics
+ */
+typedef struct {
+    uint32_t spectra;                   /*!< Count of published spectra */
+    uint32_t skipped_hops;              /*!< Hops not analyzed, because the worker was behind (only the latest is analyzed) */
+    uint32_t dropped_samples;           /*!< Samples not stored, because the ring buffer was full */
+    uint32_t fft_time_max;              /*!< Longest analysis of one hop (window, FFT, bands) [us] */
+    uint32_t fft_time_avg;              /*!< Average analysis of one hop [us] */
+} audio_spectrum_stats_t;
+
+/**
+ * @brief Audio spectrum handle
+ */
+typedef struct audio_spectrum_s *audio_spectrum_handle_t;
+
+/**
+ * @brief Create audio spectrum analyzer and its worker task
+ *
+ * @param config        Configuration
+ * @param ret_handle    Created analyzer
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if there is no memory for the analyzer
+ *      - Others                if the esp-dsp FFT cannot be initialized
+ */
+esp_err_t audio_spectrum_create(const audio_spectrum_config_t *config, audio_spectrum_handle_t *ret_handle);
+
+/**
+ * @brief Delete audio spectrum analyzer
+ *
+ * @note The producer must not feed the analyzer anymore
+ *
+ * @param handle    Analyzer
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t audio_spectrum_delete(audio_spectrum_handle_t handle);
+
+/**
+ * @brief Feed audio samples into the analyzer
+ *
+ * The channels are mixed into mono and copied into the ring buffer. The function never waits: samples which
+ * do not fit are dropped. It can be called from the audio task (e.g. tap callback of the WAV player) or from
+ * the capture task. Only one producer is supported.
+ *
+ * @param handle        Analyzer
+ * @param pcm           Interleaved 16-bit samples
+ * @param frames        Count of frames (samples per channel)
+ * @param channels      Count of channels
+ * @param sample_rate   Sample rate [Hz], the bands are recalculated when it changes
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if some samples were dropped
+ */
+esp_err_t audio_spectrum_feed(audio_spectrum_handle_t handle, const int16_t *pcm, size_t frames, uint8_t channels, uint32_t sample_rate);
+
+/**
+ * @brief Get the latest band levels
+ *
+ * Intended to be called once per GUI frame (e.g. from a LVGL timer). It does not wait for the worker
+ * and it does not lock it.
+ *
+ * @param handle    Analyzer
+ * @param levels    Output levels 0.0 - 1.0 (floor_db - 0 dBFS), lowest band first
+ * @param count     Size of `levels`, at most `bands` levels are written
+ * @return Sequence number of the spectrum, the GUI does not need to redraw, when it did not change (0 before the first spectrum)
+ */
+uint32_t audio_spectrum_get(audio_spectrum_handle_t handle, float *levels, size_t count);
+
+/**
+ * @brief Get statistics of the analyzer
+ *
+ * @param handle    Analyzer
+ * @param stats     Output statistics
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t audio_spectrum_get_stats(audio_spectrum_handle_t handle, audio_spectrum_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
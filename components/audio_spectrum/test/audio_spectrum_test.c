@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "unity.h"
+#include "audio_spectrum.h"
+
+#define TEST_SAMPLE_RATE    (22050)
+#define TEST_FRAMES         (256)
+
+TEST_CASE("Audio spectrum invalid arguments test", "[audio_spectrum]")
+{
+    audio_spectrum_handle_t spectrum = NULL;
+    audio_spectrum_config_t config = AUDIO_SPECTRUM_CONFIG_DEFAULT();
+
+    config.fft_size = 500;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_spectrum_create(&config, &spectrum));
+    config.fft_size = 512;
+    config.hop = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_spectrum_create(&config, &spectrum));
+    config.hop = 256;
+    config.bands = AUDIO_SPECTRUM_BANDS_MAX + 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_spectrum_create(&config, &spectrum));
+    config.bands = 16;
+    config.ring_samples = 1000;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_spectrum_create(&config, &spectrum));
+    TEST_ASSERT_NULL(spectrum);
+
+    float levels[16];
+    audio_spectrum_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_spectrum_delete(NULL));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_spectrum_feed(NULL, NULL, 0, 1, TEST_SAMPLE_RATE));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_spectrum_get_stats(NULL, &stats));
+    TEST_ASSERT_EQUAL(0, audio_spectrum_get(NULL, levels, 16));
+}
+
+TEST_CASE("Audio spectrum sine test", "[audio_spectrum]")
+{
+    audio_spectrum_handle_t spectrum;
+    const audio_spectrum_config_t config = AUDIO_SPECTRUM_CONFIG_DEFAULT();
+    TEST_ASSERT_EQUAL(ESP_OK, audio_spectrum_create(&config, &spectrum));
+
+    /* 1 kHz sine at -6 dBFS, stereo */
+    static int16_t pcm[TEST_FRAMES * 2];
+    float phase = 0.0f;
+    for (int block = 0; block < 20; block++) {
+        for (int i = 0; i < TEST_FRAMES; i++) {
+            pcm[2 * i] = pcm[2 * i + 1] = (int16_t)(16384 * sinf(phase));
+            phase = fmodf(phase + 2 * M_PI * 1000 / TEST_SAMPLE_RATE, 2 * M_PI);
+        }
+        TEST_ASSERT_EQUAL(ESP_OK, audio_spectrum_feed(spectrum, pcm, TEST_FRAMES, 2, TEST_SAMPLE_RATE));
+        vTaskDelay(pdMS_TO_TICKS(TEST_FRAMES * 1000 / TEST_SAMPLE_RATE + 1));
+    }
+
+    float levels[16];
+    TEST_ASSERT_NOT_EQUAL(0, audio_spectrum_get(spectrum, levels, 16));
+    int peak = 0;
+    for (int i = 1; i < 16; i++) {
+        if (levels[i] > levels[peak]) {
+            peak = i;
+        }
+    }
+    /* 1 kHz is in the 9th band of 16 bands 60 Hz - 11 kHz, -6 dBFS is 0.9 of 60 dB range */
+    TEST_ASSERT_EQUAL(8, peak);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.9f, levels[peak]);
+
+    audio_spectrum_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_spectrum_get_stats(spectrum, &stats));
+    TEST_ASSERT_EQUAL(0, stats.dropped_samples);
+    TEST_ASSERT_GREATER_THAN(0, stats.spectra);
+    TEST_ASSERT_EQUAL(ESP_OK, audio_spectrum_delete(spectrum));
+}
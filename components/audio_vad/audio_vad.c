@@ -0,0 +1,239 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "audio_vad.h"
+
+static const char *TAG = "audio_vad";
+
+/* Noise floor follows lower energy fast and higher energy slowly (speech does not raise it) */
+#define AUDIO_VAD_NOISE_DOWN_SHIFT  (2)
+#define AUDIO_VAD_NOISE_UP_SHIFT    (6)
+
+struct audio_vad_s {
+    audio_vad_config_t config;
+    int16_t *slots;                         /* (preroll_frames + 1) captured frames */
+    size_t frame_len;                       /* Count of samples of one frame (all channels) */
+    uint32_t cur;                           /* Slot of the frame being captured */
+    uint32_t history;                       /* Count of silent frames kept for preroll */
+    uint32_t ratio;                         /* Speech to noise energy ratio (Q8) */
+    uint32_t min_energy;
+    uint32_t noise;                         /* Noise floor energy */
+    uint32_t trigger_cnt;
+    uint32_t hangover_cnt;
+    SemaphoreHandle_t exited;
+    audio_vad_stats_t stats;
+    volatile bool speech;
+    volatile bool running;
+};
+
+/* Mean energy of the decimated channel, the decimation filter is a moving average */
+static uint32_t audio_vad_energy(audio_vad_handle_t handle, const int16_t *frame)
+{
+    const audio_vad_config_t *cfg = &handle->config;
+    const size_t out_samples = cfg->frame_samples / cfg->decimation;
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < out_samples; i++) {
+        const int16_t *in = &frame[i * cfg->decimation * cfg->channels + cfg->vad_channel];
+        int32_t acc = 0;
+        for (int k = 0; k < cfg->decimation; k++) {
+            acc += in[k * cfg->channels];
+        }
+        acc /= cfg->decimation;
+        sum += acc * acc;
+    }
+    return sum / out_samples;
+}
+
+/* Returns true, if the frame is detected as speech */
+static bool audio_vad_detect(audio_vad_handle_t handle, const int16_t *frame)
+{
+    const uint32_t energy = audio_vad_energy(handle, frame);
+    if (handle->stats.frames == 0) {
+        /* Capture starts in silence */
+        handle->noise = energy;
+        return false;
+    }
+
+    const bool active = energy >= handle->min_energy && (uint64_t)energy * 256 > (uint64_t)handle->noise * handle->ratio;
+    if (!active && !handle->speech) {
+        if (energy < handle->noise) {
+            handle->noise -= (handle->noise - energy) >> AUDIO_VAD_NOISE_DOWN_SHIFT;
+        } else {
+            handle->noise += (energy - handle->noise) >> AUDIO_VAD_NOISE_UP_SHIFT;
+        }
+    }
+    return active;
+}
+
+static void audio_vad_deliver(audio_vad_handle_t handle, const int16_t *frame)
+{
+    const audio_vad_config_t *cfg = &handle->config;
+    const int64_t start = esp_timer_get_time();
+    cfg->frame_cb(frame, cfg->frame_samples, cfg->user_ctx);
+    const uint32_t cb_time = esp_timer_get_time() - start;
+    handle->stats.cb_time_max = MAX(handle->stats.cb_time_max, cb_time);
+    handle->stats.speech_frames++;
+}
+
+static void audio_vad_task(void *arg)
+{
+    audio_vad_handle_t handle = (audio_vad_handle_t)arg;
+    const audio_vad_config_t *cfg = &handle->config;
+    const uint32_t slots = cfg->preroll_frames + 1;
+
+    while (handle->running) {
+        int16_t *frame = &handle->slots[handle->cur * handle->frame_len];
+        if (esp_codec_dev_read(cfg->mic, frame, handle->frame_len * sizeof(int16_t)) != ESP_CODEC_DEV_OK) {
+            ESP_LOGE(TAG, "Codec read failed");
+            break;
+        }
+
+        const int64_t start = esp_timer_get_time();
+        const bool active = audio_vad_detect(handle, frame);
+        const uint32_t vad_time = esp_timer_get_time() - start;
+        handle->stats.vad_time_max = MAX(handle->stats.vad_time_max, vad_time);
+        handle->stats.frames++;
+
+        if (!handle->speech) {
+            handle->trigger_cnt = active ? handle->trigger_cnt + 1 : 0;
+            if (handle->trigger_cnt >= cfg->trigger_frames) {
+                handle->speech = true;
+                handle->hangover_cnt = 0;
+                handle->stats.wake_cnt++;
+                if (cfg->state_cb) {
+                    cfg->state_cb(true, cfg->user_ctx);
+                }
+                /* Kept frames are delivered first, oldest one is the first */
+                for (uint32_t k = handle->history; k > 0; k--) {
+                    audio_vad_deliver(handle, &handle->slots[((handle->cur + slots - k) % slots) * handle->frame_len]);
+                }
+                handle->history = 0;
+            }
+        } else {
+            handle->hangover_cnt = active ? 0 : handle->hangover_cnt + 1;
+            if (handle->hangover_cnt >= cfg->hangover_frames) {
+                handle->speech = false;
+                handle->trigger_cnt = 0;
+                if (cfg->state_cb) {
+                    cfg->state_cb(false, cfg->user_ctx);
+                }
+            }
+        }
+
+        if (handle->speech || handle->hangover_cnt > 0) {
+            /* Hangover frame which ended the speech is delivered too */
+            audio_vad_deliver(handle, frame);
+            if (!handle->speech) {
+                handle->hangover_cnt = 0;
+            }
+        } else if (cfg->preroll_frames > 0) {
+            /* The frame stays in its slot for preroll, the next frame is captured into the oldest slot */
+            handle->history = MIN(handle->history + 1, cfg->preroll_frames);
+            handle->cur = (handle->cur + 1) % slots;
+        }
+    }
+
+    xSemaphoreGive(handle->exited);
+    vTaskDelete(NULL);
+}
+
+static void audio_vad_free(audio_vad_handle_t handle)
+{
+    if (handle->exited) {
+        vSemaphoreDelete(handle->exited);
+    }
+    free(handle->slots);
+    free(handle);
+}
+
+esp_err_t audio_vad_create(const audio_vad_config_t *config, audio_vad_handle_t *ret_handle)
+{
+    esp_err_t ret = ESP_OK;
+    BaseType_t res;
+    bool mic_open = false;
+    ESP_RETURN_ON_FALSE(config && ret_handle && config->mic && config->frame_cb, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->sample_rate > 0 && config->channels > 0 && config->vad_channel < config->channels, ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid audio format");
+    ESP_RETURN_ON_FALSE(config->decimation > 0 && config->frame_samples >= config->decimation, ESP_ERR_INVALID_ARG, TAG,
+                        "Frame is shorter than decimation");
+
+    audio_vad_handle_t handle = calloc(1, sizeof(struct audio_vad_s));
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_NO_MEM, TAG, "Not enough memory for VAD");
+    handle->config = *config;
+    handle->config.trigger_frames = MAX(config->trigger_frames, 1);
+    handle->config.hangover_frames = MAX(config->hangover_frames, 1);
+    handle->frame_len = config->frame_samples * config->channels;
+    handle->ratio = lrintf(256.0f * powf(10.0f, config->threshold_db / 10.0f));
+    handle->min_energy = (uint32_t)config->min_level * config->min_level;
+
+    handle->slots = malloc((config->preroll_frames + 1) * handle->frame_len * sizeof(int16_t));
+    handle->exited = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(handle->slots && handle->exited, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for buffers");
+
+    esp_codec_dev_sample_info_t fs = {
+        .sample_rate = config->sample_rate,
+        .channel = config->channels,
+        .bits_per_sample = 16,
+    };
+    ESP_GOTO_ON_FALSE(esp_codec_dev_open(config->mic, &fs) == ESP_CODEC_DEV_OK, ESP_FAIL, err, TAG, "Microphone open failed");
+    mic_open = true;
+
+    handle->running = true;
+    if (config->task_affinity < 0) {
+        res = xTaskCreate(audio_vad_task, "audio_vad", config->task_stack, handle, config->task_priority, NULL);
+    } else {
+        res = xTaskCreatePinnedToCore(audio_vad_task, "audio_vad", config->task_stack, handle, config->task_priority, NULL, config->task_affinity);
+    }
+    ESP_GOTO_ON_FALSE(res == pdPASS, ESP_ERR_NO_MEM, err, TAG, "Create task failed");
+
+    *ret_handle = handle;
+    return ESP_OK;
+
+err:
+    if (mic_open) {
+        esp_codec_dev_close(config->mic);
+    }
+    audio_vad_free(handle);
+    return ret;
+}
+
+esp_err_t audio_vad_delete(audio_vad_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    /* The task finishes the running frame */
+    handle->running = false;
+    xSemaphoreTake(handle->exited, portMAX_DELAY);
+    esp_codec_dev_close(handle->config.mic);
+    audio_vad_free(handle);
+    return ESP_OK;
+}
+
+bool audio_vad_is_speech(audio_vad_handle_t handle)
+{
+    return handle && handle->speech;
+}
+
+esp_err_t audio_vad_get_stats(audio_vad_handle_t handle, audio_vad_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(handle && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    *stats = handle->stats;
+    stats->gated_frames = stats->frames - MIN(stats->speech_frames, stats->frames);
+    stats->noise_level = lrintf(sqrtf(handle->noise));
+    return ESP_OK;
+}
@@ -0,0 +1,150 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Voice activity detection gate of microphone capture
+ *
+ * A task reads the microphone and runs an energy detector on one decimated channel. Captured frames are passed
+ * to the processing callback only during speech (and its hangover), so the processing sleeps in silence.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_codec_dev.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Callback of captured frame during speech
+ *
+ * @param[in] mic       Captured frame of `samples * channels` 16-bit samples (interleaved, full rate)
+ * @param[in] samples   Count of samples of each channel
+ * @param[in] user_ctx  User data from the configuration
+ */
+typedef void (*audio_vad_frame_cb_t)(const int16_t *mic, size_t samples, void *user_ctx);
+
+/**
+ * @brief Callback of speech start and end
+ *
+ * @param[in] speech    true: speech started (the pipeline should wake up), false: silence after hangover
+ * @param[in] user_ctx  User data from the configuration
+ */
+typedef void (*audio_vad_state_cb_t)(bool speech, void *user_ctx);
+
+/**
+ * @brief Voice activity detection configuration
+ */
+typedef struct {
+    esp_codec_dev_handle_t mic;         /*!< Microphone codec device (e.g. from `bsp_audio_codec_microphone_init`) */
+    uint32_t sample_rate;               /*!< Capture sample rate [Hz] */
+    uint8_t channels;                   /*!< Count of captured channels */
+    size_t frame_samples;               /*!< Count of samples of each channel in one frame */
+    uint8_t vad_channel;                /*!< Channel analysed by the detector */
+    uint8_t decimation;                 /*!< Decimation of the analysed channel (1: full rate) */
+    float threshold_db;                 /*!< Frame energy above the noise floor detected as speech [dB] */
+    uint16_t min_level;                 /*!< Minimum RMS level detected as speech (quiet rooms) */
+    uint32_t trigger_frames;            /*!< Count of consecutive speech frames to wake up */
+    uint32_t hangover_frames;           /*!< Count of consecutive silent frames to go to sleep */
+    uint32_t preroll_frames;            /*!< Frames before the wake up delivered with the speech (start of the word) */
+    audio_vad_frame_cb_t frame_cb;      /*!< Processing of speech frames */
+    audio_vad_state_cb_t state_cb;      /*!< Speech start and end (can be NULL) */
+    void *user_ctx;                     /*!< User data for the callbacks */
+    int task_priority;                  /*!< Priority of the capture task */
+    int task_stack;                     /*!< Stack size of the capture task [bytes] */
+    int task_affinity;                  /*!< Core of the task (-1 for no affinity) */
+} audio_vad_config_t;
+
+/**
+ * @brief Default voice activity detection configuration (16 kHz mono, 20 ms frames, analysed at 4 kHz)
+ */
+#define AUDIO_VAD_CONFIG_DEFAULT(mic_dev)       \
+    {                                           \
+        .mic = (mic_dev),                       \
+        .sample_rate = 16000,                   \
+        .channels = 1,                          \
+        .frame_samples = 320,                   \
+        .vad_channel = 0,                       \
+        .decimation = 4,                        \
+        .threshold_db = 9.0,                    \
+        .min_level = 200,                       \
+        .trigger_frames = 2,                    \
+        .hangover_frames = 25,                  \
+        .preroll_frames = 5,                    \
+        .task_priority = 5,                     \
+        .task_stack = 4096,                     \
+        .task_affinity = -1,                    \
+    }
+
+/**
+ * @brief Voice activity detection statistics
+ */
+typedef struct {
+    uint32_t frames;                    /*!< Count of captured frames */
+    uint32_t speech_frames;             /*!< Count of frames passed to the processing (including hangover and preroll) */
+    uint32_t gated_frames;              /*!< Count of frames not processed (CPU time saved) */
+    uint32_t wake_cnt;                  /*!< Count of wake ups */
+    uint32_t vad_time_max;              /*!< Longest time of the detector in one frame [us] */
+    uint32_t cb_time_max;               /*!< Longest time of the processing callback in one frame [us] */
+    uint32_t noise_level;               /*!< Current noise floor (RMS) */
+} audio_vad_stats_t;
+
+/**
+ * @brief Voice activity detection handle
+ */
+typedef struct audio_vad_s *audio_vad_handle_t;
+
+/**
+ * @brief Open the microphone and start voice activity detection
+ *
+ * @param config        Configuration
+ * @param ret_handle    Created detector
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if there is no memory for the detector
+ *      - ESP_FAIL              if the codec cannot be opened
+ */
+esp_err_t audio_vad_create(const audio_vad_config_t *config, audio_vad_handle_t *ret_handle);
+
+/**
+ * @brief Stop voice activity detection and close the microphone
+ *
+ * @param handle    Detector
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t audio_vad_delete(audio_vad_handle_t handle);
+
+/**
+ * @brief Check, if speech is detected (frames are processed)
+ *
+ * @param handle    Detector
+ * @return true during speech and its hangover
+ */
+bool audio_vad_is_speech(audio_vad_handle_t handle);
+
+/**
+ * @brief Get statistics of the detector
+ *
+ * @param handle    Detector
+ * @param stats     Output statistics
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t audio_vad_get_stats(audio_vad_handle_t handle, audio_vad_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
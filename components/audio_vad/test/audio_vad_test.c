@@ -0,0 +1,37 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "unity.h"
+#include "audio_vad.h"
+
+static void frame_cb(const int16_t *mic, size_t samples, void *user_ctx)
+{
+}
+
+TEST_CASE("Audio VAD invalid arguments test", "[audio_vad]")
+{
+    /* Codec is not opened, when the configuration is invalid */
+    static int dummy_codec;
+    audio_vad_handle_t vad = NULL;
+
+    audio_vad_config_t config = AUDIO_VAD_CONFIG_DEFAULT(NULL);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_vad_create(&config, &vad));
+
+    config.mic = (esp_codec_dev_handle_t)&dummy_codec;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_vad_create(&config, &vad));
+
+    config.frame_cb = frame_cb;
+    config.vad_channel = 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_vad_create(&config, &vad));
+
+    config.vad_channel = 0;
+    config.decimation = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_vad_create(&config, &vad));
+    TEST_ASSERT_NULL(vad);
+
+    TEST_ASSERT_FALSE(audio_vad_is_speech(NULL));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, audio_vad_delete(NULL));
+}
@@ -0,0 +1,980 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
+#include "freertos/ringbuf.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "soc/soc_caps.h"
+#include "avi_player.h"
+
+#if SOC_JPEG_CODEC_SUPPORTED
+#include "driver/jpeg_decode.h"
+#define AVI_PLAYER_HW_JPEG          1
+#else
+#include "esp_jpeg_dec.h"
+#define AVI_PLAYER_HW_JPEG          0
+#endif
+
+static const char *TAG = "avi_player";
+
+#define AVI_PLAYER_PATH_MAX         (256)
+/* Period of checking the stop request, when a task waits */
+#define AVI_PLAYER_WAIT_MS          (50)
+/* Time without data in the audio ring buffer, after which silence is sent to the codec */
+#define AVI_PLAYER_UNDERRUN_MS      (10)
+/* One codec write [bytes] */
+#define AVI_PLAYER_AUDIO_CHUNK      (1024)
+/* File reads start on sector boundary */
+#define AVI_PLAYER_READ_ALIGN       (512)
+/* JPEG frames read ahead of the decoder */
+#define AVI_PLAYER_JPEG_SLOTS       (2)
+#define AVI_PLAYER_FRAMES_MAX       (4)
+/* Size of JPEG buffer, when the file does not suggest it */
+#define AVI_PLAYER_JPEG_SIZE        (32 * 1024)
+/* Longest header list (stream headers) */
+#define AVI_PLAYER_HDRL_MAX         (16 * 1024)
+
+#define AVI_PLAYER_EV_PLAY          BIT0    /* Reader: new file should be played */
+#define AVI_PLAYER_EV_DECODE        BIT1    /* Decoder: header was parsed (or the reader failed) */
+#define AVI_PLAYER_EV_DISPLAY       BIT2    /* Display: header was parsed (or the reader failed) */
+#define AVI_PLAYER_EV_AUDIO         BIT3    /* Audio: the first frame is displayed, audio clock starts */
+#define AVI_PLAYER_EV_READER_IDLE   BIT4
+#define AVI_PLAYER_EV_DECODER_IDLE  BIT5
+#define AVI_PLAYER_EV_DISPLAY_IDLE  BIT6
+#define AVI_PLAYER_EV_AUDIO_IDLE    BIT7
+#define AVI_PLAYER_EV_READER_EXIT   BIT8
+#define AVI_PLAYER_EV_DECODER_EXIT  BIT9
+#define AVI_PLAYER_EV_DISPLAY_EXIT  BIT10
+#define AVI_PLAYER_EV_AUDIO_EXIT    BIT11
+#define AVI_PLAYER_EV_ALL_IDLE      (AVI_PLAYER_EV_READER_IDLE | AVI_PLAYER_EV_DECODER_IDLE | AVI_PLAYER_EV_DISPLAY_IDLE | AVI_PLAYER_EV_AUDIO_IDLE)
+#define AVI_PLAYER_EV_ALL_EXIT      (AVI_PLAYER_EV_READER_EXIT | AVI_PLAYER_EV_DECODER_EXIT | AVI_PLAYER_EV_DISPLAY_EXIT | AVI_PLAYER_EV_AUDIO_EXIT)
+#define AVI_PLAYER_EV_ALL_START     (AVI_PLAYER_EV_PLAY | AVI_PLAYER_EV_DECODE | AVI_PLAYER_EV_DISPLAY | AVI_PLAYER_EV_AUDIO)
+
+typedef struct {
+    int8_t buf;                             /* JPEG slot or frame buffer, -1 is the end of stream */
+    uint32_t index;                         /* Index of the frame in the file */
+    uint32_t len;                           /* Length of JPEG data [bytes] */
+    uint32_t stride;                        /* Distance of the decoded rows [px] */
+} avi_player_msg_t;
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+} avi_player_jpeg_t;
+
+/* Buffered file reader, all reads from the file have read_size and start on sector boundary */
+typedef struct {
+    FILE *f;
+    uint8_t *buf;
+    size_t size;                            /* Size of the buffer (read_size) */
+    size_t pos;                             /* Read position in the buffer */
+    size_t len;                             /* Valid bytes in the buffer */
+    uint32_t offset;                        /* File offset of the buffer start */
+    uint32_t file_pos;                      /* Position of the file (next read without seek) */
+} avi_player_file_t;
+
+struct avi_player_s {
+    esp_codec_dev_handle_t codec;
+    avi_player_frame_cb_t frame_cb;
+    avi_player_done_cb_t done_cb;
+    void *user_ctx;
+    bool swap_bytes;
+    bool buff_spiram;
+    EventGroupHandle_t events;
+    QueueHandle_t jpeg_free;                /* Free JPEG slots (index) */
+    QueueHandle_t jpeg_ready;               /* Read JPEG frames (avi_player_msg_t) */
+    QueueHandle_t frame_free;               /* Free frame buffers (index) */
+    QueueHandle_t frame_ready;              /* Decoded frames (avi_player_msg_t) */
+    RingbufHandle_t audio_ring;
+    size_t audio_ring_size;
+    avi_player_file_t file;
+    avi_player_jpeg_t jpegs[AVI_PLAYER_JPEG_SLOTS];
+    uint16_t *frames[AVI_PLAYER_FRAMES_MAX];
+    size_t frame_size;                      /* Size of each frame buffer [bytes] */
+    uint8_t frame_cnt;
+    uint8_t *silence;
+#if AVI_PLAYER_HW_JPEG
+    jpeg_decoder_handle_t engine;
+    jpeg_decode_cfg_t decode_cfg;
+#else
+    jpeg_dec_handle_t decoder;
+#endif
+    char path[AVI_PLAYER_PATH_MAX];
+    /* Streams of the playing file */
+    int video_stream;
+    int audio_stream;                       /* -1: no PCM audio (or no codec) */
+    uint32_t width;
+    uint32_t height;
+    uint32_t frame_period;                  /* [us] */
+    size_t jpeg_size;                       /* Suggested size of JPEG buffer [bytes] */
+    esp_codec_dev_sample_info_t fs;
+    uint32_t byte_rate;                     /* Audio bytes per second */
+    uint32_t movi_start;                    /* Data of the movi list */
+    uint32_t movi_end;
+    /* Playback clock, audio output is the clock while it plays */
+    volatile bool audio_clock;
+    volatile bool clock_started;            /* The first frame was displayed */
+    volatile uint32_t audio_bytes;          /* Bytes sent to the codec (data and silence) */
+    uint32_t silence_debt;                  /* Silence sent on underruns, the same amount of data is skipped */
+    int64_t start_time;                     /* System time of the clock zero, when audio does not play */
+    portMUX_TYPE clock_lock;                /* Start of the clock by the display or the reader */
+    esp_err_t result;
+    avi_player_stats_t stats;
+    volatile bool stop;
+    volatile bool running;
+};
+
+static inline uint16_t avi_player_le16(const uint8_t *data)
+{
+    return data[0] | (data[1] << 8);
+}
+
+static inline uint32_t avi_player_le32(const uint8_t *data)
+{
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static int64_t avi_player_clock(avi_player_handle_t handle)
+{
+    if (handle->audio_clock) {
+        return (int64_t)handle->audio_bytes * 1000000 / handle->byte_rate;
+    }
+    return esp_timer_get_time() - handle->start_time;
+}
+
+/* The clock starts with the first frame, or with audio when the file begins with more audio than the ring buffer holds */
+static void avi_player_clock_start(avi_player_handle_t handle, int64_t pts)
+{
+    portENTER_CRITICAL(&handle->clock_lock);
+    const bool start = !handle->clock_started;
+    if (start) {
+        handle->start_time = esp_timer_get_time() - pts;
+        handle->clock_started = true;
+    }
+    portEXIT_CRITICAL(&handle->clock_lock);
+    if (start) {
+        xEventGroupSetBits(handle->events, AVI_PLAYER_EV_AUDIO);
+    }
+}
+
+/*******************************************************************************
+* Buffered file reading
+*******************************************************************************/
+
+static esp_err_t avi_player_file_fill(avi_player_handle_t handle, uint32_t offset)
+{
+    avi_player_file_t *file = &handle->file;
+    if (file->file_pos != offset) {
+        ESP_RETURN_ON_FALSE(fseek(file->f, offset, SEEK_SET) == 0, ESP_ERR_INVALID_SIZE, TAG, "Seek failed");
+        file->file_pos = offset;
+    }
+    const int64_t start = esp_timer_get_time();
+    file->len = fread(file->buf, 1, file->size, file->f);
+    const uint32_t read_time = esp_timer_get_time() - start;
+    handle->stats.read_time_max = MAX(handle->stats.read_time_max, read_time);
+    file->offset = offset;
+    file->file_pos += file->len;
+    file->pos = 0;
+    return (file->len > 0) ? ESP_OK : ESP_ERR_INVALID_SIZE;
+}
+
+static inline uint32_t avi_player_file_tell(const avi_player_file_t *file)
+{
+    return file->offset + file->pos;
+}
+
+static esp_err_t avi_player_file_seek(avi_player_handle_t handle, uint32_t pos)
+{
+    avi_player_file_t *file = &handle->file;
+    if (pos < file->offset || pos >= file->offset + file->len) {
+        ESP_RETURN_ON_ERROR(avi_player_file_fill(handle, pos & ~(AVI_PLAYER_READ_ALIGN - 1)), TAG, "File is truncated");
+    }
+    file->pos = pos - file->offset;
+    ESP_RETURN_ON_FALSE(file->pos < file->len, ESP_ERR_INVALID_SIZE, TAG, "File is truncated");
+    return ESP_OK;
+}
+
+/* Data available in the buffer without copy, at most `max` bytes */
+static esp_err_t avi_player_file_peek(avi_player_handle_t handle, const uint8_t **data, size_t *len, size_t max)
+{
+    avi_player_file_t *file = &handle->file;
+    if (file->pos == file->len) {
+        ESP_RETURN_ON_ERROR(avi_player_file_fill(handle, file->offset + file->len), TAG, "File is truncated");
+    }
+    *data = &file->buf[file->pos];
+    *len = MIN(max, file->len - file->pos);
+    file->pos += *len;
+    return ESP_OK;
+}
+
+static esp_err_t avi_player_file_read(avi_player_handle_t handle, void *dst, size_t len)
+{
+    uint8_t *out = dst;
+    while (len > 0) {
+        const uint8_t *data;
+        size_t chunk;
+        ESP_RETURN_ON_ERROR(avi_player_file_peek(handle, &data, &chunk, len), TAG, "File is truncated");
+        memcpy(out, data, chunk);
+        out += chunk;
+        len -= chunk;
+    }
+    return ESP_OK;
+}
+
+/*******************************************************************************
+* AVI parsing
+*******************************************************************************/
+
+/* Stream headers: MJPEG video and PCM audio streams are selected */
+static esp_err_t avi_player_parse_hdrl(avi_player_handle_t handle, const uint8_t *data, size_t len)
+{
+    int stream = 0;
+    for (size_t pos = 0; pos + 8 <= len;) {
+        const uint32_t size = MIN(avi_player_le32(&data[pos + 4]), len - pos - 8);
+        const uint8_t *chunk = &data[pos + 8];
+
+        if (memcmp(&data[pos], "avih", 4) == 0 && size >= 40) {
+            handle->frame_period = avi_player_le32(&chunk[0]);
+            handle->jpeg_size = MAX(handle->jpeg_size, avi_player_le32(&chunk[28]));
+            handle->width = avi_player_le32(&chunk[32]);
+            handle->height = avi_player_le32(&chunk[36]);
+        } else if (memcmp(&data[pos], "LIST", 4) == 0 && size >= 4 && memcmp(chunk, "strl", 4) == 0) {
+            const uint8_t *strh = NULL;
+            const uint8_t *strf = NULL;
+            uint32_t strf_size = 0;
+            for (size_t sub = 4; sub + 8 <= size;) {
+                const uint32_t sub_size = MIN(avi_player_le32(&chunk[sub + 4]), size - sub - 8);
+                if (memcmp(&chunk[sub], "strh", 4) == 0 && sub_size >= 40) {
+                    strh = &chunk[sub + 8];
+                } else if (memcmp(&chunk[sub], "strf", 4) == 0) {
+                    strf = &chunk[sub + 8];
+                    strf_size = sub_size;
+                }
+                sub += 8 + sub_size + (sub_size & 1);
+            }
+
+            if (strh && strf && memcmp(strh, "vids", 4) == 0 && strf_size >= 20 && handle->video_stream < 0) {
+                if (memcmp(&strf[16], "MJPG", 4) == 0 || memcmp(&strh[4], "MJPG", 4) == 0) {
+                    handle->video_stream = stream;
+                    handle->width = avi_player_le32(&strf[4]);
+                    handle->height = abs((int32_t)avi_player_le32(&strf[8]));
+                    /* Rate / scale is more precise than the period in the main header */
+                    const uint32_t scale = avi_player_le32(&strh[20]);
+                    const uint32_t rate = avi_player_le32(&strh[24]);
+                    if (scale && rate) {
+                        handle->frame_period = (uint64_t)scale * 1000000 / rate;
+                    }
+                    handle->jpeg_size = MAX(handle->jpeg_size, avi_player_le32(&strh[36]));
+                }
+            } else if (strh && strf && memcmp(strh, "auds", 4) == 0 && strf_size >= 16 && handle->audio_stream < 0) {
+                if (avi_player_le16(&strf[0]) == 1) {
+                    handle->audio_stream = stream;
+                    handle->fs.channel = avi_player_le16(&strf[2]);
+                    handle->fs.sample_rate = avi_player_le32(&strf[4]);
+                    handle->fs.bits_per_sample = avi_player_le16(&strf[14]);
+                    handle->byte_rate = avi_player_le32(&strf[8]);
+                } else {
+                    ESP_LOGW(TAG, "Audio stream %d is not PCM, video is played without audio", stream);
+                }
+            }
+            stream++;
+        }
+        pos += 8 + size + (size & 1);
+    }
+
+    ESP_RETURN_ON_FALSE(handle->video_stream >= 0, ESP_ERR_NOT_SUPPORTED, TAG, "No MJPEG video stream");
+    ESP_RETURN_ON_FALSE(handle->width > 0 && handle->height > 0 && handle->frame_period > 0, ESP_ERR_INVALID_SIZE, TAG, "Invalid video stream header");
+    if (handle->audio_stream >= 0 && (handle->codec == NULL || handle->byte_rate == 0 || handle->fs.channel == 0)) {
+        handle->audio_stream = -1;
+    }
+    return ESP_OK;
+}
+
+/* Headers are parsed, the file is positioned to the start of movi list */
+static esp_err_t avi_player_parse_header(avi_player_handle_t handle)
+{
+    uint8_t hdr[12];
+    ESP_RETURN_ON_ERROR(avi_player_file_read(handle, hdr, 12), TAG, "File is too short");
+    ESP_RETURN_ON_FALSE(memcmp(hdr, "RIFF", 4) == 0 && memcmp(&hdr[8], "AVI ", 4) == 0, ESP_ERR_NOT_SUPPORTED, TAG, "Not an AVI file");
+
+    while (avi_player_file_read(handle, hdr, 8) == ESP_OK) {
+        const uint32_t size = avi_player_le32(&hdr[4]);
+        const uint32_t next = avi_player_file_tell(&handle->file) + size + (size & 1);
+        if (memcmp(hdr, "LIST", 4) == 0 && size >= 4) {
+            ESP_RETURN_ON_ERROR(avi_player_file_read(handle, &hdr[8], 4), TAG, "File is too short");
+            if (memcmp(&hdr[8], "hdrl", 4) == 0) {
+                ESP_RETURN_ON_FALSE(size - 4 <= AVI_PLAYER_HDRL_MAX, ESP_ERR_INVALID_SIZE, TAG, "Header list is too long");
+                uint8_t *hdrl = malloc(size - 4);
+                ESP_RETURN_ON_FALSE(hdrl, ESP_ERR_NO_MEM, TAG, "Not enough memory for header list");
+                esp_err_t ret = avi_player_file_read(handle, hdrl, size - 4);
+                if (ret == ESP_OK) {
+                    ret = avi_player_parse_hdrl(handle, hdrl, size - 4);
+                }
+                free(hdrl);
+                ESP_RETURN_ON_ERROR(ret, TAG, "Unsupported AVI header");
+            } else if (memcmp(&hdr[8], "movi", 4) == 0) {
+                ESP_RETURN_ON_FALSE(handle->video_stream >= 0, ESP_ERR_INVALID_STATE, TAG, "Header list is missing");
+                handle->movi_start = avi_player_file_tell(&handle->file);
+                handle->movi_end = handle->movi_start + size - 4;
+                return ESP_OK;
+            }
+        }
+        ESP_RETURN_ON_ERROR(avi_player_file_seek(handle, next), TAG, "File is truncated");
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+/*******************************************************************************
+* Memory
+*******************************************************************************/
+
+static void *avi_player_alloc(avi_player_handle_t handle, size_t size, bool jpeg_input, size_t *ret_size)
+{
+#if AVI_PLAYER_HW_JPEG
+    /* DMA buffers of the codec are aligned to cache lines */
+    const jpeg_decode_memory_alloc_cfg_t mem_cfg = {
+        .buffer_direction = jpeg_input ? JPEG_DEC_ALLOC_INPUT_BUFFER : JPEG_DEC_ALLOC_OUTPUT_BUFFER,
+    };
+    return jpeg_alloc_decoder_mem(size, &mem_cfg, ret_size);
+#else
+    const uint32_t caps = (handle->buff_spiram ? MALLOC_CAP_SPIRAM : MALLOC_CAP_INTERNAL) | MALLOC_CAP_8BIT;
+    /* SIMD decoder needs 16 bytes aligned output */
+    void *buf = heap_caps_aligned_alloc(16, size, caps);
+    *ret_size = buf ? size : 0;
+    return buf;
+#endif
+}
+
+/* Frame buffers are reallocated only for bigger videos */
+static esp_err_t avi_player_alloc_frames(avi_player_handle_t handle)
+{
+    /* Decoded size is aligned to whole MCU blocks */
+    const size_t size = ((handle->width + 15) & ~15) * ((handle->height + 15) & ~15) * sizeof(uint16_t);
+    if (size <= handle->frame_size) {
+        return ESP_OK;
+    }
+    for (int i = 0; i < handle->frame_cnt; i++) {
+        free(handle->frames[i]);
+        handle->frames[i] = NULL;
+    }
+    handle->frame_size = 0;
+    size_t allocated = 0;
+    for (int i = 0; i < handle->frame_cnt; i++) {
+        handle->frames[i] = avi_player_alloc(handle, size, false, &allocated);
+        ESP_RETURN_ON_FALSE(handle->frames[i], ESP_ERR_NO_MEM, TAG, "Not enough memory for frame buffers (%d x %zu bytes)", handle->frame_cnt, size);
+    }
+    handle->frame_size = size;
+    return ESP_OK;
+}
+
+static esp_err_t avi_player_jpeg_reserve(avi_player_handle_t handle, avi_player_jpeg_t *jpeg, size_t len)
+{
+    if (len <= jpeg->size) {
+        return ESP_OK;
+    }
+    free(jpeg->data);
+    jpeg->data = avi_player_alloc(handle, MAX(len, handle->jpeg_size), true, &jpeg->size);
+    if (jpeg->data == NULL) {
+        jpeg->size = 0;
+        ESP_LOGE(TAG, "Not enough memory for JPEG frame (%zu bytes)", len);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+/*******************************************************************************
+* Reader
+*******************************************************************************/
+
+static esp_err_t avi_player_read_video(avi_player_handle_t handle, uint32_t size, uint32_t index)
+{
+    uint8_t slot;
+    while (xQueueReceive(handle->jpeg_free, &slot, pdMS_TO_TICKS(AVI_PLAYER_WAIT_MS)) != pdTRUE) {
+        if (handle->stop) {
+            return ESP_OK;
+        }
+    }
+
+    avi_player_jpeg_t *jpeg = &handle->jpegs[slot];
+    esp_err_t ret = avi_player_jpeg_reserve(handle, jpeg, size);
+    if (ret == ESP_OK) {
+        ret = avi_player_file_read(handle, jpeg->data, size);
+    }
+    if (ret != ESP_OK) {
+        xQueueSend(handle->jpeg_free, &slot, 0);
+        return ret;
+    }
+    const avi_player_msg_t msg = {
+        .buf = slot,
+        .index = index,
+        .len = size,
+    };
+    xQueueSend(handle->jpeg_ready, &msg, portMAX_DELAY);
+    return ESP_OK;
+}
+
+static esp_err_t avi_player_read_audio(avi_player_handle_t handle, uint32_t size)
+{
+    /* Sent from the file buffer without copy */
+    while (size > 0 && !handle->stop) {
+        const uint8_t *data;
+        size_t len;
+        ESP_RETURN_ON_ERROR(avi_player_file_peek(handle, &data, &len, size), TAG, "File is truncated");
+        while (!handle->stop && xRingbufferSend(handle->audio_ring, data, len, pdMS_TO_TICKS(AVI_PLAYER_WAIT_MS)) != pdTRUE) {
+            avi_player_clock_start(handle, 0);
+        }
+        size -= len;
+    }
+    return ESP_OK;
+}
+
+static void avi_player_read_file(avi_player_handle_t handle)
+{
+    esp_err_t ret = ESP_OK;
+    uint32_t index = 0;
+
+    handle->video_stream = -1;
+    handle->audio_stream = -1;
+    handle->jpeg_size = AVI_PLAYER_JPEG_SIZE;
+    handle->file.f = fopen(handle->path, "rb");
+    ESP_GOTO_ON_FALSE(handle->file.f, ESP_ERR_NOT_FOUND, end, TAG, "File %s does not exist", handle->path);
+    /* Reads go directly into the aligned buffer, not through the stdio buffer */
+    setvbuf(handle->file.f, NULL, _IONBF, 0);
+    handle->file.offset = 0;
+    handle->file.file_pos = 0;
+    handle->file.pos = 0;
+    handle->file.len = 0;
+    ESP_GOTO_ON_ERROR(avi_player_parse_header(handle), end, TAG, "Unsupported AVI file %s", handle->path);
+    ESP_GOTO_ON_ERROR(avi_player_alloc_frames(handle), end, TAG, "Allocation failed");
+    ESP_LOGI(TAG, "Playing %s: %" PRIu32 "x%" PRIu32 ", %" PRIu32 " us per frame, audio %s", handle->path, handle->width, handle->height,
+             handle->frame_period, (handle->audio_stream >= 0) ? "PCM" : "none");
+    handle->audio_clock = (handle->audio_stream >= 0);
+    xEventGroupSetBits(handle->events, AVI_PLAYER_EV_DECODE | AVI_PLAYER_EV_DISPLAY);
+
+    /* Chunks of the streams are interleaved in movi list */
+    uint8_t hdr[12];
+    while (!handle->stop && avi_player_file_tell(&handle->file) + 8 <= handle->movi_end) {
+        ESP_GOTO_ON_ERROR(avi_player_file_read(handle, hdr, 8), end, TAG, "File %s is truncated", handle->path);
+        const uint32_t size = avi_player_le32(&hdr[4]);
+        if (memcmp(hdr, "LIST", 4) == 0) {
+            /* Chunks of 'rec ' list are read as if they were in movi list */
+            ESP_GOTO_ON_ERROR(avi_player_file_read(handle, &hdr[8], 4), end, TAG, "File %s is truncated", handle->path);
+            continue;
+        }
+
+        const uint32_t next = avi_player_file_tell(&handle->file) + size + (size & 1);
+        const int stream = (hdr[0] - '0') * 10 + (hdr[1] - '0');
+        if (stream == handle->video_stream && hdr[2] == 'd') {
+            /* Empty chunk repeats the previous frame */
+            if (size > 0) {
+                ESP_GOTO_ON_ERROR(avi_player_read_video(handle, size, index), end, TAG, "Reading of frame %" PRIu32 " failed", index);
+            }
+            index++;
+        } else if (stream == handle->audio_stream && hdr[2] == 'w' && hdr[3] == 'b') {
+            ESP_GOTO_ON_ERROR(avi_player_read_audio(handle, size), end, TAG, "Reading of audio failed");
+        }
+        if (next >= handle->movi_end) {
+            break;
+        }
+        ESP_GOTO_ON_ERROR(avi_player_file_seek(handle, next), end, TAG, "File %s is truncated", handle->path);
+    }
+
+end:
+    if (handle->file.f) {
+        fclose(handle->file.f);
+        handle->file.f = NULL;
+    }
+    handle->result = ret;
+    /* Decoder and display finish with the end of stream */
+    const avi_player_msg_t eos = {
+        .buf = -1,
+    };
+    xQueueSend(handle->jpeg_ready, &eos, portMAX_DELAY);
+    xEventGroupSetBits(handle->events, AVI_PLAYER_EV_DECODE | AVI_PLAYER_EV_DISPLAY);
+}
+
+/*******************************************************************************
+* Decoder
+*******************************************************************************/
+
+static esp_err_t avi_player_decode_frame(avi_player_handle_t handle, const avi_player_jpeg_t *jpeg, uint32_t len, uint16_t *out, uint32_t *stride)
+{
+#if AVI_PLAYER_HW_JPEG
+    jpeg_decode_picture_info_t info;
+    ESP_RETURN_ON_ERROR(jpeg_decoder_get_info(jpeg->data, len, &info), TAG, "Invalid JPEG frame");
+    const uint32_t mcu_w = (info.sample_method == JPEG_DOWN_SAMPLING_YUV420 || info.sample_method == JPEG_DOWN_SAMPLING_YUV422) ? 16 : 8;
+    const uint32_t mcu_h = (info.sample_method == JPEG_DOWN_SAMPLING_YUV420) ? 16 : 8;
+    *stride = ((info.width + mcu_w - 1) / mcu_w) * mcu_w;
+    const uint32_t out_size = *stride * (((info.height + mcu_h - 1) / mcu_h) * mcu_h) * sizeof(uint16_t);
+    ESP_RETURN_ON_FALSE(info.width <= handle->width && info.height <= handle->height && out_size <= handle->frame_size,
+                        ESP_ERR_INVALID_SIZE, TAG, "Frame is bigger than the video");
+
+    uint32_t written = 0;
+    ESP_RETURN_ON_ERROR(jpeg_decoder_process(handle->engine, &handle->decode_cfg, jpeg->data, len, (uint8_t *)out, handle->frame_size, &written),
+                        TAG, "JPEG decoding failed");
+    /* The codec has no big endian output */
+    if (handle->swap_bytes) {
+        for (uint32_t i = 0; i < out_size / sizeof(uint16_t); i++) {
+            out[i] = __builtin_bswap16(out[i]);
+        }
+    }
+#else
+    jpeg_dec_io_t io = {
+        .inbuf = jpeg->data,
+        .inbuf_len = len,
+        .outbuf = (uint8_t *)out,
+    };
+    jpeg_dec_header_info_t info;
+    ESP_RETURN_ON_FALSE(jpeg_dec_parse_header(handle->decoder, &io, &info) == JPEG_ERR_OK, ESP_ERR_INVALID_RESPONSE, TAG, "Invalid JPEG frame");
+    ESP_RETURN_ON_FALSE(info.width <= handle->width && info.height <= handle->height, ESP_ERR_INVALID_SIZE, TAG, "Frame is bigger than the video");
+    ESP_RETURN_ON_FALSE(jpeg_dec_process(handle->decoder, &io) == JPEG_ERR_OK, ESP_FAIL, TAG, "JPEG decoding failed");
+    *stride = info.width;
+#endif
+    return ESP_OK;
+}
+
+static void avi_player_decode(avi_player_handle_t handle)
+{
+    avi_player_msg_t msg;
+    while (!handle->stop) {
+        if (xQueueReceive(handle->jpeg_ready, &msg, pdMS_TO_TICKS(AVI_PLAYER_WAIT_MS)) != pdTRUE) {
+            continue;
+        }
+        if (msg.buf < 0) {
+            break;
+        }
+
+        /* Late frame is not decoded, the decoder catches up with the clock */
+        const int64_t pts = (int64_t)msg.index * handle->frame_period;
+        if (handle->clock_started && avi_player_clock(handle) - pts > handle->frame_period) {
+            handle->stats.frames_dropped++;
+            xQueueSend(handle->jpeg_free, &msg.buf, 0);
+            continue;
+        }
+
+        uint8_t frame;
+        while (!handle->stop && xQueueReceive(handle->frame_free, &frame, pdMS_TO_TICKS(AVI_PLAYER_WAIT_MS)) != pdTRUE) {
+        }
+        if (handle->stop) {
+            break;
+        }
+
+        const int64_t start = esp_timer_get_time();
+        const esp_err_t ret = avi_player_decode_frame(handle, &handle->jpegs[msg.buf], msg.len, handle->frames[frame], &msg.stride);
+        const uint32_t decode_time = esp_timer_get_time() - start;
+        handle->stats.decode_time_max = MAX(handle->stats.decode_time_max, decode_time);
+        xQueueSend(handle->jpeg_free, &msg.buf, 0);
+        if (ret != ESP_OK) {
+            /* Broken frame is skipped, the previous one stays on the screen */
+            handle->stats.frames_dropped++;
+            xQueueSend(handle->frame_free, &frame, 0);
+            continue;
+        }
+        msg.buf = frame;
+        xQueueSend(handle->frame_ready, &msg, portMAX_DELAY);
+    }
+
+    const avi_player_msg_t eos = {
+        .buf = -1,
+    };
+    xQueueSend(handle->frame_ready, &eos, portMAX_DELAY);
+}
+
+/*******************************************************************************
+* Display
+*******************************************************************************/
+
+static void avi_player_display(avi_player_handle_t handle)
+{
+    avi_player_msg_t msg;
+    int8_t shown = -1;
+
+    while (!handle->stop) {
+        if (xQueueReceive(handle->frame_ready, &msg, pdMS_TO_TICKS(AVI_PLAYER_WAIT_MS)) != pdTRUE) {
+            continue;
+        }
+        if (msg.buf < 0) {
+            break;
+        }
+
+        const int64_t pts = (int64_t)msg.index * handle->frame_period;
+        /* The first frame is the clock zero, audio starts with it */
+        avi_player_clock_start(handle, pts);
+        int64_t wait = pts - avi_player_clock(handle);
+        while (!handle->stop && wait > 0) {
+            vTaskDelay(MAX(1, pdMS_TO_TICKS(MIN(wait / 1000, AVI_PLAYER_WAIT_MS))));
+            wait = pts - avi_player_clock(handle);
+        }
+        if (handle->stop) {
+            xQueueSend(handle->frame_free, &msg.buf, 0);
+            break;
+        }
+        if (-wait > handle->frame_period) {
+            handle->stats.frames_late++;
+        }
+        handle->stats.av_offset_max = MAX(handle->stats.av_offset_max, (int32_t)MIN(-wait, INT32_MAX));
+
+        const avi_player_frame_t frame = {
+            .data = handle->frames[msg.buf],
+            .width = handle->width,
+            .height = handle->height,
+            .stride = msg.stride,
+            .index = msg.index,
+        };
+        handle->frame_cb(&frame, handle->user_ctx);
+        handle->stats.frames_displayed++;
+
+        /* Previous frame is not sent anymore */
+        if (shown >= 0) {
+            xQueueSend(handle->frame_free, &shown, 0);
+        }
+        shown = msg.buf;
+    }
+
+    /* Audio task runs (and finishes) also when no frame was displayed */
+    avi_player_clock_start(handle, 0);
+}
+
+/*******************************************************************************
+* Audio
+*******************************************************************************/
+
+static void avi_player_audio(avi_player_handle_t handle)
+{
+    if (handle->stop || handle->audio_stream < 0) {
+        return;
+    }
+    esp_codec_dev_sample_info_t fs = handle->fs;
+    if (esp_codec_dev_open(handle->codec, &fs) != ESP_CODEC_DEV_OK) {
+        ESP_LOGE(TAG, "Codec open failed, video is played without audio");
+        handle->start_time = esp_timer_get_time() - avi_player_clock(handle);
+        handle->audio_clock = false;
+        return;
+    }
+    /* 8-bit PCM is unsigned */
+    memset(handle->silence, (fs.bits_per_sample == 8) ? 0x80 : 0, AVI_PLAYER_AUDIO_CHUNK);
+
+    while (!handle->stop) {
+        const bool reader_done = (xEventGroupGetBits(handle->events) & AVI_PLAYER_EV_READER_IDLE);
+        size_t len = 0;
+        uint8_t *item = xRingbufferReceiveUpTo(handle->audio_ring, &len, pdMS_TO_TICKS(AVI_PLAYER_UNDERRUN_MS), AVI_PLAYER_AUDIO_CHUNK);
+        if (item) {
+            /* Audio sent late is skipped, the audio stays in sync with the video */
+            const size_t skip = MIN(len, handle->silence_debt);
+            handle->silence_debt -= skip;
+            if (len > skip) {
+                esp_codec_dev_write(handle->codec, item + skip, len - skip);
+                handle->audio_bytes += len - skip;
+            }
+            vRingbufferReturnItem(handle->audio_ring, item);
+        } else if (reader_done) {
+            break;
+        } else {
+            /* Reader is late, the clock runs on with silence */
+            handle->stats.audio_underruns++;
+            esp_codec_dev_write(handle->codec, handle->silence, AVI_PLAYER_AUDIO_CHUNK);
+            handle->audio_bytes += AVI_PLAYER_AUDIO_CHUNK;
+            handle->silence_debt += AVI_PLAYER_AUDIO_CHUNK;
+        }
+    }
+
+    /* Video longer than audio continues by the system time */
+    handle->start_time = esp_timer_get_time() - avi_player_clock(handle);
+    handle->audio_clock = false;
+    esp_codec_dev_close(handle->codec);
+}
+
+/*******************************************************************************
+* Tasks
+*******************************************************************************/
+
+static void avi_player_reader_task(void *arg)
+{
+    avi_player_handle_t handle = (avi_player_handle_t)arg;
+
+    while (1) {
+        xEventGroupWaitBits(handle->events, AVI_PLAYER_EV_PLAY, pdTRUE, pdFALSE, portMAX_DELAY);
+        if (!handle->running) {
+            break;
+        }
+        avi_player_read_file(handle);
+        xEventGroupSetBits(handle->events, AVI_PLAYER_EV_READER_IDLE);
+    }
+
+    xEventGroupSetBits(handle->events, AVI_PLAYER_EV_READER_EXIT);
+    vTaskDelete(NULL);
+}
+
+static void avi_player_decoder_task(void *arg)
+{
+    avi_player_handle_t handle = (avi_player_handle_t)arg;
+
+    while (1) {
+        xEventGroupWaitBits(handle->events, AVI_PLAYER_EV_DECODE, pdTRUE, pdFALSE, portMAX_DELAY);
+        if (!handle->running) {
+            break;
+        }
+        avi_player_decode(handle);
+        xEventGroupSetBits(handle->events, AVI_PLAYER_EV_DECODER_IDLE);
+    }
+
+    xEventGroupSetBits(handle->events, AVI_PLAYER_EV_DECODER_EXIT);
+    vTaskDelete(NULL);
+}
+
+static void avi_player_display_task(void *arg)
+{
+    avi_player_handle_t handle = (avi_player_handle_t)arg;
+
+    while (1) {
+        xEventGroupWaitBits(handle->events, AVI_PLAYER_EV_DISPLAY, pdTRUE, pdFALSE, portMAX_DELAY);
+        if (!handle->running) {
+            break;
+        }
+        avi_player_display(handle);
+        xEventGroupWaitBits(handle->events, AVI_PLAYER_EV_READER_IDLE | AVI_PLAYER_EV_DECODER_IDLE | AVI_PLAYER_EV_AUDIO_IDLE, pdFALSE, pdTRUE, portMAX_DELAY);
+
+        /* Next file can be played from the callback */
+        xEventGroupSetBits(handle->events, AVI_PLAYER_EV_DISPLAY_IDLE);
+        if (handle->done_cb) {
+            handle->done_cb(handle->result, handle->user_ctx);
+        }
+    }
+
+    xEventGroupSetBits(handle->events, AVI_PLAYER_EV_DISPLAY_EXIT);
+    vTaskDelete(NULL);
+}
+
+static void avi_player_audio_task(void *arg)
+{
+    avi_player_handle_t handle = (avi_player_handle_t)arg;
+
+    while (1) {
+        xEventGroupWaitBits(handle->events, AVI_PLAYER_EV_AUDIO, pdTRUE, pdFALSE, portMAX_DELAY);
+        if (!handle->running) {
+            break;
+        }
+        avi_player_audio(handle);
+        xEventGroupSetBits(handle->events, AVI_PLAYER_EV_AUDIO_IDLE);
+    }
+
+    xEventGroupSetBits(handle->events, AVI_PLAYER_EV_AUDIO_EXIT);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t avi_player_task_create(TaskFunction_t task, const char *name, const avi_player_config_t *config, int priority, avi_player_handle_t handle)
+{
+    BaseType_t res;
+    if (config->task_affinity < 0) {
+        res = xTaskCreate(task, name, config->task_stack, handle, priority, NULL);
+    } else {
+        res = xTaskCreatePinnedToCore(task, name, config->task_stack, handle, priority, NULL, config->task_affinity);
+    }
+    return (res == pdPASS) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+/* Queues and buffers are reset to the initial state, all tasks are idle */
+static void avi_player_reset(avi_player_handle_t handle)
+{
+    xQueueReset(handle->jpeg_free);
+    xQueueReset(handle->jpeg_ready);
+    xQueueReset(handle->frame_free);
+    xQueueReset(handle->frame_ready);
+    for (uint8_t i = 0; i < AVI_PLAYER_JPEG_SLOTS; i++) {
+        xQueueSend(handle->jpeg_free, &i, 0);
+    }
+    for (uint8_t i = 0; i < handle->frame_cnt; i++) {
+        xQueueSend(handle->frame_free, &i, 0);
+    }
+    size_t len = 0;
+    void *item;
+    while ((item = xRingbufferReceiveUpTo(handle->audio_ring, &len, 0, handle->audio_ring_size)) != NULL) {
+        vRingbufferReturnItem(handle->audio_ring, item);
+    }
+}
+
+static void avi_player_free(avi_player_handle_t handle)
+{
+    if (handle->audio_ring) {
+        vRingbufferDelete(handle->audio_ring);
+    }
+    if (handle->events) {
+        vEventGroupDelete(handle->events);
+    }
+    QueueHandle_t queues[] = {handle->jpeg_free, handle->jpeg_ready, handle->frame_free, handle->frame_ready};
+    for (int i = 0; i < sizeof(queues) / sizeof(queues[0]); i++) {
+        if (queues[i]) {
+            vQueueDelete(queues[i]);
+        }
+    }
+#if AVI_PLAYER_HW_JPEG
+    if (handle->engine) {
+        jpeg_del_decoder_engine(handle->engine);
+    }
+#else
+    if (handle->decoder) {
+        jpeg_dec_close(handle->decoder);
+    }
+#endif
+    for (int i = 0; i < AVI_PLAYER_JPEG_SLOTS; i++) {
+        free(handle->jpegs[i].data);
+    }
+    for (int i = 0; i < handle->frame_cnt; i++) {
+        free(handle->frames[i]);
+    }
+    free(handle->file.buf);
+    free(handle->silence);
+    free(handle);
+}
+
+static esp_err_t avi_player_decoder_init(avi_player_handle_t handle)
+{
+#if AVI_PLAYER_HW_JPEG
+    handle->decode_cfg.output_format = JPEG_DECODE_OUT_FORMAT_RGB565;
+    handle->decode_cfg.rgb_order = JPEG_DEC_RGB_ELEMENT_ORDER_BGR;
+    handle->decode_cfg.conv_std = JPEG_YUV_RGB_CONV_STD_BT601;
+    const jpeg_decode_engine_cfg_t engine_cfg = {
+        .timeout_ms = 100,
+    };
+    ESP_RETURN_ON_ERROR(jpeg_new_decoder_engine(&engine_cfg, &handle->engine), TAG, "JPEG decoder engine create failed");
+#else
+    jpeg_dec_config_t dec_cfg = DEFAULT_JPEG_DEC_CONFIG();
+    dec_cfg.output_type = handle->swap_bytes ? JPEG_PIXEL_FORMAT_RGB565_BE : JPEG_PIXEL_FORMAT_RGB565_LE;
+    ESP_RETURN_ON_FALSE(jpeg_dec_open(&dec_cfg, &handle->decoder) == JPEG_ERR_OK, ESP_ERR_NO_MEM, TAG, "JPEG decoder open failed");
+#endif
+    return ESP_OK;
+}
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t avi_player_create(const avi_player_config_t *config, avi_player_handle_t *ret_handle)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(config && ret_handle && config->frame_cb, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->read_size > 0 && (config->read_size % AVI_PLAYER_READ_ALIGN) == 0, ESP_ERR_INVALID_ARG, TAG,
+                        "Read size must be multiple of %d", AVI_PLAYER_READ_ALIGN);
+    ESP_RETURN_ON_FALSE(config->frame_buffers >= 2 && config->frame_buffers <= AVI_PLAYER_FRAMES_MAX, ESP_ERR_INVALID_ARG, TAG,
+                        "Count of frame buffers must be 2 - %d", AVI_PLAYER_FRAMES_MAX);
+    ESP_RETURN_ON_FALSE(config->audio_ring_size >= 2 * AVI_PLAYER_AUDIO_CHUNK, ESP_ERR_INVALID_ARG, TAG, "Audio ring buffer is too small");
+
+    avi_player_handle_t handle = calloc(1, sizeof(struct avi_player_s));
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_NO_MEM, TAG, "Not enough memory for player");
+    handle->codec = config->codec;
+    handle->frame_cb = config->frame_cb;
+    handle->done_cb = config->done_cb;
+    handle->user_ctx = config->user_ctx;
+    handle->swap_bytes = config->flags.swap_bytes;
+    handle->buff_spiram = config->flags.buff_spiram;
+    handle->frame_cnt = config->frame_buffers;
+    handle->audio_ring_size = config->audio_ring_size;
+    handle->file.size = config->read_size;
+    handle->clock_lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
+
+    ESP_GOTO_ON_ERROR(avi_player_decoder_init(handle), err, TAG, "Decoder init failed");
+    handle->audio_ring = xRingbufferCreate(config->audio_ring_size, RINGBUF_TYPE_BYTEBUF);
+    ESP_GOTO_ON_FALSE(handle->audio_ring, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for ring buffer");
+    handle->events = xEventGroupCreate();
+    handle->jpeg_free = xQueueCreate(AVI_PLAYER_JPEG_SLOTS, sizeof(uint8_t));
+    handle->jpeg_ready = xQueueCreate(AVI_PLAYER_JPEG_SLOTS + 1, sizeof(avi_player_msg_t));
+    handle->frame_free = xQueueCreate(AVI_PLAYER_FRAMES_MAX, sizeof(uint8_t));
+    handle->frame_ready = xQueueCreate(AVI_PLAYER_FRAMES_MAX + 1, sizeof(avi_player_msg_t));
+    ESP_GOTO_ON_FALSE(handle->events && handle->jpeg_free && handle->jpeg_ready && handle->frame_free && handle->frame_ready, ESP_ERR_NO_MEM, err, TAG,
+                      "Not enough memory for queues");
+    /* SD card driver reads directly into word aligned DMA capable buffer */
+    handle->file.buf = heap_caps_aligned_alloc(4, config->read_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    handle->silence = malloc(AVI_PLAYER_AUDIO_CHUNK);
+    ESP_GOTO_ON_FALSE(handle->file.buf && handle->silence, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for buffers");
+    /* Exit bit is cleared for created task only, the tasks do not exit until running is cleared */
+    xEventGroupSetBits(handle->events, AVI_PLAYER_EV_ALL_IDLE | AVI_PLAYER_EV_ALL_EXIT);
+
+    handle->running = true;
+    ESP_GOTO_ON_ERROR(avi_player_task_create(avi_player_reader_task, "avi_reader", config, config->reader_priority, handle), err, TAG, "Create task failed");
+    xEventGroupClearBits(handle->events, AVI_PLAYER_EV_READER_EXIT);
+    ESP_GOTO_ON_ERROR(avi_player_task_create(avi_player_decoder_task, "avi_decoder", config, config->decoder_priority, handle), err, TAG, "Create task failed");
+    xEventGroupClearBits(handle->events, AVI_PLAYER_EV_DECODER_EXIT);
+    ESP_GOTO_ON_ERROR(avi_player_task_create(avi_player_display_task, "avi_display", config, config->display_priority, handle), err, TAG, "Create task failed");
+    xEventGroupClearBits(handle->events, AVI_PLAYER_EV_DISPLAY_EXIT);
+    ESP_GOTO_ON_ERROR(avi_player_task_create(avi_player_audio_task, "avi_audio", config, config->audio_priority, handle), err, TAG, "Create task failed");
+    xEventGroupClearBits(handle->events, AVI_PLAYER_EV_AUDIO_EXIT);
+
+    *ret_handle = handle;
+    return ESP_OK;
+
+err:
+    if (handle->events) {
+        /* Already created tasks exit */
+        handle->running = false;
+        xEventGroupSetBits(handle->events, AVI_PLAYER_EV_ALL_START);
+        xEventGroupWaitBits(handle->events, AVI_PLAYER_EV_ALL_EXIT, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+    avi_player_free(handle);
+    return ret;
+}
+
+esp_err_t avi_player_delete(avi_player_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    avi_player_stop(handle);
+    handle->running = false;
+    xEventGroupSetBits(handle->events, AVI_PLAYER_EV_ALL_START);
+    xEventGroupWaitBits(handle->events, AVI_PLAYER_EV_ALL_EXIT, pdFALSE, pdTRUE, portMAX_DELAY);
+    avi_player_free(handle);
+    return ESP_OK;
+}
+
+esp_err_t avi_player_play(avi_player_handle_t handle, const char *path)
+{
+    ESP_RETURN_ON_FALSE(handle && path, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(strlen(path) < AVI_PLAYER_PATH_MAX, ESP_ERR_INVALID_ARG, TAG, "Path is too long");
+
+    avi_player_stop(handle);
+    avi_player_reset(handle);
+    strcpy(handle->path, path);
+    handle->stop = false;
+    handle->result = ESP_OK;
+    handle->audio_clock = false;
+    handle->clock_started = false;
+    handle->audio_bytes = 0;
+    handle->silence_debt = 0;
+    memset(&handle->stats, 0, sizeof(avi_player_stats_t));
+
+    xEventGroupClearBits(handle->events, AVI_PLAYER_EV_ALL_IDLE);
+    xEventGroupSetBits(handle->events, AVI_PLAYER_EV_PLAY);
+    return ESP_OK;
+}
+
+esp_err_t avi_player_stop(avi_player_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    handle->stop = true;
+    xEventGroupWaitBits(handle->events, AVI_PLAYER_EV_ALL_IDLE, pdFALSE, pdTRUE, portMAX_DELAY);
+    /* Start bits of the stopped playback are not used anymore */
+    xEventGroupClearBits(handle->events, AVI_PLAYER_EV_ALL_START);
+    return ESP_OK;
+}
+
+esp_err_t avi_player_get_stats(avi_player_handle_t handle, avi_player_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(handle && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    *stats = handle->stats;
+    return ESP_OK;
+}
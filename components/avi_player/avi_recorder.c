@@ -0,0 +1,410 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "freertos/ringbuf.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "avi_recorder.h"
+
+static const char *TAG = "avi_recorder";
+
+/* Period of checking the end of recording, when the writer waits for frames */
+#define AVI_RECORDER_WAIT_MS        (50)
+#define AVI_RECORDER_SECTOR_SIZE    (512)
+/* Headers with JUNK padding, the movi data start on sector boundary */
+#define AVI_RECORDER_HEADER_SIZE    (AVI_RECORDER_SECTOR_SIZE)
+/* Offset of 'movi' fourcc, the index offsets are related to it */
+#define AVI_RECORDER_MOVI_POS       (AVI_RECORDER_HEADER_SIZE - 4)
+#define AVI_RECORDER_CHUNK_HDR      (8)
+#define AVI_RECORDER_IDX_ENTRY      (16)
+#define AVI_RECORDER_AVIF_HASINDEX  (0x10)
+#define AVI_RECORDER_AVIIF_KEYFRAME (0x10)
+
+#define AVI_RECORDER_EV_WRITER_DONE BIT0
+
+/* Index entry of one stored frame */
+typedef struct {
+    uint32_t offset;                        /* Offset of the chunk header from 'movi' fourcc */
+    uint32_t size;                          /* Size of the JPEG frame */
+} avi_recorder_idx_t;
+
+struct avi_recorder_s {
+    avi_recorder_config_t config;
+    RingbufHandle_t ring;                   /* JPEG frames waiting for storage (one item per frame) */
+    StaticRingbuffer_t *ring_struct;
+    uint8_t *ring_storage;
+    EventGroupHandle_t events;
+    avi_recorder_idx_t *index;              /* Stored frames */
+    uint32_t queued;                        /* Frames passed to the ring buffer (index entries reserved) */
+    uint8_t *block;                         /* One file write */
+    size_t fill;                            /* Bytes in the block */
+    uint32_t data_size;                     /* Bytes passed to the file (with header) */
+    bool write_ok;
+    FILE *f;
+    uint32_t width;
+    uint32_t height;
+    uint32_t fps;
+    int64_t start_time;
+    esp_err_t result;
+    avi_recorder_stats_t stats;
+    volatile bool stop;
+    bool recording;
+};
+
+static inline void avi_recorder_put_le16(uint8_t *data, uint16_t value)
+{
+    data[0] = value & 0xFF;
+    data[1] = value >> 8;
+}
+
+static inline void avi_recorder_put_le32(uint8_t *data, uint32_t value)
+{
+    data[0] = value & 0xFF;
+    data[1] = (value >> 8) & 0xFF;
+    data[2] = (value >> 16) & 0xFF;
+    data[3] = value >> 24;
+}
+
+static inline void avi_recorder_put_chunk(uint8_t *data, const char *fourcc, uint32_t size)
+{
+    memcpy(data, fourcc, 4);
+    avi_recorder_put_le32(&data[4], size);
+}
+
+/*
+ * RIFF 'AVI ' header with one MJPEG stream: hdrl list (avih, strl list with strh and strf), JUNK padding to the sector
+ * boundary and movi list header. Sizes and counts are zero during recording and they are updated at the end.
+ */
+static void avi_recorder_fill_header(avi_recorder_handle_t handle, uint8_t *hdr, uint32_t file_size, uint32_t movi_size)
+{
+    const uint32_t frames = handle->stats.frame_cnt;
+    const uint32_t max_frame = handle->stats.frame_size_max;
+
+    memset(hdr, 0, AVI_RECORDER_HEADER_SIZE);
+    avi_recorder_put_chunk(&hdr[0], "RIFF", file_size ? file_size - 8 : 0);
+    memcpy(&hdr[8], "AVI ", 4);
+    avi_recorder_put_chunk(&hdr[12], "LIST", 4 + 64 + 12 + 64 + 48);
+    memcpy(&hdr[20], "hdrl", 4);
+
+    uint8_t *avih = &hdr[24];
+    avi_recorder_put_chunk(avih, "avih", 56);
+    avi_recorder_put_le32(&avih[8], 1000000 / handle->fps);
+    avi_recorder_put_le32(&avih[12], max_frame * handle->fps);
+    avi_recorder_put_le32(&avih[20], AVI_RECORDER_AVIF_HASINDEX);
+    avi_recorder_put_le32(&avih[24], frames);
+    avi_recorder_put_le32(&avih[32], 1);
+    avi_recorder_put_le32(&avih[36], max_frame);
+    avi_recorder_put_le32(&avih[40], handle->width);
+    avi_recorder_put_le32(&avih[44], handle->height);
+
+    avi_recorder_put_chunk(&hdr[88], "LIST", 4 + 64 + 48);
+    memcpy(&hdr[96], "strl", 4);
+    uint8_t *strh = &hdr[100];
+    avi_recorder_put_chunk(strh, "strh", 56);
+    memcpy(&strh[8], "vids", 4);
+    memcpy(&strh[12], "MJPG", 4);
+    avi_recorder_put_le32(&strh[28], 1);
+    avi_recorder_put_le32(&strh[32], handle->fps);
+    avi_recorder_put_le32(&strh[40], frames);
+    avi_recorder_put_le32(&strh[44], max_frame);
+    avi_recorder_put_le32(&strh[48], UINT32_MAX);
+    avi_recorder_put_le16(&strh[60], handle->width);
+    avi_recorder_put_le16(&strh[62], handle->height);
+
+    uint8_t *strf = &hdr[164];
+    avi_recorder_put_chunk(strf, "strf", 40);
+    avi_recorder_put_le32(&strf[8], 40);
+    avi_recorder_put_le32(&strf[12], handle->width);
+    avi_recorder_put_le32(&strf[16], handle->height);
+    avi_recorder_put_le16(&strf[20], 1);
+    avi_recorder_put_le16(&strf[22], 24);
+    memcpy(&strf[24], "MJPG", 4);
+    avi_recorder_put_le32(&strf[28], handle->width * handle->height * 3);
+
+    avi_recorder_put_chunk(&hdr[212], "JUNK", AVI_RECORDER_MOVI_POS - 8 - 220);
+    avi_recorder_put_chunk(&hdr[AVI_RECORDER_MOVI_POS - 8], "LIST", movi_size);
+    memcpy(&hdr[AVI_RECORDER_MOVI_POS], "movi", 4);
+}
+
+static bool avi_recorder_write_block(avi_recorder_handle_t handle, size_t len)
+{
+    const int64_t start = esp_timer_get_time();
+    const size_t written = fwrite(handle->block, 1, len, handle->f);
+    const int64_t end = esp_timer_get_time();
+    handle->stats.write_time_max = MAX(handle->stats.write_time_max, (uint32_t)(end - start));
+    if (written != len) {
+        ESP_LOGE(TAG, "File write failed (storage full?)");
+        handle->result = ESP_FAIL;
+        handle->stop = true;
+        return false;
+    }
+    handle->stats.bytes_written += len;
+    if (end > handle->start_time) {
+        handle->stats.throughput = (uint64_t)handle->stats.bytes_written * 1000000 / (end - handle->start_time);
+    }
+    return true;
+}
+
+static void avi_recorder_store(avi_recorder_handle_t handle, const uint8_t *data, size_t len)
+{
+    const size_t block_size = handle->config.block_size;
+
+    while (len > 0) {
+        const size_t n = MIN(len, block_size - handle->fill);
+        memcpy(&handle->block[handle->fill], data, n);
+        handle->fill += n;
+        data += n;
+        len -= n;
+        if (handle->fill == block_size) {
+            /* After a write error the data is only drained */
+            handle->write_ok = handle->write_ok && avi_recorder_write_block(handle, block_size);
+            handle->data_size += block_size;
+            handle->fill = 0;
+        }
+    }
+}
+
+static void avi_recorder_store_frame(avi_recorder_handle_t handle, const uint8_t *jpeg, size_t len)
+{
+    uint8_t chunk[AVI_RECORDER_CHUNK_HDR];
+    const uint8_t pad = 0;
+
+    handle->index[handle->stats.frame_cnt].offset = handle->data_size + handle->fill - AVI_RECORDER_MOVI_POS;
+    handle->index[handle->stats.frame_cnt].size = len;
+    handle->stats.frame_cnt++;
+
+    avi_recorder_put_chunk(chunk, "00dc", len);
+    avi_recorder_store(handle, chunk, sizeof(chunk));
+    avi_recorder_store(handle, jpeg, len);
+    /* Chunks are word aligned */
+    if (len & 1) {
+        avi_recorder_store(handle, &pad, 1);
+    }
+}
+
+static void avi_recorder_store_index(avi_recorder_handle_t handle)
+{
+    uint8_t entry[AVI_RECORDER_IDX_ENTRY];
+
+    avi_recorder_put_chunk(entry, "idx1", handle->stats.frame_cnt * AVI_RECORDER_IDX_ENTRY);
+    avi_recorder_store(handle, entry, AVI_RECORDER_CHUNK_HDR);
+    for (uint32_t i = 0; i < handle->stats.frame_cnt; i++) {
+        avi_recorder_put_chunk(entry, "00dc", AVI_RECORDER_AVIIF_KEYFRAME);
+        avi_recorder_put_le32(&entry[8], handle->index[i].offset);
+        avi_recorder_put_le32(&entry[12], handle->index[i].size);
+        avi_recorder_store(handle, entry, AVI_RECORDER_IDX_ENTRY);
+    }
+}
+
+static void avi_recorder_writer_task(void *arg)
+{
+    avi_recorder_handle_t handle = (avi_recorder_handle_t)arg;
+
+    /* Header is the start of the first block, so all blocks are written on sector boundaries */
+    avi_recorder_fill_header(handle, handle->block, 0, 0);
+    handle->fill = AVI_RECORDER_HEADER_SIZE;
+    handle->data_size = 0;
+    handle->write_ok = true;
+
+    while (1) {
+        size_t len = 0;
+        void *item = xRingbufferReceive(handle->ring, &len, pdMS_TO_TICKS(AVI_RECORDER_WAIT_MS));
+        if (item) {
+            avi_recorder_store_frame(handle, item, len);
+            vRingbufferReturnItem(handle->ring, item);
+        } else if (handle->stop) {
+            break;
+        }
+    }
+
+    /* Index follows the movi list, then the sizes in the header are known */
+    const uint32_t movi_end = handle->data_size + handle->fill;
+    avi_recorder_store_index(handle);
+    if (handle->fill > 0 && handle->write_ok) {
+        handle->write_ok = avi_recorder_write_block(handle, handle->fill);
+        handle->data_size += handle->fill;
+    }
+    if (handle->write_ok) {
+        avi_recorder_fill_header(handle, handle->block, handle->data_size, movi_end - AVI_RECORDER_MOVI_POS);
+        if (fseek(handle->f, 0, SEEK_SET) != 0 || fwrite(handle->block, 1, AVI_RECORDER_HEADER_SIZE, handle->f) != AVI_RECORDER_HEADER_SIZE) {
+            ESP_LOGE(TAG, "AVI header update failed");
+            handle->result = ESP_FAIL;
+        }
+    }
+    if (fclose(handle->f) != 0) {
+        handle->result = ESP_FAIL;
+    }
+    handle->f = NULL;
+
+    xEventGroupSetBits(handle->events, AVI_RECORDER_EV_WRITER_DONE);
+    vTaskDelete(NULL);
+}
+
+static void avi_recorder_free(avi_recorder_handle_t handle)
+{
+    if (handle->ring) {
+        vRingbufferDelete(handle->ring);
+    }
+    if (handle->events) {
+        vEventGroupDelete(handle->events);
+    }
+    free(handle->ring_struct);
+    free(handle->ring_storage);
+    free(handle->index);
+    free(handle->block);
+    free(handle);
+}
+
+esp_err_t avi_recorder_create(const avi_recorder_config_t *config, avi_recorder_handle_t *ret_handle)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(config && ret_handle && config->max_frames > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->block_size > 0 && (config->block_size % AVI_RECORDER_SECTOR_SIZE) == 0, ESP_ERR_INVALID_ARG, TAG,
+                        "Block size must be multiple of %d", AVI_RECORDER_SECTOR_SIZE);
+    ESP_RETURN_ON_FALSE(config->ring_size >= 2 * config->block_size, ESP_ERR_INVALID_ARG, TAG, "Ring buffer must hold at least two blocks");
+
+    avi_recorder_handle_t handle = calloc(1, sizeof(struct avi_recorder_s));
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_NO_MEM, TAG, "Not enough memory for recorder");
+    handle->config = *config;
+
+    /* Several JPEG frames must fit into the ring buffer to survive SD card stalls, it is too big for internal RAM */
+    const uint32_t ring_caps = config->flags.ring_spiram ? MALLOC_CAP_SPIRAM : MALLOC_CAP_INTERNAL;
+    handle->ring_storage = heap_caps_malloc(config->ring_size, ring_caps | MALLOC_CAP_8BIT);
+    handle->ring_struct = heap_caps_calloc(1, sizeof(StaticRingbuffer_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    ESP_GOTO_ON_FALSE(handle->ring_storage && handle->ring_struct, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for ring buffer");
+    handle->ring = xRingbufferCreateStatic(config->ring_size, RINGBUF_TYPE_NOSPLIT, handle->ring_storage, handle->ring_struct);
+    ESP_GOTO_ON_FALSE(handle->ring, ESP_ERR_NO_MEM, err, TAG, "Ring buffer create failed");
+    handle->events = xEventGroupCreate();
+    ESP_GOTO_ON_FALSE(handle->events, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for event group");
+    handle->index = heap_caps_malloc(config->max_frames * sizeof(avi_recorder_idx_t), ring_caps | MALLOC_CAP_8BIT);
+    /* Internal DMA capable block can be passed to SD card driver without copying */
+    handle->block = heap_caps_malloc(config->block_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    ESP_GOTO_ON_FALSE(handle->index && handle->block, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for buffers");
+    xEventGroupSetBits(handle->events, AVI_RECORDER_EV_WRITER_DONE);
+
+    *ret_handle = handle;
+    return ESP_OK;
+
+err:
+    avi_recorder_free(handle);
+    return ret;
+}
+
+esp_err_t avi_recorder_delete(avi_recorder_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    avi_recorder_stop(handle);
+    avi_recorder_free(handle);
+    return ESP_OK;
+}
+
+esp_err_t avi_recorder_start(avi_recorder_handle_t handle, const char *path, uint32_t width, uint32_t height, uint32_t fps)
+{
+    ESP_RETURN_ON_FALSE(handle && path && width > 0 && height > 0 && width <= UINT16_MAX && height <= UINT16_MAX && fps > 0,
+                        ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(!handle->recording, ESP_ERR_INVALID_STATE, TAG, "Recording is already running");
+
+    handle->f = fopen(path, "wb");
+    ESP_RETURN_ON_FALSE(handle->f, ESP_ERR_NOT_FOUND, TAG, "File %s cannot be created", path);
+    /* The blocks are written directly, without copying to stdio buffer */
+    setvbuf(handle->f, NULL, _IONBF, 0);
+
+    handle->width = width;
+    handle->height = height;
+    handle->fps = fps;
+    handle->queued = 0;
+    handle->stop = false;
+    handle->result = ESP_OK;
+    handle->start_time = esp_timer_get_time();
+    memset(&handle->stats, 0, sizeof(avi_recorder_stats_t));
+    xEventGroupClearBits(handle->events, AVI_RECORDER_EV_WRITER_DONE);
+
+    BaseType_t res;
+    if (handle->config.task_affinity < 0) {
+        res = xTaskCreate(avi_recorder_writer_task, "avi_rec_writer", handle->config.task_stack, handle, handle->config.writer_priority, NULL);
+    } else {
+        res = xTaskCreatePinnedToCore(avi_recorder_writer_task, "avi_rec_writer", handle->config.task_stack, handle,
+                                      handle->config.writer_priority, NULL, handle->config.task_affinity);
+    }
+    if (res != pdPASS) {
+        xEventGroupSetBits(handle->events, AVI_RECORDER_EV_WRITER_DONE);
+        fclose(handle->f);
+        handle->f = NULL;
+        ESP_LOGE(TAG, "Create task failed");
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Recording %s: %" PRIu32 "x%" PRIu32 ", %" PRIu32 " fps", path, width, height, fps);
+    handle->recording = true;
+    return ESP_OK;
+}
+
+esp_err_t avi_recorder_write_frame(avi_recorder_handle_t handle, const void *jpeg, size_t len)
+{
+    ESP_RETURN_ON_FALSE(handle && jpeg && len > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    if (!handle->recording || handle->stop) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* Never wait for the storage, the camera would drop frames instead */
+    if (handle->queued >= handle->config.max_frames || xRingbufferSend(handle->ring, jpeg, len, 0) != pdTRUE) {
+        handle->stats.drop_cnt++;
+        return ESP_ERR_NO_MEM;
+    }
+    handle->queued++;
+    handle->stats.frame_size_max = MAX(handle->stats.frame_size_max, len);
+    const uint32_t level = handle->config.ring_size - xRingbufferGetCurFreeSize(handle->ring);
+    handle->stats.ring_level_max = MAX(handle->stats.ring_level_max, level);
+    return ESP_OK;
+}
+
+esp_err_t avi_recorder_stop(avi_recorder_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    if (!handle->recording) {
+        return ESP_OK;
+    }
+    handle->stop = true;
+    xEventGroupWaitBits(handle->events, AVI_RECORDER_EV_WRITER_DONE, pdFALSE, pdTRUE, portMAX_DELAY);
+    handle->recording = false;
+
+    /* Frame added by other task during the stop is not in the file */
+    size_t len;
+    void *item;
+    while ((item = xRingbufferReceive(handle->ring, &len, 0)) != NULL) {
+        vRingbufferReturnItem(handle->ring, item);
+    }
+
+    if (handle->stats.drop_cnt > 0) {
+        ESP_LOGW(TAG, "%" PRIu32 " frames were dropped, storage was too slow (longest write %" PRIu32 " us)",
+                 handle->stats.drop_cnt, handle->stats.write_time_max);
+    }
+    return handle->result;
+}
+
+bool avi_recorder_is_recording(avi_recorder_handle_t handle)
+{
+    return handle && handle->recording && !handle->stop;
+}
+
+esp_err_t avi_recorder_get_stats(avi_recorder_handle_t handle, avi_recorder_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(handle && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    *stats = handle->stats;
+    return ESP_OK;
+}
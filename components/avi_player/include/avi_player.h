@@ -0,0 +1,183 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief MJPEG AVI player
+ *
+ * A reader task reads the AVI file in large aligned blocks and splits it into JPEG frames and PCM audio.
+ * A decoder task decodes the frames into a ring of frame buffers and a display task passes them to the
+ * application at their presentation time. The audio output is the clock of the playback.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_codec_dev.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Decoded video frame
+ */
+typedef struct {
+    const uint16_t *data;               /*!< RGB565 pixels (big endian with `swap_bytes`) */
+    uint32_t width;                     /*!< Width of the video [px] */
+    uint32_t height;                    /*!< Height of the video [px] */
+    uint32_t stride;                    /*!< Distance of the rows [px], can be bigger than width (MCU alignment) */
+    uint32_t index;                     /*!< Index of the frame in the file */
+} avi_player_frame_t;
+
+/**
+ * @brief Callback of the frame to be displayed (e.g. `esp_lcd_panel_draw_bitmap` or LVGL image update)
+ *
+ * @note It is called from the display task at the presentation time of the frame.
+ * @note The frame data are valid until the next call of the callback returns, so they can be sent by DMA.
+ *
+ * @param frame     Decoded frame
+ * @param user_ctx  User data from the configuration
+ */
+typedef void (*avi_player_frame_cb_t)(const avi_player_frame_t *frame, void *user_ctx);
+
+/**
+ * @brief Callback of finished playback
+ *
+ * @note It is called from the display task
+ *
+ * @param result    ESP_OK when the file was played to the end or stopped, error code otherwise
+ * @param user_ctx  User data from the configuration
+ */
+typedef void (*avi_player_done_cb_t)(esp_err_t result, void *user_ctx);
+
+/**
+ * @brief AVI player configuration
+ */
+typedef struct {
+    esp_codec_dev_handle_t codec;       /*!< Speaker codec device (e.g. from `bsp_audio_codec_speaker_init`), NULL: video only */
+    avi_player_frame_cb_t frame_cb;     /*!< Callback of the frame to be displayed */
+    avi_player_done_cb_t done_cb;       /*!< Callback of finished playback (can be NULL) */
+    void *user_ctx;                     /*!< User data for the callbacks */
+    size_t read_size;                   /*!< Size of one file read [bytes], multiple of 512 */
+    size_t audio_ring_size;             /*!< Size of the audio ring buffer [bytes] */
+    uint8_t frame_buffers;              /*!< Count of decoded frame buffers (2 - 4), one is displayed while the next ones are decoded */
+    int reader_priority;                /*!< Priority of the reader task */
+    int decoder_priority;               /*!< Priority of the decoder task */
+    int display_priority;               /*!< Priority of the display task */
+    int audio_priority;                 /*!< Priority of the audio task (should be the highest) */
+    int task_stack;                     /*!< Stack size of each task [bytes] */
+    int task_affinity;                  /*!< Core of the tasks (-1 for no affinity) */
+    struct {
+        unsigned int swap_bytes: 1;     /*!< Frames in big endian RGB565 (SPI and I80 panels) */
+        unsigned int buff_spiram: 1;    /*!< Frame buffers and JPEG buffers in PSRAM */
+    } flags;
+} avi_player_config_t;
+
+/**
+ * @brief Default AVI player configuration
+ */
+#define AVI_PLAYER_CONFIG_DEFAULT(codec_dev, frame_callback)    \
+    {                                           \
+        .codec = (codec_dev),                   \
+        .frame_cb = (frame_callback),           \
+        .read_size = 16 * 1024,                 \
+        .audio_ring_size = 32 * 1024,           \
+        .frame_buffers = 3,                     \
+        .reader_priority = 4,                   \
+        .decoder_priority = 5,                  \
+        .display_priority = 6,                  \
+        .audio_priority = 7,                    \
+        .task_stack = 4096,                     \
+        .task_affinity = -1,                    \
+        .flags = {                              \
+            .buff_spiram = 1,                   \
+        },                                      \
+    }
+
+/**
+ * @brief AVI player statistics (since the last start of playback)
+ */
+typedef struct {
+    uint32_t frames_displayed;          /*!< Count of displayed frames */
+    uint32_t frames_dropped;            /*!< Count of frames skipped without decoding, because the decoder was late */
+    uint32_t frames_late;               /*!< Count of frames displayed more than one frame period after their time */
+    uint32_t decode_time_max;           /*!< Longest decoding of one frame [us] */
+    uint32_t read_time_max;             /*!< Longest file read [us] */
+    uint32_t audio_underruns;           /*!< Count of audio writes, when the ring buffer was empty (silence was sent instead) */
+    int32_t av_offset_max;              /*!< Largest difference of display time and presentation time of a frame [us] */
+} avi_player_stats_t;
+
+/**
+ * @brief AVI player handle
+ */
+typedef struct avi_player_s *avi_player_handle_t;
+
+/**
+ * @brief Create AVI player
+ *
+ * @param config        Configuration
+ * @param ret_handle    Created player
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if there is no memory for the player
+ */
+esp_err_t avi_player_create(const avi_player_config_t *config, avi_player_handle_t *ret_handle);
+
+/**
+ * @brief Delete AVI player
+ *
+ * @note Playing file is stopped
+ *
+ * @param handle    Player
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t avi_player_delete(avi_player_handle_t handle);
+
+/**
+ * @brief Start playing AVI file
+ *
+ * @note Playing file is stopped first.
+ * @note Only MJPEG video and PCM audio streams are supported. Files without audio stream are played by the system time.
+ *
+ * @param handle    Player
+ * @param path      Path to the AVI file
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t avi_player_play(avi_player_handle_t handle, const char *path);
+
+/**
+ * @brief Stop playing and wait until all tasks are idle
+ *
+ * @param handle    Player
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t avi_player_stop(avi_player_handle_t handle);
+
+/**
+ * @brief Get playback statistics
+ *
+ * @param handle    Player
+ * @param stats     Output statistics
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t avi_player_get_stats(avi_player_handle_t handle, avi_player_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
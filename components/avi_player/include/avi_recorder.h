@@ -0,0 +1,165 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief MJPEG AVI recorder with ring buffer between encoder and storage
+ *
+ * JPEG frames (e.g. from the hardware JPEG encoder or a camera in JPEG mode) are copied into a ring buffer and never
+ * wait for the storage. A writer task stores the frames in large blocks aligned to sectors and the AVI index is written,
+ * when the recording is stopped.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief AVI recorder configuration
+ */
+typedef struct {
+    size_t ring_size;                   /*!< Size of the ring buffer of JPEG frames waiting for storage [bytes] */
+    size_t block_size;                  /*!< Size of one file write, multiple of 512 (sector) [bytes] */
+    uint32_t max_frames;                /*!< Maximum count of frames in one file (size of the index, 8 bytes per frame) */
+    int writer_priority;                /*!< Priority of the writer task */
+    int task_stack;                     /*!< Stack size of the writer task [bytes] */
+    int task_affinity;                  /*!< Core of the writer task (-1 for no affinity) */
+    struct {
+        unsigned int ring_spiram: 1;    /*!< Ring buffer and the index are allocated in PSRAM */
+    } flags;
+} avi_recorder_config_t;
+
+/**
+ * @brief Default AVI recorder configuration
+ */
+#define AVI_RECORDER_CONFIG_DEFAULT()           \
+    {                                           \
+        .ring_size = 1024 * 1024,               \
+        .block_size = 32 * 1024,                \
+        .max_frames = 18000,                    \
+        .writer_priority = 5,                   \
+        .task_stack = 4096,                     \
+        .task_affinity = -1,                    \
+        .flags = {                              \
+            .ring_spiram = 1,                   \
+        },                                      \
+    }
+
+/**
+ * @brief AVI recorder statistics (of the current or the last recording)
+ */
+typedef struct {
+    uint32_t frame_cnt;                 /*!< Frames stored in the file */
+    uint32_t drop_cnt;                  /*!< Frames dropped, because the ring buffer was full or the index is full */
+    uint32_t frame_size_max;            /*!< The largest JPEG frame [bytes] */
+    uint32_t write_time_max;            /*!< Longest file write of one block [us] */
+    uint32_t ring_level_max;            /*!< Highest count of bytes waiting for storage */
+    uint32_t bytes_written;             /*!< Bytes written into the file */
+    uint32_t throughput;                /*!< Average write throughput since the start [bytes/s] */
+} avi_recorder_stats_t;
+
+/**
+ * @brief AVI recorder handle
+ */
+typedef struct avi_recorder_s *avi_recorder_handle_t;
+
+/**
+ * @brief Create AVI recorder
+ *
+ * @param config        Configuration
+ * @param ret_handle    Created recorder
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if there is no memory for the recorder
+ */
+esp_err_t avi_recorder_create(const avi_recorder_config_t *config, avi_recorder_handle_t *ret_handle);
+
+/**
+ * @brief Delete AVI recorder
+ *
+ * @note Running recording is stopped
+ *
+ * @param handle    Recorder
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t avi_recorder_delete(avi_recorder_handle_t handle);
+
+/**
+ * @brief Start recording of MJPEG video into AVI file
+ *
+ * @param handle    Recorder
+ * @param path      Path to the created AVI file
+ * @param width     Width of the frames [px]
+ * @param height    Height of the frames [px]
+ * @param fps       Frame rate written into the file, the frames are played at this rate
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_INVALID_STATE if the recording is already running
+ *      - ESP_ERR_NOT_FOUND     if the file cannot be created
+ *      - ESP_ERR_NO_MEM        if the writer task cannot be created
+ */
+esp_err_t avi_recorder_start(avi_recorder_handle_t handle, const char *path, uint32_t width, uint32_t height, uint32_t fps);
+
+/**
+ * @brief Add one JPEG frame to the recording
+ *
+ * The frame is copied into the ring buffer, this function does not wait for the storage.
+ *
+ * @param handle    Recorder
+ * @param jpeg      JPEG image
+ * @param len       Size of the JPEG image [bytes]
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_INVALID_STATE if the recording is not running (or it was stopped by a write error)
+ *      - ESP_ERR_NO_MEM        if the frame was dropped (the storage is behind or the index is full)
+ */
+esp_err_t avi_recorder_write_frame(avi_recorder_handle_t handle, const void *jpeg, size_t len);
+
+/**
+ * @brief Stop recording, store buffered frames and write the index and the final AVI header
+ *
+ * @param handle    Recorder
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_FAIL              if writing of the file failed during recording
+ */
+esp_err_t avi_recorder_stop(avi_recorder_handle_t handle);
+
+/**
+ * @brief Check, if the recorder is recording
+ *
+ * @param handle    Recorder
+ * @return true, if a recording is running
+ */
+bool avi_recorder_is_recording(avi_recorder_handle_t handle);
+
+/**
+ * @brief Get statistics of the recording
+ *
+ * @param handle    Recorder
+ * @param stats     Output statistics
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t avi_recorder_get_stats(avi_recorder_handle_t handle, avi_recorder_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,98 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include "unity.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "avi_player.h"
+#include "avi_recorder.h"
+
+static SemaphoreHandle_t done;
+static esp_err_t done_result;
+static uint32_t frames;
+
+static void frame_cb(const avi_player_frame_t *frame, void *user_ctx)
+{
+    frames++;
+}
+
+static void done_cb(esp_err_t result, void *user_ctx)
+{
+    done_result = result;
+    xSemaphoreGive(done);
+}
+
+TEST_CASE("AVI player missing file test", "[avi_player]")
+{
+    /* Frame buffers are not allocated and the codec is not opened, when the file cannot be read */
+    avi_player_handle_t player = NULL;
+
+    done = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(done);
+
+    avi_player_config_t config = AVI_PLAYER_CONFIG_DEFAULT(NULL, NULL);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, avi_player_create(&config, &player));
+
+    config.frame_cb = frame_cb;
+    config.read_size = 1000;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, avi_player_create(&config, &player));
+
+    config.read_size = 4096;
+    config.frame_buffers = 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, avi_player_create(&config, &player));
+
+    config.frame_buffers = 2;
+    config.done_cb = done_cb;
+    TEST_ASSERT_EQUAL(ESP_OK, avi_player_create(&config, &player));
+
+    TEST_ASSERT_EQUAL(ESP_OK, avi_player_play(player, "/not_existing/video.avi"));
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(done, pdMS_TO_TICKS(1000)));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, done_result);
+    TEST_ASSERT_EQUAL(ESP_OK, avi_player_stop(player));
+
+    avi_player_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, avi_player_get_stats(player, &stats));
+    TEST_ASSERT_EQUAL(0, stats.frames_displayed);
+    TEST_ASSERT_EQUAL(0, frames);
+
+    TEST_ASSERT_EQUAL(ESP_OK, avi_player_delete(player));
+    vSemaphoreDelete(done);
+}
+
+TEST_CASE("AVI recorder invalid arguments test", "[avi_recorder]")
+{
+    /* Frames are not accepted, when the file cannot be created */
+    avi_recorder_handle_t recorder = NULL;
+    const uint8_t jpeg[] = {0xFF, 0xD8, 0xFF, 0xD9};
+
+    avi_recorder_config_t config = AVI_RECORDER_CONFIG_DEFAULT();
+    config.flags.ring_spiram = 0;
+    config.block_size = 4000;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, avi_recorder_create(&config, &recorder));
+
+    config.block_size = 4096;
+    config.ring_size = 4096;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, avi_recorder_create(&config, &recorder));
+
+    config.ring_size = 16 * 1024;
+    config.max_frames = 100;
+    TEST_ASSERT_EQUAL(ESP_OK, avi_recorder_create(&config, &recorder));
+    TEST_ASSERT_FALSE(avi_recorder_is_recording(recorder));
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, avi_recorder_start(recorder, "/not_existing/video.avi", 320, 240, 0));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, avi_recorder_start(recorder, "/not_existing/video.avi", 320, 240, 15));
+    TEST_ASSERT_FALSE(avi_recorder_is_recording(recorder));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, avi_recorder_write_frame(recorder, jpeg, sizeof(jpeg)));
+    TEST_ASSERT_EQUAL(ESP_OK, avi_recorder_stop(recorder));
+
+    avi_recorder_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, avi_recorder_get_stats(recorder, &stats));
+    TEST_ASSERT_EQUAL(0, stats.frame_cnt);
+    TEST_ASSERT_EQUAL(0, stats.bytes_written);
+
+    TEST_ASSERT_EQUAL(ESP_OK, avi_recorder_delete(recorder));
+}
@@ -6,6 +6,7 @@
 
 #include <stdio.h>
 #include "driver/i2c.h"
+#include "esp_timer.h"
 #include "bh1750.h"
 
 #define BH_1750_MEASUREMENT_ACCURACY    1.2    /*!< the typical measurement accuracy of  BH1750 sensor */
@@ -13,16 +14,28 @@
 #define BH1750_POWER_DOWN        0x00    /*!< Command to set Power Down*/
 #define BH1750_POWER_ON          0x01    /*!< Command to set Power On*/
 
+#define BH1750_MEASURE_TIME_DEFAULT     69      /*!< Default value of MTreg */
+#define BH1750_CONV_TIME_H_RES_US       180000  /*!< Max. measurement time of H-Resolution modes with default MTreg */
+#define BH1750_CONV_TIME_L_RES_US       24000   /*!< Max. measurement time of L-Resolution mode with default MTreg */
+
 typedef struct {
     i2c_port_t bus;
     uint16_t dev_addr;
+    uint8_t cmd_buf[I2C_LINK_RECOMMENDED_SIZE(2)]; /* Command link of the device, no heap allocation per access */
+    uint8_t measure_time;           /* MTreg value, scales the measurement time */
+    bh1750_measure_mode_t mode;
+    bool measuring;                 /* Measurement started by bh1750_start_measurement */
+    int64_t ready_time;             /* esp_timer time [us] when the measurement is finished */
+    esp_timer_handle_t timer;       /* Created on first use of bh1750_start_measurement_cb */
+    bh1750_data_cb_t data_cb;
+    void *user_ctx;
 } bh1750_dev_t;
 
-static esp_err_t bh1750_write_byte(const bh1750_dev_t *const sens, const uint8_t byte)
+static esp_err_t bh1750_write_byte(bh1750_dev_t *const sens, const uint8_t byte)
 {
     esp_err_t ret;
 
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(sens->cmd_buf, sizeof(sens->cmd_buf));
     ret = i2c_master_start(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_write_byte(cmd, sens->dev_addr | I2C_MASTER_WRITE, true);
@@ -32,7 +45,7 @@ static esp_err_t bh1750_write_byte(const bh1750_dev_t *const sens, const uint8_t
     ret = i2c_master_stop(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_cmd_begin(sens->bus, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
+    i2c_cmd_link_delete_static(cmd);
 
     return ret;
 }
@@ -42,12 +55,17 @@ bh1750_handle_t bh1750_create(i2c_port_t port, const uint16_t dev_addr)
     bh1750_dev_t *sensor = (bh1750_dev_t *) calloc(1, sizeof(bh1750_dev_t));
     sensor->bus = port;
     sensor->dev_addr = dev_addr << 1;
+    sensor->measure_time = BH1750_MEASURE_TIME_DEFAULT;
     return (bh1750_handle_t) sensor;
 }
 
 esp_err_t bh1750_delete(bh1750_handle_t sensor)
 {
     bh1750_dev_t *sens = (bh1750_dev_t *) sensor;
+    if (sens->timer) {
+        esp_timer_stop(sens->timer);
+        esp_timer_delete(sens->timer);
+    }
     free(sens);
     return ESP_OK;
 }
@@ -77,6 +95,7 @@ esp_err_t bh1750_set_measure_time(bh1750_handle_t sensor, const uint8_t measure_
             return ret;
         }
     }
+    sens->measure_time = measure_time;
     return ESP_OK;
 }
 
@@ -92,7 +111,7 @@ esp_err_t bh1750_get_data(bh1750_handle_t sensor, float *const data)
     uint8_t bh1750_data_h, bh1750_data_l;
     bh1750_dev_t *sens = (bh1750_dev_t *) sensor;
 
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(sens->cmd_buf, sizeof(sens->cmd_buf));
     ret = i2c_master_start(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_write_byte(cmd, sens->dev_addr | I2C_MASTER_READ, true);
@@ -104,10 +123,92 @@ esp_err_t bh1750_get_data(bh1750_handle_t sensor, float *const data)
     ret = i2c_master_stop(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_cmd_begin(sens->bus, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
+    i2c_cmd_link_delete_static(cmd);
     if (ESP_OK != ret) {
         return ret;
     }
     *data = (( bh1750_data_h << 8 | bh1750_data_l ) / BH_1750_MEASUREMENT_ACCURACY);
     return ESP_OK;
 }
+
+static uint32_t bh1750_get_conv_time(const bh1750_dev_t *sens, const bh1750_measure_mode_t mode)
+{
+    const uint32_t conv_time = (mode == BH1750_CONTINUE_4LX_RES || mode == BH1750_ONETIME_4LX_RES) ? BH1750_CONV_TIME_L_RES_US : BH1750_CONV_TIME_H_RES_US;
+    return conv_time * sens->measure_time / BH1750_MEASURE_TIME_DEFAULT;
+}
+
+esp_err_t bh1750_start_measurement(bh1750_handle_t sensor, const bh1750_measure_mode_t cmd_measure)
+{
+    bh1750_dev_t *sens = (bh1750_dev_t *) sensor;
+    if (sens->timer && esp_timer_is_active(sens->timer)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = bh1750_write_byte(sens, (uint8_t)cmd_measure);
+    if (ESP_OK != ret) {
+        return ret;
+    }
+    sens->mode = cmd_measure;
+    sens->ready_time = esp_timer_get_time() + bh1750_get_conv_time(sens, cmd_measure);
+    sens->measuring = true;
+    return ESP_OK;
+}
+
+esp_err_t bh1750_poll_data(bh1750_handle_t sensor, float *const data)
+{
+    bh1750_dev_t *sens = (bh1750_dev_t *) sensor;
+    if (!sens->measuring) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (esp_timer_get_time() < sens->ready_time) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+    // continuous modes keep measuring, one-time result is read only once
+    if (sens->mode == BH1750_ONETIME_1LX_RES || sens->mode == BH1750_ONETIME_HALFLX_RES || sens->mode == BH1750_ONETIME_4LX_RES) {
+        sens->measuring = false;
+    }
+    return bh1750_get_data(sensor, data);
+}
+
+static void bh1750_timer_cb(void *arg)
+{
+    bh1750_dev_t *sens = (bh1750_dev_t *) arg;
+    float data = 0;
+
+    esp_err_t ret = bh1750_poll_data(sens, &data);
+    if (ESP_ERR_NOT_FINISHED == ret) {
+        const int64_t wait = sens->ready_time - esp_timer_get_time();
+        esp_timer_start_once(sens->timer, wait > 0 ? wait : 0);
+        return;
+    }
+    // the callback gets one result also in continuous mode
+    sens->measuring = false;
+    sens->data_cb(sens, ret, data, sens->user_ctx);
+}
+
+esp_err_t bh1750_start_measurement_cb(bh1750_handle_t sensor, const bh1750_measure_mode_t cmd_measure, bh1750_data_cb_t data_cb, void *user_ctx)
+{
+    bh1750_dev_t *sens = (bh1750_dev_t *) sensor;
+    if (!data_cb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!sens->timer) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = bh1750_timer_cb,
+            .arg = sens,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "bh1750",
+        };
+        esp_err_t ret = esp_timer_create(&timer_args, &sens->timer);
+        if (ESP_OK != ret) {
+            return ret;
+        }
+    }
+
+    esp_err_t ret = bh1750_start_measurement(sensor, cmd_measure);
+    if (ESP_OK != ret) {
+        return ret;
+    }
+    sens->data_cb = data_cb;
+    sens->user_ctx = user_ctx;
+    return esp_timer_start_once(sens->timer, bh1750_get_conv_time(sens, cmd_measure));
+}
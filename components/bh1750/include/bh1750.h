@@ -29,6 +29,18 @@ typedef enum {
 #define BH1750_I2C_ADDRESS_DEFAULT   (0x23)
 typedef void *bh1750_handle_t;
 
+/**
+ * @brief Callback of finished measurement started by bh1750_start_measurement_cb()
+ *
+ * @note It is called from esp_timer task
+ *
+ * @param sensor object handle of bh1750
+ * @param result ESP_OK on success, error of the I2C transaction otherwise
+ * @param data light intensity value got from bh1750 in [lx]
+ * @param user_ctx User data passed to bh1750_start_measurement_cb()
+ */
+typedef void (*bh1750_data_cb_t)(bh1750_handle_t sensor, esp_err_t result, float data, void *user_ctx);
+
 /**
  * @brief Set bh1750 as power down mode (low current)
  *
@@ -104,6 +116,61 @@ esp_err_t bh1750_get_data(bh1750_handle_t sensor, float *const data);
  */
 esp_err_t bh1750_set_measure_time(bh1750_handle_t sensor, const uint8_t measure_time);
 
+/**
+ * @brief Start measurement without waiting
+ *
+ * Sets measurement mode like bh1750_set_measure_mode() and remembers when the measurement is finished.
+ * The measurement time is the maximum from datasheet, scaled by measurement time set by bh1750_set_measure_time().
+ * Call bh1750_poll_data() to get the result. Measurements of more sensors can run at the same time.
+ *
+ * @param     sensor object handle of bh1750
+ * @param[in] cmd_measure the instruction to set measurement mode
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_STATE Measurement started by bh1750_start_measurement_cb() is running
+ *     - ESP_FAIL Fail
+ */
+esp_err_t bh1750_start_measurement(bh1750_handle_t sensor, const bh1750_measure_mode_t cmd_measure);
+
+/**
+ * @brief Poll measurement started by bh1750_start_measurement()
+ *
+ * This function never waits. In one-time modes the result can be read once, in continuous modes repeatedly.
+ *
+ * @param      sensor object handle of bh1750
+ * @param[out] data light intensity value got from bh1750 in [lx]
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_NOT_FINISHED Measurement is running, poll again later
+ *     - ESP_ERR_INVALID_STATE No measurement was started
+ *     - ESP_FAIL Fail
+ */
+esp_err_t bh1750_poll_data(bh1750_handle_t sensor, float *const data);
+
+/**
+ * @brief Start measurement and get the result in callback
+ *
+ * The result is read by esp_timer at the end of the measurement, the caller doesn't wait or poll.
+ * The callback is called once, also in continuous modes.
+ *
+ * @note I2C transactions are executed from esp_timer task
+ *
+ * @param     sensor object handle of bh1750
+ * @param[in] cmd_measure the instruction to set measurement mode
+ * @param[in] data_cb Callback of finished measurement
+ * @param[in] user_ctx User data passed to data_cb
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG data_cb is NULL
+ *     - ESP_ERR_INVALID_STATE Measurement started by bh1750_start_measurement_cb() is running
+ *     - ESP_ERR_NO_MEM No memory for the timer
+ *     - ESP_FAIL Fail
+ */
+esp_err_t bh1750_start_measurement_cb(bh1750_handle_t sensor, const bh1750_measure_mode_t cmd_measure, bh1750_data_cb_t data_cb, void *user_ctx);
+
 /**
  * @brief Create and init sensor object and return a sensor handle
  *
@@ -9,11 +9,13 @@
 #include "driver/i2c.h"
 #include "bh1750.h"
 #include "esp_log.h"
+#include "i2c_bus_stats.h"
 
 #define I2C_MASTER_SCL_IO 26      /*!< gpio number for I2C master clock */
 #define I2C_MASTER_SDA_IO 25      /*!< gpio number for I2C master data  */
 #define I2C_MASTER_NUM I2C_NUM_0  /*!< I2C port number for master dev */
 #define I2C_MASTER_FREQ_HZ 100000 /*!< I2C master clock frequency */
+#define PERF_ITERATIONS 1000      /*!< Number of readings in performance test */
 
 static const char *TAG = "bh1750 test";
 static bh1750_handle_t bh1750 = NULL;
@@ -67,6 +69,17 @@ TEST_CASE("Sensor BH1750 test", "[bh1750][iot][sensor]")
     TEST_ASSERT_EQUAL(ESP_OK, ret);
     ESP_LOGI(TAG, "bh1750 val(one time mode): %f\n", bh1750_data);
 
+    // non-blocking one-shot mode
+    ret = bh1750_start_measurement(bh1750, BH1750_ONETIME_4LX_RES);
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FINISHED, bh1750_poll_data(bh1750, &bh1750_data));
+    while (ESP_ERR_NOT_FINISHED == (ret = bh1750_poll_data(bh1750, &bh1750_data))) {
+        vTaskDelay(1);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, bh1750_poll_data(bh1750, &bh1750_data));
+    ESP_LOGI(TAG, "bh1750 val(non-blocking one time mode): %f\n", bh1750_data);
+
     // continous mode
     cmd_measure = BH1750_CONTINUE_4LX_RES;
     ret = bh1750_set_measure_mode(bh1750, cmd_measure);
@@ -83,3 +96,22 @@ TEST_CASE("Sensor BH1750 test", "[bh1750][iot][sensor]")
     ret = i2c_driver_delete(I2C_MASTER_NUM);
     TEST_ASSERT_EQUAL(ESP_OK, ret);
 }
+
+static esp_err_t bh1750_perf_get_data(void *ctx)
+{
+    float data;
+    return bh1750_get_data(bh1750, &data);
+}
+
+TEST_CASE("Sensor BH1750 performance", "[bh1750][iot][sensor][perf]")
+{
+    bh1750_init();
+    TEST_ASSERT_EQUAL(ESP_OK, bh1750_power_on(bh1750));
+    TEST_ASSERT_EQUAL(ESP_OK, bh1750_set_measure_mode(bh1750, BH1750_CONTINUE_4LX_RES));
+    vTaskDelay(30 / portTICK_PERIOD_MS);
+
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_perf_run("bh1750", "get_data", bh1750_perf_get_data, NULL, PERF_ITERATIONS, 1, NULL));
+
+    TEST_ASSERT_EQUAL(ESP_OK, bh1750_delete(bh1750));
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_driver_delete(I2C_MASTER_NUM));
+}
@@ -6,6 +6,8 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
+#include "onewire_bus.h"
 #include "onewire_device.h"
 #include "ds18b20_types.h"
 
@@ -24,6 +26,16 @@ typedef struct ds18b20_device_t *ds18b20_device_handle_t;
 typedef struct {
 } ds18b20_config_t;
 
+/**
+ * @brief DS18B20 devices of one 1-Wire bus, measured by `ds18b20_measure_buses`
+ */
+typedef struct {
+    onewire_bus_handle_t bus;           /*!< 1-Wire bus handle, each bus has its own RMT channels */
+    ds18b20_device_handle_t *devices;   /*!< DS18B20 devices on the bus */
+    size_t num;                         /*!< Number of devices */
+    float *temperatures;                /*!< Output array of `num` conversion results, NAN for failed devices */
+} ds18b20_bus_devices_t;
+
 /**
  * @brief Create a new DS18B20 device based on the general 1-Wire device
  *
@@ -42,6 +54,37 @@ typedef struct {
  */
 esp_err_t ds18b20_new_device(onewire_device_t *device, const ds18b20_config_t *config, ds18b20_device_handle_t *ret_ds18b20);
 
+/**
+ * @brief Create DS18B20 devices of the 1-Wire bus from ROM codes cached in NVS
+ *
+ * @note The cached ROM codes are used, when all of them have a valid CRC and each device is present (its scratchpad is read).
+ *       Otherwise the bus is searched and the ROM codes of found DS18B20 devices are cached for the next boot.
+ * @note NVS must be initialized (`nvs_flash_init`) before. Devices added to the bus later are found after `ds18b20_clear_rom_cache`.
+ *
+ * @param[in] bus 1-Wire bus handle
+ * @param[in] nvs_key NVS key of the cached ROM codes of the bus (max 15 characters), in the namespace "ds18b20"
+ * @param[out] ret_ds18b20s Array of `max_num` returned DS18B20 device handles
+ * @param[in] max_num Maximum number of devices
+ * @param[out] ret_num Number of created devices
+ * @return
+ *      - ESP_OK: Create DS18B20 devices successfully
+ *      - ESP_ERR_INVALID_ARG: Create DS18B20 devices failed due to invalid argument
+ *      - ESP_ERR_NOT_FOUND: No DS18B20 device on the bus
+ *      - ESP_FAIL: Create DS18B20 devices failed due to other reasons
+ */
+esp_err_t ds18b20_new_devices_cached(onewire_bus_handle_t bus, const char *nvs_key, ds18b20_device_handle_t *ret_ds18b20s, size_t max_num, size_t *ret_num);
+
+/**
+ * @brief Clear ROM codes cached by `ds18b20_new_devices_cached`, the bus is searched again on the next call
+ *
+ * @param[in] nvs_key NVS key of the cached ROM codes
+ * @return
+ *      - ESP_OK: Cache cleared (or it did not exist)
+ *      - ESP_ERR_INVALID_ARG: Invalid argument
+ *      - Others: NVS error
+ */
+esp_err_t ds18b20_clear_rom_cache(const char *nvs_key);
+
 /**
  * @brief Delete DS18B20 device
  *
@@ -79,6 +122,24 @@ esp_err_t ds18b20_set_resolution(ds18b20_device_handle_t ds18b20, ds18b20_resolu
  */
 esp_err_t ds18b20_trigger_temperature_conversion(ds18b20_device_handle_t ds18b20);
 
+/**
+ * @brief Trigger temperature conversion of all DS18B20 devices on the 1-Wire bus at once
+ *
+ * @note The convert command is broadcast with Skip ROM, so all devices convert in parallel.
+ *       This function then polls read slots until the devices release the bus, instead of a fixed delay.
+ *       The results can be read with `ds18b20_get_temperature` or `ds18b20_get_temperatures`.
+ * @note Polling requires externally powered devices, parasite powered devices are not supported.
+ *
+ * @param[in] bus 1-Wire bus handle the DS18B20 devices are connected to
+ * @param[in] resolution Highest resolution set on the devices, determines the conversion timeout
+ * @return
+ *      - ESP_OK: Temperature conversion finished successfully
+ *      - ESP_ERR_INVALID_ARG: Trigger temperature conversion failed due to invalid argument
+ *      - ESP_ERR_TIMEOUT: Temperature conversion didn't finish in the time given by the resolution
+ *      - ESP_FAIL: Trigger temperature conversion failed due to other reasons
+ */
+esp_err_t ds18b20_trigger_temperature_conversion_for_all(onewire_bus_handle_t bus, ds18b20_resolution_t resolution);
+
 /**
  * @brief Get temperature from DS18B20
  *
@@ -92,6 +153,39 @@ esp_err_t ds18b20_trigger_temperature_conversion(ds18b20_device_handle_t ds18b20
  */
 esp_err_t ds18b20_get_temperature(ds18b20_device_handle_t ds18b20, float *temperature);
 
+/**
+ * @brief Get temperatures from several DS18B20 devices
+ *
+ * @note A device that fails to respond doesn't stop the readout, its temperature is set to NAN.
+ *
+ * @param[in] ds18b20s Array of DS18B20 device handles returned by `ds18b20_new_device`
+ * @param[in] num Number of devices in the array
+ * @param[out] temperatures Array of `num` conversion results
+ * @return
+ *      - ESP_OK: Get all temperatures successfully
+ *      - ESP_ERR_INVALID_ARG: Get temperatures failed due to invalid argument
+ *      - Others: Error of the first device that failed
+ */
+esp_err_t ds18b20_get_temperatures(ds18b20_device_handle_t *ds18b20s, size_t num, float *temperatures);
+
+/**
+ * @brief Convert and read all DS18B20 devices on several 1-Wire buses
+ *
+ * @note Conversions are started on all buses at once and finish is polled on each bus (see `ds18b20_trigger_temperature_conversion_for_all`).
+ *       The buses are then read in parallel, by the calling task and one temporary task per further bus with the priority of the calling task.
+ *       The readout takes the time of the bus with the most devices.
+ *
+ * @param[in,out] buses Array of buses with their devices and output temperatures
+ * @param[in] bus_num Number of buses
+ * @param[in] resolution Highest resolution set on the devices, determines the conversion timeout
+ * @return
+ *      - ESP_OK: All temperatures read successfully
+ *      - ESP_ERR_INVALID_ARG: Invalid argument
+ *      - ESP_ERR_NO_MEM: Out of memory
+ *      - Others: Error of the first bus that failed, temperatures of failed devices are NAN
+ */
+esp_err_t ds18b20_measure_buses(ds18b20_bus_devices_t *buses, size_t bus_num, ds18b20_resolution_t resolution);
+
 #ifdef __cplusplus
 }
 #endif
@@ -4,9 +4,12 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 #include <string.h>
+#include <math.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_check.h"
+#include "nvs.h"
 #include "onewire_bus.h"
 #include "onewire_cmd.h"
 #include "onewire_crc.h"
@@ -18,6 +21,13 @@ static const char *TAG = "ds18b20";
 #define DS18B20_CMD_WRITE_SCRATCHPAD  0x4E
 #define DS18B20_CMD_READ_SCRATCHPAD   0xBE
 
+#define DS18B20_CONVERT_POLL_MS       10
+
+// NVS namespace of the cached ROM codes
+#define DS18B20_NVS_NAMESPACE         "ds18b20"
+// stack of the tasks reading further buses in ds18b20_measure_buses
+#define DS18B20_BUS_TASK_STACK        3072
+
 /**
  * @brief Structure of DS18B20's scratchpad
  */
@@ -41,6 +51,9 @@ typedef struct ds18b20_device_t {
     ds18b20_resolution_t resolution;
 } ds18b20_device_t;
 
+// conversion time of each resolution, with some margin
+static const uint32_t s_convert_delays_ms[] = {100, 200, 400, 800};
+
 esp_err_t ds18b20_new_device(onewire_device_t *device, const ds18b20_config_t *config, ds18b20_device_handle_t *ret_ds18b20)
 {
     ds18b20_device_t *ds18b20 = NULL;
@@ -110,15 +123,44 @@ esp_err_t ds18b20_trigger_temperature_conversion(ds18b20_device_handle_t ds18b20
     ESP_RETURN_ON_ERROR(ds18b20_send_command(ds18b20, DS18B20_CMD_CONVERT_TEMP), TAG, "send DS18B20_CMD_CONVERT_TEMP failed");
 
     // delay proper time for temperature conversion
-    const uint32_t delays_ms[] = {100, 200, 400, 800};
-    vTaskDelay(pdMS_TO_TICKS(delays_ms[ds18b20->resolution]));
+    vTaskDelay(pdMS_TO_TICKS(s_convert_delays_ms[ds18b20->resolution]));
 
     return ESP_OK;
 }
 
-esp_err_t ds18b20_get_temperature(ds18b20_device_handle_t ds18b20, float *ret_temperature)
+static esp_err_t ds18b20_convert_start(onewire_bus_handle_t bus)
+{
+    // reset bus and check if any device is present
+    ESP_RETURN_ON_ERROR(onewire_bus_reset(bus), TAG, "reset bus error");
+
+    // broadcast command to all devices: DS18B20_CMD_CONVERT_TEMP
+    const uint8_t tx_buffer[] = {ONEWIRE_CMD_SKIP_ROM, DS18B20_CMD_CONVERT_TEMP};
+    ESP_RETURN_ON_ERROR(onewire_bus_write_bytes(bus, tx_buffer, sizeof(tx_buffer)), TAG, "send DS18B20_CMD_CONVERT_TEMP failed");
+    return ESP_OK;
+}
+
+esp_err_t ds18b20_trigger_temperature_conversion_for_all(onewire_bus_handle_t bus, ds18b20_resolution_t resolution)
+{
+    ESP_RETURN_ON_FALSE(bus && resolution <= DS18B20_RESOLUTION_12B, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_ERROR(ds18b20_convert_start(bus), TAG, "start conversion failed");
+
+    // devices hold the bus low in read slots until all of them finished the conversion
+    const TickType_t poll_ticks = pdMS_TO_TICKS(DS18B20_CONVERT_POLL_MS) ? pdMS_TO_TICKS(DS18B20_CONVERT_POLL_MS) : 1;
+    const TickType_t timeout_ticks = pdMS_TO_TICKS(s_convert_delays_ms[resolution]);
+    const TickType_t start = xTaskGetTickCount();
+    uint8_t done = 0;
+    while (true) {
+        vTaskDelay(poll_ticks);
+        ESP_RETURN_ON_ERROR(onewire_bus_read_bit(bus, &done), TAG, "read conversion status failed");
+        if (done) {
+            return ESP_OK;
+        }
+        ESP_RETURN_ON_FALSE(xTaskGetTickCount() - start < timeout_ticks, ESP_ERR_TIMEOUT, TAG, "temperature conversion timeout");
+    }
+}
+
+static esp_err_t ds18b20_read_scratchpad(ds18b20_device_handle_t ds18b20, ds18b20_scratchpad_t *scratchpad)
 {
-    ESP_RETURN_ON_FALSE(ds18b20 && ret_temperature, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
     // reset bus and check if the ds18b20 is present
     ESP_RETURN_ON_ERROR(onewire_bus_reset(ds18b20->bus), TAG, "reset bus error");
 
@@ -126,11 +168,19 @@ esp_err_t ds18b20_get_temperature(ds18b20_device_handle_t ds18b20, float *ret_te
     ESP_RETURN_ON_ERROR(ds18b20_send_command(ds18b20, DS18B20_CMD_READ_SCRATCHPAD), TAG, "send DS18B20_CMD_READ_SCRATCHPAD failed");
 
     // read scratchpad data
-    ds18b20_scratchpad_t scratchpad;
-    ESP_RETURN_ON_ERROR(onewire_bus_read_bytes(ds18b20->bus, (uint8_t *)&scratchpad, sizeof(scratchpad)),
+    ESP_RETURN_ON_ERROR(onewire_bus_read_bytes(ds18b20->bus, (uint8_t *)scratchpad, sizeof(ds18b20_scratchpad_t)),
                         TAG, "error while reading scratchpad data");
     // check crc
-    ESP_RETURN_ON_FALSE(onewire_crc8(0, (uint8_t *)&scratchpad, 8) == scratchpad.crc_value, ESP_ERR_INVALID_CRC, TAG, "scratchpad crc error");
+    ESP_RETURN_ON_FALSE(onewire_crc8(0, (uint8_t *)scratchpad, 8) == scratchpad->crc_value, ESP_ERR_INVALID_CRC, TAG, "scratchpad crc error");
+    return ESP_OK;
+}
+
+esp_err_t ds18b20_get_temperature(ds18b20_device_handle_t ds18b20, float *ret_temperature)
+{
+    ESP_RETURN_ON_FALSE(ds18b20 && ret_temperature, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    ds18b20_scratchpad_t scratchpad;
+    ESP_RETURN_ON_ERROR(ds18b20_read_scratchpad(ds18b20, &scratchpad), TAG, "read scratchpad failed");
 
     const uint8_t lsb_mask[4] = {0x07, 0x03, 0x01, 0x00}; // mask bits not used in low resolution
     uint8_t lsb_masked = scratchpad.temp_lsb & (~lsb_mask[scratchpad.configuration >> 5]);
@@ -141,3 +191,218 @@ esp_err_t ds18b20_get_temperature(ds18b20_device_handle_t ds18b20, float *ret_te
 
     return ESP_OK;
 }
+
+esp_err_t ds18b20_get_temperatures(ds18b20_device_handle_t *ds18b20s, size_t num, float *ret_temperatures)
+{
+    ESP_RETURN_ON_FALSE(ds18b20s && ret_temperatures, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    esp_err_t ret = ESP_OK;
+    // read all devices, one failing device doesn't discard the results of the others
+    for (size_t i = 0; i < num; i++) {
+        esp_err_t err = ds18b20_get_temperature(ds18b20s[i], &ret_temperatures[i]);
+        if (err != ESP_OK) {
+            ret_temperatures[i] = NAN;
+            if (ret == ESP_OK) {
+                ret = err;
+            }
+        }
+    }
+    return ret;
+}
+
+static bool ds18b20_rom_is_valid(onewire_device_address_t address)
+{
+    // family code of DS18B20 and CRC of the first 7 bytes in the last byte
+    const uint8_t *rom = (const uint8_t *)&address;
+    return rom[0] == 0x28 && onewire_crc8(0, rom, 7) == rom[7];
+}
+
+static esp_err_t ds18b20_load_cached(onewire_bus_handle_t bus, const char *nvs_key, ds18b20_device_handle_t *ds18b20s, size_t max_num, size_t *ret_num)
+{
+    nvs_handle_t nvs;
+    onewire_device_address_t roms[max_num];
+    size_t size = sizeof(roms);
+    ESP_RETURN_ON_ERROR(nvs_open(DS18B20_NVS_NAMESPACE, NVS_READONLY, &nvs), TAG, "no cached ROM codes");
+    esp_err_t ret = nvs_get_blob(nvs, nvs_key, roms, &size);
+    nvs_close(nvs);
+    ESP_RETURN_ON_ERROR(ret, TAG, "no cached ROM codes");
+
+    // each cached device must be valid and present, otherwise the bus is searched again
+    size_t num = 0;
+    const ds18b20_config_t ds_cfg = {};
+    for (size_t i = 0; i < size / sizeof(onewire_device_address_t) && ret == ESP_OK; i++) {
+        onewire_device_t device = {
+            .bus = bus,
+            .address = roms[i],
+        };
+        ds18b20_scratchpad_t scratchpad;
+        ret = ds18b20_rom_is_valid(roms[i]) ? ds18b20_new_device(&device, &ds_cfg, &ds18b20s[num]) : ESP_ERR_INVALID_CRC;
+        if (ret == ESP_OK) {
+            num++;
+            ret = ds18b20_read_scratchpad(ds18b20s[num - 1], &scratchpad);
+        }
+    }
+    if (ret != ESP_OK || num == 0) {
+        for (size_t i = 0; i < num; i++) {
+            ds18b20_del_device(ds18b20s[i]);
+        }
+        return ESP_ERR_NOT_FOUND;
+    }
+    *ret_num = num;
+    return ESP_OK;
+}
+
+static esp_err_t ds18b20_search(onewire_bus_handle_t bus, ds18b20_device_handle_t *ds18b20s, size_t max_num, size_t *ret_num)
+{
+    onewire_device_iter_handle_t iter = NULL;
+    onewire_device_t device;
+    const ds18b20_config_t ds_cfg = {};
+    size_t num = 0;
+    esp_err_t ret = ESP_OK;
+
+    ESP_RETURN_ON_ERROR(onewire_new_device_iter(bus, &iter), TAG, "create device iterator failed");
+    while (num < max_num && (ret = onewire_device_iter_get_next(iter, &device)) != ESP_ERR_NOT_FOUND) {
+        // other device types and invalid reads are skipped
+        if (ret == ESP_OK && ds18b20_new_device(&device, &ds_cfg, &ds18b20s[num]) == ESP_OK) {
+            num++;
+        }
+    }
+    onewire_del_device_iter(iter);
+    ESP_RETURN_ON_FALSE(num > 0, ESP_ERR_NOT_FOUND, TAG, "no DS18B20 device found");
+    *ret_num = num;
+    return ESP_OK;
+}
+
+esp_err_t ds18b20_new_devices_cached(onewire_bus_handle_t bus, const char *nvs_key, ds18b20_device_handle_t *ret_ds18b20s, size_t max_num, size_t *ret_num)
+{
+    ESP_RETURN_ON_FALSE(bus && nvs_key && ret_ds18b20s && max_num > 0 && ret_num, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    if (ds18b20_load_cached(bus, nvs_key, ret_ds18b20s, max_num, ret_num) == ESP_OK) {
+        ESP_LOGD(TAG, "%d DS18B20 device(s) from cache %s", (int)*ret_num, nvs_key);
+        return ESP_OK;
+    }
+
+    ESP_RETURN_ON_ERROR(ds18b20_search(bus, ret_ds18b20s, max_num, ret_num), TAG, "search failed");
+    onewire_device_address_t roms[*ret_num];
+    for (size_t i = 0; i < *ret_num; i++) {
+        roms[i] = ret_ds18b20s[i]->addr;
+    }
+
+    // devices are usable also when the cache can't be written
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(DS18B20_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(nvs, nvs_key, roms, sizeof(roms));
+        if (ret == ESP_OK) {
+            ret = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "ROM codes not cached: %s", esp_err_to_name(ret));
+    }
+    return ESP_OK;
+}
+
+esp_err_t ds18b20_clear_rom_cache(const char *nvs_key)
+{
+    ESP_RETURN_ON_FALSE(nvs_key, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    nvs_handle_t nvs;
+    ESP_RETURN_ON_ERROR(nvs_open(DS18B20_NVS_NAMESPACE, NVS_READWRITE, &nvs), TAG, "open NVS failed");
+    esp_err_t ret = nvs_erase_key(nvs, nvs_key);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    return (ret == ESP_ERR_NVS_NOT_FOUND) ? ESP_OK : ret;
+}
+
+typedef struct {
+    ds18b20_bus_devices_t *bus_devices;
+    SemaphoreHandle_t done;
+    esp_err_t ret;
+} ds18b20_bus_task_ctx_t;
+
+static void ds18b20_bus_task(void *arg)
+{
+    ds18b20_bus_task_ctx_t *ctx = (ds18b20_bus_task_ctx_t *)arg;
+    ctx->ret = ds18b20_get_temperatures(ctx->bus_devices->devices, ctx->bus_devices->num, ctx->bus_devices->temperatures);
+    xSemaphoreGive(ctx->done);
+    vTaskDelete(NULL);
+}
+
+esp_err_t ds18b20_measure_buses(ds18b20_bus_devices_t *buses, size_t bus_num, ds18b20_resolution_t resolution)
+{
+    ESP_RETURN_ON_FALSE(buses && bus_num > 0 && resolution <= DS18B20_RESOLUTION_12B, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    esp_err_t ret = ESP_OK;
+    ds18b20_bus_task_ctx_t ctx[bus_num];
+    bool converting[bus_num];
+
+    // start conversions on all buses, they run in the devices at once
+    for (size_t i = 0; i < bus_num; i++) {
+        for (size_t j = 0; j < buses[i].num; j++) {
+            buses[i].temperatures[j] = NAN;
+        }
+        ctx[i].bus_devices = &buses[i];
+        ctx[i].done = NULL;
+        ctx[i].ret = ds18b20_convert_start(buses[i].bus);
+        converting[i] = (ctx[i].ret == ESP_OK);
+    }
+
+    // poll all buses until the devices release them
+    const TickType_t poll_ticks = pdMS_TO_TICKS(DS18B20_CONVERT_POLL_MS) ? pdMS_TO_TICKS(DS18B20_CONVERT_POLL_MS) : 1;
+    const TickType_t timeout_ticks = pdMS_TO_TICKS(s_convert_delays_ms[resolution]);
+    const TickType_t start = xTaskGetTickCount();
+    size_t pending = bus_num;
+    while (pending > 0) {
+        vTaskDelay(poll_ticks);
+        pending = 0;
+        for (size_t i = 0; i < bus_num; i++) {
+            uint8_t done = 0;
+            if (converting[i]) {
+                ctx[i].ret = onewire_bus_read_bit(buses[i].bus, &done);
+                converting[i] = (ctx[i].ret == ESP_OK && !done);
+                if (converting[i] && xTaskGetTickCount() - start >= timeout_ticks) {
+                    ctx[i].ret = ESP_ERR_TIMEOUT;
+                    converting[i] = false;
+                }
+                pending += converting[i];
+            }
+        }
+    }
+
+    // buses are read in parallel, each one by its own RMT channels, the first one by the calling task
+    SemaphoreHandle_t done = xSemaphoreCreateCounting(bus_num, 0);
+    ESP_RETURN_ON_FALSE(done, ESP_ERR_NO_MEM, TAG, "no mem for semaphore");
+    size_t started = 0;
+    for (size_t i = 1; i < bus_num; i++) {
+        if (ctx[i].ret != ESP_OK) {
+            continue;
+        }
+        ctx[i].done = done;
+        if (xTaskCreate(ds18b20_bus_task, "ds18b20", DS18B20_BUS_TASK_STACK, &ctx[i], uxTaskPriorityGet(NULL), NULL) == pdPASS) {
+            started++;
+        } else {
+            // no memory for the task, the bus is read after the first one
+            ctx[i].done = NULL;
+        }
+    }
+    if (ctx[0].ret == ESP_OK) {
+        ctx[0].ret = ds18b20_get_temperatures(buses[0].devices, buses[0].num, buses[0].temperatures);
+    }
+    for (size_t i = 1; i < bus_num; i++) {
+        // buses read by the tasks are skipped, their results are written concurrently
+        if (ctx[i].done == NULL && ctx[i].ret == ESP_OK) {
+            ctx[i].ret = ds18b20_get_temperatures(buses[i].devices, buses[i].num, buses[i].temperatures);
+        }
+    }
+    while (started--) {
+        xSemaphoreTake(done, portMAX_DELAY);
+    }
+    vSemaphoreDelete(done);
+
+    // results of failed devices and buses are NAN, the first error is returned
+    for (size_t i = 0; i < bus_num && ret == ESP_OK; i++) {
+        ret = ctx[i].ret;
+    }
+    return ret;
+}
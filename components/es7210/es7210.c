@@ -5,10 +5,12 @@
  */
 
 #include <inttypes.h>
+#include <string.h>
 #include "es7210.h"
 #include "es7210_reg.h"
 #include "esp_log.h"
 #include "esp_check.h"
+#include "esp_bit_defs.h"
 
 const static char *TAG = "ES7210";
 
@@ -29,9 +31,23 @@ const static char *TAG = "ES7210";
                         TAG, "i2c communication error while writing "#reg_addr); \
 } while(0)
 
+/* Registers 0x00 - 0x4C are cached */
+#define ES7210_CACHE_SIZE   (0x4D)
+/* Maximum count of writes sent in one I2C transaction */
+#define ES7210_BATCH_MAX    (40)
+
+#define ES7210_BIT_GET(map, reg)    ((map)[(reg) / 32] & (1u << ((reg) % 32)))
+#define ES7210_BIT_SET(map, reg)    ((map)[(reg) / 32] |= (1u << ((reg) % 32)))
+#define ES7210_BIT_CLR(map, reg)    ((map)[(reg) / 32] &= ~(1u << ((reg) % 32)))
+
 struct es7210_dev_t {
     i2c_port_t  i2c_port;
     uint8_t     i2c_addr;
+    uint8_t     cache[ES7210_CACHE_SIZE];                   /*!< Shadow copy of written registers */
+    uint32_t    cached[(ES7210_CACHE_SIZE + 31) / 32];      /*!< Bitmap of valid cache entries */
+    uint8_t     batch_len;
+    uint8_t     batch[ES7210_BATCH_MAX][2];                 /*!< Pending writes: register, value */
+    bool        batching;
 };
 
 /**
@@ -124,32 +140,101 @@ static const coeff_div_t *es7210_get_coeff(uint32_t mclk, uint32_t lrck)
     return NULL;
 }
 
-static esp_err_t es7210_write_reg(es7210_dev_handle_t handle, uint8_t reg_addr, uint8_t reg_val)
+/**
+ * @brief Send all pending writes in one I2C transaction, in the order they were written
+ *
+ * @note ES7210 registers are written one by one (START, address, register, value, STOP),
+ *       so the sequence does not depend on register auto-increment.
+ */
+static esp_err_t es7210_batch_flush(es7210_dev_handle_t handle)
 {
-    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid device handle");
     esp_err_t ret = ESP_OK;
+    if (handle->batch_len == 0) {
+        return ESP_OK;
+    }
 
     i2c_cmd_handle_t cmd = i2c_cmd_link_create();
     ESP_GOTO_ON_FALSE(cmd, ESP_ERR_NO_MEM, err, TAG, "memory allocation for i2c cmd handle failed");
 
-    ESP_GOTO_ON_ERROR(i2c_master_start(cmd), err, TAG, "error while appending i2c command");
-    ESP_GOTO_ON_ERROR(i2c_master_write_byte(cmd, handle->i2c_addr << 1 | I2C_MASTER_WRITE, true),
-                      err, TAG, "error while appending i2c command");
-    ESP_GOTO_ON_ERROR(i2c_master_write_byte(cmd, reg_addr, true), err,
-                      TAG, "error while appending i2c command");
-    ESP_GOTO_ON_ERROR(i2c_master_write_byte(cmd, reg_val, true), err,
-                      TAG, "error while appending i2c command");
-    ESP_GOTO_ON_ERROR(i2c_master_stop(cmd), err, TAG, "error while appending i2c command");
+    for (int i = 0; i < handle->batch_len; i++) {
+        ESP_GOTO_ON_ERROR(i2c_master_start(cmd), err, TAG, "error while appending i2c command");
+        ESP_GOTO_ON_ERROR(i2c_master_write_byte(cmd, handle->i2c_addr << 1 | I2C_MASTER_WRITE, true),
+                          err, TAG, "error while appending i2c command");
+        ESP_GOTO_ON_ERROR(i2c_master_write(cmd, handle->batch[i], 2, true), err,
+                          TAG, "error while appending i2c command");
+        ESP_GOTO_ON_ERROR(i2c_master_stop(cmd), err, TAG, "error while appending i2c command");
+    }
 
     ESP_GOTO_ON_ERROR(i2c_master_cmd_begin(handle->i2c_port, cmd, pdMS_TO_TICKS(1000)),
-                      err, TAG, "error while writing register");
+                      err, TAG, "error while writing registers");
 err:
     if (cmd) {
         i2c_cmd_link_delete(cmd);
     }
+    if (ret != ESP_OK) {
+        /* It is unknown, which writes were applied */
+        for (int i = 0; i < handle->batch_len; i++) {
+            ES7210_BIT_CLR(handle->cached, handle->batch[i][0]);
+        }
+    }
+    handle->batch_len = 0;
     return ret;
 }
 
+static esp_err_t es7210_write_reg(es7210_dev_handle_t handle, uint8_t reg_addr, uint8_t reg_val)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid device handle");
+    ESP_RETURN_ON_FALSE(reg_addr < ES7210_CACHE_SIZE, ESP_ERR_INVALID_ARG, TAG, "invalid register address");
+
+    /* Writes of the reset register are commands, they are never skipped */
+    if (reg_addr != ES7210_RESET_REG00 && ES7210_BIT_GET(handle->cached, reg_addr) && handle->cache[reg_addr] == reg_val) {
+        return ESP_OK;
+    }
+    handle->cache[reg_addr] = reg_val;
+    ES7210_BIT_SET(handle->cached, reg_addr);
+
+    if (handle->batch_len == ES7210_BATCH_MAX) {
+        ESP_RETURN_ON_ERROR(es7210_batch_flush(handle), TAG, "error while writing registers");
+    }
+    handle->batch[handle->batch_len][0] = reg_addr;
+    handle->batch[handle->batch_len][1] = reg_val;
+    handle->batch_len++;
+
+    return handle->batching ? ESP_OK : es7210_batch_flush(handle);
+}
+
+/**
+ * @brief Change bits of a register, its value is taken from the cache or read from the device
+ */
+static esp_err_t es7210_update_reg(es7210_dev_handle_t handle, uint8_t reg_addr, uint8_t mask, uint8_t reg_val)
+{
+    uint8_t value = handle->cache[reg_addr];
+    if (!ES7210_BIT_GET(handle->cached, reg_addr)) {
+        /* Not written since reset, not cached, so the restore doesn't write it */
+        ESP_RETURN_ON_ERROR(i2c_master_write_read_device(handle->i2c_port, handle->i2c_addr, &reg_addr, 1, &value, 1, pdMS_TO_TICKS(1000)),
+                            TAG, "error while reading register");
+    }
+    return es7210_write_reg(handle, reg_addr, (value & ~mask) | (reg_val & mask));
+}
+
+static void es7210_batch_begin(es7210_dev_handle_t handle)
+{
+    handle->batching = true;
+}
+
+/* Pending writes are sent also on error, the first error is returned */
+static esp_err_t es7210_batch_commit(es7210_dev_handle_t handle, esp_err_t ret)
+{
+    handle->batching = false;
+    const esp_err_t flush_ret = es7210_batch_flush(handle);
+    return (ret != ESP_OK) ? ret : flush_ret;
+}
+
+static void es7210_cache_invalidate(es7210_dev_handle_t handle)
+{
+    memset(handle->cached, 0, sizeof(handle->cached));
+}
+
 static esp_err_t es7210_set_i2s_format(es7210_dev_handle_t handle, es7210_i2s_fmt_t i2s_format,
                                        es7210_i2s_bits_t bit_width, bool tdm_enable)
 {
@@ -245,6 +330,26 @@ static esp_err_t es7210_set_mic_gain(es7210_dev_handle_t handle, es7210_mic_gain
     return ESP_OK;
 }
 
+/* Registers of one channel (ADC1-4) */
+static const struct {
+    uint8_t gain;       /*!< MIC gain */
+    uint8_t volume;     /*!< ADC direct dB */
+    uint8_t hpf;        /*!< HPF of the channel, bit 5 enables it */
+    uint8_t mute;       /*!< Mute register of the channel pair */
+    uint8_t mute_bit;   /*!< Mute bit of the channel */
+} es7210_channel_regs[4] = {
+    {ES7210_MIC1_GAIN_REG43, ES7210_ADC1_DIRECT_DB_REG1B, ES7210_ADC12_HPF1_REG23, ES7210_ADC12_MUTERANGE_REG15, BIT(0)},
+    {ES7210_MIC2_GAIN_REG44, ES7210_ADC2_DIRECT_DB_REG1C, ES7210_ADC12_HPF2_REG22, ES7210_ADC12_MUTERANGE_REG15, BIT(1)},
+    {ES7210_MIC3_GAIN_REG45, ES7210_ADC3_DIRECT_DB_REG1D, ES7210_ADC34_HPF1_REG21, ES7210_ADC34_MUTERANGE_REG14, BIT(0)},
+    {ES7210_MIC4_GAIN_REG46, ES7210_ADC4_DIRECT_DB_REG1E, ES7210_ADC34_HPF2_REG20, ES7210_ADC34_MUTERANGE_REG14, BIT(1)},
+};
+
+/*
+ * reg_val: 0x00 represents -95.5dB, 0xBF represents 0dB (default after reset),
+ * and 0xFF represents +32dB, with a 0.5dB step
+ */
+#define ES7210_VOLUME_REG_VAL(volume_db)    ((uint8_t)(191 + (volume_db) * 2))
+
 static esp_err_t es7210_set_mic_bias(es7210_dev_handle_t handle, es7210_mic_bias_t mic_bias)
 {
     ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid device handle pointer");
@@ -280,14 +385,8 @@ esp_err_t es7210_del_codec(es7210_dev_handle_t handle)
     return ESP_OK;
 }
 
-esp_err_t es7210_config_codec(es7210_dev_handle_t handle, const es7210_codec_config_t *codec_conf)
+static esp_err_t es7210_config_regs(es7210_dev_handle_t handle, const es7210_codec_config_t *codec_conf)
 {
-    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid device handle pointer");
-    ESP_RETURN_ON_FALSE(codec_conf, ESP_ERR_INVALID_ARG, TAG, "invalid codec config pointer");
-
-    /* Perform software reset */
-    ES7210_WRITE_REG(ES7210_RESET_REG00, 0xFF);
-    ES7210_WRITE_REG(ES7210_RESET_REG00, 0x32);
     /* Set the initialization time when device powers up */
     ES7210_WRITE_REG(ES7210_TIME_CONTROL0_REG09, 0x30);
     ES7210_WRITE_REG(ES7210_TIME_CONTROL1_REG0A, 0x30);
@@ -318,28 +417,161 @@ esp_err_t es7210_config_codec(es7210_dev_handle_t handle, const es7210_codec_con
     /* Power on MIC1-4 bias & ADC1-4 & PGA1-4 Power */
     ES7210_WRITE_REG(ES7210_MIC12_POWER_REG4B, 0x0F);
     ES7210_WRITE_REG(ES7210_MIC34_POWER_REG4C, 0x0F);
-    /* Enable device */
+    return ESP_OK;
+}
+
+/* Reset register commands must be in this order: reset, configuration, enable */
+static esp_err_t es7210_software_reset(es7210_dev_handle_t handle)
+{
+    /* All registers have their default values after reset */
+    es7210_cache_invalidate(handle);
+    ES7210_WRITE_REG(ES7210_RESET_REG00, 0xFF);
+    ES7210_WRITE_REG(ES7210_RESET_REG00, 0x32);
+    return ESP_OK;
+}
+
+static esp_err_t es7210_enable(es7210_dev_handle_t handle)
+{
     ES7210_WRITE_REG(ES7210_RESET_REG00, 0x71);
     ES7210_WRITE_REG(ES7210_RESET_REG00, 0x41);
-
     return ESP_OK;
 }
 
+esp_err_t es7210_config_codec(es7210_dev_handle_t handle, const es7210_codec_config_t *codec_conf)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid device handle pointer");
+    ESP_RETURN_ON_FALSE(codec_conf, ESP_ERR_INVALID_ARG, TAG, "invalid codec config pointer");
+
+    /* The whole configuration is sent in one I2C transaction */
+    esp_err_t ret;
+    es7210_batch_begin(handle);
+    ret = es7210_software_reset(handle);
+    if (ret == ESP_OK) {
+        ret = es7210_config_regs(handle, codec_conf);
+    }
+    if (ret == ESP_OK) {
+        ret = es7210_enable(handle);
+    }
+    return es7210_batch_commit(handle, ret);
+}
+
+esp_err_t es7210_restore_codec(es7210_dev_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid device handle pointer");
+
+    /* Only registers written since the last reset differ from their defaults */
+    uint8_t values[ES7210_CACHE_SIZE];
+    uint32_t restore[(ES7210_CACHE_SIZE + 31) / 32];
+    memcpy(values, handle->cache, sizeof(values));
+    memcpy(restore, handle->cached, sizeof(restore));
+
+    esp_err_t ret;
+    es7210_batch_begin(handle);
+    ret = es7210_software_reset(handle);
+    for (int reg = ES7210_RESET_REG00 + 1; reg < ES7210_CACHE_SIZE && ret == ESP_OK; reg++) {
+        if (ES7210_BIT_GET(restore, reg)) {
+            ret = es7210_write_reg(handle, reg, values[reg]);
+        }
+    }
+    if (ret == ESP_OK) {
+        ret = es7210_enable(handle);
+    }
+    return es7210_batch_commit(handle, ret);
+}
+
 esp_err_t es7210_config_volume(es7210_dev_handle_t handle, int8_t volume_db)
 {
     ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid device handle pointer");
     ESP_RETURN_ON_FALSE(volume_db >= -95 && volume_db <= 32, ESP_ERR_INVALID_ARG, TAG, "invalid volume range");
 
-    /*
-     * reg_val: 0x00 represents -95.5dB, 0xBF represents 0dB (default after reset),
-     * and 0xFF represents +32dB, with a 0.5dB step
-     */
-    uint8_t reg_val = 191 + volume_db * 2;
+    return es7210_config_channel_volume(handle, ES7210_CHANNEL_ALL, volume_db);
+}
 
-    ES7210_WRITE_REG(ES7210_ADC1_DIRECT_DB_REG1B, reg_val);
-    ES7210_WRITE_REG(ES7210_ADC2_DIRECT_DB_REG1C, reg_val);
-    ES7210_WRITE_REG(ES7210_ADC3_DIRECT_DB_REG1D, reg_val);
-    ES7210_WRITE_REG(ES7210_ADC4_DIRECT_DB_REG1E, reg_val);
+esp_err_t es7210_config_channel_gain(es7210_dev_handle_t handle, uint8_t channel_mask, es7210_mic_gain_t mic_gain)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid device handle pointer");
+    ESP_RETURN_ON_FALSE(IS_ES7210_MIC_GAIN(mic_gain), ESP_ERR_INVALID_ARG, TAG, "invalid mic gain value");
 
-    return ESP_OK;
+    esp_err_t ret = ESP_OK;
+    es7210_batch_begin(handle);
+    for (int ch = 0; ch < 4 && ret == ESP_OK; ch++) {
+        if (channel_mask & BIT(ch)) {
+            ret = es7210_write_reg(handle, es7210_channel_regs[ch].gain, mic_gain | 0x10);
+        }
+    }
+    return es7210_batch_commit(handle, ret);
+}
+
+esp_err_t es7210_config_channel_volume(es7210_dev_handle_t handle, uint8_t channel_mask, int8_t volume_db)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid device handle pointer");
+    ESP_RETURN_ON_FALSE(volume_db >= -95 && volume_db <= 32, ESP_ERR_INVALID_ARG, TAG, "invalid volume range");
+
+    /* Unchanged channels are skipped, the rest is sent in one I2C transaction */
+    esp_err_t ret = ESP_OK;
+    es7210_batch_begin(handle);
+    for (int ch = 0; ch < 4 && ret == ESP_OK; ch++) {
+        if (channel_mask & BIT(ch)) {
+            ret = es7210_write_reg(handle, es7210_channel_regs[ch].volume, ES7210_VOLUME_REG_VAL(volume_db));
+        }
+    }
+    return es7210_batch_commit(handle, ret);
+}
+
+esp_err_t es7210_config_channel_hpf(es7210_dev_handle_t handle, uint8_t channel_mask, bool enable)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid device handle pointer");
+
+    esp_err_t ret = ESP_OK;
+    es7210_batch_begin(handle);
+    for (int ch = 0; ch < 4 && ret == ESP_OK; ch++) {
+        if (channel_mask & BIT(ch)) {
+            ret = es7210_update_reg(handle, es7210_channel_regs[ch].hpf, BIT(5), enable ? BIT(5) : 0);
+        }
+    }
+    return es7210_batch_commit(handle, ret);
+}
+
+esp_err_t es7210_config_channel_mute(es7210_dev_handle_t handle, uint8_t channel_mask, bool mute)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid device handle pointer");
+
+    esp_err_t ret = ESP_OK;
+    es7210_batch_begin(handle);
+    for (int ch = 0; ch < 4 && ret == ESP_OK; ch++) {
+        if (channel_mask & BIT(ch)) {
+            const uint8_t bit = es7210_channel_regs[ch].mute_bit;
+            ret = es7210_update_reg(handle, es7210_channel_regs[ch].mute, bit, mute ? bit : 0);
+        }
+    }
+    return es7210_batch_commit(handle, ret);
+}
+
+esp_err_t es7210_config_channels(es7210_dev_handle_t handle, const es7210_channel_config_t channel_conf[4])
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid device handle pointer");
+    ESP_RETURN_ON_FALSE(channel_conf, ESP_ERR_INVALID_ARG, TAG, "invalid channel config pointer");
+    for (int ch = 0; ch < 4; ch++) {
+        ESP_RETURN_ON_FALSE(IS_ES7210_MIC_GAIN(channel_conf[ch].mic_gain), ESP_ERR_INVALID_ARG, TAG, "invalid mic gain value");
+        ESP_RETURN_ON_FALSE(channel_conf[ch].volume_db >= -95 && channel_conf[ch].volume_db <= 32, ESP_ERR_INVALID_ARG, TAG, "invalid volume range");
+    }
+
+    /* Up to 14 changed registers in one I2C transaction */
+    esp_err_t ret = ESP_OK;
+    es7210_batch_begin(handle);
+    for (int ch = 0; ch < 4 && ret == ESP_OK; ch++) {
+        const es7210_channel_config_t *conf = &channel_conf[ch];
+        const uint8_t bit = es7210_channel_regs[ch].mute_bit;
+        ret = es7210_write_reg(handle, es7210_channel_regs[ch].gain, conf->mic_gain | 0x10);
+        if (ret == ESP_OK) {
+            ret = es7210_write_reg(handle, es7210_channel_regs[ch].volume, ES7210_VOLUME_REG_VAL(conf->volume_db));
+        }
+        if (ret == ESP_OK) {
+            ret = es7210_update_reg(handle, es7210_channel_regs[ch].hpf, BIT(5), conf->hpf_enable ? BIT(5) : 0);
+        }
+        if (ret == ESP_OK) {
+            ret = es7210_update_reg(handle, es7210_channel_regs[ch].mute, bit, conf->mute ? bit : 0);
+        }
+    }
+    return es7210_batch_commit(handle, ret);
 }
@@ -12,6 +12,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "esp_err.h"
 #include "driver/i2c.h"
 
@@ -100,6 +101,27 @@ typedef enum {
     ES7210_MIC_BIAS_2V87 = 0x70    /*!< 2.87V MIC bias */
 } es7210_mic_bias_t;
 
+/**
+ * @brief Channels (ADC1-4) of ES7210, can be combined into a mask
+ *
+ */
+#define ES7210_CHANNEL_1    (1 << 0)
+#define ES7210_CHANNEL_2    (1 << 1)
+#define ES7210_CHANNEL_3    (1 << 2)
+#define ES7210_CHANNEL_4    (1 << 3)
+#define ES7210_CHANNEL_ALL  (0x0F)
+
+/**
+ * @brief Configuration of one ES7210 channel (per-microphone calibration)
+ *
+ */
+typedef struct {
+    es7210_mic_gain_t mic_gain;     /*!< Analog gain of the MIC (PGA) */
+    int8_t volume_db;               /*!< Digital volume of the ADC, in dB, with a range from -95dB to +32dB */
+    bool hpf_enable;                /*!< High-pass filter of the ADC (DC removal) */
+    bool mute;                      /*!< Mute of the ADC */
+} es7210_channel_config_t;
+
 /**
  * @brief Type of es7210 device handle
  *
@@ -171,6 +193,24 @@ esp_err_t es7210_del_codec(es7210_dev_handle_t handle);
  */
 esp_err_t es7210_config_codec(es7210_dev_handle_t handle, const es7210_codec_config_t *codec_conf);
 
+/**
+ * @brief Restore configuration of ES7210 after power cycle.
+ *
+ * The driver keeps a copy of all registers written since the last reset. ES7210 is reset
+ * and only these registers are written again, in one I2C transaction.
+ *
+ * @param[in] handle ES7210 device handle
+ * @return
+ *          - ESP_OK                  Codec restore success.
+ *          - ESP_ERR_INVALID_ARG     Invalid device handle.
+ *          - ESP_ERR_NO_MEM          Memory allocation failed.
+ *          - ESP_FAIL                Sending command error, slave hasn't ACK the transfer.
+ *          - ESP_ERR_INVALID_STATE   I2C driver not installed or not in master mode.
+ *          - ESP_ERR_TIMEOUT         Operation timeout because the bus is busy.
+ *
+ */
+esp_err_t es7210_restore_codec(es7210_dev_handle_t handle);
+
 /**
  * @brief Configure volume of ES7210.
  *
@@ -187,6 +227,72 @@ esp_err_t es7210_config_codec(es7210_dev_handle_t handle, const es7210_codec_con
  */
 esp_err_t es7210_config_volume(es7210_dev_handle_t handle, int8_t volume_db);
 
+/**
+ * @brief Configure MIC gain of selected channels of ES7210.
+ *
+ * @param[in] handle ES7210 device handle
+ * @param[in] channel_mask Channels to be configured, e.g. ES7210_CHANNEL_1 | ES7210_CHANNEL_2
+ * @param[in] mic_gain Gain of analog MIC
+ * @return
+ *          - ESP_OK                  Gain config success.
+ *          - ESP_ERR_INVALID_ARG     Invalid device handle or argument.
+ *          - Else                    I2C communication error.
+ */
+esp_err_t es7210_config_channel_gain(es7210_dev_handle_t handle, uint8_t channel_mask, es7210_mic_gain_t mic_gain);
+
+/**
+ * @brief Configure volume of selected channels of ES7210.
+ *
+ * @param[in] handle ES7210 device handle
+ * @param[in] channel_mask Channels to be configured
+ * @param[in] volume_db Volume to be set, in dB, with a range from -95dB to +32dB.
+ * @return
+ *          - ESP_OK                  Volume config success.
+ *          - ESP_ERR_INVALID_ARG     Invalid device handle or argument.
+ *          - Else                    I2C communication error.
+ */
+esp_err_t es7210_config_channel_volume(es7210_dev_handle_t handle, uint8_t channel_mask, int8_t volume_db);
+
+/**
+ * @brief Enable or disable high-pass filter (DC removal) of selected channels of ES7210.
+ *
+ * @param[in] handle ES7210 device handle
+ * @param[in] channel_mask Channels to be configured
+ * @param[in] enable Enable the filter
+ * @return
+ *          - ESP_OK                  HPF config success.
+ *          - ESP_ERR_INVALID_ARG     Invalid device handle or argument.
+ *          - Else                    I2C communication error.
+ */
+esp_err_t es7210_config_channel_hpf(es7210_dev_handle_t handle, uint8_t channel_mask, bool enable);
+
+/**
+ * @brief Mute or unmute selected channels of ES7210.
+ *
+ * @param[in] handle ES7210 device handle
+ * @param[in] channel_mask Channels to be configured
+ * @param[in] mute Mute the channels
+ * @return
+ *          - ESP_OK                  Mute config success.
+ *          - ESP_ERR_INVALID_ARG     Invalid device handle or argument.
+ *          - Else                    I2C communication error.
+ */
+esp_err_t es7210_config_channel_mute(es7210_dev_handle_t handle, uint8_t channel_mask, bool mute);
+
+/**
+ * @brief Configure all four channels of ES7210.
+ *
+ * Changed registers of all channels are sent in one I2C transaction.
+ *
+ * @param[in] handle ES7210 device handle
+ * @param[in] channel_conf Configuration of channels 1-4
+ * @return
+ *          - ESP_OK                  Channels config success.
+ *          - ESP_ERR_INVALID_ARG     Invalid device handle or argument.
+ *          - Else                    I2C communication error.
+ */
+esp_err_t es7210_config_channels(es7210_dev_handle_t handle, const es7210_channel_config_t channel_conf[4]);
+
 #ifdef __cplusplus
 }
 #endif
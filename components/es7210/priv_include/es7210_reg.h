@@ -25,6 +25,7 @@
 
 #define  ES7210_ADC_AUTOMUTE_REG13          0x13        /* Set mute */
 #define  ES7210_ADC34_MUTERANGE_REG14       0x14        /* Set mute range */
+#define  ES7210_ADC12_MUTERANGE_REG15       0x15        /* Set mute range */
 #define  ES7210_ALC_SEL_REG16               0x16        /* Set ALC mode */
 #define  ES7210_ADC1_DIRECT_DB_REG1B        0x1B
 #define  ES7210_ADC2_DIRECT_DB_REG1C        0x1C
@@ -10,11 +10,13 @@
 #include "es7210.h"
 #include "esp_system.h"
 #include "esp_log.h"
+#include "i2c_bus_stats.h"
 
 #define I2C_MASTER_SCL_IO 18      /*!< gpio number for I2C master clock on S3-Korvo */
 #define I2C_MASTER_SDA_IO 17      /*!< gpio number for I2C master data  on S3-Korvo */
 #define I2C_MASTER_NUM I2C_NUM_0  /*!< I2C port number for master dev */
 #define I2C_MASTER_FREQ_HZ 100000 /*!< I2C master clock frequency */
+#define PERF_ITERATIONS 1000      /*!< Number of readings in performance test */
 
 #define ES7210_I2C_ADDR             (0x40)
 #define ES7210_SAMPLE_RATE          (48000)
@@ -73,6 +75,31 @@ TEST_CASE("ADC Codec ES7210 basic functionality test", "[es7210][iot][device]")
     test_es7210_init(false);
     TEST_ERROR_CHECK(es7210_del_codec(es7210_handle), "Failed to delete ES7210 handle");
     test_es7210_init(true);
+    const es7210_channel_config_t channel_conf[4] = {
+        {.mic_gain = ES7210_MIC_GAIN_30DB, .volume_db = 0, .hpf_enable = true},
+        {.mic_gain = ES7210_MIC_GAIN_30DB, .volume_db = 1, .hpf_enable = true},
+        {.mic_gain = ES7210_MIC_GAIN_27DB, .volume_db = -1, .hpf_enable = true},
+        {.mic_gain = ES7210_MIC_GAIN_0DB, .volume_db = 0, .mute = true},
+    };
+    TEST_ERROR_CHECK(es7210_config_channels(es7210_handle, channel_conf), "Failed to config ES7210 channels");
+    TEST_ERROR_CHECK(es7210_config_channel_mute(es7210_handle, ES7210_CHANNEL_4, false), "Failed to unmute ES7210 channel");
+    TEST_ERROR_CHECK(es7210_restore_codec(es7210_handle), "Failed to restore ES7210 configuration");
+    TEST_ERROR_CHECK(es7210_del_codec(es7210_handle), "Failed to delete ES7210 handle");
+    TEST_ERROR_CHECK(i2c_driver_delete(I2C_MASTER_NUM), "Failed to delete I2C driver");
+}
+
+static esp_err_t es7210_perf_config_volume(void *ctx)
+{
+    return es7210_config_volume(es7210_handle, ES7210_ADC_VOLUME);
+}
+
+TEST_CASE("ADC Codec ES7210 performance", "[es7210][iot][device][perf]")
+{
+    test_i2c_init();
+    test_es7210_init(false);
+
+    TEST_ERROR_CHECK(i2c_bus_perf_run("es7210", "config_volume", es7210_perf_config_volume, NULL, PERF_ITERATIONS, 1, NULL), "Performance test failed");
+
     TEST_ERROR_CHECK(es7210_del_codec(es7210_handle), "Failed to delete ES7210 handle");
     TEST_ERROR_CHECK(i2c_driver_delete(I2C_MASTER_NUM), "Failed to delete I2C driver");
 }
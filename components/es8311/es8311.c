@@ -13,9 +13,20 @@
 
 #include "es8311_reg.h"
 
+/* Registers 0x00 - 0x49 are cached */
+#define ES8311_CACHE_SIZE   (0x4A)
+/* Maximum count of writes sent in one I2C transaction */
+#define ES8311_BATCH_MAX    (32)
+
 typedef struct {
     i2c_port_t port;
     uint16_t dev_addr;
+    uint8_t cache[ES8311_CACHE_SIZE];           /* Shadow copy of the registers */
+    uint32_t cached[(ES8311_CACHE_SIZE + 31) / 32];     /* Bitmap of valid cache entries */
+    uint32_t modified[(ES8311_CACHE_SIZE + 31) / 32];   /* Bitmap of registers written since reset */
+    uint8_t batch_depth;                        /* Nesting of batch_begin/batch_commit */
+    uint8_t batch_len;
+    uint8_t batch[ES8311_BATCH_MAX][2];         /* Pending writes: register, value */
 } es8311_dev_t;
 
 /*
@@ -142,19 +153,137 @@ static const struct _coeff_div coeff_div[] = {
 
 static const char *TAG = "ES8311";
 
-static inline esp_err_t es8311_write_reg(es8311_handle_t dev, uint8_t reg_addr, uint8_t data)
+#define ES8311_BIT_GET(map, reg)    ((map)[(reg) / 32] & (1u << ((reg) % 32)))
+#define ES8311_BIT_SET(map, reg)    ((map)[(reg) / 32] |= (1u << ((reg) % 32)))
+#define ES8311_BIT_CLR(map, reg)    ((map)[(reg) / 32] &= ~(1u << ((reg) % 32)))
+
+static inline esp_err_t es8311_write_reg_hw(es8311_dev_t *es, uint8_t reg_addr, uint8_t data)
 {
-    es8311_dev_t *es = (es8311_dev_t *) dev;
     const uint8_t write_buf[2] = {reg_addr, data};
     return i2c_master_write_to_device(es->port, es->dev_addr, write_buf, sizeof(write_buf), pdMS_TO_TICKS(1000));
 }
 
-static inline esp_err_t es8311_read_reg(es8311_handle_t dev, uint8_t reg_addr, uint8_t *reg_value)
+static inline esp_err_t es8311_read_reg_hw(es8311_dev_t *es, uint8_t reg_addr, uint8_t *reg_value)
 {
-    es8311_dev_t *es = (es8311_dev_t *) dev;
     return i2c_master_write_read_device(es->port, es->dev_addr, &reg_addr, 1, reg_value, 1, pdMS_TO_TICKS(1000));
 }
 
+static void es8311_cache_invalidate(es8311_dev_t *es)
+{
+    memset(es->cached, 0, sizeof(es->cached));
+    memset(es->modified, 0, sizeof(es->modified));
+}
+
+/* Send all pending writes in one I2C transaction, in the order they were written */
+static esp_err_t es8311_batch_flush(es8311_dev_t *es)
+{
+    esp_err_t ret = ESP_OK;
+    if (es->batch_len == 0) {
+        return ESP_OK;
+    }
+
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    ESP_GOTO_ON_FALSE(cmd, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for I2C command");
+    for (int i = 0; i < es->batch_len; i++) {
+        ESP_GOTO_ON_ERROR(i2c_master_start(cmd), err, TAG, "I2C command error");
+        ESP_GOTO_ON_ERROR(i2c_master_write_byte(cmd, (es->dev_addr << 1) | I2C_MASTER_WRITE, true), err, TAG, "I2C command error");
+        ESP_GOTO_ON_ERROR(i2c_master_write(cmd, es->batch[i], 2, true), err, TAG, "I2C command error");
+        ESP_GOTO_ON_ERROR(i2c_master_stop(cmd), err, TAG, "I2C command error");
+    }
+    ret = i2c_master_cmd_begin(es->port, cmd, pdMS_TO_TICKS(1000));
+
+err:
+    if (cmd) {
+        i2c_cmd_link_delete(cmd);
+    }
+    if (ret != ESP_OK) {
+        /* It is unknown, which writes were applied */
+        for (int i = 0; i < es->batch_len; i++) {
+            if (es->batch[i][0] < ES8311_CACHE_SIZE) {
+                ES8311_BIT_CLR(es->cached, es->batch[i][0]);
+            }
+        }
+    }
+    es->batch_len = 0;
+    return ret;
+}
+
+static esp_err_t es8311_write_reg(es8311_handle_t dev, uint8_t reg_addr, uint8_t data)
+{
+    es8311_dev_t *es = (es8311_dev_t *) dev;
+
+    if (reg_addr < ES8311_CACHE_SIZE) {
+        /* Writes of the reset register have side effects, they are never skipped */
+        if (reg_addr != ES8311_RESET_REG00 && ES8311_BIT_GET(es->cached, reg_addr) && es->cache[reg_addr] == data) {
+            return ESP_OK;
+        }
+        es->cache[reg_addr] = data;
+        ES8311_BIT_SET(es->cached, reg_addr);
+        ES8311_BIT_SET(es->modified, reg_addr);
+    }
+
+    if (es->batch_depth > 0) {
+        if (es->batch_len == ES8311_BATCH_MAX) {
+            ESP_RETURN_ON_ERROR(es8311_batch_flush(es), TAG, "I2C read/write error");
+        }
+        es->batch[es->batch_len][0] = reg_addr;
+        es->batch[es->batch_len][1] = data;
+        es->batch_len++;
+        return ESP_OK;
+    }
+
+    esp_err_t ret = es8311_write_reg_hw(es, reg_addr, data);
+    if (ret != ESP_OK && reg_addr < ES8311_CACHE_SIZE) {
+        ES8311_BIT_CLR(es->cached, reg_addr);
+    }
+    return ret;
+}
+
+/* Pending writes of a batch are already in the cache, so read-modify-write sequences work inside batch too */
+static esp_err_t es8311_read_reg(es8311_handle_t dev, uint8_t reg_addr, uint8_t *reg_value)
+{
+    es8311_dev_t *es = (es8311_dev_t *) dev;
+
+    if (reg_addr < ES8311_CACHE_SIZE && ES8311_BIT_GET(es->cached, reg_addr)) {
+        *reg_value = es->cache[reg_addr];
+        return ESP_OK;
+    }
+    ESP_RETURN_ON_ERROR(es8311_read_reg_hw(es, reg_addr, reg_value), TAG, "I2C read/write error");
+    if (reg_addr < ES8311_CACHE_SIZE) {
+        es->cache[reg_addr] = *reg_value;
+        ES8311_BIT_SET(es->cached, reg_addr);
+    }
+    return ESP_OK;
+}
+
+esp_err_t es8311_batch_begin(es8311_handle_t dev)
+{
+    ESP_RETURN_ON_FALSE(dev, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+    es8311_dev_t *es = (es8311_dev_t *) dev;
+    es->batch_depth++;
+    return ESP_OK;
+}
+
+esp_err_t es8311_batch_commit(es8311_handle_t dev)
+{
+    ESP_RETURN_ON_FALSE(dev, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+    es8311_dev_t *es = (es8311_dev_t *) dev;
+    ESP_RETURN_ON_FALSE(es->batch_depth > 0, ESP_ERR_INVALID_STATE, TAG, "No batch started");
+
+    /* Nested batches are sent with the outermost one */
+    if (--es->batch_depth > 0) {
+        return ESP_OK;
+    }
+    return es8311_batch_flush(es);
+}
+
+/* Finish the batch also on error, the error of the configuration is returned */
+static esp_err_t es8311_batch_end(es8311_handle_t dev, esp_err_t ret)
+{
+    const esp_err_t commit_ret = es8311_batch_commit(dev);
+    return (ret != ESP_OK) ? ret : commit_ret;
+}
+
 /*
 * look for the coefficient in coeff_div[] table
 */
@@ -169,7 +298,7 @@ static int get_coeff(uint32_t mclk, uint32_t rate)
     return -1;
 }
 
-esp_err_t es8311_sample_frequency_config(es8311_handle_t dev, int mclk_frequency, int sample_frequency)
+static esp_err_t es8311_sample_frequency_regs(es8311_handle_t dev, int mclk_frequency, int sample_frequency)
 {
     uint8_t regv;
 
@@ -225,6 +354,13 @@ esp_err_t es8311_sample_frequency_config(es8311_handle_t dev, int mclk_frequency
     return ESP_OK;
 }
 
+esp_err_t es8311_sample_frequency_config(es8311_handle_t dev, int mclk_frequency, int sample_frequency)
+{
+    /* Registers 0x02 - 0x08 are sent in one transaction, unchanged ones are skipped */
+    ESP_RETURN_ON_ERROR(es8311_batch_begin(dev), TAG, "");
+    return es8311_batch_end(dev, es8311_sample_frequency_regs(dev, mclk_frequency, sample_frequency));
+}
+
 static esp_err_t es8311_clock_config(es8311_handle_t dev, const es8311_clock_config_t *const clk_cfg, es8311_resolution_t res)
 {
     uint8_t reg06;
@@ -314,6 +450,24 @@ esp_err_t es8311_microphone_config(es8311_handle_t dev, bool digital_mic)
     return es8311_write_reg(dev, ES8311_SYSTEM_REG14, reg14);
 }
 
+static esp_err_t es8311_config_regs(es8311_handle_t dev, const es8311_clock_config_t *const clk_cfg, const es8311_resolution_t res_in, const es8311_resolution_t res_out)
+{
+    /* Setup clock: source, polarity and clock dividers */
+    ESP_RETURN_ON_ERROR(es8311_clock_config(dev, clk_cfg, res_out), TAG, "");
+
+    /* Setup audio format (fmt): master/slave, resolution, I2S */
+    ESP_RETURN_ON_ERROR(es8311_fmt_config(dev, res_in, res_out), TAG, "");
+
+    ESP_RETURN_ON_ERROR(es8311_write_reg(dev, ES8311_SYSTEM_REG0D, 0x01), TAG, "I2C read/write error"); // Power up analog circuitry - NOT default
+    ESP_RETURN_ON_ERROR(es8311_write_reg(dev, ES8311_SYSTEM_REG0E, 0x02), TAG, "I2C read/write error"); // Enable analog PGA, enable ADC modulator - NOT default
+    ESP_RETURN_ON_ERROR(es8311_write_reg(dev, ES8311_SYSTEM_REG12, 0x00), TAG, "I2C read/write error"); // power-up DAC - NOT default
+    ESP_RETURN_ON_ERROR(es8311_write_reg(dev, ES8311_SYSTEM_REG13, 0x10), TAG, "I2C read/write error"); // Enable output to HP drive - NOT default
+    ESP_RETURN_ON_ERROR(es8311_write_reg(dev, ES8311_ADC_REG1C, 0x6A), TAG, "I2C read/write error"); // ADC Equalizer bypass, cancel DC offset in digital domain
+    ESP_RETURN_ON_ERROR(es8311_write_reg(dev, ES8311_DAC_REG37, 0x08), TAG, "I2C read/write error"); // Bypass DAC equalizer - NOT default
+
+    return ESP_OK;
+}
+
 esp_err_t es8311_init(es8311_handle_t dev, const es8311_clock_config_t *const clk_cfg, const es8311_resolution_t res_in, const es8311_resolution_t res_out)
 {
     ESP_RETURN_ON_FALSE(
@@ -325,26 +479,51 @@ esp_err_t es8311_init(es8311_handle_t dev, const es8311_clock_config_t *const cl
     }
 
 
+    es8311_dev_t *es = (es8311_dev_t *) dev;
+
     /* Reset ES8311 to its default */
+    es8311_cache_invalidate(es);
     ESP_RETURN_ON_ERROR(es8311_write_reg(dev, ES8311_RESET_REG00, 0x1F), TAG, "I2C read/write error");
     vTaskDelay(pdMS_TO_TICKS(20));
+    es8311_cache_invalidate(es);
     ESP_RETURN_ON_ERROR(es8311_write_reg(dev, ES8311_RESET_REG00, 0x00), TAG, "I2C read/write error");
     ESP_RETURN_ON_ERROR(es8311_write_reg(dev, ES8311_RESET_REG00, 0x80), TAG, "I2C read/write error"); // Power-on command
 
-    /* Setup clock: source, polarity and clock dividers */
-    ESP_RETURN_ON_ERROR(es8311_clock_config(dev, clk_cfg, res_out), TAG, "");
+    ESP_RETURN_ON_ERROR(es8311_batch_begin(dev), TAG, "");
+    return es8311_batch_end(dev, es8311_config_regs(dev, clk_cfg, res_in, res_out));
+}
 
-    /* Setup audio format (fmt): master/slave, resolution, I2S */
-    ESP_RETURN_ON_ERROR(es8311_fmt_config(dev, res_in, res_out), TAG, "");
+esp_err_t es8311_registers_restore(es8311_handle_t dev)
+{
+    ESP_RETURN_ON_FALSE(dev, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+    es8311_dev_t *es = (es8311_dev_t *) dev;
+    ESP_RETURN_ON_FALSE(es->batch_depth == 0, ESP_ERR_INVALID_STATE, TAG, "Batch not committed");
 
-    ESP_RETURN_ON_ERROR(es8311_write_reg(dev, ES8311_SYSTEM_REG0D, 0x01), TAG, "I2C read/write error"); // Power up analog circuitry - NOT default
-    ESP_RETURN_ON_ERROR(es8311_write_reg(dev, ES8311_SYSTEM_REG0E, 0x02), TAG, "I2C read/write error"); // Enable analog PGA, enable ADC modulator - NOT default
-    ESP_RETURN_ON_ERROR(es8311_write_reg(dev, ES8311_SYSTEM_REG12, 0x00), TAG, "I2C read/write error"); // power-up DAC - NOT default
-    ESP_RETURN_ON_ERROR(es8311_write_reg(dev, ES8311_SYSTEM_REG13, 0x10), TAG, "I2C read/write error"); // Enable output to HP drive - NOT default
-    ESP_RETURN_ON_ERROR(es8311_write_reg(dev, ES8311_ADC_REG1C, 0x6A), TAG, "I2C read/write error"); // ADC Equalizer bypass, cancel DC offset in digital domain
-    ESP_RETURN_ON_ERROR(es8311_write_reg(dev, ES8311_DAC_REG37, 0x08), TAG, "I2C read/write error"); // Bypass DAC equalizer - NOT default
+    /* Only registers written since the last reset differ from power-on defaults */
+    uint8_t values[ES8311_CACHE_SIZE];
+    uint32_t restore[(ES8311_CACHE_SIZE + 31) / 32];
+    memcpy(values, es->cache, sizeof(values));
+    memcpy(restore, es->modified, sizeof(restore));
 
-    return ESP_OK;
+    es8311_cache_invalidate(es);
+    ESP_RETURN_ON_ERROR(es8311_write_reg(dev, ES8311_RESET_REG00, 0x1F), TAG, "I2C read/write error");
+    vTaskDelay(pdMS_TO_TICKS(20));
+    es8311_cache_invalidate(es);
+    ESP_RETURN_ON_ERROR(es8311_write_reg(dev, ES8311_RESET_REG00, 0x00), TAG, "I2C read/write error");
+    ESP_RETURN_ON_ERROR(es8311_write_reg(dev, ES8311_RESET_REG00, 0x80), TAG, "I2C read/write error"); // Power-on command
+
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_ERROR(es8311_batch_begin(dev), TAG, "");
+    for (int reg = ES8311_RESET_REG00 + 1; reg < ES8311_CACHE_SIZE && ret == ESP_OK; reg++) {
+        if (ES8311_BIT_GET(restore, reg)) {
+            ret = es8311_write_reg(dev, reg, values[reg]);
+        }
+    }
+    /* Serial port mode is in the reset register */
+    if (ret == ESP_OK && ES8311_BIT_GET(restore, ES8311_RESET_REG00)) {
+        ret = es8311_write_reg(dev, ES8311_RESET_REG00, values[ES8311_RESET_REG00]);
+    }
+    return es8311_batch_end(dev, ret);
 }
 
 void es8311_delete(es8311_handle_t dev)
@@ -424,11 +603,95 @@ esp_err_t es8311_microphone_fade(es8311_handle_t dev, const es8311_fade_t fade)
     return es8311_write_reg(dev, ES8311_ADC_REG15, reg15);
 }
 
+static esp_err_t es8311_level_ctrl_regs(es8311_handle_t dev, uint8_t ctrl_reg, uint8_t level_reg, const es8311_level_ctrl_t *cfg)
+{
+    uint8_t regv;
+    /* Levels first, so the control starts with the new range */
+    ESP_RETURN_ON_ERROR(es8311_write_reg(dev, level_reg, (cfg->max_level << 4) | cfg->min_level), TAG, "I2C read/write error");
+    ESP_RETURN_ON_ERROR(es8311_read_reg(dev, ctrl_reg, &regv), TAG, "I2C read/write error");
+    regv &= 0x70;
+    regv |= cfg->winsize;
+    if (cfg->enable) {
+        regv |= BIT(7);
+    }
+    return es8311_write_reg(dev, ctrl_reg, regv);
+}
+
+static esp_err_t es8311_level_ctrl_config(es8311_handle_t dev, uint8_t ctrl_reg, uint8_t level_reg, const es8311_level_ctrl_t *cfg)
+{
+    ESP_RETURN_ON_FALSE(cfg && cfg->winsize <= 0x0F && cfg->max_level <= 0x0F && cfg->min_level <= cfg->max_level,
+                        ESP_ERR_INVALID_ARG, TAG, "Invalid level control configuration");
+    ESP_RETURN_ON_ERROR(es8311_batch_begin(dev), TAG, "");
+    return es8311_batch_end(dev, es8311_level_ctrl_regs(dev, ctrl_reg, level_reg, cfg));
+}
+
+esp_err_t es8311_voice_drc_config(es8311_handle_t dev, const es8311_level_ctrl_t *drc)
+{
+    return es8311_level_ctrl_config(dev, ES8311_DAC_REG34, ES8311_DAC_REG35, drc);
+}
+
+esp_err_t es8311_microphone_alc_config(es8311_handle_t dev, const es8311_level_ctrl_t *alc)
+{
+    return es8311_level_ctrl_config(dev, ES8311_ADC_REG18, ES8311_ADC_REG19, alc);
+}
+
+/* Coefficient registers are written MSB first */
+static esp_err_t es8311_eq_coeff_write(es8311_handle_t dev, uint8_t reg_addr, uint32_t coeff)
+{
+    for (int i = 0; i < 4; i++) {
+        ESP_RETURN_ON_ERROR(es8311_write_reg(dev, reg_addr + i, (coeff >> (24 - 8 * i)) & 0xFF), TAG, "I2C read/write error");
+    }
+    return ESP_OK;
+}
+
+static esp_err_t es8311_eq_regs(es8311_handle_t dev, uint8_t bypass_reg, uint8_t bypass_bit, const uint8_t *coeff_regs, const uint32_t *coeffs, int coeff_cnt)
+{
+    uint8_t regv;
+    ESP_RETURN_ON_ERROR(es8311_read_reg(dev, bypass_reg, &regv), TAG, "I2C read/write error");
+    if (coeffs == NULL) {
+        return es8311_write_reg(dev, bypass_reg, regv | bypass_bit);
+    }
+    for (int i = 0; i < coeff_cnt; i++) {
+        ESP_RETURN_ON_ERROR(es8311_eq_coeff_write(dev, coeff_regs[i], coeffs[i]), TAG, "");
+    }
+    return es8311_write_reg(dev, bypass_reg, regv & ~bypass_bit);
+}
+
+esp_err_t es8311_voice_eq_config(es8311_handle_t dev, const es8311_dac_eq_t *eq)
+{
+    const uint8_t regs[] = {ES8311_DACEQ_B0_REG38, ES8311_DACEQ_B1_REG3C, ES8311_DACEQ_A1_REG40};
+    uint32_t coeffs[3];
+    if (eq) {
+        coeffs[0] = eq->b0;
+        coeffs[1] = eq->b1;
+        coeffs[2] = eq->a1;
+    }
+    /* 12 coefficient registers and the bypass bit are sent in one I2C transaction */
+    ESP_RETURN_ON_ERROR(es8311_batch_begin(dev), TAG, "");
+    return es8311_batch_end(dev, es8311_eq_regs(dev, ES8311_DAC_REG37, BIT(3), regs, eq ? coeffs : NULL, 3));
+}
+
+esp_err_t es8311_microphone_eq_config(es8311_handle_t dev, const es8311_adc_eq_t *eq)
+{
+    const uint8_t regs[] = {ES8311_ADCEQ_B0_REG1D, ES8311_ADCEQ_A1_REG21, ES8311_ADCEQ_A2_REG25, ES8311_ADCEQ_B1_REG29, ES8311_ADCEQ_B2_REG2D};
+    uint32_t coeffs[5];
+    if (eq) {
+        coeffs[0] = eq->b0;
+        coeffs[1] = eq->a1;
+        coeffs[2] = eq->a2;
+        coeffs[3] = eq->b1;
+        coeffs[4] = eq->b2;
+    }
+    /* 20 coefficient registers and the bypass bit are sent in one I2C transaction */
+    ESP_RETURN_ON_ERROR(es8311_batch_begin(dev), TAG, "");
+    return es8311_batch_end(dev, es8311_eq_regs(dev, ES8311_ADC_REG1C, BIT(6), regs, eq ? coeffs : NULL, 5));
+}
+
 void es8311_register_dump(es8311_handle_t dev)
 {
     for (int reg = 0; reg < 0x4A; reg++) {
         uint8_t value;
-        ESP_ERROR_CHECK(es8311_read_reg(dev, reg, &value));
+        ESP_ERROR_CHECK(es8311_read_reg_hw((es8311_dev_t *) dev, reg, &value));
         printf("REG:%02x: %02x", reg, value);
     }
 }
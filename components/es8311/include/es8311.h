@@ -75,6 +75,50 @@ typedef struct es8311_clock_config_t {
     int  sample_frequency;   // in Hz
 } es8311_clock_config_t;
 
+/**
+ * @brief Level control of the codec: DAC dynamic range control (DRC) or ADC automatic level control (ALC)
+ *
+ * The gain is adjusted by the codec, so the signal level stays between min_level and max_level.
+ * Levels and window size are 4-bit codes of the ES8311 user guide, higher level code is louder signal.
+ */
+typedef struct es8311_level_ctrl_t {
+    bool    enable;
+    uint8_t winsize;    // Window of the level detection (0 ~ 15), longer window is slower attack and release
+    uint8_t max_level;  // Maximum signal level (0 ~ 15)
+    uint8_t min_level;  // Minimum signal level (0 ~ 15), must not be higher than max_level
+} es8311_level_ctrl_t;
+
+/* Level control presets */
+#define ES8311_LEVEL_CTRL_OFF()             {.enable = false, .winsize = 0, .max_level = 0, .min_level = 0}
+#define ES8311_DRC_LIMITER()                {.enable = true, .winsize = 2, .max_level = 15, .min_level = 0}   // Only peaks are limited, small speaker protection
+#define ES8311_DRC_NIGHT_MODE()             {.enable = true, .winsize = 4, .max_level = 12, .min_level = 6}   // Quiet parts are louder, loud parts are softer
+#define ES8311_ALC_VOICE()                  {.enable = true, .winsize = 2, .max_level = 12, .min_level = 10}  // Near-field voice, fast reaction
+#define ES8311_ALC_FAR_FIELD()              {.enable = true, .winsize = 6, .max_level = 13, .min_level = 8}   // Distant voice, slow gain changes
+
+/**
+ * @brief Coefficients of DAC equalizer (first order IIR filter: B0, B1, A1)
+ *
+ * 32-bit register values as generated by the ES8311 EQ coefficient tool of Everest Semiconductor
+ */
+typedef struct es8311_dac_eq_t {
+    uint32_t b0;
+    uint32_t b1;
+    uint32_t a1;
+} es8311_dac_eq_t;
+
+/**
+ * @brief Coefficients of ADC equalizer (biquad IIR filter: B0, A1, A2, B1, B2)
+ *
+ * 32-bit register values as generated by the ES8311 EQ coefficient tool of Everest Semiconductor
+ */
+typedef struct es8311_adc_eq_t {
+    uint32_t b0;
+    uint32_t a1;
+    uint32_t a2;
+    uint32_t b1;
+    uint32_t b2;
+} es8311_adc_eq_t;
+
 /**
  * @brief Initialize ES8311
  *
@@ -131,10 +175,49 @@ esp_err_t es8311_voice_volume_get(es8311_handle_t dev, int *volume);
 /**
  * @brief Print out ES8311 register content
  *
+ * @note Registers are read from the device, not from the register cache
+ *
  * @param dev ES8311 handle
  */
 void es8311_register_dump(es8311_handle_t dev);
 
+/**
+ * @brief Start batch of register writes
+ *
+ * The driver keeps a copy of ES8311 registers, writes of unchanged values are skipped.
+ * Between es8311_batch_begin() and es8311_batch_commit() the writes only update the copy,
+ * the commit sends them all in one I2C transaction. Batches can be nested.
+ *
+ * @param dev ES8311 handle
+ * @return
+ *     - ESP_OK success
+ *     - ESP_ERR_INVALID_ARG invalid handle
+ */
+esp_err_t es8311_batch_begin(es8311_handle_t dev);
+
+/**
+ * @brief Send register writes of the batch to ES8311
+ *
+ * @param dev ES8311 handle
+ * @return
+ *     - ESP_OK success
+ *     - ESP_ERR_INVALID_STATE no batch started
+ *     - Else fail
+ */
+esp_err_t es8311_batch_commit(es8311_handle_t dev);
+
+/**
+ * @brief Restore configuration after ES8311 power cycle
+ *
+ * ES8311 is reset and only registers written since es8311_init() are sent again, in one I2C transaction.
+ *
+ * @param dev ES8311 handle
+ * @return
+ *     - ESP_OK success
+ *     - Else fail
+ */
+esp_err_t es8311_registers_restore(es8311_handle_t dev);
+
 /**
  * @brief Mute ES8311 output
  *
@@ -205,6 +288,58 @@ esp_err_t es8311_voice_fade(es8311_handle_t dev, const es8311_fade_t fade);
  */
 esp_err_t es8311_microphone_fade(es8311_handle_t dev, const es8311_fade_t fade);
 
+/**
+ * @brief Configure dynamic range control of DAC output
+ *
+ * @param dev ES8311 handle
+ * @param[in] drc DRC configuration, e.g. ES8311_DRC_LIMITER()
+ * @return
+ *     - ESP_OK success
+ *     - ESP_ERR_INVALID_ARG invalid configuration
+ *     - Else I2C read/write error
+ */
+esp_err_t es8311_voice_drc_config(es8311_handle_t dev, const es8311_level_ctrl_t *drc);
+
+/**
+ * @brief Configure automatic level control of ADC input
+ *
+ * @note The ALC controls the ADC digital gain, set the microphone gain (es8311_microphone_gain_set) for the headroom
+ *
+ * @param dev ES8311 handle
+ * @param[in] alc ALC configuration, e.g. ES8311_ALC_VOICE()
+ * @return
+ *     - ESP_OK success
+ *     - ESP_ERR_INVALID_ARG invalid configuration
+ *     - Else I2C read/write error
+ */
+esp_err_t es8311_microphone_alc_config(es8311_handle_t dev, const es8311_level_ctrl_t *alc);
+
+/**
+ * @brief Configure DAC equalizer
+ *
+ * Coefficients are written in one I2C transaction, then the equalizer is enabled.
+ *
+ * @param dev ES8311 handle
+ * @param[in] eq Equalizer coefficients, NULL: bypass the equalizer
+ * @return
+ *     - ESP_OK success
+ *     - Else I2C read/write error
+ */
+esp_err_t es8311_voice_eq_config(es8311_handle_t dev, const es8311_dac_eq_t *eq);
+
+/**
+ * @brief Configure ADC equalizer
+ *
+ * Coefficients are written in one I2C transaction, then the equalizer is enabled.
+ *
+ * @param dev ES8311 handle
+ * @param[in] eq Equalizer coefficients, NULL: bypass the equalizer
+ * @return
+ *     - ESP_OK success
+ *     - Else I2C read/write error
+ */
+esp_err_t es8311_microphone_eq_config(es8311_handle_t dev, const es8311_adc_eq_t *eq);
+
 /**
  * @brief Create ES8311 object and return its handle
  *
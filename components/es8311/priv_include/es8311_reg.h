@@ -51,6 +51,11 @@
 #define ES8311_ADC_REG1A                0x1A /* ADC, alc automute */
 #define ES8311_ADC_REG1B                0x1B /* ADC, alc automute, adc hpf s1 */
 #define ES8311_ADC_REG1C                0x1C /* ADC, equalizer, hpf s2 */
+#define ES8311_ADCEQ_B0_REG1D           0x1D /* ADC, equalizer B0 coefficient, 4 registers MSB first */
+#define ES8311_ADCEQ_A1_REG21           0x21 /* ADC, equalizer A1 coefficient */
+#define ES8311_ADCEQ_A2_REG25           0x25 /* ADC, equalizer A2 coefficient */
+#define ES8311_ADCEQ_B1_REG29           0x29 /* ADC, equalizer B1 coefficient */
+#define ES8311_ADCEQ_B2_REG2D           0x2D /* ADC, equalizer B2 coefficient */
 /*
  * DAC
  */
@@ -60,6 +65,9 @@
 #define ES8311_DAC_REG34                0x34 /* DAC, drc enable, drc winsize */
 #define ES8311_DAC_REG35                0x35 /* DAC, drc maxlevel, minilevel */
 #define ES8311_DAC_REG37                0x37 /* DAC, ramprate */
+#define ES8311_DACEQ_B0_REG38           0x38 /* DAC, equalizer B0 coefficient, 4 registers MSB first */
+#define ES8311_DACEQ_B1_REG3C           0x3C /* DAC, equalizer B1 coefficient */
+#define ES8311_DACEQ_A1_REG40           0x40 /* DAC, equalizer A1 coefficient */
 /*
  *GPIO
  */
@@ -0,0 +1,137 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_check.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_lcd_mock.h"
+
+static const char *TAG = "lcd_mock";
+
+struct esp_lcd_panel_io_t {
+    esp_lcd_panel_io_color_trans_done_cb_t on_color_trans_done;
+    void *user_ctx;
+};
+
+struct esp_lcd_panel_t {
+    esp_lcd_mock_config_t config;
+    esp_lcd_panel_io_handle_t io;
+    esp_lcd_mock_stats_t stats;
+    uint16_t *frame;            /* RGB565 pixels, NULL for monochrome panel */
+};
+
+esp_err_t esp_lcd_new_panel_mock(const esp_lcd_mock_config_t *config, esp_lcd_panel_io_handle_t *ret_io, esp_lcd_panel_handle_t *ret_panel)
+{
+    ESP_RETURN_ON_FALSE(config && ret_io && ret_panel && config->hres > 0 && config->vres > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->bits_per_pixel == 16 || config->bits_per_pixel == 1, ESP_ERR_INVALID_ARG, TAG, "Unsupported bits per pixel");
+
+    esp_lcd_panel_io_handle_t io = calloc(1, sizeof(struct esp_lcd_panel_io_t));
+    esp_lcd_panel_handle_t panel = calloc(1, sizeof(struct esp_lcd_panel_t));
+    if (io == NULL || panel == NULL) {
+        free(io);
+        free(panel);
+        return ESP_ERR_NO_MEM;
+    }
+    panel->config = *config;
+    panel->io = io;
+    if (config->bits_per_pixel == 16) {
+        panel->frame = calloc((size_t)config->hres * config->vres, sizeof(uint16_t));
+        if (panel->frame == NULL) {
+            free(io);
+            free(panel);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    *ret_io = io;
+    *ret_panel = panel;
+    return ESP_OK;
+}
+
+void esp_lcd_mock_get_stats(esp_lcd_panel_handle_t panel, esp_lcd_mock_stats_t *stats, bool reset)
+{
+    *stats = panel->stats;
+    if (reset) {
+        panel->stats.draw_cnt = 0;
+        panel->stats.draw_px = 0;
+        panel->stats.draw_bytes = 0;
+    }
+}
+
+const uint16_t *esp_lcd_mock_get_frame(esp_lcd_panel_handle_t panel)
+{
+    return panel->frame;
+}
+
+esp_err_t esp_lcd_panel_io_register_event_callbacks(esp_lcd_panel_io_handle_t io, const esp_lcd_panel_io_callbacks_t *cbs, void *user_ctx)
+{
+    ESP_RETURN_ON_FALSE(io && cbs, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    io->on_color_trans_done = cbs->on_color_trans_done;
+    io->user_ctx = user_ctx;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_del(esp_lcd_panel_io_handle_t io)
+{
+    free(io);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end, const void *color_data)
+{
+    ESP_RETURN_ON_FALSE(panel && color_data, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    /* Size of the window is checked against the panel in default orientation or with swapped axes */
+    const int hres = panel->stats.swap_xy ? panel->config.vres : panel->config.hres;
+    const int vres = panel->stats.swap_xy ? panel->config.hres : panel->config.vres;
+    ESP_RETURN_ON_FALSE(x_start >= 0 && y_start >= 0 && x_start < x_end && y_start < y_end && x_end <= hres && y_end <= vres,
+                        ESP_ERR_INVALID_ARG, TAG, "Window out of panel (%d,%d)-(%d,%d)", x_start, y_start, x_end, y_end);
+
+    const int w = x_end - x_start;
+    const int h = y_end - y_start;
+    panel->stats.draw_cnt++;
+    panel->stats.draw_px += (uint64_t)w * h;
+    panel->stats.draw_bytes += (uint64_t)w * h * panel->config.bits_per_pixel / 8;
+
+    if (panel->frame) {
+        const uint16_t *src = color_data;
+        for (int y = 0; y < h; y++) {
+            memcpy(&panel->frame[(size_t)(y_start + y) * hres + x_start], &src[(size_t)y * w], w * sizeof(uint16_t));
+        }
+    }
+
+    /* Transfer is finished immediately */
+    if (panel->io->on_color_trans_done) {
+        esp_lcd_panel_io_event_data_t edata = {0};
+        panel->io->on_color_trans_done(panel->io, &edata, panel->io->user_ctx);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_mirror(esp_lcd_panel_handle_t panel, bool mirror_x, bool mirror_y)
+{
+    ESP_RETURN_ON_FALSE(panel, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    panel->stats.mirror_x = mirror_x;
+    panel->stats.mirror_y = mirror_y;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_swap_xy(esp_lcd_panel_handle_t panel, bool swap_axes)
+{
+    ESP_RETURN_ON_FALSE(panel, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    panel->stats.swap_xy = swap_axes;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_del(esp_lcd_panel_handle_t panel)
+{
+    if (panel) {
+        free(panel->frame);
+        free(panel);
+    }
+    return ESP_OK;
+}
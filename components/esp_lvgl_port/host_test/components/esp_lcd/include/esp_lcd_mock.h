@@ -0,0 +1,79 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Mocked LCD panel for host tests
+ *
+ * The panel does not send anything, it counts the transfers and copies RGB565 pixels into its frame buffer.
+ * The transfer is finished immediately, `on_color_trans_done` is called from `esp_lcd_panel_draw_bitmap()`.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_lcd_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Mocked panel configuration
+ */
+typedef struct {
+    int hres;               /*!< Horizontal resolution of the panel */
+    int vres;               /*!< Vertical resolution of the panel */
+    int bits_per_pixel;     /*!< Bits per pixel: 16 (pixels are kept in frame buffer) or 1 (monochrome, only counted) */
+} esp_lcd_mock_config_t;
+
+/**
+ * @brief Transfers recorded by the mocked panel
+ */
+typedef struct {
+    uint32_t draw_cnt;      /*!< Number of esp_lcd_panel_draw_bitmap() calls */
+    uint64_t draw_px;       /*!< Number of drawn pixels */
+    uint64_t draw_bytes;    /*!< Number of bytes, which would be sent to the panel */
+    bool     swap_xy;       /*!< Last value set by esp_lcd_panel_swap_xy() */
+    bool     mirror_x;      /*!< Last value set by esp_lcd_panel_mirror() */
+    bool     mirror_y;      /*!< Last value set by esp_lcd_panel_mirror() */
+} esp_lcd_mock_stats_t;
+
+/**
+ * @brief Create mocked panel and its IO
+ *
+ * @param config        Panel configuration
+ * @param[out] ret_io   Panel IO handle
+ * @param[out] ret_panel Panel handle
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *      - ESP_ERR_NO_MEM        if there is no memory for the frame buffer
+ */
+esp_err_t esp_lcd_new_panel_mock(const esp_lcd_mock_config_t *config, esp_lcd_panel_io_handle_t *ret_io, esp_lcd_panel_handle_t *ret_panel);
+
+/**
+ * @brief Get recorded transfers
+ *
+ * @param panel         Panel handle
+ * @param[out] stats    Recorded transfers
+ * @param reset         Clear the counters after reading
+ */
+void esp_lcd_mock_get_stats(esp_lcd_panel_handle_t panel, esp_lcd_mock_stats_t *stats, bool reset);
+
+/**
+ * @brief Get frame buffer with the drawn RGB565 pixels
+ *
+ * @param panel     Panel handle
+ * @return Frame buffer (`hres * vres` pixels) or NULL for monochrome panel
+ */
+const uint16_t *esp_lcd_mock_get_frame(esp_lcd_panel_handle_t panel);
+
+#ifdef __cplusplus
+}
+#endif
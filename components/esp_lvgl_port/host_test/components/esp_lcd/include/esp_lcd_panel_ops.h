@@ -0,0 +1,71 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Mocked esp_lcd panel operations (host tests)
+ *
+ * Only the part of the API used by esp_lvgl_port.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_lcd_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Draw bitmap on LCD panel
+ *
+ * @param panel     LCD panel handle
+ * @param x_start   Start pixel index in the target frame buffer, on x-axis (x_start is included)
+ * @param y_start   Start pixel index in the target frame buffer, on y-axis (y_start is included)
+ * @param x_end     End pixel index in the target frame buffer, on x-axis (x_end is not included)
+ * @param y_end     End pixel index in the target frame buffer, on y-axis (y_end is not included)
+ * @param color_data RGB color data that will be dumped to the specific window range
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if the window is out of the panel
+ */
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end, const void *color_data);
+
+/**
+ * @brief Mirror the LCD panel on specific axis
+ *
+ * @param panel     LCD panel handle
+ * @param mirror_x  Whether the panel will be mirrored about the x axis
+ * @param mirror_y  Whether the panel will be mirrored about the y axis
+ * @return
+ *      - ESP_OK                on success
+ */
+esp_err_t esp_lcd_panel_mirror(esp_lcd_panel_handle_t panel, bool mirror_x, bool mirror_y);
+
+/**
+ * @brief Swap/Exchange x and y axis
+ *
+ * @param panel     LCD panel handle
+ * @param swap_axes Whether to swap the x and y axis
+ * @return
+ *      - ESP_OK                on success
+ */
+esp_err_t esp_lcd_panel_swap_xy(esp_lcd_panel_handle_t panel, bool swap_axes);
+
+/**
+ * @brief Deinitialize the LCD panel
+ *
+ * @param panel     LCD panel handle
+ * @return
+ *      - ESP_OK                on success
+ */
+esp_err_t esp_lcd_panel_del(esp_lcd_panel_handle_t panel);
+
+#ifdef __cplusplus
+}
+#endif
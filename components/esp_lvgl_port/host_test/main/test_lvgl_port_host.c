@@ -0,0 +1,269 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "esp_lcd_mock.h"
+#include "esp_lvgl_port.h"
+
+#include "unity.h"
+
+/* Transform benchmark area (pixels) */
+#define TEST_AREA_W         (320)
+#define TEST_AREA_H         (48)
+#define TEST_AREA_SIZE      (TEST_AREA_W * TEST_AREA_H)
+#define TEST_ITERATIONS     (200)
+
+/* Refreshed frames in each flush scenario */
+#define TEST_FRAMES         (20)
+
+/*******************************************************************************
+* Transform cost per pixel
+*******************************************************************************/
+
+typedef enum {
+    TEST_TRANSFORM_SWAP,
+    TEST_TRANSFORM_SWAP_COPY,
+    TEST_TRANSFORM_ROTATE_90,
+    TEST_TRANSFORM_ROTATE_90_SWAP,
+    TEST_TRANSFORM_ROTATE_180,
+    TEST_TRANSFORM_ROTATE_270_SWAP,
+    TEST_TRANSFORM_L8,
+    TEST_TRANSFORM_MAX,
+} test_transform_t;
+
+static const char *const test_transform_names[TEST_TRANSFORM_MAX] = {
+    [TEST_TRANSFORM_SWAP] = "swap",
+    [TEST_TRANSFORM_SWAP_COPY] = "swap_copy",
+    [TEST_TRANSFORM_ROTATE_90] = "rotate_90",
+    [TEST_TRANSFORM_ROTATE_90_SWAP] = "rotate_90_swap",
+    [TEST_TRANSFORM_ROTATE_180] = "rotate_180",
+    [TEST_TRANSFORM_ROTATE_270_SWAP] = "rotate_270_swap",
+    [TEST_TRANSFORM_L8] = "l8_to_rgb565",
+};
+
+static void test_transform_run(test_transform_t transform, uint16_t *src, uint16_t *dst, const uint16_t *clut)
+{
+    switch (transform) {
+    case TEST_TRANSFORM_SWAP:
+        lvgl_port_transform_rgb565_swap(src, TEST_AREA_SIZE);
+        break;
+    case TEST_TRANSFORM_SWAP_COPY:
+        lvgl_port_transform_rgb565_swap_copy(dst, src, TEST_AREA_SIZE);
+        break;
+    case TEST_TRANSFORM_ROTATE_90:
+        lvgl_port_transform_rgb565_rotate(src, dst, TEST_AREA_W, TEST_AREA_H, LV_DISPLAY_ROTATION_90, false);
+        break;
+    case TEST_TRANSFORM_ROTATE_90_SWAP:
+        lvgl_port_transform_rgb565_rotate(src, dst, TEST_AREA_W, TEST_AREA_H, LV_DISPLAY_ROTATION_90, true);
+        break;
+    case TEST_TRANSFORM_ROTATE_180:
+        lvgl_port_transform_rgb565_rotate(src, dst, TEST_AREA_W, TEST_AREA_H, LV_DISPLAY_ROTATION_180, false);
+        break;
+    case TEST_TRANSFORM_ROTATE_270_SWAP:
+        lvgl_port_transform_rgb565_rotate(src, dst, TEST_AREA_W, TEST_AREA_H, LV_DISPLAY_ROTATION_270, true);
+        break;
+    case TEST_TRANSFORM_L8:
+        lvgl_port_transform_l8_to_rgb565((const uint8_t *)src, dst, TEST_AREA_SIZE, clut);
+        break;
+    default:
+        break;
+    }
+}
+
+TEST_CASE("Benchmark transform cost per pixel", "[lvgl port][host][benchmark]")
+{
+    uint16_t *src = malloc(TEST_AREA_SIZE * sizeof(uint16_t));
+    uint16_t *dst = malloc(TEST_AREA_SIZE * sizeof(uint16_t));
+    uint16_t *clut = malloc(256 * sizeof(uint16_t));
+    TEST_ASSERT_NOT_NULL(src);
+    TEST_ASSERT_NOT_NULL(dst);
+    TEST_ASSERT_NOT_NULL(clut);
+    for (int i = 0; i < TEST_AREA_SIZE; i++) {
+        src[i] = (uint16_t)(i * 7 + 3);
+    }
+    for (int i = 0; i < 256; i++) {
+        clut[i] = (uint16_t)(0xFFFF - i * 3);
+    }
+
+    for (test_transform_t t = 0; t < TEST_TRANSFORM_MAX; t++) {
+        /* Warm up caches */
+        test_transform_run(t, src, dst, clut);
+
+        const int64_t start = esp_timer_get_time();
+        for (int i = 0; i < TEST_ITERATIONS; i++) {
+            test_transform_run(t, src, dst, clut);
+        }
+        const int64_t duration = esp_timer_get_time() - start;
+
+        printf("BENCH;host;lvgl=%d;transform=%s;ns_px=%.2f\n", LVGL_VERSION_MAJOR, test_transform_names[t],
+               (double)duration * 1000 / ((double)TEST_ITERATIONS * TEST_AREA_SIZE));
+    }
+
+    free(src);
+    free(dst);
+    free(clut);
+}
+
+/*******************************************************************************
+* Flush scenarios
+*******************************************************************************/
+
+typedef struct {
+    const char *name;
+    int hres;
+    int vres;
+    uint32_t buff_lines;            /* Height of draw buffer */
+    bool monochrome;
+    bool swap_bytes;
+    bool sw_rotate;
+    lv_display_rotation_t rotation;
+    uint32_t trans_lines;           /* Height of transport buffer (0: not used) */
+    bool l8;                        /* L8 color format with CLUT */
+    uint32_t solid_lines;           /* Height of pattern buffer for solid color areas (0: not used) */
+} test_flush_cfg_t;
+
+static const test_flush_cfg_t test_flush_cfgs[] = {
+    {.name = "rgb565",          .hres = 320, .vres = 240, .buff_lines = 24},
+    {.name = "swap",            .hres = 320, .vres = 240, .buff_lines = 24, .swap_bytes = true},
+    {.name = "rot90",           .hres = 320, .vres = 240, .buff_lines = 24, .sw_rotate = true, .rotation = LV_DISPLAY_ROTATION_90},
+    {.name = "rot90_swap",      .hres = 320, .vres = 240, .buff_lines = 24, .sw_rotate = true, .rotation = LV_DISPLAY_ROTATION_90, .swap_bytes = true},
+    {.name = "rot180",          .hres = 320, .vres = 240, .buff_lines = 24, .sw_rotate = true, .rotation = LV_DISPLAY_ROTATION_180},
+    {.name = "trans_swap",      .hres = 320, .vres = 240, .buff_lines = 60, .swap_bytes = true, .trans_lines = 8},
+    {.name = "solid_swap",      .hres = 320, .vres = 240, .buff_lines = 24, .swap_bytes = true, .solid_lines = 4},
+    {.name = "solid_trans",     .hres = 320, .vres = 240, .buff_lines = 60, .swap_bytes = true, .trans_lines = 8, .solid_lines = 4},
+    {.name = "l8_clut",         .hres = 320, .vres = 240, .buff_lines = 60, .l8 = true, .trans_lines = 8},
+    {.name = "monochrome",      .hres = 128, .vres = 64,  .buff_lines = 64, .monochrome = true},
+};
+
+static uint16_t test_expected_color(const test_flush_cfg_t *cfg, lv_color_t color)
+{
+    const uint16_t c = lv_color_to_u16(color);
+    return cfg->swap_bytes ? (uint16_t)((c << 8) | (c >> 8)) : c;
+}
+
+static void test_flush_scenario(const test_flush_cfg_t *cfg)
+{
+    esp_lcd_panel_io_handle_t io = NULL;
+    esp_lcd_panel_handle_t panel = NULL;
+    const esp_lcd_mock_config_t mock_cfg = {
+        .hres = cfg->hres,
+        .vres = cfg->vres,
+        .bits_per_pixel = cfg->monochrome ? 1 : 16,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, esp_lcd_new_panel_mock(&mock_cfg, &io, &panel));
+
+    uint16_t clut[256];
+    for (int i = 0; i < 256; i++) {
+        clut[i] = (uint16_t)((i >> 3) << 11 | (i >> 2) << 5 | (i >> 3));
+    }
+
+    const lvgl_port_display_cfg_t disp_cfg = {
+        .io_handle = io,
+        .panel_handle = panel,
+        .buffer_size = cfg->hres * cfg->buff_lines,
+        .trans_size = cfg->hres * cfg->trans_lines,
+        .solid_size = cfg->hres * cfg->solid_lines,
+        .hres = cfg->hres,
+        .vres = cfg->vres,
+        .monochrome = cfg->monochrome,
+        .color_format = cfg->l8 ? LV_COLOR_FORMAT_L8 : LV_COLOR_FORMAT_RGB565,
+        .clut = cfg->l8 ? clut : NULL,
+        .flags = {
+            .swap_bytes = cfg->swap_bytes,
+            .sw_rotate = cfg->sw_rotate,
+        },
+    };
+    lv_display_t *disp = lvgl_port_add_disp(&disp_cfg);
+    TEST_ASSERT_NOT_NULL(disp);
+
+    lvgl_port_lock(0);
+    lv_display_set_rotation(disp, cfg->rotation);
+    lv_obj_t *scr = lv_display_get_screen_active(disp);
+    lv_obj_set_style_bg_opa(scr, LV_OPA_COVER, 0);
+    lv_obj_set_style_bg_color(scr, lv_color_black(), 0);
+    lv_refr_now(disp);
+    lvgl_port_unlock();
+
+    esp_lcd_mock_stats_t stats;
+    esp_lcd_mock_get_stats(panel, &stats, true);
+
+    /* Whole screen changes in each frame, all pixels are sent */
+    uint64_t flush_us = 0, flush_px = 0, solid_px = 0;
+    const int64_t start = esp_timer_get_time();
+    for (int i = 0; i < TEST_FRAMES; i++) {
+        const lv_color_t color = (i % 2 == 0) ? lv_color_white() : lv_color_black();
+        lvgl_port_lock(0);
+        lv_obj_set_style_bg_color(scr, color, 0);
+        lv_refr_now(disp);
+        lvgl_port_unlock();
+
+        lvgl_port_disp_perf_t perf;
+        TEST_ASSERT_EQUAL(ESP_OK, lvgl_port_disp_get_perf(disp, &perf));
+        flush_us += perf.flush_time;
+        flush_px += perf.flush_px;
+        solid_px += perf.solid_px;
+
+        const uint16_t *frame = esp_lcd_mock_get_frame(panel);
+        if (frame && !cfg->l8) {
+            TEST_ASSERT_EQUAL_HEX16(test_expected_color(cfg, color), frame[0]);
+            TEST_ASSERT_EQUAL_HEX16(test_expected_color(cfg, color), frame[cfg->hres * cfg->vres - 1]);
+        }
+    }
+    const int64_t duration = esp_timer_get_time() - start;
+
+    esp_lcd_mock_get_stats(panel, &stats, true);
+    const uint64_t frame_bytes = (uint64_t)cfg->hres * cfg->vres * mock_cfg.bits_per_pixel / 8;
+
+    /* Machine-readable output, one line per scenario */
+    printf("BENCH;host;lvgl=%d;cfg=%s;draw_calls=%.1f;bytes=%" PRIu64 ";flush_ns_px=%.2f;frame_us=%.1f\n",
+           LVGL_VERSION_MAJOR, cfg->name, (double)stats.draw_cnt / TEST_FRAMES, stats.draw_bytes / TEST_FRAMES,
+           flush_px ? (double)flush_us * 1000 / flush_px : 0.0, (double)duration / TEST_FRAMES);
+
+    TEST_ASSERT_EQUAL_UINT64(frame_bytes * TEST_FRAMES, stats.draw_bytes);
+    TEST_ASSERT_GREATER_OR_EQUAL(TEST_FRAMES, stats.draw_cnt);
+
+    /* Background of one color is sent whole from the pattern buffer */
+    if (cfg->solid_lines) {
+        TEST_ASSERT_EQUAL_UINT64(flush_px, solid_px);
+    }
+
+    /* Monochrome display sends only changed pages */
+    if (cfg->monochrome) {
+        lvgl_port_lock(0);
+        lv_obj_invalidate(scr);
+        lv_refr_now(disp);
+        lvgl_port_unlock();
+        esp_lcd_mock_get_stats(panel, &stats, true);
+        TEST_ASSERT_EQUAL_UINT32(0, stats.draw_cnt);
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, lvgl_port_remove_disp(disp));
+    esp_lcd_panel_del(panel);
+    esp_lcd_panel_io_del(io);
+}
+
+TEST_CASE("Benchmark flush scenarios", "[lvgl port][host][benchmark]")
+{
+    const lvgl_port_cfg_t lvgl_cfg = ESP_LVGL_PORT_INIT_CONFIG();
+    TEST_ASSERT_EQUAL(ESP_OK, lvgl_port_init(&lvgl_cfg));
+
+    for (size_t i = 0; i < sizeof(test_flush_cfgs) / sizeof(test_flush_cfgs[0]); i++) {
+        test_flush_scenario(&test_flush_cfgs[i]);
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, lvgl_port_deinit());
+}
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    unity_run_all_tests();
+    exit(UNITY_END());
+}
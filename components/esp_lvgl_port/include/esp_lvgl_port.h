@@ -12,12 +12,26 @@
 #pragma once
 
 #include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "lvgl.h"
 #include "esp_lvgl_port_disp.h"
 #include "esp_lvgl_port_touch.h"
 #include "esp_lvgl_port_knob.h"
 #include "esp_lvgl_port_button.h"
 #include "esp_lvgl_port_usbhid.h"
+#include "esp_lvgl_port_transform.h"
+#include "esp_lvgl_port_cache.h"
+#include "esp_lvgl_port_jpeg.h"
+#include "esp_lvgl_port_mem.h"
+#include "esp_lvgl_port_font.h"
+#include "esp_lvgl_port_ppa.h"
+#include "esp_lvgl_port_mirror.h"
+#include "esp_lvgl_port_screenshot.h"
+#include "esp_lvgl_port_screen.h"
+#include "esp_lvgl_port_bind.h"
+#include "esp_lvgl_port_atlas.h"
+#include "esp_lvgl_port_prefetch.h"
 
 #if LVGL_VERSION_MAJOR == 8
 #include "esp_lvgl_port_compatibility.h"
@@ -44,6 +58,69 @@ typedef struct {
     void *param;
 } lvgl_port_event_t;
 
+/**
+ * @brief LVGL lock statistics
+ */
+typedef struct {
+    uint32_t     lock_cnt;      /*!< Number of taken locks (recursive locks are not counted) */
+    uint32_t     contended_cnt; /*!< Number of locks, which had to wait for another task holding the lock */
+    uint32_t     wait_time_max; /*!< Maximum time of waiting for the lock in [us] */
+    uint64_t     wait_time_sum; /*!< Sum of waiting times for the lock in [us] */
+    uint32_t     hold_time_max; /*!< Maximum time of holding the lock in [us] */
+    uint64_t     hold_time_sum; /*!< Sum of holding times of the lock in [us] */
+    TaskHandle_t owner;         /*!< Task, which holds the lock now (NULL: lock is free) */
+} lvgl_port_lock_stats_t;
+
+/**
+ * @brief Function called in LVGL task with taken LVGL lock
+ */
+typedef void (*lvgl_port_async_cb_t)(void *user_data);
+
+/**
+ * @brief Stages of the touch-to-photon path reported to the trace callback
+ */
+typedef enum {
+    LVGL_PORT_TRACE_TOUCH_IRQ,  /*!< Touch controller interrupt (called from ISR) */
+    LVGL_PORT_TRACE_TASK_WAKE,  /*!< LVGL task woke up with pending input events */
+    LVGL_PORT_TRACE_TOUCH_READ, /*!< Touch controller was read and it is pressed (area is the touch point) */
+    LVGL_PORT_TRACE_RENDER,     /*!< Display refresh started, LVGL renders invalidated areas */
+    LVGL_PORT_TRACE_FLUSH,      /*!< Rendered area was passed to the flush callback */
+    LVGL_PORT_TRACE_FLUSH_DONE, /*!< Flushed area was sent to the panel (area of the last flush, can be called from ISR) */
+} lvgl_port_trace_stage_t;
+
+/**
+ * @brief Trace callback
+ *
+ * @note It is called from ISR for some stages, it must be short and placed in IRAM.
+ *
+ * @param stage     Stage of the path
+ * @param time_us   Timestamp from esp_timer in [us]
+ * @param area      Display area or touch point (NULL, if not related to any area)
+ * @param user_ctx  User context from lvgl_port_set_trace_cb
+ */
+typedef void (*lvgl_port_trace_cb_t)(lvgl_port_trace_stage_t stage, int64_t time_us, const lv_area_t *area, void *user_ctx);
+
+/**
+ * @brief Power management levels of the LVGL task (flags.pm_lock, flags.pm_governor)
+ */
+typedef enum {
+    LVGL_PORT_PM_LEVEL_IDLE,    /*!< LVGL task sleeps, it holds no lock */
+    LVGL_PORT_PM_LEVEL_LOW,     /*!< LVGL task works with ESP_PM_APB_FREQ_MAX lock (governor only) */
+    LVGL_PORT_PM_LEVEL_HIGH,    /*!< LVGL task works with ESP_PM_CPU_FREQ_MAX lock */
+    LVGL_PORT_PM_LEVEL_MAX,
+} lvgl_port_pm_level_t;
+
+/**
+ * @brief Power management statistics of the LVGL task
+ */
+typedef struct {
+    uint64_t             time_us[LVGL_PORT_PM_LEVEL_MAX];   /*!< Residency time in each level [us] */
+    uint32_t             frames[LVGL_PORT_PM_LEVEL_MAX];    /*!< Rendered frames in each level (IDLE is always 0) */
+    uint32_t             missed;    /*!< Frames with render time longer than the target frame period */
+    uint32_t             boosts;    /*!< Switches to HIGH level (missed deadline, animation start or input) */
+    lvgl_port_pm_level_t level;     /*!< Level of the next work of the LVGL task */
+} lvgl_port_pm_stats_t;
+
 /**
  * @brief Init configuration structure
  */
@@ -52,7 +129,15 @@ typedef struct {
     int task_stack;         /*!< LVGL task stack size */
     int task_affinity;      /*!< LVGL task pinned to core (-1 is no affinity) */
     int task_max_sleep_ms;  /*!< Maximum sleep in LVGL task */
-    int timer_period_ms;    /*!< LVGL timer tick period in ms */
+    int timer_period_ms;    /*!< LVGL timer tick period in ms (LVGL8 without LV_TICK_CUSTOM only, LVGL9 reads the tick from esp_timer) */
+    int pm_frame_ms;        /*!< Target frame period of the PM governor in ms (0: LV_DEF_REFR_PERIOD) */
+    int task_boost_priority; /*!< Priority of LVGL task after input activity, it must be higher than task_priority (0: no boost, LVGL9 only) */
+    int task_boost_ms;      /*!< Boost window after the last input activity in ms (0: 300 ms) */
+    struct {
+        unsigned int idle_tick_stop: 1; /*!< Wait for wake-up only, when LVGL is idle (no periodic task wake-up). Wake-up via lvgl_port_task_wake or lvgl_port_lock (LVGL9 only) */
+        unsigned int pm_lock: 1;        /*!< Hold power management locks only while LVGL renders (CPU max) and flushes (APB max), so the chip can enter light sleep between frames (needs CONFIG_PM_ENABLE, LVGL9 only) */
+        unsigned int pm_governor: 1;    /*!< With pm_lock: render with APB max lock and hold CPU max only for frames close to the deadline, animation starts and input (LVGL9 only) */
+    } flags;
 } lvgl_port_cfg_t;
 
 /**
@@ -109,6 +194,65 @@ bool lvgl_port_lock(uint32_t timeout_ms);
  */
 void lvgl_port_unlock(void);
 
+/**
+ * @brief Get statistics of the LVGL mutex
+ *
+ * @note The LVGL mutex has priority inheritance. When the LVGL task waits for the lock, the holder runs with the LVGL task priority.
+ *
+ * @param stats Output statistics
+ * @param reset Reset the counters after read
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if stats is NULL
+ *      - ESP_ERR_INVALID_STATE     if lvgl_port_init was not called
+ */
+esp_err_t lvgl_port_get_lock_stats(lvgl_port_lock_stats_t *stats, bool reset);
+
+/**
+ * @brief Get power management statistics of the LVGL task
+ *
+ * @note The statistics are collected with flags.pm_lock or flags.pm_governor (LVGL9 only).
+ *
+ * @param stats Output statistics
+ * @param reset Reset the counters after read
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if stats is NULL
+ *      - ESP_ERR_INVALID_STATE     if lvgl_port_init was not called or PM locks are not used
+ *      - ESP_ERR_NOT_SUPPORTED     if used LVGL8
+ */
+esp_err_t lvgl_port_get_pm_stats(lvgl_port_pm_stats_t *stats, bool reset);
+
+/**
+ * @brief Call function in LVGL task with taken LVGL lock
+ *
+ * @note The caller does not need the LVGL lock. It can be used for UI updates from tasks, which should not wait for the lock.
+ * @note The calls are stored in a lock-free ring buffer (16 entries), this function never blocks and it can be called from ISR.
+ *
+ * @param cb        Function to be called
+ * @param user_data Parameter of the function
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if cb is NULL
+ *      - ESP_ERR_INVALID_STATE     if lvgl_port_init was not called
+ *      - ESP_ERR_TIMEOUT           if there are too many pending calls
+ */
+esp_err_t lvgl_port_async_call(lvgl_port_async_cb_t cb, void *user_data);
+
+/**
+ * @brief Set callback for timestamps of the touch-to-photon path (LVGL9 only)
+ *
+ * @note It is used for latency measurement. Without callback, each stage costs only one NULL check.
+ * @note With transport buffer (`trans_size`), LVGL_PORT_TRACE_FLUSH_DONE is reported after the copy of the last chunk, before its transfer ends.
+ *
+ * @param cb        Trace callback (NULL: disable tracing)
+ * @param user_ctx  User context passed to the callback
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_NOT_SUPPORTED     if used with LVGL8
+ */
+esp_err_t lvgl_port_set_trace_cb(lvgl_port_trace_cb_t cb, void *user_ctx);
+
 /**
  * @brief Notify LVGL, that data was flushed to LCD display
  *
@@ -138,10 +282,46 @@ esp_err_t lvgl_port_stop(void);
  */
 esp_err_t lvgl_port_resume(void);
 
+/**
+ * @brief Park LVGL port (LVGL9 only)
+ *
+ * Stops LVGL timers (as lvgl_port_stop), waits for the last flush of each display and switches its panel off.
+ * With `release_buffers`, draw buffers, rotation and transport buffers of all displays are freed, so that their
+ * memory can be used by other parts of the application (e.g. camera or audio). LVGL objects, styles and input devices
+ * are kept, the task is not deleted. Input devices are not read while parked.
+ *
+ * @note RGB frame buffers are owned by the LCD driver and they are not freed. RGB panels keep refreshing.
+ * @note Draw buffers of the ring (`buffer_count`) are not freed.
+ * @note Nothing can be rendered while parked, do not call `lv_refr_now`.
+ *
+ * @param release_buffers Free the display buffers
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_STATE     if lvgl_port_init was not called or the port is already parked
+ *      - ESP_ERR_TIMEOUT           if the last flush of some display did not finish, already parked displays are unparked and the port keeps running
+ *      - ESP_ERR_NOT_SUPPORTED     if used with LVGL8
+ */
+esp_err_t lvgl_port_park(bool release_buffers);
+
+/**
+ * @brief Unpark LVGL port (LVGL9 only)
+ *
+ * The released buffers are allocated again with the same size and memory capabilities, panels are switched on
+ * and whole screens are rendered in the next frame. LVGL timers are resumed (as lvgl_port_resume).
+ *
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_STATE     if lvgl_port_init was not called or the port is not parked
+ *      - ESP_ERR_NO_MEM            if the buffers cannot be allocated, the port stays parked (call it again later)
+ *      - ESP_ERR_NOT_SUPPORTED     if used with LVGL8
+ */
+esp_err_t lvgl_port_unpark(void);
+
 /**
  * @brief Notify LVGL task, that display need reload
  *
  * @note It is called from LVGL events and touch interrupts
+ * @note Events are not queued. More events before the LVGL task wakes up are handled at once, each input device is read only once.
  *
  * @param event     event type
  * @param param     user param
@@ -0,0 +1,76 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port sprite atlas
+ *
+ * Icons packed by `lvgl_port_create_c_atlas()` (see project_include.cmake) are one image in flash. Sub-image descriptors
+ * point into the atlas rows, nothing is copied.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief Position of one sub-image in the atlas
+ */
+typedef struct {
+    const char  *name;      /*!< Name of the sub-image (file name of the icon without extension) */
+    uint16_t    x;          /*!< Left column in the atlas */
+    uint16_t    y;          /*!< Top row in the atlas */
+    uint16_t    w;          /*!< Width of the sub-image */
+    uint16_t    h;          /*!< Height of the sub-image */
+} lvgl_port_atlas_rect_t;
+
+/**
+ * @brief Atlas generated by `lvgl_port_create_c_atlas()`
+ */
+typedef struct {
+    const lv_image_dsc_t        *image;     /*!< Atlas image */
+    const lvgl_port_atlas_rect_t *rects;    /*!< Sub-images sorted by name */
+    uint32_t                    count;      /*!< Count of the sub-images */
+} lvgl_port_atlas_t;
+
+/**
+ * @brief Initialize image descriptor of one sub-image
+ *
+ * The descriptor has the stride of the atlas and its data point into the atlas image.
+ *
+ * @note The descriptor is used by LVGL after lv_image_set_src(), it must not be a local variable.
+ * @note Formats with whole bytes per pixel are supported (not indexed, not RGB565A8), the atlas must not be compressed.
+ *
+ * @param atlas     Atlas
+ * @param index     Index of the sub-image (generated `<NAME>_<ICON>` constant or lvgl_port_atlas_find())
+ * @param ret_dsc   Output image descriptor
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_NOT_SUPPORTED     if the color format of the atlas does not allow sub-images
+ */
+esp_err_t lvgl_port_atlas_get(const lvgl_port_atlas_t *atlas, uint32_t index, lv_image_dsc_t *ret_dsc);
+
+/**
+ * @brief Find sub-image by name
+ *
+ * @param atlas Atlas
+ * @param name  Name of the sub-image
+ * @return Index of the sub-image, -1 if it is not in the atlas
+ */
+int32_t lvgl_port_atlas_find(const lvgl_port_atlas_t *atlas, const char *name);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
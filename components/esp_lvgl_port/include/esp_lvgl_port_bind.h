@@ -0,0 +1,88 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port binding of numeric values to labels
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief Maximum number of values in one binding
+ */
+#define LVGL_PORT_BIND_VALUES_MAX   4
+
+/**
+ * @brief Handle of value binding
+ */
+typedef struct lvgl_port_bind_s *lvgl_port_bind_handle_t;
+
+/**
+ * @brief Configuration of value binding
+ */
+typedef struct {
+    lv_obj_t    *label;         /*!< Label showing the values */
+    const char  *fmt;           /*!< Format of the label text, values are passed as double (only %f, %e and %g conversions, e.g. "Temp: %.1f") */
+    uint32_t    value_count;    /*!< Number of values in the format (1 - LVGL_PORT_BIND_VALUES_MAX) */
+    float       epsilon;        /*!< Changes of the values smaller than epsilon are ignored (0: any change is formatted) */
+} lvgl_port_bind_cfg_t;
+
+/**
+ * @brief Bind numeric values to a label
+ *
+ * The values are set from any task without the LVGL lock. Changed values are formatted in LVGL task once before
+ * the next frame, the label text is set only when the formatted text differs from the shown one, so values
+ * changing below the display precision do not invalidate the label.
+ *
+ * @note The format string must be valid until the binding is deleted.
+ * @note The binding is stopped, when the label is deleted. Delete the binding by lvgl_port_bind_delete anyway.
+ *
+ * @param cfg           Configuration of the binding
+ * @param ret_handle    Output handle of the binding
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_NO_MEM            if there is not enough memory for the binding
+ */
+esp_err_t lvgl_port_bind_create(const lvgl_port_bind_cfg_t *cfg, lvgl_port_bind_handle_t *ret_handle);
+
+/**
+ * @brief Set values of the binding
+ *
+ * @note It can be called from any task, the LVGL lock is not needed (it must not be called from ISR).
+ *
+ * @param handle    Handle of the binding
+ * @param values    New values
+ * @param count     Number of the values (at most value_count from configuration), the rest is kept
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ */
+esp_err_t lvgl_port_bind_set(lvgl_port_bind_handle_t handle, const float *values, uint32_t count);
+
+/**
+ * @brief Delete the binding, the label is kept
+ *
+ * @param handle    Handle of the binding
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if the handle is not valid
+ */
+esp_err_t lvgl_port_bind_delete(lvgl_port_bind_handle_t handle);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
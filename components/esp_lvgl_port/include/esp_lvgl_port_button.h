@@ -36,6 +36,10 @@ typedef struct {
     const button_config_t *button_prev;   /*!< Navigation button for previous */
     const button_config_t *button_next;   /*!< Navigation button for next */
     const button_config_t *button_enter;  /*!< Navigation button for enter */
+    uint16_t debounce_ms;                 /*!< Debounce time of buttons read by GPIO interrupt [ms] (0 = 20 ms) */
+    struct {
+        unsigned int gpio_interrupt: 1;   /*!< Read GPIO buttons (BUTTON_TYPE_GPIO) by edge interrupt instead of periodic scanning in button component */
+    } flags;
 } lvgl_port_nav_btns_cfg_t;
 
 /**
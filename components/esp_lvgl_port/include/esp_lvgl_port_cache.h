@@ -0,0 +1,85 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port layer cache
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief Handle of cached object subtree
+ */
+typedef struct lvgl_port_cache_s *lvgl_port_cache_handle_t;
+
+/**
+ * @brief Configuration of the layer cache structure
+ */
+typedef struct {
+    lv_obj_t            *obj;           /*!< Root of the static object subtree, which will be cached */
+    lv_color_format_t   color_format;   /*!< Color format of the cached pixels (0: color format of the display, use `LV_COLOR_FORMAT_ARGB8888` for not opaque subtree) */
+    struct {
+        unsigned int buff_spiram: 1;    /*!< Cached pixels will be in PSRAM (internal RAM otherwise) */
+    } flags;
+} lvgl_port_cache_cfg_t;
+
+/**
+ * @brief Render object subtree into the cache
+ *
+ * The subtree is rendered once and hidden. An image with the cached pixels is shown on its place,
+ * so the redrawn areas overlapping the subtree are blitted from the cache instead of rendering of the subtree.
+ *
+ * @note The cached subtree does not get input events and its changes are not visible until lvgl_port_cache_update is called.
+ * @note Requires LVGL 9.1 or newer with `LV_USE_SNAPSHOT` enabled.
+ *
+ * @param cache_cfg Layer cache configuration structure
+ * @param ret_cache Output handle of the cache
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_NO_MEM            if there is not enough memory for cached pixels
+ *      - ESP_ERR_NOT_SUPPORTED     if LVGL snapshot is not enabled
+ */
+esp_err_t lvgl_port_cache_create(const lvgl_port_cache_cfg_t *cache_cfg, lvgl_port_cache_handle_t *ret_cache);
+
+/**
+ * @brief Render the cached subtree again (after its change)
+ *
+ * @note When the size of the subtree was changed, the cached pixels are reallocated.
+ *
+ * @param cache Handle of the cache
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if the handle is not valid
+ *      - ESP_ERR_NO_MEM            if there is not enough memory for cached pixels
+ */
+esp_err_t lvgl_port_cache_update(lvgl_port_cache_handle_t cache);
+
+/**
+ * @brief Remove the cache and show the original subtree
+ *
+ * @note Free all memory used for this cache.
+ *
+ * @param cache Handle of the cache
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if the handle is not valid
+ */
+esp_err_t lvgl_port_cache_delete(lvgl_port_cache_handle_t cache);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -44,6 +44,15 @@ typedef struct {
     uint32_t    buffer_size;        /*!< Size of the buffer for the screen in pixels */
     bool        double_buffer;      /*!< True, if should be allocated two buffers */
     uint32_t    trans_size;         /*!< Allocated buffer will be in SRAM to move framebuf (optional) */
+#if LVGL_VERSION_MAJOR >= 9
+    uint8_t     trans_count;        /*!< Number of transport buffers in flight, 2 to 4 (optional, 0: two buffers, used only with `trans_size`) */
+    uint32_t    merge_overhead;     /*!< Cost of one transfer in pixels. Invalidated areas are merged, when the merged area is cheaper to send (optional, only partial mode) */
+    uint32_t    refresh_period_ms;  /*!< Period of LVGL refresh of this display in [ms] (optional, 0: `LV_DEF_REFR_PERIOD`) */
+    uint32_t    solid_size;         /*!< Size of internal pattern buffer in pixels, areas of one color are sent from it (optional, 0: not used, RGB565 SPI/I80 display only, at least one line) */
+    uint8_t     buffer_count;       /*!< Number of partial draw buffers in ring, 2 to 4, flushed buffers are sent directly while LVGL renders into a free one (optional, 0: `double_buffer`, SPI/I80 display only) */
+#endif
+
+    int         te_gpio_num;    /*!< GPIO connected to TE (tearing effect) output of the LCD (used only with `flags.te_sync`) */
 
     uint32_t    hres;           /*!< LCD display horizontal resolution */
     uint32_t    vres;           /*!< LCD display vertical resolution */
@@ -53,16 +62,28 @@ typedef struct {
     lvgl_port_rotation_cfg_t rotation;      /*!< Default values of the screen rotation */
 #if LVGL_VERSION_MAJOR >= 9
     lv_color_format_t        color_format;  /*!< The color format of the display */
+    const uint16_t           *clut;         /*!< 256 RGB565 colors for indexes of `LV_COLOR_FORMAT_L8` (used only with L8, `trans_size` needed, copied in add display) */
+
+    struct {
+        int task_priority;  /*!< Flush task priority */
+        int task_stack;     /*!< Flush task stack size (0: default 4096) */
+        int task_affinity;  /*!< Flush task pinned to core (-1 is no affinity) */
+    } flush_task;           /*!< Flush task configuration (used only with `flags.flush_in_task`) */
 #endif
     struct {
         unsigned int buff_dma: 1;    /*!< Allocated LVGL buffer will be DMA capable */
         unsigned int buff_spiram: 1; /*!< Allocated LVGL buffer will be in PSRAM */
         unsigned int sw_rotate: 1;   /*!< Use software rotation (slower) or PPA if available */
+        unsigned int buff_auto: 1;   /*!< Choose size, count and memory of draw buffers by free memory (`buffer_size`, `double_buffer`, `buff_dma` and `buff_spiram` are ignored) */
+        unsigned int swap_bytes: 1;  /*!< Swap bytes in RGB656 (16-bit) color format before send to LCD driver (LVGL8: instead of `LV_COLOR_16_SWAP`, SPI/I80 display) */
 #if LVGL_VERSION_MAJOR >= 9
-        unsigned int swap_bytes: 1;  /*!< Swap bytes in RGB656 (16-bit) color format before send to LCD driver */
+        unsigned int flush_in_task: 1; /*!< Transform and send data to LCD in a separate flush task, LVGL renders into the second buffer meanwhile (`double_buffer` needed) */
+        unsigned int tile_hash: 1;   /*!< Keep CRC32 of 16x16 tiles sent to the panel and do not send unchanged tiles again (SPI/I80 display with `trans_size`, without `direct_mode` and `monochrome`) */
 #endif
         unsigned int full_refresh: 1;/*!< 1: Always make the whole screen redrawn */
         unsigned int direct_mode: 1; /*!< 1: Use screen-sized buffers and draw to absolute coordinates */
+        unsigned int te_sync: 1;     /*!< 1: The first flush of each frame waits for TE pulse on `te_gpio_num` (SPI/I80 display, TE must be enabled in LCD driver) */
+        unsigned int round_mask: 1;  /*!< 1: Do not send pixels outside the inscribed circle of round display (SPI/I80 display with `hres == vres`, without `trans_size`, `direct_mode` and `monochrome`) */
     } flags;
 } lvgl_port_display_cfg_t;
 
@@ -73,6 +94,11 @@ typedef struct {
     struct {
         unsigned int bb_mode: 1;        /*!< 1: Use bounce buffer mode */
         unsigned int avoid_tearing: 1;  /*!< 1: Use internal RGB buffers as a LVGL draw buffers to avoid tearing effect */
+        unsigned int triple_buffer: 1;  /*!< 1: Use three internal RGB buffers (`num_fbs = 3` in RGB panel, `avoid_tearing` and `full_refresh` needed), LVGL does not wait for VSYNC after each frame */
+#if LVGL_VERSION_MAJOR >= 9
+        unsigned int compressed_fb: 1;  /*!< 1: Lines are stored RLE compressed in PSRAM and decompressed into bounce buffers (RGB panel with `no_fb` and bounce buffer, partial mode) */
+        unsigned int dma_copy: 1;       /*!< 1: Draw buffers (internal DMA memory) are copied into the frame buffer by GDMA, the flush does not block LVGL task (partial mode, RGB565, ESP-IDF 5.2 and newer) */
+#endif
     } flags;
 } lvgl_port_display_rgb_cfg_t;
 
@@ -81,8 +107,103 @@ typedef struct {
  */
 typedef struct {
     int dummy;
+#if LVGL_VERSION_MAJOR >= 9
+    struct {
+        unsigned int fb_rgb888: 1;  /*!< 1: Frame buffer of the DPI panel is RGB888 while LVGL renders RGB565 (`color_format`), PPA converts the flushed areas (ESP32-P4) */
+    } flags;
+#endif
 } lvgl_port_display_dsi_cfg_t;
 
+/* Number of bins of the flush latency histogram in lvgl_port_disp_perf_t */
+#define LVGL_PORT_PERF_HIST_BINS        (8)
+/* Upper limit of the first bin of the flush latency histogram [us], each next bin doubles it */
+#define LVGL_PORT_PERF_HIST_FIRST_US    (250U)
+
+/**
+ * @brief Display performance counters (values of the last refreshed frame)
+ */
+typedef struct {
+    uint32_t frame_cnt;     /*!< Number of refreshed frames since the display was added */
+    uint32_t frame_time;    /*!< Duration of the whole frame refresh in [us] */
+    uint32_t render_time;   /*!< Time of rendering in [us] (frame time without flush callbacks, includes waiting for free draw buffer) */
+    uint32_t flush_time;    /*!< Time spent in flush callbacks in [us] (transformations, copying and queueing of the data) */
+    uint32_t trans_time;    /*!< Time of data transfer into LCD in [us] (sum of times from flush start to flush ready, with transport buffers the time when any transport buffer was being sent) */
+    uint32_t flush_cnt;     /*!< Number of flush callbacks */
+    uint32_t flush_px;      /*!< Number of flushed pixels */
+    uint32_t solid_px;      /*!< Number of flushed pixels sent from the pattern buffer as areas of one color (`solid_size`) */
+    uint32_t skip_px;       /*!< Number of flushed pixels not sent, because their tiles did not change (`tile_hash`) */
+    uint32_t te_period;     /*!< Refresh period of the panel measured from TE pulses in [us] (0: TE is not used) */
+    uint32_t vsync_drop;    /*!< Refresh periods of the panel (RGB VSYNC or TE) missed by the frame, the frame can take one period (LVGL9) */
+    uint32_t lock_contended; /*!< Number of LVGL locks during the frame, which had to wait for another task (LVGL9) */
+    uint32_t lock_wait;     /*!< Sum of waiting times for the LVGL lock during the frame in [us] (LVGL9) */
+    uint16_t flush_hist[LVGL_PORT_PERF_HIST_BINS]; /*!< Histogram of flush latencies (flush start to flush ready) of the frame, bin `i` counts latencies
+                                                        below `LVGL_PORT_PERF_HIST_FIRST_US << i` (the last bin all longer) (LVGL9) */
+} lvgl_port_disp_perf_t;
+
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief Statistics of the SPI bus shared by the display and the touch controller (since the last reset)
+ */
+typedef struct {
+    uint32_t period;            /*!< Duration of the measurement in [us] */
+    uint32_t busy_time;         /*!< Sum of times from flush start to flush ready in [us] */
+    uint32_t utilization;       /*!< Display part of the bus time in [%] (`busy_time` / `period`) */
+    uint32_t touch_reads;       /*!< Number of touch reads with `bus_wait_ms` */
+    uint32_t touch_wait_max;    /*!< Longest wait of a touch read for the gap between display transfers in [us] */
+    uint32_t touch_timeouts;    /*!< Number of touch reads, which did not get the gap in `bus_wait_ms` and were read anyway */
+} lvgl_port_disp_bus_stats_t;
+#endif
+
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief Hardware vertical scrolling functions of the LCD driver
+ */
+typedef struct {
+    esp_err_t (*set_area)(esp_lcd_panel_handle_t panel, uint16_t top, uint16_t height);   /*!< Define scrolling area and reset the offset (e.g. `esp_lcd_ili9341_set_scroll_area`) */
+    esp_err_t (*set_offset)(esp_lcd_panel_handle_t panel, uint16_t offset);               /*!< Set scrolling offset (e.g. `esp_lcd_ili9341_set_scroll_offset`) */
+} lvgl_port_hw_scroll_cfg_t;
+
+/**
+ * @brief Callback switching the panel into or out of its low-power mode
+ *
+ * @note It is called from LVGL task with the LVGL lock taken
+ *
+ * @param panel     LCD panel handle (control handle, if it was set in the display configuration)
+ * @param enable    True to enter the low-power mode, false to return to normal mode
+ * @param user_ctx  User data from the configuration
+ * @return
+ *      - ESP_OK on success
+ */
+typedef esp_err_t (*lvgl_port_low_power_cb_t)(esp_lcd_panel_handle_t panel, bool enable, void *user_ctx);
+
+/**
+ * @brief Configuration of automatic panel low-power mode
+ */
+typedef struct {
+    uint32_t                  timeout_ms; /*!< Time without invalidation of the display, after which the panel enters low-power mode */
+    lvgl_port_low_power_cb_t  cb;         /*!< Switching of the panel mode (e.g. idle mode and lower frame rate of the LCD driver) */
+    void                      *user_ctx;  /*!< User data for the callback */
+} lvgl_port_low_power_cfg_t;
+
+/**
+ * @brief Configuration of frame pacing
+ */
+typedef struct {
+    uint32_t fps;       /*!< Target frame rate (0: pacing disabled) */
+    bool     te_align;  /*!< Round the frame period to whole refresh periods of the panel measured from TE pulses (`te_gpio_num`) */
+} lvgl_port_frame_pacing_cfg_t;
+
+/**
+ * @brief Statistics of frame pacing
+ */
+typedef struct {
+    uint32_t frames;        /*!< Count of paced frames */
+    uint32_t slipped;       /*!< Count of frame periods missed, because the render started one or more periods after its deadline */
+    uint32_t period_us;     /*!< Frame period in [us] (rounded to the panel refresh period with `te_align`) */
+    uint32_t jitter_max_us; /*!< Maximum delay of the render start after its deadline in [us] */
+} lvgl_port_frame_pacing_stats_t;
+#endif
+
 /**
  * @brief Add I2C/SPI/I8080 display handling to LVGL
  *
@@ -125,6 +246,140 @@ lv_display_t *lvgl_port_add_disp_rgb(const lvgl_port_display_cfg_t *disp_cfg, co
  */
 esp_err_t lvgl_port_remove_disp(lv_display_t *disp);
 
+/**
+ * @brief Get performance counters of the last refreshed frame
+ *
+ * @param disp LVGL display handle (returned from lvgl_port_add_disp)
+ * @param perf Output performance counters
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_INVALID_STATE     if the display was not added by LVGL port
+ */
+esp_err_t lvgl_port_disp_get_perf(lv_display_t *disp, lvgl_port_disp_perf_t *perf);
+
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief Get statistics of the SPI bus shared with the touch controller (`bus_wait_ms` of the touch)
+ *
+ * @param disp  LVGL display handle (returned from lvgl_port_add_disp)
+ * @param stats Output statistics
+ * @param reset Start a new measurement
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_INVALID_STATE     if the display was not added by LVGL port
+ */
+esp_err_t lvgl_port_disp_get_bus_stats(lv_display_t *disp, lvgl_port_disp_bus_stats_t *stats, bool reset);
+#endif
+
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief Map vertical scrolling of the container onto hardware scrolling of the LCD controller
+ *
+ * The rows of the container are the scrolling area of the panel. When the container is scrolled, the panel shows
+ * its memory with the new scrolling offset and LVGL redraws only the newly exposed rows (and the scrollbar column)
+ * instead of the whole container. The rows above and below the container are fixed.
+ *
+ * @note The container must span the whole width of the display, it must not move or resize and no other object may overlap it.
+ *       Its background must be plain (no gradient, image or top/bottom border), because it moves with the content.
+ * @note Supported with SPI/I80 displays in partial mode without `trans_size`, `round_mask`, `flush_in_task` and SW rotation.
+ *       The panel must not have swapped axes (portrait orientation of ILI9341 and ST7796). It is detached on display rotation.
+ *
+ * @param disp       LVGL display handle (returned from lvgl_port_add_disp)
+ * @param obj        Scrolled container (e.g. full-height list)
+ * @param scroll_cfg Scrolling functions of the LCD driver
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid (e.g. the container does not span the whole width)
+ *      - ESP_ERR_INVALID_STATE     if the display was not added by LVGL port or a container is already attached
+ *      - ESP_ERR_NOT_SUPPORTED     if the display configuration or orientation is not supported
+ */
+esp_err_t lvgl_port_disp_hw_scroll_attach(lv_display_t *disp, lv_obj_t *obj, const lvgl_port_hw_scroll_cfg_t *scroll_cfg);
+
+/**
+ * @brief Stop hardware scrolling of the container attached by `lvgl_port_disp_hw_scroll_attach`
+ *
+ * @note The container is detached automatically, when it is deleted.
+ *
+ * @param disp  LVGL display handle (returned from lvgl_port_add_disp)
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_INVALID_STATE     if the display was not added by LVGL port
+ */
+esp_err_t lvgl_port_disp_hw_scroll_detach(lv_display_t *disp);
+
+/**
+ * @brief Switch the panel into low-power mode, when the screen is static
+ *
+ * The callback enters the low-power mode after `timeout_ms` without any invalidated area of the display. The first
+ * invalidation returns the panel into normal mode, before the area is rendered and flushed.
+ *
+ * @note The callback should change only the panel state which does not need a redraw (e.g. idle mode with 8 colors
+ *       and lower frame rate, partial mode over the active part of the screen).
+ *
+ * @param disp      LVGL display handle (returned from lvgl_port_add_disp)
+ * @param lp_cfg    Low-power configuration (NULL or zero `timeout_ms`: disabled, the panel returns into normal mode)
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_INVALID_STATE     if the display was not added by LVGL port
+ *      - ESP_ERR_NO_MEM            if there is not enough memory for the timer
+ */
+esp_err_t lvgl_port_disp_set_low_power(lv_display_t *disp, const lvgl_port_low_power_cfg_t *lp_cfg);
+
+/**
+ * @brief Set period of LVGL refresh of the display
+ *
+ * Each display is refreshed by its own LVGL timer, e.g. a small status OLED can be refreshed less often than the main LCD.
+ *
+ * @note With frame pacing, the period is used after the pacing is disabled.
+ *
+ * @param disp      LVGL display handle (returned from lvgl_port_add_disp)
+ * @param period_ms Refresh period in [ms]
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_INVALID_STATE     if the display was not added by LVGL port
+ */
+esp_err_t lvgl_port_disp_set_refresh_period(lv_display_t *disp, uint32_t period_ms);
+
+/**
+ * @brief Render the display with a fixed frame rate and even frame times
+ *
+ * LVGL refresh timer of the display is taken over by LVGL task. The frame is rendered at its deadline, only when
+ * an area was invalidated. Deadlines follow each other by the frame period, so the animations move by the same
+ * step in each frame. A frame rendered one or more periods after its deadline is counted as slipped and the next
+ * deadline is set one period after its render start.
+ *
+ * @note With `te_align`, the period is a whole multiple of the panel refresh period and the first flush of the frame
+ *       waits for TE pulse (`te_gpio_num`). The refresh period of RGB and MIPI-DSI panels is not used.
+ * @note The deadlines are kept by the LVGL task sleep, set CONFIG_FREERTOS_HZ to 1000 for even frame times.
+ *
+ * @param disp          LVGL display handle (returned from lvgl_port_add_disp)
+ * @param pacing_cfg    Frame pacing configuration (NULL or zero `fps`: disabled, refresh period of the display is restored)
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_INVALID_STATE     if the display was not added by LVGL port
+ */
+esp_err_t lvgl_port_disp_set_frame_pacing(lv_display_t *disp, const lvgl_port_frame_pacing_cfg_t *pacing_cfg);
+
+/**
+ * @brief Get statistics of frame pacing
+ *
+ * @param disp      LVGL display handle (returned from lvgl_port_add_disp)
+ * @param stats     Output statistics
+ * @param reset     Clear the frame, slip and jitter counters after reading
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_INVALID_STATE     if the display was not added by LVGL port
+ */
+esp_err_t lvgl_port_disp_get_pacing_stats(lv_display_t *disp, lvgl_port_frame_pacing_stats_t *stats, bool reset);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
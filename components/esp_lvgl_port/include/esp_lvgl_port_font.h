@@ -0,0 +1,119 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port glyph cache
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief Handle of font with glyph cache
+ */
+typedef struct lvgl_port_font_cache_s *lvgl_port_font_cache_handle_t;
+
+/**
+ * @brief Configuration of the glyph cache structure
+ */
+typedef struct {
+    const lv_font_t *font;          /*!< Original font (e.g. compressed font in flash) */
+    uint32_t        cache_size;     /*!< Budget of the cached glyph bitmaps in bytes, the least recently used glyphs are evicted */
+    struct {
+        unsigned int buff_spiram: 1;    /*!< Cached glyphs will be in PSRAM (internal RAM otherwise) */
+    } flags;
+} lvgl_port_font_cache_cfg_t;
+
+/**
+ * @brief Statistics of the glyph cache
+ */
+typedef struct {
+    uint32_t hit_cnt;       /*!< Glyphs copied from the cache */
+    uint32_t miss_cnt;      /*!< Glyphs rendered by the original font */
+    uint32_t evict_cnt;     /*!< Glyphs removed from the cache for new ones */
+    uint32_t glyph_cnt;     /*!< Glyphs in the cache now */
+    uint32_t used_size;     /*!< Bytes used by the cached glyphs */
+} lvgl_port_font_cache_stats_t;
+
+/**
+ * @brief Create font with glyph cache
+ *
+ * The returned font draws the same glyphs as the original font. Rendered glyph bitmaps (decompressed and expanded to A8)
+ * are kept in the cache, so the next drawing of the same glyph is only a copy.
+ *
+ * @note Use the font from lvgl_port_font_cache_get_font in styles instead of the original font.
+ * @note Only bitmap glyphs are cached, glyphs from fallback fonts are not cached.
+ * @note Requires LVGL 9.2 or newer.
+ *
+ * @param cache_cfg Glyph cache configuration structure
+ * @param ret_cache Output handle of the cache
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_NO_MEM            if there is not enough memory
+ *      - ESP_ERR_NOT_SUPPORTED     if LVGL is older than 9.2
+ */
+esp_err_t lvgl_port_font_cache_create(const lvgl_port_font_cache_cfg_t *cache_cfg, lvgl_port_font_cache_handle_t *ret_cache);
+
+/**
+ * @brief Get font with glyph cache
+ *
+ * @param cache Handle of the cache
+ * @return Font with glyph cache (NULL, if the handle is not valid)
+ */
+const lv_font_t *lvgl_port_font_cache_get_font(lvgl_port_font_cache_handle_t cache);
+
+/**
+ * @brief Render glyphs of the text into the cache
+ *
+ * @note It can be called at startup or before screen load with all characters of the screen (e.g. digits and letters of a list).
+ * @note The caller must hold the LVGL lock.
+ *
+ * @param cache Handle of the cache
+ * @param text  UTF-8 characters to be cached
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_NO_MEM            if there is not enough memory for temporary glyph buffer
+ */
+esp_err_t lvgl_port_font_cache_prewarm(lvgl_port_font_cache_handle_t cache, const char *text);
+
+/**
+ * @brief Get statistics of the glyph cache
+ *
+ * @param cache Handle of the cache
+ * @param stats Output statistics
+ * @param reset Reset the counters after read
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ */
+esp_err_t lvgl_port_font_cache_get_stats(lvgl_port_font_cache_handle_t cache, lvgl_port_font_cache_stats_t *stats, bool reset);
+
+/**
+ * @brief Delete the glyph cache
+ *
+ * @note The font from lvgl_port_font_cache_get_font must not be used anymore.
+ *
+ * @param cache Handle of the cache
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if the handle is not valid
+ */
+esp_err_t lvgl_port_font_cache_delete(lvgl_port_font_cache_handle_t cache);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,70 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port hardware JPEG decoder
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief Configuration of the hardware JPEG decoder structure
+ */
+typedef struct {
+    lv_color_format_t   color_format;   /*!< Color format of decoded images, `LV_COLOR_FORMAT_RGB565` or `LV_COLOR_FORMAT_RGB888` (0: RGB565) */
+    uint32_t            cache_size;     /*!< Budget of the decoded images cache in bytes, the least recently used images are freed (0: no cache) */
+    int                 timeout_ms;     /*!< Timeout of decoding one image (0: default 100 ms) */
+} lvgl_port_jpeg_cfg_t;
+
+/**
+ * @brief Add LVGL image decoder using the hardware JPEG codec (ESP32-P4)
+ *
+ * Decodes JPEG files (`*.jpg`, `*.jpeg`) and JPEG images in variables (`LV_COLOR_FORMAT_RAW`)
+ * by DMA directly into PSRAM draw buffers.
+ *
+ * @note Only baseline JPEG is supported by the codec. Progressive images are decoded by other LVGL decoders, if enabled.
+ * @note Allocated memory in this function is not free in deinit. You must call lvgl_port_jpeg_decoder_deinit for free all memory!
+ *
+ * @param jpeg_cfg Hardware JPEG decoder configuration structure
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_INVALID_STATE     if the decoder is already added
+ *      - ESP_ERR_NO_MEM            if there is not enough memory
+ *      - ESP_ERR_NOT_SUPPORTED     if the chip has no hardware JPEG codec
+ */
+esp_err_t lvgl_port_jpeg_decoder_init(const lvgl_port_jpeg_cfg_t *jpeg_cfg);
+
+/**
+ * @brief Free decoded images, which are not used now, from the cache
+ *
+ * @param src Image source (file path or image descriptor), NULL for all images
+ */
+void lvgl_port_jpeg_decoder_cache_drop(const void *src);
+
+/**
+ * @brief Remove hardware JPEG decoder from LVGL
+ *
+ * @note Free all memory used by the decoder and the cache. Images using the decoder must be deleted before.
+ *
+ * @return
+ *      - ESP_OK                    on success
+ */
+esp_err_t lvgl_port_jpeg_decoder_deinit(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
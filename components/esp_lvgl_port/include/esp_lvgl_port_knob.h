@@ -39,6 +39,7 @@ typedef struct {
     lv_display_t *disp;    /*!< LVGL display handle (returned from lvgl_port_add_disp) */
     const knob_config_t *encoder_a_b;
     const button_config_t *encoder_enter;  /*!< Navigation button for enter */
+    uint8_t accel;          /*!< Acceleration of fast rotation, steps between two reads are multiplied by (1 + steps * accel / 16) (0: no acceleration) */
 } lvgl_port_encoder_cfg_t;
 
 /**
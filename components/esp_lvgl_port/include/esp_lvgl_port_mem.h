@@ -0,0 +1,54 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port memory arena
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Statistics of LVGL memory arena
+ */
+typedef struct {
+    uint32_t arena_cnt;         /*!< Number of arenas (the first one and additional ones) */
+    size_t   total_size;        /*!< Size of all arenas in [B] */
+    size_t   free_size;         /*!< Free memory in [B] */
+    size_t   min_free_size;     /*!< Lowest free memory since lv_init() in [B] */
+    size_t   largest_free;      /*!< Largest free block in [B] */
+    uint32_t used_cnt;          /*!< Number of allocated blocks */
+    uint32_t free_cnt;          /*!< Number of free blocks */
+    uint32_t frag_pct;          /*!< Fragmentation of free memory in [%] (0: one free block) */
+    uint32_t fail_cnt;          /*!< Number of failed allocations */
+} lvgl_port_mem_stats_t;
+
+/**
+ * @brief Get statistics of LVGL memory arena
+ *
+ * @note The arena is used when CONFIG_LVGL_PORT_MEM_ARENA is enabled (LVGL9 with `LV_USE_CUSTOM_MALLOC`).
+ *       lv_mem_monitor() reports the same values.
+ *
+ * @param stats Output statistics
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if stats is NULL
+ *      - ESP_ERR_INVALID_STATE     if LVGL is not initialized
+ *      - ESP_ERR_NOT_SUPPORTED     if the arena is not enabled
+ */
+esp_err_t lvgl_port_mem_get_stats(lvgl_port_mem_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,139 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port remote screen mirroring
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief Magic number at the beginning of each packet
+ */
+#define LVGL_PORT_MIRROR_MAGIC  (0x4D4C)
+
+/**
+ * @brief Type of the mirror packet
+ */
+typedef enum {
+    LVGL_PORT_MIRROR_AREA_RAW = 0,  /*!< Payload: RGB565 pixels of the area row by row (little endian) */
+    LVGL_PORT_MIRROR_AREA_RLE = 1,  /*!< Payload: runs of the area row by row, pairs of 16-bit count and RGB565 color (little endian) */
+    LVGL_PORT_MIRROR_FRAME_END = 2, /*!< No payload, all areas of the frame were sent (area is the whole screen) */
+} lvgl_port_mirror_packet_type_t;
+
+/**
+ * @brief Header of the mirror packet, `len` bytes of payload follow
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t    magic;      /*!< LVGL_PORT_MIRROR_MAGIC */
+    uint8_t     type;       /*!< Packet type (lvgl_port_mirror_packet_type_t) */
+    uint8_t     reserved;
+    int16_t     x1;         /*!< Area of the packet (inclusive coordinates) */
+    int16_t     y1;
+    int16_t     x2;
+    int16_t     y2;
+    uint32_t    len;        /*!< Length of the payload in bytes */
+} lvgl_port_mirror_packet_t;
+
+/**
+ * @brief Sending of the packets to the remote viewer (socket, USB CDC...)
+ *
+ * @note It is called from the mirror task, it can block.
+ *
+ * @param data      Packet header or payload
+ * @param len       Length of the data in bytes
+ * @param user_ctx  User data from the configuration
+ * @return
+ *      - ESP_OK on success, otherwise the screen is sent again
+ */
+typedef esp_err_t (*lvgl_port_mirror_send_cb_t)(const void *data, size_t len, void *user_ctx);
+
+/**
+ * @brief Handle of the screen mirror
+ */
+typedef struct lvgl_port_mirror_s *lvgl_port_mirror_handle_t;
+
+/**
+ * @brief Configuration of the screen mirror
+ */
+typedef struct {
+    lv_display_t                *disp;          /*!< LVGL display handle (returned from lvgl_port_add_disp) */
+    lvgl_port_mirror_send_cb_t  send_cb;        /*!< Sending of the packets */
+    void                        *user_ctx;      /*!< User data for the callback */
+    size_t                      buffer_size;    /*!< Size of the buffer of captured areas waiting for sending in bytes (0: 32 kB) */
+    uint32_t                    max_rate;       /*!< Maximum data rate in bytes per second (0: not limited) */
+    int                         task_priority;  /*!< Mirror task priority (lower than LVGL task) */
+    int                         task_stack;     /*!< Mirror task stack size (0: 4096) */
+    int                         task_affinity;  /*!< Mirror task pinned to core (-1 is no affinity) */
+    struct {
+        unsigned int buff_spiram: 1;            /*!< Buffer of captured areas will be in PSRAM */
+    } flags;
+} lvgl_port_mirror_cfg_t;
+
+/**
+ * @brief Start mirroring of the display
+ *
+ * The flushed areas are copied into the buffer and the mirror task sends them RLE compressed (raw when RLE is not
+ * shorter), each frame is closed by LVGL_PORT_MIRROR_FRAME_END packet. When the buffer is full (the remote link
+ * or `max_rate` is slower than the UI), the areas are dropped and the whole screen is sent again after the buffer
+ * is empty. The first frame is the whole screen.
+ *
+ * @note Supported with RGB565 displays without `monochrome`.
+ *
+ * @param mirror_cfg    Mirror configuration
+ * @param ret_mirror    Output handle of the mirror
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_INVALID_STATE     if the display was not added by LVGL port or it is already mirrored
+ *      - ESP_ERR_NOT_SUPPORTED     if the color format of the display is not supported
+ *      - ESP_ERR_NO_MEM            if there is not enough memory
+ */
+esp_err_t lvgl_port_mirror_start(const lvgl_port_mirror_cfg_t *mirror_cfg, lvgl_port_mirror_handle_t *ret_mirror);
+
+/**
+ * @brief Stop mirroring and free all memory of the mirror
+ *
+ * @param mirror    Handle of the mirror
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if the handle is not valid
+ */
+esp_err_t lvgl_port_mirror_stop(lvgl_port_mirror_handle_t mirror);
+
+/**
+ * @brief Input from the remote viewer
+ *
+ * The mirror has a pointer input device, the remote touches and clicks are read by LVGL as from a touch panel.
+ *
+ * @note It can be called from any task (e.g. the task receiving from the socket).
+ *
+ * @param mirror    Handle of the mirror
+ * @param x         X coordinate on the screen
+ * @param y         Y coordinate on the screen
+ * @param pressed   True, if the pointer is pressed
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if the handle is not valid
+ */
+esp_err_t lvgl_port_mirror_input(lvgl_port_mirror_handle_t mirror, int32_t x, int32_t y, bool pressed);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
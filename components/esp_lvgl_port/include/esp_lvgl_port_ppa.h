@@ -0,0 +1,87 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port PPA draw unit
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief Configuration of the PPA draw unit structure
+ */
+typedef struct {
+    uint32_t    min_area;   /*!< Minimal area of the draw task in pixels drawn by PPA, smaller tasks are faster drawn by CPU (0: default 1600) */
+} lvgl_port_ppa_draw_cfg_t;
+
+/**
+ * @brief Statistics of the PPA draw unit
+ */
+typedef struct {
+    uint32_t task_cnt;          /*!< Draw tasks evaluated by LVGL (all types) */
+    uint32_t fill_cnt;          /*!< Rectangles filled by PPA */
+    uint32_t blend_cnt;         /*!< Images and layers blended by PPA (with alpha or opacity) */
+    uint32_t scale_cnt;         /*!< Opaque images and layers copied or scaled by PPA */
+    uint32_t fallback_cnt;      /*!< Tasks taken by PPA draw unit, but drawn by CPU (unsupported layer buffer, PPA error) */
+    uint64_t task_px;           /*!< Pixels of all evaluated draw tasks (clipped area) */
+    uint64_t ppa_px;            /*!< Pixels drawn by PPA */
+    uint32_t offload_pct;       /*!< Tasks drawn by PPA in percent of all evaluated tasks */
+    uint32_t offload_px_pct;    /*!< Pixels drawn by PPA in percent of pixels of all evaluated tasks */
+} lvgl_port_ppa_draw_stats_t;
+
+/**
+ * @brief Add LVGL draw unit using PPA (ESP32-P4)
+ *
+ * The draw unit takes these draw tasks from the CPU (SW) draw units:
+ *  - rectangle fills without radius, gradient and transparency
+ *  - images and layers without rotation, recoloring and masks, blended with alpha channel and opacity
+ *  - opaque images and layers scaled by multiples of 1/16
+ *
+ * Other tasks are drawn by CPU as before. The draw unit is deleted by lv_deinit.
+ *
+ * @note Layer buffers must be aligned to cache line (`LV_DRAW_BUF_ALIGN` 64, ESP32-P4 PSRAM cache line), otherwise
+ *       the tasks are drawn by CPU and counted in `fallback_cnt`.
+ * @note Requires LVGL 9.2 or newer.
+ * @note The caller must hold the LVGL lock.
+ *
+ * @param ppa_cfg PPA draw unit configuration structure (NULL: default configuration)
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_STATE     if the draw unit is already added
+ *      - ESP_ERR_NO_MEM            if there is not enough memory
+ *      - ESP_ERR_NOT_SUPPORTED     if the chip has no PPA or LVGL is older than 9.2
+ */
+esp_err_t lvgl_port_ppa_draw_init(const lvgl_port_ppa_draw_cfg_t *ppa_cfg);
+
+/**
+ * @brief Get statistics of the PPA draw unit
+ *
+ * @note The caller must hold the LVGL lock.
+ *
+ * @param stats Output statistics
+ * @param reset Reset the counters after read
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_INVALID_STATE     if the draw unit is not added
+ */
+esp_err_t lvgl_port_ppa_draw_get_stats(lvgl_port_ppa_draw_stats_t *stats, bool reset);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
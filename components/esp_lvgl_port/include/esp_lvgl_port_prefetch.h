@@ -0,0 +1,87 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port image prefetch in idle time
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief Configuration of the image prefetch
+ */
+typedef struct {
+    const void *const *srcs;    /*!< Image sources of the likely next screens (`lv_image_dsc_t` or file path), owned by the application */
+    uint32_t    count;          /*!< Count of the image sources */
+    uint32_t    budget;         /*!< Maximum decoded bytes put into the LVGL image cache (0: limited by the image cache only) */
+    uint32_t    min_idle_ms;    /*!< Images are decoded only when LVGL has nothing to do for at least this time (0: default 10 ms) */
+} lvgl_port_prefetch_cfg_t;
+
+/**
+ * @brief Statistics of the current image prefetch
+ */
+typedef struct {
+    uint32_t cached_cnt;    /*!< Images decoded into the LVGL image cache */
+    uint32_t cached_size;   /*!< Decoded bytes of the cached images */
+    uint32_t direct_cnt;    /*!< Images used without decoding (e.g. uncompressed C arrays), nothing to prefetch */
+    uint32_t skip_cnt;      /*!< Images not decoded because of the budget */
+    uint32_t fail_cnt;      /*!< Images, which could not be opened */
+    uint32_t pending_cnt;   /*!< Images waiting for idle time */
+    uint32_t time_ms;       /*!< Time spent by decoding [ms] */
+} lvgl_port_prefetch_stats_t;
+
+/**
+ * @brief Decode images of the likely next screens in idle time of the LVGL task
+ *
+ * The LVGL task decodes the images one by one after lv_timer_handler(), when the next LVGL timer is not ready for
+ * `min_idle_ms`. At most half of the idle time is used, so the rendering is not delayed. Decoded images stay in the LVGL
+ * image cache and the next screen does not wait for the decoders (JPEG, PNG, compressed images, files).
+ *
+ * @note The image cache size must be set in LVGL (`CONFIG_LV_CACHE_DEF_SIZE` or lv_image_cache_resize()), PSRAM heap
+ *       of LVGL (e.g. LVGL memory arena in PSRAM) keeps the decoded images out of internal RAM.
+ * @note A new call replaces the pending images of the previous one.
+ * @note Requires LVGL 9.1 or newer.
+ *
+ * @param cfg   Prefetch configuration
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_NOT_SUPPORTED     if LVGL is older than 9.1
+ */
+esp_err_t lvgl_port_prefetch_start(const lvgl_port_prefetch_cfg_t *cfg);
+
+/**
+ * @brief Drop the pending images of the prefetch, the already decoded images stay in the image cache
+ *
+ * @return
+ *      - ESP_OK                    on success
+ */
+esp_err_t lvgl_port_prefetch_cancel(void);
+
+/**
+ * @brief Get statistics of the current prefetch
+ *
+ * @param stats Output statistics
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ */
+esp_err_t lvgl_port_prefetch_get_stats(lvgl_port_prefetch_stats_t *stats);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
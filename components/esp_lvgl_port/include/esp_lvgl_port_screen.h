@@ -0,0 +1,92 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port incremental screen building
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief Handle of screen being built
+ */
+typedef struct lvgl_port_screen_build_s *lvgl_port_screen_build_handle_t;
+
+/**
+ * @brief One step of the screen building (e.g. creating of one tab), it is called in LVGL task with LVGL lock taken
+ *
+ * @param scr       New screen (not loaded yet)
+ * @param user_ctx  User context from configuration
+ */
+typedef void (*lvgl_port_screen_step_t)(lv_obj_t *scr, void *user_ctx);
+
+/**
+ * @brief Callback of the built screen, it is called in LVGL task after the screen load was started
+ *
+ * @param scr       Built screen
+ * @param user_ctx  User context from configuration
+ */
+typedef void (*lvgl_port_screen_done_cb_t)(lv_obj_t *scr, void *user_ctx);
+
+/**
+ * @brief Configuration of the incremental screen building
+ */
+typedef struct {
+    lv_display_t                    *disp;          /*!< Display of the screen (NULL: default display) */
+    const lvgl_port_screen_step_t   *steps;         /*!< Building steps, called in the order */
+    uint32_t                        step_count;     /*!< Number of building steps */
+    void                            *user_ctx;      /*!< User context passed to the steps and done callback */
+    uint32_t                        budget_ms;      /*!< Time for building steps in one refresh period `LV_DEF_REFR_PERIOD` [ms] (0: 5 ms), at least one step is called */
+    lv_screen_load_anim_t           anim;           /*!< Animation of the screen load */
+    uint32_t                        anim_time;      /*!< Duration of the animation [ms] */
+    lvgl_port_screen_done_cb_t      done_cb;        /*!< Called when the screen is built and loaded (optional) */
+    struct {
+        unsigned int auto_del: 1;   /*!< Delete the previous screen after the load */
+    } flags;
+} lvgl_port_screen_build_cfg_t;
+
+/**
+ * @brief Build a new screen in time-sliced steps and load it, when it is complete
+ *
+ * The steps are called in LVGL task, one slice of steps per refresh period (`LV_DEF_REFR_PERIOD`), so the current screen
+ * is still rendered and gets input events while the new screen is being built. The new screen is not loaded
+ * until all steps are done, its objects are not rendered during the building.
+ *
+ * @note The handle is valid until the done callback is called or until the building is cancelled.
+ * @note Split long steps (e.g. one step per tab or per list item), one step cannot be interrupted.
+ *
+ * @param cfg           Configuration of the building
+ * @param ret_handle    Output handle of the building (optional)
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_NO_MEM            if there is not enough memory for the screen or its timer
+ */
+esp_err_t lvgl_port_screen_build(const lvgl_port_screen_build_cfg_t *cfg, lvgl_port_screen_build_handle_t *ret_handle);
+
+/**
+ * @brief Cancel the screen building and delete the partially built screen
+ *
+ * @param handle    Handle of the building
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if the handle is not valid
+ */
+esp_err_t lvgl_port_screen_build_cancel(lvgl_port_screen_build_handle_t handle);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,97 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port background screenshot
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief Screenshot finished callback
+ *
+ * @note It is called from the screenshot task.
+ *
+ * @param path      Path of the written file
+ * @param result    ESP_OK, if the file was written, otherwise the error
+ * @param user_ctx  User data from lvgl_port_screenshot_take
+ */
+typedef void (*lvgl_port_screenshot_done_cb_t)(const char *path, esp_err_t result, void *user_ctx);
+
+/**
+ * @brief Configuration of the screenshot service
+ */
+typedef struct {
+    int                 task_priority;  /*!< Screenshot task priority (lower than LVGL task) */
+    int                 task_stack;     /*!< Screenshot task stack size (0: 4096) */
+    int                 task_affinity;  /*!< Screenshot task pinned to core (-1 is no affinity) */
+    struct {
+        unsigned int buff_spiram: 1;    /*!< Staging buffer of the screen will be in PSRAM */
+    } flags;
+} lvgl_port_screenshot_cfg_t;
+
+/**
+ * @brief Initialize screenshot service
+ *
+ * Creates the screenshot task, which encodes the captured screens into QOI images and writes them into files.
+ *
+ * @param cfg   Screenshot configuration
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_INVALID_STATE     if the service is already initialized
+ *      - ESP_ERR_NO_MEM            if there is not enough memory
+ */
+esp_err_t lvgl_port_screenshot_init(const lvgl_port_screenshot_cfg_t *cfg);
+
+/**
+ * @brief Take screenshot of the display in background
+ *
+ * The whole screen is invalidated and the areas flushed in the next refresh are copied into the staging buffer,
+ * the refresh is not slowed down by encoding and file writing. The file is written in QOI format
+ * (https://qoiformat.org) by the screenshot task, `done_cb` is called after that. The file system
+ * (e.g. SD card by `bsp_sdcard_mount`) must be mounted by the application.
+ *
+ * @note Only one screenshot can be in progress.
+ * @note Supported with RGB565 displays without `monochrome`.
+ *
+ * @param disp      LVGL display handle (returned from lvgl_port_add_disp)
+ * @param path      Path of the file (e.g. "/sdcard/shot0001.qoi"), copied
+ * @param done_cb   Called when the file is written (can be NULL)
+ * @param user_ctx  User data for the callback
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ *      - ESP_ERR_INVALID_STATE     if the service is not initialized or other screenshot is in progress
+ *      - ESP_ERR_NOT_SUPPORTED     if the color format of the display is not supported
+ *      - ESP_ERR_NO_MEM            if there is not enough memory for the staging buffer
+ */
+esp_err_t lvgl_port_screenshot_take(lv_display_t *disp, const char *path, lvgl_port_screenshot_done_cb_t done_cb, void *user_ctx);
+
+/**
+ * @brief Deinitialize screenshot service
+ *
+ * @note It waits for the screenshot in progress.
+ *
+ * @return
+ *      - ESP_OK                    on success
+ */
+esp_err_t lvgl_port_screenshot_deinit(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -27,6 +27,28 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Touch gesture type
+ */
+typedef enum {
+    LVGL_PORT_GESTURE_DOUBLE_TAP,   /*!< Two short taps at the same place */
+    LVGL_PORT_GESTURE_LONG_PRESS,   /*!< One finger held without moving */
+    LVGL_PORT_GESTURE_SWIPE,        /*!< Fast movement of one finger (see `dir`) */
+    LVGL_PORT_GESTURE_PINCH,        /*!< Two fingers closer or further (see `scale`), reported while changing */
+    LVGL_PORT_GESTURE_ROTATE,       /*!< Two fingers rotated (see `angle`), reported while changing */
+} lvgl_port_gesture_type_t;
+
+/**
+ * @brief Touch gesture (parameter of the gesture event)
+ */
+typedef struct {
+    lvgl_port_gesture_type_t type;  /*!< Gesture type */
+    lv_point_t point;               /*!< Gesture position (center between fingers for pinch and rotate) */
+    lv_dir_t dir;                   /*!< Swipe direction */
+    int32_t scale;                  /*!< Pinch scale from the start of the gesture (256 is no change) */
+    int32_t angle;                  /*!< Rotation from the start of the gesture [0.1 degree], clockwise */
+} lvgl_port_gesture_t;
+
 #ifdef ESP_LVGL_PORT_TOUCH_COMPONENT
 /**
  * @brief Configuration touch structure
@@ -34,8 +56,28 @@ extern "C" {
 typedef struct {
     lv_display_t *disp;    /*!< LVGL display handle (returned from lvgl_port_add_disp) */
     esp_lcd_touch_handle_t   handle;   /*!< LCD touch IO handle */
+    uint32_t predict_ms;    /*!< Move the touch point by its velocity this time ahead, e.g. time to the next display refresh (0: no prediction, needs CONFIG_ESP_LCD_TOUCH_SAMPLES) */
+    uint32_t poll_active_ms;    /*!< Read period while touched, only interrupt (or `poll_idle_ms`) is used while not touched (0: LVGL indev read period or interrupt only) */
+    uint32_t poll_idle_ms;      /*!< Read period while not touched, when interrupt pin is not used (0: LVGL indev read period) */
+    uint32_t sleep_timeout_ms;  /*!< Controller sleeps after this display inactivity, it is woken by display activity (0: never) */
+    uint32_t scan_idle_ms;      /*!< Controller is kept in active scanning while touched and until this display inactivity, then it may enter its monitor mode (0: controller default, see `esp_lcd_touch_set_active_scan`) */
+    uint32_t bus_wait_ms;       /*!< Touch controller shares the SPI bus with the display, reading waits up to this time for a gap between display transfers (0: bus is not shared, LVGL9 only) */
+    struct {
+        unsigned int gestures: 1;   /*!< Recognize gestures and send gesture event (see lvgl_port_touch_get_gesture_event) */
+        unsigned int wake_on_touch: 1; /*!< Touch interrupt wakes the chip from light sleep, the controller is not put into sleep mode (`sleep_timeout_ms` is ignored), needs interrupt pin and the acquisition task (see esp_lcd_touch_set_wakeup) */
+    } flags;
 } lvgl_port_touch_cfg_t;
 
+/**
+ * @brief Statistics of the presses, which woke the chip (`flags.wake_on_touch`)
+ */
+typedef struct {
+    uint32_t wake_cnt;              /*!< Count of presses started by the wake-up interrupt */
+    uint32_t read_latency_us;       /*!< Last wake-up: interrupt to the first touched sample [us] */
+    uint32_t frame_latency_us;      /*!< Last wake-up: interrupt to the end of the first flush rendered after the press [us] (LVGL9) */
+    uint32_t frame_latency_max_us;  /*!< Longest interrupt to the first flushed frame [us] (LVGL9) */
+} lvgl_port_touch_wake_stats_t;
+
 /**
  * @brief Add LCD touch as an input device
  *
@@ -55,6 +97,32 @@ lv_indev_t *lvgl_port_add_touch(const lvgl_port_touch_cfg_t *touch_cfg);
  *      - ESP_OK                    on success
  */
 esp_err_t lvgl_port_remove_touch(lv_indev_t *touch);
+
+/**
+ * @brief Get LVGL event code of touch gestures
+ *
+ * The event is sent to the pressed object (or to the active screen), when enabled `flags.gestures`
+ * in touch configuration. Event parameter is `lvgl_port_gesture_t *` (`lv_event_get_param`).
+ *
+ * @note The event code is registered in the first call of lvgl_port_add_touch.
+ *
+ * @return LVGL event code (0 when not registered yet)
+ */
+uint32_t lvgl_port_touch_get_gesture_event(void);
+
+/**
+ * @brief Get statistics of the presses, which woke the chip
+ *
+ * The wake-to-first-frame latency is measured from the touch interrupt to the end of the first flush, which was
+ * rendered after the press was given to LVGL. Presses, which do not change the screen, are not measured.
+ *
+ * @param touch Touch input device (returned from lvgl_port_add_touch)
+ * @param stats Output statistics
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if some of the arguments are not valid
+ */
+esp_err_t lvgl_port_touch_get_wake_stats(lv_indev_t *touch, lvgl_port_touch_wake_stats_t *stats);
 #endif
 
 #ifdef __cplusplus
@@ -0,0 +1,122 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port pixel transformations
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "lvgl.h"
+
+#if LVGL_VERSION_MAJOR == 8
+#include "esp_lvgl_port_compatibility.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Swap bytes in RGB565 (16-bit) buffer
+ *
+ * @note Data are processed by 32-bit words (two pixels at once).
+ *
+ * @param buf Buffer with RGB565 pixels
+ * @param len Number of pixels
+ */
+void lvgl_port_transform_rgb565_swap(uint16_t *buf, size_t len);
+
+/**
+ * @brief Copy RGB565 (16-bit) buffer and swap bytes in one pass
+ *
+ * @param dst Destination buffer
+ * @param src Source buffer
+ * @param len Number of pixels
+ */
+void lvgl_port_transform_rgb565_swap_copy(uint16_t *dst, const uint16_t *src, size_t len);
+
+/**
+ * @brief Check, if all pixels of RGB565 (16-bit) buffer have the same color
+ *
+ * @note Data are compared by 32-bit words, the scan ends on the first different word.
+ *
+ * @param buf   Buffer with RGB565 pixels
+ * @param len   Number of pixels
+ * @param color Color of the pixels (optional, set only when the buffer is solid)
+ * @return true, if the buffer has one color
+ */
+bool lvgl_port_transform_rgb565_is_solid(const uint16_t *buf, size_t len, uint16_t *color);
+
+/**
+ * @brief Rotate RGB565 (16-bit) area for display rotation
+ *
+ * @note The pixels are mapped same as areas in display rotation (LVGL logical coordinates -> display coordinates).
+ * 90 and 270 degrees are processed in tiles for better cache (PSRAM) usage.
+ * Rotated area has swapped width and height for 90 and 270 degrees.
+ * Source and destination buffers must not overlap (except rotation 0).
+ *
+ * @param src      Source buffer (area in LVGL coordinates)
+ * @param dst      Destination buffer (area in display coordinates)
+ * @param w        Width of the source area in pixels
+ * @param h        Height of the source area in pixels
+ * @param rotation Display rotation
+ * @param swap     True, if bytes should be swapped in the same pass
+ */
+void lvgl_port_transform_rgb565_rotate(const uint16_t *src, uint16_t *dst, int32_t w, int32_t h, lv_display_rotation_t rotation, bool swap);
+
+/**
+ * @brief Rotate only a strip of lines of RGB565 (16-bit) area for display rotation
+ *
+ * @note Same as lvgl_port_transform_rgb565_rotate, but only the output lines `line` to `line + lines - 1` (in display coordinates)
+ * are written to the beginning of `dst`. The rotated area can be sent in strips through a small buffer.
+ *
+ * @param src      Source buffer (whole area in LVGL coordinates)
+ * @param dst      Destination buffer for the strip (`lines` lines of the rotated area)
+ * @param w        Width of the source area in pixels
+ * @param h        Height of the source area in pixels
+ * @param rotation Display rotation
+ * @param swap     True, if bytes should be swapped in the same pass
+ * @param line     First output line of the strip
+ * @param lines    Number of output lines in the strip (limited to the end of the rotated area)
+ */
+void lvgl_port_transform_rgb565_rotate_lines(const uint16_t *src, uint16_t *dst, int32_t w, int32_t h, lv_display_rotation_t rotation, bool swap,
+        int32_t line, int32_t lines);
+
+/**
+ * @brief Expand L8 (8-bit index) buffer into RGB565 (16-bit) buffer by color look-up table
+ *
+ * @param src  Source buffer with 8-bit indexes
+ * @param dst  Destination buffer (RGB565)
+ * @param len  Number of pixels
+ * @param clut Table of 256 RGB565 colors
+ */
+void lvgl_port_transform_l8_to_rgb565(const uint8_t *src, uint16_t *dst, size_t len, const uint16_t *clut);
+
+/**
+ * @brief Scale RGB565 (16-bit) picture to another size in one pass (e.g. camera frame into LVGL canvas)
+ *
+ * The source is cropped to the aspect ratio of the destination (centered) and scaled to the destination size.
+ * Bilinear interpolation processes all three color channels of a pixel in one 32-bit word.
+ *
+ * @param src      Source picture
+ * @param src_w    Width of the source in pixels
+ * @param src_h    Height of the source in pixels
+ * @param dst      Destination picture (must not overlap with source)
+ * @param dst_w    Width of the destination in pixels
+ * @param dst_h    Height of the destination in pixels
+ * @param bilinear True for bilinear interpolation (smoother downscale), false for nearest pixel (faster)
+ * @param swap     True, if bytes of source pixels are swapped (e.g. big-endian camera), destination is in native order
+ */
+void lvgl_port_transform_rgb565_scale(const uint16_t *src, int32_t src_w, int32_t src_h, uint16_t *dst, int32_t dst_w, int32_t dst_h, bool bilinear, bool swap);
+
+#ifdef __cplusplus
+}
+#endif
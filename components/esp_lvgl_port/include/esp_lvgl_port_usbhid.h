@@ -34,6 +34,9 @@ typedef struct {
     lv_display_t *disp;        /*!< LVGL display handle (returned from lvgl_port_add_disp) */
     uint8_t sensitivity;    /*!< Mouse sensitivity (cannot be zero) */
     lv_obj_t *cursor_img;   /*!< Mouse cursor image, if NULL then used default */
+    struct {
+        unsigned int cursor_overlay: 1; /*!< Draw the cursor in flush instead of LVGL object, motion does not render (LVGL9, SPI/I80 RGB565) */
+    } flags;
 } lvgl_port_hid_mouse_cfg_t;
 
 /**
@@ -0,0 +1,74 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ESP LVGL port touch gestures
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_lvgl_port_touch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maximum count of gestures recognized from one touch reading
+ */
+#define LVGL_PORT_GESTURE_MAX_OUT   (2)
+
+/**
+ * @brief Gesture recognition state (one per touch input)
+ */
+typedef struct {
+    uint8_t  points;        /*!< Count of touch points in the last update */
+    bool     moved;         /*!< First point moved out of the tap area */
+    bool     multi;         /*!< More points were touched during this touch */
+    bool     long_press;    /*!< Long press was already reported */
+    int32_t  start_x;       /*!< First point at the start of touch */
+    int32_t  start_y;
+    int32_t  last_x;        /*!< First point in the last update */
+    int32_t  last_y;
+    int64_t  start_us;      /*!< Time of the start of touch */
+    float    start_dist;    /*!< Distance of two points at the start of multi-touch */
+    float    start_angle;   /*!< Angle of two points at the start of multi-touch */
+    int32_t  scale;         /*!< Last reported pinch scale */
+    int32_t  angle;         /*!< Last reported rotation */
+    bool     tap_valid;     /*!< There was a tap (for double tap) */
+    int64_t  tap_us;        /*!< Time of the last tap */
+    int32_t  tap_x;         /*!< Position of the last tap */
+    int32_t  tap_y;
+} lvgl_port_gesture_ctx_t;
+
+/**
+ * @brief Reset gesture recognition state
+ *
+ * @param ctx   Gesture state
+ */
+void lvgl_port_gesture_init(lvgl_port_gesture_ctx_t *ctx);
+
+/**
+ * @brief Update gesture recognition by one touch reading
+ *
+ * @note It must be called regularly, also when the touch is not changed (long press) and released.
+ *
+ * @param ctx       Gesture state
+ * @param x         X coordinates of touch points
+ * @param y         Y coordinates of touch points
+ * @param cnt       Count of touch points (0 when released)
+ * @param now_us    Time of the reading [us]
+ * @param out       Recognized gestures (LVGL_PORT_GESTURE_MAX_OUT items)
+ * @return Count of recognized gestures
+ */
+uint8_t lvgl_port_gesture_update(lvgl_port_gesture_ctx_t *ctx, const uint16_t *x, const uint16_t *y, uint8_t cnt, int64_t now_us, lvgl_port_gesture_t *out);
+
+#ifdef __cplusplus
+}
+#endif
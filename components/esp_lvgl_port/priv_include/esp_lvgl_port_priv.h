@@ -11,10 +11,57 @@
 
 #pragma once
 
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "esp_attr.h"
+#include "esp_lvgl_port.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* SystemView user events, no code without CONFIG_LVGL_PORT_TRACE_SYSVIEW */
+#define LVGL_PORT_SV_FRAME      0
+#define LVGL_PORT_SV_FLUSH      1
+#define LVGL_PORT_SV_INDEV_READ 2
+
+#if CONFIG_LVGL_PORT_TRACE_SYSVIEW
+#include "SEGGER_SYSVIEW.h"
+#define LVGL_PORT_SV_START(id)  SEGGER_SYSVIEW_OnUserStart(id)
+#define LVGL_PORT_SV_STOP(id)   SEGGER_SYSVIEW_OnUserStop(id)
+#else
+#define LVGL_PORT_SV_START(id)
+#define LVGL_PORT_SV_STOP(id)
+#endif
+
+/* Accounting of buffers, when mem_account component is in the project (set by CMake) */
+#if LVGL_PORT_MEM_ACCOUNT
+#include "mem_account.h"
+#define LVGL_PORT_MEM_SUBSYS            "lvgl_port"
+#define LVGL_PORT_MEM_ADD(ptr, caps)    mem_account_add(LVGL_PORT_MEM_SUBSYS, (ptr), (caps))
+#define LVGL_PORT_MEM_REMOVE(ptr, caps) mem_account_remove(LVGL_PORT_MEM_SUBSYS, (ptr), (caps))
+#else
+#define LVGL_PORT_MEM_ADD(ptr, caps)
+#define LVGL_PORT_MEM_REMOVE(ptr, caps)
+#endif
+
+/* Invalidation profiler, no code without CONFIG_LVGL_PORT_INV_PROFILER */
+#if CONFIG_LVGL_PORT_INV_PROFILER && LVGL_VERSION_MAJOR >= 9
+void lvgl_port_inv_prof_record(lv_display_t *disp, const lv_area_t *area);
+#define LVGL_PORT_INV_PROF_RECORD(disp, area)  lvgl_port_inv_prof_record((disp), (area))
+#else
+#define LVGL_PORT_INV_PROF_RECORD(disp, area)
+#endif
+
+/* RGB panel callbacks are called from ISR while the cache can be disabled by flash writes */
+#if CONFIG_LVGL_PORT_RGB_ISR_IRAM_SAFE
+#define LVGL_PORT_RGB_ISR_ATTR  IRAM_ATTR
+#else
+#define LVGL_PORT_RGB_ISR_ATTR
+#endif
+
 /**
  * @brief Rotation configuration
  */
@@ -29,8 +76,449 @@ typedef enum {
  */
 typedef struct {
     unsigned int avoid_tearing: 1;    /*!< Use internal RGB buffers as a LVGL draw buffers to avoid tearing effect */
+    unsigned int triple_buffer: 1;    /*!< Use three internal RGB buffers, rendering does not wait for VSYNC */
+    unsigned int compressed_fb: 1;    /*!< RGB panel without frame buffer, lines are stored compressed and decompressed into bounce buffers */
+    unsigned int dma_copy: 1;         /*!< Draw buffers are copied into RGB frame buffer by GDMA */
 } lvgl_port_disp_priv_cfg_t;
 
+/**
+ * @brief Automatic draw buffers configuration
+ */
+typedef struct {
+    uint32_t hres;          /*!< Horizontal resolution */
+    uint32_t vres;          /*!< Vertical resolution */
+    uint32_t px_size;       /*!< Size of one pixel in buffer in bytes */
+    bool     full;          /*!< Buffer must be screen sized (full refresh, direct mode, monochrome) */
+    bool     dma;           /*!< Buffer must be DMA capable */
+    bool     internal_first;/*!< Prefer internal RAM (SPI, I80) before PSRAM */
+    bool     psram_allowed; /*!< PSRAM can be used for buffers */
+} lvgl_port_buff_auto_cfg_t;
+
+/**
+ * @brief Automatically allocated draw buffers
+ */
+typedef struct {
+    void     *buf1;         /*!< First buffer */
+    void     *buf2;         /*!< Second buffer (NULL, if only one was allocated) */
+    uint32_t buffer_size;   /*!< Size of one buffer in pixels */
+    uint32_t caps;          /*!< Memory capabilities of the buffers */
+} lvgl_port_buff_auto_t;
+
+/**
+ * @brief Allocate draw buffer
+ *
+ * The buffer is aligned to the cache line of the memory (e.g. PSRAM or L1 cached internal RAM of ESP32-P4),
+ * so cache write back of a flushed area does not touch other data. Free it by `free`.
+ *
+ * @param size  Size in bytes
+ * @param caps  Memory capabilities
+ * @return Allocated buffer or NULL
+ */
+void *lvgl_port_buffer_malloc(size_t size, uint32_t caps);
+
+/**
+ * @brief Allocate the biggest possible draw buffers
+ *
+ * @note Two buffers are preferred, smaller buffers are used, when there is not enough memory.
+ *
+ * @param cfg   Configuration
+ * @param out   Allocated buffers
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_NO_MEM if not even one smallest buffer can be allocated
+ */
+esp_err_t lvgl_port_buffers_auto(const lvgl_port_buff_auto_cfg_t *cfg, lvgl_port_buff_auto_t *out);
+
+/**
+ * @brief Report stage of the touch-to-photon path to the trace callback, no-op without callback
+ *
+ * @note It can be called from ISR
+ *
+ * @param stage Stage of the path
+ * @param area  Related area or NULL
+ */
+void lvgl_port_trace(lvgl_port_trace_stage_t stage, const lv_area_t *area);
+
+#ifdef ESP_LVGL_PORT_TOUCH_COMPONENT
+/**
+ * @brief Measure the first frame after a touch wake-up, called by lvgl_port_trace for each stage
+ *
+ * @note It can be called from ISR
+ *
+ * @param stage Stage of the path
+ */
+void lvgl_port_touch_wake_trace(lvgl_port_trace_stage_t stage);
+#endif
+
+/**
+ * @brief Park the display: wait for the last flush, switch the panel off and optionally free its buffers
+ *
+ * @note The caller must hold the LVGL lock and LVGL timers must be stopped.
+ *
+ * @param disp              LVGL display
+ * @param release_buffers   Free draw, rotation and transport buffers (RGB frame buffers are kept)
+ * @return
+ *      - ESP_OK                on success (also if the display is already parked)
+ *      - ESP_ERR_INVALID_STATE if the display was not added by LVGL port
+ *      - ESP_ERR_TIMEOUT       if the last flush did not finish
+ */
+esp_err_t lvgl_port_disp_park(lv_display_t *disp, bool release_buffers);
+
+/**
+ * @brief Unpark the display: allocate the released buffers, switch the panel on and invalidate the screen
+ *
+ * @note The caller must hold the LVGL lock.
+ *
+ * @param disp  LVGL display
+ * @return
+ *      - ESP_OK                on success (also if the display is not parked)
+ *      - ESP_ERR_INVALID_STATE if the display was not added by LVGL port
+ *      - ESP_ERR_NO_MEM        if the buffers cannot be allocated, the display stays parked
+ */
+esp_err_t lvgl_port_disp_unpark(lv_display_t *disp);
+
+/**
+ * @brief Render the paced displays with pending invalidation, whose frame deadline has passed
+ *
+ * @note It is called from LVGL task with the LVGL lock taken, after lv_timer_handler
+ *
+ * @return Time until the nearest deadline of a pending frame in [ms] (LV_NO_TIMER_READY: no frame is pending)
+ */
+uint32_t lvgl_port_disp_pace(void);
+
+/**
+ * @brief Decode the pending images of the prefetch in the idle time
+ *
+ * @note It is called from LVGL task with the LVGL lock taken, after lv_timer_handler
+ *
+ * @param idle_ms Time until the next LVGL timer or paced frame [ms]
+ * @return Time spent by decoding [ms]
+ */
+uint32_t lvgl_port_prefetch_run(uint32_t idle_ms);
+
+#if LVGL_VERSION_MAJOR >= 9
+/**
+ * @brief Draw the cursor over the flushed areas instead of LVGL cursor object
+ *
+ * The flushed screen is kept in a shadow copy, the cursor motion sends only the old and new cursor area composed from
+ * the shadow screen and the cursor image. LVGL does not render anything on cursor motion.
+ *
+ * @note Supported with SPI/I80 RGB565 displays without `direct_mode`, `sw_rotate`, `round_mask`, `tile_hash` and hardware scrolling
+ *
+ * @param disp  LVGL display handle
+ * @param img   Cursor image (ARGB8888)
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if the image is not ARGB8888
+ *      - ESP_ERR_INVALID_STATE if the display was not added by LVGL port or the cursor is already attached
+ *      - ESP_ERR_NOT_SUPPORTED if the display configuration is not supported
+ *      - ESP_ERR_NO_MEM        if there is not enough memory for the shadow screen
+ */
+esp_err_t lvgl_port_disp_cursor_attach(lv_display_t *disp, const lv_image_dsc_t *img);
+
+/**
+ * @brief Remove the cursor overlay and free the shadow screen
+ *
+ * @param disp  LVGL display handle
+ */
+void lvgl_port_disp_cursor_detach(lv_display_t *disp);
+
+/**
+ * @brief Move the cursor overlay, the old and new cursor area is sent to the panel
+ *
+ * @note It is called from LVGL task with the LVGL lock taken (input device read)
+ *
+ * @param disp  LVGL display handle
+ * @param x     Left edge of the cursor image
+ * @param y     Top edge of the cursor image
+ */
+void lvgl_port_disp_cursor_move(lv_display_t *disp, int32_t x, int32_t y);
+
+/**
+ * @brief Set the mirror capturing flushed areas of the display
+ *
+ * @note It is called with the LVGL lock taken
+ *
+ * @param disp      LVGL display handle
+ * @param mirror    Mirror handle (NULL: capturing is stopped)
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_STATE if the display was not added by LVGL port or it is already mirrored
+ *      - ESP_ERR_NOT_SUPPORTED if the color format of the display is not supported
+ */
+esp_err_t lvgl_port_disp_set_mirror(lv_display_t *disp, lvgl_port_mirror_handle_t mirror);
+
+/**
+ * @brief Wait for a gap between transfers of the display on the shared SPI bus
+ *
+ * @note It is called from LVGL task with the LVGL lock taken (input device read), the result is counted in bus statistics
+ *
+ * @param disp          LVGL display handle
+ * @param timeout_ms    Maximum waiting time
+ * @return true, if no transfer of the display is in progress (false: timeout)
+ */
+bool lvgl_port_disp_bus_wait(lv_display_t *disp, uint32_t timeout_ms);
+
+/**
+ * @brief Copy the flushed area into the mirror buffer (never blocks, the area is dropped when the buffer is full)
+ *
+ * @note It is called from flush callback before any transformation of the pixels
+ *
+ * @param mirror    Mirror handle
+ * @param area      Flushed area
+ * @param px        RGB565 pixels of the first row of the area
+ * @param stride    Distance of the rows in pixels
+ */
+void lvgl_port_mirror_capture(lvgl_port_mirror_handle_t mirror, const lv_area_t *area, const uint16_t *px, int32_t stride);
+
+/**
+ * @brief Enable copying of the flushed areas into the screenshot staging buffer
+ *
+ * @note It is called with the LVGL lock taken
+ *
+ * @param disp      LVGL display handle
+ * @param enable    True, if the flushed areas are copied
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_STATE if the display was not added by LVGL port
+ *      - ESP_ERR_NOT_SUPPORTED if the color format of the display is not supported
+ */
+esp_err_t lvgl_port_disp_set_screenshot(lv_display_t *disp, bool enable);
+
+/**
+ * @brief Copy the flushed area into the screenshot staging buffer
+ *
+ * @note It is called from flush callback before any transformation of the pixels
+ *
+ * @param disp      LVGL display handle
+ * @param area      Flushed area
+ * @param px        RGB565 pixels of the first row of the area
+ * @param stride    Distance of the rows in pixels
+ */
+void lvgl_port_screenshot_capture(lv_display_t *disp, const lv_area_t *area, const uint16_t *px, int32_t stride);
+#endif
+
+/**
+ * @brief Take the APB frequency lock for a flush (flags.pm_lock), no-op otherwise
+ */
+void lvgl_port_pm_flush_acquire(void);
+
+/**
+ * @brief Give the APB frequency lock after a flush, it can be called from ISR
+ */
+void lvgl_port_pm_flush_release(void);
+
+/**
+ * @brief Report a rendered frame to the PM governor, no-op without PM locks
+ *
+ * @note It is called from LVGL task at the end of the display refresh
+ *
+ * @param render_time   Render time of the frame without flushing [us]
+ */
+void lvgl_port_pm_frame_done(uint32_t render_time);
+
+/**
+ * @brief Get contention of the LVGL lock since init (not reset by lvgl_port_get_lock_stats)
+ *
+ * @param contended     Output number of locks, which had to wait for another task
+ * @param wait_time     Output sum of waiting times for the lock [us]
+ */
+void lvgl_port_lock_contention(uint32_t *contended, uint64_t *wait_time);
+
+/**
+ * @brief Handle of TE (tearing effect) synchronization
+ */
+typedef struct lvgl_port_te_s *lvgl_port_te_handle_t;
+
+/**
+ * @brief Initialize TE synchronization on GPIO
+ *
+ * @param gpio_num  GPIO connected to TE output of the LCD
+ * @param ret_te    Created TE handle
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if GPIO is not valid
+ *      - ESP_ERR_NO_MEM if there is not enough memory
+ */
+esp_err_t lvgl_port_te_init(int gpio_num, lvgl_port_te_handle_t *ret_te);
+
+/**
+ * @brief Deinitialize TE synchronization (NULL is allowed)
+ */
+void lvgl_port_te_deinit(lvgl_port_te_handle_t te);
+
+/**
+ * @brief Wait for the start of V-blanking
+ *
+ * @note It returns immediately at the beginning of V-blanking, otherwise waits for the next TE pulse (with timeout)
+ */
+void lvgl_port_te_wait(lvgl_port_te_handle_t te);
+
+/**
+ * @brief Get measured refresh period of the panel in [us] (0: no TE pulses)
+ */
+uint32_t lvgl_port_te_get_period(lvgl_port_te_handle_t te);
+
+/**
+ * @brief Maximum count of bands of one flushed area on a round display
+ */
+#define LVGL_PORT_ROUND_BANDS_MAX   (16)
+
+/**
+ * @brief Part of the flushed area visible on a round display (coordinates are included)
+ */
+typedef struct {
+    int32_t x1;
+    int32_t y1;
+    int32_t x2;
+    int32_t y2;
+} lvgl_port_round_band_t;
+
+/**
+ * @brief Split area into horizontal bands clipped by the circle inscribed in the square display
+ *
+ * @param diameter  Resolution of the square display
+ * @param x1        Area start on x-axis
+ * @param y1        Area start on y-axis
+ * @param x2        Area end on x-axis (included)
+ * @param y2        Area end on y-axis (included)
+ * @param bands     Output, space for LVGL_PORT_ROUND_BANDS_MAX bands
+ * @return Count of bands (0: the area is not visible)
+ */
+uint32_t lvgl_port_round_split(uint32_t diameter, int32_t x1, int32_t y1, int32_t x2, int32_t y2, lvgl_port_round_band_t *bands);
+
+/**
+ * @brief Maximum count of parts of one flushed area on a display with hardware scrolling
+ */
+#define LVGL_PORT_SCROLL_PARTS_MAX  (4)
+
+/**
+ * @brief Rows of the flushed area written into one block of the panel memory (coordinates are included)
+ */
+typedef struct {
+    int32_t y1;
+    int32_t y2;
+    int32_t mem_y1;
+} lvgl_port_scroll_part_t;
+
+/**
+ * @brief Split rows of the flushed area by their position in the panel memory scrolled by hardware
+ *
+ * Row `top + r` of the scrolling area is stored in the memory row `top + (r + offset) % height`, the rows above
+ * and below the scrolling area are stored in the same memory rows.
+ *
+ * @param top       First row of the scrolling area
+ * @param height    Rows of the scrolling area
+ * @param offset    Scrolling offset (0 to `height - 1`)
+ * @param y1        Area start on y-axis
+ * @param y2        Area end on y-axis (included)
+ * @param parts     Output, space for LVGL_PORT_SCROLL_PARTS_MAX parts
+ * @return Count of parts
+ */
+uint32_t lvgl_port_scroll_split(int32_t top, int32_t height, int32_t offset, int32_t y1, int32_t y2, lvgl_port_scroll_part_t *parts);
+
+/**
+ * @brief Handle of compressed (RLE per line) frame buffer
+ */
+typedef struct lvgl_port_cfb_s *lvgl_port_cfb_handle_t;
+
+/**
+ * @brief Create compressed RGB565 frame buffer
+ *
+ * @note Two slots of raw line size are allocated for each line in PSRAM, only the compressed data are read and written.
+ *
+ * @param hres      Horizontal resolution
+ * @param vres      Vertical resolution
+ * @param ret_cfb   Created handle
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if the resolution is not valid
+ *      - ESP_ERR_NO_MEM if there is not enough memory
+ */
+esp_err_t lvgl_port_cfb_init(uint32_t hres, uint32_t vres, lvgl_port_cfb_handle_t *ret_cfb);
+
+/**
+ * @brief Free compressed frame buffer (NULL is allowed)
+ */
+void lvgl_port_cfb_deinit(lvgl_port_cfb_handle_t cfb);
+
+/**
+ * @brief Compress area into the frame buffer (coordinates are included)
+ *
+ * @note Lines updated only partially are decompressed, patched and compressed again.
+ *
+ * @param data  RGB565 pixels of the area
+ */
+void lvgl_port_cfb_write(lvgl_port_cfb_handle_t cfb, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const uint16_t *data);
+
+/**
+ * @brief Decompress lines into the bounce buffer
+ *
+ * @note It is called from RGB bounce buffer ISR. The bounce buffer can start and end in the middle of a line.
+ *
+ * @param pos_px    Position of the first pixel in the frame
+ * @param dst       Bounce buffer
+ * @param len_px    Size of the bounce buffer in pixels
+ */
+void lvgl_port_cfb_read(lvgl_port_cfb_handle_t cfb, uint32_t pos_px, uint16_t *dst, uint32_t len_px);
+
+/**
+ * @brief Size of one tile of the panel content hash (pixels x pixels)
+ */
+#define LVGL_PORT_TILE_SIZE     (16)
+
+/**
+ * @brief Handle of panel content hash (CRC32 of each tile sent to the panel)
+ */
+typedef struct lvgl_port_tile_s *lvgl_port_tile_handle_t;
+
+/**
+ * @brief Create panel content hash, content of all tiles is unknown
+ *
+ * @param hres      Horizontal resolution
+ * @param vres      Vertical resolution
+ * @param ret_tiles Created handle
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if the resolution is not valid
+ *      - ESP_ERR_NO_MEM if there is not enough memory
+ */
+esp_err_t lvgl_port_tile_init(uint32_t hres, uint32_t vres, lvgl_port_tile_handle_t *ret_tiles);
+
+/**
+ * @brief Free panel content hash (NULL is allowed)
+ */
+void lvgl_port_tile_deinit(lvgl_port_tile_handle_t tiles);
+
+/**
+ * @brief Forget content of all tiles and set resolution of the flushed coordinates (e.g. after rotation)
+ */
+void lvgl_port_tile_reset(lvgl_port_tile_handle_t tiles, int32_t hres, int32_t vres);
+
+/**
+ * @brief Forget content of the tiles touched by the area sent to the panel by other way (coordinates are included)
+ */
+void lvgl_port_tile_forget(lvgl_port_tile_handle_t tiles, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+
+/**
+ * @brief Compare rows of the flushed area within one tile row with the panel content and store the new hashes
+ *
+ * Tiles fully covered by the rows are hashed, the other tiles are always reported as changed and their content is forgotten.
+ *
+ * @param data          Pixels of the rows (first pixel at `x1`)
+ * @param stride        Distance of the rows in data in bytes
+ * @param px_size       Size of one pixel in bytes
+ * @param x1            Area start on x-axis
+ * @param y1            First row
+ * @param x2            Area end on x-axis (included)
+ * @param y2            Last row (included), in the same tile row as `y1`
+ * @param changed_x1    Output, start of the changed tiles (clipped by the area)
+ * @param changed_x2    Output, end of the changed tiles (clipped by the area, included)
+ * @return True, if some tile changed and the span must be sent
+ */
+bool lvgl_port_tile_compare(lvgl_port_tile_handle_t tiles, const uint8_t *data, size_t stride, uint32_t px_size,
+                            int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t *changed_x1, int32_t *changed_x2);
+
 /**
  * @brief Notify LVGL task
  *
@@ -1,7 +1,24 @@
+# Tools of this component, the functions below are called from other components
+set(LVGL_PORT_TOOLS_DIR ${CMAKE_CURRENT_LIST_DIR}/tools)
+
 # lvgl_port_create_c_image
 #
 # Create a C array of image for using with LVGL
+#
+# Optional display-native arguments:
+#   SWAP_BYTES          RGB565 pixels in the byte order of the panel (`swap_bytes`), LVGL 9 only
+#   ROTATION <deg>      Pre-rotation of the image (0, 90, 180, 270) as LVGL port rotates the screen
+#   STRIDE_ALIGN <n>    Alignment of image rows in bytes, LVGL 9 only
+#   SECTION <name>      Place the image data into `.rodata.<name>` section
 function(lvgl_port_create_c_image image_path output_path color_format compression)
+    cmake_parse_arguments(ARG "SWAP_BYTES" "ROTATION;STRIDE_ALIGN;SECTION" "" ${ARGN})
+    if(NOT ARG_ROTATION)
+        set(ARG_ROTATION 0)
+    endif()
+    if(NOT ARG_STRIDE_ALIGN)
+        set(ARG_STRIDE_ALIGN 1)
+    endif()
+    set(native_py ${LVGL_PORT_TOOLS_DIR}/lvgl_port_image_native.py)
 
     #Get Python
     idf_build_get_property(python PYTHON)
@@ -29,9 +46,27 @@ function(lvgl_port_create_c_image image_path output_path color_format compressio
 
     message(STATUS "Generating C array image: ${image_path}")
 
+    #Rotate image before conversion, the file name stays the same (name of the C variable)
+    get_filename_component(image_name ${image_full_path} NAME_WE)
+    if(NOT ARG_ROTATION EQUAL 0)
+        set(rotated_dir "${CMAKE_BINARY_DIR}/lvgl_port_images/rot${ARG_ROTATION}")
+        file(MAKE_DIRECTORY ${rotated_dir})
+        execute_process(COMMAND ${python} -m pip install pypng OUTPUT_QUIET)
+        execute_process(COMMAND ${python} ${native_py} rotate ${image_full_path} "${rotated_dir}/${image_name}.png" ${ARG_ROTATION}
+                RESULT_VARIABLE result)
+        if(NOT result EQUAL 0)
+            message(FATAL_ERROR "Image rotation failed: ${image_path}")
+        endif()
+        set(image_full_path "${rotated_dir}/${image_name}.png")
+    endif()
+
     #Create C array image by LVGL version
     if(lvgl_ver VERSION_LESS "9.0.0")
 
+        if(ARG_SWAP_BYTES OR NOT ARG_STRIDE_ALIGN EQUAL 1)
+            message(WARNING "SWAP_BYTES and STRIDE_ALIGN are used only in LVGL 9, byte order is set by CONFIG_LV_COLOR_16_SWAP (native with swap_bytes display flag)")
+        endif()
+        set(ARG_SWAP_BYTES FALSE)
         if(CONFIG_LV_COLOR_16_SWAP)
             set(color_format "RGB565SWAP")
         else()
@@ -61,18 +96,92 @@ function(lvgl_port_create_c_image image_path output_path color_format compressio
                 --ofmt=C
                 --cf=${color_format}
                 --compress=${compression}
+                --align=${ARG_STRIDE_ALIGN}
                 -o ${output_full_path}
                 ${image_full_path})
     endif()
 
+    #Display-native post-processing of the generated C file
+    set(finalize_args "")
+    if(ARG_SWAP_BYTES)
+        list(APPEND finalize_args --swap)
+    endif()
+    if(ARG_SECTION)
+        list(APPEND finalize_args --section ${ARG_SECTION} --align ${ARG_STRIDE_ALIGN})
+    endif()
+    if(finalize_args)
+        execute_process(COMMAND ${python} ${native_py} finalize "${output_full_path}/${image_name}.c" ${finalize_args}
+                RESULT_VARIABLE result)
+        if(NOT result EQUAL 0)
+            message(FATAL_ERROR "Display-native post-processing failed: ${image_path}")
+        endif()
+    endif()
+
+endfunction()
+
+# lvgl_port_create_c_atlas
+#
+# Pack all PNG icons of a directory into one atlas image (C array) and generate its index `<name>_atlas.h`/`<name>_atlas.c`,
+# sub-images are referenced by `lvgl_port_atlas_get()`, LVGL 9 only
+#
+# Arguments:
+#   NAME <name>         Name of the atlas image (C variable), the index is `<name>_atlas`
+#   ALIGN <n>           Alignment of the sub-image columns and the atlas rows in bytes
+#   WIDTH <px>          Width of the atlas (about square by default)
+#   SWAP_BYTES          RGB565 pixels in the byte order of the panel (`swap_bytes`)
+#   SECTION <name>      Place the atlas data into `.rodata.<name>` section
+function(lvgl_port_create_c_atlas images_dir output_path color_format)
+    cmake_parse_arguments(ARG "SWAP_BYTES" "NAME;ALIGN;WIDTH;SECTION" "" ${ARGN})
+    if(NOT ARG_NAME)
+        message(FATAL_ERROR "lvgl_port_create_c_atlas: NAME is required")
+    endif()
+    if(NOT ARG_ALIGN)
+        set(ARG_ALIGN 1)
+    endif()
+    if(NOT ARG_WIDTH)
+        set(ARG_WIDTH 0)
+    endif()
+    set(native_py ${LVGL_PORT_TOOLS_DIR}/lvgl_port_image_native.py)
+    idf_build_get_property(python PYTHON)
+
+    get_filename_component(images_full_path ${images_dir} ABSOLUTE)
+    get_filename_component(output_full_path ${output_path} ABSOLUTE)
+    if(NOT IS_DIRECTORY ${images_full_path})
+        message(FATAL_ERROR "Input directory (${images_full_path}) not exists!")
+    endif()
+
+    message(STATUS "Generating image atlas: ${ARG_NAME}")
+
+    #Pack the icons into PNG atlas, it is converted as any other image
+    set(atlas_dir "${CMAKE_BINARY_DIR}/lvgl_port_images/atlas")
+    file(MAKE_DIRECTORY ${atlas_dir} ${output_full_path})
+    execute_process(COMMAND ${python} -m pip install pypng OUTPUT_QUIET)
+    execute_process(COMMAND ${python} ${native_py} atlas ${images_full_path} "${atlas_dir}/${ARG_NAME}.png" ${output_full_path}
+            --cf ${color_format} --align ${ARG_ALIGN} --width ${ARG_WIDTH}
+            RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "Image atlas packing failed: ${images_dir}")
+    endif()
+
+    #Sub-images point into the atlas rows, so the atlas is not compressed
+    set(image_args STRIDE_ALIGN ${ARG_ALIGN})
+    if(ARG_SWAP_BYTES)
+        list(APPEND image_args SWAP_BYTES)
+    endif()
+    if(ARG_SECTION)
+        list(APPEND image_args SECTION ${ARG_SECTION})
+    endif()
+    lvgl_port_create_c_image("${atlas_dir}/${ARG_NAME}.png" ${output_path} ${color_format} NONE ${image_args})
+
 endfunction()
 
 # lvgl_port_add_images
 #
 # Add all images to build
 function(lvgl_port_add_images component output_path)
-    #Add images to sources
+    #Add images to sources, generated atlas headers are included by the application
     file(GLOB_RECURSE IMAGE_SOURCES ${output_path}*.c)
     target_sources(${component} PRIVATE ${IMAGE_SOURCES})
+    target_include_directories(${component} PRIVATE ${output_path})
     idf_build_set_property(COMPILE_OPTIONS "-DLV_LVGL_H_INCLUDE_SIMPLE=1" APPEND)
 endfunction()
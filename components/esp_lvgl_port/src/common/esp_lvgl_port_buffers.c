@@ -0,0 +1,126 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include <inttypes.h>
+#include "soc/soc_caps.h"
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_idf_version.h"
+#include "esp_lvgl_port_priv.h"
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0) && !CONFIG_IDF_TARGET_LINUX
+#include "esp_cache.h"
+#define LVGL_PORT_BUFFER_CACHE_ALIGN    1
+#else
+#define LVGL_PORT_BUFFER_CACHE_ALIGN    0
+#endif
+
+static const char *TAG = "LVGL";
+
+/* Minimal number of lines in partial buffer */
+#define LVGL_PORT_AUTO_MIN_LINES            (10)
+/* Biggest partial buffer is a quarter of the screen */
+#define LVGL_PORT_AUTO_MAX_DIVIDER          (4)
+/* Internal RAM, which must stay free for other drivers after allocation */
+#define LVGL_PORT_AUTO_INTERNAL_RESERVE     (32 * 1024)
+
+/*******************************************************************************
+* Private functions
+*******************************************************************************/
+
+static void *lvgl_port_buffer_alloc(size_t size, uint32_t caps)
+{
+    void *buf = lvgl_port_buffer_malloc(size, caps);
+    if (buf && (caps & MALLOC_CAP_INTERNAL) && heap_caps_get_free_size(MALLOC_CAP_INTERNAL) < LVGL_PORT_AUTO_INTERNAL_RESERVE) {
+        /* Do not take the whole internal RAM */
+        free(buf);
+        buf = NULL;
+    }
+    return buf;
+}
+
+static bool lvgl_port_buffers_try(const lvgl_port_buff_auto_cfg_t *cfg, uint32_t caps, bool two, lvgl_port_buff_auto_t *out)
+{
+    const uint32_t min_lines = (cfg->vres < LVGL_PORT_AUTO_MIN_LINES ? cfg->vres : LVGL_PORT_AUTO_MIN_LINES);
+    uint32_t lines = (cfg->full ? cfg->vres : cfg->vres / LVGL_PORT_AUTO_MAX_DIVIDER);
+    if (lines < min_lines) {
+        lines = min_lines;
+    }
+
+    while (lines >= min_lines) {
+        const size_t size = (size_t)cfg->hres * lines * cfg->px_size;
+        void *buf1 = lvgl_port_buffer_alloc(size, caps);
+        void *buf2 = (buf1 && two ? lvgl_port_buffer_alloc(size, caps) : NULL);
+        if (buf1 && (!two || buf2)) {
+            out->buf1 = buf1;
+            out->buf2 = buf2;
+            out->buffer_size = cfg->hres * lines;
+            out->caps = caps;
+            return true;
+        }
+        free(buf1);
+        free(buf2);
+
+        /* Full screen buffer cannot be smaller */
+        if (cfg->full) {
+            break;
+        }
+        lines -= (lines / 4 > 0 ? lines / 4 : 1);
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+* Private API functions
+*******************************************************************************/
+
+void *lvgl_port_buffer_malloc(size_t size, uint32_t caps)
+{
+#if LVGL_PORT_BUFFER_CACHE_ALIGN
+    size_t align = 0;
+    if (esp_cache_get_alignment(caps, &align) == ESP_OK && align > 4) {
+        /* Buffer is the only data in its cache lines, write back before DMA does not touch other data */
+        return heap_caps_aligned_alloc(align, (size + align - 1) & ~(align - 1), caps);
+    }
+#endif
+    return heap_caps_malloc(size, caps);
+}
+
+esp_err_t lvgl_port_buffers_auto(const lvgl_port_buff_auto_cfg_t *cfg, lvgl_port_buff_auto_t *out)
+{
+    assert(cfg && out);
+
+    const uint32_t internal_caps = MALLOC_CAP_INTERNAL | (cfg->dma ? MALLOC_CAP_DMA : 0);
+    uint32_t psram_caps = MALLOC_CAP_SPIRAM;
+#if SOC_PSRAM_DMA_CAPABLE
+    psram_caps |= (cfg->dma ? MALLOC_CAP_DMA : 0);
+#endif
+    const bool psram = cfg->psram_allowed && (heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0);
+
+    /* Order of tries: preferred memory with two buffers, then one buffer, then the other memory */
+    uint32_t caps_list[2];
+    int caps_cnt = 0;
+    if (psram && !cfg->internal_first) {
+        caps_list[caps_cnt++] = psram_caps;
+    }
+    caps_list[caps_cnt++] = internal_caps;
+    if (psram && cfg->internal_first) {
+        caps_list[caps_cnt++] = psram_caps;
+    }
+
+    for (int i = 0; i < caps_cnt; i++) {
+        if (lvgl_port_buffers_try(cfg, caps_list[i], true, out) || lvgl_port_buffers_try(cfg, caps_list[i], false, out)) {
+            ESP_LOGI(TAG, "Draw buffers: %d x %"PRIu32" px in %s", (out->buf2 ? 2 : 1), out->buffer_size, ((out->caps & MALLOC_CAP_SPIRAM) ? "PSRAM" : "internal RAM"));
+            return ESP_OK;
+        }
+    }
+
+    return ESP_ERR_NO_MEM;
+}
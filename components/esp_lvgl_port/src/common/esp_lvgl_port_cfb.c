@@ -0,0 +1,176 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_lvgl_port_priv.h"
+
+static const char *TAG = "LVGL";
+
+/* Line info: index of the valid slot, raw flag and count of used 16-bit words */
+#define LVGL_PORT_CFB_SLOT      (1UL << 31)
+#define LVGL_PORT_CFB_RAW       (1UL << 30)
+#define LVGL_PORT_CFB_LEN_MASK  (0xFFFFUL)
+
+struct lvgl_port_cfb_s {
+    uint32_t            hres;       /* Width of one line in pixels */
+    uint32_t            vres;       /* Count of lines */
+    uint16_t            *slots;     /* Two slots of `hres` words for each line (PSRAM), the new line is written into the unused one */
+    volatile uint32_t   *info;      /* Line info (internal RAM), read from the bounce buffer ISR */
+    uint16_t            *line;      /* Decompressed line being updated (internal RAM) */
+    uint16_t            *runs;      /* Compressed line before storing into PSRAM (internal RAM) */
+};
+
+static inline LVGL_PORT_RGB_ISR_ATTR uint16_t *lvgl_port_cfb_slot(lvgl_port_cfb_handle_t cfb, uint32_t y, uint32_t info)
+{
+    return &cfb->slots[((size_t)y * 2 + ((info & LVGL_PORT_CFB_SLOT) ? 1 : 0)) * cfb->hres];
+}
+
+/* Runs are pairs of words (count, color), returns 0 when the runs are not shorter than raw line */
+static uint32_t lvgl_port_cfb_encode(const uint16_t *line, uint32_t width, uint16_t *runs)
+{
+    uint32_t len = 0;
+    uint32_t x = 0;
+    while (x < width) {
+        const uint16_t color = line[x];
+        uint32_t cnt = 1;
+        while (x + cnt < width && line[x + cnt] == color) {
+            cnt++;
+        }
+        if (len + 2 >= width) {
+            return 0;
+        }
+        runs[len++] = (uint16_t)cnt;
+        runs[len++] = color;
+        x += cnt;
+    }
+    return len;
+}
+
+/* Decompress `cnt` pixels of the line from the pixel `x` */
+static LVGL_PORT_RGB_ISR_ATTR void lvgl_port_cfb_decode(lvgl_port_cfb_handle_t cfb, uint32_t y, uint32_t x, uint32_t cnt, uint16_t *dst)
+{
+    const uint32_t info = cfb->info[y];
+    const uint16_t *src = lvgl_port_cfb_slot(cfb, y, info);
+    const uint32_t len = info & LVGL_PORT_CFB_LEN_MASK;
+
+    if (info & LVGL_PORT_CFB_RAW) {
+        memcpy(dst, &src[x], cnt * sizeof(uint16_t));
+        return;
+    }
+    if (len == 0) {
+        /* Line was never written */
+        memset(dst, 0, cnt * sizeof(uint16_t));
+        return;
+    }
+
+    uint16_t *end = dst + cnt;
+    for (uint32_t i = 0; i < len && dst < end; i += 2) {
+        uint32_t run = src[i];
+        const uint16_t color = src[i + 1];
+        if (run <= x) {
+            /* Run is before the first pixel */
+            x -= run;
+            continue;
+        }
+        run -= x;
+        x = 0;
+        while (run-- && dst < end) {
+            *dst++ = color;
+        }
+    }
+}
+
+esp_err_t lvgl_port_cfb_init(uint32_t hres, uint32_t vres, lvgl_port_cfb_handle_t *ret_cfb)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(hres > 0 && hres <= LVGL_PORT_CFB_LEN_MASK && vres > 0 && ret_cfb, ESP_ERR_INVALID_ARG, TAG, "Invalid compressed frame buffer size!");
+
+    lvgl_port_cfb_handle_t cfb = heap_caps_calloc(1, sizeof(struct lvgl_port_cfb_s), MALLOC_CAP_INTERNAL);
+    ESP_RETURN_ON_FALSE(cfb, ESP_ERR_NO_MEM, TAG, "Not enough memory for compressed frame buffer allocation!");
+    cfb->hres = hres;
+    cfb->vres = vres;
+
+    cfb->slots = heap_caps_malloc((size_t)hres * vres * 2 * sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+    ESP_GOTO_ON_FALSE(cfb->slots, ESP_ERR_NO_MEM, err, TAG, "Not enough PSRAM for compressed frame buffer!");
+    /* All lines are black from the start */
+    cfb->info = heap_caps_calloc(vres, sizeof(uint32_t), MALLOC_CAP_INTERNAL);
+    cfb->line = heap_caps_malloc(hres * sizeof(uint16_t), MALLOC_CAP_INTERNAL);
+    cfb->runs = heap_caps_malloc(hres * sizeof(uint16_t), MALLOC_CAP_INTERNAL);
+    ESP_GOTO_ON_FALSE(cfb->info && cfb->line && cfb->runs, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for compressed frame buffer lines!");
+
+    *ret_cfb = cfb;
+    return ESP_OK;
+
+err:
+    lvgl_port_cfb_deinit(cfb);
+    return ret;
+}
+
+void lvgl_port_cfb_deinit(lvgl_port_cfb_handle_t cfb)
+{
+    if (cfb == NULL) {
+        return;
+    }
+
+    free(cfb->slots);
+    free((void *)cfb->info);
+    free(cfb->line);
+    free(cfb->runs);
+    free(cfb);
+}
+
+void lvgl_port_cfb_write(lvgl_port_cfb_handle_t cfb, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const uint16_t *data)
+{
+    assert(cfb);
+    const uint32_t width = x2 - x1 + 1;
+    const bool full_line = (x1 == 0 && width == cfb->hres);
+
+    for (int32_t y = y1; y <= y2; y++, data += width) {
+        const uint16_t *line = data;
+        if (!full_line) {
+            /* Only a part of the line is changed, the rest is taken from the stored line */
+            lvgl_port_cfb_decode(cfb, y, 0, cfb->hres, cfb->line);
+            memcpy(&cfb->line[x1], data, width * sizeof(uint16_t));
+            line = cfb->line;
+        }
+
+        /* The new line is stored into the unused slot, the bounce buffer ISR can be reading the other one */
+        const uint32_t slot = (cfb->info[y] & LVGL_PORT_CFB_SLOT) ^ LVGL_PORT_CFB_SLOT;
+        uint16_t *dst = lvgl_port_cfb_slot(cfb, y, slot);
+        const uint32_t len = lvgl_port_cfb_encode(line, cfb->hres, cfb->runs);
+        if (len) {
+            memcpy(dst, cfb->runs, len * sizeof(uint16_t));
+            cfb->info[y] = slot | len;
+        } else {
+            memcpy(dst, line, cfb->hres * sizeof(uint16_t));
+            cfb->info[y] = slot | LVGL_PORT_CFB_RAW | cfb->hres;
+        }
+    }
+}
+
+LVGL_PORT_RGB_ISR_ATTR void lvgl_port_cfb_read(lvgl_port_cfb_handle_t cfb, uint32_t pos_px, uint16_t *dst, uint32_t len_px)
+{
+    uint32_t y = pos_px / cfb->hres;
+    uint32_t x = pos_px % cfb->hres;
+    while (len_px > 0) {
+        /* Bounce buffer can wrap to the start of the frame */
+        if (y >= cfb->vres) {
+            y = 0;
+        }
+        /* Bounce buffer of not whole lines starts or ends in the middle of a line */
+        const uint32_t cnt = (len_px < cfb->hres - x) ? len_px : cfb->hres - x;
+        lvgl_port_cfb_decode(cfb, y, x, cnt, dst);
+        dst += cnt;
+        len_px -= cnt;
+        x = 0;
+        y++;
+    }
+}
@@ -0,0 +1,194 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include "esp_lvgl_port_gesture.h"
+
+/* Movement of the finger, which is still a tap or long press [px] */
+#define LVGL_PORT_GESTURE_TAP_AREA          (12)
+/* Longest tap [us] */
+#define LVGL_PORT_GESTURE_TAP_MAX_US        (300 * 1000)
+/* Longest time between two taps of double tap [us] */
+#define LVGL_PORT_GESTURE_DOUBLE_TAP_US     (350 * 1000)
+/* Long press time [us] */
+#define LVGL_PORT_GESTURE_LONG_PRESS_US     (500 * 1000)
+/* Shortest swipe [px] */
+#define LVGL_PORT_GESTURE_SWIPE_MIN         (50)
+/* Longest swipe [us] */
+#define LVGL_PORT_GESTURE_SWIPE_MAX_US      (500 * 1000)
+/* Pinch is reported after this change of scale (256 = 1.0) */
+#define LVGL_PORT_GESTURE_PINCH_MIN         (16)
+/* Rotation is reported after this change of angle [0.1 degree] */
+#define LVGL_PORT_GESTURE_ROTATE_MIN        (50)
+
+#define LVGL_PORT_GESTURE_SCALE_ONE         (256)
+#define LVGL_PORT_GESTURE_ABS(v)            ((v) < 0 ? -(v) : (v))
+
+/*******************************************************************************
+* Private functions
+*******************************************************************************/
+
+static inline lvgl_port_gesture_t *lvgl_port_gesture_add(lvgl_port_gesture_t *out, uint8_t *cnt, lvgl_port_gesture_type_t type, int32_t x, int32_t y)
+{
+    lvgl_port_gesture_t *gesture = &out[(*cnt)++];
+    memset(gesture, 0, sizeof(lvgl_port_gesture_t));
+    gesture->type = type;
+    gesture->point.x = x;
+    gesture->point.y = y;
+    gesture->scale = LVGL_PORT_GESTURE_SCALE_ONE;
+    return gesture;
+}
+
+/* Two fingers: pinch and rotation from the start of multi-touch */
+static uint8_t lvgl_port_gesture_multi(lvgl_port_gesture_ctx_t *ctx, const uint16_t *x, const uint16_t *y, lvgl_port_gesture_t *out)
+{
+    uint8_t cnt = 0;
+    const float dx = (float)x[1] - x[0];
+    const float dy = (float)y[1] - y[0];
+    const float dist = sqrtf(dx * dx + dy * dy);
+    const float angle = atan2f(dy, dx);
+    const int32_t cx = (x[0] + x[1]) / 2;
+    const int32_t cy = (y[0] + y[1]) / 2;
+
+    if (!ctx->multi || ctx->points < 2) {
+        /* Second finger touched (again), new reference */
+        ctx->multi = true;
+        ctx->start_dist = dist;
+        ctx->start_angle = angle;
+        ctx->scale = LVGL_PORT_GESTURE_SCALE_ONE;
+        ctx->angle = 0;
+        return 0;
+    }
+
+    if (ctx->start_dist >= 1.0f) {
+        const int32_t scale = (int32_t)(dist * LVGL_PORT_GESTURE_SCALE_ONE / ctx->start_dist);
+        if (LVGL_PORT_GESTURE_ABS(scale - ctx->scale) >= LVGL_PORT_GESTURE_PINCH_MIN) {
+            ctx->scale = scale;
+            lvgl_port_gesture_add(out, &cnt, LVGL_PORT_GESTURE_PINCH, cx, cy)->scale = scale;
+        }
+    }
+
+    float diff = angle - ctx->start_angle;
+    if (diff > (float)M_PI) {
+        diff -= 2.0f * (float)M_PI;
+    } else if (diff < -(float)M_PI) {
+        diff += 2.0f * (float)M_PI;
+    }
+    const int32_t rot = (int32_t)(diff * 1800.0f / (float)M_PI);
+    if (LVGL_PORT_GESTURE_ABS(rot - ctx->angle) >= LVGL_PORT_GESTURE_ROTATE_MIN) {
+        ctx->angle = rot;
+        lvgl_port_gesture_t *gesture = lvgl_port_gesture_add(out, &cnt, LVGL_PORT_GESTURE_ROTATE, cx, cy);
+        gesture->angle = rot;
+    }
+
+    return cnt;
+}
+
+/* End of one finger touch: swipe, tap or double tap */
+static uint8_t lvgl_port_gesture_release(lvgl_port_gesture_ctx_t *ctx, int64_t now_us, lvgl_port_gesture_t *out)
+{
+    uint8_t cnt = 0;
+    const int64_t duration = now_us - ctx->start_us;
+    const int32_t dx = ctx->last_x - ctx->start_x;
+    const int32_t dy = ctx->last_y - ctx->start_y;
+
+    if (ctx->multi || ctx->long_press) {
+        ctx->tap_valid = false;
+        return 0;
+    }
+
+    if (ctx->moved) {
+        const int32_t adx = LVGL_PORT_GESTURE_ABS(dx);
+        const int32_t ady = LVGL_PORT_GESTURE_ABS(dy);
+        if (duration <= LVGL_PORT_GESTURE_SWIPE_MAX_US && (adx >= LVGL_PORT_GESTURE_SWIPE_MIN || ady >= LVGL_PORT_GESTURE_SWIPE_MIN)) {
+            lvgl_port_gesture_t *gesture = lvgl_port_gesture_add(out, &cnt, LVGL_PORT_GESTURE_SWIPE, ctx->last_x, ctx->last_y);
+            if (adx >= ady) {
+                gesture->dir = (dx > 0 ? LV_DIR_RIGHT : LV_DIR_LEFT);
+            } else {
+                gesture->dir = (dy > 0 ? LV_DIR_BOTTOM : LV_DIR_TOP);
+            }
+        }
+        ctx->tap_valid = false;
+        return cnt;
+    }
+
+    if (duration > LVGL_PORT_GESTURE_TAP_MAX_US) {
+        ctx->tap_valid = false;
+        return 0;
+    }
+
+    /* Tap, the second one near to the first one is double tap */
+    if (ctx->tap_valid && (ctx->start_us - ctx->tap_us) <= LVGL_PORT_GESTURE_DOUBLE_TAP_US &&
+            LVGL_PORT_GESTURE_ABS(ctx->start_x - ctx->tap_x) <= LVGL_PORT_GESTURE_TAP_AREA &&
+            LVGL_PORT_GESTURE_ABS(ctx->start_y - ctx->tap_y) <= LVGL_PORT_GESTURE_TAP_AREA) {
+        lvgl_port_gesture_add(out, &cnt, LVGL_PORT_GESTURE_DOUBLE_TAP, ctx->start_x, ctx->start_y);
+        ctx->tap_valid = false;
+    } else {
+        ctx->tap_valid = true;
+        ctx->tap_us = now_us;
+        ctx->tap_x = ctx->start_x;
+        ctx->tap_y = ctx->start_y;
+    }
+
+    return cnt;
+}
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+void lvgl_port_gesture_init(lvgl_port_gesture_ctx_t *ctx)
+{
+    assert(ctx != NULL);
+    memset(ctx, 0, sizeof(lvgl_port_gesture_ctx_t));
+}
+
+uint8_t lvgl_port_gesture_update(lvgl_port_gesture_ctx_t *ctx, const uint16_t *x, const uint16_t *y, uint8_t cnt, int64_t now_us, lvgl_port_gesture_t *out)
+{
+    uint8_t out_cnt = 0;
+
+    assert(ctx != NULL);
+    assert(out != NULL);
+
+    if (cnt == 0) {
+        if (ctx->points > 0) {
+            out_cnt = lvgl_port_gesture_release(ctx, now_us, out);
+        }
+        ctx->points = 0;
+        return out_cnt;
+    }
+
+    assert(x != NULL && y != NULL);
+
+    if (ctx->points == 0) {
+        /* Start of touch */
+        ctx->start_x = ctx->last_x = x[0];
+        ctx->start_y = ctx->last_y = y[0];
+        ctx->start_us = now_us;
+        ctx->moved = false;
+        ctx->multi = false;
+        ctx->long_press = false;
+    }
+
+    ctx->last_x = x[0];
+    ctx->last_y = y[0];
+    if (LVGL_PORT_GESTURE_ABS(ctx->last_x - ctx->start_x) > LVGL_PORT_GESTURE_TAP_AREA ||
+            LVGL_PORT_GESTURE_ABS(ctx->last_y - ctx->start_y) > LVGL_PORT_GESTURE_TAP_AREA) {
+        ctx->moved = true;
+    }
+
+    if (cnt >= 2) {
+        out_cnt = lvgl_port_gesture_multi(ctx, x, y, out);
+    } else if (!ctx->moved && !ctx->multi && !ctx->long_press && (now_us - ctx->start_us) >= LVGL_PORT_GESTURE_LONG_PRESS_US) {
+        ctx->long_press = true;
+        lvgl_port_gesture_add(out, &out_cnt, LVGL_PORT_GESTURE_LONG_PRESS, ctx->start_x, ctx->start_y);
+    }
+
+    ctx->points = cnt;
+    return out_cnt;
+}
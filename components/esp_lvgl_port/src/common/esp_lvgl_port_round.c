@@ -0,0 +1,79 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include "esp_lvgl_port_priv.h"
+
+/* Minimal height of one band, bigger bands mean less commands but more invisible pixels */
+#define LVGL_PORT_ROUND_BAND_ROWS   (16)
+
+/* Distance from the center of the circle to the nearest point of the row (y is pixel index, center in pixel edges) */
+static inline float lvgl_port_round_row_dist(int32_t y, float center)
+{
+    if (y + 1 <= center) {
+        return center - (y + 1);
+    } else if (y >= center) {
+        return y - center;
+    }
+    return 0.0f;
+}
+
+static inline bool lvgl_port_round_row_visible(int32_t y, float radius)
+{
+    return lvgl_port_round_row_dist(y, radius) < radius;
+}
+
+uint32_t lvgl_port_round_split(uint32_t diameter, int32_t x1, int32_t y1, int32_t x2, int32_t y2, lvgl_port_round_band_t *bands)
+{
+    const float radius = diameter / 2.0f;
+    uint32_t cnt = 0;
+
+    /* Rows completely outside of the circle */
+    while (y1 <= y2 && !lvgl_port_round_row_visible(y1, radius)) {
+        y1++;
+    }
+    while (y2 >= y1 && !lvgl_port_round_row_visible(y2, radius)) {
+        y2--;
+    }
+    if (y1 > y2) {
+        return 0;
+    }
+
+    /* Bounded count of bands, so the command overhead does not grow with the area height */
+    int32_t rows = (y2 - y1 + LVGL_PORT_ROUND_BANDS_MAX) / LVGL_PORT_ROUND_BANDS_MAX;
+    if (rows < LVGL_PORT_ROUND_BAND_ROWS) {
+        rows = LVGL_PORT_ROUND_BAND_ROWS;
+    }
+
+    for (int32_t y = y1; y <= y2; y += rows) {
+        const int32_t band_y2 = (y + rows - 1 < y2) ? (y + rows - 1) : y2;
+
+        /* The widest row of the band is the nearest one to the center */
+        float dist = lvgl_port_round_row_dist(y, radius);
+        const float dist_end = lvgl_port_round_row_dist(band_y2, radius);
+        if (y < radius && band_y2 >= radius - 1) {
+            dist = 0.0f;
+        } else if (dist_end < dist) {
+            dist = dist_end;
+        }
+        const float half = sqrtf(radius * radius - dist * dist);
+        int32_t band_x1 = (int32_t)floorf(radius - half);
+        int32_t band_x2 = (int32_t)ceilf(radius + half) - 1;
+
+        band_x1 = (band_x1 > x1) ? band_x1 : x1;
+        band_x2 = (band_x2 < x2) ? band_x2 : x2;
+        if (band_x1 > band_x2) {
+            continue;
+        }
+        bands[cnt].x1 = band_x1;
+        bands[cnt].y1 = y;
+        bands[cnt].x2 = band_x2;
+        bands[cnt].y2 = band_y2;
+        cnt++;
+    }
+
+    return cnt;
+}
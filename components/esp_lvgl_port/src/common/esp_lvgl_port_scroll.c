@@ -0,0 +1,53 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <assert.h>
+#include "esp_lvgl_port_priv.h"
+
+uint32_t lvgl_port_scroll_split(int32_t top, int32_t height, int32_t offset, int32_t y1, int32_t y2, lvgl_port_scroll_part_t *parts)
+{
+    uint32_t cnt = 0;
+    int32_t y = y1;
+
+    while (y <= y2) {
+        int32_t end;
+        int32_t mem_y;
+        if (y < top) {
+            /* Top fixed area */
+            end = (y2 < top - 1 ? y2 : top - 1);
+            mem_y = y;
+        } else if (y >= top + height) {
+            /* Bottom fixed area */
+            end = y2;
+            mem_y = y;
+        } else {
+            /* Scrolling area, the rows continue in memory until its end, then from its start */
+            const int32_t row = (y - top + offset) % height;
+            end = y + (height - row) - 1;
+            if (end > top + height - 1) {
+                end = top + height - 1;
+            }
+            if (end > y2) {
+                end = y2;
+            }
+            mem_y = top + row;
+        }
+
+        if (cnt > 0 && parts[cnt - 1].mem_y1 + (parts[cnt - 1].y2 - parts[cnt - 1].y1 + 1) == mem_y) {
+            /* Continues in memory right after the previous part */
+            parts[cnt - 1].y2 = end;
+        } else {
+            assert(cnt < LVGL_PORT_SCROLL_PARTS_MAX);
+            parts[cnt].y1 = y;
+            parts[cnt].y2 = end;
+            parts[cnt].mem_y1 = mem_y;
+            cnt++;
+        }
+        y = end + 1;
+    }
+
+    return cnt;
+}
@@ -0,0 +1,138 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "driver/gpio.h"
+#endif
+#include "esp_lvgl_port_priv.h"
+
+static const char *TAG = "LVGL";
+
+/* Maximum waiting for TE pulse, the flush is not blocked when TE is not connected */
+#define LVGL_PORT_TE_TIMEOUT_MS     (50)
+
+struct lvgl_port_te_s {
+    int                 gpio_num;   /* GPIO connected to TE output of the LCD */
+    SemaphoreHandle_t   sem;        /* Given in each TE pulse */
+    volatile int64_t    last;       /* Time of the last TE pulse [us] */
+    volatile uint32_t   period;     /* Time between the last two TE pulses [us] */
+};
+
+#if !CONFIG_IDF_TARGET_LINUX
+static void lvgl_port_te_isr(void *arg)
+{
+    lvgl_port_te_handle_t te = (lvgl_port_te_handle_t)arg;
+    BaseType_t need_yield = pdFALSE;
+
+    const int64_t now = esp_timer_get_time();
+    if (te->last) {
+        te->period = (uint32_t)(now - te->last);
+    }
+    te->last = now;
+
+    xSemaphoreGiveFromISR(te->sem, &need_yield);
+    if (need_yield == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+#endif
+
+esp_err_t lvgl_port_te_init(int gpio_num, lvgl_port_te_handle_t *ret_te)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    /* No GPIO in host build */
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(GPIO_IS_VALID_GPIO(gpio_num) && ret_te, ESP_ERR_INVALID_ARG, TAG, "Invalid TE GPIO!");
+
+    lvgl_port_te_handle_t te = calloc(1, sizeof(struct lvgl_port_te_s));
+    ESP_RETURN_ON_FALSE(te, ESP_ERR_NO_MEM, TAG, "Not enough memory for TE context allocation!");
+    te->gpio_num = -1;
+
+    te->sem = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(te->sem, ESP_ERR_NO_MEM, err, TAG, "Failed to create TE semaphore!");
+
+    /* TE output is high during V-blanking */
+    const gpio_config_t gpio_cfg = {
+        .pin_bit_mask = BIT64(gpio_num),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_POSEDGE,
+    };
+    ESP_GOTO_ON_ERROR(gpio_config(&gpio_cfg), err, TAG, "TE GPIO config failed!");
+
+    /* ISR service can be already installed by application or other component */
+    ret = gpio_install_isr_service(0);
+    ESP_GOTO_ON_FALSE(ret == ESP_OK || ret == ESP_ERR_INVALID_STATE, ret, err, TAG, "GPIO ISR service install failed!");
+    ret = ESP_OK;
+    ESP_GOTO_ON_ERROR(gpio_isr_handler_add(gpio_num, lvgl_port_te_isr, te), err, TAG, "TE GPIO ISR handler add failed!");
+    te->gpio_num = gpio_num;
+
+    *ret_te = te;
+    return ESP_OK;
+
+err:
+    lvgl_port_te_deinit(te);
+    return ret;
+#endif
+}
+
+void lvgl_port_te_deinit(lvgl_port_te_handle_t te)
+{
+    if (te == NULL) {
+        return;
+    }
+
+#if !CONFIG_IDF_TARGET_LINUX
+    if (te->gpio_num >= 0) {
+        gpio_isr_handler_remove(te->gpio_num);
+        gpio_reset_pin(te->gpio_num);
+    }
+#endif
+    if (te->sem) {
+        vSemaphoreDelete(te->sem);
+    }
+    free(te);
+}
+
+void lvgl_port_te_wait(lvgl_port_te_handle_t te)
+{
+    assert(te);
+
+    /* V-blanking has just started, the write can start without waiting */
+    const int64_t since = esp_timer_get_time() - te->last;
+    if (te->period && since < te->period / 8) {
+        return;
+    }
+
+    /* Drop the old pulse and wait for the next one */
+    xSemaphoreTake(te->sem, 0);
+    if (xSemaphoreTake(te->sem, pdMS_TO_TICKS(LVGL_PORT_TE_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGD(TAG, "TE pulse timeout");
+    }
+}
+
+uint32_t lvgl_port_te_get_period(lvgl_port_te_handle_t te)
+{
+    assert(te);
+    /* Panel does not refresh anymore, the last period is not valid */
+    if (esp_timer_get_time() - te->last > LVGL_PORT_TE_TIMEOUT_MS * 1000) {
+        return 0;
+    }
+    return te->period;
+}
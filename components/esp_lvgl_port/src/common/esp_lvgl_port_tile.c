@@ -0,0 +1,127 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_crc.h"
+#include "esp_lvgl_port_priv.h"
+
+static const char *TAG = "LVGL";
+
+/* Hash of a tile with unknown content on the panel, computed zero hash is stored as 1 */
+#define LVGL_PORT_TILE_UNKNOWN  (0)
+
+struct lvgl_port_tile_s {
+    uint32_t    *hash;      /* CRC32 of each tile as sent to the panel (internal RAM) */
+    uint32_t    cols;       /* Tiles in one row of the grid (for the longer side, any rotation fits) */
+    int32_t     hres;       /* Resolution of the current coordinates of the flushed areas */
+    int32_t     vres;
+};
+
+esp_err_t lvgl_port_tile_init(uint32_t hres, uint32_t vres, lvgl_port_tile_handle_t *ret_tiles)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(hres > 0 && vres > 0 && ret_tiles, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments!");
+
+    lvgl_port_tile_handle_t tiles = calloc(1, sizeof(struct lvgl_port_tile_s));
+    ESP_RETURN_ON_FALSE(tiles, ESP_ERR_NO_MEM, TAG, "Not enough memory for tile hash!");
+    tiles->cols = (LV_MAX(hres, vres) + LVGL_PORT_TILE_SIZE - 1) / LVGL_PORT_TILE_SIZE;
+    /* Looked up for each tile of each flushed area */
+    tiles->hash = heap_caps_malloc(tiles->cols * tiles->cols * sizeof(uint32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    ESP_GOTO_ON_FALSE(tiles->hash, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for tile hash!");
+    lvgl_port_tile_reset(tiles, hres, vres);
+
+    *ret_tiles = tiles;
+    return ESP_OK;
+
+err:
+    free(tiles);
+    return ret;
+}
+
+void lvgl_port_tile_deinit(lvgl_port_tile_handle_t tiles)
+{
+    if (tiles) {
+        free(tiles->hash);
+        free(tiles);
+    }
+}
+
+void lvgl_port_tile_reset(lvgl_port_tile_handle_t tiles, int32_t hres, int32_t vres)
+{
+    assert(tiles);
+    tiles->hres = hres;
+    tiles->vres = vres;
+    memset(tiles->hash, LVGL_PORT_TILE_UNKNOWN, tiles->cols * tiles->cols * sizeof(uint32_t));
+}
+
+void lvgl_port_tile_forget(lvgl_port_tile_handle_t tiles, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    assert(tiles);
+    const int32_t last = (int32_t)tiles->cols - 1;
+    for (int32_t ty = LV_MAX(y1, 0) / LVGL_PORT_TILE_SIZE; ty <= LV_MIN(y2 / LVGL_PORT_TILE_SIZE, last); ty++) {
+        for (int32_t tx = LV_MAX(x1, 0) / LVGL_PORT_TILE_SIZE; tx <= LV_MIN(x2 / LVGL_PORT_TILE_SIZE, last); tx++) {
+            tiles->hash[ty * tiles->cols + tx] = LVGL_PORT_TILE_UNKNOWN;
+        }
+    }
+}
+
+bool lvgl_port_tile_compare(lvgl_port_tile_handle_t tiles, const uint8_t *data, size_t stride, uint32_t px_size,
+                            int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t *changed_x1, int32_t *changed_x2)
+{
+    assert(tiles && data);
+    const int32_t ty = y1 / LVGL_PORT_TILE_SIZE;
+    const int32_t tile_y1 = ty * LVGL_PORT_TILE_SIZE;
+    const int32_t tile_y2 = LV_MIN(tile_y1 + LVGL_PORT_TILE_SIZE - 1, tiles->vres - 1);
+    assert(y2 <= tile_y1 + LVGL_PORT_TILE_SIZE - 1);
+    /* Only tiles covered by the area are known after the flush, other rows of the tile are not seen */
+    const bool full_rows = (y1 == tile_y1 && y2 == tile_y2 && ty < (int32_t)tiles->cols);
+    int32_t first = -1;
+    int32_t last = -1;
+
+    for (int32_t tx = x1 / LVGL_PORT_TILE_SIZE; tx <= x2 / LVGL_PORT_TILE_SIZE; tx++) {
+        const int32_t tile_x1 = tx * LVGL_PORT_TILE_SIZE;
+        const int32_t tile_x2 = LV_MIN(tile_x1 + LVGL_PORT_TILE_SIZE - 1, tiles->hres - 1);
+        uint32_t *stored = (ty < (int32_t)tiles->cols && tx < (int32_t)tiles->cols ? &tiles->hash[ty * tiles->cols + tx] : NULL);
+        bool changed = true;
+
+        if (stored && full_rows && x1 <= tile_x1 && x2 >= tile_x2) {
+            const uint8_t *line = data + (size_t)(tile_x1 - x1) * px_size;
+            const uint32_t len = (uint32_t)(tile_x2 - tile_x1 + 1) * px_size;
+            uint32_t crc = 0;
+            for (int32_t y = y1; y <= y2; y++) {
+                crc = esp_rom_crc32_le(crc, line, len);
+                line += stride;
+            }
+            if (crc == LVGL_PORT_TILE_UNKNOWN) {
+                crc = 1;
+            }
+            changed = (*stored != crc);
+            *stored = crc;
+        } else if (stored) {
+            *stored = LVGL_PORT_TILE_UNKNOWN;
+        }
+
+        if (changed) {
+            if (first < 0) {
+                first = tx;
+            }
+            last = tx;
+        }
+    }
+
+    if (first < 0) {
+        return false;
+    }
+    *changed_x1 = LV_MAX(x1, first * LVGL_PORT_TILE_SIZE);
+    *changed_x2 = LV_MIN(x2, last * LVGL_PORT_TILE_SIZE + LVGL_PORT_TILE_SIZE - 1);
+    return true;
+}
@@ -0,0 +1,334 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_lvgl_port_transform.h"
+
+/* Size of one tile (pixels x pixels) for 90 and 270 degrees rotation */
+#define LVGL_PORT_TRANSFORM_TILE   (16)
+
+/* Swap bytes in both RGB565 pixels of one 32-bit word */
+#define LVGL_PORT_SWAP_WORD(w)     ((((w) & 0x00FF00FFU) << 8) | (((w) >> 8) & 0x00FF00FFU))
+#define LVGL_PORT_SWAP_PIXEL(p)    ((uint16_t)(((p) << 8) | ((p) >> 8)))
+
+/* RGB565 pixel spread in 32-bit word (G in upper half, R and B in lower half) with gaps for 5-bit weights,
+   all three channels are interpolated by one multiplication */
+#define LVGL_PORT_RGB565_MASK      (0x07E0F81FU)
+#define LVGL_PORT_RGB565_EXPAND(p) ((((uint32_t)(p) << 16) | (p)) & LVGL_PORT_RGB565_MASK)
+#define LVGL_PORT_RGB565_PACK(w)   ((uint16_t)(((w) & LVGL_PORT_RGB565_MASK) | (((w) & LVGL_PORT_RGB565_MASK) >> 16)))
+#define LVGL_PORT_RGB565_MIX(a, b, w) ((((a) * (32 - (w)) + (b) * (w)) >> 5) & LVGL_PORT_RGB565_MASK)
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+void lvgl_port_transform_rgb565_swap(uint16_t *buf, size_t len)
+{
+    if (buf == NULL || len == 0) {
+        return;
+    }
+
+    /* Align to 32-bit word */
+    if (((uintptr_t)buf & 0x3) != 0) {
+        *buf = LVGL_PORT_SWAP_PIXEL(*buf);
+        buf++;
+        len--;
+    }
+
+    /* Two pixels in one word, four words in one loop */
+    uint32_t *buf32 = (uint32_t *)buf;
+    size_t words = len / 2;
+    while (words >= 4) {
+        buf32[0] = LVGL_PORT_SWAP_WORD(buf32[0]);
+        buf32[1] = LVGL_PORT_SWAP_WORD(buf32[1]);
+        buf32[2] = LVGL_PORT_SWAP_WORD(buf32[2]);
+        buf32[3] = LVGL_PORT_SWAP_WORD(buf32[3]);
+        buf32 += 4;
+        words -= 4;
+    }
+    while (words > 0) {
+        *buf32 = LVGL_PORT_SWAP_WORD(*buf32);
+        buf32++;
+        words--;
+    }
+
+    /* Last pixel */
+    if (len & 0x1) {
+        buf = (uint16_t *)buf32;
+        *buf = LVGL_PORT_SWAP_PIXEL(*buf);
+    }
+}
+
+void lvgl_port_transform_rgb565_swap_copy(uint16_t *dst, const uint16_t *src, size_t len)
+{
+    if (dst == NULL || src == NULL || len == 0) {
+        return;
+    }
+
+    /* Word access is possible only when both buffers have the same alignment */
+    if ((((uintptr_t)dst ^ (uintptr_t)src) & 0x3) != 0) {
+        while (len--) {
+            *dst++ = LVGL_PORT_SWAP_PIXEL(*src);
+            src++;
+        }
+        return;
+    }
+
+    if (((uintptr_t)dst & 0x3) != 0) {
+        *dst++ = LVGL_PORT_SWAP_PIXEL(*src);
+        src++;
+        len--;
+    }
+
+    uint32_t *dst32 = (uint32_t *)dst;
+    const uint32_t *src32 = (const uint32_t *)src;
+    size_t words = len / 2;
+    while (words >= 4) {
+        dst32[0] = LVGL_PORT_SWAP_WORD(src32[0]);
+        dst32[1] = LVGL_PORT_SWAP_WORD(src32[1]);
+        dst32[2] = LVGL_PORT_SWAP_WORD(src32[2]);
+        dst32[3] = LVGL_PORT_SWAP_WORD(src32[3]);
+        dst32 += 4;
+        src32 += 4;
+        words -= 4;
+    }
+    while (words > 0) {
+        *dst32++ = LVGL_PORT_SWAP_WORD(*src32);
+        src32++;
+        words--;
+    }
+
+    if (len & 0x1) {
+        *(uint16_t *)dst32 = LVGL_PORT_SWAP_PIXEL(*(const uint16_t *)src32);
+    }
+}
+
+bool lvgl_port_transform_rgb565_is_solid(const uint16_t *buf, size_t len, uint16_t *color)
+{
+    if (buf == NULL || len == 0) {
+        return false;
+    }
+
+    const uint16_t first = buf[0];
+    const uint32_t pattern = ((uint32_t)first << 16) | first;
+
+    /* Align to 32-bit word, the first pixel is the pattern */
+    if (((uintptr_t)buf & 0x3) != 0) {
+        buf++;
+        len--;
+    }
+
+    /* Two pixels in one word, four words in one loop */
+    const uint32_t *buf32 = (const uint32_t *)buf;
+    size_t words = len / 2;
+    while (words >= 4) {
+        if (((buf32[0] ^ pattern) | (buf32[1] ^ pattern) | (buf32[2] ^ pattern) | (buf32[3] ^ pattern)) != 0) {
+            return false;
+        }
+        buf32 += 4;
+        words -= 4;
+    }
+    while (words > 0) {
+        if (*buf32 != pattern) {
+            return false;
+        }
+        buf32++;
+        words--;
+    }
+
+    /* Last pixel */
+    if ((len & 0x1) && *(const uint16_t *)buf32 != first) {
+        return false;
+    }
+
+    if (color) {
+        *color = first;
+    }
+    return true;
+}
+
+void lvgl_port_transform_rgb565_rotate(const uint16_t *src, uint16_t *dst, int32_t w, int32_t h, lv_display_rotation_t rotation, bool swap)
+{
+    const int32_t lines = ((rotation == LV_DISPLAY_ROTATION_90 || rotation == LV_DISPLAY_ROTATION_270) ? w : h);
+
+    lvgl_port_transform_rgb565_rotate_lines(src, dst, w, h, rotation, swap, 0, lines);
+}
+
+void lvgl_port_transform_rgb565_rotate_lines(const uint16_t *src, uint16_t *dst, int32_t w, int32_t h, lv_display_rotation_t rotation, bool swap,
+        int32_t line, int32_t lines)
+{
+    const bool transpose = (rotation == LV_DISPLAY_ROTATION_90 || rotation == LV_DISPLAY_ROTATION_270);
+    const int32_t out_h = (transpose ? w : h);
+
+    if (src == NULL || dst == NULL || w <= 0 || h <= 0 || line < 0 || line >= out_h || lines <= 0) {
+        return;
+    }
+    if (lines > out_h - line) {
+        lines = out_h - line;
+    }
+
+    const size_t len = (size_t)w * h;
+
+    switch (rotation) {
+    case LV_DISPLAY_ROTATION_0:
+        src += (size_t)line * w;
+        if (swap) {
+            lvgl_port_transform_rgb565_swap_copy(dst, src, (size_t)lines * w);
+        } else if (dst != src) {
+            memcpy(dst, src, (size_t)lines * w * sizeof(uint16_t));
+        }
+        break;
+    case LV_DISPLAY_ROTATION_180:
+        /* Reverse order of all pixels, output lines are the source lines from the bottom */
+        for (size_t i = (size_t)line * w; i < (size_t)(line + lines) * w; i++) {
+            const uint16_t px = src[len - 1 - i];
+            *dst++ = (swap ? LVGL_PORT_SWAP_PIXEL(px) : px);
+        }
+        break;
+    case LV_DISPLAY_ROTATION_90:
+    case LV_DISPLAY_ROTATION_270: {
+        /* Output area has width h and height w, its lines are the source columns (from the right for 90 degrees).
+         * Transpose in tiles for keep source and destination lines in cache. */
+        const int32_t x_first = (rotation == LV_DISPLAY_ROTATION_90 ? w - line - lines : line);
+        const int32_t x_last = x_first + lines;
+        for (int32_t ty = 0; ty < h; ty += LVGL_PORT_TRANSFORM_TILE) {
+            const int32_t ty_end = (ty + LVGL_PORT_TRANSFORM_TILE < h ? ty + LVGL_PORT_TRANSFORM_TILE : h);
+            for (int32_t tx = x_first; tx < x_last; tx += LVGL_PORT_TRANSFORM_TILE) {
+                const int32_t tx_end = (tx + LVGL_PORT_TRANSFORM_TILE < x_last ? tx + LVGL_PORT_TRANSFORM_TILE : x_last);
+                for (int32_t y = ty; y < ty_end; y++) {
+                    const uint16_t *src_line = src + (size_t)y * w;
+                    for (int32_t x = tx; x < tx_end; x++) {
+                        uint16_t px = src_line[x];
+                        if (swap) {
+                            px = LVGL_PORT_SWAP_PIXEL(px);
+                        }
+                        if (rotation == LV_DISPLAY_ROTATION_90) {
+                            /* (x, y) -> (y, w - 1 - x) */
+                            dst[(size_t)(w - 1 - x - line) * h + y] = px;
+                        } else {
+                            /* (x, y) -> (h - 1 - y, x) */
+                            dst[(size_t)(x - line) * h + (h - 1 - y)] = px;
+                        }
+                    }
+                }
+            }
+        }
+        break;
+    }
+    }
+}
+
+void lvgl_port_transform_l8_to_rgb565(const uint8_t *src, uint16_t *dst, size_t len, const uint16_t *clut)
+{
+    if (dst == NULL || src == NULL || clut == NULL) {
+        return;
+    }
+
+    /* Four pixels in one loop */
+    while (len >= 4) {
+        dst[0] = clut[src[0]];
+        dst[1] = clut[src[1]];
+        dst[2] = clut[src[2]];
+        dst[3] = clut[src[3]];
+        src += 4;
+        dst += 4;
+        len -= 4;
+    }
+    while (len--) {
+        *dst++ = clut[*src++];
+    }
+}
+
+void lvgl_port_transform_rgb565_scale(const uint16_t *src, int32_t src_w, int32_t src_h, uint16_t *dst, int32_t dst_w, int32_t dst_h, bool bilinear, bool swap)
+{
+    if (src == NULL || dst == NULL || src_w <= 0 || src_h <= 0 || dst_w <= 0 || dst_h <= 0) {
+        return;
+    }
+
+    /* Crop the source to the aspect ratio of the destination (centered) */
+    int32_t crop_w = src_w;
+    int32_t crop_h = src_h;
+    if ((int64_t)src_w * dst_h > (int64_t)src_h * dst_w) {
+        crop_w = (int32_t)((int64_t)src_h * dst_w / dst_h);
+    } else {
+        crop_h = (int32_t)((int64_t)src_w * dst_h / dst_w);
+    }
+    crop_w = (crop_w > 0 ? crop_w : 1);
+    crop_h = (crop_h > 0 ? crop_h : 1);
+    const uint16_t *crop = src + (size_t)((src_h - crop_h) / 2) * src_w + (src_w - crop_w) / 2;
+
+    /* 16.16 fixed point steps, pixel centers are sampled */
+    const uint32_t step_x = ((uint32_t)crop_w << 16) / dst_w;
+    const uint32_t step_y = ((uint32_t)crop_h << 16) / dst_h;
+
+    if (!bilinear) {
+        uint32_t fy = step_y / 2;
+        for (int32_t y = 0; y < dst_h; y++, fy += step_y) {
+            const uint16_t *src_line = crop + (size_t)(fy >> 16) * src_w;
+            uint32_t fx = step_x / 2;
+            int32_t x = 0;
+            /* Four pixels in one loop */
+            for (; x + 4 <= dst_w; x += 4) {
+                uint16_t p0 = src_line[fx >> 16];
+                uint16_t p1 = src_line[(fx + step_x) >> 16];
+                uint16_t p2 = src_line[(fx + 2 * step_x) >> 16];
+                uint16_t p3 = src_line[(fx + 3 * step_x) >> 16];
+                if (swap) {
+                    p0 = LVGL_PORT_SWAP_PIXEL(p0);
+                    p1 = LVGL_PORT_SWAP_PIXEL(p1);
+                    p2 = LVGL_PORT_SWAP_PIXEL(p2);
+                    p3 = LVGL_PORT_SWAP_PIXEL(p3);
+                }
+                dst[0] = p0;
+                dst[1] = p1;
+                dst[2] = p2;
+                dst[3] = p3;
+                dst += 4;
+                fx += 4 * step_x;
+            }
+            for (; x < dst_w; x++, fx += step_x) {
+                const uint16_t px = src_line[fx >> 16];
+                *dst++ = (swap ? LVGL_PORT_SWAP_PIXEL(px) : px);
+            }
+        }
+        return;
+    }
+
+    /* Bilinear: source position of the destination pixel center, interpolated with 5-bit weights */
+    const uint32_t max_x = (uint32_t)(crop_w - 1) << 16;
+    const uint32_t max_y = (uint32_t)(crop_h - 1) << 16;
+    const int64_t start_x = (int64_t)(step_x / 2) - 0x8000;
+    const int64_t start_y = (int64_t)(step_y / 2) - 0x8000;
+    for (int32_t y = 0; y < dst_h; y++) {
+        int64_t fy = start_y + (int64_t)y * step_y;
+        fy = (fy < 0 ? 0 : (fy > max_y ? max_y : fy));
+        const int32_t y0 = (int32_t)(fy >> 16);
+        const uint32_t wy = ((uint32_t)fy >> 11) & 0x1F;
+        const uint16_t *line0 = crop + (size_t)y0 * src_w;
+        const uint16_t *line1 = (y0 + 1 < crop_h ? line0 + src_w : line0);
+        for (int32_t x = 0; x < dst_w; x++) {
+            int64_t fx = start_x + (int64_t)x * step_x;
+            fx = (fx < 0 ? 0 : (fx > max_x ? max_x : fx));
+            const int32_t x0 = (int32_t)(fx >> 16);
+            const int32_t x1 = (x0 + 1 < crop_w ? x0 + 1 : x0);
+            const uint32_t wx = ((uint32_t)fx >> 11) & 0x1F;
+            uint16_t p00 = line0[x0];
+            uint16_t p01 = line0[x1];
+            uint16_t p10 = line1[x0];
+            uint16_t p11 = line1[x1];
+            if (swap) {
+                p00 = LVGL_PORT_SWAP_PIXEL(p00);
+                p01 = LVGL_PORT_SWAP_PIXEL(p01);
+                p10 = LVGL_PORT_SWAP_PIXEL(p10);
+                p11 = LVGL_PORT_SWAP_PIXEL(p11);
+            }
+            const uint32_t top = LVGL_PORT_RGB565_MIX(LVGL_PORT_RGB565_EXPAND(p00), LVGL_PORT_RGB565_EXPAND(p01), wx);
+            const uint32_t bottom = LVGL_PORT_RGB565_MIX(LVGL_PORT_RGB565_EXPAND(p10), LVGL_PORT_RGB565_EXPAND(p11), wx);
+            const uint32_t px = LVGL_PORT_RGB565_MIX(top, bottom, wy);
+            *dst++ = LVGL_PORT_RGB565_PACK(px);
+        }
+    }
+}
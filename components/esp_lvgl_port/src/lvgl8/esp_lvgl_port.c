@@ -5,6 +5,7 @@
  */
 
 #include <string.h>
+#include <stdatomic.h>
 #include "esp_system.h"
 #include "esp_log.h"
 #include "esp_err.h"
@@ -21,10 +22,27 @@ static const char *TAG = "LVGL";
 
 #define ESP_LVGL_PORT_TASK_MUX_DELAY_MS    10000
 
+/* Maximum number of pending lvgl_port_async_call (power of two) */
+#define ESP_LVGL_PORT_ASYNC_QUEUE_LEN      16
+
 /*******************************************************************************
 * Types definitions
 *******************************************************************************/
 
+typedef struct {
+    atomic_uint          seq;       /* Sequence number of the cell (ready for write: position, ready for read: position + 1) */
+    lvgl_port_async_cb_t cb;
+    void                 *user_data;
+} lvgl_port_async_t;
+
+/* Lock-free ring buffer, more producers (tasks and ISRs) and one consumer (LVGL task) */
+typedef struct {
+    lvgl_port_async_t    cells[ESP_LVGL_PORT_ASYNC_QUEUE_LEN];
+    atomic_uint          head;      /* Next position for write */
+    unsigned int         tail;      /* Next position for read (LVGL task only) */
+    bool                 ready;
+} lvgl_port_async_ring_t;
+
 typedef struct lvgl_port_ctx_s {
     TaskHandle_t        lvgl_task;
     SemaphoreHandle_t   lvgl_mux;
@@ -33,12 +51,17 @@ typedef struct lvgl_port_ctx_s {
     bool                running;
     int                 task_max_sleep_ms;
     int                 timer_period_ms;
+    lvgl_port_async_ring_t async;       /* Pending lvgl_port_async_call */
+    lvgl_port_lock_stats_t lock_stats;  /* LVGL lock statistics */
+    int64_t             lock_start;     /* Time of taking the LVGL lock [us] */
+    uint32_t            lock_depth;     /* Recursive depth of the LVGL lock */
 } lvgl_port_ctx_t;
 
 /*******************************************************************************
 * Local variables
 *******************************************************************************/
 static lvgl_port_ctx_t lvgl_port_ctx;
+static portMUX_TYPE lvgl_port_stats_lock = portMUX_INITIALIZER_UNLOCKED;
 
 /*******************************************************************************
 * Function definitions
@@ -46,6 +69,9 @@ static lvgl_port_ctx_t lvgl_port_ctx;
 static void lvgl_port_task(void *arg);
 static esp_err_t lvgl_port_tick_init(void);
 static void lvgl_port_task_deinit(void);
+static void lvgl_port_lock_taken(int64_t wait_start, bool contended);
+static void lvgl_port_lock_released(void);
+static void lvgl_port_process_async(void);
 
 /*******************************************************************************
 * Public API functions
@@ -75,6 +101,13 @@ esp_err_t lvgl_port_init(const lvgl_port_cfg_t *cfg)
     /* Task semaphore */
     lvgl_port_ctx.task_mux = xSemaphoreCreateMutex();
     ESP_GOTO_ON_FALSE(lvgl_port_ctx.task_mux, ESP_ERR_NO_MEM, err, TAG, "Create LVGL task sem fail!");
+    /* Async calls */
+    for (int i = 0; i < ESP_LVGL_PORT_ASYNC_QUEUE_LEN; i++) {
+        atomic_init(&lvgl_port_ctx.async.cells[i].seq, i);
+    }
+    atomic_init(&lvgl_port_ctx.async.head, 0);
+    lvgl_port_ctx.async.tail = 0;
+    lvgl_port_ctx.async.ready = true;
 
     BaseType_t res;
     if (cfg->task_affinity < 0) {
@@ -96,6 +129,12 @@ esp_err_t lvgl_port_resume(void)
 {
     esp_err_t ret = ESP_ERR_INVALID_STATE;
 
+#if LV_TICK_CUSTOM
+    if (lvgl_port_ctx.lvgl_mux != NULL) {
+        lv_timer_enable(true);
+        ret = ESP_OK;
+    }
+#endif
     if (lvgl_port_ctx.tick_timer != NULL) {
         lv_timer_enable(true);
         ret = esp_timer_start_periodic(lvgl_port_ctx.tick_timer, lvgl_port_ctx.timer_period_ms * 1000);
@@ -108,6 +147,12 @@ esp_err_t lvgl_port_stop(void)
 {
     esp_err_t ret = ESP_ERR_INVALID_STATE;
 
+#if LV_TICK_CUSTOM
+    if (lvgl_port_ctx.lvgl_mux != NULL) {
+        lv_timer_enable(false);
+        ret = ESP_OK;
+    }
+#endif
     if (lvgl_port_ctx.tick_timer != NULL) {
         lv_timer_enable(false);
         ret = esp_timer_stop(lvgl_port_ctx.tick_timer);
@@ -147,15 +192,109 @@ bool lvgl_port_lock(uint32_t timeout_ms)
     assert(lvgl_port_ctx.lvgl_mux && "lvgl_port_init must be called first");
 
     const TickType_t timeout_ticks = (timeout_ms == 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
-    return xSemaphoreTakeRecursive(lvgl_port_ctx.lvgl_mux, timeout_ticks) == pdTRUE;
+    const int64_t wait_start = esp_timer_get_time();
+    /* Lock held by another task is counted as contention */
+    const bool contended = (xSemaphoreTakeRecursive(lvgl_port_ctx.lvgl_mux, 0) != pdTRUE);
+    if (contended && xSemaphoreTakeRecursive(lvgl_port_ctx.lvgl_mux, timeout_ticks) != pdTRUE) {
+        return false;
+    }
+    lvgl_port_lock_taken(wait_start, contended);
+    return true;
 }
 
 void lvgl_port_unlock(void)
 {
     assert(lvgl_port_ctx.lvgl_mux && "lvgl_port_init must be called first");
+    lvgl_port_lock_released();
     xSemaphoreGiveRecursive(lvgl_port_ctx.lvgl_mux);
 }
 
+esp_err_t lvgl_port_get_lock_stats(lvgl_port_lock_stats_t *stats, bool reset)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(lvgl_port_ctx.lvgl_mux, ESP_ERR_INVALID_STATE, TAG, "lvgl_port_init must be called first");
+
+    /* Statistics can be read without the LVGL lock, the task waiting for the lock is not blocked */
+    portENTER_CRITICAL(&lvgl_port_stats_lock);
+    memcpy(stats, &lvgl_port_ctx.lock_stats, sizeof(lvgl_port_lock_stats_t));
+    if (reset) {
+        const TaskHandle_t owner = lvgl_port_ctx.lock_stats.owner;
+        memset(&lvgl_port_ctx.lock_stats, 0, sizeof(lvgl_port_lock_stats_t));
+        lvgl_port_ctx.lock_stats.owner = owner;
+    }
+    portEXIT_CRITICAL(&lvgl_port_stats_lock);
+
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_async_call(lvgl_port_async_cb_t cb, void *user_data)
+{
+    /* No logs here, this function can be called from ISR */
+    if (cb == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!lvgl_port_ctx.async.ready) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* Reserve a cell: the cell is free, when its sequence is equal to the write position */
+    lvgl_port_async_ring_t *ring = &lvgl_port_ctx.async;
+    lvgl_port_async_t *cell;
+    unsigned int pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    while (1) {
+        cell = &ring->cells[pos & (ESP_LVGL_PORT_ASYNC_QUEUE_LEN - 1)];
+        const unsigned int seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        const int diff = (int)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->head, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* Ring is full */
+            return ESP_ERR_TIMEOUT;
+        } else {
+            pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        }
+    }
+
+    cell->cb = cb;
+    cell->user_data = user_data;
+    /* Publish the cell for the LVGL task */
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_set_trace_cb(lvgl_port_trace_cb_t cb, void *user_ctx)
+{
+    ESP_LOGE(TAG, "Tracing is not supported, when used LVGL8!");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t lvgl_port_get_pm_stats(lvgl_port_pm_stats_t *stats, bool reset)
+{
+    ESP_LOGE(TAG, "PM statistics are not supported, when used LVGL8!");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t lvgl_port_park(bool release_buffers)
+{
+    ESP_LOGE(TAG, "Park is not supported, when used LVGL8!");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t lvgl_port_unpark(void)
+{
+    ESP_LOGE(TAG, "Park is not supported, when used LVGL8!");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t lvgl_port_mem_get_stats(lvgl_port_mem_stats_t *stats)
+{
+    ESP_LOGE(TAG, "LVGL memory arena is not supported, when used LVGL8!");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
 esp_err_t lvgl_port_task_wake(lvgl_port_event_type_t event, void *param)
 {
     ESP_LOGE(TAG, "Task wake is not supported, when used LVGL8!");
@@ -195,6 +334,8 @@ static void lvgl_port_task(void *arg)
     lvgl_port_ctx.running = true;
     while (lvgl_port_ctx.running) {
         if (lvgl_port_lock(0)) {
+            /* UI updates from other tasks */
+            lvgl_port_process_async();
             task_delay_ms = lv_timer_handler();
             lvgl_port_unlock();
         }
@@ -213,6 +354,64 @@ static void lvgl_port_task(void *arg)
     vTaskDelete( NULL );
 }
 
+static void lvgl_port_lock_taken(int64_t wait_start, bool contended)
+{
+    /* Only the first (not recursive) lock is measured */
+    if (lvgl_port_ctx.lock_depth++ > 0) {
+        return;
+    }
+
+    const int64_t now = esp_timer_get_time();
+    const uint32_t wait_time = (uint32_t)(now - wait_start);
+    lvgl_port_lock_stats_t *stats = &lvgl_port_ctx.lock_stats;
+    portENTER_CRITICAL(&lvgl_port_stats_lock);
+    stats->lock_cnt++;
+    stats->contended_cnt += (contended ? 1 : 0);
+    stats->wait_time_sum += wait_time;
+    if (wait_time > stats->wait_time_max) {
+        stats->wait_time_max = wait_time;
+    }
+    stats->owner = xTaskGetCurrentTaskHandle();
+    portEXIT_CRITICAL(&lvgl_port_stats_lock);
+    lvgl_port_ctx.lock_start = now;
+}
+
+static void lvgl_port_lock_released(void)
+{
+    if (--lvgl_port_ctx.lock_depth > 0) {
+        return;
+    }
+
+    const uint32_t hold_time = (uint32_t)(esp_timer_get_time() - lvgl_port_ctx.lock_start);
+    lvgl_port_lock_stats_t *stats = &lvgl_port_ctx.lock_stats;
+    portENTER_CRITICAL(&lvgl_port_stats_lock);
+    stats->hold_time_sum += hold_time;
+    if (hold_time > stats->hold_time_max) {
+        stats->hold_time_max = hold_time;
+    }
+    stats->owner = NULL;
+    portEXIT_CRITICAL(&lvgl_port_stats_lock);
+}
+
+static void lvgl_port_process_async(void)
+{
+    lvgl_port_async_ring_t *ring = &lvgl_port_ctx.async;
+    while (1) {
+        lvgl_port_async_t *cell = &ring->cells[ring->tail & (ESP_LVGL_PORT_ASYNC_QUEUE_LEN - 1)];
+        if (atomic_load_explicit(&cell->seq, memory_order_acquire) != ring->tail + 1) {
+            /* Empty or the producer did not finish writing yet */
+            break;
+        }
+        const lvgl_port_async_cb_t cb = cell->cb;
+        void *user_data = cell->user_data;
+        /* Release the cell for the next round */
+        atomic_store_explicit(&cell->seq, ring->tail + ESP_LVGL_PORT_ASYNC_QUEUE_LEN, memory_order_release);
+        ring->tail++;
+
+        cb(user_data);
+    }
+}
+
 static void lvgl_port_task_deinit(void)
 {
     if (lvgl_port_ctx.lvgl_mux) {
@@ -228,14 +427,20 @@ static void lvgl_port_task_deinit(void)
 #endif
 }
 
+#if !LV_TICK_CUSTOM
 static void lvgl_port_tick_increment(void *arg)
 {
     /* Tell LVGL how many milliseconds have elapsed */
     lv_tick_inc(lvgl_port_ctx.timer_period_ms);
 }
+#endif
 
 static esp_err_t lvgl_port_tick_init(void)
 {
+#if LV_TICK_CUSTOM
+    /* LVGL reads the tick by LV_TICK_CUSTOM_SYS_TIME_EXPR (e.g. esp_timer_get_time() / 1000), no periodic timer */
+    return ESP_OK;
+#else
     // Tick interface for LVGL (using esp_timer to generate 2ms periodic event)
     const esp_timer_create_args_t lvgl_tick_timer_args = {
         .callback = &lvgl_port_tick_increment,
@@ -243,4 +448,5 @@ static esp_err_t lvgl_port_tick_init(void)
     };
     ESP_RETURN_ON_ERROR(esp_timer_create(&lvgl_tick_timer_args, &lvgl_port_ctx.tick_timer), TAG, "Creating LVGL timer filed!");
     return esp_timer_start_periodic(lvgl_port_ctx.tick_timer, lvgl_port_ctx.timer_period_ms * 1000);
+#endif
 }
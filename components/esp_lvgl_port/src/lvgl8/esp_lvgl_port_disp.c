@@ -9,6 +9,7 @@
 #include "esp_err.h"
 #include "esp_check.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
 #include "esp_idf_version.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_ops.h"
@@ -45,15 +46,32 @@ typedef struct {
     esp_lcd_panel_handle_t    control_handle; /* LCD panel control handle */
     lvgl_port_rotation_cfg_t  rotation;     /* Default values of the screen rotation */
     lv_disp_drv_t             disp_drv;     /* LVGL display driver */
-    lv_color_t                *trans_buf;   /* Buffer send to driver */
+    lv_color_t                *trans_buf[2]; /* Buffers (ping-pong) send to driver */
     uint32_t                  trans_size;   /* Maximum size for one transport */
-    SemaphoreHandle_t         trans_sem;    /* Idle transfer mutex */
+    uint8_t                   trans_idx;    /* Index of the transport buffer which will be filled next */
+    SemaphoreHandle_t         trans_sem;    /* Counting semaphore of free transport buffers */
+    lvgl_port_disp_perf_t     perf;         /* Performance counters of the last frame */
+    lvgl_port_disp_perf_t     perf_cur;     /* Performance counters of the frame in progress */
+    int64_t                   perf_flush_start; /* Time of the last flush start [us] */
+    bool                      triple_buffer; /* Use three RGB frame buffers */
+    void                      *rgb_fbs[3];  /* RGB frame buffers (triple buffer mode) */
+    uint8_t                   rgb_fb_displayed; /* Index of the frame buffer which is displayed */
+    volatile int8_t           rgb_fb_pending; /* Index of the frame buffer which will be displayed after VSYNC (-1: none) */
+    volatile bool             rgb_fb_queued;  /* Pending frame buffer was given to the RGB driver, the next VSYNC displays it */
+    portMUX_TYPE              rgb_fb_lock;    /* Lock of the pending frame buffer between flush and VSYNC ISR */
+    lv_area_t                 sync_areas[LV_INV_BUF_SIZE]; /* Areas redrawn in this frame, which must be copied into the other RGB frame buffer (direct mode) */
+    uint8_t                   sync_cnt;     /* Number of areas in sync_areas */
+    bool                      sync_full;    /* Too many areas, copy the whole frame buffer */
+    lvgl_port_te_handle_t     te;           /* TE synchronization of the first flush in frame (te_sync) */
+    uint32_t                  round_size;   /* Diameter of the round display (round_mask, 0: not used) */
+    volatile uint32_t         round_pending; /* Bands of the flushed area still being sent */
+    bool                      swap_bytes;   /* Swap bytes of RGB565 pixels in flush (LVGL renders in native order) */
 } lvgl_port_display_ctx_t;
 
 /*******************************************************************************
 * Function definitions
 *******************************************************************************/
-static lv_disp_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp_cfg, const lvgl_port_disp_priv_cfg_t *priv_cfg);
+static lv_disp_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp_cfg, lvgl_port_disp_type_t disp_type, const lvgl_port_disp_priv_cfg_t *priv_cfg);
 static lvgl_port_display_ctx_t *lvgl_port_get_display_ctx(lv_disp_t *disp);
 #if LVGL_PORT_HANDLE_FLUSH_READY
 static bool lvgl_port_flush_io_ready_callback(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx);
@@ -66,6 +84,15 @@ static bool lvgl_port_flush_panel_ready_callback(esp_lcd_panel_handle_t panel_io
 #endif
 static void lvgl_port_flush_callback(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map);
 static void lvgl_port_update_callback(lv_disp_drv_t *drv);
+static void lvgl_port_flush_area(lvgl_port_display_ctx_t *disp_ctx, lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map);
+static void lvgl_port_disp_flush_ready(lv_disp_drv_t *drv);
+static void lvgl_port_flush_round(lvgl_port_display_ctx_t *disp_ctx, lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map);
+#if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+static void lvgl_port_flush_rgb_triple(lvgl_port_display_ctx_t *disp_ctx, lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map);
+static void lvgl_port_rgb_sync_add(lvgl_port_display_ctx_t *disp_ctx, const lv_area_t *area);
+static void lvgl_port_rgb_sync(lvgl_port_display_ctx_t *disp_ctx, lv_disp_drv_t *drv, const lv_color_t *color_map);
+#endif
+static void lvgl_port_monitor_callback(lv_disp_drv_t *drv, uint32_t time, uint32_t px);
 static void lvgl_port_pix_monochrome_callback(lv_disp_drv_t *drv, uint8_t *buf, lv_coord_t buf_w, lv_coord_t x, lv_coord_t y, lv_color_t color, lv_opa_t opa);
 
 /*******************************************************************************
@@ -74,12 +101,10 @@ static void lvgl_port_pix_monochrome_callback(lv_disp_drv_t *drv, uint8_t *buf,
 
 lv_disp_t *lvgl_port_add_disp(const lvgl_port_display_cfg_t *disp_cfg)
 {
-    lv_disp_t *disp = lvgl_port_add_disp_priv(disp_cfg, NULL);
+    lv_disp_t *disp = lvgl_port_add_disp_priv(disp_cfg, LVGL_PORT_DISP_TYPE_OTHER, NULL);
 
     if (disp != NULL) {
         lvgl_port_display_ctx_t *disp_ctx = lvgl_port_get_display_ctx(disp);
-        /* Set display type */
-        disp_ctx->disp_type = LVGL_PORT_DISP_TYPE_OTHER;
 
         assert(disp_ctx->io_handle != NULL);
 
@@ -97,12 +122,10 @@ lv_disp_t *lvgl_port_add_disp(const lvgl_port_display_cfg_t *disp_cfg)
 
 lv_display_t *lvgl_port_add_disp_dsi(const lvgl_port_display_cfg_t *disp_cfg, const lvgl_port_display_dsi_cfg_t *dsi_cfg)
 {
-    lv_disp_t *disp = lvgl_port_add_disp_priv(disp_cfg, NULL);
+    lv_disp_t *disp = lvgl_port_add_disp_priv(disp_cfg, LVGL_PORT_DISP_TYPE_DSI, NULL);
 
     if (disp != NULL) {
         lvgl_port_display_ctx_t *disp_ctx = lvgl_port_get_display_ctx(disp);
-        /* Set display type */
-        disp_ctx->disp_type = LVGL_PORT_DISP_TYPE_DSI;
 
 #if (CONFIG_IDF_TARGET_ESP32P4 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0))
         const esp_lcd_dpi_panel_event_callbacks_t cbs = {
@@ -123,13 +146,12 @@ lv_display_t *lvgl_port_add_disp_rgb(const lvgl_port_display_cfg_t *disp_cfg, co
     assert(rgb_cfg != NULL);
     const lvgl_port_disp_priv_cfg_t priv_cfg = {
         .avoid_tearing = rgb_cfg->flags.avoid_tearing,
+        .triple_buffer = rgb_cfg->flags.triple_buffer,
     };
-    lv_disp_t *disp = lvgl_port_add_disp_priv(disp_cfg, &priv_cfg);
+    lv_disp_t *disp = lvgl_port_add_disp_priv(disp_cfg, LVGL_PORT_DISP_TYPE_RGB, &priv_cfg);
 
     if (disp != NULL) {
         lvgl_port_display_ctx_t *disp_ctx = lvgl_port_get_display_ctx(disp);
-        /* Set display type */
-        disp_ctx->disp_type = LVGL_PORT_DISP_TYPE_RGB;
 
 #if (CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0))
         /* Register done callback */
@@ -165,6 +187,21 @@ esp_err_t lvgl_port_remove_disp(lv_disp_t *disp)
 
     lv_disp_remove(disp);
 
+    lvgl_port_te_deinit(disp_ctx->te);
+
+    if (disp_ctx->trans_sem) {
+        /* Wait for all transport buffers to be released by the LCD driver */
+        for (int i = 0; i < 2; i++) {
+            xSemaphoreTake(disp_ctx->trans_sem, pdMS_TO_TICKS(1000));
+        }
+        vSemaphoreDelete(disp_ctx->trans_sem);
+    }
+    for (int i = 0; i < 2; i++) {
+        if (disp_ctx->trans_buf[i]) {
+            free(disp_ctx->trans_buf[i]);
+        }
+    }
+
     if (disp_drv) {
         if (disp_drv->draw_buf && disp_drv->draw_buf->buf1) {
             free(disp_drv->draw_buf->buf1);
@@ -189,7 +226,19 @@ void lvgl_port_flush_ready(lv_disp_t *disp)
 {
     assert(disp);
     assert(disp->driver);
-    lv_disp_flush_ready(disp->driver);
+    lvgl_port_disp_flush_ready(disp->driver);
+}
+
+esp_err_t lvgl_port_disp_get_perf(lv_display_t *disp, lvgl_port_disp_perf_t *perf)
+{
+    ESP_RETURN_ON_FALSE(disp && perf, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    lvgl_port_display_ctx_t *disp_ctx = lvgl_port_get_display_ctx(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_STATE, TAG, "Display is not added to LVGL port");
+
+    memcpy(perf, &disp_ctx->perf, sizeof(lvgl_port_disp_perf_t));
+    perf->te_period = (disp_ctx->te ? lvgl_port_te_get_period(disp_ctx->te) : 0);
+
+    return ESP_OK;
 }
 
 /*******************************************************************************
@@ -205,25 +254,27 @@ static lvgl_port_display_ctx_t *lvgl_port_get_display_ctx(lv_disp_t *disp)
     return disp_ctx;
 }
 
-static lv_disp_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp_cfg, const lvgl_port_disp_priv_cfg_t *priv_cfg)
+static lv_disp_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp_cfg, lvgl_port_disp_type_t disp_type, const lvgl_port_disp_priv_cfg_t *priv_cfg)
 {
     esp_err_t ret = ESP_OK;
     lv_disp_t *disp = NULL;
     lv_color_t *buf1 = NULL;
     lv_color_t *buf2 = NULL;
     lv_color_t *buf3 = NULL;
+    lv_color_t *buf4 = NULL;
     uint32_t buffer_size = 0;
     SemaphoreHandle_t trans_sem = NULL;
     assert(disp_cfg != NULL);
     assert(disp_cfg->panel_handle != NULL);
-    assert(disp_cfg->buffer_size > 0);
+    assert(disp_cfg->buffer_size > 0 || disp_cfg->flags.buff_auto);
     assert(disp_cfg->hres > 0);
     assert(disp_cfg->vres > 0);
 
-    /* Display context */
-    lvgl_port_display_ctx_t *disp_ctx = malloc(sizeof(lvgl_port_display_ctx_t));
+    /* Display context (internal RAM, it is read from RGB panel ISR) */
+    lvgl_port_display_ctx_t *disp_ctx = heap_caps_malloc(sizeof(lvgl_port_display_ctx_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
     ESP_GOTO_ON_FALSE(disp_ctx, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for display context allocation!");
     memset(disp_ctx, 0, sizeof(lvgl_port_display_ctx_t));
+    disp_ctx->disp_type = disp_type;
     disp_ctx->io_handle = disp_cfg->io_handle;
     disp_ctx->panel_handle = disp_cfg->panel_handle;
     disp_ctx->control_handle = disp_cfg->control_handle;
@@ -232,13 +283,33 @@ static lv_disp_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp_cf
     disp_ctx->rotation.mirror_y = disp_cfg->rotation.mirror_y;
     disp_ctx->trans_size = disp_cfg->trans_size;
 
+    if (disp_cfg->flags.swap_bytes) {
+        /* LV_COLOR_16_SWAP would swap the bytes twice, RGB panels take pixels in native order */
+        ESP_GOTO_ON_FALSE(LV_COLOR_DEPTH == 16 && !LV_COLOR_16_SWAP && !disp_cfg->monochrome && priv_cfg == NULL, ESP_ERR_INVALID_ARG, err, TAG,
+                          "Swap bytes needs RGB565 without LV_COLOR_16_SWAP and SPI/I80 display!");
+        /* Pixels are swapped in place without transport buffer, direct mode keeps the draw buffer for the next frames */
+        ESP_GOTO_ON_FALSE(!disp_cfg->flags.direct_mode || disp_cfg->trans_size > 0, ESP_ERR_INVALID_ARG, err, TAG, "Swap bytes in direct mode needs transport buffer!");
+        disp_ctx->swap_bytes = true;
+    }
+
     buffer_size = disp_cfg->buffer_size;
 
     /* Use RGB internal buffers for avoid tearing effect */
     if (priv_cfg && priv_cfg->avoid_tearing) {
 #if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
         buffer_size = disp_cfg->hres * disp_cfg->vres;
-        ESP_GOTO_ON_ERROR(esp_lcd_rgb_panel_get_frame_buffer(disp_cfg->panel_handle, 2, (void *)&buf1, (void *)&buf2), err, TAG, "Get RGB buffers failed");
+        if (priv_cfg->triple_buffer) {
+            ESP_GOTO_ON_FALSE(disp_cfg->flags.full_refresh, ESP_ERR_INVALID_ARG, err, TAG, "Triple buffer can be used only with full refresh!");
+            ESP_GOTO_ON_ERROR(esp_lcd_rgb_panel_get_frame_buffer(disp_cfg->panel_handle, 3, &disp_ctx->rgb_fbs[0], &disp_ctx->rgb_fbs[1], &disp_ctx->rgb_fbs[2]), err, TAG, "Get RGB buffers failed");
+            /* The first frame buffer is displayed after init, LVGL renders into the second one. The draw buffer is switched in the flush callback. */
+            disp_ctx->triple_buffer = true;
+            disp_ctx->rgb_fb_displayed = 0;
+            disp_ctx->rgb_fb_pending = -1;
+            portMUX_INITIALIZE(&disp_ctx->rgb_fb_lock);
+            buf1 = disp_ctx->rgb_fbs[1];
+        } else {
+            ESP_GOTO_ON_ERROR(esp_lcd_rgb_panel_get_frame_buffer(disp_cfg->panel_handle, 2, (void *)&buf1, (void *)&buf2), err, TAG, "Get RGB buffers failed");
+        }
 #endif
     } else {
         uint32_t buff_caps = MALLOC_CAP_DEFAULT;
@@ -251,25 +322,72 @@ static lv_disp_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp_cf
         }
 
         if (disp_cfg->trans_size) {
-            buf3 = heap_caps_malloc(disp_cfg->trans_size * sizeof(lv_color_t), MALLOC_CAP_DMA);
+            /* RGB panels copy data into their frame buffers, transport buffers are supported only for IO with DMA done callback */
+            ESP_GOTO_ON_FALSE(priv_cfg == NULL, ESP_ERR_NOT_SUPPORTED, err, TAG, "Transport buffer is not supported with RGB display!");
+            /* Monochrome buffer is packed in pages of 1 bpp, it cannot be split into lines of pixels */
+            ESP_GOTO_ON_FALSE(!disp_cfg->monochrome, ESP_ERR_INVALID_ARG, err, TAG, "Transport buffer is not supported with monochrome display!");
+            /* Transport buffer must hold at least one line in any rotation */
+            ESP_GOTO_ON_FALSE(disp_cfg->trans_size >= LV_MAX(disp_cfg->hres, disp_cfg->vres), ESP_ERR_INVALID_ARG, err, TAG, "Transport buffer must be at least one line long!");
+
+            /* Two transport buffers: one is filled while the other one is sent by DMA */
+            buf3 = heap_caps_malloc(disp_cfg->trans_size * sizeof(lv_color_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
             ESP_GOTO_ON_FALSE(buf3, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for buffer(transport) allocation!");
-            disp_ctx->trans_buf = buf3;
+            buf4 = heap_caps_malloc(disp_cfg->trans_size * sizeof(lv_color_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+            ESP_GOTO_ON_FALSE(buf4, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for buffer(transport) allocation!");
+            disp_ctx->trans_buf[0] = buf3;
+            disp_ctx->trans_buf[1] = buf4;
 
-            trans_sem = xSemaphoreCreateCounting(1, 0);
+            trans_sem = xSemaphoreCreateCounting(2, 2);
             ESP_GOTO_ON_FALSE(trans_sem, ESP_ERR_NO_MEM, err, TAG, "Failed to create transport counting Semaphore");
             disp_ctx->trans_sem = trans_sem;
         }
 
-        /* alloc draw buffers used by LVGL */
-        /* it's recommended to choose the size of the draw buffer(s) to be at least 1/10 screen sized */
-        buf1 = heap_caps_malloc(buffer_size * sizeof(lv_color_t), buff_caps);
-        ESP_GOTO_ON_FALSE(buf1, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (buf1) allocation!");
-        if (disp_cfg->double_buffer) {
-            buf2 = heap_caps_malloc(buffer_size * sizeof(lv_color_t), buff_caps);
-            ESP_GOTO_ON_FALSE(buf2, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (buf2) allocation!");
+        if (disp_cfg->flags.buff_auto) {
+            const lvgl_port_buff_auto_cfg_t auto_cfg = {
+                .hres = disp_cfg->hres,
+                .vres = disp_cfg->vres,
+                .px_size = sizeof(lv_color_t),
+                .full = (disp_cfg->flags.full_refresh || disp_cfg->flags.direct_mode || disp_cfg->monochrome),
+                .dma = (disp_cfg->trans_size == 0),
+                /* SPI and I80 are faster from internal RAM, RGB and MIPI-DSI panels copy the data into their frame buffers */
+                .internal_first = (disp_type == LVGL_PORT_DISP_TYPE_OTHER),
+#if SOC_PSRAM_DMA_CAPABLE
+                .psram_allowed = true,
+#else
+                .psram_allowed = (disp_type != LVGL_PORT_DISP_TYPE_OTHER || disp_cfg->trans_size > 0),
+#endif
+            };
+            lvgl_port_buff_auto_t auto_buff;
+            ESP_GOTO_ON_ERROR(lvgl_port_buffers_auto(&auto_cfg, &auto_buff), err, TAG, "Not enough memory for LVGL buffer allocation!");
+            buf1 = auto_buff.buf1;
+            buf2 = auto_buff.buf2;
+            buffer_size = auto_buff.buffer_size;
+        } else {
+            /* alloc draw buffers used by LVGL */
+            /* it's recommended to choose the size of the draw buffer(s) to be at least 1/10 screen sized */
+            buf1 = lvgl_port_buffer_malloc(buffer_size * sizeof(lv_color_t), buff_caps);
+            ESP_GOTO_ON_FALSE(buf1, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (buf1) allocation!");
+            if (disp_cfg->double_buffer) {
+                buf2 = lvgl_port_buffer_malloc(buffer_size * sizeof(lv_color_t), buff_caps);
+                ESP_GOTO_ON_FALSE(buf2, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (buf2) allocation!");
+            }
         }
     }
 
+    if (disp_cfg->flags.te_sync) {
+        /* RGB panels are synchronized by VSYNC */
+        ESP_GOTO_ON_FALSE(priv_cfg == NULL, ESP_ERR_NOT_SUPPORTED, err, TAG, "TE synchronization is not supported with RGB display!");
+        ESP_GOTO_ON_ERROR(lvgl_port_te_init(disp_cfg->te_gpio_num, &disp_ctx->te), err, TAG, "TE synchronization init failed!");
+    }
+
+    if (disp_cfg->flags.round_mask) {
+        /* Rows are compacted in the draw buffer, its content must not be kept between frames */
+        ESP_GOTO_ON_FALSE(priv_cfg == NULL && disp_cfg->trans_size == 0 && !disp_cfg->flags.direct_mode && !disp_cfg->monochrome, ESP_ERR_NOT_SUPPORTED, err, TAG,
+                          "Round mask is supported only with SPI/I80 display without transport buffer, direct mode and monochrome!");
+        ESP_GOTO_ON_FALSE(disp_cfg->hres == disp_cfg->vres, ESP_ERR_INVALID_ARG, err, TAG, "Round mask needs square resolution!");
+        disp_ctx->round_size = disp_cfg->hres;
+    }
+
     lv_disp_draw_buf_t *disp_buf = malloc(sizeof(lv_disp_draw_buf_t));
     ESP_GOTO_ON_FALSE(disp_buf, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL display buffer allocation!");
 
@@ -283,6 +401,7 @@ static lv_disp_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp_cf
     disp_ctx->disp_drv.flush_cb = lvgl_port_flush_callback;
     disp_ctx->disp_drv.draw_buf = disp_buf;
     disp_ctx->disp_drv.user_data = disp_ctx;
+    disp_ctx->disp_drv.monitor_cb = lvgl_port_monitor_callback;
 
     disp_ctx->disp_drv.sw_rotate = disp_cfg->flags.sw_rotate;
     if (disp_ctx->disp_drv.sw_rotate == false) {
@@ -315,19 +434,24 @@ static lv_disp_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp_cf
 
 err:
     if (ret != ESP_OK) {
-        if (buf1) {
+        /* RGB frame buffers are owned by the LCD driver */
+        if (buf1 && !(priv_cfg && priv_cfg->avoid_tearing)) {
             free(buf1);
         }
-        if (buf2) {
+        if (buf2 && !(priv_cfg && priv_cfg->avoid_tearing)) {
             free(buf2);
         }
         if (buf3) {
             free(buf3);
         }
+        if (buf4) {
+            free(buf4);
+        }
         if (trans_sem) {
             vSemaphoreDelete(trans_sem);
         }
         if (disp_ctx) {
+            lvgl_port_te_deinit(disp_ctx->te);
             free(disp_ctx);
         }
     }
@@ -344,13 +468,19 @@ static bool lvgl_port_flush_io_ready_callback(esp_lcd_panel_io_handle_t panel_io
     assert(disp_drv != NULL);
     lvgl_port_display_ctx_t *disp_ctx = disp_drv->user_data;
     assert(disp_ctx != NULL);
-    lv_disp_flush_ready(disp_drv);
 
     if (disp_ctx->trans_size && disp_ctx->trans_sem) {
+        /* Transport buffer is free again, LVGL was already notified in flush callback */
         xSemaphoreGiveFromISR(disp_ctx->trans_sem, &taskAwake);
+    } else if (disp_ctx->round_pending > 1) {
+        /* More bands of the round display area are being sent */
+        disp_ctx->round_pending--;
+    } else {
+        disp_ctx->round_pending = 0;
+        lvgl_port_disp_flush_ready(disp_drv);
     }
 
-    return false;
+    return (taskAwake == pdTRUE);
 }
 
 #if (CONFIG_IDF_TARGET_ESP32P4 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0))
@@ -362,23 +492,36 @@ static bool lvgl_port_flush_panel_ready_callback(esp_lcd_panel_handle_t panel_io
     assert(disp_drv != NULL);
     lvgl_port_display_ctx_t *disp_ctx = disp_drv->user_data;
     assert(disp_ctx != NULL);
-    lv_disp_flush_ready(disp_drv);
 
     if (disp_ctx->trans_size && disp_ctx->trans_sem) {
+        /* Transport buffer is free again, LVGL was already notified in flush callback */
         xSemaphoreGiveFromISR(disp_ctx->trans_sem, &taskAwake);
+    } else {
+        lvgl_port_disp_flush_ready(disp_drv);
     }
 
-    return false;
+    return (taskAwake == pdTRUE);
 }
 #endif
 
 #if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
-static bool lvgl_port_flush_vsync_ready_callback(esp_lcd_panel_handle_t panel_io, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
+static LVGL_PORT_RGB_ISR_ATTR bool lvgl_port_flush_vsync_ready_callback(esp_lcd_panel_handle_t panel_io, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
 {
     BaseType_t need_yield = pdFALSE;
 
     lv_disp_drv_t *disp_drv = (lv_disp_drv_t *)user_ctx;
     assert(disp_drv != NULL);
+    lvgl_port_display_ctx_t *disp_ctx = disp_drv->user_data;
+    if (disp_ctx && disp_ctx->triple_buffer) {
+        portENTER_CRITICAL_ISR(&disp_ctx->rgb_fb_lock);
+        if (disp_ctx->rgb_fb_pending >= 0 && disp_ctx->rgb_fb_queued) {
+            /* The pending frame buffer is displayed from now */
+            disp_ctx->rgb_fb_displayed = disp_ctx->rgb_fb_pending;
+            disp_ctx->rgb_fb_pending = -1;
+            disp_ctx->rgb_fb_queued = false;
+        }
+        portEXIT_CRITICAL_ISR(&disp_ctx->rgb_fb_lock);
+    }
     need_yield = lvgl_port_task_notify(ULONG_MAX);
 
     return (need_yield == pdTRUE);
@@ -392,18 +535,23 @@ static void lvgl_port_flush_callback(lv_disp_drv_t *drv, const lv_area_t *area,
     lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)drv->user_data;
     assert(disp_ctx != NULL);
 
-    int x_draw_start;
-    int x_draw_end;
-    int y_draw_start;
-    int y_draw_end;
+    /* Writing of a new frame starts in V-blanking, the panel does not show two frames at once */
+    if (disp_ctx->te && disp_ctx->perf_cur.flush_cnt == 0) {
+        lvgl_port_te_wait(disp_ctx->te);
+    }
+
+    const int64_t flush_start = esp_timer_get_time();
+    disp_ctx->perf_flush_start = flush_start;
+    disp_ctx->perf_cur.flush_cnt++;
+    disp_ctx->perf_cur.flush_px += lv_area_get_size(area);
 
-    int y_start_tmp;
-    int y_end_tmp;
+    lvgl_port_flush_area(disp_ctx, drv, area, color_map);
 
-    int trans_count;
-    int trans_line;
-    int max_line;
+    disp_ctx->perf_cur.flush_time += (uint32_t)(esp_timer_get_time() - flush_start);
+}
 
+static void lvgl_port_flush_area(lvgl_port_display_ctx_t *disp_ctx, lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+{
     const int x_start = area->x1;
     const int x_end = area->x2;
     const int y_start = area->y1;
@@ -411,53 +559,205 @@ static void lvgl_port_flush_callback(lv_disp_drv_t *drv, const lv_area_t *area,
     const int width = x_end - x_start + 1;
     const int height = y_end - y_start + 1;
 
-    lv_color_t *from = color_map;
-    lv_color_t *to = NULL;
+#if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    if (disp_ctx->disp_type == LVGL_PORT_DISP_TYPE_RGB && disp_ctx->triple_buffer) {
+        lvgl_port_flush_rgb_triple(disp_ctx, drv, area, color_map);
+        return;
+    }
+#endif
 
     if (disp_ctx->trans_size == 0) {
         if (disp_ctx->disp_type == LVGL_PORT_DISP_TYPE_RGB && (drv->direct_mode || drv->full_refresh)) {
+#if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+            if (drv->direct_mode && drv->draw_buf->buf2) {
+                lvgl_port_rgb_sync_add(disp_ctx, area);
+            }
+#endif
             if (lv_disp_flush_is_last(drv)) {
                 /* If the interface is I80 or SPI, this step cannot be used for drawing. */
                 esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, x_start, y_start, x_end + 1, y_end + 1, color_map);
                 /* Waiting for the last frame buffer to complete transmission */
                 ulTaskNotifyValueClear(NULL, ULONG_MAX);
                 ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+                if (drv->direct_mode && drv->draw_buf->buf2) {
+                    lvgl_port_rgb_sync(disp_ctx, drv, color_map);
+                }
+#endif
             }
         } else {
-            esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, x_start, y_start, x_end + 1, y_end + 1, color_map);
+            if (disp_ctx->swap_bytes) {
+                /* LVGL renders the next area into the other buffer, this one is sent as it is */
+                lvgl_port_transform_rgb565_swap((uint16_t *)color_map, (size_t)width * height);
+            }
+            if (disp_ctx->round_size && disp_ctx->disp_type == LVGL_PORT_DISP_TYPE_OTHER) {
+                lvgl_port_flush_round(disp_ctx, drv, area, color_map);
+            } else {
+                esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, x_start, y_start, x_end + 1, y_end + 1, color_map);
+            }
         }
 
         if (disp_ctx->disp_type == LVGL_PORT_DISP_TYPE_RGB) {
-            lv_disp_flush_ready(drv);
+            lvgl_port_disp_flush_ready(drv);
         }
     } else {
-        y_start_tmp = y_start;
-        max_line = ((disp_ctx->trans_size / width) > height) ? (height) : (disp_ctx->trans_size / width);
-        trans_count = height / max_line + (height % max_line ? (1) : (0));
-
-        for (int i = 0; i < trans_count; i++) {
-            trans_line = (y_end - y_start_tmp + 1) > max_line ? max_line : (y_end - y_start_tmp + 1);
-            y_end_tmp = (y_end - y_start_tmp + 1) > max_line ? (y_start_tmp + max_line - 1) : y_end;
-
-            to = disp_ctx->trans_buf;
-            for (int y = 0; y < trans_line; y++) {
-                for (int x = 0; x < width; x++) {
-                    *(to + y * (width) + x) = *(from + y * (width) + x);
-                }
-            }
-            x_draw_start = x_start;
-            x_draw_end = x_end;
-            y_draw_start = y_start_tmp;
-            y_draw_end = y_end_tmp;
-            esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, x_draw_start, y_draw_start, x_draw_end + 1, y_draw_end + 1, to);
-
-            from += max_line * width;
-            y_start_tmp += max_line;
+        int max_line = disp_ctx->trans_size / width;
+        assert(max_line > 0);
+        if (max_line > height) {
+            max_line = height;
+        }
+
+        /* The transport buffers are used as ping-pong: the next chunk is copied while the previous one is sent by DMA */
+        const lv_color_t *from = color_map;
+        for (int y = y_start; y <= y_end; y += max_line) {
+            const int trans_line = ((y_end - y + 1) > max_line ? max_line : (y_end - y + 1));
+            const size_t len = (size_t)trans_line * width;
+
+            /* Wait for a free transport buffer (released from the LCD IO done callback) */
             xSemaphoreTake(disp_ctx->trans_sem, portMAX_DELAY);
+            lv_color_t *to = disp_ctx->trans_buf[disp_ctx->trans_idx];
+            disp_ctx->trans_idx ^= 1;
+
+            /* Bytes are swapped in the copy, which is done anyway */
+            if (disp_ctx->swap_bytes) {
+                lvgl_port_transform_rgb565_swap_copy((uint16_t *)to, (const uint16_t *)from, len);
+            } else {
+                memcpy(to, from, len * sizeof(lv_color_t));
+            }
+            esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, x_start, y, x_end + 1, y + trans_line, to);
+
+            from += len;
         }
+
+        /* All data were copied out of the LVGL buffer, LVGL can render next area while the last chunks are being sent */
+        lvgl_port_disp_flush_ready(drv);
     }
 }
 
+/* Send only the bands of the area visible on the round display.
+ * Rows of each band are compacted in place, the band data never overlap the rows of the next bands. */
+static void lvgl_port_flush_round(lvgl_port_display_ctx_t *disp_ctx, lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+{
+    lvgl_port_round_band_t bands[LVGL_PORT_ROUND_BANDS_MAX];
+    const uint32_t cnt = lvgl_port_round_split(disp_ctx->round_size, area->x1, area->y1, area->x2, area->y2, bands);
+    const int width = lv_area_get_width(area);
+
+    if (cnt == 0) {
+        /* Whole area is in the corners */
+        lvgl_port_disp_flush_ready(drv);
+        return;
+    }
+
+    /* Flush ready is called from the IO done callback of the last band */
+    disp_ctx->round_pending = cnt;
+    for (uint32_t i = 0; i < cnt; i++) {
+        const lvgl_port_round_band_t *band = &bands[i];
+        const int band_width = band->x2 - band->x1 + 1;
+        lv_color_t *to = color_map + (size_t)(band->y1 - area->y1) * width;
+
+        if (band->x1 != area->x1 || band->x2 != area->x2) {
+            for (int y = band->y1; y <= band->y2; y++) {
+                const lv_color_t *from = color_map + (size_t)(y - area->y1) * width + (band->x1 - area->x1);
+                memmove(to + (size_t)(y - band->y1) * band_width, from, band_width * sizeof(lv_color_t));
+            }
+        }
+        esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, band->x1, band->y1, band->x2 + 1, band->y2 + 1, to);
+    }
+}
+
+#if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+/* Triple buffering: one frame buffer is displayed, one is waiting for VSYNC and LVGL renders into the third one. */
+static void lvgl_port_flush_rgb_triple(lvgl_port_display_ctx_t *disp_ctx, lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+{
+    int8_t rendered = -1;
+    for (int i = 0; i < 3; i++) {
+        if (disp_ctx->rgb_fbs[i] == color_map) {
+            rendered = i;
+        }
+    }
+    assert(rendered >= 0);
+
+    /* Previous frame is still waiting for VSYNC, its buffer cannot be given to LVGL yet */
+    while (disp_ctx->rgb_fb_pending >= 0) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+    }
+
+    /* Buffer is pending before it is given to the RGB driver, the VSYNC ISR takes it as displayed only after draw_bitmap returned
+     * (the driver switches the frame buffer in the first VSYNC after draw_bitmap, not before) */
+    portENTER_CRITICAL(&disp_ctx->rgb_fb_lock);
+    const uint8_t displayed = disp_ctx->rgb_fb_displayed;
+    disp_ctx->rgb_fb_pending = rendered;
+    disp_ctx->rgb_fb_queued = false;
+    portEXIT_CRITICAL(&disp_ctx->rgb_fb_lock);
+
+    /* Frame buffer will be switched by the RGB driver in the next VSYNC */
+    const esp_err_t err = esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, color_map);
+
+    portENTER_CRITICAL(&disp_ctx->rgb_fb_lock);
+    if (err == ESP_OK) {
+        disp_ctx->rgb_fb_queued = true;
+    } else {
+        /* Frame buffer is not switched, the displayed one stays */
+        disp_ctx->rgb_fb_pending = -1;
+    }
+    portEXIT_CRITICAL(&disp_ctx->rgb_fb_lock);
+
+    /* LVGL renders next frame into the buffer, which is neither displayed nor pending */
+    for (int i = 0; i < 3; i++) {
+        if (i != rendered && i != displayed) {
+            drv->draw_buf->buf1 = disp_ctx->rgb_fbs[i];
+            drv->draw_buf->buf_act = disp_ctx->rgb_fbs[i];
+            break;
+        }
+    }
+
+    lvgl_port_disp_flush_ready(drv);
+}
+
+static void lvgl_port_rgb_sync_add(lvgl_port_display_ctx_t *disp_ctx, const lv_area_t *area)
+{
+    if (disp_ctx->sync_full) {
+        return;
+    }
+
+    /* Skip areas, which are already covered */
+    for (int i = 0; i < disp_ctx->sync_cnt; i++) {
+        if (_lv_area_is_in(area, &disp_ctx->sync_areas[i], 0)) {
+            return;
+        }
+    }
+
+    if (disp_ctx->sync_cnt < LV_INV_BUF_SIZE) {
+        disp_ctx->sync_areas[disp_ctx->sync_cnt++] = *area;
+    } else {
+        disp_ctx->sync_full = true;
+    }
+}
+
+/* Direct mode with two frame buffers: copy areas redrawn in this frame into the other frame buffer, which LVGL will draw into in the next frame. */
+static void lvgl_port_rgb_sync(lvgl_port_display_ctx_t *disp_ctx, lv_disp_drv_t *drv, const lv_color_t *color_map)
+{
+    lv_color_t *dst = (color_map == drv->draw_buf->buf1 ? drv->draw_buf->buf2 : drv->draw_buf->buf1);
+    const int32_t hres = drv->hor_res;
+
+    if (disp_ctx->sync_full) {
+        memcpy(dst, color_map, (size_t)hres * drv->ver_res * sizeof(lv_color_t));
+    } else {
+        for (int i = 0; i < disp_ctx->sync_cnt; i++) {
+            const lv_area_t *area = &disp_ctx->sync_areas[i];
+            const size_t line_size = lv_area_get_width(area) * sizeof(lv_color_t);
+            for (int32_t y = area->y1; y <= area->y2; y++) {
+                const size_t offset = (size_t)y * hres + area->x1;
+                memcpy(dst + offset, color_map + offset, line_size);
+            }
+        }
+    }
+
+    disp_ctx->sync_cnt = 0;
+    disp_ctx->sync_full = false;
+}
+#endif
+
 static void lvgl_port_update_callback(lv_disp_drv_t *drv)
 {
     assert(drv);
@@ -515,3 +815,25 @@ static void lvgl_port_pix_monochrome_callback(lv_disp_drv_t *drv, uint8_t *buf,
         (*buf) |= (1 << (y % 8));
     }
 }
+
+static void lvgl_port_disp_flush_ready(lv_disp_drv_t *drv)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)drv->user_data;
+    if (disp_ctx) {
+        disp_ctx->perf_cur.trans_time += (uint32_t)(esp_timer_get_time() - disp_ctx->perf_flush_start);
+    }
+    lv_disp_flush_ready(drv);
+}
+
+static void lvgl_port_monitor_callback(lv_disp_drv_t *drv, uint32_t time, uint32_t px)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)drv->user_data;
+    assert(disp_ctx != NULL);
+
+    /* LVGL8 reports the refresh time in [ms] */
+    disp_ctx->perf_cur.frame_cnt = disp_ctx->perf.frame_cnt + 1;
+    disp_ctx->perf_cur.frame_time = LV_MAX(time * 1000, disp_ctx->perf_cur.flush_time);
+    disp_ctx->perf_cur.render_time = disp_ctx->perf_cur.frame_time - disp_ctx->perf_cur.flush_time;
+    memcpy(&disp_ctx->perf, &disp_ctx->perf_cur, sizeof(lvgl_port_disp_perf_t));
+    memset(&disp_ctx->perf_cur, 0, sizeof(lvgl_port_disp_perf_t));
+}
@@ -7,11 +7,19 @@
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_check.h"
+#include "esp_timer.h"
 #include "esp_lcd_touch.h"
 #include "esp_lvgl_port.h"
+#include "esp_lvgl_port_gesture.h"
 
 static const char *TAG = "LVGL";
 
+/* Period of checking display inactivity for touch sleep */
+#define LVGL_PORT_TOUCH_SLEEP_CHECK_MS      (200)
+
+/* Gesture event code (registered in LVGL, common for all touches) */
+static uint32_t lvgl_port_gesture_event = 0;
+
 /*******************************************************************************
 * Types definitions
 *******************************************************************************/
@@ -19,6 +27,26 @@ static const char *TAG = "LVGL";
 typedef struct {
     esp_lcd_touch_handle_t   handle;     /* LCD touch IO handle */
     lv_indev_drv_t           indev_drv;  /* LVGL input device driver */
+#if (CONFIG_ESP_LCD_TOUCH_SAMPLES > 0)
+    uint32_t                 predict_ms; /* Touch prediction time */
+    esp_lcd_touch_sample_t   samples[CONFIG_ESP_LCD_TOUCH_SAMPLES]; /* Samples not given to LVGL yet */
+    uint8_t                  sample_cnt; /* Count of samples */
+    uint8_t                  sample_idx; /* Index of the next sample given to LVGL */
+    bool                     release;    /* Release after the last sample */
+    esp_lcd_touch_sample_t   last;       /* Last sample given to LVGL (for velocity) */
+    bool                     last_valid; /* Last sample is from the current touch */
+#endif
+    bool                    gestures;   /* Gesture recognition enabled */
+    lvgl_port_gesture_ctx_t gesture;    /* Gesture recognition state */
+    uint32_t                poll_active_ms; /* Read period while touched */
+    uint32_t                poll_idle_ms;   /* Read period while not touched */
+    uint32_t                sleep_timeout_ms; /* Inactivity time for controller sleep */
+    uint32_t                scan_idle_ms;   /* Inactivity time for controller monitor mode */
+    lv_timer_t              *sleep_timer;   /* Timer checking display inactivity */
+    bool                    pressed;    /* Touched in the last reading */
+    bool                    sleeping;   /* Controller is in sleep mode */
+    bool                    scan_active; /* Controller is kept in active scanning */
+    bool                    wake_on_touch; /* Touch interrupt wakes the chip from light sleep */
 } lvgl_port_touch_ctx_t;
 
 /*******************************************************************************
@@ -26,6 +54,13 @@ typedef struct {
 *******************************************************************************/
 
 static void lvgl_port_touchpad_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *data);
+static void lvgl_port_touch_gestures(lvgl_port_touch_ctx_t *touch_ctx, const uint16_t *x, const uint16_t *y, uint8_t cnt);
+static void lvgl_port_touch_set_poll(lvgl_port_touch_ctx_t *touch_ctx, bool active);
+static void lvgl_port_touch_sleep_timer_cb(lv_timer_t *timer);
+static void lvgl_port_touch_set_scan(lvgl_port_touch_ctx_t *touch_ctx, bool active);
+#if (CONFIG_ESP_LCD_TOUCH_SAMPLES > 0)
+static bool lvgl_port_touchpad_read_sample(lvgl_port_touch_ctx_t *touch_ctx, lv_indev_data_t *data);
+#endif
 
 /*******************************************************************************
 * Public API functions
@@ -44,6 +79,41 @@ lv_indev_t *lvgl_port_add_touch(const lvgl_port_touch_cfg_t *touch_cfg)
         return NULL;
     }
     touch_ctx->handle = touch_cfg->handle;
+#if (CONFIG_ESP_LCD_TOUCH_SAMPLES > 0)
+    touch_ctx->predict_ms = touch_cfg->predict_ms;
+    touch_ctx->sample_cnt = 0;
+    touch_ctx->sample_idx = 0;
+    touch_ctx->release = false;
+    touch_ctx->last_valid = false;
+#endif
+    touch_ctx->gestures = touch_cfg->flags.gestures;
+    lvgl_port_gesture_init(&touch_ctx->gesture);
+    touch_ctx->poll_active_ms = touch_cfg->poll_active_ms;
+    touch_ctx->poll_idle_ms = touch_cfg->poll_idle_ms;
+    touch_ctx->sleep_timeout_ms = touch_cfg->sleep_timeout_ms;
+    touch_ctx->scan_idle_ms = touch_cfg->scan_idle_ms;
+    touch_ctx->sleep_timer = NULL;
+    touch_ctx->pressed = false;
+    touch_ctx->sleeping = false;
+    touch_ctx->scan_active = true;
+    touch_ctx->wake_on_touch = touch_cfg->flags.wake_on_touch;
+
+    if (touch_ctx->wake_on_touch) {
+        /* Sleeping controller would not report the touch, it can only scan slowly in its monitor mode */
+        if (touch_ctx->sleep_timeout_ms > 0) {
+            ESP_LOGW(TAG, "Touch sleep timeout is ignored with wake on touch");
+            touch_ctx->sleep_timeout_ms = 0;
+        }
+        if (esp_lcd_touch_set_wakeup(touch_ctx->handle, true) != ESP_OK) {
+            ESP_LOGE(TAG, "Touch wake-up needs interrupt pin and acquisition task");
+            free(touch_ctx);
+            return NULL;
+        }
+    }
+
+    if (touch_ctx->gestures && lvgl_port_gesture_event == 0) {
+        lvgl_port_gesture_event = lv_event_register_id();
+    }
 
     /* Register a touchpad input device */
     lv_indev_drv_init(&touch_ctx->indev_drv);
@@ -51,7 +121,26 @@ lv_indev_t *lvgl_port_add_touch(const lvgl_port_touch_cfg_t *touch_cfg)
     touch_ctx->indev_drv.disp = touch_cfg->disp;
     touch_ctx->indev_drv.read_cb = lvgl_port_touchpad_read;
     touch_ctx->indev_drv.user_data = touch_ctx;
-    return lv_indev_drv_register(&touch_ctx->indev_drv);
+    lv_indev_t *indev = lv_indev_drv_register(&touch_ctx->indev_drv);
+    if (indev == NULL) {
+        if (touch_ctx->wake_on_touch) {
+            esp_lcd_touch_set_wakeup(touch_ctx->handle, false);
+        }
+        free(touch_ctx);
+        return NULL;
+    }
+
+    /* Slow polling until the first touch */
+    lvgl_port_touch_set_poll(touch_ctx, false);
+    /* Monitor mode until the first touch */
+    if (touch_ctx->scan_idle_ms > 0) {
+        lvgl_port_touch_set_scan(touch_ctx, false);
+    }
+    if (touch_ctx->sleep_timeout_ms > 0 || touch_ctx->scan_idle_ms > 0) {
+        touch_ctx->sleep_timer = lv_timer_create(lvgl_port_touch_sleep_timer_cb, LVGL_PORT_TOUCH_SLEEP_CHECK_MS, touch_ctx);
+    }
+
+    return indev;
 }
 
 esp_err_t lvgl_port_remove_touch(lv_indev_t *touch)
@@ -65,12 +154,42 @@ esp_err_t lvgl_port_remove_touch(lv_indev_t *touch)
     lv_indev_delete(touch);
 
     if (touch_ctx) {
+        if (touch_ctx->sleep_timer) {
+            lv_timer_del(touch_ctx->sleep_timer);
+        }
+        if (touch_ctx->sleeping) {
+            esp_lcd_touch_exit_sleep(touch_ctx->handle);
+        }
+        if (touch_ctx->wake_on_touch) {
+            esp_lcd_touch_set_wakeup(touch_ctx->handle, false);
+        }
         free(touch_ctx);
     }
 
     return ESP_OK;
 }
 
+uint32_t lvgl_port_touch_get_gesture_event(void)
+{
+    return lvgl_port_gesture_event;
+}
+
+esp_err_t lvgl_port_touch_get_wake_stats(lv_indev_t *touch, lvgl_port_touch_wake_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(touch && stats && touch->driver, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments!");
+    lvgl_port_touch_ctx_t *touch_ctx = (lvgl_port_touch_ctx_t *)touch->driver->user_data;
+    ESP_RETURN_ON_FALSE(touch_ctx, ESP_ERR_INVALID_ARG, TAG, "Not a touch of LVGL port!");
+
+    /* Latency of the first frame is measured only with LVGL 9 */
+    esp_lcd_touch_wakeup_stats_t wake;
+    esp_lcd_touch_get_wakeup_stats(touch_ctx->handle, &wake);
+    *stats = (lvgl_port_touch_wake_stats_t) {
+        .wake_cnt = wake.wake_cnt,
+        .read_latency_us = wake.read_latency_us,
+    };
+    return ESP_OK;
+}
+
 /*******************************************************************************
 * Private functions
 *******************************************************************************/
@@ -81,15 +200,57 @@ static void lvgl_port_touchpad_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *
     lvgl_port_touch_ctx_t *touch_ctx = (lvgl_port_touch_ctx_t *)indev_drv->user_data;
     assert(touch_ctx->handle);
 
-    uint16_t touchpad_x[1] = {0};
-    uint16_t touchpad_y[1] = {0};
+    /* Two points are needed only for gestures */
+    uint16_t touchpad_x[2] = {0};
+    uint16_t touchpad_y[2] = {0};
     uint8_t touchpad_cnt = 0;
 
+    /* The controller is not read in sleep mode */
+    if (touch_ctx->sleeping) {
+        data->state = LV_INDEV_STATE_RELEASED;
+        return;
+    }
+
+#if (CONFIG_ESP_LCD_TOUCH_SAMPLES > 0)
+    /* Samples from the last reading are given to LVGL one by one */
+    if (lvgl_port_touchpad_read_sample(touch_ctx, data)) {
+        return;
+    }
+#endif
+
     /* Read data from touch controller into memory */
     esp_lcd_touch_read_data(touch_ctx->handle);
 
     /* Read data from touch controller */
-    bool touchpad_pressed = esp_lcd_touch_get_coordinates(touch_ctx->handle, touchpad_x, touchpad_y, NULL, &touchpad_cnt, 1);
+    bool touchpad_pressed = esp_lcd_touch_get_coordinates(touch_ctx->handle, touchpad_x, touchpad_y, NULL, &touchpad_cnt, (touch_ctx->gestures ? 2 : 1));
+
+    if (touch_ctx->gestures) {
+        lvgl_port_touch_gestures(touch_ctx, touchpad_x, touchpad_y, (touchpad_pressed ? touchpad_cnt : 0));
+    }
+
+    /* Fast reading only while touched */
+    const bool pressed = (touchpad_pressed && touchpad_cnt > 0);
+    if (pressed != touch_ctx->pressed) {
+        touch_ctx->pressed = pressed;
+        lvgl_port_touch_set_poll(touch_ctx, pressed);
+        if (pressed && touch_ctx->scan_idle_ms > 0 && !touch_ctx->scan_active) {
+            lvgl_port_touch_set_scan(touch_ctx, true);
+        }
+    }
+
+#if (CONFIG_ESP_LCD_TOUCH_SAMPLES > 0)
+    /* All samples read since the last call (the acquisition task can read more of them) */
+    touch_ctx->sample_cnt = esp_lcd_touch_get_samples(touch_ctx->handle, touch_ctx->samples, CONFIG_ESP_LCD_TOUCH_SAMPLES);
+    touch_ctx->sample_idx = 0;
+    touch_ctx->release = !(touchpad_pressed && touchpad_cnt > 0);
+    if (lvgl_port_touchpad_read_sample(touch_ctx, data)) {
+        return;
+    }
+    touch_ctx->release = false;
+    if (!(touchpad_pressed && touchpad_cnt > 0)) {
+        touch_ctx->last_valid = false;
+    }
+#endif
 
     if (touchpad_pressed && touchpad_cnt > 0) {
         data->point.x = touchpad_x[0];
@@ -99,3 +260,147 @@ static void lvgl_port_touchpad_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *
         data->state = LV_INDEV_STATE_RELEASED;
     }
 }
+
+/* Select reading period by touch state */
+static void lvgl_port_touch_set_poll(lvgl_port_touch_ctx_t *touch_ctx, bool active)
+{
+    uint32_t period = (active ? touch_ctx->poll_active_ms : touch_ctx->poll_idle_ms);
+    if (period == 0) {
+        period = LV_INDEV_DEF_READ_PERIOD;
+    }
+    lv_timer_t *timer = touch_ctx->indev_drv.read_timer;
+    if (timer) {
+        lv_timer_set_period(timer, period);
+    }
+}
+
+/* Controller sleeps, when the display is inactive (no touch and no other input), and it is woken by activity */
+static void lvgl_port_touch_sleep_timer_cb(lv_timer_t *timer)
+{
+    lvgl_port_touch_ctx_t *touch_ctx = (lvgl_port_touch_ctx_t *)timer->user_data;
+    assert(touch_ctx);
+
+    const uint32_t inactive_ms = lv_disp_get_inactive_time(touch_ctx->indev_drv.disp);
+
+    /* Slow scanning of the controller in idle */
+    if (touch_ctx->scan_idle_ms > 0 && touch_ctx->scan_active && !touch_ctx->pressed && inactive_ms >= touch_ctx->scan_idle_ms) {
+        lvgl_port_touch_set_scan(touch_ctx, false);
+    }
+    if (touch_ctx->sleep_timeout_ms == 0) {
+        return;
+    }
+
+    const bool inactive = (inactive_ms >= touch_ctx->sleep_timeout_ms);
+    if (inactive && !touch_ctx->sleeping && !touch_ctx->pressed) {
+        if (touch_ctx->handle->enter_sleep && esp_lcd_touch_enter_sleep(touch_ctx->handle) == ESP_OK) {
+            touch_ctx->sleeping = true;
+        }
+    } else if (!inactive && touch_ctx->sleeping) {
+        touch_ctx->sleeping = false;
+        if (esp_lcd_touch_exit_sleep(touch_ctx->handle) != ESP_OK) {
+            ESP_LOGW(TAG, "Touch exit sleep failed");
+        }
+    }
+}
+
+/* Active scanning during interaction, monitor mode of the controller in idle */
+static void lvgl_port_touch_set_scan(lvgl_port_touch_ctx_t *touch_ctx, bool active)
+{
+    touch_ctx->scan_active = active;
+    const esp_err_t ret = esp_lcd_touch_set_active_scan(touch_ctx->handle, active);
+    if (ret == ESP_ERR_NOT_SUPPORTED) {
+        ESP_LOGW(TAG, "Touch controller does not support scan mode switching");
+        touch_ctx->scan_idle_ms = 0;
+    } else if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Touch scan mode not set");
+    }
+}
+
+/* Recognize gestures from the touch points and send them to the object under the gesture */
+static void lvgl_port_touch_gestures(lvgl_port_touch_ctx_t *touch_ctx, const uint16_t *x, const uint16_t *y, uint8_t cnt)
+{
+    uint16_t gx[2];
+    uint16_t gy[2];
+    lvgl_port_gesture_t gestures[LVGL_PORT_GESTURE_MAX_OUT];
+    lv_disp_t *disp = touch_ctx->indev_drv.disp;
+    const lv_disp_rot_t rotation = disp->driver->rotated;
+    const int32_t hres = disp->driver->hor_res;
+    const int32_t vres = disp->driver->ver_res;
+
+    /* Rotate the points same as LVGL rotates the pointer */
+    cnt = (cnt > 2 ? 2 : cnt);
+    for (int i = 0; i < cnt; i++) {
+        int32_t px = x[i];
+        int32_t py = y[i];
+        if (rotation == LV_DISP_ROT_180 || rotation == LV_DISP_ROT_270) {
+            px = hres - px - 1;
+            py = vres - py - 1;
+        }
+        if (rotation == LV_DISP_ROT_90 || rotation == LV_DISP_ROT_270) {
+            const int32_t tmp = py;
+            py = px;
+            px = vres - tmp - 1;
+        }
+        gx[i] = (uint16_t)LV_CLAMP(0, px, UINT16_MAX);
+        gy[i] = (uint16_t)LV_CLAMP(0, py, UINT16_MAX);
+    }
+
+    const uint8_t gesture_cnt = lvgl_port_gesture_update(&touch_ctx->gesture, gx, gy, cnt, esp_timer_get_time(), gestures);
+    for (int i = 0; i < gesture_cnt; i++) {
+        lv_obj_t *scr = lv_disp_get_scr_act(disp);
+        lv_obj_t *target = lv_indev_search_obj(scr, &gestures[i].point);
+        if (target == NULL) {
+            target = scr;
+        }
+        lv_event_send(target, lvgl_port_gesture_event, &gestures[i]);
+    }
+}
+
+#if (CONFIG_ESP_LCD_TOUCH_SAMPLES > 0)
+/* Give the next saved sample to LVGL. Returns false, if there is nothing to give. */
+static bool lvgl_port_touchpad_read_sample(lvgl_port_touch_ctx_t *touch_ctx, lv_indev_data_t *data)
+{
+    if (touch_ctx->sample_idx >= touch_ctx->sample_cnt) {
+        if (touch_ctx->release && touch_ctx->sample_cnt > 0) {
+            /* Touch was released after the last sample */
+            touch_ctx->release = false;
+            touch_ctx->sample_cnt = 0;
+            touch_ctx->last_valid = false;
+            data->point.x = touch_ctx->last.x;
+            data->point.y = touch_ctx->last.y;
+            data->state = LV_INDEV_STATE_RELEASED;
+            return true;
+        }
+        return false;
+    }
+
+    const esp_lcd_touch_sample_t *sample = &touch_ctx->samples[touch_ctx->sample_idx++];
+    int32_t x = sample->x;
+    int32_t y = sample->y;
+
+    /* Only the newest sample is predicted, it will be shown in the next frame */
+    const bool newest = (touch_ctx->sample_idx == touch_ctx->sample_cnt);
+    if (newest && touch_ctx->predict_ms > 0 && touch_ctx->last_valid) {
+        const int64_t dt = sample->timestamp_us - touch_ctx->last.timestamp_us;
+        /* Too old samples are not from the same movement */
+        if (dt > 0 && dt < 50000) {
+            const int64_t ahead = (int64_t)touch_ctx->predict_ms * 1000;
+            x += (int32_t)(((int64_t)x - touch_ctx->last.x) * ahead / dt);
+            y += (int32_t)(((int64_t)y - touch_ctx->last.y) * ahead / dt);
+            const int32_t hres = lv_disp_get_hor_res(touch_ctx->indev_drv.disp);
+            const int32_t vres = lv_disp_get_ver_res(touch_ctx->indev_drv.disp);
+            x = LV_CLAMP(0, x, hres - 1);
+            y = LV_CLAMP(0, y, vres - 1);
+        }
+    }
+    touch_ctx->last = *sample;
+    touch_ctx->last_valid = true;
+
+    data->point.x = x;
+    data->point.y = y;
+    data->state = LV_INDEV_STATE_PRESSED;
+    /* LVGL calls read callback again in the same cycle */
+    data->continue_reading = (!newest || touch_ctx->release);
+    return true;
+}
+#endif
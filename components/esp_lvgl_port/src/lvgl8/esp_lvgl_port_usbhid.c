@@ -5,6 +5,7 @@
  */
 
 #include <string.h>
+#include <stdatomic.h>
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_check.h"
@@ -22,10 +23,19 @@ LV_IMG_DECLARE(img_cursor)
 
 static const char *TAG = "LVGL";
 
+/* Count of mouse button changes, which can wait for LVGL read (power of two) */
+#define LVGL_PORT_USB_HID_MOUSE_QUEUE_LEN   (16)
+
 /*******************************************************************************
 * Types definitions
 *******************************************************************************/
 
+typedef struct {
+    int32_t dx;                 /* Mouse X motion before the button change */
+    int32_t dy;                 /* Mouse Y motion before the button change */
+    bool left_button;           /* Mouse left button state after the change */
+} lvgl_port_usb_hid_mouse_event_t;
+
 typedef struct {
     QueueHandle_t   queue;      /* USB HID queue */
     TaskHandle_t    task;       /* USB HID task */
@@ -33,9 +43,15 @@ typedef struct {
     struct {
         lv_indev_drv_t  drv;    /* LVGL mouse input device driver */
         uint8_t sensitivity;    /* Mouse sensitivity (cannot be zero) */
-        int16_t x;              /* Mouse X coordinate */
-        int16_t y;              /* Mouse Y coordinate */
-        bool left_button;       /* Mouse left button state */
+        int32_t x;              /* Mouse X coordinate */
+        int32_t y;              /* Mouse Y coordinate */
+        bool left_button;       /* Mouse left button state (LVGL read) */
+        bool report_button;     /* Mouse left button state of the last queued report (HID callback) */
+        atomic_int dx;          /* Mouse X motion summed since the last read or button change */
+        atomic_int dy;          /* Mouse Y motion summed since the last read or button change */
+        lvgl_port_usb_hid_mouse_event_t events[LVGL_PORT_USB_HID_MOUSE_QUEUE_LEN]; /* Button changes */
+        atomic_uint head;       /* Next position for write (HID callback) */
+        atomic_uint tail;       /* Next position for read (LVGL read) */
     } mouse;
     struct {
         lv_indev_drv_t  drv;    /* LVGL keyboard input device driver */
@@ -259,6 +275,23 @@ static char usb_hid_get_keyboard_char(uint8_t key, uint8_t shift)
     return ret_key;
 }
 
+static bool lvgl_port_usb_hid_queue_button(lvgl_port_usb_hid_ctx_t *hid_ctx, int32_t dx, int32_t dy, bool left_button)
+{
+    /* Only HID callback writes into the queue */
+    const unsigned int head = atomic_load_explicit(&hid_ctx->mouse.head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&hid_ctx->mouse.tail, memory_order_acquire) >= LVGL_PORT_USB_HID_MOUSE_QUEUE_LEN) {
+        return false;
+    }
+
+    lvgl_port_usb_hid_mouse_event_t *event = &hid_ctx->mouse.events[head & (LVGL_PORT_USB_HID_MOUSE_QUEUE_LEN - 1)];
+    event->dx = atomic_exchange_explicit(&hid_ctx->mouse.dx, 0, memory_order_relaxed) + dx;
+    event->dy = atomic_exchange_explicit(&hid_ctx->mouse.dy, 0, memory_order_relaxed) + dy;
+    event->left_button = left_button;
+    atomic_store_explicit(&hid_ctx->mouse.head, head + 1, memory_order_release);
+
+    return true;
+}
+
 static void lvgl_port_usb_hid_host_interface_callback(hid_host_device_handle_t hid_device_handle, const hid_host_interface_event_t event, void *arg)
 {
     hid_host_dev_params_t dev;
@@ -322,9 +355,16 @@ static void lvgl_port_usb_hid_host_interface_callback(hid_host_device_handle_t h
             if (data_length < sizeof(hid_mouse_input_report_boot_t)) {
                 break;
             }
-            hid_ctx->mouse.left_button = mouse->buttons.button1;
-            hid_ctx->mouse.x += mouse->x_displacement;
-            hid_ctx->mouse.y += mouse->y_displacement;
+            /* Button changes are queued with the motion before them, other motion is only summed */
+            const bool left_button = mouse->buttons.button1;
+            if (left_button != hid_ctx->mouse.report_button &&
+                    lvgl_port_usb_hid_queue_button(hid_ctx, mouse->x_displacement, mouse->y_displacement, left_button)) {
+                hid_ctx->mouse.report_button = left_button;
+            } else {
+                /* When the queue is full, the button change is queued with one of the next reports */
+                atomic_fetch_add_explicit(&hid_ctx->mouse.dx, mouse->x_displacement, memory_order_relaxed);
+                atomic_fetch_add_explicit(&hid_ctx->mouse.dy, mouse->y_displacement, memory_order_relaxed);
+            }
         }
         break;
     case HID_HOST_INTERFACE_EVENT_TRANSFER_ERROR:
@@ -400,6 +440,25 @@ static void lvgl_port_usb_hid_read_mouse(lv_indev_drv_t *indev_drv, lv_indev_dat
         height = indev_drv->disp->driver->hor_res;
     }
 
+    /* Apply the oldest button change or all summed motion */
+    int32_t dx;
+    int32_t dy;
+    const unsigned int tail = atomic_load_explicit(&ctx->mouse.tail, memory_order_relaxed);
+    if (tail != atomic_load_explicit(&ctx->mouse.head, memory_order_acquire)) {
+        const lvgl_port_usb_hid_mouse_event_t *event = &ctx->mouse.events[tail & (LVGL_PORT_USB_HID_MOUSE_QUEUE_LEN - 1)];
+        dx = event->dx;
+        dy = event->dy;
+        ctx->mouse.left_button = event->left_button;
+        atomic_store_explicit(&ctx->mouse.tail, tail + 1, memory_order_release);
+        /* Each button change is one LVGL reading */
+        data->continue_reading = (tail + 1 != atomic_load_explicit(&ctx->mouse.head, memory_order_acquire));
+    } else {
+        dx = atomic_exchange_explicit(&ctx->mouse.dx, 0, memory_order_relaxed);
+        dy = atomic_exchange_explicit(&ctx->mouse.dy, 0, memory_order_relaxed);
+    }
+    ctx->mouse.x += dx;
+    ctx->mouse.y += dy;
+
     /* Screen borders */
     if (ctx->mouse.x < 0) {
         ctx->mouse.x = 0;
@@ -5,6 +5,7 @@
  */
 
 #include <string.h>
+#include <stdatomic.h>
 #include "esp_system.h"
 #include "esp_log.h"
 #include "esp_err.h"
@@ -14,6 +15,9 @@
 #include "freertos/portmacro.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
 #include "esp_lvgl_port.h"
 #include "esp_lvgl_port_priv.h"
 #include "lvgl.h"
@@ -21,27 +25,103 @@
 static const char *TAG = "LVGL";
 
 #define ESP_LVGL_PORT_TASK_MUX_DELAY_MS    10000
+/* Minimal time without LVGL timer ready for waiting for wake-up only (idle_tick_stop) */
+#define ESP_LVGL_PORT_TICK_IDLE_MS         100
+
+/* Pending events of the LVGL task. Bits 0-7 are event types, bits 8-31 are input devices registered in wake_indevs. */
+#define ESP_LVGL_PORT_WAKE_DISPLAY         (1U << 0)
+#define ESP_LVGL_PORT_WAKE_INDEV_ALL       (1U << 1)
+#define ESP_LVGL_PORT_WAKE_USER            (1U << 2)
+#define ESP_LVGL_PORT_WAKE_INDEV_SHIFT     (8)
+#define ESP_LVGL_PORT_WAKE_INDEV_MAX       (24)
+
+/* Default boost window of the LVGL task priority after input activity [ms] */
+#define ESP_LVGL_PORT_BOOST_MS             300
+
+/* PM governor: HIGH level after a frame longer than 3/4 of the period, LOW level after frames shorter than 1/4 of the period */
+#define ESP_LVGL_PORT_PM_BOOST_NUM         3
+#define ESP_LVGL_PORT_PM_BOOST_DEN         4
+#define ESP_LVGL_PORT_PM_DROP_DEN          4
+#define ESP_LVGL_PORT_PM_DROP_FRAMES       10
+/* PM governor: HIGH level is held after input or animation start [ms] */
+#define ESP_LVGL_PORT_PM_HOLD_MS           500
+
+/* Maximum number of pending lvgl_port_async_call (power of two) */
+#define ESP_LVGL_PORT_ASYNC_QUEUE_LEN      16
 
 /*******************************************************************************
 * Types definitions
 *******************************************************************************/
 
+typedef struct {
+    atomic_uint          seq;       /* Sequence number of the cell (ready for write: position, ready for read: position + 1) */
+    lvgl_port_async_cb_t cb;
+    void                 *user_data;
+} lvgl_port_async_t;
+
+/* Lock-free ring buffer, more producers (tasks and ISRs) and one consumer (LVGL task) */
+typedef struct {
+    lvgl_port_async_t    cells[ESP_LVGL_PORT_ASYNC_QUEUE_LEN];
+    atomic_uint          head;      /* Next position for write */
+    unsigned int         tail;      /* Next position for read (LVGL task only) */
+    bool                 ready;
+} lvgl_port_async_ring_t;
+
+/* Power management of the LVGL task (flags.pm_lock, flags.pm_governor) */
+typedef struct {
+    bool                 used;          /* Levels are tracked */
+    bool                 governor;      /* Level is selected by frame render times */
+    lvgl_port_pm_level_t level;         /* Level selected by the governor (HIGH without governor) */
+    lvgl_port_pm_level_t cur;           /* Level being accounted now */
+    int64_t              mark;          /* Start of the current level [us] */
+    int64_t              hold_until;    /* HIGH level is held until this time [us] */
+    uint32_t             frame_us;      /* Target frame period [us] */
+    uint32_t             frame_max;     /* Longest render time in the current work [us] */
+    uint32_t             fast_cnt;      /* Consecutive fast frames in HIGH level */
+    uint32_t             anim_cnt;      /* Running animations after the last work */
+    lvgl_port_pm_stats_t stats;
+} lvgl_port_pm_t;
+
 typedef struct lvgl_port_ctx_s {
     TaskHandle_t        lvgl_task;
     SemaphoreHandle_t   lvgl_mux;
     SemaphoreHandle_t   timer_mux;
-    QueueHandle_t       lvgl_queue;
+    SemaphoreHandle_t   wake_sem;       /* LVGL task wake-up, given once for any number of events */
+    volatile uint32_t   wake_pending;   /* Pending events (ESP_LVGL_PORT_WAKE_*) */
+    lv_indev_t          *wake_indevs[ESP_LVGL_PORT_WAKE_INDEV_MAX]; /* Input devices, which woke the task (index is bit in wake_pending) */
+    lvgl_port_async_ring_t async;       /* Pending lvgl_port_async_call */
+    lvgl_port_lock_stats_t lock_stats;  /* LVGL lock statistics */
+    uint64_t            lock_wait_total; /* Sum of waiting times for the lock since init, not reset with the statistics [us] */
+    uint32_t            lock_contended_total; /* Number of contended locks since init, not reset with the statistics */
+    int64_t             lock_start;     /* Time of taking the LVGL lock [us] */
+    lvgl_port_trace_cb_t trace_cb;      /* Touch-to-photon trace callback */
+    void                *trace_ctx;
+    uint32_t            lock_depth;     /* Recursive depth of the LVGL lock */
     SemaphoreHandle_t   task_init_mux;
-    esp_timer_handle_t  tick_timer;
     bool                running;
     int                 task_max_sleep_ms;
-    int                 timer_period_ms;
+    int                 task_priority;
+    int                 task_boost_priority; /* Priority after input activity (0: no boost) */
+    uint32_t            task_boost_ms;  /* Boost window after the last input activity [ms] */
+    bool                task_boosted;
+    bool                idle_tick_stop; /* Wait for wake-up only, when LVGL is idle */
+    bool                tick_paused;    /* LVGL is idle, the task waits for wake-up only */
+    bool                parked;         /* LVGL timers are stopped and displays are parked (lvgl_port_park) */
+    bool                stopped;        /* LVGL timers are stopped (lvgl_port_stop), paced displays are not rendered */
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_handle_t pm_cpu_lock;   /* Held while LVGL task works */
+    esp_pm_lock_handle_t pm_apb_lock;   /* Held while a display is flushed */
+    esp_pm_lock_handle_t pm_low_lock;   /* Held while LVGL task works in LOW level (governor) */
+#endif
+    lvgl_port_pm_t      pm;
 } lvgl_port_ctx_t;
 
 /*******************************************************************************
 * Local variables
 *******************************************************************************/
 static lvgl_port_ctx_t lvgl_port_ctx;
+static portMUX_TYPE lvgl_port_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static portMUX_TYPE lvgl_port_wake_lock = portMUX_INITIALIZER_UNLOCKED;
 
 /*******************************************************************************
 * Function definitions
@@ -49,6 +129,17 @@ static lvgl_port_ctx_t lvgl_port_ctx;
 static void lvgl_port_task(void *arg);
 static esp_err_t lvgl_port_tick_init(void);
 static void lvgl_port_task_deinit(void);
+static void lvgl_port_tick_pause(void);
+static void lvgl_port_tick_catch_up(void);
+static void lvgl_port_read_indevs(uint32_t events);
+static void lvgl_port_lock_taken(int64_t wait_start, bool contended);
+static void lvgl_port_lock_released(void);
+static void lvgl_port_process_async(void);
+static void lvgl_port_task_boost(bool boost);
+static esp_err_t lvgl_port_pm_init(const lvgl_port_cfg_t *cfg);
+static void lvgl_port_pm_deinit(void);
+static lvgl_port_pm_level_t lvgl_port_pm_work_start(uint32_t events);
+static void lvgl_port_pm_work_end(lvgl_port_pm_level_t level);
 
 /*******************************************************************************
 * Public API functions
@@ -59,16 +150,24 @@ esp_err_t lvgl_port_init(const lvgl_port_cfg_t *cfg)
     esp_err_t ret = ESP_OK;
     ESP_GOTO_ON_FALSE(cfg, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
     ESP_GOTO_ON_FALSE(cfg->task_affinity < (configNUM_CORES), ESP_ERR_INVALID_ARG, err, TAG, "Bad core number for task! Maximum core number is %d", (configNUM_CORES - 1));
+    ESP_GOTO_ON_FALSE(cfg->task_boost_priority == 0 || (cfg->task_boost_priority > cfg->task_priority && cfg->task_boost_priority < configMAX_PRIORITIES),
+                      ESP_ERR_INVALID_ARG, err, TAG, "Boost priority must be between task priority and %d", (configMAX_PRIORITIES - 1));
 
     memset(&lvgl_port_ctx, 0, sizeof(lvgl_port_ctx));
 
-    /* Tick init */
-    lvgl_port_ctx.timer_period_ms = cfg->timer_period_ms;
+    /* LVGL reads the tick from esp_timer, timer_period_ms is not used */
+    lvgl_port_ctx.idle_tick_stop = cfg->flags.idle_tick_stop;
+    if (cfg->flags.pm_lock || cfg->flags.pm_governor) {
+        ESP_GOTO_ON_ERROR(lvgl_port_pm_init(cfg), err, TAG, "Create PM locks fail!");
+    }
     /* Create task */
     lvgl_port_ctx.task_max_sleep_ms = cfg->task_max_sleep_ms;
     if (lvgl_port_ctx.task_max_sleep_ms == 0) {
         lvgl_port_ctx.task_max_sleep_ms = 500;
     }
+    lvgl_port_ctx.task_priority = cfg->task_priority;
+    lvgl_port_ctx.task_boost_priority = cfg->task_boost_priority;
+    lvgl_port_ctx.task_boost_ms = (cfg->task_boost_ms > 0 ? cfg->task_boost_ms : ESP_LVGL_PORT_BOOST_MS);
     /* Timer semaphore */
     lvgl_port_ctx.timer_mux = xSemaphoreCreateMutex();
     ESP_GOTO_ON_FALSE(lvgl_port_ctx.timer_mux, ESP_ERR_NO_MEM, err, TAG, "Create timer mutex fail!");
@@ -78,9 +177,16 @@ esp_err_t lvgl_port_init(const lvgl_port_cfg_t *cfg)
     /* Task init semaphore */
     lvgl_port_ctx.task_init_mux = xSemaphoreCreateMutex();
     ESP_GOTO_ON_FALSE(lvgl_port_ctx.task_init_mux, ESP_ERR_NO_MEM, err, TAG, "Create LVGL task sem fail!");
-    /* Task queue */
-    lvgl_port_ctx.lvgl_queue = xQueueCreate(100, sizeof(lvgl_port_event_t));
-    ESP_GOTO_ON_FALSE(lvgl_port_ctx.lvgl_queue, ESP_ERR_NO_MEM, err, TAG, "Create LVGL queue fail!");
+    /* Task wake-up */
+    lvgl_port_ctx.wake_sem = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(lvgl_port_ctx.wake_sem, ESP_ERR_NO_MEM, err, TAG, "Create LVGL wake semaphore fail!");
+    /* Async calls */
+    for (int i = 0; i < ESP_LVGL_PORT_ASYNC_QUEUE_LEN; i++) {
+        atomic_init(&lvgl_port_ctx.async.cells[i].seq, i);
+    }
+    atomic_init(&lvgl_port_ctx.async.head, 0);
+    lvgl_port_ctx.async.tail = 0;
+    lvgl_port_ctx.async.ready = true;
 
     BaseType_t res;
     if (cfg->task_affinity < 0) {
@@ -100,37 +206,93 @@ err:
 
 esp_err_t lvgl_port_resume(void)
 {
-    esp_err_t ret = ESP_ERR_INVALID_STATE;
-
-    if (lvgl_port_ctx.tick_timer != NULL) {
-        lv_timer_enable(true);
-        ret = esp_timer_start_periodic(lvgl_port_ctx.tick_timer, lvgl_port_ctx.timer_period_ms * 1000);
+    if (!lvgl_port_ctx.running) {
+        return ESP_ERR_INVALID_STATE;
     }
 
-    return ret;
+    lv_timer_enable(true);
+    lvgl_port_ctx.stopped = false;
+    return ESP_OK;
 }
 
 esp_err_t lvgl_port_stop(void)
 {
-    esp_err_t ret = ESP_ERR_INVALID_STATE;
+    if (!lvgl_port_ctx.running) {
+        return ESP_ERR_INVALID_STATE;
+    }
 
-    if (lvgl_port_ctx.tick_timer != NULL) {
-        lv_timer_enable(false);
-        ret = esp_timer_stop(lvgl_port_ctx.tick_timer);
+    /* There is no tick timer, only LVGL timers are stopped */
+    lv_timer_enable(false);
+    lvgl_port_ctx.stopped = true;
+    lvgl_port_ctx.tick_paused = false;
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_park(bool release_buffers)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(lvgl_port_ctx.lvgl_mux, ESP_ERR_INVALID_STATE, TAG, "LVGL port is not initialized");
+
+    lvgl_port_lock(0);
+    ESP_GOTO_ON_FALSE(!lvgl_port_ctx.parked, ESP_ERR_INVALID_STATE, err, TAG, "LVGL port is already parked");
+
+    /* No frame is rendered from now, objects, styles and timers stay in LVGL */
+    lvgl_port_stop();
+    lv_display_t *disp = NULL;
+    for (disp = lv_display_get_next(NULL); disp != NULL; disp = lv_display_get_next(disp)) {
+        if (lv_display_get_user_data(disp) == NULL) {
+            continue;
+        }
+        if (lvgl_port_disp_park(disp, release_buffers) != ESP_OK) {
+            ret = ESP_ERR_TIMEOUT;
+            break;
+        }
+    }
+
+    if (ret != ESP_OK) {
+        /* Displays parked before the failed one are running again, the port is not parked */
+        for (lv_display_t *parked = lv_display_get_next(NULL); parked != disp; parked = lv_display_get_next(parked)) {
+            if (lv_display_get_user_data(parked) != NULL && lvgl_port_disp_unpark(parked) != ESP_OK) {
+                ESP_LOGE(TAG, "Display was not unparked after failed park!");
+            }
+        }
+        lvgl_port_resume();
+        lvgl_port_task_wake(LVGL_PORT_EVENT_DISPLAY, NULL);
+        goto err;
     }
+    lvgl_port_ctx.parked = true;
 
+err:
+    lvgl_port_unlock();
     return ret;
 }
 
-esp_err_t lvgl_port_deinit(void)
+esp_err_t lvgl_port_unpark(void)
 {
-    /* Stop and delete timer */
-    if (lvgl_port_ctx.tick_timer != NULL) {
-        esp_timer_stop(lvgl_port_ctx.tick_timer);
-        esp_timer_delete(lvgl_port_ctx.tick_timer);
-        lvgl_port_ctx.tick_timer = NULL;
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(lvgl_port_ctx.lvgl_mux, ESP_ERR_INVALID_STATE, TAG, "LVGL port is not initialized");
+
+    lvgl_port_lock(0);
+    ESP_GOTO_ON_FALSE(lvgl_port_ctx.parked, ESP_ERR_INVALID_STATE, err, TAG, "LVGL port is not parked");
+
+    /* All displays must have their buffers back before the first frame */
+    for (lv_display_t *disp = lv_display_get_next(NULL); disp != NULL; disp = lv_display_get_next(disp)) {
+        if (lv_display_get_user_data(disp) == NULL) {
+            continue;
+        }
+        ESP_GOTO_ON_ERROR(lvgl_port_disp_unpark(disp), err, TAG, "Unpark display failed, LVGL port stays parked");
     }
+    lvgl_port_ctx.parked = false;
+    lvgl_port_resume();
+    lvgl_port_task_wake(LVGL_PORT_EVENT_DISPLAY, NULL);
 
+err:
+    lvgl_port_unlock();
+    return ret;
+}
+
+esp_err_t lvgl_port_deinit(void)
+{
     /* Stop running task */
     if (lvgl_port_ctx.running) {
         lvgl_port_ctx.running = false;
@@ -153,39 +315,173 @@ bool lvgl_port_lock(uint32_t timeout_ms)
     assert(lvgl_port_ctx.lvgl_mux && "lvgl_port_init must be called first");
 
     const TickType_t timeout_ticks = (timeout_ms == 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
-    return xSemaphoreTakeRecursive(lvgl_port_ctx.lvgl_mux, timeout_ticks) == pdTRUE;
+    const int64_t wait_start = esp_timer_get_time();
+    /* Lock held by another task is counted as contention */
+    const bool contended = (xSemaphoreTakeRecursive(lvgl_port_ctx.lvgl_mux, 0) != pdTRUE);
+    if (contended && xSemaphoreTakeRecursive(lvgl_port_ctx.lvgl_mux, timeout_ticks) != pdTRUE) {
+        return false;
+    }
+    lvgl_port_lock_taken(wait_start, contended);
+
+    /* LVGL is going to be used, the tick must be valid */
+    lvgl_port_tick_catch_up();
+    return true;
 }
 
 void lvgl_port_unlock(void)
 {
     assert(lvgl_port_ctx.lvgl_mux && "lvgl_port_init must be called first");
+    lvgl_port_lock_released();
     xSemaphoreGiveRecursive(lvgl_port_ctx.lvgl_mux);
 }
 
-esp_err_t lvgl_port_task_wake(lvgl_port_event_type_t event, void *param)
+esp_err_t lvgl_port_get_lock_stats(lvgl_port_lock_stats_t *stats, bool reset)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(lvgl_port_ctx.lvgl_mux, ESP_ERR_INVALID_STATE, TAG, "lvgl_port_init must be called first");
+
+    /* Statistics can be read without the LVGL lock, the task waiting for the lock is not blocked */
+    portENTER_CRITICAL(&lvgl_port_stats_lock);
+    memcpy(stats, &lvgl_port_ctx.lock_stats, sizeof(lvgl_port_lock_stats_t));
+    if (reset) {
+        const TaskHandle_t owner = lvgl_port_ctx.lock_stats.owner;
+        memset(&lvgl_port_ctx.lock_stats, 0, sizeof(lvgl_port_lock_stats_t));
+        lvgl_port_ctx.lock_stats.owner = owner;
+    }
+    portEXIT_CRITICAL(&lvgl_port_stats_lock);
+
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_get_pm_stats(lvgl_port_pm_stats_t *stats, bool reset)
 {
-    if (!lvgl_port_ctx.lvgl_queue) {
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(lvgl_port_ctx.lvgl_mux && lvgl_port_ctx.pm.used, ESP_ERR_INVALID_STATE, TAG, "PM locks are not used");
+
+    lvgl_port_pm_t *pm = &lvgl_port_ctx.pm;
+    const int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&lvgl_port_stats_lock);
+    /* Time of the current level is counted up to now */
+    pm->stats.time_us[pm->cur] += now - pm->mark;
+    pm->mark = now;
+    pm->stats.level = (now < pm->hold_until ? LVGL_PORT_PM_LEVEL_HIGH : pm->level);
+    memcpy(stats, &pm->stats, sizeof(lvgl_port_pm_stats_t));
+    if (reset) {
+        memset(&pm->stats, 0, sizeof(lvgl_port_pm_stats_t));
+    }
+    portEXIT_CRITICAL(&lvgl_port_stats_lock);
+
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_async_call(lvgl_port_async_cb_t cb, void *user_data)
+{
+    /* No logs here, this function can be called from ISR */
+    if (cb == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!lvgl_port_ctx.async.ready) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    lvgl_port_event_t ev = {
-        .type = event,
-        .param = param,
-    };
+    /* Reserve a cell: the cell is free, when its sequence is equal to the write position */
+    lvgl_port_async_ring_t *ring = &lvgl_port_ctx.async;
+    lvgl_port_async_t *cell;
+    unsigned int pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    while (1) {
+        cell = &ring->cells[pos & (ESP_LVGL_PORT_ASYNC_QUEUE_LEN - 1)];
+        const unsigned int seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        const int diff = (int)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->head, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* Ring is full */
+            return ESP_ERR_TIMEOUT;
+        } else {
+            pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        }
+    }
+
+    cell->cb = cb;
+    cell->user_data = user_data;
+    /* Publish the cell for the LVGL task */
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+
+    /* Wake LVGL task */
+    lvgl_port_task_wake(LVGL_PORT_EVENT_USER, NULL);
+
+    return ESP_OK;
+}
+
+IRAM_ATTR esp_err_t lvgl_port_task_wake(lvgl_port_event_type_t event, void *param)
+{
+    if (!lvgl_port_ctx.wake_sem) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t bits = ESP_LVGL_PORT_WAKE_USER;
+    if (event == LVGL_PORT_EVENT_DISPLAY) {
+        bits = ESP_LVGL_PORT_WAKE_DISPLAY;
+    } else if (event == LVGL_PORT_EVENT_TOUCH) {
+        bits = ESP_LVGL_PORT_WAKE_INDEV_ALL;
+    }
+
+    /* Events are only marked as pending, more events before the task wakes up are handled at once */
+    portENTER_CRITICAL_SAFE(&lvgl_port_wake_lock);
+    if (event == LVGL_PORT_EVENT_TOUCH && param != NULL) {
+        for (int i = 0; i < ESP_LVGL_PORT_WAKE_INDEV_MAX; i++) {
+            if (lvgl_port_ctx.wake_indevs[i] == NULL) {
+                lvgl_port_ctx.wake_indevs[i] = param;
+            }
+            if (lvgl_port_ctx.wake_indevs[i] == param) {
+                bits = (1U << (ESP_LVGL_PORT_WAKE_INDEV_SHIFT + i));
+                break;
+            }
+        }
+    }
+    lvgl_port_ctx.wake_pending |= bits;
+    portEXIT_CRITICAL_SAFE(&lvgl_port_wake_lock);
 
     if (xPortInIsrContext() == pdTRUE) {
         BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-        xQueueSendFromISR(lvgl_port_ctx.lvgl_queue, &ev, &xHigherPriorityTaskWoken);
+        xSemaphoreGiveFromISR(lvgl_port_ctx.wake_sem, &xHigherPriorityTaskWoken);
         if (xHigherPriorityTaskWoken) {
             portYIELD_FROM_ISR( );
         }
     } else {
-        xQueueSend(lvgl_port_ctx.lvgl_queue, &ev, 0);
+        xSemaphoreGive(lvgl_port_ctx.wake_sem);
     }
 
     return ESP_OK;
 }
 
+esp_err_t lvgl_port_set_trace_cb(lvgl_port_trace_cb_t cb, void *user_ctx)
+{
+    portENTER_CRITICAL(&lvgl_port_wake_lock);
+    lvgl_port_ctx.trace_ctx = user_ctx;
+    lvgl_port_ctx.trace_cb = cb;
+    portEXIT_CRITICAL(&lvgl_port_wake_lock);
+    return ESP_OK;
+}
+
+IRAM_ATTR void lvgl_port_trace(lvgl_port_trace_stage_t stage, const lv_area_t *area)
+{
+    const lvgl_port_trace_cb_t cb = lvgl_port_ctx.trace_cb;
+    if (stage == LVGL_PORT_TRACE_FLUSH) {
+        LVGL_PORT_SV_START(LVGL_PORT_SV_FLUSH);
+    } else if (stage == LVGL_PORT_TRACE_FLUSH_DONE) {
+        LVGL_PORT_SV_STOP(LVGL_PORT_SV_FLUSH);
+    }
+#ifdef ESP_LVGL_PORT_TOUCH_COMPONENT
+    lvgl_port_touch_wake_trace(stage);
+#endif
+    if (cb) {
+        cb(stage, esp_timer_get_time(), area, lvgl_port_ctx.trace_ctx);
+    }
+}
+
 IRAM_ATTR bool lvgl_port_task_notify(uint32_t value)
 {
     BaseType_t need_yield = pdFALSE;
@@ -206,9 +502,8 @@ IRAM_ATTR bool lvgl_port_task_notify(uint32_t value)
 
 static void lvgl_port_task(void *arg)
 {
-    lvgl_port_event_t event;
     uint32_t task_delay_ms = 0;
-    lv_indev_t *indev = NULL;
+    uint32_t events = 0;
 
     /* Take the task semaphore */
     if (xSemaphoreTake(lvgl_port_ctx.task_init_mux, 0) != pdTRUE) {
@@ -219,41 +514,86 @@ static void lvgl_port_task(void *arg)
 
     /* LVGL init */
     lv_init();
+#if LV_USE_OS == LV_OS_FREERTOS && LV_DRAW_SW_DRAW_UNIT_CNT > 1
+    ESP_LOGI(TAG, "LVGL renders with %d SW draw units", LV_DRAW_SW_DRAW_UNIT_CNT);
+#endif
     /* Tick init */
     lvgl_port_tick_init();
 
     ESP_LOGI(TAG, "Starting LVGL task");
     lvgl_port_ctx.running = true;
     while (lvgl_port_ctx.running) {
-        /* Wait for queue or timeout (sleep task) */
+        /* Wait for queue or timeout (sleep task). In idle mode without any LVGL timer, wait for wake-up only. */
         TickType_t wait = (pdMS_TO_TICKS(task_delay_ms) >= 1 ? pdMS_TO_TICKS(task_delay_ms) : 1);
-        xQueueReceive(lvgl_port_ctx.lvgl_queue, &event, wait);
+        if (task_delay_ms == LV_NO_TIMER_READY && lvgl_port_ctx.tick_paused) {
+            wait = portMAX_DELAY;
+        }
+        xSemaphoreTake(lvgl_port_ctx.wake_sem, wait);
+
+        /* Take all pending events at once */
+        portENTER_CRITICAL(&lvgl_port_wake_lock);
+        events |= lvgl_port_ctx.wake_pending;
+        lvgl_port_ctx.wake_pending = 0;
+        portEXIT_CRITICAL(&lvgl_port_wake_lock);
+
+        /* Input activity boosts the priority before the LVGL lock is taken, the holder of the lock inherits it */
+        if (events & ~(ESP_LVGL_PORT_WAKE_DISPLAY | ESP_LVGL_PORT_WAKE_USER)) {
+            lvgl_port_task_boost(true);
+        }
 
         if (lv_display_get_default() && lvgl_port_lock(0)) {
+            const lvgl_port_pm_level_t pm_level = lvgl_port_pm_work_start(events);
 
             /* Call read input devices */
-            if (event.type == LVGL_PORT_EVENT_TOUCH) {
+            /* Input devices are not read while parked, the touches would be processed by a hidden UI */
+            if ((events & ~(ESP_LVGL_PORT_WAKE_DISPLAY | ESP_LVGL_PORT_WAKE_USER)) && !lvgl_port_ctx.parked) {
+                lvgl_port_trace(LVGL_PORT_TRACE_TASK_WAKE, NULL);
                 xSemaphoreTake(lvgl_port_ctx.timer_mux, portMAX_DELAY);
-                if (event.param != NULL) {
-                    lv_indev_read(event.param);
-                } else {
-                    indev = lv_indev_get_next(NULL);
-                    while (indev != NULL) {
-                        lv_indev_read(indev);
-                        indev = lv_indev_get_next(indev);
-                    }
-                }
+                lvgl_port_read_indevs(events);
                 xSemaphoreGive(lvgl_port_ctx.timer_mux);
             }
+            events = 0;
+
+            /* UI updates from other tasks */
+            lvgl_port_process_async();
 
             /* Handle LVGL */
             task_delay_ms = lv_timer_handler();
+
+            /* Paced displays are rendered at their frame deadlines */
+            if (!lvgl_port_ctx.stopped) {
+                task_delay_ms = LV_MIN(task_delay_ms, lvgl_port_disp_pace());
+            }
+
+            /* The boost lasts for the window after the last activity of any input device (also polled ones) */
+            if (lvgl_port_ctx.task_boost_priority) {
+                const uint32_t inactive = lv_display_get_inactive_time(NULL);
+                const bool boost = (inactive < lvgl_port_ctx.task_boost_ms);
+                lvgl_port_task_boost(boost);
+                if (boost) {
+                    task_delay_ms = LV_MIN(task_delay_ms, lvgl_port_ctx.task_boost_ms - inactive);
+                }
+            }
+
+            /* Images of the next screens are decoded in the idle time, the time until the next timer is shorter then */
+            if (!lvgl_port_ctx.parked) {
+                const uint32_t spent = lvgl_port_prefetch_run(task_delay_ms);
+                if (spent && task_delay_ms != LV_NO_TIMER_READY) {
+                    task_delay_ms = (task_delay_ms > spent ? task_delay_ms - spent : 1);
+                }
+            }
+
+            /* No timer is ready for a long time, stop the tick for save power */
+            if (lvgl_port_ctx.idle_tick_stop && task_delay_ms >= ESP_LVGL_PORT_TICK_IDLE_MS) {
+                lvgl_port_tick_pause();
+            }
+            lvgl_port_pm_work_end(pm_level);
             lvgl_port_unlock();
         } else {
             task_delay_ms = 1; /*Keep trying*/
         }
 
-        if (task_delay_ms == LV_NO_TIMER_READY) {
+        if (task_delay_ms == LV_NO_TIMER_READY && !lvgl_port_ctx.tick_paused) {
             task_delay_ms = lvgl_port_ctx.task_max_sleep_ms;
         }
 
@@ -268,6 +608,104 @@ static void lvgl_port_task(void *arg)
     vTaskDelete( NULL );
 }
 
+static void lvgl_port_task_boost(bool boost)
+{
+    if (lvgl_port_ctx.task_boost_priority == 0 || lvgl_port_ctx.task_boosted == boost) {
+        return;
+    }
+    vTaskPrioritySet(NULL, boost ? lvgl_port_ctx.task_boost_priority : lvgl_port_ctx.task_priority);
+    lvgl_port_ctx.task_boosted = boost;
+}
+
+static void lvgl_port_lock_taken(int64_t wait_start, bool contended)
+{
+    /* Only the first (not recursive) lock is measured */
+    if (lvgl_port_ctx.lock_depth++ > 0) {
+        return;
+    }
+
+    const int64_t now = esp_timer_get_time();
+    const uint32_t wait_time = (uint32_t)(now - wait_start);
+    lvgl_port_lock_stats_t *stats = &lvgl_port_ctx.lock_stats;
+    portENTER_CRITICAL(&lvgl_port_stats_lock);
+    stats->lock_cnt++;
+    stats->contended_cnt += (contended ? 1 : 0);
+    stats->wait_time_sum += wait_time;
+    lvgl_port_ctx.lock_wait_total += wait_time;
+    lvgl_port_ctx.lock_contended_total += (contended ? 1 : 0);
+    if (wait_time > stats->wait_time_max) {
+        stats->wait_time_max = wait_time;
+    }
+    stats->owner = xTaskGetCurrentTaskHandle();
+    portEXIT_CRITICAL(&lvgl_port_stats_lock);
+    lvgl_port_ctx.lock_start = now;
+}
+
+void lvgl_port_lock_contention(uint32_t *contended, uint64_t *wait_time)
+{
+    portENTER_CRITICAL(&lvgl_port_stats_lock);
+    *contended = lvgl_port_ctx.lock_contended_total;
+    *wait_time = lvgl_port_ctx.lock_wait_total;
+    portEXIT_CRITICAL(&lvgl_port_stats_lock);
+}
+
+static void lvgl_port_lock_released(void)
+{
+    if (--lvgl_port_ctx.lock_depth > 0) {
+        return;
+    }
+
+    const uint32_t hold_time = (uint32_t)(esp_timer_get_time() - lvgl_port_ctx.lock_start);
+    lvgl_port_lock_stats_t *stats = &lvgl_port_ctx.lock_stats;
+    portENTER_CRITICAL(&lvgl_port_stats_lock);
+    stats->hold_time_sum += hold_time;
+    if (hold_time > stats->hold_time_max) {
+        stats->hold_time_max = hold_time;
+    }
+    stats->owner = NULL;
+    portEXIT_CRITICAL(&lvgl_port_stats_lock);
+}
+
+static void lvgl_port_process_async(void)
+{
+    lvgl_port_async_ring_t *ring = &lvgl_port_ctx.async;
+    while (1) {
+        lvgl_port_async_t *cell = &ring->cells[ring->tail & (ESP_LVGL_PORT_ASYNC_QUEUE_LEN - 1)];
+        if (atomic_load_explicit(&cell->seq, memory_order_acquire) != ring->tail + 1) {
+            /* Empty or the producer did not finish writing yet */
+            break;
+        }
+        const lvgl_port_async_cb_t cb = cell->cb;
+        void *user_data = cell->user_data;
+        /* Release the cell for the next round */
+        atomic_store_explicit(&cell->seq, ring->tail + ESP_LVGL_PORT_ASYNC_QUEUE_LEN, memory_order_release);
+        ring->tail++;
+
+        cb(user_data);
+    }
+}
+
+static void lvgl_port_read_indevs(uint32_t events)
+{
+    lv_indev_t *indev = lv_indev_get_next(NULL);
+    while (indev != NULL) {
+        bool read = (events & ESP_LVGL_PORT_WAKE_INDEV_ALL);
+        if (!read) {
+            /* Only indevs existing in LVGL are read, registered pointer can belong to an already removed indev */
+            for (int i = 0; i < ESP_LVGL_PORT_WAKE_INDEV_MAX; i++) {
+                if (lvgl_port_ctx.wake_indevs[i] == indev && (events & (1U << (ESP_LVGL_PORT_WAKE_INDEV_SHIFT + i)))) {
+                    read = true;
+                    break;
+                }
+            }
+        }
+        if (read) {
+            lv_indev_read(indev);
+        }
+        indev = lv_indev_get_next(indev);
+    }
+}
+
 static void lvgl_port_task_deinit(void)
 {
     if (lvgl_port_ctx.timer_mux) {
@@ -279,9 +717,10 @@ static void lvgl_port_task_deinit(void)
     if (lvgl_port_ctx.task_init_mux) {
         vSemaphoreDelete(lvgl_port_ctx.task_init_mux);
     }
-    if (lvgl_port_ctx.lvgl_queue) {
-        vQueueDelete(lvgl_port_ctx.lvgl_queue);
+    if (lvgl_port_ctx.wake_sem) {
+        vSemaphoreDelete(lvgl_port_ctx.wake_sem);
     }
+    lvgl_port_pm_deinit();
     memset(&lvgl_port_ctx, 0, sizeof(lvgl_port_ctx));
 #if LV_ENABLE_GC || !LV_MEM_CUSTOM
     /* Deinitialize LVGL */
@@ -289,21 +728,185 @@ static void lvgl_port_task_deinit(void)
 #endif
 }
 
-static void lvgl_port_tick_increment(void *arg)
+static uint32_t lvgl_port_tick_get(void)
 {
-    xSemaphoreTake(lvgl_port_ctx.timer_mux, portMAX_DELAY);
-    /* Tell LVGL how many milliseconds have elapsed */
-    lv_tick_inc(lvgl_port_ctx.timer_period_ms);
-    xSemaphoreGive(lvgl_port_ctx.timer_mux);
+    /* Computed from the absolute time, the sub-ms remainder is not lost after idle periods and the tick does not drift */
+    return (uint32_t)(esp_timer_get_time() / 1000);
 }
 
 static esp_err_t lvgl_port_tick_init(void)
 {
-    // Tick interface for LVGL (using esp_timer to generate 2ms periodic event)
-    const esp_timer_create_args_t lvgl_tick_timer_args = {
-        .callback = &lvgl_port_tick_increment,
-        .name = "LVGL tick",
-    };
-    ESP_RETURN_ON_ERROR(esp_timer_create(&lvgl_tick_timer_args, &lvgl_port_ctx.tick_timer), TAG, "Creating LVGL timer filed!");
-    return esp_timer_start_periodic(lvgl_port_ctx.tick_timer, lvgl_port_ctx.timer_period_ms * 1000);
+    /* LVGL reads the time when it needs it, there is no periodic timer waking the chip and no timer ISR load */
+    lv_tick_set_cb(lvgl_port_tick_get);
+    return ESP_OK;
+}
+
+static void lvgl_port_tick_pause(void)
+{
+    /* Nothing to stop, only the task waits for wake-up */
+    lvgl_port_ctx.tick_paused = true;
+}
+
+static void lvgl_port_tick_catch_up(void)
+{
+    /* The tick is always valid, the task only stops waiting for wake-up */
+    lvgl_port_ctx.tick_paused = false;
+}
+
+static esp_err_t lvgl_port_pm_init(const lvgl_port_cfg_t *cfg)
+{
+    lvgl_port_pm_t *pm = &lvgl_port_ctx.pm;
+    pm->used = true;
+    pm->governor = cfg->flags.pm_governor;
+    pm->level = (pm->governor ? LVGL_PORT_PM_LEVEL_LOW : LVGL_PORT_PM_LEVEL_HIGH);
+    pm->cur = LVGL_PORT_PM_LEVEL_IDLE;
+    pm->mark = esp_timer_get_time();
+    pm->frame_us = (cfg->pm_frame_ms > 0 ? cfg->pm_frame_ms : LV_DEF_REFR_PERIOD) * 1000;
+
+#if CONFIG_PM_ENABLE
+    ESP_RETURN_ON_ERROR(esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "lvgl_render", &lvgl_port_ctx.pm_cpu_lock), TAG, "CPU lock");
+    ESP_RETURN_ON_ERROR(esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "lvgl_flush", &lvgl_port_ctx.pm_apb_lock), TAG, "APB lock");
+    if (pm->governor) {
+        ESP_RETURN_ON_ERROR(esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "lvgl_render_low", &lvgl_port_ctx.pm_low_lock), TAG, "Render APB lock");
+    }
+    return ESP_OK;
+#else
+    ESP_LOGW(TAG, "CONFIG_PM_ENABLE is not set, PM locks are not used");
+    return ESP_OK;
+#endif
+}
+
+static void lvgl_port_pm_deinit(void)
+{
+#if CONFIG_PM_ENABLE
+    if (lvgl_port_ctx.pm_cpu_lock) {
+        esp_pm_lock_delete(lvgl_port_ctx.pm_cpu_lock);
+    }
+    if (lvgl_port_ctx.pm_apb_lock) {
+        esp_pm_lock_delete(lvgl_port_ctx.pm_apb_lock);
+    }
+    if (lvgl_port_ctx.pm_low_lock) {
+        esp_pm_lock_delete(lvgl_port_ctx.pm_low_lock);
+    }
+#endif
+}
+
+/* Switch the accounted level, the caller holds lvgl_port_stats_lock */
+static void lvgl_port_pm_account(lvgl_port_pm_level_t level, int64_t now)
+{
+    lvgl_port_pm_t *pm = &lvgl_port_ctx.pm;
+    pm->stats.time_us[pm->cur] += now - pm->mark;
+    pm->mark = now;
+    pm->cur = level;
+}
+
+/* Hold HIGH level for a while, the next frames are expected to be demanding */
+static void lvgl_port_pm_hold(int64_t now)
+{
+    lvgl_port_pm_t *pm = &lvgl_port_ctx.pm;
+    if (now >= pm->hold_until && pm->level != LVGL_PORT_PM_LEVEL_HIGH) {
+        pm->stats.boosts++;
+    }
+    pm->hold_until = now + ESP_LVGL_PORT_PM_HOLD_MS * 1000;
+}
+
+static lvgl_port_pm_level_t lvgl_port_pm_work_start(uint32_t events)
+{
+    lvgl_port_pm_t *pm = &lvgl_port_ctx.pm;
+    if (!pm->used) {
+        return LVGL_PORT_PM_LEVEL_IDLE;
+    }
+
+    const int64_t now = esp_timer_get_time();
+    const uint32_t anim_cnt = (pm->governor ? lv_anim_count_running() : 0);
+    portENTER_CRITICAL(&lvgl_port_stats_lock);
+    if (pm->governor) {
+        /* Input events and new animations raise the frequency before their frames are rendered */
+        if ((events & ~(ESP_LVGL_PORT_WAKE_DISPLAY | ESP_LVGL_PORT_WAKE_USER)) || anim_cnt > pm->anim_cnt) {
+            lvgl_port_pm_hold(now);
+        }
+        pm->anim_cnt = anim_cnt;
+    }
+    const lvgl_port_pm_level_t level = (now < pm->hold_until ? LVGL_PORT_PM_LEVEL_HIGH : pm->level);
+    lvgl_port_pm_account(level, now);
+    portEXIT_CRITICAL(&lvgl_port_stats_lock);
+    pm->frame_max = 0;
+
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_handle_t lock = (level == LVGL_PORT_PM_LEVEL_HIGH ? lvgl_port_ctx.pm_cpu_lock : lvgl_port_ctx.pm_low_lock);
+    if (lock) {
+        esp_pm_lock_acquire(lock);
+    }
+#endif
+    return level;
+}
+
+static void lvgl_port_pm_work_end(lvgl_port_pm_level_t level)
+{
+    lvgl_port_pm_t *pm = &lvgl_port_ctx.pm;
+    if (level == LVGL_PORT_PM_LEVEL_IDLE) {
+        return;
+    }
+
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_handle_t lock = (level == LVGL_PORT_PM_LEVEL_HIGH ? lvgl_port_ctx.pm_cpu_lock : lvgl_port_ctx.pm_low_lock);
+    if (lock) {
+        esp_pm_lock_release(lock);
+    }
+#endif
+
+    const int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&lvgl_port_stats_lock);
+    lvgl_port_pm_account(LVGL_PORT_PM_LEVEL_IDLE, now);
+    if (pm->frame_max > pm->frame_us) {
+        pm->stats.missed++;
+    }
+    if (pm->governor && pm->frame_max > 0) {
+        if (level == LVGL_PORT_PM_LEVEL_LOW && pm->frame_max * ESP_LVGL_PORT_PM_BOOST_DEN > pm->frame_us * ESP_LVGL_PORT_PM_BOOST_NUM) {
+            /* Close to the deadline, the next frames are rendered at CPU max */
+            pm->level = LVGL_PORT_PM_LEVEL_HIGH;
+            pm->fast_cnt = 0;
+            pm->stats.boosts++;
+        } else if (pm->level == LVGL_PORT_PM_LEVEL_HIGH && level == LVGL_PORT_PM_LEVEL_HIGH) {
+            /* The frame would fit into the period also at lower frequency (APB max is at least 1/3 of CPU max) */
+            pm->fast_cnt = (pm->frame_max * ESP_LVGL_PORT_PM_DROP_DEN < pm->frame_us ? pm->fast_cnt + 1 : 0);
+            if (pm->fast_cnt >= ESP_LVGL_PORT_PM_DROP_FRAMES) {
+                pm->level = LVGL_PORT_PM_LEVEL_LOW;
+                pm->fast_cnt = 0;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&lvgl_port_stats_lock);
+}
+
+void lvgl_port_pm_frame_done(uint32_t render_time)
+{
+    lvgl_port_pm_t *pm = &lvgl_port_ctx.pm;
+    /* Frames refreshed outside of the LVGL task work (lv_refr_now) are not counted */
+    if (!pm->used || pm->cur == LVGL_PORT_PM_LEVEL_IDLE) {
+        return;
+    }
+
+    pm->frame_max = LV_MAX(pm->frame_max, render_time);
+    portENTER_CRITICAL(&lvgl_port_stats_lock);
+    pm->stats.frames[pm->cur]++;
+    portEXIT_CRITICAL(&lvgl_port_stats_lock);
+}
+
+void lvgl_port_pm_flush_acquire(void)
+{
+#if CONFIG_PM_ENABLE
+    if (lvgl_port_ctx.pm_apb_lock) {
+        esp_pm_lock_acquire(lvgl_port_ctx.pm_apb_lock);
+    }
+#endif
+}
+
+void lvgl_port_pm_flush_release(void)
+{
+#if CONFIG_PM_ENABLE
+    if (lvgl_port_ctx.pm_apb_lock) {
+        esp_pm_lock_release(lvgl_port_ctx.pm_apb_lock);
+    }
+#endif
 }
@@ -0,0 +1,68 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_lvgl_port.h"
+
+static const char *TAG = "LVGL";
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t lvgl_port_atlas_get(const lvgl_port_atlas_t *atlas, uint32_t index, lv_image_dsc_t *ret_dsc)
+{
+    ESP_RETURN_ON_FALSE(atlas && atlas->image && atlas->rects && ret_dsc, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments!");
+    ESP_RETURN_ON_FALSE(index < atlas->count, ESP_ERR_INVALID_ARG, TAG, "Sub-image %"PRIu32" is not in the atlas!", index);
+
+    const lv_image_header_t *header = &atlas->image->header;
+    const uint32_t bpp = lv_color_format_get_bpp(header->cf);
+    /* Sub-image must be addressable by the atlas stride: whole bytes per pixel, one plane, no palette */
+    ESP_RETURN_ON_FALSE(bpp >= 8 && (bpp % 8) == 0 && !LV_COLOR_FORMAT_IS_INDEXED(header->cf) && header->cf != LV_COLOR_FORMAT_RGB565A8 &&
+                        !(header->flags & LV_IMAGE_FLAGS_COMPRESSED), ESP_ERR_NOT_SUPPORTED, TAG, "Color format of the atlas does not allow sub-images!");
+
+    const lvgl_port_atlas_rect_t *rect = &atlas->rects[index];
+    ESP_RETURN_ON_FALSE(rect->w > 0 && rect->h > 0 && rect->x + rect->w <= header->w && rect->y + rect->h <= header->h,
+                        ESP_ERR_INVALID_ARG, TAG, "Sub-image %s is out of the atlas!", rect->name);
+    const uint32_t stride = header->stride ? header->stride : lv_draw_buf_width_to_stride(header->w, header->cf);
+
+    memset(ret_dsc, 0, sizeof(lv_image_dsc_t));
+    ret_dsc->header = *header;
+    ret_dsc->header.w = rect->w;
+    ret_dsc->header.h = rect->h;
+    ret_dsc->header.stride = stride;
+    ret_dsc->data = atlas->image->data + (size_t)rect->y * stride + (size_t)rect->x * (bpp / 8);
+    /* The last row ends at the sub-image width, not at the stride */
+    ret_dsc->data_size = (uint32_t)(rect->h - 1) * stride + (uint32_t)rect->w * (bpp / 8);
+    return ESP_OK;
+}
+
+int32_t lvgl_port_atlas_find(const lvgl_port_atlas_t *atlas, const char *name)
+{
+    if (atlas == NULL || atlas->rects == NULL || name == NULL) {
+        return -1;
+    }
+
+    /* Sub-images are sorted by name by the generator */
+    int32_t low = 0;
+    int32_t high = (int32_t)atlas->count - 1;
+    while (low <= high) {
+        const int32_t mid = low + (high - low) / 2;
+        const int cmp = strcmp(name, atlas->rects[mid].name);
+        if (cmp == 0) {
+            return mid;
+        } else if (cmp < 0) {
+            high = mid - 1;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,166 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_lvgl_port.h"
+
+static const char *TAG = "LVGL";
+
+/* Maximum length of the formatted text */
+#define LVGL_PORT_BIND_TEXT_LEN     (128)
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+struct lvgl_port_bind_s {
+    lvgl_port_bind_cfg_t cfg;           /* Configuration (format is owned by the application) */
+    float               values[LVGL_PORT_BIND_VALUES_MAX];  /* Last set values */
+    float               applied[LVGL_PORT_BIND_VALUES_MAX]; /* Values of the last formatting */
+    bool                dirty;          /* Values changed more than epsilon since the last formatting */
+    struct lvgl_port_bind_s *next;
+};
+
+/*******************************************************************************
+* Local variables
+*******************************************************************************/
+
+/* Bindings are linked and formatted with LVGL lock, values are protected by the spinlock */
+static struct lvgl_port_bind_s *lvgl_port_binds;
+static bool lvgl_port_bind_pending;
+static portMUX_TYPE lvgl_port_bind_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/*******************************************************************************
+* Function definitions
+*******************************************************************************/
+
+static void lvgl_port_bind_apply(void *user_data);
+static void lvgl_port_bind_label_deleted(lv_event_t *e);
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t lvgl_port_bind_create(const lvgl_port_bind_cfg_t *cfg, lvgl_port_bind_handle_t *ret_handle)
+{
+    ESP_RETURN_ON_FALSE(cfg && cfg->label && cfg->fmt && ret_handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments!");
+    ESP_RETURN_ON_FALSE(cfg->value_count > 0 && cfg->value_count <= LVGL_PORT_BIND_VALUES_MAX, ESP_ERR_INVALID_ARG, TAG, "Invalid value count!");
+
+    lvgl_port_bind_handle_t bind = calloc(1, sizeof(struct lvgl_port_bind_s));
+    ESP_RETURN_ON_FALSE(bind, ESP_ERR_NO_MEM, TAG, "Not enough memory for value binding!");
+    bind->cfg = *cfg;
+    /* The first set is always formatted */
+    for (int i = 0; i < LVGL_PORT_BIND_VALUES_MAX; i++) {
+        bind->applied[i] = NAN;
+    }
+
+    lvgl_port_lock(0);
+    lv_obj_add_event_cb(cfg->label, lvgl_port_bind_label_deleted, LV_EVENT_DELETE, bind);
+    bind->next = lvgl_port_binds;
+    lvgl_port_binds = bind;
+    lvgl_port_unlock();
+
+    *ret_handle = bind;
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_bind_set(lvgl_port_bind_handle_t handle, const float *values, uint32_t count)
+{
+    ESP_RETURN_ON_FALSE(handle && values && count <= handle->cfg.value_count, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments!");
+
+    bool schedule = false;
+    portENTER_CRITICAL(&lvgl_port_bind_lock);
+    for (uint32_t i = 0; i < count; i++) {
+        handle->values[i] = values[i];
+        /* NaN in applied values (nothing shown yet) always differs */
+        if (!(fabsf(values[i] - handle->applied[i]) < handle->cfg.epsilon) && values[i] != handle->applied[i]) {
+            handle->dirty = true;
+        }
+    }
+    /* One formatting in LVGL task for all values set before the next frame */
+    if (handle->dirty && !lvgl_port_bind_pending) {
+        lvgl_port_bind_pending = true;
+        schedule = true;
+    }
+    portEXIT_CRITICAL(&lvgl_port_bind_lock);
+
+    if (schedule && lvgl_port_async_call(lvgl_port_bind_apply, NULL) != ESP_OK) {
+        /* Too many pending calls, the next set tries again */
+        portENTER_CRITICAL(&lvgl_port_bind_lock);
+        lvgl_port_bind_pending = false;
+        portEXIT_CRITICAL(&lvgl_port_bind_lock);
+    }
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_bind_delete(lvgl_port_bind_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments!");
+
+    lvgl_port_lock(0);
+    for (struct lvgl_port_bind_s **it = &lvgl_port_binds; *it != NULL; it = &(*it)->next) {
+        if (*it == handle) {
+            *it = handle->next;
+            break;
+        }
+    }
+    if (handle->cfg.label) {
+        lv_obj_remove_event_cb_with_user_data(handle->cfg.label, lvgl_port_bind_label_deleted, handle);
+    }
+    lvgl_port_unlock();
+
+    free(handle);
+    return ESP_OK;
+}
+
+/*******************************************************************************
+* Private functions
+*******************************************************************************/
+
+/* Called in LVGL task with LVGL lock taken */
+static void lvgl_port_bind_apply(void *user_data)
+{
+    char text[LVGL_PORT_BIND_TEXT_LEN];
+
+    portENTER_CRITICAL(&lvgl_port_bind_lock);
+    lvgl_port_bind_pending = false;
+    portEXIT_CRITICAL(&lvgl_port_bind_lock);
+
+    for (struct lvgl_port_bind_s *bind = lvgl_port_binds; bind != NULL; bind = bind->next) {
+        float v[LVGL_PORT_BIND_VALUES_MAX];
+        portENTER_CRITICAL(&lvgl_port_bind_lock);
+        const bool dirty = bind->dirty;
+        if (dirty) {
+            memcpy(v, bind->values, sizeof(v));
+            memcpy(bind->applied, bind->values, sizeof(v));
+            bind->dirty = false;
+        }
+        portEXIT_CRITICAL(&lvgl_port_bind_lock);
+        if (!dirty || bind->cfg.label == NULL) {
+            continue;
+        }
+
+        /* Unused values are ignored by the format, only the visible change invalidates the label.
+         * The libc formatting is used, LVGL sprintf may be built without float support. */
+        snprintf(text, sizeof(text), bind->cfg.fmt, (double)v[0], (double)v[1], (double)v[2], (double)v[3]);
+        if (strcmp(text, lv_label_get_text(bind->cfg.label)) != 0) {
+            lv_label_set_text(bind->cfg.label, text);
+        }
+    }
+}
+
+static void lvgl_port_bind_label_deleted(lv_event_t *e)
+{
+    lvgl_port_bind_handle_t bind = (lvgl_port_bind_handle_t)lv_event_get_user_data(e);
+    bind->cfg.label = NULL;
+}
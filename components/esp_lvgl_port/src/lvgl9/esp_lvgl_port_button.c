@@ -7,10 +7,15 @@
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_check.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
 #include "esp_lvgl_port.h"
 
 static const char *TAG = "LVGL";
 
+/* Default debounce time of buttons read by GPIO interrupt [ms] */
+#define LVGL_PORT_NAV_BTN_DEBOUNCE_MS   (20)
+
 /*******************************************************************************
 * Types definitions
 *******************************************************************************/
@@ -22,8 +27,20 @@ typedef enum {
     LVGL_PORT_NAV_BTN_CNT,
 } lvgl_port_nav_btns_t;
 
+struct lvgl_port_nav_btns_ctx_s;
+
 typedef struct {
+    struct lvgl_port_nav_btns_ctx_s *ctx;   /* Buttons context */
+    lvgl_port_nav_btns_t id;                /* Button */
+    int32_t gpio_num;                       /* GPIO number (-1 when the button is not read by GPIO interrupt) */
+    uint8_t active_level;                   /* GPIO level of pressed button */
+    esp_timer_handle_t debounce_timer;      /* Timer for debouncing after GPIO edge */
+} lvgl_port_nav_btn_gpio_t;
+
+typedef struct lvgl_port_nav_btns_ctx_s {
     button_handle_t btn[LVGL_PORT_NAV_BTN_CNT];     /* Button handlers */
+    lvgl_port_nav_btn_gpio_t gpio[LVGL_PORT_NAV_BTN_CNT]; /* Buttons read by GPIO interrupt */
+    uint32_t debounce_us;                           /* Debounce time of buttons read by GPIO interrupt */
     lv_indev_t      *indev;  /* LVGL input device driver */
     bool btn_prev; /* Button prev state */
     bool btn_next; /* Button next state */
@@ -37,6 +54,8 @@ typedef struct {
 static void lvgl_port_navigation_buttons_read(lv_indev_t *indev_drv, lv_indev_data_t *data);
 static void lvgl_port_btn_down_handler(void *arg, void *arg2);
 static void lvgl_port_btn_up_handler(void *arg, void *arg2);
+static esp_err_t lvgl_port_btn_gpio_init(lvgl_port_nav_btns_ctx_t *ctx, lvgl_port_nav_btns_t id, const button_config_t *cfg);
+static void lvgl_port_btn_gpio_deinit(lvgl_port_nav_btn_gpio_t *btn);
 
 /*******************************************************************************
 * Public API functions
@@ -50,39 +69,42 @@ lv_indev_t *lvgl_port_add_navigation_buttons(const lvgl_port_nav_btns_cfg_t *but
     assert(buttons_cfg->disp != NULL);
 
     /* Touch context */
-    lvgl_port_nav_btns_ctx_t *buttons_ctx = malloc(sizeof(lvgl_port_nav_btns_ctx_t));
+    lvgl_port_nav_btns_ctx_t *buttons_ctx = calloc(1, sizeof(lvgl_port_nav_btns_ctx_t));
     if (buttons_ctx == NULL) {
         ESP_LOGE(TAG, "Not enough memory for buttons context allocation!");
         return NULL;
     }
 
-    /* Previous button */
-    if (buttons_cfg->button_prev != NULL) {
-        buttons_ctx->btn[LVGL_PORT_NAV_BTN_PREV] = iot_button_create(buttons_cfg->button_prev);
-        ESP_GOTO_ON_FALSE(buttons_ctx->btn[LVGL_PORT_NAV_BTN_PREV], ESP_ERR_NO_MEM, err, TAG, "Not enough memory for button create!");
-    }
-
-    /* Next button */
-    if (buttons_cfg->button_next != NULL) {
-        buttons_ctx->btn[LVGL_PORT_NAV_BTN_NEXT] = iot_button_create(buttons_cfg->button_next);
-        ESP_GOTO_ON_FALSE(buttons_ctx->btn[LVGL_PORT_NAV_BTN_NEXT], ESP_ERR_NO_MEM, err, TAG, "Not enough memory for button create!");
+    buttons_ctx->debounce_us = (buttons_cfg->debounce_ms ? buttons_cfg->debounce_ms : LVGL_PORT_NAV_BTN_DEBOUNCE_MS) * 1000;
+    for (int i = 0; i < LVGL_PORT_NAV_BTN_CNT; i++) {
+        buttons_ctx->gpio[i].gpio_num = -1;
     }
 
-    /* Enter button */
-    if (buttons_cfg->button_enter != NULL) {
-        buttons_ctx->btn[LVGL_PORT_NAV_BTN_ENTER] = iot_button_create(buttons_cfg->button_enter);
-        ESP_GOTO_ON_FALSE(buttons_ctx->btn[LVGL_PORT_NAV_BTN_ENTER], ESP_ERR_NO_MEM, err, TAG, "Not enough memory for button create!");
-    }
+    const button_config_t *btn_cfg[LVGL_PORT_NAV_BTN_CNT] = {
+        [LVGL_PORT_NAV_BTN_PREV] = buttons_cfg->button_prev,
+        [LVGL_PORT_NAV_BTN_NEXT] = buttons_cfg->button_next,
+        [LVGL_PORT_NAV_BTN_ENTER] = buttons_cfg->button_enter,
+    };
 
-    /* Button handlers */
     for (int i = 0; i < LVGL_PORT_NAV_BTN_CNT; i++) {
-        ESP_ERROR_CHECK(iot_button_register_cb(buttons_ctx->btn[i], BUTTON_PRESS_DOWN, lvgl_port_btn_down_handler, buttons_ctx));
-        ESP_ERROR_CHECK(iot_button_register_cb(buttons_ctx->btn[i], BUTTON_PRESS_UP, lvgl_port_btn_up_handler, buttons_ctx));
-    }
+        if (btn_cfg[i] == NULL) {
+            continue;
+        }
+
+        /* GPIO buttons with edge interrupt, no periodic scanning is needed */
+        if (buttons_cfg->flags.gpio_interrupt && btn_cfg[i]->type == BUTTON_TYPE_GPIO) {
+            ESP_GOTO_ON_ERROR(lvgl_port_btn_gpio_init(buttons_ctx, i, btn_cfg[i]), err, TAG, "GPIO button init failed!");
+            continue;
+        }
+
+        /* Other buttons (ADC...) are scanned by button component */
+        buttons_ctx->btn[i] = iot_button_create(btn_cfg[i]);
+        ESP_GOTO_ON_FALSE(buttons_ctx->btn[i], ESP_ERR_NO_MEM, err, TAG, "Not enough memory for button create!");
 
-    buttons_ctx->btn_prev = false;
-    buttons_ctx->btn_next = false;
-    buttons_ctx->btn_enter = false;
+        /* Button handlers */
+        ESP_GOTO_ON_ERROR(iot_button_register_cb(buttons_ctx->btn[i], BUTTON_PRESS_DOWN, lvgl_port_btn_down_handler, buttons_ctx), err, TAG, "Button callback register failed!");
+        ESP_GOTO_ON_ERROR(iot_button_register_cb(buttons_ctx->btn[i], BUTTON_PRESS_UP, lvgl_port_btn_up_handler, buttons_ctx), err, TAG, "Button callback register failed!");
+    }
 
     lvgl_port_lock(0);
     /* Register a touchpad input device */
@@ -104,6 +126,7 @@ err:
             if (buttons_ctx->btn[i] != NULL) {
                 iot_button_delete(buttons_ctx->btn[i]);
             }
+            lvgl_port_btn_gpio_deinit(&buttons_ctx->gpio[i]);
         }
 
         if (buttons_ctx != NULL) {
@@ -125,6 +148,12 @@ esp_err_t lvgl_port_remove_navigation_buttons(lv_indev_t *buttons)
     lvgl_port_unlock();
 
     if (buttons_ctx) {
+        for (int i = 0; i < LVGL_PORT_NAV_BTN_CNT; i++) {
+            if (buttons_ctx->btn[i] != NULL) {
+                iot_button_delete(buttons_ctx->btn[i]);
+            }
+            lvgl_port_btn_gpio_deinit(&buttons_ctx->gpio[i]);
+        }
         free(buttons_ctx);
     }
 
@@ -208,3 +237,126 @@ static void lvgl_port_btn_up_handler(void *arg, void *arg2)
     /* Wake LVGL task, if needed */
     lvgl_port_task_wake(LVGL_PORT_EVENT_TOUCH, ctx->indev);
 }
+
+static void lvgl_port_btn_set_state(lvgl_port_nav_btns_ctx_t *ctx, lvgl_port_nav_btns_t id, bool pressed)
+{
+    switch (id) {
+    case LVGL_PORT_NAV_BTN_PREV:
+        ctx->btn_prev = pressed;
+        break;
+    case LVGL_PORT_NAV_BTN_NEXT:
+        ctx->btn_next = pressed;
+        break;
+    case LVGL_PORT_NAV_BTN_ENTER:
+        ctx->btn_enter = pressed;
+        break;
+    default:
+        break;
+    }
+}
+
+static bool lvgl_port_btn_get_state(lvgl_port_nav_btns_ctx_t *ctx, lvgl_port_nav_btns_t id)
+{
+    switch (id) {
+    case LVGL_PORT_NAV_BTN_PREV:
+        return ctx->btn_prev;
+    case LVGL_PORT_NAV_BTN_NEXT:
+        return ctx->btn_next;
+    case LVGL_PORT_NAV_BTN_ENTER:
+        return ctx->btn_enter;
+    default:
+        return false;
+    }
+}
+
+static void lvgl_port_btn_gpio_isr(void *arg)
+{
+    lvgl_port_nav_btn_gpio_t *btn = (lvgl_port_nav_btn_gpio_t *)arg;
+
+    /* Bouncing edges are ignored, the level is read after debounce time */
+    gpio_intr_disable(btn->gpio_num);
+    esp_timer_start_once(btn->debounce_timer, btn->ctx->debounce_us);
+}
+
+static void lvgl_port_btn_gpio_debounce_cb(void *arg)
+{
+    lvgl_port_nav_btn_gpio_t *btn = (lvgl_port_nav_btn_gpio_t *)arg;
+    lvgl_port_nav_btns_ctx_t *ctx = btn->ctx;
+
+    const bool pressed = (gpio_get_level(btn->gpio_num) == btn->active_level);
+    const bool changed = (pressed != lvgl_port_btn_get_state(ctx, btn->id));
+    lvgl_port_btn_set_state(ctx, btn->id, pressed);
+    gpio_intr_enable(btn->gpio_num);
+
+    /* The level could be changed, while the interrupt was disabled */
+    if ((gpio_get_level(btn->gpio_num) == btn->active_level) != pressed) {
+        gpio_intr_disable(btn->gpio_num);
+        esp_timer_start_once(btn->debounce_timer, ctx->debounce_us);
+    }
+
+    if (changed) {
+        /* Wake LVGL task, if needed */
+        lvgl_port_task_wake(LVGL_PORT_EVENT_TOUCH, ctx->indev);
+    }
+}
+
+static esp_err_t lvgl_port_btn_gpio_init(lvgl_port_nav_btns_ctx_t *ctx, lvgl_port_nav_btns_t id, const button_config_t *cfg)
+{
+    esp_err_t ret = ESP_OK;
+    lvgl_port_nav_btn_gpio_t *btn = &ctx->gpio[id];
+    const int32_t gpio_num = cfg->gpio_button_config.gpio_num;
+    const uint8_t active_level = cfg->gpio_button_config.active_level;
+
+    ESP_RETURN_ON_FALSE(GPIO_IS_VALID_GPIO(gpio_num), ESP_ERR_INVALID_ARG, TAG, "Invalid button GPIO!");
+
+    btn->ctx = ctx;
+    btn->id = id;
+    btn->active_level = active_level;
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = lvgl_port_btn_gpio_debounce_cb,
+        .arg = btn,
+        .name = "LVGL btn debounce",
+    };
+    ESP_RETURN_ON_ERROR(esp_timer_create(&timer_args, &btn->debounce_timer), TAG, "Creating debounce timer failed!");
+
+    const gpio_config_t gpio_cfg = {
+        .pin_bit_mask = BIT64(gpio_num),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = (active_level ? GPIO_PULLUP_DISABLE : GPIO_PULLUP_ENABLE),
+        .pull_down_en = (active_level ? GPIO_PULLDOWN_ENABLE : GPIO_PULLDOWN_DISABLE),
+        .intr_type = GPIO_INTR_ANYEDGE,
+    };
+    ESP_GOTO_ON_ERROR(gpio_config(&gpio_cfg), err, TAG, "GPIO config failed!");
+
+    /* ISR service can be already installed by application or other component */
+    ret = gpio_install_isr_service(0);
+    ESP_GOTO_ON_FALSE(ret == ESP_OK || ret == ESP_ERR_INVALID_STATE, ret, err, TAG, "GPIO ISR service install failed!");
+    ESP_GOTO_ON_ERROR(gpio_isr_handler_add(gpio_num, lvgl_port_btn_gpio_isr, btn), err, TAG, "GPIO ISR handler add failed!");
+    btn->gpio_num = gpio_num;
+
+    /* Initial state */
+    lvgl_port_btn_set_state(ctx, id, gpio_get_level(gpio_num) == active_level);
+
+    return ESP_OK;
+
+err:
+    gpio_reset_pin(gpio_num);
+    esp_timer_delete(btn->debounce_timer);
+    btn->debounce_timer = NULL;
+    return ret;
+}
+
+static void lvgl_port_btn_gpio_deinit(lvgl_port_nav_btn_gpio_t *btn)
+{
+    if (btn->gpio_num >= 0) {
+        gpio_isr_handler_remove(btn->gpio_num);
+        gpio_reset_pin(btn->gpio_num);
+        btn->gpio_num = -1;
+    }
+    if (btn->debounce_timer) {
+        esp_timer_stop(btn->debounce_timer);
+        esp_timer_delete(btn->debounce_timer);
+        btn->debounce_timer = NULL;
+    }
+}
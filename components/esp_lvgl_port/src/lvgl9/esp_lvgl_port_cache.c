@@ -0,0 +1,170 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_lvgl_port.h"
+
+static const char *TAG = "LVGL";
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+struct lvgl_port_cache_s {
+    lv_obj_t            *obj;       /* Root of the cached subtree (hidden) */
+    lv_obj_t            *img;       /* Image showing the cached pixels on place of the subtree */
+    lv_color_format_t   cf;         /* Color format of the cached pixels */
+    uint32_t            caps;       /* Memory capabilities of the cached pixels */
+    lv_draw_buf_t       draw_buf;   /* Cached pixels */
+    void                *data;      /* Allocated memory of the cached pixels */
+    uint32_t            data_size;  /* Size of the allocated memory */
+};
+
+/*******************************************************************************
+* Function definitions
+*******************************************************************************/
+
+static esp_err_t lvgl_port_cache_render(lvgl_port_cache_handle_t cache);
+static void lvgl_port_cache_free(lvgl_port_cache_handle_t cache);
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t lvgl_port_cache_create(const lvgl_port_cache_cfg_t *cache_cfg, lvgl_port_cache_handle_t *ret_cache)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(cache_cfg && cache_cfg->obj && ret_cache, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments!");
+#if !LV_USE_SNAPSHOT
+    ESP_RETURN_ON_FALSE(false, ESP_ERR_NOT_SUPPORTED, TAG, "Layer cache needs LV_USE_SNAPSHOT enabled in LVGL!");
+#endif
+
+    lvgl_port_cache_handle_t cache = calloc(1, sizeof(struct lvgl_port_cache_s));
+    ESP_RETURN_ON_FALSE(cache, ESP_ERR_NO_MEM, TAG, "Not enough memory for layer cache allocation!");
+
+    lvgl_port_lock(0);
+    lv_obj_t *parent = lv_obj_get_parent(cache_cfg->obj);
+    ESP_GOTO_ON_FALSE(parent, ESP_ERR_INVALID_ARG, err, TAG, "Screen cannot be cached, use a child object!");
+
+    cache->obj = cache_cfg->obj;
+    cache->caps = (cache_cfg->flags.buff_spiram ? MALLOC_CAP_SPIRAM : MALLOC_CAP_INTERNAL) | MALLOC_CAP_8BIT;
+    cache->cf = cache_cfg->color_format;
+    if (cache->cf == LV_COLOR_FORMAT_UNKNOWN) {
+        cache->cf = lv_display_get_color_format(lv_obj_get_display(cache->obj));
+    }
+
+    /* The image takes the place of the subtree in the order of children, so it is covered by the same siblings */
+    cache->img = lv_image_create(parent);
+    ESP_GOTO_ON_FALSE(cache->img, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for layer cache image!");
+    lv_obj_add_flag(cache->img, LV_OBJ_FLAG_IGNORE_LAYOUT | LV_OBJ_FLAG_FLOATING);
+    lv_obj_remove_flag(cache->img, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_move_to_index(cache->img, lv_obj_get_index(cache->obj));
+
+    ESP_GOTO_ON_ERROR(lvgl_port_cache_render(cache), err, TAG, "Layer cache render failed!");
+    lvgl_port_unlock();
+
+    *ret_cache = cache;
+    return ESP_OK;
+
+err:
+    lvgl_port_cache_free(cache);
+    lvgl_port_unlock();
+    return ret;
+}
+
+esp_err_t lvgl_port_cache_update(lvgl_port_cache_handle_t cache)
+{
+    esp_err_t ret;
+    ESP_RETURN_ON_FALSE(cache, ESP_ERR_INVALID_ARG, TAG, "Invalid layer cache!");
+
+    lvgl_port_lock(0);
+    ret = lvgl_port_cache_render(cache);
+    lvgl_port_unlock();
+
+    return ret;
+}
+
+esp_err_t lvgl_port_cache_delete(lvgl_port_cache_handle_t cache)
+{
+    ESP_RETURN_ON_FALSE(cache, ESP_ERR_INVALID_ARG, TAG, "Invalid layer cache!");
+
+    lvgl_port_lock(0);
+    lvgl_port_cache_free(cache);
+    lvgl_port_unlock();
+
+    return ESP_OK;
+}
+
+/*******************************************************************************
+* Private functions
+*******************************************************************************/
+
+static esp_err_t lvgl_port_cache_render(lvgl_port_cache_handle_t cache)
+{
+#if LV_USE_SNAPSHOT
+    esp_err_t ret = ESP_OK;
+
+    /* Hidden objects are not rendered into the snapshot */
+    lv_obj_remove_flag(cache->obj, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_update_layout(cache->obj);
+
+    /* Snapshot contains also the extra draw area (e.g. shadow) */
+    const int32_t ext = lv_obj_get_ext_draw_size(cache->obj);
+    const int32_t w = lv_obj_get_width(cache->obj) + ext * 2;
+    const int32_t h = lv_obj_get_height(cache->obj) + ext * 2;
+    const uint32_t stride = lv_draw_buf_width_to_stride(w, cache->cf);
+    const uint32_t size = stride * h;
+
+    /* The old pixels could be in the image cache of LVGL */
+    lv_image_cache_drop(&cache->draw_buf);
+    if (size > cache->data_size) {
+        lv_image_set_src(cache->img, NULL);
+        heap_caps_free(cache->data);
+        cache->data_size = 0;
+        cache->data = heap_caps_aligned_alloc(LV_DRAW_BUF_ALIGN, size, cache->caps);
+        ESP_GOTO_ON_FALSE(cache->data, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for layer cache pixels (%"PRIu32" bytes)!", size);
+        cache->data_size = size;
+    }
+
+    ESP_GOTO_ON_FALSE(lv_draw_buf_init(&cache->draw_buf, w, h, cache->cf, stride, cache->data, size) == LV_RESULT_OK, ESP_ERR_INVALID_ARG, err, TAG, "Invalid layer cache buffer!");
+    ESP_GOTO_ON_FALSE(lv_snapshot_take_to_draw_buf(cache->obj, cache->cf, &cache->draw_buf) == LV_RESULT_OK, ESP_ERR_INVALID_STATE, err, TAG, "Layer cache snapshot failed!");
+
+    lv_obj_set_pos(cache->img, lv_obj_get_x(cache->obj) - ext, lv_obj_get_y(cache->obj) - ext);
+    lv_image_set_src(cache->img, &cache->draw_buf);
+    lv_obj_invalidate(cache->img);
+
+    /* Subtree is shown from the cache only */
+    lv_obj_add_flag(cache->obj, LV_OBJ_FLAG_HIDDEN);
+    return ESP_OK;
+
+err:
+    /* Without cached pixels the subtree stays rendered as usual */
+    lv_image_set_src(cache->img, NULL);
+    return ret;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+static void lvgl_port_cache_free(lvgl_port_cache_handle_t cache)
+{
+    if (cache->img) {
+        lv_obj_delete(cache->img);
+    }
+    if (cache->obj) {
+        lv_obj_remove_flag(cache->obj, LV_OBJ_FLAG_HIDDEN);
+    }
+    if (cache->data) {
+        lv_image_cache_drop(&cache->draw_buf);
+        heap_caps_free(cache->data);
+    }
+    free(cache);
+}
@@ -12,6 +12,8 @@
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
 #include "esp_idf_version.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_ops.h"
@@ -22,8 +24,22 @@
 #include "esp_lcd_panel_rgb.h"
 #endif
 
+#if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0)
+#include "esp_async_memcpy.h"
+#include "esp_memory_utils.h"
+#include "esp_cache.h"
+#define LVGL_PORT_RGB_DMA_COPY_SUPPORTED 1
+#else
+#define LVGL_PORT_RGB_DMA_COPY_SUPPORTED 0
+#endif
+
 #if (CONFIG_IDF_TARGET_ESP32P4 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0))
 #include "esp_lcd_mipi_dsi.h"
+#include "esp_cache.h"
+#include "driver/ppa.h"
+#define LVGL_PORT_PPA_SUPPORTED 1
+#else
+#define LVGL_PORT_PPA_SUPPORTED 0
 #endif
 
 #if (ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(4, 4, 4)) || (ESP_IDF_VERSION == ESP_IDF_VERSION_VAL(5, 0, 0))
@@ -34,10 +50,42 @@
 
 static const char *TAG = "LVGL";
 
+/* Default stack size of the flush task */
+#define LVGL_PORT_FLUSH_TASK_STACK  (4096)
+
+/* Maximum number of transport buffers in flight */
+#define LVGL_PORT_TRANS_BUF_MAX     (4)
+
+/* Maximum number of draw buffers in ring (buffer_count) */
+#define LVGL_PORT_DRAW_RING_MAX     (4)
+
+/* Lines of one SW rotation strip without transport buffers (tile of the rotation kernel) */
+#define LVGL_PORT_ROT_STRIP_LINES   (16)
+
+/* Alignment of GDMA copy into RGB frame buffer in PSRAM (data cache line) */
+#define LVGL_PORT_RGB_DMA_COPY_ALIGN    (64)
+
+/* Maximum time of waiting for the last flush, when the display is parked */
+#define LVGL_PORT_PARK_FLUSH_WAIT_MS    (100)
+
+/* Period of LVGL refresh timer of the paced display, the refresh is started by LVGL task */
+#define LVGL_PORT_PACING_REFR_PERIOD    (UINT32_MAX / 2)
+
+/* Maximum time of waiting for the flush in progress, when the cursor overlay is moved */
+#define LVGL_PORT_CURSOR_WAIT_MS        (50)
+/* Polling period of the gap between display transfers for the touch on the shared SPI bus [us] */
+#define LVGL_PORT_BUS_POLL_US           (100)
+
 /*******************************************************************************
 * Types definitions
 *******************************************************************************/
 
+typedef struct {
+    lv_area_t                 area;         /* Flushed area */
+    uint8_t                   *color_map;   /* Rendered data (NULL: stop the flush task) */
+    TaskHandle_t              notify;       /* Task notified after stop of the flush task */
+} lvgl_port_flush_job_t;
+
 typedef struct {
     lvgl_port_disp_type_t     disp_type;    /* Display type */
     esp_lcd_panel_io_handle_t io_handle;      /* LCD panel IO handle */
@@ -47,32 +95,190 @@ typedef struct {
     lv_color_t                *draw_buffs[3]; /* Display draw buffers */
     lv_display_t              *disp_drv;      /* LVGL display driver */
     lv_display_rotation_t     current_rotation;
+    uint8_t                   *mono_prev;     /* Monochrome pages sent in the last frame (for sending only changed pages) */
+    bool                      mono_prev_valid; /* Content of mono_prev matches the screen */
+    size_t                    rot_buf_size;   /* Size of the rotation buffer draw_buffs[2] in bytes (allocated only when rotated) */
+    bool                      rot_strips;     /* SW rotation writes line strips into the transport buffers, rotation buffer is not used */
+    uint32_t                  rot_strip_size; /* Pixels of one rotation strip, when the transport buffers are allocated only while rotated */
+    uint32_t                  rot_buf_caps;   /* Memory capabilities of the rotation buffer */
+    uint32_t                  draw_buf_caps;  /* Memory capabilities of the draw buffers draw_buffs[0..1] */
+    size_t                    draw_buf_size;  /* Size of one draw buffer draw_buffs[0..1] in bytes */
+    bool                      draw_buf_double; /* Two draw buffers are used */
+    struct {
+        lv_color_t                *buf[LVGL_PORT_DRAW_RING_MAX]; /* Draw buffers of the ring (buf[0] is draw_buffs[0]) */
+        uint8_t                   cnt;        /* Number of draw buffers in the ring (0: not used) */
+        uint8_t                   idx;        /* Index of the buffer, which LVGL renders into */
+        SemaphoreHandle_t         sem;        /* Counting semaphore of free buffers (without the one LVGL renders into) */
+    } ring;
+    bool                      parked;         /* Panel is off, buffers can be released (lvgl_port_park) */
+    lv_color_t                *trans_buf[LVGL_PORT_TRANS_BUF_MAX]; /* Transport buffers (ring) send to driver */
+    uint32_t                  trans_size;     /* Maximum size for one transport in pixels */
+    size_t                    trans_buf_size; /* Size of one transport buffer in bytes */
+    uint8_t                   trans_cnt;      /* Number of allocated transport buffers */
+    uint8_t                   trans_idx;      /* Index of the transport buffer which will be filled next */
+    SemaphoreHandle_t         trans_sem;      /* Counting semaphore of free transport buffers */
+    uint16_t                  *clut;          /* RGB565 colors of L8 indexes, expanded into transport buffers (already swapped when swap_bytes) */
+    uint32_t                  merge_overhead; /* Cost of one transfer in pixels (0: areas are not merged) */
+    lv_area_t                 inv_areas[LV_INV_BUF_SIZE]; /* Areas invalidated since last refresh */
+    uint8_t                   inv_cnt;        /* Number of areas in inv_areas */
+    lvgl_port_disp_perf_t     perf;           /* Performance counters of the last frame */
+    lvgl_port_disp_perf_t     perf_cur;       /* Performance counters of the frame in progress */
+    int64_t                   perf_frame_start; /* Time of the frame start [us] */
+    int64_t                   perf_flush_start; /* Time of the last flush start [us] */
+    int64_t                   trans_busy_start; /* Time, when the first transport buffer in flight was queued [us] */
+    volatile uint32_t         vsync_cnt;      /* Number of RGB VSYNC interrupts */
+    uint32_t                  perf_vsync_start; /* vsync_cnt at the frame start */
+    uint64_t                  perf_lock_wait; /* Sum of LVGL lock waiting times at the frame start [us] */
+    uint32_t                  perf_lock_contended; /* Number of contended LVGL locks at the frame start */
+    lv_area_t                 trace_area;     /* Area of the flush in progress (lvgl_port_trace) */
+    TaskHandle_t              flush_task;     /* Flush task (flush_in_task) */
+    QueueHandle_t             flush_queue;    /* Areas to flush, processed by flush task */
+    lvgl_port_te_handle_t     te;             /* TE synchronization of the first flush in frame (te_sync) */
+    uint32_t                  round_size;     /* Diameter of the round display (round_mask, 0: not used) */
+    uint32_t                  refr_period;    /* Period of LVGL refresh timer of this display [ms] */
+    struct {
+        lv_obj_t                  *obj;       /* Container scrolled by hardware (NULL: not used) */
+        lvgl_port_hw_scroll_cfg_t cfg;        /* Scrolling functions of the LCD driver */
+        int32_t                   top;        /* First row of the scrolling area */
+        int32_t                   height;     /* Rows of the scrolling area */
+        int32_t                   offset;     /* Scrolling offset of the rendered content */
+        int32_t                   panel_offset; /* Scrolling offset set in the panel */
+        int32_t                   last_x;     /* Scroll position of the container in the last scroll event */
+        int32_t                   last_y;
+        int32_t                   moved;      /* Rows the content moved up since the last refresh (height: whole container is redrawn) */
+        bool                      inv_replace; /* Next invalidation of the whole container is replaced by the exposed rows */
+    } hw_scroll;
+    struct {
+        lvgl_port_low_power_cfg_t cfg;        /* Low-power switching of the panel (zero timeout: not used) */
+        lv_timer_t                *timer;     /* Timer of the display inactivity, paused while in low-power mode */
+        bool                      active;     /* The panel is in low-power mode */
+    } low_power;
+    struct {
+        lvgl_port_frame_pacing_cfg_t   cfg;   /* Frame pacing (zero fps: not used) */
+        lvgl_port_frame_pacing_stats_t stats; /* Frame, slip and jitter counters */
+        int64_t                   next;       /* Deadline of the next frame [us] */
+        int64_t                   pending_since; /* Time of the first invalidation after the last frame [us] */
+        volatile bool             pending;    /* An area was invalidated, the frame will be rendered at its deadline */
+    } pacing;
+    struct {
+        uint16_t                  *shadow;    /* Flushed screen without the cursor (NULL: cursor overlay not used) */
+        uint32_t                  shadow_caps; /* Memory capabilities of the shadow screen */
+        uint16_t                  *sprite;    /* RGB565 pixels of the cursor image */
+        uint8_t                   *alpha;     /* Opacity of the cursor pixels */
+        uint16_t                  *tx_buf;    /* Composed areas sent on cursor motion (DMA capable) */
+        int32_t                   w;          /* Size of the cursor image */
+        int32_t                   h;
+        lv_area_t                 area;       /* Cursor area shown on the panel (can exceed the screen) */
+        volatile uint8_t          sending;    /* Composed areas being sent, not flushed by LVGL */
+    } cursor;
+    lvgl_port_mirror_handle_t mirror;         /* Remote mirror of the flushed areas (NULL: not mirrored) */
+    bool                      screenshot;     /* Flushed areas are copied into the screenshot staging buffer */
+    volatile uint32_t         parts_pending;  /* Parts of the flushed area still being sent (round display bands, hardware scroll parts, solid color bands) */
+    struct {
+        uint16_t                  *buf;       /* Pattern buffer in internal DMA memory, sent repeatedly for areas of one color (NULL: not used) */
+        uint32_t                  size;       /* Size of the pattern buffer in pixels */
+        uint16_t                  color;      /* Color in the pattern buffer (already swapped when swap_bytes) */
+        bool                      valid;      /* The pattern buffer is filled with the color */
+    } solid;
+#if LVGL_PORT_PPA_SUPPORTED
+    ppa_client_handle_t       ppa_handle;     /* PPA SRM client (rotation, byte swap and color conversion) */
+    void                      *ppa_fb;        /* MIPI-DSI frame buffer, PPA output */
+    size_t                    ppa_fb_size;    /* Size of the MIPI-DSI frame buffer in bytes */
+    size_t                    ppa_fb_align;   /* Cache line size of the frame buffer memory */
+    lv_color_format_t         ppa_fb_cf;      /* Color format of the frame buffer, PPA converts from the LVGL color format */
+#endif
     struct {
         unsigned int monochrome: 1;  /* True, if display is monochrome and using 1bit for 1px */
         unsigned int swap_bytes: 1;  /* Swap bytes in RGB656 (16-bit) before send to LCD driver */
         unsigned int full_refresh: 1;   /* Always make the whole screen redrawn */
         unsigned int direct_mode: 1;    /* Use screen-sized buffers and draw to absolute coordinates */
         unsigned int sw_rotate: 1;    /* Use software rotation (slower) or PPA if available */
+        unsigned int triple_buffer: 1;  /* Use three RGB frame buffers */
     } flags;
+    void                      *rgb_fbs[3];    /* RGB frame buffers (triple buffer mode) */
+    lvgl_port_cfb_handle_t    cfb;            /* Compressed frame buffer, decompressed into RGB bounce buffers (compressed_fb) */
+    lvgl_port_tile_handle_t   tiles;          /* Hash of the panel content, unchanged tiles are not sent (tile_hash) */
+    uint8_t                   rgb_fb_displayed; /* Index of the frame buffer which is displayed */
+    volatile int8_t           rgb_fb_pending; /* Index of the frame buffer which will be displayed after VSYNC (-1: none) */
+    volatile bool             rgb_fb_queued;  /* Pending frame buffer was given to the RGB driver, the next VSYNC displays it */
+    portMUX_TYPE              rgb_fb_lock;    /* Lock of the pending frame buffer between flush and VSYNC ISR */
+    volatile bool             pm_flushing;    /* APB frequency lock is held for the flush in progress */
+    struct {
+        int64_t                   start;      /* Start of the statistics period [us] */
+        volatile uint64_t         busy;       /* Sum of times from flush start to flush ready (bus transfer with transport buffers) [us] */
+        uint32_t                  touch_reads; /* Touch reads waiting for the gap */
+        uint32_t                  touch_wait_max; /* Longest wait for the gap [us] */
+        uint32_t                  touch_timeouts; /* Touch reads without the gap */
+    } bus;
+#if LVGL_PORT_RGB_DMA_COPY_SUPPORTED
+    async_memcpy_handle_t     dma_copy;       /* GDMA copy of draw buffers into RGB frame buffer (dma_copy) */
+    uint8_t                   *dma_copy_fb;   /* RGB frame buffer, destination of the GDMA copy */
+    uint8_t                   *dma_copy_dst;  /* Block of the frame buffer being copied, invalidated in cache when done */
+    size_t                    dma_copy_size;
+#endif
 } lvgl_port_display_ctx_t;
 
 /*******************************************************************************
 * Function definitions
 *******************************************************************************/
-static lv_display_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp_cfg, const lvgl_port_disp_priv_cfg_t *priv_cfg);
+static lv_display_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp_cfg, lvgl_port_disp_type_t disp_type, const lvgl_port_disp_priv_cfg_t *priv_cfg);
 #if LVGL_PORT_HANDLE_FLUSH_READY
 static bool lvgl_port_flush_io_ready_callback(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx);
 #if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
 static bool lvgl_port_flush_vsync_ready_callback(esp_lcd_panel_handle_t panel_io, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx);
+static bool lvgl_port_rgb_bounce_empty_callback(esp_lcd_panel_handle_t panel, void *bounce_buf, int pos_px, int len_bytes, void *user_ctx);
 #endif
 #if (CONFIG_IDF_TARGET_ESP32P4 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0))
 static bool lvgl_port_flush_panel_ready_callback(esp_lcd_panel_handle_t panel_io, esp_lcd_dpi_panel_event_data_t *edata, void *user_ctx);
 #endif
 #endif
+#if LVGL_PORT_PPA_SUPPORTED
+static esp_err_t lvgl_port_ppa_init(lvgl_port_display_ctx_t *disp_ctx, lv_color_format_t fb_cf);
+static bool lvgl_port_ppa_done_callback(ppa_client_handle_t ppa_client, ppa_event_data_t *event_data, void *user_data);
+static void lvgl_port_flush_ppa(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, uint8_t *color_map);
+#endif
 static void lvgl_port_flush_callback(lv_display_t *drv, const lv_area_t *area, uint8_t *color_map);
 static void lvgl_port_disp_size_update_callback(lv_event_t *e);
 static void lvgl_port_disp_rotation_update(lvgl_port_display_ctx_t *disp_ctx);
 static void lvgl_port_display_invalidate_callback(lv_event_t *e);
+static void lvgl_port_display_refr_ready_callback(lv_event_t *e);
+static void lvgl_port_flush_trans(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, uint8_t *color_map);
+static void lvgl_port_trans_send(lvgl_port_display_ctx_t *disp_ctx, const lv_area_t *area, const uint8_t *from, size_t stride, uint32_t px_size);
+static void lvgl_port_flush_rotate_trans(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, uint8_t *color_map);
+static void lvgl_port_trans_queued(lvgl_port_display_ctx_t *disp_ctx);
+static bool lvgl_port_sw_rotated(const lvgl_port_display_ctx_t *disp_ctx);
+static void lvgl_port_flush_tiles(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, uint8_t *color_map);
+static void lvgl_port_tiles_reset(lvgl_port_display_ctx_t *disp_ctx);
+static bool lvgl_port_flush_solid(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, const uint8_t *color_map);
+static void lvgl_port_flush_ring_next(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv);
+static void lvgl_port_flush_round(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, uint8_t *color_map);
+static void lvgl_port_flush_hw_scroll(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, uint8_t *color_map);
+static void lvgl_port_hw_scroll_callback(lv_event_t *e);
+static void lvgl_port_hw_scroll_refr_ready_callback(lv_event_t *e);
+static void lvgl_port_hw_scroll_invalidate(lvgl_port_display_ctx_t *disp_ctx, lv_area_t *area);
+static void lvgl_port_hw_scroll_stop(lvgl_port_display_ctx_t *disp_ctx);
+static void lvgl_port_low_power_timer_cb(lv_timer_t *timer);
+static void lvgl_port_low_power_exit(lvgl_port_display_ctx_t *disp_ctx);
+static void lvgl_port_rot_buf_update(lvgl_port_display_ctx_t *disp_ctx);
+static void lvgl_port_rot_strips_update(lvgl_port_display_ctx_t *disp_ctx);
+static void lvgl_port_disp_mem_account(lvgl_port_display_ctx_t *disp_ctx, bool add);
+static void lvgl_port_flush_area(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, uint8_t *color_map);
+static void lvgl_port_flush_measured(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, uint8_t *color_map);
+static esp_err_t lvgl_port_flush_task_init(lvgl_port_display_ctx_t *disp_ctx, const lvgl_port_display_cfg_t *disp_cfg);
+static void lvgl_port_flush_task_deinit(lvgl_port_display_ctx_t *disp_ctx);
+static void lvgl_port_disp_flush_ready(lv_display_t *disp);
+static bool lvgl_port_disp_sending(lvgl_port_display_ctx_t *disp_ctx);
+#if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+static void lvgl_port_flush_rgb_triple(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, uint8_t *color_map);
+#endif
+#if LVGL_PORT_RGB_DMA_COPY_SUPPORTED
+static esp_err_t lvgl_port_rgb_dma_copy_init(lvgl_port_display_ctx_t *disp_ctx, esp_lcd_panel_handle_t panel_handle);
+static bool lvgl_port_flush_rgb_dma(lvgl_port_display_ctx_t *disp_ctx, const lv_area_t *area, uint8_t *color_map);
+#endif
+static void lvgl_port_display_perf_callback(lv_event_t *e);
+static void lvgl_port_cursor_blend(lvgl_port_display_ctx_t *disp_ctx, const lv_area_t *area, uint16_t *px);
+static void lvgl_port_cursor_flush(lvgl_port_display_ctx_t *disp_ctx, const lv_area_t *area, uint8_t *color_map);
+static void lvgl_port_cursor_free(lvgl_port_display_ctx_t *disp_ctx);
 
 /*******************************************************************************
 * Public API functions
@@ -81,12 +287,10 @@ static void lvgl_port_display_invalidate_callback(lv_event_t *e);
 lv_display_t *lvgl_port_add_disp(const lvgl_port_display_cfg_t *disp_cfg)
 {
     lvgl_port_lock(0);
-    lv_disp_t *disp = lvgl_port_add_disp_priv(disp_cfg, NULL);
+    lv_disp_t *disp = lvgl_port_add_disp_priv(disp_cfg, LVGL_PORT_DISP_TYPE_OTHER, NULL);
 
     if (disp != NULL) {
         lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
-        /* Set display type */
-        disp_ctx->disp_type = LVGL_PORT_DISP_TYPE_OTHER;
 
         assert(disp_cfg->io_handle != NULL);
 
@@ -108,13 +312,14 @@ lv_display_t *lvgl_port_add_disp(const lvgl_port_display_cfg_t *disp_cfg)
 
 lv_display_t *lvgl_port_add_disp_dsi(const lvgl_port_display_cfg_t *disp_cfg, const lvgl_port_display_dsi_cfg_t *dsi_cfg)
 {
+    /* MIPI-DSI frame buffer is RGB, L8 indexes are expanded only in transport buffers of SPI/I80 */
+    ESP_RETURN_ON_FALSE(disp_cfg->color_format != LV_COLOR_FORMAT_L8, NULL, TAG, "Color format L8 is not supported with MIPI-DSI display!");
+
     lvgl_port_lock(0);
-    lv_disp_t *disp = lvgl_port_add_disp_priv(disp_cfg, NULL);
+    lv_disp_t *disp = lvgl_port_add_disp_priv(disp_cfg, LVGL_PORT_DISP_TYPE_DSI, NULL);
 
     if (disp != NULL) {
         lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
-        /* Set display type */
-        disp_ctx->disp_type = LVGL_PORT_DISP_TYPE_DSI;
 
 #if (CONFIG_IDF_TARGET_ESP32P4 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0))
         const esp_lcd_dpi_panel_event_callbacks_t cbs = {
@@ -123,6 +328,26 @@ lv_display_t *lvgl_port_add_disp_dsi(const lvgl_port_display_cfg_t *disp_cfg, co
         /* Register done callback */
         esp_lcd_dpi_panel_register_event_callbacks(disp_ctx->panel_handle, &cbs, disp);
 
+        /* RGB565 draw buffers are converted into RGB888 frame buffer, it is possible only by PPA */
+        const bool fb_rgb888 = (dsi_cfg && dsi_cfg->flags.fb_rgb888 && disp_cfg->color_format == LV_COLOR_FORMAT_RGB565);
+        if (dsi_cfg && dsi_cfg->flags.fb_rgb888 && !fb_rgb888) {
+            ESP_LOGW(TAG, "RGB888 frame buffer conversion needs RGB565 color format, not used");
+        }
+
+        /* Use PPA for SW rotation and byte swap instead of CPU */
+        if (fb_rgb888) {
+            if (lvgl_port_ppa_init(disp_ctx, LV_COLOR_FORMAT_RGB888) != ESP_OK) {
+                ESP_LOGE(TAG, "PPA initialization failed, RGB565 cannot be converted into RGB888 frame buffer");
+                lvgl_port_unlock();
+                lvgl_port_remove_disp(disp);
+                return NULL;
+            }
+        } else if (disp_ctx->flags.sw_rotate) {
+            if (lvgl_port_ppa_init(disp_ctx, lv_display_get_color_format(disp)) != ESP_OK) {
+                ESP_LOGW(TAG, "PPA initialization failed, software rotation will be used");
+            }
+        }
+
         /* Apply rotation from initial display configuration */
         lvgl_port_disp_rotation_update(disp_ctx);
 
@@ -141,13 +366,14 @@ lv_display_t *lvgl_port_add_disp_rgb(const lvgl_port_display_cfg_t *disp_cfg, co
     assert(rgb_cfg != NULL);
     const lvgl_port_disp_priv_cfg_t priv_cfg = {
         .avoid_tearing = rgb_cfg->flags.avoid_tearing,
+        .triple_buffer = rgb_cfg->flags.triple_buffer,
+        .compressed_fb = rgb_cfg->flags.compressed_fb,
+        .dma_copy = rgb_cfg->flags.dma_copy,
     };
-    lv_disp_t *disp = lvgl_port_add_disp_priv(disp_cfg, &priv_cfg);
+    lv_disp_t *disp = lvgl_port_add_disp_priv(disp_cfg, LVGL_PORT_DISP_TYPE_RGB, &priv_cfg);
 
     if (disp != NULL) {
         lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
-        /* Set display type */
-        disp_ctx->disp_type = LVGL_PORT_DISP_TYPE_RGB;
 
 #if (CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0))
         /* Register done callback */
@@ -161,10 +387,19 @@ lv_display_t *lvgl_port_add_disp_rgb(const lvgl_port_display_cfg_t *disp_cfg, co
 #endif
         };
 
-        if (rgb_cfg->flags.bb_mode && (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 2))) {
-            ESP_ERROR_CHECK(esp_lcd_rgb_panel_register_event_callbacks(disp_ctx->panel_handle, &bb_cbs, &disp_ctx->disp_drv));
+        /* Bounce buffers are filled from the compressed frame buffer (the RGB panel has no frame buffer) */
+        const esp_lcd_rgb_panel_event_callbacks_t cfb_cbs = {
+            .on_vsync = lvgl_port_flush_vsync_ready_callback,
+            .on_bounce_empty = lvgl_port_rgb_bounce_empty_callback,
+        };
+
+        /* The callbacks get the display context, LVGL functions (in flash) are not called from ISR */
+        if (disp_ctx->cfb) {
+            ESP_ERROR_CHECK(esp_lcd_rgb_panel_register_event_callbacks(disp_ctx->panel_handle, &cfb_cbs, disp_ctx));
+        } else if (rgb_cfg->flags.bb_mode && (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 2))) {
+            ESP_ERROR_CHECK(esp_lcd_rgb_panel_register_event_callbacks(disp_ctx->panel_handle, &bb_cbs, disp_ctx));
         } else {
-            ESP_ERROR_CHECK(esp_lcd_rgb_panel_register_event_callbacks(disp_ctx->panel_handle, &vsync_cbs, &disp_ctx->disp_drv));
+            ESP_ERROR_CHECK(esp_lcd_rgb_panel_register_event_callbacks(disp_ctx->panel_handle, &vsync_cbs, disp_ctx));
         }
 #else
         ESP_RETURN_ON_FALSE(false, NULL, TAG, "RGB is supported only on ESP32S3 and from IDF 5.0!");
@@ -184,9 +419,81 @@ esp_err_t lvgl_port_remove_disp(lv_display_t *disp)
     lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
 
     lvgl_port_lock(0);
+    if (disp_ctx->hw_scroll.obj) {
+        lv_obj_remove_event_cb_with_user_data(disp_ctx->hw_scroll.obj, lvgl_port_hw_scroll_callback, disp_ctx);
+    }
+    if (disp_ctx->low_power.timer) {
+        lv_timer_delete(disp_ctx->low_power.timer);
+    }
+    /* Flush callback is called under the LVGL lock, no new area can be queued into the flush task */
+    lvgl_port_flush_task_deinit(disp_ctx);
     lv_disp_remove(disp);
     lvgl_port_unlock();
 
+    lvgl_port_cursor_free(disp_ctx);
+
+    lvgl_port_te_deinit(disp_ctx->te);
+    lvgl_port_tile_deinit(disp_ctx->tiles);
+
+    /* Flush, which never finished */
+    if (disp_ctx->pm_flushing) {
+        disp_ctx->pm_flushing = false;
+        lvgl_port_pm_flush_release();
+    }
+
+#if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    if (disp_ctx->cfb) {
+        /* Bounce buffer ISR must not read the compressed frame buffer anymore */
+        const esp_lcd_rgb_panel_event_callbacks_t cbs = {0};
+        esp_lcd_rgb_panel_register_event_callbacks(disp_ctx->panel_handle, &cbs, NULL);
+        lvgl_port_cfb_deinit(disp_ctx->cfb);
+    }
+#endif
+
+#if LVGL_PORT_RGB_DMA_COPY_SUPPORTED
+    if (disp_ctx->dma_copy) {
+        esp_async_memcpy_uninstall(disp_ctx->dma_copy);
+    }
+#endif
+
+#if LVGL_PORT_PPA_SUPPORTED
+    if (disp_ctx->ppa_handle) {
+        ppa_unregister_client(disp_ctx->ppa_handle);
+    }
+#endif
+
+    if (disp_ctx->trans_sem) {
+        /* Wait for all transport buffers to be released by the LCD driver */
+        for (int i = 0; i < disp_ctx->trans_cnt; i++) {
+            xSemaphoreTake(disp_ctx->trans_sem, pdMS_TO_TICKS(1000));
+        }
+        vSemaphoreDelete(disp_ctx->trans_sem);
+    }
+
+    if (disp_ctx->ring.sem) {
+        /* Wait for all flushed draw buffers to be sent by the LCD driver */
+        for (int i = 1; i < disp_ctx->ring.cnt; i++) {
+            xSemaphoreTake(disp_ctx->ring.sem, pdMS_TO_TICKS(1000));
+        }
+        vSemaphoreDelete(disp_ctx->ring.sem);
+    }
+
+    lvgl_port_disp_mem_account(disp_ctx, false);
+
+    for (int i = 0; i < LVGL_PORT_TRANS_BUF_MAX; i++) {
+        if (disp_ctx->trans_buf[i]) {
+            free(disp_ctx->trans_buf[i]);
+        }
+    }
+
+    if (disp_ctx->clut) {
+        free(disp_ctx->clut);
+    }
+
+    if (disp_ctx->solid.buf) {
+        free(disp_ctx->solid.buf);
+    }
+
     if (disp_ctx->draw_buffs[0]) {
         free(disp_ctx->draw_buffs[0]);
     }
@@ -195,10 +502,18 @@ esp_err_t lvgl_port_remove_disp(lv_display_t *disp)
         free(disp_ctx->draw_buffs[1]);
     }
 
+    for (int i = 1; i < disp_ctx->ring.cnt; i++) {
+        free(disp_ctx->ring.buf[i]);
+    }
+
     if (disp_ctx->draw_buffs[2]) {
         free(disp_ctx->draw_buffs[2]);
     }
 
+    if (disp_ctx->mono_prev) {
+        free(disp_ctx->mono_prev);
+    }
+
     free(disp_ctx);
 
     return ESP_OK;
@@ -207,334 +522,2058 @@ esp_err_t lvgl_port_remove_disp(lv_display_t *disp)
 void lvgl_port_flush_ready(lv_display_t *disp)
 {
     assert(disp);
-    lv_disp_flush_ready(disp);
+    lvgl_port_disp_flush_ready(disp);
 }
 
-/*******************************************************************************
-* Private functions
-*******************************************************************************/
-
-static lv_display_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp_cfg, const lvgl_port_disp_priv_cfg_t *priv_cfg)
+esp_err_t lvgl_port_disp_get_perf(lv_display_t *disp, lvgl_port_disp_perf_t *perf)
 {
-    esp_err_t ret = ESP_OK;
-    lv_display_t *disp = NULL;
-    lv_color_t *buf1 = NULL;
-    lv_color_t *buf2 = NULL;
-    uint32_t buffer_size = 0;
-    assert(disp_cfg != NULL);
-    assert(disp_cfg->panel_handle != NULL);
-    assert(disp_cfg->buffer_size > 0);
-    assert(disp_cfg->hres > 0);
-    assert(disp_cfg->vres > 0);
+    ESP_RETURN_ON_FALSE(disp && perf, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_STATE, TAG, "Display is not added to LVGL port");
 
-    buffer_size = disp_cfg->buffer_size;
+    memcpy(perf, &disp_ctx->perf, sizeof(lvgl_port_disp_perf_t));
+    perf->te_period = (disp_ctx->te ? lvgl_port_te_get_period(disp_ctx->te) : 0);
 
-    /* Check supported display color formats */
-    ESP_RETURN_ON_FALSE(disp_cfg->color_format == 0 || disp_cfg->color_format == LV_COLOR_FORMAT_RGB565 || disp_cfg->color_format == LV_COLOR_FORMAT_RGB888 || disp_cfg->color_format == LV_COLOR_FORMAT_XRGB8888 || disp_cfg->color_format == LV_COLOR_FORMAT_ARGB8888, NULL, TAG, "Not supported display color format!");
+    return ESP_OK;
+}
 
-    lv_color_format_t display_color_format = (disp_cfg->color_format != 0 ? disp_cfg->color_format : LV_COLOR_FORMAT_RGB565);
-    if (disp_cfg->flags.swap_bytes) {
-        /* Swap bytes can be used only in RGB656 color format */
-        ESP_RETURN_ON_FALSE(display_color_format == LV_COLOR_FORMAT_RGB565, NULL, TAG, "Swap bytes can be used only in display color format RGB565!");
-    }
+esp_err_t lvgl_port_disp_get_bus_stats(lv_display_t *disp, lvgl_port_disp_bus_stats_t *stats, bool reset)
+{
+    ESP_RETURN_ON_FALSE(disp && stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_STATE, TAG, "Display is not added to LVGL port");
 
-    if (disp_cfg->flags.buff_dma) {
-        /* DMA buffer can be used only in RGB656 color format */
-        ESP_RETURN_ON_FALSE(display_color_format == LV_COLOR_FORMAT_RGB565, NULL, TAG, "DMA buffer can be used only in display color format RGB565 (not alligned copy)!");
+    lvgl_port_lock(0);
+    const int64_t now = esp_timer_get_time();
+    stats->period = (uint32_t)(now - disp_ctx->bus.start);
+    stats->busy_time = (uint32_t)disp_ctx->bus.busy;
+    stats->utilization = (stats->period ? (uint32_t)((uint64_t)stats->busy_time * 100 / stats->period) : 0);
+    stats->touch_reads = disp_ctx->bus.touch_reads;
+    stats->touch_wait_max = disp_ctx->bus.touch_wait_max;
+    stats->touch_timeouts = disp_ctx->bus.touch_timeouts;
+    if (reset) {
+        memset(&disp_ctx->bus, 0, sizeof(disp_ctx->bus));
+        disp_ctx->bus.start = now;
     }
+    lvgl_port_unlock();
 
-    /* Display context */
-    lvgl_port_display_ctx_t *disp_ctx = malloc(sizeof(lvgl_port_display_ctx_t));
-    ESP_GOTO_ON_FALSE(disp_ctx, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for display context allocation!");
-    memset(disp_ctx, 0, sizeof(lvgl_port_display_ctx_t));
-    disp_ctx->io_handle = disp_cfg->io_handle;
-    disp_ctx->panel_handle = disp_cfg->panel_handle;
-    disp_ctx->control_handle = disp_cfg->control_handle;
-    disp_ctx->rotation.swap_xy = disp_cfg->rotation.swap_xy;
-    disp_ctx->rotation.mirror_x = disp_cfg->rotation.mirror_x;
-    disp_ctx->rotation.mirror_y = disp_cfg->rotation.mirror_y;
-    disp_ctx->flags.swap_bytes = disp_cfg->flags.swap_bytes;
-    disp_ctx->flags.sw_rotate = disp_cfg->flags.sw_rotate;
-    disp_ctx->current_rotation = LV_DISPLAY_ROTATION_0;
+    return ESP_OK;
+}
 
-    uint32_t buff_caps = 0;
-#if SOC_PSRAM_DMA_CAPABLE == 0
-    if (disp_cfg->flags.buff_dma && disp_cfg->flags.buff_spiram) {
-        ESP_GOTO_ON_FALSE(false, ESP_ERR_NOT_SUPPORTED, err, TAG, "Alloc DMA capable buffer in SPIRAM is not supported!");
-    }
-#endif
-    if (disp_cfg->flags.buff_dma) {
-        buff_caps |= MALLOC_CAP_DMA;
-    }
-    if (disp_cfg->flags.buff_spiram) {
-        buff_caps |= MALLOC_CAP_SPIRAM;
-    }
-    if (buff_caps == 0) {
-        buff_caps |= MALLOC_CAP_DEFAULT;
+bool lvgl_port_disp_bus_wait(lv_display_t *disp, uint32_t timeout_ms)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (disp ? (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp) : NULL);
+    if (disp_ctx == NULL) {
+        return true;
     }
 
-    /* Use RGB internal buffers for avoid tearing effect */
-    if (priv_cfg && priv_cfg->avoid_tearing) {
-#if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
-        buffer_size = disp_cfg->hres * disp_cfg->vres;
-        ESP_GOTO_ON_ERROR(esp_lcd_rgb_panel_get_frame_buffer(disp_cfg->panel_handle, 2, (void *)&buf1, (void *)&buf2), err, TAG, "Get RGB buffers failed");
-#endif
-    } else {
-        /* alloc draw buffers used by LVGL */
-        /* it's recommended to choose the size of the draw buffer(s) to be at least 1/10 screen sized */
-        buf1 = heap_caps_malloc(buffer_size * sizeof(lv_color_t), buff_caps);
-        ESP_GOTO_ON_FALSE(buf1, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (buf1) allocation!");
-        if (disp_cfg->double_buffer) {
-            buf2 = heap_caps_malloc(buffer_size * sizeof(lv_color_t), buff_caps);
-            ESP_GOTO_ON_FALSE(buf2, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (buf2) allocation!");
-        }
+    /* Transfers of one flush are short, busy waiting does not give the LVGL task away for a tick */
+    const int64_t wait_start = esp_timer_get_time();
+    const int64_t timeout_us = (int64_t)timeout_ms * 1000;
+    int64_t waited = 0;
+    bool idle = !lvgl_port_disp_sending(disp_ctx);
+    while (!idle && waited < timeout_us) {
+        esp_rom_delay_us(LVGL_PORT_BUS_POLL_US);
+        waited = esp_timer_get_time() - wait_start;
+        idle = !lvgl_port_disp_sending(disp_ctx);
+    }
 
-        disp_ctx->draw_buffs[0] = buf1;
-        disp_ctx->draw_buffs[1] = buf2;
+    disp_ctx->bus.touch_reads++;
+    disp_ctx->bus.touch_wait_max = LV_MAX(disp_ctx->bus.touch_wait_max, (uint32_t)waited);
+    if (!idle) {
+        disp_ctx->bus.touch_timeouts++;
     }
+    return idle;
+}
 
-    disp = lv_display_create(disp_cfg->hres, disp_cfg->vres);
+esp_err_t lvgl_port_disp_hw_scroll_attach(lv_display_t *disp, lv_obj_t *obj, const lvgl_port_hw_scroll_cfg_t *scroll_cfg)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(disp && obj && scroll_cfg && scroll_cfg->set_area && scroll_cfg->set_offset, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_STATE, TAG, "Display is not added to LVGL port");
+    /* Each flushed area is written directly into the panel memory, split by the scrolling offset */
+    ESP_RETURN_ON_FALSE(disp_ctx->disp_type == LVGL_PORT_DISP_TYPE_OTHER && disp_ctx->trans_size == 0 && disp_ctx->round_size == 0 && disp_ctx->flush_task == NULL &&
+                        disp_ctx->ring.cnt == 0 && !disp_ctx->flags.monochrome && !disp_ctx->flags.full_refresh && !disp_ctx->flags.direct_mode && !disp_ctx->flags.sw_rotate,
+                        ESP_ERR_NOT_SUPPORTED, TAG, "Hardware scroll is supported only with SPI/I80 display in partial mode without transport buffer, draw buffer ring, round mask, flush task and SW rotation!");
 
-    /* Monochrome display settings */
-    if (disp_cfg->monochrome) {
-        /* When using monochromatic display, there must be used full bufer! */
-        ESP_GOTO_ON_FALSE((disp_cfg->hres * disp_cfg->vres == buffer_size), ESP_ERR_INVALID_ARG, err, TAG, "Monochromatic display must using full buffer!");
+    lvgl_port_lock(0);
+    ESP_GOTO_ON_FALSE(disp_ctx->hw_scroll.obj == NULL, ESP_ERR_INVALID_STATE, err, TAG, "Hardware scroll is already attached!");
+
+    lv_area_t coords;
+    lv_obj_update_layout(obj);
+    lv_obj_get_coords(obj, &coords);
+    const int32_t top = LV_MAX(coords.y1, 0);
+    const int32_t bottom = LV_MIN(coords.y2, lv_display_get_vertical_resolution(disp) - 1);
+    /* Hardware scrolls whole rows of the panel */
+    ESP_GOTO_ON_FALSE(coords.x1 <= 0 && coords.x2 >= lv_display_get_horizontal_resolution(disp) - 1 && bottom > top, ESP_ERR_INVALID_ARG, err, TAG,
+                      "Container must span the whole width of the display!");
+    ESP_GOTO_ON_ERROR(scroll_cfg->set_area(disp_ctx->panel_handle, top, bottom - top + 1), err, TAG, "Set scroll area failed!");
+
+    disp_ctx->hw_scroll.cfg = *scroll_cfg;
+    disp_ctx->hw_scroll.top = top;
+    disp_ctx->hw_scroll.height = bottom - top + 1;
+    disp_ctx->hw_scroll.offset = 0;
+    disp_ctx->hw_scroll.panel_offset = 0;
+    disp_ctx->hw_scroll.last_x = lv_obj_get_scroll_x(obj);
+    disp_ctx->hw_scroll.last_y = lv_obj_get_scroll_y(obj);
+    disp_ctx->hw_scroll.moved = 0;
+    disp_ctx->hw_scroll.inv_replace = false;
+    disp_ctx->hw_scroll.obj = obj;
+    lv_obj_add_event_cb(obj, lvgl_port_hw_scroll_callback, LV_EVENT_SCROLL, disp_ctx);
+    lv_obj_add_event_cb(obj, lvgl_port_hw_scroll_callback, LV_EVENT_DELETE, disp_ctx);
+    lv_display_add_event_cb(disp, lvgl_port_hw_scroll_refr_ready_callback, LV_EVENT_REFR_READY, disp_ctx);
 
-        disp_ctx->flags.monochrome = 1;
-        lv_display_set_buffers(disp, buf1, buf2, buffer_size * sizeof(lv_color_t), LV_DISPLAY_RENDER_MODE_FULL);
-    } else if (disp_cfg->flags.direct_mode) {
-        /* When using direct_mode, there must be used full bufer! */
-        ESP_GOTO_ON_FALSE((disp_cfg->hres * disp_cfg->vres == buffer_size), ESP_ERR_INVALID_ARG, err, TAG, "Direct mode must using full buffer!");
+err:
+    lvgl_port_unlock();
+    return ret;
+}
 
-        disp_ctx->flags.direct_mode = 1;
-        lv_display_set_buffers(disp, buf1, buf2, buffer_size * sizeof(lv_color_t), LV_DISPLAY_RENDER_MODE_DIRECT);
-    } else if (disp_cfg->flags.full_refresh) {
-        /* When using full_refresh, there must be used full bufer! */
-        ESP_GOTO_ON_FALSE((disp_cfg->hres * disp_cfg->vres == buffer_size), ESP_ERR_INVALID_ARG, err, TAG, "Full refresh must using full buffer!");
+esp_err_t lvgl_port_disp_hw_scroll_detach(lv_display_t *disp)
+{
+    ESP_RETURN_ON_FALSE(disp, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_STATE, TAG, "Display is not added to LVGL port");
 
-        disp_ctx->flags.full_refresh = 1;
-        lv_display_set_buffers(disp, buf1, buf2, buffer_size * sizeof(lv_color_t), LV_DISPLAY_RENDER_MODE_FULL);
-    } else {
-        lv_display_set_buffers(disp, buf1, buf2, buffer_size * sizeof(lv_color_t), LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lvgl_port_lock(0);
+    if (disp_ctx->hw_scroll.obj) {
+        lv_obj_remove_event_cb_with_user_data(disp_ctx->hw_scroll.obj, lvgl_port_hw_scroll_callback, disp_ctx);
+        lvgl_port_hw_scroll_stop(disp_ctx);
     }
+    lvgl_port_unlock();
 
-    lv_display_set_color_format(disp, display_color_format);
-    lv_display_set_flush_cb(disp, lvgl_port_flush_callback);
-    lv_display_add_event_cb(disp, lvgl_port_disp_size_update_callback, LV_EVENT_RESOLUTION_CHANGED, disp_ctx);
-    lv_display_add_event_cb(disp, lvgl_port_display_invalidate_callback, LV_EVENT_INVALIDATE_AREA, disp_ctx);
-    lv_display_add_event_cb(disp, lvgl_port_display_invalidate_callback, LV_EVENT_REFR_REQUEST, disp_ctx);
+    return ESP_OK;
+}
 
-    lv_display_set_user_data(disp, disp_ctx);
-    disp_ctx->disp_drv = disp;
+esp_err_t lvgl_port_disp_set_low_power(lv_display_t *disp, const lvgl_port_low_power_cfg_t *lp_cfg)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(disp && (lp_cfg == NULL || lp_cfg->timeout_ms == 0 || lp_cfg->cb), ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_STATE, TAG, "Display is not added to LVGL port");
 
-    /* Use SW rotation */
-    if (disp_cfg->flags.sw_rotate) {
-        disp_ctx->draw_buffs[2] = heap_caps_malloc(buffer_size * sizeof(lv_color_t), buff_caps);
-        ESP_GOTO_ON_FALSE(disp_ctx->draw_buffs[2], ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (rotation buffer) allocation!");
+    lvgl_port_lock(0);
+    /* The panel is switched back by the old callback */
+    lvgl_port_low_power_exit(disp_ctx);
+
+    if (lp_cfg == NULL || lp_cfg->timeout_ms == 0) {
+        memset(&disp_ctx->low_power.cfg, 0, sizeof(lvgl_port_low_power_cfg_t));
+        if (disp_ctx->low_power.timer) {
+            lv_timer_delete(disp_ctx->low_power.timer);
+            disp_ctx->low_power.timer = NULL;
+        }
+        goto err;
     }
 
-
-err:
-    if (ret != ESP_OK) {
-        if (buf1) {
-            free(buf1);
-        }
-        if (buf2) {
-            free(buf2);
-        }
-        if (disp_ctx->draw_buffs[2]) {
-            free(disp_ctx->draw_buffs[2]);
-        }
-        if (disp_ctx) {
-            free(disp_ctx);
-        }
+    if (disp_ctx->low_power.timer == NULL) {
+        disp_ctx->low_power.timer = lv_timer_create(lvgl_port_low_power_timer_cb, lp_cfg->timeout_ms, disp_ctx);
+        ESP_GOTO_ON_FALSE(disp_ctx->low_power.timer, ESP_ERR_NO_MEM, err, TAG, "Create low-power timer fail!");
     }
+    disp_ctx->low_power.cfg = *lp_cfg;
+    lv_timer_set_period(disp_ctx->low_power.timer, lp_cfg->timeout_ms);
+    lv_timer_reset(disp_ctx->low_power.timer);
+    lv_timer_resume(disp_ctx->low_power.timer);
 
-    return disp;
+err:
+    lvgl_port_unlock();
+    return ret;
 }
 
-#if LVGL_PORT_HANDLE_FLUSH_READY
-static bool lvgl_port_flush_io_ready_callback(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
+esp_err_t lvgl_port_disp_set_refresh_period(lv_display_t *disp, uint32_t period_ms)
 {
-    lv_display_t *disp_drv = (lv_display_t *)user_ctx;
-    assert(disp_drv != NULL);
-    lv_disp_flush_ready(disp_drv);
-    return false;
+    ESP_RETURN_ON_FALSE(disp && period_ms > 0, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_STATE, TAG, "Display is not added to LVGL port");
+
+    lvgl_port_lock(0);
+    disp_ctx->refr_period = period_ms;
+    /* Paced display keeps its frame period, the period is used after pacing is disabled */
+    lv_timer_t *refr_timer = lv_display_get_refr_timer(disp);
+    if (refr_timer && disp_ctx->pacing.cfg.fps == 0) {
+        lv_timer_set_period(refr_timer, period_ms);
+    }
+    lvgl_port_unlock();
+
+    return ESP_OK;
 }
 
-#if (CONFIG_IDF_TARGET_ESP32P4 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0))
-static bool lvgl_port_flush_panel_ready_callback(esp_lcd_panel_handle_t panel_io, esp_lcd_dpi_panel_event_data_t *edata, void *user_ctx)
+esp_err_t lvgl_port_disp_set_frame_pacing(lv_display_t *disp, const lvgl_port_frame_pacing_cfg_t *pacing_cfg)
 {
-    lv_display_t *disp_drv = (lv_display_t *)user_ctx;
-    assert(disp_drv != NULL);
-    lv_disp_flush_ready(disp_drv);
-    return false;
+    ESP_RETURN_ON_FALSE(disp && (pacing_cfg == NULL || pacing_cfg->fps <= 1000), ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_STATE, TAG, "Display is not added to LVGL port");
+    lv_timer_t *refr_timer = lv_display_get_refr_timer(disp);
+
+    lvgl_port_lock(0);
+    if (pacing_cfg == NULL || pacing_cfg->fps == 0) {
+        memset(&disp_ctx->pacing, 0, sizeof(disp_ctx->pacing));
+        if (refr_timer) {
+            lv_timer_set_period(refr_timer, disp_ctx->refr_period);
+            lv_timer_ready(refr_timer);
+        }
+    } else {
+        disp_ctx->pacing.cfg = *pacing_cfg;
+        memset(&disp_ctx->pacing.stats, 0, sizeof(lvgl_port_frame_pacing_stats_t));
+        disp_ctx->pacing.stats.period_us = 1000000 / pacing_cfg->fps;
+        disp_ctx->pacing.next = esp_timer_get_time();
+        /* LVGL refreshes the display only when LVGL task calls it */
+        if (refr_timer) {
+            lv_timer_set_period(refr_timer, LVGL_PORT_PACING_REFR_PERIOD);
+            lv_timer_reset(refr_timer);
+        }
+        disp_ctx->pacing.pending_since = disp_ctx->pacing.next;
+        disp_ctx->pacing.pending = true;
+    }
+    lvgl_port_unlock();
+
+    lvgl_port_task_wake(LVGL_PORT_EVENT_DISPLAY, NULL);
+    return ESP_OK;
 }
-#endif
 
-#if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
-static bool lvgl_port_flush_vsync_ready_callback(esp_lcd_panel_handle_t panel_io, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
+esp_err_t lvgl_port_disp_get_pacing_stats(lv_display_t *disp, lvgl_port_frame_pacing_stats_t *stats, bool reset)
 {
-    BaseType_t need_yield = pdFALSE;
+    ESP_RETURN_ON_FALSE(disp && stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_STATE, TAG, "Display is not added to LVGL port");
 
-    lv_display_t *disp_drv = (lv_display_t *)user_ctx;
-    assert(disp_drv != NULL);
-    need_yield = lvgl_port_task_notify(ULONG_MAX);
-    lvgl_port_task_wake(LVGL_PORT_EVENT_DISPLAY, disp_drv);
+    lvgl_port_lock(0);
+    *stats = disp_ctx->pacing.stats;
+    if (reset) {
+        disp_ctx->pacing.stats.frames = 0;
+        disp_ctx->pacing.stats.slipped = 0;
+        disp_ctx->pacing.stats.jitter_max_us = 0;
+    }
+    lvgl_port_unlock();
 
-    return (need_yield == pdTRUE);
+    return ESP_OK;
 }
-#endif
-#endif
 
-static void _lvgl_port_transform_monochrome(lv_display_t *display, const lv_area_t *area, uint8_t *color_map)
+uint32_t lvgl_port_disp_pace(void)
 {
-    uint8_t *buf = color_map;
-    lv_color_t *color = (lv_color_t *)color_map;
-    uint16_t hor_res = lv_display_get_physical_horizontal_resolution(display);
-    uint16_t ver_res = lv_display_get_physical_vertical_resolution(display);
-    uint16_t res = hor_res;
-    bool swap_xy = (lv_display_get_rotation(display) == LV_DISPLAY_ROTATION_90 || lv_display_get_rotation(display) == LV_DISPLAY_ROTATION_270);
+    uint32_t wait_ms = LV_NO_TIMER_READY;
 
-    int x1 = area->x1;
-    int x2 = area->x2;
-    int y1 = area->y1;
-    int y2 = area->y2;
+    for (lv_display_t *disp = lv_display_get_next(NULL); disp; disp = lv_display_get_next(disp)) {
+        lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+        if (disp_ctx == NULL || disp_ctx->pacing.cfg.fps == 0 || !disp_ctx->pacing.pending) {
+            continue;
+        }
 
-    int out_x, out_y;
-    for (int y = y1; y <= y2; y++) {
+        /* TE period is measured from the pulses, it is known only after a while */
+        uint32_t period = 1000000 / disp_ctx->pacing.cfg.fps;
+        const uint32_t te_period = (disp_ctx->pacing.cfg.te_align && disp_ctx->te ? lvgl_port_te_get_period(disp_ctx->te) : 0);
+        if (te_period) {
+            period = ((period + te_period / 2) / te_period) * te_period;
+            period = (period ? period : te_period);
+        }
+        disp_ctx->pacing.stats.period_us = period;
+
+        const int64_t now = esp_timer_get_time();
+        if (now < disp_ctx->pacing.next) {
+            const uint32_t ms = (uint32_t)((disp_ctx->pacing.next - now + 999) / 1000);
+            wait_ms = LV_MIN(wait_ms, ms);
+            continue;
+        }
+
+        /* Invalidated after the deadline (static screen): the delay is counted from the invalidation */
+        const int64_t deadline = LV_MAX(disp_ctx->pacing.next, disp_ctx->pacing.pending_since);
+        const uint32_t late = (uint32_t)LV_MIN(now - deadline, UINT32_MAX);
+        disp_ctx->pacing.stats.slipped += late / period;
+        disp_ctx->pacing.stats.jitter_max_us = LV_MAX(disp_ctx->pacing.stats.jitter_max_us, late);
+        disp_ctx->pacing.stats.frames++;
+        /* Keep the cadence, unless the frame slipped or the screen was static */
+        disp_ctx->pacing.next = (disp_ctx->pacing.next + period > now ? disp_ctx->pacing.next + period : now + period);
+
+        /* Invalidations during the render request the next frame */
+        disp_ctx->pacing.pending = false;
+        lv_refr_now(disp);
+        lv_timer_t *refr_timer = lv_display_get_refr_timer(disp);
+        if (refr_timer) {
+            lv_timer_reset(refr_timer);
+        }
+        if (disp_ctx->pacing.pending) {
+            const int64_t after = esp_timer_get_time();
+            const uint32_t ms = (uint32_t)(disp_ctx->pacing.next > after ? (disp_ctx->pacing.next - after + 999) / 1000 : 0);
+            wait_ms = LV_MIN(wait_ms, ms);
+        }
+    }
+
+    return wait_ms;
+}
+
+esp_err_t lvgl_port_disp_park(lv_display_t *disp, bool release_buffers)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_STATE, TAG, "Display is not added to LVGL port");
+    if (disp_ctx->parked) {
+        return ESP_OK;
+    }
+
+    /* LVGL does not wait for the end of the last flush with two buffers */
+    const TickType_t wait_start = xTaskGetTickCount();
+    while (disp_ctx->pm_flushing && xTaskGetTickCount() - wait_start < pdMS_TO_TICKS(LVGL_PORT_PARK_FLUSH_WAIT_MS)) {
+        vTaskDelay(1);
+    }
+    ESP_RETURN_ON_FALSE(!disp_ctx->pm_flushing, ESP_ERR_TIMEOUT, TAG, "Flush did not finish, display is not parked!");
+    if (disp_ctx->trans_sem) {
+        /* Transport buffers are released by the LCD driver */
+        for (int i = 0; i < disp_ctx->trans_cnt; i++) {
+            xSemaphoreTake(disp_ctx->trans_sem, pdMS_TO_TICKS(LVGL_PORT_PARK_FLUSH_WAIT_MS));
+        }
+        for (int i = 0; i < disp_ctx->trans_cnt; i++) {
+            xSemaphoreGive(disp_ctx->trans_sem);
+        }
+    }
+    if (disp_ctx->ring.sem) {
+        /* Flushed draw buffers are released by the LCD driver */
+        for (int i = 1; i < disp_ctx->ring.cnt; i++) {
+            xSemaphoreTake(disp_ctx->ring.sem, pdMS_TO_TICKS(LVGL_PORT_PARK_FLUSH_WAIT_MS));
+        }
+        for (int i = 1; i < disp_ctx->ring.cnt; i++) {
+            xSemaphoreGive(disp_ctx->ring.sem);
+        }
+    }
+
+    esp_lcd_panel_handle_t control_handle = (disp_ctx->control_handle ? disp_ctx->control_handle : disp_ctx->panel_handle);
+    if (esp_lcd_panel_disp_on_off(control_handle, false) != ESP_OK) {
+        ESP_LOGD(TAG, "Panel does not support switching off");
+    }
+    disp_ctx->parked = true;
+
+    /* RGB frame buffers are owned by the LCD driver, draw_buffs are not set for them. Draw buffers of the ring are kept. */
+    if (release_buffers) {
+        for (int i = 0; i < 2 && disp_ctx->ring.cnt == 0; i++) {
+            if (disp_ctx->draw_buffs[i]) {
+                LVGL_PORT_MEM_REMOVE(disp_ctx->draw_buffs[i], disp_ctx->draw_buf_caps);
+                free(disp_ctx->draw_buffs[i]);
+                disp_ctx->draw_buffs[i] = NULL;
+            }
+        }
+        /* Rotation buffer is allocated again in the next flush */
+        if (disp_ctx->draw_buffs[2]) {
+            LVGL_PORT_MEM_REMOVE(disp_ctx->draw_buffs[2], disp_ctx->rot_buf_caps);
+            free(disp_ctx->draw_buffs[2]);
+            disp_ctx->draw_buffs[2] = NULL;
+        }
+        for (int i = 0; i < disp_ctx->trans_cnt; i++) {
+            LVGL_PORT_MEM_REMOVE(disp_ctx->trans_buf[i], MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+            free(disp_ctx->trans_buf[i]);
+            disp_ctx->trans_buf[i] = NULL;
+        }
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_disp_unpark(lv_display_t *disp)
+{
+    esp_err_t ret = ESP_OK;
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_STATE, TAG, "Display is not added to LVGL port");
+    if (!disp_ctx->parked) {
+        return ESP_OK;
+    }
+
+    /* Released buffers are allocated with the same size and capabilities, LVGL gets them back */
+    if (disp_ctx->draw_buf_size && disp_ctx->draw_buffs[0] == NULL) {
+        disp_ctx->draw_buffs[0] = lvgl_port_buffer_malloc(disp_ctx->draw_buf_size, disp_ctx->draw_buf_caps);
+        ESP_GOTO_ON_FALSE(disp_ctx->draw_buffs[0], ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (buf1) allocation!");
+        if (disp_ctx->draw_buf_double) {
+            disp_ctx->draw_buffs[1] = lvgl_port_buffer_malloc(disp_ctx->draw_buf_size, disp_ctx->draw_buf_caps);
+            ESP_GOTO_ON_FALSE(disp_ctx->draw_buffs[1], ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (buf2) allocation!");
+        }
+        LVGL_PORT_MEM_ADD(disp_ctx->draw_buffs[0], disp_ctx->draw_buf_caps);
+        LVGL_PORT_MEM_ADD(disp_ctx->draw_buffs[1], disp_ctx->draw_buf_caps);
+
+        lv_display_render_mode_t render_mode = LV_DISPLAY_RENDER_MODE_PARTIAL;
+        if (disp_ctx->flags.direct_mode) {
+            render_mode = LV_DISPLAY_RENDER_MODE_DIRECT;
+        } else if (disp_ctx->flags.full_refresh || disp_ctx->flags.monochrome) {
+            render_mode = LV_DISPLAY_RENDER_MODE_FULL;
+        }
+        lv_display_set_buffers(disp, disp_ctx->draw_buffs[0], disp_ctx->draw_buffs[1], disp_ctx->draw_buf_size, render_mode);
+    }
+    for (int i = 0; i < disp_ctx->trans_cnt; i++) {
+        if (disp_ctx->trans_buf[i] == NULL) {
+            disp_ctx->trans_buf[i] = heap_caps_malloc(disp_ctx->trans_buf_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+            ESP_GOTO_ON_FALSE(disp_ctx->trans_buf[i], ESP_ERR_NO_MEM, err, TAG, "Not enough memory for buffer(transport) allocation!");
+            LVGL_PORT_MEM_ADD(disp_ctx->trans_buf[i], MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        }
+    }
+    disp_ctx->trans_idx = 0;
+
+    esp_lcd_panel_handle_t control_handle = (disp_ctx->control_handle ? disp_ctx->control_handle : disp_ctx->panel_handle);
+    if (esp_lcd_panel_disp_on_off(control_handle, true) != ESP_OK) {
+        ESP_LOGD(TAG, "Panel does not support switching on");
+    }
+    disp_ctx->parked = false;
+    disp_ctx->mono_prev_valid = false;
+    lvgl_port_tiles_reset(disp_ctx);
+
+    /* Content of the released buffers is lost, the whole screen is rendered in the next frame */
+    lv_obj_invalidate(lv_display_get_screen_active(disp));
+
+err:
+    if (ret != ESP_OK) {
+        /* Display stays parked, a part of the buffers can be freed by the next lvgl_port_park */
+        if (disp_ctx->draw_buffs[1] == NULL && disp_ctx->draw_buffs[0] != NULL && disp_ctx->draw_buf_double) {
+            free(disp_ctx->draw_buffs[0]);
+            disp_ctx->draw_buffs[0] = NULL;
+        }
+    }
+    return ret;
+}
+
+esp_err_t lvgl_port_disp_set_mirror(lv_display_t *disp, lvgl_port_mirror_handle_t mirror)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_STATE, TAG, "Display is not added to LVGL port");
+    if (mirror == NULL) {
+        disp_ctx->mirror = NULL;
+        return ESP_OK;
+    }
+    ESP_RETURN_ON_FALSE(disp_ctx->mirror == NULL, ESP_ERR_INVALID_STATE, TAG, "Display is already mirrored");
+    ESP_RETURN_ON_FALSE(lv_display_get_color_format(disp) == LV_COLOR_FORMAT_RGB565 && !disp_ctx->flags.monochrome, ESP_ERR_NOT_SUPPORTED, TAG,
+                        "Mirror supports only RGB565 displays!");
+    disp_ctx->mirror = mirror;
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_disp_set_screenshot(lv_display_t *disp, bool enable)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_STATE, TAG, "Display is not added to LVGL port");
+    ESP_RETURN_ON_FALSE(!enable || (lv_display_get_color_format(disp) == LV_COLOR_FORMAT_RGB565 && !disp_ctx->flags.monochrome),
+                        ESP_ERR_NOT_SUPPORTED, TAG, "Screenshot supports only RGB565 displays!");
+    disp_ctx->screenshot = enable;
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_disp_cursor_attach(lv_display_t *disp, const lv_image_dsc_t *img)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(disp && img && img->header.cf == LV_COLOR_FORMAT_ARGB8888, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_STATE, TAG, "Display is not added to LVGL port");
+    /* Flushed areas must be RGB565 rows of the screen in LVGL coordinates */
+    ESP_RETURN_ON_FALSE(disp_ctx->disp_type == LVGL_PORT_DISP_TYPE_OTHER && lv_display_get_color_format(disp) == LV_COLOR_FORMAT_RGB565 &&
+                        !disp_ctx->flags.monochrome && !disp_ctx->flags.direct_mode && !disp_ctx->flags.sw_rotate && disp_ctx->clut == NULL &&
+                        disp_ctx->round_size == 0 && disp_ctx->hw_scroll.obj == NULL && disp_ctx->tiles == NULL, ESP_ERR_NOT_SUPPORTED, TAG,
+                        "Cursor overlay is not supported with this display configuration!");
+    ESP_RETURN_ON_FALSE(disp_ctx->cursor.shadow == NULL, ESP_ERR_INVALID_STATE, TAG, "Cursor overlay is already attached");
+
+    const int32_t w = img->header.w;
+    const int32_t h = img->header.h;
+    const size_t screen_px = lv_display_get_horizontal_resolution(disp) * lv_display_get_vertical_resolution(disp);
+
+    lvgl_port_lock(0);
+    /* Shadow screen is read only on cursor motion, PSRAM is fast enough */
+    disp_ctx->cursor.shadow_caps = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+    disp_ctx->cursor.shadow = heap_caps_malloc(screen_px * sizeof(uint16_t), disp_ctx->cursor.shadow_caps);
+    if (disp_ctx->cursor.shadow == NULL) {
+        disp_ctx->cursor.shadow_caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+        disp_ctx->cursor.shadow = heap_caps_malloc(screen_px * sizeof(uint16_t), disp_ctx->cursor.shadow_caps);
+    }
+    disp_ctx->cursor.sprite = heap_caps_malloc(w * h * sizeof(uint16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    disp_ctx->cursor.alpha = heap_caps_malloc(w * h, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    /* Union of the old and new cursor area, or both areas side by side */
+    disp_ctx->cursor.tx_buf = heap_caps_malloc(4 * w * h * sizeof(uint16_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    ESP_GOTO_ON_FALSE(disp_ctx->cursor.shadow && disp_ctx->cursor.sprite && disp_ctx->cursor.alpha && disp_ctx->cursor.tx_buf, ESP_ERR_NO_MEM, err, TAG,
+                      "Not enough memory for cursor overlay!");
+    LVGL_PORT_MEM_ADD(disp_ctx->cursor.shadow, disp_ctx->cursor.shadow_caps);
+    LVGL_PORT_MEM_ADD(disp_ctx->cursor.tx_buf, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+
+    /* ARGB8888 is B, G, R, A in memory */
+    for (int32_t y = 0; y < h; y++) {
+        const uint8_t *src = img->data + y * img->header.stride;
+        for (int32_t x = 0; x < w; x++, src += 4) {
+            disp_ctx->cursor.sprite[y * w + x] = ((src[2] & 0xF8) << 8) | ((src[1] & 0xFC) << 3) | (src[0] >> 3);
+            disp_ctx->cursor.alpha[y * w + x] = src[3];
+        }
+    }
+    disp_ctx->cursor.w = w;
+    disp_ctx->cursor.h = h;
+    lv_area_set(&disp_ctx->cursor.area, 0, 0, w - 1, h - 1);
+
+    /* The shadow screen is filled by the next frame */
+    lv_obj_invalidate(lv_display_get_screen_active(disp));
+
+err:
+    if (ret != ESP_OK) {
+        lvgl_port_cursor_free(disp_ctx);
+    }
+    lvgl_port_unlock();
+    return ret;
+}
+
+void lvgl_port_disp_cursor_detach(lv_display_t *disp)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    if (disp_ctx == NULL || disp_ctx->cursor.shadow == NULL) {
+        return;
+    }
+
+    lvgl_port_lock(0);
+    /* Cursor area is redrawn without the cursor */
+    lv_area_t area = disp_ctx->cursor.area;
+    lvgl_port_cursor_free(disp_ctx);
+    lv_obj_invalidate_area(lv_display_get_screen_active(disp), &area);
+    lvgl_port_unlock();
+}
+
+void lvgl_port_disp_cursor_move(lv_display_t *disp, int32_t x, int32_t y)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    if (disp_ctx == NULL || disp_ctx->cursor.shadow == NULL || disp_ctx->parked) {
+        return;
+    }
+    if (disp_ctx->cursor.area.x1 == x && disp_ctx->cursor.area.y1 == y) {
+        return;
+    }
+
+    /* The LCD driver must not report the end of a flushed area as the end of the cursor area */
+    const TickType_t wait_start = xTaskGetTickCount();
+    while (lvgl_port_disp_sending(disp_ctx) &&
+            xTaskGetTickCount() - wait_start < pdMS_TO_TICKS(LVGL_PORT_CURSOR_WAIT_MS)) {
+        vTaskDelay(1);
+    }
+    if (disp_ctx->pm_flushing || disp_ctx->cursor.sending) {
+        /* Moved by the next reading */
+        return;
+    }
+
+    const lv_area_t old_area = disp_ctx->cursor.area;
+    lv_area_set(&disp_ctx->cursor.area, x, y, x + disp_ctx->cursor.w - 1, y + disp_ctx->cursor.h - 1);
+
+    /* Overlapping areas are sent as one, the union is at most 2x2 cursor sizes */
+    lv_area_t parts[2];
+    int part_cnt;
+    if (lv_area_intersect(&parts[0], &old_area, &disp_ctx->cursor.area)) {
+        parts[0].x1 = LV_MIN(old_area.x1, disp_ctx->cursor.area.x1);
+        parts[0].y1 = LV_MIN(old_area.y1, disp_ctx->cursor.area.y1);
+        parts[0].x2 = LV_MAX(old_area.x2, disp_ctx->cursor.area.x2);
+        parts[0].y2 = LV_MAX(old_area.y2, disp_ctx->cursor.area.y2);
+        part_cnt = 1;
+    } else {
+        parts[0] = old_area;
+        parts[1] = disp_ctx->cursor.area;
+        part_cnt = 2;
+    }
+
+    const int32_t hres = lv_display_get_horizontal_resolution(disp);
+    lv_area_t screen;
+    lv_area_set(&screen, 0, 0, hres - 1, lv_display_get_vertical_resolution(disp) - 1);
+    uint16_t *bufs[2];
+    uint16_t *buf = disp_ctx->cursor.tx_buf;
+    int send_cnt = 0;
+    for (int i = 0; i < part_cnt; i++) {
+        lv_area_t *part = &parts[send_cnt];
+        if (!lv_area_intersect(part, &parts[i], &screen)) {
+            continue;
+        }
+        /* Rows of the shadow screen with the cursor blended over them */
+        const int32_t part_w = lv_area_get_width(part);
+        for (int32_t row = part->y1; row <= part->y2; row++) {
+            memcpy(buf + (row - part->y1) * part_w, disp_ctx->cursor.shadow + row * hres + part->x1, part_w * sizeof(uint16_t));
+        }
+        lvgl_port_cursor_blend(disp_ctx, part, buf);
+        if (disp_ctx->flags.swap_bytes) {
+            lvgl_port_transform_rgb565_swap(buf, lv_area_get_size(part));
+        }
+        bufs[send_cnt++] = buf;
+        buf += lv_area_get_size(part);
+    }
+
+    /* Set before the first transfer, the done callback can come before the second one is queued */
+    disp_ctx->cursor.sending = send_cnt;
+    for (int i = 0; i < send_cnt; i++) {
+        esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, parts[i].x1, parts[i].y1, parts[i].x2 + 1, parts[i].y2 + 1, bufs[i]);
+    }
+}
+
+/*******************************************************************************
+* Private functions
+*******************************************************************************/
+
+static lv_display_t *lvgl_port_add_disp_priv(const lvgl_port_display_cfg_t *disp_cfg, lvgl_port_disp_type_t disp_type, const lvgl_port_disp_priv_cfg_t *priv_cfg)
+{
+    esp_err_t ret = ESP_OK;
+    lv_display_t *disp = NULL;
+    lv_color_t *buf1 = NULL;
+    lv_color_t *buf2 = NULL;
+    uint32_t buffer_size = 0;
+    assert(disp_cfg != NULL);
+    assert(disp_cfg->panel_handle != NULL);
+    assert(disp_cfg->buffer_size > 0 || disp_cfg->flags.buff_auto);
+    assert(disp_cfg->hres > 0);
+    assert(disp_cfg->vres > 0);
+
+    buffer_size = disp_cfg->buffer_size;
+
+    /* Check supported display color formats */
+    ESP_RETURN_ON_FALSE(disp_cfg->color_format == 0 || disp_cfg->color_format == LV_COLOR_FORMAT_RGB565 || disp_cfg->color_format == LV_COLOR_FORMAT_RGB888 || disp_cfg->color_format == LV_COLOR_FORMAT_XRGB8888 || disp_cfg->color_format == LV_COLOR_FORMAT_ARGB8888 || disp_cfg->color_format == LV_COLOR_FORMAT_L8, NULL, TAG, "Not supported display color format!");
+
+    lv_color_format_t display_color_format = (disp_cfg->color_format != 0 ? disp_cfg->color_format : LV_COLOR_FORMAT_RGB565);
+    if (display_color_format == LV_COLOR_FORMAT_L8) {
+        /* L8 indexes are expanded to RGB565 during copy into transport buffers */
+        ESP_RETURN_ON_FALSE(disp_cfg->clut && disp_cfg->trans_size && priv_cfg == NULL && !disp_cfg->monochrome, NULL, TAG, "Color format L8 needs CLUT and transport buffer (SPI/I80 display only)!");
+    }
+
+    if (disp_cfg->flags.swap_bytes) {
+        /* Swap bytes can be used only in RGB656 color format (or in RGB565 CLUT) */
+        ESP_RETURN_ON_FALSE(display_color_format == LV_COLOR_FORMAT_RGB565 || display_color_format == LV_COLOR_FORMAT_L8, NULL, TAG, "Swap bytes can be used only in display color format RGB565 or L8!");
+    }
+    const uint32_t px_size = (display_color_format == LV_COLOR_FORMAT_L8 ? 1 : sizeof(lv_color_t));
+
+    if (disp_cfg->buffer_count) {
+        /* Only the done callback of panel IO returns the flushed buffers into the ring */
+        ESP_RETURN_ON_FALSE(disp_type == LVGL_PORT_DISP_TYPE_OTHER, NULL, TAG, "Draw buffer ring is not supported with RGB and MIPI-DSI display!");
+        /* Flushed buffers are sent directly by DMA, nothing can be transformed into another buffer or sent in parts */
+        ESP_RETURN_ON_FALSE(disp_cfg->buffer_count >= 2 && disp_cfg->buffer_count <= LVGL_PORT_DRAW_RING_MAX, NULL, TAG, "Draw buffer count must be 2 to %d!", LVGL_PORT_DRAW_RING_MAX);
+        ESP_RETURN_ON_FALSE(!disp_cfg->double_buffer && !disp_cfg->flags.buff_auto && disp_cfg->trans_size == 0 && disp_cfg->solid_size == 0 &&
+                            !disp_cfg->flags.sw_rotate && !disp_cfg->flags.flush_in_task && !disp_cfg->flags.round_mask &&
+                            !disp_cfg->flags.full_refresh && !disp_cfg->flags.direct_mode && !disp_cfg->monochrome, NULL, TAG,
+                            "Draw buffer ring is supported only with SPI/I80 display in partial mode without double_buffer, buff_auto, transport and pattern buffer, SW rotation, flush task and round mask!");
+    }
+
+    if (disp_cfg->flags.buff_dma) {
+        /* DMA buffer can be used only in RGB656 color format */
+        ESP_RETURN_ON_FALSE(display_color_format == LV_COLOR_FORMAT_RGB565, NULL, TAG, "DMA buffer can be used only in display color format RGB565 (not alligned copy)!");
+    }
+
+    /* Display context (internal RAM, it is read from RGB panel ISR) */
+    lvgl_port_display_ctx_t *disp_ctx = heap_caps_malloc(sizeof(lvgl_port_display_ctx_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    ESP_GOTO_ON_FALSE(disp_ctx, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for display context allocation!");
+    memset(disp_ctx, 0, sizeof(lvgl_port_display_ctx_t));
+    disp_ctx->disp_type = disp_type;
+    disp_ctx->io_handle = disp_cfg->io_handle;
+    disp_ctx->panel_handle = disp_cfg->panel_handle;
+    disp_ctx->control_handle = disp_cfg->control_handle;
+    disp_ctx->rotation.swap_xy = disp_cfg->rotation.swap_xy;
+    disp_ctx->rotation.mirror_x = disp_cfg->rotation.mirror_x;
+    disp_ctx->rotation.mirror_y = disp_cfg->rotation.mirror_y;
+    disp_ctx->flags.swap_bytes = disp_cfg->flags.swap_bytes;
+    disp_ctx->flags.sw_rotate = disp_cfg->flags.sw_rotate;
+    disp_ctx->current_rotation = LV_DISPLAY_ROTATION_0;
+    disp_ctx->trans_size = disp_cfg->trans_size;
+    if (!disp_cfg->flags.full_refresh && !disp_cfg->flags.direct_mode && !disp_cfg->monochrome) {
+        disp_ctx->merge_overhead = disp_cfg->merge_overhead;
+    }
+
+    uint32_t buff_caps = 0;
+#if SOC_PSRAM_DMA_CAPABLE == 0
+    if (disp_cfg->flags.buff_dma && disp_cfg->flags.buff_spiram && (0 == disp_cfg->trans_size)) {
+        ESP_GOTO_ON_FALSE(false, ESP_ERR_NOT_SUPPORTED, err, TAG, "Alloc DMA capable buffer in SPIRAM is not supported!");
+    }
+#endif
+    if (disp_cfg->flags.buff_dma && (0 == disp_cfg->trans_size)) {
+        buff_caps |= MALLOC_CAP_DMA;
+    }
+    if (disp_cfg->flags.buff_spiram) {
+        buff_caps |= MALLOC_CAP_SPIRAM;
+    }
+    if (buff_caps == 0) {
+        buff_caps |= MALLOC_CAP_DEFAULT;
+    }
+
+    /* Use RGB internal buffers for avoid tearing effect */
+    if (priv_cfg && priv_cfg->avoid_tearing) {
+#if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+        buffer_size = disp_cfg->hres * disp_cfg->vres;
+        if (priv_cfg->triple_buffer) {
+            ESP_GOTO_ON_FALSE(disp_cfg->flags.full_refresh, ESP_ERR_INVALID_ARG, err, TAG, "Triple buffer can be used only with full refresh!");
+            ESP_GOTO_ON_ERROR(esp_lcd_rgb_panel_get_frame_buffer(disp_cfg->panel_handle, 3, &disp_ctx->rgb_fbs[0], &disp_ctx->rgb_fbs[1], &disp_ctx->rgb_fbs[2]), err, TAG, "Get RGB buffers failed");
+            /* The first frame buffer is displayed after init, LVGL renders into the second one. The draw buffer is switched in the flush callback. */
+            disp_ctx->flags.triple_buffer = 1;
+            disp_ctx->rgb_fb_displayed = 0;
+            disp_ctx->rgb_fb_pending = -1;
+            portMUX_INITIALIZE(&disp_ctx->rgb_fb_lock);
+            buf1 = disp_ctx->rgb_fbs[1];
+        } else {
+            ESP_GOTO_ON_ERROR(esp_lcd_rgb_panel_get_frame_buffer(disp_cfg->panel_handle, 2, (void *)&buf1, (void *)&buf2), err, TAG, "Get RGB buffers failed");
+        }
+#endif
+    } else if (disp_cfg->flags.buff_auto) {
+        const lvgl_port_buff_auto_cfg_t auto_cfg = {
+            .hres = disp_cfg->hres,
+            .vres = disp_cfg->vres,
+            .px_size = px_size,
+            .full = (disp_cfg->flags.full_refresh || disp_cfg->flags.direct_mode || disp_cfg->monochrome),
+            /* DMA buffer can be used only in RGB656 color format */
+            .dma = (disp_cfg->trans_size == 0 && display_color_format == LV_COLOR_FORMAT_RGB565),
+            /* SPI and I80 are faster from internal RAM, RGB and MIPI-DSI panels copy the data into their frame buffers */
+            .internal_first = (disp_type == LVGL_PORT_DISP_TYPE_OTHER),
+#if SOC_PSRAM_DMA_CAPABLE
+            .psram_allowed = true,
+#else
+            .psram_allowed = (disp_type != LVGL_PORT_DISP_TYPE_OTHER || disp_cfg->trans_size > 0),
+#endif
+        };
+        lvgl_port_buff_auto_t auto_buff;
+        ESP_GOTO_ON_ERROR(lvgl_port_buffers_auto(&auto_cfg, &auto_buff), err, TAG, "Not enough memory for LVGL buffer allocation!");
+        buf1 = auto_buff.buf1;
+        buf2 = auto_buff.buf2;
+        buffer_size = auto_buff.buffer_size;
+        buff_caps = auto_buff.caps;
+
+        disp_ctx->draw_buffs[0] = buf1;
+        disp_ctx->draw_buffs[1] = buf2;
+        disp_ctx->draw_buf_caps = buff_caps;
+        disp_ctx->draw_buf_size = buffer_size * px_size;
+        disp_ctx->draw_buf_double = (buf2 != NULL);
+    } else {
+        /* alloc draw buffers used by LVGL */
+        /* it's recommended to choose the size of the draw buffer(s) to be at least 1/10 screen sized */
+        buf1 = lvgl_port_buffer_malloc(buffer_size * px_size, buff_caps);
+        ESP_GOTO_ON_FALSE(buf1, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (buf1) allocation!");
+        if (disp_cfg->double_buffer) {
+            buf2 = lvgl_port_buffer_malloc(buffer_size * px_size, buff_caps);
+            ESP_GOTO_ON_FALSE(buf2, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (buf2) allocation!");
+        }
+        if (disp_cfg->buffer_count) {
+            /* LVGL renders into one buffer, its memory is switched to a free buffer of the ring in each flush */
+            disp_ctx->ring.buf[0] = buf1;
+            for (int i = 1; i < disp_cfg->buffer_count; i++) {
+                disp_ctx->ring.buf[i] = lvgl_port_buffer_malloc(buffer_size * px_size, buff_caps);
+                ESP_GOTO_ON_FALSE(disp_ctx->ring.buf[i], ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL buffer (ring) allocation!");
+            }
+            disp_ctx->ring.cnt = disp_cfg->buffer_count;
+            disp_ctx->ring.sem = xSemaphoreCreateCounting(disp_cfg->buffer_count - 1, disp_cfg->buffer_count - 1);
+            ESP_GOTO_ON_FALSE(disp_ctx->ring.sem, ESP_ERR_NO_MEM, err, TAG, "Failed to create draw buffer ring Semaphore");
+        }
+
+        disp_ctx->draw_buffs[0] = buf1;
+        disp_ctx->draw_buffs[1] = buf2;
+        disp_ctx->draw_buf_caps = buff_caps;
+        disp_ctx->draw_buf_size = buffer_size * px_size;
+        disp_ctx->draw_buf_double = (buf2 != NULL);
+    }
+
+    /* Transport buffers in SRAM: one is filled while the others are sent by DMA */
+    if (disp_cfg->trans_size) {
+        /* RGB panels copy data into their frame buffers, transport buffers are supported only for IO with DMA done callback */
+        ESP_GOTO_ON_FALSE(priv_cfg == NULL, ESP_ERR_NOT_SUPPORTED, err, TAG, "Transport buffer is not supported with RGB display!");
+        /* Monochrome buffer is packed in pages of 1 bpp, it cannot be split into lines of pixels */
+        ESP_GOTO_ON_FALSE(!disp_cfg->monochrome, ESP_ERR_INVALID_ARG, err, TAG, "Transport buffer is not supported with monochrome display!");
+        /* Transport buffer must hold at least one line in any rotation */
+        ESP_GOTO_ON_FALSE(disp_cfg->trans_size >= LV_MAX(disp_cfg->hres, disp_cfg->vres), ESP_ERR_INVALID_ARG, err, TAG, "Transport buffer must be at least one line long!");
+        ESP_GOTO_ON_FALSE(disp_cfg->trans_count <= LVGL_PORT_TRANS_BUF_MAX && disp_cfg->trans_count != 1, ESP_ERR_INVALID_ARG, err, TAG, "Transport buffer count must be 2 to %d!", LVGL_PORT_TRANS_BUF_MAX);
+        disp_ctx->trans_cnt = (disp_cfg->trans_count ? disp_cfg->trans_count : 2);
+        /* Pixels are copied in the display color format (lv_color_t is RGB888), L8 indexes are expanded to RGB565 */
+        disp_ctx->trans_buf_size = (size_t)disp_cfg->trans_size *
+                                   (display_color_format == LV_COLOR_FORMAT_L8 ? sizeof(uint16_t) : lv_color_format_get_size(display_color_format));
+        for (int i = 0; i < disp_ctx->trans_cnt; i++) {
+            disp_ctx->trans_buf[i] = heap_caps_malloc(disp_ctx->trans_buf_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+            ESP_GOTO_ON_FALSE(disp_ctx->trans_buf[i], ESP_ERR_NO_MEM, err, TAG, "Not enough memory for buffer(transport) allocation!");
+        }
+
+        disp_ctx->trans_sem = xSemaphoreCreateCounting(disp_ctx->trans_cnt, disp_ctx->trans_cnt);
+        ESP_GOTO_ON_FALSE(disp_ctx->trans_sem, ESP_ERR_NO_MEM, err, TAG, "Failed to create transport counting Semaphore");
+    }
+
+    /* Palette is looked up for each pixel, keep it in internal RAM */
+    if (display_color_format == LV_COLOR_FORMAT_L8) {
+        disp_ctx->clut = heap_caps_malloc(256 * sizeof(uint16_t), MALLOC_CAP_INTERNAL);
+        ESP_GOTO_ON_FALSE(disp_ctx->clut, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for CLUT allocation!");
+        if (disp_cfg->flags.swap_bytes) {
+            lvgl_port_transform_rgb565_swap_copy(disp_ctx->clut, disp_cfg->clut, 256);
+        } else {
+            memcpy(disp_ctx->clut, disp_cfg->clut, 256 * sizeof(uint16_t));
+        }
+    }
+
+    /* Areas of one color are sent from a small pattern buffer, DMA does not read them from the (PSRAM) draw buffer.
+     * The bands are counted down in the panel IO done callback, MIPI-DSI and RGB panels cannot send them. */
+    if (disp_cfg->solid_size) {
+        ESP_GOTO_ON_FALSE(disp_type == LVGL_PORT_DISP_TYPE_OTHER && display_color_format == LV_COLOR_FORMAT_RGB565 && !disp_cfg->monochrome, ESP_ERR_NOT_SUPPORTED, err, TAG,
+                          "Solid color areas are supported only with RGB565 SPI/I80 display!");
+        /* Pattern buffer must hold at least one line in any rotation */
+        ESP_GOTO_ON_FALSE(disp_cfg->solid_size >= LV_MAX(disp_cfg->hres, disp_cfg->vres), ESP_ERR_INVALID_ARG, err, TAG, "Pattern buffer must be at least one line long!");
+        disp_ctx->solid.buf = heap_caps_malloc(disp_cfg->solid_size * sizeof(uint16_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        ESP_GOTO_ON_FALSE(disp_ctx->solid.buf, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for buffer(pattern) allocation!");
+        disp_ctx->solid.size = disp_cfg->solid_size;
+    }
+
+    if (disp_cfg->flags.flush_in_task) {
+        /* RGB panels wait for VSYNC notification in the LVGL task */
+        ESP_GOTO_ON_FALSE(priv_cfg == NULL, ESP_ERR_NOT_SUPPORTED, err, TAG, "Flush task is not supported with RGB display!");
+        /* Without second buffer LVGL waits for the flush ready and nothing can overlap */
+        ESP_GOTO_ON_FALSE(buf2 != NULL, ESP_ERR_INVALID_ARG, err, TAG, "Flush task needs double buffer!");
+    }
+
+    if (disp_cfg->flags.te_sync) {
+        /* RGB panels are synchronized by VSYNC */
+        ESP_GOTO_ON_FALSE(priv_cfg == NULL, ESP_ERR_NOT_SUPPORTED, err, TAG, "TE synchronization is not supported with RGB display!");
+        ESP_GOTO_ON_ERROR(lvgl_port_te_init(disp_cfg->te_gpio_num, &disp_ctx->te), err, TAG, "TE synchronization init failed!");
+    }
+
+    if (priv_cfg && priv_cfg->compressed_fb) {
+        /* Areas are compressed line by line, LVGL renders into small internal buffers */
+        ESP_GOTO_ON_FALSE(!priv_cfg->avoid_tearing && !disp_cfg->flags.full_refresh && !disp_cfg->flags.direct_mode && !disp_cfg->monochrome && display_color_format == LV_COLOR_FORMAT_RGB565,
+                          ESP_ERR_NOT_SUPPORTED, err, TAG, "Compressed frame buffer is supported only in partial mode with RGB565!");
+        ESP_GOTO_ON_ERROR(lvgl_port_cfb_init(disp_cfg->hres, disp_cfg->vres, &disp_ctx->cfb), err, TAG, "Compressed frame buffer init failed!");
+    }
+
+    if (priv_cfg && priv_cfg->dma_copy) {
+        /* Areas are extended to whole lines, each flushed area is one block of the frame buffer */
+        ESP_GOTO_ON_FALSE(!priv_cfg->avoid_tearing && !priv_cfg->compressed_fb && !disp_cfg->flags.full_refresh && !disp_cfg->flags.direct_mode &&
+                          !disp_cfg->flags.sw_rotate && !disp_cfg->monochrome && display_color_format == LV_COLOR_FORMAT_RGB565,
+                          ESP_ERR_NOT_SUPPORTED, err, TAG, "DMA copy is supported only in partial mode with RGB565 and without SW rotation!");
+#if LVGL_PORT_RGB_DMA_COPY_SUPPORTED
+        ESP_GOTO_ON_ERROR(lvgl_port_rgb_dma_copy_init(disp_ctx, disp_cfg->panel_handle), err, TAG, "DMA copy init failed!");
+#else
+        ESP_LOGW(TAG, "DMA copy is supported only on ESP32S3 and from IDF 5.2, the draw buffers are copied by CPU");
+#endif
+    }
+
+    if (disp_cfg->flags.tile_hash) {
+        /* Panel content is known only from the areas copied into the transport buffers */
+        ESP_GOTO_ON_FALSE(priv_cfg == NULL && disp_cfg->trans_size && !disp_cfg->flags.direct_mode && !disp_cfg->monochrome, ESP_ERR_NOT_SUPPORTED, err, TAG,
+                          "Tile hash is supported only with SPI/I80 display with transport buffer, without direct mode and monochrome!");
+        ESP_GOTO_ON_ERROR(lvgl_port_tile_init(disp_cfg->hres, disp_cfg->vres, &disp_ctx->tiles), err, TAG, "Tile hash init failed!");
+    }
+
+    if (disp_cfg->flags.round_mask) {
+        /* Rows are compacted in the draw buffer, its content must not be kept between frames */
+        ESP_GOTO_ON_FALSE(priv_cfg == NULL && disp_cfg->trans_size == 0 && !disp_cfg->flags.direct_mode && !disp_cfg->monochrome, ESP_ERR_NOT_SUPPORTED, err, TAG,
+                          "Round mask is supported only with SPI/I80 display without transport buffer, direct mode and monochrome!");
+        ESP_GOTO_ON_FALSE(disp_cfg->hres == disp_cfg->vres, ESP_ERR_INVALID_ARG, err, TAG, "Round mask needs square resolution!");
+        disp_ctx->round_size = disp_cfg->hres;
+    }
+
+    disp = lv_display_create(disp_cfg->hres, disp_cfg->vres);
+
+    /* Each display has its own refresh timer, a slow display is not refreshed at the rate of the main one */
+    disp_ctx->refr_period = (disp_cfg->refresh_period_ms ? disp_cfg->refresh_period_ms : LV_DEF_REFR_PERIOD);
+    disp_ctx->bus.start = esp_timer_get_time();
+    if (lv_display_get_refr_timer(disp)) {
+        lv_timer_set_period(lv_display_get_refr_timer(disp), disp_ctx->refr_period);
+    }
+
+    /* Monochrome display settings */
+    if (disp_cfg->monochrome) {
+        /* When using monochromatic display, there must be used full bufer! */
+        ESP_GOTO_ON_FALSE((disp_cfg->hres * disp_cfg->vres == buffer_size), ESP_ERR_INVALID_ARG, err, TAG, "Monochromatic display must using full buffer!");
+
+        disp_ctx->flags.monochrome = 1;
+        /* Without this buffer, all pages are sent in every frame */
+        disp_ctx->mono_prev = malloc(disp_cfg->hres * disp_cfg->vres / 8);
+        lv_display_set_buffers(disp, buf1, buf2, buffer_size * px_size, LV_DISPLAY_RENDER_MODE_FULL);
+    } else if (disp_cfg->flags.direct_mode) {
+        /* When using direct_mode, there must be used full bufer! */
+        ESP_GOTO_ON_FALSE((disp_cfg->hres * disp_cfg->vres == buffer_size), ESP_ERR_INVALID_ARG, err, TAG, "Direct mode must using full buffer!");
+
+        disp_ctx->flags.direct_mode = 1;
+        lv_display_set_buffers(disp, buf1, buf2, buffer_size * px_size, LV_DISPLAY_RENDER_MODE_DIRECT);
+    } else if (disp_cfg->flags.full_refresh) {
+        /* When using full_refresh, there must be used full bufer! */
+        ESP_GOTO_ON_FALSE((disp_cfg->hres * disp_cfg->vres == buffer_size), ESP_ERR_INVALID_ARG, err, TAG, "Full refresh must using full buffer!");
+
+        disp_ctx->flags.full_refresh = 1;
+        lv_display_set_buffers(disp, buf1, buf2, buffer_size * px_size, LV_DISPLAY_RENDER_MODE_FULL);
+    } else {
+        lv_display_set_buffers(disp, buf1, buf2, buffer_size * px_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    }
+
+    lv_display_set_color_format(disp, display_color_format);
+    lv_display_set_flush_cb(disp, lvgl_port_flush_callback);
+    lv_display_add_event_cb(disp, lvgl_port_disp_size_update_callback, LV_EVENT_RESOLUTION_CHANGED, disp_ctx);
+    lv_display_add_event_cb(disp, lvgl_port_display_invalidate_callback, LV_EVENT_INVALIDATE_AREA, disp_ctx);
+    lv_display_add_event_cb(disp, lvgl_port_display_invalidate_callback, LV_EVENT_REFR_REQUEST, disp_ctx);
+    if (disp_ctx->merge_overhead) {
+        lv_display_add_event_cb(disp, lvgl_port_display_refr_ready_callback, LV_EVENT_REFR_READY, disp_ctx);
+    }
+    lv_display_add_event_cb(disp, lvgl_port_display_perf_callback, LV_EVENT_REFR_START, disp_ctx);
+    lv_display_add_event_cb(disp, lvgl_port_display_perf_callback, LV_EVENT_REFR_READY, disp_ctx);
+
+    lv_display_set_user_data(disp, disp_ctx);
+    disp_ctx->disp_drv = disp;
+
+    /* Use SW rotation. Line strips of the rotated area are written directly into the transport buffers (SRAM), without `trans_size`
+     * two strips are allocated as transport buffers while the display is rotated. Only RGB displays, round mask, L8 and monochrome
+     * need the rotation buffer of the whole area (allocated in the flush when the display is rotated). */
+    if (disp_cfg->flags.sw_rotate) {
+        disp_ctx->rot_strips = (disp_type != LVGL_PORT_DISP_TYPE_RGB && disp_ctx->tiles == NULL &&
+                                disp_ctx->clut == NULL && disp_ctx->round_size == 0 && !disp_cfg->monochrome);
+        if (disp_ctx->rot_strips && disp_ctx->trans_sem == NULL) {
+            disp_ctx->rot_strip_size = LVGL_PORT_ROT_STRIP_LINES * LV_MAX(disp_cfg->hres, disp_cfg->vres);
+        }
+        if (!disp_ctx->rot_strips) {
+            disp_ctx->rot_buf_size = buffer_size * px_size;
+            disp_ctx->rot_buf_caps = buff_caps;
+        }
+    }
+
+    if (disp_cfg->flags.flush_in_task) {
+        ESP_GOTO_ON_ERROR(lvgl_port_flush_task_init(disp_ctx, disp_cfg), err, TAG, "Flush task init failed!");
+    }
+
+    lvgl_port_disp_mem_account(disp_ctx, true);
+
+err:
+    if (ret != ESP_OK) {
+        /* RGB frame buffers are owned by the LCD driver */
+        if (buf1 && !(priv_cfg && priv_cfg->avoid_tearing)) {
+            free(buf1);
+        }
+        if (buf2 && !(priv_cfg && priv_cfg->avoid_tearing)) {
+            free(buf2);
+        }
+        for (int i = 0; disp_ctx && i < LVGL_PORT_TRANS_BUF_MAX; i++) {
+            if (disp_ctx->trans_buf[i]) {
+                free(disp_ctx->trans_buf[i]);
+            }
+        }
+        if (disp_ctx && disp_ctx->trans_sem) {
+            vSemaphoreDelete(disp_ctx->trans_sem);
+        }
+        if (disp_ctx && disp_ctx->clut) {
+            free(disp_ctx->clut);
+        }
+        if (disp_ctx && disp_ctx->solid.buf) {
+            free(disp_ctx->solid.buf);
+        }
+        for (int i = 1; disp_ctx && i < LVGL_PORT_DRAW_RING_MAX; i++) {
+            if (disp_ctx->ring.buf[i]) {
+                free(disp_ctx->ring.buf[i]);
+            }
+        }
+        if (disp_ctx && disp_ctx->ring.sem) {
+            vSemaphoreDelete(disp_ctx->ring.sem);
+        }
+        if (disp_ctx && disp_ctx->mono_prev) {
+            free(disp_ctx->mono_prev);
+        }
+        if (disp_ctx) {
+            lvgl_port_flush_task_deinit(disp_ctx);
+            lvgl_port_te_deinit(disp_ctx->te);
+            lvgl_port_cfb_deinit(disp_ctx->cfb);
+            lvgl_port_tile_deinit(disp_ctx->tiles);
+#if LVGL_PORT_RGB_DMA_COPY_SUPPORTED
+            if (disp_ctx->dma_copy) {
+                esp_async_memcpy_uninstall(disp_ctx->dma_copy);
+            }
+#endif
+        }
+        if (disp_ctx) {
+            free(disp_ctx);
+        }
+    }
+
+    return disp;
+}
+
+#if LVGL_PORT_HANDLE_FLUSH_READY
+/* Release the sent transport buffer. The bus transfer time ends, when no transport buffer is in flight. */
+static void lvgl_port_trans_release_from_isr(lvgl_port_display_ctx_t *disp_ctx, BaseType_t *task_awake)
+{
+    xSemaphoreGiveFromISR(disp_ctx->trans_sem, task_awake);
+    if (uxSemaphoreGetCountFromISR(disp_ctx->trans_sem) == disp_ctx->trans_cnt) {
+        const uint32_t busy = (uint32_t)(esp_timer_get_time() - disp_ctx->trans_busy_start);
+        disp_ctx->perf_cur.trans_time += busy;
+        disp_ctx->bus.busy += busy;
+    }
+}
+
+static bool lvgl_port_flush_io_ready_callback(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
+{
+    BaseType_t taskAwake = pdFALSE;
+
+    lv_display_t *disp_drv = (lv_display_t *)user_ctx;
+    assert(disp_drv != NULL);
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp_drv);
+    assert(disp_ctx != NULL);
+
+    if (disp_ctx->cursor.sending) {
+        /* Cursor area is sent only when no flush is in progress */
+        disp_ctx->cursor.sending--;
+    } else if (disp_ctx->trans_size && disp_ctx->trans_sem) {
+        /* Transport buffer is free again, LVGL was already notified in flush callback */
+        lvgl_port_trans_release_from_isr(disp_ctx, &taskAwake);
+    } else if (disp_ctx->ring.sem) {
+        /* Draw buffer of the ring is free again, LVGL was already notified in flush callback */
+        xSemaphoreGiveFromISR(disp_ctx->ring.sem, &taskAwake);
+    } else if (disp_ctx->parts_pending > 1) {
+        /* More parts of the flushed area are being sent */
+        disp_ctx->parts_pending--;
+    } else {
+        disp_ctx->parts_pending = 0;
+        lvgl_port_disp_flush_ready(disp_drv);
+    }
+
+    return (taskAwake == pdTRUE);
+}
+
+#if (CONFIG_IDF_TARGET_ESP32P4 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0))
+static bool lvgl_port_flush_panel_ready_callback(esp_lcd_panel_handle_t panel_io, esp_lcd_dpi_panel_event_data_t *edata, void *user_ctx)
+{
+    BaseType_t taskAwake = pdFALSE;
+
+    lv_display_t *disp_drv = (lv_display_t *)user_ctx;
+    assert(disp_drv != NULL);
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp_drv);
+    assert(disp_ctx != NULL);
+
+    if (disp_ctx->trans_size && disp_ctx->trans_sem) {
+        /* Transport buffer is free again, LVGL was already notified in flush callback */
+        lvgl_port_trans_release_from_isr(disp_ctx, &taskAwake);
+    } else {
+        lvgl_port_disp_flush_ready(disp_drv);
+    }
+
+    return (taskAwake == pdTRUE);
+}
+#endif
+
+#if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+static LVGL_PORT_RGB_ISR_ATTR bool lvgl_port_flush_vsync_ready_callback(esp_lcd_panel_handle_t panel_io, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
+{
+    BaseType_t need_yield = pdFALSE;
+
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)user_ctx;
+    assert(disp_ctx != NULL);
+    disp_ctx->vsync_cnt++;
+    if (disp_ctx->flags.triple_buffer) {
+        portENTER_CRITICAL_ISR(&disp_ctx->rgb_fb_lock);
+        if (disp_ctx->rgb_fb_pending >= 0 && disp_ctx->rgb_fb_queued) {
+            /* The pending frame buffer is displayed from now */
+            disp_ctx->rgb_fb_displayed = disp_ctx->rgb_fb_pending;
+            disp_ctx->rgb_fb_pending = -1;
+            disp_ctx->rgb_fb_queued = false;
+        }
+        portEXIT_CRITICAL_ISR(&disp_ctx->rgb_fb_lock);
+    }
+    need_yield = lvgl_port_task_notify(ULONG_MAX);
+    lvgl_port_task_wake(LVGL_PORT_EVENT_DISPLAY, disp_ctx->disp_drv);
+
+    return (need_yield == pdTRUE);
+}
+
+static LVGL_PORT_RGB_ISR_ATTR bool lvgl_port_rgb_bounce_empty_callback(esp_lcd_panel_handle_t panel, void *bounce_buf, int pos_px, int len_bytes, void *user_ctx)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)user_ctx;
+    assert(disp_ctx != NULL);
+    lvgl_port_cfb_read(disp_ctx->cfb, pos_px, bounce_buf, len_bytes / sizeof(uint16_t));
+    return false;
+}
+#endif
+#endif
+
+/* Monochrome pixel is lit when its blue channel is dark */
+static inline uint8_t lvgl_port_mono_px(const uint8_t *src, size_t idx, uint32_t px_size)
+{
+    if (px_size == 2) {
+        /* RGB565: blue are the lowest 5 bits */
+        return ((((const uint16_t *)src)[idx] & 0x1F) <= (16 >> 3));
+    }
+    return (src[idx * px_size] <= 16);
+}
+
+static void _lvgl_port_transform_monochrome(lv_display_t *display, const lv_area_t *area, uint8_t *color_map)
+{
+    uint8_t *buf = color_map;
+    const uint32_t px_size = lv_color_format_get_size(lv_display_get_color_format(display));
+    uint16_t hor_res = lv_display_get_physical_horizontal_resolution(display);
+    uint16_t ver_res = lv_display_get_physical_vertical_resolution(display);
+    uint16_t res = hor_res;
+    bool swap_xy = (lv_display_get_rotation(display) == LV_DISPLAY_ROTATION_90 || lv_display_get_rotation(display) == LV_DISPLAY_ROTATION_270);
+
+    int x1 = area->x1;
+    int x2 = area->x2;
+    int y1 = area->y1;
+    int y2 = area->y2;
+
+    int out_x, out_y;
+    for (int y = y1; y <= y2; y++) {
         for (int x = x1; x <= x2; x++) {
-            bool chroma_color = (color[hor_res * y + x].blue > 16);
+            bool chroma_color = !lvgl_port_mono_px(color_map, hor_res * y + x, px_size);
+
+            if (swap_xy) {
+                out_x = y;
+                out_y = x;
+                res = ver_res;
+            } else {
+                out_x = x;
+                out_y = y;
+                res = hor_res;
+            }
+
+            /* Write to the buffer as required for the display.
+            * It writes only 1-bit for monochrome displays mapped vertically.*/
+            buf = color_map + res * (out_y >> 3) + (out_x);
+            if (chroma_color) {
+                (*buf) &= ~(1 << (out_y % 8));
+            } else {
+                (*buf) |= (1 << (out_y % 8));
+            }
+        }
+    }
+}
+
+/* Convert the whole screen page by page (8 rows into one byte per column) and find the pages changed since the last frame.
+ * Returns false, if nothing changed. Conversion is in place, the output of one page never overwrites unread pixels. */
+static bool lvgl_port_transform_monochrome_pages(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *display, uint8_t *color_map, int32_t *page_first, int32_t *page_last)
+{
+    const uint32_t px_size = lv_color_format_get_size(lv_display_get_color_format(display));
+    const int32_t hor_res = lv_display_get_physical_horizontal_resolution(display);
+    const int32_t pages = lv_display_get_physical_vertical_resolution(display) / 8;
+
+    *page_first = -1;
+    *page_last = -1;
+    for (int32_t p = 0; p < pages; p++) {
+        const uint8_t *rows = color_map + (size_t)p * 8 * hor_res * px_size;
+        uint8_t *out = color_map + (size_t)p * hor_res;
+        for (int32_t x = 0; x < hor_res; x++) {
+            uint8_t b = 0;
+            for (int bit = 0; bit < 8; bit++) {
+                b |= lvgl_port_mono_px(rows, bit * hor_res + x, px_size) << bit;
+            }
+            out[x] = b;
+        }
+
+        uint8_t *prev = (disp_ctx->mono_prev ? disp_ctx->mono_prev + (size_t)p * hor_res : NULL);
+        if (prev && disp_ctx->mono_prev_valid && memcmp(prev, out, hor_res) == 0) {
+            continue;
+        }
+        if (prev) {
+            memcpy(prev, out, hor_res);
+        }
+        if (*page_first < 0) {
+            *page_first = p;
+        }
+        *page_last = p;
+    }
+    disp_ctx->mono_prev_valid = (disp_ctx->mono_prev != NULL);
+
+    return (*page_first >= 0);
+}
+
+void lvgl_port_rotate_area(lv_display_t *disp, lv_area_t *area)
+{
+    lv_display_rotation_t rotation = lv_display_get_rotation(disp);
+
+    int32_t w = lv_area_get_width(area);
+    int32_t h = lv_area_get_height(area);
+
+    int32_t hres = lv_display_get_horizontal_resolution(disp);
+    int32_t vres = lv_display_get_vertical_resolution(disp);
+    if (rotation == LV_DISPLAY_ROTATION_90 || rotation == LV_DISPLAY_ROTATION_270) {
+        vres = lv_display_get_horizontal_resolution(disp);
+        hres = lv_display_get_vertical_resolution(disp);
+    }
+
+    switch (rotation) {
+    case LV_DISPLAY_ROTATION_0:
+        return;
+    case LV_DISPLAY_ROTATION_90:
+        area->y2 = vres - area->x1 - 1;
+        area->x1 = area->y1;
+        area->x2 = area->x1 + h - 1;
+        area->y1 = area->y2 - w + 1;
+        break;
+    case LV_DISPLAY_ROTATION_180:
+        area->y2 = vres - area->y1 - 1;
+        area->y1 = area->y2 - h + 1;
+        area->x2 = hres - area->x1 - 1;
+        area->x1 = area->x2 - w + 1;
+        break;
+    case LV_DISPLAY_ROTATION_270:
+        area->x1 = hres - area->y2 - 1;
+        area->y2 = area->x2;
+        area->x2 = area->x1 + h - 1;
+        area->y1 = area->y2 - w + 1;
+        break;
+    }
+}
+
+static void lvgl_port_flush_callback(lv_display_t *drv, const lv_area_t *area, uint8_t *color_map)
+{
+    assert(drv != NULL);
+    assert(area != NULL);
+    assert(color_map != NULL);
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(drv);
+    assert(disp_ctx != NULL);
 
-            if (swap_xy) {
-                out_x = y;
-                out_y = x;
-                res = ver_res;
+    disp_ctx->trace_area = *area;
+    lvgl_port_trace(LVGL_PORT_TRACE_FLUSH, area);
+
+    /* Released in lvgl_port_disp_flush_ready, LVGL doesn't start the next flush before */
+    if (!disp_ctx->pm_flushing) {
+        disp_ctx->pm_flushing = true;
+        lvgl_port_pm_flush_acquire();
+    }
+
+    /* Remote mirror and screenshot get the pixels as rendered by LVGL */
+    if (disp_ctx->mirror || disp_ctx->screenshot) {
+        const int32_t hres = lv_display_get_horizontal_resolution(drv);
+        const uint16_t *px = (const uint16_t *)color_map;
+        int32_t stride = lv_area_get_width(area);
+        if (disp_ctx->flags.direct_mode) {
+            px += area->y1 * hres + area->x1;
+            stride = hres;
+        }
+        if (disp_ctx->mirror) {
+            lvgl_port_mirror_capture(disp_ctx->mirror, area, px, stride);
+        }
+        if (disp_ctx->screenshot) {
+            lvgl_port_screenshot_capture(drv, area, px, stride);
+        }
+    }
+
+    /* Cursor is blended before the bytes are swapped */
+    if (disp_ctx->cursor.shadow) {
+        lvgl_port_cursor_flush(disp_ctx, area, color_map);
+    }
+
+    if (disp_ctx->flush_queue) {
+        /* Flush task transforms and sends the data, LVGL can render into the second buffer */
+        lvgl_port_flush_job_t job = {
+            .area = *area,
+            .color_map = color_map,
+        };
+        xQueueSend(disp_ctx->flush_queue, &job, portMAX_DELAY);
+        return;
+    }
+
+    lvgl_port_flush_measured(disp_ctx, drv, area, color_map);
+}
+
+static void lvgl_port_flush_measured(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, uint8_t *color_map)
+{
+    /* Writing of a new frame starts in V-blanking, the panel does not show two frames at once */
+    if (disp_ctx->te && disp_ctx->perf_cur.flush_cnt == 0) {
+        lvgl_port_te_wait(disp_ctx->te);
+    }
+
+    const int64_t flush_start = esp_timer_get_time();
+    disp_ctx->perf_flush_start = flush_start;
+    disp_ctx->perf_cur.flush_cnt++;
+    disp_ctx->perf_cur.flush_px += lv_area_get_size(area);
+
+    lvgl_port_flush_area(disp_ctx, drv, area, color_map);
+
+    disp_ctx->perf_cur.flush_time += (uint32_t)(esp_timer_get_time() - flush_start);
+}
+
+static void lvgl_port_flush_task(void *arg)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)arg;
+    lvgl_port_flush_job_t job;
+
+    while (1) {
+        xQueueReceive(disp_ctx->flush_queue, &job, portMAX_DELAY);
+        if (job.color_map == NULL) {
+            break;
+        }
+        lvgl_port_flush_measured(disp_ctx, disp_ctx->disp_drv, &job.area, job.color_map);
+    }
+
+    if (job.notify) {
+        xTaskNotifyGive(job.notify);
+    }
+    vTaskDelete(NULL);
+}
+
+static esp_err_t lvgl_port_flush_task_init(lvgl_port_display_ctx_t *disp_ctx, const lvgl_port_display_cfg_t *disp_cfg)
+{
+    const int stack = (disp_cfg->flush_task.task_stack > 0 ? disp_cfg->flush_task.task_stack : LVGL_PORT_FLUSH_TASK_STACK);
+    ESP_RETURN_ON_FALSE(disp_cfg->flush_task.task_affinity < (configNUM_CORES), ESP_ERR_INVALID_ARG, TAG, "Bad core number for flush task! Maximum core number is %d", (configNUM_CORES - 1));
+
+    /* LVGL waits for flush ready before next flush, only one area can be in the queue */
+    disp_ctx->flush_queue = xQueueCreate(1, sizeof(lvgl_port_flush_job_t));
+    ESP_RETURN_ON_FALSE(disp_ctx->flush_queue, ESP_ERR_NO_MEM, TAG, "Create flush queue fail!");
+
+    BaseType_t res;
+    if (disp_cfg->flush_task.task_affinity < 0) {
+        res = xTaskCreate(lvgl_port_flush_task, "LVGL flush", stack, disp_ctx, disp_cfg->flush_task.task_priority, &disp_ctx->flush_task);
+    } else {
+        res = xTaskCreatePinnedToCore(lvgl_port_flush_task, "LVGL flush", stack, disp_ctx, disp_cfg->flush_task.task_priority, &disp_ctx->flush_task, disp_cfg->flush_task.task_affinity);
+    }
+    if (res != pdPASS) {
+        vQueueDelete(disp_ctx->flush_queue);
+        disp_ctx->flush_queue = NULL;
+        disp_ctx->flush_task = NULL;
+        ESP_LOGE(TAG, "Create flush task fail!");
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+static void lvgl_port_flush_task_deinit(lvgl_port_display_ctx_t *disp_ctx)
+{
+    if (disp_ctx->flush_task) {
+        /* Stop the flush task after the last queued area */
+        lvgl_port_flush_job_t job = {
+            .color_map = NULL,
+            .notify = xTaskGetCurrentTaskHandle(),
+        };
+        xQueueSend(disp_ctx->flush_queue, &job, portMAX_DELAY);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+        disp_ctx->flush_task = NULL;
+    }
+
+    if (disp_ctx->flush_queue) {
+        vQueueDelete(disp_ctx->flush_queue);
+        disp_ctx->flush_queue = NULL;
+    }
+}
+
+/* Allocate the rotation buffer when the display is rotated and free it in rotation 0.
+ * It is called from the flush, when LVGL already waits for the previous flush ready, so the buffer is not used by DMA. */
+static void lvgl_port_rot_buf_update(lvgl_port_display_ctx_t *disp_ctx)
+{
+    if (disp_ctx->rot_strip_size) {
+        lvgl_port_rot_strips_update(disp_ctx);
+        return;
+    }
+    if (disp_ctx->rot_buf_size == 0) {
+        /* Rotated in line strips into the transport buffers */
+        return;
+    }
+    if (disp_ctx->current_rotation == LV_DISPLAY_ROTATION_0) {
+        if (disp_ctx->draw_buffs[2]) {
+            LVGL_PORT_MEM_REMOVE(disp_ctx->draw_buffs[2], disp_ctx->rot_buf_caps);
+            free(disp_ctx->draw_buffs[2]);
+            disp_ctx->draw_buffs[2] = NULL;
+        }
+    } else if (disp_ctx->draw_buffs[2] == NULL) {
+        disp_ctx->draw_buffs[2] = lvgl_port_buffer_malloc(disp_ctx->rot_buf_size, disp_ctx->rot_buf_caps);
+        if (disp_ctx->draw_buffs[2] == NULL) {
+            ESP_LOGE(TAG, "Not enough memory for LVGL buffer (rotation buffer) allocation!");
+        }
+        LVGL_PORT_MEM_ADD(disp_ctx->draw_buffs[2], disp_ctx->rot_buf_caps);
+    }
+}
+
+/* Allocate two rotation strips as transport buffers when the display is rotated and free them in rotation 0.
+ * The IO done callback releases the transport buffers only while trans_size is set, it is set after allocation and cleared first. */
+static void lvgl_port_rot_strips_update(lvgl_port_display_ctx_t *disp_ctx)
+{
+    if (disp_ctx->current_rotation == LV_DISPLAY_ROTATION_0) {
+        if (disp_ctx->trans_sem == NULL) {
+            return;
+        }
+        /* Wait for the last strips to be sent */
+        for (int i = 0; i < disp_ctx->trans_cnt; i++) {
+            xSemaphoreTake(disp_ctx->trans_sem, portMAX_DELAY);
+        }
+        disp_ctx->trans_size = 0;
+        vSemaphoreDelete(disp_ctx->trans_sem);
+        disp_ctx->trans_sem = NULL;
+        for (int i = 0; i < disp_ctx->trans_cnt; i++) {
+            LVGL_PORT_MEM_REMOVE(disp_ctx->trans_buf[i], MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+            free(disp_ctx->trans_buf[i]);
+            disp_ctx->trans_buf[i] = NULL;
+        }
+        disp_ctx->trans_cnt = 0;
+        disp_ctx->trans_idx = 0;
+    } else if (disp_ctx->trans_sem == NULL) {
+        const lv_color_format_t cf = lv_display_get_color_format(disp_ctx->disp_drv);
+        disp_ctx->trans_buf_size = (size_t)disp_ctx->rot_strip_size * lv_color_format_get_size(cf);
+        disp_ctx->trans_cnt = 2;
+        for (int i = 0; i < disp_ctx->trans_cnt; i++) {
+            disp_ctx->trans_buf[i] = heap_caps_malloc(disp_ctx->trans_buf_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+            LVGL_PORT_MEM_ADD(disp_ctx->trans_buf[i], MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        }
+        disp_ctx->trans_sem = xSemaphoreCreateCounting(disp_ctx->trans_cnt, disp_ctx->trans_cnt);
+        if (disp_ctx->trans_buf[0] == NULL || disp_ctx->trans_buf[1] == NULL || disp_ctx->trans_sem == NULL) {
+            ESP_LOGE(TAG, "Not enough memory for LVGL buffer (rotation strips) allocation!");
+            for (int i = 0; i < disp_ctx->trans_cnt; i++) {
+                LVGL_PORT_MEM_REMOVE(disp_ctx->trans_buf[i], MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+                free(disp_ctx->trans_buf[i]);
+                disp_ctx->trans_buf[i] = NULL;
+            }
+            if (disp_ctx->trans_sem) {
+                vSemaphoreDelete(disp_ctx->trans_sem);
+                disp_ctx->trans_sem = NULL;
+            }
+            disp_ctx->trans_cnt = 0;
+            return;
+        }
+        disp_ctx->trans_idx = 0;
+        disp_ctx->trans_size = disp_ctx->rot_strip_size;
+    }
+}
+
+/* Account buffers of the display (mem_account component), the rotation buffer is accounted when it is allocated */
+static void lvgl_port_disp_mem_account(lvgl_port_display_ctx_t *disp_ctx, bool add)
+{
+#if LVGL_PORT_MEM_ACCOUNT
+    esp_err_t (*account)(const char *subsys, const void *ptr, uint32_t caps) = (add ? mem_account_add : mem_account_remove);
+
+    account(LVGL_PORT_MEM_SUBSYS, disp_ctx, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    /* RGB frame buffers are owned by the LCD driver, draw_buffs are not set for them */
+    account(LVGL_PORT_MEM_SUBSYS, disp_ctx->draw_buffs[0], disp_ctx->draw_buf_caps);
+    account(LVGL_PORT_MEM_SUBSYS, disp_ctx->draw_buffs[1], disp_ctx->draw_buf_caps);
+    for (int i = 0; i < LVGL_PORT_TRANS_BUF_MAX; i++) {
+        account(LVGL_PORT_MEM_SUBSYS, disp_ctx->trans_buf[i], MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    }
+    account(LVGL_PORT_MEM_SUBSYS, disp_ctx->clut, MALLOC_CAP_INTERNAL);
+    account(LVGL_PORT_MEM_SUBSYS, disp_ctx->solid.buf, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    for (int i = 1; i < disp_ctx->ring.cnt; i++) {
+        account(LVGL_PORT_MEM_SUBSYS, disp_ctx->ring.buf[i], disp_ctx->draw_buf_caps);
+    }
+    account(LVGL_PORT_MEM_SUBSYS, disp_ctx->mono_prev, MALLOC_CAP_DEFAULT);
+    if (!add) {
+        /* Rotation buffer is freed with the display */
+        account(LVGL_PORT_MEM_SUBSYS, disp_ctx->draw_buffs[2], disp_ctx->rot_buf_caps);
+    }
+#endif
+}
+
+static void lvgl_port_flush_area(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, uint8_t *color_map)
+{
+    int offsetx1 = area->x1;
+    int offsetx2 = area->x2;
+    int offsety1 = area->y1;
+    int offsety2 = area->y2;
+
+#if LVGL_PORT_PPA_SUPPORTED
+    /* PPA rotates and swaps data directly into the MIPI-DSI frame buffer, flush ready is called from PPA done callback */
+    if (disp_ctx->ppa_handle) {
+        lvgl_port_flush_ppa(disp_ctx, drv, area, color_map);
+        return;
+    }
+#endif
+
+    /* SW rotation enabled */
+    if (disp_ctx->flags.sw_rotate) {
+        lvgl_port_rot_buf_update(disp_ctx);
+    }
+    /* Area of one color is sent from the pattern buffer, rotation and swap of the draw buffer are not needed */
+    if (disp_ctx->solid.buf && lvgl_port_flush_solid(disp_ctx, drv, area, color_map)) {
+        return;
+    }
+    if (disp_ctx->flags.sw_rotate && disp_ctx->current_rotation > LV_DISPLAY_ROTATION_0) {
+        /* SW rotation (and swap bytes in the same pass) */
+        if (disp_ctx->rot_strips && disp_ctx->trans_sem) {
+            lvgl_port_flush_rotate_trans(disp_ctx, drv, area, color_map);
+            return;
+        }
+        /* Rotated area is sent by one draw_bitmap, whose done callback reports flush ready, it needs the buffer of the whole area */
+        if (disp_ctx->draw_buffs[2]) {
+            int32_t ww = lv_area_get_width(area);
+            int32_t hh = lv_area_get_height(area);
+            lv_color_format_t cf = lv_display_get_color_format(drv);
+            uint32_t w_stride = lv_draw_buf_width_to_stride(ww, cf);
+            uint32_t h_stride = lv_draw_buf_width_to_stride(hh, cf);
+            if (cf == LV_COLOR_FORMAT_RGB565) {
+                /* Tiled RGB565 rotation, bytes are swapped during rotation when needed (swap bytes is allowed only for RGB565) */
+                lvgl_port_transform_rgb565_rotate((const uint16_t *)color_map, (uint16_t *)disp_ctx->draw_buffs[2], ww, hh, disp_ctx->current_rotation, disp_ctx->flags.swap_bytes);
+            } else if (disp_ctx->current_rotation == LV_DISPLAY_ROTATION_180) {
+                lv_draw_sw_rotate(color_map, disp_ctx->draw_buffs[2], hh, ww, h_stride, h_stride, LV_DISPLAY_ROTATION_180, cf);
+            } else if (disp_ctx->current_rotation == LV_DISPLAY_ROTATION_90) {
+                lv_draw_sw_rotate(color_map, disp_ctx->draw_buffs[2], ww, hh, w_stride, h_stride, LV_DISPLAY_ROTATION_270, cf);
+            } else if (disp_ctx->current_rotation == LV_DISPLAY_ROTATION_270) {
+                lv_draw_sw_rotate(color_map, disp_ctx->draw_buffs[2], ww, hh, w_stride, h_stride, LV_DISPLAY_ROTATION_90, cf);
+            }
+            color_map = (uint8_t *)disp_ctx->draw_buffs[2];
+            lvgl_port_rotate_area(drv, (lv_area_t *)area);
+            offsetx1 = area->x1;
+            offsetx2 = area->x2;
+            offsety1 = area->y1;
+            offsety2 = area->y2;
+        }
+    } else if (disp_ctx->flags.swap_bytes && disp_ctx->clut == NULL) {
+        /* Swap bytes in place, no rotation buffer is needed (CLUT colors are already swapped) */
+        size_t len = lv_area_get_size(area);
+        lvgl_port_transform_rgb565_swap((uint16_t *)color_map, len);
+    }
+
+    /* Transfer data in buffer for monochromatic screen */
+    if (disp_ctx->flags.monochrome) {
+        const lv_display_rotation_t rotation = lv_display_get_rotation(drv);
+        const bool full_pages = (lv_area_get_size(area) == lv_display_get_horizontal_resolution(drv) * lv_display_get_vertical_resolution(drv) &&
+                                 (lv_display_get_physical_vertical_resolution(drv) % 8) == 0);
+        if (full_pages && (rotation == LV_DISPLAY_ROTATION_0 || rotation == LV_DISPLAY_ROTATION_180)) {
+            int32_t page_first, page_last;
+            if (!lvgl_port_transform_monochrome_pages(disp_ctx, drv, color_map, &page_first, &page_last)) {
+                /* Nothing changed on the screen */
+                lvgl_port_disp_flush_ready(drv);
+                return;
+            }
+            /* Send only changed pages */
+            color_map += (size_t)page_first * lv_display_get_physical_horizontal_resolution(drv);
+            offsety1 = page_first * 8;
+            offsety2 = page_last * 8 + 7;
+        } else {
+            _lvgl_port_transform_monochrome(drv, area, color_map);
+        }
+    }
+
+    /* RGB LCD */
+#if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    if (disp_ctx->disp_type == LVGL_PORT_DISP_TYPE_RGB && disp_ctx->flags.triple_buffer) {
+        lvgl_port_flush_rgb_triple(disp_ctx, drv, area, color_map);
+        return;
+    }
+#endif
+#if LVGL_PORT_RGB_DMA_COPY_SUPPORTED
+    if (disp_ctx->dma_copy) {
+        const lv_area_t dma_area = {
+            .x1 = offsetx1,
+            .y1 = offsety1,
+            .x2 = offsetx2,
+            .y2 = offsety2,
+        };
+        if (lvgl_port_flush_rgb_dma(disp_ctx, &dma_area, color_map)) {
+            /* Flush ready is called from the copy done callback */
+            return;
+        }
+    }
+#endif
+    if (disp_ctx->cfb) {
+        /* RGB panel without frame buffer reads the lines from bounce buffer ISR */
+        lvgl_port_cfb_write(disp_ctx->cfb, offsetx1, offsety1, offsetx2, offsety2, (const uint16_t *)color_map);
+    } else if (disp_ctx->disp_type == LVGL_PORT_DISP_TYPE_RGB && (disp_ctx->flags.full_refresh || disp_ctx->flags.direct_mode)) {
+        if (lv_disp_flush_is_last(drv)) {
+            /* If the interface is I80 or SPI, this step cannot be used for drawing. */
+            esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, offsetx1, offsety1, offsetx2 + 1, offsety2 + 1, color_map);
+            /* Waiting for the last frame buffer to complete transmission */
+            ulTaskNotifyValueClear(NULL, ULONG_MAX);
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+    } else if (disp_ctx->trans_size && disp_ctx->trans_sem) {
+        lv_area_t trans_area = {
+            .x1 = offsetx1,
+            .y1 = offsety1,
+            .x2 = offsetx2,
+            .y2 = offsety2,
+        };
+        if (disp_ctx->tiles) {
+            lvgl_port_flush_tiles(disp_ctx, drv, &trans_area, color_map);
+        } else {
+            lvgl_port_flush_trans(disp_ctx, drv, &trans_area, color_map);
+        }
+    } else if (disp_ctx->round_size && disp_ctx->disp_type == LVGL_PORT_DISP_TYPE_OTHER) {
+        const lv_area_t round_area = {
+            .x1 = offsetx1,
+            .y1 = offsety1,
+            .x2 = offsetx2,
+            .y2 = offsety2,
+        };
+        lvgl_port_flush_round(disp_ctx, drv, &round_area, color_map);
+    } else if (disp_ctx->hw_scroll.obj) {
+        const lv_area_t scroll_area = {
+            .x1 = offsetx1,
+            .y1 = offsety1,
+            .x2 = offsetx2,
+            .y2 = offsety2,
+        };
+        lvgl_port_flush_hw_scroll(disp_ctx, drv, &scroll_area, color_map);
+    } else if (disp_ctx->ring.sem) {
+        esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, offsetx1, offsety1, offsetx2 + 1, offsety2 + 1, color_map);
+        lvgl_port_flush_ring_next(disp_ctx, drv);
+    } else {
+        esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, offsetx1, offsety1, offsetx2 + 1, offsety2 + 1, color_map);
+    }
+
+    if (disp_ctx->disp_type == LVGL_PORT_DISP_TYPE_RGB) {
+        lvgl_port_disp_flush_ready(drv);
+    }
+}
+
+#if CONFIG_IDF_TARGET_ESP32S3 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+/* Triple buffering: one frame buffer is displayed, one is waiting for VSYNC and LVGL renders into the third one. */
+static void lvgl_port_flush_rgb_triple(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, uint8_t *color_map)
+{
+    int8_t rendered = -1;
+    for (int i = 0; i < 3; i++) {
+        if (disp_ctx->rgb_fbs[i] == color_map) {
+            rendered = i;
+        }
+    }
+    assert(rendered >= 0);
+
+    /* Previous frame is still waiting for VSYNC, its buffer cannot be given to LVGL yet */
+    while (disp_ctx->rgb_fb_pending >= 0) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+    }
+
+    /* Buffer is pending before it is given to the RGB driver, the VSYNC ISR takes it as displayed only after draw_bitmap returned
+     * (the driver switches the frame buffer in the first VSYNC after draw_bitmap, not before) */
+    portENTER_CRITICAL(&disp_ctx->rgb_fb_lock);
+    const uint8_t displayed = disp_ctx->rgb_fb_displayed;
+    disp_ctx->rgb_fb_pending = rendered;
+    disp_ctx->rgb_fb_queued = false;
+    portEXIT_CRITICAL(&disp_ctx->rgb_fb_lock);
+
+    /* Frame buffer will be switched by the RGB driver in the next VSYNC */
+    const esp_err_t err = esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, color_map);
+
+    portENTER_CRITICAL(&disp_ctx->rgb_fb_lock);
+    if (err == ESP_OK) {
+        disp_ctx->rgb_fb_queued = true;
+    } else {
+        /* Frame buffer is not switched, the displayed one stays */
+        disp_ctx->rgb_fb_pending = -1;
+    }
+    portEXIT_CRITICAL(&disp_ctx->rgb_fb_lock);
+
+    /* LVGL renders next frame into the buffer, which is neither displayed nor pending */
+    for (int i = 0; i < 3; i++) {
+        if (i != rendered && i != displayed) {
+            lv_display_get_buf_active(drv)->data = disp_ctx->rgb_fbs[i];
+            break;
+        }
+    }
+
+    lvgl_port_disp_flush_ready(drv);
+}
+#endif
+
+/* Send the area in chunks through the SRAM transport buffers. */
+static void lvgl_port_flush_trans(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, uint8_t *color_map)
+{
+    const uint32_t px_size = lv_color_format_get_size(lv_display_get_color_format(drv));
+
+    lvgl_port_trans_send(disp_ctx, area, color_map, (size_t)lv_area_get_width(area) * px_size, px_size);
+
+    /* All data were copied out of the LVGL buffer, LVGL can render next area while the last chunks are being sent */
+    lvgl_port_disp_flush_ready(drv);
+}
+
+/* Copy the area (its lines are `stride` bytes apart in the source) into the transport buffers and send it.
+ * The transport buffers are used as a ring: the next chunk is copied while the previous ones are sent by DMA. */
+static void lvgl_port_trans_send(lvgl_port_display_ctx_t *disp_ctx, const lv_area_t *area, const uint8_t *from, size_t stride, uint32_t px_size)
+{
+    const int32_t width = lv_area_get_width(area);
+    const int32_t height = lv_area_get_height(area);
+    const size_t line_len = (size_t)width * px_size;
+    /* Lines of the whole flushed area are contiguous, they are copied at once */
+    const bool contiguous = (stride == line_len);
+    int32_t max_line = disp_ctx->trans_size / width;
+
+    /* Checked in lvgl_port_add_disp_priv, a line longer than the transport buffer would be never sent */
+    if (max_line <= 0) {
+        ESP_LOGE(TAG, "Transport buffer is shorter than one line (%d px)!", (int)width);
+        return;
+    }
+    if (max_line > height) {
+        max_line = height;
+    }
+
+    for (int32_t y = area->y1; y <= area->y2; y += max_line) {
+        const int32_t lines = ((area->y2 - y + 1) > max_line ? max_line : (area->y2 - y + 1));
+        const int32_t copies = (contiguous ? 1 : lines);
+        const size_t len = (contiguous ? (size_t)lines * line_len : line_len);
+
+        /* Wait for a free transport buffer (released from the LCD IO done callback) */
+        xSemaphoreTake(disp_ctx->trans_sem, portMAX_DELAY);
+        lvgl_port_trans_queued(disp_ctx);
+        uint8_t *to = (uint8_t *)disp_ctx->trans_buf[disp_ctx->trans_idx];
+        disp_ctx->trans_idx = (disp_ctx->trans_idx + 1) % disp_ctx->trans_cnt;
+
+        uint8_t *dst = to;
+        for (int32_t i = 0; i < copies; i++) {
+            if (disp_ctx->clut) {
+                /* One L8 index is expanded to one RGB565 pixel */
+                lvgl_port_transform_l8_to_rgb565(from, (uint16_t *)dst, len, disp_ctx->clut);
+                dst += len * sizeof(uint16_t);
             } else {
-                out_x = x;
-                out_y = y;
-                res = hor_res;
+                memcpy(dst, from, len);
+                dst += len;
+            }
+            from += (contiguous ? len : stride);
+        }
+        esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, area->x1, y, area->x2 + 1, y + lines, to);
+    }
+}
+
+/* Rotate line strips of the area (and swap bytes in the same pass) directly into the SRAM transport buffers and send them.
+ * The rotated area is never stored whole, the next strip is rotated while the previous ones are sent by DMA. */
+static void lvgl_port_flush_rotate_trans(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, uint8_t *color_map)
+{
+    const lv_color_format_t cf = lv_display_get_color_format(drv);
+    const uint32_t px_size = lv_color_format_get_size(cf);
+    const int32_t ww = lv_area_get_width(area);
+    const int32_t hh = lv_area_get_height(area);
+    const uint32_t w_stride = lv_draw_buf_width_to_stride(ww, cf);
+    const lv_display_rotation_t rotation = disp_ctx->current_rotation;
+    lv_area_t rot_area = *area;
+
+    lvgl_port_rotate_area(drv, &rot_area);
+    const int32_t width = lv_area_get_width(&rot_area);
+    const int32_t height = lv_area_get_height(&rot_area);
+    const uint32_t line_len = width * px_size;
+    const int32_t max_line = LV_MIN((int32_t)(disp_ctx->trans_size / width), height);
+
+    for (int32_t line = 0; line < height && max_line > 0; line += max_line) {
+        const int32_t lines = LV_MIN(height - line, max_line);
+
+        /* Wait for a free transport buffer (released from the LCD IO done callback) */
+        xSemaphoreTake(disp_ctx->trans_sem, portMAX_DELAY);
+        lvgl_port_trans_queued(disp_ctx);
+        uint8_t *to = (uint8_t *)disp_ctx->trans_buf[disp_ctx->trans_idx];
+        disp_ctx->trans_idx = (disp_ctx->trans_idx + 1) % disp_ctx->trans_cnt;
+
+        if (cf == LV_COLOR_FORMAT_RGB565) {
+            lvgl_port_transform_rgb565_rotate_lines((const uint16_t *)color_map, (uint16_t *)to, ww, hh, rotation, disp_ctx->flags.swap_bytes, line, lines);
+        } else if (rotation == LV_DISPLAY_ROTATION_180) {
+            /* Output lines are the source lines from the bottom */
+            lv_draw_sw_rotate(color_map + (size_t)(hh - line - lines) * w_stride, to, ww, lines, w_stride, line_len, LV_DISPLAY_ROTATION_180, cf);
+        } else if (rotation == LV_DISPLAY_ROTATION_90) {
+            /* Output lines are the source columns from the right */
+            lv_draw_sw_rotate(color_map + (size_t)(ww - line - lines) * px_size, to, lines, hh, w_stride, line_len, LV_DISPLAY_ROTATION_270, cf);
+        } else {
+            /* Output lines are the source columns from the left */
+            lv_draw_sw_rotate(color_map + (size_t)line * px_size, to, lines, hh, w_stride, line_len, LV_DISPLAY_ROTATION_90, cf);
+        }
+        esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, rot_area.x1, rot_area.y1 + line, rot_area.x2 + 1, rot_area.y1 + line + lines, to);
+    }
+
+    /* All data were copied out of the LVGL buffer, LVGL can render next area while the last strips are being sent */
+    lvgl_port_disp_flush_ready(drv);
+}
+
+/* Transport buffer is queued into the LCD driver, the bus transfer time starts with the first buffer in flight */
+static void lvgl_port_trans_queued(lvgl_port_display_ctx_t *disp_ctx)
+{
+    if (uxSemaphoreGetCount(disp_ctx->trans_sem) == disp_ctx->trans_cnt - 1U) {
+        disp_ctx->trans_busy_start = esp_timer_get_time();
+    }
+}
+
+/* The flushed area is rotated by SW (into the rotation buffer or in line strips) */
+static bool lvgl_port_sw_rotated(const lvgl_port_display_ctx_t *disp_ctx)
+{
+    return (disp_ctx->flags.sw_rotate && disp_ctx->current_rotation > LV_DISPLAY_ROTATION_0 &&
+            ((disp_ctx->rot_strips && disp_ctx->trans_sem) || disp_ctx->draw_buffs[2]));
+}
+
+/* Send only the tiles, whose content differs from the panel content. Changed tiles of one tile row are sent as one span
+ * (unchanged tiles between them too), following tile rows with the same span are joined into one area. */
+static void lvgl_port_flush_tiles(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, uint8_t *color_map)
+{
+    const uint32_t px_size = lv_color_format_get_size(lv_display_get_color_format(drv));
+    const int32_t width = lv_area_get_width(area);
+    const size_t stride = (size_t)width * px_size;
+    lv_area_t span;
+    bool pending = false;
+
+    for (int32_t y = area->y1; y <= area->y2;) {
+        const int32_t y2 = LV_MIN(area->y2, (y / LVGL_PORT_TILE_SIZE + 1) * LVGL_PORT_TILE_SIZE - 1);
+        const uint8_t *rows = color_map + (size_t)(y - area->y1) * stride;
+        int32_t x1 = 0;
+        int32_t x2 = -1;
+        const bool changed = lvgl_port_tile_compare(disp_ctx->tiles, rows, stride, px_size, area->x1, y, area->x2, y2, &x1, &x2);
+
+        if (pending && (!changed || x1 != span.x1 || x2 != span.x2)) {
+            lvgl_port_trans_send(disp_ctx, &span, color_map + (size_t)(span.y1 - area->y1) * stride + (size_t)(span.x1 - area->x1) * px_size, stride, px_size);
+            pending = false;
+        }
+        if (changed && pending) {
+            span.y2 = y2;
+        } else if (changed) {
+            span.x1 = x1;
+            span.y1 = y;
+            span.x2 = x2;
+            span.y2 = y2;
+            pending = true;
+        }
+        disp_ctx->perf_cur.skip_px += (uint32_t)(width - (x2 - x1 + 1)) * (y2 - y + 1);
+        y = y2 + 1;
+    }
+    if (pending) {
+        lvgl_port_trans_send(disp_ctx, &span, color_map + (size_t)(span.y1 - area->y1) * stride + (size_t)(span.x1 - area->x1) * px_size, stride, px_size);
+    }
+
+    /* Nothing is read from the LVGL buffer anymore, also when no tile was sent */
+    lvgl_port_disp_flush_ready(drv);
+}
+
+/* Content of the panel is unknown (rotation, panel switched off), all tiles are sent in the next frame */
+static void lvgl_port_tiles_reset(lvgl_port_display_ctx_t *disp_ctx)
+{
+    if (disp_ctx->tiles == NULL) {
+        return;
+    }
+    if (disp_ctx->flags.sw_rotate) {
+        /* Flushed areas are rotated into the panel coordinates */
+        lvgl_port_tile_reset(disp_ctx->tiles, lv_display_get_physical_horizontal_resolution(disp_ctx->disp_drv), lv_display_get_physical_vertical_resolution(disp_ctx->disp_drv));
+    } else {
+        lvgl_port_tile_reset(disp_ctx->tiles, lv_display_get_horizontal_resolution(disp_ctx->disp_drv), lv_display_get_vertical_resolution(disp_ctx->disp_drv));
+    }
+}
+
+/* The flushed draw buffer stays queued in the LCD driver, LVGL renders the next area into the next buffer of the ring.
+ * Buffers are sent in the order of flushing, so the next buffer is the one, which was sent first. */
+static void lvgl_port_flush_ring_next(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv)
+{
+    /* Wait for a free buffer (released from the LCD IO done callback) */
+    xSemaphoreTake(disp_ctx->ring.sem, portMAX_DELAY);
+    disp_ctx->ring.idx = (disp_ctx->ring.idx + 1) % disp_ctx->ring.cnt;
+    lv_display_get_buf_active(drv)->data = (uint8_t *)disp_ctx->ring.buf[disp_ctx->ring.idx];
+
+    lvgl_port_disp_flush_ready(drv);
+}
+
+/* Send the area of one color in bands from the pattern buffer, the same internal RAM buffer is queued for each band.
+ * esp_lcd does not expose looping DMA descriptors, so the pattern is repeated by queueing it again.
+ * Returns false, when the area is not solid (or it fits into one pattern) and it must be sent from the draw buffer. */
+static bool lvgl_port_flush_solid(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, const uint8_t *color_map)
+{
+    const uint32_t len = lv_area_get_size(area);
+    uint16_t color;
+
+    /* Round display and hardware scrolling split the area by themselves */
+    if (len <= disp_ctx->solid.size || disp_ctx->round_size || disp_ctx->hw_scroll.obj) {
+        return false;
+    }
+    if (!lvgl_port_transform_rgb565_is_solid((const uint16_t *)color_map, len, &color)) {
+        return false;
+    }
+    if (disp_ctx->flags.swap_bytes) {
+        color = (uint16_t)((color << 8) | (color >> 8));
+    }
+
+    /* Rotated area of one color is still one color, only its coordinates are rotated */
+    lv_area_t solid_area = *area;
+    if (lvgl_port_sw_rotated(disp_ctx)) {
+        lvgl_port_rotate_area(drv, &solid_area);
+    }
+    /* Pattern buffer is sent without hashing, the tiles must be compared again */
+    if (disp_ctx->tiles) {
+        lvgl_port_tile_forget(disp_ctx->tiles, solid_area.x1, solid_area.y1, solid_area.x2, solid_area.y2);
+    }
+
+    if (!disp_ctx->solid.valid || disp_ctx->solid.color != color) {
+        if (disp_ctx->trans_sem) {
+            /* Bands of the previous solid area can be still sent, wait until all transport slots are free */
+            for (int i = 0; i < disp_ctx->trans_cnt; i++) {
+                xSemaphoreTake(disp_ctx->trans_sem, portMAX_DELAY);
             }
+            for (int i = 0; i < disp_ctx->trans_cnt; i++) {
+                xSemaphoreGive(disp_ctx->trans_sem);
+            }
+        }
+        for (uint32_t i = 0; i < disp_ctx->solid.size; i++) {
+            disp_ctx->solid.buf[i] = color;
+        }
+        disp_ctx->solid.color = color;
+        disp_ctx->solid.valid = true;
+    }
+
+    const int32_t width = lv_area_get_width(&solid_area);
+    const int32_t max_line = disp_ctx->solid.size / width;
+    const uint32_t cnt = (lv_area_get_height(&solid_area) + max_line - 1) / max_line;
+
+    disp_ctx->perf_cur.solid_px += len;
+    if (disp_ctx->trans_sem) {
+        /* Each band takes a transport slot, the slot is released from the LCD IO done callback */
+        for (int32_t y = solid_area.y1; y <= solid_area.y2; y += max_line) {
+            const int32_t lines = LV_MIN(solid_area.y2 - y + 1, max_line);
+            xSemaphoreTake(disp_ctx->trans_sem, portMAX_DELAY);
+            lvgl_port_trans_queued(disp_ctx);
+            esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, solid_area.x1, y, solid_area.x2 + 1, y + lines, disp_ctx->solid.buf);
+        }
+        /* Draw buffer is not read by DMA, LVGL can render next area */
+        lvgl_port_disp_flush_ready(drv);
+    } else {
+        /* Flush ready is called from the IO done callback of the last band */
+        disp_ctx->parts_pending = cnt;
+        for (int32_t y = solid_area.y1; y <= solid_area.y2; y += max_line) {
+            const int32_t lines = LV_MIN(solid_area.y2 - y + 1, max_line);
+            esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, solid_area.x1, y, solid_area.x2 + 1, y + lines, disp_ctx->solid.buf);
+        }
+    }
+    return true;
+}
+
+/* Send only the bands of the area visible on the round display.
+ * Rows of each band are compacted in place, the band data never overlap the rows of the next bands. */
+static void lvgl_port_flush_round(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, uint8_t *color_map)
+{
+    lvgl_port_round_band_t bands[LVGL_PORT_ROUND_BANDS_MAX];
+    const uint32_t cnt = lvgl_port_round_split(disp_ctx->round_size, area->x1, area->y1, area->x2, area->y2, bands);
+    const int32_t width = lv_area_get_width(area);
+    const uint32_t px_size = lv_color_format_get_size(lv_display_get_color_format(drv));
+
+    if (cnt == 0) {
+        /* Whole area is in the corners */
+        lvgl_port_disp_flush_ready(drv);
+        return;
+    }
 
-            /* Write to the buffer as required for the display.
-            * It writes only 1-bit for monochrome displays mapped vertically.*/
-            buf = color_map + res * (out_y >> 3) + (out_x);
-            if (chroma_color) {
-                (*buf) &= ~(1 << (out_y % 8));
-            } else {
-                (*buf) |= (1 << (out_y % 8));
+    /* Flush ready is called from the IO done callback of the last band */
+    disp_ctx->parts_pending = cnt;
+    for (uint32_t i = 0; i < cnt; i++) {
+        const lvgl_port_round_band_t *band = &bands[i];
+        const size_t band_len = (size_t)(band->x2 - band->x1 + 1) * px_size;
+        uint8_t *to = color_map + (size_t)(band->y1 - area->y1) * width * px_size;
+
+        if (band->x1 != area->x1 || band->x2 != area->x2) {
+            for (int32_t y = band->y1; y <= band->y2; y++) {
+                const uint8_t *from = color_map + ((size_t)(y - area->y1) * width + (band->x1 - area->x1)) * px_size;
+                memmove(to + (size_t)(y - band->y1) * band_len, from, band_len);
             }
         }
+        esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, band->x1, band->y1, band->x2 + 1, band->y2 + 1, to);
     }
 }
 
-void lvgl_port_rotate_area(lv_display_t *disp, lv_area_t *area)
+/* Write the rows of the area into the panel memory scrolled by hardware.
+ * The new offset is set before the first flush of the frame, all areas of the frame were rendered for it. */
+static void lvgl_port_flush_hw_scroll(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, uint8_t *color_map)
 {
-    lv_display_rotation_t rotation = lv_display_get_rotation(disp);
+    lvgl_port_scroll_part_t parts[LVGL_PORT_SCROLL_PARTS_MAX];
+    const size_t line_len = (size_t)lv_area_get_width(area) * lv_color_format_get_size(lv_display_get_color_format(drv));
 
-    int32_t w = lv_area_get_width(area);
-    int32_t h = lv_area_get_height(area);
+    if (disp_ctx->hw_scroll.panel_offset != disp_ctx->hw_scroll.offset) {
+        disp_ctx->hw_scroll.cfg.set_offset(disp_ctx->panel_handle, disp_ctx->hw_scroll.offset);
+        disp_ctx->hw_scroll.panel_offset = disp_ctx->hw_scroll.offset;
+    }
 
-    int32_t hres = lv_display_get_horizontal_resolution(disp);
-    int32_t vres = lv_display_get_vertical_resolution(disp);
-    if (rotation == LV_DISPLAY_ROTATION_90 || rotation == LV_DISPLAY_ROTATION_270) {
-        vres = lv_display_get_horizontal_resolution(disp);
-        hres = lv_display_get_vertical_resolution(disp);
+    const uint32_t cnt = lvgl_port_scroll_split(disp_ctx->hw_scroll.top, disp_ctx->hw_scroll.height, disp_ctx->hw_scroll.offset, area->y1, area->y2, parts);
+
+    /* Flush ready is called from the IO done callback of the last part */
+    disp_ctx->parts_pending = cnt;
+    for (uint32_t i = 0; i < cnt; i++) {
+        const lvgl_port_scroll_part_t *part = &parts[i];
+        const uint8_t *from = color_map + (size_t)(part->y1 - area->y1) * line_len;
+        esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, area->x1, part->mem_y1, area->x2 + 1, part->mem_y1 + (part->y2 - part->y1) + 1, from);
     }
+}
 
-    switch (rotation) {
-    case LV_DISPLAY_ROTATION_0:
-        return;
-    case LV_DISPLAY_ROTATION_90:
-        area->y2 = vres - area->x1 - 1;
-        area->x1 = area->y1;
-        area->x2 = area->x1 + h - 1;
-        area->y1 = area->y2 - w + 1;
-        break;
-    case LV_DISPLAY_ROTATION_180:
-        area->y2 = vres - area->y1 - 1;
-        area->y1 = area->y2 - h + 1;
-        area->x2 = hres - area->x1 - 1;
-        area->x1 = area->x2 - w + 1;
-        break;
-    case LV_DISPLAY_ROTATION_270:
-        area->x1 = hres - area->y2 - 1;
-        area->y2 = area->x2;
-        area->x2 = area->x1 + h - 1;
-        area->y1 = area->y2 - w + 1;
-        break;
+#if LVGL_PORT_PPA_SUPPORTED
+static ppa_srm_color_mode_t lvgl_port_ppa_color_mode(lv_color_format_t cf)
+{
+    switch (cf) {
+    case LV_COLOR_FORMAT_RGB888:
+        return PPA_SRM_COLOR_MODE_RGB888;
+    case LV_COLOR_FORMAT_XRGB8888:
+    case LV_COLOR_FORMAT_ARGB8888:
+        return PPA_SRM_COLOR_MODE_ARGB8888;
+    case LV_COLOR_FORMAT_RGB565:
+    default:
+        return PPA_SRM_COLOR_MODE_RGB565;
     }
 }
 
-static void lvgl_port_flush_callback(lv_display_t *drv, const lv_area_t *area, uint8_t *color_map)
+static esp_err_t lvgl_port_ppa_init(lvgl_port_display_ctx_t *disp_ctx, lv_color_format_t fb_cf)
 {
-    assert(drv != NULL);
-    assert(area != NULL);
-    assert(color_map != NULL);
-    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(drv);
     assert(disp_ctx != NULL);
 
-    int offsetx1 = area->x1;
-    int offsetx2 = area->x2;
-    int offsety1 = area->y1;
-    int offsety2 = area->y2;
+    /* PPA writes directly into the frame buffer of the MIPI-DSI panel */
+    ESP_RETURN_ON_ERROR(esp_lcd_dpi_panel_get_frame_buffer(disp_ctx->panel_handle, 1, &disp_ctx->ppa_fb), TAG, "Get MIPI-DSI frame buffer failed");
+    const uint32_t hres = lv_display_get_physical_horizontal_resolution(disp_ctx->disp_drv);
+    const uint32_t vres = lv_display_get_physical_vertical_resolution(disp_ctx->disp_drv);
+    disp_ctx->ppa_fb_cf = fb_cf;
+    disp_ctx->ppa_fb_size = hres * vres * lv_color_format_get_size(fb_cf);
+    if (esp_cache_get_alignment(MALLOC_CAP_SPIRAM, &disp_ctx->ppa_fb_align) != ESP_OK) {
+        disp_ctx->ppa_fb_align = 0;
+    }
 
-    /* SW rotation enabled */
-    if (disp_ctx->flags.sw_rotate && (disp_ctx->current_rotation > LV_DISPLAY_ROTATION_0 || disp_ctx->flags.swap_bytes)) {
-        /* SW rotation */
-        if (disp_ctx->draw_buffs[2]) {
-            int32_t ww = lv_area_get_width(area);
-            int32_t hh = lv_area_get_height(area);
-            lv_color_format_t cf = lv_display_get_color_format(drv);
-            uint32_t w_stride = lv_draw_buf_width_to_stride(ww, cf);
-            uint32_t h_stride = lv_draw_buf_width_to_stride(hh, cf);
-            if (disp_ctx->current_rotation == LV_DISPLAY_ROTATION_180) {
-                lv_draw_sw_rotate(color_map, disp_ctx->draw_buffs[2], hh, ww, h_stride, h_stride, LV_DISPLAY_ROTATION_180, cf);
-            } else if (disp_ctx->current_rotation == LV_DISPLAY_ROTATION_90) {
-                lv_draw_sw_rotate(color_map, disp_ctx->draw_buffs[2], ww, hh, w_stride, h_stride, LV_DISPLAY_ROTATION_270, cf);
-            } else if (disp_ctx->current_rotation == LV_DISPLAY_ROTATION_270) {
-                lv_draw_sw_rotate(color_map, disp_ctx->draw_buffs[2], ww, hh, w_stride, h_stride, LV_DISPLAY_ROTATION_90, cf);
-            }
-            color_map = (uint8_t *)disp_ctx->draw_buffs[2];
-            lvgl_port_rotate_area(drv, (lv_area_t *)area);
-            offsetx1 = area->x1;
-            offsetx2 = area->x2;
-            offsety1 = area->y1;
-            offsety2 = area->y2;
-        }
-    } else if (disp_ctx->flags.swap_bytes) {
-        size_t len = lv_area_get_size(area);
-        lv_draw_sw_rgb565_swap(color_map, len);
+    const ppa_client_config_t ppa_cfg = {
+        .oper_type = PPA_OPERATION_SRM,
+        .max_pending_trans_num = 1,
+    };
+    ESP_RETURN_ON_ERROR(ppa_register_client(&ppa_cfg, &disp_ctx->ppa_handle), TAG, "PPA client register failed");
+
+    const ppa_event_callbacks_t cbs = {
+        .on_trans_done = lvgl_port_ppa_done_callback,
+    };
+    esp_err_t ret = ppa_client_register_event_callbacks(disp_ctx->ppa_handle, &cbs);
+    if (ret != ESP_OK) {
+        ppa_unregister_client(disp_ctx->ppa_handle);
+        disp_ctx->ppa_handle = NULL;
+        return ret;
     }
 
-    /* Transfer data in buffer for monochromatic screen */
-    if (disp_ctx->flags.monochrome) {
-        _lvgl_port_transform_monochrome(drv, area, color_map);
+    return ESP_OK;
+}
+
+static bool lvgl_port_ppa_done_callback(ppa_client_handle_t ppa_client, ppa_event_data_t *event_data, void *user_data)
+{
+    lv_display_t *disp_drv = (lv_display_t *)user_data;
+    assert(disp_drv != NULL);
+    lvgl_port_disp_flush_ready(disp_drv);
+    return false;
+}
+
+static void lvgl_port_flush_ppa(lvgl_port_display_ctx_t *disp_ctx, lv_display_t *drv, const lv_area_t *area, uint8_t *color_map)
+{
+    const ppa_srm_color_mode_t color_mode = lvgl_port_ppa_color_mode(lv_display_get_color_format(drv));
+    const int32_t ww = lv_area_get_width(area);
+    const int32_t hh = lv_area_get_height(area);
+
+    /* PPA rotation angle is counter-clockwise */
+    ppa_srm_rotation_angle_t angle = PPA_SRM_ROTATION_ANGLE_0;
+    switch (disp_ctx->current_rotation) {
+    case LV_DISPLAY_ROTATION_90:
+        angle = PPA_SRM_ROTATION_ANGLE_270;
+        break;
+    case LV_DISPLAY_ROTATION_180:
+        angle = PPA_SRM_ROTATION_ANGLE_180;
+        break;
+    case LV_DISPLAY_ROTATION_270:
+        angle = PPA_SRM_ROTATION_ANGLE_90;
+        break;
+    default:
+        break;
     }
 
-    /* RGB LCD */
-    if (disp_ctx->disp_type == LVGL_PORT_DISP_TYPE_RGB && (disp_ctx->flags.full_refresh || disp_ctx->flags.direct_mode)) {
-        if (lv_disp_flush_is_last(drv)) {
-            /* If the interface is I80 or SPI, this step cannot be used for drawing. */
-            esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, offsetx1, offsety1, offsetx2 + 1, offsety2 + 1, color_map);
-            /* Waiting for the last frame buffer to complete transmission */
-            ulTaskNotifyValueClear(NULL, ULONG_MAX);
-            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-        }
-    } else {
-        esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, offsetx1, offsety1, offsetx2 + 1, offsety2 + 1, color_map);
+    /* Area in frame buffer coordinates */
+    lv_area_t fb_area = *area;
+    lvgl_port_rotate_area(drv, &fb_area);
+
+    /* PPA driver invalidates the cache of the whole output buffer, only the rows of the area are given as output picture */
+    const size_t fb_stride = lv_display_get_physical_horizontal_resolution(drv) * lv_color_format_get_size(disp_ctx->ppa_fb_cf);
+    uint8_t *out_buf = disp_ctx->ppa_fb;
+    uint32_t out_h = lv_display_get_physical_vertical_resolution(drv);
+    int32_t out_y = fb_area.y1;
+    if (disp_ctx->ppa_fb_align == 0 || (fb_stride % disp_ctx->ppa_fb_align) == 0) {
+        out_buf += (size_t)fb_area.y1 * fb_stride;
+        out_h = lv_area_get_height(&fb_area);
+        out_y = 0;
     }
 
-    if (disp_ctx->disp_type == LVGL_PORT_DISP_TYPE_RGB) {
-        lv_disp_flush_ready(drv);
+    ppa_srm_oper_config_t srm_cfg = {
+        .in.buffer = color_map,
+        .in.pic_w = ww,
+        .in.pic_h = hh,
+        .in.block_w = ww,
+        .in.block_h = hh,
+        .in.block_offset_x = 0,
+        .in.block_offset_y = 0,
+        .in.srm_cm = color_mode,
+        .out.buffer = out_buf,
+        .out.buffer_size = out_h * fb_stride,
+        .out.pic_w = lv_display_get_physical_horizontal_resolution(drv),
+        .out.pic_h = out_h,
+        .out.block_offset_x = fb_area.x1,
+        .out.block_offset_y = out_y,
+        .out.srm_cm = lvgl_port_ppa_color_mode(disp_ctx->ppa_fb_cf),
+        .rotation_angle = angle,
+        .scale_x = 1.0f,
+        .scale_y = 1.0f,
+        .rgb_swap = 0,
+        .byte_swap = disp_ctx->flags.swap_bytes,
+        .mode = PPA_TRANS_MODE_NON_BLOCKING,
+        .user_data = drv,
+    };
+
+    if (ppa_do_scale_rotate_mirror(disp_ctx->ppa_handle, &srm_cfg) != ESP_OK) {
+        ESP_LOGE(TAG, "PPA transaction failed!");
+        lvgl_port_disp_flush_ready(drv);
     }
 }
+#endif
 
 static void lvgl_port_disp_rotation_update(lvgl_port_display_ctx_t *disp_ctx)
 {
     assert(disp_ctx != NULL);
 
+    if (disp_ctx->hw_scroll.obj && disp_ctx->current_rotation != lv_display_get_rotation(disp_ctx->disp_drv)) {
+        /* Scrolling area is defined in rows of the panel, it does not follow the rotation */
+        ESP_LOGW(TAG, "Display rotated, hardware scroll detached");
+        lvgl_port_disp_hw_scroll_detach(disp_ctx->disp_drv);
+    }
+
     disp_ctx->current_rotation = lv_display_get_rotation(disp_ctx->disp_drv);
+    /* Panel memory layout is changed, all monochrome pages must be sent again */
+    disp_ctx->mono_prev_valid = false;
+    lvgl_port_tiles_reset(disp_ctx);
     if (disp_ctx->flags.sw_rotate) {
         return;
     }
@@ -583,8 +2622,401 @@ static void lvgl_port_disp_size_update_callback(lv_event_t *e)
     lvgl_port_disp_rotation_update(disp_ctx);
 }
 
+static void lvgl_port_disp_merge_area(lvgl_port_display_ctx_t *disp_ctx, lv_area_t *area)
+{
+    lv_area_t joined;
+
+    /* Extend the new area over the close areas. LVGL joins the areas, which are inside of another one, before rendering. */
+    for (int i = 0; i < disp_ctx->inv_cnt; i++) {
+        const lv_area_t *inv = &disp_ctx->inv_areas[i];
+        joined.x1 = LV_MIN(area->x1, inv->x1);
+        joined.y1 = LV_MIN(area->y1, inv->y1);
+        joined.x2 = LV_MAX(area->x2, inv->x2);
+        joined.y2 = LV_MAX(area->y2, inv->y2);
+
+        if (lv_area_get_size(&joined) <= lv_area_get_size(area) + lv_area_get_size(inv) + disp_ctx->merge_overhead) {
+            *area = joined;
+            /* Merged area is covered by the new one, remove it and check all areas again with the bigger area */
+            disp_ctx->inv_cnt--;
+            disp_ctx->inv_areas[i] = disp_ctx->inv_areas[disp_ctx->inv_cnt];
+            i = -1;
+        }
+    }
+
+    if (disp_ctx->inv_cnt < LV_INV_BUF_SIZE) {
+        disp_ctx->inv_areas[disp_ctx->inv_cnt++] = *area;
+    }
+}
+
+static void lvgl_port_disp_tile_align(lvgl_port_display_ctx_t *disp_ctx, lv_area_t *area)
+{
+    const int32_t hres = lv_display_get_horizontal_resolution(disp_ctx->disp_drv);
+    const int32_t vres = lv_display_get_vertical_resolution(disp_ctx->disp_drv);
+
+    area->x1 = area->x1 / LVGL_PORT_TILE_SIZE * LVGL_PORT_TILE_SIZE;
+    area->y1 = area->y1 / LVGL_PORT_TILE_SIZE * LVGL_PORT_TILE_SIZE;
+    area->x2 = LV_MIN(area->x2 / LVGL_PORT_TILE_SIZE * LVGL_PORT_TILE_SIZE + LVGL_PORT_TILE_SIZE - 1, hres - 1);
+    area->y2 = LV_MIN(area->y2 / LVGL_PORT_TILE_SIZE * LVGL_PORT_TILE_SIZE + LVGL_PORT_TILE_SIZE - 1, vres - 1);
+}
+
 static void lvgl_port_display_invalidate_callback(lv_event_t *e)
 {
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_event_get_user_data(e);
+    lv_area_t *area = (lv_area_t *)lv_event_get_param(e);
+
+    /* The area as invalidated by the object, before it is changed by the port */
+    if (disp_ctx && area && lv_event_get_code(e) == LV_EVENT_INVALIDATE_AREA) {
+        LVGL_PORT_INV_PROF_RECORD(disp_ctx->disp_drv, area);
+    }
+
+#if LVGL_PORT_RGB_DMA_COPY_SUPPORTED
+    if (disp_ctx && disp_ctx->dma_copy && area && lv_event_get_code(e) == LV_EVENT_INVALIDATE_AREA) {
+        /* Whole lines are one block in the frame buffer, the area is copied by one GDMA transaction */
+        area->x1 = 0;
+        area->x2 = lv_display_get_horizontal_resolution(disp_ctx->disp_drv) - 1;
+    }
+#endif
+
+    if (disp_ctx && disp_ctx->tiles && area && lv_event_get_code(e) == LV_EVENT_INVALIDATE_AREA) {
+        /* Areas aligned to the tiles are compared tile by tile, LVGL splits them into bands of whole tile rows too */
+        lvgl_port_disp_tile_align(disp_ctx, area);
+    }
+
+    if (disp_ctx && disp_ctx->hw_scroll.obj && area && lv_event_get_code(e) == LV_EVENT_INVALIDATE_AREA) {
+        lvgl_port_hw_scroll_invalidate(disp_ctx, area);
+    }
+
+    if (disp_ctx && disp_ctx->merge_overhead && area && lv_event_get_code(e) == LV_EVENT_INVALIDATE_AREA) {
+        lvgl_port_disp_merge_area(disp_ctx, area);
+    }
+
+    if (disp_ctx && disp_ctx->low_power.timer && lv_event_get_code(e) == LV_EVENT_INVALIDATE_AREA) {
+        /* The panel shows full colors before the area is flushed, the inactivity is measured from now */
+        lvgl_port_low_power_exit(disp_ctx);
+        lv_timer_reset(disp_ctx->low_power.timer);
+        lv_timer_resume(disp_ctx->low_power.timer);
+    }
+
+    if (disp_ctx && disp_ctx->pacing.cfg.fps && !disp_ctx->pacing.pending) {
+        disp_ctx->pacing.pending_since = esp_timer_get_time();
+        disp_ctx->pacing.pending = true;
+    }
+
     /* Wake LVGL task, if needed */
     lvgl_port_task_wake(LVGL_PORT_EVENT_DISPLAY, NULL);
 }
+
+static void lvgl_port_display_refr_ready_callback(lv_event_t *e)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_event_get_user_data(e);
+    assert(disp_ctx != NULL);
+    /* All invalidated areas were refreshed */
+    disp_ctx->inv_cnt = 0;
+}
+
+/* No area was invalidated for the timeout, the screen is static */
+static void lvgl_port_low_power_timer_cb(lv_timer_t *timer)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_timer_get_user_data(timer);
+    assert(disp_ctx != NULL);
+    esp_lcd_panel_handle_t control_handle = (disp_ctx->control_handle ? disp_ctx->control_handle : disp_ctx->panel_handle);
+
+    /* Resumed by the next invalidation */
+    lv_timer_pause(timer);
+    if (disp_ctx->low_power.cfg.cb(control_handle, true, disp_ctx->low_power.cfg.user_ctx) == ESP_OK) {
+        disp_ctx->low_power.active = true;
+    } else {
+        ESP_LOGW(TAG, "Panel low-power mode enter failed!");
+    }
+}
+
+static void lvgl_port_low_power_exit(lvgl_port_display_ctx_t *disp_ctx)
+{
+    if (!disp_ctx->low_power.active) {
+        return;
+    }
+    esp_lcd_panel_handle_t control_handle = (disp_ctx->control_handle ? disp_ctx->control_handle : disp_ctx->panel_handle);
+
+    disp_ctx->low_power.active = false;
+    if (disp_ctx->low_power.cfg.cb(control_handle, false, disp_ctx->low_power.cfg.user_ctx) != ESP_OK) {
+        ESP_LOGW(TAG, "Panel low-power mode exit failed!");
+    }
+}
+
+/* LVGL moves the children and sends the scroll event, then it invalidates the whole container */
+static void lvgl_port_hw_scroll_callback(lv_event_t *e)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_event_get_user_data(e);
+    assert(disp_ctx != NULL);
+    lv_obj_t *obj = disp_ctx->hw_scroll.obj;
+
+    if (lv_event_get_code(e) == LV_EVENT_DELETE) {
+        lvgl_port_hw_scroll_stop(disp_ctx);
+        return;
+    }
+
+    const int32_t x = lv_obj_get_scroll_x(obj);
+    const int32_t y = lv_obj_get_scroll_y(obj);
+    const int32_t height = disp_ctx->hw_scroll.height;
+    const int32_t dy = y - disp_ctx->hw_scroll.last_y;
+
+    if (x != disp_ctx->hw_scroll.last_x) {
+        /* Horizontal scrolling is not done by hardware, the whole container is redrawn */
+        disp_ctx->hw_scroll.moved = height;
+    } else if (LV_ABS(disp_ctx->hw_scroll.moved) < height) {
+        disp_ctx->hw_scroll.moved += dy;
+    }
+    disp_ctx->hw_scroll.offset = ((disp_ctx->hw_scroll.offset + dy) % height + height) % height;
+    disp_ctx->hw_scroll.last_x = x;
+    disp_ctx->hw_scroll.last_y = y;
+    disp_ctx->hw_scroll.inv_replace = true;
+}
+
+/* Replace the invalidated container by the rows exposed since the last refresh.
+ * Row r of the scrolled content is in the panel memory already, if row r + moved was visible in the last refresh. */
+static void lvgl_port_hw_scroll_invalidate(lvgl_port_display_ctx_t *disp_ctx, lv_area_t *area)
+{
+    const int32_t top = disp_ctx->hw_scroll.top;
+    const int32_t bottom = top + disp_ctx->hw_scroll.height - 1;
+    const int32_t moved = disp_ctx->hw_scroll.moved;
+
+    if (!disp_ctx->hw_scroll.inv_replace || area->y1 > top || area->y2 < bottom) {
+        return;
+    }
+    disp_ctx->hw_scroll.inv_replace = false;
+    if (LV_ABS(moved) >= disp_ctx->hw_scroll.height) {
+        return;
+    }
+
+    lv_area_t scrollbar_hor;
+    lv_area_t scrollbar_ver;
+    lv_obj_get_scrollbar_area(disp_ctx->hw_scroll.obj, &scrollbar_hor, &scrollbar_ver);
+
+    if (moved > 0) {
+        area->y1 = bottom - moved + 1;
+        area->y2 = bottom;
+    } else if (moved < 0) {
+        area->y1 = top;
+        area->y2 = top - moved - 1;
+    } else {
+        /* Content is at the same position as in the last refresh */
+        area->y1 = top;
+        area->y2 = top;
+    }
+
+    if (lv_area_get_size(&scrollbar_ver) > 0) {
+        /* Scrollbar is moved with the rows, its whole column is redrawn */
+        scrollbar_ver.y1 = top;
+        scrollbar_ver.y2 = bottom;
+        lv_inv_area(disp_ctx->disp_drv, &scrollbar_ver);
+    }
+}
+
+static void lvgl_port_hw_scroll_refr_ready_callback(lv_event_t *e)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_event_get_user_data(e);
+    assert(disp_ctx != NULL);
+
+    /* All exposed rows were redrawn */
+    disp_ctx->hw_scroll.moved = 0;
+    if (disp_ctx->hw_scroll.obj && disp_ctx->hw_scroll.panel_offset != disp_ctx->hw_scroll.offset) {
+        /* Content was scrolled back to the rendered position, nothing was flushed */
+        disp_ctx->hw_scroll.cfg.set_offset(disp_ctx->panel_handle, disp_ctx->hw_scroll.offset);
+        disp_ctx->hw_scroll.panel_offset = disp_ctx->hw_scroll.offset;
+    }
+}
+
+static void lvgl_port_hw_scroll_stop(lvgl_port_display_ctx_t *disp_ctx)
+{
+    lv_display_remove_event_cb_with_user_data(disp_ctx->disp_drv, lvgl_port_hw_scroll_refr_ready_callback, disp_ctx);
+    disp_ctx->hw_scroll.obj = NULL;
+
+    /* Rows of the scrolling area are written into the same rows of the panel memory again, all must be redrawn */
+    disp_ctx->hw_scroll.cfg.set_offset(disp_ctx->panel_handle, 0);
+    const lv_area_t area = {
+        .x1 = 0,
+        .y1 = disp_ctx->hw_scroll.top,
+        .x2 = lv_display_get_horizontal_resolution(disp_ctx->disp_drv) - 1,
+        .y2 = disp_ctx->hw_scroll.top + disp_ctx->hw_scroll.height - 1,
+    };
+    lv_inv_area(disp_ctx->disp_drv, &area);
+}
+
+#if LVGL_PORT_RGB_DMA_COPY_SUPPORTED
+static bool lvgl_port_rgb_dma_done_callback(async_memcpy_handle_t mcp_hdl, async_memcpy_event_t *event, void *cb_args)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)cb_args;
+    assert(disp_ctx != NULL);
+    /* Cache lines read by CPU (bounce buffers) during the copy are stale */
+    esp_cache_msync(disp_ctx->dma_copy_dst, disp_ctx->dma_copy_size, ESP_CACHE_MSYNC_FLAG_DIR_M2C);
+    lvgl_port_disp_flush_ready(disp_ctx->disp_drv);
+    return false;
+}
+
+static esp_err_t lvgl_port_rgb_dma_copy_init(lvgl_port_display_ctx_t *disp_ctx, esp_lcd_panel_handle_t panel_handle)
+{
+    ESP_RETURN_ON_ERROR(esp_lcd_rgb_panel_get_frame_buffer(panel_handle, 1, (void *)&disp_ctx->dma_copy_fb), TAG, "Get RGB buffer failed");
+
+    async_memcpy_config_t mcp_cfg = ASYNC_MEMCPY_DEFAULT_CONFIG();
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 4, 0)
+    mcp_cfg.psram_trans_align = LVGL_PORT_RGB_DMA_COPY_ALIGN;
+#endif
+    return esp_async_memcpy_install(&mcp_cfg, &disp_ctx->dma_copy);
+}
+
+/* Copy of the area into the frame buffer by GDMA, returns false when the area must be copied by CPU (draw bitmap) */
+static bool lvgl_port_flush_rgb_dma(lvgl_port_display_ctx_t *disp_ctx, const lv_area_t *area, uint8_t *color_map)
+{
+    const int32_t hres = lv_display_get_physical_horizontal_resolution(disp_ctx->disp_drv);
+    const size_t offset = ((size_t)area->y1 * hres + area->x1) * sizeof(uint16_t);
+    const size_t size = (size_t)lv_area_get_size(area) * sizeof(uint16_t);
+
+    /* RGB driver mirrors and swaps axes only in draw bitmap */
+    if (disp_ctx->current_rotation != LV_DISPLAY_ROTATION_0 || disp_ctx->rotation.swap_xy || disp_ctx->rotation.mirror_x || disp_ctx->rotation.mirror_y) {
+        return false;
+    }
+    /* GDMA reads internal RAM only, the destination in PSRAM must be aligned to cache lines */
+    uint8_t *dst = disp_ctx->dma_copy_fb + offset;
+    if (area->x1 != 0 || area->x2 != hres - 1 || ((uintptr_t)dst % LVGL_PORT_RGB_DMA_COPY_ALIGN) || (size % LVGL_PORT_RGB_DMA_COPY_ALIGN) ||
+            !esp_ptr_dma_capable(color_map) || ((uintptr_t)color_map % 4)) {
+        return false;
+    }
+    /* Lines written by CPU (draw bitmap) must not be written back from cache over the copied data */
+    if (esp_cache_msync(dst, size, ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_INVALIDATE) != ESP_OK) {
+        return false;
+    }
+
+    disp_ctx->dma_copy_dst = dst;
+    disp_ctx->dma_copy_size = size;
+    return (esp_async_memcpy(disp_ctx->dma_copy, dst, color_map, size, lvgl_port_rgb_dma_done_callback, disp_ctx) == ESP_OK);
+}
+#endif
+
+static void lvgl_port_disp_flush_ready(lv_display_t *disp)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_display_get_user_data(disp);
+    if (disp_ctx) {
+        const uint32_t latency = (uint32_t)(esp_timer_get_time() - disp_ctx->perf_flush_start);
+        uint32_t bin = 0;
+        while (bin < LVGL_PORT_PERF_HIST_BINS - 1 && latency >= (LVGL_PORT_PERF_HIST_FIRST_US << bin)) {
+            bin++;
+        }
+        disp_ctx->perf_cur.flush_hist[bin]++;
+        /* Transport buffers are sent after flush ready, their transfer is measured in the IO done callback */
+        if (disp_ctx->trans_sem == NULL) {
+            disp_ctx->perf_cur.trans_time += latency;
+            disp_ctx->bus.busy += latency;
+        }
+        if (disp_ctx->pm_flushing) {
+            disp_ctx->pm_flushing = false;
+            lvgl_port_pm_flush_release();
+        }
+        lvgl_port_trace(LVGL_PORT_TRACE_FLUSH_DONE, &disp_ctx->trace_area);
+    }
+    lv_disp_flush_ready(disp);
+}
+
+/* Display has a transfer in progress or queued in the LCD driver */
+static bool lvgl_port_disp_sending(lvgl_port_display_ctx_t *disp_ctx)
+{
+    return disp_ctx->pm_flushing || disp_ctx->cursor.sending ||
+           (disp_ctx->trans_sem && uxSemaphoreGetCount(disp_ctx->trans_sem) < disp_ctx->trans_cnt) ||
+           (disp_ctx->ring.sem && uxSemaphoreGetCount(disp_ctx->ring.sem) < disp_ctx->ring.cnt - 1U);
+}
+
+static void lvgl_port_display_perf_callback(lv_event_t *e)
+{
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)lv_event_get_user_data(e);
+    assert(disp_ctx != NULL);
+
+    if (lv_event_get_code(e) == LV_EVENT_REFR_START) {
+        const uint32_t frame_cnt = disp_ctx->perf_cur.frame_cnt;
+        memset(&disp_ctx->perf_cur, 0, sizeof(lvgl_port_disp_perf_t));
+        disp_ctx->perf_cur.frame_cnt = frame_cnt;
+        disp_ctx->perf_frame_start = esp_timer_get_time();
+        disp_ctx->perf_vsync_start = disp_ctx->vsync_cnt;
+        lvgl_port_lock_contention(&disp_ctx->perf_lock_contended, &disp_ctx->perf_lock_wait);
+        LVGL_PORT_SV_START(LVGL_PORT_SV_FRAME);
+        lvgl_port_trace(LVGL_PORT_TRACE_RENDER, NULL);
+        return;
+    }
+
+    LVGL_PORT_SV_STOP(LVGL_PORT_SV_FRAME);
+    if (disp_ctx->perf_cur.flush_cnt > 0) {
+        /* Count only frames, which were really redrawn */
+        disp_ctx->perf_cur.frame_cnt++;
+        disp_ctx->perf_cur.frame_time = (uint32_t)(esp_timer_get_time() - disp_ctx->perf_frame_start);
+        disp_ctx->perf_cur.render_time = (disp_ctx->perf_cur.frame_time > disp_ctx->perf_cur.flush_time ? disp_ctx->perf_cur.frame_time - disp_ctx->perf_cur.flush_time : 0);
+        /* Refresh periods of the panel missed by the frame (the frame can take one period) */
+        const uint32_t vsyncs = disp_ctx->vsync_cnt - disp_ctx->perf_vsync_start;
+        const uint32_t te_period = (disp_ctx->te ? lvgl_port_te_get_period(disp_ctx->te) : 0);
+        if (vsyncs > 1) {
+            disp_ctx->perf_cur.vsync_drop = vsyncs - 1;
+        } else if (te_period && disp_ctx->perf_cur.frame_time > te_period) {
+            disp_ctx->perf_cur.vsync_drop = (disp_ctx->perf_cur.frame_time - 1) / te_period;
+        }
+        uint32_t lock_contended;
+        uint64_t lock_wait;
+        lvgl_port_lock_contention(&lock_contended, &lock_wait);
+        disp_ctx->perf_cur.lock_contended = lock_contended - disp_ctx->perf_lock_contended;
+        disp_ctx->perf_cur.lock_wait = (uint32_t)(lock_wait - disp_ctx->perf_lock_wait);
+        memcpy(&disp_ctx->perf, &disp_ctx->perf_cur, sizeof(lvgl_port_disp_perf_t));
+        lvgl_port_pm_frame_done(disp_ctx->perf_cur.render_time);
+    }
+}
+
+/* Blend the cursor into RGB565 pixels of the area (native byte order) */
+static void lvgl_port_cursor_blend(lvgl_port_display_ctx_t *disp_ctx, const lv_area_t *area, uint16_t *px)
+{
+    lv_area_t common;
+    if (!lv_area_intersect(&common, area, &disp_ctx->cursor.area)) {
+        return;
+    }
+
+    const int32_t area_w = lv_area_get_width(area);
+    for (int32_t y = common.y1; y <= common.y2; y++) {
+        const int32_t sprite_row = (y - disp_ctx->cursor.area.y1) * disp_ctx->cursor.w - disp_ctx->cursor.area.x1;
+        uint16_t *dst = px + (y - area->y1) * area_w - area->x1;
+        for (int32_t x = common.x1; x <= common.x2; x++) {
+            const uint32_t a = (disp_ctx->cursor.alpha[sprite_row + x] + 4) >> 3;
+            if (a == 0) {
+                continue;
+            }
+            /* R, G and B in one 32-bit word with gaps for the multiplication (0..32 weights) */
+            const uint32_t fg = disp_ctx->cursor.sprite[sprite_row + x];
+            const uint32_t bg = dst[x];
+            const uint32_t fg_w = (fg | (fg << 16)) & 0x07E0F81F;
+            const uint32_t bg_w = (bg | (bg << 16)) & 0x07E0F81F;
+            const uint32_t mix = ((fg_w * a + bg_w * (32 - a)) >> 5) & 0x07E0F81F;
+            dst[x] = (uint16_t)(mix | (mix >> 16));
+        }
+    }
+}
+
+/* Keep the flushed pixels in the shadow screen and draw the cursor over them */
+static void lvgl_port_cursor_flush(lvgl_port_display_ctx_t *disp_ctx, const lv_area_t *area, uint8_t *color_map)
+{
+    const int32_t hres = lv_display_get_horizontal_resolution(disp_ctx->disp_drv);
+    const int32_t area_w = lv_area_get_width(area);
+    const uint16_t *src = (const uint16_t *)color_map;
+    for (int32_t row = area->y1; row <= area->y2; row++) {
+        memcpy(disp_ctx->cursor.shadow + row * hres + area->x1, src, area_w * sizeof(uint16_t));
+        src += area_w;
+    }
+    lvgl_port_cursor_blend(disp_ctx, area, (uint16_t *)color_map);
+}
+
+static void lvgl_port_cursor_free(lvgl_port_display_ctx_t *disp_ctx)
+{
+    if (disp_ctx->cursor.shadow) {
+        LVGL_PORT_MEM_REMOVE(disp_ctx->cursor.shadow, disp_ctx->cursor.shadow_caps);
+    }
+    if (disp_ctx->cursor.tx_buf) {
+        LVGL_PORT_MEM_REMOVE(disp_ctx->cursor.tx_buf, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    }
+    free(disp_ctx->cursor.shadow);
+    free(disp_ctx->cursor.sprite);
+    free(disp_ctx->cursor.alpha);
+    free(disp_ctx->cursor.tx_buf);
+    memset(&disp_ctx->cursor, 0, sizeof(disp_ctx->cursor));
+}
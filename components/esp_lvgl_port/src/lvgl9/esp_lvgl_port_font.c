@@ -0,0 +1,295 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/queue.h>
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_lvgl_port.h"
+
+static const char *TAG = "LVGL";
+
+/* Glyph bitmap callback with draw buffer was added in LVGL 9.2 */
+#define LVGL_PORT_FONT_CACHE_SUPPORTED  (LVGL_VERSION_MAJOR > 9 || LVGL_VERSION_MINOR >= 2)
+
+#if LVGL_PORT_FONT_CACHE_SUPPORTED
+
+/* Number of hash buckets of the cached glyphs */
+#define LVGL_PORT_FONT_CACHE_BUCKETS    (64)
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+/* Rendered glyph, rows of A8 pixels without padding */
+typedef struct lvgl_port_glyph_s {
+    SLIST_ENTRY(lvgl_port_glyph_s) bucket;  /* Entry in hash bucket */
+    TAILQ_ENTRY(lvgl_port_glyph_s) lru;     /* Entry in LRU list */
+    uint32_t    index;      /* Glyph index in the original font */
+    uint16_t    w;
+    uint16_t    h;
+    uint8_t     data[];
+} lvgl_port_glyph_t;
+
+struct lvgl_port_font_cache_s {
+    lv_font_t           font;       /* Font with cache (user_data points to this structure) */
+    const lv_font_t     *orig;      /* Original font */
+    uint32_t            caps;       /* Memory of cached glyphs */
+    uint32_t            size;       /* Budget of the cache in bytes */
+    uint32_t            used;       /* Bytes used by the cached glyphs */
+    SemaphoreHandle_t   lock;       /* Glyphs can be drawn from more draw units */
+    lvgl_port_font_cache_stats_t stats;
+    SLIST_HEAD(, lvgl_port_glyph_s) buckets[LVGL_PORT_FONT_CACHE_BUCKETS];
+    TAILQ_HEAD(lvgl_port_glyph_list, lvgl_port_glyph_s) lru_list;   /* The most recently used first */
+};
+
+/*******************************************************************************
+* Function definitions
+*******************************************************************************/
+static bool lvgl_port_font_get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc, uint32_t letter, uint32_t letter_next);
+static const void *lvgl_port_font_get_glyph_bitmap(lv_font_glyph_dsc_t *dsc, lv_draw_buf_t *draw_buf);
+static void lvgl_port_font_release_glyph(const lv_font_t *font, lv_font_glyph_dsc_t *dsc);
+static void lvgl_port_font_evict(lvgl_port_font_cache_handle_t cache, uint32_t need);
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t lvgl_port_font_cache_create(const lvgl_port_font_cache_cfg_t *cache_cfg, lvgl_port_font_cache_handle_t *ret_cache)
+{
+    ESP_RETURN_ON_FALSE(cache_cfg && cache_cfg->font && cache_cfg->cache_size > 0 && ret_cache, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+
+    lvgl_port_font_cache_handle_t cache = calloc(1, sizeof(struct lvgl_port_font_cache_s));
+    ESP_RETURN_ON_FALSE(cache, ESP_ERR_NO_MEM, TAG, "Not enough memory for glyph cache!");
+    cache->lock = xSemaphoreCreateMutex();
+    if (cache->lock == NULL) {
+        free(cache);
+        ESP_LOGE(TAG, "Not enough memory for glyph cache lock!");
+        return ESP_ERR_NO_MEM;
+    }
+
+    cache->orig = cache_cfg->font;
+    cache->size = cache_cfg->cache_size;
+    cache->caps = (cache_cfg->flags.buff_spiram ? MALLOC_CAP_SPIRAM : MALLOC_CAP_INTERNAL) | MALLOC_CAP_8BIT;
+    TAILQ_INIT(&cache->lru_list);
+
+    /* Same metrics as the original font, glyphs go through the cache */
+    cache->font = *cache_cfg->font;
+    cache->font.get_glyph_dsc = lvgl_port_font_get_glyph_dsc;
+    cache->font.get_glyph_bitmap = lvgl_port_font_get_glyph_bitmap;
+    cache->font.release_glyph = lvgl_port_font_release_glyph;
+    cache->font.user_data = cache;
+
+    *ret_cache = cache;
+    return ESP_OK;
+}
+
+const lv_font_t *lvgl_port_font_cache_get_font(lvgl_port_font_cache_handle_t cache)
+{
+    return (cache ? &cache->font : NULL);
+}
+
+esp_err_t lvgl_port_font_cache_prewarm(lvgl_port_font_cache_handle_t cache, const char *text)
+{
+    ESP_RETURN_ON_FALSE(cache && text, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+
+    lv_draw_buf_t *draw_buf = NULL;
+    esp_err_t ret = ESP_OK;
+    uint32_t i = 0;
+    while (text[i] != '\0') {
+        const uint32_t letter = lv_text_encoded_next(text, &i);
+        lv_font_glyph_dsc_t g;
+        if (!lv_font_get_glyph_dsc(&cache->font, &g, letter, 0) || g.resolved_font != &cache->font) {
+            continue;
+        }
+        if (g.format <= LV_FONT_GLYPH_FORMAT_NONE || g.format >= LV_FONT_GLYPH_FORMAT_IMAGE || g.box_w == 0 || g.box_h == 0) {
+            lv_font_glyph_release_draw_data(&g);
+            continue;
+        }
+
+        /* The same temporary buffer as in label drawing */
+        lv_draw_buf_t *glyph_buf = (draw_buf ? lv_draw_buf_reshape(draw_buf, LV_COLOR_FORMAT_A8, g.box_w, g.box_h, LV_STRIDE_AUTO) : NULL);
+        if (glyph_buf == NULL) {
+            if (draw_buf) {
+                lv_draw_buf_destroy(draw_buf);
+            }
+            draw_buf = lv_draw_buf_create(g.box_w, g.box_h, LV_COLOR_FORMAT_A8, LV_STRIDE_AUTO);
+            glyph_buf = draw_buf;
+        }
+        if (glyph_buf == NULL) {
+            lv_font_glyph_release_draw_data(&g);
+            ret = ESP_ERR_NO_MEM;
+            break;
+        }
+        lv_font_get_glyph_bitmap(&g, glyph_buf);
+        lv_font_glyph_release_draw_data(&g);
+    }
+
+    if (draw_buf) {
+        lv_draw_buf_destroy(draw_buf);
+    }
+    ESP_LOGD(TAG, "Glyph cache prewarmed: %"PRIu32" glyphs, %"PRIu32" B", cache->stats.glyph_cnt, cache->used);
+    return ret;
+}
+
+esp_err_t lvgl_port_font_cache_get_stats(lvgl_port_font_cache_handle_t cache, lvgl_port_font_cache_stats_t *stats, bool reset)
+{
+    ESP_RETURN_ON_FALSE(cache && stats, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+
+    xSemaphoreTake(cache->lock, portMAX_DELAY);
+    *stats = cache->stats;
+    stats->used_size = cache->used;
+    if (reset) {
+        cache->stats.hit_cnt = 0;
+        cache->stats.miss_cnt = 0;
+        cache->stats.evict_cnt = 0;
+    }
+    xSemaphoreGive(cache->lock);
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_font_cache_delete(lvgl_port_font_cache_handle_t cache)
+{
+    ESP_RETURN_ON_FALSE(cache, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+
+    lvgl_port_font_evict(cache, cache->size);
+    vSemaphoreDelete(cache->lock);
+    free(cache);
+    return ESP_OK;
+}
+
+/*******************************************************************************
+* Private functions
+*******************************************************************************/
+
+static inline uint32_t lvgl_port_font_bucket(uint32_t index)
+{
+    return (index * 2654435761u) >> 26;     /* Fibonacci hashing into 64 buckets */
+}
+
+/* Remove the least recently used glyphs, until there is space for `need` bytes, lock must be taken */
+static void lvgl_port_font_evict(lvgl_port_font_cache_handle_t cache, uint32_t need)
+{
+    lvgl_port_glyph_t *glyph;
+    while (cache->used + need > cache->size && (glyph = TAILQ_LAST(&cache->lru_list, lvgl_port_glyph_list)) != NULL) {
+        TAILQ_REMOVE(&cache->lru_list, glyph, lru);
+        SLIST_REMOVE(&cache->buckets[lvgl_port_font_bucket(glyph->index)], glyph, lvgl_port_glyph_s, bucket);
+        cache->used -= sizeof(lvgl_port_glyph_t) + glyph->w * glyph->h;
+        cache->stats.glyph_cnt--;
+        cache->stats.evict_cnt++;
+        heap_caps_free(glyph);
+    }
+}
+
+static bool lvgl_port_font_get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc, uint32_t letter, uint32_t letter_next)
+{
+    lvgl_port_font_cache_handle_t cache = font->user_data;
+    return cache->orig->get_glyph_dsc(cache->orig, dsc, letter, letter_next);
+}
+
+static const void *lvgl_port_font_get_glyph_bitmap(lv_font_glyph_dsc_t *dsc, lv_draw_buf_t *draw_buf)
+{
+    lvgl_port_font_cache_handle_t cache = dsc->resolved_font->user_data;
+    const bool bitmap = (dsc->format > LV_FONT_GLYPH_FORMAT_NONE && dsc->format < LV_FONT_GLYPH_FORMAT_IMAGE);
+    const uint32_t w = dsc->box_w;
+    const uint32_t h = dsc->box_h;
+
+    if (bitmap && draw_buf && w > 0 && h > 0) {
+        xSemaphoreTake(cache->lock, portMAX_DELAY);
+        lvgl_port_glyph_t *glyph;
+        SLIST_FOREACH(glyph, &cache->buckets[lvgl_port_font_bucket(dsc->gid.index)], bucket) {
+            if (glyph->index == dsc->gid.index && glyph->w == w && glyph->h == h) {
+                break;
+            }
+        }
+        if (glyph) {
+            const uint32_t stride = draw_buf->header.stride;
+            for (uint32_t y = 0; y < h; y++) {
+                memcpy(draw_buf->data + y * stride, glyph->data + y * w, w);
+            }
+            TAILQ_REMOVE(&cache->lru_list, glyph, lru);
+            TAILQ_INSERT_HEAD(&cache->lru_list, glyph, lru);
+            cache->stats.hit_cnt++;
+            xSemaphoreGive(cache->lock);
+            return draw_buf;
+        }
+        cache->stats.miss_cnt++;
+        xSemaphoreGive(cache->lock);
+    }
+
+    /* Original font renders the glyph */
+    dsc->resolved_font = cache->orig;
+    const void *ret = cache->orig->get_glyph_bitmap(dsc, draw_buf);
+    dsc->resolved_font = &cache->font;
+
+    const uint32_t glyph_size = sizeof(lvgl_port_glyph_t) + w * h;
+    if (ret != draw_buf || !bitmap || draw_buf == NULL || w == 0 || h == 0 || glyph_size > cache->size) {
+        return ret;
+    }
+
+    xSemaphoreTake(cache->lock, portMAX_DELAY);
+    lvgl_port_font_evict(cache, glyph_size);
+    lvgl_port_glyph_t *glyph = heap_caps_malloc(glyph_size, cache->caps);
+    if (glyph) {
+        glyph->index = dsc->gid.index;
+        glyph->w = w;
+        glyph->h = h;
+        const uint32_t stride = draw_buf->header.stride;
+        for (uint32_t y = 0; y < h; y++) {
+            memcpy(glyph->data + y * w, draw_buf->data + y * stride, w);
+        }
+        SLIST_INSERT_HEAD(&cache->buckets[lvgl_port_font_bucket(glyph->index)], glyph, bucket);
+        TAILQ_INSERT_HEAD(&cache->lru_list, glyph, lru);
+        cache->used += glyph_size;
+        cache->stats.glyph_cnt++;
+    }
+    xSemaphoreGive(cache->lock);
+    return ret;
+}
+
+static void lvgl_port_font_release_glyph(const lv_font_t *font, lv_font_glyph_dsc_t *dsc)
+{
+    lvgl_port_font_cache_handle_t cache = font->user_data;
+    if (cache->orig->release_glyph) {
+        cache->orig->release_glyph(cache->orig, dsc);
+    }
+}
+
+#else // LVGL_PORT_FONT_CACHE_SUPPORTED
+
+esp_err_t lvgl_port_font_cache_create(const lvgl_port_font_cache_cfg_t *cache_cfg, lvgl_port_font_cache_handle_t *ret_cache)
+{
+    ESP_LOGE(TAG, "Glyph cache needs LVGL 9.2 or newer!");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+const lv_font_t *lvgl_port_font_cache_get_font(lvgl_port_font_cache_handle_t cache)
+{
+    return NULL;
+}
+
+esp_err_t lvgl_port_font_cache_prewarm(lvgl_port_font_cache_handle_t cache, const char *text)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t lvgl_port_font_cache_get_stats(lvgl_port_font_cache_handle_t cache, lvgl_port_font_cache_stats_t *stats, bool reset)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t lvgl_port_font_cache_delete(lvgl_port_font_cache_handle_t cache)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif // LVGL_PORT_FONT_CACHE_SUPPORTED
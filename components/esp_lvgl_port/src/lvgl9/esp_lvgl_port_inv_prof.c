@@ -0,0 +1,198 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_lvgl_port.h"
+#include "esp_lvgl_port_priv.h"
+
+static const char *TAG = "LVGL";
+
+/* Screens summed in the report, the others are summed as "other" */
+#define LVGL_PORT_INV_PROF_SCREENS  (8)
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+typedef struct {
+    lv_obj_t            *obj;       /* Object the areas were attributed to (can be deleted already) */
+    lv_obj_t            *screen;    /* Screen of the object */
+    const char          *cls;       /* Class name of the object, read at the first invalidation */
+    lv_area_t           coords;     /* Coordinates of the object at the last invalidation */
+    uint64_t            pixels;     /* Invalidated pixels */
+    uint32_t            count;      /* Count of invalidations */
+} lvgl_port_inv_prof_entry_t;
+
+typedef struct {
+    lvgl_port_inv_prof_entry_t entries[CONFIG_LVGL_PORT_INV_PROFILER_OBJS];
+    uint32_t            entry_cnt;
+    uint64_t            other_pixels;   /* Pixels of objects which did not fit into entries */
+    uint64_t            total_pixels;
+    uint32_t            total_count;
+    lv_timer_t          *timer;         /* Periodic report */
+} lvgl_port_inv_prof_t;
+
+/*******************************************************************************
+* Local variables
+*******************************************************************************/
+
+static lvgl_port_inv_prof_t lvgl_port_inv_prof;
+
+/*******************************************************************************
+* Function definitions
+*******************************************************************************/
+
+static lv_obj_t *lvgl_port_inv_prof_find(lv_obj_t *obj, const lv_area_t *area);
+static void lvgl_port_inv_prof_report(lv_timer_t *timer);
+
+/*******************************************************************************
+* Private functions
+*******************************************************************************/
+
+void lvgl_port_inv_prof_record(lv_display_t *disp, const lv_area_t *area)
+{
+    lvgl_port_inv_prof_t *prof = &lvgl_port_inv_prof;
+
+    if (prof->timer == NULL) {
+        prof->timer = lv_timer_create(lvgl_port_inv_prof_report, CONFIG_LVGL_PORT_INV_PROFILER_PERIOD_MS, NULL);
+        if (prof->timer == NULL) {
+            return;
+        }
+    }
+
+    /* Top-most layer first, the screen itself when no object covers the area */
+    lv_obj_t *layers[] = {lv_display_get_layer_sys(disp), lv_display_get_layer_top(disp), lv_display_get_screen_active(disp)};
+    lv_obj_t *obj = NULL;
+    for (size_t i = 0; i < sizeof(layers) / sizeof(layers[0]) && obj == NULL; i++) {
+        if (layers[i]) {
+            obj = lvgl_port_inv_prof_find(layers[i], area);
+            obj = (obj == layers[i] && i < 2 ? NULL : obj);
+        }
+    }
+    if (obj == NULL) {
+        obj = lv_display_get_screen_active(disp);
+    }
+
+    const uint32_t pixels = lv_area_get_size(area);
+    prof->total_pixels += pixels;
+    prof->total_count++;
+
+    lvgl_port_inv_prof_entry_t *entry = NULL;
+    for (uint32_t i = 0; i < prof->entry_cnt; i++) {
+        if (prof->entries[i].obj == obj) {
+            entry = &prof->entries[i];
+            break;
+        }
+    }
+    if (entry == NULL && prof->entry_cnt < CONFIG_LVGL_PORT_INV_PROFILER_OBJS) {
+        entry = &prof->entries[prof->entry_cnt++];
+        entry->obj = obj;
+        entry->screen = lv_obj_get_screen(obj);
+        entry->cls = lv_obj_get_class(obj)->name;
+    }
+    if (entry == NULL) {
+        prof->other_pixels += pixels;
+        return;
+    }
+    lv_obj_get_coords(obj, &entry->coords);
+    entry->pixels += pixels;
+    entry->count++;
+}
+
+/*******************************************************************************
+* Local functions
+*******************************************************************************/
+
+/* Deepest visible object, whose drawn area covers the invalidated area (areas are invalidated in object coordinates
+ * extended by the shadow/outline size and clipped by the parents) */
+static lv_obj_t *lvgl_port_inv_prof_find(lv_obj_t *obj, const lv_area_t *area)
+{
+    /* Later children are drawn above the earlier ones */
+    for (int32_t i = (int32_t)lv_obj_get_child_count(obj) - 1; i >= 0; i--) {
+        lv_obj_t *child = lv_obj_get_child(obj, i);
+        if (lv_obj_has_flag(child, LV_OBJ_FLAG_HIDDEN)) {
+            continue;
+        }
+        lv_area_t coords;
+        lv_obj_get_coords(child, &coords);
+        const int32_t ext = lv_obj_get_ext_draw_size(child);
+        lv_area_increase(&coords, ext, ext);
+        if (lv_area_is_in(area, &coords, 0)) {
+            return lvgl_port_inv_prof_find(child, area);
+        }
+    }
+    return obj;
+}
+
+static int lvgl_port_inv_prof_cmp(const void *a, const void *b)
+{
+    const uint64_t pa = ((const lvgl_port_inv_prof_entry_t *)a)->pixels;
+    const uint64_t pb = ((const lvgl_port_inv_prof_entry_t *)b)->pixels;
+    return (pa < pb) - (pa > pb);
+}
+
+static void lvgl_port_inv_prof_report(lv_timer_t *timer)
+{
+    lvgl_port_inv_prof_t *prof = &lvgl_port_inv_prof;
+    if (prof->total_count == 0) {
+        return;
+    }
+
+    lv_display_t *disp = lv_display_get_default();
+    const uint32_t screen_px = (disp ? lv_display_get_horizontal_resolution(disp) * lv_display_get_vertical_resolution(disp) : 0);
+    ESP_LOGI(TAG, "Invalidated %" PRIu64 " px (%" PRIu64 " screens) in %" PRIu32 " areas during %d ms",
+             prof->total_pixels, (screen_px ? prof->total_pixels / screen_px : 0), prof->total_count,
+             CONFIG_LVGL_PORT_INV_PROFILER_PERIOD_MS);
+
+    qsort(prof->entries, prof->entry_cnt, sizeof(lvgl_port_inv_prof_entry_t), lvgl_port_inv_prof_cmp);
+    printf("%-10s %-12s %-20s %12s %6s %8s\n", "object", "class", "coords", "pixels", "%", "count");
+    for (uint32_t i = 0; i < prof->entry_cnt && i < CONFIG_LVGL_PORT_INV_PROFILER_TOP_N; i++) {
+        const lvgl_port_inv_prof_entry_t *entry = &prof->entries[i];
+        char coords[24];
+        snprintf(coords, sizeof(coords), "%" PRId32 ",%" PRId32 " %" PRId32 "x%" PRId32, entry->coords.x1, entry->coords.y1,
+                 lv_area_get_width(&entry->coords), lv_area_get_height(&entry->coords));
+        printf("%-10p %-12s %-20s %12" PRIu64 " %6.1f %8" PRIu32 "\n", (void *)entry->obj, (entry->cls ? entry->cls : "?"), coords,
+               entry->pixels, 100.0 * entry->pixels / prof->total_pixels, entry->count);
+    }
+    if (prof->other_pixels) {
+        printf("%-10s %-12s %-20s %12" PRIu64 " %6.1f\n", "other", "", "", prof->other_pixels,
+               100.0 * prof->other_pixels / prof->total_pixels);
+    }
+
+    /* Sum per screen */
+    lv_obj_t *screens[LVGL_PORT_INV_PROF_SCREENS] = {0};
+    uint64_t screen_pixels[LVGL_PORT_INV_PROF_SCREENS] = {0};
+    uint64_t screen_other = prof->other_pixels;
+    for (uint32_t i = 0; i < prof->entry_cnt; i++) {
+        const lvgl_port_inv_prof_entry_t *entry = &prof->entries[i];
+        int s = 0;
+        while (s < LVGL_PORT_INV_PROF_SCREENS && screens[s] && screens[s] != entry->screen) {
+            s++;
+        }
+        if (s == LVGL_PORT_INV_PROF_SCREENS) {
+            screen_other += entry->pixels;
+            continue;
+        }
+        screens[s] = entry->screen;
+        screen_pixels[s] += entry->pixels;
+    }
+    printf("%-10s %12s %6s\n", "screen", "pixels", "%");
+    for (int s = 0; s < LVGL_PORT_INV_PROF_SCREENS && screens[s]; s++) {
+        printf("%-10p %12" PRIu64 " %6.1f\n", (void *)screens[s], screen_pixels[s], 100.0 * screen_pixels[s] / prof->total_pixels);
+    }
+    if (screen_other) {
+        printf("%-10s %12" PRIu64 " %6.1f\n", "other", screen_other, 100.0 * screen_other / prof->total_pixels);
+    }
+
+    /* Next period from zero, the pointers of deleted objects are not kept */
+    lv_timer_t *report_timer = prof->timer;
+    memset(prof, 0, sizeof(lvgl_port_inv_prof_t));
+    prof->timer = report_timer;
+}
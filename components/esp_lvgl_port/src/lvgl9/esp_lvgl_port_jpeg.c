@@ -0,0 +1,487 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <strings.h>
+#include <sys/queue.h>
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_idf_version.h"
+#include "soc/soc_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_lvgl_port.h"
+
+#if SOC_JPEG_CODEC_SUPPORTED && (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0))
+#include "driver/jpeg_decode.h"
+#define LVGL_PORT_JPEG_SUPPORTED 1
+#else
+#define LVGL_PORT_JPEG_SUPPORTED 0
+#endif
+
+static const char *TAG = "LVGL";
+
+#if LVGL_PORT_JPEG_SUPPORTED
+
+#define LVGL_PORT_JPEG_TIMEOUT_MS   (100)
+/* Maximum count of JPEG segments before SOF marker */
+#define LVGL_PORT_JPEG_MAX_SEGMENTS (64)
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+/* Decoded image, it stays in the cache after close until it is evicted */
+typedef struct lvgl_port_jpeg_entry_s {
+    TAILQ_ENTRY(lvgl_port_jpeg_entry_s) next;
+    const void      *src_var;   /* Source image descriptor (variable source) */
+    char            *src_path;  /* Copy of the source path (file source) */
+    uint32_t        ref_cnt;    /* Count of open decoder descriptors */
+    bool            cached;     /* Entry is in the cache list */
+    size_t          size;       /* Size of the allocated pixels */
+    lv_draw_buf_t   draw_buf;   /* Decoded pixels (DMA output) */
+} lvgl_port_jpeg_entry_t;
+
+typedef struct {
+    lv_image_decoder_t      *decoder;       /* LVGL image decoder */
+    jpeg_decoder_handle_t   engine;         /* Hardware JPEG decoder engine */
+    jpeg_decode_cfg_t       decode_cfg;     /* Output format of decoder */
+    lv_color_format_t       cf;             /* Color format of decoded images */
+    uint8_t                 px_size;        /* Bytes per pixel of decoded images */
+    SemaphoreHandle_t       lock;           /* Decoder can be opened from more draw units */
+    uint8_t                 *in_buf;        /* DMA input buffer for the JPEG data */
+    size_t                  in_buf_size;    /* Size of the input buffer */
+    uint32_t                cache_size;     /* Budget of the cache in bytes */
+    uint32_t                cache_used;     /* Bytes used by the cached images */
+    TAILQ_HEAD(, lvgl_port_jpeg_entry_s) cache; /* Cached images, the most recently used first */
+} lvgl_port_jpeg_ctx_t;
+
+/* Source reader, the JPEG data are in variable or in file */
+typedef struct {
+    const uint8_t   *data;
+    uint32_t        data_size;
+    lv_fs_file_t    file;
+    bool            is_file;
+} lvgl_port_jpeg_src_t;
+
+/*******************************************************************************
+* Local variables
+*******************************************************************************/
+
+static lvgl_port_jpeg_ctx_t *lvgl_port_jpeg_ctx = NULL;
+
+/*******************************************************************************
+* Function definitions
+*******************************************************************************/
+
+static lv_result_t lvgl_port_jpeg_info(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc, lv_image_header_t *header);
+static lv_result_t lvgl_port_jpeg_open(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc);
+static void lvgl_port_jpeg_close(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc);
+static bool lvgl_port_jpeg_src_open(lvgl_port_jpeg_src_t *src, const void *img_src);
+static void lvgl_port_jpeg_src_close(lvgl_port_jpeg_src_t *src);
+static bool lvgl_port_jpeg_src_read(lvgl_port_jpeg_src_t *src, uint32_t pos, uint8_t *buf, uint32_t len);
+static bool lvgl_port_jpeg_get_size(lvgl_port_jpeg_src_t *src, uint32_t *w, uint32_t *h);
+static lvgl_port_jpeg_entry_t *lvgl_port_jpeg_cache_find(lvgl_port_jpeg_ctx_t *ctx, const void *img_src);
+static void lvgl_port_jpeg_cache_evict(lvgl_port_jpeg_ctx_t *ctx, uint32_t needed, const void *img_src);
+static void lvgl_port_jpeg_entry_free(lvgl_port_jpeg_entry_t *entry);
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t lvgl_port_jpeg_decoder_init(const lvgl_port_jpeg_cfg_t *jpeg_cfg)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(jpeg_cfg, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments!");
+    ESP_RETURN_ON_FALSE(lvgl_port_jpeg_ctx == NULL, ESP_ERR_INVALID_STATE, TAG, "JPEG decoder is already added!");
+
+    const lv_color_format_t cf = (jpeg_cfg->color_format == LV_COLOR_FORMAT_UNKNOWN) ? LV_COLOR_FORMAT_RGB565 : jpeg_cfg->color_format;
+    ESP_RETURN_ON_FALSE(cf == LV_COLOR_FORMAT_RGB565 || cf == LV_COLOR_FORMAT_RGB888, ESP_ERR_INVALID_ARG, TAG, "JPEG decoder supports only RGB565 and RGB888 output!");
+
+    lvgl_port_jpeg_ctx_t *ctx = calloc(1, sizeof(lvgl_port_jpeg_ctx_t));
+    ESP_RETURN_ON_FALSE(ctx, ESP_ERR_NO_MEM, TAG, "Not enough memory for JPEG decoder context allocation!");
+    TAILQ_INIT(&ctx->cache);
+    ctx->cf = cf;
+    ctx->px_size = lv_color_format_get_size(cf);
+    ctx->cache_size = jpeg_cfg->cache_size;
+    /* LVGL expects the blue channel in the lowest bits */
+    ctx->decode_cfg.output_format = (cf == LV_COLOR_FORMAT_RGB565) ? JPEG_DECODE_OUT_FORMAT_RGB565 : JPEG_DECODE_OUT_FORMAT_RGB888;
+    ctx->decode_cfg.rgb_order = JPEG_DEC_RGB_ELEMENT_ORDER_BGR;
+    ctx->decode_cfg.conv_std = JPEG_YUV_RGB_CONV_STD_BT601;
+
+    ctx->lock = xSemaphoreCreateMutex();
+    ESP_GOTO_ON_FALSE(ctx->lock, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for JPEG decoder mutex!");
+
+    const jpeg_decode_engine_cfg_t engine_cfg = {
+        .timeout_ms = jpeg_cfg->timeout_ms ? jpeg_cfg->timeout_ms : LVGL_PORT_JPEG_TIMEOUT_MS,
+    };
+    ESP_GOTO_ON_ERROR(jpeg_new_decoder_engine(&engine_cfg, &ctx->engine), err, TAG, "JPEG decoder engine create failed!");
+
+    lvgl_port_lock(0);
+    ctx->decoder = lv_image_decoder_create();
+    if (ctx->decoder) {
+        lv_image_decoder_set_info_cb(ctx->decoder, lvgl_port_jpeg_info);
+        lv_image_decoder_set_open_cb(ctx->decoder, lvgl_port_jpeg_open);
+        lv_image_decoder_set_close_cb(ctx->decoder, lvgl_port_jpeg_close);
+        ctx->decoder->user_data = ctx;
+    }
+    lvgl_port_unlock();
+    ESP_GOTO_ON_FALSE(ctx->decoder, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for LVGL image decoder!");
+
+    lvgl_port_jpeg_ctx = ctx;
+    return ESP_OK;
+
+err:
+    if (ctx->engine) {
+        jpeg_del_decoder_engine(ctx->engine);
+    }
+    if (ctx->lock) {
+        vSemaphoreDelete(ctx->lock);
+    }
+    free(ctx);
+    return ret;
+}
+
+void lvgl_port_jpeg_decoder_cache_drop(const void *src)
+{
+    lvgl_port_jpeg_ctx_t *ctx = lvgl_port_jpeg_ctx;
+    if (ctx == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    lvgl_port_jpeg_cache_evict(ctx, UINT32_MAX, src);
+    xSemaphoreGive(ctx->lock);
+}
+
+esp_err_t lvgl_port_jpeg_decoder_deinit(void)
+{
+    lvgl_port_jpeg_ctx_t *ctx = lvgl_port_jpeg_ctx;
+    if (ctx == NULL) {
+        return ESP_OK;
+    }
+
+    lvgl_port_lock(0);
+    lv_image_decoder_delete(ctx->decoder);
+    lvgl_port_unlock();
+
+    while (!TAILQ_EMPTY(&ctx->cache)) {
+        lvgl_port_jpeg_entry_t *entry = TAILQ_FIRST(&ctx->cache);
+        TAILQ_REMOVE(&ctx->cache, entry, next);
+        lvgl_port_jpeg_entry_free(entry);
+    }
+    jpeg_del_decoder_engine(ctx->engine);
+    vSemaphoreDelete(ctx->lock);
+    free(ctx->in_buf);
+    free(ctx);
+    lvgl_port_jpeg_ctx = NULL;
+
+    return ESP_OK;
+}
+
+/*******************************************************************************
+* Private functions
+*******************************************************************************/
+
+static lv_result_t lvgl_port_jpeg_info(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc, lv_image_header_t *header)
+{
+    lvgl_port_jpeg_ctx_t *ctx = decoder->user_data;
+    lvgl_port_jpeg_src_t src;
+    uint32_t w, h;
+
+    if (!lvgl_port_jpeg_src_open(&src, dsc->src)) {
+        return LV_RESULT_INVALID;
+    }
+    const bool ok = lvgl_port_jpeg_get_size(&src, &w, &h);
+    lvgl_port_jpeg_src_close(&src);
+    if (!ok) {
+        return LV_RESULT_INVALID;
+    }
+
+    header->cf = ctx->cf;
+    header->w = w;
+    header->h = h;
+    header->stride = w * ctx->px_size;
+    return LV_RESULT_OK;
+}
+
+static lv_result_t lvgl_port_jpeg_open(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+{
+    lvgl_port_jpeg_ctx_t *ctx = decoder->user_data;
+    lvgl_port_jpeg_entry_t *entry = NULL;
+    lvgl_port_jpeg_src_t src;
+    lv_result_t res = LV_RESULT_INVALID;
+
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+
+    /* Decoded image from the cache is moved to the front */
+    entry = lvgl_port_jpeg_cache_find(ctx, dsc->src);
+    if (entry) {
+        TAILQ_REMOVE(&ctx->cache, entry, next);
+        TAILQ_INSERT_HEAD(&ctx->cache, entry, next);
+        goto done;
+    }
+
+    /* Whole JPEG data are read into the DMA input buffer */
+    if (!lvgl_port_jpeg_src_open(&src, dsc->src)) {
+        goto end;
+    }
+    uint32_t in_size = src.data_size;
+    if (in_size > ctx->in_buf_size) {
+        const jpeg_decode_memory_alloc_cfg_t in_mem_cfg = {
+            .buffer_direction = JPEG_DEC_ALLOC_INPUT_BUFFER,
+        };
+        free(ctx->in_buf);
+        ctx->in_buf = jpeg_alloc_decoder_mem(in_size, &in_mem_cfg, &ctx->in_buf_size);
+        if (ctx->in_buf == NULL) {
+            ctx->in_buf_size = 0;
+        }
+    }
+    const bool read_ok = (ctx->in_buf && lvgl_port_jpeg_src_read(&src, 0, ctx->in_buf, in_size));
+    lvgl_port_jpeg_src_close(&src);
+    if (!read_ok) {
+        ESP_LOGE(TAG, "Not enough memory for JPEG data (%"PRIu32" bytes)!", in_size);
+        goto end;
+    }
+
+    /* Output of the codec is aligned to whole MCU blocks */
+    jpeg_decode_picture_info_t info;
+    if (jpeg_decoder_get_info(ctx->in_buf, in_size, &info) != ESP_OK) {
+        goto end;
+    }
+    const uint32_t mcu_w = (info.sample_method == JPEG_DOWN_SAMPLING_YUV420 || info.sample_method == JPEG_DOWN_SAMPLING_YUV422) ? 16 : 8;
+    const uint32_t mcu_h = (info.sample_method == JPEG_DOWN_SAMPLING_YUV420) ? 16 : 8;
+    const uint32_t stride = ((info.width + mcu_w - 1) / mcu_w) * mcu_w * ctx->px_size;
+    const uint32_t out_size = stride * (((info.height + mcu_h - 1) / mcu_h) * mcu_h);
+
+    /* Place for the new image is made from the least recently used ones */
+    if (ctx->cache_size) {
+        lvgl_port_jpeg_cache_evict(ctx, out_size, NULL);
+    }
+
+    entry = calloc(1, sizeof(lvgl_port_jpeg_entry_t));
+    if (entry == NULL) {
+        goto end;
+    }
+    const jpeg_decode_memory_alloc_cfg_t out_mem_cfg = {
+        .buffer_direction = JPEG_DEC_ALLOC_OUTPUT_BUFFER,
+    };
+    void *out_buf = jpeg_alloc_decoder_mem(out_size, &out_mem_cfg, &entry->size);
+    if (out_buf == NULL) {
+        ESP_LOGE(TAG, "Not enough memory for decoded JPEG image (%"PRIu32" bytes)!", out_size);
+        goto err;
+    }
+    lv_draw_buf_init(&entry->draw_buf, info.width, info.height, ctx->cf, stride, out_buf, entry->size);
+
+    uint32_t written = 0;
+    if (jpeg_decoder_process(ctx->engine, &ctx->decode_cfg, ctx->in_buf, in_size, out_buf, entry->size, &written) != ESP_OK) {
+        ESP_LOGE(TAG, "JPEG decoding failed!");
+        goto err;
+    }
+
+    if (lv_image_src_get_type(dsc->src) == LV_IMAGE_SRC_FILE) {
+        entry->src_path = strdup(dsc->src);
+    } else {
+        entry->src_var = dsc->src;
+    }
+    /* Image larger than the whole budget is freed in close */
+    if (ctx->cache_size && entry->size <= ctx->cache_size && (entry->src_var || entry->src_path)) {
+        entry->cached = true;
+        ctx->cache_used += entry->size;
+        TAILQ_INSERT_HEAD(&ctx->cache, entry, next);
+    }
+
+done:
+    entry->ref_cnt++;
+    dsc->decoded = &entry->draw_buf;
+    dsc->user_data = entry;
+    res = LV_RESULT_OK;
+    goto end;
+
+err:
+    lvgl_port_jpeg_entry_free(entry);
+end:
+    xSemaphoreGive(ctx->lock);
+    return res;
+}
+
+static void lvgl_port_jpeg_close(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+{
+    lvgl_port_jpeg_ctx_t *ctx = decoder->user_data;
+    lvgl_port_jpeg_entry_t *entry = dsc->user_data;
+    if (entry == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    entry->ref_cnt--;
+    if (!entry->cached && entry->ref_cnt == 0) {
+        lvgl_port_jpeg_entry_free(entry);
+    }
+    xSemaphoreGive(ctx->lock);
+    dsc->user_data = NULL;
+    dsc->decoded = NULL;
+}
+
+static bool lvgl_port_jpeg_src_open(lvgl_port_jpeg_src_t *src, const void *img_src)
+{
+    memset(src, 0, sizeof(lvgl_port_jpeg_src_t));
+
+    switch (lv_image_src_get_type(img_src)) {
+    case LV_IMAGE_SRC_VARIABLE: {
+        const lv_image_dsc_t *img_dsc = img_src;
+        if (img_dsc->header.cf != LV_COLOR_FORMAT_RAW || img_dsc->data_size < 2 || img_dsc->data[0] != 0xFF || img_dsc->data[1] != 0xD8) {
+            return false;
+        }
+        src->data = img_dsc->data;
+        src->data_size = img_dsc->data_size;
+        return true;
+    }
+    case LV_IMAGE_SRC_FILE: {
+        const char *ext = lv_fs_get_ext(img_src);
+        if (strcasecmp(ext, "jpg") != 0 && strcasecmp(ext, "jpeg") != 0) {
+            return false;
+        }
+        if (lv_fs_open(&src->file, img_src, LV_FS_MODE_RD) != LV_FS_RES_OK) {
+            return false;
+        }
+        src->is_file = true;
+        if (lv_fs_seek(&src->file, 0, LV_FS_SEEK_END) != LV_FS_RES_OK || lv_fs_tell(&src->file, &src->data_size) != LV_FS_RES_OK) {
+            lvgl_port_jpeg_src_close(src);
+            return false;
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+static void lvgl_port_jpeg_src_close(lvgl_port_jpeg_src_t *src)
+{
+    if (src->is_file) {
+        lv_fs_close(&src->file);
+        src->is_file = false;
+    }
+}
+
+static bool lvgl_port_jpeg_src_read(lvgl_port_jpeg_src_t *src, uint32_t pos, uint8_t *buf, uint32_t len)
+{
+    if (pos + len > src->data_size) {
+        return false;
+    }
+    if (!src->is_file) {
+        memcpy(buf, &src->data[pos], len);
+        return true;
+    }
+
+    uint32_t read = 0;
+    return lv_fs_seek(&src->file, pos, LV_FS_SEEK_SET) == LV_FS_RES_OK &&
+           lv_fs_read(&src->file, buf, len, &read) == LV_FS_RES_OK && read == len;
+}
+
+/* Finds baseline SOF marker without reading the whole file, progressive JPEG is left for other decoders */
+static bool lvgl_port_jpeg_get_size(lvgl_port_jpeg_src_t *src, uint32_t *w, uint32_t *h)
+{
+    uint8_t buf[9];
+    uint32_t pos = 2;
+
+    if (!lvgl_port_jpeg_src_read(src, 0, buf, 2) || buf[0] != 0xFF || buf[1] != 0xD8) {
+        return false;
+    }
+
+    for (int i = 0; i < LVGL_PORT_JPEG_MAX_SEGMENTS; i++) {
+        if (!lvgl_port_jpeg_src_read(src, pos, buf, 4) || buf[0] != 0xFF) {
+            return false;
+        }
+        const uint8_t marker = buf[1];
+        if (marker == 0xFF) {
+            /* Fill byte */
+            pos++;
+            continue;
+        }
+        if (marker == 0xC0 || marker == 0xC1) {
+            if (!lvgl_port_jpeg_src_read(src, pos + 4, buf, 5)) {
+                return false;
+            }
+            *h = (buf[1] << 8) | buf[2];
+            *w = (buf[3] << 8) | buf[4];
+            return (*w > 0 && *h > 0);
+        }
+        if ((marker >= 0xC2 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) || marker == 0xDA) {
+            /* Progressive, lossless or arithmetic coding is not supported by the codec */
+            return false;
+        }
+        pos += 2 + ((buf[2] << 8) | buf[3]);
+    }
+
+    return false;
+}
+
+static lvgl_port_jpeg_entry_t *lvgl_port_jpeg_cache_find(lvgl_port_jpeg_ctx_t *ctx, const void *img_src)
+{
+    const bool is_file = (lv_image_src_get_type(img_src) == LV_IMAGE_SRC_FILE);
+    lvgl_port_jpeg_entry_t *entry;
+
+    TAILQ_FOREACH(entry, &ctx->cache, next) {
+        if (is_file ? (entry->src_path && strcmp(entry->src_path, img_src) == 0) : (entry->src_var == img_src)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/* Frees unused images from the end of the cache (or only images of the source), until the needed bytes fit into the budget */
+static void lvgl_port_jpeg_cache_evict(lvgl_port_jpeg_ctx_t *ctx, uint32_t needed, const void *img_src)
+{
+    lvgl_port_jpeg_entry_t *entry = TAILQ_LAST(&ctx->cache, lvgl_port_jpeg_entry_s);
+    const lvgl_port_jpeg_entry_t *match = img_src ? lvgl_port_jpeg_cache_find(ctx, img_src) : NULL;
+    if (img_src && match == NULL) {
+        return;
+    }
+
+    while (entry && (needed == UINT32_MAX || ctx->cache_used + needed > ctx->cache_size)) {
+        lvgl_port_jpeg_entry_t *prev = TAILQ_PREV(entry, lvgl_port_jpeg_entry_s, next);
+        if (entry->ref_cnt == 0 && (match == NULL || entry == match)) {
+            TAILQ_REMOVE(&ctx->cache, entry, next);
+            ctx->cache_used -= entry->size;
+            lvgl_port_jpeg_entry_free(entry);
+        }
+        entry = prev;
+    }
+}
+
+static void lvgl_port_jpeg_entry_free(lvgl_port_jpeg_entry_t *entry)
+{
+    if (entry == NULL) {
+        return;
+    }
+    free(entry->draw_buf.data);
+    free(entry->src_path);
+    free(entry);
+}
+
+#else
+
+esp_err_t lvgl_port_jpeg_decoder_init(const lvgl_port_jpeg_cfg_t *jpeg_cfg)
+{
+    ESP_LOGE(TAG, "Hardware JPEG decoder is not supported on this chip!");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void lvgl_port_jpeg_decoder_cache_drop(const void *src)
+{
+}
+
+esp_err_t lvgl_port_jpeg_decoder_deinit(void)
+{
+    return ESP_OK;
+}
+
+#endif
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <stdatomic.h>
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_check.h"
@@ -20,6 +21,8 @@ typedef struct {
     button_handle_t btn_handle;     /* Encoder button handlers */
     lv_indev_t      *indev;         /* LVGL input device driver */
     bool btn_enter;                 /* Encoder button enter state */
+    atomic_int      steps;          /* Knob steps since the last read (signed) */
+    uint8_t         accel;          /* Acceleration of fast rotation */
 } lvgl_port_encoder_ctx_t;
 
 /*******************************************************************************
@@ -29,7 +32,8 @@ typedef struct {
 static void lvgl_port_encoder_read(lv_indev_t *indev_drv, lv_indev_data_t *data);
 static void lvgl_port_encoder_btn_down_handler(void *arg, void *arg2);
 static void lvgl_port_encoder_btn_up_handler(void *arg, void *arg2);
-static void lvgl_port_encoder_knob_handler(void *arg, void *arg2);
+static void lvgl_port_encoder_knob_left_handler(void *arg, void *arg2);
+static void lvgl_port_encoder_knob_right_handler(void *arg, void *arg2);
 
 /*******************************************************************************
 * Public API functions
@@ -43,7 +47,7 @@ lv_indev_t *lvgl_port_add_encoder(const lvgl_port_encoder_cfg_t *encoder_cfg)
     assert(encoder_cfg->disp != NULL);
 
     /* Encoder context */
-    lvgl_port_encoder_ctx_t *encoder_ctx = malloc(sizeof(lvgl_port_encoder_ctx_t));
+    lvgl_port_encoder_ctx_t *encoder_ctx = calloc(1, sizeof(lvgl_port_encoder_ctx_t));
     if (encoder_ctx == NULL) {
         ESP_LOGE(TAG, "Not enough memory for encoder context allocation!");
         return NULL;
@@ -54,8 +58,8 @@ lv_indev_t *lvgl_port_add_encoder(const lvgl_port_encoder_cfg_t *encoder_cfg)
         encoder_ctx->knob_handle = iot_knob_create(encoder_cfg->encoder_a_b);
         ESP_GOTO_ON_FALSE(encoder_ctx->knob_handle, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for knob create!");
 
-        ESP_ERROR_CHECK(iot_knob_register_cb(encoder_ctx->knob_handle, KNOB_LEFT, lvgl_port_encoder_knob_handler, encoder_ctx));
-        ESP_ERROR_CHECK(iot_knob_register_cb(encoder_ctx->knob_handle, KNOB_RIGHT, lvgl_port_encoder_knob_handler, encoder_ctx));
+        ESP_ERROR_CHECK(iot_knob_register_cb(encoder_ctx->knob_handle, KNOB_LEFT, lvgl_port_encoder_knob_left_handler, encoder_ctx));
+        ESP_ERROR_CHECK(iot_knob_register_cb(encoder_ctx->knob_handle, KNOB_RIGHT, lvgl_port_encoder_knob_right_handler, encoder_ctx));
     }
 
     /* Encoder Enter */
@@ -68,6 +72,8 @@ lv_indev_t *lvgl_port_add_encoder(const lvgl_port_encoder_cfg_t *encoder_cfg)
     ESP_ERROR_CHECK(iot_button_register_cb(encoder_ctx->btn_handle, BUTTON_PRESS_UP, lvgl_port_encoder_btn_up_handler, encoder_ctx));
 
     encoder_ctx->btn_enter = false;
+    atomic_init(&encoder_ctx->steps, 0);
+    encoder_ctx->accel = encoder_cfg->accel;
 
     lvgl_port_lock(0);
     /* Register a encoder input device */
@@ -130,20 +136,17 @@ esp_err_t lvgl_port_remove_encoder(lv_indev_t *encoder)
 
 static void lvgl_port_encoder_read(lv_indev_t *indev_drv, lv_indev_data_t *data)
 {
-    static int32_t last_v = 0;
     assert(indev_drv);
     lvgl_port_encoder_ctx_t *ctx = (lvgl_port_encoder_ctx_t *)lv_indev_get_user_data(indev_drv);
     assert(ctx);
 
-    int32_t invd = iot_knob_get_count_value(ctx->knob_handle);
-    knob_event_t event = iot_knob_get_event(ctx->knob_handle);
-
-    if (last_v ^ invd) {
-        last_v = invd;
-        data->enc_diff = (KNOB_LEFT == event) ? (-1) : ((KNOB_RIGHT == event) ? (1) : (0));
-    } else {
-        data->enc_diff = 0;
+    /* All steps since the last read at once */
+    int32_t steps = atomic_exchange(&ctx->steps, 0);
+    if (ctx->accel > 0) {
+        const int32_t abs_steps = (steps < 0 ? -steps : steps);
+        steps += steps * (abs_steps - 1) * ctx->accel / 16;
     }
+    data->enc_diff = (int16_t)LV_CLAMP(INT16_MIN, steps, INT16_MAX);
     data->state = (true == ctx->btn_enter) ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
 }
 
@@ -177,9 +180,22 @@ static void lvgl_port_encoder_btn_up_handler(void *arg, void *arg2)
     lvgl_port_task_wake(LVGL_PORT_EVENT_TOUCH, ctx->indev);
 }
 
-static void lvgl_port_encoder_knob_handler(void *arg, void *arg2)
+static void lvgl_port_encoder_knob_left_handler(void *arg, void *arg2)
 {
     lvgl_port_encoder_ctx_t *ctx = (lvgl_port_encoder_ctx_t *) arg2;
-    /* Wake LVGL task, if needed */
-    lvgl_port_task_wake(LVGL_PORT_EVENT_TOUCH, ctx->indev);
+    const int prev = atomic_fetch_sub(&ctx->steps, 1);
+    /* Only the first step after the last read wakes LVGL task, next steps are summed */
+    if (prev == 0) {
+        lvgl_port_task_wake(LVGL_PORT_EVENT_TOUCH, ctx->indev);
+    }
+}
+
+static void lvgl_port_encoder_knob_right_handler(void *arg, void *arg2)
+{
+    lvgl_port_encoder_ctx_t *ctx = (lvgl_port_encoder_ctx_t *) arg2;
+    const int prev = atomic_fetch_add(&ctx->steps, 1);
+    /* Only the first step after the last read wakes LVGL task, next steps are summed */
+    if (prev == 0) {
+        lvgl_port_task_wake(LVGL_PORT_EVENT_TOUCH, ctx->indev);
+    }
 }
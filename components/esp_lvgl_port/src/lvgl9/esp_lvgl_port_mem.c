@@ -0,0 +1,269 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_lvgl_port.h"
+#include "esp_lvgl_port_mem.h"
+
+#if CONFIG_LVGL_PORT_MEM_ARENA
+#include "esp_heap_caps.h"
+#include "multi_heap.h"
+#include "freertos/FreeRTOS.h"
+
+#if LV_USE_STDLIB_MALLOC != LV_STDLIB_CUSTOM
+#error "CONFIG_LVGL_PORT_MEM_ARENA needs LV_USE_CUSTOM_MALLOC in LVGL configuration"
+#endif
+
+static const char *TAG = "LVGL";
+
+#define LVGL_PORT_MEM_ARENAS_MAX    (8)
+
+#if CONFIG_LVGL_PORT_MEM_ARENA_SPIRAM
+#define LVGL_PORT_MEM_ARENA_CAPS    (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#else
+#define LVGL_PORT_MEM_ARENA_CAPS    (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#endif
+
+typedef struct {
+    multi_heap_handle_t heap;   /* TLSF heap in the arena (NULL: free slot) */
+    uint8_t             *start;
+    size_t              size;
+    bool                own;    /* Arena memory allocated by port (not added by lv_mem_add_pool) */
+} lvgl_port_arena_t;
+
+/* Arenas are only added from lv_malloc_core, LVGL calls it with its lock or from its draw threads */
+static lvgl_port_arena_t arenas[LVGL_PORT_MEM_ARENAS_MAX];
+static uint32_t arena_cnt;
+static uint32_t fail_cnt;
+static portMUX_TYPE arena_lock = portMUX_INITIALIZER_UNLOCKED;   /* Lock of all TLSF heaps and arena list */
+
+/*******************************************************************************
+* Private functions
+*******************************************************************************/
+
+static lvgl_port_arena_t *lvgl_port_mem_arena_add(void *mem, size_t size, bool own)
+{
+    multi_heap_handle_t heap = multi_heap_register(mem, size);
+    if (heap == NULL) {
+        return NULL;
+    }
+    multi_heap_set_lock(heap, &arena_lock);
+
+    lvgl_port_arena_t *arena = NULL;
+    portENTER_CRITICAL(&arena_lock);
+    for (uint32_t i = 0; i < LVGL_PORT_MEM_ARENAS_MAX; i++) {
+        if (arenas[i].heap == NULL) {
+            arena = &arenas[i];
+            arena->start = mem;
+            arena->size = size;
+            arena->own = own;
+            arena->heap = heap;
+            arena_cnt++;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&arena_lock);
+    return arena;
+}
+
+static lvgl_port_arena_t *lvgl_port_mem_arena_new(size_t size)
+{
+    void *mem = heap_caps_malloc(size, LVGL_PORT_MEM_ARENA_CAPS);
+    if (mem == NULL) {
+        return NULL;
+    }
+    lvgl_port_arena_t *arena = lvgl_port_mem_arena_add(mem, size, true);
+    if (arena == NULL) {
+        heap_caps_free(mem);
+    }
+    return arena;
+}
+
+static lvgl_port_arena_t *lvgl_port_mem_arena_of(const void *p)
+{
+    for (uint32_t i = 0; i < LVGL_PORT_MEM_ARENAS_MAX; i++) {
+        if (arenas[i].heap && (const uint8_t *)p >= arenas[i].start && (const uint8_t *)p < arenas[i].start + arenas[i].size) {
+            return &arenas[i];
+        }
+    }
+    return NULL;
+}
+
+static void *lvgl_port_mem_alloc(size_t size)
+{
+    for (uint32_t i = 0; i < LVGL_PORT_MEM_ARENAS_MAX; i++) {
+        multi_heap_handle_t heap = arenas[i].heap;
+        void *p = (heap ? multi_heap_malloc(heap, size) : NULL);
+        if (p) {
+            return p;
+        }
+    }
+
+#if CONFIG_LVGL_PORT_MEM_ARENA_EXPAND_KB > 0
+    /* Bigger blocks than the additional arena get their own arena */
+    size_t arena_size = CONFIG_LVGL_PORT_MEM_ARENA_EXPAND_KB * 1024;
+    if (arena_size < size + 1024) {
+        arena_size = size + 1024;
+    }
+    lvgl_port_arena_t *arena = lvgl_port_mem_arena_new(arena_size);
+    if (arena) {
+        ESP_LOGD(TAG, "LVGL memory arena %u kB added", (unsigned)(arena_size / 1024));
+        void *p = multi_heap_malloc(arena->heap, size);
+        if (p) {
+            return p;
+        }
+    }
+#endif
+
+    portENTER_CRITICAL(&arena_lock);
+    fail_cnt++;
+    portEXIT_CRITICAL(&arena_lock);
+    return NULL;
+}
+
+/*******************************************************************************
+* LVGL custom memory functions (LV_USE_CUSTOM_MALLOC)
+*******************************************************************************/
+
+void lv_mem_init(void)
+{
+    fail_cnt = 0;
+    if (lvgl_port_mem_arena_new(CONFIG_LVGL_PORT_MEM_ARENA_SIZE_KB * 1024) == NULL) {
+        ESP_LOGE(TAG, "Not enough memory for LVGL memory arena (%d kB)", CONFIG_LVGL_PORT_MEM_ARENA_SIZE_KB);
+    }
+}
+
+void lv_mem_deinit(void)
+{
+    for (uint32_t i = 0; i < LVGL_PORT_MEM_ARENAS_MAX; i++) {
+        if (arenas[i].heap && arenas[i].own) {
+            heap_caps_free(arenas[i].start);
+        }
+    }
+    memset(arenas, 0, sizeof(arenas));
+    arena_cnt = 0;
+}
+
+lv_mem_pool_t lv_mem_add_pool(void *mem, size_t bytes)
+{
+    return lvgl_port_mem_arena_add(mem, bytes, false);
+}
+
+void lv_mem_remove_pool(lv_mem_pool_t pool)
+{
+    lvgl_port_arena_t *arena = pool;
+    if (arena == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&arena_lock);
+    arena->heap = NULL;
+    arena_cnt--;
+    portEXIT_CRITICAL(&arena_lock);
+}
+
+void *lv_malloc_core(size_t size)
+{
+    return lvgl_port_mem_alloc(size);
+}
+
+void lv_free_core(void *p)
+{
+    lvgl_port_arena_t *arena = lvgl_port_mem_arena_of(p);
+    if (arena) {
+        multi_heap_free(arena->heap, p);
+    }
+}
+
+void *lv_realloc_core(void *p, size_t new_size)
+{
+    lvgl_port_arena_t *arena = lvgl_port_mem_arena_of(p);
+    if (arena == NULL) {
+        return lvgl_port_mem_alloc(new_size);
+    }
+
+    void *new_p = multi_heap_realloc(arena->heap, p, new_size);
+    if (new_p == NULL) {
+        /* No space in the same arena, move the block */
+        new_p = lvgl_port_mem_alloc(new_size);
+        if (new_p) {
+            const size_t old_size = multi_heap_get_allocated_size(arena->heap, p);
+            memcpy(new_p, p, old_size < new_size ? old_size : new_size);
+            multi_heap_free(arena->heap, p);
+        }
+    }
+    return new_p;
+}
+
+void lv_mem_monitor_core(lv_mem_monitor_t *mon_p)
+{
+    lvgl_port_mem_stats_t stats;
+    if (lvgl_port_mem_get_stats(&stats) != ESP_OK) {
+        return;
+    }
+    mon_p->total_size = stats.total_size;
+    mon_p->free_size = stats.free_size;
+    mon_p->free_biggest_size = stats.largest_free;
+    mon_p->free_cnt = stats.free_cnt;
+    mon_p->used_cnt = stats.used_cnt;
+    mon_p->max_used = stats.total_size - stats.min_free_size;
+    mon_p->used_pct = (stats.total_size ? 100 - (uint64_t)stats.free_size * 100 / stats.total_size : 0);
+    mon_p->frag_pct = stats.frag_pct;
+}
+
+lv_result_t lv_mem_test_core(void)
+{
+    for (uint32_t i = 0; i < LVGL_PORT_MEM_ARENAS_MAX; i++) {
+        if (arenas[i].heap && !multi_heap_check(arenas[i].heap, true)) {
+            return LV_RESULT_INVALID;
+        }
+    }
+    return LV_RESULT_OK;
+}
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t lvgl_port_mem_get_stats(lvgl_port_mem_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+    ESP_RETURN_ON_FALSE(arena_cnt > 0, ESP_ERR_INVALID_STATE, TAG, "LVGL memory arena is not initialized");
+
+    memset(stats, 0, sizeof(lvgl_port_mem_stats_t));
+    for (uint32_t i = 0; i < LVGL_PORT_MEM_ARENAS_MAX; i++) {
+        if (arenas[i].heap == NULL) {
+            continue;
+        }
+        multi_heap_info_t info;
+        multi_heap_get_info(arenas[i].heap, &info);
+        stats->arena_cnt++;
+        stats->total_size += arenas[i].size;
+        stats->free_size += info.total_free_bytes;
+        stats->min_free_size += info.minimum_free_bytes;
+        stats->used_cnt += info.allocated_blocks;
+        stats->free_cnt += info.free_blocks;
+        if (info.largest_free_block > stats->largest_free) {
+            stats->largest_free = info.largest_free_block;
+        }
+    }
+    stats->fail_cnt = fail_cnt;
+    /* The same metric as LVGL built-in pool: the largest free block in relation to all free memory */
+    stats->frag_pct = (stats->free_size ? 100 - (uint64_t)stats->largest_free * 100 / stats->free_size : 0);
+    return ESP_OK;
+}
+
+#else // CONFIG_LVGL_PORT_MEM_ARENA
+
+esp_err_t lvgl_port_mem_get_stats(lvgl_port_mem_stats_t *stats)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif // CONFIG_LVGL_PORT_MEM_ARENA
@@ -0,0 +1,341 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/ringbuf.h"
+#include "esp_lvgl_port.h"
+#include "esp_lvgl_port_priv.h"
+
+static const char *TAG = "LVGL";
+
+#define LVGL_PORT_MIRROR_BUFFER_SIZE    (32 * 1024)
+#define LVGL_PORT_MIRROR_TASK_STACK     (4096)
+/* Time of waiting for the captured areas, the stop request is checked meanwhile */
+#define LVGL_PORT_MIRROR_WAIT_MS        (100)
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+struct lvgl_port_mirror_s {
+    lv_display_t                *disp;
+    lvgl_port_mirror_send_cb_t  send_cb;
+    void                        *user_ctx;
+    uint32_t                    max_rate;       /* Bytes per second (0: not limited) */
+    RingbufHandle_t             ring;           /* Captured areas: packet header and raw pixels */
+    StaticRingbuffer_t          ring_struct;
+    uint8_t                     *ring_storage;
+    uint32_t                    ring_caps;      /* Memory capabilities of the ring buffer storage */
+    size_t                      item_max;       /* Maximum size of one captured item */
+    uint16_t                    *runs;          /* RLE encoded payload (mirror task) */
+    TaskHandle_t                task;
+    TaskHandle_t                stop_notify;    /* Task waiting for the end of the mirror task */
+    volatile bool               running;
+    atomic_bool                 resync;         /* An area was dropped, the whole screen will be sent again */
+    bool                        frame_captured; /* An area was captured since the last frame end */
+    int64_t                     next_send;      /* Time when the next packet can be sent (max_rate) [us] */
+    lv_indev_t                  *indev;         /* Remote pointer */
+    atomic_uint                 input;          /* Remote pointer state: pressed (bit 31), y (bits 16-30), x (bits 0-15) */
+};
+
+/*******************************************************************************
+* Function definitions
+*******************************************************************************/
+
+static void lvgl_port_mirror_task(void *arg);
+static void lvgl_port_mirror_refr_ready_callback(lv_event_t *e);
+static void lvgl_port_mirror_read(lv_indev_t *indev, lv_indev_data_t *data);
+static void lvgl_port_mirror_invalidate(void *user_data);
+static void lvgl_port_mirror_free(lvgl_port_mirror_handle_t mirror);
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t lvgl_port_mirror_start(const lvgl_port_mirror_cfg_t *mirror_cfg, lvgl_port_mirror_handle_t *ret_mirror)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(mirror_cfg && mirror_cfg->disp && mirror_cfg->send_cb && ret_mirror, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments!");
+    ESP_RETURN_ON_FALSE(mirror_cfg->task_affinity < (configNUM_CORES), ESP_ERR_INVALID_ARG, TAG, "Bad core number for mirror task! Maximum core number is %d", (configNUM_CORES - 1));
+
+    lvgl_port_mirror_handle_t mirror = calloc(1, sizeof(struct lvgl_port_mirror_s));
+    ESP_RETURN_ON_FALSE(mirror, ESP_ERR_NO_MEM, TAG, "Not enough memory for mirror allocation!");
+    mirror->disp = mirror_cfg->disp;
+    mirror->send_cb = mirror_cfg->send_cb;
+    mirror->user_ctx = mirror_cfg->user_ctx;
+    mirror->max_rate = mirror_cfg->max_rate;
+    atomic_init(&mirror->resync, false);
+    atomic_init(&mirror->input, 0);
+
+    /* An item can take at most a half of no-split ring buffer */
+    const size_t buffer_size = (mirror_cfg->buffer_size ? mirror_cfg->buffer_size : LVGL_PORT_MIRROR_BUFFER_SIZE);
+    const uint32_t caps = (mirror_cfg->flags.buff_spiram ? MALLOC_CAP_SPIRAM : MALLOC_CAP_INTERNAL) | MALLOC_CAP_8BIT;
+    mirror->item_max = buffer_size / 2 - 16;
+    ESP_GOTO_ON_FALSE(mirror->item_max >= sizeof(lvgl_port_mirror_packet_t) + lv_display_get_horizontal_resolution(mirror->disp) * sizeof(uint16_t),
+                      ESP_ERR_INVALID_ARG, err, TAG, "Mirror buffer must hold two lines of the display!");
+    mirror->ring_caps = caps;
+    mirror->ring_storage = heap_caps_malloc(buffer_size, caps);
+    mirror->runs = heap_caps_malloc(mirror->item_max, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    ESP_GOTO_ON_FALSE(mirror->ring_storage && mirror->runs, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for mirror buffers!");
+    LVGL_PORT_MEM_ADD(mirror->ring_storage, caps);
+    mirror->ring = xRingbufferCreateStatic(buffer_size, RINGBUF_TYPE_NOSPLIT, mirror->ring_storage, &mirror->ring_struct);
+    ESP_GOTO_ON_FALSE(mirror->ring, ESP_ERR_NO_MEM, err, TAG, "Create mirror ring buffer fail!");
+
+    mirror->running = true;
+    const int stack = (mirror_cfg->task_stack > 0 ? mirror_cfg->task_stack : LVGL_PORT_MIRROR_TASK_STACK);
+    BaseType_t res;
+    if (mirror_cfg->task_affinity < 0) {
+        res = xTaskCreate(lvgl_port_mirror_task, "LVGL mirror", stack, mirror, mirror_cfg->task_priority, &mirror->task);
+    } else {
+        res = xTaskCreatePinnedToCore(lvgl_port_mirror_task, "LVGL mirror", stack, mirror, mirror_cfg->task_priority, &mirror->task, mirror_cfg->task_affinity);
+    }
+    ESP_GOTO_ON_FALSE(res == pdPASS, ESP_FAIL, err, TAG, "Create mirror task fail!");
+
+    lvgl_port_lock(0);
+    ret = lvgl_port_disp_set_mirror(mirror->disp, mirror);
+    if (ret == ESP_OK) {
+        lv_display_add_event_cb(mirror->disp, lvgl_port_mirror_refr_ready_callback, LV_EVENT_REFR_READY, mirror);
+
+        /* Remote touches, the device reads them as a touch panel */
+        mirror->indev = lv_indev_create();
+        lv_indev_set_type(mirror->indev, LV_INDEV_TYPE_POINTER);
+        lv_indev_set_mode(mirror->indev, LV_INDEV_MODE_EVENT);
+        lv_indev_set_read_cb(mirror->indev, lvgl_port_mirror_read);
+        lv_indev_set_disp(mirror->indev, mirror->disp);
+        lv_indev_set_user_data(mirror->indev, mirror);
+
+        /* The remote viewer starts with the whole screen */
+        lv_obj_invalidate(lv_display_get_screen_active(mirror->disp));
+    }
+    lvgl_port_unlock();
+    ESP_GOTO_ON_ERROR(ret, err, TAG, "Display cannot be mirrored!");
+
+    *ret_mirror = mirror;
+    return ESP_OK;
+
+err:
+    lvgl_port_mirror_free(mirror);
+    return ret;
+}
+
+esp_err_t lvgl_port_mirror_stop(lvgl_port_mirror_handle_t mirror)
+{
+    ESP_RETURN_ON_FALSE(mirror, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments!");
+
+    lvgl_port_lock(0);
+    /* No new area is captured after this */
+    lvgl_port_disp_set_mirror(mirror->disp, NULL);
+    lv_display_remove_event_cb_with_user_data(mirror->disp, lvgl_port_mirror_refr_ready_callback, mirror);
+    if (mirror->indev) {
+        lv_indev_delete(mirror->indev);
+        mirror->indev = NULL;
+    }
+    lvgl_port_unlock();
+
+    lvgl_port_mirror_free(mirror);
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_mirror_input(lvgl_port_mirror_handle_t mirror, int32_t x, int32_t y, bool pressed)
+{
+    ESP_RETURN_ON_FALSE(mirror && mirror->indev, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments!");
+
+    const unsigned int input = (pressed ? (1U << 31) : 0) | ((LV_CLAMP(0, y, 0x7FFF) & 0x7FFF) << 16) | (LV_CLAMP(0, x, 0xFFFF) & 0xFFFF);
+    atomic_store(&mirror->input, input);
+    lvgl_port_task_wake(LVGL_PORT_EVENT_TOUCH, mirror->indev);
+    return ESP_OK;
+}
+
+/*******************************************************************************
+* Private functions
+*******************************************************************************/
+
+void lvgl_port_mirror_capture(lvgl_port_mirror_handle_t mirror, const lv_area_t *area, const uint16_t *px, int32_t stride)
+{
+    if (atomic_load(&mirror->resync)) {
+        /* The whole screen will be sent again */
+        return;
+    }
+
+    /* Large areas are split into bands of rows, each band is one item */
+    const int32_t w = lv_area_get_width(area);
+    const int32_t band_rows = LV_MAX(1, (int32_t)((mirror->item_max - sizeof(lvgl_port_mirror_packet_t)) / (w * sizeof(uint16_t))));
+    for (int32_t y = area->y1; y <= area->y2; y += band_rows) {
+        const int32_t rows = LV_MIN(band_rows, area->y2 - y + 1);
+        const size_t len = w * rows * sizeof(uint16_t);
+        void *item = NULL;
+        if (xRingbufferSendAcquire(mirror->ring, &item, sizeof(lvgl_port_mirror_packet_t) + len, 0) != pdTRUE) {
+            /* The remote link is slower than the UI, LVGL is not slowed down */
+            atomic_store(&mirror->resync, true);
+            return;
+        }
+        lvgl_port_mirror_packet_t *packet = (lvgl_port_mirror_packet_t *)item;
+        packet->magic = LVGL_PORT_MIRROR_MAGIC;
+        packet->type = LVGL_PORT_MIRROR_AREA_RAW;
+        packet->reserved = 0;
+        packet->x1 = area->x1;
+        packet->y1 = y;
+        packet->x2 = area->x2;
+        packet->y2 = y + rows - 1;
+        packet->len = len;
+        uint16_t *dst = (uint16_t *)(packet + 1);
+        for (int32_t row = 0; row < rows; row++) {
+            memcpy(dst + row * w, px + (y - area->y1 + row) * stride, w * sizeof(uint16_t));
+        }
+        xRingbufferSendComplete(mirror->ring, item);
+    }
+    mirror->frame_captured = true;
+}
+
+/*******************************************************************************
+* Local functions
+*******************************************************************************/
+
+/* Runs of all rows together, returns 0 when the runs are not shorter than raw pixels */
+static size_t lvgl_port_mirror_encode(const uint16_t *px, size_t px_cnt, uint16_t *runs)
+{
+    size_t len = 0;
+    size_t i = 0;
+    while (i < px_cnt) {
+        const uint16_t color = px[i];
+        size_t cnt = 1;
+        while (i + cnt < px_cnt && cnt < UINT16_MAX && px[i + cnt] == color) {
+            cnt++;
+        }
+        if (len + 2 >= px_cnt) {
+            return 0;
+        }
+        runs[len++] = (uint16_t)cnt;
+        runs[len++] = color;
+        i += cnt;
+    }
+    return len * sizeof(uint16_t);
+}
+
+static esp_err_t lvgl_port_mirror_send(lvgl_port_mirror_handle_t mirror, lvgl_port_mirror_packet_t *packet, const void *payload)
+{
+    /* Average data rate is limited, the remote link does not take the bandwidth of the application */
+    if (mirror->max_rate) {
+        const int64_t now = esp_timer_get_time();
+        if (mirror->next_send > now) {
+            vTaskDelay(LV_MAX(1, pdMS_TO_TICKS((mirror->next_send - now) / 1000)));
+        }
+        mirror->next_send = LV_MAX(mirror->next_send, now) + (int64_t)(sizeof(*packet) + packet->len) * 1000000 / mirror->max_rate;
+    }
+
+    ESP_RETURN_ON_ERROR(mirror->send_cb(packet, sizeof(*packet), mirror->user_ctx), TAG, "Mirror send failed");
+    if (packet->len) {
+        ESP_RETURN_ON_ERROR(mirror->send_cb(payload, packet->len, mirror->user_ctx), TAG, "Mirror send failed");
+    }
+    return ESP_OK;
+}
+
+static void lvgl_port_mirror_task(void *arg)
+{
+    lvgl_port_mirror_handle_t mirror = (lvgl_port_mirror_handle_t)arg;
+
+    while (mirror->running) {
+        size_t size = 0;
+        lvgl_port_mirror_packet_t *packet = xRingbufferReceive(mirror->ring, &size, pdMS_TO_TICKS(LVGL_PORT_MIRROR_WAIT_MS));
+        if (packet == NULL) {
+            /* All captured areas were sent, the dropped ones are rendered again */
+            if (atomic_load(&mirror->resync) && lvgl_port_async_call(lvgl_port_mirror_invalidate, mirror->disp) == ESP_OK) {
+                atomic_store(&mirror->resync, false);
+            }
+            continue;
+        }
+
+        esp_err_t ret = ESP_OK;
+        if (packet->type == LVGL_PORT_MIRROR_AREA_RAW) {
+            const uint16_t *px = (const uint16_t *)(packet + 1);
+            const size_t rle_len = lvgl_port_mirror_encode(px, packet->len / sizeof(uint16_t), mirror->runs);
+            if (rle_len) {
+                packet->type = LVGL_PORT_MIRROR_AREA_RLE;
+                packet->len = rle_len;
+                ret = lvgl_port_mirror_send(mirror, packet, mirror->runs);
+            } else {
+                ret = lvgl_port_mirror_send(mirror, packet, px);
+            }
+        } else {
+            ret = lvgl_port_mirror_send(mirror, packet, NULL);
+        }
+        vRingbufferReturnItem(mirror->ring, packet);
+
+        if (ret != ESP_OK) {
+            /* The remote viewer lost a part of the screen */
+            atomic_store(&mirror->resync, true);
+        }
+    }
+
+    if (mirror->stop_notify) {
+        xTaskNotifyGive(mirror->stop_notify);
+    }
+    vTaskDelete(NULL);
+}
+
+static void lvgl_port_mirror_refr_ready_callback(lv_event_t *e)
+{
+    lvgl_port_mirror_handle_t mirror = (lvgl_port_mirror_handle_t)lv_event_get_user_data(e);
+    if (!mirror->frame_captured || atomic_load(&mirror->resync)) {
+        return;
+    }
+
+    lvgl_port_mirror_packet_t packet = {
+        .magic = LVGL_PORT_MIRROR_MAGIC,
+        .type = LVGL_PORT_MIRROR_FRAME_END,
+        .x2 = lv_display_get_horizontal_resolution(mirror->disp) - 1,
+        .y2 = lv_display_get_vertical_resolution(mirror->disp) - 1,
+    };
+    if (xRingbufferSend(mirror->ring, &packet, sizeof(packet), 0) == pdTRUE) {
+        mirror->frame_captured = false;
+    }
+}
+
+static void lvgl_port_mirror_read(lv_indev_t *indev, lv_indev_data_t *data)
+{
+    lvgl_port_mirror_handle_t mirror = (lvgl_port_mirror_handle_t)lv_indev_get_user_data(indev);
+    assert(mirror);
+
+    const unsigned int input = atomic_load(&mirror->input);
+    data->point.x = input & 0xFFFF;
+    data->point.y = (input >> 16) & 0x7FFF;
+    data->state = ((input & (1U << 31)) ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED);
+}
+
+/* Called in LVGL task, the mirror can be already stopped */
+static void lvgl_port_mirror_invalidate(void *user_data)
+{
+    lv_display_t *disp = (lv_display_t *)user_data;
+    lv_obj_invalidate(lv_display_get_screen_active(disp));
+}
+
+static void lvgl_port_mirror_free(lvgl_port_mirror_handle_t mirror)
+{
+    if (mirror->task) {
+        /* Stop the mirror task after the current packet */
+        mirror->stop_notify = xTaskGetCurrentTaskHandle();
+        mirror->running = false;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000 + LVGL_PORT_MIRROR_WAIT_MS));
+    }
+    if (mirror->ring) {
+        vRingbufferDelete(mirror->ring);
+    }
+    if (mirror->ring_storage) {
+        LVGL_PORT_MEM_REMOVE(mirror->ring_storage, mirror->ring_caps);
+        free(mirror->ring_storage);
+    }
+    free(mirror->runs);
+    free(mirror);
+}
@@ -0,0 +1,554 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_idf_version.h"
+#include "soc/soc_caps.h"
+#include "esp_lvgl_port.h"
+
+/* Draw unit API with draw task evaluation and image header in draw descriptor is stable from LVGL 9.2 */
+#if SOC_PPA_SUPPORTED && (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)) && (LVGL_VERSION_MAJOR > 9 || LVGL_VERSION_MINOR >= 2)
+#include "esp_heap_caps.h"
+#include "esp_cache.h"
+#include "esp_memory_utils.h"
+#include "driver/ppa.h"
+#if __has_include("lvgl_private.h")
+#include "lvgl_private.h"
+#endif
+#define LVGL_PORT_PPA_DRAW_SUPPORTED 1
+#else
+#define LVGL_PORT_PPA_DRAW_SUPPORTED 0
+#endif
+
+static const char *TAG = "LVGL";
+
+#if LVGL_PORT_PPA_DRAW_SUPPORTED
+
+/* ID of the draw unit, LVGL built-in draw units use low numbers */
+#define LVGL_PORT_PPA_DRAW_UNIT_ID      (30)
+/* Preference score of supported tasks, lower than SW draw unit (100) */
+#define LVGL_PORT_PPA_DRAW_SCORE        (70)
+#define LVGL_PORT_PPA_DRAW_MIN_AREA     (1600)
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+typedef struct {
+    lv_draw_unit_t      base;           /* LVGL draw unit (must be first) */
+    ppa_client_handle_t fill;           /* PPA client for rectangle fills */
+    ppa_client_handle_t blend;          /* PPA client for blending with alpha or opacity */
+    ppa_client_handle_t srm;            /* PPA client for copying and scaling of opaque images */
+    size_t              align_spiram;   /* Cache line size of PSRAM */
+    size_t              align_internal; /* Cache line size of internal RAM */
+    uint32_t            min_area;
+    lvgl_port_ppa_draw_stats_t stats;
+} lvgl_port_ppa_draw_unit_t;
+
+/* Output picture of PPA in layer buffer, only the rows of the drawn area when the stride is aligned to cache line */
+typedef struct {
+    void        *buffer;
+    uint32_t    buffer_size;
+    uint32_t    pic_w;
+    uint32_t    pic_h;
+    uint32_t    offset_x;
+    uint32_t    offset_y;
+} lvgl_port_ppa_draw_out_t;
+
+/*******************************************************************************
+* Function definitions
+*******************************************************************************/
+static int32_t lvgl_port_ppa_draw_evaluate(lv_draw_unit_t *draw_unit, lv_draw_task_t *task);
+static int32_t lvgl_port_ppa_draw_dispatch(lv_draw_unit_t *draw_unit, lv_layer_t *layer);
+static int32_t lvgl_port_ppa_draw_delete(lv_draw_unit_t *draw_unit);
+static bool lvgl_port_ppa_draw_task_supported(const lvgl_port_ppa_draw_unit_t *unit, const lv_draw_task_t *task);
+static bool lvgl_port_ppa_draw_execute(lvgl_port_ppa_draw_unit_t *unit, lv_draw_task_t *task);
+static bool lvgl_port_ppa_draw_fill(lvgl_port_ppa_draw_unit_t *unit, lv_draw_task_t *task);
+static bool lvgl_port_ppa_draw_image(lvgl_port_ppa_draw_unit_t *unit, lv_draw_task_t *task, const lv_draw_buf_t *src);
+static bool lvgl_port_ppa_draw_get_out(const lvgl_port_ppa_draw_unit_t *unit, const lv_layer_t *layer, const lv_area_t *area, lvgl_port_ppa_draw_out_t *out);
+static bool lvgl_port_ppa_draw_layer_busy(const lv_layer_t *layer);
+
+/*******************************************************************************
+* Local variables
+*******************************************************************************/
+
+static lvgl_port_ppa_draw_unit_t *ppa_unit;
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t lvgl_port_ppa_draw_init(const lvgl_port_ppa_draw_cfg_t *ppa_cfg)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(ppa_unit == NULL, ESP_ERR_INVALID_STATE, TAG, "PPA draw unit is already added");
+
+    /* Allocated by LVGL, it is freed in lv_deinit after delete_cb */
+    lvgl_port_ppa_draw_unit_t *unit = lv_draw_create_unit(sizeof(lvgl_port_ppa_draw_unit_t));
+    ESP_RETURN_ON_FALSE(unit, ESP_ERR_NO_MEM, TAG, "Not enough memory for PPA draw unit");
+    unit->base.evaluate_cb = lvgl_port_ppa_draw_evaluate;
+    unit->base.dispatch_cb = lvgl_port_ppa_draw_dispatch;
+    unit->base.delete_cb = lvgl_port_ppa_draw_delete;
+    unit->min_area = (ppa_cfg && ppa_cfg->min_area) ? ppa_cfg->min_area : LVGL_PORT_PPA_DRAW_MIN_AREA;
+    if (esp_cache_get_alignment(MALLOC_CAP_SPIRAM, &unit->align_spiram) != ESP_OK) {
+        unit->align_spiram = 0;
+    }
+    if (esp_cache_get_alignment(MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA, &unit->align_internal) != ESP_OK) {
+        unit->align_internal = 0;
+    }
+    if (LV_DRAW_BUF_ALIGN < unit->align_spiram) {
+        ESP_LOGW(TAG, "LV_DRAW_BUF_ALIGN (%d) is smaller than cache line (%u), layers will be drawn by CPU", LV_DRAW_BUF_ALIGN, (unsigned)unit->align_spiram);
+    }
+
+    /* Without PPA clients, the unit does not take any tasks */
+    ppa_client_config_t client_cfg = {
+        .oper_type = PPA_OPERATION_FILL,
+        .max_pending_trans_num = 1,
+    };
+    ESP_GOTO_ON_ERROR(ppa_register_client(&client_cfg, &unit->fill), err, TAG, "PPA fill client register failed");
+    client_cfg.oper_type = PPA_OPERATION_BLEND;
+    ESP_GOTO_ON_ERROR(ppa_register_client(&client_cfg, &unit->blend), err, TAG, "PPA blend client register failed");
+    client_cfg.oper_type = PPA_OPERATION_SRM;
+    ESP_GOTO_ON_ERROR(ppa_register_client(&client_cfg, &unit->srm), err, TAG, "PPA SRM client register failed");
+
+    ppa_unit = unit;
+    return ESP_OK;
+
+err:
+    lvgl_port_ppa_draw_delete(&unit->base);
+    return ret;
+}
+
+esp_err_t lvgl_port_ppa_draw_get_stats(lvgl_port_ppa_draw_stats_t *stats, bool reset)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+    ESP_RETURN_ON_FALSE(ppa_unit, ESP_ERR_INVALID_STATE, TAG, "PPA draw unit is not added");
+
+    *stats = ppa_unit->stats;
+    const uint32_t ppa_cnt = stats->fill_cnt + stats->blend_cnt + stats->scale_cnt;
+    stats->offload_pct = (stats->task_cnt ? (uint64_t)ppa_cnt * 100 / stats->task_cnt : 0);
+    stats->offload_px_pct = (stats->task_px ? stats->ppa_px * 100 / stats->task_px : 0);
+    if (reset) {
+        memset(&ppa_unit->stats, 0, sizeof(lvgl_port_ppa_draw_stats_t));
+    }
+    return ESP_OK;
+}
+
+/*******************************************************************************
+* Private functions
+*******************************************************************************/
+
+static int32_t lvgl_port_ppa_draw_evaluate(lv_draw_unit_t *draw_unit, lv_draw_task_t *task)
+{
+    lvgl_port_ppa_draw_unit_t *unit = (lvgl_port_ppa_draw_unit_t *)draw_unit;
+    lv_area_t area;
+
+    unit->stats.task_cnt++;
+    if (lv_area_intersect(&area, &task->area, &task->clip_area)) {
+        unit->stats.task_px += lv_area_get_size(&area);
+    }
+
+    if (unit->srm && lvgl_port_ppa_draw_task_supported(unit, task) && task->preference_score > LVGL_PORT_PPA_DRAW_SCORE) {
+        task->preference_score = LVGL_PORT_PPA_DRAW_SCORE;
+        task->preferred_draw_unit_id = LVGL_PORT_PPA_DRAW_UNIT_ID;
+    }
+    return 0;
+}
+
+static int32_t lvgl_port_ppa_draw_dispatch(lv_draw_unit_t *draw_unit, lv_layer_t *layer)
+{
+    lvgl_port_ppa_draw_unit_t *unit = (lvgl_port_ppa_draw_unit_t *)draw_unit;
+
+    lv_draw_task_t *task = lv_draw_get_next_available_task(layer, NULL, LVGL_PORT_PPA_DRAW_UNIT_ID);
+    if (task == NULL) {
+        return LV_DRAW_UNIT_IDLE;
+    }
+
+    /* CPU draw units could write into the same cache lines of the layer, PPA waits until they finish */
+    if (lvgl_port_ppa_draw_layer_busy(layer)) {
+        return 0;
+    }
+
+    if (lv_draw_layer_alloc_buf(layer) == NULL) {
+        return LV_DRAW_UNIT_IDLE;
+    }
+
+    task->state = LV_DRAW_TASK_STATE_IN_PROGRESS;
+    draw_unit->target_layer = layer;
+    draw_unit->clip_area = &task->clip_area;
+
+    /* PPA transaction is blocking, the CPU draw units in other threads continue with other layers */
+    if (!lvgl_port_ppa_draw_execute(unit, task)) {
+        unit->stats.fallback_cnt++;
+        switch (task->type) {
+        case LV_DRAW_TASK_TYPE_FILL:
+            lv_draw_sw_fill(draw_unit, task->draw_dsc, &task->area);
+            break;
+        case LV_DRAW_TASK_TYPE_IMAGE:
+            lv_draw_sw_image(draw_unit, task->draw_dsc, &task->area);
+            break;
+        case LV_DRAW_TASK_TYPE_LAYER:
+            lv_draw_sw_layer(draw_unit, task->draw_dsc, &task->area);
+            break;
+        default:
+            break;
+        }
+    }
+
+    task->state = LV_DRAW_TASK_STATE_READY;
+    draw_unit->target_layer = NULL;
+    draw_unit->clip_area = NULL;
+    lv_draw_dispatch_request();
+    return 1;
+}
+
+static int32_t lvgl_port_ppa_draw_delete(lv_draw_unit_t *draw_unit)
+{
+    lvgl_port_ppa_draw_unit_t *unit = (lvgl_port_ppa_draw_unit_t *)draw_unit;
+
+    if (unit->fill) {
+        ppa_unregister_client(unit->fill);
+        unit->fill = NULL;
+    }
+    if (unit->blend) {
+        ppa_unregister_client(unit->blend);
+        unit->blend = NULL;
+    }
+    if (unit->srm) {
+        ppa_unregister_client(unit->srm);
+        unit->srm = NULL;
+    }
+    if (ppa_unit == unit) {
+        ppa_unit = NULL;
+    }
+    return 0;
+}
+
+static bool lvgl_port_ppa_draw_layer_busy(const lv_layer_t *layer)
+{
+    for (const lv_draw_task_t *t = layer->draw_task_head; t; t = t->next) {
+        if (t->state == LV_DRAW_TASK_STATE_IN_PROGRESS) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool lvgl_port_ppa_draw_color_format(lv_color_format_t cf, bool *has_alpha)
+{
+    switch (cf) {
+    case LV_COLOR_FORMAT_RGB565:
+    case LV_COLOR_FORMAT_RGB888:
+    case LV_COLOR_FORMAT_XRGB8888:
+        *has_alpha = false;
+        return true;
+    case LV_COLOR_FORMAT_ARGB8888:
+        *has_alpha = true;
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool lvgl_port_ppa_draw_task_supported(const lvgl_port_ppa_draw_unit_t *unit, const lv_draw_task_t *task)
+{
+    lv_area_t area;
+    if (!lv_area_intersect(&area, &task->area, &task->clip_area) || lv_area_get_size(&area) < unit->min_area) {
+        return false;
+    }
+
+    if (task->type == LV_DRAW_TASK_TYPE_FILL) {
+        /* PPA fill writes the color, it does not blend */
+        const lv_draw_fill_dsc_t *dsc = task->draw_dsc;
+        return dsc->radius == 0 && dsc->opa >= LV_OPA_MAX && dsc->grad.dir == LV_GRAD_DIR_NONE;
+    }
+
+    if (task->type != LV_DRAW_TASK_TYPE_IMAGE && task->type != LV_DRAW_TASK_TYPE_LAYER) {
+        return false;
+    }
+
+    const lv_draw_image_dsc_t *dsc = task->draw_dsc;
+    if (dsc->rotation != 0 || dsc->skew_x != 0 || dsc->skew_y != 0 || dsc->tile || dsc->recolor_opa > LV_OPA_MIN ||
+            dsc->blend_mode != LV_BLEND_MODE_NORMAL || dsc->bitmap_mask_src != NULL || dsc->clip_radius != 0) {
+        return false;
+    }
+
+    lv_color_format_t cf;
+    if (task->type == LV_DRAW_TASK_TYPE_LAYER) {
+        const lv_layer_t *layer_to_draw = dsc->src;
+        cf = layer_to_draw->color_format;
+    } else {
+        if (dsc->header.flags & LV_IMAGE_FLAGS_COMPRESSED) {
+            return false;
+        }
+        /* PPA (DMA) cannot read images in flash, images from files are decoded into RAM */
+        if (lv_image_src_get_type(dsc->src) == LV_IMAGE_SRC_VARIABLE) {
+            const lv_image_dsc_t *img = dsc->src;
+            if (!esp_ptr_dma_ext_capable(img->data) && !esp_ptr_dma_capable(img->data)) {
+                return false;
+            }
+        }
+        cf = dsc->header.cf;
+    }
+
+    bool has_alpha;
+    if (!lvgl_port_ppa_draw_color_format(cf, &has_alpha)) {
+        return false;
+    }
+    if (dsc->scale_x == LV_SCALE_NONE && dsc->scale_y == LV_SCALE_NONE) {
+        return true;
+    }
+    /* SRM scales with 1/16 precision and does not blend */
+    return !has_alpha && dsc->opa >= LV_OPA_MAX && (dsc->scale_x % 16) == 0 && (dsc->scale_y % 16) == 0;
+}
+
+static bool lvgl_port_ppa_draw_execute(lvgl_port_ppa_draw_unit_t *unit, lv_draw_task_t *task)
+{
+    if (task->type == LV_DRAW_TASK_TYPE_FILL) {
+        return lvgl_port_ppa_draw_fill(unit, task);
+    }
+
+    const lv_draw_image_dsc_t *dsc = task->draw_dsc;
+    if (task->type == LV_DRAW_TASK_TYPE_LAYER) {
+        const lv_layer_t *layer_to_draw = dsc->src;
+        return layer_to_draw->draw_buf && lvgl_port_ppa_draw_image(unit, task, layer_to_draw->draw_buf);
+    }
+
+    lv_image_decoder_dsc_t decoder_dsc;
+    if (lv_image_decoder_open(&decoder_dsc, dsc->src, NULL) != LV_RESULT_OK) {
+        return false;
+    }
+    /* Only fully decoded images, not decoded line by line */
+    const bool ret = decoder_dsc.decoded && lvgl_port_ppa_draw_image(unit, task, decoder_dsc.decoded);
+    lv_image_decoder_close(&decoder_dsc);
+    return ret;
+}
+
+static bool lvgl_port_ppa_draw_get_out(const lvgl_port_ppa_draw_unit_t *unit, const lv_layer_t *layer, const lv_area_t *area, lvgl_port_ppa_draw_out_t *out)
+{
+    const lv_draw_buf_t *buf = layer->draw_buf;
+    const uint32_t px_size = lv_color_format_get_size(buf->header.cf);
+    const uint32_t stride = buf->header.stride;
+    if (px_size == 0 || (stride % px_size) != 0) {
+        return false;
+    }
+
+    /* PPA invalidates the output picture in cache, it must be aligned to cache lines */
+    const size_t align = esp_ptr_external_ram(buf->data) ? unit->align_spiram : unit->align_internal;
+    const uint32_t y = area->y1 - layer->buf_area.y1;
+    out->pic_w = stride / px_size;
+    out->offset_x = area->x1 - layer->buf_area.x1;
+    if (align > 1 && (stride % align) == 0) {
+        out->buffer = buf->data + y * stride;
+        out->pic_h = lv_area_get_height(area);
+        out->offset_y = 0;
+    } else {
+        out->buffer = buf->data;
+        out->pic_h = buf->header.h;
+        out->offset_y = y;
+    }
+    out->buffer_size = out->pic_h * stride;
+    return align <= 1 || (((uintptr_t)out->buffer % align) == 0 && (out->buffer_size % align) == 0);
+}
+
+static bool lvgl_port_ppa_draw_fill(lvgl_port_ppa_draw_unit_t *unit, lv_draw_task_t *task)
+{
+    const lv_draw_fill_dsc_t *dsc = task->draw_dsc;
+    const lv_layer_t *layer = unit->base.target_layer;
+    lvgl_port_ppa_draw_out_t out;
+    ppa_fill_color_mode_t cm;
+    lv_area_t area;
+
+    switch (layer->color_format) {
+    case LV_COLOR_FORMAT_RGB565:
+        cm = PPA_FILL_COLOR_MODE_RGB565;
+        break;
+    case LV_COLOR_FORMAT_RGB888:
+        cm = PPA_FILL_COLOR_MODE_RGB888;
+        break;
+    case LV_COLOR_FORMAT_XRGB8888:
+    case LV_COLOR_FORMAT_ARGB8888:
+        cm = PPA_FILL_COLOR_MODE_ARGB8888;
+        break;
+    default:
+        return false;
+    }
+
+    if (!lv_area_intersect(&area, &task->area, &task->clip_area) || !lv_area_intersect(&area, &area, &layer->buf_area)) {
+        return true;
+    }
+    if (!lvgl_port_ppa_draw_get_out(unit, layer, &area, &out)) {
+        return false;
+    }
+
+    const ppa_fill_oper_config_t fill_cfg = {
+        .out = {
+            .buffer = out.buffer,
+            .buffer_size = out.buffer_size,
+            .pic_w = out.pic_w,
+            .pic_h = out.pic_h,
+            .block_offset_x = out.offset_x,
+            .block_offset_y = out.offset_y,
+            .fill_cm = cm,
+        },
+        .fill_block_w = lv_area_get_width(&area),
+        .fill_block_h = lv_area_get_height(&area),
+        .fill_argb_color = {
+            .val = lv_color_to_u32(dsc->color),
+        },
+        .mode = PPA_TRANS_MODE_BLOCKING,
+    };
+    if (ppa_do_fill(unit->fill, &fill_cfg) != ESP_OK) {
+        return false;
+    }
+
+    unit->stats.fill_cnt++;
+    unit->stats.ppa_px += lv_area_get_size(&area);
+    return true;
+}
+
+static bool lvgl_port_ppa_draw_image(lvgl_port_ppa_draw_unit_t *unit, lv_draw_task_t *task, const lv_draw_buf_t *src)
+{
+    const lv_draw_image_dsc_t *dsc = task->draw_dsc;
+    const lv_layer_t *layer = unit->base.target_layer;
+    const int32_t src_w = src->header.w;
+    const int32_t src_h = src->header.h;
+    const uint32_t src_px_size = lv_color_format_get_size(src->header.cf);
+    bool src_alpha;
+    bool dst_alpha;
+    lvgl_port_ppa_draw_out_t out;
+    lv_area_t area;
+
+    /* Decoded image can have another format than in the header (e.g. with alpha) */
+    if (!lvgl_port_ppa_draw_color_format(src->header.cf, &src_alpha) || !lvgl_port_ppa_draw_color_format(layer->color_format, &dst_alpha) ||
+            (src->header.stride % src_px_size) != 0 || lv_area_get_width(&task->area) != src_w || lv_area_get_height(&task->area) != src_h) {
+        return false;
+    }
+
+    const bool scaled = (dsc->scale_x != LV_SCALE_NONE || dsc->scale_y != LV_SCALE_NONE);
+    if (scaled) {
+        /* Scaled area must be exactly the PPA output, clipped images are drawn by CPU */
+        lv_image_buf_get_transformed_area(&area, src_w, src_h, 0, dsc->scale_x, dsc->scale_y, &dsc->pivot);
+        lv_area_move(&area, task->area.x1, task->area.y1);
+        if ((src_w * dsc->scale_x) % LV_SCALE_NONE != 0 || (src_h * dsc->scale_y) % LV_SCALE_NONE != 0 ||
+                lv_area_get_width(&area) != src_w * dsc->scale_x / LV_SCALE_NONE || lv_area_get_height(&area) != src_h * dsc->scale_y / LV_SCALE_NONE ||
+                !lv_area_is_in(&area, &task->clip_area, 0) || !lv_area_is_in(&area, &layer->buf_area, 0)) {
+            return false;
+        }
+    } else if (!lv_area_intersect(&area, &task->area, &task->clip_area) || !lv_area_intersect(&area, &area, &layer->buf_area)) {
+        return true;
+    }
+    if (!lvgl_port_ppa_draw_get_out(unit, layer, &area, &out)) {
+        return false;
+    }
+
+    const ppa_in_pic_blk_config_t in_src = {
+        .buffer = src->data,
+        .pic_w = src->header.stride / src_px_size,
+        .pic_h = src_h,
+        .block_w = scaled ? src_w : lv_area_get_width(&area),
+        .block_h = scaled ? src_h : lv_area_get_height(&area),
+        .block_offset_x = scaled ? 0 : area.x1 - task->area.x1,
+        .block_offset_y = scaled ? 0 : area.y1 - task->area.y1,
+    };
+
+    if (!src_alpha && dsc->opa >= LV_OPA_MAX) {
+        /* Opaque image is only copied (and scaled, converted), the layer is not read */
+        ppa_srm_oper_config_t srm_cfg = {
+            .in = in_src,
+            .out = {
+                .buffer = out.buffer,
+                .buffer_size = out.buffer_size,
+                .pic_w = out.pic_w,
+                .pic_h = out.pic_h,
+                .block_offset_x = out.offset_x,
+                .block_offset_y = out.offset_y,
+            },
+            .rotation_angle = PPA_SRM_ROTATION_ANGLE_0,
+            .scale_x = (float)dsc->scale_x / LV_SCALE_NONE,
+            .scale_y = (float)dsc->scale_y / LV_SCALE_NONE,
+            .alpha_update_mode = PPA_ALPHA_FIX_VALUE,
+            .alpha_fix_val = 0xFF,
+            .mode = PPA_TRANS_MODE_BLOCKING,
+        };
+        srm_cfg.in.srm_cm = (src->header.cf == LV_COLOR_FORMAT_RGB565 ? PPA_SRM_COLOR_MODE_RGB565 :
+                             src->header.cf == LV_COLOR_FORMAT_RGB888 ? PPA_SRM_COLOR_MODE_RGB888 : PPA_SRM_COLOR_MODE_ARGB8888);
+        srm_cfg.out.srm_cm = (layer->color_format == LV_COLOR_FORMAT_RGB565 ? PPA_SRM_COLOR_MODE_RGB565 :
+                              layer->color_format == LV_COLOR_FORMAT_RGB888 ? PPA_SRM_COLOR_MODE_RGB888 : PPA_SRM_COLOR_MODE_ARGB8888);
+        if (ppa_do_scale_rotate_mirror(unit->srm, &srm_cfg) != ESP_OK) {
+            return false;
+        }
+        unit->stats.scale_cnt++;
+    } else {
+        /* Foreground is the image, background and output is the layer (Porter-Duff source over) */
+        const ppa_blend_color_mode_t src_cm = (src->header.cf == LV_COLOR_FORMAT_RGB565 ? PPA_BLEND_COLOR_MODE_RGB565 :
+                                               src->header.cf == LV_COLOR_FORMAT_RGB888 ? PPA_BLEND_COLOR_MODE_RGB888 : PPA_BLEND_COLOR_MODE_ARGB8888);
+        const ppa_blend_color_mode_t dst_cm = (layer->color_format == LV_COLOR_FORMAT_RGB565 ? PPA_BLEND_COLOR_MODE_RGB565 :
+                                               layer->color_format == LV_COLOR_FORMAT_RGB888 ? PPA_BLEND_COLOR_MODE_RGB888 : PPA_BLEND_COLOR_MODE_ARGB8888);
+        const uint32_t dst_px_size = lv_color_format_get_size(layer->color_format);
+        ppa_blend_oper_config_t blend_cfg = {
+            .in_bg = {
+                .buffer = layer->draw_buf->data,
+                .pic_w = layer->draw_buf->header.stride / dst_px_size,
+                .pic_h = layer->draw_buf->header.h,
+                .block_w = lv_area_get_width(&area),
+                .block_h = lv_area_get_height(&area),
+                .block_offset_x = area.x1 - layer->buf_area.x1,
+                .block_offset_y = area.y1 - layer->buf_area.y1,
+                .blend_cm = dst_cm,
+            },
+            .in_fg = in_src,
+            .out = {
+                .buffer = out.buffer,
+                .buffer_size = out.buffer_size,
+                .pic_w = out.pic_w,
+                .pic_h = out.pic_h,
+                .block_offset_x = out.offset_x,
+                .block_offset_y = out.offset_y,
+                .blend_cm = dst_cm,
+            },
+            .bg_alpha_update_mode = (dst_alpha ? PPA_ALPHA_NO_CHANGE : PPA_ALPHA_FIX_VALUE),
+            .bg_alpha_fix_val = 0xFF,
+            .mode = PPA_TRANS_MODE_BLOCKING,
+        };
+        blend_cfg.in_fg.blend_cm = src_cm;
+        if (!src_alpha) {
+            /* XRGB8888 alpha byte is not valid, RGB565 and RGB888 have no alpha */
+            blend_cfg.fg_alpha_update_mode = PPA_ALPHA_FIX_VALUE;
+            blend_cfg.fg_alpha_fix_val = dsc->opa;
+        } else if (dsc->opa < LV_OPA_MAX) {
+            blend_cfg.fg_alpha_update_mode = PPA_ALPHA_SCALE;
+            blend_cfg.fg_alpha_scale_ratio = (float)dsc->opa / LV_OPA_COVER;
+        } else {
+            blend_cfg.fg_alpha_update_mode = PPA_ALPHA_NO_CHANGE;
+        }
+        if (ppa_do_blend(unit->blend, &blend_cfg) != ESP_OK) {
+            return false;
+        }
+        unit->stats.blend_cnt++;
+    }
+
+    unit->stats.ppa_px += lv_area_get_size(&area);
+    return true;
+}
+
+#else
+
+esp_err_t lvgl_port_ppa_draw_init(const lvgl_port_ppa_draw_cfg_t *ppa_cfg)
+{
+    ESP_LOGE(TAG, "PPA draw unit is not supported on this chip or LVGL version!");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t lvgl_port_ppa_draw_get_stats(lvgl_port_ppa_draw_stats_t *stats, bool reset)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif
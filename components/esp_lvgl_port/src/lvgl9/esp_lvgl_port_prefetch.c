@@ -0,0 +1,161 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "esp_lvgl_port.h"
+#include "esp_lvgl_port_priv.h"
+
+static const char *TAG = "LVGL";
+
+/* Decoded images are kept in the image cache from LVGL 9.1 */
+#define LVGL_PORT_PREFETCH_SUPPORTED    (LVGL_VERSION_MAJOR > 9 || LVGL_VERSION_MINOR >= 1)
+
+/* Default minimal idle time of the LVGL task for decoding [ms] */
+#define LVGL_PORT_PREFETCH_IDLE_MS      (10)
+/* Maximum time of decoding in one idle period [ms], input events wait for it */
+#define LVGL_PORT_PREFETCH_SLICE_MS     (20)
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+typedef struct {
+    lvgl_port_prefetch_cfg_t cfg;       /* Current prefetch (sources are owned by the application) */
+    uint32_t            next;           /* Index of the next source */
+    int64_t             time_us;        /* Time spent by decoding */
+    lvgl_port_prefetch_stats_t stats;
+} lvgl_port_prefetch_ctx_t;
+
+/*******************************************************************************
+* Local variables
+*******************************************************************************/
+static lvgl_port_prefetch_ctx_t lvgl_port_prefetch_ctx;
+
+/*******************************************************************************
+* Function definitions
+*******************************************************************************/
+#if LVGL_PORT_PREFETCH_SUPPORTED
+static void lvgl_port_prefetch_image(const void *src);
+#endif
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t lvgl_port_prefetch_start(const lvgl_port_prefetch_cfg_t *cfg)
+{
+#if LVGL_PORT_PREFETCH_SUPPORTED
+    ESP_RETURN_ON_FALSE(cfg && (cfg->srcs || cfg->count == 0), ESP_ERR_INVALID_ARG, TAG, "Invalid arguments!");
+
+    lvgl_port_lock(0);
+    memset(&lvgl_port_prefetch_ctx, 0, sizeof(lvgl_port_prefetch_ctx));
+    lvgl_port_prefetch_ctx.cfg = *cfg;
+    if (lvgl_port_prefetch_ctx.cfg.min_idle_ms == 0) {
+        lvgl_port_prefetch_ctx.cfg.min_idle_ms = LVGL_PORT_PREFETCH_IDLE_MS;
+    }
+    lvgl_port_unlock();
+
+    /* The LVGL task may sleep without any timer, the prefetch starts in the next idle period */
+    lvgl_port_task_wake(LVGL_PORT_EVENT_USER, NULL);
+    return ESP_OK;
+#else
+    ESP_LOGE(TAG, "Image prefetch needs LVGL 9.1 or newer!");
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t lvgl_port_prefetch_cancel(void)
+{
+    lvgl_port_lock(0);
+    lvgl_port_prefetch_ctx.cfg.count = 0;
+    lvgl_port_prefetch_ctx.next = 0;
+    lvgl_port_unlock();
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_prefetch_get_stats(lvgl_port_prefetch_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments!");
+
+    lvgl_port_lock(0);
+    *stats = lvgl_port_prefetch_ctx.stats;
+    stats->pending_cnt = lvgl_port_prefetch_ctx.cfg.count - lvgl_port_prefetch_ctx.next;
+    stats->time_ms = (uint32_t)(lvgl_port_prefetch_ctx.time_us / 1000);
+    lvgl_port_unlock();
+    return ESP_OK;
+}
+
+/*******************************************************************************
+* Private functions
+*******************************************************************************/
+
+uint32_t lvgl_port_prefetch_run(uint32_t idle_ms)
+{
+#if LVGL_PORT_PREFETCH_SUPPORTED
+    lvgl_port_prefetch_ctx_t *ctx = &lvgl_port_prefetch_ctx;
+    if (ctx->next >= ctx->cfg.count || idle_ms < ctx->cfg.min_idle_ms) {
+        return 0;
+    }
+
+    /* At least one image in each idle period, so an image longer than the slice cannot block the prefetch */
+    const int64_t start = esp_timer_get_time();
+    const int64_t slice_us = (int64_t)LV_MIN(idle_ms / 2, LVGL_PORT_PREFETCH_SLICE_MS) * 1000;
+    int64_t spent = 0;
+    do {
+        lvgl_port_prefetch_image(ctx->cfg.srcs[ctx->next]);
+        ctx->next++;
+        spent = esp_timer_get_time() - start;
+    } while (ctx->next < ctx->cfg.count && spent < slice_us);
+    ctx->time_us += spent;
+
+    if (ctx->next >= ctx->cfg.count) {
+        ESP_LOGD(TAG, "Prefetch done: %"PRIu32" images (%"PRIu32" bytes) cached, %"PRIu32" skipped, %"PRIu32" failed, %"PRIu32" ms",
+                 ctx->stats.cached_cnt, ctx->stats.cached_size, ctx->stats.skip_cnt, ctx->stats.fail_cnt, (uint32_t)(ctx->time_us / 1000));
+    }
+    return (uint32_t)((spent + 999) / 1000);
+#else
+    return 0;
+#endif
+}
+
+#if LVGL_PORT_PREFETCH_SUPPORTED
+static void lvgl_port_prefetch_image(const void *src)
+{
+    lvgl_port_prefetch_ctx_t *ctx = &lvgl_port_prefetch_ctx;
+    lv_image_header_t header;
+    if (src == NULL || lv_image_decoder_get_info(src, &header) != LV_RESULT_OK) {
+        ctx->stats.fail_cnt++;
+        return;
+    }
+
+    /* Size of the decoded image is known from the header, images over the budget are not decoded at all */
+    const uint32_t size = lv_draw_buf_width_to_stride(header.w, header.cf) * header.h;
+    if (ctx->cfg.budget && ctx->stats.cached_size + size > ctx->cfg.budget) {
+        ctx->stats.skip_cnt++;
+        return;
+    }
+
+    lv_image_decoder_dsc_t dsc;
+    if (lv_image_decoder_open(&dsc, src, NULL) != LV_RESULT_OK) {
+        ctx->stats.fail_cnt++;
+        return;
+    }
+    /* Images without cache entry are drawn directly from their source (e.g. uncompressed C arrays) */
+    if (dsc.cache_entry) {
+        ctx->stats.cached_cnt++;
+        ctx->stats.cached_size += (dsc.decoded ? dsc.decoded->data_size : size);
+    } else {
+        ctx->stats.direct_cnt++;
+    }
+    /* The cache entry is released, the decoded image stays in the cache until it is evicted */
+    lv_image_decoder_close(&dsc);
+}
+#endif
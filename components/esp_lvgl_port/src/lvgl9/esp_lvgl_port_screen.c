@@ -0,0 +1,137 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "esp_lvgl_port.h"
+
+static const char *TAG = "LVGL";
+
+/* Default time for building steps in one refresh period [ms] */
+#define LVGL_PORT_SCREEN_BUDGET_MS  (5)
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+struct lvgl_port_screen_build_s {
+    lvgl_port_screen_build_cfg_t cfg;   /* Configuration (steps are owned by the application) */
+    lv_obj_t            *scr;           /* New screen */
+    lv_timer_t          *timer;         /* Timer of the building slices, one slice in each refresh period */
+    uint32_t            next;           /* Index of the next step */
+    uint32_t            slices;         /* Number of slices used for building */
+    int64_t             start;          /* Time of the building start [us] */
+};
+
+/*******************************************************************************
+* Function definitions
+*******************************************************************************/
+
+static void lvgl_port_screen_build_slice(lv_timer_t *timer);
+static void lvgl_port_screen_build_free(lvgl_port_screen_build_handle_t build, bool del_scr);
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t lvgl_port_screen_build(const lvgl_port_screen_build_cfg_t *cfg, lvgl_port_screen_build_handle_t *ret_handle)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(cfg && (cfg->steps || cfg->step_count == 0), ESP_ERR_INVALID_ARG, TAG, "Invalid arguments!");
+
+    lvgl_port_screen_build_handle_t build = calloc(1, sizeof(struct lvgl_port_screen_build_s));
+    ESP_RETURN_ON_FALSE(build, ESP_ERR_NO_MEM, TAG, "Not enough memory for screen building!");
+    build->cfg = *cfg;
+    if (build->cfg.budget_ms == 0) {
+        build->cfg.budget_ms = LVGL_PORT_SCREEN_BUDGET_MS;
+    }
+
+    lvgl_port_lock(0);
+    lv_display_t *disp = (cfg->disp ? cfg->disp : lv_display_get_default());
+    ESP_GOTO_ON_FALSE(disp, ESP_ERR_INVALID_ARG, err, TAG, "No display for the screen!");
+
+    /* Screens are created on the default display */
+    lv_display_t *def_disp = lv_display_get_default();
+    lv_display_set_default(disp);
+    build->scr = lv_obj_create(NULL);
+    lv_display_set_default(def_disp);
+    ESP_GOTO_ON_FALSE(build->scr, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for the screen!");
+
+    /* One slice in each refresh period, the slice runs between the refreshes of the current screen */
+    build->timer = lv_timer_create(lvgl_port_screen_build_slice, LV_DEF_REFR_PERIOD, build);
+    ESP_GOTO_ON_FALSE(build->timer, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for screen building timer!");
+    lv_timer_ready(build->timer);
+    build->start = esp_timer_get_time();
+    lvgl_port_unlock();
+
+    if (ret_handle) {
+        *ret_handle = build;
+    }
+    return ESP_OK;
+
+err:
+    lvgl_port_screen_build_free(build, true);
+    lvgl_port_unlock();
+    return ret;
+}
+
+esp_err_t lvgl_port_screen_build_cancel(lvgl_port_screen_build_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments!");
+
+    lvgl_port_lock(0);
+    lvgl_port_screen_build_free(handle, true);
+    lvgl_port_unlock();
+    return ESP_OK;
+}
+
+/*******************************************************************************
+* Private functions
+*******************************************************************************/
+
+static void lvgl_port_screen_build_slice(lv_timer_t *timer)
+{
+    lvgl_port_screen_build_handle_t build = (lvgl_port_screen_build_handle_t)lv_timer_get_user_data(timer);
+    const int64_t slice_start = esp_timer_get_time();
+    const int64_t budget_us = (int64_t)build->cfg.budget_ms * 1000;
+
+    /* At least one step in each slice, so a step longer than the budget cannot block the building */
+    do {
+        if (build->next >= build->cfg.step_count) {
+            break;
+        }
+        build->cfg.steps[build->next](build->scr, build->cfg.user_ctx);
+        build->next++;
+    } while (esp_timer_get_time() - slice_start < budget_us);
+    build->slices++;
+
+    if (build->next < build->cfg.step_count) {
+        return;
+    }
+
+    ESP_LOGD(TAG, "Screen built in %"PRIu32" steps, %"PRIu32" slices, %"PRIu32" ms", build->cfg.step_count, build->slices,
+             (uint32_t)((esp_timer_get_time() - build->start) / 1000));
+    lv_screen_load_anim(build->scr, build->cfg.anim, build->cfg.anim_time, 0, build->cfg.flags.auto_del);
+    if (build->cfg.done_cb) {
+        build->cfg.done_cb(build->scr, build->cfg.user_ctx);
+    }
+    lvgl_port_screen_build_free(build, false);
+}
+
+static void lvgl_port_screen_build_free(lvgl_port_screen_build_handle_t build, bool del_scr)
+{
+    if (build->timer) {
+        lv_timer_delete(build->timer);
+    }
+    if (del_scr && build->scr) {
+        lv_obj_delete(build->scr);
+    }
+    free(build);
+}
@@ -0,0 +1,355 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_lvgl_port.h"
+#include "esp_lvgl_port_priv.h"
+
+static const char *TAG = "LVGL";
+
+#define LVGL_PORT_SCREENSHOT_TASK_STACK (4096)
+/* Encoded bytes written into the file at once */
+#define LVGL_PORT_SCREENSHOT_WRITE_SIZE (4096)
+
+/* QOI format (https://qoiformat.org/qoi-specification.pdf) */
+#define QOI_OP_INDEX    (0x00)
+#define QOI_OP_DIFF     (0x40)
+#define QOI_OP_LUMA     (0x80)
+#define QOI_OP_RUN      (0xC0)
+#define QOI_OP_RGB      (0xFE)
+#define QOI_HASH(px)    ((((px) >> 16 & 0xFF) * 3 + ((px) >> 8 & 0xFF) * 5 + ((px) & 0xFF) * 7 + 255 * 11) % 64)
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+typedef enum {
+    LVGL_PORT_SCREENSHOT_IDLE,
+    LVGL_PORT_SCREENSHOT_CAPTURING,     /* Flushed areas are copied into the staging buffer */
+    LVGL_PORT_SCREENSHOT_WRITING,       /* Screenshot task encodes and writes the staging buffer */
+} lvgl_port_screenshot_state_t;
+
+typedef struct {
+    TaskHandle_t                    task;
+    TaskHandle_t                    stop_notify;    /* Task waiting for the end of the screenshot task */
+    volatile bool                   running;
+    uint32_t                        caps;           /* Memory capabilities of the staging buffer */
+    volatile lvgl_port_screenshot_state_t state;
+    bool                            captured;       /* An area was copied since the screenshot was taken */
+    lv_display_t                    *disp;
+    uint16_t                        *staging;       /* RGB565 pixels of the whole screen */
+    int32_t                         w;              /* Size of the screen at the time of the screenshot */
+    int32_t                         h;
+    char                            *path;
+    lvgl_port_screenshot_done_cb_t  done_cb;
+    void                            *user_ctx;
+} lvgl_port_screenshot_ctx_t;
+
+typedef struct {
+    FILE        *file;
+    uint8_t     *buf;
+    size_t      len;
+    bool        failed;
+} lvgl_port_screenshot_writer_t;
+
+/*******************************************************************************
+* Local variables
+*******************************************************************************/
+
+static lvgl_port_screenshot_ctx_t *lvgl_port_screenshot_ctx = NULL;
+
+/*******************************************************************************
+* Function definitions
+*******************************************************************************/
+
+static void lvgl_port_screenshot_task(void *arg);
+static void lvgl_port_screenshot_refr_ready_callback(lv_event_t *e);
+static void lvgl_port_screenshot_release(lvgl_port_screenshot_ctx_t *ctx);
+static esp_err_t lvgl_port_screenshot_write_qoi(const lvgl_port_screenshot_ctx_t *ctx);
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t lvgl_port_screenshot_init(const lvgl_port_screenshot_cfg_t *cfg)
+{
+    ESP_RETURN_ON_FALSE(cfg, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments!");
+    ESP_RETURN_ON_FALSE(cfg->task_affinity < (configNUM_CORES), ESP_ERR_INVALID_ARG, TAG, "Bad core number for screenshot task! Maximum core number is %d", (configNUM_CORES - 1));
+    ESP_RETURN_ON_FALSE(lvgl_port_screenshot_ctx == NULL, ESP_ERR_INVALID_STATE, TAG, "Screenshot is already initialized!");
+
+    lvgl_port_screenshot_ctx_t *ctx = calloc(1, sizeof(lvgl_port_screenshot_ctx_t));
+    ESP_RETURN_ON_FALSE(ctx, ESP_ERR_NO_MEM, TAG, "Not enough memory for screenshot allocation!");
+    ctx->caps = (cfg->flags.buff_spiram ? MALLOC_CAP_SPIRAM : MALLOC_CAP_INTERNAL) | MALLOC_CAP_8BIT;
+    ctx->running = true;
+
+    const int stack = (cfg->task_stack > 0 ? cfg->task_stack : LVGL_PORT_SCREENSHOT_TASK_STACK);
+    BaseType_t res;
+    if (cfg->task_affinity < 0) {
+        res = xTaskCreate(lvgl_port_screenshot_task, "LVGL screenshot", stack, ctx, cfg->task_priority, &ctx->task);
+    } else {
+        res = xTaskCreatePinnedToCore(lvgl_port_screenshot_task, "LVGL screenshot", stack, ctx, cfg->task_priority, &ctx->task, cfg->task_affinity);
+    }
+    if (res != pdPASS) {
+        free(ctx);
+        ESP_LOGE(TAG, "Create screenshot task fail!");
+        return ESP_FAIL;
+    }
+
+    lvgl_port_screenshot_ctx = ctx;
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_screenshot_take(lv_display_t *disp, const char *path, lvgl_port_screenshot_done_cb_t done_cb, void *user_ctx)
+{
+    esp_err_t ret = ESP_OK;
+    lvgl_port_screenshot_ctx_t *ctx = lvgl_port_screenshot_ctx;
+    ESP_RETURN_ON_FALSE(disp && path, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments!");
+    ESP_RETURN_ON_FALSE(ctx, ESP_ERR_INVALID_STATE, TAG, "Screenshot is not initialized!");
+
+    lvgl_port_lock(0);
+    if (ctx->state != LVGL_PORT_SCREENSHOT_IDLE) {
+        lvgl_port_unlock();
+        ESP_LOGE(TAG, "Other screenshot is in progress!");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    ctx->w = lv_display_get_horizontal_resolution(disp);
+    ctx->h = lv_display_get_vertical_resolution(disp);
+    ctx->staging = heap_caps_malloc(ctx->w * ctx->h * sizeof(uint16_t), ctx->caps);
+    ctx->path = strdup(path);
+    ESP_GOTO_ON_FALSE(ctx->staging && ctx->path, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for screenshot staging buffer!");
+    LVGL_PORT_MEM_ADD(ctx->staging, ctx->caps);
+    ESP_GOTO_ON_ERROR(lvgl_port_disp_set_screenshot(disp, true), err, TAG, "Display cannot be captured!");
+
+    ctx->disp = disp;
+    ctx->done_cb = done_cb;
+    ctx->user_ctx = user_ctx;
+    ctx->captured = false;
+    ctx->state = LVGL_PORT_SCREENSHOT_CAPTURING;
+    lv_display_add_event_cb(disp, lvgl_port_screenshot_refr_ready_callback, LV_EVENT_REFR_READY, ctx);
+
+    /* The whole screen is rendered in the next refresh, LVGL is not blocked by the snapshot */
+    lv_obj_invalidate(lv_display_get_screen_active(disp));
+    lvgl_port_unlock();
+    return ESP_OK;
+
+err:
+    lvgl_port_screenshot_release(ctx);
+    lvgl_port_unlock();
+    return ret;
+}
+
+esp_err_t lvgl_port_screenshot_deinit(void)
+{
+    lvgl_port_screenshot_ctx_t *ctx = lvgl_port_screenshot_ctx;
+    if (ctx == NULL) {
+        return ESP_OK;
+    }
+
+    lvgl_port_lock(0);
+    if (ctx->state == LVGL_PORT_SCREENSHOT_CAPTURING) {
+        lvgl_port_disp_set_screenshot(ctx->disp, false);
+        lv_display_remove_event_cb_with_user_data(ctx->disp, lvgl_port_screenshot_refr_ready_callback, ctx);
+        lvgl_port_screenshot_release(ctx);
+    }
+    lvgl_port_unlock();
+
+    /* Stop the screenshot task after the file in progress is written */
+    ctx->stop_notify = xTaskGetCurrentTaskHandle();
+    ctx->running = false;
+    xTaskNotifyGive(ctx->task);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    free(ctx);
+    lvgl_port_screenshot_ctx = NULL;
+    return ESP_OK;
+}
+
+/*******************************************************************************
+* Private functions
+*******************************************************************************/
+
+void lvgl_port_screenshot_capture(lv_display_t *disp, const lv_area_t *area, const uint16_t *px, int32_t stride)
+{
+    lvgl_port_screenshot_ctx_t *ctx = lvgl_port_screenshot_ctx;
+    if (ctx == NULL || ctx->state != LVGL_PORT_SCREENSHOT_CAPTURING || ctx->disp != disp) {
+        return;
+    }
+
+    /* The screen could be resized since the screenshot was taken */
+    const lv_area_t screen = {0, 0, ctx->w - 1, ctx->h - 1};
+    lv_area_t clipped;
+    if (!lv_area_intersect(&clipped, area, &screen)) {
+        return;
+    }
+    const int32_t w = lv_area_get_width(&clipped);
+    px += (clipped.y1 - area->y1) * stride + (clipped.x1 - area->x1);
+    for (int32_t y = clipped.y1; y <= clipped.y2; y++) {
+        memcpy(ctx->staging + y * ctx->w + clipped.x1, px, w * sizeof(uint16_t));
+        px += stride;
+    }
+    ctx->captured = true;
+}
+
+/*******************************************************************************
+* Local functions
+*******************************************************************************/
+
+static void lvgl_port_screenshot_task(void *arg)
+{
+    lvgl_port_screenshot_ctx_t *ctx = (lvgl_port_screenshot_ctx_t *)arg;
+
+    while (ctx->running) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (ctx->state != LVGL_PORT_SCREENSHOT_WRITING) {
+            continue;
+        }
+
+        const esp_err_t ret = lvgl_port_screenshot_write_qoi(ctx);
+        if (ctx->done_cb) {
+            ctx->done_cb(ctx->path, ret, ctx->user_ctx);
+        }
+        lvgl_port_screenshot_release(ctx);
+    }
+
+    if (ctx->stop_notify) {
+        xTaskNotifyGive(ctx->stop_notify);
+    }
+    vTaskDelete(NULL);
+}
+
+static void lvgl_port_screenshot_refr_ready_callback(lv_event_t *e)
+{
+    lvgl_port_screenshot_ctx_t *ctx = (lvgl_port_screenshot_ctx_t *)lv_event_get_user_data(e);
+    if (!ctx->captured) {
+        /* The invalidated screen was not rendered yet (e.g. frame pacing) */
+        return;
+    }
+
+    /* The whole screen is in the staging buffer, the rest is done without the LVGL lock */
+    lvgl_port_disp_set_screenshot(ctx->disp, false);
+    lv_display_remove_event_cb_with_user_data(ctx->disp, lvgl_port_screenshot_refr_ready_callback, ctx);
+    ctx->state = LVGL_PORT_SCREENSHOT_WRITING;
+    xTaskNotifyGive(ctx->task);
+}
+
+static void lvgl_port_screenshot_release(lvgl_port_screenshot_ctx_t *ctx)
+{
+    if (ctx->staging) {
+        LVGL_PORT_MEM_REMOVE(ctx->staging, ctx->caps);
+        free(ctx->staging);
+        ctx->staging = NULL;
+    }
+    free(ctx->path);
+    ctx->path = NULL;
+    ctx->disp = NULL;
+    ctx->state = LVGL_PORT_SCREENSHOT_IDLE;
+}
+
+static void lvgl_port_screenshot_put(lvgl_port_screenshot_writer_t *writer, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        writer->buf[writer->len++] = data[i];
+        if (writer->len == LVGL_PORT_SCREENSHOT_WRITE_SIZE) {
+            writer->failed |= (fwrite(writer->buf, 1, writer->len, writer->file) != writer->len);
+            writer->len = 0;
+        }
+    }
+}
+
+static esp_err_t lvgl_port_screenshot_write_qoi(const lvgl_port_screenshot_ctx_t *ctx)
+{
+    lvgl_port_screenshot_writer_t writer = {
+        .buf = malloc(LVGL_PORT_SCREENSHOT_WRITE_SIZE),
+    };
+    ESP_RETURN_ON_FALSE(writer.buf, ESP_ERR_NO_MEM, TAG, "Not enough memory for screenshot writing!");
+    writer.file = fopen(ctx->path, "wb");
+    if (writer.file == NULL) {
+        free(writer.buf);
+        ESP_LOGE(TAG, "Cannot open %s", ctx->path);
+        return ESP_FAIL;
+    }
+
+    /* Header: magic, width, height (big endian), RGB channels, sRGB */
+    const uint8_t header[14] = {
+        'q', 'o', 'i', 'f',
+        ctx->w >> 24, ctx->w >> 16, ctx->w >> 8, ctx->w,
+        ctx->h >> 24, ctx->h >> 16, ctx->h >> 8, ctx->h,
+        3, 0
+    };
+    lvgl_port_screenshot_put(&writer, header, sizeof(header));
+
+    /* Pixels are 0xRRGGBB, the alpha is always 255 */
+    uint32_t index[64];
+    memset(index, 0xFF, sizeof(index));
+    uint32_t prev = 0;
+    uint8_t run = 0;
+    const size_t px_cnt = ctx->w * ctx->h;
+    for (size_t i = 0; i < px_cnt; i++) {
+        const uint16_t c = ctx->staging[i];
+        const uint8_t r = ((c >> 8) & 0xF8) | (c >> 13);
+        const uint8_t g = ((c >> 3) & 0xFC) | ((c >> 9) & 0x03);
+        const uint8_t b = ((c << 3) & 0xF8) | ((c >> 2) & 0x07);
+        const uint32_t px = (r << 16) | (g << 8) | b;
+
+        if (px == prev) {
+            run++;
+            if (run == 62 || i == px_cnt - 1) {
+                const uint8_t op = QOI_OP_RUN | (run - 1);
+                lvgl_port_screenshot_put(&writer, &op, 1);
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            const uint8_t op = QOI_OP_RUN | (run - 1);
+            lvgl_port_screenshot_put(&writer, &op, 1);
+            run = 0;
+        }
+
+        const uint8_t hash = QOI_HASH(px);
+        if (index[hash] == px) {
+            lvgl_port_screenshot_put(&writer, &hash, 1);
+        } else {
+            index[hash] = px;
+            const int8_t dr = (int8_t)(r - (prev >> 16));
+            const int8_t dg = (int8_t)(g - (prev >> 8));
+            const int8_t db = (int8_t)(b - prev);
+            const int8_t dr_dg = dr - dg;
+            const int8_t db_dg = db - dg;
+            if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                const uint8_t op = QOI_OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2);
+                lvgl_port_screenshot_put(&writer, &op, 1);
+            } else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7) {
+                const uint8_t op[2] = {QOI_OP_LUMA | (dg + 32), ((dr_dg + 8) << 4) | (db_dg + 8)};
+                lvgl_port_screenshot_put(&writer, op, sizeof(op));
+            } else {
+                const uint8_t op[4] = {QOI_OP_RGB, r, g, b};
+                lvgl_port_screenshot_put(&writer, op, sizeof(op));
+            }
+        }
+        prev = px;
+    }
+
+    static const uint8_t end[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+    lvgl_port_screenshot_put(&writer, end, sizeof(end));
+    if (writer.len) {
+        writer.failed |= (fwrite(writer.buf, 1, writer.len, writer.file) != writer.len);
+    }
+    writer.failed |= (fclose(writer.file) != 0);
+    free(writer.buf);
+
+    ESP_RETURN_ON_FALSE(!writer.failed, ESP_FAIL, TAG, "Writing %s failed", ctx->path);
+    return ESP_OK;
+}
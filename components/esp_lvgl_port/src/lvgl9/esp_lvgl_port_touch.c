@@ -7,11 +7,27 @@
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_check.h"
+#include "esp_timer.h"
 #include "esp_lcd_touch.h"
 #include "esp_lvgl_port.h"
+#include "esp_lvgl_port_gesture.h"
+#include "esp_lvgl_port_priv.h"
 
 static const char *TAG = "LVGL";
 
+/* Period of checking display inactivity for touch sleep */
+#define LVGL_PORT_TOUCH_SLEEP_CHECK_MS      (200)
+
+/* Gesture event code (registered in LVGL, common for all touches) */
+static uint32_t lvgl_port_gesture_event = 0;
+
+/* Measurement of the first frame after a wake-up press */
+typedef enum {
+    LVGL_PORT_TOUCH_WAKE_IDLE,      /* Nothing to measure */
+    LVGL_PORT_TOUCH_WAKE_PRESSED,   /* Press was given to LVGL, waiting for rendering */
+    LVGL_PORT_TOUCH_WAKE_RENDERING, /* Frame after the press is rendered, waiting for its first flush done */
+} lvgl_port_touch_wake_state_t;
+
 /*******************************************************************************
 * Types definitions
 *******************************************************************************/
@@ -19,14 +35,53 @@ static const char *TAG = "LVGL";
 typedef struct {
     esp_lcd_touch_handle_t  handle;     /* LCD touch IO handle */
     lv_indev_t              *indev;     /* LVGL input device driver */
+#if (CONFIG_ESP_LCD_TOUCH_SAMPLES > 0)
+    uint32_t                predict_ms; /* Touch prediction time */
+    esp_lcd_touch_sample_t  samples[CONFIG_ESP_LCD_TOUCH_SAMPLES]; /* Samples not given to LVGL yet */
+    uint8_t                 sample_cnt; /* Count of samples */
+    uint8_t                 sample_idx; /* Index of the next sample given to LVGL */
+    bool                    release;    /* Release after the last sample */
+    esp_lcd_touch_sample_t  last;       /* Last sample given to LVGL (for velocity) */
+    bool                    last_valid; /* Last sample is from the current touch */
+#endif
+    bool                    gestures;   /* Gesture recognition enabled */
+    lvgl_port_gesture_ctx_t gesture;    /* Gesture recognition state */
+    uint32_t                poll_active_ms; /* Read period while touched */
+    uint32_t                poll_idle_ms;   /* Read period while not touched */
+    uint32_t                sleep_timeout_ms; /* Inactivity time for controller sleep */
+    uint32_t                scan_idle_ms;   /* Inactivity time for controller monitor mode */
+    uint32_t                bus_wait_ms;    /* Maximum wait for the gap between display transfers (shared SPI bus) */
+    lv_timer_t              *sleep_timer;   /* Timer checking display inactivity */
+    bool                    pressed;    /* Touched in the last reading */
+    bool                    sleeping;   /* Controller is in sleep mode */
+    bool                    scan_active; /* Controller is kept in active scanning */
+    bool                    wake_on_touch; /* Touch interrupt wakes the chip from light sleep */
+    uint32_t                wake_cnt;   /* Wake-ups of the controller already counted */
+    lvgl_port_touch_wake_stats_t wake_stats;
 } lvgl_port_touch_ctx_t;
 
+/* Only one wake-up is measured at a time, the frame is common for all touches */
+static struct {
+    lvgl_port_touch_ctx_t   *touch_ctx; /* Touch of the measured wake-up */
+    int64_t                 irq_us;     /* Time of the wake-up interrupt */
+    volatile lvgl_port_touch_wake_state_t state;
+} lvgl_port_touch_wake;
+static portMUX_TYPE lvgl_port_touch_wake_lock = portMUX_INITIALIZER_UNLOCKED;
+
 /*******************************************************************************
 * Function definitions
 *******************************************************************************/
 
 static void lvgl_port_touchpad_read(lv_indev_t *indev_drv, lv_indev_data_t *data);
 static void lvgl_port_touch_interrupt_callback(esp_lcd_touch_handle_t tp);
+static void lvgl_port_touch_gestures(lvgl_port_touch_ctx_t *touch_ctx, const uint16_t *x, const uint16_t *y, uint8_t cnt);
+static void lvgl_port_touch_set_poll(lvgl_port_touch_ctx_t *touch_ctx, bool active);
+static void lvgl_port_touch_sleep_timer_cb(lv_timer_t *timer);
+static void lvgl_port_touch_set_scan(lvgl_port_touch_ctx_t *touch_ctx, bool active);
+static void lvgl_port_touch_wake_press(lvgl_port_touch_ctx_t *touch_ctx, bool pressed);
+#if (CONFIG_ESP_LCD_TOUCH_SAMPLES > 0)
+static bool lvgl_port_touchpad_read_sample(lvgl_port_touch_ctx_t *touch_ctx, lv_indev_data_t *data);
+#endif
 
 /*******************************************************************************
 * Public API functions
@@ -47,6 +102,42 @@ lv_indev_t *lvgl_port_add_touch(const lvgl_port_touch_cfg_t *touch_cfg)
         return NULL;
     }
     touch_ctx->handle = touch_cfg->handle;
+#if (CONFIG_ESP_LCD_TOUCH_SAMPLES > 0)
+    touch_ctx->predict_ms = touch_cfg->predict_ms;
+    touch_ctx->sample_cnt = 0;
+    touch_ctx->sample_idx = 0;
+    touch_ctx->release = false;
+    touch_ctx->last_valid = false;
+#endif
+    touch_ctx->gestures = touch_cfg->flags.gestures;
+    lvgl_port_gesture_init(&touch_ctx->gesture);
+    touch_ctx->poll_active_ms = touch_cfg->poll_active_ms;
+    touch_ctx->poll_idle_ms = touch_cfg->poll_idle_ms;
+    touch_ctx->sleep_timeout_ms = touch_cfg->sleep_timeout_ms;
+    touch_ctx->scan_idle_ms = touch_cfg->scan_idle_ms;
+    touch_ctx->bus_wait_ms = touch_cfg->bus_wait_ms;
+    touch_ctx->sleep_timer = NULL;
+    touch_ctx->pressed = false;
+    touch_ctx->sleeping = false;
+    touch_ctx->scan_active = true;
+    touch_ctx->wake_on_touch = touch_cfg->flags.wake_on_touch;
+    touch_ctx->wake_cnt = 0;
+    touch_ctx->wake_stats = (lvgl_port_touch_wake_stats_t) {
+        0
+    };
+
+    if (touch_ctx->wake_on_touch) {
+        /* Sleeping controller would not report the touch, it can only scan slowly in its monitor mode */
+        if (touch_ctx->sleep_timeout_ms > 0) {
+            ESP_LOGW(TAG, "Touch sleep timeout is ignored with wake on touch");
+            touch_ctx->sleep_timeout_ms = 0;
+        }
+        ret = esp_lcd_touch_set_wakeup(touch_ctx->handle, true);
+        ESP_GOTO_ON_ERROR(ret, err, TAG, "Touch wake-up needs interrupt pin and acquisition task");
+        esp_lcd_touch_wakeup_stats_t wake;
+        esp_lcd_touch_get_wakeup_stats(touch_ctx->handle, &wake);
+        touch_ctx->wake_cnt = wake.wake_cnt;
+    }
 
     if (touch_ctx->handle->config.int_gpio_num != GPIO_NUM_NC) {
         /* Register touch interrupt callback */
@@ -55,6 +146,9 @@ lv_indev_t *lvgl_port_add_touch(const lvgl_port_touch_cfg_t *touch_cfg)
     }
 
     lvgl_port_lock(0);
+    if (touch_ctx->gestures && lvgl_port_gesture_event == 0) {
+        lvgl_port_gesture_event = lv_event_register_id();
+    }
     /* Register a touchpad input device */
     indev = lv_indev_create();
     lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
@@ -66,11 +160,23 @@ lv_indev_t *lvgl_port_add_touch(const lvgl_port_touch_cfg_t *touch_cfg)
     lv_indev_set_disp(indev, touch_cfg->disp);
     lv_indev_set_user_data(indev, touch_ctx);
     touch_ctx->indev = indev;
+    /* Interrupt or slow polling until the first touch */
+    lvgl_port_touch_set_poll(touch_ctx, false);
+    /* Monitor mode until the first touch */
+    if (touch_ctx->scan_idle_ms > 0) {
+        lvgl_port_touch_set_scan(touch_ctx, false);
+    }
+    if (touch_ctx->sleep_timeout_ms > 0 || touch_ctx->scan_idle_ms > 0) {
+        touch_ctx->sleep_timer = lv_timer_create(lvgl_port_touch_sleep_timer_cb, LVGL_PORT_TOUCH_SLEEP_CHECK_MS, touch_ctx);
+    }
     lvgl_port_unlock();
 
 err:
     if (ret != ESP_OK) {
         if (touch_ctx) {
+            if (touch_ctx->wake_on_touch) {
+                esp_lcd_touch_set_wakeup(touch_ctx->handle, false);
+            }
             free(touch_ctx);
         }
     }
@@ -86,8 +192,25 @@ esp_err_t lvgl_port_remove_touch(lv_indev_t *touch)
     lvgl_port_lock(0);
     /* Remove input device driver */
     lv_indev_delete(touch);
+    if (touch_ctx->sleep_timer) {
+        lv_timer_delete(touch_ctx->sleep_timer);
+    }
     lvgl_port_unlock();
 
+    portENTER_CRITICAL(&lvgl_port_touch_wake_lock);
+    if (lvgl_port_touch_wake.touch_ctx == touch_ctx) {
+        lvgl_port_touch_wake.touch_ctx = NULL;
+        lvgl_port_touch_wake.state = LVGL_PORT_TOUCH_WAKE_IDLE;
+    }
+    portEXIT_CRITICAL(&lvgl_port_touch_wake_lock);
+
+    if (touch_ctx->sleeping) {
+        esp_lcd_touch_exit_sleep(touch_ctx->handle);
+    }
+    if (touch_ctx->wake_on_touch) {
+        esp_lcd_touch_set_wakeup(touch_ctx->handle, false);
+    }
+
     if (touch_ctx->handle->config.int_gpio_num != GPIO_NUM_NC) {
         /* Unregister touch interrupt callback */
         esp_lcd_touch_register_interrupt_callback(touch_ctx->handle, NULL);
@@ -100,6 +223,23 @@ esp_err_t lvgl_port_remove_touch(lv_indev_t *touch)
     return ESP_OK;
 }
 
+uint32_t lvgl_port_touch_get_gesture_event(void)
+{
+    return lvgl_port_gesture_event;
+}
+
+esp_err_t lvgl_port_touch_get_wake_stats(lv_indev_t *touch, lvgl_port_touch_wake_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(touch && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments!");
+    lvgl_port_touch_ctx_t *touch_ctx = (lvgl_port_touch_ctx_t *)lv_indev_get_user_data(touch);
+    ESP_RETURN_ON_FALSE(touch_ctx, ESP_ERR_INVALID_ARG, TAG, "Not a touch of LVGL port!");
+
+    portENTER_CRITICAL(&lvgl_port_touch_wake_lock);
+    *stats = touch_ctx->wake_stats;
+    portEXIT_CRITICAL(&lvgl_port_touch_wake_lock);
+    return ESP_OK;
+}
+
 /*******************************************************************************
 * Private functions
 *******************************************************************************/
@@ -111,20 +251,74 @@ static void lvgl_port_touchpad_read(lv_indev_t *indev_drv, lv_indev_data_t *data
     assert(touch_ctx);
     assert(touch_ctx->handle);
 
-    uint16_t touchpad_x[1] = {0};
-    uint16_t touchpad_y[1] = {0};
+    /* Two points are needed only for gestures */
+    uint16_t touchpad_x[2] = {0};
+    uint16_t touchpad_y[2] = {0};
     uint8_t touchpad_cnt = 0;
 
+    /* The controller is not read in sleep mode */
+    if (touch_ctx->sleeping) {
+        data->state = LV_INDEV_STATE_RELEASED;
+        return;
+    }
+
+#if (CONFIG_ESP_LCD_TOUCH_SAMPLES > 0)
+    /* Samples from the last reading are given to LVGL one by one */
+    if (lvgl_port_touchpad_read_sample(touch_ctx, data)) {
+        return;
+    }
+#endif
+
+    /* Touch transaction is not queued between transfers of the display on the shared SPI bus, it is read anyway after timeout */
+    if (touch_ctx->bus_wait_ms > 0) {
+        lvgl_port_disp_bus_wait(lv_indev_get_display(indev_drv), touch_ctx->bus_wait_ms);
+    }
+
     /* Read data from touch controller into memory */
+    LVGL_PORT_SV_START(LVGL_PORT_SV_INDEV_READ);
     esp_lcd_touch_read_data(touch_ctx->handle);
+    LVGL_PORT_SV_STOP(LVGL_PORT_SV_INDEV_READ);
 
     /* Read data from touch controller */
-    bool touchpad_pressed = esp_lcd_touch_get_coordinates(touch_ctx->handle, touchpad_x, touchpad_y, NULL, &touchpad_cnt, 1);
+    bool touchpad_pressed = esp_lcd_touch_get_coordinates(touch_ctx->handle, touchpad_x, touchpad_y, NULL, &touchpad_cnt, (touch_ctx->gestures ? 2 : 1));
+
+    if (touch_ctx->gestures) {
+        lvgl_port_touch_gestures(touch_ctx, touchpad_x, touchpad_y, (touchpad_pressed ? touchpad_cnt : 0));
+    }
+
+    /* Fast reading only while touched */
+    const bool pressed = (touchpad_pressed && touchpad_cnt > 0);
+    if (pressed != touch_ctx->pressed) {
+        touch_ctx->pressed = pressed;
+        if (touch_ctx->wake_on_touch) {
+            lvgl_port_touch_wake_press(touch_ctx, pressed);
+        }
+        lvgl_port_touch_set_poll(touch_ctx, pressed);
+        if (pressed && touch_ctx->scan_idle_ms > 0 && !touch_ctx->scan_active) {
+            lvgl_port_touch_set_scan(touch_ctx, true);
+        }
+    }
+
+#if (CONFIG_ESP_LCD_TOUCH_SAMPLES > 0)
+    /* All samples read since the last call (the acquisition task can read more of them) */
+    touch_ctx->sample_cnt = esp_lcd_touch_get_samples(touch_ctx->handle, touch_ctx->samples, CONFIG_ESP_LCD_TOUCH_SAMPLES);
+    touch_ctx->sample_idx = 0;
+    touch_ctx->release = !(touchpad_pressed && touchpad_cnt > 0);
+    if (lvgl_port_touchpad_read_sample(touch_ctx, data)) {
+        return;
+    }
+    touch_ctx->release = false;
+    if (!(touchpad_pressed && touchpad_cnt > 0)) {
+        touch_ctx->last_valid = false;
+    }
+#endif
 
     if (touchpad_pressed && touchpad_cnt > 0) {
         data->point.x = touchpad_x[0];
         data->point.y = touchpad_y[0];
         data->state = LV_INDEV_STATE_PRESSED;
+        const lv_area_t point = {touchpad_x[0], touchpad_y[0], touchpad_x[0], touchpad_y[0]};
+        lvgl_port_trace(LVGL_PORT_TRACE_TOUCH_READ, &point);
     } else {
         data->state = LV_INDEV_STATE_RELEASED;
     }
@@ -134,6 +328,209 @@ static void IRAM_ATTR lvgl_port_touch_interrupt_callback(esp_lcd_touch_handle_t
 {
     lvgl_port_touch_ctx_t *touch_ctx = (lvgl_port_touch_ctx_t *) tp->config.user_data;
 
+    lvgl_port_trace(LVGL_PORT_TRACE_TOUCH_IRQ, NULL);
+
     /* Wake LVGL task, if needed */
     lvgl_port_task_wake(LVGL_PORT_EVENT_TOUCH, touch_ctx->indev);
 }
+
+/* Select reading period by touch state */
+static void lvgl_port_touch_set_poll(lvgl_port_touch_ctx_t *touch_ctx, bool active)
+{
+    uint32_t period = (active ? touch_ctx->poll_active_ms : touch_ctx->poll_idle_ms);
+    if (period == 0) {
+        period = LV_DEF_REFR_PERIOD;
+    }
+    /* With interrupt, the controller is read only after interrupt while not touched */
+    if (touch_ctx->handle->config.int_gpio_num != GPIO_NUM_NC && touch_ctx->poll_active_ms > 0) {
+        lv_indev_set_mode(touch_ctx->indev, (active ? LV_INDEV_MODE_TIMER : LV_INDEV_MODE_EVENT));
+    }
+    lv_timer_t *timer = lv_indev_get_read_timer(touch_ctx->indev);
+    if (timer) {
+        lv_timer_set_period(timer, period);
+    }
+}
+
+/* Controller sleeps, when the display is inactive (no touch and no other input), and it is woken by activity */
+static void lvgl_port_touch_sleep_timer_cb(lv_timer_t *timer)
+{
+    lvgl_port_touch_ctx_t *touch_ctx = (lvgl_port_touch_ctx_t *)lv_timer_get_user_data(timer);
+    assert(touch_ctx);
+
+    const uint32_t inactive_ms = lv_display_get_inactive_time(lv_indev_get_display(touch_ctx->indev));
+
+    /* Slow scanning of the controller in idle */
+    if (touch_ctx->scan_idle_ms > 0 && touch_ctx->scan_active && !touch_ctx->pressed && inactive_ms >= touch_ctx->scan_idle_ms) {
+        lvgl_port_touch_set_scan(touch_ctx, false);
+    }
+    if (touch_ctx->sleep_timeout_ms == 0) {
+        return;
+    }
+
+    const bool inactive = (inactive_ms >= touch_ctx->sleep_timeout_ms);
+    if (inactive && !touch_ctx->sleeping && !touch_ctx->pressed) {
+        if (touch_ctx->handle->enter_sleep && esp_lcd_touch_enter_sleep(touch_ctx->handle) == ESP_OK) {
+            touch_ctx->sleeping = true;
+        }
+    } else if (!inactive && touch_ctx->sleeping) {
+        touch_ctx->sleeping = false;
+        if (esp_lcd_touch_exit_sleep(touch_ctx->handle) != ESP_OK) {
+            ESP_LOGW(TAG, "Touch exit sleep failed");
+        }
+    }
+}
+
+/* Active scanning during interaction, monitor mode of the controller in idle */
+static void lvgl_port_touch_set_scan(lvgl_port_touch_ctx_t *touch_ctx, bool active)
+{
+    touch_ctx->scan_active = active;
+    const esp_err_t ret = esp_lcd_touch_set_active_scan(touch_ctx->handle, active);
+    if (ret == ESP_ERR_NOT_SUPPORTED) {
+        ESP_LOGW(TAG, "Touch controller does not support scan mode switching");
+        touch_ctx->scan_idle_ms = 0;
+    } else if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Touch scan mode not set");
+    }
+}
+
+/* The press started by the wake-up interrupt waits for its first frame */
+static void lvgl_port_touch_wake_press(lvgl_port_touch_ctx_t *touch_ctx, bool pressed)
+{
+    if (!pressed) {
+        /* Press without any change of the screen is not measured */
+        portENTER_CRITICAL(&lvgl_port_touch_wake_lock);
+        if (lvgl_port_touch_wake.touch_ctx == touch_ctx && lvgl_port_touch_wake.state == LVGL_PORT_TOUCH_WAKE_PRESSED) {
+            lvgl_port_touch_wake.state = LVGL_PORT_TOUCH_WAKE_IDLE;
+        }
+        portEXIT_CRITICAL(&lvgl_port_touch_wake_lock);
+        return;
+    }
+
+    esp_lcd_touch_wakeup_stats_t wake;
+    esp_lcd_touch_get_wakeup_stats(touch_ctx->handle, &wake);
+    if (wake.wake_cnt == touch_ctx->wake_cnt) {
+        return;
+    }
+    touch_ctx->wake_cnt = wake.wake_cnt;
+
+    portENTER_CRITICAL(&lvgl_port_touch_wake_lock);
+    touch_ctx->wake_stats.wake_cnt++;
+    touch_ctx->wake_stats.read_latency_us = wake.read_latency_us;
+    lvgl_port_touch_wake.touch_ctx = touch_ctx;
+    lvgl_port_touch_wake.irq_us = wake.last_irq_us;
+    lvgl_port_touch_wake.state = LVGL_PORT_TOUCH_WAKE_PRESSED;
+    portEXIT_CRITICAL(&lvgl_port_touch_wake_lock);
+}
+
+IRAM_ATTR void lvgl_port_touch_wake_trace(lvgl_port_trace_stage_t stage)
+{
+    /* One volatile read per stage, when nothing is measured */
+    if (lvgl_port_touch_wake.state == LVGL_PORT_TOUCH_WAKE_IDLE) {
+        return;
+    }
+
+    portENTER_CRITICAL_SAFE(&lvgl_port_touch_wake_lock);
+    if (stage == LVGL_PORT_TRACE_RENDER && lvgl_port_touch_wake.state == LVGL_PORT_TOUCH_WAKE_PRESSED) {
+        /* Flushes of frames rendered before the press are not counted */
+        lvgl_port_touch_wake.state = LVGL_PORT_TOUCH_WAKE_RENDERING;
+    } else if (stage == LVGL_PORT_TRACE_FLUSH_DONE && lvgl_port_touch_wake.state == LVGL_PORT_TOUCH_WAKE_RENDERING) {
+        lvgl_port_touch_wake_stats_t *stats = &lvgl_port_touch_wake.touch_ctx->wake_stats;
+        stats->frame_latency_us = (uint32_t)(esp_timer_get_time() - lvgl_port_touch_wake.irq_us);
+        stats->frame_latency_max_us = LV_MAX(stats->frame_latency_max_us, stats->frame_latency_us);
+        lvgl_port_touch_wake.state = LVGL_PORT_TOUCH_WAKE_IDLE;
+    }
+    portEXIT_CRITICAL_SAFE(&lvgl_port_touch_wake_lock);
+}
+
+/* Recognize gestures from the touch points and send them to the object under the gesture */
+static void lvgl_port_touch_gestures(lvgl_port_touch_ctx_t *touch_ctx, const uint16_t *x, const uint16_t *y, uint8_t cnt)
+{
+    uint16_t gx[2];
+    uint16_t gy[2];
+    lvgl_port_gesture_t gestures[LVGL_PORT_GESTURE_MAX_OUT];
+    lv_display_t *disp = lv_indev_get_display(touch_ctx->indev);
+    const lv_display_rotation_t rotation = lv_display_get_rotation(disp);
+    const int32_t hres = lv_display_get_physical_horizontal_resolution(disp);
+    const int32_t vres = lv_display_get_physical_vertical_resolution(disp);
+
+    /* Rotate the points same as LVGL rotates the pointer */
+    cnt = (cnt > 2 ? 2 : cnt);
+    for (int i = 0; i < cnt; i++) {
+        int32_t px = x[i];
+        int32_t py = y[i];
+        if (rotation == LV_DISPLAY_ROTATION_180 || rotation == LV_DISPLAY_ROTATION_270) {
+            px = hres - px - 1;
+            py = vres - py - 1;
+        }
+        if (rotation == LV_DISPLAY_ROTATION_90 || rotation == LV_DISPLAY_ROTATION_270) {
+            const int32_t tmp = py;
+            py = px;
+            px = vres - tmp - 1;
+        }
+        gx[i] = (uint16_t)LV_CLAMP(0, px, UINT16_MAX);
+        gy[i] = (uint16_t)LV_CLAMP(0, py, UINT16_MAX);
+    }
+
+    const uint8_t gesture_cnt = lvgl_port_gesture_update(&touch_ctx->gesture, gx, gy, cnt, esp_timer_get_time(), gestures);
+    for (int i = 0; i < gesture_cnt; i++) {
+        lv_obj_t *scr = lv_display_get_screen_active(disp);
+        lv_obj_t *target = lv_indev_search_obj(scr, &gestures[i].point);
+        if (target == NULL) {
+            target = scr;
+        }
+        lv_obj_send_event(target, lvgl_port_gesture_event, &gestures[i]);
+    }
+}
+
+#if (CONFIG_ESP_LCD_TOUCH_SAMPLES > 0)
+/* Give the next saved sample to LVGL. Returns false, if there is nothing to give. */
+static bool lvgl_port_touchpad_read_sample(lvgl_port_touch_ctx_t *touch_ctx, lv_indev_data_t *data)
+{
+    if (touch_ctx->sample_idx >= touch_ctx->sample_cnt) {
+        if (touch_ctx->release && touch_ctx->sample_cnt > 0) {
+            /* Touch was released after the last sample */
+            touch_ctx->release = false;
+            touch_ctx->sample_cnt = 0;
+            touch_ctx->last_valid = false;
+            data->point.x = touch_ctx->last.x;
+            data->point.y = touch_ctx->last.y;
+            data->state = LV_INDEV_STATE_RELEASED;
+            return true;
+        }
+        return false;
+    }
+
+    const esp_lcd_touch_sample_t *sample = &touch_ctx->samples[touch_ctx->sample_idx++];
+    int32_t x = sample->x;
+    int32_t y = sample->y;
+
+    /* Only the newest sample is predicted, it will be shown in the next frame */
+    const bool newest = (touch_ctx->sample_idx == touch_ctx->sample_cnt);
+    if (newest && touch_ctx->predict_ms > 0 && touch_ctx->last_valid) {
+        const int64_t dt = sample->timestamp_us - touch_ctx->last.timestamp_us;
+        /* Too old samples are not from the same movement */
+        if (dt > 0 && dt < 50000) {
+            const int64_t ahead = (int64_t)touch_ctx->predict_ms * 1000;
+            x += (int32_t)(((int64_t)x - touch_ctx->last.x) * ahead / dt);
+            y += (int32_t)(((int64_t)y - touch_ctx->last.y) * ahead / dt);
+            const int32_t hres = lv_display_get_horizontal_resolution(lv_indev_get_display(touch_ctx->indev));
+            const int32_t vres = lv_display_get_vertical_resolution(lv_indev_get_display(touch_ctx->indev));
+            x = LV_CLAMP(0, x, hres - 1);
+            y = LV_CLAMP(0, y, vres - 1);
+        }
+    }
+    touch_ctx->last = *sample;
+    touch_ctx->last_valid = true;
+
+    data->point.x = x;
+    data->point.y = y;
+    data->state = LV_INDEV_STATE_PRESSED;
+    if (newest) {
+        const lv_area_t point = {x, y, x, y};
+        lvgl_port_trace(LVGL_PORT_TRACE_TOUCH_READ, &point);
+    }
+    /* LVGL calls read callback again in the same cycle */
+    data->continue_reading = (!newest || touch_ctx->release);
+    return true;
+}
+#endif
@@ -4,7 +4,7 @@
  * SPDX-License-Identifier: CC0-1.0
  */
 
-
+#include <inttypes.h>
 #include "esp_err.h"
 #include "esp_log.h"
 #include "esp_check.h"
@@ -14,6 +14,7 @@
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_vendor.h"
 #include "esp_lcd_panel_ops.h"
+#include "esp_timer.h"
 #include "esp_lvgl_port.h"
 
 #include "esp_lcd_touch_tt21100.h"
@@ -349,6 +350,234 @@ TEST_CASE("Main test LVGL port", "[lvgl port]")
 
 }
 
+TEST_CASE("Transport buffer is rejected with monochrome display", "[lvgl port]")
+{
+    TEST_ASSERT_EQUAL(app_lcd_init(), ESP_OK);
+    size_t start_freemem_8bit = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+    const lvgl_port_cfg_t lvgl_cfg = ESP_LVGL_PORT_INIT_CONFIG();
+    TEST_ASSERT_EQUAL(lvgl_port_init(&lvgl_cfg), ESP_OK);
+
+    /* Monochrome buffer is packed in 1 bpp pages, the transport buffers split lines of pixels */
+    const lvgl_port_display_cfg_t disp_cfg = {
+        .io_handle = lcd_io,
+        .panel_handle = lcd_panel,
+        .buffer_size = EXAMPLE_LCD_H_RES * EXAMPLE_LCD_V_RES,
+        .trans_size = EXAMPLE_LCD_H_RES * 4,
+        .hres = EXAMPLE_LCD_H_RES,
+        .vres = EXAMPLE_LCD_V_RES,
+        .monochrome = true,
+    };
+    TEST_ASSERT_NULL(lvgl_port_add_disp(&disp_cfg));
+
+    TEST_ASSERT_EQUAL(lvgl_port_deinit(), ESP_OK);
+    vTaskDelay(1000 / portTICK_PERIOD_MS);
+    check_leak(start_freemem_8bit, heap_caps_get_free_size(MALLOC_CAP_8BIT), "8BIT LVGL");
+
+    TEST_ASSERT_EQUAL(app_lcd_deinit(), ESP_OK);
+}
+
+/* Benchmark duration of one scene in one configuration */
+#define TEST_BENCH_SCENE_MS         (3000)
+#define TEST_BENCH_SAMPLE_MS        (20)
+
+typedef struct {
+    const char *name;
+    uint32_t buff_lines;            /* Height of draw buffer, screen height for full refresh */
+    bool double_buffer;
+    bool full_refresh;
+    bool sw_rotate;                 /* Display is rotated by 90 degrees in software */
+    bool swap_bytes;
+} test_bench_cfg_t;
+
+typedef void (*test_bench_scene_t)(lv_obj_t *scr);
+
+/* Direct mode is not in the list, it needs RGB display (SPI LCD cannot draw from the screen-sized buffer with stride) */
+static const test_bench_cfg_t test_bench_cfgs[] = {
+    {.name = "partial_single",      .buff_lines = EXAMPLE_LCD_DRAW_BUFF_HEIGHT, .double_buffer = false, .swap_bytes = true},
+    {.name = "partial_double",      .buff_lines = EXAMPLE_LCD_DRAW_BUFF_HEIGHT, .double_buffer = true,  .swap_bytes = true},
+    {.name = "partial_double_rot",  .buff_lines = EXAMPLE_LCD_DRAW_BUFF_HEIGHT, .double_buffer = true,  .swap_bytes = true, .sw_rotate = true},
+    {.name = "partial_double_noswap", .buff_lines = EXAMPLE_LCD_DRAW_BUFF_HEIGHT, .double_buffer = true, .swap_bytes = false},
+    {.name = "full_refresh_double", .buff_lines = EXAMPLE_LCD_V_RES,            .double_buffer = true,  .swap_bytes = true, .full_refresh = true},
+};
+
+/* Big areas: full width gradient bar moving over the screen */
+static void test_bench_scene_move(lv_obj_t *scr)
+{
+    lv_obj_t *bar = lv_obj_create(scr);
+    lv_obj_set_size(bar, lv_pct(100), lv_pct(30));
+    lv_obj_set_style_radius(bar, 0, 0);
+    lv_obj_set_style_bg_color(bar, lv_color_hex(0xFF0000), 0);
+    lv_obj_set_style_bg_grad_color(bar, lv_color_hex(0x0000FF), 0);
+    lv_obj_set_style_bg_grad_dir(bar, LV_GRAD_DIR_HOR, 0);
+
+    lv_anim_t a;
+    lv_anim_init(&a);
+    lv_anim_set_var(&a, bar);
+    lv_anim_set_exec_cb(&a, (lv_anim_exec_xcb_t)lv_obj_set_y);
+    lv_anim_set_values(&a, 0, lv_obj_get_height(scr) * 7 / 10);
+    lv_anim_set_time(&a, 1000);
+    lv_anim_set_playback_time(&a, 1000);
+    lv_anim_set_repeat_count(&a, LV_ANIM_REPEAT_INFINITE);
+    lv_anim_start(&a);
+}
+
+/* Small areas: spinners in the corners */
+static void test_bench_scene_spinner(lv_obj_t *scr)
+{
+    const lv_align_t align[] = {LV_ALIGN_TOP_LEFT, LV_ALIGN_TOP_RIGHT, LV_ALIGN_BOTTOM_LEFT, LV_ALIGN_BOTTOM_RIGHT};
+    for (int i = 0; i < sizeof(align) / sizeof(align[0]); i++) {
+#if LVGL_VERSION_MAJOR == 8
+        lv_obj_t *spinner = lv_spinner_create(scr, 1000, 60);
+#else
+        lv_obj_t *spinner = lv_spinner_create(scr);
+#endif
+        lv_obj_set_size(spinner, 60, 60);
+        lv_obj_align(spinner, align[i], 0, 0);
+    }
+}
+
+/* Glyph rendering: full screen of text scrolling */
+static void test_bench_scene_text(lv_obj_t *scr)
+{
+    lv_obj_t *label = lv_label_create(scr);
+    lv_obj_set_width(label, lv_pct(100));
+    lv_label_set_long_mode(label, LV_LABEL_LONG_WRAP);
+    lv_label_set_text(label, "The quick brown fox jumps over the lazy dog. 0123456789 "
+                      "The quick brown fox jumps over the lazy dog. 0123456789 "
+                      "The quick brown fox jumps over the lazy dog. 0123456789 "
+                      "The quick brown fox jumps over the lazy dog. 0123456789 "
+                      "The quick brown fox jumps over the lazy dog. 0123456789");
+
+    lv_anim_t a;
+    lv_anim_init(&a);
+    lv_anim_set_var(&a, label);
+    lv_anim_set_exec_cb(&a, (lv_anim_exec_xcb_t)lv_obj_set_y);
+    lv_anim_set_values(&a, 0, lv_obj_get_height(scr) / 2);
+    lv_anim_set_time(&a, 1000);
+    lv_anim_set_playback_time(&a, 1000);
+    lv_anim_set_repeat_count(&a, LV_ANIM_REPEAT_INFINITE);
+    lv_anim_start(&a);
+}
+
+static const struct {
+    const char *name;
+    test_bench_scene_t create;
+} test_bench_scenes[] = {
+    {"move", test_bench_scene_move},
+    {"spinner", test_bench_scene_spinner},
+    {"text", test_bench_scene_text},
+};
+
+/* Render paths in internal RAM (linker.lf), compare the results of builds with and without it */
+#if CONFIG_LVGL_PORT_RENDER_IN_IRAM
+#define TEST_BENCH_IRAM     (1)
+#else
+#define TEST_BENCH_IRAM     (0)
+#endif
+
+static void test_bench_run(const test_bench_cfg_t *cfg)
+{
+    const lvgl_port_display_cfg_t disp_cfg = {
+        .io_handle = lcd_io,
+        .panel_handle = lcd_panel,
+        .buffer_size = EXAMPLE_LCD_H_RES * cfg->buff_lines,
+        .double_buffer = cfg->double_buffer,
+        .hres = EXAMPLE_LCD_H_RES,
+        .vres = EXAMPLE_LCD_V_RES,
+        .monochrome = false,
+        .rotation = {
+            .swap_xy = false,
+            .mirror_x = true,
+            .mirror_y = true,
+        },
+        .flags = {
+            .buff_dma = !cfg->full_refresh,
+            .buff_spiram = cfg->full_refresh,
+            .sw_rotate = cfg->sw_rotate,
+            .full_refresh = cfg->full_refresh,
+#if LVGL_VERSION_MAJOR >= 9
+            .swap_bytes = cfg->swap_bytes,
+#endif
+        }
+    };
+
+    for (int s = 0; s < sizeof(test_bench_scenes) / sizeof(test_bench_scenes[0]); s++) {
+        lvgl_port_lock(0);
+        lvgl_disp = lvgl_port_add_disp(&disp_cfg);
+        TEST_ASSERT_NOT_NULL(lvgl_disp);
+        if (cfg->sw_rotate) {
+            lv_disp_set_rotation(lvgl_disp, LV_DISPLAY_ROTATION_90);
+        }
+        test_bench_scenes[s].create(lv_disp_get_scr_act(lvgl_disp));
+        lvgl_port_unlock();
+
+        /* Skip the first frames */
+        vTaskDelay(pdMS_TO_TICKS(200));
+
+        lvgl_port_disp_perf_t perf;
+        TEST_ASSERT_EQUAL(lvgl_port_disp_get_perf(lvgl_disp, &perf), ESP_OK);
+        const uint32_t start_frames = perf.frame_cnt;
+        const int64_t start = esp_timer_get_time();
+
+        /* Counters hold values of the last frame only, average them from samples */
+        uint64_t render_sum = 0, flush_sum = 0, trans_sum = 0;
+        uint32_t trans_max = 0, samples = 0;
+        while (esp_timer_get_time() - start < TEST_BENCH_SCENE_MS * 1000) {
+            vTaskDelay(pdMS_TO_TICKS(TEST_BENCH_SAMPLE_MS));
+            TEST_ASSERT_EQUAL(lvgl_port_disp_get_perf(lvgl_disp, &perf), ESP_OK);
+            render_sum += perf.render_time;
+            flush_sum += perf.flush_time;
+            trans_sum += perf.trans_time;
+            if (perf.trans_time > trans_max) {
+                trans_max = perf.trans_time;
+            }
+            samples++;
+        }
+        const int64_t duration = esp_timer_get_time() - start;
+        const uint32_t frames = perf.frame_cnt - start_frames;
+
+        const float fps = frames * 1000000.0f / duration;
+        const uint32_t render_avg = render_sum / samples;
+        const uint32_t flush_avg = flush_sum / samples;
+        /* LVGL task is busy by rendering and flushing, the rest of the frame it waits for LCD or sleeps */
+        float cpu = (render_avg + flush_avg) * fps / 10000.0f;
+        if (cpu > 100.0f) {
+            cpu = 100.0f;
+        }
+
+        /* Machine-readable output, one line per configuration and scene */
+        printf("BENCH;board=esp-box;lvgl=%d;iram=%d;cfg=%s;scene=%s;fps=%.1f;cpu=%.1f;render_us=%"PRIu32";flush_us=%"PRIu32";trans_us=%"PRIu32";trans_max_us=%"PRIu32"\n",
+               LVGL_VERSION_MAJOR, TEST_BENCH_IRAM, cfg->name, test_bench_scenes[s].name, fps, cpu, render_avg, flush_avg,
+               (uint32_t)(trans_sum / samples), trans_max);
+
+        TEST_ASSERT_GREATER_THAN(0, frames);
+
+        TEST_ASSERT_EQUAL(lvgl_port_remove_disp(lvgl_disp), ESP_OK);
+    }
+}
+
+TEST_CASE("Benchmark display refresh", "[lvgl port][benchmark]")
+{
+    TEST_ASSERT_EQUAL(app_lcd_init(), ESP_OK);
+
+    const lvgl_port_cfg_t lvgl_cfg = ESP_LVGL_PORT_INIT_CONFIG();
+    TEST_ASSERT_EQUAL(lvgl_port_init(&lvgl_cfg), ESP_OK);
+
+    for (int i = 0; i < sizeof(test_bench_cfgs) / sizeof(test_bench_cfgs[0]); i++) {
+#if LVGL_VERSION_MAJOR == 8
+        /* Bytes are swapped by LVGL (LV_COLOR_16_SWAP) in LVGL8 */
+        if (!test_bench_cfgs[i].swap_bytes) {
+            continue;
+        }
+#endif
+        test_bench_run(&test_bench_cfgs[i]);
+    }
+
+    TEST_ASSERT_EQUAL(lvgl_port_deinit(), ESP_OK);
+    TEST_ASSERT_EQUAL(app_lcd_deinit(), ESP_OK);
+}
+
 void app_main(void)
 {
     printf("TEST ESP LVGL port\n\r");
@@ -0,0 +1,310 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_lvgl_port.h"
+
+#include "unity.h"
+
+/* Benchmark area size (pixels) */
+#define TEST_AREA_W         (320)
+#define TEST_AREA_H         (48)
+#define TEST_AREA_SIZE      (TEST_AREA_W * TEST_AREA_H)
+#define TEST_ITERATIONS     (50)
+
+static const char *TAG = "test_transform";
+
+static uint16_t *test_alloc(uint32_t caps)
+{
+    uint16_t *buf = heap_caps_malloc(TEST_AREA_SIZE * sizeof(uint16_t), caps);
+    TEST_ASSERT_NOT_NULL(buf);
+    return buf;
+}
+
+static void test_fill(uint16_t *buf)
+{
+    for (int i = 0; i < TEST_AREA_SIZE; i++) {
+        buf[i] = (uint16_t)(i * 7 + 3);
+    }
+}
+
+TEST_CASE("Transform RGB565 swap and rotation", "[lvgl port][transform]")
+{
+    uint16_t *src = test_alloc(MALLOC_CAP_DEFAULT);
+    uint16_t *dst = test_alloc(MALLOC_CAP_DEFAULT);
+    test_fill(src);
+
+    /* Swap twice returns original data */
+    memcpy(dst, src, TEST_AREA_SIZE * sizeof(uint16_t));
+    lvgl_port_transform_rgb565_swap(dst, TEST_AREA_SIZE);
+    TEST_ASSERT_EQUAL_HEX16((uint16_t)((src[1] << 8) | (src[1] >> 8)), dst[1]);
+    lvgl_port_transform_rgb565_swap(dst, TEST_AREA_SIZE);
+    TEST_ASSERT_EQUAL_HEX16_ARRAY(src, dst, TEST_AREA_SIZE);
+
+    /* Rotation 90: (x, y) -> (y, w - 1 - x) */
+    lvgl_port_transform_rgb565_rotate(src, dst, TEST_AREA_W, TEST_AREA_H, LV_DISPLAY_ROTATION_90, false);
+    TEST_ASSERT_EQUAL_HEX16(src[0], dst[(TEST_AREA_W - 1) * TEST_AREA_H]);
+    TEST_ASSERT_EQUAL_HEX16(src[TEST_AREA_W - 1], dst[0]);
+
+    /* Rotation 270: (x, y) -> (h - 1 - y, x) */
+    lvgl_port_transform_rgb565_rotate(src, dst, TEST_AREA_W, TEST_AREA_H, LV_DISPLAY_ROTATION_270, false);
+    TEST_ASSERT_EQUAL_HEX16(src[0], dst[TEST_AREA_H - 1]);
+    TEST_ASSERT_EQUAL_HEX16(src[TEST_AREA_SIZE - 1], dst[(TEST_AREA_W - 1) * TEST_AREA_H]);
+
+    /* Rotation 180 with swap */
+    lvgl_port_transform_rgb565_rotate(src, dst, TEST_AREA_W, TEST_AREA_H, LV_DISPLAY_ROTATION_180, true);
+    TEST_ASSERT_EQUAL_HEX16((uint16_t)((src[0] << 8) | (src[0] >> 8)), dst[TEST_AREA_SIZE - 1]);
+
+    free(src);
+    free(dst);
+}
+
+TEST_CASE("Transform RGB565 rotation in line strips", "[lvgl port][transform]")
+{
+    uint16_t *src = test_alloc(MALLOC_CAP_DEFAULT);
+    uint16_t *full = test_alloc(MALLOC_CAP_DEFAULT);
+    uint16_t *strip = test_alloc(MALLOC_CAP_DEFAULT);
+    test_fill(src);
+
+    /* Strips (the last one shorter) put together give the whole rotated area */
+    const lv_display_rotation_t rotations[] = {LV_DISPLAY_ROTATION_0, LV_DISPLAY_ROTATION_90, LV_DISPLAY_ROTATION_180, LV_DISPLAY_ROTATION_270};
+    for (size_t r = 0; r < sizeof(rotations) / sizeof(rotations[0]); r++) {
+        const bool transpose = (rotations[r] == LV_DISPLAY_ROTATION_90 || rotations[r] == LV_DISPLAY_ROTATION_270);
+        const int32_t out_w = (transpose ? TEST_AREA_H : TEST_AREA_W);
+        const int32_t out_h = (transpose ? TEST_AREA_W : TEST_AREA_H);
+        const int32_t lines = 7;
+
+        lvgl_port_transform_rgb565_rotate(src, full, TEST_AREA_W, TEST_AREA_H, rotations[r], true);
+        for (int32_t line = 0; line < out_h; line += lines) {
+            const int32_t cnt = (out_h - line < lines ? out_h - line : lines);
+            lvgl_port_transform_rgb565_rotate_lines(src, strip, TEST_AREA_W, TEST_AREA_H, rotations[r], true, line, lines);
+            TEST_ASSERT_EQUAL_HEX16_ARRAY(full + line * out_w, strip, cnt * out_w);
+        }
+    }
+
+    free(src);
+    free(full);
+    free(strip);
+}
+
+#if LVGL_VERSION_MAJOR >= 9
+static void test_rotate_lvgl(int32_t w, int32_t h)
+{
+    const size_t len = (size_t)w * h;
+    uint16_t *src = heap_caps_malloc(len * sizeof(uint16_t), MALLOC_CAP_DEFAULT);
+    uint16_t *dst = heap_caps_malloc(len * sizeof(uint16_t), MALLOC_CAP_DEFAULT);
+    uint16_t *ref = heap_caps_malloc(len * sizeof(uint16_t), MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_NOT_NULL(src);
+    TEST_ASSERT_NOT_NULL(dst);
+    TEST_ASSERT_NOT_NULL(ref);
+    for (size_t i = 0; i < len; i++) {
+        src[i] = (uint16_t)(i * 7 + 3);
+    }
+
+    /* Display rotation 90 is LVGL rotation 270 of the rendered area (and 270 is 90), see lvgl_port_flush_area */
+    const struct {
+        lv_display_rotation_t port;
+        lv_display_rotation_t lvgl;
+    } rotations[] = {
+        {LV_DISPLAY_ROTATION_90, LV_DISPLAY_ROTATION_270},
+        {LV_DISPLAY_ROTATION_180, LV_DISPLAY_ROTATION_180},
+        {LV_DISPLAY_ROTATION_270, LV_DISPLAY_ROTATION_90},
+    };
+    for (size_t r = 0; r < sizeof(rotations) / sizeof(rotations[0]); r++) {
+        const bool transpose = (rotations[r].port != LV_DISPLAY_ROTATION_180);
+        const uint32_t dst_stride = (transpose ? h : w) * sizeof(uint16_t);
+
+        lv_draw_sw_rotate(src, ref, w, h, w * sizeof(uint16_t), dst_stride, rotations[r].lvgl, LV_COLOR_FORMAT_RGB565);
+        lvgl_port_transform_rgb565_rotate(src, dst, w, h, rotations[r].port, false);
+        TEST_ASSERT_EQUAL_HEX16_ARRAY(ref, dst, len);
+
+        /* Fused swap gives the same pixels as LVGL rotation followed by LVGL swap */
+        lv_draw_sw_rgb565_swap(ref, len);
+        lvgl_port_transform_rgb565_rotate(src, dst, w, h, rotations[r].port, true);
+        TEST_ASSERT_EQUAL_HEX16_ARRAY(ref, dst, len);
+    }
+
+    free(src);
+    free(dst);
+    free(ref);
+}
+
+TEST_CASE("Transform RGB565 rotation matches LVGL", "[lvgl port][transform]")
+{
+    /* Even size, odd width, odd height, both odd and one line (tiles are not full) */
+    test_rotate_lvgl(TEST_AREA_W, TEST_AREA_H);
+    test_rotate_lvgl(37, 16);
+    test_rotate_lvgl(32, 23);
+    test_rotate_lvgl(17, 41);
+    test_rotate_lvgl(1, 5);
+}
+#endif
+
+TEST_CASE("Transform L8 to RGB565 by CLUT", "[lvgl port][transform]")
+{
+    uint16_t clut[256];
+    for (int i = 0; i < 256; i++) {
+        clut[i] = (uint16_t)(0xFFFF - i * 3);
+    }
+
+    /* Odd length covers the tail after four pixels loop */
+    const size_t len = 255;
+    uint8_t *src = malloc(len);
+    uint16_t *dst = test_alloc(MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_NOT_NULL(src);
+    for (size_t i = 0; i < len; i++) {
+        src[i] = (uint8_t)(255 - i);
+    }
+
+    lvgl_port_transform_l8_to_rgb565(src, dst, len, clut);
+    for (size_t i = 0; i < len; i++) {
+        TEST_ASSERT_EQUAL_HEX16(clut[src[i]], dst[i]);
+    }
+
+    free(src);
+    free(dst);
+}
+
+TEST_CASE("Transform RGB565 solid color detection", "[lvgl port][transform]")
+{
+    uint16_t *buf = test_alloc(MALLOC_CAP_DEFAULT);
+    for (int i = 0; i < TEST_AREA_SIZE; i++) {
+        buf[i] = 0x1234;
+    }
+
+    /* Aligned and unaligned start, odd length covers the last pixel */
+    uint16_t color = 0;
+    TEST_ASSERT_TRUE(lvgl_port_transform_rgb565_is_solid(buf, TEST_AREA_SIZE, &color));
+    TEST_ASSERT_EQUAL_HEX16(0x1234, color);
+    TEST_ASSERT_TRUE(lvgl_port_transform_rgb565_is_solid(buf + 1, TEST_AREA_SIZE - 2, NULL));
+
+    /* One different pixel in the head, middle and tail */
+    const size_t diffs[] = {0, 1, TEST_AREA_SIZE / 2 + 1, TEST_AREA_SIZE - 1};
+    for (size_t i = 0; i < sizeof(diffs) / sizeof(diffs[0]); i++) {
+        buf[diffs[i]] = 0x1235;
+        TEST_ASSERT_FALSE(lvgl_port_transform_rgb565_is_solid(buf, TEST_AREA_SIZE, NULL));
+        buf[diffs[i]] = 0x1234;
+    }
+    buf[TEST_AREA_SIZE - 2] = 0x4321;
+    TEST_ASSERT_FALSE(lvgl_port_transform_rgb565_is_solid(buf + 1, TEST_AREA_SIZE - 2, NULL));
+
+    free(buf);
+}
+
+TEST_CASE("Transform RGB565 scale and crop", "[lvgl port][transform]")
+{
+    /* 320x48 source into 80x40 destination: cropped to 96x48 in the center, then scaled by 1.2 */
+    uint16_t *src = test_alloc(MALLOC_CAP_DEFAULT);
+    uint16_t *dst = test_alloc(MALLOC_CAP_DEFAULT);
+    for (int i = 0; i < TEST_AREA_SIZE; i++) {
+        src[i] = 0xF81F;
+    }
+
+    /* Uniform color is kept by interpolation, swap is done on source pixels */
+    lvgl_port_transform_rgb565_scale(src, TEST_AREA_W, TEST_AREA_H, dst, 80, 40, true, false);
+    for (int i = 0; i < 80 * 40; i++) {
+        TEST_ASSERT_EQUAL_HEX16(0xF81F, dst[i]);
+    }
+    lvgl_port_transform_rgb565_scale(src, TEST_AREA_W, TEST_AREA_H, dst, 80, 40, false, true);
+    for (int i = 0; i < 80 * 40; i++) {
+        TEST_ASSERT_EQUAL_HEX16(0x1FF8, dst[i]);
+    }
+
+    /* Nearest pixel of 2x downscale without crop takes every second pixel (pixel centers) */
+    test_fill(src);
+    lvgl_port_transform_rgb565_scale(src, TEST_AREA_W, TEST_AREA_H, dst, TEST_AREA_W / 2, TEST_AREA_H / 2, false, false);
+    for (int y = 0; y < TEST_AREA_H / 2; y++) {
+        for (int x = 0; x < TEST_AREA_W / 2; x++) {
+            TEST_ASSERT_EQUAL_HEX16(src[(2 * y + 1) * TEST_AREA_W + 2 * x + 1], dst[y * (TEST_AREA_W / 2) + x]);
+        }
+    }
+
+    /* Bilinear between black and white gives gray */
+    const uint16_t bw[2] = {0x0000, 0xFFFF};
+    lvgl_port_transform_rgb565_scale(bw, 2, 1, dst, 4, 2, true, false);
+    TEST_ASSERT_EQUAL_HEX16(0x0000, dst[0]);
+    TEST_ASSERT_EQUAL_HEX16(0xFFFF, dst[3]);
+    TEST_ASSERT(dst[1] > 0x0000 && dst[1] < dst[2] && dst[2] < 0xFFFF);
+
+    free(src);
+    free(dst);
+}
+
+static void test_benchmark(const char *name, uint32_t caps)
+{
+    uint16_t *src = test_alloc(caps);
+    uint16_t *dst = test_alloc(caps);
+    test_fill(src);
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        lvgl_port_transform_rgb565_swap(src, TEST_AREA_SIZE);
+    }
+    int64_t port_swap = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        lvgl_port_transform_rgb565_rotate(src, dst, TEST_AREA_W, TEST_AREA_H, LV_DISPLAY_ROTATION_90, false);
+    }
+    int64_t port_rotate = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        lvgl_port_transform_rgb565_rotate(src, dst, TEST_AREA_W, TEST_AREA_H, LV_DISPLAY_ROTATION_90, true);
+    }
+    int64_t port_rotate_swap = esp_timer_get_time() - start;
+
+    ESP_LOGI(TAG, "[%s] LVGL port: swap %lld us, rotate 90 %lld us, rotate 90 + swap %lld us", name,
+             port_swap / TEST_ITERATIONS, port_rotate / TEST_ITERATIONS, port_rotate_swap / TEST_ITERATIONS);
+
+#if LVGL_VERSION_MAJOR >= 9
+    const uint32_t w_stride = TEST_AREA_W * sizeof(uint16_t);
+    const uint32_t h_stride = TEST_AREA_H * sizeof(uint16_t);
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        lv_draw_sw_rgb565_swap(src, TEST_AREA_SIZE);
+    }
+    int64_t lv_swap = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        lv_draw_sw_rotate(src, dst, TEST_AREA_W, TEST_AREA_H, w_stride, h_stride, LV_DISPLAY_ROTATION_270, LV_COLOR_FORMAT_RGB565);
+    }
+    int64_t lv_rotate = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        lv_draw_sw_rotate(src, dst, TEST_AREA_W, TEST_AREA_H, w_stride, h_stride, LV_DISPLAY_ROTATION_270, LV_COLOR_FORMAT_RGB565);
+        lv_draw_sw_rgb565_swap(dst, TEST_AREA_SIZE);
+    }
+    int64_t lv_rotate_swap = esp_timer_get_time() - start;
+
+    ESP_LOGI(TAG, "[%s] LVGL SW:   swap %lld us, rotate 90 %lld us, rotate 90 + swap %lld us", name,
+             lv_swap / TEST_ITERATIONS, lv_rotate / TEST_ITERATIONS, lv_rotate_swap / TEST_ITERATIONS);
+
+    /* Rotation and swap in one pass must be faster than LVGL rotation followed by LVGL swap */
+    TEST_ASSERT_LESS_THAN_UINT32((uint32_t)lv_rotate_swap, (uint32_t)port_rotate_swap);
+    if (caps & MALLOC_CAP_SPIRAM) {
+        /* Tiled transpose keeps PSRAM lines in cache */
+        TEST_ASSERT_LESS_THAN_UINT32((uint32_t)lv_rotate, (uint32_t)port_rotate);
+    }
+#endif
+
+    free(src);
+    free(dst);
+}
+
+TEST_CASE("Benchmark transform RGB565", "[lvgl port][transform][benchmark]")
+{
+    test_benchmark("SRAM", MALLOC_CAP_INTERNAL);
+#if CONFIG_SPIRAM
+    test_benchmark("PSRAM", MALLOC_CAP_SPIRAM);
+#endif
+}
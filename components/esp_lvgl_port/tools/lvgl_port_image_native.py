@@ -0,0 +1,200 @@
+#!/usr/bin/env python
+#
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Display-native options of lvgl_port_create_c_image (see project_include.cmake):
+#   rotate   - rotate PNG image before the conversion, the same way as LVGL port rotates the rendered screen
+#   finalize - swap bytes of RGB565 pixels and place the image into a dedicated flash section
+#   atlas    - pack PNG icons of a directory into one atlas image and generate its index (lvgl_port_create_c_atlas)
+
+import argparse
+import math
+import os
+import re
+import sys
+
+# Bytes per pixel of the color formats, which allow sub-images addressed by the atlas stride
+ATLAS_FORMATS = {'L8': 1, 'A8': 1, 'RGB565': 2, 'RGB888': 3, 'XRGB8888': 4, 'ARGB8888': 4}
+
+
+def rotate(src, dst, rotation):
+    import png
+    w, h, rows, _ = png.Reader(filename=src).asRGBA8()
+    px = [list(zip(*[iter(row)] * 4)) for row in rows]
+    if rotation == 90:
+        # (x, y) -> (y, w - 1 - x)
+        out = [[px[y][w - 1 - r] for y in range(h)] for r in range(w)]
+    elif rotation == 180:
+        out = [list(reversed(row)) for row in reversed(px)]
+    elif rotation == 270:
+        # (x, y) -> (h - 1 - y, x)
+        out = [[px[h - 1 - c][r] for c in range(h)] for r in range(w)]
+    else:
+        out = px
+    flat = [[v for p in row for v in p] for row in out]
+    with open(dst, 'wb') as f:
+        png.Writer(width=len(out[0]), height=len(out), alpha=True, greyscale=False).write(f, flat)
+
+
+def swap_bytes(text):
+    # Only the pixel plane of RGB565 formats is swapped, alpha plane of RGB565A8 follows it
+    cf = re.search(r'\.header\.cf\s*=\s*(LV_COLOR_FORMAT_\w+)', text)
+    if cf is None or cf.group(1) not in ('LV_COLOR_FORMAT_RGB565', 'LV_COLOR_FORMAT_RGB565A8'):
+        raise ValueError('Byte swap needs RGB565 or RGB565A8 image')
+    if re.search(r'\.header\.flags\s*=\s*LV_IMAGE_FLAGS_COMPRESSED', text):
+        raise ValueError('Byte swap of compressed image is not possible')
+    h = int(re.search(r'\.header\.h\s*=\s*(\d+)', text).group(1))
+    stride = int(re.search(r'\.header\.stride\s*=\s*(\d+)', text).group(1))
+
+    array = re.search(r'(uint8_t\s+\w+\[\]\s*=\s*\{)(.*?)(\};)', text, re.S)
+    data = [int(v, 16) for v in re.findall(r'0x[0-9a-fA-F]{2}', array.group(2))]
+    for i in range(0, min(h * stride, len(data)) - 1, 2):
+        data[i], data[i + 1] = data[i + 1], data[i]
+
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append('    ' + ','.join('0x{:02x}'.format(v) for v in data[i:i + 16]) + ',')
+    return text[:array.start(2)] + '\n' + '\n'.join(lines) + '\n' + text[array.end(2):]
+
+
+def place_section(text, section, align):
+    # Generated files define empty LV_ATTRIBUTE_IMAGE_<NAME> (LVGL 9) or LV_ATTRIBUTE_IMG_<NAME> (LVGL 8) when it is not defined
+    attr = re.search(r'#ifndef\s+(LV_ATTRIBUTE_IMA?GE?_\w+)', text)
+    if attr is None:
+        raise ValueError('Image attribute not found')
+    define = '#define {} __attribute__((section(".rodata.{}"), aligned({})))\n'.format(attr.group(1), section, max(align, 4))
+    return text[:attr.start()] + define + text[attr.start():]
+
+
+def finalize(path, swap, section, align):
+    with open(path) as f:
+        text = f.read()
+    if swap:
+        text = swap_bytes(text)
+    if section:
+        text = place_section(text, section, align)
+    with open(path, 'w') as f:
+        f.write(text)
+
+
+def c_name(name):
+    name = re.sub(r'[^0-9a-zA-Z_]', '_', name).lower()
+    return '_' + name if name[0].isdigit() else name
+
+
+def pack(sizes, width, step):
+    # Shelf packing: the highest icons first, each shelf is as high as its first icon
+    order = sorted(range(len(sizes)), key=lambda i: (-sizes[i][1], -sizes[i][0], i))
+    pos = [None] * len(sizes)
+    x = y = shelf_h = 0
+    for i in order:
+        w, h = sizes[i]
+        if x > 0 and x + w > width:
+            x, y, shelf_h = 0, y + shelf_h, 0
+        pos[i] = (x, y)
+        x += (w + step - 1) // step * step
+        shelf_h = max(shelf_h, h)
+    return pos, y + shelf_h
+
+
+def atlas(src_dir, png_out, index_dir, name, cf, align, width):
+    import png
+    if cf not in ATLAS_FORMATS:
+        raise ValueError('Atlas needs one of {} color formats'.format(', '.join(ATLAS_FORMATS)))
+    files = sorted(f for f in os.listdir(src_dir) if f.lower().endswith('.png'))
+    if not files:
+        raise ValueError('No PNG image in {}'.format(src_dir))
+    names = [c_name(os.path.splitext(f)[0]) for f in files]
+    if len(set(names)) != len(names):
+        raise ValueError('Icon names are not unique in {}'.format(src_dir))
+
+    icons = []
+    for f in files:
+        w, h, rows, _ = png.Reader(filename=os.path.join(src_dir, f)).asRGBA8()
+        icons.append((w, h, [bytes(row) for row in rows]))
+
+    # Columns of the sub-images are aligned, the rows by the stride of the atlas (STRIDE_ALIGN)
+    bpp = ATLAS_FORMATS[cf]
+    step = align // math.gcd(align, bpp)
+    max_w = max(w for w, _, _ in icons)
+    if not width:
+        area = sum(((w + step - 1) // step * step) * h for w, h, _ in icons)
+        width = int(math.ceil(math.sqrt(area)))
+    width = max(width, max_w)
+    pos, height = pack([(w, h) for w, h, _ in icons], width, step)
+    width = max(x + w for (x, _), (w, _, _) in zip(pos, icons))
+    if width > 0xFFFF or height > 0xFFFF:
+        raise ValueError('Atlas is too large ({}x{})'.format(width, height))
+
+    sheet = [bytearray(width * 4) for _ in range(height)]
+    for (x, y), (w, h, rows) in zip(pos, icons):
+        for r in range(h):
+            sheet[y + r][x * 4:(x + w) * 4] = rows[r]
+    with open(png_out, 'wb') as f:
+        png.Writer(width=width, height=height, alpha=True, greyscale=False).write(f, sheet)
+
+    # Index is sorted by name for lvgl_port_atlas_find()
+    entries = sorted(zip(names, pos, icons), key=lambda e: e[0])
+    with open(os.path.join(index_dir, name + '_atlas.h'), 'w') as f:
+        f.write('/* Generated by lvgl_port_create_c_atlas, do not edit */\n\n#pragma once\n\n')
+        f.write('#include "esp_lvgl_port_atlas.h"\n\n')
+        f.write('#if LVGL_VERSION_MAJOR < 9\n#error "Image atlas needs LVGL 9"\n#endif\n\n')
+        f.write('#ifdef __cplusplus\nextern "C" {\n#endif\n\n')
+        f.write('extern const lv_image_dsc_t {};\n'.format(name))
+        f.write('extern const lvgl_port_atlas_t {}_atlas;\n\n'.format(name))
+        f.write('/* Indexes of the sub-images for lvgl_port_atlas_get() */\nenum {\n')
+        for i, (icon, _, _) in enumerate(entries):
+            f.write('    {}_{} = {},\n'.format(name.upper(), icon.upper(), i))
+        f.write('    {}_COUNT = {},\n}};\n\n'.format(name.upper(), len(entries)))
+        f.write('#ifdef __cplusplus\n}\n#endif\n')
+    with open(os.path.join(index_dir, name + '_atlas.c'), 'w') as f:
+        f.write('/* Generated by lvgl_port_create_c_atlas, do not edit */\n\n')
+        f.write('#include "{}_atlas.h"\n\n'.format(name))
+        f.write('static const lvgl_port_atlas_rect_t {}_rects[] = {{\n'.format(name))
+        for icon, (x, y), (w, h, _) in entries:
+            f.write('    {{ .name = "{}", .x = {}, .y = {}, .w = {}, .h = {} }},\n'.format(icon, x, y, w, h))
+        f.write('};\n\n')
+        f.write('const lvgl_port_atlas_t {0}_atlas = {{\n    .image = &{0},\n    .rects = {0}_rects,\n    .count = {1},\n}};\n'
+                .format(name, len(entries)))
+    print('Atlas {}: {} icons, {}x{} px'.format(name, len(entries), width, height))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Display-native options of LVGL C array images')
+    sub = parser.add_subparsers(dest='cmd', required=True)
+    p = sub.add_parser('rotate', help='Rotate PNG image')
+    p.add_argument('src')
+    p.add_argument('dst')
+    p.add_argument('rotation', type=int, choices=[0, 90, 180, 270])
+    p = sub.add_parser('finalize', help='Post-process generated C file')
+    p.add_argument('path')
+    p.add_argument('--swap', action='store_true', help='Swap bytes of RGB565 pixels')
+    p.add_argument('--section', help='Place data into .rodata.<SECTION>')
+    p.add_argument('--align', type=int, default=4, help='Alignment of the data in the section [bytes]')
+    p = sub.add_parser('atlas', help='Pack PNG icons into atlas image and generate its index')
+    p.add_argument('src_dir')
+    p.add_argument('png_out', help='Atlas PNG image, its file name is the name of the C variable')
+    p.add_argument('index_dir', help='Output directory of <name>_atlas.h and <name>_atlas.c')
+    p.add_argument('--cf', required=True, help='Color format of the atlas')
+    p.add_argument('--align', type=int, default=1, help='Alignment of the sub-image columns [bytes]')
+    p.add_argument('--width', type=int, default=0, help='Width of the atlas (0: about square)')
+    args = parser.parse_args()
+
+    try:
+        if args.cmd == 'rotate':
+            rotate(args.src, args.dst, args.rotation)
+        elif args.cmd == 'atlas':
+            name = c_name(os.path.splitext(os.path.basename(args.png_out))[0])
+            atlas(args.src_dir, args.png_out, args.index_dir, name, args.cf, args.align, args.width)
+        else:
+            finalize(args.path, args.swap, args.section, args.align)
+    except (ValueError, AttributeError, IOError) as e:
+        print('lvgl_port_image_native: {}'.format(e), file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
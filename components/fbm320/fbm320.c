@@ -6,6 +6,7 @@
 
 #include <stdio.h>
 #include "driver/i2c.h"
+#include "esp_timer.h"
 #include "fbm320.h"
 
 // FBM320 registers
@@ -17,22 +18,43 @@
 #define FBM320_CALIBRATION_DATA_2      0xF1u // 1 byte
 #define FBM320_CALIBRATION_DATA_LEN    20u   // 20 bytes together
 
+#define FBM320_CMD_MEAS_TEMPERATURE    0x2Eu
+
+// Conversion times [us]
+#define FBM320_CONV_TIME_TEMPERATURE   10000
+#define FBM320_CONV_TIME_PRESSURE      10000
+#define FBM320_CONV_TIME_PRESSURE_8192 20000
+
 typedef struct {
     int32_t C0, C1, C2, C3, C4, C5, C6, C7, C8, C9, C10, C11, C12, C13;
 } fbm320_calibration_data_t;
 
+typedef enum {
+    FBM320_STATE_IDLE = 0,
+    FBM320_STATE_TEMPERATURE,   /* Temperature conversion is running */
+    FBM320_STATE_PRESSURE,      /* Pressure conversion is running */
+} fbm320_state_t;
+
 typedef struct {
     i2c_port_t bus;
     uint16_t dev_addr;
+    uint8_t cmd_buf[I2C_LINK_RECOMMENDED_SIZE(2)]; /* Command link of the device, no heap allocation per access */
     bool initialized;
     fbm320_calibration_data_t calibration_data;
+    fbm320_state_t state;
+    fbm320_measure_mode_t meas_mode;
+    int32_t temperature_raw;
+    int64_t ready_time;             /* esp_timer time [us] when the running conversion is finished */
+    esp_timer_handle_t timer;       /* Created on first use of fbm320_start_measurement_cb */
+    fbm320_data_cb_t data_cb;
+    void *user_ctx;
 } fbm320_dev_t;
 
 static esp_err_t fbm320_write(fbm320_handle_t sensor, const uint8_t reg_start_addr, const uint8_t *const data_buf, const uint8_t data_len)
 {
     fbm320_dev_t *sens = (fbm320_dev_t *) sensor;
     esp_err_t  ret;
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(sens->cmd_buf, sizeof(sens->cmd_buf));
     ret = i2c_master_start(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_write_byte(cmd, sens->dev_addr | I2C_MASTER_WRITE, true);
@@ -44,7 +66,7 @@ static esp_err_t fbm320_write(fbm320_handle_t sensor, const uint8_t reg_start_ad
     ret = i2c_master_stop(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_cmd_begin(sens->bus, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
+    i2c_cmd_link_delete_static(cmd);
 
     return ret;
 }
@@ -53,7 +75,7 @@ static esp_err_t fbm320_read(fbm320_handle_t sensor, const uint8_t reg_start_add
 {
     fbm320_dev_t *sens = (fbm320_dev_t *) sensor;
     esp_err_t ret;
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(sens->cmd_buf, sizeof(sens->cmd_buf));
     ret = i2c_master_start(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_write_byte(cmd, sens->dev_addr | I2C_MASTER_WRITE, true);
@@ -69,7 +91,7 @@ static esp_err_t fbm320_read(fbm320_handle_t sensor, const uint8_t reg_start_add
     ret = i2c_master_stop(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_cmd_begin(sens->bus, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
+    i2c_cmd_link_delete_static(cmd);
 
     return ret;
 }
@@ -86,6 +108,10 @@ fbm320_handle_t fbm320_create(i2c_port_t port, const uint16_t dev_addr)
 void fbm320_delete(fbm320_handle_t sensor)
 {
     fbm320_dev_t *sens = (fbm320_dev_t *) sensor;
+    if (sens->timer) {
+        esp_timer_stop(sens->timer);
+        esp_timer_delete(sens->timer);
+    }
     free(sens);
 }
 
@@ -128,7 +154,7 @@ esp_err_t fbm320_init(fbm320_handle_t sensor)
     sens->calibration_data.C12 = ((R[0] & 0x0C) << 1) | (R[7] & 7);
 
     // first dummy read
-    uint8_t cmd = 0x2e;
+    uint8_t cmd = FBM320_CMD_MEAS_TEMPERATURE;
     ret = fbm320_write(sensor, FBM320_CONFIG_REG, &cmd, 1);
     if (ESP_OK != ret) {
         return ret;
@@ -147,46 +173,11 @@ static esp_err_t fbm320_read_result(fbm320_handle_t sensor, int32_t *const resul
     return ret;
 }
 
-esp_err_t fbm320_get_data(fbm320_handle_t sensor, const fbm320_measure_mode_t meas_mode, int32_t *const temperature, int32_t *const pressure)
+static void fbm320_calculate(const fbm320_dev_t *sens, const int32_t temperature_raw, const int32_t pressure_raw, int32_t *const temperature, int32_t *const pressure)
 {
-    esp_err_t ret;
-    fbm320_dev_t *sens = (fbm320_dev_t *) sensor;
-    if (!sens->initialized) {
-        return ESP_ERR_INVALID_STATE;
-    }
-
-    int32_t temperature_raw, pressure_raw;
-
-    // trigger TEMPERATURE measurement and wait for result
-    uint8_t cmd = 0x2e;
-    ret = fbm320_write(sensor, FBM320_CONFIG_REG, &cmd, 1);
-    if (ESP_OK != ret) {
-        return ret;
-    }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
-    ret = fbm320_read_result(sensor, &temperature_raw);
-    if (ESP_OK != ret) {
-        return ret;
-    }
-
-    // trigger PRESSURE  measurement and wait for result
-    ret = fbm320_write(sensor, FBM320_CONFIG_REG, (uint8_t *)&meas_mode, 1);
-    if (ESP_OK != ret) {
-        return ret;
-    }
-    if (meas_mode == FBM320_MEAS_PRESS_OSR_8192) {
-        vTaskDelay(20 / portTICK_PERIOD_MS);
-    } else {
-        vTaskDelay(10 / portTICK_PERIOD_MS);
-    }
-    ret = fbm320_read_result(sensor, &pressure_raw);
-    if (ESP_OK != ret) {
-        return ret;
-    }
-
     int32_t X01, X02, X03, X11, X12, X13, X21, X22, X23, X24, X25, X26, X31, X32;
     int32_t PP1, PP2, PP3, PP4, CF, DT, DT2; // helper variables
-    fbm320_calibration_data_t *cal_data = &sens->calibration_data; // helper pointer
+    const fbm320_calibration_data_t *cal_data = &sens->calibration_data; // helper pointer
 
     DT = ((temperature_raw - 8388608) >> 4) + (cal_data->C0 << 4);
     X01 = (cal_data->C1 + 4459) * DT >> 1;
@@ -215,6 +206,123 @@ esp_err_t fbm320_get_data(fbm320_handle_t sensor, const fbm320_measure_mode_t me
     X31 = (((CF * cal_data->C10) >> 17) * PP4) >> 2;
     X32 = (((((CF * cal_data->C11) >> 15) * PP4) >> 18) * PP4);
     *pressure = ((X31 + X32) >> 15) + PP4 + 99880;
+}
+
+static esp_err_t fbm320_trigger(fbm320_dev_t *sens, const uint8_t cmd, const uint32_t conv_time)
+{
+    esp_err_t ret = fbm320_write(sens, FBM320_CONFIG_REG, &cmd, 1);
+    sens->ready_time = esp_timer_get_time() + conv_time;
+    return ret;
+}
+
+esp_err_t fbm320_start_measurement(fbm320_handle_t sensor, const fbm320_measure_mode_t meas_mode)
+{
+    fbm320_dev_t *sens = (fbm320_dev_t *) sensor;
+    if (!sens->initialized || sens->state != FBM320_STATE_IDLE) {
+        return ESP_ERR_INVALID_STATE;
+    }
 
+    // trigger TEMPERATURE measurement, PRESSURE follows from fbm320_poll_data
+    esp_err_t ret = fbm320_trigger(sens, FBM320_CMD_MEAS_TEMPERATURE, FBM320_CONV_TIME_TEMPERATURE);
+    if (ESP_OK != ret) {
+        return ret;
+    }
+    sens->meas_mode = meas_mode;
+    sens->state = FBM320_STATE_TEMPERATURE;
+    return ESP_OK;
+}
+
+esp_err_t fbm320_poll_data(fbm320_handle_t sensor, int32_t *const temperature, int32_t *const pressure)
+{
+    esp_err_t ret;
+    fbm320_dev_t *sens = (fbm320_dev_t *) sensor;
+    if (sens->state == FBM320_STATE_IDLE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (esp_timer_get_time() < sens->ready_time) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+
+    if (sens->state == FBM320_STATE_TEMPERATURE) {
+        // read TEMPERATURE and trigger PRESSURE measurement
+        ret = fbm320_read_result(sens, &sens->temperature_raw);
+        if (ESP_OK == ret) {
+            const uint32_t conv_time = (sens->meas_mode == FBM320_MEAS_PRESS_OSR_8192) ? FBM320_CONV_TIME_PRESSURE_8192 : FBM320_CONV_TIME_PRESSURE;
+            ret = fbm320_trigger(sens, (uint8_t)sens->meas_mode, conv_time);
+        }
+        if (ESP_OK != ret) {
+            sens->state = FBM320_STATE_IDLE;
+            return ret;
+        }
+        sens->state = FBM320_STATE_PRESSURE;
+        return ESP_ERR_NOT_FINISHED;
+    }
+
+    int32_t pressure_raw;
+    sens->state = FBM320_STATE_IDLE;
+    ret = fbm320_read_result(sens, &pressure_raw);
+    if (ESP_OK != ret) {
+        return ret;
+    }
+    fbm320_calculate(sens, sens->temperature_raw, pressure_raw, temperature, pressure);
+    return ESP_OK;
+}
+
+static void fbm320_timer_cb(void *arg)
+{
+    fbm320_dev_t *sens = (fbm320_dev_t *) arg;
+    int32_t temperature = 0, pressure = 0;
+
+    esp_err_t ret = fbm320_poll_data(sens, &temperature, &pressure);
+    if (ESP_ERR_NOT_FINISHED == ret) {
+        const int64_t wait = sens->ready_time - esp_timer_get_time();
+        esp_timer_start_once(sens->timer, wait > 0 ? wait : 0);
+        return;
+    }
+    sens->data_cb(sens, ret, temperature, pressure, sens->user_ctx);
+}
+
+esp_err_t fbm320_start_measurement_cb(fbm320_handle_t sensor, const fbm320_measure_mode_t meas_mode, fbm320_data_cb_t data_cb, void *user_ctx)
+{
+    fbm320_dev_t *sens = (fbm320_dev_t *) sensor;
+    if (!data_cb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!sens->timer) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = fbm320_timer_cb,
+            .arg = sens,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "fbm320",
+        };
+        esp_err_t ret = esp_timer_create(&timer_args, &sens->timer);
+        if (ESP_OK != ret) {
+            return ret;
+        }
+    }
+
+    esp_err_t ret = fbm320_start_measurement(sensor, meas_mode);
+    if (ESP_OK != ret) {
+        return ret;
+    }
+    sens->data_cb = data_cb;
+    sens->user_ctx = user_ctx;
+    return esp_timer_start_once(sens->timer, FBM320_CONV_TIME_TEMPERATURE);
+}
+
+esp_err_t fbm320_get_data(fbm320_handle_t sensor, const fbm320_measure_mode_t meas_mode, int32_t *const temperature, int32_t *const pressure)
+{
+    fbm320_dev_t *sens = (fbm320_dev_t *) sensor;
+    esp_err_t ret = fbm320_start_measurement(sensor, meas_mode);
+    if (ESP_OK != ret) {
+        return ret;
+    }
+
+    // wait for TEMPERATURE and PRESSURE results
+    while (ESP_ERR_NOT_FINISHED == (ret = fbm320_poll_data(sensor, temperature, pressure))) {
+        const int64_t wait = sens->ready_time - esp_timer_get_time();
+        const TickType_t ticks = pdMS_TO_TICKS((wait + 999) / 1000);
+        vTaskDelay(ticks ? ticks : 1);
+    }
     return ret;
 }
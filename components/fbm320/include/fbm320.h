@@ -37,6 +37,19 @@ typedef enum {
 
 typedef void *fbm320_handle_t;
 
+/**
+ * @brief Callback of finished measurement started by fbm320_start_measurement_cb()
+ *
+ * @note It is called from esp_timer task
+ *
+ * @param sensor object handle of FBM320
+ * @param result ESP_OK on success, error of the I2C transaction otherwise
+ * @param temperature Measured temperature in 0.01[deg C]
+ * @param pressure Measured pressure in [Pa]
+ * @param user_ctx User data passed to fbm320_start_measurement_cb()
+ */
+typedef void (*fbm320_data_cb_t)(fbm320_handle_t sensor, esp_err_t result, int32_t temperature, int32_t pressure, void *user_ctx);
+
 /**
  * @brief Create sensor object and return a sensor handle
  *
@@ -98,6 +111,62 @@ esp_err_t fbm320_init(fbm320_handle_t sensor);
  */
 esp_err_t fbm320_get_data(fbm320_handle_t sensor, const fbm320_measure_mode_t meas_mode, int32_t *const temperature, int32_t *const pressure);
 
+/**
+ * @brief Start measurement of temperature and pressure without waiting
+ *
+ * This function triggers temperature measurement and returns.
+ * Call fbm320_poll_data() to advance the measurement and get the result.
+ * Conversions of more sensors can run at the same time.
+ *
+ * @param sensor object handle of FBM320
+ * @param[in] meas_mode Oversampling ratio of pressure measurement
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_STATE Sensor is not initialized or a measurement is running
+ *     - ESP_FAIL Fail
+ */
+esp_err_t fbm320_start_measurement(fbm320_handle_t sensor, const fbm320_measure_mode_t meas_mode);
+
+/**
+ * @brief Poll measurement started by fbm320_start_measurement()
+ *
+ * This function never waits. When the temperature conversion is finished, it reads the result and triggers pressure measurement.
+ * When the pressure conversion is finished, it reads the result and calculates real pressure and temperature.
+ *
+ * @param sensor object handle of FBM320
+ * @param[out] temperature Measured temperature in 0.01[deg C]
+ * @param[out] pressure Measured pressure in [Pa]
+ *
+ * @return
+ *     - ESP_OK Success, measurement is finished
+ *     - ESP_ERR_NOT_FINISHED Conversion is running, poll again later
+ *     - ESP_ERR_INVALID_STATE No measurement was started
+ *     - ESP_FAIL Fail
+ */
+esp_err_t fbm320_poll_data(fbm320_handle_t sensor, int32_t *const temperature, int32_t *const pressure);
+
+/**
+ * @brief Start measurement of temperature and pressure and get the result in callback
+ *
+ * Steps of the measurement are driven by esp_timer at the end of each conversion, the caller doesn't wait or poll.
+ *
+ * @note I2C transactions are executed from esp_timer task
+ *
+ * @param sensor object handle of FBM320
+ * @param[in] meas_mode Oversampling ratio of pressure measurement
+ * @param[in] data_cb Callback of finished measurement
+ * @param[in] user_ctx User data passed to data_cb
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG data_cb is NULL
+ *     - ESP_ERR_INVALID_STATE Sensor is not initialized or a measurement is running
+ *     - ESP_ERR_NO_MEM No memory for the timer
+ *     - ESP_FAIL Fail
+ */
+esp_err_t fbm320_start_measurement_cb(fbm320_handle_t sensor, const fbm320_measure_mode_t meas_mode, fbm320_data_cb_t data_cb, void *user_ctx);
+
 #ifdef __cplusplus
 }
 #endif
@@ -5,16 +5,19 @@
  */
 
 #include <stdio.h>
+#include <inttypes.h>
 #include "unity.h"
 #include "driver/i2c.h"
 #include "fbm320.h"
 #include "esp_system.h"
 #include "esp_log.h"
+#include "i2c_bus_stats.h"
 
 #define I2C_MASTER_SCL_IO 26      /*!< gpio number for I2C master clock */
 #define I2C_MASTER_SDA_IO 25      /*!< gpio number for I2C master data  */
 #define I2C_MASTER_NUM I2C_NUM_0  /*!< I2C port number for master dev */
 #define I2C_MASTER_FREQ_HZ 100000 /*!< I2C master clock frequency */
+#define PERF_ITERATIONS 1000      /*!< Number of readings in performance test */
 
 static const char *TAG = "fbm320 test";
 static fbm320_handle_t fbm320 = NULL;
@@ -74,3 +77,51 @@ TEST_CASE("Sensor fbm320 test", "[fbm320][iot][sensor]")
     ret = i2c_driver_delete(I2C_MASTER_NUM);
     TEST_ASSERT_EQUAL(ESP_OK, ret);
 }
+
+TEST_CASE("Sensor fbm320 non-blocking test", "[fbm320][iot][sensor]")
+{
+    esp_err_t ret;
+    int32_t temperature, pressure;
+    uint32_t polls = 0;
+
+    i2c_sensor_fbm320_init();
+
+    ret = fbm320_init(fbm320);
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+
+    ret = fbm320_start_measurement(fbm320, FBM320_MEAS_PRESS_OSR_8192);
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, fbm320_start_measurement(fbm320, FBM320_MEAS_PRESS_OSR_8192));
+
+    while (ESP_ERR_NOT_FINISHED == (ret = fbm320_poll_data(fbm320, &temperature, &pressure))) {
+        polls++;
+        vTaskDelay(1);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, polls);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, fbm320_poll_data(fbm320, &temperature, &pressure));
+
+    ESP_LOGI(TAG, "pressure: %.1f kPa, temperature: %.1f degC (%"PRIu32" polls)", (float)pressure / 1000, (float)temperature / 100, polls);
+
+    fbm320_delete(fbm320);
+    ret = i2c_driver_delete(I2C_MASTER_NUM);
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+}
+
+static esp_err_t fbm320_perf_get_data(void *ctx)
+{
+    int32_t temperature, pressure;
+    return fbm320_get_data(fbm320, FBM320_MEAS_PRESS_OSR_1024, &temperature, &pressure);
+}
+
+TEST_CASE("Sensor fbm320 performance", "[fbm320][iot][sensor][perf]")
+{
+    i2c_sensor_fbm320_init();
+    TEST_ASSERT_EQUAL(ESP_OK, fbm320_init(fbm320));
+
+    /* Latency includes the conversion time of temperature and pressure */
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_perf_run("fbm320", "get_data_osr1024", fbm320_perf_get_data, NULL, PERF_ITERATIONS, 1, NULL));
+
+    fbm320_delete(fbm320);
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_driver_delete(I2C_MASTER_NUM));
+}
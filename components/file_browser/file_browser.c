@@ -0,0 +1,545 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "file_browser.h"
+
+static const char *TAG = "file_browser";
+
+#define FILE_BROWSER_PATH_MAX       (256)
+/* Entries array of the listing grows by this count */
+#define FILE_BROWSER_ENTRIES_STEP   (64)
+/* Waiting for the listing task to release a cached listing */
+#define FILE_BROWSER_SLOT_WAIT_MS   (1000)
+/* Rows out of the visible area (one above and one below) */
+#define FILE_BROWSER_SPARE_ROWS     (2)
+#define FILE_BROWSER_ROW_UNBOUND    (UINT32_MAX)
+
+typedef struct {
+    char *name;
+    bool is_dir;
+} file_browser_entry_t;
+
+/* Directory listing, filled by the listing task and read by LVGL task (both with the lock) */
+typedef struct {
+    char path[FILE_BROWSER_PATH_MAX];
+    file_browser_entry_t *entries;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t used_stamp;        /* For LRU selection of the cached listings */
+    bool valid;                 /* Path is set, listing can be shown */
+    bool done;                  /* Whole directory was read */
+    bool loading;               /* Queued or being read by the listing task */
+    bool cancel;                /* Entries are not needed anymore, the listing task stops reading */
+} file_browser_listing_t;
+
+struct file_browser_s {
+    file_browser_config_t config;
+    char root[FILE_BROWSER_PATH_MAX];
+
+    /* LVGL objects (LVGL task only) */
+    lv_obj_t *cont;
+    lv_obj_t *header;
+    lv_obj_t *list;
+    lv_obj_t *spacer;           /* The last pixel of the virtual list, it sets the scroll range */
+    lv_obj_t **rows;            /* Row for entry index i is rows[i % row_cnt] */
+    uint32_t *row_index;        /* Index bound to the row */
+    uint32_t row_cnt;
+    lv_timer_t *timer;          /* Updates the list while the directory is being read */
+    uint32_t shown_count;
+    bool has_back;
+
+    /* Cached listings */
+    file_browser_listing_t *listings;
+    file_browser_listing_t *current;
+    uint32_t stamp;
+
+    SemaphoreHandle_t lock;     /* Lock of listings */
+    SemaphoreHandle_t slot_free;/* Given by the listing task after each listing */
+    QueueHandle_t queue;        /* Listings to be read (NULL: exit) */
+    TaskHandle_t task;
+    SemaphoreHandle_t task_done;
+};
+
+/*******************************************************************************
+* Listing task
+*******************************************************************************/
+
+static void file_browser_listing_free(file_browser_listing_t *listing)
+{
+    for (uint32_t i = 0; i < listing->count; i++) {
+        free(listing->entries[i].name);
+    }
+    free(listing->entries);
+    listing->entries = NULL;
+    listing->count = 0;
+    listing->capacity = 0;
+}
+
+static void file_browser_read_dir(file_browser_handle_t fb, file_browser_listing_t *listing)
+{
+    DIR *d = opendir(listing->path);
+    if (d == NULL) {
+        ESP_LOGW(TAG, "Cannot open directory %s", listing->path);
+        return;
+    }
+
+    struct dirent *dir;
+    while (!listing->cancel && (dir = readdir(d)) != NULL) {
+        char *name = strdup(dir->d_name);
+        if (name == NULL) {
+            ESP_LOGE(TAG, "Not enough memory for directory listing");
+            break;
+        }
+
+        xSemaphoreTake(fb->lock, portMAX_DELAY);
+        if (listing->count == listing->capacity) {
+            file_browser_entry_t *entries = realloc(listing->entries, (listing->capacity + FILE_BROWSER_ENTRIES_STEP) * sizeof(file_browser_entry_t));
+            if (entries == NULL) {
+                xSemaphoreGive(fb->lock);
+                free(name);
+                ESP_LOGE(TAG, "Not enough memory for directory listing");
+                break;
+            }
+            listing->entries = entries;
+            listing->capacity += FILE_BROWSER_ENTRIES_STEP;
+        }
+        listing->entries[listing->count].name = name;
+        listing->entries[listing->count].is_dir = (dir->d_type == DT_DIR);
+        listing->count++;
+        xSemaphoreGive(fb->lock);
+    }
+    closedir(d);
+}
+
+static void file_browser_task(void *arg)
+{
+    file_browser_handle_t fb = arg;
+    file_browser_listing_t *listing;
+
+    while (xQueueReceive(fb->queue, &listing, portMAX_DELAY) == pdTRUE && listing != NULL) {
+        const uint32_t start = esp_log_timestamp();
+        file_browser_read_dir(fb, listing);
+
+        xSemaphoreTake(fb->lock, portMAX_DELAY);
+        if (listing->cancel) {
+            file_browser_listing_free(listing);
+            listing->valid = false;
+        } else {
+            listing->done = true;
+            ESP_LOGD(TAG, "%s: %"PRIu32" entries read in %"PRIu32" ms", listing->path, listing->count, esp_log_timestamp() - start);
+        }
+        listing->loading = false;
+        listing->cancel = false;
+        xSemaphoreGive(fb->lock);
+        xSemaphoreGive(fb->slot_free);
+    }
+
+    xSemaphoreGive(fb->task_done);
+    vTaskDelete(NULL);
+}
+
+/*******************************************************************************
+* Virtual list (LVGL task)
+*******************************************************************************/
+
+static void file_browser_row_set(lv_obj_t *row, const char *icon, const char *text)
+{
+    lv_image_set_src(lv_obj_get_child(row, 0), icon);
+    lv_label_set_text(lv_obj_get_child(row, 1), text);
+}
+
+/* Bind visible rows to entries, force: rebind also rows with the same index */
+static void file_browser_bind(file_browser_handle_t fb, bool force)
+{
+    const int32_t row_h = fb->config.row_height;
+
+    xSemaphoreTake(fb->lock, portMAX_DELAY);
+    const file_browser_listing_t *listing = fb->current;
+    const uint32_t count = (listing ? listing->count : 0);
+    const uint32_t total = count + (fb->has_back ? 1 : 0);
+
+    /* Scroll range of all rows */
+    if (total > 0) {
+        lv_obj_remove_flag(fb->spacer, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_set_y(fb->spacer, total * row_h - 1);
+    } else {
+        lv_obj_add_flag(fb->spacer, LV_OBJ_FLAG_HIDDEN);
+    }
+
+    const int32_t scroll_y = lv_obj_get_scroll_y(fb->list);
+    uint32_t first = (scroll_y > row_h ? scroll_y / row_h - 1 : 0);
+    for (uint32_t idx = first; idx < first + fb->row_cnt; idx++) {
+        const uint32_t slot = idx % fb->row_cnt;
+        lv_obj_t *row = fb->rows[slot];
+        if (idx >= total) {
+            lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
+            fb->row_index[slot] = FILE_BROWSER_ROW_UNBOUND;
+            continue;
+        }
+        if (fb->row_index[slot] == idx && !force) {
+            continue;
+        }
+        fb->row_index[slot] = idx;
+        lv_obj_remove_flag(row, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_set_y(row, idx * row_h);
+        if (fb->has_back && idx == 0) {
+            file_browser_row_set(row, LV_SYMBOL_LEFT, "Back");
+        } else {
+            const file_browser_entry_t *entry = &listing->entries[idx - (fb->has_back ? 1 : 0)];
+            const char *icon = LV_SYMBOL_DIRECTORY;
+            if (!entry->is_dir) {
+                icon = (fb->config.icon_cb ? fb->config.icon_cb(entry->name, fb->config.user_ctx) : LV_SYMBOL_FILE);
+            }
+            file_browser_row_set(row, icon, entry->name);
+        }
+    }
+    fb->shown_count = count;
+    xSemaphoreGive(fb->lock);
+}
+
+/* Path in the header, "..." while the directory is being read */
+static void file_browser_header_update(file_browser_handle_t fb, bool done)
+{
+    lv_label_set_text_fmt(fb->header, "%s%s", fb->current ? fb->current->path : "", done ? "" : " ...");
+}
+
+static void file_browser_timer_cb(lv_timer_t *timer)
+{
+    file_browser_handle_t fb = lv_timer_get_user_data(timer);
+
+    xSemaphoreTake(fb->lock, portMAX_DELAY);
+    const bool done = (fb->current == NULL || fb->current->done);
+    const bool changed = (fb->current && fb->current->count != fb->shown_count);
+    xSemaphoreGive(fb->lock);
+
+    if (changed) {
+        file_browser_bind(fb, false);
+    }
+    if (done) {
+        file_browser_header_update(fb, true);
+        lv_timer_pause(fb->timer);
+    }
+}
+
+static void file_browser_scroll_cb(lv_event_t *e)
+{
+    file_browser_bind(lv_event_get_user_data(e), false);
+}
+
+static void file_browser_parent_path(char *path)
+{
+    char *slash = strrchr(path, '/');
+    if (slash) {
+        *slash = '\0';
+    }
+}
+
+static void file_browser_row_cb(lv_event_t *e)
+{
+    file_browser_handle_t fb = lv_event_get_user_data(e);
+    lv_obj_t *row = lv_event_get_current_target(e);
+    char path[FILE_BROWSER_PATH_MAX];
+
+    uint32_t idx = FILE_BROWSER_ROW_UNBOUND;
+    for (uint32_t i = 0; i < fb->row_cnt; i++) {
+        if (fb->rows[i] == row) {
+            idx = fb->row_index[i];
+        }
+    }
+    if (idx == FILE_BROWSER_ROW_UNBOUND || fb->current == NULL) {
+        return;
+    }
+
+    strlcpy(path, fb->current->path, sizeof(path));
+    if (fb->has_back && idx == 0) {
+        file_browser_parent_path(path);
+        file_browser_open(fb, path);
+        return;
+    }
+
+    xSemaphoreTake(fb->lock, portMAX_DELAY);
+    const uint32_t entry_idx = idx - (fb->has_back ? 1 : 0);
+    if (entry_idx >= fb->current->count) {
+        xSemaphoreGive(fb->lock);
+        return;
+    }
+    const file_browser_entry_t *entry = &fb->current->entries[entry_idx];
+    const bool is_dir = entry->is_dir;
+    strlcat(path, "/", sizeof(path));
+    strlcat(path, entry->name, sizeof(path));
+    xSemaphoreGive(fb->lock);
+
+    if (is_dir) {
+        file_browser_open(fb, path);
+    } else if (fb->config.select_cb) {
+        fb->config.select_cb(fb, path, fb->config.user_ctx);
+    }
+}
+
+static void file_browser_show(file_browser_handle_t fb, file_browser_listing_t *listing)
+{
+    fb->current = listing;
+    fb->has_back = (strcmp(listing->path, fb->root) != 0);
+    fb->shown_count = 0;
+    lv_obj_scroll_to_y(fb->list, 0, LV_ANIM_OFF);
+    file_browser_bind(fb, true);
+
+    xSemaphoreTake(fb->lock, portMAX_DELAY);
+    const bool done = listing->done;
+    xSemaphoreGive(fb->lock);
+    file_browser_header_update(fb, done);
+    if (done) {
+        lv_timer_pause(fb->timer);
+    } else {
+        lv_timer_resume(fb->timer);
+    }
+}
+
+/* Take listing for the path (fresh: it must be read), lock must be taken */
+static file_browser_listing_t *file_browser_listing_get(file_browser_handle_t fb, const char *path, bool *fresh)
+{
+    *fresh = false;
+    file_browser_listing_t *lru = NULL;
+    for (uint32_t i = 0; i < fb->config.cache_dirs; i++) {
+        file_browser_listing_t *listing = &fb->listings[i];
+        if (listing->valid && !listing->cancel && strcmp(listing->path, path) == 0) {
+            return listing;
+        }
+        if (!listing->loading && (lru == NULL || listing->used_stamp < lru->used_stamp)) {
+            lru = listing;
+        }
+    }
+    if (lru == NULL) {
+        return NULL;
+    }
+
+    /* Read the directory into the least recently used listing */
+    file_browser_listing_free(lru);
+    strlcpy(lru->path, path, sizeof(lru->path));
+    lru->valid = true;
+    lru->done = false;
+    lru->loading = true;
+    *fresh = true;
+    return lru;
+}
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+esp_err_t file_browser_create(const file_browser_config_t *config, file_browser_handle_t *ret_handle)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(config && config->parent && config->root && ret_handle, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+    ESP_RETURN_ON_FALSE(config->row_height > 0 && config->cache_dirs > 0, ESP_ERR_INVALID_ARG, TAG, "invalid configuration");
+
+    file_browser_handle_t fb = calloc(1, sizeof(struct file_browser_s));
+    ESP_RETURN_ON_FALSE(fb, ESP_ERR_NO_MEM, TAG, "Not enough memory for file browser");
+    fb->config = *config;
+    strlcpy(fb->root, config->root, sizeof(fb->root));
+    fb->config.root = fb->root;
+
+    fb->listings = calloc(config->cache_dirs, sizeof(file_browser_listing_t));
+    fb->lock = xSemaphoreCreateMutex();
+    fb->slot_free = xSemaphoreCreateBinary();
+    fb->task_done = xSemaphoreCreateBinary();
+    fb->queue = xQueueCreate(config->cache_dirs, sizeof(file_browser_listing_t *));
+    ESP_GOTO_ON_FALSE(fb->listings && fb->lock && fb->slot_free && fb->task_done && fb->queue, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for file browser");
+
+    /* Visible rows and spare ones, the list is never higher than the display */
+    fb->row_cnt = lv_display_get_vertical_resolution(lv_obj_get_display(config->parent)) / config->row_height + 1 + FILE_BROWSER_SPARE_ROWS;
+    fb->rows = calloc(fb->row_cnt, sizeof(lv_obj_t *));
+    fb->row_index = malloc(fb->row_cnt * sizeof(uint32_t));
+    ESP_GOTO_ON_FALSE(fb->rows && fb->row_index, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for file browser rows");
+
+    /* Header with path and the list below it */
+    fb->cont = lv_obj_create(config->parent);
+    lv_obj_set_size(fb->cont, lv_pct(100), lv_pct(100));
+    lv_obj_set_flex_flow(fb->cont, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_style_pad_all(fb->cont, 0, 0);
+    lv_obj_set_style_pad_row(fb->cont, 0, 0);
+    lv_obj_set_style_border_width(fb->cont, 0, 0);
+    lv_obj_remove_flag(fb->cont, LV_OBJ_FLAG_SCROLLABLE);
+
+    fb->header = lv_label_create(fb->cont);
+    lv_obj_set_width(fb->header, lv_pct(100));
+    lv_label_set_long_mode(fb->header, LV_LABEL_LONG_DOT);
+
+    /* Rows are placed by the entry index, not by layout */
+    fb->list = lv_list_create(fb->cont);
+    lv_obj_set_width(fb->list, lv_pct(100));
+    lv_obj_set_flex_grow(fb->list, 1);
+    lv_obj_set_layout(fb->list, LV_LAYOUT_NONE);
+    lv_obj_set_scroll_dir(fb->list, LV_DIR_VER);
+    lv_obj_add_event_cb(fb->list, file_browser_scroll_cb, LV_EVENT_SCROLL, fb);
+
+    fb->spacer = lv_obj_create(fb->list);
+    lv_obj_remove_style_all(fb->spacer);
+    lv_obj_set_size(fb->spacer, 1, 1);
+    lv_obj_remove_flag(fb->spacer, LV_OBJ_FLAG_CLICKABLE);
+
+    for (uint32_t i = 0; i < fb->row_cnt; i++) {
+        lv_obj_t *row = lv_list_add_button(fb->list, LV_SYMBOL_FILE, "");
+        lv_obj_set_height(row, config->row_height);
+        lv_label_set_long_mode(lv_obj_get_child(row, 1), LV_LABEL_LONG_DOT);
+        lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_add_event_cb(row, file_browser_row_cb, LV_EVENT_CLICKED, fb);
+        if (config->group) {
+            lv_group_add_obj(config->group, row);
+        }
+        fb->rows[i] = row;
+        fb->row_index[i] = FILE_BROWSER_ROW_UNBOUND;
+    }
+
+    fb->timer = lv_timer_create(file_browser_timer_cb, config->refresh_period_ms, fb);
+    ESP_GOTO_ON_FALSE(fb->timer, ESP_ERR_NO_MEM, err_obj, TAG, "Not enough memory for file browser timer");
+    lv_timer_pause(fb->timer);
+
+    BaseType_t res;
+    if (config->task_affinity < 0) {
+        res = xTaskCreate(file_browser_task, "file_browser", config->task_stack, fb, config->task_priority, &fb->task);
+    } else {
+        res = xTaskCreatePinnedToCore(file_browser_task, "file_browser", config->task_stack, fb, config->task_priority, &fb->task, config->task_affinity);
+    }
+    ESP_GOTO_ON_FALSE(res == pdPASS, ESP_ERR_NO_MEM, err_timer, TAG, "Create file browser task fail");
+
+    *ret_handle = fb;
+    file_browser_open(fb, fb->root);
+    return ESP_OK;
+
+err_timer:
+    lv_timer_delete(fb->timer);
+err_obj:
+    lv_obj_delete(fb->cont);
+err:
+    free(fb->rows);
+    free(fb->row_index);
+    free(fb->listings);
+    if (fb->lock) {
+        vSemaphoreDelete(fb->lock);
+    }
+    if (fb->slot_free) {
+        vSemaphoreDelete(fb->slot_free);
+    }
+    if (fb->task_done) {
+        vSemaphoreDelete(fb->task_done);
+    }
+    if (fb->queue) {
+        vQueueDelete(fb->queue);
+    }
+    free(fb);
+    return ret;
+}
+
+esp_err_t file_browser_delete(file_browser_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+    file_browser_handle_t fb = handle;
+
+    /* Stop reading and end the task */
+    xSemaphoreTake(fb->lock, portMAX_DELAY);
+    for (uint32_t i = 0; i < fb->config.cache_dirs; i++) {
+        fb->listings[i].cancel = fb->listings[i].loading;
+    }
+    xSemaphoreGive(fb->lock);
+    const file_browser_listing_t *end = NULL;
+    xQueueSend(fb->queue, &end, portMAX_DELAY);
+    xSemaphoreTake(fb->task_done, portMAX_DELAY);
+
+    lv_timer_delete(fb->timer);
+    lv_obj_delete(fb->cont);
+    for (uint32_t i = 0; i < fb->config.cache_dirs; i++) {
+        file_browser_listing_free(&fb->listings[i]);
+    }
+    free(fb->listings);
+    free(fb->rows);
+    free(fb->row_index);
+    vSemaphoreDelete(fb->lock);
+    vSemaphoreDelete(fb->slot_free);
+    vSemaphoreDelete(fb->task_done);
+    vQueueDelete(fb->queue);
+    free(fb);
+    return ESP_OK;
+}
+
+esp_err_t file_browser_open(file_browser_handle_t handle, const char *path)
+{
+    ESP_RETURN_ON_FALSE(handle && path, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+    file_browser_handle_t fb = handle;
+    file_browser_listing_t *listing;
+
+    const TickType_t start = xTaskGetTickCount();
+    while (true) {
+        xSemaphoreTake(fb->lock, portMAX_DELAY);
+        /* Reading of the shown directory is not needed anymore */
+        if (fb->current && fb->current->loading && strcmp(fb->current->path, path) != 0) {
+            fb->current->cancel = true;
+        }
+        bool fresh;
+        listing = file_browser_listing_get(fb, path, &fresh);
+        if (listing) {
+            listing->used_stamp = ++fb->stamp;
+        }
+        xSemaphoreGive(fb->lock);
+
+        if (listing) {
+            if (fresh) {
+                xQueueSend(fb->queue, &listing, portMAX_DELAY);
+            }
+            break;
+        }
+        /* All cached listings are being read, wait until one is released */
+        ESP_RETURN_ON_FALSE(xTaskGetTickCount() - start < pdMS_TO_TICKS(FILE_BROWSER_SLOT_WAIT_MS), ESP_ERR_NO_MEM, TAG, "No free directory listing");
+        xSemaphoreTake(fb->slot_free, pdMS_TO_TICKS(FILE_BROWSER_SLOT_WAIT_MS));
+    }
+
+    file_browser_show(fb, listing);
+    return ESP_OK;
+}
+
+esp_err_t file_browser_refresh(file_browser_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle && handle->current, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+    file_browser_handle_t fb = handle;
+    char path[FILE_BROWSER_PATH_MAX];
+
+    xSemaphoreTake(fb->lock, portMAX_DELAY);
+    strlcpy(path, fb->current->path, sizeof(path));
+    /* Drop the cached listing, it is read again into a free one */
+    if (fb->current->loading) {
+        fb->current->cancel = true;
+    } else {
+        file_browser_listing_free(fb->current);
+        fb->current->valid = false;
+    }
+    fb->current = NULL;
+    xSemaphoreGive(fb->lock);
+
+    return file_browser_open(fb, path);
+}
+
+const char *file_browser_get_path(file_browser_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, NULL, TAG, "invalid arguments");
+    return (handle->current ? handle->current->path : handle->root);
+}
+
+lv_obj_t *file_browser_get_obj(file_browser_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, NULL, TAG, "invalid arguments");
+    return handle->cont;
+}
@@ -0,0 +1,159 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief LVGL file browser with background directory listing
+ *
+ * Directories are read by a background task into cached listings. The LVGL list is virtualized: only the visible rows
+ * (and two spare ones) exist and they are re-bound to the entries while scrolling, so directories with thousands
+ * of files are shown immediately and the display lock is never held during file system access.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief File browser handle
+ */
+typedef struct file_browser_s *file_browser_handle_t;
+
+/**
+ * @brief Callback of clicked file
+ *
+ * @note It is called from LVGL task with the display lock taken
+ *
+ * @param browser   File browser
+ * @param path      Full path of the file
+ * @param user_ctx  User data from the configuration
+ */
+typedef void (*file_browser_select_cb_t)(file_browser_handle_t browser, const char *path, void *user_ctx);
+
+/**
+ * @brief Callback of icon of the entry
+ *
+ * @param name      Name of the file
+ * @param user_ctx  User data from the configuration
+ * @return Icon (LVGL symbol) of the file
+ */
+typedef const char *(*file_browser_icon_cb_t)(const char *name, void *user_ctx);
+
+/**
+ * @brief File browser configuration
+ */
+typedef struct {
+    lv_obj_t *parent;                   /*!< Parent object of the browser */
+    const char *root;                   /*!< Root directory, there is no Back row in it */
+    lv_group_t *group;                  /*!< Input group for encoder or keypad (can be NULL) */
+    int32_t row_height;                 /*!< Height of one row [px] */
+    uint32_t cache_dirs;                /*!< Count of cached directory listings (at least 1) */
+    uint32_t refresh_period_ms;         /*!< Period of updating the list while the directory is being read */
+    int task_priority;                  /*!< Priority of the listing task */
+    int task_stack;                     /*!< Stack size of the listing task [bytes] */
+    int task_affinity;                  /*!< Core of the listing task (-1 for no affinity) */
+    file_browser_select_cb_t select_cb; /*!< Callback of clicked file (can be NULL) */
+    file_browser_icon_cb_t icon_cb;     /*!< Callback of file icon (NULL: LV_SYMBOL_FILE for all files) */
+    void *user_ctx;                     /*!< User data for the callbacks */
+} file_browser_config_t;
+
+/**
+ * @brief Default file browser configuration
+ */
+#define FILE_BROWSER_CONFIG_DEFAULT(parent_obj, root_path) \
+    {                                           \
+        .parent = (parent_obj),                 \
+        .root = (root_path),                    \
+        .row_height = 40,                       \
+        .cache_dirs = 4,                        \
+        .refresh_period_ms = 50,                \
+        .task_priority = 3,                     \
+        .task_stack = 4096,                     \
+        .task_affinity = -1,                    \
+    }
+
+/**
+ * @brief Create file browser
+ *
+ * @note The caller must hold the display lock. The root directory is opened.
+ *
+ * @param config        Configuration
+ * @param ret_handle    Created browser
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if there is no memory for the browser
+ */
+esp_err_t file_browser_create(const file_browser_config_t *config, file_browser_handle_t *ret_handle);
+
+/**
+ * @brief Delete file browser
+ *
+ * @note The caller must hold the display lock. It waits for the end of directory reading.
+ *
+ * @param handle    File browser
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t file_browser_delete(file_browser_handle_t handle);
+
+/**
+ * @brief Show directory
+ *
+ * The cached listing is shown immediately, otherwise the directory is read in background
+ * and the rows are filled in as the entries come.
+ *
+ * @note The caller must hold the display lock
+ *
+ * @param handle    File browser
+ * @param path      Path of the directory
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if there is no memory for the listing
+ */
+esp_err_t file_browser_open(file_browser_handle_t handle, const char *path);
+
+/**
+ * @brief Read the shown directory again
+ *
+ * @note The caller must hold the display lock. Use it after files were added or removed.
+ *
+ * @param handle    File browser
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if there is no memory for the listing
+ */
+esp_err_t file_browser_refresh(file_browser_handle_t handle);
+
+/**
+ * @brief Get path of the shown directory
+ *
+ * @param handle    File browser
+ * @return Path of the directory (NULL, if parameter error)
+ */
+const char *file_browser_get_path(file_browser_handle_t handle);
+
+/**
+ * @brief Get LVGL object of the browser
+ *
+ * @param handle    File browser
+ * @return Container object of the browser (NULL, if parameter error)
+ */
+lv_obj_t *file_browser_get_obj(file_browser_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
@@ -10,12 +10,14 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 
 #define HTS221_I2C_ADDRESS    ((uint8_t)0x5F) // HTS221 constant address
 
 typedef struct {
     i2c_port_t bus;
     uint16_t dev_addr;
+    uint8_t cmd_buf[I2C_LINK_RECOMMENDED_SIZE(2)]; /* Command link of the device, no heap allocation per access */
     bool initialized;
 
     // Data-ready (DRDY) related variables
@@ -23,6 +25,7 @@ typedef struct {
     gpio_num_t drdy_pin;
     hts221_drdylevel_t drdy_level;
     hts221_drdy_callback_t drdy_callback;
+    QueueHandle_t drdy_queue;
 
     // calibration coefficients
     struct {
@@ -37,6 +40,10 @@ typedef struct {
         int16_t h1_rh;
         int16_t h0_t0_out;
         int16_t h1_t0_out;
+
+        // slopes of the linear interpolation [0.1 unit per LSB] in Q16, precomputed in hts221_init
+        int32_t t_slope;
+        int32_t h_slope;
     } calibration_data;
 } hts221_dev_t;
 
@@ -51,6 +58,32 @@ static void IRAM_ATTR drdy_isr(void *args)
     }
 }
 
+static int16_t hts221_convert_humidity(const hts221_dev_t *dev, const int16_t h_out)
+{
+    int32_t humidity = (int32_t)(((int64_t)(h_out - dev->calibration_data.h0_t0_out) * dev->calibration_data.h_slope) >> 16);
+    humidity += dev->calibration_data.h0_rh * 10;
+    return humidity > 1000 ? 1000 : humidity;
+}
+
+static int16_t hts221_convert_temperature(const hts221_dev_t *dev, const int16_t t_out)
+{
+    int32_t temperature = (int32_t)(((int64_t)(t_out - dev->calibration_data.t0_out) * dev->calibration_data.t_slope) >> 16);
+    return temperature + dev->calibration_data.t0_degc * 10;
+}
+
+static void drdy_publish(hts221_dev_t *sens, const hts221_data_t *data)
+{
+    if (sens->drdy_callback != NULL) {
+        sens->drdy_callback(data->humidity, data->temperature);
+    }
+    if (sens->drdy_queue != NULL && xQueueSend(sens->drdy_queue, data, 0) != pdTRUE) {
+        // Queue is full, the oldest sample is dropped
+        hts221_data_t oldest;
+        xQueueReceive(sens->drdy_queue, &oldest, 0);
+        xQueueSend(sens->drdy_queue, data, 0);
+    }
+}
+
 static void drdy_task(void *args)
 {
     hts221_dev_t *sens = (hts221_dev_t *)args;
@@ -67,16 +100,13 @@ static void drdy_task(void *args)
     ESP_ERROR_CHECK(gpio_config(&drdy_pin_config));
 
     // perform dummy read to reset DRDY status
-    int16_t temperature, humidity;
-    hts221_get_humidity(args, &humidity);
-    hts221_get_temperature(args, &temperature);
+    hts221_data_t data;
+    hts221_get_data(args, &data);
 
     while (1) {
         ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // Wait for new data from ISR
-        hts221_get_humidity(args, &humidity);
-        hts221_get_temperature(args, &temperature);
-        if (sens->drdy_callback != NULL) {
-            sens->drdy_callback(humidity, temperature);
+        if (ESP_OK == hts221_get_data(args, &data)) {
+            drdy_publish(sens, &data);
         }
     }
     vTaskDelete(NULL);
@@ -86,7 +116,7 @@ static esp_err_t hts221_write(hts221_handle_t sensor, const uint8_t reg_start_ad
 {
     hts221_dev_t *sens = (hts221_dev_t *) sensor;
     esp_err_t  ret;
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(sens->cmd_buf, sizeof(sens->cmd_buf));
     ret = i2c_master_start(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_write_byte(cmd, sens->dev_addr | I2C_MASTER_WRITE, true);
@@ -98,7 +128,7 @@ static esp_err_t hts221_write(hts221_handle_t sensor, const uint8_t reg_start_ad
     ret = i2c_master_stop(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_cmd_begin(sens->bus, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
+    i2c_cmd_link_delete_static(cmd);
 
     return ret;
 }
@@ -112,7 +142,7 @@ static esp_err_t hts221_read(hts221_handle_t sensor, const uint8_t reg_start_add
 {
     hts221_dev_t *sens = (hts221_dev_t *) sensor;
     esp_err_t ret;
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(sens->cmd_buf, sizeof(sens->cmd_buf));
     ret = i2c_master_start(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_write_byte(cmd, sens->dev_addr | I2C_MASTER_WRITE, true);
@@ -128,7 +158,7 @@ static esp_err_t hts221_read(hts221_handle_t sensor, const uint8_t reg_start_add
     ret = i2c_master_stop(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_cmd_begin(sens->bus, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
+    i2c_cmd_link_delete_static(cmd);
 
     return ret;
 }
@@ -212,6 +242,12 @@ esp_err_t hts221_init(hts221_handle_t sensor, const hts221_config_t *const hts22
         return ESP_FAIL;
     }
 
+    // interpolation slopes, so that conversion of each sample needs no division
+    dev->calibration_data.t_slope = ((int32_t)(dev->calibration_data.t1_degc - dev->calibration_data.t0_degc) * 10 * 65536) /
+                                    (int32_t)(dev->calibration_data.t1_out - dev->calibration_data.t0_out);
+    dev->calibration_data.h_slope = ((int32_t)(dev->calibration_data.h1_rh - dev->calibration_data.h0_rh) * 10 * 65536) /
+                                    (int32_t)(dev->calibration_data.h1_t0_out - dev->calibration_data.h0_t0_out);
+
     // configure and activate it
     ret = hts221_set_config(sensor, hts221_config);
     assert(ESP_OK == ret);
@@ -310,12 +346,7 @@ esp_err_t hts221_get_humidity(hts221_handle_t sensor, int16_t *const humidity)
     ret = hts221_read(sensor, HTS221_HR_OUT_L_REG, buffer, 2);
     assert(ESP_OK == ret);
     int16_t h_out = (int16_t)(((uint16_t)buffer[1]) << 8) | (uint16_t)buffer[0];
-
-    int32_t tmp_32 = ((int32_t)(h_out - dev->calibration_data.h0_t0_out)) * ((int32_t)(dev->calibration_data.h1_rh - dev->calibration_data.h0_rh) * 10);
-    *humidity = tmp_32 / (int32_t)(dev->calibration_data.h1_t0_out - dev->calibration_data.h0_t0_out)  + dev->calibration_data.h0_rh * 10;
-    if (*humidity > 1000) {
-        *humidity = 1000;
-    }
+    *humidity = hts221_convert_humidity(dev, h_out);
     return ret;
 }
 
@@ -332,18 +363,38 @@ esp_err_t hts221_get_temperature(hts221_handle_t sensor, int16_t *const temperat
     ret = hts221_read(sensor, HTS221_TEMP_OUT_L_REG, buffer, 2);
     assert(ESP_OK == ret);
     int16_t t_out = (((uint16_t)buffer[1]) << 8) | (uint16_t)buffer[0];
-
-    int32_t tmp_32 = ((int32_t)(t_out - dev->calibration_data.t0_out)) * ((int32_t)(dev->calibration_data.t1_degc - dev->calibration_data.t0_degc) * 10);
-    *temperature = tmp_32 / (int32_t)(dev->calibration_data.t1_out - dev->calibration_data.t0_out) + dev->calibration_data.t0_degc * 10;
+    *temperature = hts221_convert_temperature(dev, t_out);
     return ret;
 }
 
+esp_err_t hts221_get_data(hts221_handle_t sensor, hts221_data_t *const data)
+{
+    esp_err_t ret;
+    hts221_dev_t *dev = (hts221_dev_t *)sensor;
+    uint8_t buffer[4];
+
+    if (!dev->initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // HUMIDITY_OUT_L/H and TEMP_OUT_L/H are consecutive registers
+    ret = hts221_read(sensor, HTS221_HR_OUT_L_REG, buffer, sizeof(buffer));
+    if (ESP_OK != ret) {
+        return ret;
+    }
+    int16_t h_out = (int16_t)((((uint16_t)buffer[1]) << 8) | (uint16_t)buffer[0]);
+    int16_t t_out = (int16_t)((((uint16_t)buffer[3]) << 8) | (uint16_t)buffer[2]);
+    data->humidity = hts221_convert_humidity(dev, h_out);
+    data->temperature = hts221_convert_temperature(dev, t_out);
+    return ESP_OK;
+}
+
 esp_err_t hts221_drdy_enable(hts221_handle_t sensor, const hts221_drdy_config_t *const config)
 {
     esp_err_t ret;
     hts221_dev_t *sens = (hts221_dev_t *)sensor;
 
-    if (config->drdy_callback == NULL) {
+    if (config->drdy_callback == NULL && config->drdy_queue == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
 
@@ -354,11 +405,13 @@ esp_err_t hts221_drdy_enable(hts221_handle_t sensor, const hts221_drdy_config_t
     // store parameters that are needed in a new FreeRTOS task
     sens->drdy_pin      = config->drdy_pin;
     sens->drdy_callback = config->drdy_callback;
+    sens->drdy_queue    = config->drdy_queue;
     sens->drdy_level    = config->irq_level;
 
     // Create FreeRTOS task - interrupt allocation should be done in pinned to core task
+    const BaseType_t core = config->drdy_task_affinity < 0 ? tskNO_AFFINITY : config->drdy_task_affinity;
     BaseType_t freertos_ret = xTaskCreatePinnedToCore(
-                                  drdy_task, "HTS221 DRDY", 2048, sensor, config->drdy_task_priority, &sens->drdy_task_handle, 0
+                                  drdy_task, "HTS221 DRDY", 2048, sensor, config->drdy_task_priority, &sens->drdy_task_handle, core
                               );
     if (pdPASS != freertos_ret) {
         return ESP_ERR_NO_MEM;
@@ -17,6 +17,8 @@ extern "C" {
 
 #include "driver/i2c.h"
 #include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 
 /**
 * @brief  Humidity average.
@@ -82,6 +84,14 @@ typedef struct {
     bool                 bdu_status;       /*!< Enable/disable the block data update */
 } hts221_config_t;
 
+/**
+ * @brief Humidity and temperature sample
+ */
+typedef struct {
+    int16_t humidity;                      /*!< Relative humidity in 0.1 [%] */
+    int16_t temperature;                   /*!< Temperature in 0.1 [deg C] */
+} hts221_data_t;
+
 /**
  * @brief Callback function type for DRDY mode
  */
@@ -94,8 +104,10 @@ typedef struct {
     hts221_drdylevel_t     irq_level;        /*!< HTS221_HIGH_LVL/HTS221_LOW_LVL the level for DRDY pin */
     hts221_outputtype_t    irq_output_type;  /*!< Output configuration for DRDY pin */
     gpio_num_t             drdy_pin;
-    hts221_drdy_callback_t drdy_callback;
+    hts221_drdy_callback_t drdy_callback;    /*!< Called with new data from DRDY task (can be NULL if drdy_queue is set) */
+    QueueHandle_t          drdy_queue;       /*!< Queue of hts221_data_t items, new data is sent without waiting, the oldest item is dropped if full (can be NULL) */
     UBaseType_t            drdy_task_priority;
+    int                    drdy_task_affinity; /*!< Core of the DRDY task, its GPIO interrupt is allocated there (0 by default, -1 for no affinity) */
 } hts221_drdy_config_t;
 
 
@@ -257,6 +269,21 @@ esp_err_t hts221_get_humidity(hts221_handle_t sensor, int16_t *const humidity);
  */
 esp_err_t hts221_get_temperature(hts221_handle_t sensor, int16_t *const temperature);
 
+/**
+ * @brief Get humidity and temperature in one I2C transaction
+ *
+ * Both output registers are read at once and converted with calibration slopes precomputed by hts221_init().
+ *
+ * @param sensor object handle of hts221
+ * @param[out] data humidity in 0.1 [%] and temperature in 0.1 [deg C]
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_STATE Driver is not initialized
+ *     - ESP_FAIL Fail
+ */
+esp_err_t hts221_get_data(hts221_handle_t sensor, hts221_data_t *const data);
+
 /**
  * @brief Create sensor object and return a sensor handle
  *
@@ -290,7 +317,7 @@ esp_err_t hts221_init(hts221_handle_t sensor, const hts221_config_t *const hts22
  * @param[in] config DRDY mode configuration structure
  * @return
  *     - ESP_OK Success
- *     - ESP_ERR_INVALID_ARG Callback function is NULL
+ *     - ESP_ERR_INVALID_ARG Both callback function and queue are NULL
  *     - ESP_ERR_INVALID_STATE Driver is not initialized
  *     - ESP_ERR_NO_MEM Failed to create a FreeRTOS task
  */
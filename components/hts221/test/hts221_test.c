@@ -10,11 +10,13 @@
 #include "hts221.h"
 #include "esp_system.h"
 #include "esp_log.h"
+#include "i2c_bus_stats.h"
 
 #define I2C_MASTER_SCL_IO 26      /*!< gpio number for I2C master clock */
 #define I2C_MASTER_SDA_IO 25      /*!< gpio number for I2C master data  */
 #define I2C_MASTER_NUM I2C_NUM_0  /*!< I2C port number for master dev */
 #define I2C_MASTER_FREQ_HZ 100000 /*!< I2C master clock frequency */
+#define PERF_ITERATIONS 1000      /*!< Number of readings in performance test */
 
 static const char *TAG = "hts221 test";
 static hts221_handle_t hts221 = NULL;
@@ -90,7 +92,52 @@ TEST_CASE("Sensor hts221 test", "[hts221][iot][sensor]")
     TEST_ASSERT_EQUAL(ESP_OK, ret);
     ESP_LOGI(TAG, "temperature value is: %2.2f degC", (float)temperature / 10);
 
+    // burst read of both values
+    hts221_data_t data;
+    ret = hts221_get_data(hts221, &data);
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+    TEST_ASSERT_INT16_WITHIN(10, humidity, data.humidity);
+    TEST_ASSERT_INT16_WITHIN(10, temperature, data.temperature);
+
     hts221_delete(hts221);
     ret = i2c_driver_delete(I2C_MASTER_NUM);
     TEST_ASSERT_EQUAL(ESP_OK, ret);
 }
+
+static esp_err_t hts221_perf_get_separate(void *ctx)
+{
+    int16_t humidity, temperature;
+    esp_err_t ret = hts221_get_humidity(hts221, &humidity);
+    if (ret == ESP_OK) {
+        ret = hts221_get_temperature(hts221, &temperature);
+    }
+    return ret;
+}
+
+static esp_err_t hts221_perf_get_data(void *ctx)
+{
+    hts221_data_t data;
+    return hts221_get_data(hts221, &data);
+}
+
+TEST_CASE("Sensor hts221 performance", "[hts221][iot][sensor][perf]")
+{
+    i2c_bus_perf_result_t separate, burst;
+    const hts221_config_t hts221_config = {
+        .avg_h = HTS221_AVGH_32,
+        .avg_t = HTS221_AVGT_16,
+        .odr = HTS221_ODR_12_5HZ,
+        .bdu_status = true,
+    };
+
+    i2c_sensor_hts221_init();
+    TEST_ASSERT_EQUAL(ESP_OK, hts221_init(hts221, &hts221_config));
+
+    /* Humidity and temperature by separate calls and in one burst */
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_perf_run("hts221", "get_humidity_temperature", hts221_perf_get_separate, NULL, PERF_ITERATIONS, 1, &separate));
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_perf_run("hts221", "get_data", hts221_perf_get_data, NULL, PERF_ITERATIONS, 1, &burst));
+    TEST_ASSERT(burst.transactions <= separate.transactions);
+
+    hts221_delete(hts221);
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_driver_delete(I2C_MASTER_NUM));
+}
@@ -0,0 +1,447 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "i2c_scheduler.h"
+#if CONFIG_I2C_SCHEDULER_TRACE_SYSVIEW
+#include "SEGGER_SYSVIEW.h"
+#endif
+
+static const char *TAG = "i2c_scheduler";
+
+#define I2C_SCHEDULER_PROBE_COUNT       8   /* Address acknowledges needed at one clock */
+#define I2C_SCHEDULER_PROBE_TIMEOUT_MS  50
+
+#define I2C_SCHEDULER_SV_TRANS          4   /* SystemView user event of the transaction */
+#if CONFIG_I2C_SCHEDULER_TRACE_SYSVIEW
+#define I2C_SCHEDULER_SV_START(id)      SEGGER_SYSVIEW_OnUserStart(id)
+#define I2C_SCHEDULER_SV_STOP(id)       SEGGER_SYSVIEW_OnUserStop(id)
+#else
+#define I2C_SCHEDULER_SV_START(id)
+#define I2C_SCHEDULER_SV_STOP(id)
+#endif
+
+/* Lower clocks tried by probing [Hz] */
+static const uint32_t i2c_scheduler_clk_steps[] = {1000000, 400000, 100000};
+
+typedef struct {
+    bool used;
+    uint8_t dev_addr;
+    i2c_scheduler_dev_stats_t stats;
+} i2c_scheduler_dev_t;
+
+struct i2c_scheduler_s {
+    i2c_port_t i2c_num;
+    SemaphoreHandle_t bus_lock;                     /* Taken by the task for a transaction, or by probing */
+    uint32_t base_clk_hz;                           /* Clock configured by the user, 0 if not known */
+    int base_high_period;                           /* SCL periods of the base clock */
+    int base_low_period;
+    uint32_t clk_hz;                                /* Current clock on the bus */
+    portMUX_TYPE stats_lock;
+    i2c_scheduler_dev_t devs[I2C_SCHEDULER_DEVICES_MAX];
+    i2c_scheduler_stats_t stats;
+    int64_t stats_start_us;
+    QueueHandle_t queue[I2C_SCHEDULER_PRIO_MAX];    /* Waiting transactions by priority */
+    SemaphoreHandle_t pending;                      /* Count of waiting transactions */
+    SemaphoreHandle_t task_done;
+    TaskHandle_t task;
+    volatile bool running;
+};
+
+typedef struct {
+    SemaphoreHandle_t done;
+    esp_err_t result;
+} i2c_scheduler_sync_t;
+
+/* Find the device or start tracking it */
+static i2c_scheduler_dev_t *i2c_scheduler_get_dev(i2c_scheduler_handle_t handle, uint8_t dev_addr)
+{
+    i2c_scheduler_dev_t *free_dev = NULL;
+    for (int i = 0; i < I2C_SCHEDULER_DEVICES_MAX; i++) {
+        if (handle->devs[i].used && handle->devs[i].dev_addr == dev_addr) {
+            return &handle->devs[i];
+        } else if (!handle->devs[i].used && !free_dev) {
+            free_dev = &handle->devs[i];
+        }
+    }
+    if (free_dev) {
+        portENTER_CRITICAL(&handle->stats_lock);
+        free_dev->used = true;
+        free_dev->dev_addr = dev_addr;
+        free_dev->stats = (i2c_scheduler_dev_stats_t) {
+            .clk_hz = handle->base_clk_hz,
+        };
+        portEXIT_CRITICAL(&handle->stats_lock);
+    }
+    return free_dev;
+}
+
+/* SCL periods scale inversely with the clock */
+static esp_err_t i2c_scheduler_set_clock(i2c_scheduler_handle_t handle, uint32_t clk_hz)
+{
+    if (clk_hz == 0 || clk_hz == handle->clk_hz) {
+        return ESP_OK;
+    }
+    const int high = (int)((uint64_t)handle->base_high_period * handle->base_clk_hz / clk_hz);
+    const int low = (int)((uint64_t)handle->base_low_period * handle->base_clk_hz / clk_hz);
+    ESP_RETURN_ON_ERROR(i2c_set_period(handle->i2c_num, high, low), TAG, "Set clock %"PRIu32" Hz failed", clk_hz);
+    handle->clk_hz = clk_hz;
+    return ESP_OK;
+}
+
+static void i2c_scheduler_account(i2c_scheduler_handle_t handle, i2c_scheduler_dev_t *dev, esp_err_t result, int64_t busy_us)
+{
+    bool downgrade = false;
+
+    portENTER_CRITICAL(&handle->stats_lock);
+    handle->stats.transactions++;
+    handle->stats.busy_us += busy_us;
+    if (result != ESP_OK) {
+        handle->stats.errors++;
+    }
+    if (dev) {
+        dev->stats.transactions++;
+        if (result == ESP_FAIL) {
+            dev->stats.nack++;
+        } else if (result == ESP_ERR_TIMEOUT) {
+            dev->stats.timeout++;
+        }
+        /* A raised clock is not reliable anymore */
+        if (result != ESP_OK && dev->stats.clk_hz > handle->base_clk_hz) {
+            dev->stats.clk_hz = handle->base_clk_hz;
+            dev->stats.clk_downgrades++;
+            downgrade = true;
+        }
+    }
+    portEXIT_CRITICAL(&handle->stats_lock);
+
+    if (downgrade) {
+        ESP_LOGW(TAG, "Device 0x%02X failed (%s), back to %"PRIu32" Hz", dev->dev_addr, esp_err_to_name(result), handle->base_clk_hz);
+    }
+}
+
+static void i2c_scheduler_execute(i2c_scheduler_handle_t handle, const i2c_scheduler_trans_t *trans)
+{
+    const TickType_t timeout = pdMS_TO_TICKS(trans->timeout_ms);
+    esp_err_t ret;
+
+    xSemaphoreTake(handle->bus_lock, portMAX_DELAY);
+    i2c_scheduler_dev_t *dev = i2c_scheduler_get_dev(handle, trans->dev_addr);
+    i2c_scheduler_set_clock(handle, dev ? dev->stats.clk_hz : handle->base_clk_hz);
+    const int64_t start = esp_timer_get_time();
+
+    I2C_SCHEDULER_SV_START(I2C_SCHEDULER_SV_TRANS);
+    if (trans->write_size > 0 && trans->read_size > 0) {
+        ret = i2c_master_write_read_device(handle->i2c_num, trans->dev_addr, trans->write_buf, trans->write_size, trans->read_buf, trans->read_size, timeout);
+    } else if (trans->write_size > 0) {
+        ret = i2c_master_write_to_device(handle->i2c_num, trans->dev_addr, trans->write_buf, trans->write_size, timeout);
+    } else {
+        ret = i2c_master_read_from_device(handle->i2c_num, trans->dev_addr, trans->read_buf, trans->read_size, timeout);
+    }
+    I2C_SCHEDULER_SV_STOP(I2C_SCHEDULER_SV_TRANS);
+    i2c_scheduler_account(handle, dev, ret, esp_timer_get_time() - start);
+    /* Other users of the port (e.g. drivers not using the scheduler) expect the bus clock */
+    i2c_scheduler_set_clock(handle, handle->base_clk_hz);
+    xSemaphoreGive(handle->bus_lock);
+
+    if (trans->done_cb) {
+        trans->done_cb(ret, trans->user_ctx);
+    }
+}
+
+/* Take the waiting transaction with the highest priority */
+static bool i2c_scheduler_next(i2c_scheduler_handle_t handle, i2c_scheduler_trans_t *trans)
+{
+    for (int i = 0; i < I2C_SCHEDULER_PRIO_MAX; i++) {
+        if (xQueueReceive(handle->queue[i], trans, 0) == pdTRUE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void i2c_scheduler_task(void *arg)
+{
+    i2c_scheduler_handle_t handle = (i2c_scheduler_handle_t)arg;
+    i2c_scheduler_trans_t trans;
+
+    while (1) {
+        xSemaphoreTake(handle->pending, portMAX_DELAY);
+        if (!handle->running) {
+            break;
+        }
+        if (i2c_scheduler_next(handle, &trans)) {
+            i2c_scheduler_execute(handle, &trans);
+        }
+    }
+
+    xSemaphoreGive(handle->task_done);
+    vTaskDelete(NULL);
+}
+
+static void i2c_scheduler_sync_done(esp_err_t result, void *user_ctx)
+{
+    i2c_scheduler_sync_t *sync = (i2c_scheduler_sync_t *)user_ctx;
+    sync->result = result;
+    xSemaphoreGive(sync->done);
+}
+
+static void i2c_scheduler_free(i2c_scheduler_handle_t handle)
+{
+    for (int i = 0; i < I2C_SCHEDULER_PRIO_MAX; i++) {
+        if (handle->queue[i]) {
+            vQueueDelete(handle->queue[i]);
+        }
+    }
+    if (handle->pending) {
+        vSemaphoreDelete(handle->pending);
+    }
+    if (handle->task_done) {
+        vSemaphoreDelete(handle->task_done);
+    }
+    if (handle->bus_lock) {
+        vSemaphoreDelete(handle->bus_lock);
+    }
+    free(handle);
+}
+
+esp_err_t i2c_scheduler_create(const i2c_scheduler_config_t *config, i2c_scheduler_handle_t *ret_handle)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(config && ret_handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->i2c_num < I2C_NUM_MAX, ESP_ERR_INVALID_ARG, TAG, "Invalid I2C port");
+    ESP_RETURN_ON_FALSE(config->queue_size > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid queue size");
+
+    i2c_scheduler_handle_t handle = calloc(1, sizeof(struct i2c_scheduler_s));
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_NO_MEM, TAG, "Not enough memory for scheduler");
+    handle->i2c_num = config->i2c_num;
+    handle->base_clk_hz = config->clk_speed_hz;
+    handle->clk_hz = config->clk_speed_hz;
+    portMUX_INITIALIZE(&handle->stats_lock);
+    handle->stats_start_us = esp_timer_get_time();
+    if (handle->base_clk_hz) {
+        ESP_GOTO_ON_ERROR(i2c_get_period(handle->i2c_num, &handle->base_high_period, &handle->base_low_period), err, TAG, "Get clock failed");
+    }
+
+    for (int i = 0; i < I2C_SCHEDULER_PRIO_MAX; i++) {
+        handle->queue[i] = xQueueCreate(config->queue_size, sizeof(i2c_scheduler_trans_t));
+        ESP_GOTO_ON_FALSE(handle->queue[i], ESP_ERR_NO_MEM, err, TAG, "Not enough memory for queue");
+    }
+    handle->pending = xSemaphoreCreateCounting(config->queue_size * I2C_SCHEDULER_PRIO_MAX + 1, 0);
+    ESP_GOTO_ON_FALSE(handle->pending, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for semaphore");
+    handle->task_done = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(handle->task_done, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for semaphore");
+    handle->bus_lock = xSemaphoreCreateMutex();
+    ESP_GOTO_ON_FALSE(handle->bus_lock, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for mutex");
+
+    handle->running = true;
+    BaseType_t res;
+    if (config->task_affinity < 0) {
+        res = xTaskCreate(i2c_scheduler_task, "i2c_scheduler", config->task_stack, handle, config->task_priority, &handle->task);
+    } else {
+        res = xTaskCreatePinnedToCore(i2c_scheduler_task, "i2c_scheduler", config->task_stack, handle, config->task_priority, &handle->task, config->task_affinity);
+    }
+    ESP_GOTO_ON_FALSE(res == pdPASS, ESP_ERR_NO_MEM, err, TAG, "Create task failed");
+
+    *ret_handle = handle;
+    return ESP_OK;
+
+err:
+    i2c_scheduler_free(handle);
+    return ret;
+}
+
+esp_err_t i2c_scheduler_delete(i2c_scheduler_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+
+    /* Stop the task after the current transaction */
+    handle->running = false;
+    xSemaphoreGive(handle->pending);
+    xSemaphoreTake(handle->task_done, portMAX_DELAY);
+
+    /* Not executed transactions */
+    i2c_scheduler_trans_t trans;
+    while (i2c_scheduler_next(handle, &trans)) {
+        if (trans.done_cb) {
+            trans.done_cb(ESP_ERR_INVALID_STATE, trans.user_ctx);
+        }
+    }
+
+    i2c_scheduler_free(handle);
+    return ESP_OK;
+}
+
+esp_err_t i2c_scheduler_submit(i2c_scheduler_handle_t handle, const i2c_scheduler_trans_t *trans)
+{
+    ESP_RETURN_ON_FALSE(handle && trans, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(trans->prio < I2C_SCHEDULER_PRIO_MAX, ESP_ERR_INVALID_ARG, TAG, "Invalid priority");
+    ESP_RETURN_ON_FALSE(trans->write_size > 0 || trans->read_size > 0, ESP_ERR_INVALID_ARG, TAG, "Empty transaction");
+    ESP_RETURN_ON_FALSE(trans->write_size == 0 || trans->write_buf, ESP_ERR_INVALID_ARG, TAG, "Invalid write buffer");
+    ESP_RETURN_ON_FALSE(trans->read_size == 0 || trans->read_buf, ESP_ERR_INVALID_ARG, TAG, "Invalid read buffer");
+
+    if (xPortInIsrContext() == pdTRUE) {
+        BaseType_t need_yield = pdFALSE;
+        if (xQueueSendFromISR(handle->queue[trans->prio], trans, &need_yield) != pdTRUE) {
+            return ESP_ERR_NO_MEM;
+        }
+        xSemaphoreGiveFromISR(handle->pending, &need_yield);
+        if (need_yield == pdTRUE) {
+            portYIELD_FROM_ISR();
+        }
+    } else {
+        if (xQueueSend(handle->queue[trans->prio], trans, 0) != pdTRUE) {
+            ESP_LOGW(TAG, "Queue of priority %d is full", trans->prio);
+            return ESP_ERR_NO_MEM;
+        }
+        xSemaphoreGive(handle->pending);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t i2c_scheduler_transfer(i2c_scheduler_handle_t handle, const i2c_scheduler_trans_t *trans)
+{
+    ESP_RETURN_ON_FALSE(handle && trans, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    StaticSemaphore_t done_buffer;
+    i2c_scheduler_sync_t sync = {
+        .done = xSemaphoreCreateBinaryStatic(&done_buffer),
+        .result = ESP_OK,
+    };
+    i2c_scheduler_trans_t sync_trans = *trans;
+    sync_trans.done_cb = i2c_scheduler_sync_done;
+    sync_trans.user_ctx = &sync;
+
+    esp_err_t ret = i2c_scheduler_submit(handle, &sync_trans);
+    if (ret == ESP_OK) {
+        xSemaphoreTake(sync.done, portMAX_DELAY);
+        ret = sync.result;
+    }
+    vSemaphoreDelete(sync.done);
+
+    return ret;
+}
+
+static esp_err_t i2c_scheduler_probe_at(i2c_scheduler_handle_t handle, uint8_t dev_addr, uint32_t clk_hz)
+{
+    ESP_RETURN_ON_ERROR(i2c_scheduler_set_clock(handle, clk_hz), TAG, "Set clock failed");
+
+    for (int i = 0; i < I2C_SCHEDULER_PROBE_COUNT; i++) {
+        i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+        ESP_RETURN_ON_FALSE(cmd, ESP_ERR_NO_MEM, TAG, "Not enough memory for command");
+        i2c_master_start(cmd);
+        i2c_master_write_byte(cmd, (dev_addr << 1) | I2C_MASTER_WRITE, true);
+        i2c_master_stop(cmd);
+        esp_err_t ret = i2c_master_cmd_begin(handle->i2c_num, cmd, pdMS_TO_TICKS(I2C_SCHEDULER_PROBE_TIMEOUT_MS));
+        i2c_cmd_link_delete(cmd);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2c_scheduler_probe_device(i2c_scheduler_handle_t handle, uint8_t dev_addr, uint32_t max_clk_hz, uint32_t *ret_clk_hz)
+{
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    ESP_RETURN_ON_FALSE(handle && dev_addr < 0x80 && max_clk_hz > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(handle->base_clk_hz, ESP_ERR_INVALID_STATE, TAG, "Bus clock not configured");
+
+    xSemaphoreTake(handle->bus_lock, portMAX_DELAY);
+    i2c_scheduler_dev_t *dev = i2c_scheduler_get_dev(handle, dev_addr);
+    ESP_GOTO_ON_FALSE(dev, ESP_ERR_NO_MEM, out, TAG, "Too many devices");
+
+    /* From the maximum clock down the standard clocks */
+    uint32_t clk_hz = max_clk_hz;
+    uint32_t found_hz = handle->base_clk_hz;
+    size_t step = 0;
+    while (clk_hz) {
+        if (i2c_scheduler_probe_at(handle, dev_addr, clk_hz) == ESP_OK) {
+            found_hz = clk_hz;
+            ret = ESP_OK;
+            break;
+        }
+        while (step < sizeof(i2c_scheduler_clk_steps) / sizeof(i2c_scheduler_clk_steps[0]) && i2c_scheduler_clk_steps[step] >= clk_hz) {
+            step++;
+        }
+        clk_hz = step < sizeof(i2c_scheduler_clk_steps) / sizeof(i2c_scheduler_clk_steps[0]) ? i2c_scheduler_clk_steps[step] : 0;
+    }
+    i2c_scheduler_set_clock(handle, handle->base_clk_hz);
+
+    portENTER_CRITICAL(&handle->stats_lock);
+    dev->stats.clk_hz = found_hz;
+    portEXIT_CRITICAL(&handle->stats_lock);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Device 0x%02X: %"PRIu32" Hz", dev_addr, found_hz);
+    } else {
+        ESP_LOGW(TAG, "Device 0x%02X doesn't respond", dev_addr);
+    }
+    if (ret_clk_hz) {
+        *ret_clk_hz = found_hz;
+    }
+
+out:
+    xSemaphoreGive(handle->bus_lock);
+    return ret;
+}
+
+esp_err_t i2c_scheduler_get_stats(i2c_scheduler_handle_t handle, i2c_scheduler_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(handle && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    const int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&handle->stats_lock);
+    *stats = handle->stats;
+    stats->elapsed_us = now - handle->stats_start_us;
+    portEXIT_CRITICAL(&handle->stats_lock);
+    stats->utilization = stats->elapsed_us ? (uint8_t)(MIN(stats->busy_us, stats->elapsed_us) * 100 / stats->elapsed_us) : 0;
+    return ESP_OK;
+}
+
+esp_err_t i2c_scheduler_get_device_stats(i2c_scheduler_handle_t handle, uint8_t dev_addr, i2c_scheduler_dev_stats_t *stats)
+{
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    ESP_RETURN_ON_FALSE(handle && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    portENTER_CRITICAL(&handle->stats_lock);
+    for (int i = 0; i < I2C_SCHEDULER_DEVICES_MAX; i++) {
+        if (handle->devs[i].used && handle->devs[i].dev_addr == dev_addr) {
+            *stats = handle->devs[i].stats;
+            ret = ESP_OK;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&handle->stats_lock);
+    return ret;
+}
+
+esp_err_t i2c_scheduler_reset_stats(i2c_scheduler_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+
+    portENTER_CRITICAL(&handle->stats_lock);
+    memset(&handle->stats, 0, sizeof(handle->stats));
+    handle->stats_start_us = esp_timer_get_time();
+    for (int i = 0; i < I2C_SCHEDULER_DEVICES_MAX; i++) {
+        const uint32_t clk_hz = handle->devs[i].stats.clk_hz;
+        handle->devs[i].stats = (i2c_scheduler_dev_stats_t) {
+            .clk_hz = clk_hz,
+        };
+    }
+    portEXIT_CRITICAL(&handle->stats_lock);
+    return ESP_OK;
+}
@@ -0,0 +1,237 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief I2C bus scheduler
+ *
+ * Transactions of more devices on one I2C bus are queued by priority and executed by one task.
+ * A waiting high priority transaction (e.g. touch) is executed before waiting lower priority
+ * transactions (e.g. environmental sensors).
+ *
+ * Each device can use its own bus clock, selected by probing (`i2c_scheduler_probe_device`).
+ * The scheduler counts NACKs and timeouts of each device and the bus utilization.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/i2c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Priority of I2C transaction
+ */
+typedef enum {
+    I2C_SCHEDULER_PRIO_HIGH = 0,        /*!< Latency sensitive devices (e.g. touch) */
+    I2C_SCHEDULER_PRIO_MEDIUM,          /*!< Control devices (e.g. IO expander) */
+    I2C_SCHEDULER_PRIO_LOW,             /*!< Slow devices (e.g. environmental sensors) */
+    I2C_SCHEDULER_PRIO_MAX,
+} i2c_scheduler_prio_t;
+
+/**
+ * @brief Callback of finished I2C transaction
+ *
+ * @note It is called from the scheduler task (or from `i2c_scheduler_delete` with ESP_ERR_INVALID_STATE for not executed transactions)
+ *
+ * @param result    Result of the transaction
+ * @param user_ctx  User data from the transaction
+ */
+typedef void (*i2c_scheduler_done_cb_t)(esp_err_t result, void *user_ctx);
+
+/**
+ * @brief I2C transaction
+ *
+ * @note Write and read buffers must be valid until the transaction is finished
+ */
+typedef struct {
+    uint8_t dev_addr;                   /*!< 7-bit I2C address of the device */
+    const uint8_t *write_buf;           /*!< Data written to the device (NULL for read only) */
+    size_t write_size;                  /*!< Size of written data */
+    uint8_t *read_buf;                  /*!< Buffer for data read from the device after the written data (NULL for write only) */
+    size_t read_size;                   /*!< Size of read data */
+    uint32_t timeout_ms;                /*!< Timeout of the transaction on the bus */
+    i2c_scheduler_prio_t prio;          /*!< Priority of the transaction */
+    i2c_scheduler_done_cb_t done_cb;    /*!< Callback of finished transaction (can be NULL) */
+    void *user_ctx;                     /*!< User data for the callback */
+} i2c_scheduler_trans_t;
+
+/**
+ * @brief I2C scheduler configuration
+ */
+typedef struct {
+    i2c_port_t i2c_num;                 /*!< I2C port, the driver must be installed (`i2c_driver_install`) */
+    size_t queue_size;                  /*!< Maximum count of waiting transactions of each priority */
+    int task_priority;                  /*!< Priority of the scheduler task */
+    int task_stack;                     /*!< Stack size of the scheduler task [bytes] */
+    int task_affinity;                  /*!< Core of the scheduler task (-1 for no affinity) */
+    uint32_t clk_speed_hz;              /*!< Clock set by `i2c_param_config` [Hz], needed for per-device clocks (0 to keep the bus clock) */
+} i2c_scheduler_config_t;
+
+/**
+ * @brief Statistics of one device on the bus
+ */
+typedef struct {
+    uint32_t clk_hz;                    /*!< Clock used for the device [Hz] (0 if the bus clock is not known) */
+    uint32_t transactions;              /*!< Count of executed transactions */
+    uint32_t nack;                      /*!< Count of transactions not acknowledged by the device */
+    uint32_t timeout;                   /*!< Count of transactions, which timed out */
+    uint32_t clk_downgrades;            /*!< Count of returns to the bus clock after a failed transaction */
+} i2c_scheduler_dev_stats_t;
+
+/**
+ * @brief Statistics of the bus
+ */
+typedef struct {
+    uint32_t transactions;              /*!< Count of executed transactions */
+    uint32_t errors;                    /*!< Count of failed transactions */
+    uint64_t busy_us;                   /*!< Time spent in transactions [us] */
+    uint64_t elapsed_us;                /*!< Time since creation or last reset of the statistics [us] */
+    uint8_t utilization;                /*!< Bus utilization, busy_us / elapsed_us [%] */
+} i2c_scheduler_stats_t;
+
+/**
+ * @brief Maximum count of devices with own clock and statistics
+ */
+#define I2C_SCHEDULER_DEVICES_MAX   16
+
+/**
+ * @brief Default I2C scheduler configuration
+ */
+#define I2C_SCHEDULER_CONFIG_DEFAULT(port)  \
+    {                                       \
+        .i2c_num = (port),                  \
+        .queue_size = 8,                    \
+        .task_priority = 6,                 \
+        .task_stack = 3072,                 \
+        .task_affinity = -1,                \
+        .clk_speed_hz = 0,                  \
+    }
+
+/**
+ * @brief I2C scheduler handle
+ */
+typedef struct i2c_scheduler_s *i2c_scheduler_handle_t;
+
+/**
+ * @brief Create I2C scheduler on one I2C port
+ *
+ * @param config        Configuration
+ * @param ret_handle    Created scheduler
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if there is no memory for the scheduler
+ */
+esp_err_t i2c_scheduler_create(const i2c_scheduler_config_t *config, i2c_scheduler_handle_t *ret_handle);
+
+/**
+ * @brief Delete I2C scheduler
+ *
+ * @note The currently executed transaction is finished, callbacks of waiting transactions are called with ESP_ERR_INVALID_STATE
+ *
+ * @param handle    Scheduler
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t i2c_scheduler_delete(i2c_scheduler_handle_t handle);
+
+/**
+ * @brief Submit I2C transaction without waiting
+ *
+ * @note The transaction descriptor is copied, the buffers must be valid until `done_cb` is called
+ * @note It can be called from ISR
+ *
+ * @param handle    Scheduler
+ * @param trans     Transaction
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if the queue of the priority is full
+ */
+esp_err_t i2c_scheduler_submit(i2c_scheduler_handle_t handle, const i2c_scheduler_trans_t *trans);
+
+/**
+ * @brief Execute I2C transaction and wait for the result
+ *
+ * @note `done_cb` of the transaction is not used
+ *
+ * @param handle    Scheduler
+ * @param trans     Transaction
+ * @return
+ *      - Result of the transaction
+ *      - ESP_ERR_NO_MEM        if the queue of the priority is full
+ */
+esp_err_t i2c_scheduler_transfer(i2c_scheduler_handle_t handle, const i2c_scheduler_trans_t *trans);
+
+/**
+ * @brief Find the highest clock, at which the device reliably acknowledges its address
+ *
+ * The device is addressed several times at `max_clk_hz`, then at lower standard clocks (1 MHz, 400 kHz, 100 kHz)
+ * until all attempts are acknowledged. Later transactions to the device use the found clock;
+ * after a failed transaction the device returns to the bus clock.
+ *
+ * @note The bus is blocked for the scheduler during probing
+ * @note The clock is changed by scaling SCL high and low periods of the bus clock, other bus timings are kept
+ *
+ * @param handle        Scheduler
+ * @param dev_addr      7-bit I2C address of the device
+ * @param max_clk_hz    Maximum clock supported by the device and the bus wiring [Hz]
+ * @param[out] ret_clk_hz Found clock (can be NULL)
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_INVALID_STATE if `clk_speed_hz` was not configured
+ *      - ESP_ERR_NO_MEM        if I2C_SCHEDULER_DEVICES_MAX devices are used
+ *      - ESP_ERR_NOT_FOUND     if the device doesn't respond at any clock, the bus clock is used for it
+ */
+esp_err_t i2c_scheduler_probe_device(i2c_scheduler_handle_t handle, uint8_t dev_addr, uint32_t max_clk_hz, uint32_t *ret_clk_hz);
+
+/**
+ * @brief Get statistics of the bus
+ *
+ * @param handle        Scheduler
+ * @param[out] stats    Statistics
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t i2c_scheduler_get_stats(i2c_scheduler_handle_t handle, i2c_scheduler_stats_t *stats);
+
+/**
+ * @brief Get statistics of one device
+ *
+ * Devices are tracked from their first transaction or probe, up to I2C_SCHEDULER_DEVICES_MAX devices.
+ *
+ * @param handle        Scheduler
+ * @param dev_addr      7-bit I2C address of the device
+ * @param[out] stats    Statistics
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NOT_FOUND     if the device is not tracked
+ */
+esp_err_t i2c_scheduler_get_device_stats(i2c_scheduler_handle_t handle, uint8_t dev_addr, i2c_scheduler_dev_stats_t *stats);
+
+/**
+ * @brief Clear counters of the bus and of all devices, device clocks are kept
+ *
+ * @param handle    Scheduler
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t i2c_scheduler_reset_stats(i2c_scheduler_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
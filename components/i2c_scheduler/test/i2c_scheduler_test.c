@@ -0,0 +1,159 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include "unity.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "driver/i2c.h"
+#include "i2c_scheduler.h"
+
+#define I2C_MASTER_SCL_IO 26      /*!< gpio number for I2C master clock */
+#define I2C_MASTER_SDA_IO 25      /*!< gpio number for I2C master data  */
+#define I2C_MASTER_NUM I2C_NUM_0  /*!< I2C port number for master dev */
+#define I2C_MASTER_FREQ_HZ 100000 /*!< I2C master clock frequency */
+
+#define TEST_DEV_ADDR     0x5F    /*!< No device is needed, NACK finishes the transaction too */
+
+static SemaphoreHandle_t gate;
+static SemaphoreHandle_t done;
+static int order[I2C_SCHEDULER_PRIO_MAX];
+static int order_cnt;
+
+/**
+ * @brief i2c master initialization
+ */
+static void i2c_bus_init(void)
+{
+    i2c_config_t conf;
+    conf.mode = I2C_MODE_MASTER;
+    conf.sda_io_num = (gpio_num_t)I2C_MASTER_SDA_IO;
+    conf.sda_pullup_en = GPIO_PULLUP_ENABLE;
+    conf.scl_io_num = (gpio_num_t)I2C_MASTER_SCL_IO;
+    conf.scl_pullup_en = GPIO_PULLUP_ENABLE;
+    conf.master.clk_speed = I2C_MASTER_FREQ_HZ;
+    conf.clk_flags = I2C_SCLK_SRC_FLAG_FOR_NOMAL;
+
+    esp_err_t ret = i2c_param_config(I2C_MASTER_NUM, &conf);
+    TEST_ASSERT_EQUAL_MESSAGE(ESP_OK, ret, "I2C config returned error");
+
+    ret = i2c_driver_install(I2C_MASTER_NUM, conf.mode, 0, 0, 0);
+    TEST_ASSERT_EQUAL_MESSAGE(ESP_OK, ret, "I2C install returned error");
+}
+
+/* Blocks the scheduler task until the test submits all transactions */
+static void gate_cb(esp_err_t result, void *user_ctx)
+{
+    xSemaphoreTake(gate, portMAX_DELAY);
+}
+
+static void order_cb(esp_err_t result, void *user_ctx)
+{
+    order[order_cnt++] = (int)user_ctx;
+    xSemaphoreGive(done);
+}
+
+TEST_CASE("I2C scheduler priority test", "[i2c_scheduler][iot]")
+{
+    i2c_scheduler_handle_t scheduler = NULL;
+    uint8_t reg = 0x0F;
+    uint8_t data = 0;
+
+    i2c_bus_init();
+    gate = xSemaphoreCreateBinary();
+    done = xSemaphoreCreateCounting(I2C_SCHEDULER_PRIO_MAX, 0);
+    TEST_ASSERT_NOT_NULL(gate);
+    TEST_ASSERT_NOT_NULL(done);
+    order_cnt = 0;
+
+    const i2c_scheduler_config_t config = I2C_SCHEDULER_CONFIG_DEFAULT(I2C_MASTER_NUM);
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_scheduler_create(&config, &scheduler));
+
+    i2c_scheduler_trans_t trans = {
+        .dev_addr = TEST_DEV_ADDR,
+        .write_buf = &reg,
+        .write_size = 1,
+        .read_buf = &data,
+        .read_size = 1,
+        .timeout_ms = 100,
+        .prio = I2C_SCHEDULER_PRIO_LOW,
+        .done_cb = gate_cb,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_scheduler_submit(scheduler, &trans));
+
+    /* Submitted from the lowest priority, executed from the highest */
+    trans.done_cb = order_cb;
+    for (int prio = I2C_SCHEDULER_PRIO_MAX - 1; prio >= 0; prio--) {
+        trans.prio = prio;
+        trans.user_ctx = (void *)prio;
+        TEST_ASSERT_EQUAL(ESP_OK, i2c_scheduler_submit(scheduler, &trans));
+    }
+    xSemaphoreGive(gate);
+
+    for (int i = 0; i < I2C_SCHEDULER_PRIO_MAX; i++) {
+        TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(done, pdMS_TO_TICKS(1000)));
+    }
+    for (int i = 0; i < I2C_SCHEDULER_PRIO_MAX; i++) {
+        TEST_ASSERT_EQUAL(i, order[i]);
+    }
+
+    /* Synchronous transfer returns the result of the transaction (no device) */
+    trans.prio = I2C_SCHEDULER_PRIO_HIGH;
+    TEST_ASSERT_NOT_EQUAL(ESP_OK, i2c_scheduler_transfer(scheduler, &trans));
+
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_scheduler_delete(scheduler));
+    vSemaphoreDelete(gate);
+    vSemaphoreDelete(done);
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_driver_delete(I2C_MASTER_NUM));
+}
+
+TEST_CASE("I2C scheduler statistics test", "[i2c_scheduler][iot]")
+{
+    i2c_scheduler_handle_t scheduler = NULL;
+    uint8_t reg = 0x0F;
+    i2c_scheduler_stats_t stats;
+    i2c_scheduler_dev_stats_t dev_stats;
+    uint32_t clk_hz = 0;
+
+    i2c_bus_init();
+    i2c_scheduler_config_t config = I2C_SCHEDULER_CONFIG_DEFAULT(I2C_MASTER_NUM);
+    config.clk_speed_hz = I2C_MASTER_FREQ_HZ;
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_scheduler_create(&config, &scheduler));
+
+    /* No device: it keeps the bus clock */
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, i2c_scheduler_probe_device(scheduler, TEST_DEV_ADDR, 1000000, &clk_hz));
+    TEST_ASSERT_EQUAL(I2C_MASTER_FREQ_HZ, clk_hz);
+
+    const i2c_scheduler_trans_t trans = {
+        .dev_addr = TEST_DEV_ADDR,
+        .write_buf = &reg,
+        .write_size = 1,
+        .timeout_ms = 100,
+        .prio = I2C_SCHEDULER_PRIO_HIGH,
+    };
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_NOT_EQUAL(ESP_OK, i2c_scheduler_transfer(scheduler, &trans));
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_scheduler_get_stats(scheduler, &stats));
+    TEST_ASSERT_EQUAL(3, stats.transactions);
+    TEST_ASSERT_EQUAL(3, stats.errors);
+    TEST_ASSERT_GREATER_THAN(0, stats.busy_us);
+    TEST_ASSERT_LESS_OR_EQUAL(100, stats.utilization);
+
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_scheduler_get_device_stats(scheduler, TEST_DEV_ADDR, &dev_stats));
+    TEST_ASSERT_EQUAL(3, dev_stats.transactions);
+    TEST_ASSERT_EQUAL(3, dev_stats.nack + dev_stats.timeout);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, i2c_scheduler_get_device_stats(scheduler, TEST_DEV_ADDR + 1, &dev_stats));
+
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_scheduler_reset_stats(scheduler));
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_scheduler_get_device_stats(scheduler, TEST_DEV_ADDR, &dev_stats));
+    TEST_ASSERT_EQUAL(0, dev_stats.transactions);
+    TEST_ASSERT_EQUAL(I2C_MASTER_FREQ_HZ, dev_stats.clk_hz);
+
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_scheduler_delete(scheduler));
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_driver_delete(I2C_MASTER_NUM));
+}
@@ -0,0 +1,258 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_idf_version.h"
+#include "soc/soc_caps.h"
+#include "i2s_stream.h"
+#if SOC_CACHE_INTERNAL_MEM_VIA_L1CACHE
+#include "esp_cache.h"
+#endif
+
+static const char *TAG = "i2s_stream";
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0)
+#define I2S_STREAM_EVENT_BUF(event)     ((event)->dma_buf)
+#else
+#define I2S_STREAM_EVENT_BUF(event)     (*(void **)(event)->data)
+#endif
+
+typedef struct {
+    i2s_chan_handle_t chan;
+    QueueHandle_t queue;                    /* DMA buffers passed from the ISR */
+    void **held;                            /* Acquired buffers in the order of acquiring */
+    uint32_t held_first;
+    uint32_t held_cnt;
+    uint32_t pending;                       /* Buffers in the queue or acquired (not released yet) */
+    size_t size;                            /* Size of one DMA buffer */
+    uint32_t buffers;
+    uint32_t xruns;
+} i2s_stream_dir_t;
+
+struct i2s_stream_s {
+    uint32_t desc_num;
+    i2s_stream_dir_t rx;
+    i2s_stream_dir_t tx;
+    portMUX_TYPE lock;
+};
+
+/* Called from both callbacks, the DMA continues in the buffer after the completed one */
+static bool IRAM_ATTR i2s_stream_isr_put(i2s_stream_handle_t handle, i2s_stream_dir_t *dir, i2s_event_data_t *event)
+{
+    BaseType_t need_yield = pdFALSE;
+    void *buf = I2S_STREAM_EVENT_BUF(event);
+    bool put = true;
+
+    portENTER_CRITICAL_ISR(&handle->lock);
+    dir->buffers++;
+    dir->size = event->size;
+    /* The next buffer is still held by the application: captured data are overwritten or silence is played */
+    if (dir->pending >= handle->desc_num - 1) {
+        dir->xruns++;
+    }
+    if (dir->pending < handle->desc_num) {
+        dir->pending++;
+    } else {
+        put = false;
+    }
+    portEXIT_CRITICAL_ISR(&handle->lock);
+
+    if (put) {
+        xQueueSendFromISR(dir->queue, &buf, &need_yield);
+    }
+    return need_yield == pdTRUE;
+}
+
+static bool IRAM_ATTR i2s_stream_on_recv(i2s_chan_handle_t chan, i2s_event_data_t *event, void *user_ctx)
+{
+    i2s_stream_handle_t handle = (i2s_stream_handle_t)user_ctx;
+    return i2s_stream_isr_put(handle, &handle->rx, event);
+}
+
+static bool IRAM_ATTR i2s_stream_on_sent(i2s_chan_handle_t chan, i2s_event_data_t *event, void *user_ctx)
+{
+    i2s_stream_handle_t handle = (i2s_stream_handle_t)user_ctx;
+    return i2s_stream_isr_put(handle, &handle->tx, event);
+}
+
+/* Callbacks can be registered in the init state of the channel only */
+static esp_err_t i2s_stream_register(i2s_chan_handle_t chan, const i2s_event_callbacks_t *cbs, void *user_ctx)
+{
+    i2s_channel_disable(chan);
+    const esp_err_t ret = i2s_channel_register_event_callback(chan, cbs, user_ctx);
+    ESP_RETURN_ON_ERROR(i2s_channel_enable(chan), TAG, "I2S enabling failed");
+    return ret;
+}
+
+static esp_err_t i2s_stream_dir_init(i2s_stream_handle_t handle, i2s_stream_dir_t *dir, i2s_chan_handle_t chan)
+{
+    dir->chan = chan;
+    if (chan == NULL) {
+        return ESP_OK;
+    }
+    dir->queue = xQueueCreate(handle->desc_num, sizeof(void *));
+    dir->held = calloc(handle->desc_num, sizeof(void *));
+    ESP_RETURN_ON_FALSE(dir->queue && dir->held, ESP_ERR_NO_MEM, TAG, "Not enough memory for buffer queue");
+    return ESP_OK;
+}
+
+static void i2s_stream_dir_free(i2s_stream_dir_t *dir)
+{
+    if (dir->queue) {
+        vQueueDelete(dir->queue);
+    }
+    free(dir->held);
+}
+
+static void i2s_stream_free(i2s_stream_handle_t handle)
+{
+    i2s_stream_dir_free(&handle->rx);
+    i2s_stream_dir_free(&handle->tx);
+    free(handle);
+}
+
+esp_err_t i2s_stream_create(const i2s_stream_config_t *config, i2s_stream_handle_t *ret_handle)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(config && ret_handle && (config->tx_chan || config->rx_chan), ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->dma_desc_num >= 2, ESP_ERR_INVALID_ARG, TAG, "At least two DMA buffers are needed");
+
+    i2s_stream_handle_t handle = calloc(1, sizeof(struct i2s_stream_s));
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_NO_MEM, TAG, "Not enough memory for stream");
+    handle->desc_num = config->dma_desc_num;
+    handle->lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
+    ESP_GOTO_ON_ERROR(i2s_stream_dir_init(handle, &handle->rx, config->rx_chan), err, TAG, "Create capture stream failed");
+    ESP_GOTO_ON_ERROR(i2s_stream_dir_init(handle, &handle->tx, config->tx_chan), err, TAG, "Create playback stream failed");
+
+    if (config->rx_chan) {
+        const i2s_event_callbacks_t cbs = {
+            .on_recv = i2s_stream_on_recv,
+        };
+        ESP_GOTO_ON_ERROR(i2s_stream_register(config->rx_chan, &cbs, handle), err, TAG, "Register capture callback failed");
+    }
+    if (config->tx_chan) {
+        const i2s_event_callbacks_t cbs = {
+            .on_sent = i2s_stream_on_sent,
+        };
+        ESP_GOTO_ON_ERROR(i2s_stream_register(config->tx_chan, &cbs, handle), err_rx, TAG, "Register playback callback failed");
+    }
+
+    *ret_handle = handle;
+    return ESP_OK;
+
+err_rx:
+    if (config->rx_chan) {
+        const i2s_event_callbacks_t none = {0};
+        i2s_stream_register(config->rx_chan, &none, NULL);
+    }
+err:
+    i2s_stream_free(handle);
+    return ret;
+}
+
+esp_err_t i2s_stream_delete(i2s_stream_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    const i2s_event_callbacks_t none = {0};
+    if (handle->rx.chan) {
+        i2s_stream_register(handle->rx.chan, &none, NULL);
+    }
+    if (handle->tx.chan) {
+        i2s_stream_register(handle->tx.chan, &none, NULL);
+    }
+    i2s_stream_free(handle);
+    return ESP_OK;
+}
+
+static esp_err_t i2s_stream_acquire(i2s_stream_handle_t handle, i2s_stream_dir_t *dir, void **buf, size_t *size, TickType_t timeout)
+{
+    ESP_RETURN_ON_FALSE(dir->chan, ESP_ERR_NOT_SUPPORTED, TAG, "Direction is not streamed");
+    ESP_RETURN_ON_FALSE(dir->held_cnt < handle->desc_num, ESP_ERR_INVALID_STATE, TAG, "All buffers are acquired");
+    if (xQueueReceive(dir->queue, buf, timeout) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    dir->held[(dir->held_first + dir->held_cnt) % handle->desc_num] = *buf;
+    dir->held_cnt++;
+    *size = dir->size;
+    return ESP_OK;
+}
+
+static void *i2s_stream_release(i2s_stream_handle_t handle, i2s_stream_dir_t *dir)
+{
+    void *buf = dir->held[dir->held_first];
+    dir->held_first = (dir->held_first + 1) % handle->desc_num;
+    dir->held_cnt--;
+
+    portENTER_CRITICAL(&handle->lock);
+    dir->pending--;
+    portEXIT_CRITICAL(&handle->lock);
+    return buf;
+}
+
+esp_err_t i2s_stream_rx_acquire(i2s_stream_handle_t handle, const void **buf, size_t *size, TickType_t timeout)
+{
+    ESP_RETURN_ON_FALSE(handle && buf && size, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    void *data = NULL;
+    ESP_RETURN_ON_ERROR(i2s_stream_acquire(handle, &handle->rx, &data, size, timeout), TAG, "No captured buffer");
+#if SOC_CACHE_INTERNAL_MEM_VIA_L1CACHE
+    /* DMA wrote the memory behind the cache */
+    esp_cache_msync(data, *size, ESP_CACHE_MSYNC_FLAG_DIR_M2C);
+#endif
+    *buf = data;
+    return ESP_OK;
+}
+
+esp_err_t i2s_stream_rx_release(i2s_stream_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(handle->rx.held_cnt > 0, ESP_ERR_INVALID_STATE, TAG, "No captured buffer is acquired");
+
+    i2s_stream_release(handle, &handle->rx);
+    return ESP_OK;
+}
+
+esp_err_t i2s_stream_tx_acquire(i2s_stream_handle_t handle, void **buf, size_t *size, TickType_t timeout)
+{
+    ESP_RETURN_ON_FALSE(handle && buf && size, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    return i2s_stream_acquire(handle, &handle->tx, buf, size, timeout);
+}
+
+esp_err_t i2s_stream_tx_release(i2s_stream_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(handle->tx.held_cnt > 0, ESP_ERR_INVALID_STATE, TAG, "No playback buffer is acquired");
+
+    void *buf = i2s_stream_release(handle, &handle->tx);
+#if SOC_CACHE_INTERNAL_MEM_VIA_L1CACHE
+    /* DMA reads the memory behind the cache */
+    esp_cache_msync(buf, handle->tx.size, ESP_CACHE_MSYNC_FLAG_DIR_C2M);
+#else
+    (void)buf;
+#endif
+    return ESP_OK;
+}
+
+esp_err_t i2s_stream_get_stats(i2s_stream_handle_t handle, i2s_stream_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(handle && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    portENTER_CRITICAL(&handle->lock);
+    stats->rx_buffers = handle->rx.buffers;
+    stats->rx_overflows = handle->rx.xruns;
+    stats->tx_buffers = handle->tx.buffers;
+    stats->tx_underflows = handle->tx.xruns;
+    portEXIT_CRITICAL(&handle->lock);
+    return ESP_OK;
+}
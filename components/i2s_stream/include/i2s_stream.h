@@ -0,0 +1,164 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Event-driven I2S streaming with zero-copy DMA buffers
+ *
+ * The `on_recv` and `on_sent` callbacks of the I2S channels put the DMA buffers into queues. The application
+ * acquires the buffers from the queues, it processes captured data and fills playback data directly
+ * in the DMA buffers. There is no blocking `i2s_channel_read` / `i2s_channel_write` and no copy.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "driver/i2s_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief I2S stream configuration
+ */
+typedef struct {
+    i2s_chan_handle_t tx_chan;          /*!< Playback channel (e.g. from `bsp_audio_get_i2s_channels`), NULL: capture only */
+    i2s_chan_handle_t rx_chan;          /*!< Capture channel, NULL: playback only */
+    uint32_t dma_desc_num;              /*!< Count of DMA buffers of the channels (`dma_desc_num` of `i2s_chan_config_t`) */
+} i2s_stream_config_t;
+
+/**
+ * @brief Default I2S stream configuration (default DMA buffers of I2S driver)
+ */
+#define I2S_STREAM_CONFIG_DEFAULT(tx, rx)       \
+    {                                           \
+        .tx_chan = (tx),                        \
+        .rx_chan = (rx),                        \
+        .dma_desc_num = 6,                      \
+    }
+
+/**
+ * @brief I2S stream statistics
+ */
+typedef struct {
+    uint32_t rx_buffers;                /*!< Count of captured DMA buffers */
+    uint32_t rx_overflows;              /*!< Count of captured buffers, which were overwritten before they were released */
+    uint32_t tx_buffers;                /*!< Count of sent DMA buffers */
+    uint32_t tx_underflows;             /*!< Count of sent buffers, which were not filled in time (silence was played) */
+} i2s_stream_stats_t;
+
+/**
+ * @brief I2S stream handle
+ */
+typedef struct i2s_stream_s *i2s_stream_handle_t;
+
+/**
+ * @brief Create I2S stream
+ *
+ * The channels are disabled, the event callbacks are registered and the channels are enabled again.
+ *
+ * @note Create the stream after the codec devices are opened (`esp_codec_dev_open` configures I2S)
+ *       and delete it before they are closed.
+ * @note The channels must be created with `auto_clear`, so not filled playback buffers are silent.
+ *
+ * @param config        Configuration
+ * @param ret_handle    Created stream
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if there is no memory for the stream
+ *      - Others                I2S driver errors
+ */
+esp_err_t i2s_stream_create(const i2s_stream_config_t *config, i2s_stream_handle_t *ret_handle);
+
+/**
+ * @brief Delete I2S stream
+ *
+ * The event callbacks are unregistered, the channels stay enabled.
+ *
+ * @param handle    Stream
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t i2s_stream_delete(i2s_stream_handle_t handle);
+
+/**
+ * @brief Get next captured DMA buffer
+ *
+ * @note The buffer is valid until it is released. Release it before the DMA wraps around
+ *       (within `dma_desc_num - 1` buffer periods), otherwise an overflow is counted.
+ *
+ * @param handle    Stream
+ * @param buf       Captured data
+ * @param size      Size of the data [bytes]
+ * @param timeout   Time to wait for the buffer
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NOT_SUPPORTED if the stream has no capture channel
+ *      - ESP_ERR_TIMEOUT       if no buffer was captured
+ */
+esp_err_t i2s_stream_rx_acquire(i2s_stream_handle_t handle, const void **buf, size_t *size, TickType_t timeout);
+
+/**
+ * @brief Release the oldest acquired captured buffer
+ *
+ * @param handle    Stream
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_INVALID_STATE if no buffer is acquired
+ */
+esp_err_t i2s_stream_rx_release(i2s_stream_handle_t handle);
+
+/**
+ * @brief Get next free playback DMA buffer
+ *
+ * The buffer is played after the buffers which are already queued in DMA. Fill it whole and release it
+ * before the DMA reaches it, otherwise an underflow is counted.
+ *
+ * @param handle    Stream
+ * @param buf       Buffer to be filled
+ * @param size      Size of the buffer [bytes]
+ * @param timeout   Time to wait for the buffer
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NOT_SUPPORTED if the stream has no playback channel
+ *      - ESP_ERR_TIMEOUT       if no buffer was sent
+ */
+esp_err_t i2s_stream_tx_acquire(i2s_stream_handle_t handle, void **buf, size_t *size, TickType_t timeout);
+
+/**
+ * @brief Release the oldest acquired playback buffer, it is filled
+ *
+ * @param handle    Stream
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_INVALID_STATE if no buffer is acquired
+ */
+esp_err_t i2s_stream_tx_release(i2s_stream_handle_t handle);
+
+/**
+ * @brief Get stream statistics
+ *
+ * @param handle    Stream
+ * @param stats     Output statistics
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t i2s_stream_get_stats(i2s_stream_handle_t handle, i2s_stream_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,34 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "unity.h"
+#include "i2s_stream.h"
+
+TEST_CASE("I2S stream invalid arguments test", "[i2s_stream]")
+{
+    /* Channels are not touched, when the configuration is invalid */
+    static int dummy_chan;
+    i2s_stream_handle_t stream = NULL;
+
+    i2s_stream_config_t config = I2S_STREAM_CONFIG_DEFAULT(NULL, NULL);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, i2s_stream_create(&config, &stream));
+
+    config.tx_chan = (i2s_chan_handle_t)&dummy_chan;
+    config.dma_desc_num = 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, i2s_stream_create(&config, &stream));
+    TEST_ASSERT_NULL(stream);
+
+    const void *rx_buf;
+    void *tx_buf;
+    size_t size;
+    i2s_stream_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, i2s_stream_delete(NULL));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, i2s_stream_rx_acquire(NULL, &rx_buf, &size, 0));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, i2s_stream_tx_acquire(NULL, &tx_buf, &size, 0));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, i2s_stream_rx_release(NULL));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, i2s_stream_tx_release(NULL));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, i2s_stream_get_stats(NULL, &stats));
+}
@@ -5,12 +5,21 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include <time.h>
 #include <sys/time.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_system.h"
 #include "esp_check.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
 #include "driver/i2c.h"
+#include "driver/gpio.h"
 #include "icm42670.h"
 
 #define ALPHA                       0.99f        /*!< Weight of gyroscope */
@@ -21,6 +30,8 @@
 
 /* ICM42670 register */
 #define ICM42670_WHOAMI         0x75
+#define ICM42670_SIGNAL_PATH_RESET 0x02
+#define ICM42670_INT_CONFIG     0x06
 #define ICM42670_GYRO_CONFIG0   0x20
 #define ICM42670_ACCEL_CONFIG0  0x21
 #define ICM42670_TEMP_CONFIG    0x22
@@ -28,6 +39,60 @@
 #define ICM42670_TEMP_DATA      0x09
 #define ICM42670_ACCEL_DATA     0x0B
 #define ICM42670_GYRO_DATA      0x11
+#define ICM42670_APEX_CONFIG0   0x25
+#define ICM42670_APEX_CONFIG1   0x26
+#define ICM42670_WOM_CONFIG     0x27
+#define ICM42670_FIFO_CONFIG1   0x28
+#define ICM42670_FIFO_CONFIG2   0x29
+#define ICM42670_INT_SOURCE0    0x2B
+#define ICM42670_INT_SOURCE1    0x2C
+#define ICM42670_APEX_DATA0     0x31
+#define ICM42670_INTF_CONFIG0   0x35
+#define ICM42670_INT_STATUS     0x3A
+#define ICM42670_INT_STATUS2    0x3B
+#define ICM42670_FIFO_COUNTH    0x3D
+#define ICM42670_FIFO_DATA      0x3F
+#define ICM42670_BLK_SEL_W      0x79
+#define ICM42670_MADDR_W        0x7A
+#define ICM42670_M_W            0x7B
+#define ICM42670_BLK_SEL_R      0x7C
+#define ICM42670_MADDR_R        0x7D
+#define ICM42670_M_R            0x7E
+
+/* ICM42670 MREG1 register (accessed through BLK_SEL, MADDR and M registers) */
+#define ICM42670_MREG1_FIFO_CONFIG5     0x01
+#define ICM42670_MREG1_SENSOR_CONFIG3   0x06
+#define ICM42670_MREG1_INT_SOURCE6      0x2F
+#define ICM42670_MREG1_ACCEL_WOM_X_THR  0x4B
+
+/* Register bits */
+#define ICM42670_FIFO_FLUSH             BIT2
+#define ICM42670_INT1_LATCHED           BIT2
+#define ICM42670_INT1_PUSH_PULL         BIT1
+#define ICM42670_INT1_ACTIVE_HIGH       BIT0
+#define ICM42670_FIFO_BYPASS            BIT0
+#define ICM42670_FIFO_COUNT_RECORDS     BIT6
+#define ICM42670_FIFO_WM_GT_TH          BIT5
+#define ICM42670_FIFO_GYRO_EN           BIT1
+#define ICM42670_FIFO_ACCEL_EN          BIT0
+#define ICM42670_FIFO_THS_INT1_EN       BIT2
+#define ICM42670_FIFO_FULL_INT          BIT1
+#define ICM42670_WOM_INT1_EN            (BIT2 | BIT1 | BIT0)
+#define ICM42670_WOM_EN                 BIT0
+#define ICM42670_WOM_MODE_PREVIOUS      BIT1
+#define ICM42670_DMP_INIT_EN            BIT2
+#define ICM42670_DMP_MEM_RESET_EN       BIT0
+#define ICM42670_DMP_ODR_50HZ           0x02
+#define ICM42670_APEX_DISABLE           BIT6
+#define ICM42670_STEP_DET_INT1_EN       BIT5
+#define ICM42670_TILT_DET_INT1_EN       BIT3
+#define ICM42670_INT_STATUS3_STEP_DET   BIT5
+#define ICM42670_INT_STATUS3_TILT_DET   BIT3
+
+/* FIFO packet header */
+#define ICM42670_FIFO_HEADER_MSG        BIT7 /* FIFO is empty */
+#define ICM42670_FIFO_HEADER_ACCEL      BIT6
+#define ICM42670_FIFO_HEADER_GYRO       BIT5
 
 /* Sensitivity of the gyroscope */
 #define GYRO_FS_2000_SENSITIVITY (16.4)
@@ -48,18 +113,40 @@
 typedef struct {
     i2c_port_t bus;
     uint8_t dev_addr;
+    uint8_t cmd_buf[I2C_LINK_RECOMMENDED_SIZE(2)]; /* Command link of the device, no heap allocation per access */
     uint32_t counter;
     float dt;  /*!< delay time between two measurements, dt should be small (ms level) */
     struct timeval *timer;
+    float acce_sensitivity;         /* Sensitivities of the configured ranges (0: not known yet) */
+    float gyro_sensitivity;
+    bool int_active_high;
+    struct icm42670_fifo_stream_s *stream;
 } icm42670_dev_t;
 
+typedef struct icm42670_fifo_stream_s {
+    icm42670_fifo_stream_config_t config;
+    TaskHandle_t task;
+    SemaphoreHandle_t exited;
+    uint8_t *buf;                   /* Raw packets of one burst */
+    icm42670_fifo_sample_t *samples;
+    uint32_t period_us;             /* Period of packets (the higher ODR of the sensors) */
+    uint32_t overflow_cnt;
+    volatile bool running;
+} icm42670_fifo_stream_t;
+
 /*******************************************************************************
 * Function definitions
 *******************************************************************************/
 static esp_err_t icm42670_write(icm42670_handle_t sensor, const uint8_t reg_start_addr, const uint8_t *data_buf, const uint8_t data_len);
-static esp_err_t icm42670_read(icm42670_handle_t sensor, const uint8_t reg_start_addr, uint8_t *data_buf, const uint8_t data_len);
+static esp_err_t icm42670_read(icm42670_handle_t sensor, const uint8_t reg_start_addr, uint8_t *data_buf, const size_t data_len);
+static esp_err_t icm42670_write_mreg(icm42670_handle_t sensor, const uint8_t reg, const uint8_t value);
+static esp_err_t icm42670_read_mreg(icm42670_handle_t sensor, const uint8_t reg, uint8_t *value);
+static esp_err_t icm42670_update_reg(icm42670_handle_t sensor, const uint8_t reg, const uint8_t mask, const uint8_t value);
 
 static esp_err_t icm42670_get_raw_value(icm42670_handle_t sensor, uint8_t reg, icm42670_raw_value_t *value);
+static uint16_t icm42670_fifo_parse(const uint8_t *buf, icm42670_fifo_sample_t *samples, uint16_t count);
+static void icm42670_fifo_isr(void *arg);
+static void icm42670_fifo_task(void *arg);
 
 /*******************************************************************************
 * Local variables
@@ -95,6 +182,10 @@ void icm42670_delete(icm42670_handle_t sensor)
 {
     icm42670_dev_t *sens = (icm42670_dev_t *) sensor;
 
+    if (sens->stream) {
+        icm42670_fifo_stream_stop(sensor, NULL);
+    }
+
     if (sens->timer) {
         free(sens->timer);
     }
@@ -117,6 +208,8 @@ esp_err_t icm42670_get_deviceid(icm42670_handle_t sensor, uint8_t *deviceid)
 
 esp_err_t icm42670_config(icm42670_handle_t sensor, const icm42670_cfg_t *config)
 {
+    icm42670_dev_t *sens = (icm42670_dev_t *) sensor;
+    esp_err_t ret = ESP_FAIL;
     uint8_t data[2];
 
     assert(config != NULL);
@@ -126,7 +219,18 @@ esp_err_t icm42670_config(icm42670_handle_t sensor, const icm42670_cfg_t *config
     /* Accelerometer */
     data[1] = ((config->acce_fs & 0x03) << 5) | (config->acce_odr & 0x0F);
 
-    return icm42670_write(sensor, ICM42670_GYRO_CONFIG0, data, sizeof(data));
+    ret = icm42670_write(sensor, ICM42670_GYRO_CONFIG0, data, sizeof(data));
+    ESP_RETURN_ON_ERROR(ret, TAG, "Config error!");
+
+    /* Sensitivities are stored for icm42670_get_all_value() */
+    sens->acce_sensitivity = 0;
+    sens->gyro_sensitivity = 0;
+    ret = icm42670_get_acce_sensitivity(sensor, &sens->acce_sensitivity);
+    if (ret == ESP_OK) {
+        ret = icm42670_get_gyro_sensitivity(sensor, &sens->gyro_sensitivity);
+    }
+
+    return ret;
 }
 
 esp_err_t icm42670_acce_set_pwr(icm42670_handle_t sensor, icm42670_acce_pwr_t state)
@@ -136,6 +240,7 @@ esp_err_t icm42670_acce_set_pwr(icm42670_handle_t sensor, icm42670_acce_pwr_t st
 
     ret = icm42670_read(sensor, ICM42670_PWR_MGMT0, &data, 1);
     if (ret == ESP_OK) {
+        data &= ~0x03;
         data |= (state & 0x03);
 
         ret = icm42670_write(sensor, ICM42670_PWR_MGMT0, &data, sizeof(data));
@@ -151,6 +256,7 @@ esp_err_t icm42670_gyro_set_pwr(icm42670_handle_t sensor, icm42670_gyro_pwr_t st
 
     ret = icm42670_read(sensor, ICM42670_PWR_MGMT0, &data, 1);
     if (ret == ESP_OK) {
+        data &= ~(0x03 << 2);
         data |= ((state & 0x03) << 2);
 
         ret = icm42670_write(sensor, ICM42670_PWR_MGMT0, &data, sizeof(data));
@@ -170,7 +276,7 @@ esp_err_t icm42670_get_acce_sensitivity(icm42670_handle_t sensor, float *sensiti
 
     ret = icm42670_read(sensor, ICM42670_ACCEL_CONFIG0, &acce_fs, 1);
     if (ret == ESP_OK) {
-        acce_fs = (acce_fs >> 3) & 0x03;
+        acce_fs = (acce_fs >> 5) & 0x03;
         switch (acce_fs) {
         case ACCE_FS_16G:
             *sensitivity = ACCE_FS_16G_SENSITIVITY;
@@ -199,9 +305,9 @@ esp_err_t icm42670_get_gyro_sensitivity(icm42670_handle_t sensor, float *sensiti
 
     *sensitivity = 0;
 
-    ret = icm42670_read(sensor, ICM42670_ACCEL_CONFIG0, &gyro_fs, 1);
+    ret = icm42670_read(sensor, ICM42670_GYRO_CONFIG0, &gyro_fs, 1);
     if (ret == ESP_OK) {
-        gyro_fs = (gyro_fs >> 3) & 0x03;
+        gyro_fs = (gyro_fs >> 5) & 0x03;
         switch (gyro_fs) {
         case GYRO_FS_2000DPS:
             *sensitivity = GYRO_FS_2000_SENSITIVITY;
@@ -310,11 +416,381 @@ esp_err_t icm42670_get_temp_value(icm42670_handle_t sensor, float *value)
     ret = icm42670_get_temp_raw_value(sensor, &raw_value);
     ESP_RETURN_ON_ERROR(ret, TAG, "Get raw value error!");
 
-    *value = (raw_value / 128) + 25;
+    *value = ((int16_t)raw_value / 128.0f) + 25;
+
+    return ESP_OK;
+}
+
+esp_err_t icm42670_get_all_raw_value(icm42670_handle_t sensor, icm42670_raw_value_t *acce_value, icm42670_raw_value_t *gyro_value,
+                                     uint16_t *temp_value)
+{
+    esp_err_t ret = ESP_FAIL;
+    uint8_t data[14];
+
+    assert(acce_value != NULL);
+    assert(gyro_value != NULL);
+
+    /* Temperature, accelerometer and gyroscope registers are contiguous */
+    ret = icm42670_read(sensor, ICM42670_TEMP_DATA, data, sizeof(data));
+    if (ret == ESP_OK) {
+        if (temp_value) {
+            *temp_value = (uint16_t)((data[0] << 8) + data[1]);
+        }
+        acce_value->x = (int16_t)((data[2] << 8) + data[3]);
+        acce_value->y = (int16_t)((data[4] << 8) + data[5]);
+        acce_value->z = (int16_t)((data[6] << 8) + data[7]);
+        gyro_value->x = (int16_t)((data[8] << 8) + data[9]);
+        gyro_value->y = (int16_t)((data[10] << 8) + data[11]);
+        gyro_value->z = (int16_t)((data[12] << 8) + data[13]);
+    }
+
+    return ret;
+}
+
+esp_err_t icm42670_get_all_value(icm42670_handle_t sensor, icm42670_value_t *acce_value, icm42670_value_t *gyro_value, float *temp_value)
+{
+    esp_err_t ret;
+    icm42670_dev_t *sens = (icm42670_dev_t *) sensor;
+    icm42670_raw_value_t raw_acce;
+    icm42670_raw_value_t raw_gyro;
+    uint16_t raw_temp;
+
+    assert(acce_value != NULL);
+    assert(gyro_value != NULL);
+
+    /* Without icm42670_config(), the sensitivities are read only once */
+    if (sens->acce_sensitivity == 0 || sens->gyro_sensitivity == 0) {
+        ret = icm42670_get_acce_sensitivity(sensor, &sens->acce_sensitivity);
+        ESP_RETURN_ON_ERROR(ret, TAG, "Get sensitivity error!");
+        ret = icm42670_get_gyro_sensitivity(sensor, &sens->gyro_sensitivity);
+        ESP_RETURN_ON_ERROR(ret, TAG, "Get sensitivity error!");
+    }
+
+    ret = icm42670_get_all_raw_value(sensor, &raw_acce, &raw_gyro, &raw_temp);
+    ESP_RETURN_ON_ERROR(ret, TAG, "Get raw value error!");
+
+    acce_value->x = raw_acce.x / sens->acce_sensitivity;
+    acce_value->y = raw_acce.y / sens->acce_sensitivity;
+    acce_value->z = raw_acce.z / sens->acce_sensitivity;
+    gyro_value->x = raw_gyro.x / sens->gyro_sensitivity;
+    gyro_value->y = raw_gyro.y / sens->gyro_sensitivity;
+    gyro_value->z = raw_gyro.z / sens->gyro_sensitivity;
+    if (temp_value) {
+        *temp_value = ((int16_t)raw_temp / 128.0f) + 25;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t icm42670_config_int(icm42670_handle_t sensor, const icm42670_int_cfg_t *config)
+{
+    icm42670_dev_t *sens = (icm42670_dev_t *) sensor;
+    uint8_t data = 0;
+
+    assert(config != NULL);
+
+    if (config->active_high) {
+        data |= ICM42670_INT1_ACTIVE_HIGH;
+    }
+    if (config->push_pull) {
+        data |= ICM42670_INT1_PUSH_PULL;
+    }
+    if (config->latched) {
+        data |= ICM42670_INT1_LATCHED;
+    }
+    ESP_RETURN_ON_ERROR(icm42670_update_reg(sensor, ICM42670_INT_CONFIG, 0x07, data), TAG, "INT config error!");
+    sens->int_active_high = config->active_high;
+
+    return ESP_OK;
+}
+
+esp_err_t icm42670_fifo_enable(icm42670_handle_t sensor, uint16_t watermark)
+{
+    ESP_RETURN_ON_FALSE(watermark <= ICM42670_FIFO_PACKETS_MAX, ESP_ERR_INVALID_ARG, TAG, "Invalid watermark!");
+
+    /* Bypass FIFO during the configuration */
+    ESP_RETURN_ON_ERROR(icm42670_update_reg(sensor, ICM42670_FIFO_CONFIG1, 0x03, ICM42670_FIFO_BYPASS), TAG, "FIFO config error!");
+    /* Count and watermark are in packets, not in bytes */
+    ESP_RETURN_ON_ERROR(icm42670_update_reg(sensor, ICM42670_INTF_CONFIG0, ICM42670_FIFO_COUNT_RECORDS, ICM42670_FIFO_COUNT_RECORDS),
+                        TAG, "FIFO count config error!");
+    /* Both sensors in one packet, interrupt at each packet above the watermark */
+    ESP_RETURN_ON_ERROR(icm42670_write_mreg(sensor, ICM42670_MREG1_FIFO_CONFIG5,
+                                            ICM42670_FIFO_WM_GT_TH | ICM42670_FIFO_GYRO_EN | ICM42670_FIFO_ACCEL_EN),
+                        TAG, "FIFO config error!");
+
+    const uint8_t wm[2] = {watermark & 0xFF, (watermark >> 8) & 0x0F};
+    ESP_RETURN_ON_ERROR(icm42670_write(sensor, ICM42670_FIFO_CONFIG2, wm, sizeof(wm)), TAG, "FIFO watermark error!");
+    ESP_RETURN_ON_ERROR(icm42670_update_reg(sensor, ICM42670_INT_SOURCE0, ICM42670_FIFO_THS_INT1_EN,
+                                            watermark ? ICM42670_FIFO_THS_INT1_EN : 0), TAG, "FIFO interrupt error!");
+
+    /* Stream mode */
+    ESP_RETURN_ON_ERROR(icm42670_update_reg(sensor, ICM42670_FIFO_CONFIG1, 0x03, 0), TAG, "FIFO config error!");
+    ESP_RETURN_ON_ERROR(icm42670_update_reg(sensor, ICM42670_SIGNAL_PATH_RESET, ICM42670_FIFO_FLUSH, ICM42670_FIFO_FLUSH),
+                        TAG, "FIFO flush error!");
+    esp_rom_delay_us(10);
+
+    return ESP_OK;
+}
+
+esp_err_t icm42670_fifo_disable(icm42670_handle_t sensor)
+{
+    ESP_RETURN_ON_ERROR(icm42670_update_reg(sensor, ICM42670_INT_SOURCE0, ICM42670_FIFO_THS_INT1_EN, 0), TAG, "FIFO interrupt error!");
+    ESP_RETURN_ON_ERROR(icm42670_write_mreg(sensor, ICM42670_MREG1_FIFO_CONFIG5, 0), TAG, "FIFO config error!");
+    return icm42670_update_reg(sensor, ICM42670_FIFO_CONFIG1, 0x03, ICM42670_FIFO_BYPASS);
+}
+
+esp_err_t icm42670_fifo_get_count(icm42670_handle_t sensor, uint16_t *count)
+{
+    esp_err_t ret = ESP_FAIL;
+    uint8_t data[2];
+
+    assert(count != NULL);
+
+    *count = 0;
+
+    ret = icm42670_read(sensor, ICM42670_FIFO_COUNTH, data, sizeof(data));
+    if (ret == ESP_OK) {
+        *count = (uint16_t)((data[0] << 8) + data[1]);
+    }
+
+    return ret;
+}
+
+esp_err_t icm42670_fifo_read(icm42670_handle_t sensor, icm42670_fifo_sample_t *samples, uint16_t count, uint16_t *valid)
+{
+    esp_err_t ret = ESP_FAIL;
+
+    assert(samples != NULL);
+    assert(valid != NULL);
+
+    *valid = 0;
+    ESP_RETURN_ON_FALSE(count > 0 && count <= ICM42670_FIFO_PACKETS_MAX, ESP_ERR_INVALID_ARG, TAG, "Invalid count!");
+
+    uint8_t *buf = malloc(count * ICM42670_FIFO_PACKET_SIZE);
+    ESP_RETURN_ON_FALSE(buf, ESP_ERR_NO_MEM, TAG, "Not enough memory!");
+
+    /* FIFO_DATA address does not increment, all packets are read in one transaction */
+    ret = icm42670_read(sensor, ICM42670_FIFO_DATA, buf, count * ICM42670_FIFO_PACKET_SIZE);
+    if (ret == ESP_OK) {
+        *valid = icm42670_fifo_parse(buf, samples, count);
+    }
+    free(buf);
+
+    return ret;
+}
+
+static void icm42670_fifo_stream_free(icm42670_fifo_stream_t *stream)
+{
+    if (stream->exited) {
+        vSemaphoreDelete(stream->exited);
+    }
+    free(stream->buf);
+    free(stream->samples);
+    free(stream);
+}
+
+esp_err_t icm42670_fifo_stream_start(icm42670_handle_t sensor, const icm42670_fifo_stream_config_t *config)
+{
+    esp_err_t ret = ESP_OK;
+    BaseType_t res;
+    uint8_t odr[2];
+    icm42670_dev_t *sens = (icm42670_dev_t *) sensor;
+
+    assert(config != NULL);
+
+    ESP_RETURN_ON_FALSE(config->callback && config->watermark > 0 && config->watermark <= ICM42670_FIFO_PACKETS_MAX,
+                        ESP_ERR_INVALID_ARG, TAG, "Invalid configuration!");
+    ESP_RETURN_ON_FALSE(config->int_pin == GPIO_NUM_NC || GPIO_IS_VALID_GPIO(config->int_pin), ESP_ERR_INVALID_ARG, TAG, "Invalid INT pin!");
+    ESP_RETURN_ON_FALSE(sens->stream == NULL, ESP_ERR_INVALID_STATE, TAG, "Stream is running!");
+
+    /* Packets are stored with the higher ODR (ODR 5 is 1.6 kHz, each step halves it) */
+    ESP_RETURN_ON_ERROR(icm42670_read(sensor, ICM42670_GYRO_CONFIG0, odr, sizeof(odr)), TAG, "Read ODR error!");
+    const uint8_t odr_max = MIN(MAX(MIN(odr[0] & 0x0F, odr[1] & 0x0F), 5), 15);
+
+    icm42670_fifo_stream_t *stream = calloc(1, sizeof(icm42670_fifo_stream_t));
+    ESP_RETURN_ON_FALSE(stream, ESP_ERR_NO_MEM, TAG, "Not enough memory!");
+    stream->config = *config;
+    stream->period_us = 625u << (odr_max - 5);
+    stream->buf = malloc(config->watermark * ICM42670_FIFO_PACKET_SIZE);
+    stream->samples = malloc(config->watermark * sizeof(icm42670_fifo_sample_t));
+    stream->exited = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(stream->buf && stream->samples && stream->exited, ESP_ERR_NO_MEM, err, TAG, "Not enough memory!");
+
+    ESP_GOTO_ON_ERROR(icm42670_fifo_enable(sensor, config->int_pin == GPIO_NUM_NC ? 0 : config->watermark), err, TAG, "FIFO enable error!");
+    stream->running = true;
+    sens->stream = stream;
+
+    if (config->task_affinity < 0) {
+        res = xTaskCreate(icm42670_fifo_task, "icm42670_fifo", config->task_stack, sens, config->task_priority, &stream->task);
+    } else {
+        res = xTaskCreatePinnedToCore(icm42670_fifo_task, "icm42670_fifo", config->task_stack, sens, config->task_priority,
+                                      &stream->task, config->task_affinity);
+    }
+    ESP_GOTO_ON_FALSE(res == pdPASS, ESP_ERR_NO_MEM, err_fifo, TAG, "Create task failed!");
+
+    if (config->int_pin != GPIO_NUM_NC) {
+        const gpio_config_t int_gpio_config = {
+            .mode = GPIO_MODE_INPUT,
+            .intr_type = sens->int_active_high ? GPIO_INTR_POSEDGE : GPIO_INTR_NEGEDGE,
+            .pin_bit_mask = (1ULL << config->int_pin),
+        };
+        ret = gpio_config(&int_gpio_config);
+        if (ret == ESP_OK) {
+            ret = gpio_isr_handler_add(config->int_pin, icm42670_fifo_isr, stream);
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "INT pin config error!");
+            stream->running = false;
+            xTaskNotifyGive(stream->task);
+            xSemaphoreTake(stream->exited, portMAX_DELAY);
+            goto err_fifo;
+        }
+    }
+
+    return ESP_OK;
+
+err_fifo:
+    sens->stream = NULL;
+    icm42670_fifo_disable(sensor);
+err:
+    icm42670_fifo_stream_free(stream);
+    return ret;
+}
+
+esp_err_t icm42670_fifo_stream_stop(icm42670_handle_t sensor, uint32_t *overflow_cnt)
+{
+    icm42670_dev_t *sens = (icm42670_dev_t *) sensor;
+    icm42670_fifo_stream_t *stream = sens->stream;
+
+    ESP_RETURN_ON_FALSE(stream, ESP_ERR_INVALID_STATE, TAG, "Stream is not running!");
+
+    if (stream->config.int_pin != GPIO_NUM_NC) {
+        gpio_isr_handler_remove(stream->config.int_pin);
+    }
+    /* The task finishes the running burst */
+    stream->running = false;
+    xTaskNotifyGive(stream->task);
+    xSemaphoreTake(stream->exited, portMAX_DELAY);
+
+    icm42670_fifo_disable(sensor);
+    if (overflow_cnt) {
+        *overflow_cnt = stream->overflow_cnt;
+    }
+    sens->stream = NULL;
+    icm42670_fifo_stream_free(stream);
 
     return ESP_OK;
 }
 
+esp_err_t icm42670_wom_enable(icm42670_handle_t sensor, const icm42670_wom_cfg_t *config)
+{
+    assert(config != NULL);
+
+    /* Same threshold on all axes */
+    for (int i = 0; i < 3; i++) {
+        ESP_RETURN_ON_ERROR(icm42670_write_mreg(sensor, ICM42670_MREG1_ACCEL_WOM_X_THR + i, config->threshold), TAG, "WOM threshold error!");
+    }
+
+    /* Any axis raises the interrupt */
+    uint8_t wom_config = ((config->duration & 0x03) << 3) | (config->compare_previous ? ICM42670_WOM_MODE_PREVIOUS : 0);
+    ESP_RETURN_ON_ERROR(icm42670_write(sensor, ICM42670_WOM_CONFIG, &wom_config, 1), TAG, "WOM config error!");
+    ESP_RETURN_ON_ERROR(icm42670_update_reg(sensor, ICM42670_INT_SOURCE1, ICM42670_WOM_INT1_EN, ICM42670_WOM_INT1_EN), TAG, "WOM interrupt error!");
+
+    wom_config |= ICM42670_WOM_EN;
+    return icm42670_write(sensor, ICM42670_WOM_CONFIG, &wom_config, 1);
+}
+
+esp_err_t icm42670_wom_disable(icm42670_handle_t sensor)
+{
+    ESP_RETURN_ON_ERROR(icm42670_update_reg(sensor, ICM42670_WOM_CONFIG, ICM42670_WOM_EN, 0), TAG, "WOM config error!");
+    return icm42670_update_reg(sensor, ICM42670_INT_SOURCE1, ICM42670_WOM_INT1_EN, 0);
+}
+
+esp_err_t icm42670_apex_enable(icm42670_handle_t sensor, uint8_t features)
+{
+    const uint8_t all_features = ICM42670_APEX_PEDOMETER | ICM42670_APEX_TILT;
+    uint8_t data;
+
+    ESP_RETURN_ON_FALSE(features != 0 && (features & ~all_features) == 0, ESP_ERR_INVALID_ARG, TAG, "Invalid features!");
+
+    /* Features are off during DMP initialization */
+    data = ICM42670_DMP_ODR_50HZ;
+    ESP_RETURN_ON_ERROR(icm42670_write(sensor, ICM42670_APEX_CONFIG1, &data, 1), TAG, "APEX config error!");
+    ESP_RETURN_ON_ERROR(icm42670_read_mreg(sensor, ICM42670_MREG1_SENSOR_CONFIG3, &data), TAG, "APEX config error!");
+    data &= ~ICM42670_APEX_DISABLE;
+    ESP_RETURN_ON_ERROR(icm42670_write_mreg(sensor, ICM42670_MREG1_SENSOR_CONFIG3, data), TAG, "APEX config error!");
+
+    ESP_RETURN_ON_ERROR(icm42670_update_reg(sensor, ICM42670_APEX_CONFIG0, ICM42670_DMP_MEM_RESET_EN, ICM42670_DMP_MEM_RESET_EN),
+                        TAG, "DMP reset error!");
+    vTaskDelay(pdMS_TO_TICKS(1) + 1);
+    ESP_RETURN_ON_ERROR(icm42670_update_reg(sensor, ICM42670_APEX_CONFIG0, ICM42670_DMP_INIT_EN, ICM42670_DMP_INIT_EN),
+                        TAG, "DMP init error!");
+    vTaskDelay(pdMS_TO_TICKS(50) + 1);
+
+    data = 0;
+    if (features & ICM42670_APEX_PEDOMETER) {
+        data |= ICM42670_STEP_DET_INT1_EN;
+    }
+    if (features & ICM42670_APEX_TILT) {
+        data |= ICM42670_TILT_DET_INT1_EN;
+    }
+    ESP_RETURN_ON_ERROR(icm42670_write_mreg(sensor, ICM42670_MREG1_INT_SOURCE6, data), TAG, "APEX interrupt error!");
+
+    data = features | ICM42670_DMP_ODR_50HZ;
+    return icm42670_write(sensor, ICM42670_APEX_CONFIG1, &data, 1);
+}
+
+esp_err_t icm42670_apex_disable(icm42670_handle_t sensor)
+{
+    uint8_t data = ICM42670_DMP_ODR_50HZ;
+
+    ESP_RETURN_ON_ERROR(icm42670_write(sensor, ICM42670_APEX_CONFIG1, &data, 1), TAG, "APEX config error!");
+    return icm42670_write_mreg(sensor, ICM42670_MREG1_INT_SOURCE6, 0);
+}
+
+esp_err_t icm42670_apex_get_step_count(icm42670_handle_t sensor, uint16_t *steps)
+{
+    esp_err_t ret = ESP_FAIL;
+    uint8_t data[2];
+
+    assert(steps != NULL);
+
+    *steps = 0;
+
+    ret = icm42670_read(sensor, ICM42670_APEX_DATA0, data, sizeof(data));
+    if (ret == ESP_OK) {
+        *steps = (uint16_t)((data[1] << 8) + data[0]);
+    }
+
+    return ret;
+}
+
+esp_err_t icm42670_get_motion_events(icm42670_handle_t sensor, uint8_t *events)
+{
+    esp_err_t ret = ESP_FAIL;
+    uint8_t status[2];
+
+    assert(events != NULL);
+
+    *events = 0;
+
+    /* INT_STATUS2 (wake on motion) and INT_STATUS3 (APEX) are cleared on read */
+    ret = icm42670_read(sensor, ICM42670_INT_STATUS2, status, sizeof(status));
+    if (ret == ESP_OK) {
+        if (status[0] & ICM42670_WOM_INT1_EN) {
+            *events |= ICM42670_EVENT_WOM;
+        }
+        if (status[1] & ICM42670_INT_STATUS3_STEP_DET) {
+            *events |= ICM42670_EVENT_STEP;
+        }
+        if (status[1] & ICM42670_INT_STATUS3_TILT_DET) {
+            *events |= ICM42670_EVENT_TILT;
+        }
+    }
+
+    return ret;
+}
+
 /*******************************************************************************
 * Private functions
 *******************************************************************************/
@@ -347,7 +823,7 @@ static esp_err_t icm42670_write(icm42670_handle_t sensor, const uint8_t reg_star
 
     assert(sens);
 
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(sens->cmd_buf, sizeof(sens->cmd_buf));
     ret = i2c_master_start(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_write_byte(cmd, (sens->dev_addr << 1) | I2C_MASTER_WRITE, true);
@@ -359,12 +835,12 @@ static esp_err_t icm42670_write(icm42670_handle_t sensor, const uint8_t reg_star
     ret = i2c_master_stop(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_cmd_begin(sens->bus, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
+    i2c_cmd_link_delete_static(cmd);
 
     return ret;
 }
 
-static esp_err_t icm42670_read(icm42670_handle_t sensor, const uint8_t reg_start_addr, uint8_t *data_buf, const uint8_t data_len)
+static esp_err_t icm42670_read(icm42670_handle_t sensor, const uint8_t reg_start_addr, uint8_t *data_buf, const size_t data_len)
 {
     icm42670_dev_t *sens = (icm42670_dev_t *) sensor;
     uint8_t reg_buff[] = {reg_start_addr};
@@ -375,6 +851,127 @@ static esp_err_t icm42670_read(icm42670_handle_t sensor, const uint8_t reg_start
     return i2c_master_write_read_device(sens->bus, sens->dev_addr, reg_buff, sizeof(reg_buff), data_buf, data_len, 1000 / portTICK_PERIOD_MS);
 }
 
+static esp_err_t icm42670_write_mreg(icm42670_handle_t sensor, const uint8_t reg, const uint8_t value)
+{
+    const uint8_t blk_sel = 0x00; /* MREG1 */
+
+    ESP_RETURN_ON_ERROR(icm42670_write(sensor, ICM42670_BLK_SEL_W, &blk_sel, 1), TAG, "MREG select error!");
+    ESP_RETURN_ON_ERROR(icm42670_write(sensor, ICM42670_MADDR_W, &reg, 1), TAG, "MREG address error!");
+    ESP_RETURN_ON_ERROR(icm42670_write(sensor, ICM42670_M_W, &value, 1), TAG, "MREG write error!");
+    /* The sensor needs 10 us to finish the access */
+    esp_rom_delay_us(10);
+
+    return ESP_OK;
+}
+
+static esp_err_t icm42670_read_mreg(icm42670_handle_t sensor, const uint8_t reg, uint8_t *value)
+{
+    const uint8_t blk_sel = 0x00; /* MREG1 */
+
+    ESP_RETURN_ON_ERROR(icm42670_write(sensor, ICM42670_BLK_SEL_R, &blk_sel, 1), TAG, "MREG select error!");
+    ESP_RETURN_ON_ERROR(icm42670_write(sensor, ICM42670_MADDR_R, &reg, 1), TAG, "MREG address error!");
+    esp_rom_delay_us(10);
+
+    return icm42670_read(sensor, ICM42670_M_R, value, 1);
+}
+
+static esp_err_t icm42670_update_reg(icm42670_handle_t sensor, const uint8_t reg, const uint8_t mask, const uint8_t value)
+{
+    esp_err_t ret = ESP_FAIL;
+    uint8_t data;
+
+    ret = icm42670_read(sensor, reg, &data, 1);
+    if (ret == ESP_OK) {
+        data = (data & ~mask) | (value & mask);
+        ret = icm42670_write(sensor, reg, &data, 1);
+    }
+
+    return ret;
+}
+
+static uint16_t icm42670_fifo_parse(const uint8_t *buf, icm42670_fifo_sample_t *samples, uint16_t count)
+{
+    uint16_t valid = 0;
+
+    for (uint16_t i = 0; i < count; i++) {
+        const uint8_t *packet = &buf[i * ICM42670_FIFO_PACKET_SIZE];
+        const uint8_t sensors = ICM42670_FIFO_HEADER_ACCEL | ICM42670_FIFO_HEADER_GYRO;
+        if ((packet[0] & ICM42670_FIFO_HEADER_MSG) || (packet[0] & sensors) != sensors) {
+            continue;
+        }
+        icm42670_fifo_sample_t *sample = &samples[valid++];
+        sample->acce.x = (int16_t)((packet[1] << 8) + packet[2]);
+        sample->acce.y = (int16_t)((packet[3] << 8) + packet[4]);
+        sample->acce.z = (int16_t)((packet[5] << 8) + packet[6]);
+        sample->gyro.x = (int16_t)((packet[7] << 8) + packet[8]);
+        sample->gyro.y = (int16_t)((packet[9] << 8) + packet[10]);
+        sample->gyro.z = (int16_t)((packet[11] << 8) + packet[12]);
+        sample->raw_temp = (int8_t)packet[13];
+        sample->tmst = (uint16_t)((packet[14] << 8) + packet[15]);
+    }
+
+    return valid;
+}
+
+static void IRAM_ATTR icm42670_fifo_isr(void *arg)
+{
+    icm42670_fifo_stream_t *stream = (icm42670_fifo_stream_t *) arg;
+    BaseType_t task_woken = pdFALSE;
+
+    vTaskNotifyGiveFromISR(stream->task, &task_woken);
+    if (task_woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static void icm42670_fifo_task(void *arg)
+{
+    icm42670_dev_t *sens = (icm42670_dev_t *) arg;
+    icm42670_fifo_stream_t *stream = sens->stream;
+    const uint16_t watermark = stream->config.watermark;
+    const uint32_t burst_us = watermark * stream->period_us;
+    const bool use_isr = (stream->config.int_pin != GPIO_NUM_NC);
+    /* With interrupts, the timeout only recovers from a lost interrupt */
+    const TickType_t wait = MAX(pdMS_TO_TICKS((use_isr ? 2 : 1) * burst_us / 1000), 1);
+
+    while (stream->running) {
+        ulTaskNotifyTake(pdTRUE, wait);
+        if (!stream->running) {
+            break;
+        }
+
+        /* Reading the status clears latched interrupt */
+        uint8_t int_status;
+        uint16_t count;
+        if (icm42670_read(sens, ICM42670_INT_STATUS, &int_status, 1) != ESP_OK) {
+            continue;
+        }
+        if (int_status & ICM42670_FIFO_FULL_INT) {
+            stream->overflow_cnt++;
+            ESP_LOGW(TAG, "FIFO full, packets lost");
+        }
+        if (icm42670_fifo_get_count(sens, &count) != ESP_OK || count < watermark) {
+            continue;
+        }
+        const int64_t now = esp_timer_get_time();
+
+        /* The newest packet in FIFO was sampled now, the burst contains the oldest packets */
+        if (icm42670_read(sens, ICM42670_FIFO_DATA, stream->buf, watermark * ICM42670_FIFO_PACKET_SIZE) != ESP_OK) {
+            continue;
+        }
+        const uint16_t valid = icm42670_fifo_parse(stream->buf, stream->samples, watermark);
+        for (uint16_t i = 0; i < valid; i++) {
+            stream->samples[i].timestamp_us = now - (int64_t)(count - 1 - i) * stream->period_us;
+        }
+        if (valid > 0) {
+            stream->config.callback(stream->samples, valid, stream->config.user_ctx);
+        }
+    }
+
+    xSemaphoreGive(stream->exited);
+    vTaskDelete(NULL);
+}
+
 esp_err_t icm42670_complimentory_filter(icm42670_handle_t sensor, const icm42670_value_t *const acce_value,
                                         const icm42670_value_t *const gyro_value, complimentary_angle_t *const complimentary_angle)
 {
@@ -10,7 +10,9 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include "driver/i2c.h"
+#include "driver/gpio.h"
 
 #define ICM42670_I2C_ADDRESS         0x68 /*!< I2C address with AD0 pin low */
 #define ICM42670_I2C_ADDRESS_1       0x69 /*!< I2C address with AD0 pin high */
@@ -93,6 +95,57 @@ typedef struct {
 
 typedef void *icm42670_handle_t;
 
+#define ICM42670_FIFO_PACKET_SIZE   16u  /*!< FIFO packet with accelerometer, gyroscope, temperature and timestamp */
+#define ICM42670_FIFO_PACKETS_MAX   144u /*!< Maximum count of packets in FIFO (2.25 kB) */
+
+/* Motion events returned by icm42670_get_motion_events() */
+#define ICM42670_EVENT_WOM          (1 << 0) /*!< Wake on motion */
+#define ICM42670_EVENT_STEP         (1 << 1) /*!< Step detected by pedometer */
+#define ICM42670_EVENT_TILT         (1 << 2) /*!< Tilt detected */
+
+/* APEX features of icm42670_apex_enable() */
+#define ICM42670_APEX_PEDOMETER     (1 << 3) /*!< Pedometer (step detection and step counter) */
+#define ICM42670_APEX_TILT          (1 << 4) /*!< Tilt detection */
+
+typedef struct {
+    bool active_high;   /*!< INT1 polarity (active low otherwise) */
+    bool push_pull;     /*!< INT1 drive circuit (open drain otherwise) */
+    bool latched;       /*!< INT1 is latched until the status is read (pulse otherwise) */
+} icm42670_int_cfg_t;
+
+typedef struct {
+    icm42670_raw_value_t acce;  /*!< Raw accelerometer measurement */
+    icm42670_raw_value_t gyro;  /*!< Raw gyroscope measurement */
+    int8_t raw_temp;            /*!< Raw temperature (0.5 degree Celsius per LSB, 0 is 25 degree Celsius) */
+    uint16_t tmst;              /*!< Timestamp of the sensor from the packet (wraps at 16 bits) */
+    int64_t timestamp_us;       /*!< Time of the sample (esp_timer time, estimated from the ODR) */
+} icm42670_fifo_sample_t;
+
+/**
+ * @brief Callback of FIFO samples
+ *
+ * @param samples samples read in one burst, the oldest one is the first
+ * @param count count of samples
+ * @param user_ctx user data from the stream configuration
+ */
+typedef void (*icm42670_fifo_cb_t)(const icm42670_fifo_sample_t *samples, size_t count, void *user_ctx);
+
+typedef struct {
+    uint16_t watermark;             /*!< Count of packets read in one I2C transaction (1 - ICM42670_FIFO_PACKETS_MAX) */
+    gpio_num_t int_pin;             /*!< GPIO connected to INT1 for FIFO watermark interrupt (GPIO_NUM_NC: FIFO is polled) */
+    icm42670_fifo_cb_t callback;    /*!< Callback of read samples */
+    void *user_ctx;                 /*!< User data for the callback */
+    int task_priority;              /*!< Priority of the stream task */
+    int task_stack;                 /*!< Stack size of the stream task [bytes] */
+    int task_affinity;              /*!< Core of the task (-1 for no affinity) */
+} icm42670_fifo_stream_config_t;
+
+typedef struct {
+    uint8_t threshold;          /*!< Threshold of acceleration change on each axis [1/256 g] */
+    bool compare_previous;      /*!< Compare with previous sample (with the initial sample otherwise) */
+    uint8_t duration;           /*!< Count of over-threshold samples to raise the interrupt minus one (0 - 3) */
+} icm42670_wom_cfg_t;
+
 /**
  * @brief Create and init sensor object and return a sensor handle
  *
@@ -256,6 +309,217 @@ esp_err_t icm42670_get_gyro_value(icm42670_handle_t sensor, icm42670_value_t *va
  */
 esp_err_t icm42670_get_temp_value(icm42670_handle_t sensor, float *value);
 
+/**
+ * @brief Read raw temperature, accelerometer and gyroscope measurements in one I2C transaction
+ *
+ * All values come from the same sample.
+ *
+ * @param sensor object handle of icm42670
+ * @param acce_value raw accelerometer measurements
+ * @param gyro_value raw gyroscope measurements
+ * @param temp_value raw temperature measurement (can be NULL)
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t icm42670_get_all_raw_value(icm42670_handle_t sensor, icm42670_raw_value_t *acce_value, icm42670_raw_value_t *gyro_value,
+                                     uint16_t *temp_value);
+
+/**
+ * @brief Read accelerometer, gyroscope and temperature values in one I2C transaction
+ *
+ * Sensitivities are stored by icm42670_config() (or read from the sensor once), so only one transaction is used.
+ *
+ * @param sensor object handle of icm42670
+ * @param acce_value accelerometer measurements
+ * @param gyro_value gyroscope measurements
+ * @param temp_value temperature measurement (can be NULL)
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t icm42670_get_all_value(icm42670_handle_t sensor, icm42670_value_t *acce_value, icm42670_value_t *gyro_value, float *temp_value);
+
+/**
+ * @brief Configure INT1 pin of the sensor
+ *
+ * @param sensor object handle of icm42670
+ * @param config INT1 pin configuration
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t icm42670_config_int(icm42670_handle_t sensor, const icm42670_int_cfg_t *config);
+
+/**
+ * @brief Enable FIFO with accelerometer and gyroscope packets
+ *
+ * Packets are stored with ODR set by icm42670_config(). FIFO is flushed.
+ *
+ * @param sensor object handle of icm42670
+ * @param watermark count of packets which raises FIFO threshold interrupt on INT1 (0: interrupt disabled)
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Invalid watermark
+ *     - ESP_FAIL Fail
+ */
+esp_err_t icm42670_fifo_enable(icm42670_handle_t sensor, uint16_t watermark);
+
+/**
+ * @brief Disable FIFO
+ *
+ * @param sensor object handle of icm42670
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t icm42670_fifo_disable(icm42670_handle_t sensor);
+
+/**
+ * @brief Get count of packets in FIFO
+ *
+ * @param sensor object handle of icm42670
+ * @param count count of packets
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t icm42670_fifo_get_count(icm42670_handle_t sensor, uint16_t *count);
+
+/**
+ * @brief Read packets from FIFO in one I2C transaction
+ *
+ * @note Host timestamps are not set, invalid packets are skipped
+ *
+ * @param sensor object handle of icm42670
+ * @param samples read samples
+ * @param count count of packets to read (see icm42670_fifo_get_count())
+ * @param valid count of valid samples
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Invalid count
+ *     - ESP_ERR_NO_MEM Not enough memory for the read buffer
+ *     - ESP_FAIL Fail
+ */
+esp_err_t icm42670_fifo_read(icm42670_handle_t sensor, icm42670_fifo_sample_t *samples, uint16_t count, uint16_t *valid);
+
+/**
+ * @brief Start streaming of FIFO samples
+ *
+ * FIFO is enabled and a task reads `watermark` packets in one I2C transaction and passes them to the callback.
+ * The task is woken by FIFO threshold interrupt on INT1 (see icm42670_config_int(), GPIO ISR service must be installed),
+ * or FIFO is polled once per watermark period without the INT pin.
+ *
+ * @note Do not access the sensor from other tasks while streaming
+ *
+ * @param sensor object handle of icm42670
+ * @param config stream configuration
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Invalid configuration
+ *     - ESP_ERR_INVALID_STATE Stream is running already
+ *     - ESP_ERR_NO_MEM Not enough memory for the stream
+ *     - ESP_FAIL Fail
+ */
+esp_err_t icm42670_fifo_stream_start(icm42670_handle_t sensor, const icm42670_fifo_stream_config_t *config);
+
+/**
+ * @brief Stop streaming of FIFO samples and disable FIFO
+ *
+ * @param sensor object handle of icm42670
+ * @param overflow_cnt count of FIFO full events during streaming (can be NULL)
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_STATE Stream is not running
+ */
+esp_err_t icm42670_fifo_stream_stop(icm42670_handle_t sensor, uint32_t *overflow_cnt);
+
+/**
+ * @brief Enable wake on motion interrupt on INT1
+ *
+ * @note Accelerometer must be powered on, low-power mode is recommended (see icm42670_acce_set_pwr())
+ *
+ * @param sensor object handle of icm42670
+ * @param config wake on motion configuration
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t icm42670_wom_enable(icm42670_handle_t sensor, const icm42670_wom_cfg_t *config);
+
+/**
+ * @brief Disable wake on motion
+ *
+ * @param sensor object handle of icm42670
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t icm42670_wom_disable(icm42670_handle_t sensor);
+
+/**
+ * @brief Enable APEX motion features with interrupts on INT1
+ *
+ * The features run on the sensor (DMP at 50 Hz), the host can sleep until the interrupt.
+ *
+ * @note Accelerometer must be powered on with ODR 50 Hz or higher, low-power mode is recommended
+ *
+ * @param sensor object handle of icm42670
+ * @param features ICM42670_APEX_PEDOMETER and/or ICM42670_APEX_TILT
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Invalid features
+ *     - ESP_FAIL Fail
+ */
+esp_err_t icm42670_apex_enable(icm42670_handle_t sensor, uint8_t features);
+
+/**
+ * @brief Disable all APEX motion features
+ *
+ * @param sensor object handle of icm42670
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t icm42670_apex_disable(icm42670_handle_t sensor);
+
+/**
+ * @brief Read step count of pedometer
+ *
+ * @param sensor object handle of icm42670
+ * @param steps count of steps since pedometer was enabled
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t icm42670_apex_get_step_count(icm42670_handle_t sensor, uint16_t *steps);
+
+/**
+ * @brief Read and clear motion events (wake on motion and APEX)
+ *
+ * @param sensor object handle of icm42670
+ * @param events ICM42670_EVENT_* bits
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t icm42670_get_motion_events(icm42670_handle_t sensor, uint8_t *events);
+
 /**
  * @brief use complimentory filter to caculate roll and pitch
  *
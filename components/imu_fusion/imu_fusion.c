@@ -0,0 +1,295 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "esp_check.h"
+#include "imu_fusion.h"
+
+static const char *TAG = "imu_fusion";
+
+/* Fixed-point angles are Q16 degrees, gains are Q15 */
+#define IMU_FUSION_Q16_DEG(deg)     ((int32_t)((deg) * 65536))
+#define IMU_FUSION_Q15_ONE          (32768)
+/* Gyroscope scale is Q24 degrees per LSB and sample, rates are Q8 LSB, so their product is Q32 degrees */
+#define IMU_FUSION_GYRO_SCALE_SHIFT (24)
+#define IMU_FUSION_RATE_SHIFT       (24 + 8 - 16)
+/* Bias follows still samples slowly after the initial estimation */
+#define IMU_FUSION_BIAS_TRACK_SHIFT (10)
+
+struct imu_fusion_s {
+    imu_fusion_config_t config;
+    bool initialized;
+    /* Fixed-point state */
+    int32_t angle_q[3];                 /* Roll, pitch and yaw (Q16 degrees) */
+    int32_t gyro_scale_q;
+    int32_t alpha_q;
+    /* Float state */
+    float angle[3];
+    float gyro_scale;
+    /* Gyroscope bias */
+    int32_t bias_q8[3];                 /* Raw bias (Q8) */
+    int32_t bias_sum[3];
+    uint32_t bias_cnt;
+    int32_t still_thr;                  /* Raw rotation rate */
+    int64_t acce_sq;                    /* Square of 1 g in raw units */
+};
+
+/* atan(z) for z in <0, 1> (Q15), result in Q16 degrees, error below 0.1 degree */
+static inline int32_t imu_fusion_atan_q(int32_t z)
+{
+    /* atan(z) = 45 z + z (1 - z) (14.02 + 3.80 z) [degree] */
+    const int32_t t = IMU_FUSION_Q16_DEG(14.02) + (int32_t)(((int64_t)IMU_FUSION_Q16_DEG(3.80) * z) >> 15);
+    const int32_t zz = (z * (IMU_FUSION_Q15_ONE - z)) >> 15;
+    return (int32_t)(((int64_t)IMU_FUSION_Q16_DEG(45) * z) >> 15) + (int32_t)(((int64_t)t * zz) >> 15);
+}
+
+static int32_t imu_fusion_atan2_q(int32_t y, int32_t x)
+{
+    const int32_t ax = abs(x);
+    const int32_t ay = abs(y);
+    int32_t angle;
+
+    if (ax == 0 && ay == 0) {
+        return 0;
+    } else if (ax >= ay) {
+        angle = imu_fusion_atan_q(((int64_t)ay << 15) / ax);
+    } else {
+        angle = IMU_FUSION_Q16_DEG(90) - imu_fusion_atan_q(((int64_t)ax << 15) / ay);
+    }
+    if (x < 0) {
+        angle = IMU_FUSION_Q16_DEG(180) - angle;
+    }
+    return (y < 0) ? -angle : angle;
+}
+
+static inline const int16_t *imu_fusion_at(const int16_t *first, size_t stride, size_t i)
+{
+    return (const int16_t *)((const uint8_t *)first + i * stride);
+}
+
+/* Still samples are averaged to the initial bias, then the bias follows them slowly */
+static void imu_fusion_update_bias(imu_fusion_handle_t handle, const int16_t *acce, const int16_t *gyro)
+{
+    const imu_fusion_config_t *cfg = &handle->config;
+    int32_t ref[3];
+
+    for (int k = 0; k < 3; k++) {
+        /* Before the estimation ends, the reference is the running mean */
+        ref[k] = (handle->bias_cnt < cfg->bias_samples) ? (handle->bias_cnt ? handle->bias_sum[k] / (int32_t)handle->bias_cnt : gyro[k])
+                 : (handle->bias_q8[k] >> 8);
+        if (abs(gyro[k] - ref[k]) > handle->still_thr) {
+            return;
+        }
+    }
+    /* Accelerometer measures only gravity (within 20 %) */
+    const int64_t a2 = (int64_t)acce[0] * acce[0] + (int64_t)acce[1] * acce[1] + (int64_t)acce[2] * acce[2];
+    if (llabs(a2 - handle->acce_sq) > handle->acce_sq / 5) {
+        return;
+    }
+
+    if (handle->bias_cnt < cfg->bias_samples) {
+        for (int k = 0; k < 3; k++) {
+            handle->bias_sum[k] += gyro[k];
+        }
+        if (++handle->bias_cnt == cfg->bias_samples) {
+            for (int k = 0; k < 3; k++) {
+                handle->bias_q8[k] = (handle->bias_sum[k] * 256) / (int32_t)handle->bias_cnt;
+            }
+        }
+    } else {
+        for (int k = 0; k < 3; k++) {
+            handle->bias_q8[k] += ((gyro[k] * 256) - handle->bias_q8[k]) >> IMU_FUSION_BIAS_TRACK_SHIFT;
+        }
+    }
+}
+
+static void imu_fusion_update_fixed(imu_fusion_handle_t handle, const imu_fusion_batch_t *batch, const int32_t acce_sum[3])
+{
+    const int32_t acce_roll = imu_fusion_atan2_q(acce_sum[1], acce_sum[2]);
+    const int32_t acce_pitch = imu_fusion_atan2_q(acce_sum[0], acce_sum[2]);
+    const int32_t bias[3] = {handle->bias_q8[0], handle->bias_q8[1], handle->bias_q8[2]};
+    int32_t roll = handle->initialized ? handle->angle_q[0] : acce_roll;
+    int32_t pitch = handle->initialized ? handle->angle_q[1] : acce_pitch;
+    int64_t yaw_sum = 0;
+    int32_t alpha_pow = IMU_FUSION_Q15_ONE;
+
+    /*
+     * angle = alpha * (angle + gyro * dt) + (1 - alpha) * acce_angle for each sample.
+     * With one accelerometer angle per batch, its term sums to (1 - alpha^n) * acce_angle.
+     */
+    for (size_t i = 0; i < batch->count; i++) {
+        const int16_t *g = imu_fusion_at(batch->gyro, batch->stride, i);
+        const int32_t rate_x = g[0] * 256 - bias[0];
+        const int32_t rate_y = g[1] * 256 - bias[1];
+        roll += (int32_t)(((int64_t)rate_x * handle->gyro_scale_q) >> IMU_FUSION_RATE_SHIFT);
+        pitch += (int32_t)(((int64_t)rate_y * handle->gyro_scale_q) >> IMU_FUSION_RATE_SHIFT);
+        roll = (int32_t)(((int64_t)roll * handle->alpha_q) >> 15);
+        pitch = (int32_t)(((int64_t)pitch * handle->alpha_q) >> 15);
+        alpha_pow = (alpha_pow * handle->alpha_q) >> 15;
+        yaw_sum += g[2] * 256 - bias[2];
+    }
+
+    const int32_t acce_weight = IMU_FUSION_Q15_ONE - alpha_pow;
+    handle->angle_q[0] = roll + (int32_t)(((int64_t)acce_roll * acce_weight) >> 15);
+    handle->angle_q[1] = pitch + (int32_t)(((int64_t)acce_pitch * acce_weight) >> 15);
+
+    /* Yaw has no reference, it is integrated and wrapped to +-180 degrees */
+    int32_t yaw = handle->angle_q[2] + (int32_t)((yaw_sum * handle->gyro_scale_q) >> IMU_FUSION_RATE_SHIFT);
+    while (yaw > IMU_FUSION_Q16_DEG(180)) {
+        yaw -= IMU_FUSION_Q16_DEG(360);
+    }
+    while (yaw < -IMU_FUSION_Q16_DEG(180)) {
+        yaw += IMU_FUSION_Q16_DEG(360);
+    }
+    handle->angle_q[2] = yaw;
+}
+
+static void imu_fusion_update_float(imu_fusion_handle_t handle, const imu_fusion_batch_t *batch, const int32_t acce_sum[3])
+{
+    const float rad_to_deg = 180.0f / M_PI;
+    const float acce_roll = atan2f(acce_sum[1], acce_sum[2]) * rad_to_deg;
+    const float acce_pitch = atan2f(acce_sum[0], acce_sum[2]) * rad_to_deg;
+    const float bias[3] = {handle->bias_q8[0] / 256.0f, handle->bias_q8[1] / 256.0f, handle->bias_q8[2] / 256.0f};
+    const float alpha = handle->config.alpha;
+    const float scale = handle->gyro_scale;
+    float roll = handle->initialized ? handle->angle[0] : acce_roll;
+    float pitch = handle->initialized ? handle->angle[1] : acce_pitch;
+    float yaw_sum = 0;
+    float alpha_pow = 1.0f;
+
+    /* Same recursion as the fixed-point variant */
+    for (size_t i = 0; i < batch->count; i++) {
+        const int16_t *g = imu_fusion_at(batch->gyro, batch->stride, i);
+        roll = alpha * (roll + (g[0] - bias[0]) * scale);
+        pitch = alpha * (pitch + (g[1] - bias[1]) * scale);
+        alpha_pow *= alpha;
+        yaw_sum += g[2] - bias[2];
+    }
+
+    handle->angle[0] = roll + (1.0f - alpha_pow) * acce_roll;
+    handle->angle[1] = pitch + (1.0f - alpha_pow) * acce_pitch;
+    handle->angle[2] = remainderf(handle->angle[2] + yaw_sum * scale, 360.0f);
+}
+
+esp_err_t imu_fusion_create(const imu_fusion_config_t *config, imu_fusion_handle_t *ret_handle)
+{
+    ESP_RETURN_ON_FALSE(config && ret_handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->sample_period > 0 && config->acce_sensitivity > 0 && config->gyro_sensitivity > 0,
+                        ESP_ERR_INVALID_ARG, TAG, "Invalid sample period or sensitivity");
+    ESP_RETURN_ON_FALSE(config->alpha >= 0 && config->alpha <= 1, ESP_ERR_INVALID_ARG, TAG, "Invalid alpha");
+    ESP_RETURN_ON_FALSE(config->bias_samples <= UINT16_MAX, ESP_ERR_INVALID_ARG, TAG, "Too many bias samples");
+    ESP_RETURN_ON_FALSE(config->mode == IMU_FUSION_FIXED_POINT || config->mode == IMU_FUSION_FLOAT, ESP_ERR_INVALID_ARG, TAG, "Invalid mode");
+
+    const float gyro_scale = config->sample_period / config->gyro_sensitivity;
+    /* One sample of full scale rotation must fit to the fixed-point scale */
+    ESP_RETURN_ON_FALSE(gyro_scale * (1 << IMU_FUSION_GYRO_SCALE_SHIFT) < INT32_MAX, ESP_ERR_INVALID_ARG, TAG, "Too long sample period");
+
+    imu_fusion_handle_t handle = calloc(1, sizeof(struct imu_fusion_s));
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_NO_MEM, TAG, "Not enough memory for IMU fusion");
+    handle->config = *config;
+    handle->gyro_scale = gyro_scale;
+    handle->gyro_scale_q = lrintf(gyro_scale * (1 << IMU_FUSION_GYRO_SCALE_SHIFT));
+    handle->alpha_q = lrintf(config->alpha * IMU_FUSION_Q15_ONE);
+    handle->still_thr = lrintf(config->still_threshold * config->gyro_sensitivity);
+    handle->acce_sq = (int64_t)lrintf(config->acce_sensitivity) * lrintf(config->acce_sensitivity);
+
+    *ret_handle = handle;
+    return ESP_OK;
+}
+
+esp_err_t imu_fusion_delete(imu_fusion_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t imu_fusion_update(imu_fusion_handle_t handle, const imu_fusion_batch_t *batch, imu_fusion_angle_t *angle)
+{
+    ESP_RETURN_ON_FALSE(handle && batch && batch->acce && batch->gyro && batch->count > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(batch->stride >= 3 * sizeof(int16_t) && batch->count <= UINT16_MAX, ESP_ERR_INVALID_ARG, TAG, "Invalid batch");
+
+    /* Accelerometer angles are computed once per batch from the mean (the sum has the same angles) */
+    int32_t acce_sum[3] = {0};
+    for (size_t i = 0; i < batch->count; i++) {
+        const int16_t *a = imu_fusion_at(batch->acce, batch->stride, i);
+        acce_sum[0] += a[0];
+        acce_sum[1] += a[1];
+        acce_sum[2] += a[2];
+        if (handle->config.bias_samples > 0) {
+            imu_fusion_update_bias(handle, a, imu_fusion_at(batch->gyro, batch->stride, i));
+        }
+    }
+
+    if (handle->config.mode == IMU_FUSION_FIXED_POINT) {
+        imu_fusion_update_fixed(handle, batch, acce_sum);
+    } else {
+        imu_fusion_update_float(handle, batch, acce_sum);
+    }
+    handle->initialized = true;
+
+    if (angle) {
+        if (handle->config.mode == IMU_FUSION_FIXED_POINT) {
+            angle->roll = handle->angle_q[0] / 65536.0f;
+            angle->pitch = handle->angle_q[1] / 65536.0f;
+            angle->yaw = handle->angle_q[2] / 65536.0f;
+        } else {
+            angle->roll = handle->angle[0];
+            angle->pitch = handle->angle[1];
+            angle->yaw = handle->angle[2];
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t imu_fusion_get_quaternion(imu_fusion_handle_t handle, imu_fusion_quat_t *quat)
+{
+    ESP_RETURN_ON_FALSE(handle && quat, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    float half[3];
+    const float deg_to_rad_half = M_PI / 360.0f;
+    for (int k = 0; k < 3; k++) {
+        const float deg = (handle->config.mode == IMU_FUSION_FIXED_POINT) ? handle->angle_q[k] / 65536.0f : handle->angle[k];
+        half[k] = deg * deg_to_rad_half;
+    }
+
+    /* Roll about X, pitch about Y, yaw about Z (applied in Z, Y, X order) */
+    const float cr = cosf(half[0]), sr = sinf(half[0]);
+    const float cp = cosf(half[1]), sp = sinf(half[1]);
+    const float cy = cosf(half[2]), sy = sinf(half[2]);
+    quat->w = cr * cp * cy + sr * sp * sy;
+    quat->x = sr * cp * cy - cr * sp * sy;
+    quat->y = cr * sp * cy + sr * cp * sy;
+    quat->z = cr * cp * sy - sr * sp * cy;
+    return ESP_OK;
+}
+
+esp_err_t imu_fusion_get_gyro_bias(imu_fusion_handle_t handle, int16_t bias[3])
+{
+    ESP_RETURN_ON_FALSE(handle && bias, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    const bool done = handle->bias_cnt >= handle->config.bias_samples;
+    for (int k = 0; k < 3; k++) {
+        bias[k] = done ? handle->bias_q8[k] / 256 : (handle->bias_cnt ? handle->bias_sum[k] / (int32_t)handle->bias_cnt : 0);
+    }
+    return (done && handle->config.bias_samples > 0) ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t imu_fusion_reset(imu_fusion_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    handle->initialized = false;
+    memset(handle->angle_q, 0, sizeof(handle->angle_q));
+    memset(handle->angle, 0, sizeof(handle->angle));
+    memset(handle->bias_q8, 0, sizeof(handle->bias_q8));
+    memset(handle->bias_sum, 0, sizeof(handle->bias_sum));
+    handle->bias_cnt = 0;
+    return ESP_OK;
+}
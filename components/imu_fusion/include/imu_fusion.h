@@ -0,0 +1,173 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Batched complementary filter for IMU sensor fusion
+ *
+ * Raw accelerometer and gyroscope samples (e.g. a burst from the MPU6050 or ICM42670 FIFO) are processed at once.
+ * The gyroscope is integrated for each sample, the accelerometer angles are computed once per batch from the mean
+ * acceleration. The fixed-point variant needs no FPU (ESP32-C3), the float variant is for chips with FPU.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Arithmetic of the filter
+ */
+typedef enum {
+    IMU_FUSION_FIXED_POINT = 0,         /*!< Integer arithmetic and integer atan2 approximation (error below 0.3 degree) */
+    IMU_FUSION_FLOAT,                   /*!< Float arithmetic */
+} imu_fusion_mode_t;
+
+/**
+ * @brief IMU fusion configuration
+ */
+typedef struct {
+    imu_fusion_mode_t mode;             /*!< Arithmetic of the filter */
+    float sample_period;                /*!< Period of samples [s] */
+    float acce_sensitivity;             /*!< Accelerometer sensitivity [LSB/g] */
+    float gyro_sensitivity;             /*!< Gyroscope sensitivity [LSB/(degree/s)] */
+    float alpha;                        /*!< Weight of gyroscope (0.0 - 1.0) */
+    uint32_t bias_samples;              /*!< Count of still samples averaged for gyroscope bias (0: bias estimation disabled) */
+    float still_threshold;              /*!< Maximum rotation rate of still samples after bias removal [degree/s] */
+} imu_fusion_config_t;
+
+/**
+ * @brief Default IMU fusion configuration
+ */
+#define IMU_FUSION_CONFIG_DEFAULT(period, acce_sens, gyro_sens) \
+    {                                                           \
+        .mode = IMU_FUSION_FIXED_POINT,                         \
+        .sample_period = (period),                              \
+        .acce_sensitivity = (acce_sens),                        \
+        .gyro_sensitivity = (gyro_sens),                        \
+        .alpha = 0.99,                                          \
+        .bias_samples = 200,                                    \
+        .still_threshold = 3.0,                                 \
+    }
+
+/**
+ * @brief Orientation angles [degree]
+ *
+ * @note Yaw is integrated gyroscope only, it drifts
+ */
+typedef struct {
+    float roll;
+    float pitch;
+    float yaw;
+} imu_fusion_angle_t;
+
+/**
+ * @brief Orientation quaternion
+ */
+typedef struct {
+    float w;
+    float x;
+    float y;
+    float z;
+} imu_fusion_quat_t;
+
+/**
+ * @brief Batch of raw samples
+ *
+ * Samples are read with a stride, so arrays of driver FIFO samples are used without copy, e.g.
+ * `{.acce = &s[0].acce.raw_acce_x, .gyro = &s[0].gyro.raw_gyro_x, .stride = sizeof(s[0]), .count = n}`
+ * for `mpu6050_fifo_sample_t s[n]`.
+ */
+typedef struct {
+    const int16_t *acce;                /*!< X, Y and Z of the first accelerometer sample */
+    const int16_t *gyro;                /*!< X, Y and Z of the first gyroscope sample */
+    size_t stride;                      /*!< Distance of two samples [bytes] */
+    size_t count;                       /*!< Count of samples */
+} imu_fusion_batch_t;
+
+/**
+ * @brief IMU fusion handle
+ */
+typedef struct imu_fusion_s *imu_fusion_handle_t;
+
+/**
+ * @brief Create IMU fusion filter
+ *
+ * @param config        Configuration
+ * @param ret_handle    Created filter
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if there is no memory for the filter
+ */
+esp_err_t imu_fusion_create(const imu_fusion_config_t *config, imu_fusion_handle_t *ret_handle);
+
+/**
+ * @brief Delete IMU fusion filter
+ *
+ * @param handle    Filter
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t imu_fusion_delete(imu_fusion_handle_t handle);
+
+/**
+ * @brief Process batch of raw samples
+ *
+ * The first batch initializes the angles from the accelerometer.
+ *
+ * @param handle    Filter
+ * @param batch     Raw samples
+ * @param angle     Orientation after the last sample (can be NULL)
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t imu_fusion_update(imu_fusion_handle_t handle, const imu_fusion_batch_t *batch, imu_fusion_angle_t *angle);
+
+/**
+ * @brief Get orientation as quaternion
+ *
+ * @param handle    Filter
+ * @param quat      Orientation after the last processed sample
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t imu_fusion_get_quaternion(imu_fusion_handle_t handle, imu_fusion_quat_t *quat);
+
+/**
+ * @brief Get estimated gyroscope bias
+ *
+ * @param handle    Filter
+ * @param bias      Raw bias of X, Y and Z axis
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_INVALID_STATE if estimation is not finished yet (the current partial estimate is returned)
+ */
+esp_err_t imu_fusion_get_gyro_bias(imu_fusion_handle_t handle, int16_t bias[3]);
+
+/**
+ * @brief Reset orientation and gyroscope bias
+ *
+ * @param handle    Filter
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t imu_fusion_reset(imu_fusion_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,141 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include <inttypes.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "imu_fusion.h"
+
+#define TEST_SAMPLES        (1000)
+#define TEST_BATCH          (50)
+#define TEST_PERIOD         (0.001f)
+#define TEST_ACCE_SENS      (8192.0f)
+#define TEST_GYRO_SENS      (65.5f)
+
+static const char *TAG = "imu_fusion test";
+
+typedef struct {
+    int16_t acce[3];
+    int16_t gyro[3];
+} test_sample_t;
+
+static test_sample_t samples[TEST_SAMPLES];
+
+/* Rotation about X axis at 30 degree/s */
+static void test_generate(void)
+{
+    for (int i = 0; i < TEST_SAMPLES; i++) {
+        const float roll = 30.0f * TEST_PERIOD * i * M_PI / 180.0f;
+        samples[i].acce[0] = 0;
+        samples[i].acce[1] = lrintf(TEST_ACCE_SENS * sinf(roll));
+        samples[i].acce[2] = lrintf(TEST_ACCE_SENS * cosf(roll));
+        samples[i].gyro[0] = lrintf(30.0f * TEST_GYRO_SENS);
+        samples[i].gyro[1] = 0;
+        samples[i].gyro[2] = 0;
+    }
+}
+
+/* Per sample float filter of mpu6050_complimentory_filter() and icm42670_complimentory_filter() */
+static float test_reference(void)
+{
+    float roll = atan2f(samples[0].acce[1], samples[0].acce[2]) * 180.0f / M_PI;
+    for (int i = 1; i < TEST_SAMPLES; i++) {
+        const float acce_x = samples[i].acce[0] / TEST_ACCE_SENS;
+        const float acce_y = samples[i].acce[1] / TEST_ACCE_SENS;
+        const float acce_z = samples[i].acce[2] / TEST_ACCE_SENS;
+        const float acce_roll = atan2f(acce_y, acce_z) * 180.0f / M_PI;
+        const float acce_pitch = atan2f(acce_x, acce_z) * 180.0f / M_PI;
+        (void)acce_pitch;
+        roll = 0.99f * (roll + samples[i].gyro[0] / TEST_GYRO_SENS * TEST_PERIOD) + 0.01f * acce_roll;
+    }
+    return roll;
+}
+
+static float test_fusion(imu_fusion_mode_t mode)
+{
+    imu_fusion_handle_t fusion = NULL;
+    imu_fusion_angle_t angle;
+    imu_fusion_config_t config = IMU_FUSION_CONFIG_DEFAULT(TEST_PERIOD, TEST_ACCE_SENS, TEST_GYRO_SENS);
+    config.mode = mode;
+    config.bias_samples = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, imu_fusion_create(&config, &fusion));
+
+    for (int i = 0; i < TEST_SAMPLES; i += TEST_BATCH) {
+        const imu_fusion_batch_t batch = {
+            .acce = samples[i].acce,
+            .gyro = samples[i].gyro,
+            .stride = sizeof(test_sample_t),
+            .count = TEST_BATCH,
+        };
+        TEST_ASSERT_EQUAL(ESP_OK, imu_fusion_update(fusion, &batch, &angle));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, imu_fusion_delete(fusion));
+    return angle.roll;
+}
+
+TEST_CASE("IMU fusion accuracy and benchmark test", "[imu_fusion]")
+{
+    const float expected = 30.0f * TEST_PERIOD * (TEST_SAMPLES - 1);
+    test_generate();
+
+    int64_t start = esp_timer_get_time();
+    const float roll_ref = test_reference();
+    const int64_t time_ref = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    const float roll_fixed = test_fusion(IMU_FUSION_FIXED_POINT);
+    const int64_t time_fixed = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    const float roll_float = test_fusion(IMU_FUSION_FLOAT);
+    const int64_t time_float = esp_timer_get_time() - start;
+
+    ESP_LOGI(TAG, "%d samples: per sample float %" PRId64 " us (%.2f), batched fixed-point %" PRId64 " us (%.2f), batched float %" PRId64 " us (%.2f)",
+             TEST_SAMPLES, time_ref, roll_ref, time_fixed, roll_fixed, time_float, roll_float);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, expected, roll_ref);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, expected, roll_fixed);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, expected, roll_float);
+}
+
+TEST_CASE("IMU fusion gyroscope bias test", "[imu_fusion]")
+{
+    imu_fusion_handle_t fusion = NULL;
+    imu_fusion_angle_t angle;
+    imu_fusion_quat_t quat;
+    int16_t bias[3];
+    test_sample_t still[TEST_BATCH];
+    imu_fusion_config_t config = IMU_FUSION_CONFIG_DEFAULT(TEST_PERIOD, TEST_ACCE_SENS, TEST_GYRO_SENS);
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, imu_fusion_create(NULL, &fusion));
+    TEST_ASSERT_EQUAL(ESP_OK, imu_fusion_create(&config, &fusion));
+
+    for (int i = 0; i < TEST_BATCH; i++) {
+        still[i] = (test_sample_t) {
+            .acce = {0, 0, (int16_t)TEST_ACCE_SENS},
+            .gyro = {50, -20, 10},
+        };
+    }
+    const imu_fusion_batch_t batch = {.acce = still[0].acce, .gyro = still[0].gyro, .stride = sizeof(test_sample_t), .count = TEST_BATCH};
+    TEST_ASSERT_EQUAL(ESP_OK, imu_fusion_update(fusion, &batch, &angle));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, imu_fusion_get_gyro_bias(fusion, bias));
+
+    for (uint32_t i = 0; i < config.bias_samples / TEST_BATCH; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, imu_fusion_update(fusion, &batch, &angle));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, imu_fusion_get_gyro_bias(fusion, bias));
+    TEST_ASSERT_EQUAL_INT16(50, bias[0]);
+    TEST_ASSERT_EQUAL_INT16(-20, bias[1]);
+    TEST_ASSERT_EQUAL_INT16(10, bias[2]);
+
+    /* Level and still, bias is removed */
+    TEST_ASSERT_EQUAL(ESP_OK, imu_fusion_get_quaternion(fusion, &quat));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.0f, quat.w);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 0.0f, angle.roll);
+
+    TEST_ASSERT_EQUAL(ESP_OK, imu_fusion_delete(fusion));
+}
@@ -6,7 +6,12 @@
 
 #include <inttypes.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "driver/gpio.h"
 #include "esp_bit_defs.h"
 #include "esp_check.h"
 #include "esp_log.h"
@@ -15,6 +20,12 @@
 
 #define VALID_IO_COUNT(handle)      ((handle)->config.io_count <= IO_COUNT_MAX ? (handle)->config.io_count : IO_COUNT_MAX)
 
+/* Maximum count of input register reads for one interrupt (INT can be asserted again during the read) */
+#define INTR_READ_MAX               (3)
+
+/* Number of output register values converted on stack and written at once by `esp_io_expander_set_level_seq` */
+#define LEVEL_SEQ_CHUNK             (32)
+
 /**
  * @brief Register type
  *
@@ -25,10 +36,30 @@ typedef enum {
     REG_DIRECTION,
 } reg_type_t;
 
+/**
+ * @brief Interrupt mode state
+ *
+ */
+struct esp_io_expander_intr_s {
+    esp_io_expander_handle_t handle;
+    int int_gpio_num;
+    TaskHandle_t task;
+    SemaphoreHandle_t task_done;
+    volatile bool running;
+    volatile uint32_t input_reg;            /* Cached value of input register */
+    portMUX_TYPE lock;                      /* Lock for callbacks */
+    struct {
+        esp_io_expander_edge_cb_t cb;
+        void *user_ctx;
+    } edge_cb[IO_COUNT_MAX];
+};
+
 static char *TAG = "io_expander";
 
 static esp_err_t write_reg(esp_io_expander_handle_t handle, reg_type_t reg, uint32_t value);
 static esp_err_t read_reg(esp_io_expander_handle_t handle, reg_type_t reg, uint32_t *value);
+static void intr_isr_handler(void *arg);
+static void intr_task(void *arg);
 
 esp_err_t esp_io_expander_set_dir(esp_io_expander_handle_t handle, uint32_t pin_num_mask, esp_io_expander_dir_t direction)
 {
@@ -105,6 +136,150 @@ esp_err_t esp_io_expander_set_level(esp_io_expander_handle_t handle, uint32_t pi
     return ESP_OK;
 }
 
+esp_err_t esp_io_expander_transaction_begin(esp_io_expander_handle_t handle, esp_io_expander_transaction_t *trans)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+    ESP_RETURN_ON_FALSE(trans, ESP_ERR_INVALID_ARG, TAG, "Invalid transaction");
+
+    memset(trans, 0, sizeof(esp_io_expander_transaction_t));
+    trans->handle = handle;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_io_expander_transaction_set_dir(esp_io_expander_transaction_t *trans, uint32_t pin_num_mask, esp_io_expander_dir_t direction)
+{
+    ESP_RETURN_ON_FALSE(trans && trans->handle, ESP_ERR_INVALID_ARG, TAG, "Invalid transaction");
+
+    trans->dir_mask |= pin_num_mask;
+    if (direction == IO_EXPANDER_OUTPUT) {
+        trans->dir_output |= pin_num_mask;
+    } else {
+        trans->dir_output &= ~pin_num_mask;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t esp_io_expander_transaction_set_level(esp_io_expander_transaction_t *trans, uint32_t pin_num_mask, uint8_t level)
+{
+    ESP_RETURN_ON_FALSE(trans && trans->handle, ESP_ERR_INVALID_ARG, TAG, "Invalid transaction");
+
+    trans->level_mask |= pin_num_mask;
+    if (level) {
+        trans->level_high |= pin_num_mask;
+    } else {
+        trans->level_high &= ~pin_num_mask;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t esp_io_expander_transaction_commit(esp_io_expander_transaction_t *trans)
+{
+    ESP_RETURN_ON_FALSE(trans && trans->handle, ESP_ERR_INVALID_ARG, TAG, "Invalid transaction");
+    esp_io_expander_handle_t handle = trans->handle;
+    if ((trans->dir_mask | trans->level_mask) >= BIT64(VALID_IO_COUNT(handle))) {
+        ESP_LOGW(TAG, "Pin num mask out of range, bit higher than %d won't work", VALID_IO_COUNT(handle) - 1);
+    }
+
+    uint32_t dir_reg, output_reg;
+    ESP_RETURN_ON_ERROR(read_reg(handle, REG_DIRECTION, &dir_reg), TAG, "Read direction reg failed");
+    ESP_RETURN_ON_ERROR(read_reg(handle, REG_OUTPUT, &output_reg), TAG, "Read Output reg failed");
+
+    /* Final direction, 1 if output */
+    uint32_t dir_output = handle->config.flags.dir_out_bit_zero ? ~dir_reg : dir_reg;
+    dir_output = (dir_output & ~trans->dir_mask) | (trans->dir_output & trans->dir_mask);
+    if (trans->level_mask & ~dir_output) {
+        ESP_LOGE(TAG, "Pins 0x%" PRIx32 " can't set level in input mode", trans->level_mask & ~dir_output);
+        return ESP_ERR_INVALID_STATE;
+    }
+    const uint32_t new_dir_reg = handle->config.flags.dir_out_bit_zero ? ~dir_output : dir_output;
+
+    /* Final output level, 1 if high */
+    uint32_t level_high = handle->config.flags.output_high_bit_zero ? ~output_reg : output_reg;
+    level_high = (level_high & ~trans->level_mask) | (trans->level_high & trans->level_mask);
+    const uint32_t new_output_reg = handle->config.flags.output_high_bit_zero ? ~level_high : level_high;
+
+    /* Write to regs only when different */
+    const uint32_t valid_mask = (uint32_t)(BIT64(VALID_IO_COUNT(handle)) - 1);
+    const bool dir_changed = ((new_dir_reg ^ dir_reg) & valid_mask) != 0;
+    const bool output_changed = ((new_output_reg ^ output_reg) & valid_mask) != 0;
+    if (dir_changed && output_changed && handle->write_output_direction_reg) {
+        ESP_RETURN_ON_ERROR(handle->write_output_direction_reg(handle, new_output_reg, new_dir_reg), TAG, "Write output and direction reg failed");
+    } else {
+        if (output_changed) {
+            ESP_RETURN_ON_ERROR(write_reg(handle, REG_OUTPUT, new_output_reg), TAG, "Write Output reg failed");
+        }
+        if (dir_changed) {
+            ESP_RETURN_ON_ERROR(write_reg(handle, REG_DIRECTION, new_dir_reg), TAG, "Write direction reg failed");
+        }
+    }
+
+    /* Transaction can be used again */
+    trans->dir_mask = 0;
+    trans->level_mask = 0;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_io_expander_set_level_seq(esp_io_expander_handle_t handle, uint32_t pin_num_mask, const uint32_t *levels, size_t count)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+    ESP_RETURN_ON_FALSE(levels || count == 0, ESP_ERR_INVALID_ARG, TAG, "Invalid levels");
+    if (pin_num_mask >= BIT64(VALID_IO_COUNT(handle))) {
+        ESP_LOGW(TAG, "Pin num mask out of range, bit higher than %d won't work", VALID_IO_COUNT(handle) - 1);
+    }
+
+    uint32_t dir_reg, output_reg;
+    ESP_RETURN_ON_ERROR(read_reg(handle, REG_DIRECTION, &dir_reg), TAG, "Read direction reg failed");
+    /* Get 1 if output */
+    const uint32_t dir_output = handle->config.flags.dir_out_bit_zero ? ~dir_reg : dir_reg;
+    if (pin_num_mask & ~dir_output) {
+        ESP_LOGE(TAG, "Pins 0x%" PRIx32 " can't set level in input mode", pin_num_mask & ~dir_output);
+        return ESP_ERR_INVALID_STATE;
+    }
+    ESP_RETURN_ON_ERROR(read_reg(handle, REG_OUTPUT, &output_reg), TAG, "Read Output reg failed");
+    /* Get 1 if high level */
+    const uint32_t level_high = handle->config.flags.output_high_bit_zero ? ~output_reg : output_reg;
+
+    uint32_t values[LEVEL_SEQ_CHUNK];
+    while (count > 0) {
+        const size_t chunk = (count < LEVEL_SEQ_CHUNK) ? count : LEVEL_SEQ_CHUNK;
+        for (size_t i = 0; i < chunk; i++) {
+            const uint32_t high = (level_high & ~pin_num_mask) | (levels[i] & pin_num_mask);
+            values[i] = handle->config.flags.output_high_bit_zero ? ~high : high;
+        }
+        if (handle->write_output_reg_seq) {
+            ESP_RETURN_ON_ERROR(handle->write_output_reg_seq(handle, values, chunk), TAG, "Write Output reg sequence failed");
+        } else {
+            for (size_t i = 0; i < chunk; i++) {
+                ESP_RETURN_ON_ERROR(write_reg(handle, REG_OUTPUT, values[i]), TAG, "Write Output reg failed");
+            }
+        }
+        levels += chunk;
+        count -= chunk;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Check, if all target IOs are in input mode (the direction is cached by each device driver)
+ */
+static bool is_input_mask(esp_io_expander_handle_t handle, uint32_t pin_num_mask)
+{
+    uint32_t dir_reg;
+    if (read_reg(handle, REG_DIRECTION, &dir_reg) != ESP_OK) {
+        return false;
+    }
+    /* Get 1 if input */
+    if (!handle->config.flags.dir_out_bit_zero) {
+        dir_reg ^= 0xffffffff;
+    }
+    return (pin_num_mask & ~dir_reg) == 0;
+}
+
 esp_err_t esp_io_expander_get_level(esp_io_expander_handle_t handle, uint32_t pin_num_mask, uint32_t *level_mask)
 {
     ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
@@ -114,7 +289,12 @@ esp_err_t esp_io_expander_get_level(esp_io_expander_handle_t handle, uint32_t pi
     }
 
     uint32_t input_reg;
-    ESP_RETURN_ON_ERROR(read_reg(handle, REG_INPUT, &input_reg), TAG, "Read input reg failed");
+    if (handle->intr != NULL && is_input_mask(handle, pin_num_mask)) {
+        /* Input levels are updated from the interrupt mode task */
+        input_reg = handle->intr->input_reg;
+    } else {
+        ESP_RETURN_ON_ERROR(read_reg(handle, REG_INPUT, &input_reg), TAG, "Read input reg failed");
+    }
     if (!handle->config.flags.input_high_bit_zero) {
         /* Get 1 when input high level */
         *level_mask = input_reg & pin_num_mask;
@@ -126,6 +306,117 @@ esp_err_t esp_io_expander_get_level(esp_io_expander_handle_t handle, uint32_t pi
     return ESP_OK;
 }
 
+esp_err_t esp_io_expander_enable_interrupt(esp_io_expander_handle_t handle, const esp_io_expander_intr_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+    ESP_RETURN_ON_FALSE(config, ESP_ERR_INVALID_ARG, TAG, "Invalid config");
+    ESP_RETURN_ON_FALSE(GPIO_IS_VALID_GPIO(config->int_gpio_num), ESP_ERR_INVALID_ARG, TAG, "Invalid INT GPIO");
+    ESP_RETURN_ON_FALSE(handle->intr == NULL, ESP_ERR_INVALID_STATE, TAG, "Interrupt mode is already enabled");
+
+    esp_err_t ret = ESP_OK;
+    esp_io_expander_intr_t *intr = (esp_io_expander_intr_t *)calloc(1, sizeof(esp_io_expander_intr_t));
+    ESP_RETURN_ON_FALSE(intr, ESP_ERR_NO_MEM, TAG, "Malloc failed");
+    intr->handle = handle;
+    intr->int_gpio_num = config->int_gpio_num;
+    intr->lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
+
+    /* Initial input levels, it clears also pending interrupt of the device */
+    uint32_t input_reg;
+    ESP_GOTO_ON_ERROR(read_reg(handle, REG_INPUT, &input_reg), err, TAG, "Read input reg failed");
+    intr->input_reg = input_reg;
+
+    intr->task_done = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(intr->task_done, ESP_ERR_NO_MEM, err, TAG, "Create semaphore failed");
+
+    intr->running = true;
+    BaseType_t res;
+    if (config->task_affinity < 0) {
+        res = xTaskCreate(intr_task, "io_expander", config->task_stack, intr, config->task_priority, &intr->task);
+    } else {
+        res = xTaskCreatePinnedToCore(intr_task, "io_expander", config->task_stack, intr, config->task_priority, &intr->task, config->task_affinity);
+    }
+    ESP_GOTO_ON_FALSE(res == pdPASS, ESP_ERR_NO_MEM, err, TAG, "Create task failed");
+
+    const gpio_config_t int_gpio_config = {
+        .mode = GPIO_MODE_INPUT,
+        .intr_type = GPIO_INTR_NEGEDGE,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pin_bit_mask = BIT64(config->int_gpio_num)
+    };
+    ESP_GOTO_ON_ERROR(gpio_config(&int_gpio_config), err, TAG, "INT GPIO config failed");
+
+    /* ISR service can be already installed by application or other component */
+    ret = gpio_install_isr_service(0);
+    ESP_GOTO_ON_FALSE(ret == ESP_OK || ret == ESP_ERR_INVALID_STATE, ret, err, TAG, "GPIO ISR service install failed");
+    ESP_GOTO_ON_ERROR(gpio_isr_handler_add(config->int_gpio_num, intr_isr_handler, intr), err, TAG, "GPIO ISR handler add failed");
+
+    handle->intr = intr;
+
+    /* Check changes, which came before the interrupt was enabled */
+    xTaskNotifyGive(intr->task);
+
+    return ESP_OK;
+
+err:
+    gpio_reset_pin(config->int_gpio_num);
+    if (intr->task) {
+        intr->running = false;
+        xTaskNotifyGive(intr->task);
+        xSemaphoreTake(intr->task_done, portMAX_DELAY);
+    }
+    if (intr->task_done) {
+        vSemaphoreDelete(intr->task_done);
+    }
+    free(intr);
+    return ret;
+}
+
+esp_err_t esp_io_expander_disable_interrupt(esp_io_expander_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+
+    esp_io_expander_intr_t *intr = handle->intr;
+    if (intr == NULL) {
+        return ESP_OK;
+    }
+
+    gpio_isr_handler_remove(intr->int_gpio_num);
+    gpio_reset_pin(intr->int_gpio_num);
+
+    /* Stop the task, it can be just communicating with the device */
+    intr->running = false;
+    xTaskNotifyGive(intr->task);
+    xSemaphoreTake(intr->task_done, portMAX_DELAY);
+
+    handle->intr = NULL;
+    vSemaphoreDelete(intr->task_done);
+    free(intr);
+
+    return ESP_OK;
+}
+
+esp_err_t esp_io_expander_register_edge_cb(esp_io_expander_handle_t handle, uint32_t pin_num_mask, esp_io_expander_edge_cb_t cb, void *user_ctx)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+    ESP_RETURN_ON_FALSE(handle->intr, ESP_ERR_INVALID_STATE, TAG, "Interrupt mode isn't enabled");
+    if (pin_num_mask >= BIT64(VALID_IO_COUNT(handle))) {
+        ESP_LOGW(TAG, "Pin num mask out of range, bit higher than %d won't work", VALID_IO_COUNT(handle) - 1);
+    }
+
+    esp_io_expander_intr_t *intr = handle->intr;
+    uint8_t io_count = VALID_IO_COUNT(handle);
+    portENTER_CRITICAL(&intr->lock);
+    for (int i = 0; i < io_count; i++) {
+        if (pin_num_mask & BIT(i)) {
+            intr->edge_cb[i].cb = cb;
+            intr->edge_cb[i].user_ctx = user_ctx;
+        }
+    }
+    portEXIT_CRITICAL(&intr->lock);
+
+    return ESP_OK;
+}
+
 esp_err_t esp_io_expander_print_state(esp_io_expander_handle_t handle)
 {
     ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
@@ -169,6 +460,8 @@ esp_err_t esp_io_expander_del(esp_io_expander_handle_t handle)
     ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
     ESP_RETURN_ON_FALSE(handle->del, ESP_ERR_NOT_SUPPORTED, TAG, "del isn't implemented");
 
+    ESP_RETURN_ON_ERROR(esp_io_expander_disable_interrupt(handle), TAG, "Disable interrupt failed");
+
     return handle->del(handle);
 }
 
@@ -226,3 +519,61 @@ static esp_err_t read_reg(esp_io_expander_handle_t handle, reg_type_t reg, uint3
 
     return ESP_OK;
 }
+
+static void IRAM_ATTR intr_isr_handler(void *arg)
+{
+    esp_io_expander_intr_t *intr = (esp_io_expander_intr_t *)arg;
+    BaseType_t need_yield = pdFALSE;
+
+    /* Communication with the device is done in the task */
+    vTaskNotifyGiveFromISR(intr->task, &need_yield);
+    if (need_yield == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static void intr_task(void *arg)
+{
+    esp_io_expander_intr_t *intr = (esp_io_expander_intr_t *)arg;
+    esp_io_expander_handle_t handle = intr->handle;
+    uint8_t io_count = VALID_IO_COUNT(handle);
+    uint32_t input_reg;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!intr->running) {
+            break;
+        }
+
+        /* Read again, if INT was asserted again during the read */
+        for (int n = 0; n < INTR_READ_MAX; n++) {
+            if (read_reg(handle, REG_INPUT, &input_reg) != ESP_OK) {
+                ESP_LOGE(TAG, "Read input reg failed");
+                break;
+            }
+            const uint32_t changed = (input_reg ^ intr->input_reg) & (uint32_t)(BIT64(io_count) - 1);
+            intr->input_reg = input_reg;
+
+            for (int i = 0; i < io_count; i++) {
+                if (!(changed & BIT(i))) {
+                    continue;
+                }
+                portENTER_CRITICAL(&intr->lock);
+                const esp_io_expander_edge_cb_t cb = intr->edge_cb[i].cb;
+                void *user_ctx = intr->edge_cb[i].user_ctx;
+                portEXIT_CRITICAL(&intr->lock);
+                if (cb) {
+                    const bool bit = (input_reg & BIT(i)) != 0;
+                    cb(handle, BIT(i), (bit != handle->config.flags.input_high_bit_zero) ? 1 : 0, user_ctx);
+                }
+            }
+
+            if (gpio_get_level(intr->int_gpio_num) != 0) {
+                break;
+            }
+        }
+    }
+
+    xSemaphoreGive(intr->task_done);
+    vTaskDelete(NULL);
+}
@@ -29,6 +29,12 @@ extern "C" {
 typedef struct esp_io_expander_s esp_io_expander_t;
 typedef esp_io_expander_t *esp_io_expander_handle_t;
 
+/**
+ * @brief IO Expander interrupt mode state (private)
+ *
+ */
+typedef struct esp_io_expander_intr_s esp_io_expander_intr_t;
+
 /**
  * @brief IO Expander Pin Num
  *
@@ -88,9 +94,57 @@ typedef struct {
         uint8_t input_high_bit_zero : 1;    /*!< If the input level of IO is high, the corresponding bit of the input register is 0 */
         uint8_t output_high_bit_zero : 1;   /*!< If the output level of IO is high, the corresponding bit of the output register is 0 */
     } flags;
-    /* Don't support with interrupt mode yet, will be added soon */
 } esp_io_expander_config_t;
 
+/**
+ * @brief IO Expander interrupt mode configuration
+ *
+ */
+typedef struct {
+    int int_gpio_num;           /*!< GPIO connected to the INT output of the device (open-drain, active low) */
+    int task_priority;          /*!< Priority of the task, which reads the device and calls edge callbacks */
+    int task_stack;             /*!< Stack size of the task [bytes] */
+    int task_affinity;          /*!< Core of the task (-1 for no affinity) */
+} esp_io_expander_intr_config_t;
+
+/**
+ * @brief Default interrupt mode configuration
+ *
+ */
+#define ESP_IO_EXPANDER_INTR_CONFIG_DEFAULT(gpio)   \
+    {                                               \
+        .int_gpio_num = (gpio),                     \
+        .task_priority = 5,                         \
+        .task_stack = 3072,                         \
+        .task_affinity = -1,                        \
+    }
+
+/**
+ * @brief IO Expander transaction
+ *
+ * @note Direction and output level changes of more IOs are collected and written by `esp_io_expander_transaction_commit`,
+ *       each register is written at most once.
+ */
+typedef struct {
+    esp_io_expander_handle_t handle;    /*!< IO Expander handle */
+    uint32_t dir_mask;                  /*!< IOs with changed direction */
+    uint32_t dir_output;                /*!< New direction of IOs in `dir_mask`, 1 - Output */
+    uint32_t level_mask;                /*!< IOs with changed output level */
+    uint32_t level_high;                /*!< New output level of IOs in `level_mask`, 1 - High level */
+} esp_io_expander_transaction_t;
+
+/**
+ * @brief Callback of input level change in interrupt mode
+ *
+ * @note It is called from the interrupt mode task, it can use the IO expander functions
+ *
+ * @param handle: IO Expander handle
+ * @param pin_num_mask: Pin num with type of `esp_io_expander_pin_num_t`, whose level was changed
+ * @param level: 0 - Low level, 1 - High level
+ * @param user_ctx: User data from `esp_io_expander_register_edge_cb`
+ */
+typedef void (*esp_io_expander_edge_cb_t)(esp_io_expander_handle_t handle, uint32_t pin_num_mask, uint8_t level, void *user_ctx);
+
 struct esp_io_expander_s {
 
     /**
@@ -165,6 +219,37 @@ struct esp_io_expander_s {
      */
     esp_err_t (*read_direction_reg)(esp_io_expander_handle_t handle, uint32_t *value);
 
+    /**
+     * @brief Write values to output register and direction register together (optional)
+     *
+     * @note The output register must be written first, the output level is valid when the IO becomes output
+     * @note It is used by `esp_io_expander_transaction_commit`, when both registers are changed. If it isn't implemented,
+     *       `write_output_reg` and `write_direction_reg` are called.
+     *
+     * @param handle: IO Expander handle
+     * @param output: Output register's value
+     * @param direction: Direction register's value
+     *
+     * @return
+     *      - ESP_OK: Success, otherwise returns ESP_ERR_xxx
+     */
+    esp_err_t (*write_output_direction_reg)(esp_io_expander_handle_t handle, uint32_t output, uint32_t direction);
+
+    /**
+     * @brief Write values to output register one after another in one bus transaction (optional)
+     *
+     * @note It is used by `esp_io_expander_set_level_seq`. If it isn't implemented, `write_output_reg` is called for each value.
+     * @note The last value must be cached as with `write_output_reg`
+     *
+     * @param handle: IO Expander handle
+     * @param values: Output register's values in the order of writing
+     * @param count: Number of values
+     *
+     * @return
+     *      - ESP_OK: Success, otherwise returns ESP_ERR_xxx
+     */
+    esp_err_t (*write_output_reg_seq)(esp_io_expander_handle_t handle, const uint32_t *values, size_t count);
+
     /**
      * @brief Reset the device to its initial state (mandatory)
      *
@@ -191,6 +276,11 @@ struct esp_io_expander_s {
      * @brief Configuration structure
      */
     esp_io_expander_config_t config;
+
+    /**
+     * @brief Interrupt mode state (used only by `esp_io_expander.c`, NULL when disabled)
+     */
+    esp_io_expander_intr_t *intr;
 };
 
 /**
@@ -219,10 +309,91 @@ esp_err_t esp_io_expander_set_dir(esp_io_expander_handle_t handle, uint32_t pin_
  */
 esp_err_t esp_io_expander_set_level(esp_io_expander_handle_t handle, uint32_t pin_num_mask, uint8_t level);
 
+/**
+ * @brief Start a transaction
+ *
+ * Example:
+ * @code{c}
+ * esp_io_expander_transaction_t trans;
+ * esp_io_expander_transaction_begin(handle, &trans);
+ * esp_io_expander_transaction_set_dir(&trans, IO_EXPANDER_PIN_NUM_0 | IO_EXPANDER_PIN_NUM_1, IO_EXPANDER_OUTPUT);
+ * esp_io_expander_transaction_set_level(&trans, IO_EXPANDER_PIN_NUM_0, 1);
+ * esp_io_expander_transaction_set_level(&trans, IO_EXPANDER_PIN_NUM_1, 0);
+ * esp_io_expander_transaction_commit(&trans);
+ * @endcode
+ *
+ * @param handle: IO Exapnder handle
+ * @param trans: Transaction to initialize
+ *
+ * @return
+ *      - ESP_OK: Success, otherwise returns ESP_ERR_xxx
+ */
+esp_err_t esp_io_expander_transaction_begin(esp_io_expander_handle_t handle, esp_io_expander_transaction_t *trans);
+
+/**
+ * @brief Set the direction of a set of target IOs in a transaction
+ *
+ * @note Nothing is written to the device until `esp_io_expander_transaction_commit`
+ *
+ * @param trans: Transaction
+ * @param pin_num_mask: Bitwise OR of allowed pin num with type of `esp_io_expander_pin_num_t`
+ * @param direction: IO direction (only support input or output now)
+ *
+ * @return
+ *      - ESP_OK: Success, otherwise returns ESP_ERR_xxx
+ */
+esp_err_t esp_io_expander_transaction_set_dir(esp_io_expander_transaction_t *trans, uint32_t pin_num_mask, esp_io_expander_dir_t direction);
+
+/**
+ * @brief Set the output level of a set of target IOs in a transaction
+ *
+ * @note Nothing is written to the device until `esp_io_expander_transaction_commit`
+ *
+ * @param trans: Transaction
+ * @param pin_num_mask: Bitwise OR of allowed pin num with type of `esp_io_expander_pin_num_t`
+ * @param level: 0 - Low level, 1 - High level
+ *
+ * @return
+ *      - ESP_OK: Success, otherwise returns ESP_ERR_xxx
+ */
+esp_err_t esp_io_expander_transaction_set_level(esp_io_expander_transaction_t *trans, uint32_t pin_num_mask, uint8_t level);
+
+/**
+ * @brief Write all changes of a transaction to the device
+ *
+ * @note Output register is written before direction register, so new output IOs start with the expected level
+ * @note All IOs with changed level must be in output mode after the transaction, otherwise this function will return
+ *       the error `ESP_ERR_INVALID_STATE` and nothing is written
+ *
+ * @param trans: Transaction
+ *
+ * @return
+ *      - ESP_OK: Success, otherwise returns ESP_ERR_xxx
+ */
+esp_err_t esp_io_expander_transaction_commit(esp_io_expander_transaction_t *trans);
+
+/**
+ * @brief Set the output level of a set of target IOs in a sequence of steps, e.g. edges of a bit-banged bus
+ *
+ * @note Devices with `write_output_reg_seq` (e.g. TCA9554, TCA95xx) write the whole sequence in one I2C transaction,
+ *       each step is applied to the IOs when its data byte is acknowledged
+ * @note IOs outside of `pin_num_mask` keep their level
+ *
+ * @param handle: IO Exapnder handle
+ * @param pin_num_mask: Bitwise OR of allowed pin num with type of `esp_io_expander_pin_num_t`, all must be in output mode
+ * @param levels: Bit mask of high level IOs (from `pin_num_mask`) for each step
+ * @param count: Number of steps
+ *
+ * @return
+ *      - ESP_OK: Success, otherwise returns ESP_ERR_xxx
+ */
+esp_err_t esp_io_expander_set_level_seq(esp_io_expander_handle_t handle, uint32_t pin_num_mask, const uint32_t *levels, size_t count);
+
 /**
  * @brief Get the intput level of a set of target IOs
  *
  * @note This function can be called whenever target IOs are in input mode or output mode
+ * @note In interrupt mode, levels of input IOs are returned from cache without communication with the device
  *
  * @param handle: IO Exapnder handle
  * @param pin_num_mask: Bitwise OR of allowed pin num with type of `esp_io_expander_pin_num_t`
@@ -233,6 +404,50 @@ esp_err_t esp_io_expander_set_level(esp_io_expander_handle_t handle, uint32_t pi
  */
 esp_err_t esp_io_expander_get_level(esp_io_expander_handle_t handle, uint32_t pin_num_mask, uint32_t *level_mask);
 
+/**
+ * @brief Enable interrupt mode
+ *
+ * @note The INT output of the device triggers one read of the input register. The input levels are cached
+ *       and `esp_io_expander_get_level` of input IOs doesn't need any communication with the device.
+ * @note The device must clear its INT output by read of the input register (e.g. TCA9554, TCA95xx).
+ * @note It uses GPIO ISR service, which is installed, if it isn't installed yet.
+ *
+ * @param handle: IO Expander handle
+ * @param config: Interrupt mode configuration
+ *
+ * @return
+ *      - ESP_OK: Success, otherwise returns ESP_ERR_xxx
+ */
+esp_err_t esp_io_expander_enable_interrupt(esp_io_expander_handle_t handle, const esp_io_expander_intr_config_t *config);
+
+/**
+ * @brief Disable interrupt mode
+ *
+ * @note It is called automatically from `esp_io_expander_del`
+ *
+ * @param handle: IO Expander handle
+ *
+ * @return
+ *      - ESP_OK: Success, otherwise returns ESP_ERR_xxx
+ */
+esp_err_t esp_io_expander_disable_interrupt(esp_io_expander_handle_t handle);
+
+/**
+ * @brief Register callback of input level change of a set of target IOs
+ *
+ * @note Interrupt mode must be enabled first, otherwise this function will return the error `ESP_ERR_INVALID_STATE`
+ * @note The callback is called once for each changed IO
+ *
+ * @param handle: IO Expander handle
+ * @param pin_num_mask: Bitwise OR of allowed pin num with type of `esp_io_expander_pin_num_t`
+ * @param cb: Callback (NULL for unregister)
+ * @param user_ctx: User data passed to the callback
+ *
+ * @return
+ *      - ESP_OK: Success, otherwise returns ESP_ERR_xxx
+ */
+esp_err_t esp_io_expander_register_edge_cb(esp_io_expander_handle_t handle, uint32_t pin_num_mask, esp_io_expander_edge_cb_t cb, void *user_ctx);
+
 /**
  * @brief Print the current status of each IO of the device, including direction, input level and output level
  *
@@ -21,6 +21,9 @@
 
 #define IO_COUNT                (8)
 
+/* Maximum number of port values in one I2C transaction of `write_output_reg_seq` */
+#define OUTPUT_SEQ_MAX          (32)
+
 /* Default register value on power-up */
 #define DIR_REG_DEFAULT_VAL     (0xff)
 #define OUT_REG_DEFAULT_VAL     (0xff)
@@ -36,7 +39,8 @@ typedef struct {
     struct {
         uint8_t direction;
         uint8_t output;
-    } regs;
+    } regs;                 /* Shadow registers, the chip has only one quasi-bidirectional port */
+    uint8_t port;           /* Last byte written to the port */
 } esp_io_expander_ht8574_t;
 
 static char *TAG = "ht8574";
@@ -44,6 +48,8 @@ static char *TAG = "ht8574";
 static esp_err_t read_input_reg(esp_io_expander_handle_t handle, uint32_t *value);
 static esp_err_t write_output_reg(esp_io_expander_handle_t handle, uint32_t value);
 static esp_err_t read_output_reg(esp_io_expander_handle_t handle, uint32_t *value);
+static esp_err_t write_output_reg_seq(esp_io_expander_handle_t handle, const uint32_t *values, size_t count);
+static esp_err_t write_output_direction_reg(esp_io_expander_handle_t handle, uint32_t output, uint32_t direction);
 static esp_err_t write_direction_reg(esp_io_expander_handle_t handle, uint32_t value);
 static esp_err_t read_direction_reg(esp_io_expander_handle_t handle, uint32_t *value);
 static esp_err_t reset(esp_io_expander_t *handle);
@@ -64,6 +70,8 @@ esp_err_t esp_io_expander_new_i2c_ht8574(i2c_port_t i2c_num, uint32_t i2c_addres
     ht8574->base.read_input_reg = read_input_reg;
     ht8574->base.write_output_reg = write_output_reg;
     ht8574->base.read_output_reg = read_output_reg;
+    ht8574->base.write_output_reg_seq = write_output_reg_seq;
+    ht8574->base.write_output_direction_reg = write_output_direction_reg;
     ht8574->base.write_direction_reg = write_direction_reg;
     ht8574->base.read_direction_reg = read_direction_reg;
     ht8574->base.del = del;
@@ -94,16 +102,31 @@ static esp_err_t read_input_reg(esp_io_expander_handle_t handle, uint32_t *value
     return ESP_OK;
 }
 
+/**
+ * @brief Write the port byte, input IOs are written as 1 (weak pull-up), so they can be driven by external devices
+ *
+ * @note The byte is not written, when it is the same as the last one (the port is write-only from the output view)
+ */
+static esp_err_t write_port(esp_io_expander_ht8574_t *ht8574, uint8_t output, uint8_t direction, bool force)
+{
+    /* Direction bit 1 is input */
+    uint8_t data = output | direction;
+    if (data != ht8574->port || force) {
+        ESP_RETURN_ON_ERROR(
+            i2c_master_write_to_device(ht8574->i2c_num, ht8574->i2c_address, &data, 1, pdMS_TO_TICKS(I2C_TIMEOUT_MS)),
+            TAG, "Write port failed");
+        ht8574->port = data;
+    }
+    ht8574->regs.output = output;
+    ht8574->regs.direction = direction;
+    return ESP_OK;
+}
+
 static esp_err_t write_output_reg(esp_io_expander_handle_t handle, uint32_t value)
 {
     esp_io_expander_ht8574_t *ht8574 = (esp_io_expander_ht8574_t *)__containerof(handle, esp_io_expander_ht8574_t, base);
-    value &= 0xff;
 
-    uint8_t data = (uint8_t)value;
-    ESP_RETURN_ON_ERROR(
-        i2c_master_write_to_device(ht8574->i2c_num, ht8574->i2c_address, &data, 1, pdMS_TO_TICKS(I2C_TIMEOUT_MS)),
-        TAG, "Write output reg failed");
-    ht8574->regs.output = value;
+    ESP_RETURN_ON_ERROR(write_port(ht8574, value & 0xff, ht8574->regs.direction, false), TAG, "Write output reg failed");
     return ESP_OK;
 }
 
@@ -115,11 +138,42 @@ static esp_err_t read_output_reg(esp_io_expander_handle_t handle, uint32_t *valu
     return ESP_OK;
 }
 
+static esp_err_t write_output_reg_seq(esp_io_expander_handle_t handle, const uint32_t *values, size_t count)
+{
+    esp_io_expander_ht8574_t *ht8574 = (esp_io_expander_ht8574_t *)__containerof(handle, esp_io_expander_ht8574_t, base);
+
+    /* Each data byte of one write is latched to the port */
+    uint8_t data[OUTPUT_SEQ_MAX];
+    while (count > 0) {
+        const size_t len = (count < OUTPUT_SEQ_MAX) ? count : OUTPUT_SEQ_MAX;
+        for (size_t i = 0; i < len; i++) {
+            data[i] = (values[i] & 0xff) | ht8574->regs.direction;
+        }
+        ESP_RETURN_ON_ERROR(
+            i2c_master_write_to_device(ht8574->i2c_num, ht8574->i2c_address, data, len, pdMS_TO_TICKS(I2C_TIMEOUT_MS)),
+            TAG, "Write output reg sequence failed");
+        ht8574->regs.output = values[len - 1] & 0xff;
+        ht8574->port = data[len - 1];
+        values += len;
+        count -= len;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t write_output_direction_reg(esp_io_expander_handle_t handle, uint32_t output, uint32_t direction)
+{
+    esp_io_expander_ht8574_t *ht8574 = (esp_io_expander_ht8574_t *)__containerof(handle, esp_io_expander_ht8574_t, base);
+
+    ESP_RETURN_ON_ERROR(write_port(ht8574, output & 0xff, direction & 0xff, false), TAG, "Write output and direction reg failed");
+    return ESP_OK;
+}
+
 static esp_err_t write_direction_reg(esp_io_expander_handle_t handle, uint32_t value)
 {
     esp_io_expander_ht8574_t *ht8574 = (esp_io_expander_ht8574_t *)__containerof(handle, esp_io_expander_ht8574_t, base);
-    value &= 0xff;
-    ht8574->regs.direction = value;
+
+    /* New input IOs are released to 1, new output IOs get their output level */
+    ESP_RETURN_ON_ERROR(write_port(ht8574, ht8574->regs.output, value & 0xff, false), TAG, "Write direction reg failed");
     return ESP_OK;
 }
 
@@ -133,7 +187,9 @@ static esp_err_t read_direction_reg(esp_io_expander_handle_t handle, uint32_t *v
 
 static esp_err_t reset(esp_io_expander_t *handle)
 {
-    ESP_RETURN_ON_ERROR(write_output_reg(handle, OUT_REG_DEFAULT_VAL), TAG, "Write output reg failed");
+    esp_io_expander_ht8574_t *ht8574 = (esp_io_expander_ht8574_t *)__containerof(handle, esp_io_expander_ht8574_t, base);
+
+    ESP_RETURN_ON_ERROR(write_port(ht8574, OUT_REG_DEFAULT_VAL, ht8574->regs.direction, true), TAG, "Write output reg failed");
     return ESP_OK;
 }
 
@@ -26,6 +26,9 @@
 #define OUTPUT_REG_ADDR         (0x01)
 #define DIRECTION_REG_ADDR      (0x03)
 
+/* Maximum number of output values in one I2C transaction of `write_output_reg_seq` */
+#define OUTPUT_SEQ_MAX          (32)
+
 /* Default register value on power-up */
 #define DIR_REG_DEFAULT_VAL     (0xff)
 #define OUT_REG_DEFAULT_VAL     (0xff)
@@ -49,6 +52,7 @@ static char *TAG = "tca9554";
 static esp_err_t read_input_reg(esp_io_expander_handle_t handle, uint32_t *value);
 static esp_err_t write_output_reg(esp_io_expander_handle_t handle, uint32_t value);
 static esp_err_t read_output_reg(esp_io_expander_handle_t handle, uint32_t *value);
+static esp_err_t write_output_reg_seq(esp_io_expander_handle_t handle, const uint32_t *values, size_t count);
 static esp_err_t write_direction_reg(esp_io_expander_handle_t handle, uint32_t value);
 static esp_err_t read_direction_reg(esp_io_expander_handle_t handle, uint32_t *value);
 static esp_err_t reset(esp_io_expander_t *handle);
@@ -69,6 +73,7 @@ esp_err_t esp_io_expander_new_i2c_tca9554(i2c_port_t i2c_num, uint32_t i2c_addre
     tca9554->base.read_input_reg = read_input_reg;
     tca9554->base.write_output_reg = write_output_reg;
     tca9554->base.read_output_reg = read_output_reg;
+    tca9554->base.write_output_reg_seq = write_output_reg_seq;
     tca9554->base.write_direction_reg = write_direction_reg;
     tca9554->base.read_direction_reg = read_direction_reg;
     tca9554->base.del = del;
@@ -120,6 +125,27 @@ static esp_err_t read_output_reg(esp_io_expander_handle_t handle, uint32_t *valu
     return ESP_OK;
 }
 
+static esp_err_t write_output_reg_seq(esp_io_expander_handle_t handle, const uint32_t *values, size_t count)
+{
+    esp_io_expander_tca9554_t *tca9554 = (esp_io_expander_tca9554_t *)__containerof(handle, esp_io_expander_tca9554_t, base);
+
+    /* The command byte selects the output register for all following data bytes */
+    uint8_t data[1 + OUTPUT_SEQ_MAX] = {OUTPUT_REG_ADDR};
+    while (count > 0) {
+        const size_t len = (count < OUTPUT_SEQ_MAX) ? count : OUTPUT_SEQ_MAX;
+        for (size_t i = 0; i < len; i++) {
+            data[1 + i] = values[i] & 0xff;
+        }
+        ESP_RETURN_ON_ERROR(
+            i2c_master_write_to_device(tca9554->i2c_num, tca9554->i2c_address, data, 1 + len, pdMS_TO_TICKS(I2C_TIMEOUT_MS)),
+            TAG, "Write output reg sequence failed");
+        tca9554->regs.output = data[len];
+        values += len;
+        count -= len;
+    }
+    return ESP_OK;
+}
+
 static esp_err_t write_direction_reg(esp_io_expander_handle_t handle, uint32_t value)
 {
     esp_io_expander_tca9554_t *tca9554 = (esp_io_expander_tca9554_t *)__containerof(handle, esp_io_expander_tca9554_t, base);
@@ -26,6 +26,9 @@
 #define OUTPUT_REG_ADDR         (0x02)
 #define DIRECTION_REG_ADDR      (0x06)
 
+/* Maximum number of output values in one I2C transaction of `write_output_reg_seq` */
+#define OUTPUT_SEQ_MAX          (16)
+
 /* Default register value on power-up */
 #define DIR_REG_DEFAULT_VAL     (0xffff)
 #define OUT_REG_DEFAULT_VAL     (0xffff)
@@ -51,6 +54,8 @@ static esp_err_t write_output_reg(esp_io_expander_handle_t handle, uint32_t valu
 static esp_err_t read_output_reg(esp_io_expander_handle_t handle, uint32_t *value);
 static esp_err_t write_direction_reg(esp_io_expander_handle_t handle, uint32_t value);
 static esp_err_t read_direction_reg(esp_io_expander_handle_t handle, uint32_t *value);
+static esp_err_t write_output_direction_reg(esp_io_expander_handle_t handle, uint32_t output, uint32_t direction);
+static esp_err_t write_output_reg_seq(esp_io_expander_handle_t handle, const uint32_t *values, size_t count);
 static esp_err_t reset(esp_io_expander_t *handle);
 static esp_err_t del(esp_io_expander_t *handle);
 
@@ -71,6 +76,8 @@ esp_err_t esp_io_expander_new_i2c_tca95xx_16bit(i2c_port_t i2c_num, uint32_t i2c
     tca->base.read_output_reg = read_output_reg;
     tca->base.write_direction_reg = write_direction_reg;
     tca->base.read_direction_reg = read_direction_reg;
+    tca->base.write_output_direction_reg = write_output_direction_reg;
+    tca->base.write_output_reg_seq = write_output_reg_seq;
     tca->base.del = del;
     tca->base.reset = reset;
 
@@ -141,6 +148,56 @@ static esp_err_t read_direction_reg(esp_io_expander_handle_t handle, uint32_t *v
     return ESP_OK;
 }
 
+static esp_err_t write_output_direction_reg(esp_io_expander_handle_t handle, uint32_t output, uint32_t direction)
+{
+    esp_io_expander_tca95xx_16bit_t *tca = (esp_io_expander_tca95xx_16bit_t *)__containerof(handle, esp_io_expander_tca95xx_16bit_t, base);
+    esp_err_t ret = ESP_OK;
+    output &= 0xffff;
+    direction &= 0xffff;
+
+    /* Register pointer increments only inside of register pair, so both pairs are written in one transaction with repeated start */
+    const uint8_t output_data[] = {OUTPUT_REG_ADDR, output & 0xff, output >> 8};
+    const uint8_t direction_data[] = {DIRECTION_REG_ADDR, direction & 0xff, direction >> 8};
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    ESP_RETURN_ON_FALSE(cmd, ESP_ERR_NO_MEM, TAG, "Create I2C command failed");
+    ESP_GOTO_ON_ERROR(i2c_master_start(cmd), err, TAG, "I2C command failed");
+    ESP_GOTO_ON_ERROR(i2c_master_write_byte(cmd, (tca->i2c_address << 1) | I2C_MASTER_WRITE, true), err, TAG, "I2C command failed");
+    ESP_GOTO_ON_ERROR(i2c_master_write(cmd, output_data, sizeof(output_data), true), err, TAG, "I2C command failed");
+    ESP_GOTO_ON_ERROR(i2c_master_start(cmd), err, TAG, "I2C command failed");
+    ESP_GOTO_ON_ERROR(i2c_master_write_byte(cmd, (tca->i2c_address << 1) | I2C_MASTER_WRITE, true), err, TAG, "I2C command failed");
+    ESP_GOTO_ON_ERROR(i2c_master_write(cmd, direction_data, sizeof(direction_data), true), err, TAG, "I2C command failed");
+    ESP_GOTO_ON_ERROR(i2c_master_stop(cmd), err, TAG, "I2C command failed");
+    ESP_GOTO_ON_ERROR(i2c_master_cmd_begin(tca->i2c_num, cmd, pdMS_TO_TICKS(I2C_TIMEOUT_MS)), err, TAG, "Write output and direction reg failed");
+    tca->regs.output = output;
+    tca->regs.direction = direction;
+
+err:
+    i2c_cmd_link_delete(cmd);
+    return ret;
+}
+
+static esp_err_t write_output_reg_seq(esp_io_expander_handle_t handle, const uint32_t *values, size_t count)
+{
+    esp_io_expander_tca95xx_16bit_t *tca = (esp_io_expander_tca95xx_16bit_t *)__containerof(handle, esp_io_expander_tca95xx_16bit_t, base);
+
+    /* Register pointer toggles between output port 0 and 1, each value takes two data bytes */
+    uint8_t data[1 + 2 * OUTPUT_SEQ_MAX] = {OUTPUT_REG_ADDR};
+    while (count > 0) {
+        const size_t len = (count < OUTPUT_SEQ_MAX) ? count : OUTPUT_SEQ_MAX;
+        for (size_t i = 0; i < len; i++) {
+            data[1 + 2 * i] = values[i] & 0xff;
+            data[2 + 2 * i] = (values[i] >> 8) & 0xff;
+        }
+        ESP_RETURN_ON_ERROR(
+            i2c_master_write_to_device(tca->i2c_num, tca->i2c_address, data, 1 + 2 * len, pdMS_TO_TICKS(I2C_TIMEOUT_MS)),
+            TAG, "Write output reg sequence failed");
+        tca->regs.output = values[len - 1] & 0xffff;
+        values += len;
+        count -= len;
+    }
+    return ESP_OK;
+}
+
 static esp_err_t reset(esp_io_expander_t *handle)
 {
     ESP_RETURN_ON_ERROR(write_direction_reg(handle, DIR_REG_DEFAULT_VAL), TAG, "Write dir reg failed");
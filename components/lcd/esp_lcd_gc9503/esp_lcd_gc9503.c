@@ -283,7 +283,10 @@ static esp_err_t panel_gc9503_send_init_cmds(gc9503_panel_t *gc9503)
 
         ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, init_cmds[i].cmd, init_cmds[i].data, init_cmds[i].data_bytes),
                             TAG, "send command failed");
-        vTaskDelay(pdMS_TO_TICKS(init_cmds[i].delay_ms));
+        // Commands without delay are sent back to back, without switching to other tasks
+        if (init_cmds[i].delay_ms) {
+            vTaskDelay(pdMS_TO_TICKS(init_cmds[i].delay_ms));
+        }
     }
     ESP_LOGD(TAG, "send init commands success");
 
@@ -16,11 +16,18 @@
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "esp_check.h"
+#include "nvs.h"
 
 #include "esp_lcd_gc9a01.h"
 
 static const char *TAG = "gc9a01";
 
+/* NVS namespace of the saved gamma */
+#define GC9A01_GAMMA_NVS_NAMESPACE      "gc9a01"
+
+/* Lines of the panel memory */
+#define GC9A01_LINES    (240)
+
 static esp_err_t panel_gc9a01_del(esp_lcd_panel_t *panel);
 static esp_err_t panel_gc9a01_reset(esp_lcd_panel_t *panel);
 static esp_err_t panel_gc9a01_init(esp_lcd_panel_t *panel);
@@ -43,6 +50,9 @@ typedef struct {
     uint8_t colmod_val; // save current value of LCD_CMD_COLMOD register
     const gc9a01_lcd_init_cmd_t *init_cmds;
     uint16_t init_cmds_size;
+    bool te_enable;
+    gc9a01_gamma_t gamma;   // gamma set at runtime, it overrides the gamma of the init commands
+    bool gamma_set;
 } gc9a01_panel_t;
 
 esp_err_t esp_lcd_new_panel_gc9a01(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *panel_dev_config, esp_lcd_panel_handle_t *ret_panel)
@@ -108,6 +118,7 @@ esp_err_t esp_lcd_new_panel_gc9a01(const esp_lcd_panel_io_handle_t io, const esp
     if (panel_dev_config->vendor_config) {
         gc9a01->init_cmds = ((gc9a01_vendor_config_t *)panel_dev_config->vendor_config)->init_cmds;
         gc9a01->init_cmds_size = ((gc9a01_vendor_config_t *)panel_dev_config->vendor_config)->init_cmds_size;
+        gc9a01->te_enable = ((gc9a01_vendor_config_t *)panel_dev_config->vendor_config)->flags.te_enable;
     }
     gc9a01->base.del = panel_gc9a01_del;
     gc9a01->base.reset = panel_gc9a01_reset;
@@ -140,6 +151,121 @@ err:
     return ret;
 }
 
+// first panel line of the rows in coordinates of draw_bitmap (moved by y_gap, reversed by mirrored Y)
+static esp_err_t panel_gc9a01_rows_to_lines(gc9a01_panel_t *gc9a01, uint16_t top, uint16_t height, int *first)
+{
+    // with swapped axes, the lines of the panel are columns of the picture
+    ESP_RETURN_ON_FALSE(!(gc9a01->madctl_val & LCD_CMD_MV_BIT), ESP_ERR_NOT_SUPPORTED, TAG, "not supported with swapped axes");
+    int line = top + gc9a01->y_gap;
+    ESP_RETURN_ON_FALSE(height > 0 && line + height <= GC9A01_LINES, ESP_ERR_INVALID_ARG, TAG, "invalid rows");
+    if (gc9a01->madctl_val & LCD_CMD_MY_BIT) {
+        // row address order is reversed, the areas are defined in lines of the panel
+        line = GC9A01_LINES - line - height;
+    }
+    *first = line;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_gc9a01_set_idle_mode(esp_lcd_panel_handle_t panel, bool idle)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_gc9a01_del, ESP_ERR_INVALID_ARG, TAG, "invalid panel");
+    gc9a01_panel_t *gc9a01 = __containerof(panel, gc9a01_panel_t, base);
+
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(gc9a01->io, idle ? LCD_CMD_IDMON : LCD_CMD_IDMOFF, NULL, 0), TAG, "send command failed");
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_gc9a01_set_partial_mode(esp_lcd_panel_handle_t panel, bool partial, uint16_t top, uint16_t height)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_gc9a01_del, ESP_ERR_INVALID_ARG, TAG, "invalid panel");
+    gc9a01_panel_t *gc9a01 = __containerof(panel, gc9a01_panel_t, base);
+    esp_lcd_panel_io_handle_t io = gc9a01->io;
+
+    if (!partial) {
+        ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_NORON, NULL, 0), TAG, "send command failed");
+        return ESP_OK;
+    }
+
+    int first = 0;
+    ESP_RETURN_ON_ERROR(panel_gc9a01_rows_to_lines(gc9a01, top, height, &first), TAG, "invalid partial area");
+    const int last = first + height - 1;
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_PTLAR, (uint8_t[]) {
+        (first >> 8) & 0xFF,
+        first & 0xFF,
+        (last >> 8) & 0xFF,
+        last & 0xFF,
+    }, 4), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_PTLON, NULL, 0), TAG, "send command failed");
+
+    return ESP_OK;
+}
+
+static esp_err_t panel_gc9a01_send_gamma(gc9a01_panel_t *gc9a01)
+{
+    esp_lcd_panel_io_handle_t io = gc9a01->io;
+
+    // gamma registers are accessible only with enabled inter register
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, 0xFE, NULL, 0), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, 0xEF, NULL, 0), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, 0xF0, &gc9a01->gamma.positive[0], 6), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, 0xF1, &gc9a01->gamma.positive[6], 6), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, 0xF2, &gc9a01->gamma.negative[0], 6), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, 0xF3, &gc9a01->gamma.negative[6], 6), TAG, "send command failed");
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_gc9a01_set_gamma(esp_lcd_panel_handle_t panel, const gc9a01_gamma_t *gamma)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_gc9a01_del && gamma, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    gc9a01_panel_t *gc9a01 = __containerof(panel, gc9a01_panel_t, base);
+
+    gc9a01->gamma = *gamma;
+    gc9a01->gamma_set = true;
+    ESP_RETURN_ON_ERROR(panel_gc9a01_send_gamma(gc9a01), TAG, "set gamma failed");
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_gc9a01_save_gamma(esp_lcd_panel_handle_t panel, const char *key)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_gc9a01_del && key, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    gc9a01_panel_t *gc9a01 = __containerof(panel, gc9a01_panel_t, base);
+    esp_err_t ret = ESP_OK;
+    nvs_handle_t nvs;
+
+    ESP_RETURN_ON_FALSE(gc9a01->gamma_set, ESP_ERR_INVALID_STATE, TAG, "gamma is not set");
+    ESP_RETURN_ON_ERROR(nvs_open(GC9A01_GAMMA_NVS_NAMESPACE, NVS_READWRITE, &nvs), TAG, "NVS open failed");
+    ESP_GOTO_ON_ERROR(nvs_set_blob(nvs, key, &gc9a01->gamma, sizeof(gc9a01_gamma_t)), err, TAG, "NVS write failed");
+    ESP_GOTO_ON_ERROR(nvs_commit(nvs), err, TAG, "NVS commit failed");
+
+err:
+    nvs_close(nvs);
+    return ret;
+}
+
+esp_err_t esp_lcd_gc9a01_load_gamma(esp_lcd_panel_handle_t panel, const char *key)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_gc9a01_del && key, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    esp_err_t ret = ESP_OK;
+    nvs_handle_t nvs;
+    gc9a01_gamma_t gamma;
+    size_t len = sizeof(gc9a01_gamma_t);
+
+    ret = nvs_open(GC9A01_GAMMA_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (ret != ESP_OK) {
+        // namespace does not exist before the first save
+        return ret;
+    }
+    ret = nvs_get_blob(nvs, key, &gamma, &len);
+    nvs_close(nvs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ESP_RETURN_ON_FALSE(len == sizeof(gc9a01_gamma_t), ESP_ERR_INVALID_SIZE, TAG, "bad gamma in NVS");
+
+    return esp_lcd_gc9a01_set_gamma(panel, &gamma);
+}
+
 static esp_err_t panel_gc9a01_del(esp_lcd_panel_t *panel)
 {
     gc9a01_panel_t *gc9a01 = __containerof(panel, gc9a01_panel_t, base);
@@ -266,10 +392,25 @@ static esp_err_t panel_gc9a01_init(esp_lcd_panel_t *panel)
         }
 
         ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, init_cmds[i].cmd, init_cmds[i].data, init_cmds[i].data_bytes), TAG, "send command failed");
-        vTaskDelay(pdMS_TO_TICKS(init_cmds[i].delay_ms));
+        // Commands without delay are sent back to back, without switching to other tasks
+        if (init_cmds[i].delay_ms) {
+            vTaskDelay(pdMS_TO_TICKS(init_cmds[i].delay_ms));
+        }
     }
     ESP_LOGD(TAG, "send init commands success");
 
+    if (gc9a01->gamma_set) {
+        // gamma set at runtime (e.g. calibration of the unit) replaces the gamma of the init commands
+        ESP_RETURN_ON_ERROR(panel_gc9a01_send_gamma(gc9a01), TAG, "set gamma failed");
+    }
+
+    if (gc9a01->te_enable) {
+        // TE output with V-blanking information only
+        ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_TEON, (uint8_t[]) {
+            0x00,
+        }, 1), TAG, "send command failed");
+    }
+
     return ESP_OK;
 }
 
@@ -39,8 +39,22 @@ typedef struct {
                                                  *   Please refer to `vendor_specific_init_default` in source file.
                                                  */
     uint16_t init_cmds_size;                    /*<! Number of commands in above array */
+    struct {
+        unsigned int te_enable: 1;              /*<! Set to 1 to enable TE (tearing effect) output, the pulse is generated in each V-blanking */
+    } flags;
 } gc9a01_vendor_config_t;
 
+/**
+ * @brief Gamma correction of the panel
+ *
+ * Parameters of the gamma registers as they are sent to the controller, see the datasheet
+ * (`vendor_specific_init_default` in source file has the default curve).
+ */
+typedef struct {
+    uint8_t positive[12];   /*!< Positive gamma: SET_GAMMA1 (F0h, bytes 0-5) and SET_GAMMA2 (F1h, bytes 6-11) */
+    uint8_t negative[12];   /*!< Negative gamma: SET_GAMMA3 (F2h, bytes 0-5) and SET_GAMMA4 (F3h, bytes 6-11) */
+} gc9a01_gamma_t;
+
 /**
  * @brief Create LCD panel for model GC9A01
  *
@@ -56,6 +70,83 @@ typedef struct {
  */
 esp_err_t esp_lcd_new_panel_gc9a01(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *panel_dev_config, esp_lcd_panel_handle_t *ret_panel);
 
+/**
+ * @brief Turn idle mode on or off (IDMON/IDMOFF)
+ *
+ * In idle mode, the panel shows only 8 colors (MSB of each color component) and can run at lower frame rate
+ * (frame rate of the idle mode), which reduces its power consumption, e.g. on a static screen.
+ *
+ * @param[in] panel LCD panel handle of GC9A01
+ * @param[in] idle True to turn idle mode on, false to return to full colors
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_gc9a01_set_idle_mode(esp_lcd_panel_handle_t panel, bool idle);
+
+/**
+ * @brief Turn partial display mode on or off (PTLAR + PTLON/NORON)
+ *
+ * In partial mode, only the rows of the partial area are driven, the rest of the panel shows the non-display color.
+ *
+ * @note  Partial area is defined in lines of the panel (240), it is not supported with swapped axes (landscape orientation).
+ *
+ * @param[in] panel LCD panel handle of GC9A01
+ * @param[in] partial True to turn partial mode on, false to return to normal mode (whole panel)
+ * @param[in] top First row of the partial area (coordinates of `esp_lcd_panel_draw_bitmap()`, ignored in normal mode)
+ * @param[in] height Rows of the partial area (ignored in normal mode)
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_ERR_NOT_SUPPORTED if the axes are swapped
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_gc9a01_set_partial_mode(esp_lcd_panel_handle_t panel, bool partial, uint16_t top, uint16_t height);
+
+/**
+ * @brief Set gamma correction of the panel (SET_GAMMA1-4)
+ *
+ * The colors are corrected by the controller, so the rendered buffers need no color correction in software.
+ * The gamma is kept by the driver and sent again after the initialization commands by `esp_lcd_panel_init()`,
+ * so it can be set before or after the initialization.
+ *
+ * @param[in] panel LCD panel handle of GC9A01
+ * @param[in] gamma Gamma correction
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_gc9a01_set_gamma(esp_lcd_panel_handle_t panel, const gc9a01_gamma_t *gamma);
+
+/**
+ * @brief Save gamma correction of the panel into NVS (e.g. calibration of the unit)
+ *
+ * @note  NVS must be initialized (`nvs_flash_init`).
+ *
+ * @param[in] panel LCD panel handle of GC9A01
+ * @param[in] key NVS key (more panels can be saved under different keys)
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_ERR_INVALID_STATE if the gamma is not set by `esp_lcd_gc9a01_set_gamma()`
+ *          - ESP_OK                on success
+ *          - Others                NVS error
+ */
+esp_err_t esp_lcd_gc9a01_save_gamma(esp_lcd_panel_handle_t panel, const char *key);
+
+/**
+ * @brief Load gamma correction from NVS and set it to the panel
+ *
+ * @note  NVS must be initialized (`nvs_flash_init`).
+ *
+ * @param[in] panel LCD panel handle of GC9A01
+ * @param[in] key NVS key
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_ERR_NVS_NOT_FOUND if the gamma was not saved yet
+ *          - ESP_OK                on success
+ *          - Others                NVS error
+ */
+esp_err_t esp_lcd_gc9a01_load_gamma(esp_lcd_panel_handle_t panel, const char *key);
+
 /**
  * @brief LCD panel bus configuration structure
  *
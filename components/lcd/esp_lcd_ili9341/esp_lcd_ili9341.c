@@ -16,11 +16,18 @@
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "esp_check.h"
+#include "nvs.h"
 
 #include "esp_lcd_ili9341.h"
 
 static const char *TAG = "ili9341";
 
+/* Lines of the panel memory (rows in the native portrait orientation) */
+#define ILI9341_LINES   (320)
+
+/* NVS namespace of the saved gamma */
+#define ILI9341_GAMMA_NVS_NAMESPACE     "ili9341"
+
 static esp_err_t panel_ili9341_del(esp_lcd_panel_t *panel);
 static esp_err_t panel_ili9341_reset(esp_lcd_panel_t *panel);
 static esp_err_t panel_ili9341_init(esp_lcd_panel_t *panel);
@@ -43,6 +50,11 @@ typedef struct {
     uint8_t colmod_val; // save current value of LCD_CMD_COLMOD register
     const ili9341_lcd_init_cmd_t *init_cmds;
     uint16_t init_cmds_size;
+    bool te_enable;
+    uint16_t scroll_first;  // first panel line of the vertical scrolling area
+    uint16_t scroll_height; // lines of the vertical scrolling area (0: not defined)
+    ili9341_gamma_t gamma;  // gamma set at runtime, it overrides the gamma of the init commands
+    bool gamma_set;
 } ili9341_panel_t;
 
 esp_err_t esp_lcd_new_panel_ili9341(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *panel_dev_config, esp_lcd_panel_handle_t *ret_panel)
@@ -108,6 +120,7 @@ esp_err_t esp_lcd_new_panel_ili9341(const esp_lcd_panel_io_handle_t io, const es
     if (panel_dev_config->vendor_config) {
         ili9341->init_cmds = ((ili9341_vendor_config_t *)panel_dev_config->vendor_config)->init_cmds;
         ili9341->init_cmds_size = ((ili9341_vendor_config_t *)panel_dev_config->vendor_config)->init_cmds_size;
+        ili9341->te_enable = ((ili9341_vendor_config_t *)panel_dev_config->vendor_config)->flags.te_enable;
     }
     ili9341->base.del = panel_ili9341_del;
     ili9341->base.reset = panel_ili9341_reset;
@@ -140,6 +153,185 @@ err:
     return ret;
 }
 
+// first panel line of the rows in coordinates of draw_bitmap (moved by y_gap, reversed by mirrored Y)
+static esp_err_t panel_ili9341_rows_to_lines(ili9341_panel_t *ili9341, uint16_t top, uint16_t height, int *first)
+{
+    // with swapped axes, the lines of the panel are columns of the picture
+    ESP_RETURN_ON_FALSE(!(ili9341->madctl_val & LCD_CMD_MV_BIT), ESP_ERR_NOT_SUPPORTED, TAG, "not supported with swapped axes");
+    int line = top + ili9341->y_gap;
+    ESP_RETURN_ON_FALSE(height > 0 && line + height <= ILI9341_LINES, ESP_ERR_INVALID_ARG, TAG, "invalid rows");
+    if (ili9341->madctl_val & LCD_CMD_MY_BIT) {
+        // row address order is reversed, the areas are defined in lines of the panel
+        line = ILI9341_LINES - line - height;
+    }
+    *first = line;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_ili9341_set_idle_mode(esp_lcd_panel_handle_t panel, bool idle)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_ili9341_del, ESP_ERR_INVALID_ARG, TAG, "invalid panel");
+    ili9341_panel_t *ili9341 = __containerof(panel, ili9341_panel_t, base);
+
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(ili9341->io, idle ? LCD_CMD_IDMON : LCD_CMD_IDMOFF, NULL, 0), TAG, "send command failed");
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_ili9341_set_partial_mode(esp_lcd_panel_handle_t panel, bool partial, uint16_t top, uint16_t height)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_ili9341_del, ESP_ERR_INVALID_ARG, TAG, "invalid panel");
+    ili9341_panel_t *ili9341 = __containerof(panel, ili9341_panel_t, base);
+    esp_lcd_panel_io_handle_t io = ili9341->io;
+
+    if (!partial) {
+        ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_NORON, NULL, 0), TAG, "send command failed");
+        return ESP_OK;
+    }
+
+    int first = 0;
+    ESP_RETURN_ON_ERROR(panel_ili9341_rows_to_lines(ili9341, top, height, &first), TAG, "invalid partial area");
+    const int last = first + height - 1;
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_PTLAR, (uint8_t[]) {
+        (first >> 8) & 0xFF,
+        first & 0xFF,
+        (last >> 8) & 0xFF,
+        last & 0xFF,
+    }, 4), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_PTLON, NULL, 0), TAG, "send command failed");
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_ili9341_set_frame_rate(esp_lcd_panel_handle_t panel, ili9341_frame_rate_mode_t mode, uint8_t div, uint8_t rtn)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_ili9341_del, ESP_ERR_INVALID_ARG, TAG, "invalid panel");
+    ili9341_panel_t *ili9341 = __containerof(panel, ili9341_panel_t, base);
+    ESP_RETURN_ON_FALSE(mode <= ILI9341_FRAME_RATE_PARTIAL && div <= 3 && rtn >= 0x10 && rtn <= 0x1F, ESP_ERR_INVALID_ARG, TAG, "invalid frame rate");
+
+    // FRMCTR1 (normal), FRMCTR2 (idle) and FRMCTR3 (partial) have the same parameters
+    const int command = 0xB1 + mode;
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(ili9341->io, command, (uint8_t[]) {
+        div,
+        rtn,
+    }, 2), TAG, "send command failed");
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_ili9341_set_scroll_area(esp_lcd_panel_handle_t panel, uint16_t top, uint16_t height)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_ili9341_del, ESP_ERR_INVALID_ARG, TAG, "invalid panel");
+    ili9341_panel_t *ili9341 = __containerof(panel, ili9341_panel_t, base);
+    esp_lcd_panel_io_handle_t io = ili9341->io;
+
+    int first = 0;
+    ESP_RETURN_ON_ERROR(panel_ili9341_rows_to_lines(ili9341, top, height, &first), TAG, "invalid scroll area");
+    const int bottom = ILI9341_LINES - first - height;
+
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_VSCRDEF, (uint8_t[]) {
+        (first >> 8) & 0xFF,
+        first & 0xFF,
+        (height >> 8) & 0xFF,
+        height & 0xFF,
+        (bottom >> 8) & 0xFF,
+        bottom & 0xFF,
+    }, 6), TAG, "send command failed");
+    // the first line of the area is shown at its top
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_VSCSAD, (uint8_t[]) {
+        (first >> 8) & 0xFF,
+        first & 0xFF,
+    }, 2), TAG, "send command failed");
+    ili9341->scroll_first = first;
+    ili9341->scroll_height = height;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_ili9341_set_scroll_offset(esp_lcd_panel_handle_t panel, uint16_t offset)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_ili9341_del, ESP_ERR_INVALID_ARG, TAG, "invalid panel");
+    ili9341_panel_t *ili9341 = __containerof(panel, ili9341_panel_t, base);
+    esp_lcd_panel_io_handle_t io = ili9341->io;
+
+    ESP_RETURN_ON_FALSE(ili9341->scroll_height, ESP_ERR_INVALID_STATE, TAG, "scroll area is not defined");
+    ESP_RETURN_ON_FALSE(offset < ili9341->scroll_height, ESP_ERR_INVALID_ARG, TAG, "invalid scroll offset");
+    if (ili9341->madctl_val & LCD_CMD_MY_BIT) {
+        // picture is mirrored, the panel scrolls in the opposite direction
+        offset = (ili9341->scroll_height - offset) % ili9341->scroll_height;
+    }
+    const int line = ili9341->scroll_first + offset;
+
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_VSCSAD, (uint8_t[]) {
+        (line >> 8) & 0xFF,
+        line & 0xFF,
+    }, 2), TAG, "send command failed");
+
+    return ESP_OK;
+}
+
+static esp_err_t panel_ili9341_send_gamma(ili9341_panel_t *ili9341)
+{
+    esp_lcd_panel_io_handle_t io = ili9341->io;
+
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, 0xE0, ili9341->gamma.positive, sizeof(ili9341->gamma.positive)), TAG,
+                        "send command failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, 0xE1, ili9341->gamma.negative, sizeof(ili9341->gamma.negative)), TAG,
+                        "send command failed");
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_ili9341_set_gamma(esp_lcd_panel_handle_t panel, const ili9341_gamma_t *gamma)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_ili9341_del && gamma, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ili9341_panel_t *ili9341 = __containerof(panel, ili9341_panel_t, base);
+
+    ili9341->gamma = *gamma;
+    ili9341->gamma_set = true;
+    ESP_RETURN_ON_ERROR(panel_ili9341_send_gamma(ili9341), TAG, "set gamma failed");
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_ili9341_save_gamma(esp_lcd_panel_handle_t panel, const char *key)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_ili9341_del && key, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ili9341_panel_t *ili9341 = __containerof(panel, ili9341_panel_t, base);
+    esp_err_t ret = ESP_OK;
+    nvs_handle_t nvs;
+
+    ESP_RETURN_ON_FALSE(ili9341->gamma_set, ESP_ERR_INVALID_STATE, TAG, "gamma is not set");
+    ESP_RETURN_ON_ERROR(nvs_open(ILI9341_GAMMA_NVS_NAMESPACE, NVS_READWRITE, &nvs), TAG, "NVS open failed");
+    ESP_GOTO_ON_ERROR(nvs_set_blob(nvs, key, &ili9341->gamma, sizeof(ili9341_gamma_t)), err, TAG, "NVS write failed");
+    ESP_GOTO_ON_ERROR(nvs_commit(nvs), err, TAG, "NVS commit failed");
+
+err:
+    nvs_close(nvs);
+    return ret;
+}
+
+esp_err_t esp_lcd_ili9341_load_gamma(esp_lcd_panel_handle_t panel, const char *key)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_ili9341_del && key, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    esp_err_t ret = ESP_OK;
+    nvs_handle_t nvs;
+    ili9341_gamma_t gamma;
+    size_t len = sizeof(ili9341_gamma_t);
+
+    ret = nvs_open(ILI9341_GAMMA_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (ret != ESP_OK) {
+        // namespace does not exist before the first save
+        return ret;
+    }
+    ret = nvs_get_blob(nvs, key, &gamma, &len);
+    nvs_close(nvs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ESP_RETURN_ON_FALSE(len == sizeof(ili9341_gamma_t), ESP_ERR_INVALID_SIZE, TAG, "bad gamma in NVS");
+
+    return esp_lcd_ili9341_set_gamma(panel, &gamma);
+}
+
 static esp_err_t panel_ili9341_del(esp_lcd_panel_t *panel)
 {
     ili9341_panel_t *ili9341 = __containerof(panel, ili9341_panel_t, base);
@@ -226,6 +418,7 @@ static esp_err_t panel_ili9341_init(esp_lcd_panel_t *panel)
 
     // LCD goes into sleep mode and display will be turned off after power on reset, exit sleep mode first
     ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_SLPOUT, NULL, 0), TAG, "send command failed");
+    ili9341->scroll_height = 0;
     vTaskDelay(pdMS_TO_TICKS(100));
     ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_MADCTL, (uint8_t[]) {
         ili9341->madctl_val,
@@ -266,10 +459,25 @@ static esp_err_t panel_ili9341_init(esp_lcd_panel_t *panel)
         }
 
         ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, init_cmds[i].cmd, init_cmds[i].data, init_cmds[i].data_bytes), TAG, "send command failed");
-        vTaskDelay(pdMS_TO_TICKS(init_cmds[i].delay_ms));
+        // Commands without delay are sent back to back, without switching to other tasks
+        if (init_cmds[i].delay_ms) {
+            vTaskDelay(pdMS_TO_TICKS(init_cmds[i].delay_ms));
+        }
     }
     ESP_LOGD(TAG, "send init commands success");
 
+    if (ili9341->gamma_set) {
+        // gamma set at runtime (e.g. calibration of the unit) replaces the gamma of the init commands
+        ESP_RETURN_ON_ERROR(panel_ili9341_send_gamma(ili9341), TAG, "set gamma failed");
+    }
+
+    if (ili9341->te_enable) {
+        // TE output with V-blanking information only
+        ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_TEON, (uint8_t[]) {
+            0x00,
+        }, 1), TAG, "send command failed");
+    }
+
     return ESP_OK;
 }
 
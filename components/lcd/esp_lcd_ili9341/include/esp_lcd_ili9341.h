@@ -39,8 +39,31 @@ typedef struct {
                                                  *   Please refer to `vendor_specific_init_default` in source file.
                                                  */
     uint16_t init_cmds_size;                    /*<! Number of commands in above array */
+    struct {
+        unsigned int te_enable: 1;              /*<! Set to 1 to enable TE (tearing effect) output, the pulse is generated in each V-blanking */
+    } flags;
 } ili9341_vendor_config_t;
 
+/**
+ * @brief Display mode of the frame rate control
+ */
+typedef enum {
+    ILI9341_FRAME_RATE_NORMAL = 0,  /*!< Normal mode, full colors (FRMCTR1) */
+    ILI9341_FRAME_RATE_IDLE,        /*!< Idle mode, 8 colors (FRMCTR2) */
+    ILI9341_FRAME_RATE_PARTIAL,     /*!< Partial mode, full colors (FRMCTR3) */
+} ili9341_frame_rate_mode_t;
+
+/**
+ * @brief Gamma correction of the panel
+ *
+ * Parameters of the gamma registers as they are sent to the controller, see the datasheet
+ * (`vendor_specific_init_default` in source file has the default curve).
+ */
+typedef struct {
+    uint8_t positive[15];   /*!< Positive gamma correction (PGAMCTRL, E0h) */
+    uint8_t negative[15];   /*!< Negative gamma correction (NGAMCTRL, E1h) */
+} ili9341_gamma_t;
+
 /**
  * @brief Create LCD panel for model ILI9341
  *
@@ -56,6 +79,133 @@ typedef struct {
  */
 esp_err_t esp_lcd_new_panel_ili9341(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *panel_dev_config, esp_lcd_panel_handle_t *ret_panel);
 
+/**
+ * @brief Turn idle mode on or off (IDMON/IDMOFF)
+ *
+ * In idle mode, the panel shows only 8 colors (MSB of each color component) and can run at lower frame rate
+ * (frame rate of the idle mode), which reduces its power consumption, e.g. on a static screen.
+ *
+ * @param[in] panel LCD panel handle of ILI9341
+ * @param[in] idle True to turn idle mode on, false to return to full colors
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_ili9341_set_idle_mode(esp_lcd_panel_handle_t panel, bool idle);
+
+/**
+ * @brief Turn partial display mode on or off (PTLAR + PTLON/NORON)
+ *
+ * In partial mode, only the rows of the partial area are driven, the rest of the panel shows the non-display color.
+ *
+ * @note  Partial area is defined in lines of the panel (320), it is not supported with swapped axes (landscape orientation).
+ *
+ * @param[in] panel LCD panel handle of ILI9341
+ * @param[in] partial True to turn partial mode on, false to return to normal mode (whole panel)
+ * @param[in] top First row of the partial area (coordinates of `esp_lcd_panel_draw_bitmap()`, ignored in normal mode)
+ * @param[in] height Rows of the partial area (ignored in normal mode)
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_ERR_NOT_SUPPORTED if the axes are swapped
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_ili9341_set_partial_mode(esp_lcd_panel_handle_t panel, bool partial, uint16_t top, uint16_t height);
+
+/**
+ * @brief Set frame rate of the display mode (FRMCTR1/2/3)
+ *
+ * Frame rate = 615 kHz / (2^div * rtn * 324), e.g. 70 Hz for div 0 and rtn 0x1B (default), 61 Hz for div 0 and rtn 0x1F,
+ * 30 Hz for div 1 and rtn 0x1F, 8 Hz for div 3 and rtn 0x1F.
+ *
+ * @param[in] panel LCD panel handle of ILI9341
+ * @param[in] mode Display mode
+ * @param[in] div Division ratio of the internal clock (0: 1, 1: 1/2, 2: 1/4, 3: 1/8)
+ * @param[in] rtn Clocks per line (0x10 to 0x1F: 16 to 31 clocks)
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_ili9341_set_frame_rate(esp_lcd_panel_handle_t panel, ili9341_frame_rate_mode_t mode, uint8_t div, uint8_t rtn);
+
+/**
+ * @brief Define vertical scrolling area (VSCRDEF)
+ *
+ * Rows above and below the scrolling area are fixed. The rows of the scrolling area are shown rotated by the offset
+ * set by `esp_lcd_ili9341_set_scroll_offset()`, so a scrolled picture needs only the newly exposed rows to be sent.
+ * The scrolling offset is reset to 0.
+ *
+ * @note  Scrolling works in lines of the panel (320), it is not supported with swapped axes (landscape orientation).
+ *
+ * @param[in] panel LCD panel handle of ILI9341
+ * @param[in] top First row of the scrolling area (coordinates of `esp_lcd_panel_draw_bitmap()`)
+ * @param[in] height Rows of the scrolling area
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_ERR_NOT_SUPPORTED if the axes are swapped
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_ili9341_set_scroll_area(esp_lcd_panel_handle_t panel, uint16_t top, uint16_t height);
+
+/**
+ * @brief Set vertical scrolling offset (VSCRSADD)
+ *
+ * The row `top + offset` of the panel memory is shown at the top of the scrolling area, the rows of the memory
+ * above it are shown below the last one.
+ *
+ * @param[in] panel LCD panel handle of ILI9341
+ * @param[in] offset Scrolling offset in rows (0 to `height - 1`)
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_ERR_INVALID_STATE if the scrolling area is not defined
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_ili9341_set_scroll_offset(esp_lcd_panel_handle_t panel, uint16_t offset);
+
+/**
+ * @brief Set gamma correction of the panel (PGAMCTRL/NGAMCTRL)
+ *
+ * The colors are corrected by the controller, so the rendered buffers need no color correction in software.
+ * The gamma is kept by the driver and sent again after the initialization commands by `esp_lcd_panel_init()`,
+ * so it can be set before or after the initialization.
+ *
+ * @param[in] panel LCD panel handle of ILI9341
+ * @param[in] gamma Gamma correction
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_ili9341_set_gamma(esp_lcd_panel_handle_t panel, const ili9341_gamma_t *gamma);
+
+/**
+ * @brief Save gamma correction of the panel into NVS (e.g. calibration of the unit)
+ *
+ * @note  NVS must be initialized (`nvs_flash_init`).
+ *
+ * @param[in] panel LCD panel handle of ILI9341
+ * @param[in] key NVS key (more panels can be saved under different keys)
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_ERR_INVALID_STATE if the gamma is not set by `esp_lcd_ili9341_set_gamma()`
+ *          - ESP_OK                on success
+ *          - Others                NVS error
+ */
+esp_err_t esp_lcd_ili9341_save_gamma(esp_lcd_panel_handle_t panel, const char *key);
+
+/**
+ * @brief Load gamma correction from NVS and set it to the panel
+ *
+ * @note  NVS must be initialized (`nvs_flash_init`).
+ *
+ * @param[in] panel LCD panel handle of ILI9341
+ * @param[in] key NVS key
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_ERR_NVS_NOT_FOUND if the gamma was not saved yet
+ *          - ESP_OK                on success
+ *          - Others                NVS error
+ */
+esp_err_t esp_lcd_ili9341_load_gamma(esp_lcd_panel_handle_t panel, const char *key);
+
 /**
  * @brief LCD panel bus configuration structure
  *
@@ -17,6 +17,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/gpio.h"
+#include "nvs.h"
 #include "esp_lcd_ili9881c.h"
 
 #define ILI9881C_CMD_CNDBKxSEL                (0xFF)
@@ -35,6 +36,11 @@
 #define ILI9881C_CMD_GS_BIT       (1 << 0)
 #define ILI9881C_CMD_SS_BIT       (1 << 1)
 
+// First registers of the positive and negative gamma on CMD_Page 1
+#define ILI9881C_GAMMA_POSITIVE               (0xA0)
+#define ILI9881C_GAMMA_NEGATIVE               (0xC0)
+#define ILI9881C_GAMMA_NVS_NAMESPACE          "ili9881c"
+
 typedef struct {
     esp_lcd_panel_io_handle_t io;
     int reset_gpio_num;
@@ -43,8 +49,10 @@ typedef struct {
     const ili9881c_lcd_init_cmd_t *init_cmds;
     uint16_t init_cmds_size;
     uint8_t lane_num;
+    ili9881c_gamma_t gamma; // gamma set at runtime, it overrides the gamma of the init commands
     struct {
         unsigned int reset_level: 1;
+        unsigned int gamma_set: 1;
     } flags;
     // To save the original functions of MIPI DPI panel
     esp_err_t (*del)(esp_lcd_panel_t *panel);
@@ -358,6 +366,82 @@ static const ili9881c_lcd_init_cmd_t vendor_specific_init_default[] = {
     //============ Gamma END===========
 };
 
+static esp_err_t panel_ili9881c_send_gamma(ili9881c_panel_t *ili9881c)
+{
+    esp_lcd_panel_io_handle_t io = ili9881c->io;
+
+    // The gamma registers are on the CMD_Page 1
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, ILI9881C_CMD_CNDBKxSEL, (uint8_t[]) {
+        ILI9881C_CMD_BKxSEL_BYTE0, ILI9881C_CMD_BKxSEL_BYTE1, ILI9881C_CMD_BKxSEL_BYTE2_PAGE1
+    }, 3), TAG, "send command failed");
+    for (size_t i = 0; i < sizeof(ili9881c->gamma.positive); i++) {
+        ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, ILI9881C_GAMMA_POSITIVE + i, &ili9881c->gamma.positive[i], 1), TAG,
+                            "send command failed");
+    }
+    for (size_t i = 0; i < sizeof(ili9881c->gamma.negative); i++) {
+        ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, ILI9881C_GAMMA_NEGATIVE + i, &ili9881c->gamma.negative[i], 1), TAG,
+                            "send command failed");
+    }
+    // back to CMD_Page 0
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, ILI9881C_CMD_CNDBKxSEL, (uint8_t[]) {
+        ILI9881C_CMD_BKxSEL_BYTE0, ILI9881C_CMD_BKxSEL_BYTE1, ILI9881C_CMD_BKxSEL_BYTE2_PAGE0
+    }, 3), TAG, "send command failed");
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_ili9881c_set_gamma(esp_lcd_panel_handle_t panel, const ili9881c_gamma_t *gamma)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_ili9881c_del && gamma, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+    ili9881c_panel_t *ili9881c = (ili9881c_panel_t *)panel->user_data;
+
+    ili9881c->gamma = *gamma;
+    ili9881c->flags.gamma_set = 1;
+    ESP_RETURN_ON_ERROR(panel_ili9881c_send_gamma(ili9881c), TAG, "set gamma failed");
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_ili9881c_save_gamma(esp_lcd_panel_handle_t panel, const char *key)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_ili9881c_del && key, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+    ili9881c_panel_t *ili9881c = (ili9881c_panel_t *)panel->user_data;
+    esp_err_t ret = ESP_OK;
+    nvs_handle_t nvs;
+
+    ESP_RETURN_ON_FALSE(ili9881c->flags.gamma_set, ESP_ERR_INVALID_STATE, TAG, "gamma is not set");
+    ESP_RETURN_ON_ERROR(nvs_open(ILI9881C_GAMMA_NVS_NAMESPACE, NVS_READWRITE, &nvs), TAG, "NVS open failed");
+    ESP_GOTO_ON_ERROR(nvs_set_blob(nvs, key, &ili9881c->gamma, sizeof(ili9881c_gamma_t)), err, TAG, "NVS write failed");
+    ESP_GOTO_ON_ERROR(nvs_commit(nvs), err, TAG, "NVS commit failed");
+
+err:
+    nvs_close(nvs);
+    return ret;
+}
+
+esp_err_t esp_lcd_ili9881c_load_gamma(esp_lcd_panel_handle_t panel, const char *key)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_ili9881c_del && key, ESP_ERR_INVALID_ARG, TAG, "invalid arguments");
+    esp_err_t ret = ESP_OK;
+    nvs_handle_t nvs;
+    ili9881c_gamma_t gamma;
+    size_t len = sizeof(ili9881c_gamma_t);
+
+    ret = nvs_open(ILI9881C_GAMMA_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (ret != ESP_OK) {
+        // namespace does not exist before the first save
+        return ret;
+    }
+    ret = nvs_get_blob(nvs, key, &gamma, &len);
+    nvs_close(nvs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ESP_RETURN_ON_FALSE(len == sizeof(ili9881c_gamma_t), ESP_ERR_INVALID_SIZE, TAG, "bad gamma in NVS");
+
+    return esp_lcd_ili9881c_set_gamma(panel, &gamma);
+}
+
 static esp_err_t panel_ili9881c_del(esp_lcd_panel_t *panel)
 {
     ili9881c_panel_t *ili9881c = (ili9881c_panel_t *)panel->user_data;
@@ -457,7 +541,10 @@ static esp_err_t panel_ili9881c_init(esp_lcd_panel_t *panel)
 
         // Send command
         ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, init_cmds[i].cmd, init_cmds[i].data, init_cmds[i].data_bytes), TAG, "send command failed");
-        vTaskDelay(pdMS_TO_TICKS(init_cmds[i].delay_ms));
+        // Commands without delay are sent back to back, without switching to other tasks
+        if (init_cmds[i].delay_ms) {
+            vTaskDelay(pdMS_TO_TICKS(init_cmds[i].delay_ms));
+        }
 
         if ((init_cmds[i].cmd == ILI9881C_CMD_CNDBKxSEL) && (((uint8_t *)init_cmds[i].data)[2] == ILI9881C_CMD_BKxSEL_BYTE2_PAGE0)) {
             is_command0_enable = true;
@@ -467,6 +554,11 @@ static esp_err_t panel_ili9881c_init(esp_lcd_panel_t *panel)
     }
     ESP_LOGD(TAG, "send init commands success");
 
+    if (ili9881c->flags.gamma_set) {
+        // gamma set at runtime (e.g. calibration of the unit) replaces the gamma of the init commands
+        ESP_RETURN_ON_ERROR(panel_ili9881c_send_gamma(ili9881c), TAG, "set gamma failed");
+    }
+
     ESP_RETURN_ON_ERROR(ili9881c->init(panel), TAG, "init MIPI DPI panel failed");
 
     return ESP_OK;
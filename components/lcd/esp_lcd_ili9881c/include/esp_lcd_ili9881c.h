@@ -51,6 +51,17 @@ typedef struct {
     } mipi_config;
 } ili9881c_vendor_config_t;
 
+/**
+ * @brief Gamma correction of the panel
+ *
+ * Values of the gamma registers on CMD_Page 1 as they are sent to the controller, see the datasheet
+ * (`vendor_specific_init_default` in source file has the default curve).
+ */
+typedef struct {
+    uint8_t positive[20];   /*!< Positive gamma correction (registers A0h-B3h) */
+    uint8_t negative[20];   /*!< Negative gamma correction (registers C0h-D3h) */
+} ili9881c_gamma_t;
+
 /**
  * @brief Create LCD panel for model ILI9881C
  *
@@ -67,6 +78,51 @@ typedef struct {
 esp_err_t esp_lcd_new_panel_ili9881c(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *panel_dev_config,
                                      esp_lcd_panel_handle_t *ret_panel);
 
+/**
+ * @brief Set gamma correction of the panel
+ *
+ * The colors are corrected by the controller, so the rendered buffers need no color correction in software.
+ * The gamma is kept by the driver and sent again after the initialization commands by `esp_lcd_panel_init()`,
+ * so it can be set before or after the initialization.
+ *
+ * @param[in] panel LCD panel handle of ILI9881C
+ * @param[in] gamma Gamma correction
+ * @return
+ *      - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *      - ESP_OK                on success
+ */
+esp_err_t esp_lcd_ili9881c_set_gamma(esp_lcd_panel_handle_t panel, const ili9881c_gamma_t *gamma);
+
+/**
+ * @brief Save gamma correction of the panel into NVS (e.g. calibration of the unit)
+ *
+ * @note  NVS must be initialized (`nvs_flash_init`).
+ *
+ * @param[in] panel LCD panel handle of ILI9881C
+ * @param[in] key NVS key (more panels can be saved under different keys)
+ * @return
+ *      - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *      - ESP_ERR_INVALID_STATE if the gamma is not set by `esp_lcd_ili9881c_set_gamma()`
+ *      - ESP_OK                on success
+ *      - Others                NVS error
+ */
+esp_err_t esp_lcd_ili9881c_save_gamma(esp_lcd_panel_handle_t panel, const char *key);
+
+/**
+ * @brief Load gamma correction from NVS and set it to the panel
+ *
+ * @note  NVS must be initialized (`nvs_flash_init`).
+ *
+ * @param[in] panel LCD panel handle of ILI9881C
+ * @param[in] key NVS key
+ * @return
+ *      - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *      - ESP_ERR_NVS_NOT_FOUND if the gamma was not saved yet
+ *      - ESP_OK                on success
+ *      - Others                NVS error
+ */
+esp_err_t esp_lcd_ili9881c_load_gamma(esp_lcd_panel_handle_t panel, const char *key);
+
 /**
  * @brief MIPI-DSI bus configuration structure
  *
@@ -21,6 +21,28 @@
 
 #define ESP_RA8875_TIMEOUT_US   (10*1000)
 
+/* Block Transfer Engine (BTE) registers */
+#define RA8875_REG_BECR0        0x50    // BTE enable / status
+#define RA8875_REG_BECR1        0x51    // ROP code [7:4] and BTE operation [3:0]
+#define RA8875_REG_HSBE0        0x54    // Source X
+#define RA8875_REG_VSBE0        0x56    // Source Y
+#define RA8875_REG_HDBE0        0x58    // Destination X
+#define RA8875_REG_VDBE0        0x5a    // Destination Y
+#define RA8875_REG_BEWR0        0x5c    // Block width
+#define RA8875_REG_BEHR0        0x5e    // Block height
+#define RA8875_REG_FGCR0        0x63    // Foreground color red, green and blue in 3 registers
+#define RA8875_REG_PTNO         0x66    // Pattern number and size
+#define RA8875_REG_MWCR1        0x41    // Memory write destination
+
+#define RA8875_BTE_START        0x80
+#define RA8875_BTE_ROP_SOURCE   0xc0    // Destination = Source
+#define RA8875_BTE_MOVE_POS     0x02    // Move with ROP in positive direction
+#define RA8875_BTE_MOVE_NEG     0x03    // Move with ROP in negative direction (block corners are bottom-right)
+#define RA8875_BTE_PATTERN_FILL 0x06    // Pattern fill with ROP
+#define RA8875_BTE_SOLID_FILL   0x0c    // Solid fill with foreground color
+#define RA8875_MWCR1_PATTERN    0x08    // Memory write to pattern RAM
+#define RA8875_PATTERN_SIZE     8       // 8x8 pixels pattern
+
 static const char *TAG = "ra8875";
 
 static esp_err_t panel_ra8875_del(esp_lcd_panel_t *panel);
@@ -245,6 +267,12 @@ static esp_err_t panel_ra8875_tx_param(esp_lcd_panel_t *panel, int lcd_cmd, uint
     }, 1);
 }
 
+static esp_err_t panel_ra8875_tx_param_u16(esp_lcd_panel_t *panel, int lcd_cmd, uint16_t param)
+{
+    ESP_RETURN_ON_ERROR(panel_ra8875_tx_param(panel, lcd_cmd, param & 0xff), TAG, "send command failed");
+    return panel_ra8875_tx_param(panel, lcd_cmd + 1, param >> 8);
+}
+
 static esp_err_t panel_ra8875_init(esp_lcd_panel_t *panel)
 {
     ra8875_panel_t *ra8875 = __containerof(panel, ra8875_panel_t, base);
@@ -338,6 +366,113 @@ static esp_err_t panel_ra8875_draw_bitmap(esp_lcd_panel_t *panel, int x_start, i
     return ESP_OK;
 }
 
+/* Convert panel rectangle to display memory rectangle (gap and axes swap) */
+static void panel_ra8875_to_memory(ra8875_panel_t *ra8875, int *x_start, int *y_start, int *x_end, int *y_end)
+{
+    *x_start += ra8875->x_gap;
+    *x_end += ra8875->x_gap;
+    *y_start += ra8875->y_gap;
+    *y_end += ra8875->y_gap;
+
+    if (ra8875->swap_axes) {
+        int xs = *x_start;
+        int xe = *x_end;
+
+        *x_start = *y_start;
+        *y_start = xs;
+
+        *x_end = *y_end;
+        *y_end = xe;
+    }
+}
+
+static esp_err_t panel_ra8875_set_fg_color(esp_lcd_panel_t *panel, uint16_t color)
+{
+    ra8875_panel_t *ra8875 = __containerof(panel, ra8875_panel_t, base);
+    uint8_t r, g, b;
+
+    if (ra8875->bits_per_pixel == 16) {
+        // RGB565
+        r = (color >> 11) & 0x1f;
+        g = (color >> 5) & 0x3f;
+        b = color & 0x1f;
+    } else {
+        // RGB332
+        r = (color >> 5) & 0x07;
+        g = (color >> 2) & 0x07;
+        b = color & 0x03;
+    }
+    ESP_RETURN_ON_ERROR(panel_ra8875_tx_param(panel, RA8875_REG_FGCR0, r), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(panel_ra8875_tx_param(panel, RA8875_REG_FGCR0 + 1, g), TAG, "send command failed");
+    return panel_ra8875_tx_param(panel, RA8875_REG_FGCR0 + 2, b);
+}
+
+/* Set destination block and start BTE, the engine runs until WAIT is released */
+static esp_err_t panel_ra8875_bte_start(esp_lcd_panel_t *panel, uint8_t operation, int x, int y, int width, int height)
+{
+    ESP_RETURN_ON_ERROR(panel_ra8875_tx_param_u16(panel, RA8875_REG_HDBE0, x), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(panel_ra8875_tx_param_u16(panel, RA8875_REG_VDBE0, y), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(panel_ra8875_tx_param_u16(panel, RA8875_REG_BEWR0, width), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(panel_ra8875_tx_param_u16(panel, RA8875_REG_BEHR0, height), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(panel_ra8875_tx_param(panel, RA8875_REG_BECR1, operation), TAG, "send command failed");
+    return panel_ra8875_tx_param(panel, RA8875_REG_BECR0, RA8875_BTE_START);
+}
+
+esp_err_t esp_lcd_ra8875_fill_rect(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end, uint16_t color)
+{
+    ESP_RETURN_ON_FALSE(panel && (x_start < x_end) && (y_start < y_end), ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ra8875_panel_t *ra8875 = __containerof(panel, ra8875_panel_t, base);
+    ESP_RETURN_ON_FALSE(ra8875->wait_gpio_num >= 0, ESP_ERR_NOT_SUPPORTED, TAG, "BTE needs WAIT GPIO");
+
+    panel_ra8875_to_memory(ra8875, &x_start, &y_start, &x_end, &y_end);
+    ESP_RETURN_ON_ERROR(panel_ra8875_set_fg_color(panel, color), TAG, "set color failed");
+    return panel_ra8875_bte_start(panel, RA8875_BTE_ROP_SOURCE | RA8875_BTE_SOLID_FILL, x_start, y_start, x_end - x_start, y_end - y_start);
+}
+
+esp_err_t esp_lcd_ra8875_move_rect(esp_lcd_panel_handle_t panel, int src_x, int src_y, int x_start, int y_start, int x_end, int y_end)
+{
+    ESP_RETURN_ON_FALSE(panel && (x_start < x_end) && (y_start < y_end), ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ra8875_panel_t *ra8875 = __containerof(panel, ra8875_panel_t, base);
+    ESP_RETURN_ON_FALSE(ra8875->wait_gpio_num >= 0, ESP_ERR_NOT_SUPPORTED, TAG, "BTE needs WAIT GPIO");
+
+    int src_x_end = src_x + (x_end - x_start);
+    int src_y_end = src_y + (y_end - y_start);
+    panel_ra8875_to_memory(ra8875, &src_x, &src_y, &src_x_end, &src_y_end);
+    panel_ra8875_to_memory(ra8875, &x_start, &y_start, &x_end, &y_end);
+
+    // Overlapping blocks: destination after source in memory must be copied from the end
+    uint8_t operation = RA8875_BTE_ROP_SOURCE | RA8875_BTE_MOVE_POS;
+    if ((y_start > src_y) || ((y_start == src_y) && (x_start > src_x))) {
+        operation = RA8875_BTE_ROP_SOURCE | RA8875_BTE_MOVE_NEG;
+        src_x = src_x_end - 1;
+        src_y = src_y_end - 1;
+    }
+    ESP_RETURN_ON_ERROR(panel_ra8875_tx_param_u16(panel, RA8875_REG_HSBE0, src_x), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(panel_ra8875_tx_param_u16(panel, RA8875_REG_VSBE0, src_y), TAG, "send command failed");
+    if (operation == (RA8875_BTE_ROP_SOURCE | RA8875_BTE_MOVE_NEG)) {
+        return panel_ra8875_bte_start(panel, operation, x_end - 1, y_end - 1, x_end - x_start, y_end - y_start);
+    }
+    return panel_ra8875_bte_start(panel, operation, x_start, y_start, x_end - x_start, y_end - y_start);
+}
+
+esp_err_t esp_lcd_ra8875_pattern_fill(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end, const void *pattern)
+{
+    ESP_RETURN_ON_FALSE(panel && pattern && (x_start < x_end) && (y_start < y_end), ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ra8875_panel_t *ra8875 = __containerof(panel, ra8875_panel_t, base);
+    ESP_RETURN_ON_FALSE(ra8875->wait_gpio_num >= 0, ESP_ERR_NOT_SUPPORTED, TAG, "BTE needs WAIT GPIO");
+
+    // Load 8x8 pattern number 0 into pattern RAM
+    ESP_RETURN_ON_ERROR(panel_ra8875_tx_param(panel, RA8875_REG_PTNO, 0x00), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(panel_ra8875_tx_param(panel, RA8875_REG_MWCR1, RA8875_MWCR1_PATTERN), TAG, "send command failed");
+    panel_ra8875_wait(panel);
+    size_t len = RA8875_PATTERN_SIZE * RA8875_PATTERN_SIZE * ra8875->bits_per_pixel / 8;
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_color(ra8875->io, 0x02, pattern, len), TAG, "send pattern failed");
+    ESP_RETURN_ON_ERROR(panel_ra8875_tx_param(panel, RA8875_REG_MWCR1, 0x00), TAG, "send command failed");
+
+    panel_ra8875_to_memory(ra8875, &x_start, &y_start, &x_end, &y_end);
+    return panel_ra8875_bte_start(panel, RA8875_BTE_ROP_SOURCE | RA8875_BTE_PATTERN_FILL, x_start, y_start, x_end - x_start, y_end - y_start);
+}
+
 static esp_err_t panel_ra8875_invert_color(esp_lcd_panel_t *panel, bool invert_color_data)
 {
     ESP_LOGE(TAG, "invert color is unsupported");
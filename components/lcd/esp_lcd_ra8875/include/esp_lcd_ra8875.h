@@ -39,6 +39,61 @@ typedef struct {
  */
 esp_err_t esp_lcd_new_panel_ra8875(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *panel_dev_config, esp_lcd_panel_handle_t *ret_panel);
 
+/**
+ * @brief Fill rectangle with one color by the Block Transfer Engine
+ *
+ * @note No pixel data are sent, the operation runs in the controller. WAIT GPIO is needed.
+ *
+ * @param[in] panel LCD panel handle
+ * @param[in] x_start Start index on x-axis (x_start included)
+ * @param[in] y_start Start index on y-axis (y_start included)
+ * @param[in] x_end End index on x-axis (x_end not included)
+ * @param[in] y_end End index on y-axis (y_end not included)
+ * @param[in] color Color in the panel pixel format (RGB565 or RGB332)
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_ERR_NOT_SUPPORTED if WAIT GPIO is not used
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_ra8875_fill_rect(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end, uint16_t color);
+
+/**
+ * @brief Move (copy) rectangle inside the display memory by the Block Transfer Engine
+ *
+ * @note It can be used for scrolling, overlapping source and destination are supported. WAIT GPIO is needed.
+ *
+ * @param[in] panel LCD panel handle
+ * @param[in] src_x Source start index on x-axis
+ * @param[in] src_y Source start index on y-axis
+ * @param[in] x_start Destination start index on x-axis (x_start included)
+ * @param[in] y_start Destination start index on y-axis (y_start included)
+ * @param[in] x_end Destination end index on x-axis (x_end not included)
+ * @param[in] y_end Destination end index on y-axis (y_end not included)
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_ERR_NOT_SUPPORTED if WAIT GPIO is not used
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_ra8875_move_rect(esp_lcd_panel_handle_t panel, int src_x, int src_y, int x_start, int y_start, int x_end, int y_end);
+
+/**
+ * @brief Fill rectangle with repeated 8x8 pattern by the Block Transfer Engine
+ *
+ * @note Only the pattern (64 pixels) is sent. WAIT GPIO is needed.
+ *
+ * @param[in] panel LCD panel handle
+ * @param[in] x_start Start index on x-axis (x_start included)
+ * @param[in] y_start Start index on y-axis (y_start included)
+ * @param[in] x_end End index on x-axis (x_end not included)
+ * @param[in] y_end End index on y-axis (y_end not included)
+ * @param[in] pattern 8x8 pixels in the panel pixel format
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          - ESP_ERR_NOT_SUPPORTED if WAIT GPIO is not used
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_ra8875_pattern_fill(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end, const void *pattern);
+
 #ifdef __cplusplus
 }
 #endif
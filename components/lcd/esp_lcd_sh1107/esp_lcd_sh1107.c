@@ -5,6 +5,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <sys/cdefs.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -22,6 +23,15 @@ static const char *TAG = "sh1107";
 
 #define LCD_SH1107_I2C_CMD  0X00
 #define LCD_SH1107_I2C_RAM  0X40
+/* Control byte with continuation bit: one command byte follows, then next control byte */
+#define LCD_SH1107_I2C_CMD_CONT 0X80
+
+/* Maximum number of columns of SH1107 */
+#define LCD_SH1107_MAX_COLUMNS  (128)
+/* Number of pages (8 rows each) of SH1107 */
+#define LCD_SH1107_MAX_PAGES    (16)
+/* Page setup in one I2C transaction: column high, column low and page commands, each with own control byte */
+#define LCD_SH1107_PAGE_SETUP_LEN   (6)
 
 #define LCD_SH1107_PARAM_ONOFF          0xAE
 #define LCD_SH1107_PARAM_MIRROR_X       0xA0
@@ -47,6 +57,9 @@ typedef struct {
     int y_gap;
     unsigned int bits_per_pixel;
     bool swap_axes;
+    uint8_t page_buf[LCD_SH1107_PAGE_SETUP_LEN + LCD_SH1107_MAX_COLUMNS]; /* Page setup and data sent in one I2C transaction */
+    uint8_t gddram[LCD_SH1107_MAX_PAGES][LCD_SH1107_MAX_COLUMNS]; /* Shadow of the display RAM, only changed columns are sent */
+    uint16_t gddram_valid; /* Bit mask of pages, whose shadow matches the display RAM */
 } sh1107_panel_t;
 
 esp_err_t esp_lcd_new_panel_sh1107(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *panel_dev_config, esp_lcd_panel_handle_t *ret_panel)
@@ -113,6 +126,9 @@ static esp_err_t panel_sh1107_reset(esp_lcd_panel_t *panel)
 {
     sh1107_panel_t *sh1107 = __containerof(panel, sh1107_panel_t, base);
 
+    /* Content of display RAM is not known after reset */
+    sh1107->gddram_valid = 0;
+
     // perform hardware reset
     if (GPIO_IS_VALID_OUTPUT_GPIO(sh1107->reset_gpio_num)) {
         gpio_set_level(sh1107->reset_gpio_num, sh1107->reset_level);
@@ -170,6 +186,8 @@ static esp_err_t panel_sh1107_init(esp_lcd_panel_t *panel)
     sh1107_panel_t *sh1107 = __containerof(panel, sh1107_panel_t, base);
     esp_lcd_panel_io_handle_t io = sh1107->io;
 
+    sh1107->gddram_valid = 0;
+
     // vendor specific initialization, it can be different between manufacturers
     // should consult the LCD supplier for initialization sequence code
     int cmd = 0;
@@ -192,7 +210,7 @@ static esp_err_t panel_sh1107_draw_bitmap(esp_lcd_panel_t *panel, int x_start, i
     uint8_t column_low = 0;
     uint8_t column_high = 0;
     uint8_t row_start = 0, row_end = 0;
-    const uint16_t *ptr;
+    const uint8_t *ptr;
     uint32_t size = 0;
 
     // adding extra gap
@@ -218,6 +236,45 @@ static esp_err_t panel_sh1107_draw_bitmap(esp_lcd_panel_t *panel, int x_start, i
 
     size = (x_end - x_start);
 
+    if (x_end <= LCD_SH1107_MAX_COLUMNS && row_end <= LCD_SH1107_MAX_PAGES) {
+        /* Column, page and data of one page in one I2C transaction. The first control byte is the "command" of tx_color. */
+        uint8_t *buf = sh1107->page_buf;
+        for (int i = row_start; i < row_end; i++) {
+            uint8_t *shadow = &sh1107->gddram[i][x_start];
+            int first = 0;
+            int last = size - 1;
+            ptr = (const uint8_t *)color_data + (i - row_start) * size;
+
+            /* Send only the span of changed columns, when the shadow of the page is valid */
+            if (sh1107->gddram_valid & (1U << i)) {
+                while (first <= last && ptr[first] == shadow[first]) {
+                    first++;
+                }
+                if (first > last) {
+                    continue;
+                }
+                while (ptr[last] == shadow[last]) {
+                    last--;
+                }
+            } else if (x_start == 0 && x_end == LCD_SH1107_MAX_COLUMNS) {
+                sh1107->gddram_valid |= (1U << i);
+            }
+            memcpy(&shadow[first], &ptr[first], last - first + 1);
+
+            const int column = x_start + first;
+            buf[0] = 0x10 | ((column >> 4) & 0x0F);
+            buf[1] = LCD_SH1107_I2C_CMD_CONT;
+            buf[2] = 0x00 | (column & 0x0F);
+            buf[3] = LCD_SH1107_I2C_CMD_CONT;
+            buf[4] = 0xB0 | i;
+            buf[5] = LCD_SH1107_I2C_RAM;
+            memcpy(&buf[LCD_SH1107_PAGE_SETUP_LEN], &ptr[first], last - first + 1);
+            ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_color(io, LCD_SH1107_I2C_CMD_CONT, buf, LCD_SH1107_PAGE_SETUP_LEN + last - first + 1),
+                                TAG, "send page failed");
+        }
+        return ESP_OK;
+    }
+
     for (int i = row_start; i < row_end; i++) {
         /* Start column */
         esp_lcd_panel_io_tx_param(io, LCD_SH1107_I2C_CMD, (uint8_t[]) {
@@ -231,7 +288,7 @@ static esp_err_t panel_sh1107_draw_bitmap(esp_lcd_panel_t *panel, int x_start, i
             0xB0 | i
         }, 1);
 
-        ptr = color_data + i * x_end;
+        ptr = (const uint8_t *)color_data + (i - row_start) * size;
         esp_lcd_panel_io_tx_color(io, LCD_SH1107_I2C_RAM, (uint8_t *)ptr, size);
     }
 
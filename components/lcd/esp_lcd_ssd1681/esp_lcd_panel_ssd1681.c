@@ -6,6 +6,7 @@
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "sdkconfig.h"
 #if CONFIG_LCD_ENABLE_DEBUG_LOG
 // The local log level must be defined before including esp_log.h
@@ -26,6 +27,10 @@
 #define SSD1681_LUT_SIZE                   159
 #define SSD1681_EPD_1IN54_V2_WIDTH         200
 #define SSD1681_EPD_1IN54_V2_HEIGHT        200
+#define SSD1681_VRAM_ROW_LEN               (SSD1681_EPD_1IN54_V2_WIDTH / 8)
+#define SSD1681_VRAM_SIZE                  (SSD1681_VRAM_ROW_LEN * SSD1681_EPD_1IN54_V2_HEIGHT)
+#define SSD1681_REFRESH_TASK_STACK         3072
+#define SSD1681_REFRESH_TASK_PRIORITY      4
 
 
 static const char *TAG = "lcd_panel.epaper";
@@ -35,6 +40,17 @@ typedef struct {
     void *args;
 } epaper_panel_callback_t;
 
+// Window of VRAM, x in bytes and y in rows, both inclusive
+typedef struct {
+    int x0;
+    int x1;
+    int y0;
+    int y1;
+} epaper_window_t;
+
+#define EPAPER_WINDOW_EMPTY     ((epaper_window_t) {.x0 = SSD1681_VRAM_ROW_LEN, .x1 = -1, .y0 = SSD1681_EPD_1IN54_V2_HEIGHT, .y1 = -1})
+#define EPAPER_WINDOW_IS_EMPTY(win)  ((win).x0 > (win).x1)
+
 typedef struct {
     esp_lcd_panel_t base;
     esp_lcd_panel_io_handle_t io;
@@ -45,6 +61,8 @@ typedef struct {
     // Configurations from epaper_ssd1681_conf
     int busy_gpio_num;
     bool full_refresh;
+    bool partial_refresh;
+    uint32_t full_refresh_interval;
     // Configurations from interface functions
     int gap_x;
     int gap_y;
@@ -61,19 +79,41 @@ typedef struct {
     bool _mirror_x;
     uint8_t *_framebuffer;
     bool _invert_color;
+    // --- Partial refresh, RED VRAM keeps the frame shown by the last refresh
+    uint32_t _partial_cnt;
+    uint8_t *_vram;                     // Copy of BLACK VRAM content, SSD1681_VRAM_ROW_LEN bytes per row
+    uint8_t *_window_buf;               // DMA capable buffer for transfer of one VRAM window
+    epaper_window_t _red_vram_pending;  // Window of RED VRAM to be updated after the refresh
+    bool _red_vram_stale;
+    // --- Queued frames, drawn by the refresh task when BUSY clears
+    TaskHandle_t _refresh_task;
+    SemaphoreHandle_t _refresh_task_done;
+    SemaphoreHandle_t _queue_lock;      // Protects the newest queued frame
+    uint8_t *_queue_buf;                // Newest queued frame
+    uint8_t *_queue_draw_buf;           // Frame being drawn by the refresh task
+    int _queue_area[4];                 // x_start, y_start, x_end, y_end of the newest queued frame
+    bool _queue_pending;
+    volatile bool _queue_running;
 } epaper_panel_t;
 
 // --- Utility functions
 static inline uint8_t byte_reverse(uint8_t data);
 static esp_err_t process_bitmap(esp_lcd_panel_t *panel, int len_x, int len_y, int buffer_size, const void *color_data);
+static inline void epaper_window_add(epaper_window_t *win, const epaper_window_t *add);
 static esp_err_t panel_epaper_wait_busy(esp_lcd_panel_t *panel);
 // --- Callback functions & ISRs
 static void epaper_driver_gpio_isr_handler(void *arg);
+static void epaper_refresh_task(void *arg);
+static esp_err_t epaper_queue_init(epaper_panel_t *epaper_panel);
+static void epaper_queue_deinit(epaper_panel_t *epaper_panel);
 // --- IO wrapper functions, simply send command/param/buffer
 static esp_err_t epaper_set_lut(esp_lcd_panel_io_handle_t io, const uint8_t *lut);
 static esp_err_t epaper_set_cursor(esp_lcd_panel_io_handle_t io, uint32_t cur_x, uint32_t cur_y);
 static esp_err_t epaper_set_area(esp_lcd_panel_io_handle_t io, uint32_t start_x, uint32_t start_y, uint32_t end_x, uint32_t end_y);
 static esp_err_t panel_epaper_set_vram(esp_lcd_panel_io_handle_t io, uint8_t *bw_bitmap, uint8_t *red_bitmap, size_t size);
+static esp_err_t panel_epaper_set_vram_window(epaper_panel_t *epaper_panel, const epaper_window_t *win, bool bw, bool red);
+// --- Partial refresh
+static esp_err_t epaper_panel_draw_partial(epaper_panel_t *epaper_panel, int x_start, int y_start, int len_x, int len_y, bool y_decrement);
 // --- SSD1681 specific functions, exported to user in public header file
 // extern esp_err_t esp_lcd_new_panel_ssd1681(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *panel_dev_config,
 //                                            esp_lcd_panel_handle_t *ret_panel);
@@ -81,6 +121,7 @@ static esp_err_t panel_epaper_set_vram(esp_lcd_panel_io_handle_t io, uint8_t *bw
 // extern esp_err_t epaper_panel_refresh_screen(esp_lcd_panel_t *panel);
 // extern esp_err_t epaper_panel_set_bitmap_color(esp_lcd_panel_t* panel, esp_lcd_ssd1681_bitmap_color_t color);
 // extern esp_err_t epaper_panel_set_custom_lut(esp_lcd_panel_t *panel, uint8_t *lut, size_t size);
+// extern esp_err_t epaper_panel_queue_frame(esp_lcd_panel_t *panel, int x_start, int y_start, int x_end, int y_end, const void *color_data);
 // --- Used to implement esp_lcd_panel_interface
 static esp_err_t epaper_panel_del(esp_lcd_panel_t *panel);
 static esp_err_t epaper_panel_reset(esp_lcd_panel_t *panel);
@@ -96,13 +137,131 @@ static esp_err_t epaper_panel_disp_on_off(esp_lcd_panel_t *panel, bool on_off);
 static void epaper_driver_gpio_isr_handler(void *arg)
 {
     epaper_panel_t *epaper_panel = arg;
+    BaseType_t need_yield = pdFALSE;
     // --- Disable ISR handling
     gpio_intr_disable(epaper_panel->busy_gpio_num);
 
     // --- Call user callback func
     if (epaper_panel->epaper_refresh_done_isr_callback.callback_ptr) {
-        (epaper_panel->epaper_refresh_done_isr_callback.callback_ptr)(&(epaper_panel->base), NULL, epaper_panel->epaper_refresh_done_isr_callback.args);
+        if ((epaper_panel->epaper_refresh_done_isr_callback.callback_ptr)(&(epaper_panel->base), NULL, epaper_panel->epaper_refresh_done_isr_callback.args)) {
+            need_yield = pdTRUE;
+        }
+    }
+    // --- Wake up refresh task, the newest queued frame can be sent now
+    if (epaper_panel->_refresh_task) {
+        vTaskNotifyGiveFromISR(epaper_panel->_refresh_task, &need_yield);
+    }
+    if (need_yield == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static void epaper_refresh_task(void *arg)
+{
+    epaper_panel_t *epaper_panel = arg;
+    int area[4];
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!(epaper_panel->_queue_running)) {
+            break;
+        }
+        // Refresh in progress, BUSY ISR wakes up the task again when it finishes
+        if (gpio_get_level(epaper_panel->busy_gpio_num)) {
+            continue;
+        }
+        // --- Take the newest queued frame, older ones were overwritten
+        xSemaphoreTake(epaper_panel->_queue_lock, portMAX_DELAY);
+        bool pending = epaper_panel->_queue_pending;
+        if (pending) {
+            uint8_t *buf = epaper_panel->_queue_draw_buf;
+            epaper_panel->_queue_draw_buf = epaper_panel->_queue_buf;
+            epaper_panel->_queue_buf = buf;
+            memcpy(area, epaper_panel->_queue_area, sizeof(area));
+            epaper_panel->_queue_pending = false;
+        }
+        xSemaphoreGive(epaper_panel->_queue_lock);
+        if (!pending) {
+            continue;
+        }
+        // --- Send and refresh
+        if (epaper_panel_draw_bitmap(&(epaper_panel->base), area[0], area[1], area[2], area[3], epaper_panel->_queue_draw_buf) != ESP_OK ||
+                epaper_panel_refresh_screen(&(epaper_panel->base)) != ESP_OK) {
+            ESP_LOGE(TAG, "queued frame drawing error");
+        }
+    }
+
+    xSemaphoreGive(epaper_panel->_refresh_task_done);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t epaper_queue_init(epaper_panel_t *epaper_panel)
+{
+    esp_err_t ret = ESP_OK;
+    // Both buffers are passed to draw_bitmap, DMA capable memory avoids copy in non-copy mode
+    epaper_panel->_queue_buf = heap_caps_malloc(SSD1681_VRAM_SIZE, MALLOC_CAP_DMA);
+    epaper_panel->_queue_draw_buf = heap_caps_malloc(SSD1681_VRAM_SIZE, MALLOC_CAP_DMA);
+    ESP_GOTO_ON_FALSE(epaper_panel->_queue_buf && epaper_panel->_queue_draw_buf, ESP_ERR_NO_MEM, err, TAG, "no mem for frame queue");
+    epaper_panel->_queue_lock = xSemaphoreCreateMutex();
+    ESP_GOTO_ON_FALSE(epaper_panel->_queue_lock, ESP_ERR_NO_MEM, err, TAG, "no mem for frame queue lock");
+    epaper_panel->_refresh_task_done = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(epaper_panel->_refresh_task_done, ESP_ERR_NO_MEM, err, TAG, "no mem for refresh task semaphore");
+    epaper_panel->_queue_running = true;
+    ESP_GOTO_ON_FALSE(xTaskCreate(epaper_refresh_task, "epaper_refresh", SSD1681_REFRESH_TASK_STACK, epaper_panel,
+                                  SSD1681_REFRESH_TASK_PRIORITY, &(epaper_panel->_refresh_task)) == pdPASS,
+                      ESP_ERR_NO_MEM, err, TAG, "create refresh task err");
+    return ESP_OK;
+err:
+    epaper_queue_deinit(epaper_panel);
+    return ret;
+}
+
+static void epaper_queue_deinit(epaper_panel_t *epaper_panel)
+{
+    if (epaper_panel->_refresh_task) {
+        epaper_panel->_queue_running = false;
+        xTaskNotifyGive(epaper_panel->_refresh_task);
+        xSemaphoreTake(epaper_panel->_refresh_task_done, portMAX_DELAY);
+        epaper_panel->_refresh_task = NULL;
+    }
+    if (epaper_panel->_refresh_task_done) {
+        vSemaphoreDelete(epaper_panel->_refresh_task_done);
+        epaper_panel->_refresh_task_done = NULL;
+    }
+    if (epaper_panel->_queue_lock) {
+        vSemaphoreDelete(epaper_panel->_queue_lock);
+        epaper_panel->_queue_lock = NULL;
+    }
+    free(epaper_panel->_queue_buf);
+    free(epaper_panel->_queue_draw_buf);
+    epaper_panel->_queue_buf = NULL;
+    epaper_panel->_queue_draw_buf = NULL;
+}
+
+esp_err_t epaper_panel_queue_frame(esp_lcd_panel_t *panel, int x_start, int y_start, int x_end, int y_end, const void *color_data)
+{
+    ESP_RETURN_ON_FALSE(panel, ESP_ERR_INVALID_ARG, TAG, "panel handler is NULL");
+    ESP_RETURN_ON_FALSE(color_data, ESP_ERR_INVALID_ARG, TAG, "bitmap is null");
+    ESP_RETURN_ON_FALSE((x_start < x_end) && (y_start < y_end), ESP_ERR_INVALID_ARG, TAG, "start position must be smaller than end position");
+    size_t size = (x_end - x_start) * (y_end - y_start) / 8;
+    ESP_RETURN_ON_FALSE(size <= SSD1681_VRAM_SIZE, ESP_ERR_INVALID_ARG, TAG, "bitmap is larger than panel");
+    epaper_panel_t *epaper_panel = __containerof(panel, epaper_panel_t, base);
+    // --- Refresh task is created with the first queued frame
+    if (!(epaper_panel->_refresh_task)) {
+        ESP_RETURN_ON_ERROR(epaper_queue_init(epaper_panel), TAG, "epaper_queue_init() error");
     }
+    // --- Replace the pending frame, only the newest one is drawn
+    xSemaphoreTake(epaper_panel->_queue_lock, portMAX_DELAY);
+    memcpy(epaper_panel->_queue_buf, color_data, size);
+    epaper_panel->_queue_area[0] = x_start;
+    epaper_panel->_queue_area[1] = y_start;
+    epaper_panel->_queue_area[2] = x_end;
+    epaper_panel->_queue_area[3] = y_end;
+    epaper_panel->_queue_pending = true;
+    xSemaphoreGive(epaper_panel->_queue_lock);
+    // Task checks BUSY itself, it waits for the BUSY ISR if a refresh is in progress
+    xTaskNotifyGive(epaper_panel->_refresh_task);
+    return ESP_OK;
 }
 
 esp_err_t epaper_panel_register_event_callbacks(esp_lcd_panel_t *panel, epaper_panel_callbacks_t *cbs, void *user_ctx)
@@ -209,13 +368,39 @@ esp_err_t panel_epaper_set_vram(esp_lcd_panel_io_handle_t io, uint8_t *bw_bitmap
     return ESP_OK;
 }
 
+static esp_err_t panel_epaper_set_vram_window(epaper_panel_t *epaper_panel, const epaper_window_t *win, bool bw, bool red)
+{
+    // --- Collect the window rows from the VRAM copy
+    int row_len = win->x1 - win->x0 + 1;
+    int rows = win->y1 - win->y0 + 1;
+    for (int i = 0; i < rows; i++) {
+        memcpy(epaper_panel->_window_buf + i * row_len,
+               epaper_panel->_vram + (win->y0 + i) * SSD1681_VRAM_ROW_LEN + win->x0, row_len);
+    }
+    // --- Window is always written with X and Y increment, the copy is in VRAM coordinates
+    ESP_RETURN_ON_ERROR(epaper_set_area(epaper_panel->io, win->x0 * 8, win->y0, win->x1 * 8, win->y1), TAG,
+                        "epaper_set_area() error");
+    ESP_RETURN_ON_ERROR(epaper_set_cursor(epaper_panel->io, win->x0 * 8, win->y0), TAG,
+                        "epaper_set_cursor() error");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(epaper_panel->io, SSD1681_CMD_DATA_ENTRY_MODE, (uint8_t[]) {
+        SSD1681_PARAM_DATA_ENTRY_MODE_3
+    }, 1), TAG, "SSD1681_CMD_DATA_ENTRY_MODE err");
+    return panel_epaper_set_vram(epaper_panel->io, bw ? epaper_panel->_window_buf : NULL,
+                                 red ? epaper_panel->_window_buf : NULL, row_len * rows);
+}
+
 esp_err_t epaper_panel_refresh_screen(esp_lcd_panel_t *panel)
 {
     ESP_RETURN_ON_FALSE(panel, ESP_ERR_INVALID_ARG, TAG, "panel handler is NULL");
     epaper_panel_t *epaper_panel = __containerof(panel, epaper_panel_t, base);
     // --- Set color invert
     uint8_t duc_flag = 0x00;
-    if (!(epaper_panel->_invert_color)) {
+    if (epaper_panel->partial_refresh) {
+        // RED VRAM holds the previous frame, both VRAMs must have the same polarity
+        if (!(epaper_panel->_invert_color)) {
+            duc_flag |= (SSD1681_PARAM_COLOR_BW_INVERSE_BIT | SSD1681_PARAM_COLOR_RW_INVERSE_BIT);
+        }
+    } else if (!(epaper_panel->_invert_color)) {
         duc_flag |= SSD1681_PARAM_COLOR_BW_INVERSE_BIT;
         duc_flag &= (~SSD1681_PARAM_COLOR_RW_INVERSE_BIT);
     } else {
@@ -228,13 +413,32 @@ esp_err_t epaper_panel_refresh_screen(esp_lcd_panel_t *panel)
     // --- Enable refresh done handler isr
     gpio_intr_enable(epaper_panel->busy_gpio_num);
     // --- Send refresh command
+    uint8_t update_mode = SSD1681_PARAM_DISP_WITH_MODE_2;
+    if (epaper_panel->partial_refresh) {
+        update_mode = epaper_panel->full_refresh ? SSD1681_PARAM_DISP_FULL : SSD1681_PARAM_DISP_PARTIAL;
+    }
     ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(epaper_panel->io, SSD1681_CMD_SET_DISP_UPDATE_CTRL, (uint8_t[]) {
-        SSD1681_PARAM_DISP_WITH_MODE_2
+        update_mode
     }, 1), TAG, "SSD1681_CMD_SET_DISP_UPDATE_CTRL err");
 
     ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(epaper_panel->io, SSD1681_CMD_ACTIVE_DISP_UPDATE_SEQ, NULL, 0), TAG,
                         "SSD1681_CMD_ACTIVE_DISP_UPDATE_SEQ err");
 
+    if (epaper_panel->partial_refresh) {
+        // --- Schedule the next full refresh, it removes the ghosting of partial refreshes
+        if (epaper_panel->full_refresh) {
+            epaper_panel->full_refresh = false;
+            epaper_panel->_partial_cnt = 0;
+        } else {
+            epaper_panel->_partial_cnt++;
+        }
+        if (epaper_panel->full_refresh_interval && epaper_panel->_partial_cnt >= epaper_panel->full_refresh_interval) {
+            epaper_panel->full_refresh = true;
+        }
+        // RED VRAM can be updated only after this refresh, it is done in the next draw_bitmap
+        epaper_panel->_red_vram_stale = !EPAPER_WINDOW_IS_EMPTY(epaper_panel->_red_vram_pending);
+    }
+
     return ESP_OK;
 }
 
@@ -264,12 +468,21 @@ esp_lcd_new_panel_ssd1681(const esp_lcd_panel_io_handle_t io, const esp_lcd_pane
     epaper_panel->gap_y = 0;
     epaper_panel->bitmap_color = SSD1681_EPAPER_BITMAP_BLACK;
     epaper_panel->full_refresh = true;
+    epaper_panel->_partial_cnt = 0;
+    epaper_panel->_vram = NULL;
+    epaper_panel->_window_buf = NULL;
+    epaper_panel->_red_vram_pending = EPAPER_WINDOW_EMPTY;
+    epaper_panel->_red_vram_stale = false;
+    epaper_panel->_refresh_task = NULL;
+    epaper_panel->_queue_pending = false;
     // configurations
     epaper_panel->io = io;
     epaper_panel->reset_gpio_num = panel_dev_config->reset_gpio_num;
     epaper_panel->busy_gpio_num = epaper_ssd1681_conf->busy_gpio_num;
     epaper_panel->reset_level = panel_dev_config->flags.reset_active_high;
     epaper_panel->_non_copy_mode = epaper_ssd1681_conf->non_copy_mode;
+    epaper_panel->partial_refresh = epaper_ssd1681_conf->partial_refresh;
+    epaper_panel->full_refresh_interval = epaper_ssd1681_conf->full_refresh_interval;
     // functions
     epaper_panel->base.del = epaper_panel_del;
     epaper_panel->base.reset = epaper_panel_reset;
@@ -280,13 +493,20 @@ esp_lcd_new_panel_ssd1681(const esp_lcd_panel_io_handle_t io, const esp_lcd_pane
     epaper_panel->base.mirror = epaper_panel_mirror;
     epaper_panel->base.swap_xy = epaper_panel_swap_xy;
     epaper_panel->base.disp_on_off = epaper_panel_disp_on_off;
-    *ret_panel = &(epaper_panel->base);
     // --- Init framebuffer
     if (!(epaper_panel->_non_copy_mode)) {
         epaper_panel->_framebuffer = heap_caps_malloc(SSD1681_EPD_1IN54_V2_WIDTH * SSD1681_EPD_1IN54_V2_HEIGHT / 8,
                                      MALLOC_CAP_DMA);
-        ESP_RETURN_ON_FALSE(epaper_panel->_framebuffer, ESP_ERR_NO_MEM, TAG, "epaper_panel_draw_bitmap allocating buffer memory err");
+        ESP_GOTO_ON_FALSE(epaper_panel->_framebuffer, ESP_ERR_NO_MEM, err, TAG, "epaper_panel_draw_bitmap allocating buffer memory err");
     }
+    // --- Init buffers for partial refresh
+    if (epaper_panel->partial_refresh) {
+        epaper_panel->_vram = heap_caps_calloc(1, SSD1681_VRAM_SIZE, MALLOC_CAP_DEFAULT);
+        ESP_GOTO_ON_FALSE(epaper_panel->_vram, ESP_ERR_NO_MEM, err, TAG, "no mem for vram copy");
+        epaper_panel->_window_buf = heap_caps_malloc(SSD1681_VRAM_SIZE, MALLOC_CAP_DMA);
+        ESP_GOTO_ON_FALSE(epaper_panel->_window_buf, ESP_ERR_NO_MEM, err, TAG, "no mem for vram window buffer");
+    }
+    *ret_panel = &(epaper_panel->base);
     // --- Init GPIO
     // init RST GPIO
     if (epaper_panel->reset_gpio_num >= 0) {
@@ -321,6 +541,11 @@ err:
         if (epaper_ssd1681_conf->busy_gpio_num >= 0) {
             gpio_reset_pin(epaper_ssd1681_conf->busy_gpio_num);
         }
+        if (!(epaper_panel->_non_copy_mode)) {
+            free(epaper_panel->_framebuffer);
+        }
+        free(epaper_panel->_vram);
+        free(epaper_panel->_window_buf);
         free(epaper_panel);
     }
     return ret;
@@ -333,12 +558,19 @@ static esp_err_t epaper_panel_del(esp_lcd_panel_t *panel)
     if ((epaper_panel->reset_gpio_num) >= 0) {
         gpio_reset_pin(epaper_panel->reset_gpio_num);
     }
+    // --- Stop refresh task before the BUSY ISR is removed
+    epaper_queue_deinit(epaper_panel);
+    if (epaper_panel->busy_gpio_num >= 0) {
+        gpio_isr_handler_remove(epaper_panel->busy_gpio_num);
+    }
     gpio_reset_pin(epaper_panel->busy_gpio_num);
     // --- Free allocated RAM
     if ((epaper_panel->_framebuffer) && (!(epaper_panel->_non_copy_mode))) {
         // Should not free if buffer is not allocated by driver
         free(epaper_panel->_framebuffer);
     }
+    free(epaper_panel->_vram);
+    free(epaper_panel->_window_buf);
     ESP_LOGD(TAG, "del ssd1681 epaper panel @%p", epaper_panel);
     free(epaper_panel);
     return ESP_OK;
@@ -406,6 +638,11 @@ static esp_err_t epaper_panel_init(esp_lcd_panel_t *panel)
     ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, SSD1681_CMD_ACTIVE_DISP_UPDATE_SEQ, NULL, 0), TAG,
                         "param SSD1681_CMD_SET_DISP_UPDATE_CTRL err");
     panel_epaper_wait_busy(panel);
+    // --- VRAM content is unknown, the first refresh must be a full one
+    epaper_panel->full_refresh = true;
+    epaper_panel->_partial_cnt = 0;
+    epaper_panel->_red_vram_pending = EPAPER_WINDOW_EMPTY;
+    epaper_panel->_red_vram_stale = false;
 
     return ESP_OK;
 }
@@ -445,6 +682,17 @@ epaper_panel_draw_bitmap(esp_lcd_panel_t *panel, int x_start, int y_start, int x
         // Copy & convert image according to configuration
         process_bitmap(panel, len_x, len_y, buffer_size, color_data);
     }
+    // --- Partial refresh mode, only the changed window is sent
+    if (epaper_panel->partial_refresh) {
+        ESP_RETURN_ON_FALSE(epaper_panel->bitmap_color == SSD1681_EPAPER_BITMAP_BLACK, ESP_ERR_INVALID_STATE, TAG,
+                            "red bitmap is unavailable in partial refresh mode");
+        ESP_RETURN_ON_FALSE((x_start >= 0) && (y_start >= 0) && (x_end < SSD1681_EPD_1IN54_V2_WIDTH) && (y_end < SSD1681_EPD_1IN54_V2_HEIGHT),
+                            ESP_ERR_INVALID_ARG, TAG, "area out of panel");
+        ESP_RETURN_ON_FALSE(!(x_start % 8) && !(len_x % 8), ESP_ERR_INVALID_ARG, TAG, "x_start and width must be multiple of 8");
+        // Rows are drawn with Y decrement if only one axis is mirrored
+        return epaper_panel_draw_partial(epaper_panel, x_start, y_start, len_x, len_y,
+                                         epaper_panel->_mirror_x != epaper_panel->_mirror_y);
+    }
     // --- Set cursor & data entry sequence
     if ((!(epaper_panel->_mirror_x)) && (!(epaper_panel->_mirror_y))) {
         // --- Cursor Settings
@@ -506,6 +754,47 @@ epaper_panel_draw_bitmap(esp_lcd_panel_t *panel, int x_start, int y_start, int x
     return ESP_OK;
 }
 
+static esp_err_t epaper_panel_draw_partial(epaper_panel_t *epaper_panel, int x_start, int y_start, int len_x, int len_y, bool y_decrement)
+{
+    int row_len = len_x / 8;
+    epaper_window_t changed = EPAPER_WINDOW_EMPTY;
+    // --- RED VRAM must keep the frame shown by the last refresh, it is the reference of the next partial refresh
+    if (epaper_panel->_red_vram_stale) {
+        ESP_RETURN_ON_ERROR(panel_epaper_set_vram_window(epaper_panel, &(epaper_panel->_red_vram_pending), false, true), TAG,
+                            "panel_epaper_set_vram_window error");
+        epaper_panel->_red_vram_pending = EPAPER_WINDOW_EMPTY;
+        epaper_panel->_red_vram_stale = false;
+    }
+    // --- Compare the bitmap with VRAM content at byte granularity
+    for (int row = 0; row < len_y; row++) {
+        int y = y_decrement ? (y_start + len_y - 1 - row) : (y_start + row);
+        const uint8_t *src = epaper_panel->_framebuffer + row * row_len;
+        uint8_t *dst = epaper_panel->_vram + y * SSD1681_VRAM_ROW_LEN + x_start / 8;
+        for (int col = 0; col < row_len; col++) {
+            if (epaper_panel->full_refresh || (src[col] != dst[col])) {
+                dst[col] = src[col];
+                epaper_window_add(&changed, &(epaper_window_t) {
+                    .x0 = x_start / 8 + col, .x1 = x_start / 8 + col, .y0 = y, .y1 = y
+                });
+            }
+        }
+    }
+    if (EPAPER_WINDOW_IS_EMPTY(changed)) {
+        return ESP_OK;
+    }
+    // --- Send the changed window
+    if (epaper_panel->full_refresh) {
+        // Full waveform does not use the previous frame, both VRAMs get the new one
+        ESP_RETURN_ON_ERROR(panel_epaper_set_vram_window(epaper_panel, &changed, true, true), TAG,
+                            "panel_epaper_set_vram_window error");
+    } else {
+        ESP_RETURN_ON_ERROR(panel_epaper_set_vram_window(epaper_panel, &changed, true, false), TAG,
+                            "panel_epaper_set_vram_window error");
+        epaper_window_add(&(epaper_panel->_red_vram_pending), &changed);
+    }
+    return ESP_OK;
+}
+
 static esp_err_t epaper_panel_invert_color(esp_lcd_panel_t *panel, bool invert_color_data)
 {
     epaper_panel_t *epaper_panel = __containerof(panel, epaper_panel_t, base);
@@ -641,6 +930,14 @@ static esp_err_t process_bitmap(esp_lcd_panel_t *panel, int len_x, int len_y, in
     return ESP_OK;
 }
 
+static inline void epaper_window_add(epaper_window_t *win, const epaper_window_t *add)
+{
+    win->x0 = (add->x0 < win->x0) ? add->x0 : win->x0;
+    win->x1 = (add->x1 > win->x1) ? add->x1 : win->x1;
+    win->y0 = (add->y0 < win->y0) ? add->y0 : win->y0;
+    win->y1 = (add->y1 > win->y1) ? add->y1 : win->y1;
+}
+
 static inline uint8_t byte_reverse(uint8_t data)
 {
     static uint8_t _4bit_reverse_lut[] =  {
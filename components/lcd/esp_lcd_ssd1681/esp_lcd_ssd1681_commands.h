@@ -65,6 +65,18 @@
 // Disable Analog
 // Disable OSC
 #define SSD1681_PARAM_DISP_UPDATE_MODE_2      0xcf
+// Load temperature value
+// Load LUT with DISPLAY mode 1
+// Display with DISPLAY Mode 1 (full waveform)
+// Disable Analog
+// Disable OSC
+#define SSD1681_PARAM_DISP_FULL               0xf7
+// Load temperature value
+// Load LUT with DISPLAY mode 2
+// Display with DISPLAY Mode 2 (partial waveform, changed pixels only)
+// Disable Analog
+// Disable OSC
+#define SSD1681_PARAM_DISP_PARTIAL            0xff
 // --- Active display update sequence
 #define SSD1681_CMD_ACTIVE_DISP_UPDATE_SEQ  0x20
 // ---
@@ -40,6 +40,10 @@ typedef struct {
     int busy_gpio_num;         /*!< GPIO num of the BUSY pin */
     bool non_copy_mode;        /*!< If the bitmap would be copied or not.
                                 *   Image rotation and mirror is limited when enabling. */
+    bool partial_refresh;      /*!< Refresh only the changed pixels with the fast partial update waveform.
+                                *   RED VRAM keeps the previous frame, red bitmap is unavailable when enabling. */
+    uint32_t full_refresh_interval; /*!< Count of partial refreshes before a forced full refresh, 0 for no forced full refresh.
+                                     *   Only used with `partial_refresh`. */
 } esp_lcd_ssd1681_config_t;
 
 /**
@@ -129,6 +133,29 @@ esp_err_t epaper_panel_register_event_callbacks(esp_lcd_panel_t *panel, epaper_p
  */
 esp_err_t epaper_panel_set_custom_lut(esp_lcd_panel_t *panel, uint8_t *lut, size_t size);
 
+/**
+ * @brief Queue a bitmap to be drawn and refreshed without waiting
+ *
+ * @note The bitmap is copied, the buffer can be reused right after this function returns.
+ * @note The bitmap is sent at once if the panel is idle, otherwise when the BUSY pin goes LOW after the current refresh.
+ *       Frames queued during a refresh are coalesced, only the newest one is sent.
+ * @note `on_epaper_refresh_done` is called after each refresh, as with `epaper_panel_refresh_screen()`.
+ * @note A refresh task and two frame buffers are allocated with the first queued frame.
+ * @attention
+ *       Do not call `esp_lcd_panel_draw_bitmap()` or `epaper_panel_refresh_screen()` while queued frames are being sent.
+ *
+ * @param[in] panel LCD panel handle
+ * @param[in] x_start Start index on x-axis (x_start included)
+ * @param[in] y_start Start index on y-axis (y_start included)
+ * @param[in] x_end End index on x-axis (x_end not included)
+ * @param[in] y_end End index on y-axis (y_end not included)
+ * @param[in] color_data bitmap to be drawn
+ * @return  ESP_OK                on success
+ *          ESP_ERR_INVALID_ARG   if parameter is invalid
+ *          ESP_ERR_NO_MEM        if out of memory
+ */
+esp_err_t epaper_panel_queue_frame(esp_lcd_panel_t *panel, int x_start, int y_start, int x_end, int y_end, const void *color_data);
+
 
 #ifdef __cplusplus
 }
@@ -16,12 +16,19 @@
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "esp_check.h"
+#include "nvs.h"
 
 #include "esp_lcd_st7796.h"
 #include "esp_lcd_st7796_interface.h"
 
 static const char *TAG = "st7796_general";
 
+/* Lines of the panel memory (rows in the native portrait orientation) */
+#define ST7796_LINES    (480)
+
+/* NVS namespace of the saved gamma */
+#define ST7796_GAMMA_NVS_NAMESPACE      "st7796"
+
 static esp_err_t panel_st7796_del(esp_lcd_panel_t *panel);
 static esp_err_t panel_st7796_reset(esp_lcd_panel_t *panel);
 static esp_err_t panel_st7796_init(esp_lcd_panel_t *panel);
@@ -44,6 +51,11 @@ typedef struct {
     uint8_t colmod_val; // save current value of LCD_CMD_COLMOD register
     const st7796_lcd_init_cmd_t *init_cmds;
     uint16_t init_cmds_size;
+    bool te_enable;
+    uint16_t scroll_first;  // first panel line of the vertical scrolling area
+    uint16_t scroll_height; // lines of the vertical scrolling area (0: not defined)
+    st7796_gamma_t gamma;   // gamma set at runtime, it overrides the gamma of the init commands
+    bool gamma_set;
 } st7796_panel_t;
 
 esp_err_t esp_lcd_new_panel_st7796_general(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *panel_dev_config, esp_lcd_panel_handle_t *ret_panel)
@@ -113,6 +125,7 @@ esp_err_t esp_lcd_new_panel_st7796_general(const esp_lcd_panel_io_handle_t io, c
     if (panel_dev_config->vendor_config) {
         st7796->init_cmds = ((st7796_vendor_config_t *)panel_dev_config->vendor_config)->init_cmds;
         st7796->init_cmds_size = ((st7796_vendor_config_t *)panel_dev_config->vendor_config)->init_cmds_size;
+        st7796->te_enable = ((st7796_vendor_config_t *)panel_dev_config->vendor_config)->flags.te_enable;
     }
     st7796->base.del = panel_st7796_del;
     st7796->base.reset = panel_st7796_reset;
@@ -145,6 +158,198 @@ err:
     return ret;
 }
 
+// first panel line of the rows in coordinates of draw_bitmap (moved by y_gap, reversed by mirrored Y)
+static esp_err_t panel_st7796_rows_to_lines(st7796_panel_t *st7796, uint16_t top, uint16_t height, int *first)
+{
+    // with swapped axes, the lines of the panel are columns of the picture
+    ESP_RETURN_ON_FALSE(!(st7796->madctl_val & LCD_CMD_MV_BIT), ESP_ERR_NOT_SUPPORTED, TAG, "not supported with swapped axes");
+    int line = top + st7796->y_gap;
+    ESP_RETURN_ON_FALSE(height > 0 && line + height <= ST7796_LINES, ESP_ERR_INVALID_ARG, TAG, "invalid rows");
+    if (st7796->madctl_val & LCD_CMD_MY_BIT) {
+        // row address order is reversed, the areas are defined in lines of the panel
+        line = ST7796_LINES - line - height;
+    }
+    *first = line;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_st7796_set_idle_mode(esp_lcd_panel_handle_t panel, bool idle)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_st7796_del, ESP_ERR_INVALID_ARG, TAG, "invalid panel");
+    st7796_panel_t *st7796 = __containerof(panel, st7796_panel_t, base);
+
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(st7796->io, idle ? LCD_CMD_IDMON : LCD_CMD_IDMOFF, NULL, 0), TAG, "send command failed");
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_st7796_set_partial_mode(esp_lcd_panel_handle_t panel, bool partial, uint16_t top, uint16_t height)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_st7796_del, ESP_ERR_INVALID_ARG, TAG, "invalid panel");
+    st7796_panel_t *st7796 = __containerof(panel, st7796_panel_t, base);
+    esp_lcd_panel_io_handle_t io = st7796->io;
+
+    if (!partial) {
+        ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_NORON, NULL, 0), TAG, "send command failed");
+        return ESP_OK;
+    }
+
+    int first = 0;
+    ESP_RETURN_ON_ERROR(panel_st7796_rows_to_lines(st7796, top, height, &first), TAG, "invalid partial area");
+    const int last = first + height - 1;
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_PTLAR, (uint8_t[]) {
+        (first >> 8) & 0xFF,
+        first & 0xFF,
+        (last >> 8) & 0xFF,
+        last & 0xFF,
+    }, 4), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_PTLON, NULL, 0), TAG, "send command failed");
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_st7796_set_frame_rate(esp_lcd_panel_handle_t panel, st7796_frame_rate_mode_t mode, uint8_t frs_div, uint8_t rtn)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_st7796_del, ESP_ERR_INVALID_ARG, TAG, "invalid panel");
+    st7796_panel_t *st7796 = __containerof(panel, st7796_panel_t, base);
+    ESP_RETURN_ON_FALSE(mode <= ST7796_FRAME_RATE_PARTIAL && rtn <= 0x1F, ESP_ERR_INVALID_ARG, TAG, "invalid frame rate");
+
+    // FRMCTR1 (normal), FRMCTR2 (idle) and FRMCTR3 (partial) have the same parameters
+    const int command = 0xB1 + mode;
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(st7796->io, command, (uint8_t[]) {
+        frs_div,
+        rtn,
+    }, 2), TAG, "send command failed");
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_st7796_set_scroll_area(esp_lcd_panel_handle_t panel, uint16_t top, uint16_t height)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_st7796_del, ESP_ERR_INVALID_ARG, TAG, "invalid panel");
+    st7796_panel_t *st7796 = __containerof(panel, st7796_panel_t, base);
+    esp_lcd_panel_io_handle_t io = st7796->io;
+
+    int first = 0;
+    ESP_RETURN_ON_ERROR(panel_st7796_rows_to_lines(st7796, top, height, &first), TAG, "invalid scroll area");
+    const int bottom = ST7796_LINES - first - height;
+
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_VSCRDEF, (uint8_t[]) {
+        (first >> 8) & 0xFF,
+        first & 0xFF,
+        (height >> 8) & 0xFF,
+        height & 0xFF,
+        (bottom >> 8) & 0xFF,
+        bottom & 0xFF,
+    }, 6), TAG, "send command failed");
+    // the first line of the area is shown at its top
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_VSCSAD, (uint8_t[]) {
+        (first >> 8) & 0xFF,
+        first & 0xFF,
+    }, 2), TAG, "send command failed");
+    st7796->scroll_first = first;
+    st7796->scroll_height = height;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_st7796_set_scroll_offset(esp_lcd_panel_handle_t panel, uint16_t offset)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_st7796_del, ESP_ERR_INVALID_ARG, TAG, "invalid panel");
+    st7796_panel_t *st7796 = __containerof(panel, st7796_panel_t, base);
+    esp_lcd_panel_io_handle_t io = st7796->io;
+
+    ESP_RETURN_ON_FALSE(st7796->scroll_height, ESP_ERR_INVALID_STATE, TAG, "scroll area is not defined");
+    ESP_RETURN_ON_FALSE(offset < st7796->scroll_height, ESP_ERR_INVALID_ARG, TAG, "invalid scroll offset");
+    if (st7796->madctl_val & LCD_CMD_MY_BIT) {
+        // picture is mirrored, the panel scrolls in the opposite direction
+        offset = (st7796->scroll_height - offset) % st7796->scroll_height;
+    }
+    const int line = st7796->scroll_first + offset;
+
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_VSCSAD, (uint8_t[]) {
+        (line >> 8) & 0xFF,
+        line & 0xFF,
+    }, 2), TAG, "send command failed");
+
+    return ESP_OK;
+}
+
+static esp_err_t panel_st7796_send_gamma(st7796_panel_t *st7796)
+{
+    esp_lcd_panel_io_handle_t io = st7796->io;
+
+    // gamma registers are accessible only with enabled command set control (CSCON)
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, 0xF0, (uint8_t[]) {
+        0xC3,
+    }, 1), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, 0xF0, (uint8_t[]) {
+        0x96,
+    }, 1), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, 0xE0, st7796->gamma.positive, sizeof(st7796->gamma.positive)), TAG,
+                        "send command failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, 0xE1, st7796->gamma.negative, sizeof(st7796->gamma.negative)), TAG,
+                        "send command failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, 0xF0, (uint8_t[]) {
+        0x3C,
+    }, 1), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, 0xF0, (uint8_t[]) {
+        0x69,
+    }, 1), TAG, "send command failed");
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_st7796_set_gamma(esp_lcd_panel_handle_t panel, const st7796_gamma_t *gamma)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_st7796_del && gamma, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    st7796_panel_t *st7796 = __containerof(panel, st7796_panel_t, base);
+
+    st7796->gamma = *gamma;
+    st7796->gamma_set = true;
+    ESP_RETURN_ON_ERROR(panel_st7796_send_gamma(st7796), TAG, "set gamma failed");
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_st7796_save_gamma(esp_lcd_panel_handle_t panel, const char *key)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_st7796_del && key, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    st7796_panel_t *st7796 = __containerof(panel, st7796_panel_t, base);
+    esp_err_t ret = ESP_OK;
+    nvs_handle_t nvs;
+
+    ESP_RETURN_ON_FALSE(st7796->gamma_set, ESP_ERR_INVALID_STATE, TAG, "gamma is not set");
+    ESP_RETURN_ON_ERROR(nvs_open(ST7796_GAMMA_NVS_NAMESPACE, NVS_READWRITE, &nvs), TAG, "NVS open failed");
+    ESP_GOTO_ON_ERROR(nvs_set_blob(nvs, key, &st7796->gamma, sizeof(st7796_gamma_t)), err, TAG, "NVS write failed");
+    ESP_GOTO_ON_ERROR(nvs_commit(nvs), err, TAG, "NVS commit failed");
+
+err:
+    nvs_close(nvs);
+    return ret;
+}
+
+esp_err_t esp_lcd_st7796_load_gamma(esp_lcd_panel_handle_t panel, const char *key)
+{
+    ESP_RETURN_ON_FALSE(panel && panel->del == panel_st7796_del && key, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    esp_err_t ret = ESP_OK;
+    nvs_handle_t nvs;
+    st7796_gamma_t gamma;
+    size_t len = sizeof(st7796_gamma_t);
+
+    ret = nvs_open(ST7796_GAMMA_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (ret != ESP_OK) {
+        // namespace does not exist before the first save
+        return ret;
+    }
+    ret = nvs_get_blob(nvs, key, &gamma, &len);
+    nvs_close(nvs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ESP_RETURN_ON_FALSE(len == sizeof(st7796_gamma_t), ESP_ERR_INVALID_SIZE, TAG, "bad gamma in NVS");
+
+    return esp_lcd_st7796_set_gamma(panel, &gamma);
+}
+
 static esp_err_t panel_st7796_del(esp_lcd_panel_t *panel)
 {
     st7796_panel_t *st7796 = __containerof(panel, st7796_panel_t, base);
@@ -199,6 +404,7 @@ static esp_err_t panel_st7796_init(esp_lcd_panel_t *panel)
 
     // LCD goes into sleep mode and display will be turned off after power on reset, exit sleep mode first
     ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_SLPOUT, NULL, 0), TAG, "send command failed");
+    st7796->scroll_height = 0;
     vTaskDelay(pdMS_TO_TICKS(100));
     ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_MADCTL, (uint8_t[]) {
         st7796->madctl_val,
@@ -239,10 +445,25 @@ static esp_err_t panel_st7796_init(esp_lcd_panel_t *panel)
         }
 
         ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, init_cmds[i].cmd, init_cmds[i].data, init_cmds[i].data_bytes), TAG, "send command failed");
-        vTaskDelay(pdMS_TO_TICKS(init_cmds[i].delay_ms));
+        // Commands without delay are sent back to back, without switching to other tasks
+        if (init_cmds[i].delay_ms) {
+            vTaskDelay(pdMS_TO_TICKS(init_cmds[i].delay_ms));
+        }
     }
     ESP_LOGD(TAG, "send init commands success");
 
+    if (st7796->gamma_set) {
+        // gamma set at runtime (e.g. calibration of the unit) replaces the gamma of the init commands
+        ESP_RETURN_ON_ERROR(panel_st7796_send_gamma(st7796), TAG, "set gamma failed");
+    }
+
+    if (st7796->te_enable) {
+        // TE output with V-blanking information only
+        ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(io, LCD_CMD_TEON, (uint8_t[]) {
+            0x00,
+        }, 1), TAG, "send command failed");
+    }
+
     return ESP_OK;
 }
 
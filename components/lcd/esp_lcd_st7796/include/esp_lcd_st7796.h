@@ -52,9 +52,30 @@ typedef struct {
 #endif
     struct {
         unsigned int use_mipi_interface: 1;         /*<! Set to 1 if using MIPI interface, default is SPI/I80 interface */
+        unsigned int te_enable: 1;                  /*<! Set to 1 to enable TE (tearing effect) output in V-blanking (SPI/I80 interface only) */
     } flags;
 } st7796_vendor_config_t;
 
+/**
+ * @brief Display mode of the frame rate control
+ */
+typedef enum {
+    ST7796_FRAME_RATE_NORMAL = 0,   /*!< Normal mode, full colors (FRMCTR1) */
+    ST7796_FRAME_RATE_IDLE,         /*!< Idle mode, 8 colors (FRMCTR2) */
+    ST7796_FRAME_RATE_PARTIAL,      /*!< Partial mode, full colors (FRMCTR3) */
+} st7796_frame_rate_mode_t;
+
+/**
+ * @brief Gamma correction of the panel
+ *
+ * Parameters of the gamma registers as they are sent to the controller, see the datasheet
+ * (`vendor_specific_init_default` in source file has the default curve).
+ */
+typedef struct {
+    uint8_t positive[14];   /*!< Positive gamma control (PGC, E0h) */
+    uint8_t negative[14];   /*!< Negative gamma control (NGC, E1h) */
+} st7796_gamma_t;
+
 /**
  * @brief Create LCD panel for model ST7796
  *
@@ -70,6 +91,134 @@ typedef struct {
  */
 esp_err_t esp_lcd_new_panel_st7796(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *panel_dev_config, esp_lcd_panel_handle_t *ret_panel);
 
+/**
+ * @brief Turn idle mode on or off (IDMON/IDMOFF)
+ *
+ * In idle mode, the panel shows only 8 colors (MSB of each color component) and can run at lower frame rate
+ * (frame rate of the idle mode), which reduces its power consumption, e.g. on a static screen.
+ *
+ * @param[in] panel LCD panel handle of ST7796
+ * @param[in] idle True to turn idle mode on, false to return to full colors
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid or the panel is not ST7796 with SPI/I80 interface
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_st7796_set_idle_mode(esp_lcd_panel_handle_t panel, bool idle);
+
+/**
+ * @brief Turn partial display mode on or off (PTLAR + PTLON/NORON)
+ *
+ * In partial mode, only the rows of the partial area are driven, the rest of the panel shows the non-display color.
+ *
+ * @note  Partial area is defined in lines of the panel (480), it is not supported with swapped axes (landscape orientation).
+ *
+ * @param[in] panel LCD panel handle of ST7796
+ * @param[in] partial True to turn partial mode on, false to return to normal mode (whole panel)
+ * @param[in] top First row of the partial area (coordinates of `esp_lcd_panel_draw_bitmap()`, ignored in normal mode)
+ * @param[in] height Rows of the partial area (ignored in normal mode)
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid or the panel is not ST7796 with SPI/I80 interface
+ *          - ESP_ERR_NOT_SUPPORTED if the axes are swapped
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_st7796_set_partial_mode(esp_lcd_panel_handle_t panel, bool partial, uint16_t top, uint16_t height);
+
+/**
+ * @brief Set frame rate of the display mode (FRMCTR1/2/3, SPI/I80 interface)
+ *
+ * The parameters are written to the register of the mode as they are, see the datasheet of the controller
+ * (reset values of normal mode are 0xA0 and 0x10).
+ *
+ * @param[in] panel LCD panel handle of ST7796
+ * @param[in] mode Display mode
+ * @param[in] frs_div First parameter: frame rate select (bits 7:4, normal mode only) and division ratio of the internal clock (bits 1:0)
+ * @param[in] rtn Second parameter: clocks per line (bits 4:0)
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid or the panel is not ST7796 with SPI/I80 interface
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_st7796_set_frame_rate(esp_lcd_panel_handle_t panel, st7796_frame_rate_mode_t mode, uint8_t frs_div, uint8_t rtn);
+
+/**
+ * @brief Define vertical scrolling area (VSCRDEF)
+ *
+ * Rows above and below the scrolling area are fixed. The rows of the scrolling area are shown rotated by the offset
+ * set by `esp_lcd_st7796_set_scroll_offset()`, so a scrolled picture needs only the newly exposed rows to be sent.
+ * The scrolling offset is reset to 0.
+ *
+ * @note  Scrolling works in lines of the panel (480), it is not supported with swapped axes (landscape orientation).
+ * @note  Only SPI/I80 interface is supported.
+ *
+ * @param[in] panel LCD panel handle of ST7796
+ * @param[in] top First row of the scrolling area (coordinates of `esp_lcd_panel_draw_bitmap()`)
+ * @param[in] height Rows of the scrolling area
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid or the panel is not ST7796 with SPI/I80 interface
+ *          - ESP_ERR_NOT_SUPPORTED if the axes are swapped
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_st7796_set_scroll_area(esp_lcd_panel_handle_t panel, uint16_t top, uint16_t height);
+
+/**
+ * @brief Set vertical scrolling offset (VSCRSADD)
+ *
+ * The row `top + offset` of the panel memory is shown at the top of the scrolling area, the rows of the memory
+ * above it are shown below the last one.
+ *
+ * @param[in] panel LCD panel handle of ST7796
+ * @param[in] offset Scrolling offset in rows (0 to `height - 1`)
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid or the panel is not ST7796 with SPI/I80 interface
+ *          - ESP_ERR_INVALID_STATE if the scrolling area is not defined
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_st7796_set_scroll_offset(esp_lcd_panel_handle_t panel, uint16_t offset);
+
+/**
+ * @brief Set gamma correction of the panel (PGC/NGC, SPI/I80 interface)
+ *
+ * The colors are corrected by the controller, so the rendered buffers need no color correction in software.
+ * The gamma is kept by the driver and sent again after the initialization commands by `esp_lcd_panel_init()`,
+ * so it can be set before or after the initialization.
+ *
+ * @param[in] panel LCD panel handle of ST7796
+ * @param[in] gamma Gamma correction
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid or the panel is not ST7796 with SPI/I80 interface
+ *          - ESP_OK                on success
+ */
+esp_err_t esp_lcd_st7796_set_gamma(esp_lcd_panel_handle_t panel, const st7796_gamma_t *gamma);
+
+/**
+ * @brief Save gamma correction of the panel into NVS (e.g. calibration of the unit)
+ *
+ * @note  NVS must be initialized (`nvs_flash_init`).
+ *
+ * @param[in] panel LCD panel handle of ST7796
+ * @param[in] key NVS key (more panels can be saved under different keys)
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid or the panel is not ST7796 with SPI/I80 interface
+ *          - ESP_ERR_INVALID_STATE if the gamma is not set by `esp_lcd_st7796_set_gamma()`
+ *          - ESP_OK                on success
+ *          - Others                NVS error
+ */
+esp_err_t esp_lcd_st7796_save_gamma(esp_lcd_panel_handle_t panel, const char *key);
+
+/**
+ * @brief Load gamma correction from NVS and set it to the panel
+ *
+ * @note  NVS must be initialized (`nvs_flash_init`).
+ *
+ * @param[in] panel LCD panel handle of ST7796
+ * @param[in] key NVS key
+ * @return
+ *          - ESP_ERR_INVALID_ARG   if parameter is invalid or the panel is not ST7796 with SPI/I80 interface
+ *          - ESP_ERR_NVS_NOT_FOUND if the gamma was not saved yet
+ *          - ESP_OK                on success
+ *          - Others                NVS error
+ */
+esp_err_t esp_lcd_st7796_load_gamma(esp_lcd_panel_handle_t panel, const char *key);
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////// Default Configuration Macros for I80 Interface /////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
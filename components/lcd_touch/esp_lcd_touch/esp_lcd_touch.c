@@ -5,6 +5,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/gpio.h"
@@ -12,17 +13,67 @@
 #include "esp_err.h"
 #include "esp_check.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_sleep.h"
+#include "nvs.h"
 #include "esp_lcd_touch.h"
+#if CONFIG_ESP_LCD_TOUCH_TRACE_SYSVIEW
+#include "SEGGER_SYSVIEW.h"
+#endif
 
 static const char *TAG = "TP";
 
+/* Time to wait for the end of the acquisition task */
+#define ESP_LCD_TOUCH_ACQUISITION_STOP_MS   (1000)
+
+/* NVS namespace for calibration matrices */
+#define ESP_LCD_TOUCH_CALIBRATION_NVS_NAMESPACE     "esp_lcd_touch"
+
+/* SystemView user event of the controller reading */
+#define ESP_LCD_TOUCH_SV_READ       (3)
+#if CONFIG_ESP_LCD_TOUCH_TRACE_SYSVIEW
+#define ESP_LCD_TOUCH_SV_START(id)  SEGGER_SYSVIEW_OnUserStart(id)
+#define ESP_LCD_TOUCH_SV_STOP(id)   SEGGER_SYSVIEW_OnUserStop(id)
+#else
+#define ESP_LCD_TOUCH_SV_START(id)
+#define ESP_LCD_TOUCH_SV_STOP(id)
+#endif
+
 /*******************************************************************************
-* Function definitions
+* Types definitions
 *******************************************************************************/
 
+typedef struct {
+    bool touched;
+    uint8_t points;
+    uint16_t x[CONFIG_ESP_LCD_TOUCH_MAX_POINTS];
+    uint16_t y[CONFIG_ESP_LCD_TOUCH_MAX_POINTS];
+    uint16_t strength[CONFIG_ESP_LCD_TOUCH_MAX_POINTS];
+} esp_lcd_touch_acq_sample_t;
+
+struct esp_lcd_touch_acquisition_s {
+    TaskHandle_t task;                      /* Acquisition task */
+    TaskHandle_t stop_task;                 /* Task waiting for the end of the acquisition task */
+    volatile bool running;                  /* Acquisition task is running */
+    uint32_t poll_period_ms;                /* Period of reading while touched or without interrupt pin */
+    esp_lcd_touch_acq_sample_t samples[2];      /* Double-buffered samples */
+    uint8_t ready;                          /* Index of the last complete sample */
+    portMUX_TYPE lock;                      /* Lock for switching of the samples */
+    gpio_num_t int_gpio;                    /* Interrupt pin (GPIO_NUM_NC: polling) */
+    volatile bool wakeup;                   /* Level interrupt wakes the system, it is masked in ISR until release */
+    volatile int64_t irq_us;                /* Time of the last interrupt */
+    esp_lcd_touch_wakeup_stats_t wake_stats;
+};
+
 /*******************************************************************************
-* Local variables
+* Function definitions
 *******************************************************************************/
+static void esp_lcd_touch_acquisition_task(void *arg);
+static void esp_lcd_touch_acquisition_isr(void *arg);
+static bool esp_lcd_touch_acquisition_get_xy(esp_lcd_touch_handle_t tp, uint16_t *x, uint16_t *y, uint16_t *strength, uint8_t *point_num, uint8_t max_point_num);
+static esp_err_t esp_lcd_touch_read(esp_lcd_touch_handle_t tp);
+static void esp_lcd_touch_adjust_coordinates(esp_lcd_touch_handle_t tp, uint16_t *x, uint16_t *y, uint16_t *strength, uint8_t *point_num, uint8_t max_point_num);
+static void esp_lcd_touch_apply_calibration(esp_lcd_touch_handle_t tp, uint16_t *x, uint16_t *y, uint8_t point_num);
 
 /*******************************************************************************
 * Public API functions
@@ -50,12 +101,26 @@ esp_err_t esp_lcd_touch_exit_sleep(esp_lcd_touch_handle_t tp)
     }
 }
 
+esp_err_t esp_lcd_touch_set_active_scan(esp_lcd_touch_handle_t tp, bool active)
+{
+    assert(tp != NULL);
+    if (tp->set_active_scan == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return tp->set_active_scan(tp, active);
+}
+
 esp_err_t esp_lcd_touch_read_data(esp_lcd_touch_handle_t tp)
 {
     assert(tp != NULL);
     assert(tp->read_data != NULL);
 
-    return tp->read_data(tp);
+    /* Controller is read by the acquisition task */
+    if (tp->acquisition) {
+        return ESP_OK;
+    }
+
+    return esp_lcd_touch_read(tp);
 }
 
 bool esp_lcd_touch_get_coordinates(esp_lcd_touch_handle_t tp, uint16_t *x, uint16_t *y, uint16_t *strength, uint8_t *point_num, uint8_t max_point_num)
@@ -67,43 +132,95 @@ bool esp_lcd_touch_get_coordinates(esp_lcd_touch_handle_t tp, uint16_t *x, uint1
     assert(y != NULL);
     assert(tp->get_xy != NULL);
 
-    touched = tp->get_xy(tp, x, y, strength, point_num, max_point_num);
+    if (tp->acquisition) {
+        touched = esp_lcd_touch_acquisition_get_xy(tp, x, y, strength, point_num, max_point_num);
+    } else {
+        touched = tp->get_xy(tp, x, y, strength, point_num, max_point_num);
+    }
     if (!touched) {
         return false;
     }
 
-    /* Process coordinates by user */
-    if (tp->config.process_coordinates != NULL) {
-        tp->config.process_coordinates(tp, x, y, strength, point_num, max_point_num);
-    }
+    esp_lcd_touch_adjust_coordinates(tp, x, y, strength, point_num, max_point_num);
 
-    /* Software coordinates adjustment needed */
-    bool sw_adj_needed = ((tp->config.flags.mirror_x && (tp->set_mirror_x == NULL)) ||
-                          (tp->config.flags.mirror_y && (tp->set_mirror_y == NULL)) ||
-                          (tp->config.flags.swap_xy && (tp->set_swap_xy == NULL)));
+    return touched;
+}
 
-    /* Adjust all coordinates */
-    for (int i = 0; (sw_adj_needed && i < *point_num); i++) {
+#if (CONFIG_ESP_LCD_TOUCH_SAMPLES > 0)
+uint8_t esp_lcd_touch_get_samples(esp_lcd_touch_handle_t tp, esp_lcd_touch_sample_t *samples, uint8_t max_samples)
+{
+    assert(tp != NULL);
+    assert(samples != NULL || max_samples == 0);
 
-        /*  Mirror X coordinates (if not supported by HW) */
-        if (tp->config.flags.mirror_x && tp->set_mirror_x == NULL) {
-            x[i] = tp->config.x_max - x[i];
-        }
+    uint8_t cnt = 0;
 
-        /*  Mirror Y coordinates (if not supported by HW) */
-        if (tp->config.flags.mirror_y && tp->set_mirror_y == NULL) {
-            y[i] = tp->config.y_max - y[i];
+    portENTER_CRITICAL(&tp->data.lock);
+    /* Only the newest samples are returned, when there is not enough space */
+    while (tp->data.samples_cnt > max_samples) {
+        tp->data.samples_tail = (tp->data.samples_tail + 1) % CONFIG_ESP_LCD_TOUCH_SAMPLES;
+        tp->data.samples_cnt--;
+    }
+    while (tp->data.samples_cnt > 0) {
+        samples[cnt++] = tp->data.samples[tp->data.samples_tail];
+        tp->data.samples_tail = (tp->data.samples_tail + 1) % CONFIG_ESP_LCD_TOUCH_SAMPLES;
+        tp->data.samples_cnt--;
+    }
+    portEXIT_CRITICAL(&tp->data.lock);
+
+    /* Same adjusting as in esp_lcd_touch_get_coordinates, outside of the lock (user callback) */
+    uint8_t out = 0;
+    for (uint8_t i = 0; i < cnt; i++) {
+        uint8_t point_num = 1;
+        esp_lcd_touch_adjust_coordinates(tp, &samples[i].x, &samples[i].y, &samples[i].strength, &point_num, 1);
+        if (point_num > 0) {
+            samples[out++] = samples[i];
         }
+    }
 
-        /* Swap X and Y coordinates (if not supported by HW) */
-        if (tp->config.flags.swap_xy && tp->set_swap_xy == NULL) {
-            uint16_t tmp = x[i];
-            x[i] = y[i];
-            y[i] = tmp;
+    return out;
+}
+#endif
+
+esp_err_t esp_lcd_touch_get_gesture(esp_lcd_touch_handle_t tp, esp_lcd_touch_gesture_t *gesture)
+{
+    assert(tp != NULL);
+    assert(gesture != NULL);
+
+    portENTER_CRITICAL(&tp->data.lock);
+    esp_lcd_touch_gesture_t g = tp->data.gesture;
+    tp->data.gesture = ESP_LCD_TOUCH_GESTURE_NONE;
+    portEXIT_CRITICAL(&tp->data.lock);
+
+    /* Swipes are adjusted in the same order as the coordinates: mirror, then swap */
+    if (tp->config.flags.mirror_x && tp->set_mirror_x == NULL) {
+        g = (g == ESP_LCD_TOUCH_GESTURE_SWIPE_LEFT ? ESP_LCD_TOUCH_GESTURE_SWIPE_RIGHT :
+             g == ESP_LCD_TOUCH_GESTURE_SWIPE_RIGHT ? ESP_LCD_TOUCH_GESTURE_SWIPE_LEFT : g);
+    }
+    if (tp->config.flags.mirror_y && tp->set_mirror_y == NULL) {
+        g = (g == ESP_LCD_TOUCH_GESTURE_SWIPE_UP ? ESP_LCD_TOUCH_GESTURE_SWIPE_DOWN :
+             g == ESP_LCD_TOUCH_GESTURE_SWIPE_DOWN ? ESP_LCD_TOUCH_GESTURE_SWIPE_UP : g);
+    }
+    if (tp->config.flags.swap_xy && tp->set_swap_xy == NULL) {
+        switch (g) {
+        case ESP_LCD_TOUCH_GESTURE_SWIPE_UP:
+            g = ESP_LCD_TOUCH_GESTURE_SWIPE_LEFT;
+            break;
+        case ESP_LCD_TOUCH_GESTURE_SWIPE_DOWN:
+            g = ESP_LCD_TOUCH_GESTURE_SWIPE_RIGHT;
+            break;
+        case ESP_LCD_TOUCH_GESTURE_SWIPE_LEFT:
+            g = ESP_LCD_TOUCH_GESTURE_SWIPE_UP;
+            break;
+        case ESP_LCD_TOUCH_GESTURE_SWIPE_RIGHT:
+            g = ESP_LCD_TOUCH_GESTURE_SWIPE_DOWN;
+            break;
+        default:
+            break;
         }
     }
+    *gesture = g;
 
-    return touched;
+    return ESP_OK;
 }
 
 #if (CONFIG_ESP_LCD_TOUCH_MAX_BUTTONS > 0)
@@ -211,10 +328,130 @@ esp_err_t esp_lcd_touch_get_mirror_y(esp_lcd_touch_handle_t tp, bool *mirror)
     return ESP_OK;
 }
 
+esp_err_t esp_lcd_touch_set_calibration(esp_lcd_touch_handle_t tp, const esp_lcd_touch_calibration_t *calibration)
+{
+    assert(tp != NULL);
+
+    /* Acquisition task or other task can just adjust the coordinates */
+    portENTER_CRITICAL(&tp->data.lock);
+    if (calibration) {
+        tp->calibration = *calibration;
+        tp->calibrated = true;
+    } else {
+        tp->calibrated = false;
+    }
+    portEXIT_CRITICAL(&tp->data.lock);
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_touch_get_calibration(esp_lcd_touch_handle_t tp, esp_lcd_touch_calibration_t *calibration)
+{
+    assert(tp != NULL);
+    assert(calibration != NULL);
+
+    ESP_RETURN_ON_FALSE(tp->calibrated, ESP_ERR_INVALID_STATE, TAG, "Calibration is not set");
+    *calibration = tp->calibration;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_touch_calibration_compute(const esp_lcd_touch_point_t raw[3], const esp_lcd_touch_point_t display[3], esp_lcd_touch_calibration_t *calibration)
+{
+    assert(raw != NULL);
+    assert(display != NULL);
+    assert(calibration != NULL);
+
+    /* Solve display = M * raw for three points (Cramer's rule) */
+    const int64_t x0 = raw[0].x, y0 = raw[0].y;
+    const int64_t x1 = raw[1].x, y1 = raw[1].y;
+    const int64_t x2 = raw[2].x, y2 = raw[2].y;
+    int64_t det = (x0 - x2) * (y1 - y2) - (x1 - x2) * (y0 - y2);
+    ESP_RETURN_ON_FALSE(det != 0, ESP_ERR_INVALID_ARG, TAG, "Calibration points lie on one line");
+
+    int64_t coef[6];
+    for (int i = 0; i < 2; i++) {
+        const int64_t v0 = (i == 0 ? display[0].x : display[0].y);
+        const int64_t v1 = (i == 0 ? display[1].x : display[1].y);
+        const int64_t v2 = (i == 0 ? display[2].x : display[2].y);
+        coef[i * 3 + 0] = (v0 - v2) * (y1 - y2) - (v1 - v2) * (y0 - y2);
+        coef[i * 3 + 1] = (x0 - x2) * (v1 - v2) - (x1 - x2) * (v0 - v2);
+        coef[i * 3 + 2] = v0 * (x1 * y2 - x2 * y1) - v1 * (x0 * y2 - x2 * y0) + v2 * (x0 * y1 - x1 * y0);
+    }
+    if (det < 0) {
+        det = -det;
+        for (int i = 0; i < 6; i++) {
+            coef[i] = -coef[i];
+        }
+    }
+
+    /* Fixed-point with rounding, the division is done only here */
+    int32_t *out = &calibration->a;
+    for (int i = 0; i < 6; i++) {
+        const int64_t num = coef[i] * (1 << ESP_LCD_TOUCH_CALIBRATION_SHIFT);
+        int64_t val = (num >= 0 ? num + det / 2 : num - det / 2) / det;
+        /* Half of pixel in offsets, the shift in the transformation rounds down */
+        if (i == 2 || i == 5) {
+            val += (1 << (ESP_LCD_TOUCH_CALIBRATION_SHIFT - 1));
+        }
+        ESP_RETURN_ON_FALSE(val >= INT32_MIN && val <= INT32_MAX, ESP_ERR_INVALID_ARG, TAG, "Calibration out of range");
+        out[i] = (int32_t)val;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_touch_calibration_save(esp_lcd_touch_handle_t tp, const char *key)
+{
+    esp_err_t ret = ESP_OK;
+    nvs_handle_t nvs;
+
+    assert(tp != NULL);
+    assert(key != NULL);
+
+    ESP_RETURN_ON_FALSE(tp->calibrated, ESP_ERR_INVALID_STATE, TAG, "Calibration is not set");
+    ESP_RETURN_ON_ERROR(nvs_open(ESP_LCD_TOUCH_CALIBRATION_NVS_NAMESPACE, NVS_READWRITE, &nvs), TAG, "NVS open failed");
+    ESP_GOTO_ON_ERROR(nvs_set_blob(nvs, key, &tp->calibration, sizeof(esp_lcd_touch_calibration_t)), err, TAG, "NVS write failed");
+    ESP_GOTO_ON_ERROR(nvs_commit(nvs), err, TAG, "NVS commit failed");
+
+err:
+    nvs_close(nvs);
+    return ret;
+}
+
+esp_err_t esp_lcd_touch_calibration_load(esp_lcd_touch_handle_t tp, const char *key)
+{
+    esp_err_t ret = ESP_OK;
+    nvs_handle_t nvs;
+    esp_lcd_touch_calibration_t calibration;
+    size_t len = sizeof(esp_lcd_touch_calibration_t);
+
+    assert(tp != NULL);
+    assert(key != NULL);
+
+    ret = nvs_open(ESP_LCD_TOUCH_CALIBRATION_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (ret != ESP_OK) {
+        /* Namespace does not exist before the first save */
+        return ret;
+    }
+    ret = nvs_get_blob(nvs, key, &calibration, &len);
+    nvs_close(nvs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ESP_RETURN_ON_FALSE(len == sizeof(esp_lcd_touch_calibration_t), ESP_ERR_INVALID_SIZE, TAG, "Bad calibration in NVS");
+
+    return esp_lcd_touch_set_calibration(tp, &calibration);
+}
+
 esp_err_t esp_lcd_touch_del(esp_lcd_touch_handle_t tp)
 {
     assert(tp != NULL);
 
+    if (tp->acquisition) {
+        esp_lcd_touch_stop_acquisition(tp);
+    }
+
     if (tp->del != NULL) {
         return tp->del(tp);
     }
@@ -234,6 +471,11 @@ esp_err_t esp_lcd_touch_register_interrupt_callback(esp_lcd_touch_handle_t tp, e
 
     tp->config.interrupt_callback = callback;
 
+    /* Interrupt is handled by the acquisition task, it calls the callback */
+    if (tp->acquisition) {
+        return ESP_OK;
+    }
+
     if (callback != NULL) {
         ret = gpio_install_isr_service(0);
         /* ISR service can be installed from user before, then it returns invalid state */
@@ -264,3 +506,323 @@ esp_err_t esp_lcd_touch_register_interrupt_callback_with_data(esp_lcd_touch_hand
     tp->config.user_data = user_data;
     return esp_lcd_touch_register_interrupt_callback(tp, callback);
 }
+
+esp_err_t esp_lcd_touch_start_acquisition(esp_lcd_touch_handle_t tp, const esp_lcd_touch_acquisition_config_t *cfg)
+{
+    esp_err_t ret = ESP_OK;
+    assert(tp != NULL);
+    assert(cfg != NULL);
+    assert(tp->read_data != NULL && tp->get_xy != NULL);
+    ESP_RETURN_ON_FALSE(tp->acquisition == NULL, ESP_ERR_INVALID_STATE, TAG, "Acquisition is already running");
+
+    esp_lcd_touch_acquisition_t *acq = calloc(1, sizeof(esp_lcd_touch_acquisition_t));
+    ESP_RETURN_ON_FALSE(acq, ESP_ERR_NO_MEM, TAG, "Not enough memory for touch acquisition");
+    acq->poll_period_ms = (cfg->poll_period_ms > 0 ? cfg->poll_period_ms : 10);
+    acq->int_gpio = tp->config.int_gpio_num;
+    portMUX_INITIALIZE(&acq->lock);
+    acq->running = true;
+
+    /* User interrupt callback is not called from ISR anymore */
+    if (tp->config.int_gpio_num != GPIO_NUM_NC && tp->config.interrupt_callback) {
+        ESP_GOTO_ON_ERROR(gpio_isr_handler_remove(tp->config.int_gpio_num), err, TAG, "GPIO ISR remove handler failed");
+    }
+
+    tp->acquisition = acq;
+
+    BaseType_t res;
+    if (cfg->task_affinity < 0) {
+        res = xTaskCreate(esp_lcd_touch_acquisition_task, "Touch task", cfg->task_stack, tp, cfg->task_priority, &acq->task);
+    } else {
+        res = xTaskCreatePinnedToCore(esp_lcd_touch_acquisition_task, "Touch task", cfg->task_stack, tp, cfg->task_priority, &acq->task, cfg->task_affinity);
+    }
+    ESP_GOTO_ON_FALSE(res == pdPASS, ESP_FAIL, err, TAG, "Create touch acquisition task fail!");
+
+    if (tp->config.int_gpio_num != GPIO_NUM_NC) {
+        ret = gpio_install_isr_service(0);
+        /* ISR service can be installed from user before, then it returns invalid state */
+        ESP_GOTO_ON_FALSE(ret == ESP_OK || ret == ESP_ERR_INVALID_STATE, ret, err, TAG, "GPIO ISR install failed");
+        ESP_GOTO_ON_ERROR(gpio_isr_handler_add(tp->config.int_gpio_num, esp_lcd_touch_acquisition_isr, acq), err, TAG, "GPIO ISR install failed");
+        ESP_GOTO_ON_ERROR(gpio_intr_enable(tp->config.int_gpio_num), err, TAG, "GPIO ISR enable failed");
+    }
+
+    return ESP_OK;
+
+err:
+    if (acq->task) {
+        esp_lcd_touch_stop_acquisition(tp);
+    } else {
+        tp->acquisition = NULL;
+        free(acq);
+        /* Give the interrupt back to the user callback */
+        if (tp->config.int_gpio_num != GPIO_NUM_NC && tp->config.interrupt_callback) {
+            esp_lcd_touch_register_interrupt_callback(tp, tp->config.interrupt_callback);
+        }
+    }
+    return ret;
+}
+
+esp_err_t esp_lcd_touch_stop_acquisition(esp_lcd_touch_handle_t tp)
+{
+    assert(tp != NULL);
+    esp_lcd_touch_acquisition_t *acq = tp->acquisition;
+    if (acq == NULL) {
+        return ESP_OK;
+    }
+
+    if (acq->wakeup) {
+        esp_lcd_touch_set_wakeup(tp, false);
+    }
+    if (tp->config.int_gpio_num != GPIO_NUM_NC) {
+        gpio_isr_handler_remove(tp->config.int_gpio_num);
+    }
+
+    /* Wait for the end of the task, it can be just reading the controller */
+    acq->stop_task = xTaskGetCurrentTaskHandle();
+    acq->running = false;
+    xTaskNotifyGive(acq->task);
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ESP_LCD_TOUCH_ACQUISITION_STOP_MS)) == 0) {
+        ESP_LOGW(TAG, "Touch acquisition task did not stop in time");
+    }
+
+    tp->acquisition = NULL;
+    free(acq);
+
+    /* Give the interrupt back to the user callback */
+    if (tp->config.int_gpio_num != GPIO_NUM_NC && tp->config.interrupt_callback) {
+        ESP_RETURN_ON_ERROR(esp_lcd_touch_register_interrupt_callback(tp, tp->config.interrupt_callback), TAG, "Interrupt callback register failed");
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_touch_set_wakeup(esp_lcd_touch_handle_t tp, bool enable)
+{
+    assert(tp != NULL);
+    esp_lcd_touch_acquisition_t *acq = tp->acquisition;
+    const gpio_num_t pin = tp->config.int_gpio_num;
+
+    ESP_RETURN_ON_FALSE(pin != GPIO_NUM_NC, ESP_ERR_NOT_SUPPORTED, TAG, "Wake-up needs the interrupt pin");
+    ESP_RETURN_ON_FALSE(acq, ESP_ERR_INVALID_STATE, TAG, "Wake-up needs the acquisition task");
+    if (enable == acq->wakeup) {
+        return ESP_OK;
+    }
+
+    if (enable) {
+        /* Only level is detected in light sleep, the ISR masks it until the touch is released */
+        ESP_RETURN_ON_ERROR(gpio_wakeup_enable(pin, (tp->config.levels.interrupt ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL)), TAG, "GPIO wake-up enable failed");
+        ESP_RETURN_ON_ERROR(esp_sleep_enable_gpio_wakeup(), TAG, "GPIO wake-up source enable failed");
+        acq->wakeup = true;
+    } else {
+        /* The wake-up source stays enabled, other GPIOs can use it */
+        acq->wakeup = false;
+        ESP_RETURN_ON_ERROR(gpio_wakeup_disable(pin), TAG, "GPIO wake-up disable failed");
+        ESP_RETURN_ON_ERROR(gpio_set_intr_type(pin, (tp->config.levels.interrupt ? GPIO_INTR_POSEDGE : GPIO_INTR_NEGEDGE)), TAG, "GPIO interrupt type failed");
+        ESP_RETURN_ON_ERROR(gpio_intr_enable(pin), TAG, "GPIO ISR enable failed");
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_touch_get_wakeup_stats(esp_lcd_touch_handle_t tp, esp_lcd_touch_wakeup_stats_t *stats)
+{
+    assert(tp != NULL);
+    assert(stats != NULL);
+    esp_lcd_touch_acquisition_t *acq = tp->acquisition;
+
+    if (acq == NULL) {
+        memset(stats, 0, sizeof(esp_lcd_touch_wakeup_stats_t));
+        return ESP_OK;
+    }
+    portENTER_CRITICAL(&acq->lock);
+    *stats = acq->wake_stats;
+    portEXIT_CRITICAL(&acq->lock);
+
+    return ESP_OK;
+}
+
+/*******************************************************************************
+* Private API function
+*******************************************************************************/
+/* Read the controller and save the first point with timestamp into the samples ring */
+static esp_err_t esp_lcd_touch_read(esp_lcd_touch_handle_t tp)
+{
+    ESP_LCD_TOUCH_SV_START(ESP_LCD_TOUCH_SV_READ);
+    esp_err_t ret = tp->read_data(tp);
+    ESP_LCD_TOUCH_SV_STOP(ESP_LCD_TOUCH_SV_READ);
+#if (CONFIG_ESP_LCD_TOUCH_SAMPLES > 0)
+    if (ret == ESP_OK) {
+        const int64_t now = esp_timer_get_time();
+        portENTER_CRITICAL(&tp->data.lock);
+        if (tp->data.points > 0) {
+            /* The oldest sample is overwritten, when the ring is full */
+            if (tp->data.samples_cnt == CONFIG_ESP_LCD_TOUCH_SAMPLES) {
+                tp->data.samples_tail = (tp->data.samples_tail + 1) % CONFIG_ESP_LCD_TOUCH_SAMPLES;
+                tp->data.samples_cnt--;
+            }
+            esp_lcd_touch_sample_t *sample = &tp->data.samples[(tp->data.samples_tail + tp->data.samples_cnt) % CONFIG_ESP_LCD_TOUCH_SAMPLES];
+            sample->x = tp->data.coords[0].x;
+            sample->y = tp->data.coords[0].y;
+            sample->strength = tp->data.coords[0].strength;
+            sample->timestamp_us = now;
+            tp->data.samples_cnt++;
+        }
+        portEXIT_CRITICAL(&tp->data.lock);
+    }
+#endif
+    return ret;
+}
+
+static void esp_lcd_touch_adjust_coordinates(esp_lcd_touch_handle_t tp, uint16_t *x, uint16_t *y, uint16_t *strength, uint8_t *point_num, uint8_t max_point_num)
+{
+    /* Calibration of the raw coordinates */
+    if (tp->calibrated) {
+        esp_lcd_touch_apply_calibration(tp, x, y, *point_num);
+    }
+
+    /* Process coordinates by user */
+    if (tp->config.process_coordinates != NULL) {
+        tp->config.process_coordinates(tp, x, y, strength, point_num, max_point_num);
+    }
+
+    /* Software coordinates adjustment needed */
+    bool sw_adj_needed = ((tp->config.flags.mirror_x && (tp->set_mirror_x == NULL)) ||
+                          (tp->config.flags.mirror_y && (tp->set_mirror_y == NULL)) ||
+                          (tp->config.flags.swap_xy && (tp->set_swap_xy == NULL)));
+
+    /* Adjust all coordinates */
+    for (int i = 0; (sw_adj_needed && i < *point_num); i++) {
+
+        /*  Mirror X coordinates (if not supported by HW) */
+        if (tp->config.flags.mirror_x && tp->set_mirror_x == NULL) {
+            x[i] = tp->config.x_max - x[i];
+        }
+
+        /*  Mirror Y coordinates (if not supported by HW) */
+        if (tp->config.flags.mirror_y && tp->set_mirror_y == NULL) {
+            y[i] = tp->config.y_max - y[i];
+        }
+
+        /* Swap X and Y coordinates (if not supported by HW) */
+        if (tp->config.flags.swap_xy && tp->set_swap_xy == NULL) {
+            uint16_t tmp = x[i];
+            x[i] = y[i];
+            y[i] = tmp;
+        }
+    }
+}
+
+static void esp_lcd_touch_apply_calibration(esp_lcd_touch_handle_t tp, uint16_t *x, uint16_t *y, uint8_t point_num)
+{
+    esp_lcd_touch_calibration_t cal;
+
+    portENTER_CRITICAL(&tp->data.lock);
+    cal = tp->calibration;
+    portEXIT_CRITICAL(&tp->data.lock);
+
+    const int32_t x_max = tp->config.x_max;
+    const int32_t y_max = tp->config.y_max;
+    for (int i = 0; i < point_num; i++) {
+        const int32_t rx = x[i];
+        const int32_t ry = y[i];
+        /* 16-bit coordinates and 32-bit coefficients need 64-bit products */
+        int32_t cx = (int32_t)(((int64_t)cal.a * rx + (int64_t)cal.b * ry + cal.c) >> ESP_LCD_TOUCH_CALIBRATION_SHIFT);
+        int32_t cy = (int32_t)(((int64_t)cal.d * rx + (int64_t)cal.e * ry + cal.f) >> ESP_LCD_TOUCH_CALIBRATION_SHIFT);
+        cx = (cx < 0 ? 0 : (cx > x_max ? x_max : cx));
+        cy = (cy < 0 ? 0 : (cy > y_max ? y_max : cy));
+        x[i] = (uint16_t)cx;
+        y[i] = (uint16_t)cy;
+    }
+}
+
+static void IRAM_ATTR esp_lcd_touch_acquisition_isr(void *arg)
+{
+    esp_lcd_touch_acquisition_t *acq = (esp_lcd_touch_acquisition_t *)arg;
+    BaseType_t need_yield = pdFALSE;
+
+    acq->irq_us = esp_timer_get_time();
+    /* Level interrupt of the wake-up would repeat until the touch is released */
+    if (acq->wakeup) {
+        gpio_intr_disable(acq->int_gpio);
+    }
+    vTaskNotifyGiveFromISR(acq->task, &need_yield);
+    if (need_yield == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static void esp_lcd_touch_acquisition_task(void *arg)
+{
+    esp_lcd_touch_handle_t tp = (esp_lcd_touch_handle_t)arg;
+    esp_lcd_touch_acquisition_t *acq = tp->acquisition;
+    const bool has_int = (tp->config.int_gpio_num != GPIO_NUM_NC);
+    bool touched = false;
+
+    while (acq->running) {
+        /* Release must be read too, the controller can stop generating interrupts when not touched */
+        const TickType_t wait = ((touched || !has_int) ? pdMS_TO_TICKS(acq->poll_period_ms) : portMAX_DELAY);
+        if (acq->wakeup && !touched) {
+            /* Wake-up interrupt was masked in ISR, the next touch must wake the system again */
+            gpio_intr_enable(acq->int_gpio);
+        }
+        ulTaskNotifyTake(pdTRUE, (wait > 0 ? wait : 1));
+        if (!acq->running) {
+            break;
+        }
+
+        /* Interrupt started a new touch, the system could wake up from light sleep */
+        const bool wake = (acq->wakeup && !touched);
+        if (esp_lcd_touch_read(tp) != ESP_OK) {
+            continue;
+        }
+
+        /* Only this task writes into the sample, which is not ready */
+        esp_lcd_touch_acq_sample_t *sample = &acq->samples[acq->ready ^ 1];
+        sample->points = 0;
+        sample->touched = tp->get_xy(tp, sample->x, sample->y, sample->strength, &sample->points, CONFIG_ESP_LCD_TOUCH_MAX_POINTS);
+        if (!sample->touched) {
+            sample->points = 0;
+        }
+
+        portENTER_CRITICAL(&acq->lock);
+        acq->ready ^= 1;
+        if (wake && sample->touched) {
+            const uint32_t latency = (uint32_t)(esp_timer_get_time() - acq->irq_us);
+            acq->wake_stats.wake_cnt++;
+            acq->wake_stats.last_irq_us = acq->irq_us;
+            acq->wake_stats.read_latency_us = latency;
+            if (latency > acq->wake_stats.read_latency_max_us) {
+                acq->wake_stats.read_latency_max_us = latency;
+            }
+        }
+        portEXIT_CRITICAL(&acq->lock);
+
+        /* Notify user about new touch data and about the release */
+        const bool notify = (sample->touched || touched);
+        touched = sample->touched;
+        if (notify && tp->config.interrupt_callback) {
+            tp->config.interrupt_callback(tp);
+        }
+    }
+
+    xTaskNotifyGive(acq->stop_task);
+    vTaskDelete(NULL);
+}
+
+static bool esp_lcd_touch_acquisition_get_xy(esp_lcd_touch_handle_t tp, uint16_t *x, uint16_t *y, uint16_t *strength, uint8_t *point_num, uint8_t max_point_num)
+{
+    esp_lcd_touch_acquisition_t *acq = tp->acquisition;
+
+    portENTER_CRITICAL(&acq->lock);
+    const esp_lcd_touch_acq_sample_t *sample = &acq->samples[acq->ready];
+    const uint8_t points = (sample->points < max_point_num ? sample->points : max_point_num);
+    memcpy(x, sample->x, points * sizeof(uint16_t));
+    memcpy(y, sample->y, points * sizeof(uint16_t));
+    if (strength) {
+        memcpy(strength, sample->strength, points * sizeof(uint16_t));
+    }
+    const bool touched = sample->touched;
+    portEXIT_CRITICAL(&acq->lock);
+
+    *point_num = points;
+    return (touched && points > 0);
+}
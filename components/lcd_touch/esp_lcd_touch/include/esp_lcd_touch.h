@@ -68,6 +68,101 @@ typedef struct {
     void *driver_data;
 } esp_lcd_touch_config_t;
 
+/**
+ * @brief Touch acquisition task configuration
+ *
+ */
+typedef struct {
+    int task_priority;          /*!< Acquisition task priority */
+    int task_stack;             /*!< Acquisition task stack size */
+    int task_affinity;          /*!< Acquisition task pinned to core (-1 is no affinity) */
+    uint32_t poll_period_ms;    /*!< Period of reading while touched or when interrupt pin is not used */
+} esp_lcd_touch_acquisition_config_t;
+
+/**
+ * @brief Default touch acquisition task configuration
+ *
+ */
+#define ESP_LCD_TOUCH_ACQUISITION_DEFAULT_CONFIG()  \
+    {                                               \
+        .task_priority = 5,                         \
+        .task_stack = 3072,                         \
+        .task_affinity = -1,                        \
+        .poll_period_ms = 10,                       \
+    }
+
+typedef struct esp_lcd_touch_acquisition_s esp_lcd_touch_acquisition_t;
+
+/**
+ * @brief Statistics of the touches started by the wake-up interrupt (see esp_lcd_touch_set_wakeup)
+ *
+ */
+typedef struct {
+    uint32_t wake_cnt;              /*!< Count of touches started by the interrupt while not touched (the system could be in light sleep) */
+    int64_t last_irq_us;            /*!< Time of the interrupt, which started the last of them [us] (esp_timer_get_time) */
+    uint32_t read_latency_us;       /*!< Time from that interrupt to its first touched sample [us] */
+    uint32_t read_latency_max_us;   /*!< Longest time from the interrupt to the first touched sample [us] */
+} esp_lcd_touch_wakeup_stats_t;
+
+/**
+ * @brief Number of fractional bits of the calibration matrix coefficients
+ *
+ */
+#define ESP_LCD_TOUCH_CALIBRATION_SHIFT     (16)
+
+/**
+ * @brief Touch calibration matrix (fixed-point affine transformation)
+ *
+ * Coordinates are transformed as:
+ *   x' = (a * x + b * y + c) >> ESP_LCD_TOUCH_CALIBRATION_SHIFT
+ *   y' = (d * x + e * y + f) >> ESP_LCD_TOUCH_CALIBRATION_SHIFT
+ *
+ * It covers scale, offset, rotation and skew of the touch panel against the display.
+ */
+typedef struct {
+    int32_t a;  /*!< X scale (and rotation) */
+    int32_t b;  /*!< X skew (and rotation) */
+    int32_t c;  /*!< X offset */
+    int32_t d;  /*!< Y skew (and rotation) */
+    int32_t e;  /*!< Y scale (and rotation) */
+    int32_t f;  /*!< Y offset */
+} esp_lcd_touch_calibration_t;
+
+/**
+ * @brief Touch point for computing of the calibration matrix
+ *
+ */
+typedef struct {
+    uint16_t x; /*!< X coordinate */
+    uint16_t y; /*!< Y coordinate */
+} esp_lcd_touch_point_t;
+
+/**
+ * @brief Touch sample with timestamp (first touch point)
+ *
+ */
+typedef struct {
+    uint16_t x;             /*!< X coordinate */
+    uint16_t y;             /*!< Y coordinate */
+    uint16_t strength;      /*!< Strength */
+    int64_t timestamp_us;   /*!< Time of reading from the controller [us] (esp_timer_get_time) */
+} esp_lcd_touch_sample_t;
+
+/**
+ * @brief Gesture detected by the touch controller
+ *
+ */
+typedef enum {
+    ESP_LCD_TOUCH_GESTURE_NONE = 0,         /*!< No gesture */
+    ESP_LCD_TOUCH_GESTURE_SWIPE_UP,         /*!< Swipe towards lower Y */
+    ESP_LCD_TOUCH_GESTURE_SWIPE_DOWN,       /*!< Swipe towards higher Y */
+    ESP_LCD_TOUCH_GESTURE_SWIPE_LEFT,       /*!< Swipe towards lower X */
+    ESP_LCD_TOUCH_GESTURE_SWIPE_RIGHT,      /*!< Swipe towards higher X */
+    ESP_LCD_TOUCH_GESTURE_CLICK,            /*!< Single click */
+    ESP_LCD_TOUCH_GESTURE_DOUBLE_CLICK,     /*!< Double click */
+    ESP_LCD_TOUCH_GESTURE_LONG_PRESS,       /*!< Long press */
+} esp_lcd_touch_gesture_t;
+
 typedef struct {
     uint8_t points; /*!< Count of touch points saved */
 
@@ -85,6 +180,14 @@ typedef struct {
     } button[CONFIG_ESP_LCD_TOUCH_MAX_BUTTONS];
 #endif
 
+#if (CONFIG_ESP_LCD_TOUCH_SAMPLES > 0)
+    esp_lcd_touch_sample_t samples[CONFIG_ESP_LCD_TOUCH_SAMPLES]; /*!< Ring of samples not read by esp_lcd_touch_get_samples yet */
+    uint8_t samples_tail;   /*!< Index of the oldest sample */
+    uint8_t samples_cnt;    /*!< Count of samples in the ring */
+#endif
+
+    esp_lcd_touch_gesture_t gesture;    /*!< Last gesture detected by the controller, not read by esp_lcd_touch_get_gesture yet */
+
     portMUX_TYPE lock; /*!< Lock for read/write */
 } esp_lcd_touch_data_t;
 
@@ -118,6 +221,19 @@ struct esp_lcd_touch_s {
      */
     esp_err_t (*exit_sleep)(esp_lcd_touch_handle_t tp);
 
+    /**
+     * @brief Select fast scanning during interaction or slow monitoring in idle (optional)
+     *
+     * @note This function is usually blocking.
+     *
+     * @param tp: Touch handler
+     * @param active: True to keep the controller in active (fast) scanning, false to allow its monitor (slow) mode
+     *
+     * @return
+     *      - ESP_OK on success, otherwise returns ESP_ERR_xxx
+     */
+    esp_err_t (*set_active_scan)(esp_lcd_touch_handle_t tp, bool active);
+
     /**
      * @brief Read data from touch controller (mandatory)
      *
@@ -253,12 +369,23 @@ struct esp_lcd_touch_s {
      * @brief Data structure
      */
     esp_lcd_touch_data_t data;
+
+    /**
+     * @brief Acquisition task context (NULL, when the controller is read synchronously)
+     */
+    esp_lcd_touch_acquisition_t *acquisition;
+
+    /**
+     * @brief Calibration matrix, used only when `calibrated` is set
+     */
+    esp_lcd_touch_calibration_t calibration;
+    bool calibrated;    /*!< Calibration matrix is applied */
 };
 
 /**
  * @brief Read data from touch controller
  *
- * @note This function is usually blocking.
+ * @note This function is usually blocking. When the acquisition task is running, it does nothing.
  *
  * @param tp: Touch handler
  *
@@ -274,6 +401,8 @@ esp_err_t esp_lcd_touch_read_data(esp_lcd_touch_handle_t tp);
 /**
  * @brief Read coordinates from touch controller
  *
+ * @note When the acquisition task is running, the last sample read by the task is returned (non-blocking).
+ *
  * @param tp: Touch handler
  * @param x: Array of X coordinates
  * @param y: Array of Y coordinates
@@ -287,6 +416,41 @@ esp_err_t esp_lcd_touch_read_data(esp_lcd_touch_handle_t tp);
 bool esp_lcd_touch_get_coordinates(esp_lcd_touch_handle_t tp, uint16_t *x, uint16_t *y, uint16_t *strength, uint8_t *point_num, uint8_t max_point_num);
 
 
+#if (CONFIG_ESP_LCD_TOUCH_SAMPLES > 0)
+/**
+ * @brief Get all samples of the first touch point read since the last call (oldest first)
+ *
+ * Every successful reading of the controller (`esp_lcd_touch_read_data` or the acquisition task) saves
+ * the first touch point with timestamp into a ring of `CONFIG_ESP_LCD_TOUCH_SAMPLES` samples.
+ * The coordinates are adjusted in the same way as in `esp_lcd_touch_get_coordinates`.
+ *
+ * @note The samples do not replace `esp_lcd_touch_get_coordinates`, which is still needed for the touch state.
+ *
+ * @param tp: Touch handler
+ * @param samples: Array of samples
+ * @param max_samples: Size of samples array, only the newest samples are returned when there are more
+ *
+ * @return
+ *      - Count of returned samples
+ */
+uint8_t esp_lcd_touch_get_samples(esp_lcd_touch_handle_t tp, esp_lcd_touch_sample_t *samples, uint8_t max_samples);
+#endif
+
+/**
+ * @brief Get the last gesture detected by the touch controller
+ *
+ * Controllers with gesture engine (e.g. CST816S) save the detected gesture in `esp_lcd_touch_read_data`.
+ * The gesture is returned once, the next call returns `ESP_LCD_TOUCH_GESTURE_NONE` until a new gesture is detected.
+ * Swipe directions are adjusted by SW swap and mirror in the same way as the coordinates.
+ *
+ * @param tp: Touch handler
+ * @param gesture: Detected gesture (`ESP_LCD_TOUCH_GESTURE_NONE`, if there is none or the controller does not detect gestures)
+ *
+ * @return
+ *      - ESP_OK on success
+ */
+esp_err_t esp_lcd_touch_get_gesture(esp_lcd_touch_handle_t tp, esp_lcd_touch_gesture_t *gesture);
+
 #if (CONFIG_ESP_LCD_TOUCH_MAX_BUTTONS > 0)
 /**
  * @brief Get button state
@@ -369,6 +533,78 @@ esp_err_t esp_lcd_touch_set_mirror_y(esp_lcd_touch_handle_t tp, bool mirror);
  */
 esp_err_t esp_lcd_touch_get_mirror_y(esp_lcd_touch_handle_t tp, bool *mirror);
 
+/**
+ * @brief Set calibration matrix
+ *
+ * The matrix is applied to the coordinates read from the controller before the user `process_coordinates`
+ * callback and before SW swap and mirror. The result is limited into `x_max` and `y_max`.
+ *
+ * @param tp: Touch handler
+ * @param calibration: Calibration matrix (NULL disables the calibration)
+ *
+ * @return
+ *      - ESP_OK on success
+ */
+esp_err_t esp_lcd_touch_set_calibration(esp_lcd_touch_handle_t tp, const esp_lcd_touch_calibration_t *calibration);
+
+/**
+ * @brief Get calibration matrix
+ *
+ * @param tp: Touch handler
+ * @param calibration: Calibration matrix
+ *
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_STATE     if the calibration is not set
+ */
+esp_err_t esp_lcd_touch_get_calibration(esp_lcd_touch_handle_t tp, esp_lcd_touch_calibration_t *calibration);
+
+/**
+ * @brief Compute calibration matrix from three touched points
+ *
+ * The user touches three points shown on the display (e.g. crosses at 10 %, 50 % and 90 % of the screen,
+ * not lying on one line). Raw coordinates are read with calibration, swap and mirror disabled.
+ *
+ * @param raw: Three points read from the touch controller
+ * @param display: Three points shown on the display
+ * @param calibration: Computed calibration matrix
+ *
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if the points lie on one line
+ */
+esp_err_t esp_lcd_touch_calibration_compute(const esp_lcd_touch_point_t raw[3], const esp_lcd_touch_point_t display[3], esp_lcd_touch_calibration_t *calibration);
+
+/**
+ * @brief Save calibration matrix of the touch into NVS
+ *
+ * @note NVS must be initialized (`nvs_flash_init`).
+ *
+ * @param tp: Touch handler
+ * @param key: NVS key (more touches can be saved under different keys)
+ *
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_STATE     if the calibration is not set
+ *      - Others                    NVS error
+ */
+esp_err_t esp_lcd_touch_calibration_save(esp_lcd_touch_handle_t tp, const char *key);
+
+/**
+ * @brief Load calibration matrix from NVS and apply it to the touch
+ *
+ * @note NVS must be initialized (`nvs_flash_init`).
+ *
+ * @param tp: Touch handler
+ * @param key: NVS key
+ *
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_NVS_NOT_FOUND     if the calibration was not saved yet
+ *      - Others                    NVS error
+ */
+esp_err_t esp_lcd_touch_calibration_load(esp_lcd_touch_handle_t tp, const char *key);
+
 /**
  * @brief Delete touch (free all allocated memory and restart HW)
  *
@@ -424,6 +660,87 @@ esp_err_t esp_lcd_touch_enter_sleep(esp_lcd_touch_handle_t tp);
  */
 esp_err_t esp_lcd_touch_exit_sleep(esp_lcd_touch_handle_t tp);
 
+/**
+ * @brief Select fast scanning during interaction or slow monitoring in idle
+ *
+ * In active scanning, the controller scans the panel at its active report rate and reports the touch without delay.
+ * In monitor mode, it scans at a low rate and switches to active scanning after a touch is detected, which decreases
+ * its current consumption and the count of interrupts in idle.
+ *
+ * @param tp: Touch handler
+ * @param active: True to keep the controller in active scanning, false to let it enter monitor mode without touch
+ *
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_NOT_SUPPORTED     if the controller does not support it
+ */
+esp_err_t esp_lcd_touch_set_active_scan(esp_lcd_touch_handle_t tp, bool active);
+
+/**
+ * @brief Start reading of the touch controller in a separate task
+ *
+ * The task reads the controller after the touch interrupt (or periodically, when interrupt pin is not used)
+ * and while touched. The samples are double-buffered, `esp_lcd_touch_get_coordinates` only copies the last one
+ * and `esp_lcd_touch_read_data` does nothing. The I2C/SPI transactions are removed from the caller (e.g. the LVGL task).
+ *
+ * @note The interrupt callback (`esp_lcd_touch_register_interrupt_callback`) is called from the acquisition task
+ *       after a new sample is ready, not from the interrupt.
+ *
+ * @param tp: Touch handler
+ * @param cfg: Acquisition task configuration
+ *
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_STATE     if the acquisition is already running
+ *      - ESP_ERR_NO_MEM            if there is not enough memory
+ */
+esp_err_t esp_lcd_touch_start_acquisition(esp_lcd_touch_handle_t tp, const esp_lcd_touch_acquisition_config_t *cfg);
+
+/**
+ * @brief Wake the system from light sleep by the touch interrupt
+ *
+ * The interrupt pin is configured as a level wake-up source (`gpio_wakeup_enable`, `esp_sleep_enable_gpio_wakeup`),
+ * so a touch wakes the chip from light sleep (also automatic light sleep). Edges are not detected in light sleep,
+ * therefore the interrupt becomes level triggered: the ISR masks it and notifies the acquisition task, which reads
+ * the controller immediately. The first touched sample is the first sample in the samples ring, no reading waits
+ * for the application. The interrupt is unmasked, when the touch is released.
+ *
+ * @note The controller must not be in sleep mode (`esp_lcd_touch_enter_sleep`), it would not report the touch.
+ *       Use its monitor mode instead (`esp_lcd_touch_set_active_scan`), it keeps its configuration and state.
+ * @note Needs the interrupt pin and the running acquisition task. The wake-up is disabled by `esp_lcd_touch_stop_acquisition`.
+ *
+ * @param tp: Touch handler
+ * @param enable: True to wake the system by the touch interrupt
+ *
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_NOT_SUPPORTED     if the interrupt pin is not used
+ *      - ESP_ERR_INVALID_STATE     if the acquisition task is not running
+ *      - Others                    GPIO or sleep configuration error
+ */
+esp_err_t esp_lcd_touch_set_wakeup(esp_lcd_touch_handle_t tp, bool enable);
+
+/**
+ * @brief Get statistics of the touches started by the wake-up interrupt
+ *
+ * @param tp: Touch handler
+ * @param stats: Output statistics (zeroed, when the acquisition task is not running)
+ *
+ * @return
+ *      - ESP_OK on success
+ */
+esp_err_t esp_lcd_touch_get_wakeup_stats(esp_lcd_touch_handle_t tp, esp_lcd_touch_wakeup_stats_t *stats);
+
+/**
+ * @brief Stop the acquisition task, the controller is read synchronously again
+ *
+ * @param tp: Touch handler
+ *
+ * @return
+ *      - ESP_OK on success
+ */
+esp_err_t esp_lcd_touch_stop_acquisition(esp_lcd_touch_handle_t tp);
+
 #ifdef __cplusplus
 }
 #endif
@@ -16,22 +16,42 @@
 #include "esp_check.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_touch.h"
+#include "esp_lcd_touch_cst816s.h"
 
 #define POINT_NUM_MAX       (1)
 
-#define DATA_START_REG      (0x02)
+#define DATA_START_REG      (0x01)
 #define CHIP_ID_REG         (0xA7)
+#define MOTION_MASK_REG     (0xEC)
+#define AUTO_SLEEP_TIME_REG (0xF9)
+#define IRQ_CTL_REG         (0xFA)
+#define DIS_AUTO_SLEEP_REG  (0xFE)
+
+#define MOTION_MASK_EN_DCLICK   (1 << 0)
+#define MOTION_MASK_EN_CON_UD   (1 << 1)
+#define MOTION_MASK_EN_CON_LR   (1 << 2)
+
+#define IRQ_CTL_EN_TOUCH    (1 << 6)
+#define IRQ_CTL_EN_CHANGE   (1 << 5)
+#define IRQ_CTL_EN_MOTION   (1 << 4)
 
 static const char *TAG = "CST816S";
 
+typedef struct {
+    esp_lcd_touch_t base;
+    uint8_t gesture_id;     /* Gesture ID of the last reading, a gesture is reported once */
+} cst816s_t;
+
 static esp_err_t read_data(esp_lcd_touch_handle_t tp);
 static bool get_xy(esp_lcd_touch_handle_t tp, uint16_t *x, uint16_t *y, uint16_t *strength, uint8_t *point_num, uint8_t max_point_num);
 static esp_err_t del(esp_lcd_touch_handle_t tp);
 
 static esp_err_t i2c_read_bytes(esp_lcd_touch_handle_t tp, uint16_t reg, uint8_t *data, uint8_t len);
+static esp_err_t i2c_write_byte(esp_lcd_touch_handle_t tp, uint16_t reg, uint8_t data);
 
 static esp_err_t reset(esp_lcd_touch_handle_t tp);
 static esp_err_t read_id(esp_lcd_touch_handle_t tp);
+static esp_err_t apply_config(esp_lcd_touch_handle_t tp, const esp_lcd_touch_cst816s_config_t *cst816s_config);
 
 esp_err_t esp_lcd_touch_new_i2c_cst816s(const esp_lcd_panel_io_handle_t io, const esp_lcd_touch_config_t *config, esp_lcd_touch_handle_t *tp)
 {
@@ -41,8 +61,10 @@ esp_err_t esp_lcd_touch_new_i2c_cst816s(const esp_lcd_panel_io_handle_t io, cons
 
     /* Prepare main structure */
     esp_err_t ret = ESP_OK;
-    esp_lcd_touch_handle_t cst816s = calloc(1, sizeof(esp_lcd_touch_t));
-    ESP_GOTO_ON_FALSE(cst816s, ESP_ERR_NO_MEM, err, TAG, "Touch handle malloc failed");
+    /* The driver data follow the common structure, they are freed together with it */
+    cst816s_t *cst816s_priv = calloc(1, sizeof(cst816s_t));
+    ESP_GOTO_ON_FALSE(cst816s_priv, ESP_ERR_NO_MEM, err, TAG, "Touch handle malloc failed");
+    esp_lcd_touch_handle_t cst816s = &cst816s_priv->base;
 
     /* Communication interface */
     cst816s->io = io;
@@ -81,12 +103,16 @@ esp_err_t esp_lcd_touch_new_i2c_cst816s(const esp_lcd_panel_io_handle_t io, cons
     ESP_GOTO_ON_ERROR(reset(cst816s), err, TAG, "Reset failed");
     /* Read product id */
     ESP_GOTO_ON_ERROR(read_id(cst816s), err, TAG, "Read version failed");
+    /* Gestures and auto-sleep */
+    if (cst816s->config.driver_data) {
+        ESP_GOTO_ON_ERROR(apply_config(cst816s, (const esp_lcd_touch_cst816s_config_t *)cst816s->config.driver_data), err, TAG, "Configuration failed");
+    }
     *tp = cst816s;
 
     return ESP_OK;
 err:
-    if (cst816s) {
-        del(cst816s);
+    if (cst816s_priv) {
+        del(&cst816s_priv->base);
     }
     ESP_LOGE(TAG, "Initialization failed!");
     return ret;
@@ -95,6 +121,7 @@ err:
 static esp_err_t read_data(esp_lcd_touch_handle_t tp)
 {
     typedef struct {
+        uint8_t gesture_id;
         uint8_t num;
         uint8_t x_h : 4;
         uint8_t : 4;
@@ -107,7 +134,42 @@ static esp_err_t read_data(esp_lcd_touch_handle_t tp)
     data_t point;
     ESP_RETURN_ON_ERROR(i2c_read_bytes(tp, DATA_START_REG, (uint8_t *)&point, sizeof(data_t)), TAG, "I2C read failed");
 
+    /* Gesture IDs of the controller: slide up/down/left/right, click, double click and long press */
+    esp_lcd_touch_gesture_t gesture = ESP_LCD_TOUCH_GESTURE_NONE;
+    cst816s_t *cst816s = __containerof(tp, cst816s_t, base);
+    if (point.gesture_id != cst816s->gesture_id) {
+        switch (point.gesture_id) {
+        case 0x01:
+            gesture = ESP_LCD_TOUCH_GESTURE_SWIPE_UP;
+            break;
+        case 0x02:
+            gesture = ESP_LCD_TOUCH_GESTURE_SWIPE_DOWN;
+            break;
+        case 0x03:
+            gesture = ESP_LCD_TOUCH_GESTURE_SWIPE_LEFT;
+            break;
+        case 0x04:
+            gesture = ESP_LCD_TOUCH_GESTURE_SWIPE_RIGHT;
+            break;
+        case 0x05:
+            gesture = ESP_LCD_TOUCH_GESTURE_CLICK;
+            break;
+        case 0x0B:
+            gesture = ESP_LCD_TOUCH_GESTURE_DOUBLE_CLICK;
+            break;
+        case 0x0C:
+            gesture = ESP_LCD_TOUCH_GESTURE_LONG_PRESS;
+            break;
+        default:
+            break;
+        }
+        cst816s->gesture_id = point.gesture_id;
+    }
+
     portENTER_CRITICAL(&tp->data.lock);
+    if (gesture != ESP_LCD_TOUCH_GESTURE_NONE) {
+        tp->data.gesture = gesture;
+    }
     point.num = (point.num > POINT_NUM_MAX ? POINT_NUM_MAX : point.num);
     tp->data.points = point.num;
     /* Fill all coordinates */
@@ -178,9 +240,40 @@ static esp_err_t read_id(esp_lcd_touch_handle_t tp)
     return ESP_OK;
 }
 
+static esp_err_t apply_config(esp_lcd_touch_handle_t tp, const esp_lcd_touch_cst816s_config_t *cst816s_config)
+{
+    uint8_t motion_mask = 0;
+    if (cst816s_config->flags.double_click) {
+        motion_mask |= MOTION_MASK_EN_DCLICK;
+    }
+    if (cst816s_config->flags.continuous_ud) {
+        motion_mask |= MOTION_MASK_EN_CON_UD;
+    }
+    if (cst816s_config->flags.continuous_lr) {
+        motion_mask |= MOTION_MASK_EN_CON_LR;
+    }
+    ESP_RETURN_ON_ERROR(i2c_write_byte(tp, MOTION_MASK_REG, motion_mask), TAG, "I2C write failed");
+
+    /* Interrupt also on detected gesture, so the gesture is read without polling */
+    const uint8_t irq_ctl = IRQ_CTL_EN_TOUCH | IRQ_CTL_EN_CHANGE | (cst816s_config->flags.gesture ? IRQ_CTL_EN_MOTION : 0);
+    ESP_RETURN_ON_ERROR(i2c_write_byte(tp, IRQ_CTL_REG, irq_ctl), TAG, "I2C write failed");
+
+    if (cst816s_config->auto_sleep_s > 0) {
+        ESP_RETURN_ON_ERROR(i2c_write_byte(tp, AUTO_SLEEP_TIME_REG, cst816s_config->auto_sleep_s), TAG, "I2C write failed");
+    }
+    ESP_RETURN_ON_ERROR(i2c_write_byte(tp, DIS_AUTO_SLEEP_REG, cst816s_config->flags.disable_auto_sleep ? 0x01 : 0x00), TAG, "I2C write failed");
+
+    return ESP_OK;
+}
+
 static esp_err_t i2c_read_bytes(esp_lcd_touch_handle_t tp, uint16_t reg, uint8_t *data, uint8_t len)
 {
     ESP_RETURN_ON_FALSE(data, ESP_ERR_INVALID_ARG, TAG, "Invalid data");
 
     return esp_lcd_panel_io_rx_param(tp->io, reg, data, len);
 }
+
+static esp_err_t i2c_write_byte(esp_lcd_touch_handle_t tp, uint16_t reg, uint8_t data)
+{
+    return esp_lcd_panel_io_tx_param(tp->io, reg, &data, 1);
+}
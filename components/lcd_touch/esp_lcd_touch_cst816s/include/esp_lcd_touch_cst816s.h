@@ -17,6 +17,22 @@
 extern "C" {
 #endif
 
+/**
+ * @brief CST816S Configuration Type (optional, set in `driver_data` of `esp_lcd_touch_config_t`)
+ *
+ * Without it, the controller keeps its default configuration.
+ */
+typedef struct {
+    struct {
+        unsigned int gesture: 1;            /*!< Interrupt also on detected gesture (read by `esp_lcd_touch_get_gesture`) */
+        unsigned int double_click: 1;       /*!< Detect double click (motion mask) */
+        unsigned int continuous_ud: 1;      /*!< Report up and down swipes repeatedly while the finger moves (motion mask) */
+        unsigned int continuous_lr: 1;      /*!< Report left and right swipes repeatedly while the finger moves (motion mask) */
+        unsigned int disable_auto_sleep: 1; /*!< Controller does not enter its low-power standby without touch */
+    } flags;
+    uint8_t auto_sleep_s;   /*!< Time without touch before the controller enters its low-power standby [s] (0: controller default) */
+} esp_lcd_touch_cst816s_config_t;
+
 /**
  * @brief Create a new CST816S touch driver
  *
@@ -15,6 +15,7 @@
 #include "driver/gpio.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_touch.h"
+#include "esp_lcd_touch_ft5x06.h"
 
 static const char *TAG = "FT5x06";
 
@@ -80,6 +81,7 @@ static const char *TAG = "FT5x06";
 static esp_err_t esp_lcd_touch_ft5x06_read_data(esp_lcd_touch_handle_t tp);
 static bool esp_lcd_touch_ft5x06_get_xy(esp_lcd_touch_handle_t tp, uint16_t *x, uint16_t *y, uint16_t *strength, uint8_t *point_num, uint8_t max_point_num);
 static esp_err_t esp_lcd_touch_ft5x06_del(esp_lcd_touch_handle_t tp);
+static esp_err_t esp_lcd_touch_ft5x06_set_active_scan(esp_lcd_touch_handle_t tp, bool active);
 
 /* I2C read */
 static esp_err_t touch_ft5x06_i2c_write(esp_lcd_touch_handle_t tp, uint8_t reg, uint8_t data);
@@ -112,6 +114,7 @@ esp_err_t esp_lcd_touch_new_i2c_ft5x06(const esp_lcd_panel_io_handle_t io, const
     esp_lcd_touch_ft5x06->read_data = esp_lcd_touch_ft5x06_read_data;
     esp_lcd_touch_ft5x06->get_xy = esp_lcd_touch_ft5x06_get_xy;
     esp_lcd_touch_ft5x06->del = esp_lcd_touch_ft5x06_del;
+    esp_lcd_touch_ft5x06->set_active_scan = esp_lcd_touch_ft5x06_set_active_scan;
 
     /* Mutex */
     esp_lcd_touch_ft5x06->data.lock.owner = portMUX_FREE_VAL;
@@ -169,24 +172,25 @@ err:
 static esp_err_t esp_lcd_touch_ft5x06_read_data(esp_lcd_touch_handle_t tp)
 {
     esp_err_t err;
-    uint8_t data[30];
+    uint8_t buf[31];
     uint8_t points;
     size_t i = 0;
+    /* Count of points and points are read in one transaction, only points which can be saved (up to 5 points of FT5x06) */
+    const uint8_t burst_points = (CONFIG_ESP_LCD_TOUCH_MAX_POINTS < 5 ? CONFIG_ESP_LCD_TOUCH_MAX_POINTS : 5);
 
     assert(tp != NULL);
 
-    err = touch_ft5x06_i2c_read(tp, FT5x06_TOUCH_POINTS, &points, 1);
+    err = touch_ft5x06_i2c_read(tp, FT5x06_TOUCH_POINTS, buf, 1 + 6 * burst_points);
     ESP_RETURN_ON_ERROR(err, TAG, "I2C read error!");
 
+    points = buf[0];
     if (points > 5 || points == 0) {
         return ESP_OK;
     }
 
     /* Number of touched points */
-    points = (points > CONFIG_ESP_LCD_TOUCH_MAX_POINTS ? CONFIG_ESP_LCD_TOUCH_MAX_POINTS : points);
-
-    err = touch_ft5x06_i2c_read(tp, FT5x06_TOUCH1_XH, data, 6 * points);
-    ESP_RETURN_ON_ERROR(err, TAG, "I2C read error!");
+    points = (points > burst_points ? burst_points : points);
+    const uint8_t *data = &buf[FT5x06_TOUCH1_XH - FT5x06_TOUCH_POINTS];
 
     portENTER_CRITICAL(&tp->data.lock);
 
@@ -234,6 +238,14 @@ static bool esp_lcd_touch_ft5x06_get_xy(esp_lcd_touch_handle_t tp, uint16_t *x,
     return (*point_num > 0);
 }
 
+static esp_err_t esp_lcd_touch_ft5x06_set_active_scan(esp_lcd_touch_handle_t tp, bool active)
+{
+    assert(tp != NULL);
+
+    /* 0: keep active mode, 1: switch to monitor mode when there is no touch */
+    return touch_ft5x06_i2c_write(tp, FT5x06_ID_G_CTRL, (active ? 0 : 1));
+}
+
 static esp_err_t esp_lcd_touch_ft5x06_del(esp_lcd_touch_handle_t tp)
 {
     assert(tp != NULL);
@@ -263,12 +275,29 @@ static esp_err_t esp_lcd_touch_ft5x06_del(esp_lcd_touch_handle_t tp)
 static esp_err_t touch_ft5x06_init(esp_lcd_touch_handle_t tp)
 {
     esp_err_t ret = ESP_OK;
+    esp_lcd_touch_io_ft5x06_config_t cfg = {
+        .period_active = 12,
+        .period_monitor = 40,
+        .time_enter_monitor = 2,
+        .threshold_group = 70,
+        .threshold_peak = 60,
+    };
+    const esp_lcd_touch_io_ft5x06_config_t *ft5x06_config = (const esp_lcd_touch_io_ft5x06_config_t *)tp->config.driver_data;
+    if (ft5x06_config) {
+        ESP_RETURN_ON_FALSE(ft5x06_config->period_active == 0 || (ft5x06_config->period_active >= 3 && ft5x06_config->period_active <= 14),
+                            ESP_ERR_INVALID_ARG, TAG, "Invalid active period");
+        cfg.period_active = (ft5x06_config->period_active ? ft5x06_config->period_active : cfg.period_active);
+        cfg.period_monitor = (ft5x06_config->period_monitor ? ft5x06_config->period_monitor : cfg.period_monitor);
+        cfg.time_enter_monitor = (ft5x06_config->time_enter_monitor ? ft5x06_config->time_enter_monitor : cfg.time_enter_monitor);
+        cfg.threshold_group = (ft5x06_config->threshold_group ? ft5x06_config->threshold_group : cfg.threshold_group);
+        cfg.threshold_peak = (ft5x06_config->threshold_peak ? ft5x06_config->threshold_peak : cfg.threshold_peak);
+    }
 
     // Valid touching detect threshold
-    ret |= touch_ft5x06_i2c_write(tp, FT5x06_ID_G_THGROUP, 70);
+    ret |= touch_ft5x06_i2c_write(tp, FT5x06_ID_G_THGROUP, cfg.threshold_group);
 
     // valid touching peak detect threshold
-    ret |= touch_ft5x06_i2c_write(tp, FT5x06_ID_G_THPEAK, 60);
+    ret |= touch_ft5x06_i2c_write(tp, FT5x06_ID_G_THPEAK, cfg.threshold_peak);
 
     // Touch focus threshold
     ret |= touch_ft5x06_i2c_write(tp, FT5x06_ID_G_THCAL, 16);
@@ -283,13 +312,13 @@ static esp_err_t touch_ft5x06_init(esp_lcd_touch_handle_t tp)
     ret |= touch_ft5x06_i2c_write(tp, FT5x06_ID_G_THDIFF, 20);
 
     // Delay to enter 'Monitor' status (s)
-    ret |= touch_ft5x06_i2c_write(tp, FT5x06_ID_G_TIME_ENTER_MONITOR, 2);
+    ret |= touch_ft5x06_i2c_write(tp, FT5x06_ID_G_TIME_ENTER_MONITOR, cfg.time_enter_monitor);
 
     // Period of 'Active' status (ms)
-    ret |= touch_ft5x06_i2c_write(tp, FT5x06_ID_G_PERIODACTIVE, 12);
+    ret |= touch_ft5x06_i2c_write(tp, FT5x06_ID_G_PERIODACTIVE, cfg.period_active);
 
-    // Timer to enter 'idle' when in 'Monitor' (ms)
-    ret |= touch_ft5x06_i2c_write(tp, FT5x06_ID_G_PERIODMONITOR, 40);
+    // Period of 'Monitor' status (ms)
+    ret |= touch_ft5x06_i2c_write(tp, FT5x06_ID_G_PERIODMONITOR, cfg.period_monitor);
 
     return ret;
 }
@@ -17,6 +17,19 @@
 extern "C" {
 #endif
 
+/**
+ * @brief FT5x06 Configuration Type (optional, set in `driver_data` of `esp_lcd_touch_config_t`)
+ *
+ * Zero fields keep the default values of the driver.
+ */
+typedef struct {
+    uint8_t period_active;      /*!< Scan period in active mode [ms] (3-14, 0: 12) */
+    uint8_t period_monitor;     /*!< Scan period in monitor mode [ms] (0: 40) */
+    uint8_t time_enter_monitor; /*!< Time without touch before entering monitor mode [s] (0: 2) */
+    uint8_t threshold_group;    /*!< Touch detection threshold (0: 70) */
+    uint8_t threshold_peak;     /*!< Touch peak detection threshold (0: 60) */
+} esp_lcd_touch_io_ft5x06_config_t;
+
 /**
  * @brief Create a new FT5x06 touch driver
  *
@@ -213,10 +213,12 @@ static esp_err_t esp_lcd_touch_gt911_read_data(esp_lcd_touch_handle_t tp)
     uint8_t touch_cnt = 0;
     uint8_t clear = 0;
     size_t i = 0;
+    /* Status and points are read in one transaction, only points which can be saved (up to 5 points of GT911) */
+    const uint8_t burst_points = (CONFIG_ESP_LCD_TOUCH_MAX_POINTS < 5 ? CONFIG_ESP_LCD_TOUCH_MAX_POINTS : 5);
 
     assert(tp != NULL);
 
-    err = touch_gt911_i2c_read(tp, ESP_LCD_TOUCH_GT911_READ_XY_REG, buf, 1);
+    err = touch_gt911_i2c_read(tp, ESP_LCD_TOUCH_GT911_READ_XY_REG, buf, 1 + burst_points * 8);
     ESP_RETURN_ON_ERROR(err, TAG, "I2C read error!");
 
     /* Any touch data? */
@@ -259,11 +261,7 @@ static esp_err_t esp_lcd_touch_gt911_read_data(esp_lcd_touch_handle_t tp)
             return ESP_OK;
         }
 
-        /* Read all points */
-        err = touch_gt911_i2c_read(tp, ESP_LCD_TOUCH_GT911_READ_XY_REG + 1, &buf[1], touch_cnt * 8);
-        ESP_RETURN_ON_ERROR(err, TAG, "I2C read error!");
-
-        /* Clear all */
+        /* Points were read with the status, the clear cannot be merged into the read */
         err = touch_gt911_i2c_write(tp, ESP_LCD_TOUCH_GT911_READ_XY_REG, clear);
         ESP_RETURN_ON_ERROR(err, TAG, "I2C read error!");
 
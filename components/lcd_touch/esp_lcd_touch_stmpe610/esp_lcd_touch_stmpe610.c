@@ -48,6 +48,7 @@ static const char *TAG = "STMPE610";
 #define ESP_LCD_TOUCH_STMPE610_REG_ADC_CTRL2_6_5MHZ   (0x02)
 
 #define ESP_LCD_TOUCH_STMPE610_REG_TSC_CFG_4SAMPLE    (0x80)
+#define ESP_LCD_TOUCH_STMPE610_REG_TSC_CFG_AVE_SHIFT  (6)
 #define ESP_LCD_TOUCH_STMPE610_REG_TSC_CFG_DELAY_1MS  (0x20)
 #define ESP_LCD_TOUCH_STMPE610_REG_TSC_CFG_SETTLE_5MS (0x04)
 
@@ -60,6 +61,12 @@ static const char *TAG = "STMPE610";
 #define ESP_LCD_TOUCH_STMPE610_REG_INT_CTRL_EDGE      (0x02)
 #define ESP_LCD_TOUCH_STMPE610_REG_INT_CTRL_ENABLE    (0x01)
 
+#define ESP_LCD_TOUCH_STMPE610_REG_INT_EN_TOUCH_DET   (0x01)
+#define ESP_LCD_TOUCH_STMPE610_REG_INT_EN_FIFO_TH     (0x02)
+
+/* Maximum FIFO threshold (FIFO has 128 samples) */
+#define ESP_LCD_TOUCH_STMPE610_FIFO_TH_MAX            (127)
+
 
 /*******************************************************************************
 * Function definitions
@@ -158,22 +165,15 @@ err:
 
 static esp_err_t esp_lcd_touch_stmpe610_read_data(esp_lcd_touch_handle_t tp)
 {
-    uint8_t buf[100];
-    uint16_t x = 0;
-    uint16_t y = 0;
-    uint16_t z = 0;
+    uint8_t buf[4];
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t z = 0;
     uint8_t cnt = 0;
-    uint8_t fifo_status = 0;
 
     assert(tp != NULL);
 
-    /* Read fifo status */
-    ESP_RETURN_ON_ERROR(touch_stmpe610_read(tp, ESP_LCD_TOUCH_STMPE610_REG_FIFO_STA, (uint8_t *)&fifo_status, 1), TAG, "STMPE610 read error!");
-    if (fifo_status & ESP_LCD_TOUCH_STMPE610_REG_FIFO_STA_EMPTY) {
-        return ESP_OK;
-    }
-
-    /* Read count of samples */
+    /* Read count of samples (empty FIFO has zero size, FIFO status is not needed) */
     ESP_RETURN_ON_ERROR(touch_stmpe610_read(tp, ESP_LCD_TOUCH_STMPE610_REG_FIFO_SIZE, (uint8_t *)&cnt, 1), TAG, "STMPE610 read error!");
     if (cnt == 0) {
         return ESP_OK;
@@ -193,9 +193,7 @@ static esp_err_t esp_lcd_touch_stmpe610_read_data(esp_lcd_touch_handle_t tp)
         z += buf[3];
     }
 
-    /* Reset FIFO */
-    ESP_RETURN_ON_ERROR(touch_stmpe610_write(tp, ESP_LCD_TOUCH_STMPE610_REG_FIFO_STA, ESP_LCD_TOUCH_STMPE610_REG_FIFO_STA_RESET), TAG, "STMPE610 write error!");
-    ESP_RETURN_ON_ERROR(touch_stmpe610_write(tp, ESP_LCD_TOUCH_STMPE610_REG_FIFO_STA, 0), TAG, "STMPE610 write error!");
+    /* FIFO is drained by reading, samples arrived in the meantime are read next time */
     /* Reset all ints */
     ESP_RETURN_ON_ERROR(touch_stmpe610_write(tp, ESP_LCD_TOUCH_STMPE610_REG_INT_STA, 0xFF), TAG, "STMPE610 write error!");
 
@@ -270,6 +268,21 @@ static esp_err_t touch_stmpe610_init(esp_lcd_touch_handle_t tp)
 {
     assert(tp != NULL);
 
+    /* Default: interrupt on each sample, averaging of 4 samples */
+    uint8_t fifo_th = 1;
+    uint8_t ave = ESP_LCD_TOUCH_STMPE610_AVERAGE_4;
+    uint8_t int_en = ESP_LCD_TOUCH_STMPE610_REG_INT_EN_TOUCH_DET;
+    const esp_lcd_touch_io_stmpe610_config_t *stmpe610_config = (const esp_lcd_touch_io_stmpe610_config_t *)tp->config.driver_data;
+    if (stmpe610_config) {
+        ESP_RETURN_ON_FALSE(stmpe610_config->fifo_threshold <= ESP_LCD_TOUCH_STMPE610_FIFO_TH_MAX, ESP_ERR_INVALID_ARG, TAG, "FIFO threshold is too big");
+        ave = stmpe610_config->average;
+        if (stmpe610_config->fifo_threshold > 0) {
+            /* Interrupt after the threshold, the whole FIFO is read at once */
+            fifo_th = stmpe610_config->fifo_threshold;
+            int_en |= ESP_LCD_TOUCH_STMPE610_REG_INT_EN_FIFO_TH;
+        }
+    }
+
     if (tp->config.rst_gpio_num != GPIO_NUM_NC) {
         ESP_RETURN_ON_ERROR(gpio_set_level(tp->config.rst_gpio_num, tp->config.levels.reset), TAG, "GPIO set level error!");
         vTaskDelay(pdMS_TO_TICKS(10));
@@ -285,15 +298,16 @@ static esp_err_t touch_stmpe610_init(esp_lcd_touch_handle_t tp)
 
     /* XYZ and enable */
     touch_stmpe610_write(tp, ESP_LCD_TOUCH_STMPE610_REG_TSC_CTRL, ESP_LCD_TOUCH_STMPE610_REG_TSC_CTRL_XYZ | ESP_LCD_TOUCH_STMPE610_REG_TSC_CTRL_EN);
-    touch_stmpe610_write(tp, ESP_LCD_TOUCH_STMPE610_REG_INT_EN, 0x01);
+    touch_stmpe610_write(tp, ESP_LCD_TOUCH_STMPE610_REG_INT_EN, int_en);
 
     /* 96 clocks per conversion */
     touch_stmpe610_write(tp, ESP_LCD_TOUCH_STMPE610_REG_ADC_CTRL1, ESP_LCD_TOUCH_STMPE610_REG_ADC_CTRL1_10BIT | (0x6 << 4));
     touch_stmpe610_write(tp, ESP_LCD_TOUCH_STMPE610_REG_ADC_CTRL2, ESP_LCD_TOUCH_STMPE610_REG_ADC_CTRL2_6_5MHZ);
 
-    touch_stmpe610_write(tp, ESP_LCD_TOUCH_STMPE610_REG_TSC_CFG, ESP_LCD_TOUCH_STMPE610_REG_TSC_CFG_4SAMPLE | ESP_LCD_TOUCH_STMPE610_REG_TSC_CFG_DELAY_1MS | ESP_LCD_TOUCH_STMPE610_REG_TSC_CFG_SETTLE_5MS);
+    /* Each sample in FIFO is averaged by HW */
+    touch_stmpe610_write(tp, ESP_LCD_TOUCH_STMPE610_REG_TSC_CFG, ((ave & 0x3) << ESP_LCD_TOUCH_STMPE610_REG_TSC_CFG_AVE_SHIFT) | ESP_LCD_TOUCH_STMPE610_REG_TSC_CFG_DELAY_1MS | ESP_LCD_TOUCH_STMPE610_REG_TSC_CFG_SETTLE_5MS);
     touch_stmpe610_write(tp, ESP_LCD_TOUCH_STMPE610_REG_TSC_FRACTION_Z, 0x6);
-    touch_stmpe610_write(tp, ESP_LCD_TOUCH_STMPE610_REG_FIFO_TH, 1);
+    touch_stmpe610_write(tp, ESP_LCD_TOUCH_STMPE610_REG_FIFO_TH, fifo_th);
 
     /* Reset FIFO */
     touch_stmpe610_write(tp, ESP_LCD_TOUCH_STMPE610_REG_FIFO_STA, ESP_LCD_TOUCH_STMPE610_REG_FIFO_STA_RESET);
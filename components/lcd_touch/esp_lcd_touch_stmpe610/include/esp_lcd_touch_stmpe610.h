@@ -17,6 +17,26 @@
 extern "C" {
 #endif
 
+/**
+ * @brief STMPE610 HW averaging of the samples
+ *
+ */
+typedef enum {
+    ESP_LCD_TOUCH_STMPE610_AVERAGE_1 = 0,   /*!< No averaging */
+    ESP_LCD_TOUCH_STMPE610_AVERAGE_2,       /*!< Average of 2 samples */
+    ESP_LCD_TOUCH_STMPE610_AVERAGE_4,       /*!< Average of 4 samples (default) */
+    ESP_LCD_TOUCH_STMPE610_AVERAGE_8,       /*!< Average of 8 samples */
+} esp_lcd_touch_stmpe610_average_t;
+
+/**
+ * @brief STMPE610 Configuration Type (optional, set in `driver_data` of `esp_lcd_touch_config_t`)
+ *
+ */
+typedef struct {
+    uint8_t fifo_threshold;     /*!< Count of samples in FIFO for interrupt (1-127), 0: interrupt on each touch detection (default) */
+    esp_lcd_touch_stmpe610_average_t average;   /*!< HW averaging of each sample */
+} esp_lcd_touch_io_stmpe610_config_t;
+
 /**
  * @brief Create a new STMPE610 touch driver
  *
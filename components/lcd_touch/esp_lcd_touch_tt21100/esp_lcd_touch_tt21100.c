@@ -18,6 +18,8 @@
 static const char *TAG = "TT21100";
 
 #define ESP_LCD_TOUCH_TT21100_MAX_DATA_LEN  (7+CONFIG_ESP_LCD_TOUCH_MAX_POINTS*10) /* 7 Header + (Points * 10 data bytes) */
+/* Length of the first read: header and two points cover reports of the most touches and buttons (14 bytes) */
+#define ESP_LCD_TOUCH_TT21100_FIRST_READ_LEN ((7+2*10) < ESP_LCD_TOUCH_TT21100_MAX_DATA_LEN ? (7+2*10) : ESP_LCD_TOUCH_TT21100_MAX_DATA_LEN)
 
 /*******************************************************************************
 * Function definitions
@@ -185,22 +187,26 @@ static esp_err_t esp_lcd_touch_tt21100_read_data(esp_lcd_touch_handle_t tp)
 #endif
 
     esp_err_t err;
-    static uint16_t data_len;
-    static uint8_t data[ESP_LCD_TOUCH_TT21100_MAX_DATA_LEN];
+    uint16_t data_len;
+    uint8_t data[ESP_LCD_TOUCH_TT21100_MAX_DATA_LEN];
     uint8_t tp_num = 0;
     size_t i = 0;
 
     assert(tp != NULL);
 
-    /* Get report data length */
-    err = touch_tt21100_i2c_read(tp, (uint8_t *)&data_len, sizeof(data_len));
+    /* Each read starts at the length of the report, so the length and a report of up to two points are read in one transaction */
+    err = touch_tt21100_i2c_read(tp, data, ESP_LCD_TOUCH_TT21100_FIRST_READ_LEN);
     ESP_RETURN_ON_ERROR(err, TAG, "I2C read error!");
+    data_len = data[0] | (data[1] << 8);
 
-    /* Read report data if length */
-    if (data_len > 0 && data_len < sizeof(data)) {
-        touch_tt21100_i2c_read(tp, data, data_len);
+    /* Longer report (more points) is read again whole */
+    if (data_len > ESP_LCD_TOUCH_TT21100_FIRST_READ_LEN && data_len <= sizeof(data)) {
+        err = touch_tt21100_i2c_read(tp, data, data_len);
         ESP_RETURN_ON_ERROR(err, TAG, "I2C read error!");
+    }
 
+    /* Parse report data if length */
+    if (data_len > 2 && data_len <= sizeof(data)) {
         portENTER_CRITICAL(&tp->data.lock);
 
         if (data_len == 14) {
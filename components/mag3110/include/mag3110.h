@@ -16,6 +16,8 @@ extern "C" {
 #endif
 
 #include "driver/i2c.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
 
 /**
 * @brief Device Identification value
@@ -71,6 +73,40 @@ typedef enum {
     MAG3110_DR_OS_0_08_128 = 0xF8
 } mag3110_data_rate_t;
 
+/**
+ * @brief Calibration state tracked from the measured samples
+ *
+ * All values are in units of 0.1uT.
+ */
+typedef struct {
+    int16_t offset[3];  /*!< Hard-iron offset of X, Y and Z axis; center of the min/max envelope */
+    int16_t radius[3];  /*!< Half of the min/max span of X, Y and Z axis */
+    int16_t avg_radius; /*!< Average of the radii, all axes are scaled to it with valid calibration */
+    bool valid;         /*!< All axes were rotated through enough field for soft-iron scaling */
+} mag3110_calibration_t;
+
+/**
+ * @brief Callback with new magnetometer data
+ *
+ * Called from the streaming task, not from ISR.
+ *
+ * @param[in] data Magnetic induction in units of 0.1uT
+ * @param[in] user_ctx User context from the stream configuration
+ */
+typedef void (*mag3110_data_cb_t)(const mag3110_result_t *data, void *user_ctx);
+
+/**
+ * @brief Data-ready streaming configuration
+ */
+typedef struct {
+    gpio_num_t int_pin;            /*!< GPIO connected to INT1 of MAG3110 */
+    mag3110_data_rate_t data_rate; /*!< Data rate and oversampling settings */
+    bool auto_calibration;         /*!< Run in raw mode and correct the data with calibration tracked from the stream */
+    mag3110_data_cb_t data_cb;     /*!< Called with every new sample */
+    void *user_ctx;                /*!< Passed to data_cb */
+    UBaseType_t task_priority;     /*!< Priority of the streaming task */
+} mag3110_stream_config_t;
+
 /**
  * @brief Create and init sensor object and return a sensor handle
  *
@@ -154,6 +190,7 @@ esp_err_t mag3110_get_magnetic_induction(mag3110_handle_t sensor, mag3110_result
  * @brief Calibrate MAG3110 for a hard-iron offset
  *
  * This function will detect offsets in MAG3110 reading (caused by hard-iron or PCB influence) and store it in MAG3110 registers.
+ * The samples are read by the calling task at 80Hz, which is blocked for cal_duration_ms.
  *
  * During the calibration, the user must keep rotating the sensor in every axis to guarantee correct result.
  *
@@ -165,6 +202,64 @@ esp_err_t mag3110_get_magnetic_induction(mag3110_handle_t sensor, mag3110_result
  */
 esp_err_t mag3110_calibrate(mag3110_handle_t sensor, const uint32_t cal_duration_ms);
 
+/**
+ * @brief Get calibration tracked by the driver
+ *
+ * The calibration is updated by mag3110_calibrate() and by streaming with auto_calibration enabled.
+ *
+ * @param sensor MAG3110 handle
+ * @param[out] cal Current calibration
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Invalid parameter
+ */
+esp_err_t mag3110_get_calibration(mag3110_handle_t sensor, mag3110_calibration_t *const cal);
+
+/**
+ * @brief Forget calibration tracked by the driver
+ *
+ * Call this when the magnetic surroundings of the sensor changed. Offset registers of MAG3110 are not changed.
+ *
+ * @param sensor MAG3110 handle
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Invalid parameter
+ */
+esp_err_t mag3110_reset_calibration(mag3110_handle_t sensor);
+
+/**
+ * @brief Start streaming driven by data-ready interrupt
+ *
+ * MAG3110 is started with the configured data rate. On every rising edge of INT1 a task reads X, Y and Z in one burst
+ * and passes them to the callback. With auto_calibration the sensor runs in raw mode, every sample updates
+ * the calibration and the callback receives corrected data.
+ *
+ * @note GPIO ISR service must be installed by gpio_install_isr_service() before calling this function
+ * @note While streaming, the I2C bus is accessed by the streaming task. Do not call other functions that access the sensor.
+ *
+ * @param sensor MAG3110 handle
+ * @param[in] config Streaming configuration
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Invalid parameter
+ *     - ESP_ERR_INVALID_STATE Streaming is already running
+ *     - ESP_ERR_NO_MEM Not enough memory for the task
+ *     - Else   Fail
+ */
+esp_err_t mag3110_stream_start(mag3110_handle_t sensor, const mag3110_stream_config_t *const config);
+
+/**
+ * @brief Stop streaming and put MAG3110 to standby
+ *
+ * @param sensor MAG3110 handle
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Invalid parameter
+ *     - ESP_ERR_INVALID_STATE Streaming is not running
+ *     - Else   Fail
+ */
+esp_err_t mag3110_stream_stop(mag3110_handle_t sensor);
+
 #ifdef __cplusplus
 }
 #endif
@@ -6,8 +6,9 @@
 
 #include "mag3110.h"
 #include "esp_log.h"
-#include "esp_timer.h" // for calibration function
-#include "esp_idf_version.h" // for backward compatibility of esp-timer
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 
 #define MAG3110_I2C_ADDRESS 0x0Eu // MAG3110 constant address
 #define MAG3110_OUT_X_MSB   0x01u
@@ -23,20 +24,30 @@
 #define MAG3110_AUTO_MRST_EN 0x80u
 #define MAG3110_RAW_DATA     0x20u
 
+// Span of one axis [0.1uT] needed for valid calibration, earth field is 25-65uT
+#define MAG3110_CAL_MIN_SPAN 400
+
 typedef struct {
     i2c_port_t bus;
     uint16_t dev_addr;
+    uint8_t cmd_buf[I2C_LINK_RECOMMENDED_SIZE(2)]; /* Command link of the device, no heap allocation per access */
 
     // calibration data
     int16_t max[3];
     int16_t min[3];
+
+    // data-ready streaming
+    TaskHandle_t stream_task;
+    SemaphoreHandle_t stream_done;
+    volatile bool stream_running;
+    mag3110_stream_config_t stream_config;
 } mag3110_dev_t;
 
 static esp_err_t mag3110_write(mag3110_handle_t sensor, const uint8_t reg_start_addr, const uint8_t *const data_buf, const uint8_t data_len)
 {
     mag3110_dev_t *sens = (mag3110_dev_t *) sensor;
     esp_err_t  ret;
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(sens->cmd_buf, sizeof(sens->cmd_buf));
     ret = i2c_master_start(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_write_byte(cmd, sens->dev_addr | I2C_MASTER_WRITE, true);
@@ -48,7 +59,7 @@ static esp_err_t mag3110_write(mag3110_handle_t sensor, const uint8_t reg_start_
     ret = i2c_master_stop(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_cmd_begin(sens->bus, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
+    i2c_cmd_link_delete_static(cmd);
 
     return ret;
 }
@@ -57,7 +68,7 @@ static esp_err_t mag3110_read(mag3110_handle_t sensor, const uint8_t reg_start_a
 {
     mag3110_dev_t *sens = (mag3110_dev_t *) sensor;
     esp_err_t ret;
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(sens->cmd_buf, sizeof(sens->cmd_buf));
     ret = i2c_master_start(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_write_byte(cmd, sens->dev_addr | I2C_MASTER_WRITE, true);
@@ -73,22 +84,36 @@ static esp_err_t mag3110_read(mag3110_handle_t sensor, const uint8_t reg_start_a
     ret = i2c_master_stop(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_cmd_begin(sens->bus, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
+    i2c_cmd_link_delete_static(cmd);
 
     return ret;
 }
 
+static void mag3110_cal_reset(mag3110_dev_t *sens)
+{
+    for (int i = 0; i < 3; i++) {
+        sens->max[i] = INT16_MIN;
+        sens->min[i] = INT16_MAX;
+    }
+}
+
 mag3110_handle_t mag3110_create(const i2c_port_t port)
 {
     mag3110_dev_t *sensor = (mag3110_dev_t *) calloc(1, sizeof(mag3110_dev_t));
     sensor->bus = port;
     sensor->dev_addr = MAG3110_I2C_ADDRESS << 1;
+    mag3110_cal_reset(sensor);
     return (mag3110_handle_t) sensor;
 }
 
 void mag3110_delete(mag3110_handle_t sensor)
 {
     mag3110_dev_t *sens = (mag3110_dev_t *) sensor;
+
+    // stop data-ready streaming if it was started
+    if (sens->stream_task != NULL) {
+        mag3110_stream_stop(sensor);
+    }
     free(sens);
 }
 
@@ -139,13 +164,9 @@ esp_err_t mag3110_get_magnetic_induction(mag3110_handle_t sensor, mag3110_result
     return ret;
 }
 
-static void mag3110_timer_callback(void *arg)
+static void mag3110_cal_update(mag3110_dev_t *sens, const mag3110_result_t *const mag_data)
 {
-    mag3110_dev_t *sens = (mag3110_dev_t *) arg;
-    mag3110_result_t mag_data; // raw data from the magnetometer
-    int16_t *axis_data = &mag_data.x; // we will iterate through struct members, so pointer to it is useful
-
-    mag3110_get_magnetic_induction((mag3110_handle_t)arg, &mag_data);
+    const int16_t *axis_data = &mag_data->x; // we will iterate through struct members, so pointer to it is useful
 
     // compare the new data to stored min/max values
     for (int i = 0; i < 3; i++, axis_data++) {
@@ -158,6 +179,61 @@ static void mag3110_timer_callback(void *arg)
     }
 }
 
+static void mag3110_cal_get(const mag3110_dev_t *sens, mag3110_calibration_t *const cal)
+{
+    int32_t radius_sum = 0;
+
+    cal->valid = true;
+    for (int i = 0; i < 3; i++) {
+        if (sens->max[i] < sens->min[i]) { // no data yet
+            cal->offset[i] = 0;
+            cal->radius[i] = 0;
+            cal->valid = false;
+            continue;
+        }
+        cal->offset[i] = ((int32_t)sens->max[i] + sens->min[i]) / 2;
+        cal->radius[i] = ((int32_t)sens->max[i] - sens->min[i]) / 2;
+        if (2 * cal->radius[i] < MAG3110_CAL_MIN_SPAN) {
+            cal->valid = false;
+        }
+        radius_sum += cal->radius[i];
+    }
+    cal->avg_radius = radius_sum / 3;
+}
+
+/* Hard-iron offset is always removed, soft-iron scaling is applied with valid calibration only */
+static void mag3110_cal_apply(const mag3110_calibration_t *const cal, const mag3110_result_t *const raw, mag3110_result_t *const result)
+{
+    const int16_t *raw_axis = &raw->x;
+    int16_t *result_axis = &result->x;
+
+    for (int i = 0; i < 3; i++) {
+        int32_t value = (int32_t)raw_axis[i] - cal->offset[i];
+        if (cal->valid) {
+            value = value * cal->avg_radius / cal->radius[i];
+        }
+        result_axis[i] = value;
+    }
+}
+
+esp_err_t mag3110_get_calibration(mag3110_handle_t sensor, mag3110_calibration_t *const cal)
+{
+    if (NULL == sensor || NULL == cal) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    mag3110_cal_get((mag3110_dev_t *) sensor, cal);
+    return ESP_OK;
+}
+
+esp_err_t mag3110_reset_calibration(mag3110_handle_t sensor)
+{
+    if (NULL == sensor) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    mag3110_cal_reset((mag3110_dev_t *) sensor);
+    return ESP_OK;
+}
+
 esp_err_t mag3110_calibrate(mag3110_handle_t sensor, const uint32_t cal_duration_ms)
 {
     esp_err_t ret;
@@ -167,12 +243,12 @@ esp_err_t mag3110_calibrate(mag3110_handle_t sensor, const uint32_t cal_duration
     if (NULL == sensor) {
         return ESP_ERR_INVALID_ARG;
     }
+    if (sens->stream_task != NULL) {
+        return ESP_ERR_INVALID_STATE; // streaming calibrates continuously
+    }
 
     // initialize calibration values to their starting point
-    for (int i = 0; i < 3; i++) {
-        sens->max[i] = INT16_MIN;
-        sens->min[i] = INT16_MAX;
-    }
+    mag3110_cal_reset(sens);
 
     // reset MAG3110 to factory default
     ctrl_reg[0] = MAG3110_STANDBY_MODE;
@@ -188,31 +264,20 @@ esp_err_t mag3110_calibrate(mag3110_handle_t sensor, const uint32_t cal_duration
 
     vTaskDelay(100 / portTICK_PERIOD_MS); // Wait for start-up
 
-    const esp_timer_create_args_t cal_timer_config = {
-        .callback = mag3110_timer_callback,
-        .arg = sensor,
-        .name = "MAG3110 calibration timer",
-#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0)
-        .skip_unhandled_events = true,
-#endif
-        .dispatch_method = ESP_TIMER_TASK
-    };
-    esp_timer_handle_t cal_timer = NULL;
-    ret = esp_timer_create(&cal_timer_config, &cal_timer);
-    assert(ESP_OK == ret);
-    ESP_LOGI("MAG3110", "Entering calibration loop");
-    ret = esp_timer_start_periodic(cal_timer, 12500); // 12.5ms
-    assert(ESP_OK == ret);
-
-    // Let the ESP_Timer collect the data
+    // Collect the data in this task, no timer callback accesses the bus
     // User must rotate the MAG3110 in all axis during this time
-    vTaskDelay(cal_duration_ms / portTICK_PERIOD_MS);
-
+    ESP_LOGI("MAG3110", "Entering calibration loop");
+    const TickType_t period = pdMS_TO_TICKS(13) ? pdMS_TO_TICKS(13) : 1; // 80Hz
+    const TickType_t start = xTaskGetTickCount();
+    TickType_t last_wake = start;
+    while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(cal_duration_ms)) {
+        mag3110_result_t mag_data; // raw data from the magnetometer
+        if (ESP_OK == mag3110_get_magnetic_induction(sensor, &mag_data)) {
+            mag3110_cal_update(sens, &mag_data);
+        }
+        vTaskDelayUntil(&last_wake, period);
+    }
     ESP_LOGI("MAG3110", "Exiting calibration loop");
-    ret = esp_timer_stop(cal_timer);
-    assert(ESP_OK == ret);
-    ret = esp_timer_delete(cal_timer);
-    assert(ESP_OK == ret);
 
     // reset MAG3110 to default state
     ctrl_reg[0] = MAG3110_STANDBY_MODE;
@@ -221,22 +286,143 @@ esp_err_t mag3110_calibrate(mag3110_handle_t sensor, const uint32_t cal_duration
     assert(ESP_OK == ret);
 
     // calculate the offsets and load it to MAG3110
-    int16_t offset[3]; // result of the calibration
+    mag3110_calibration_t cal; // result of the calibration
     uint8_t offset_data[6]; // byte stream to MAG3110
 
+    mag3110_cal_get(sens, &cal);
     for (int i = 0; i < 3; i++) {
-        offset[i] = (sens->max[i] + sens->min[i]) / 2;
-
         // offset register is 15 bit wide; see datasheet Chapter 5.3.1
-        offset_data[2 * i] = ((uint16_t)offset[i] & 0xFF00) >> 7;
-        offset_data[2 * i + 1] = ((uint16_t)offset[i] & 0x00FF) << 1;
+        offset_data[2 * i] = ((uint16_t)cal.offset[i] & 0xFF00) >> 7;
+        offset_data[2 * i + 1] = ((uint16_t)cal.offset[i] & 0x00FF) << 1;
     }
     ret = mag3110_write(sensor, MAG3110_OFF_X_MSB, offset_data, sizeof(offset_data));
     assert(ESP_OK == ret);
 
-    ESP_LOGD("MAG3110", "offset data %i %i %i", offset[0], offset[1], offset[2]);
+    ESP_LOGD("MAG3110", "offset data %i %i %i", cal.offset[0], cal.offset[1], cal.offset[2]);
 
     vTaskDelay(100 / portTICK_PERIOD_MS); // Wait for shutdown
 
     return ret;
 }
+
+static void IRAM_ATTR mag3110_int_isr(void *arg)
+{
+    mag3110_dev_t *sens = (mag3110_dev_t *) arg;
+    BaseType_t need_yield = pdFALSE;
+
+    vTaskNotifyGiveFromISR(sens->stream_task, &need_yield);
+    if (need_yield) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static void mag3110_stream_task(void *arg)
+{
+    mag3110_dev_t *sens = (mag3110_dev_t *) arg;
+    const mag3110_stream_config_t *config = &sens->stream_config;
+    mag3110_result_t raw, result;
+    mag3110_calibration_t cal;
+
+    // dummy read clears data-ready, so the next sample makes a rising edge
+    mag3110_get_magnetic_induction(arg, &raw);
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // Wait for new data from ISR
+        if (!sens->stream_running) {
+            break;
+        }
+        // X, Y and Z in one burst, the read also clears INT1
+        if (ESP_OK != mag3110_get_magnetic_induction(arg, &raw)) {
+            continue;
+        }
+        if (config->auto_calibration) {
+            mag3110_cal_update(sens, &raw);
+            mag3110_cal_get(sens, &cal);
+            mag3110_cal_apply(&cal, &raw, &result);
+        } else {
+            result = raw;
+        }
+        config->data_cb(&result, config->user_ctx);
+    }
+
+    xSemaphoreGive(sens->stream_done);
+    vTaskDelete(NULL);
+}
+
+esp_err_t mag3110_stream_start(mag3110_handle_t sensor, const mag3110_stream_config_t *const config)
+{
+    esp_err_t ret;
+    mag3110_dev_t *sens = (mag3110_dev_t *) sensor;
+
+    if (NULL == sensor || NULL == config || NULL == config->data_cb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (sens->stream_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    sens->stream_config = *config;
+    sens->stream_done = xSemaphoreCreateBinary();
+    if (NULL == sens->stream_done) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // raw data, the hard-iron offset is tracked and removed by the driver
+    ret = config->auto_calibration ? mag3110_start_raw(sensor, config->data_rate) : mag3110_start(sensor, config->data_rate);
+    if (ESP_OK != ret) {
+        goto err;
+    }
+
+    sens->stream_running = true;
+    if (pdPASS != xTaskCreate(mag3110_stream_task, "MAG3110 stream", 2048, sensor, config->task_priority, &sens->stream_task)) {
+        ret = ESP_ERR_NO_MEM;
+        goto err;
+    }
+
+    // INT1 is push-pull, active high while data is ready
+    const gpio_config_t int_pin_config = {
+        .intr_type = GPIO_INTR_POSEDGE,
+        .mode = GPIO_MODE_INPUT,
+        .pin_bit_mask = BIT64(config->int_pin),
+        .pull_down_en = false,
+        .pull_up_en = false
+    };
+    ret = gpio_config(&int_pin_config);
+    if (ESP_OK == ret) {
+        ret = gpio_isr_handler_add(config->int_pin, mag3110_int_isr, sensor);
+    }
+    if (ESP_OK != ret) {
+        mag3110_stream_stop(sensor);
+        return ret;
+    }
+    xTaskNotifyGive(sens->stream_task); // clear data-ready that came before the interrupt was enabled
+    return ESP_OK;
+
+err:
+    sens->stream_running = false;
+    vSemaphoreDelete(sens->stream_done);
+    sens->stream_done = NULL;
+    return ret;
+}
+
+esp_err_t mag3110_stream_stop(mag3110_handle_t sensor)
+{
+    mag3110_dev_t *sens = (mag3110_dev_t *) sensor;
+
+    if (NULL == sensor) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (sens->stream_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Stop the task after the current sample
+    gpio_isr_handler_remove(sens->stream_config.int_pin);
+    sens->stream_running = false;
+    xTaskNotifyGive(sens->stream_task);
+    xSemaphoreTake(sens->stream_done, portMAX_DELAY);
+    vSemaphoreDelete(sens->stream_done);
+    sens->stream_done = NULL;
+    sens->stream_task = NULL;
+
+    return mag3110_stop(sensor);
+}
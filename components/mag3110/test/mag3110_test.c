@@ -10,11 +10,16 @@
 #include "mag3110.h"
 #include "esp_system.h"
 #include "esp_log.h"
+#include "i2c_bus_stats.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 #define I2C_MASTER_SCL_IO 26      /*!< gpio number for I2C master clock */
 #define I2C_MASTER_SDA_IO 25      /*!< gpio number for I2C master data  */
 #define I2C_MASTER_NUM I2C_NUM_0  /*!< I2C port number for master dev */
 #define I2C_MASTER_FREQ_HZ 100000 /*!< I2C master clock frequency */
+#define PERF_ITERATIONS 1000      /*!< Number of readings in performance test */
+#define MAG3110_INT_IO 4          /*!< gpio number for MAG3110 INT1 */
 
 static const char *TAG = "mag3110 test";
 static mag3110_handle_t mag3110 = NULL;
@@ -73,3 +78,66 @@ TEST_CASE("Sensor mag3110 test", "[mag3110][iot][sensor]")
     ret = i2c_driver_delete(I2C_MASTER_NUM);
     TEST_ASSERT_EQUAL(ESP_OK, ret);
 }
+
+static void mag3110_test_data_cb(const mag3110_result_t *data, void *user_ctx)
+{
+    volatile int *count = (volatile int *) user_ctx;
+    (*count)++;
+}
+
+TEST_CASE("Sensor mag3110 data-ready stream test", "[mag3110][iot][sensor]")
+{
+    esp_err_t ret;
+    volatile int count = 0;
+    mag3110_calibration_t cal;
+
+    i2c_sensor_mag3110_init();
+    ret = gpio_install_isr_service(0);
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+
+    const mag3110_stream_config_t config = {
+        .int_pin = MAG3110_INT_IO,
+        .data_rate = MAG3110_DR_OS_10_128,
+        .auto_calibration = true,
+        .data_cb = mag3110_test_data_cb,
+        .user_ctx = (void *) &count,
+        .task_priority = 5,
+    };
+    ret = mag3110_stream_start(mag3110, &config);
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, mag3110_stream_start(mag3110, &config));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, mag3110_calibrate(mag3110, 1000));
+
+    vTaskDelay(pdMS_TO_TICKS(1000));
+
+    ret = mag3110_stream_stop(mag3110);
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+    ESP_LOGI(TAG, "%i samples streamed", count);
+    TEST_ASSERT_GREATER_OR_EQUAL(5, count); // 10Hz data rate
+
+    ret = mag3110_get_calibration(mag3110, &cal);
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+    ESP_LOGI(TAG, "offset x:%i, y:%i, z:%i, valid:%i", cal.offset[0], cal.offset[1], cal.offset[2], cal.valid);
+
+    mag3110_delete(mag3110);
+    gpio_uninstall_isr_service();
+    ret = i2c_driver_delete(I2C_MASTER_NUM);
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+}
+
+static esp_err_t mag3110_perf_get_induction(void *ctx)
+{
+    mag3110_result_t mag_induction;
+    return mag3110_get_magnetic_induction(mag3110, &mag_induction);
+}
+
+TEST_CASE("Sensor mag3110 performance", "[mag3110][iot][sensor][perf]")
+{
+    i2c_sensor_mag3110_init();
+    TEST_ASSERT_EQUAL(ESP_OK, mag3110_start(mag3110, MAG3110_DR_OS_80_16));
+
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_perf_run("mag3110", "get_magnetic_induction", mag3110_perf_get_induction, NULL, PERF_ITERATIONS, 1, NULL));
+
+    mag3110_delete(mag3110);
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_driver_delete(I2C_MASTER_NUM));
+}
@@ -0,0 +1,149 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Memory accounting
+ *
+ * Large buffers (draw buffers, audio and camera buffers...) are accounted to named subsystems.
+ * Current and peak usage is kept per subsystem and per memory type (internal RAM, DMA capable internal RAM, PSRAM).
+ * The size of a block is read from the heap (heap_caps_get_allocated_size), so a block is only added and removed,
+ * nothing is stored per block.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Memory type of the accounted block
+ */
+typedef enum {
+    MEM_ACCOUNT_INTERNAL = 0,   /*!< Internal RAM */
+    MEM_ACCOUNT_DMA,            /*!< Internal RAM allocated with MALLOC_CAP_DMA */
+    MEM_ACCOUNT_PSRAM,          /*!< External RAM */
+    MEM_ACCOUNT_TYPE_MAX,
+} mem_account_type_t;
+
+/**
+ * @brief Usage of one memory type
+ */
+typedef struct {
+    size_t current;     /*!< Allocated now [bytes] */
+    size_t peak;        /*!< Maximum of `current` since the start or mem_account_reset_peak() */
+    uint32_t blocks;    /*!< Count of allocated blocks */
+} mem_account_usage_t;
+
+/**
+ * @brief Statistics of one subsystem
+ */
+typedef struct {
+    const char *name;                                   /*!< Name of the subsystem */
+    mem_account_usage_t usage[MEM_ACCOUNT_TYPE_MAX];    /*!< Usage per memory type */
+} mem_account_stats_t;
+
+/**
+ * @brief Add allocated block to the subsystem
+ *
+ * @note The subsystem is created with the first block, the name must be valid forever (string literal).
+ *
+ * @param subsys Name of the subsystem (e.g. "lvgl_port")
+ * @param ptr    Block from heap_caps_malloc() or malloc() (NULL: nothing is added)
+ * @param caps   Capabilities used for the allocation (MALLOC_CAP_DMA makes an internal block DMA type)
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Invalid argument
+ *      - ESP_ERR_NO_MEM        Too many subsystems (CONFIG_MEM_ACCOUNT_MAX_SUBSYS)
+ */
+esp_err_t mem_account_add(const char *subsys, const void *ptr, uint32_t caps);
+
+/**
+ * @brief Remove block from the subsystem
+ *
+ * Call it before the block is freed, with the same capabilities as mem_account_add().
+ *
+ * @param subsys Name of the subsystem
+ * @param ptr    Block added by mem_account_add() (NULL: nothing is removed)
+ * @param caps   Capabilities used for the allocation
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Invalid argument
+ *      - ESP_ERR_NOT_FOUND     The subsystem does not exist
+ *      - ESP_ERR_INVALID_STATE The block was not added (usage would be negative)
+ */
+esp_err_t mem_account_remove(const char *subsys, const void *ptr, uint32_t caps);
+
+/**
+ * @brief Allocate memory and add it to the subsystem
+ *
+ * @param subsys Name of the subsystem
+ * @param size   Size of the block [bytes]
+ * @param caps   Capabilities for heap_caps_malloc()
+ * @return Allocated block or NULL
+ */
+void *mem_account_malloc(const char *subsys, size_t size, uint32_t caps);
+
+/**
+ * @brief Remove the block from the subsystem and free it
+ *
+ * @param subsys Name of the subsystem
+ * @param ptr    Block from mem_account_malloc() (NULL: nothing is done)
+ * @param caps   Capabilities used for the allocation
+ */
+void mem_account_free(const char *subsys, void *ptr, uint32_t caps);
+
+/**
+ * @brief Get statistics of the subsystem
+ *
+ * @param subsys Name of the subsystem
+ * @param[out] stats Statistics
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Invalid argument
+ *      - ESP_ERR_NOT_FOUND     The subsystem does not exist
+ */
+esp_err_t mem_account_get(const char *subsys, mem_account_stats_t *stats);
+
+/**
+ * @brief Get statistics of all subsystems
+ *
+ * @param[out] stats   Array for statistics
+ * @param max_count    Size of the array
+ * @return Count of all subsystems (can be more than max_count)
+ */
+size_t mem_account_get_all(mem_account_stats_t *stats, size_t max_count);
+
+/**
+ * @brief Get sum of all subsystems
+ *
+ * Peak of the sum is the maximum of all accounted memory at one moment, which is less or equal to the sum of peaks.
+ *
+ * @param[out] stats Statistics with the name "total"
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Invalid argument
+ */
+esp_err_t mem_account_get_total(mem_account_stats_t *stats);
+
+/**
+ * @brief Set peaks of all subsystems and of the sum to the current usage
+ */
+void mem_account_reset_peak(void);
+
+/**
+ * @brief Print table of all subsystems and free heap of each memory type
+ */
+void mem_account_print(void);
+
+#ifdef __cplusplus
+}
+#endif
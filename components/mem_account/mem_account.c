@@ -0,0 +1,213 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+#include "mem_account.h"
+
+static const char *TAG = "mem_account";
+
+static const char *const mem_account_type_names[MEM_ACCOUNT_TYPE_MAX] = {"internal", "dma", "psram"};
+static const uint32_t mem_account_type_caps[MEM_ACCOUNT_TYPE_MAX] = {MALLOC_CAP_INTERNAL, MALLOC_CAP_DMA, MALLOC_CAP_SPIRAM};
+
+static mem_account_stats_t mem_account_subsys[CONFIG_MEM_ACCOUNT_MAX_SUBSYS];
+static size_t mem_account_subsys_cnt;
+static mem_account_stats_t mem_account_total = {.name = "total"};
+static portMUX_TYPE mem_account_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static mem_account_type_t mem_account_type(const void *ptr, uint32_t caps)
+{
+    if (esp_ptr_external_ram(ptr)) {
+        return MEM_ACCOUNT_PSRAM;
+    }
+    return (caps & MALLOC_CAP_DMA) ? MEM_ACCOUNT_DMA : MEM_ACCOUNT_INTERNAL;
+}
+
+/* Must be called in the critical section */
+static mem_account_stats_t *mem_account_find(const char *subsys)
+{
+    for (size_t i = 0; i < mem_account_subsys_cnt; i++) {
+        if (mem_account_subsys[i].name == subsys || strcmp(mem_account_subsys[i].name, subsys) == 0) {
+            return &mem_account_subsys[i];
+        }
+    }
+    return NULL;
+}
+
+static void mem_account_usage_add(mem_account_usage_t *usage, size_t size)
+{
+    usage->current += size;
+    usage->blocks++;
+    if (usage->current > usage->peak) {
+        usage->peak = usage->current;
+    }
+}
+
+static void mem_account_usage_remove(mem_account_usage_t *usage, size_t size)
+{
+    usage->current -= size;
+    usage->blocks--;
+}
+
+esp_err_t mem_account_add(const char *subsys, const void *ptr, uint32_t caps)
+{
+    ESP_RETURN_ON_FALSE(subsys, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    if (ptr == NULL) {
+        return ESP_OK;
+    }
+    const size_t size = heap_caps_get_allocated_size((void *)ptr);
+    const mem_account_type_t type = mem_account_type(ptr, caps);
+
+    portENTER_CRITICAL(&mem_account_lock);
+    mem_account_stats_t *stats = mem_account_find(subsys);
+    if (stats == NULL && mem_account_subsys_cnt < CONFIG_MEM_ACCOUNT_MAX_SUBSYS) {
+        stats = &mem_account_subsys[mem_account_subsys_cnt++];
+        stats->name = subsys;
+    }
+    if (stats) {
+        mem_account_usage_add(&stats->usage[type], size);
+        mem_account_usage_add(&mem_account_total.usage[type], size);
+    }
+    portEXIT_CRITICAL(&mem_account_lock);
+
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_NO_MEM, TAG, "too many subsystems, %s not accounted", subsys);
+    return ESP_OK;
+}
+
+esp_err_t mem_account_remove(const char *subsys, const void *ptr, uint32_t caps)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(subsys, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    if (ptr == NULL) {
+        return ESP_OK;
+    }
+    const size_t size = heap_caps_get_allocated_size((void *)ptr);
+    const mem_account_type_t type = mem_account_type(ptr, caps);
+
+    portENTER_CRITICAL(&mem_account_lock);
+    mem_account_stats_t *stats = mem_account_find(subsys);
+    if (stats == NULL) {
+        ret = ESP_ERR_NOT_FOUND;
+    } else if (stats->usage[type].current < size || stats->usage[type].blocks == 0) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else {
+        mem_account_usage_remove(&stats->usage[type], size);
+        mem_account_usage_remove(&mem_account_total.usage[type], size);
+    }
+    portEXIT_CRITICAL(&mem_account_lock);
+
+    ESP_RETURN_ON_ERROR(ret, TAG, "block %p of %s (%s) was not added", ptr, subsys, mem_account_type_names[type]);
+    return ESP_OK;
+}
+
+void *mem_account_malloc(const char *subsys, size_t size, uint32_t caps)
+{
+    void *ptr = heap_caps_malloc(size, caps);
+    if (ptr) {
+        mem_account_add(subsys, ptr, caps);
+    }
+    return ptr;
+}
+
+void mem_account_free(const char *subsys, void *ptr, uint32_t caps)
+{
+    if (ptr) {
+        mem_account_remove(subsys, ptr, caps);
+        heap_caps_free(ptr);
+    }
+}
+
+esp_err_t mem_account_get(const char *subsys, mem_account_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(subsys && stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    portENTER_CRITICAL(&mem_account_lock);
+    const mem_account_stats_t *found = mem_account_find(subsys);
+    if (found) {
+        *stats = *found;
+    }
+    portEXIT_CRITICAL(&mem_account_lock);
+
+    return found ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+size_t mem_account_get_all(mem_account_stats_t *stats, size_t max_count)
+{
+    portENTER_CRITICAL(&mem_account_lock);
+    const size_t count = mem_account_subsys_cnt;
+    for (size_t i = 0; stats && i < count && i < max_count; i++) {
+        stats[i] = mem_account_subsys[i];
+    }
+    portEXIT_CRITICAL(&mem_account_lock);
+
+    return count;
+}
+
+esp_err_t mem_account_get_total(mem_account_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    portENTER_CRITICAL(&mem_account_lock);
+    *stats = mem_account_total;
+    portEXIT_CRITICAL(&mem_account_lock);
+
+    return ESP_OK;
+}
+
+void mem_account_reset_peak(void)
+{
+    portENTER_CRITICAL(&mem_account_lock);
+    for (size_t i = 0; i < mem_account_subsys_cnt; i++) {
+        for (int type = 0; type < MEM_ACCOUNT_TYPE_MAX; type++) {
+            mem_account_subsys[i].usage[type].peak = mem_account_subsys[i].usage[type].current;
+        }
+    }
+    for (int type = 0; type < MEM_ACCOUNT_TYPE_MAX; type++) {
+        mem_account_total.usage[type].peak = mem_account_total.usage[type].current;
+    }
+    portEXIT_CRITICAL(&mem_account_lock);
+}
+
+static void mem_account_print_stats(const mem_account_stats_t *stats)
+{
+    printf("%-16s", stats->name);
+    for (int type = 0; type < MEM_ACCOUNT_TYPE_MAX; type++) {
+        printf(" %10u %10u %6u", (unsigned)stats->usage[type].current, (unsigned)stats->usage[type].peak,
+               (unsigned)stats->usage[type].blocks);
+    }
+    printf("\n");
+}
+
+void mem_account_print(void)
+{
+    mem_account_stats_t stats[CONFIG_MEM_ACCOUNT_MAX_SUBSYS];
+    mem_account_stats_t total;
+    const size_t count = mem_account_get_all(stats, CONFIG_MEM_ACCOUNT_MAX_SUBSYS);
+    mem_account_get_total(&total);
+
+    printf("%-16s", "subsystem");
+    for (int type = 0; type < MEM_ACCOUNT_TYPE_MAX; type++) {
+        printf(" %10s %10s %6s", mem_account_type_names[type], "peak", "blocks");
+    }
+    printf("\n");
+    for (size_t i = 0; i < count; i++) {
+        mem_account_print_stats(&stats[i]);
+    }
+    mem_account_print_stats(&total);
+
+    /* Free heap puts the accounted usage into context: how much more could the buffers grow */
+    printf("%-16s", "heap free");
+    for (int type = 0; type < MEM_ACCOUNT_TYPE_MAX; type++) {
+        printf(" %10u %10u %6s", (unsigned)heap_caps_get_free_size(mem_account_type_caps[type]),
+               (unsigned)heap_caps_get_minimum_free_size(mem_account_type_caps[type]), "");
+    }
+    printf("\n");
+}
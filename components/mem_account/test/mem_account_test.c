@@ -0,0 +1,71 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include "unity.h"
+#include "esp_heap_caps.h"
+#include "mem_account.h"
+
+#define TEST_BLOCK_SIZE     1000
+
+TEST_CASE("Memory accounting current and peak usage", "[mem_account]")
+{
+    mem_account_stats_t stats;
+
+    void *a = mem_account_malloc("test_usage", TEST_BLOCK_SIZE, MALLOC_CAP_INTERNAL);
+    void *b = mem_account_malloc("test_usage", TEST_BLOCK_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+
+    TEST_ASSERT_EQUAL(ESP_OK, mem_account_get("test_usage", &stats));
+    TEST_ASSERT_EQUAL_STRING("test_usage", stats.name);
+    /* The heap can round the size up */
+    TEST_ASSERT_GREATER_OR_EQUAL(TEST_BLOCK_SIZE, stats.usage[MEM_ACCOUNT_INTERNAL].current);
+    TEST_ASSERT_GREATER_OR_EQUAL(TEST_BLOCK_SIZE, stats.usage[MEM_ACCOUNT_DMA].current);
+    TEST_ASSERT_EQUAL(1, stats.usage[MEM_ACCOUNT_INTERNAL].blocks);
+    TEST_ASSERT_EQUAL(1, stats.usage[MEM_ACCOUNT_DMA].blocks);
+    const size_t peak = stats.usage[MEM_ACCOUNT_INTERNAL].peak;
+
+    mem_account_free("test_usage", a, MALLOC_CAP_INTERNAL);
+    TEST_ASSERT_EQUAL(ESP_OK, mem_account_get("test_usage", &stats));
+    TEST_ASSERT_EQUAL(0, stats.usage[MEM_ACCOUNT_INTERNAL].current);
+    TEST_ASSERT_EQUAL(0, stats.usage[MEM_ACCOUNT_INTERNAL].blocks);
+    TEST_ASSERT_EQUAL(peak, stats.usage[MEM_ACCOUNT_INTERNAL].peak);
+
+    mem_account_reset_peak();
+    TEST_ASSERT_EQUAL(ESP_OK, mem_account_get("test_usage", &stats));
+    TEST_ASSERT_EQUAL(0, stats.usage[MEM_ACCOUNT_INTERNAL].peak);
+
+    mem_account_free("test_usage", b, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+    TEST_ASSERT_EQUAL(ESP_OK, mem_account_get("test_usage", &stats));
+    TEST_ASSERT_EQUAL(0, stats.usage[MEM_ACCOUNT_DMA].current);
+    mem_account_print();
+}
+
+TEST_CASE("Memory accounting of external blocks and errors", "[mem_account]")
+{
+    mem_account_stats_t total_before;
+    mem_account_stats_t total;
+    TEST_ASSERT_EQUAL(ESP_OK, mem_account_get_total(&total_before));
+
+    void *block = heap_caps_malloc(TEST_BLOCK_SIZE, MALLOC_CAP_INTERNAL);
+    TEST_ASSERT_NOT_NULL(block);
+    TEST_ASSERT_EQUAL(ESP_OK, mem_account_add("test_errors", block, MALLOC_CAP_INTERNAL));
+    TEST_ASSERT_EQUAL(ESP_OK, mem_account_get_total(&total));
+    TEST_ASSERT_GREATER_THAN(total_before.usage[MEM_ACCOUNT_INTERNAL].current, total.usage[MEM_ACCOUNT_INTERNAL].current);
+
+    /* Not added to this subsystem */
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, mem_account_remove("test_unknown", block, MALLOC_CAP_INTERNAL));
+    TEST_ASSERT_EQUAL(ESP_OK, mem_account_remove("test_errors", block, MALLOC_CAP_INTERNAL));
+    /* Removed twice */
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, mem_account_remove("test_errors", block, MALLOC_CAP_INTERNAL));
+    heap_caps_free(block);
+
+    TEST_ASSERT_EQUAL(ESP_OK, mem_account_get_total(&total));
+    TEST_ASSERT_EQUAL(total_before.usage[MEM_ACCOUNT_INTERNAL].current, total.usage[MEM_ACCOUNT_INTERNAL].current);
+    TEST_ASSERT_EQUAL(ESP_OK, mem_account_add("test_errors", NULL, MALLOC_CAP_INTERNAL));
+    TEST_ASSERT_GREATER_OR_EQUAL(2, mem_account_get_all(NULL, 0));
+}
@@ -0,0 +1,150 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Memory-mapped assets
+ *
+ * Read-only assets (images, fonts, PCM audio) are packed by `mmap_assets_create_partition_image()`
+ * into one image with an index table. The partition is mapped into the address space through flash cache,
+ * so the assets are used directly as `const` data: no filesystem, no RAM copy.
+ *
+ * Image format (multi-byte integers are little-endian):
+ *
+ * | Offset          | Size      | Content                                                            |
+ * |-----------------|-----------|--------------------------------------------------------------------|
+ * | 0               | 4         | Magic "MAST"                                                       |
+ * | 4               | 2         | Format version (MMAP_ASSETS_FORMAT_VERSION)                        |
+ * | 6               | 2         | Count of assets                                                    |
+ * | 8               | 4         | Image size [bytes]                                                 |
+ * | 12              | 4         | Reserved (0)                                                       |
+ * | 16              | 40 x count| Index entries sorted by name: name[32] (NUL padded), offset, size  |
+ * | ...             | ...       | Asset data, each aligned to 4 bytes                                |
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Version of the image format
+ */
+#define MMAP_ASSETS_FORMAT_VERSION  1
+
+/**
+ * @brief Maximum length of asset name, without terminating NUL
+ */
+#define MMAP_ASSETS_NAME_MAX_LEN    31
+
+/**
+ * @brief Asset
+ */
+typedef struct {
+    const char *name;       /*!< Name of the asset (file name in the source directory) */
+    const uint8_t *data;    /*!< Data in mapped flash, aligned to 4 bytes */
+    size_t size;            /*!< Size of the data [bytes] */
+} mmap_asset_t;
+
+/**
+ * @brief Assets configuration
+ */
+typedef struct {
+    const char *partition_label;    /*!< Label of the data partition with the assets image */
+} mmap_assets_config_t;
+
+/**
+ * @brief Assets handle
+ */
+typedef struct mmap_assets_s *mmap_assets_handle_t;
+
+/**
+ * @brief Map assets partition and check its index
+ *
+ * @param config        Configuration
+ * @param ret_handle    Created handle
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NOT_FOUND     if the partition doesn't exist
+ *      - ESP_ERR_INVALID_VERSION if the partition doesn't contain a supported assets image
+ *      - ESP_ERR_INVALID_SIZE  if the index is corrupted
+ *      - ESP_ERR_NO_MEM        if there is no memory or no free MMU page for the mapping
+ */
+esp_err_t mmap_assets_new(const mmap_assets_config_t *config, mmap_assets_handle_t *ret_handle);
+
+/**
+ * @brief Use assets image already in memory (e.g. embedded in the application by EMBED_FILES)
+ *
+ * @param image         Assets image, aligned to 4 bytes; it must stay valid while the handle is used
+ * @param size          Size of the memory with the image [bytes]
+ * @param ret_handle    Created handle
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_INVALID_VERSION if the memory doesn't contain a supported assets image
+ *      - ESP_ERR_INVALID_SIZE  if the index is corrupted
+ *      - ESP_ERR_NO_MEM        if there is no memory for the handle
+ */
+esp_err_t mmap_assets_new_from_memory(const void *image, size_t size, mmap_assets_handle_t *ret_handle);
+
+/**
+ * @brief Unmap the assets
+ *
+ * @note Pointers to asset data are invalid after this call
+ *
+ * @param handle    Assets handle
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t mmap_assets_del(mmap_assets_handle_t handle);
+
+/**
+ * @brief Get count of assets
+ *
+ * @param handle    Assets handle
+ * @return Count of assets
+ */
+size_t mmap_assets_get_count(mmap_assets_handle_t handle);
+
+/**
+ * @brief Get asset by index
+ *
+ * Assets are sorted by name.
+ *
+ * @param handle        Assets handle
+ * @param index         Index of the asset
+ * @param[out] asset    Asset
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error or index out of range
+ */
+esp_err_t mmap_assets_get(mmap_assets_handle_t handle, size_t index, mmap_asset_t *asset);
+
+/**
+ * @brief Find asset by name
+ *
+ * Binary search in the sorted index.
+ *
+ * @param handle        Assets handle
+ * @param name          Name of the asset
+ * @param[out] asset    Asset
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NOT_FOUND     if there is no asset with the name
+ */
+esp_err_t mmap_assets_find(mmap_assets_handle_t handle, const char *name, mmap_asset_t *asset);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,176 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "mmap_assets.h"
+
+static const char *TAG = "mmap_assets";
+
+#define MMAP_ASSETS_MAGIC   0x5453414D  /* "MAST" */
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t image_size;
+    uint32_t reserved;
+} mmap_assets_header_t;
+
+typedef struct {
+    char name[MMAP_ASSETS_NAME_MAX_LEN + 1];
+    uint32_t offset;
+    uint32_t size;
+} mmap_assets_entry_t;
+
+_Static_assert(sizeof(mmap_assets_header_t) == 16, "Header size doesn't match the image format");
+_Static_assert(sizeof(mmap_assets_entry_t) == 40, "Entry size doesn't match the image format");
+
+struct mmap_assets_s {
+    const uint8_t *image;
+    const mmap_assets_entry_t *entries;
+    size_t count;
+    esp_partition_mmap_handle_t mmap_handle;
+    bool mapped;
+};
+
+static esp_err_t mmap_assets_check_header(const mmap_assets_header_t *header, size_t size)
+{
+    ESP_RETURN_ON_FALSE(header->magic == MMAP_ASSETS_MAGIC && header->version == MMAP_ASSETS_FORMAT_VERSION,
+                        ESP_ERR_INVALID_VERSION, TAG, "No supported assets image");
+    ESP_RETURN_ON_FALSE(header->image_size <= size &&
+                        sizeof(mmap_assets_header_t) + (size_t)header->count * sizeof(mmap_assets_entry_t) <= header->image_size,
+                        ESP_ERR_INVALID_SIZE, TAG, "Assets image doesn't fit");
+    return ESP_OK;
+}
+
+/* Entries must point into the image and be sorted for binary search */
+static esp_err_t mmap_assets_check_index(mmap_assets_handle_t handle, size_t image_size)
+{
+    for (size_t i = 0; i < handle->count; i++) {
+        const mmap_assets_entry_t *entry = &handle->entries[i];
+        ESP_RETURN_ON_FALSE(memchr(entry->name, '\0', sizeof(entry->name)), ESP_ERR_INVALID_SIZE, TAG, "Invalid name of asset %u", (unsigned)i);
+        ESP_RETURN_ON_FALSE(entry->offset % 4 == 0 && entry->offset <= image_size && entry->size <= image_size - entry->offset,
+                            ESP_ERR_INVALID_SIZE, TAG, "Asset %s out of image", entry->name);
+        ESP_RETURN_ON_FALSE(i == 0 || strcmp(handle->entries[i - 1].name, entry->name) < 0,
+                            ESP_ERR_INVALID_SIZE, TAG, "Index not sorted at %s", entry->name);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t mmap_assets_init(mmap_assets_handle_t handle, const void *image, size_t size)
+{
+    const mmap_assets_header_t *header = (const mmap_assets_header_t *)image;
+    ESP_RETURN_ON_ERROR(mmap_assets_check_header(header, size), TAG, "Invalid header");
+
+    handle->image = image;
+    handle->entries = (const mmap_assets_entry_t *)(handle->image + sizeof(mmap_assets_header_t));
+    handle->count = header->count;
+    return mmap_assets_check_index(handle, header->image_size);
+}
+
+esp_err_t mmap_assets_new(const mmap_assets_config_t *config, mmap_assets_handle_t *ret_handle)
+{
+    esp_err_t ret = ESP_OK;
+    mmap_assets_header_t header;
+    const void *image = NULL;
+
+    ESP_RETURN_ON_FALSE(config && config->partition_label && ret_handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, config->partition_label);
+    ESP_RETURN_ON_FALSE(partition, ESP_ERR_NOT_FOUND, TAG, "Partition %s not found", config->partition_label);
+
+    /* Only the image is mapped, not the whole partition */
+    ESP_RETURN_ON_ERROR(esp_partition_read(partition, 0, &header, sizeof(header)), TAG, "Header read failed");
+    ESP_RETURN_ON_ERROR(mmap_assets_check_header(&header, partition->size), TAG, "Invalid header");
+
+    mmap_assets_handle_t handle = calloc(1, sizeof(struct mmap_assets_s));
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_NO_MEM, TAG, "Not enough memory for assets");
+    ESP_GOTO_ON_ERROR(esp_partition_mmap(partition, 0, header.image_size, ESP_PARTITION_MMAP_DATA, &image, &handle->mmap_handle),
+                      err, TAG, "Partition mapping failed");
+    handle->mapped = true;
+    ESP_GOTO_ON_ERROR(mmap_assets_init(handle, image, header.image_size), err, TAG, "Invalid assets image");
+
+    ESP_LOGI(TAG, "%u assets mapped from %s (%" PRIu32 " bytes)", (unsigned)handle->count, partition->label, header.image_size);
+    *ret_handle = handle;
+    return ESP_OK;
+
+err:
+    mmap_assets_del(handle);
+    return ret;
+}
+
+esp_err_t mmap_assets_new_from_memory(const void *image, size_t size, mmap_assets_handle_t *ret_handle)
+{
+    esp_err_t ret = ESP_OK;
+
+    ESP_RETURN_ON_FALSE(image && ret_handle && ((uintptr_t)image % 4) == 0, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(size >= sizeof(mmap_assets_header_t), ESP_ERR_INVALID_SIZE, TAG, "Assets image too short");
+
+    mmap_assets_handle_t handle = calloc(1, sizeof(struct mmap_assets_s));
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_NO_MEM, TAG, "Not enough memory for assets");
+    ESP_GOTO_ON_ERROR(mmap_assets_init(handle, image, size), err, TAG, "Invalid assets image");
+    *ret_handle = handle;
+    return ESP_OK;
+
+err:
+    free(handle);
+    return ret;
+}
+
+esp_err_t mmap_assets_del(mmap_assets_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+    if (handle->mapped) {
+        esp_partition_munmap(handle->mmap_handle);
+    }
+    free(handle);
+    return ESP_OK;
+}
+
+size_t mmap_assets_get_count(mmap_assets_handle_t handle)
+{
+    return handle ? handle->count : 0;
+}
+
+static void mmap_assets_fill(mmap_assets_handle_t handle, const mmap_assets_entry_t *entry, mmap_asset_t *asset)
+{
+    asset->name = entry->name;
+    asset->data = handle->image + entry->offset;
+    asset->size = entry->size;
+}
+
+esp_err_t mmap_assets_get(mmap_assets_handle_t handle, size_t index, mmap_asset_t *asset)
+{
+    ESP_RETURN_ON_FALSE(handle && asset && index < handle->count, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    mmap_assets_fill(handle, &handle->entries[index], asset);
+    return ESP_OK;
+}
+
+esp_err_t mmap_assets_find(mmap_assets_handle_t handle, const char *name, mmap_asset_t *asset)
+{
+    ESP_RETURN_ON_FALSE(handle && name && asset, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    size_t low = 0;
+    size_t high = handle->count;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        const int cmp = strcmp(name, handle->entries[mid].name);
+        if (cmp == 0) {
+            mmap_assets_fill(handle, &handle->entries[mid], asset);
+            return ESP_OK;
+        } else if (cmp < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
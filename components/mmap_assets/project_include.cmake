@@ -0,0 +1,48 @@
+# Directory of the component, CMAKE_CURRENT_LIST_DIR is different when the function is called
+set(MMAP_ASSETS_COMPONENT_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+# mmap_assets_create_partition_image
+#
+# Pack files of base_dir into an assets image for the partition,
+# optionally flash the image with `idf.py flash` (FLASH_IN_PROJECT)
+function(mmap_assets_create_partition_image partition base_dir)
+    set(options FLASH_IN_PROJECT)
+    set(multi DEPENDS)
+    cmake_parse_arguments(arg "${options}" "" "${multi}" "${ARGN}")
+
+    idf_build_get_property(python PYTHON)
+    set(assets_gen_py ${python} ${MMAP_ASSETS_COMPONENT_DIR}/tools/mmap_assets_gen.py)
+
+    get_filename_component(base_dir_full_path ${base_dir} ABSOLUTE)
+    partition_table_get_partition_info(size "--partition-name ${partition}" "size")
+    partition_table_get_partition_info(offset "--partition-name ${partition}" "offset")
+
+    if("${size}" AND "${offset}")
+        set(image_file ${CMAKE_BINARY_DIR}/${partition}.bin)
+        file(GLOB assets ${base_dir_full_path}/*)
+
+        add_custom_command(OUTPUT ${image_file}
+            COMMAND ${assets_gen_py} ${size} ${base_dir_full_path} ${image_file}
+            DEPENDS ${assets} ${arg_DEPENDS}
+            COMMENT "Generating assets image ${partition}.bin"
+            VERBATIM)
+        add_custom_target(mmap_assets_${partition}_bin ALL DEPENDS ${image_file})
+
+        set_property(DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}" APPEND PROPERTY
+            ADDITIONAL_CLEAN_FILES ${image_file})
+
+        idf_component_get_property(main_args esptool_py FLASH_ARGS)
+        idf_component_get_property(sub_args esptool_py FLASH_SUB_ARGS)
+        esptool_py_flash_target(${partition}-flash "${main_args}" "${sub_args}")
+        esptool_py_flash_target_image(${partition}-flash "${partition}" "${offset}" "${image_file}")
+        add_dependencies(${partition}-flash mmap_assets_${partition}_bin)
+
+        if(arg_FLASH_IN_PROJECT)
+            esptool_py_flash_target_image(flash "${partition}" "${offset}" "${image_file}")
+            add_dependencies(flash mmap_assets_${partition}_bin)
+        endif()
+    else()
+        message(FATAL_ERROR "Failed to create assets image for partition '${partition}'. "
+                            "Check project configuration if using the correct partition table file.")
+    endif()
+endfunction()
@@ -0,0 +1,73 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "mmap_assets.h"
+
+/* Image with assets "logo.bin" (6 bytes) and "tone.pcm" (4 bytes), created by tools/mmap_assets_gen.py */
+static const uint32_t test_image[] = {
+    0x5453414D, 0x00020001, 0x0000006C, 0x00000000,
+    /* "logo.bin" */
+    0x6F676F6C, 0x6E69622E, 0, 0, 0, 0, 0, 0, 0x00000060, 0x00000006,
+    /* "tone.pcm" */
+    0x656E6F74, 0x6D63702E, 0, 0, 0, 0, 0, 0, 0x00000068, 0x00000004,
+    /* Data of logo.bin, padding, data of tone.pcm */
+    0x03020100, 0x00000504, 0x7FFF8000,
+};
+
+TEST_CASE("Assets index lookup", "[mmap_assets]")
+{
+    mmap_assets_handle_t assets;
+    mmap_asset_t asset;
+
+    TEST_ASSERT_EQUAL(ESP_OK, mmap_assets_new_from_memory(test_image, sizeof(test_image), &assets));
+    TEST_ASSERT_EQUAL(2, mmap_assets_get_count(assets));
+
+    TEST_ASSERT_EQUAL(ESP_OK, mmap_assets_get(assets, 1, &asset));
+    TEST_ASSERT_EQUAL_STRING("tone.pcm", asset.name);
+
+    TEST_ASSERT_EQUAL(ESP_OK, mmap_assets_find(assets, "logo.bin", &asset));
+    TEST_ASSERT_EQUAL(6, asset.size);
+    const uint8_t logo[] = {0, 1, 2, 3, 4, 5};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(logo, asset.data, sizeof(logo));
+
+    /* Data is used in place, without copy */
+    TEST_ASSERT_EQUAL(ESP_OK, mmap_assets_find(assets, "tone.pcm", &asset));
+    TEST_ASSERT_EQUAL_PTR(&test_image[26], asset.data);
+    TEST_ASSERT_EQUAL_INT16(-32768, ((const int16_t *)asset.data)[0]);
+    TEST_ASSERT_EQUAL_INT16(32767, ((const int16_t *)asset.data)[1]);
+
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, mmap_assets_find(assets, "font.bin", &asset));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, mmap_assets_get(assets, 2, &asset));
+    TEST_ASSERT_EQUAL(ESP_OK, mmap_assets_del(assets));
+}
+
+TEST_CASE("Assets corrupted image", "[mmap_assets]")
+{
+    mmap_assets_handle_t assets;
+    uint32_t image[sizeof(test_image) / sizeof(uint32_t)];
+
+    /* Truncated */
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, mmap_assets_new_from_memory(test_image, sizeof(test_image) - 4, &assets));
+
+    /* Wrong magic */
+    memcpy(image, test_image, sizeof(image));
+    image[0] = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_VERSION, mmap_assets_new_from_memory(image, sizeof(image), &assets));
+
+    /* Asset out of image */
+    memcpy(image, test_image, sizeof(image));
+    image[12] = 0x100;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, mmap_assets_new_from_memory(image, sizeof(image), &assets));
+
+    /* Not found partition */
+    const mmap_assets_config_t config = {
+        .partition_label = "no_assets",
+    };
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, mmap_assets_new(&config, &assets));
+}
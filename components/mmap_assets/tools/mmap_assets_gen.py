@@ -0,0 +1,66 @@
+#!/usr/bin/env python
+#
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Pack files of a directory into an assets image for mmap_assets component.
+# See include/mmap_assets.h for the image format.
+
+import argparse
+import os
+import struct
+import sys
+
+MAGIC = b'MAST'
+VERSION = 1
+NAME_MAX_LEN = 31
+HEADER_FMT = '<4sHHII'
+ENTRY_FMT = '<32sII'
+ALIGN = 4
+
+
+def align(value):
+    return (value + ALIGN - 1) & ~(ALIGN - 1)
+
+
+def create_image(base_dir):
+    files = sorted(f for f in os.listdir(base_dir) if os.path.isfile(os.path.join(base_dir, f)))
+    for name in files:
+        if len(name.encode()) > NAME_MAX_LEN:
+            raise ValueError('Asset name too long (max {} bytes): {}'.format(NAME_MAX_LEN, name))
+
+    # Data follows the index, offsets are from the start of the image
+    data_start = struct.calcsize(HEADER_FMT) + len(files) * struct.calcsize(ENTRY_FMT)
+    index = b''
+    data = b''
+    for name in files:
+        with open(os.path.join(base_dir, name), 'rb') as f:
+            content = f.read()
+        data += b'\0' * (align(data_start + len(data)) - data_start - len(data))
+        index += struct.pack(ENTRY_FMT, name.encode(), data_start + len(data), len(content))
+        data += content
+
+    header = struct.pack(HEADER_FMT, MAGIC, VERSION, len(files), data_start + len(data), 0)
+    return header + index + data, len(files)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Create assets image for mmap_assets component')
+    parser.add_argument('partition_size', help='Size of the partition (decimal or 0x hex)')
+    parser.add_argument('base_dir', help='Directory with the assets, files are packed without subdirectories')
+    parser.add_argument('output_file', help='Created image')
+    args = parser.parse_args()
+
+    image, count = create_image(args.base_dir)
+    partition_size = int(args.partition_size, 0)
+    if len(image) > partition_size:
+        sys.exit('Assets image ({} bytes) does not fit the partition ({} bytes)'.format(len(image), partition_size))
+
+    with open(args.output_file, 'wb') as f:
+        f.write(image)
+    print('Assets image: {} files, {} of {} bytes'.format(count, len(image), partition_size))
+
+
+if __name__ == '__main__':
+    main()
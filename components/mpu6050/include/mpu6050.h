@@ -108,6 +108,36 @@ typedef void *mpu6050_handle_t;
 
 typedef gpio_isr_t mpu6050_isr_t;
 
+#define MPU6050_FIFO_SIZE           1024u /*!< Size of MPU6050 FIFO in bytes */
+#define MPU6050_FIFO_FRAME_SIZE     14u   /*!< FIFO frame: accelerometer, temperature and gyroscope */
+#define MPU6050_FIFO_FRAMES_MAX     (MPU6050_FIFO_SIZE / MPU6050_FIFO_FRAME_SIZE) /*!< Maximum count of frames in FIFO */
+
+typedef struct {
+    mpu6050_raw_acce_value_t acce;  /*!< Raw accelerometer measurement */
+    int16_t raw_temp;               /*!< Raw temperature measurement */
+    mpu6050_raw_gyro_value_t gyro;  /*!< Raw gyroscope measurement */
+    int64_t timestamp_us;           /*!< Time of the sample (esp_timer time, estimated from the sample rate) */
+} mpu6050_fifo_sample_t;
+
+/**
+ * @brief Callback of FIFO samples
+ *
+ * @param samples samples read in one burst, the oldest one is the first
+ * @param count count of samples
+ * @param user_ctx user data from the stream configuration
+ */
+typedef void (*mpu6050_fifo_cb_t)(const mpu6050_fifo_sample_t *samples, size_t count, void *user_ctx);
+
+typedef struct {
+    uint8_t sample_rate_div;        /*!< Sample rate is gyroscope output rate (8 kHz, or 1 kHz with DLPF) / (1 + sample_rate_div) */
+    uint16_t watermark;             /*!< Count of samples read in one I2C transaction (1 - MPU6050_FIFO_FRAMES_MAX) */
+    mpu6050_fifo_cb_t callback;     /*!< Callback of read samples */
+    void *user_ctx;                 /*!< User data for the callback */
+    int task_priority;              /*!< Priority of the stream task */
+    int task_stack;                 /*!< Stack size of the stream task [bytes] */
+    int task_affinity;              /*!< Core of the task (-1 for no affinity) */
+} mpu6050_fifo_stream_config_t;
+
 /**
  * @brief Create and init sensor object and return a sensor handle
  *
@@ -379,6 +409,40 @@ esp_err_t mpu6050_get_gyro(mpu6050_handle_t sensor, mpu6050_gyro_value_t *const
  */
 esp_err_t mpu6050_get_temp(mpu6050_handle_t sensor, mpu6050_temp_value_t *const temp_value);
 
+/**
+ * @brief Read raw accelerometer, temperature and gyroscope measurements in one I2C transaction
+ *
+ * All values come from the same sample.
+ *
+ * @param sensor object handle of mpu6050
+ * @param raw_acce_value raw accelerometer measurements
+ * @param raw_gyro_value raw gyroscope measurements
+ * @param raw_temp raw temperature measurement (can be NULL)
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t mpu6050_get_all_raw(mpu6050_handle_t sensor, mpu6050_raw_acce_value_t *const raw_acce_value,
+                              mpu6050_raw_gyro_value_t *const raw_gyro_value, int16_t *const raw_temp);
+
+/**
+ * @brief Read accelerometer, gyroscope and temperature values in one I2C transaction
+ *
+ * Sensitivities are stored by mpu6050_config() (or read from the sensor once), so only one transaction is used.
+ *
+ * @param sensor object handle of mpu6050
+ * @param acce_value accelerometer measurements
+ * @param gyro_value gyroscope measurements
+ * @param temp_value temperature measurements (can be NULL)
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t mpu6050_get_all(mpu6050_handle_t sensor, mpu6050_acce_value_t *const acce_value,
+                          mpu6050_gyro_value_t *const gyro_value, mpu6050_temp_value_t *const temp_value);
+
 /**
  * @brief Use complimentory filter to calculate roll and pitch
  *
@@ -394,6 +458,94 @@ esp_err_t mpu6050_get_temp(mpu6050_handle_t sensor, mpu6050_temp_value_t *const
 esp_err_t mpu6050_complimentory_filter(mpu6050_handle_t sensor, const mpu6050_acce_value_t *const acce_value,
                                        const mpu6050_gyro_value_t *const gyro_value, complimentary_angle_t *const complimentary_angle);
 
+/**
+ * @brief Enable FIFO with accelerometer, temperature and gyroscope frames
+ *
+ * The FIFO is reset. Each sample is one frame of MPU6050_FIFO_FRAME_SIZE bytes.
+ *
+ * @param sensor object handle of mpu6050
+ * @param sample_rate_div sample rate divider (sample rate = gyroscope output rate / (1 + sample_rate_div))
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t mpu6050_fifo_enable(mpu6050_handle_t sensor, uint8_t sample_rate_div);
+
+/**
+ * @brief Disable FIFO
+ *
+ * @param sensor object handle of mpu6050
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t mpu6050_fifo_disable(mpu6050_handle_t sensor);
+
+/**
+ * @brief Get count of samples in FIFO
+ *
+ * @param sensor object handle of mpu6050
+ * @param count count of complete frames in FIFO
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_SIZE FIFO overflowed, it must be reset by mpu6050_fifo_enable()
+ *     - ESP_FAIL Fail
+ */
+esp_err_t mpu6050_fifo_get_count(mpu6050_handle_t sensor, uint16_t *const count);
+
+/**
+ * @brief Read samples from FIFO in one I2C transaction
+ *
+ * @note Timestamps are not set
+ *
+ * @param sensor object handle of mpu6050
+ * @param samples read samples
+ * @param count count of samples to read (must be in FIFO already, see mpu6050_fifo_get_count())
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Invalid count
+ *     - ESP_ERR_NO_MEM Not enough memory for the read buffer
+ *     - ESP_FAIL Fail
+ */
+esp_err_t mpu6050_fifo_read(mpu6050_handle_t sensor, mpu6050_fifo_sample_t *const samples, uint16_t count);
+
+/**
+ * @brief Start streaming of FIFO samples
+ *
+ * FIFO is enabled and a task reads `watermark` samples in one I2C transaction and passes them to the callback.
+ * When the INT pin is configured by mpu6050_config_interrupts(), the task is woken by DATA READY interrupts
+ * at the watermark (MPU6050 has no FIFO watermark interrupt). Otherwise the FIFO is polled once per watermark period.
+ *
+ * @note Do not register own ISR by mpu6050_register_isr() and do not access the sensor from other tasks while streaming
+ *
+ * @param sensor object handle of mpu6050
+ * @param config stream configuration
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Invalid configuration
+ *     - ESP_ERR_INVALID_STATE Stream is running already
+ *     - ESP_ERR_NO_MEM Not enough memory for the stream
+ *     - ESP_FAIL Fail
+ */
+esp_err_t mpu6050_fifo_stream_start(mpu6050_handle_t sensor, const mpu6050_fifo_stream_config_t *const config);
+
+/**
+ * @brief Stop streaming of FIFO samples and disable FIFO
+ *
+ * @param sensor object handle of mpu6050
+ * @param overflow_cnt count of FIFO overflows during streaming (can be NULL)
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_STATE Stream is not running
+ */
+esp_err_t mpu6050_fifo_stream_stop(mpu6050_handle_t sensor, uint32_t *const overflow_cnt);
+
 #ifdef __cplusplus
 }
 #endif
@@ -5,41 +5,81 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include <time.h>
 #include <sys/time.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_system.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
 #include "driver/i2c.h"
 #include "mpu6050.h"
 
+static const char *TAG = "mpu6050";
+
 #define ALPHA                       0.99f        /*!< Weight of gyroscope */
 #define RAD_TO_DEG                  57.27272727f /*!< Radians to degrees */
 
 /* MPU6050 register */
+#define MPU6050_SMPLRT_DIV          0x19u
+#define MPU6050_CONFIG              0x1Au
 #define MPU6050_GYRO_CONFIG         0x1Bu
 #define MPU6050_ACCEL_CONFIG        0x1Cu
+#define MPU6050_FIFO_EN             0x23u
 #define MPU6050_INTR_PIN_CFG         0x37u
 #define MPU6050_INTR_ENABLE          0x38u
 #define MPU6050_INTR_STATUS          0x3Au
 #define MPU6050_ACCEL_XOUT_H        0x3Bu
 #define MPU6050_GYRO_XOUT_H         0x43u
 #define MPU6050_TEMP_XOUT_H         0x41u
+#define MPU6050_USER_CTRL           0x6Au
 #define MPU6050_PWR_MGMT_1          0x6Bu
+#define MPU6050_FIFO_COUNT_H        0x72u
+#define MPU6050_FIFO_R_W            0x74u
 #define MPU6050_WHO_AM_I            0x75u
 
+/* FIFO_EN: temperature, gyroscope X, Y, Z and accelerometer, frame is ordered by register address */
+#define MPU6050_FIFO_EN_ALL         (BIT7 | BIT6 | BIT5 | BIT4 | BIT3)
+#define MPU6050_USER_CTRL_FIFO_EN   BIT6
+#define MPU6050_USER_CTRL_FIFO_RST  BIT2
+
 const uint8_t MPU6050_DATA_RDY_INT_BIT =      (uint8_t) BIT0;
 const uint8_t MPU6050_I2C_MASTER_INT_BIT =    (uint8_t) BIT3;
 const uint8_t MPU6050_FIFO_OVERFLOW_INT_BIT = (uint8_t) BIT4;
 const uint8_t MPU6050_MOT_DETECT_INT_BIT =    (uint8_t) BIT6;
 const uint8_t MPU6050_ALL_INTERRUPTS = (MPU6050_DATA_RDY_INT_BIT | MPU6050_I2C_MASTER_INT_BIT | MPU6050_FIFO_OVERFLOW_INT_BIT | MPU6050_MOT_DETECT_INT_BIT);
 
+typedef struct {
+    mpu6050_fifo_stream_config_t config;
+    TaskHandle_t task;
+    SemaphoreHandle_t exited;
+    uint8_t *buf;                   /* Raw frames of one burst */
+    mpu6050_fifo_sample_t *samples; /* Parsed frames of one burst */
+    uint32_t period_us;             /* Sample period */
+    uint32_t isr_cnt;               /* Data ready interrupts since the last wake up of the task */
+    uint32_t overflow_cnt;
+    bool use_isr;
+    volatile bool running;
+} mpu6050_fifo_stream_t;
+
 typedef struct {
     i2c_port_t bus;
     gpio_num_t int_pin;
+    bool int_configured;
     uint16_t dev_addr;
+    uint8_t cmd_buf[I2C_LINK_RECOMMENDED_SIZE(2)]; /* Command link of the device, no heap allocation per access */
     uint32_t counter;
     float dt;  /*!< delay time between two measurements, dt should be small (ms level) */
     struct timeval *timer;
+    float acce_sensitivity;         /* Sensitivities of the configured ranges (0: not known yet) */
+    float gyro_sensitivity;
+    uint32_t fifo_period_us;        /* Sample period of FIFO */
+    mpu6050_fifo_stream_t *stream;
 } mpu6050_dev_t;
 
 static esp_err_t mpu6050_write(mpu6050_handle_t sensor, const uint8_t reg_start_addr, const uint8_t *const data_buf, const uint8_t data_len)
@@ -47,7 +87,7 @@ static esp_err_t mpu6050_write(mpu6050_handle_t sensor, const uint8_t reg_start_
     mpu6050_dev_t *sens = (mpu6050_dev_t *) sensor;
     esp_err_t  ret;
 
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(sens->cmd_buf, sizeof(sens->cmd_buf));
     ret = i2c_master_start(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_write_byte(cmd, sens->dev_addr | I2C_MASTER_WRITE, true);
@@ -59,17 +99,17 @@ static esp_err_t mpu6050_write(mpu6050_handle_t sensor, const uint8_t reg_start_
     ret = i2c_master_stop(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_cmd_begin(sens->bus, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
+    i2c_cmd_link_delete_static(cmd);
 
     return ret;
 }
 
-static esp_err_t mpu6050_read(mpu6050_handle_t sensor, const uint8_t reg_start_addr, uint8_t *const data_buf, const uint8_t data_len)
+static esp_err_t mpu6050_read(mpu6050_handle_t sensor, const uint8_t reg_start_addr, uint8_t *const data_buf, const size_t data_len)
 {
     mpu6050_dev_t *sens = (mpu6050_dev_t *) sensor;
     esp_err_t  ret;
 
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(sens->cmd_buf, sizeof(sens->cmd_buf));
     ret = i2c_master_start(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_write_byte(cmd, sens->dev_addr | I2C_MASTER_WRITE, true);
@@ -85,7 +125,7 @@ static esp_err_t mpu6050_read(mpu6050_handle_t sensor, const uint8_t reg_start_a
     ret = i2c_master_stop(cmd);
     assert(ESP_OK == ret);
     ret = i2c_master_cmd_begin(sens->bus, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
+    i2c_cmd_link_delete_static(cmd);
 
     return ret;
 }
@@ -104,6 +144,10 @@ mpu6050_handle_t mpu6050_create(i2c_port_t port, const uint16_t dev_addr)
 void mpu6050_delete(mpu6050_handle_t sensor)
 {
     mpu6050_dev_t *sens = (mpu6050_dev_t *) sensor;
+    if (sens->stream) {
+        mpu6050_fifo_stream_stop(sensor, NULL);
+    }
+    free(sens->timer);
     free(sens);
 }
 
@@ -140,8 +184,24 @@ esp_err_t mpu6050_sleep(mpu6050_handle_t sensor)
 
 esp_err_t mpu6050_config(mpu6050_handle_t sensor, const mpu6050_acce_fs_t acce_fs, const mpu6050_gyro_fs_t gyro_fs)
 {
+    mpu6050_dev_t *sens = (mpu6050_dev_t *) sensor;
     uint8_t config_regs[2] = {gyro_fs << 3,  acce_fs << 3};
-    return mpu6050_write(sensor, MPU6050_GYRO_CONFIG, config_regs, sizeof(config_regs));
+    esp_err_t ret = mpu6050_write(sensor, MPU6050_GYRO_CONFIG, config_regs, sizeof(config_regs));
+    if (ESP_OK != ret) {
+        return ret;
+    }
+
+    /* Read back, the sensitivities are stored for mpu6050_get_all() */
+    ret = mpu6050_get_acce_sensitivity(sensor, &sens->acce_sensitivity);
+    if (ESP_OK != ret) {
+        sens->acce_sensitivity = 0;
+        return ret;
+    }
+    ret = mpu6050_get_gyro_sensitivity(sensor, &sens->gyro_sensitivity);
+    if (ESP_OK != ret) {
+        sens->gyro_sensitivity = 0;
+    }
+    return ret;
 }
 
 esp_err_t mpu6050_get_acce_sensitivity(mpu6050_handle_t sensor, float *const acce_sensitivity)
@@ -215,6 +275,7 @@ esp_err_t mpu6050_config_interrupts(mpu6050_handle_t sensor, const mpu6050_int_c
         // Set GPIO connected to MPU6050 INT pin only when user configures interrupts.
         mpu6050_dev_t *sensor_device = (mpu6050_dev_t *) sensor;
         sensor_device->int_pin = interrupt_configuration->interrupt_pin;
+        sensor_device->int_configured = true;
     } else {
         ret = ESP_ERR_INVALID_ARG;
         return ret;
@@ -437,6 +498,83 @@ esp_err_t mpu6050_get_temp(mpu6050_handle_t sensor, mpu6050_temp_value_t *const
     return ret;
 }
 
+static void mpu6050_parse_frame(const uint8_t *frame, mpu6050_raw_acce_value_t *const raw_acce_value,
+                                int16_t *const raw_temp, mpu6050_raw_gyro_value_t *const raw_gyro_value)
+{
+    /* Accelerometer, temperature and gyroscope registers are contiguous, FIFO frames have the same layout */
+    raw_acce_value->raw_acce_x = (int16_t)((frame[0] << 8) | frame[1]);
+    raw_acce_value->raw_acce_y = (int16_t)((frame[2] << 8) | frame[3]);
+    raw_acce_value->raw_acce_z = (int16_t)((frame[4] << 8) | frame[5]);
+    *raw_temp = (int16_t)((frame[6] << 8) | frame[7]);
+    raw_gyro_value->raw_gyro_x = (int16_t)((frame[8] << 8) | frame[9]);
+    raw_gyro_value->raw_gyro_y = (int16_t)((frame[10] << 8) | frame[11]);
+    raw_gyro_value->raw_gyro_z = (int16_t)((frame[12] << 8) | frame[13]);
+}
+
+esp_err_t mpu6050_get_all_raw(mpu6050_handle_t sensor, mpu6050_raw_acce_value_t *const raw_acce_value,
+                              mpu6050_raw_gyro_value_t *const raw_gyro_value, int16_t *const raw_temp)
+{
+    uint8_t data_rd[MPU6050_FIFO_FRAME_SIZE];
+    int16_t temp;
+
+    if (NULL == raw_acce_value || NULL == raw_gyro_value) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = mpu6050_read(sensor, MPU6050_ACCEL_XOUT_H, data_rd, sizeof(data_rd));
+    if (ESP_OK != ret) {
+        return ret;
+    }
+
+    mpu6050_parse_frame(data_rd, raw_acce_value, &temp, raw_gyro_value);
+    if (raw_temp) {
+        *raw_temp = temp;
+    }
+    return ESP_OK;
+}
+
+esp_err_t mpu6050_get_all(mpu6050_handle_t sensor, mpu6050_acce_value_t *const acce_value,
+                          mpu6050_gyro_value_t *const gyro_value, mpu6050_temp_value_t *const temp_value)
+{
+    esp_err_t ret;
+    mpu6050_raw_acce_value_t raw_acce;
+    mpu6050_raw_gyro_value_t raw_gyro;
+    int16_t raw_temp;
+    mpu6050_dev_t *sens = (mpu6050_dev_t *) sensor;
+
+    if (NULL == sens || NULL == acce_value || NULL == gyro_value) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* Without mpu6050_config(), the sensitivities are read only once */
+    if (0 == sens->acce_sensitivity || 0 == sens->gyro_sensitivity) {
+        ret = mpu6050_get_acce_sensitivity(sensor, &sens->acce_sensitivity);
+        if (ret == ESP_OK) {
+            ret = mpu6050_get_gyro_sensitivity(sensor, &sens->gyro_sensitivity);
+        }
+        if (ret != ESP_OK) {
+            sens->acce_sensitivity = 0;
+            return ret;
+        }
+    }
+
+    ret = mpu6050_get_all_raw(sensor, &raw_acce, &raw_gyro, &raw_temp);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    acce_value->acce_x = raw_acce.raw_acce_x / sens->acce_sensitivity;
+    acce_value->acce_y = raw_acce.raw_acce_y / sens->acce_sensitivity;
+    acce_value->acce_z = raw_acce.raw_acce_z / sens->acce_sensitivity;
+    gyro_value->gyro_x = raw_gyro.raw_gyro_x / sens->gyro_sensitivity;
+    gyro_value->gyro_y = raw_gyro.raw_gyro_y / sens->gyro_sensitivity;
+    gyro_value->gyro_z = raw_gyro.raw_gyro_z / sens->gyro_sensitivity;
+    if (temp_value) {
+        temp_value->temp = raw_temp / 340.00 + 36.53;
+    }
+    return ESP_OK;
+}
+
 esp_err_t mpu6050_complimentory_filter(mpu6050_handle_t sensor, const mpu6050_acce_value_t *const acce_value,
                                        const mpu6050_gyro_value_t *const gyro_value, complimentary_angle_t *const complimentary_angle)
 {
@@ -474,3 +612,291 @@ esp_err_t mpu6050_complimentory_filter(mpu6050_handle_t sensor, const mpu6050_ac
 
     return ESP_OK;
 }
+
+esp_err_t mpu6050_fifo_enable(mpu6050_handle_t sensor, uint8_t sample_rate_div)
+{
+    esp_err_t ret;
+    uint8_t dlpf_cfg;
+    uint8_t user_ctrl;
+    mpu6050_dev_t *sens = (mpu6050_dev_t *) sensor;
+
+    if (NULL == sens) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ret = mpu6050_write(sensor, MPU6050_SMPLRT_DIV, &sample_rate_div, 1);
+    if (ESP_OK != ret) {
+        return ret;
+    }
+
+    /* Gyroscope output rate is 8 kHz only without digital low pass filter */
+    ret = mpu6050_read(sensor, MPU6050_CONFIG, &dlpf_cfg, 1);
+    if (ESP_OK != ret) {
+        return ret;
+    }
+    dlpf_cfg &= 0x07;
+    const uint32_t gyro_rate = (dlpf_cfg == 0 || dlpf_cfg == 7) ? 8000 : 1000;
+    sens->fifo_period_us = (1000000u * (1u + sample_rate_div)) / gyro_rate;
+
+    /* Stop and reset FIFO, so the first frame is aligned */
+    ret = mpu6050_read(sensor, MPU6050_USER_CTRL, &user_ctrl, 1);
+    if (ESP_OK != ret) {
+        return ret;
+    }
+    user_ctrl &= ~MPU6050_USER_CTRL_FIFO_EN;
+    user_ctrl |= MPU6050_USER_CTRL_FIFO_RST;
+    ret = mpu6050_write(sensor, MPU6050_USER_CTRL, &user_ctrl, 1);
+    if (ESP_OK != ret) {
+        return ret;
+    }
+
+    uint8_t fifo_en = MPU6050_FIFO_EN_ALL;
+    ret = mpu6050_write(sensor, MPU6050_FIFO_EN, &fifo_en, 1);
+    if (ESP_OK != ret) {
+        return ret;
+    }
+
+    user_ctrl &= ~MPU6050_USER_CTRL_FIFO_RST;
+    user_ctrl |= MPU6050_USER_CTRL_FIFO_EN;
+    return mpu6050_write(sensor, MPU6050_USER_CTRL, &user_ctrl, 1);
+}
+
+esp_err_t mpu6050_fifo_disable(mpu6050_handle_t sensor)
+{
+    esp_err_t ret;
+    uint8_t user_ctrl;
+
+    if (NULL == sensor) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t fifo_en = 0;
+    ret = mpu6050_write(sensor, MPU6050_FIFO_EN, &fifo_en, 1);
+    if (ESP_OK != ret) {
+        return ret;
+    }
+
+    ret = mpu6050_read(sensor, MPU6050_USER_CTRL, &user_ctrl, 1);
+    if (ESP_OK != ret) {
+        return ret;
+    }
+    user_ctrl &= ~MPU6050_USER_CTRL_FIFO_EN;
+    user_ctrl |= MPU6050_USER_CTRL_FIFO_RST;
+    return mpu6050_write(sensor, MPU6050_USER_CTRL, &user_ctrl, 1);
+}
+
+esp_err_t mpu6050_fifo_get_count(mpu6050_handle_t sensor, uint16_t *const count)
+{
+    uint8_t data_rd[2];
+
+    if (NULL == sensor || NULL == count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = mpu6050_read(sensor, MPU6050_FIFO_COUNT_H, data_rd, sizeof(data_rd));
+    if (ESP_OK != ret) {
+        return ret;
+    }
+
+    const uint16_t bytes = (data_rd[0] << 8) | data_rd[1];
+    *count = bytes / MPU6050_FIFO_FRAME_SIZE;
+    /* Full FIFO drops the oldest bytes, the frames are not aligned anymore */
+    return (bytes >= MPU6050_FIFO_SIZE) ? ESP_ERR_INVALID_SIZE : ESP_OK;
+}
+
+static void mpu6050_fifo_parse(const uint8_t *buf, mpu6050_fifo_sample_t *const samples, uint16_t count)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        mpu6050_parse_frame(&buf[i * MPU6050_FIFO_FRAME_SIZE], &samples[i].acce, &samples[i].raw_temp, &samples[i].gyro);
+    }
+}
+
+esp_err_t mpu6050_fifo_read(mpu6050_handle_t sensor, mpu6050_fifo_sample_t *const samples, uint16_t count)
+{
+    if (NULL == sensor || NULL == samples || 0 == count || count > MPU6050_FIFO_FRAMES_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t *buf = malloc(count * MPU6050_FIFO_FRAME_SIZE);
+    if (NULL == buf) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* FIFO_R_W address does not increment, all frames are read in one transaction */
+    esp_err_t ret = mpu6050_read(sensor, MPU6050_FIFO_R_W, buf, count * MPU6050_FIFO_FRAME_SIZE);
+    if (ESP_OK == ret) {
+        mpu6050_fifo_parse(buf, samples, count);
+    }
+    free(buf);
+    return ret;
+}
+
+static void IRAM_ATTR mpu6050_fifo_isr(void *arg)
+{
+    mpu6050_fifo_stream_t *stream = (mpu6050_fifo_stream_t *) arg;
+    BaseType_t task_woken = pdFALSE;
+
+    /* MPU6050 has no FIFO watermark interrupt, data ready interrupts are counted */
+    if (++stream->isr_cnt >= stream->config.watermark) {
+        stream->isr_cnt = 0;
+        vTaskNotifyGiveFromISR(stream->task, &task_woken);
+    }
+    if (task_woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static void mpu6050_fifo_task(void *arg)
+{
+    mpu6050_dev_t *sens = (mpu6050_dev_t *) arg;
+    mpu6050_fifo_stream_t *stream = sens->stream;
+    const uint16_t watermark = stream->config.watermark;
+    const uint32_t burst_us = watermark * stream->period_us;
+    /* With interrupts, the timeout only recovers from a lost interrupt */
+    const TickType_t wait = MAX(pdMS_TO_TICKS((stream->use_isr ? 2 : 1) * burst_us / 1000), 1);
+
+    while (stream->running) {
+        ulTaskNotifyTake(pdTRUE, wait);
+        if (!stream->running) {
+            break;
+        }
+
+        uint16_t count;
+        esp_err_t ret = mpu6050_fifo_get_count(sens, &count);
+        const int64_t now = esp_timer_get_time();
+        if (ESP_ERR_INVALID_SIZE == ret) {
+            stream->overflow_cnt++;
+            ESP_LOGW(TAG, "FIFO overflow, reset");
+            mpu6050_fifo_enable(sens, stream->config.sample_rate_div);
+            stream->isr_cnt = 0;
+            continue;
+        } else if (ESP_OK != ret || count < watermark) {
+            continue;
+        }
+
+        /* The newest frame in FIFO was sampled now, the burst contains the oldest frames */
+        if (ESP_OK != mpu6050_read(sens, MPU6050_FIFO_R_W, stream->buf, watermark * MPU6050_FIFO_FRAME_SIZE)) {
+            continue;
+        }
+        mpu6050_fifo_parse(stream->buf, stream->samples, watermark);
+        for (uint16_t i = 0; i < watermark; i++) {
+            stream->samples[i].timestamp_us = now - (int64_t)(count - 1 - i) * stream->period_us;
+        }
+        stream->config.callback(stream->samples, watermark, stream->config.user_ctx);
+    }
+
+    xSemaphoreGive(stream->exited);
+    vTaskDelete(NULL);
+}
+
+static void mpu6050_fifo_stream_free(mpu6050_fifo_stream_t *stream)
+{
+    if (stream->exited) {
+        vSemaphoreDelete(stream->exited);
+    }
+    free(stream->buf);
+    free(stream->samples);
+    free(stream);
+}
+
+esp_err_t mpu6050_fifo_stream_start(mpu6050_handle_t sensor, const mpu6050_fifo_stream_config_t *const config)
+{
+    esp_err_t ret;
+    BaseType_t res;
+    mpu6050_dev_t *sens = (mpu6050_dev_t *) sensor;
+
+    if (NULL == sens || NULL == config || NULL == config->callback ||
+            0 == config->watermark || config->watermark > MPU6050_FIFO_FRAMES_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (NULL != sens->stream) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    mpu6050_fifo_stream_t *stream = calloc(1, sizeof(mpu6050_fifo_stream_t));
+    if (NULL == stream) {
+        return ESP_ERR_NO_MEM;
+    }
+    stream->config = *config;
+    stream->buf = malloc(config->watermark * MPU6050_FIFO_FRAME_SIZE);
+    stream->samples = malloc(config->watermark * sizeof(mpu6050_fifo_sample_t));
+    stream->exited = xSemaphoreCreateBinary();
+    if (NULL == stream->buf || NULL == stream->samples || NULL == stream->exited) {
+        mpu6050_fifo_stream_free(stream);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ret = mpu6050_fifo_enable(sensor, config->sample_rate_div);
+    if (ESP_OK != ret) {
+        mpu6050_fifo_stream_free(stream);
+        return ret;
+    }
+    stream->period_us = sens->fifo_period_us;
+    stream->use_isr = sens->int_configured;
+    stream->running = true;
+    sens->stream = stream;
+
+    if (config->task_affinity < 0) {
+        res = xTaskCreate(mpu6050_fifo_task, "mpu6050_fifo", config->task_stack, sens, config->task_priority, &stream->task);
+    } else {
+        res = xTaskCreatePinnedToCore(mpu6050_fifo_task, "mpu6050_fifo", config->task_stack, sens, config->task_priority,
+                                      &stream->task, config->task_affinity);
+    }
+    if (pdPASS != res) {
+        ret = ESP_ERR_NO_MEM;
+        goto err;
+    }
+
+    if (stream->use_isr) {
+        ret = gpio_isr_handler_add(sens->int_pin, mpu6050_fifo_isr, stream);
+        if (ESP_OK == ret) {
+            ret = gpio_intr_enable(sens->int_pin);
+        }
+        if (ESP_OK == ret) {
+            ret = mpu6050_enable_interrupts(sensor, MPU6050_DATA_RDY_INT_BIT);
+        }
+        if (ESP_OK != ret) {
+            gpio_isr_handler_remove(sens->int_pin);
+            stream->running = false;
+            xTaskNotifyGive(stream->task);
+            xSemaphoreTake(stream->exited, portMAX_DELAY);
+            goto err;
+        }
+    }
+    return ESP_OK;
+
+err:
+    sens->stream = NULL;
+    mpu6050_fifo_disable(sensor);
+    mpu6050_fifo_stream_free(stream);
+    return ret;
+}
+
+esp_err_t mpu6050_fifo_stream_stop(mpu6050_handle_t sensor, uint32_t *const overflow_cnt)
+{
+    mpu6050_dev_t *sens = (mpu6050_dev_t *) sensor;
+
+    if (NULL == sens || NULL == sens->stream) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    mpu6050_fifo_stream_t *stream = sens->stream;
+
+    if (stream->use_isr) {
+        gpio_isr_handler_remove(sens->int_pin);
+    }
+    /* The task finishes the running burst */
+    stream->running = false;
+    xTaskNotifyGive(stream->task);
+    xSemaphoreTake(stream->exited, portMAX_DELAY);
+
+    if (stream->use_isr) {
+        mpu6050_disable_interrupts(sensor, MPU6050_DATA_RDY_INT_BIT);
+    }
+    mpu6050_fifo_disable(sensor);
+    if (overflow_cnt) {
+        *overflow_cnt = stream->overflow_cnt;
+    }
+    sens->stream = NULL;
+    mpu6050_fifo_stream_free(stream);
+    return ESP_OK;
+}
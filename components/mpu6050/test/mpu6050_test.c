@@ -6,15 +6,20 @@
 
 #include <stdio.h>
 #include "unity.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "driver/i2c.h"
 #include "mpu6050.h"
 #include "esp_system.h"
 #include "esp_log.h"
+#include "i2c_bus_stats.h"
 
 #define I2C_MASTER_SCL_IO 26      /*!< gpio number for I2C master clock */
 #define I2C_MASTER_SDA_IO 25      /*!< gpio number for I2C master data  */
 #define I2C_MASTER_NUM I2C_NUM_0  /*!< I2C port number for master dev */
 #define I2C_MASTER_FREQ_HZ 100000 /*!< I2C master clock frequency */
+#define PERF_ITERATIONS 1000      /*!< Number of readings in performance test */
+#define PERF_FIFO_FRAMES 4        /*!< Frames read from FIFO at once in performance test */
 
 static const char *TAG = "mpu6050 test";
 static mpu6050_handle_t mpu6050 = NULL;
@@ -84,7 +89,74 @@ TEST_CASE("Sensor mpu6050 test", "[mpu6050][iot][sensor]")
     TEST_ASSERT_EQUAL(ESP_OK, ret);
     ESP_LOGI(TAG, "t:%.2f \n", temp.temp);
 
+    ret = mpu6050_get_all(mpu6050, &acce, &gyro, &temp);
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+    ESP_LOGI(TAG, "all: acce_z:%.2f, gyro_z:%.2f, t:%.2f\n", acce.acce_z, gyro.gyro_z, temp.temp);
+
+    mpu6050_fifo_sample_t samples[4];
+    uint16_t fifo_count;
+    ret = mpu6050_fifo_enable(mpu6050, 19); // 400 Hz or 50 Hz with DLPF
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+    vTaskDelay(pdMS_TO_TICKS(100));
+    ret = mpu6050_fifo_get_count(mpu6050, &fifo_count);
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+    TEST_ASSERT_GREATER_OR_EQUAL(4, fifo_count);
+    ret = mpu6050_fifo_read(mpu6050, samples, 4);
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+    ESP_LOGI(TAG, "fifo: %u frames, acce_z:%d\n", fifo_count, samples[3].acce.raw_acce_z);
+    ret = mpu6050_fifo_disable(mpu6050);
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+
     mpu6050_delete(mpu6050);
     ret = i2c_driver_delete(I2C_MASTER_NUM);
     TEST_ASSERT_EQUAL(ESP_OK, ret);
 }
+
+static esp_err_t mpu6050_perf_get_separate(void *ctx)
+{
+    mpu6050_acce_value_t acce;
+    mpu6050_gyro_value_t gyro;
+    mpu6050_temp_value_t temp;
+    esp_err_t ret = mpu6050_get_acce(mpu6050, &acce);
+    if (ret == ESP_OK) {
+        ret = mpu6050_get_gyro(mpu6050, &gyro);
+    }
+    if (ret == ESP_OK) {
+        ret = mpu6050_get_temp(mpu6050, &temp);
+    }
+    return ret;
+}
+
+static esp_err_t mpu6050_perf_get_all(void *ctx)
+{
+    mpu6050_acce_value_t acce;
+    mpu6050_gyro_value_t gyro;
+    mpu6050_temp_value_t temp;
+    return mpu6050_get_all(mpu6050, &acce, &gyro, &temp);
+}
+
+static esp_err_t mpu6050_perf_fifo_read(void *ctx)
+{
+    mpu6050_fifo_sample_t samples[PERF_FIFO_FRAMES];
+    return mpu6050_fifo_read(mpu6050, samples, PERF_FIFO_FRAMES);
+}
+
+TEST_CASE("Sensor mpu6050 performance", "[mpu6050][iot][sensor][perf]")
+{
+    i2c_bus_perf_result_t separate, all, fifo;
+
+    i2c_sensor_mpu6050_init();
+
+    /* Accelerometer, gyroscope and temperature by separate calls, in one burst and from FIFO */
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_perf_run("mpu6050", "get_acce_gyro_temp", mpu6050_perf_get_separate, NULL, PERF_ITERATIONS, 1, &separate));
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_perf_run("mpu6050", "get_all", mpu6050_perf_get_all, NULL, PERF_ITERATIONS, 1, &all));
+    TEST_ASSERT_EQUAL(ESP_OK, mpu6050_fifo_enable(mpu6050, 0));
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_perf_run("mpu6050", "fifo_read_4", mpu6050_perf_fifo_read, NULL, PERF_ITERATIONS, PERF_FIFO_FRAMES, &fifo));
+    TEST_ASSERT_EQUAL(ESP_OK, mpu6050_fifo_disable(mpu6050));
+
+    TEST_ASSERT(all.transactions < separate.transactions);
+    TEST_ASSERT(fifo.transactions < all.transactions);
+
+    mpu6050_delete(mpu6050);
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_driver_delete(I2C_MASTER_NUM));
+}
@@ -0,0 +1,202 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Publish queue
+ *
+ * Bounded outbox between producers (sensor readings) and a publisher (e.g. MQTT client). Producers only copy
+ * the message into the outbox (in PSRAM, if available) and never wait for the network; a background task
+ * publishes the messages while connected. Messages with QoS > 0 stay in the outbox until their delivery is
+ * confirmed, messages of a coalesced topic are replaced by newer ones, and a full outbox is reported to producers.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Publish callback, it must not block on the network (e.g. esp_mqtt_client_enqueue or publish)
+ *
+ * @note It is called from the publish queue task
+ *
+ * @param topic     Topic of the message
+ * @param data      Message
+ * @param len       Length of the message [bytes]
+ * @param qos       QoS of the message
+ * @param user_ctx  User context from the configuration
+ * @return Message ID (>= 0) passed to publish_queue_delivered() for QoS > 0, negative value on failure
+ */
+typedef int (*publish_queue_publish_cb_t)(const char *topic, const uint8_t *data, size_t len, int qos, void *user_ctx);
+
+/**
+ * @brief Backpressure callback, called when the outbox gets over the high watermark and back under the low watermark
+ *
+ * @param congested True over the high watermark
+ * @param user_ctx  User context from the configuration
+ */
+typedef void (*publish_queue_backpressure_cb_t)(bool congested, void *user_ctx);
+
+/**
+ * @brief Publish queue configuration
+ */
+typedef struct {
+    size_t capacity;                            /*!< Size of the outbox [bytes], messages with their topics */
+    uint32_t high_watermark_pct;                /*!< Congested over this fill level of the outbox [%] */
+    uint32_t low_watermark_pct;                 /*!< Not congested under this fill level of the outbox [%] */
+    uint32_t max_inflight;                      /*!< Maximum count of published messages waiting for delivery */
+    uint32_t retry_ms;                          /*!< Publish again QoS > 0 message not delivered in this time */
+    publish_queue_publish_cb_t publish_cb;      /*!< Publishes the messages */
+    publish_queue_backpressure_cb_t backpressure_cb; /*!< Congestion notification (can be NULL) */
+    void *user_ctx;                             /*!< Passed to the callbacks */
+    int task_priority;                          /*!< Priority of the publish task */
+    int task_stack;                             /*!< Stack size of the publish task [bytes] */
+    int task_affinity;                          /*!< Core of the publish task (-1 for no affinity) */
+} publish_queue_config_t;
+
+/**
+ * @brief Default publish queue configuration
+ */
+#define PUBLISH_QUEUE_CONFIG_DEFAULT(cb, ctx)   \
+    {                                           \
+        .capacity = 16 * 1024,                  \
+        .high_watermark_pct = 75,               \
+        .low_watermark_pct = 50,                \
+        .max_inflight = 4,                      \
+        .retry_ms = 10000,                      \
+        .publish_cb = (cb),                     \
+        .user_ctx = (ctx),                      \
+        .task_priority = 4,                     \
+        .task_stack = 3072,                     \
+        .task_affinity = -1,                    \
+    }
+
+/**
+ * @brief Flags of the message
+ */
+typedef enum {
+    PUBLISH_QUEUE_FLAG_COALESCE = (1 << 0),     /*!< Replace message of the same topic, which was not published yet */
+} publish_queue_flags_t;
+
+/**
+ * @brief Publish queue statistics
+ */
+typedef struct {
+    uint32_t queued;            /*!< Messages added to the outbox */
+    uint32_t published;         /*!< Messages published (QoS 0) or delivered (QoS > 0) */
+    uint32_t coalesced;         /*!< Messages replaced by newer message of the same topic */
+    uint32_t dropped;           /*!< QoS 0 messages dropped to make room for new messages */
+    uint32_t rejected;          /*!< Messages not added, the outbox was full */
+    uint32_t retries;           /*!< Messages published again */
+    uint32_t depth;             /*!< Messages in the outbox now */
+    uint32_t depth_max;         /*!< Maximum count of messages in the outbox */
+    size_t used;                /*!< Used bytes of the outbox now */
+    uint32_t throughput_bps;    /*!< Published bytes per second since the previous call */
+} publish_queue_stats_t;
+
+/**
+ * @brief Publish queue handle
+ */
+typedef struct publish_queue_s *publish_queue_handle_t;
+
+/**
+ * @brief Create publish queue and its task
+ *
+ * @param config        Configuration
+ * @param ret_queue     Created queue
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if there is no memory for the outbox or the task
+ */
+esp_err_t publish_queue_create(const publish_queue_config_t *config, publish_queue_handle_t *ret_queue);
+
+/**
+ * @brief Delete publish queue, messages not published are dropped
+ *
+ * @param queue     Queue
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t publish_queue_delete(publish_queue_handle_t queue);
+
+/**
+ * @brief Add message to the outbox
+ *
+ * The message is copied, the function never waits. When the outbox is full, the oldest QoS 0 messages are dropped
+ * to make room. QoS > 0 messages are never dropped, the new message is rejected instead.
+ *
+ * @note Thread-safe
+ *
+ * @param queue     Queue
+ * @param topic     Topic
+ * @param data      Message
+ * @param len       Length of the message [bytes]
+ * @param qos       QoS of the message (0 - 2)
+ * @param flags     Flags of the message (publish_queue_flags_t)
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if the outbox is full, the producer should keep the data and back off
+ */
+esp_err_t publish_queue_add(publish_queue_handle_t queue, const char *topic, const uint8_t *data, size_t len, int qos, uint32_t flags);
+
+/**
+ * @brief Set connection state of the publisher
+ *
+ * Messages are published only while connected. On disconnection, messages waiting for delivery are published
+ * again after reconnection.
+ *
+ * @param queue     Queue
+ * @param connected Publisher is connected
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t publish_queue_set_connected(publish_queue_handle_t queue, bool connected);
+
+/**
+ * @brief Confirm delivery of QoS > 0 message (e.g. MQTT_EVENT_PUBLISHED), it is removed from the outbox
+ *
+ * @param queue     Queue
+ * @param msg_id    Message ID returned by the publish callback
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NOT_FOUND     if no message waits for delivery with the ID
+ */
+esp_err_t publish_queue_delivered(publish_queue_handle_t queue, int msg_id);
+
+/**
+ * @brief Check if the outbox is over its high watermark (until it gets under the low watermark)
+ *
+ * @param queue     Queue
+ * @return True if the producers should back off
+ */
+bool publish_queue_is_congested(publish_queue_handle_t queue);
+
+/**
+ * @brief Get statistics, throughput is computed since the previous call
+ *
+ * @param queue     Queue
+ * @param stats     Statistics
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t publish_queue_get_stats(publish_queue_handle_t queue, publish_queue_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
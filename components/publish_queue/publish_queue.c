@@ -0,0 +1,394 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/queue.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "publish_queue.h"
+
+static const char *TAG = "publish_queue";
+
+/* Wait before next publish after the publish callback failed */
+#define PUBLISH_QUEUE_FAIL_DELAY_MS     1000
+
+typedef enum {
+    PUBLISH_QUEUE_MSG_PENDING = 0,      /* Waiting for publish */
+    PUBLISH_QUEUE_MSG_SENDING,          /* Passed to the publish callback now */
+    PUBLISH_QUEUE_MSG_INFLIGHT,         /* Published, waiting for delivery (QoS > 0) */
+} publish_queue_msg_state_t;
+
+typedef struct publish_queue_msg_s {
+    TAILQ_ENTRY(publish_queue_msg_s) entry;
+    publish_queue_msg_state_t state;
+    int msg_id;
+    int64_t sent_time;
+    uint32_t attempts;
+    size_t size;                        /* Accounted size in the outbox */
+    size_t len;
+    uint8_t qos;
+    uint8_t flags;
+    char *topic;                        /* Stored after the data */
+    uint8_t data[];
+} publish_queue_msg_t;
+
+struct publish_queue_s {
+    publish_queue_config_t config;
+    TAILQ_HEAD(, publish_queue_msg_s) msgs;
+    SemaphoreHandle_t lock;
+    SemaphoreHandle_t task_done;
+    TaskHandle_t task;
+    volatile bool running;
+    bool connected;
+    bool congested;
+    size_t used;
+    uint32_t inflight;
+    publish_queue_stats_t stats;
+    uint64_t published_bytes;
+    uint64_t last_bytes;
+    int64_t last_time;
+};
+
+static void *publish_queue_malloc(size_t size)
+{
+    /* The outbox is in PSRAM, if available */
+    void *ptr = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!ptr) {
+        ptr = malloc(size);
+    }
+    return ptr;
+}
+
+static void publish_queue_remove(publish_queue_handle_t queue, publish_queue_msg_t *msg)
+{
+    TAILQ_REMOVE(&queue->msgs, msg, entry);
+    queue->used -= msg->size;
+    queue->stats.depth--;
+    if (msg->state == PUBLISH_QUEUE_MSG_INFLIGHT) {
+        queue->inflight--;
+    }
+    free(msg);
+}
+
+/* Returns 1 (0) if the queue got (is not anymore) congested, -1 without change. Called with the lock taken. */
+static int publish_queue_update_congestion(publish_queue_handle_t queue)
+{
+    const size_t fill_pct = queue->used * 100 / queue->config.capacity;
+    if (!queue->congested && fill_pct >= queue->config.high_watermark_pct) {
+        queue->congested = true;
+        return 1;
+    }
+    if (queue->congested && fill_pct < queue->config.low_watermark_pct) {
+        queue->congested = false;
+        return 0;
+    }
+    return -1;
+}
+
+static void publish_queue_notify_congestion(publish_queue_handle_t queue, int change)
+{
+    if (change >= 0 && queue->config.backpressure_cb) {
+        queue->config.backpressure_cb(change == 1, queue->config.user_ctx);
+    }
+}
+
+/* Next message to publish, NULL if none. Called with the lock taken. */
+static publish_queue_msg_t *publish_queue_next(publish_queue_handle_t queue, int64_t now, TickType_t *wait)
+{
+    const int64_t retry_us = (int64_t)queue->config.retry_ms * 1000;
+    publish_queue_msg_t *msg;
+    publish_queue_msg_t *next = NULL;
+
+    *wait = portMAX_DELAY;
+    if (!queue->connected) {
+        return NULL;
+    }
+    TAILQ_FOREACH(msg, &queue->msgs, entry) {
+        if (msg->state == PUBLISH_QUEUE_MSG_INFLIGHT) {
+            if (now - msg->sent_time >= retry_us) {
+                /* Not delivered in time, publish again */
+                msg->state = PUBLISH_QUEUE_MSG_PENDING;
+                queue->inflight--;
+            } else {
+                *wait = MIN(*wait, pdMS_TO_TICKS((msg->sent_time + retry_us - now) / 1000) + 1);
+            }
+        }
+        if (!next && msg->state == PUBLISH_QUEUE_MSG_PENDING) {
+            next = msg;
+        }
+    }
+    if (next && queue->inflight >= queue->config.max_inflight) {
+        /* Wait for delivery or retry timeout */
+        return NULL;
+    }
+    return next;
+}
+
+static void publish_queue_task(void *arg)
+{
+    publish_queue_handle_t queue = (publish_queue_handle_t)arg;
+
+    while (queue->running) {
+        TickType_t wait;
+        xSemaphoreTake(queue->lock, portMAX_DELAY);
+        publish_queue_msg_t *msg = publish_queue_next(queue, esp_timer_get_time(), &wait);
+        if (msg) {
+            msg->state = PUBLISH_QUEUE_MSG_SENDING;
+        }
+        xSemaphoreGive(queue->lock);
+
+        if (!msg) {
+            ulTaskNotifyTake(pdTRUE, wait);
+            continue;
+        }
+
+        /* The lock is not held by the callback, so producers are never blocked by the network */
+        const int msg_id = queue->config.publish_cb(msg->topic, msg->data, msg->len, msg->qos, queue->config.user_ctx);
+
+        int change = -1;
+        xSemaphoreTake(queue->lock, portMAX_DELAY);
+        if (msg->attempts++ > 0) {
+            queue->stats.retries++;
+        }
+        if (msg_id < 0) {
+            msg->state = PUBLISH_QUEUE_MSG_PENDING;
+            wait = pdMS_TO_TICKS(PUBLISH_QUEUE_FAIL_DELAY_MS);
+        } else if (msg->qos == 0) {
+            queue->stats.published++;
+            queue->published_bytes += msg->len;
+            publish_queue_remove(queue, msg);
+            change = publish_queue_update_congestion(queue);
+            wait = 0;
+        } else {
+            msg->state = PUBLISH_QUEUE_MSG_INFLIGHT;
+            msg->msg_id = msg_id;
+            msg->sent_time = esp_timer_get_time();
+            queue->inflight++;
+            wait = 0;
+        }
+        xSemaphoreGive(queue->lock);
+        publish_queue_notify_congestion(queue, change);
+
+        if (wait) {
+            ulTaskNotifyTake(pdTRUE, wait);
+        }
+    }
+
+    xSemaphoreGive(queue->task_done);
+    vTaskDelete(NULL);
+}
+
+static void publish_queue_free(publish_queue_handle_t queue)
+{
+    while (!TAILQ_EMPTY(&queue->msgs)) {
+        publish_queue_remove(queue, TAILQ_FIRST(&queue->msgs));
+    }
+    if (queue->lock) {
+        vSemaphoreDelete(queue->lock);
+    }
+    if (queue->task_done) {
+        vSemaphoreDelete(queue->task_done);
+    }
+    free(queue);
+}
+
+esp_err_t publish_queue_create(const publish_queue_config_t *config, publish_queue_handle_t *ret_queue)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(config && ret_queue && config->publish_cb, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->capacity > 0 && config->max_inflight > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid capacity");
+    ESP_RETURN_ON_FALSE(config->low_watermark_pct <= config->high_watermark_pct && config->high_watermark_pct <= 100,
+                        ESP_ERR_INVALID_ARG, TAG, "Invalid watermarks");
+
+    publish_queue_handle_t queue = calloc(1, sizeof(struct publish_queue_s));
+    ESP_RETURN_ON_FALSE(queue, ESP_ERR_NO_MEM, TAG, "Not enough memory for publish queue");
+    queue->config = *config;
+    TAILQ_INIT(&queue->msgs);
+    queue->last_time = esp_timer_get_time();
+
+    queue->lock = xSemaphoreCreateMutex();
+    queue->task_done = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(queue->lock && queue->task_done, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for semaphores");
+
+    queue->running = true;
+    BaseType_t res;
+    if (config->task_affinity < 0) {
+        res = xTaskCreate(publish_queue_task, "publish_queue", config->task_stack, queue, config->task_priority, &queue->task);
+    } else {
+        res = xTaskCreatePinnedToCore(publish_queue_task, "publish_queue", config->task_stack, queue, config->task_priority, &queue->task, config->task_affinity);
+    }
+    ESP_GOTO_ON_FALSE(res == pdPASS, ESP_ERR_NO_MEM, err, TAG, "Create task failed");
+
+    *ret_queue = queue;
+    return ESP_OK;
+
+err:
+    publish_queue_free(queue);
+    return ret;
+}
+
+esp_err_t publish_queue_delete(publish_queue_handle_t queue)
+{
+    ESP_RETURN_ON_FALSE(queue, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+
+    /* Stop the task after the current message */
+    queue->running = false;
+    xTaskNotifyGive(queue->task);
+    xSemaphoreTake(queue->task_done, portMAX_DELAY);
+
+    publish_queue_free(queue);
+    return ESP_OK;
+}
+
+esp_err_t publish_queue_add(publish_queue_handle_t queue, const char *topic, const uint8_t *data, size_t len, int qos, uint32_t flags)
+{
+    ESP_RETURN_ON_FALSE(queue && topic && (data || len == 0) && qos >= 0 && qos <= 2, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    const size_t topic_len = strlen(topic) + 1;
+    const size_t size = sizeof(publish_queue_msg_t) + len + topic_len;
+    ESP_RETURN_ON_FALSE(size <= queue->config.capacity, ESP_ERR_INVALID_ARG, TAG, "Message is bigger than the outbox");
+
+    /* Copy out of the lock */
+    publish_queue_msg_t *new_msg = publish_queue_malloc(size);
+    ESP_RETURN_ON_FALSE(new_msg, ESP_ERR_NO_MEM, TAG, "Not enough memory for message");
+    memset(new_msg, 0, sizeof(publish_queue_msg_t));
+    new_msg->size = size;
+    new_msg->len = len;
+    new_msg->qos = qos;
+    new_msg->flags = flags;
+    new_msg->msg_id = -1;
+    memcpy(new_msg->data, data, len);
+    new_msg->topic = (char *)new_msg->data + len;
+    memcpy(new_msg->topic, topic, topic_len);
+
+    esp_err_t ret = ESP_OK;
+    publish_queue_msg_t *msg;
+    publish_queue_msg_t *tmp;
+    xSemaphoreTake(queue->lock, portMAX_DELAY);
+
+    /* Superseded message is replaced in its place in the outbox */
+    publish_queue_msg_t *replaced = NULL;
+    if (flags & PUBLISH_QUEUE_FLAG_COALESCE) {
+        TAILQ_FOREACH(msg, &queue->msgs, entry) {
+            if (msg->state == PUBLISH_QUEUE_MSG_PENDING && (msg->flags & PUBLISH_QUEUE_FLAG_COALESCE) && strcmp(msg->topic, topic) == 0) {
+                replaced = msg;
+                break;
+            }
+        }
+    }
+    const size_t freed = replaced ? replaced->size : 0;
+
+    /* Make room by dropping the oldest QoS 0 messages */
+    for (msg = TAILQ_FIRST(&queue->msgs); msg && queue->used - freed + size > queue->config.capacity; msg = tmp) {
+        tmp = TAILQ_NEXT(msg, entry);
+        if (msg != replaced && msg->qos == 0 && msg->state == PUBLISH_QUEUE_MSG_PENDING) {
+            queue->stats.dropped++;
+            publish_queue_remove(queue, msg);
+        }
+    }
+    if (queue->used - freed + size > queue->config.capacity) {
+        queue->stats.rejected++;
+        free(new_msg);
+        ret = ESP_ERR_NO_MEM;
+    } else {
+        if (replaced) {
+            TAILQ_INSERT_BEFORE(replaced, new_msg, entry);
+            queue->stats.coalesced++;
+            publish_queue_remove(queue, replaced);
+        } else {
+            TAILQ_INSERT_TAIL(&queue->msgs, new_msg, entry);
+        }
+        queue->used += size;
+        queue->stats.queued++;
+        queue->stats.depth++;
+        queue->stats.depth_max = MAX(queue->stats.depth_max, queue->stats.depth);
+    }
+    const int change = publish_queue_update_congestion(queue);
+    xSemaphoreGive(queue->lock);
+
+    publish_queue_notify_congestion(queue, change);
+    if (ret == ESP_OK) {
+        xTaskNotifyGive(queue->task);
+    }
+    return ret;
+}
+
+esp_err_t publish_queue_set_connected(publish_queue_handle_t queue, bool connected)
+{
+    ESP_RETURN_ON_FALSE(queue, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+
+    xSemaphoreTake(queue->lock, portMAX_DELAY);
+    queue->connected = connected;
+    if (!connected) {
+        /* Delivery of the published messages is not confirmed, publish them again after reconnection */
+        publish_queue_msg_t *msg;
+        TAILQ_FOREACH(msg, &queue->msgs, entry) {
+            if (msg->state == PUBLISH_QUEUE_MSG_INFLIGHT) {
+                msg->state = PUBLISH_QUEUE_MSG_PENDING;
+                queue->inflight--;
+            }
+        }
+    }
+    xSemaphoreGive(queue->lock);
+    xTaskNotifyGive(queue->task);
+    return ESP_OK;
+}
+
+esp_err_t publish_queue_delivered(publish_queue_handle_t queue, int msg_id)
+{
+    ESP_RETURN_ON_FALSE(queue, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    int change = -1;
+    publish_queue_msg_t *msg;
+    xSemaphoreTake(queue->lock, portMAX_DELAY);
+    TAILQ_FOREACH(msg, &queue->msgs, entry) {
+        if (msg->state == PUBLISH_QUEUE_MSG_INFLIGHT && msg->msg_id == msg_id) {
+            queue->stats.published++;
+            queue->published_bytes += msg->len;
+            publish_queue_remove(queue, msg);
+            change = publish_queue_update_congestion(queue);
+            ret = ESP_OK;
+            break;
+        }
+    }
+    xSemaphoreGive(queue->lock);
+
+    publish_queue_notify_congestion(queue, change);
+    if (ret == ESP_OK) {
+        xTaskNotifyGive(queue->task);
+    }
+    return ret;
+}
+
+bool publish_queue_is_congested(publish_queue_handle_t queue)
+{
+    return queue && queue->congested;
+}
+
+esp_err_t publish_queue_get_stats(publish_queue_handle_t queue, publish_queue_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(queue && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    xSemaphoreTake(queue->lock, portMAX_DELAY);
+    const int64_t now = esp_timer_get_time();
+    *stats = queue->stats;
+    stats->used = queue->used;
+    if (now > queue->last_time) {
+        stats->throughput_bps = (queue->published_bytes - queue->last_bytes) * 1000000 / (now - queue->last_time);
+    }
+    queue->last_bytes = queue->published_bytes;
+    queue->last_time = now;
+    xSemaphoreGive(queue->lock);
+    return ESP_OK;
+}
@@ -0,0 +1,113 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "unity.h"
+#include "publish_queue.h"
+
+#define TEST_MSGS   8
+
+typedef struct {
+    char topic[TEST_MSGS][32];
+    uint8_t value[TEST_MSGS];
+    int qos[TEST_MSGS];
+    int count;
+    int congested;
+} test_sink_t;
+
+static int test_publish_cb(const char *topic, const uint8_t *data, size_t len, int qos, void *user_ctx)
+{
+    test_sink_t *sink = (test_sink_t *)user_ctx;
+    TEST_ASSERT_EQUAL(1, len);
+    TEST_ASSERT_LESS_THAN(TEST_MSGS, sink->count);
+    strlcpy(sink->topic[sink->count], topic, sizeof(sink->topic[0]));
+    sink->value[sink->count] = data[0];
+    sink->qos[sink->count] = qos;
+    return sink->count++;
+}
+
+static void test_backpressure_cb(bool congested, void *user_ctx)
+{
+    test_sink_t *sink = (test_sink_t *)user_ctx;
+    sink->congested += congested ? 1 : -1;
+}
+
+TEST_CASE("Publish queue coalescing and delivery", "[publish_queue]")
+{
+    test_sink_t sink = {0};
+    publish_queue_handle_t queue;
+    publish_queue_stats_t stats;
+    const publish_queue_config_t config = PUBLISH_QUEUE_CONFIG_DEFAULT(test_publish_cb, &sink);
+    TEST_ASSERT_EQUAL(ESP_OK, publish_queue_create(&config, &queue));
+
+    /* Nothing is published while disconnected, the latest value replaces the older one */
+    for (uint8_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, publish_queue_add(queue, "latest", &i, 1, 0, PUBLISH_QUEUE_FLAG_COALESCE));
+    }
+    const uint8_t batch = 0xAB;
+    TEST_ASSERT_EQUAL(ESP_OK, publish_queue_add(queue, "batch", &batch, 1, 1, 0));
+    vTaskDelay(pdMS_TO_TICKS(50));
+    TEST_ASSERT_EQUAL(0, sink.count);
+    TEST_ASSERT_EQUAL(ESP_OK, publish_queue_get_stats(queue, &stats));
+    TEST_ASSERT_EQUAL(4, stats.queued);
+    TEST_ASSERT_EQUAL(2, stats.coalesced);
+    TEST_ASSERT_EQUAL(2, stats.depth);
+
+    TEST_ASSERT_EQUAL(ESP_OK, publish_queue_set_connected(queue, true));
+    vTaskDelay(pdMS_TO_TICKS(50));
+    TEST_ASSERT_EQUAL(2, sink.count);
+    TEST_ASSERT_EQUAL_STRING("latest", sink.topic[0]);
+    TEST_ASSERT_EQUAL(2, sink.value[0]);
+    TEST_ASSERT_EQUAL_STRING("batch", sink.topic[1]);
+
+    /* QoS 1 message stays in the outbox until it is delivered */
+    TEST_ASSERT_EQUAL(ESP_OK, publish_queue_get_stats(queue, &stats));
+    TEST_ASSERT_EQUAL(1, stats.published);
+    TEST_ASSERT_EQUAL(1, stats.depth);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, publish_queue_delivered(queue, 5));
+    TEST_ASSERT_EQUAL(ESP_OK, publish_queue_delivered(queue, 1));
+    TEST_ASSERT_EQUAL(ESP_OK, publish_queue_get_stats(queue, &stats));
+    TEST_ASSERT_EQUAL(2, stats.published);
+    TEST_ASSERT_EQUAL(0, stats.depth);
+    TEST_ASSERT_EQUAL(0, stats.used);
+
+    TEST_ASSERT_EQUAL(ESP_OK, publish_queue_delete(queue));
+}
+
+TEST_CASE("Publish queue full outbox", "[publish_queue]")
+{
+    test_sink_t sink = {0};
+    publish_queue_handle_t queue;
+    publish_queue_stats_t stats;
+    publish_queue_config_t config = PUBLISH_QUEUE_CONFIG_DEFAULT(test_publish_cb, &sink);
+    config.backpressure_cb = test_backpressure_cb;
+    config.capacity = 512;
+    TEST_ASSERT_EQUAL(ESP_OK, publish_queue_create(&config, &queue));
+
+    /* QoS 0 messages are dropped to make room, QoS 1 messages are rejected when there is nothing to drop */
+    uint8_t value = 0;
+    esp_err_t ret;
+    do {
+        ret = publish_queue_add(queue, "qos0", &value, 1, 0, 0);
+    } while (ret == ESP_OK && ++value < 100);
+    TEST_ASSERT_EQUAL(1, sink.congested);
+    TEST_ASSERT_TRUE(publish_queue_is_congested(queue));
+    TEST_ASSERT_EQUAL(ESP_OK, publish_queue_get_stats(queue, &stats));
+    TEST_ASSERT_GREATER_THAN(0, stats.dropped);
+    TEST_ASSERT_EQUAL(0, stats.rejected);
+
+    do {
+        ret = publish_queue_add(queue, "qos1", &value, 1, 1, 0);
+    } while (ret == ESP_OK && ++value < 200);
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, ret);
+    TEST_ASSERT_EQUAL(ESP_OK, publish_queue_get_stats(queue, &stats));
+    TEST_ASSERT_EQUAL(1, stats.rejected);
+
+    TEST_ASSERT_EQUAL(ESP_OK, publish_queue_delete(queue));
+}
@@ -0,0 +1,160 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Sensor batch
+ *
+ * Timestamped samples of fixed size are collected into one compact binary message, which is passed
+ * to the application (e.g. published to MQTT) when a flush threshold is reached.
+ *
+ * Message format (multi-byte integers are little-endian):
+ *
+ * | Offset | Size          | Content                                                         |
+ * |--------|---------------|-----------------------------------------------------------------|
+ * | 0      | 1             | Format version (SENSOR_BATCH_FORMAT_VERSION)                    |
+ * | 1      | 1             | Sample size [bytes]                                             |
+ * | 2      | 2             | Count of samples                                                |
+ * | 4      | 1-10          | Timestamp of the first sample [ms], unsigned LEB128 varint      |
+ * | ...    | 1-10 + sample | Per sample: delta to the previous timestamp [ms] varint, sample |
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Version of the message format
+ */
+#define SENSOR_BATCH_FORMAT_VERSION     1
+
+/**
+ * @brief Size of the message header without the timestamp
+ */
+#define SENSOR_BATCH_HEADER_SIZE        4
+
+/**
+ * @brief Flush callback, called with the finished message
+ *
+ * @param data      Message
+ * @param len       Length of the message [bytes]
+ * @param user_ctx  User context from the configuration
+ * @return ESP_OK if the message was sent, otherwise the batch is kept for the next flush
+ */
+typedef esp_err_t (*sensor_batch_flush_cb_t)(const uint8_t *data, size_t len, void *user_ctx);
+
+/**
+ * @brief Callback of sensor_batch_decode() with one sample
+ *
+ * @param timestamp_ms  Timestamp of the sample [ms]
+ * @param sample        Sample of `sample_size` bytes
+ * @param sample_size   Size of the sample [bytes]
+ * @param user_ctx      User context passed to sensor_batch_decode()
+ */
+typedef void (*sensor_batch_sample_cb_t)(uint64_t timestamp_ms, const void *sample, size_t sample_size, void *user_ctx);
+
+/**
+ * @brief Batch configuration
+ */
+typedef struct {
+    size_t sample_size;                 /*!< Size of one sample [bytes], 1 - 255 */
+    size_t buffer_size;                 /*!< Maximum message size [bytes], the batch is flushed when the next sample doesn't fit */
+    uint16_t max_samples;               /*!< Flush after this count of samples (0 for no limit) */
+    uint32_t window_ms;                 /*!< Flush when a sample comes this time after the first one (0 for no limit) */
+    sensor_batch_flush_cb_t flush_cb;   /*!< Called with finished messages */
+    void *user_ctx;                     /*!< Passed to flush_cb */
+} sensor_batch_config_t;
+
+/**
+ * @brief Batch handle
+ */
+typedef struct sensor_batch_s *sensor_batch_handle_t;
+
+/**
+ * @brief Create batch
+ *
+ * @param config        Configuration
+ * @param ret_batch     Created batch
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error or the buffer can't hold one sample
+ *      - ESP_ERR_NO_MEM        if there is no memory for the batch
+ */
+esp_err_t sensor_batch_create(const sensor_batch_config_t *config, sensor_batch_handle_t *ret_batch);
+
+/**
+ * @brief Delete batch, samples not flushed are dropped
+ *
+ * @param batch     Batch
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t sensor_batch_delete(sensor_batch_handle_t batch);
+
+/**
+ * @brief Add sample to the batch
+ *
+ * The batch is flushed before the sample if the sample doesn't fit or it is out of the time window,
+ * and after the sample if `max_samples` is reached.
+ * If the flush callback fails, the batch is kept and grows until the buffer is full. A full batch,
+ * that can't be flushed, is dropped to make room for the new samples.
+ *
+ * @note The batch is not thread-safe, samples must be added from one task.
+ *
+ * @param batch         Batch
+ * @param timestamp_ms  Timestamp of the sample [ms], not lower than the previous one
+ * @param sample        Sample of `sample_size` bytes
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - Others                error of the flush callback, the sample is stored anyway
+ */
+esp_err_t sensor_batch_add(sensor_batch_handle_t batch, uint64_t timestamp_ms, const void *sample);
+
+/**
+ * @brief Pass the collected samples to the flush callback
+ *
+ * @param batch     Batch
+ * @return
+ *      - ESP_OK                on success or if the batch is empty
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - Others                error of the flush callback, the batch is kept
+ */
+esp_err_t sensor_batch_flush(sensor_batch_handle_t batch);
+
+/**
+ * @brief Get count of samples waiting in the batch
+ *
+ * @param batch     Batch
+ * @return Count of samples
+ */
+size_t sensor_batch_get_count(sensor_batch_handle_t batch);
+
+/**
+ * @brief Decode a message created by the batch
+ *
+ * @param data      Message
+ * @param len       Length of the message [bytes]
+ * @param sample_cb Called with each sample
+ * @param user_ctx  Passed to sample_cb
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NOT_SUPPORTED if the format version is not supported
+ *      - ESP_ERR_INVALID_SIZE  if the message is truncated or malformed
+ */
+esp_err_t sensor_batch_decode(const uint8_t *data, size_t len, sensor_batch_sample_cb_t sample_cb, void *user_ctx);
+
+#ifdef __cplusplus
+}
+#endif
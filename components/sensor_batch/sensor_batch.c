@@ -0,0 +1,167 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_check.h"
+#include "esp_log.h"
+#include "sensor_batch.h"
+
+static const char *TAG = "sensor_batch";
+
+#define SENSOR_BATCH_VARINT_MAX     10  /* Bytes of 64-bit LEB128 varint */
+
+struct sensor_batch_s {
+    sensor_batch_config_t config;
+    size_t len;                         /* Length of the message in buffer */
+    uint16_t count;                     /* Count of samples in the message */
+    uint64_t first_ms;                  /* Timestamp of the first sample */
+    uint64_t last_ms;                   /* Timestamp of the last sample, base of the next delta */
+    uint8_t buffer[];
+};
+
+static size_t sensor_batch_put_varint(uint8_t *buf, uint64_t value)
+{
+    size_t len = 0;
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        buf[len++] = value ? (byte | 0x80) : byte;
+    } while (value);
+    return len;
+}
+
+static size_t sensor_batch_get_varint(const uint8_t *buf, size_t len, uint64_t *value)
+{
+    *value = 0;
+    for (size_t i = 0; i < len && i < SENSOR_BATCH_VARINT_MAX; i++) {
+        *value |= (uint64_t)(buf[i] & 0x7F) << (7 * i);
+        if (!(buf[i] & 0x80)) {
+            return i + 1;
+        }
+    }
+    return 0; // truncated
+}
+
+static void sensor_batch_reset(sensor_batch_handle_t batch)
+{
+    batch->len = 0;
+    batch->count = 0;
+}
+
+esp_err_t sensor_batch_create(const sensor_batch_config_t *config, sensor_batch_handle_t *ret_batch)
+{
+    ESP_RETURN_ON_FALSE(config && ret_batch && config->flush_cb, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->sample_size > 0 && config->sample_size <= UINT8_MAX, ESP_ERR_INVALID_ARG, TAG, "Invalid sample size");
+    ESP_RETURN_ON_FALSE(config->buffer_size >= SENSOR_BATCH_HEADER_SIZE + 2 * SENSOR_BATCH_VARINT_MAX + config->sample_size,
+                        ESP_ERR_INVALID_ARG, TAG, "Buffer can't hold one sample");
+
+    sensor_batch_handle_t batch = calloc(1, sizeof(struct sensor_batch_s) + config->buffer_size);
+    ESP_RETURN_ON_FALSE(batch, ESP_ERR_NO_MEM, TAG, "Not enough memory for sensor batch");
+    batch->config = *config;
+    *ret_batch = batch;
+    return ESP_OK;
+}
+
+esp_err_t sensor_batch_delete(sensor_batch_handle_t batch)
+{
+    ESP_RETURN_ON_FALSE(batch, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+    free(batch);
+    return ESP_OK;
+}
+
+esp_err_t sensor_batch_flush(sensor_batch_handle_t batch)
+{
+    ESP_RETURN_ON_FALSE(batch, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+    if (batch->count == 0) {
+        return ESP_OK;
+    }
+
+    /* Count is known only now */
+    batch->buffer[2] = batch->count & 0xFF;
+    batch->buffer[3] = batch->count >> 8;
+    esp_err_t ret = batch->config.flush_cb(batch->buffer, batch->len, batch->config.user_ctx);
+    if (ret == ESP_OK) {
+        sensor_batch_reset(batch);
+    }
+    return ret;
+}
+
+esp_err_t sensor_batch_add(sensor_batch_handle_t batch, uint64_t timestamp_ms, const void *sample)
+{
+    ESP_RETURN_ON_FALSE(batch && sample, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    const sensor_batch_config_t *config = &batch->config;
+    esp_err_t ret = ESP_OK;
+
+    if (batch->count > 0) {
+        const bool full = batch->count == UINT16_MAX ||
+                          batch->len + SENSOR_BATCH_VARINT_MAX + config->sample_size > config->buffer_size;
+        const bool out_of_window = config->window_ms && timestamp_ms - batch->first_ms >= config->window_ms;
+        if (full || out_of_window) {
+            ret = sensor_batch_flush(batch);
+            if (ret != ESP_OK && full) {
+                ESP_LOGW(TAG, "Flush failed (%s), %u samples dropped", esp_err_to_name(ret), batch->count);
+                sensor_batch_reset(batch);
+            }
+        }
+    }
+
+    if (batch->count == 0) {
+        batch->buffer[0] = SENSOR_BATCH_FORMAT_VERSION;
+        batch->buffer[1] = config->sample_size;
+        batch->len = SENSOR_BATCH_HEADER_SIZE + sensor_batch_put_varint(&batch->buffer[SENSOR_BATCH_HEADER_SIZE], timestamp_ms);
+        batch->first_ms = timestamp_ms;
+        batch->last_ms = timestamp_ms;
+    }
+
+    /* Timestamps going back are clamped, the delta is unsigned */
+    const uint64_t delta = timestamp_ms > batch->last_ms ? timestamp_ms - batch->last_ms : 0;
+    batch->last_ms += delta;
+    batch->len += sensor_batch_put_varint(&batch->buffer[batch->len], delta);
+    memcpy(&batch->buffer[batch->len], sample, config->sample_size);
+    batch->len += config->sample_size;
+    batch->count++;
+
+    if (config->max_samples && batch->count >= config->max_samples) {
+        esp_err_t flush_ret = sensor_batch_flush(batch);
+        if (ret == ESP_OK) {
+            ret = flush_ret;
+        }
+    }
+    return ret;
+}
+
+size_t sensor_batch_get_count(sensor_batch_handle_t batch)
+{
+    return batch ? batch->count : 0;
+}
+
+esp_err_t sensor_batch_decode(const uint8_t *data, size_t len, sensor_batch_sample_cb_t sample_cb, void *user_ctx)
+{
+    ESP_RETURN_ON_FALSE(data && sample_cb, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(len > SENSOR_BATCH_HEADER_SIZE, ESP_ERR_INVALID_SIZE, TAG, "Message too short");
+    ESP_RETURN_ON_FALSE(data[0] == SENSOR_BATCH_FORMAT_VERSION, ESP_ERR_NOT_SUPPORTED, TAG, "Unsupported format version %d", data[0]);
+
+    const size_t sample_size = data[1];
+    const uint16_t count = data[2] | (data[3] << 8);
+    size_t pos = SENSOR_BATCH_HEADER_SIZE;
+    uint64_t timestamp_ms;
+    size_t n = sensor_batch_get_varint(&data[pos], len - pos, &timestamp_ms);
+    ESP_RETURN_ON_FALSE(n, ESP_ERR_INVALID_SIZE, TAG, "Truncated timestamp");
+    pos += n;
+
+    for (uint16_t i = 0; i < count; i++) {
+        uint64_t delta;
+        n = sensor_batch_get_varint(&data[pos], len - pos, &delta);
+        ESP_RETURN_ON_FALSE(n && len - pos - n >= sample_size, ESP_ERR_INVALID_SIZE, TAG, "Truncated sample %u", i);
+        pos += n;
+        timestamp_ms += delta;
+        sample_cb(timestamp_ms, &data[pos], sample_size, user_ctx);
+        pos += sample_size;
+    }
+    ESP_RETURN_ON_FALSE(pos == len, ESP_ERR_INVALID_SIZE, TAG, "Unexpected data after %u samples", count);
+    return ESP_OK;
+}
@@ -0,0 +1,124 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "sensor_batch.h"
+
+#define TEST_BUFFER_SIZE    128
+#define TEST_SAMPLES        10
+
+typedef struct {
+    uint8_t msg[TEST_BUFFER_SIZE];
+    size_t len;
+    int flushes;
+    esp_err_t flush_ret;
+} test_sink_t;
+
+typedef struct {
+    uint64_t timestamp_ms[TEST_SAMPLES];
+    int32_t value[TEST_SAMPLES];
+    int count;
+} test_decoded_t;
+
+static esp_err_t test_flush_cb(const uint8_t *data, size_t len, void *user_ctx)
+{
+    test_sink_t *sink = (test_sink_t *)user_ctx;
+    if (sink->flush_ret != ESP_OK) {
+        return sink->flush_ret;
+    }
+    memcpy(sink->msg, data, len);
+    sink->len = len;
+    sink->flushes++;
+    return ESP_OK;
+}
+
+static void test_sample_cb(uint64_t timestamp_ms, const void *sample, size_t sample_size, void *user_ctx)
+{
+    test_decoded_t *decoded = (test_decoded_t *)user_ctx;
+    TEST_ASSERT_EQUAL(sizeof(int32_t), sample_size);
+    TEST_ASSERT_LESS_THAN(TEST_SAMPLES, decoded->count);
+    decoded->timestamp_ms[decoded->count] = timestamp_ms;
+    memcpy(&decoded->value[decoded->count], sample, sample_size);
+    decoded->count++;
+}
+
+TEST_CASE("Sensor batch window flush and decode", "[sensor_batch]")
+{
+    const uint64_t base_ms = 1700000000000ULL;
+    test_sink_t sink = {0};
+    test_decoded_t decoded = {0};
+    sensor_batch_handle_t batch;
+    const sensor_batch_config_t config = {
+        .sample_size = sizeof(int32_t),
+        .buffer_size = TEST_BUFFER_SIZE,
+        .window_ms = TEST_SAMPLES * 1000,
+        .flush_cb = test_flush_cb,
+        .user_ctx = &sink,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_batch_create(&config, &batch));
+
+    for (int32_t i = 0; i < TEST_SAMPLES; i++) {
+        const int32_t value = i * 3 - 5;
+        TEST_ASSERT_EQUAL(ESP_OK, sensor_batch_add(batch, base_ms + i * 1000, &value));
+    }
+    TEST_ASSERT_EQUAL(0, sink.flushes);
+    TEST_ASSERT_EQUAL(TEST_SAMPLES, sensor_batch_get_count(batch));
+
+    /* First sample out of the window publishes the batch */
+    const int32_t value = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_batch_add(batch, base_ms + TEST_SAMPLES * 1000, &value));
+    TEST_ASSERT_EQUAL(1, sink.flushes);
+    TEST_ASSERT_EQUAL(1, sensor_batch_get_count(batch));
+    printf("%d samples in %u bytes\n", TEST_SAMPLES, (unsigned)sink.len);
+
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_batch_decode(sink.msg, sink.len, test_sample_cb, &decoded));
+    TEST_ASSERT_EQUAL(TEST_SAMPLES, decoded.count);
+    for (int i = 0; i < TEST_SAMPLES; i++) {
+        TEST_ASSERT_TRUE(decoded.timestamp_ms[i] == base_ms + i * 1000);
+        TEST_ASSERT_EQUAL(i * 3 - 5, decoded.value[i]);
+    }
+
+    decoded.count = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, sensor_batch_decode(sink.msg, sink.len - 1, test_sample_cb, &decoded));
+
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_batch_delete(batch));
+}
+
+TEST_CASE("Sensor batch count limit and failed flush", "[sensor_batch]")
+{
+    test_sink_t sink = {0};
+    sensor_batch_handle_t batch;
+    const sensor_batch_config_t config = {
+        .sample_size = sizeof(int32_t),
+        .buffer_size = TEST_BUFFER_SIZE,
+        .max_samples = 3,
+        .flush_cb = test_flush_cb,
+        .user_ctx = &sink,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_batch_create(&config, &batch));
+
+    for (int32_t i = 0; i < 7; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, sensor_batch_add(batch, i * 10, &i));
+    }
+    TEST_ASSERT_EQUAL(2, sink.flushes);
+    TEST_ASSERT_EQUAL(1, sensor_batch_get_count(batch));
+
+    /* Failed flush keeps the samples */
+    sink.flush_ret = ESP_FAIL;
+    const int32_t value = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_batch_add(batch, 100, &value));
+    TEST_ASSERT_EQUAL(ESP_FAIL, sensor_batch_add(batch, 110, &value));
+    TEST_ASSERT_EQUAL(3, sensor_batch_get_count(batch));
+
+    sink.flush_ret = ESP_OK;
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_batch_flush(batch));
+    TEST_ASSERT_EQUAL(3, sink.flushes);
+    TEST_ASSERT_EQUAL(0, sensor_batch_get_count(batch));
+
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_batch_delete(batch));
+}
@@ -0,0 +1,203 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Sensor hub
+ *
+ * Sensors on one bus are sampled by one task with configured periods. Conversions of more sensors
+ * run at the same time, every sample is timestamped from esp_timer and stored in a ring buffer of its stream.
+ * More consumers can read the streams without locking and without additional bus traffic.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Sensor driver used by the hub
+ *
+ * @note The functions are called from the hub task only, so they can access the bus without locking
+ *       if all sensors of the bus are registered to one hub.
+ */
+typedef struct {
+    /**
+     * @brief Trigger conversion (NULL for continuously measuring sensors, only `read` is called)
+     *
+     * @param driver_ctx    Driver context from the stream configuration
+     * @param[out] wait_us  Time of the conversion, `read` is called after this time
+     */
+    esp_err_t (*start)(void *driver_ctx, uint32_t *wait_us);
+
+    /**
+     * @brief Read one sample
+     *
+     * @note Return ESP_ERR_NOT_FINISHED if the conversion continues (e.g. second conversion of the sample),
+     *       `read` is called again after `wait_us` (set to `poll_us` of the stream before the call).
+     *       The sample buffer of the stream keeps its content between these calls.
+     *
+     * @param driver_ctx    Driver context from the stream configuration
+     * @param[out] sample   Sample of `sample_size` bytes
+     * @param[inout] wait_us Time to the next `read` call if ESP_ERR_NOT_FINISHED is returned
+     */
+    esp_err_t (*read)(void *driver_ctx, void *sample, uint32_t *wait_us);
+} sensor_hub_driver_t;
+
+/**
+ * @brief Stream configuration
+ */
+typedef struct {
+    const char *name;                   /*!< Name of the stream (for logs) */
+    sensor_hub_driver_t driver;         /*!< Sensor driver */
+    void *driver_ctx;                   /*!< Context passed to the driver functions */
+    size_t sample_size;                 /*!< Size of one sample [bytes] */
+    uint32_t period_ms;                 /*!< Sampling period */
+    uint32_t poll_us;                   /*!< Default time to the next read of unfinished conversion */
+    size_t ring_len;                    /*!< Count of samples kept in the ring buffer */
+} sensor_hub_stream_config_t;
+
+/**
+ * @brief Sensor hub configuration
+ */
+typedef struct {
+    int task_priority;                  /*!< Priority of the hub task */
+    int task_stack;                     /*!< Stack size of the hub task [bytes] */
+    int task_affinity;                  /*!< Core of the hub task (-1 for no affinity) */
+} sensor_hub_config_t;
+
+/**
+ * @brief Default sensor hub configuration
+ */
+#define SENSOR_HUB_CONFIG_DEFAULT()         \
+    {                                       \
+        .task_priority = 6,                 \
+        .task_stack = 4096,                 \
+        .task_affinity = -1,                \
+    }
+
+/**
+ * @brief Sensor hub handle
+ */
+typedef struct sensor_hub_s *sensor_hub_handle_t;
+
+/**
+ * @brief Stream handle
+ */
+typedef struct sensor_hub_stream_s *sensor_hub_stream_handle_t;
+
+/**
+ * @brief Reader of one stream
+ *
+ * @note Each consumer has its own reader, readers don't influence each other.
+ */
+typedef struct {
+    sensor_hub_stream_handle_t stream;  /*!< Read stream */
+    uint32_t seq;                       /*!< Sequence number of the next read sample */
+} sensor_hub_reader_t;
+
+/**
+ * @brief Create sensor hub
+ *
+ * @note Sampling starts with `sensor_hub_start` after all streams are added
+ *
+ * @param config        Configuration
+ * @param ret_handle    Created hub
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if there is no memory for the hub
+ */
+esp_err_t sensor_hub_create(const sensor_hub_config_t *config, sensor_hub_handle_t *ret_handle);
+
+/**
+ * @brief Delete sensor hub and all its streams
+ *
+ * @note Readers of the streams must not be used after this call
+ *
+ * @param handle    Hub
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t sensor_hub_delete(sensor_hub_handle_t handle);
+
+/**
+ * @brief Add sensor stream to the hub
+ *
+ * @param handle        Hub
+ * @param config        Stream configuration
+ * @param ret_stream    Created stream
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_INVALID_STATE if the hub is already started
+ *      - ESP_ERR_NO_MEM        if there is no memory for the stream
+ */
+esp_err_t sensor_hub_add_stream(sensor_hub_handle_t handle, const sensor_hub_stream_config_t *config, sensor_hub_stream_handle_t *ret_stream);
+
+/**
+ * @brief Start sampling of all streams
+ *
+ * @param handle    Hub
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_INVALID_STATE if the hub is already started or has no stream
+ *      - ESP_ERR_NO_MEM        if the task can't be created
+ */
+esp_err_t sensor_hub_start(sensor_hub_handle_t handle);
+
+/**
+ * @brief Initialize reader of a stream
+ *
+ * The reader gets samples published after this call.
+ *
+ * @param stream    Stream
+ * @param reader    Reader
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t sensor_hub_reader_init(sensor_hub_stream_handle_t stream, sensor_hub_reader_t *reader);
+
+/**
+ * @brief Read the next sample of the reader without waiting
+ *
+ * @note If the reader is slower than the stream, the oldest samples are overwritten and skipped
+ *
+ * @param reader            Reader
+ * @param[out] sample       Sample of `sample_size` bytes
+ * @param[out] timestamp    esp_timer time of the sample [us] (can be NULL)
+ * @param[out] lost         Count of skipped samples (can be NULL)
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NOT_FOUND     if there is no new sample
+ */
+esp_err_t sensor_hub_read(sensor_hub_reader_t *reader, void *sample, int64_t *timestamp, uint32_t *lost);
+
+/**
+ * @brief Read the latest sample of a stream without waiting
+ *
+ * @param stream            Stream
+ * @param[out] sample       Sample of `sample_size` bytes
+ * @param[out] timestamp    esp_timer time of the sample [us] (can be NULL)
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NOT_FOUND     if no sample was published yet
+ */
+esp_err_t sensor_hub_read_latest(sensor_hub_stream_handle_t stream, void *sample, int64_t *timestamp);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,350 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sensor_hub.h"
+
+static const char *TAG = "sensor_hub";
+
+typedef enum {
+    SENSOR_HUB_STREAM_IDLE = 0,         /* Waiting for the next period */
+    SENSOR_HUB_STREAM_CONVERTING,       /* Conversion is running, waiting for read */
+} sensor_hub_stream_state_t;
+
+/* Entry of the ring buffer, the sample follows the header */
+typedef struct {
+    int64_t timestamp;
+} sensor_hub_entry_t;
+
+struct sensor_hub_stream_s {
+    sensor_hub_stream_config_t config;
+    struct sensor_hub_stream_s *next;
+    sensor_hub_stream_state_t state;
+    int64_t due_time;                   /* Start of the next period [us] */
+    int64_t ready_time;                 /* End of the running conversion [us] */
+    size_t entry_size;
+    size_t ring_entries;                /* ring_len + 1, the entry being written is never read */
+    uint8_t *ring;
+    void *sample;                       /* Sample read by the hub task before it is published */
+    atomic_uint write_seq;              /* Count of published samples, written by the hub task only */
+};
+
+struct sensor_hub_s {
+    struct sensor_hub_stream_s *streams;
+    sensor_hub_config_t config;
+    esp_timer_handle_t timer;           /* Wakes the task at the next event */
+    SemaphoreHandle_t task_done;
+    TaskHandle_t task;
+    volatile bool running;
+};
+
+static sensor_hub_entry_t *sensor_hub_entry(sensor_hub_stream_handle_t stream, uint32_t seq)
+{
+    return (sensor_hub_entry_t *)(stream->ring + (seq % stream->ring_entries) * stream->entry_size);
+}
+
+static void sensor_hub_publish(sensor_hub_stream_handle_t stream, int64_t timestamp, const void *sample)
+{
+    const uint32_t seq = atomic_load_explicit(&stream->write_seq, memory_order_relaxed);
+    sensor_hub_entry_t *entry = sensor_hub_entry(stream, seq);
+    entry->timestamp = timestamp;
+    memcpy(entry + 1, sample, stream->config.sample_size);
+    atomic_store_explicit(&stream->write_seq, seq + 1, memory_order_release);
+}
+
+/* Copy published sample, false if it was overwritten during the copy */
+static bool sensor_hub_copy(sensor_hub_stream_handle_t stream, uint32_t seq, void *sample, int64_t *timestamp)
+{
+    const sensor_hub_entry_t *entry = sensor_hub_entry(stream, seq);
+    const int64_t entry_timestamp = entry->timestamp;
+    memcpy(sample, entry + 1, stream->config.sample_size);
+    atomic_thread_fence(memory_order_acquire);
+
+    /* The entry of seq is rewritten while the hub publishes seq + ring_entries */
+    const uint32_t write_seq = atomic_load_explicit(&stream->write_seq, memory_order_relaxed);
+    if (write_seq - seq >= stream->ring_entries) {
+        return false;
+    }
+    if (timestamp) {
+        *timestamp = entry_timestamp;
+    }
+    return true;
+}
+
+static void sensor_hub_stream_read(sensor_hub_stream_handle_t stream)
+{
+    void *sample = stream->sample;
+    uint32_t wait_us = stream->config.poll_us;
+    const int64_t timestamp = esp_timer_get_time();
+    const esp_err_t ret = stream->config.driver.read(stream->config.driver_ctx, sample, &wait_us);
+
+    if (ret == ESP_ERR_NOT_FINISHED) {
+        stream->ready_time = esp_timer_get_time() + wait_us;
+        stream->state = SENSOR_HUB_STREAM_CONVERTING;
+        return;
+    }
+    if (ret == ESP_OK) {
+        sensor_hub_publish(stream, timestamp, sample);
+    } else {
+        ESP_LOGD(TAG, "Read of %s failed (%s)", stream->config.name, esp_err_to_name(ret));
+    }
+    stream->state = SENSOR_HUB_STREAM_IDLE;
+}
+
+static void sensor_hub_stream_start(sensor_hub_stream_handle_t stream, int64_t now)
+{
+    /* Keep the sampling grid, skip missed periods */
+    const int64_t period = (int64_t)stream->config.period_ms * 1000;
+    stream->due_time += period;
+    if (stream->due_time <= now) {
+        stream->due_time = now + period;
+    }
+
+    if (!stream->config.driver.start) {
+        sensor_hub_stream_read(stream);
+        return;
+    }
+
+    uint32_t wait_us = 0;
+    const esp_err_t ret = stream->config.driver.start(stream->config.driver_ctx, &wait_us);
+    if (ret != ESP_OK) {
+        ESP_LOGD(TAG, "Start of %s failed (%s)", stream->config.name, esp_err_to_name(ret));
+        return;
+    }
+    stream->ready_time = esp_timer_get_time() + wait_us;
+    stream->state = SENSOR_HUB_STREAM_CONVERTING;
+}
+
+static void sensor_hub_timer_cb(void *arg)
+{
+    sensor_hub_handle_t handle = (sensor_hub_handle_t)arg;
+    xTaskNotifyGive(handle->task);
+}
+
+static void sensor_hub_task(void *arg)
+{
+    sensor_hub_handle_t handle = (sensor_hub_handle_t)arg;
+
+    while (handle->running) {
+        /* Read finished conversions first, then start the due ones, so their conversions overlap */
+        int64_t now = esp_timer_get_time();
+        for (sensor_hub_stream_handle_t stream = handle->streams; stream; stream = stream->next) {
+            if (stream->state == SENSOR_HUB_STREAM_CONVERTING && stream->ready_time <= now) {
+                sensor_hub_stream_read(stream);
+            }
+        }
+        now = esp_timer_get_time();
+        for (sensor_hub_stream_handle_t stream = handle->streams; stream; stream = stream->next) {
+            if (stream->state == SENSOR_HUB_STREAM_IDLE && stream->due_time <= now) {
+                sensor_hub_stream_start(stream, now);
+            }
+        }
+
+        /* Sleep until the next event */
+        int64_t next = INT64_MAX;
+        for (sensor_hub_stream_handle_t stream = handle->streams; stream; stream = stream->next) {
+            next = MIN(next, stream->state == SENSOR_HUB_STREAM_CONVERTING ? stream->ready_time : stream->due_time);
+        }
+        now = esp_timer_get_time();
+        if (next > now) {
+            if (next != INT64_MAX) {
+                esp_timer_start_once(handle->timer, next - now);
+            }
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+    }
+
+    esp_timer_stop(handle->timer);
+    xSemaphoreGive(handle->task_done);
+    vTaskDelete(NULL);
+}
+
+static void sensor_hub_free(sensor_hub_handle_t handle)
+{
+    sensor_hub_stream_handle_t stream = handle->streams;
+    while (stream) {
+        sensor_hub_stream_handle_t next = stream->next;
+        free(stream->ring);
+        free(stream->sample);
+        free(stream);
+        stream = next;
+    }
+    if (handle->timer) {
+        esp_timer_delete(handle->timer);
+    }
+    if (handle->task_done) {
+        vSemaphoreDelete(handle->task_done);
+    }
+    free(handle);
+}
+
+esp_err_t sensor_hub_create(const sensor_hub_config_t *config, sensor_hub_handle_t *ret_handle)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(config && ret_handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    sensor_hub_handle_t handle = calloc(1, sizeof(struct sensor_hub_s));
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_NO_MEM, TAG, "Not enough memory for sensor hub");
+    handle->config = *config;
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = sensor_hub_timer_cb,
+        .arg = handle,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "sensor_hub",
+    };
+    ESP_GOTO_ON_ERROR(esp_timer_create(&timer_args, &handle->timer), err, TAG, "Create timer failed");
+    handle->task_done = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(handle->task_done, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for semaphore");
+
+    *ret_handle = handle;
+    return ESP_OK;
+
+err:
+    sensor_hub_free(handle);
+    return ret;
+}
+
+esp_err_t sensor_hub_delete(sensor_hub_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+
+    if (handle->task) {
+        /* Stop the task after the current event */
+        handle->running = false;
+        esp_timer_stop(handle->timer);
+        xTaskNotifyGive(handle->task);
+        xSemaphoreTake(handle->task_done, portMAX_DELAY);
+    }
+
+    sensor_hub_free(handle);
+    return ESP_OK;
+}
+
+esp_err_t sensor_hub_add_stream(sensor_hub_handle_t handle, const sensor_hub_stream_config_t *config, sensor_hub_stream_handle_t *ret_stream)
+{
+    ESP_RETURN_ON_FALSE(handle && config && ret_stream, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->driver.read, ESP_ERR_INVALID_ARG, TAG, "Invalid driver");
+    ESP_RETURN_ON_FALSE(config->sample_size > 0 && config->period_ms > 0 && config->ring_len > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid stream configuration");
+    ESP_RETURN_ON_FALSE(!handle->task, ESP_ERR_INVALID_STATE, TAG, "Sensor hub already started");
+
+    sensor_hub_stream_handle_t stream = calloc(1, sizeof(struct sensor_hub_stream_s));
+    ESP_RETURN_ON_FALSE(stream, ESP_ERR_NO_MEM, TAG, "Not enough memory for stream");
+    stream->config = *config;
+    /* Keep the timestamps of entries aligned */
+    stream->entry_size = (sizeof(sensor_hub_entry_t) + config->sample_size + 7) & ~7;
+    stream->ring_entries = config->ring_len + 1;
+    stream->ring = calloc(stream->ring_entries, stream->entry_size);
+    /* Samples are read here and copied into the ring, so consumers never see partially read samples */
+    stream->sample = calloc(1, config->sample_size);
+    if (!stream->ring || !stream->sample) {
+        free(stream->ring);
+        free(stream->sample);
+        free(stream);
+        ESP_LOGE(TAG, "Not enough memory for stream buffers");
+        return ESP_ERR_NO_MEM;
+    }
+    atomic_init(&stream->write_seq, 0);
+
+    /* Append, so the streams are served in order of adding */
+    sensor_hub_stream_handle_t *last = &handle->streams;
+    while (*last) {
+        last = &(*last)->next;
+    }
+    *last = stream;
+
+    *ret_stream = stream;
+    return ESP_OK;
+}
+
+esp_err_t sensor_hub_start(sensor_hub_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+    ESP_RETURN_ON_FALSE(!handle->task, ESP_ERR_INVALID_STATE, TAG, "Sensor hub already started");
+
+    ESP_RETURN_ON_FALSE(handle->streams, ESP_ERR_INVALID_STATE, TAG, "No stream added");
+
+    const int64_t now = esp_timer_get_time();
+    for (sensor_hub_stream_handle_t stream = handle->streams; stream; stream = stream->next) {
+        stream->due_time = now;
+    }
+
+    handle->running = true;
+    BaseType_t res;
+    if (handle->config.task_affinity < 0) {
+        res = xTaskCreate(sensor_hub_task, "sensor_hub", handle->config.task_stack, handle, handle->config.task_priority, &handle->task);
+    } else {
+        res = xTaskCreatePinnedToCore(sensor_hub_task, "sensor_hub", handle->config.task_stack, handle, handle->config.task_priority, &handle->task, handle->config.task_affinity);
+    }
+    if (res != pdPASS) {
+        handle->running = false;
+        handle->task = NULL;
+        ESP_LOGE(TAG, "Create task failed");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t sensor_hub_reader_init(sensor_hub_stream_handle_t stream, sensor_hub_reader_t *reader)
+{
+    ESP_RETURN_ON_FALSE(stream && reader, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    reader->stream = stream;
+    reader->seq = atomic_load_explicit(&stream->write_seq, memory_order_acquire);
+    return ESP_OK;
+}
+
+esp_err_t sensor_hub_read(sensor_hub_reader_t *reader, void *sample, int64_t *timestamp, uint32_t *lost)
+{
+    ESP_RETURN_ON_FALSE(reader && reader->stream && sample, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    sensor_hub_stream_handle_t stream = reader->stream;
+    uint32_t skipped = 0;
+
+    while (1) {
+        const uint32_t write_seq = atomic_load_explicit(&stream->write_seq, memory_order_acquire);
+        if (write_seq == reader->seq) {
+            return ESP_ERR_NOT_FOUND;
+        }
+        /* Skip overwritten samples */
+        if (write_seq - reader->seq > stream->config.ring_len) {
+            const uint32_t oldest = write_seq - stream->config.ring_len;
+            skipped += oldest - reader->seq;
+            reader->seq = oldest;
+        }
+        if (sensor_hub_copy(stream, reader->seq, sample, timestamp)) {
+            break;
+        }
+    }
+
+    reader->seq++;
+    if (lost) {
+        *lost = skipped;
+    }
+    return ESP_OK;
+}
+
+esp_err_t sensor_hub_read_latest(sensor_hub_stream_handle_t stream, void *sample, int64_t *timestamp)
+{
+    ESP_RETURN_ON_FALSE(stream && sample, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    while (1) {
+        const uint32_t write_seq = atomic_load_explicit(&stream->write_seq, memory_order_acquire);
+        if (write_seq == 0) {
+            return ESP_ERR_NOT_FOUND;
+        }
+        if (sensor_hub_copy(stream, write_seq - 1, sample, timestamp)) {
+            return ESP_OK;
+        }
+    }
+}
@@ -0,0 +1,144 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "unity.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "sensor_hub.h"
+
+#define TEST_CONV_TIME_US   20000   /*!< Conversion time of the test sensors */
+#define TEST_PERIOD_MS      50
+
+/* Sensor with conversion, no device is needed */
+typedef struct {
+    uint32_t cnt;
+    int64_t start_time;
+} test_sensor_t;
+
+typedef struct {
+    uint32_t cnt;
+    int64_t start_time;
+} test_sample_t;
+
+static esp_err_t test_sensor_start(void *driver_ctx, uint32_t *wait_us)
+{
+    test_sensor_t *sensor = (test_sensor_t *)driver_ctx;
+    sensor->start_time = esp_timer_get_time();
+    *wait_us = TEST_CONV_TIME_US;
+    return ESP_OK;
+}
+
+static esp_err_t test_sensor_read(void *driver_ctx, void *sample, uint32_t *wait_us)
+{
+    test_sensor_t *sensor = (test_sensor_t *)driver_ctx;
+    test_sample_t *test_sample = (test_sample_t *)sample;
+    test_sample->cnt = sensor->cnt++;
+    test_sample->start_time = sensor->start_time;
+    return ESP_OK;
+}
+
+TEST_CASE("Sensor hub overlapped conversions test", "[sensor_hub][iot]")
+{
+    sensor_hub_handle_t hub;
+    const sensor_hub_config_t config = SENSOR_HUB_CONFIG_DEFAULT();
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_hub_create(&config, &hub));
+
+    test_sensor_t sensors[2] = {};
+    sensor_hub_stream_handle_t streams[2];
+    for (int i = 0; i < 2; i++) {
+        const sensor_hub_stream_config_t stream_config = {
+            .name = "test",
+            .driver = {
+                .start = test_sensor_start,
+                .read = test_sensor_read,
+            },
+            .driver_ctx = &sensors[i],
+            .sample_size = sizeof(test_sample_t),
+            .period_ms = TEST_PERIOD_MS,
+            .poll_us = 1000,
+            .ring_len = 16,
+        };
+        TEST_ASSERT_EQUAL(ESP_OK, sensor_hub_add_stream(hub, &stream_config, &streams[i]));
+    }
+
+    /* Two consumers of one stream */
+    sensor_hub_reader_t readers[2];
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_hub_reader_init(streams[0], &readers[0]));
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_hub_reader_init(streams[0], &readers[1]));
+    test_sample_t sample;
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, sensor_hub_read_latest(streams[0], &sample, NULL));
+
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_hub_start(hub));
+    vTaskDelay(pdMS_TO_TICKS(10 * TEST_PERIOD_MS + TEST_PERIOD_MS / 2));
+
+    /* Both readers get the same samples, the sensor is read once */
+    int64_t timestamp, prev_timestamp = 0;
+    uint32_t lost;
+    uint32_t cnt = 0;
+    while (sensor_hub_read(&readers[0], &sample, &timestamp, &lost) == ESP_OK) {
+        TEST_ASSERT_EQUAL_UINT32(0, lost);
+        TEST_ASSERT_EQUAL_UINT32(cnt, sample.cnt);
+        TEST_ASSERT_TRUE(timestamp >= sample.start_time + TEST_CONV_TIME_US);
+        if (cnt > 0) {
+            TEST_ASSERT_INT_WITHIN(TEST_PERIOD_MS * 1000 / 5, TEST_PERIOD_MS * 1000, timestamp - prev_timestamp);
+        }
+        prev_timestamp = timestamp;
+        cnt++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(sensors[0].cnt, cnt);
+    for (uint32_t i = 0; i < cnt; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, sensor_hub_read(&readers[1], &sample, NULL, NULL));
+        TEST_ASSERT_EQUAL_UINT32(i, sample.cnt);
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, sensor_hub_read(&readers[1], &sample, NULL, NULL));
+
+    /* Conversions of both sensors overlap */
+    test_sample_t sample1;
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_hub_read_latest(streams[0], &sample, NULL));
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_hub_read_latest(streams[1], &sample1, NULL));
+    TEST_ASSERT_INT_WITHIN(TEST_CONV_TIME_US, 0, sample1.start_time - sample.start_time);
+    printf("%"PRIu32" samples, conversion start difference %"PRIi64" us\n", cnt, sample1.start_time - sample.start_time);
+
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_hub_delete(hub));
+}
+
+TEST_CASE("Sensor hub slow reader test", "[sensor_hub][iot]")
+{
+    sensor_hub_handle_t hub;
+    const sensor_hub_config_t config = SENSOR_HUB_CONFIG_DEFAULT();
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_hub_create(&config, &hub));
+
+    test_sensor_t sensor = {};
+    const sensor_hub_stream_config_t stream_config = {
+        .name = "test",
+        .driver = {
+            .read = test_sensor_read,
+        },
+        .driver_ctx = &sensor,
+        .sample_size = sizeof(test_sample_t),
+        .period_ms = 5,
+        .ring_len = 4,
+    };
+    sensor_hub_stream_handle_t stream;
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_hub_add_stream(hub, &stream_config, &stream));
+    sensor_hub_reader_t reader;
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_hub_reader_init(stream, &reader));
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_hub_start(hub));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, sensor_hub_add_stream(hub, &stream_config, &stream));
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    /* Overwritten samples are skipped and counted */
+    test_sample_t sample;
+    uint32_t lost;
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_hub_read(&reader, &sample, NULL, &lost));
+    TEST_ASSERT_GREATER_THAN_UINT32(0, lost);
+    TEST_ASSERT_EQUAL_UINT32(lost, sample.cnt);
+
+    TEST_ASSERT_EQUAL(ESP_OK, sensor_hub_delete(hub));
+}
@@ -0,0 +1,213 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Sensor log
+ *
+ * Time series of fixed-size records (timestamp and `channel_count` int32 values) are logged into a preallocated file.
+ * The records are encoded into blocks by the caller and written by a background task, so sampling is not blocked by
+ * the storage. Blocks are written in one sector-aligned write each.
+ *
+ * File format (multi-byte integers are little-endian, varints are unsigned LEB128):
+ *
+ * | Offset                        | Size              | Content                                                  |
+ * |-------------------------------|-------------------|----------------------------------------------------------|
+ * | 0                             | 4                 | Magic "SLOG"                                             |
+ * | 4                             | 1                 | Format version (SENSOR_LOG_FORMAT_VERSION)               |
+ * | 5                             | 1                 | Count of channels                                        |
+ * | 6                             | 2                 | Reserved                                                 |
+ * | 8                             | 4                 | Block size [bytes]                                       |
+ * | 12                            | 4                 | Count of preallocated blocks                             |
+ * | 16                            | 4                 | Count of written blocks                                  |
+ * | 20                            | 12                | Reserved                                                 |
+ * | 32                            | 8 * blocks        | Index: timestamp of the first record of each block [us]  |
+ * | header (aligned to 512 bytes) | block size * n    | Blocks                                                   |
+ *
+ * Block format:
+ *
+ * | Offset | Size              | Content                                                                          |
+ * |--------|-------------------|----------------------------------------------------------------------------------|
+ * | 0      | 2                 | Count of records                                                                 |
+ * | 2      | 2                 | Reserved                                                                         |
+ * | 4      | 4                 | Length of encoded records [bytes]                                                |
+ * | 8      | 8                 | Timestamp of the first record [us]                                               |
+ * | 16     | ...               | Per record: timestamp delta varint, per channel zigzag varint of the value delta |
+ *
+ * The deltas of the first record in the block are related to the block timestamp and zero values.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Version of the file format
+ */
+#define SENSOR_LOG_FORMAT_VERSION   1
+
+/**
+ * @brief Maximum count of channels in one record
+ */
+#define SENSOR_LOG_CHANNELS_MAX     16
+
+/**
+ * @brief Callback of sensor_log_query() with one record
+ *
+ * @param timestamp_us  Timestamp of the record [us]
+ * @param values        Values of the record
+ * @param channel_count Count of the values
+ * @param user_ctx      User context passed to sensor_log_query()
+ */
+typedef void (*sensor_log_record_cb_t)(int64_t timestamp_us, const int32_t *values, size_t channel_count, void *user_ctx);
+
+/**
+ * @brief Log configuration
+ */
+typedef struct {
+    const char *path;                   /*!< Path of the log file, the file is created or overwritten */
+    size_t channel_count;               /*!< Count of values in one record, 1 - SENSOR_LOG_CHANNELS_MAX */
+    size_t block_size;                  /*!< Size of one block, multiple of 512 [bytes] */
+    uint32_t max_blocks;                /*!< Count of preallocated blocks, records are dropped when all are written */
+    size_t block_buffers;               /*!< Count of block buffers, one is encoded while the others are written (at least 2) */
+    uint32_t sync_blocks;               /*!< Index and file are synced after this count of blocks (0 for sync on flush only) */
+    int task_priority;                  /*!< Priority of the writer task */
+    int task_stack;                     /*!< Stack size of the writer task [bytes] */
+    int task_affinity;                  /*!< Core of the writer task (-1 for no affinity) */
+} sensor_log_config_t;
+
+/**
+ * @brief Default configuration of the log
+ */
+#define SENSOR_LOG_CONFIG_DEFAULT(file, channels)   \
+    {                                               \
+        .path = (file),                             \
+        .channel_count = (channels),                \
+        .block_size = 8192,                         \
+        .max_blocks = 4096,                         \
+        .block_buffers = 3,                         \
+        .sync_blocks = 16,                          \
+        .task_priority = 3,                         \
+        .task_stack = 3072,                         \
+        .task_affinity = -1,                        \
+    }
+
+/**
+ * @brief Log statistics
+ */
+typedef struct {
+    uint32_t records;                   /*!< Records encoded into blocks */
+    uint32_t dropped;                   /*!< Records dropped (no free block buffer or all blocks written) */
+    uint32_t blocks;                    /*!< Blocks written to the file */
+    uint32_t write_errors;              /*!< Failed block writes */
+    uint32_t write_time_max;            /*!< Maximum time of one block write [us] */
+} sensor_log_stats_t;
+
+/**
+ * @brief Log handle
+ */
+typedef struct sensor_log_s *sensor_log_handle_t;
+
+/**
+ * @brief Create the log file and start the writer task
+ *
+ * The file is preallocated for `max_blocks` blocks, so the file system does not allocate clusters during logging.
+ *
+ * @param config    Configuration
+ * @param ret_log   Created log
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if there is no memory for the buffers or the task
+ *      - ESP_FAIL              if the file can't be created or preallocated
+ */
+esp_err_t sensor_log_create(const sensor_log_config_t *config, sensor_log_handle_t *ret_log);
+
+/**
+ * @brief Add one record to the log
+ *
+ * The record is encoded into the current block, this function does not access the file. A full block is passed
+ * to the writer task.
+ *
+ * @note The log is not thread-safe, records must be added from one task.
+ *
+ * @param log           Log
+ * @param timestamp_us  Timestamp of the record [us], not lower than the previous one
+ * @param values        `channel_count` values of the record
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if the record was dropped (the writer is behind or all blocks are written)
+ */
+esp_err_t sensor_log_write(sensor_log_handle_t log, int64_t timestamp_us, const int32_t *values);
+
+/**
+ * @brief Pass the current block to the writer and wait until all blocks and the index are in the file
+ *
+ * @note It must be called from the task, which adds the records.
+ *
+ * @param log       Log
+ * @param timeout   Maximum time to wait for the writer
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_TIMEOUT       if the writer did not finish in time
+ */
+esp_err_t sensor_log_flush(sensor_log_handle_t log, TickType_t timeout);
+
+/**
+ * @brief Flush the log, stop the writer task and close the file
+ *
+ * @param log   Log
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t sensor_log_close(sensor_log_handle_t log);
+
+/**
+ * @brief Get statistics of the log
+ *
+ * @param log   Log
+ * @param stats Output statistics
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t sensor_log_get_stats(sensor_log_handle_t log, sensor_log_stats_t *stats);
+
+/**
+ * @brief Read records of a time range from a log file
+ *
+ * The first block of the range is found by binary search in the index, only the blocks of the range are read.
+ *
+ * @note The file must not be written by an open log at the same time.
+ *
+ * @param path      Path of the log file
+ * @param from_us   Start of the range [us]
+ * @param to_us     End of the range (included) [us]
+ * @param record_cb Called with each record in the range
+ * @param user_ctx  Passed to record_cb
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NOT_FOUND     if the file can't be opened
+ *      - ESP_ERR_NOT_SUPPORTED if the file is not a log or its format version is not supported
+ *      - ESP_ERR_NO_MEM        if there is no memory for the block buffer
+ *      - ESP_ERR_INVALID_SIZE  if a block is truncated or malformed
+ */
+esp_err_t sensor_log_query(const char *path, int64_t from_us, int64_t to_us, sensor_log_record_cb_t record_cb, void *user_ctx);
+
+#ifdef __cplusplus
+}
+#endif
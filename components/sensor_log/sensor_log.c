@@ -0,0 +1,488 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "sensor_log.h"
+
+static const char *TAG = "sensor_log";
+
+#define SENSOR_LOG_SECTOR_SIZE      512
+#define SENSOR_LOG_HEADER_SIZE      32  /* File header before the index */
+#define SENSOR_LOG_BLOCK_HEADER     16
+#define SENSOR_LOG_VARINT_MAX       10  /* Bytes of 64-bit LEB128 varint */
+#define SENSOR_LOG_VALUE_MAX        5   /* Bytes of zigzag varint of int32 delta (33 bits) */
+
+/* Commands of the writer task, blocks are passed as pointers */
+#define SENSOR_LOG_CMD_FLUSH        ((uint8_t *)1)
+#define SENSOR_LOG_CMD_STOP         ((uint8_t *)2)
+
+struct sensor_log_s {
+    sensor_log_config_t config;
+    int fd;
+    size_t header_size;                 /* File header with the index, aligned to sectors */
+    size_t record_max;                  /* Maximum size of one encoded record */
+    QueueHandle_t write_queue;          /* Blocks and commands for the writer */
+    QueueHandle_t free_queue;           /* Free block buffers */
+    SemaphoreHandle_t done;             /* Given by the writer after a command */
+    TaskHandle_t task;
+    uint8_t **buffers;
+    /* Encoder, used by the task adding the records */
+    uint8_t *cur;                       /* Block being encoded (NULL if no free buffer was available) */
+    size_t cur_len;
+    uint16_t cur_count;
+    int64_t last_us;
+    int32_t last_values[SENSOR_LOG_CHANNELS_MAX];
+    uint32_t sealed;                    /* Blocks passed to the writer */
+    /* Writer */
+    uint8_t index[SENSOR_LOG_SECTOR_SIZE];  /* Cached sector of the index with the last entry */
+    uint32_t index_sector;
+    uint32_t written;                   /* Count of blocks in the file */
+    uint32_t unsynced;                  /* Blocks written after the last sync */
+    sensor_log_stats_t stats;
+    portMUX_TYPE lock;
+};
+
+static void sensor_log_put_u16(uint8_t *buf, uint16_t value)
+{
+    buf[0] = value & 0xFF;
+    buf[1] = value >> 8;
+}
+
+static void sensor_log_put_u32(uint8_t *buf, uint32_t value)
+{
+    for (int i = 0; i < 4; i++) {
+        buf[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+static void sensor_log_put_u64(uint8_t *buf, uint64_t value)
+{
+    for (int i = 0; i < 8; i++) {
+        buf[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+static uint16_t sensor_log_get_u16(const uint8_t *buf)
+{
+    return buf[0] | (buf[1] << 8);
+}
+
+static uint32_t sensor_log_get_u32(const uint8_t *buf)
+{
+    return buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+static uint64_t sensor_log_get_u64(const uint8_t *buf)
+{
+    return sensor_log_get_u32(buf) | ((uint64_t)sensor_log_get_u32(buf + 4) << 32);
+}
+
+static size_t sensor_log_put_varint(uint8_t *buf, uint64_t value)
+{
+    size_t len = 0;
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        buf[len++] = value ? (byte | 0x80) : byte;
+    } while (value);
+    return len;
+}
+
+static size_t sensor_log_get_varint(const uint8_t *buf, size_t len, uint64_t *value)
+{
+    *value = 0;
+    for (size_t i = 0; i < len && i < SENSOR_LOG_VARINT_MAX; i++) {
+        *value |= (uint64_t)(buf[i] & 0x7F) << (7 * i);
+        if (!(buf[i] & 0x80)) {
+            return i + 1;
+        }
+    }
+    return 0; // truncated
+}
+
+static bool sensor_log_pwrite(int fd, const void *data, size_t len, off_t offset)
+{
+    return lseek(fd, offset, SEEK_SET) == offset && write(fd, data, len) == (ssize_t)len;
+}
+
+static bool sensor_log_pread(int fd, void *data, size_t len, off_t offset)
+{
+    return lseek(fd, offset, SEEK_SET) == offset && read(fd, data, len) == (ssize_t)len;
+}
+
+/*******************************************************************************
+* Writer
+*******************************************************************************/
+
+/* Write the cached index sector and the count of blocks, then sync the file */
+static void sensor_log_sync(sensor_log_handle_t log)
+{
+    bool ok = sensor_log_pwrite(log->fd, log->index, SENSOR_LOG_SECTOR_SIZE, (off_t)log->index_sector * SENSOR_LOG_SECTOR_SIZE);
+    if (log->index_sector != 0) {
+        uint8_t count[4];
+        sensor_log_put_u32(count, log->written);
+        ok = ok && sensor_log_pwrite(log->fd, count, sizeof(count), 16);
+    }
+    ok = ok && fsync(log->fd) == 0;
+    if (!ok) {
+        ESP_LOGE(TAG, "Index sync failed");
+    }
+    log->unsynced = 0;
+}
+
+static void sensor_log_write_block(sensor_log_handle_t log, uint8_t *block)
+{
+    const sensor_log_config_t *config = &log->config;
+    const int64_t start = esp_timer_get_time();
+    const bool ok = sensor_log_pwrite(log->fd, block, config->block_size, (off_t)log->header_size + (off_t)log->written * config->block_size);
+    const uint32_t time = (uint32_t)(esp_timer_get_time() - start);
+
+    if (ok) {
+        /* Index entries are appended, only the sector with the last entry is kept in RAM */
+        const size_t entry = SENSOR_LOG_HEADER_SIZE + (size_t)log->written * 8;
+        if (entry / SENSOR_LOG_SECTOR_SIZE != log->index_sector) {
+            sensor_log_pwrite(log->fd, log->index, SENSOR_LOG_SECTOR_SIZE, (off_t)log->index_sector * SENSOR_LOG_SECTOR_SIZE);
+            log->index_sector = entry / SENSOR_LOG_SECTOR_SIZE;
+            memset(log->index, 0, SENSOR_LOG_SECTOR_SIZE);
+        }
+        memcpy(&log->index[entry % SENSOR_LOG_SECTOR_SIZE], &block[8], 8);
+        log->written++;
+        if (log->index_sector == 0) {
+            sensor_log_put_u32(&log->index[16], log->written);
+        }
+        log->unsynced++;
+    } else {
+        ESP_LOGE(TAG, "Block %"PRIu32" write failed", log->written);
+    }
+
+    portENTER_CRITICAL(&log->lock);
+    if (ok) {
+        log->stats.blocks++;
+    } else {
+        log->stats.write_errors++;
+    }
+    if (time > log->stats.write_time_max) {
+        log->stats.write_time_max = time;
+    }
+    portEXIT_CRITICAL(&log->lock);
+
+    if (config->sync_blocks && log->unsynced >= config->sync_blocks) {
+        sensor_log_sync(log);
+    }
+}
+
+static void sensor_log_task(void *arg)
+{
+    sensor_log_handle_t log = (sensor_log_handle_t)arg;
+    uint8_t *msg;
+
+    while (1) {
+        xQueueReceive(log->write_queue, &msg, portMAX_DELAY);
+        if (msg == SENSOR_LOG_CMD_FLUSH || msg == SENSOR_LOG_CMD_STOP) {
+            sensor_log_sync(log);
+            xSemaphoreGive(log->done);
+            if (msg == SENSOR_LOG_CMD_STOP) {
+                break;
+            }
+            continue;
+        }
+        sensor_log_write_block(log, msg);
+        xQueueSend(log->free_queue, &msg, portMAX_DELAY);
+    }
+    vTaskDelete(NULL);
+}
+
+/*******************************************************************************
+* Encoder
+*******************************************************************************/
+
+/* Pass the current block to the writer */
+static void sensor_log_seal(sensor_log_handle_t log)
+{
+    if (log->cur == NULL || log->cur_count == 0) {
+        return;
+    }
+    sensor_log_put_u16(&log->cur[0], log->cur_count);
+    sensor_log_put_u32(&log->cur[4], log->cur_len - SENSOR_LOG_BLOCK_HEADER);
+    /* The rest of the block is not used, zeros compress well in file copies */
+    memset(&log->cur[log->cur_len], 0, log->config.block_size - log->cur_len);
+    /* Queue holds all buffers, it never blocks */
+    xQueueSend(log->write_queue, &log->cur, portMAX_DELAY);
+    log->cur = NULL;
+    log->sealed++;
+}
+
+esp_err_t sensor_log_write(sensor_log_handle_t log, int64_t timestamp_us, const int32_t *values)
+{
+    ESP_RETURN_ON_FALSE(log && values, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    const sensor_log_config_t *config = &log->config;
+
+    if (log->cur && (log->cur_count == UINT16_MAX || log->cur_len + log->record_max > config->block_size)) {
+        sensor_log_seal(log);
+    }
+    if (log->cur == NULL) {
+        if (log->sealed >= config->max_blocks || xQueueReceive(log->free_queue, &log->cur, 0) != pdTRUE) {
+            portENTER_CRITICAL(&log->lock);
+            log->stats.dropped++;
+            portEXIT_CRITICAL(&log->lock);
+            return ESP_ERR_NO_MEM;
+        }
+        sensor_log_put_u16(&log->cur[2], 0);
+        sensor_log_put_u64(&log->cur[8], (uint64_t)timestamp_us);
+        log->cur_len = SENSOR_LOG_BLOCK_HEADER;
+        log->cur_count = 0;
+        log->last_us = timestamp_us;
+        memset(log->last_values, 0, sizeof(log->last_values));
+    }
+
+    /* Timestamps going back are clamped, the delta is unsigned */
+    if (timestamp_us < log->last_us) {
+        timestamp_us = log->last_us;
+    }
+    uint8_t *p = &log->cur[log->cur_len];
+    p += sensor_log_put_varint(p, (uint64_t)(timestamp_us - log->last_us));
+    for (size_t i = 0; i < config->channel_count; i++) {
+        const int64_t delta = (int64_t)values[i] - log->last_values[i];
+        p += sensor_log_put_varint(p, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+        log->last_values[i] = values[i];
+    }
+    log->cur_len = p - log->cur;
+    log->cur_count++;
+    log->last_us = timestamp_us;
+
+    portENTER_CRITICAL(&log->lock);
+    log->stats.records++;
+    portEXIT_CRITICAL(&log->lock);
+    return ESP_OK;
+}
+
+/*******************************************************************************
+* Log
+*******************************************************************************/
+
+static void sensor_log_free(sensor_log_handle_t log)
+{
+    if (log->buffers) {
+        for (size_t i = 0; i < log->config.block_buffers; i++) {
+            heap_caps_free(log->buffers[i]);
+        }
+        free(log->buffers);
+    }
+    if (log->write_queue) {
+        vQueueDelete(log->write_queue);
+    }
+    if (log->free_queue) {
+        vQueueDelete(log->free_queue);
+    }
+    if (log->done) {
+        vSemaphoreDelete(log->done);
+    }
+    if (log->fd >= 0) {
+        close(log->fd);
+    }
+    free(log);
+}
+
+esp_err_t sensor_log_create(const sensor_log_config_t *config, sensor_log_handle_t *ret_log)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(config && ret_log && config->path, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->channel_count > 0 && config->channel_count <= SENSOR_LOG_CHANNELS_MAX, ESP_ERR_INVALID_ARG, TAG, "Invalid channel count");
+    ESP_RETURN_ON_FALSE(config->block_size > 0 && config->block_size % SENSOR_LOG_SECTOR_SIZE == 0, ESP_ERR_INVALID_ARG, TAG, "Block size must be multiple of sector");
+    ESP_RETURN_ON_FALSE(config->max_blocks > 0 && config->block_buffers >= 2, ESP_ERR_INVALID_ARG, TAG, "Invalid count of blocks");
+
+    sensor_log_handle_t log = calloc(1, sizeof(struct sensor_log_s));
+    ESP_RETURN_ON_FALSE(log, ESP_ERR_NO_MEM, TAG, "Not enough memory for sensor log");
+    log->config = *config;
+    log->fd = -1;
+    log->lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
+    log->record_max = SENSOR_LOG_VARINT_MAX + SENSOR_LOG_VALUE_MAX * config->channel_count;
+    log->header_size = (SENSOR_LOG_HEADER_SIZE + (size_t)config->max_blocks * 8 + SENSOR_LOG_SECTOR_SIZE - 1) & ~(SENSOR_LOG_SECTOR_SIZE - 1);
+    ESP_GOTO_ON_FALSE(config->block_size >= SENSOR_LOG_BLOCK_HEADER + log->record_max, ESP_ERR_INVALID_ARG, err, TAG, "Block can't hold one record");
+
+    /* Block buffers are DMA capable, the SD card driver writes them without a bounce buffer */
+    log->buffers = calloc(config->block_buffers, sizeof(uint8_t *));
+    log->write_queue = xQueueCreate(config->block_buffers + 2, sizeof(uint8_t *));
+    log->free_queue = xQueueCreate(config->block_buffers, sizeof(uint8_t *));
+    log->done = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(log->buffers && log->write_queue && log->free_queue && log->done, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for queues");
+    for (size_t i = 0; i < config->block_buffers; i++) {
+        log->buffers[i] = heap_caps_aligned_alloc(4, config->block_size, MALLOC_CAP_DMA);
+        ESP_GOTO_ON_FALSE(log->buffers[i], ESP_ERR_NO_MEM, err, TAG, "Not enough memory for block buffers");
+        xQueueSend(log->free_queue, &log->buffers[i], 0);
+    }
+
+    /* Preallocate the whole file, the clusters are not allocated during logging */
+    log->fd = open(config->path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    ESP_GOTO_ON_FALSE(log->fd >= 0, ESP_FAIL, err, TAG, "Can't create %s", config->path);
+    const off_t file_size = (off_t)log->header_size + (off_t)config->max_blocks * config->block_size;
+    const uint8_t zero = 0;
+    ESP_GOTO_ON_FALSE(sensor_log_pwrite(log->fd, &zero, 1, file_size - 1), ESP_FAIL, err, TAG, "Can't preallocate %s", config->path);
+
+    /* Header and the first index entries, the rest of the index is zero */
+    memcpy(&log->index[0], "SLOG", 4);
+    log->index[4] = SENSOR_LOG_FORMAT_VERSION;
+    log->index[5] = config->channel_count;
+    sensor_log_put_u32(&log->index[8], config->block_size);
+    sensor_log_put_u32(&log->index[12], config->max_blocks);
+    sensor_log_put_u32(&log->index[16], 0);
+    for (size_t offset = 0; offset < log->header_size; offset += SENSOR_LOG_SECTOR_SIZE) {
+        static const uint8_t empty[SENSOR_LOG_SECTOR_SIZE];
+        ESP_GOTO_ON_FALSE(sensor_log_pwrite(log->fd, offset ? empty : log->index, SENSOR_LOG_SECTOR_SIZE, offset), ESP_FAIL, err, TAG, "Can't write index");
+    }
+    ESP_GOTO_ON_FALSE(fsync(log->fd) == 0, ESP_FAIL, err, TAG, "Can't sync %s", config->path);
+
+    BaseType_t res;
+    if (config->task_affinity < 0) {
+        res = xTaskCreate(sensor_log_task, "sensor_log", config->task_stack, log, config->task_priority, &log->task);
+    } else {
+        res = xTaskCreatePinnedToCore(sensor_log_task, "sensor_log", config->task_stack, log, config->task_priority, &log->task, config->task_affinity);
+    }
+    ESP_GOTO_ON_FALSE(res == pdPASS, ESP_ERR_NO_MEM, err, TAG, "Create task failed");
+
+    *ret_log = log;
+    return ESP_OK;
+
+err:
+    sensor_log_free(log);
+    return ret;
+}
+
+esp_err_t sensor_log_flush(sensor_log_handle_t log, TickType_t timeout)
+{
+    ESP_RETURN_ON_FALSE(log, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+
+    sensor_log_seal(log);
+    uint8_t *cmd = SENSOR_LOG_CMD_FLUSH;
+    xQueueSend(log->write_queue, &cmd, portMAX_DELAY);
+    return xSemaphoreTake(log->done, timeout) == pdTRUE ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t sensor_log_close(sensor_log_handle_t log)
+{
+    ESP_RETURN_ON_FALSE(log, ESP_ERR_INVALID_ARG, TAG, "Invalid handle");
+
+    /* The writer writes all queued blocks before the stop command */
+    sensor_log_seal(log);
+    uint8_t *cmd = SENSOR_LOG_CMD_STOP;
+    xQueueSend(log->write_queue, &cmd, portMAX_DELAY);
+    xSemaphoreTake(log->done, portMAX_DELAY);
+
+    if (log->cur) {
+        xQueueSend(log->free_queue, &log->cur, 0);
+    }
+    sensor_log_free(log);
+    return ESP_OK;
+}
+
+esp_err_t sensor_log_get_stats(sensor_log_handle_t log, sensor_log_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(log && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    portENTER_CRITICAL(&log->lock);
+    *stats = log->stats;
+    portEXIT_CRITICAL(&log->lock);
+    return ESP_OK;
+}
+
+/*******************************************************************************
+* Query
+*******************************************************************************/
+
+static esp_err_t sensor_log_decode_block(const uint8_t *block, size_t block_size, size_t channel_count, int64_t from_us, int64_t to_us,
+                                         sensor_log_record_cb_t record_cb, void *user_ctx, bool *past_end)
+{
+    const uint16_t count = sensor_log_get_u16(&block[0]);
+    const size_t len = sensor_log_get_u32(&block[4]);
+    ESP_RETURN_ON_FALSE(len <= block_size - SENSOR_LOG_BLOCK_HEADER, ESP_ERR_INVALID_SIZE, TAG, "Malformed block");
+
+    int64_t timestamp_us = (int64_t)sensor_log_get_u64(&block[8]);
+    int32_t values[SENSOR_LOG_CHANNELS_MAX] = {0};
+    const uint8_t *p = &block[SENSOR_LOG_BLOCK_HEADER];
+    const uint8_t *end = p + len;
+    for (uint16_t r = 0; r < count; r++) {
+        uint64_t value;
+        size_t n = sensor_log_get_varint(p, end - p, &value);
+        ESP_RETURN_ON_FALSE(n, ESP_ERR_INVALID_SIZE, TAG, "Truncated record");
+        p += n;
+        timestamp_us += (int64_t)value;
+        for (size_t i = 0; i < channel_count; i++) {
+            n = sensor_log_get_varint(p, end - p, &value);
+            ESP_RETURN_ON_FALSE(n, ESP_ERR_INVALID_SIZE, TAG, "Truncated record");
+            p += n;
+            const int64_t delta = (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+            values[i] = (int32_t)(values[i] + delta);
+        }
+        if (timestamp_us > to_us) {
+            *past_end = true;
+            return ESP_OK;
+        }
+        if (timestamp_us >= from_us) {
+            record_cb(timestamp_us, values, channel_count, user_ctx);
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t sensor_log_query(const char *path, int64_t from_us, int64_t to_us, sensor_log_record_cb_t record_cb, void *user_ctx)
+{
+    esp_err_t ret = ESP_OK;
+    uint8_t *block = NULL;
+    ESP_RETURN_ON_FALSE(path && record_cb && from_us <= to_us, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    int fd = open(path, O_RDONLY);
+    ESP_RETURN_ON_FALSE(fd >= 0, ESP_ERR_NOT_FOUND, TAG, "Can't open %s", path);
+
+    uint8_t header[SENSOR_LOG_HEADER_SIZE];
+    ESP_GOTO_ON_FALSE(sensor_log_pread(fd, header, sizeof(header), 0) && memcmp(header, "SLOG", 4) == 0 &&
+                      header[4] == SENSOR_LOG_FORMAT_VERSION, ESP_ERR_NOT_SUPPORTED, err, TAG, "%s is not a log", path);
+    const size_t channel_count = header[5];
+    const size_t block_size = sensor_log_get_u32(&header[8]);
+    const uint32_t max_blocks = sensor_log_get_u32(&header[12]);
+    const uint32_t blocks = sensor_log_get_u32(&header[16]);
+    ESP_GOTO_ON_FALSE(channel_count > 0 && channel_count <= SENSOR_LOG_CHANNELS_MAX && block_size > SENSOR_LOG_BLOCK_HEADER &&
+                      blocks <= max_blocks, ESP_ERR_NOT_SUPPORTED, err, TAG, "Invalid header");
+    const size_t header_size = (SENSOR_LOG_HEADER_SIZE + (size_t)max_blocks * 8 + SENSOR_LOG_SECTOR_SIZE - 1) & ~(SENSOR_LOG_SECTOR_SIZE - 1);
+
+    /* Last block starting before the range, its later records can be in the range */
+    uint32_t lo = 0;
+    uint32_t hi = blocks;
+    while (hi - lo > 1) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        uint8_t entry[8];
+        ESP_GOTO_ON_FALSE(sensor_log_pread(fd, entry, sizeof(entry), SENSOR_LOG_HEADER_SIZE + (off_t)mid * 8), ESP_ERR_INVALID_SIZE, err, TAG, "Can't read index");
+        if ((int64_t)sensor_log_get_u64(entry) <= from_us) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    block = malloc(block_size);
+    ESP_GOTO_ON_FALSE(block, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for block");
+    bool past_end = false;
+    for (uint32_t b = lo; b < blocks && !past_end; b++) {
+        ESP_GOTO_ON_FALSE(sensor_log_pread(fd, block, block_size, (off_t)header_size + (off_t)b * block_size), ESP_ERR_INVALID_SIZE, err, TAG, "Can't read block %"PRIu32, b);
+        ESP_GOTO_ON_ERROR(sensor_log_decode_block(block, block_size, channel_count, from_us, to_us, record_cb, user_ctx, &past_end), err, TAG, "Block %"PRIu32, b);
+    }
+
+err:
+    free(block);
+    close(fd);
+    return ret;
+}
@@ -0,0 +1,42 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include "unity.h"
+#include "sensor_log.h"
+
+static void test_record_cb(int64_t timestamp_us, const int32_t *values, size_t channel_count, void *user_ctx)
+{
+    TEST_FAIL_MESSAGE("No record expected");
+}
+
+TEST_CASE("Sensor log invalid arguments and missing file test", "[sensor_log]")
+{
+    sensor_log_handle_t log = NULL;
+    sensor_log_config_t config = SENSOR_LOG_CONFIG_DEFAULT(NULL, 3);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, sensor_log_create(&config, &log));
+
+    config.path = "/nonexistent/imu.slog";
+    config.channel_count = SENSOR_LOG_CHANNELS_MAX + 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, sensor_log_create(&config, &log));
+
+    /* Blocks are written in whole sectors */
+    config.channel_count = 3;
+    config.block_size = 1000;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, sensor_log_create(&config, &log));
+
+    config.block_size = 512;
+    config.block_buffers = 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, sensor_log_create(&config, &log));
+
+    /* No file system is mounted, buffers are freed on failure */
+    config.block_buffers = 2;
+    TEST_ASSERT_EQUAL(ESP_FAIL, sensor_log_create(&config, &log));
+    TEST_ASSERT_NULL(log);
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, sensor_log_query("/nonexistent/imu.slog", 10, 0, test_record_cb, NULL));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, sensor_log_query("/nonexistent/imu.slog", 0, 10, test_record_cb, NULL));
+}
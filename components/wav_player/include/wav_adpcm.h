@@ -0,0 +1,95 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief IMA-ADPCM codec of WAV files (format tag 0x0011)
+ *
+ * 16-bit samples are compressed into 4 bits, so the files are 4 times smaller and the storage is read
+ * or written 4 times less. Blocks are independent, each block starts with the predictor and step index
+ * of every channel, then the channels are interleaved in groups of 8 samples (4 bytes).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Format tag of IMA-ADPCM in WAV format chunk
+ */
+#define WAV_ADPCM_FORMAT_TAG    (0x0011)
+
+/**
+ * @brief Default size of one block per channel [bytes] (1017 samples)
+ */
+#define WAV_ADPCM_BLOCK_SIZE    (512)
+
+/**
+ * @brief Encoder state of one channel, it is carried between blocks
+ */
+typedef struct {
+    int16_t predictor;                  /*!< Last encoded sample */
+    uint8_t index;                      /*!< Index to the step table */
+} wav_adpcm_state_t;
+
+/**
+ * @brief Check, if the block is valid for the channel count
+ *
+ * @param block_align   Size of one block of all channels [bytes]
+ * @param channels      Count of channels (1 or 2)
+ * @return true, if the block can be encoded and decoded
+ */
+static inline bool wav_adpcm_block_valid(size_t block_align, uint8_t channels)
+{
+    return (channels == 1 || channels == 2) && block_align > 4U * channels && ((block_align - 4U * channels) % (4U * channels)) == 0;
+}
+
+/**
+ * @brief Count of sample frames in one block
+ *
+ * @param block_align   Size of one block of all channels [bytes]
+ * @param channels      Count of channels (1 or 2)
+ * @return Count of sample frames (samples of each channel)
+ */
+static inline size_t wav_adpcm_block_frames(size_t block_align, uint8_t channels)
+{
+    /* Sample in the header and 2 samples in each data byte */
+    return 1 + (block_align - 4U * channels) * 2 / channels;
+}
+
+/**
+ * @brief Encode one block
+ *
+ * @param state         Encoder state of each channel (zeroed before the first block)
+ * @param in            Interleaved 16-bit samples, `wav_adpcm_block_frames` sample frames
+ * @param channels      Count of channels (1 or 2)
+ * @param block_align   Size of one block of all channels [bytes] (must be valid)
+ * @param out           Encoded block, `block_align` bytes
+ */
+void wav_adpcm_encode_block(wav_adpcm_state_t *state, const int16_t *in, uint8_t channels, size_t block_align, uint8_t *out);
+
+/**
+ * @brief Decode one block
+ *
+ * @note The last block of the file can be shorter, only its complete groups of samples are decoded.
+ *
+ * @param in            Encoded block
+ * @param len           Size of the encoded block (up to block_align) [bytes]
+ * @param channels      Count of channels (1 or 2)
+ * @param out           Interleaved 16-bit samples, space for `wav_adpcm_block_frames` sample frames
+ * @return Count of decoded sample frames (0 if the block is shorter than its header)
+ */
+size_t wav_adpcm_decode_block(const uint8_t *in, size_t len, uint8_t channels, int16_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,201 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief WAV file player with prefetch ring buffer
+ *
+ * A reader task prefetches the file into a ring buffer and a writer task feeds the codec continuously,
+ * so latency spikes of the file system (SPIFFS, SD card) are hidden by the buffered audio.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_codec_dev.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Callback of finished playback
+ *
+ * @note It is called from the writer task
+ *
+ * @param result    ESP_OK when the file was played to the end or stopped, error code otherwise
+ * @param user_ctx  User data from the configuration
+ */
+typedef void (*wav_player_done_cb_t)(esp_err_t result, void *user_ctx);
+
+/**
+ * @brief Callback with the audio sent to the codec (e.g. for a spectrum analyzer or a level meter)
+ *
+ * @note It is called from the writer task before each codec write, it must not block.
+ *       Only 16-bit audio is passed, after resampling and software volume.
+ *
+ * @param pcm           Interleaved 16-bit samples
+ * @param frames        Count of frames (samples per channel)
+ * @param channels      Count of channels
+ * @param sample_rate   Sample rate [Hz]
+ * @param user_ctx      User data from the configuration
+ */
+typedef void (*wav_player_tap_cb_t)(const int16_t *pcm, size_t frames, uint8_t channels, uint32_t sample_rate, void *user_ctx);
+
+/**
+ * @brief WAV player configuration
+ */
+typedef struct {
+    esp_codec_dev_handle_t codec;       /*!< Speaker codec device (e.g. from `bsp_audio_codec_speaker_init`) */
+    size_t ring_size;                   /*!< Size of the prefetch ring buffer [bytes], multiple of 4 */
+    size_t chunk_size;                  /*!< Size of one file read and one codec write [bytes], multiple of 4 */
+    int mclk_multiple;                  /*!< MCLK multiple of the sample rate used in codec open (0: codec default) */
+    uint32_t output_rate;               /*!< Fixed output sample rate [Hz], files are resampled and the codec stays open (0: rate of each file) */
+    uint8_t output_channels;            /*!< Output channels in fixed rate mode (1 or 2) */
+    int volume;                         /*!< Initial software volume (0 - 100), see `wav_player_set_volume` */
+    int reader_priority;                /*!< Priority of the reader task (should be lower than writer) */
+    int writer_priority;                /*!< Priority of the writer task */
+    int task_stack;                     /*!< Stack size of each task [bytes] */
+    int task_affinity;                  /*!< Core of the tasks (-1 for no affinity) */
+    wav_player_done_cb_t done_cb;       /*!< Callback of finished playback (can be NULL) */
+    wav_player_tap_cb_t tap_cb;         /*!< Callback with the played audio (can be NULL) */
+    void *user_ctx;                     /*!< User data for the callbacks */
+} wav_player_config_t;
+
+/**
+ * @brief Default WAV player configuration
+ */
+#define WAV_PLAYER_CONFIG_DEFAULT(codec_dev)    \
+    {                                           \
+        .codec = (codec_dev),                   \
+        .ring_size = 16 * 1024,                 \
+        .chunk_size = 1024,                     \
+        .mclk_multiple = 0,                     \
+        .output_rate = 0,                       \
+        .output_channels = 1,                   \
+        .volume = 100,                          \
+        .reader_priority = 5,                   \
+        .writer_priority = 6,                   \
+        .task_stack = 4096,                     \
+        .task_affinity = -1,                    \
+    }
+
+/**
+ * @brief WAV player statistics (since the last start of playback)
+ */
+typedef struct {
+    uint32_t underrun_cnt;              /*!< Count of writes, when the ring buffer was empty (silence was sent instead) */
+    uint32_t read_time_max;             /*!< Longest file read in [us] */
+    uint32_t ring_level_min;            /*!< Lowest count of buffered bytes during playback */
+    uint64_t bytes_played;              /*!< Count of bytes sent to the codec */
+} wav_player_stats_t;
+
+/**
+ * @brief WAV player handle
+ */
+typedef struct wav_player_s *wav_player_handle_t;
+
+/**
+ * @brief Create WAV player
+ *
+ * @param config        Configuration
+ * @param ret_handle    Created player
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if there is no memory for the player
+ */
+esp_err_t wav_player_create(const wav_player_config_t *config, wav_player_handle_t *ret_handle);
+
+/**
+ * @brief Delete WAV player
+ *
+ * @note Playing file is stopped
+ *
+ * @param handle    Player
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t wav_player_delete(wav_player_handle_t handle);
+
+/**
+ * @brief Start playing WAV file
+ *
+ * @note Playing file is stopped first. The playback starts, when the ring buffer is half full.
+ * @note With fixed output rate, only 16-bit mono or stereo files are supported
+ *
+ * @param handle    Player
+ * @param path      Path to the WAV file (PCM)
+ * @param repeat    Play the file repeatedly
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t wav_player_play(wav_player_handle_t handle, const char *path, bool repeat);
+
+/**
+ * @brief Stop playing and wait until the codec is closed
+ *
+ * @param handle    Player
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t wav_player_stop(wav_player_handle_t handle);
+
+/**
+ * @brief Change repeating of the playing file
+ *
+ * @param handle    Player
+ * @param repeat    Play the file repeatedly
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t wav_player_set_repeat(wav_player_handle_t handle, bool repeat);
+
+/**
+ * @brief Set software volume of the playback
+ *
+ * The samples are attenuated by the writer task (0.5 dB per step, 100 is 0 dB, 0 is mute). The gain is ramped
+ * over one chunk, so changes do not click and no codec register is written. It can be called for every slider event.
+ *
+ * @note Only 16-bit PCM is attenuated, the codec output volume stays the reference (maximum) level
+ *
+ * @param handle    Player
+ * @param volume    Volume (0 - 100), values out of range are truncated
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t wav_player_set_volume(wav_player_handle_t handle, int volume);
+
+/**
+ * @brief Check, if the player is playing
+ *
+ * @param handle    Player
+ * @return true, if a file is playing
+ */
+bool wav_player_is_playing(wav_player_handle_t handle);
+
+/**
+ * @brief Get statistics of the playback
+ *
+ * @param handle    Player
+ * @param stats     Output statistics
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t wav_player_get_stats(wav_player_handle_t handle, wav_player_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,161 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief WAV file recorder with ring buffer between capture and storage
+ *
+ * A capture task reads the codec and never waits for the storage. A writer task stores the data
+ * in large blocks aligned to sectors, so slow flash or SD card writes do not stall I2S reads.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_codec_dev.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Encoding of the recorded audio data
+ */
+typedef enum {
+    WAV_RECORDER_ENCODING_PCM = 0,      /*!< Uncompressed PCM */
+    WAV_RECORDER_ENCODING_IMA_ADPCM,    /*!< IMA-ADPCM, 4 bits per sample, only 16-bit mono or stereo recordings */
+} wav_recorder_encoding_t;
+
+/**
+ * @brief WAV recorder configuration
+ */
+typedef struct {
+    esp_codec_dev_handle_t codec;       /*!< Microphone codec device (e.g. from `bsp_audio_codec_microphone_init`) */
+    size_t ring_size;                   /*!< Size of the ring buffer between capture and storage [bytes] */
+    size_t read_size;                   /*!< Size of one codec read [bytes] */
+    size_t block_size;                  /*!< Size of one file write, multiple of 512 (sector) [bytes] */
+    wav_recorder_encoding_t encoding;   /*!< Encoding of the file, IMA-ADPCM is encoded by the writer task */
+    int capture_priority;               /*!< Priority of the capture task (should be higher than writer) */
+    int writer_priority;                /*!< Priority of the writer task */
+    int task_stack;                     /*!< Stack size of each task [bytes] */
+    int task_affinity;                  /*!< Core of the tasks (-1 for no affinity) */
+    struct {
+        unsigned int ring_spiram: 1;    /*!< Ring buffer is allocated in PSRAM */
+    } flags;
+} wav_recorder_config_t;
+
+/**
+ * @brief Default WAV recorder configuration
+ */
+#define WAV_RECORDER_CONFIG_DEFAULT(codec_dev)  \
+    {                                           \
+        .codec = (codec_dev),                   \
+        .ring_size = 64 * 1024,                 \
+        .read_size = 1024,                      \
+        .block_size = 4096,                     \
+        .encoding = WAV_RECORDER_ENCODING_PCM,  \
+        .capture_priority = 7,                  \
+        .writer_priority = 5,                   \
+        .task_stack = 4096,                     \
+        .task_affinity = -1,                    \
+        .flags = {                              \
+            .ring_spiram = 0,                   \
+        },                                      \
+    }
+
+/**
+ * @brief WAV recorder statistics (of the current or the last recording)
+ */
+typedef struct {
+    uint32_t overrun_cnt;               /*!< Count of codec reads dropped, because the ring buffer was full */
+    uint32_t overrun_bytes;             /*!< Count of dropped bytes */
+    uint32_t write_time_max;            /*!< Longest file write of one block in [us] */
+    uint32_t ring_level_max;            /*!< Highest count of bytes waiting for storage */
+    uint32_t bytes_written;             /*!< Count of audio data bytes in the file (encoded) */
+    uint32_t encode_time_max;           /*!< Longest encoding of one IMA-ADPCM block [us] */
+} wav_recorder_stats_t;
+
+/**
+ * @brief WAV recorder handle
+ */
+typedef struct wav_recorder_s *wav_recorder_handle_t;
+
+/**
+ * @brief Create WAV recorder
+ *
+ * @param config        Configuration
+ * @param ret_handle    Created recorder
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NO_MEM        if there is no memory for the recorder
+ */
+esp_err_t wav_recorder_create(const wav_recorder_config_t *config, wav_recorder_handle_t *ret_handle);
+
+/**
+ * @brief Delete WAV recorder
+ *
+ * @note Running recording is stopped
+ *
+ * @param handle    Recorder
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t wav_recorder_delete(wav_recorder_handle_t handle);
+
+/**
+ * @brief Open the codec and start recording into WAV file
+ *
+ * @param handle    Recorder
+ * @param path      Path to the created WAV file
+ * @param fs        Format of the recording (`mclk_multiple` is passed to the codec)
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_ERR_NOT_SUPPORTED if the format cannot be encoded (IMA-ADPCM needs 16-bit mono or stereo)
+ *      - ESP_ERR_INVALID_STATE if the recording is already running
+ *      - ESP_ERR_NOT_FOUND     if the file cannot be created
+ *      - ESP_FAIL              if the codec cannot be opened
+ */
+esp_err_t wav_recorder_start(wav_recorder_handle_t handle, const char *path, const esp_codec_dev_sample_info_t *fs);
+
+/**
+ * @brief Stop recording, store buffered data and update the WAV header
+ *
+ * @param handle    Recorder
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ *      - ESP_FAIL              if reading of codec or writing of file failed during recording
+ */
+esp_err_t wav_recorder_stop(wav_recorder_handle_t handle);
+
+/**
+ * @brief Check, if the recorder is recording
+ *
+ * @param handle    Recorder
+ * @return true, if a recording is running
+ */
+bool wav_recorder_is_recording(wav_recorder_handle_t handle);
+
+/**
+ * @brief Get statistics of the recording
+ *
+ * @param handle    Recorder
+ * @param stats     Output statistics
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter error
+ */
+esp_err_t wav_recorder_get_stats(wav_recorder_handle_t handle, wav_recorder_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
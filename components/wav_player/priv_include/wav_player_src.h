@@ -0,0 +1,66 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Polyphase sample rate converter of 16-bit PCM
+ */
+typedef struct wav_player_src_s wav_player_src_t;
+
+/**
+ * @brief Create converter
+ *
+ * @param max_in_frames Maximum count of input sample frames in one process call
+ * @param out_channels  Output channels (1 or 2)
+ * @param ret_src       Created converter
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_NO_MEM        if there is no memory for the converter
+ */
+esp_err_t wav_player_src_create(size_t max_in_frames, uint8_t out_channels, wav_player_src_t **ret_src);
+
+/**
+ * @brief Delete converter
+ */
+void wav_player_src_delete(wav_player_src_t *src);
+
+/**
+ * @brief Set input format and clear history (before each file)
+ *
+ * @param src           Converter
+ * @param in_rate       Input sample rate [Hz]
+ * @param out_rate      Output sample rate [Hz]
+ * @param in_channels   Input channels (1 or 2)
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_NOT_SUPPORTED if the format is not supported
+ *      - ESP_ERR_NO_MEM        if there is no memory for the output buffer
+ */
+esp_err_t wav_player_src_reset(wav_player_src_t *src, uint32_t in_rate, uint32_t out_rate, uint8_t in_channels);
+
+/**
+ * @brief Convert input sample frames
+ *
+ * @param src       Converter
+ * @param in        Interleaved input samples
+ * @param in_frames Count of input sample frames (up to max_in_frames)
+ * @param out       Converted interleaved samples (owned by the converter, valid until the next call)
+ * @return Count of output sample frames
+ */
+size_t wav_player_src_process(wav_player_src_t *src, const int16_t *in, size_t in_frames, const int16_t **out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,151 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <math.h>
+#include "unity.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "wav_player.h"
+#include "wav_recorder.h"
+#include "wav_adpcm.h"
+
+static SemaphoreHandle_t done;
+static esp_err_t done_result;
+
+static void done_cb(esp_err_t result, void *user_ctx)
+{
+    done_result = result;
+    xSemaphoreGive(done);
+}
+
+TEST_CASE("WAV player missing file test", "[wav_player]")
+{
+    /* Codec is not opened, when the file cannot be read */
+    static int dummy_codec;
+    wav_player_handle_t player = NULL;
+
+    done = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(done);
+
+    wav_player_config_t config = WAV_PLAYER_CONFIG_DEFAULT(NULL);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, wav_player_create(&config, &player));
+
+    config.codec = (esp_codec_dev_handle_t)&dummy_codec;
+    config.chunk_size = 1022;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, wav_player_create(&config, &player));
+
+    config.chunk_size = 1024;
+    config.ring_size = 16 * 1024 + 2;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, wav_player_create(&config, &player));
+
+    config.ring_size = 16 * 1024;
+    config.done_cb = done_cb;
+    TEST_ASSERT_EQUAL(ESP_OK, wav_player_create(&config, &player));
+    TEST_ASSERT_FALSE(wav_player_is_playing(player));
+    TEST_ASSERT_EQUAL(ESP_OK, wav_player_set_volume(player, 50));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, wav_player_set_volume(NULL, 50));
+
+    TEST_ASSERT_EQUAL(ESP_OK, wav_player_play(player, "/not_existing/file.wav", true));
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(done, pdMS_TO_TICKS(1000)));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, done_result);
+    TEST_ASSERT_EQUAL(ESP_OK, wav_player_stop(player));
+    TEST_ASSERT_FALSE(wav_player_is_playing(player));
+
+    wav_player_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, wav_player_get_stats(player, &stats));
+    TEST_ASSERT_EQUAL(0, stats.bytes_played);
+    TEST_ASSERT_EQUAL(0, stats.underrun_cnt);
+
+    TEST_ASSERT_EQUAL(ESP_OK, wav_player_delete(player));
+    vSemaphoreDelete(done);
+}
+
+TEST_CASE("WAV recorder invalid arguments test", "[wav_recorder]")
+{
+    /* Codec is not opened, when the file cannot be created */
+    static int dummy_codec;
+    wav_recorder_handle_t recorder = NULL;
+    const esp_codec_dev_sample_info_t fs = {
+        .sample_rate = 16000,
+        .channel = 1,
+        .bits_per_sample = 16,
+    };
+
+    wav_recorder_config_t config = WAV_RECORDER_CONFIG_DEFAULT(NULL);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, wav_recorder_create(&config, &recorder));
+
+    config.codec = (esp_codec_dev_handle_t)&dummy_codec;
+    config.block_size = 4000;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, wav_recorder_create(&config, &recorder));
+
+    config.block_size = 4096;
+    config.ring_size = 4096;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, wav_recorder_create(&config, &recorder));
+
+    config.ring_size = 16 * 1024;
+    TEST_ASSERT_EQUAL(ESP_OK, wav_recorder_create(&config, &recorder));
+    TEST_ASSERT_FALSE(wav_recorder_is_recording(recorder));
+
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, wav_recorder_start(recorder, "/not_existing/file.wav", &fs));
+    TEST_ASSERT_FALSE(wav_recorder_is_recording(recorder));
+    TEST_ASSERT_EQUAL(ESP_OK, wav_recorder_stop(recorder));
+
+    wav_recorder_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, wav_recorder_get_stats(recorder, &stats));
+    TEST_ASSERT_EQUAL(0, stats.bytes_written);
+    TEST_ASSERT_EQUAL(0, stats.overrun_cnt);
+
+    TEST_ASSERT_EQUAL(ESP_OK, wav_recorder_delete(recorder));
+}
+
+TEST_CASE("IMA-ADPCM encode and decode benchmark", "[wav_player][adpcm]")
+{
+    /* CPU cost of one second of audio, the encoder runs in the recorder writer and the decoder in the player reader */
+    const uint32_t rates[] = {16000, 48000};
+
+    for (int ch = 1; ch <= 2; ch++) {
+        const size_t block_align = WAV_ADPCM_BLOCK_SIZE * ch;
+        const size_t frames = wav_adpcm_block_frames(block_align, ch);
+        int16_t *pcm = malloc(frames * ch * sizeof(int16_t));
+        int16_t *decoded = malloc(frames * ch * sizeof(int16_t));
+        uint8_t *block = malloc(block_align);
+        TEST_ASSERT_NOT_NULL(pcm);
+        TEST_ASSERT_NOT_NULL(decoded);
+        TEST_ASSERT_NOT_NULL(block);
+        for (size_t i = 0; i < frames * ch; i++) {
+            pcm[i] = 10000 * sinf(i * 0.05f);
+        }
+
+        for (int r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+            const uint32_t blocks = (rates[r] + frames - 1) / frames;
+            wav_adpcm_state_t state[2] = {0};
+            int64_t encode_time = 0;
+            int64_t decode_time = 0;
+            for (uint32_t b = 0; b < blocks; b++) {
+                int64_t start = esp_timer_get_time();
+                wav_adpcm_encode_block(state, pcm, ch, block_align, block);
+                encode_time += esp_timer_get_time() - start;
+                start = esp_timer_get_time();
+                TEST_ASSERT_EQUAL(frames, wav_adpcm_decode_block(block, block_align, ch, decoded));
+                decode_time += esp_timer_get_time() - start;
+            }
+            printf("IMA-ADPCM %" PRIu32 " Hz, %d ch: encode %" PRId64 " us/s (%.1f %% CPU), decode %" PRId64 " us/s (%.1f %% CPU)\n",
+                   rates[r], ch, encode_time, encode_time / 10000.0f, decode_time, decode_time / 10000.0f);
+        }
+
+        /* 4-bit coding of a sine keeps the error small */
+        for (size_t i = 0; i < frames * ch; i++) {
+            TEST_ASSERT_INT_WITHIN(1000, pcm[i], decoded[i]);
+        }
+        free(pcm);
+        free(decoded);
+        free(block);
+    }
+}
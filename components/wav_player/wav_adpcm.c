@@ -0,0 +1,128 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <sys/param.h>
+#include "wav_adpcm.h"
+
+#define WAV_ADPCM_INDEX_MAX (88)
+
+static const uint16_t wav_adpcm_steps[WAV_ADPCM_INDEX_MAX + 1] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t wav_adpcm_index_step[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+/* Reconstruct the sample from the nibble, encoder uses it too, so both sides have the same predictor */
+static inline int16_t wav_adpcm_expand(wav_adpcm_state_t *state, uint8_t nibble)
+{
+    const int32_t step = wav_adpcm_steps[state->index];
+    int32_t diff = step >> 3;
+    if (nibble & 4) {
+        diff += step;
+    }
+    if (nibble & 2) {
+        diff += step >> 1;
+    }
+    if (nibble & 1) {
+        diff += step >> 2;
+    }
+    int32_t sample = state->predictor + ((nibble & 8) ? -diff : diff);
+    sample = MAX(MIN(sample, INT16_MAX), INT16_MIN);
+    state->predictor = sample;
+
+    const int index = state->index + wav_adpcm_index_step[nibble & 7];
+    state->index = MAX(MIN(index, WAV_ADPCM_INDEX_MAX), 0);
+    return sample;
+}
+
+static inline uint8_t wav_adpcm_compress(wav_adpcm_state_t *state, int16_t sample)
+{
+    int32_t step = wav_adpcm_steps[state->index];
+    int32_t diff = sample - state->predictor;
+    uint8_t nibble = 0;
+    if (diff < 0) {
+        nibble = 8;
+        diff = -diff;
+    }
+    if (diff >= step) {
+        nibble |= 4;
+        diff -= step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        nibble |= 2;
+        diff -= step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        nibble |= 1;
+    }
+    wav_adpcm_expand(state, nibble);
+    return nibble;
+}
+
+void wav_adpcm_encode_block(wav_adpcm_state_t *state, const int16_t *in, uint8_t channels, size_t block_align, uint8_t *out)
+{
+    const size_t groups = (block_align - 4U * channels) / (4U * channels);
+
+    for (int ch = 0; ch < channels; ch++) {
+        /* First sample is stored as it is, the step index continues from the previous block */
+        state[ch].predictor = in[ch];
+        out[ch * 4 + 0] = in[ch] & 0xFF;
+        out[ch * 4 + 1] = (uint16_t)in[ch] >> 8;
+        out[ch * 4 + 2] = state[ch].index;
+        out[ch * 4 + 3] = 0;
+    }
+    out += 4 * channels;
+    in += channels;
+
+    for (size_t g = 0; g < groups; g++) {
+        for (int ch = 0; ch < channels; ch++) {
+            const int16_t *src = &in[ch];
+            for (int i = 0; i < 4; i++) {
+                const uint8_t low = wav_adpcm_compress(&state[ch], src[(2 * i) * channels]);
+                const uint8_t high = wav_adpcm_compress(&state[ch], src[(2 * i + 1) * channels]);
+                *out++ = low | (high << 4);
+            }
+        }
+        in += 8 * channels;
+    }
+}
+
+size_t wav_adpcm_decode_block(const uint8_t *in, size_t len, uint8_t channels, int16_t *out)
+{
+    wav_adpcm_state_t state[2];
+
+    if (len < 4U * channels) {
+        return 0;
+    }
+    for (int ch = 0; ch < channels; ch++) {
+        state[ch].predictor = (int16_t)(in[ch * 4] | (in[ch * 4 + 1] << 8));
+        state[ch].index = MIN(in[ch * 4 + 2], WAV_ADPCM_INDEX_MAX);
+        out[ch] = state[ch].predictor;
+    }
+    const size_t groups = (len - 4U * channels) / (4U * channels);
+    in += 4 * channels;
+    out += channels;
+
+    for (size_t g = 0; g < groups; g++) {
+        for (int ch = 0; ch < channels; ch++) {
+            int16_t *dst = &out[ch];
+            for (int i = 0; i < 4; i++) {
+                const uint8_t data = *in++;
+                dst[(2 * i) * channels] = wav_adpcm_expand(&state[ch], data & 0x0F);
+                dst[(2 * i + 1) * channels] = wav_adpcm_expand(&state[ch], data >> 4);
+            }
+        }
+        out += 8 * channels;
+    }
+    return 1 + groups * 8;
+}
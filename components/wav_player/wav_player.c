@@ -0,0 +1,570 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "freertos/ringbuf.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "wav_player.h"
+#include "wav_player_src.h"
+#include "wav_adpcm.h"
+
+static const char *TAG = "wav_player";
+
+#define WAV_PLAYER_PATH_MAX         (256)
+/* Period of checking the stop request, when the reader or writer waits */
+#define WAV_PLAYER_WAIT_MS          (50)
+/* Time without data in the ring buffer, after which silence is sent to the codec */
+#define WAV_PLAYER_UNDERRUN_MS      (10)
+/* Header of WAV files recorded by the examples (without RIFF tags) */
+#define WAV_PLAYER_PLAIN_HEADER     (44)
+/* Largest supported frame (8 channels of 32-bit samples) [bytes] */
+#define WAV_PLAYER_FRAME_MAX        (32)
+/* Software volume gain 0 dB (Q15) */
+#define WAV_PLAYER_GAIN_UNITY       (32768)
+
+#define WAV_PLAYER_EV_PLAY          BIT0    /* Reader: new file should be played */
+#define WAV_PLAYER_EV_DATA          BIT1    /* Writer: ring buffer is prefilled (or the reader finished) */
+#define WAV_PLAYER_EV_READER_IDLE   BIT2
+#define WAV_PLAYER_EV_WRITER_IDLE   BIT3
+#define WAV_PLAYER_EV_READER_EXIT   BIT4
+#define WAV_PLAYER_EV_WRITER_EXIT   BIT5
+
+struct wav_player_s {
+    esp_codec_dev_handle_t codec;
+    wav_player_done_cb_t done_cb;
+    wav_player_tap_cb_t tap_cb;
+    void *user_ctx;
+    int mclk_multiple;
+    uint32_t output_rate;
+    uint8_t output_channels;
+    wav_player_src_t *src;                  /* Sample rate converter in fixed output rate mode */
+    bool codec_open;                        /* Codec stays open in fixed output rate mode */
+    volatile int32_t gain_target;           /* Software volume set by user (Q15) */
+    int32_t gain;                           /* Gain of the last written sample (Q15) */
+    size_t ring_size;
+    size_t chunk_size;
+    RingbufHandle_t ring;                   /* Prefetched audio data */
+    EventGroupHandle_t events;
+    uint8_t *read_buf;                      /* One chunk read from the file */
+    uint8_t *silence;                       /* One chunk of silence for underruns */
+    char path[WAV_PLAYER_PATH_MAX];
+    esp_codec_dev_sample_info_t fs;         /* Format of the playing file (decoded) */
+    uint16_t adpcm_block;                   /* Size of IMA-ADPCM block, 0 for PCM file */
+    esp_err_t result;
+    wav_player_stats_t stats;
+    volatile bool repeat;
+    volatile bool stop;
+    volatile bool running;
+};
+
+static inline uint16_t wav_player_le16(const uint8_t *data)
+{
+    return data[0] | (data[1] << 8);
+}
+
+static inline uint32_t wav_player_le32(const uint8_t *data)
+{
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+/* Find format and data chunks of RIFF WAVE file, the file is positioned to the start of audio data */
+static esp_err_t wav_player_parse_header(FILE *f, esp_codec_dev_sample_info_t *fs, uint16_t *adpcm_block, long *data_offset, uint32_t *data_size)
+{
+    uint8_t hdr[WAV_PLAYER_PLAIN_HEADER];
+    bool fmt_found = false;
+
+    *adpcm_block = 0;
+    ESP_RETURN_ON_FALSE(fread(hdr, 1, 12, f) == 12, ESP_ERR_INVALID_SIZE, TAG, "File is too short");
+    if (memcmp(hdr, "RIFF", 4) != 0 || memcmp(&hdr[8], "WAVE", 4) != 0) {
+        /* Plain 44 bytes header with fields on fixed positions */
+        ESP_RETURN_ON_FALSE(fread(&hdr[12], 1, WAV_PLAYER_PLAIN_HEADER - 12, f) == WAV_PLAYER_PLAIN_HEADER - 12, ESP_ERR_INVALID_SIZE, TAG, "File is too short");
+        fs->channel = wav_player_le16(&hdr[22]);
+        fs->sample_rate = wav_player_le32(&hdr[24]);
+        fs->bits_per_sample = wav_player_le16(&hdr[34]);
+        *data_size = wav_player_le32(&hdr[40]);
+        *data_offset = WAV_PLAYER_PLAIN_HEADER;
+        return ESP_OK;
+    }
+
+    while (fread(hdr, 1, 8, f) == 8) {
+        const uint32_t chunk_size = wav_player_le32(&hdr[4]);
+        if (memcmp(hdr, "fmt ", 4) == 0) {
+            ESP_RETURN_ON_FALSE(chunk_size >= 16 && fread(&hdr[8], 1, 16, f) == 16, ESP_ERR_INVALID_SIZE, TAG, "Invalid format chunk");
+            const uint16_t format = wav_player_le16(&hdr[8]);
+            ESP_RETURN_ON_FALSE(format == 1 || format == 0xFFFE || format == WAV_ADPCM_FORMAT_TAG, ESP_ERR_NOT_SUPPORTED, TAG,
+                                "Only PCM and IMA-ADPCM are supported");
+            fs->channel = wav_player_le16(&hdr[10]);
+            fs->sample_rate = wav_player_le32(&hdr[12]);
+            fs->bits_per_sample = wav_player_le16(&hdr[22]);
+            if (format == WAV_ADPCM_FORMAT_TAG) {
+                /* Blocks are decoded by the reader, the ring buffer and the codec get 16-bit PCM */
+                *adpcm_block = wav_player_le16(&hdr[20]);
+                ESP_RETURN_ON_FALSE(fs->bits_per_sample == 4 && wav_adpcm_block_valid(*adpcm_block, fs->channel), ESP_ERR_NOT_SUPPORTED, TAG,
+                                    "Unsupported IMA-ADPCM block");
+                fs->bits_per_sample = 16;
+            }
+            fmt_found = true;
+            fseek(f, (chunk_size - 16) + (chunk_size & 1), SEEK_CUR);
+        } else if (memcmp(hdr, "data", 4) == 0) {
+            ESP_RETURN_ON_FALSE(fmt_found, ESP_ERR_INVALID_STATE, TAG, "Format chunk is missing");
+            *data_size = chunk_size;
+            *data_offset = ftell(f);
+            return ESP_OK;
+        } else {
+            /* Chunks are aligned to 2 bytes */
+            fseek(f, chunk_size + (chunk_size & 1), SEEK_CUR);
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+static void wav_player_read_file(wav_player_handle_t handle)
+{
+    esp_err_t ret = ESP_OK;
+    bool data_ready = false;
+    long data_offset = 0;
+    uint32_t data_size = 0;
+    uint8_t *read_buf = handle->read_buf;
+    size_t read_size = handle->chunk_size;
+    int16_t *pcm = NULL;
+
+    FILE *f = fopen(handle->path, "rb");
+    ESP_GOTO_ON_FALSE(f, ESP_ERR_NOT_FOUND, end, TAG, "File %s does not exist", handle->path);
+    ESP_GOTO_ON_ERROR(wav_player_parse_header(f, &handle->fs, &handle->adpcm_block, &data_offset, &data_size), end, TAG, "Unsupported WAV file %s", handle->path);
+    ESP_GOTO_ON_FALSE(data_size > 0 && handle->fs.channel > 0 && handle->fs.bits_per_sample > 0, ESP_ERR_INVALID_SIZE, end, TAG, "Empty WAV file %s", handle->path);
+    ESP_GOTO_ON_FALSE((handle->fs.bits_per_sample % 8) == 0 && handle->fs.channel * handle->fs.bits_per_sample / 8 <= WAV_PLAYER_FRAME_MAX,
+                      ESP_ERR_NOT_SUPPORTED, end, TAG, "Unsupported frame size of WAV file %s", handle->path);
+    ESP_LOGI(TAG, "Playing %s: %" PRIu32 " Hz, %d bit, %d channels, %" PRIu32 " bytes%s", handle->path, handle->fs.sample_rate,
+             handle->fs.bits_per_sample, handle->fs.channel, data_size, handle->adpcm_block ? " (IMA-ADPCM)" : "");
+    if (handle->adpcm_block) {
+        /* One block is read and decoded at once, it is 4 times smaller than the decoded data */
+        const size_t pcm_size = wav_adpcm_block_frames(handle->adpcm_block, handle->fs.channel) * handle->fs.channel * sizeof(int16_t);
+        ESP_GOTO_ON_FALSE(pcm_size <= handle->ring_size / 2, ESP_ERR_NOT_SUPPORTED, end, TAG, "IMA-ADPCM block is too big for the ring buffer");
+        read_size = handle->adpcm_block;
+        read_buf = malloc(read_size);
+        pcm = malloc(pcm_size);
+        ESP_GOTO_ON_FALSE(read_buf && pcm, ESP_ERR_NO_MEM, end, TAG, "Not enough memory for IMA-ADPCM decoding");
+    }
+    fseek(f, data_offset, SEEK_SET);
+
+    uint32_t remaining = data_size;
+    while (!handle->stop) {
+        if (remaining == 0) {
+            if (!handle->repeat) {
+                break;
+            }
+            /* The writer plays buffered data meanwhile, repeat has no gap */
+            fseek(f, data_offset, SEEK_SET);
+            remaining = data_size;
+        }
+
+        const int64_t start = esp_timer_get_time();
+        size_t len = fread(read_buf, 1, MIN(read_size, remaining), f);
+        const uint32_t read_time = esp_timer_get_time() - start;
+        handle->stats.read_time_max = MAX(handle->stats.read_time_max, read_time);
+        if (len == 0) {
+            ESP_LOGW(TAG, "File %s is truncated", handle->path);
+            break;
+        }
+        remaining -= len;
+
+        const void *data = read_buf;
+        if (pcm) {
+            /* Decoded here, so the writer task and I2S DMA do not wait for it */
+            len = wav_adpcm_decode_block(read_buf, len, handle->fs.channel, pcm) * handle->fs.channel * sizeof(int16_t);
+            data = pcm;
+            if (len == 0) {
+                continue;
+            }
+        }
+
+        /* Wait for free space in the ring buffer, the stop request is checked meanwhile */
+        while (!handle->stop && xRingbufferSend(handle->ring, data, len, pdMS_TO_TICKS(WAV_PLAYER_WAIT_MS)) != pdTRUE) {
+        }
+
+        /* Playback starts with half full ring buffer */
+        if (!data_ready && handle->ring_size - xRingbufferGetCurFreeSize(handle->ring) >= handle->ring_size / 2) {
+            xEventGroupSetBits(handle->events, WAV_PLAYER_EV_DATA);
+            data_ready = true;
+        }
+    }
+
+end:
+    if (f) {
+        fclose(f);
+    }
+    if (read_buf != handle->read_buf) {
+        free(read_buf);
+    }
+    free(pcm);
+    handle->result = ret;
+    /* Short file never fills the ring buffer */
+    if (!data_ready) {
+        xEventGroupSetBits(handle->events, WAV_PLAYER_EV_DATA);
+    }
+}
+
+/* Discard buffered data until the reader finishes */
+static void wav_player_drain(wav_player_handle_t handle)
+{
+    while (1) {
+        const bool reader_done = (xEventGroupGetBits(handle->events) & WAV_PLAYER_EV_READER_IDLE);
+        size_t len = 0;
+        void *item = xRingbufferReceiveUpTo(handle->ring, &len, pdMS_TO_TICKS(WAV_PLAYER_WAIT_MS), handle->ring_size);
+        if (item) {
+            vRingbufferReturnItem(handle->ring, item);
+        } else if (reader_done) {
+            break;
+        }
+    }
+}
+
+static int32_t wav_player_volume_to_gain(int volume)
+{
+    volume = MAX(MIN(volume, 100), 0);
+    /* 0.5 dB per step */
+    return (volume == 0) ? 0 : lrintf(WAV_PLAYER_GAIN_UNITY * powf(10.0f, (volume - 100) / 40.0f));
+}
+
+/* Gain is ramped linearly from the previous value to the target over the chunk, volume steps do not click */
+static void wav_player_apply_gain(wav_player_handle_t handle, int16_t *data, size_t frames, uint8_t channels)
+{
+    const int32_t target = handle->gain_target;
+    int32_t gain = handle->gain;
+    if ((gain == target && gain == WAV_PLAYER_GAIN_UNITY) || frames == 0) {
+        return;
+    }
+
+    const int32_t step = (target - gain) / (int32_t)frames;
+    for (size_t i = 0; i < frames; i++) {
+        for (int j = 0; j < channels; j++) {
+            data[i * channels + j] = (data[i * channels + j] * gain) >> 15;
+        }
+        gain += step;
+    }
+    handle->gain = target;
+}
+
+static void wav_player_codec_write(wav_player_handle_t handle, void *data, size_t len)
+{
+    if (handle->src) {
+        const int16_t *out = NULL;
+        const size_t frames = wav_player_src_process(handle->src, data, len / (handle->fs.channel * sizeof(int16_t)), &out);
+        data = (void *)out;
+        len = frames * handle->output_channels * sizeof(int16_t);
+        if (len == 0) {
+            return;
+        }
+        wav_player_apply_gain(handle, data, frames, handle->output_channels);
+        if (handle->tap_cb) {
+            handle->tap_cb(data, frames, handle->output_channels, handle->output_rate, handle->user_ctx);
+        }
+    } else if (handle->fs.bits_per_sample == 16) {
+        const size_t frames = len / (handle->fs.channel * sizeof(int16_t));
+        wav_player_apply_gain(handle, data, frames, handle->fs.channel);
+        if (handle->tap_cb) {
+            handle->tap_cb(data, frames, handle->fs.channel, handle->fs.sample_rate, handle->user_ctx);
+        }
+    }
+    esp_codec_dev_write(handle->codec, data, len);
+}
+
+static esp_err_t wav_player_codec_open(wav_player_handle_t handle, esp_codec_dev_sample_info_t *fs)
+{
+    if (handle->src) {
+        /* Files are converted to one format, switching of files does not reconfigure the codec clocks */
+        ESP_RETURN_ON_FALSE(fs->bits_per_sample == 16, ESP_ERR_NOT_SUPPORTED, TAG, "Only 16-bit files can be resampled");
+        ESP_RETURN_ON_ERROR(wav_player_src_reset(handle->src, fs->sample_rate, handle->output_rate, fs->channel), TAG, "Unsupported file format");
+        if (handle->codec_open) {
+            return ESP_OK;
+        }
+        fs->sample_rate = handle->output_rate;
+        fs->channel = handle->output_channels;
+    }
+    ESP_RETURN_ON_FALSE(esp_codec_dev_open(handle->codec, fs) == ESP_CODEC_DEV_OK, ESP_FAIL, TAG, "Codec open failed");
+    handle->codec_open = true;
+    return ESP_OK;
+}
+
+static void wav_player_write(wav_player_handle_t handle)
+{
+    /* Stopped during prefill or nothing was read (the reader sets the result before waking the writer) */
+    const bool empty = (xRingbufferGetCurFreeSize(handle->ring) == handle->ring_size);
+    if (handle->stop || (empty && handle->result != ESP_OK)) {
+        wav_player_drain(handle);
+        return;
+    }
+
+    esp_codec_dev_sample_info_t fs = handle->fs;
+    fs.mclk_multiple = handle->mclk_multiple;
+    const esp_err_t err = wav_player_codec_open(handle, &fs);
+    if (err != ESP_OK) {
+        handle->stop = true;
+        wav_player_drain(handle);
+        handle->result = err;
+        return;
+    }
+    /* 8-bit PCM is unsigned */
+    memset(handle->silence, (fs.bits_per_sample == 8) ? 0x80 : 0, handle->chunk_size);
+
+    /* Chunks are whole frames, only the end of the byte ring buffer can split a frame. Its start is kept and joined with the rest. */
+    const size_t frame = handle->fs.channel * handle->fs.bits_per_sample / 8;
+    const size_t max_len = MAX(handle->chunk_size - handle->chunk_size % frame, frame);
+    uint8_t carry[WAV_PLAYER_FRAME_MAX];
+    size_t carry_len = 0;
+
+    while (!handle->stop) {
+        const bool reader_done = (xEventGroupGetBits(handle->events) & WAV_PLAYER_EV_READER_IDLE);
+        const uint32_t level = handle->ring_size - xRingbufferGetCurFreeSize(handle->ring);
+        size_t len = 0;
+        uint8_t *item = xRingbufferReceiveUpTo(handle->ring, &len, pdMS_TO_TICKS(WAV_PLAYER_UNDERRUN_MS), max_len);
+        if (item) {
+            if (!reader_done) {
+                handle->stats.ring_level_min = MIN(handle->stats.ring_level_min, level);
+            }
+            size_t used = 0;
+            if (carry_len) {
+                used = MIN(frame - carry_len, len);
+                memcpy(&carry[carry_len], item, used);
+                carry_len += used;
+                if (carry_len == frame) {
+                    wav_player_codec_write(handle, carry, frame);
+                    carry_len = 0;
+                }
+            }
+            const size_t frames_len = (len - used) - (len - used) % frame;
+            if (frames_len) {
+                wav_player_codec_write(handle, &item[used], frames_len);
+            }
+            memcpy(&carry[carry_len], &item[used + frames_len], len - used - frames_len);
+            carry_len += len - used - frames_len;
+            vRingbufferReturnItem(handle->ring, item);
+            handle->stats.bytes_played += len;
+        } else if (reader_done) {
+            /* Whole file was played */
+            break;
+        } else {
+            /* Reader is late, the codec is fed by silence instead of repeating old DMA data */
+            handle->stats.underrun_cnt++;
+            esp_codec_dev_write(handle->codec, handle->silence, handle->chunk_size);
+        }
+    }
+
+    if (handle->stop) {
+        wav_player_drain(handle);
+    }
+    if (handle->src == NULL) {
+        esp_codec_dev_close(handle->codec);
+        handle->codec_open = false;
+    }
+}
+
+static void wav_player_reader_task(void *arg)
+{
+    wav_player_handle_t handle = (wav_player_handle_t)arg;
+
+    while (1) {
+        xEventGroupWaitBits(handle->events, WAV_PLAYER_EV_PLAY, pdTRUE, pdFALSE, portMAX_DELAY);
+        if (!handle->running) {
+            break;
+        }
+        wav_player_read_file(handle);
+        xEventGroupSetBits(handle->events, WAV_PLAYER_EV_READER_IDLE);
+    }
+
+    xEventGroupSetBits(handle->events, WAV_PLAYER_EV_READER_EXIT);
+    vTaskDelete(NULL);
+}
+
+static void wav_player_writer_task(void *arg)
+{
+    wav_player_handle_t handle = (wav_player_handle_t)arg;
+
+    while (1) {
+        xEventGroupWaitBits(handle->events, WAV_PLAYER_EV_DATA, pdTRUE, pdFALSE, portMAX_DELAY);
+        if (!handle->running) {
+            break;
+        }
+        wav_player_write(handle);
+
+        /* Next file can be played from the callback */
+        xEventGroupSetBits(handle->events, WAV_PLAYER_EV_WRITER_IDLE);
+        if (handle->done_cb) {
+            handle->done_cb(handle->result, handle->user_ctx);
+        }
+    }
+
+    xEventGroupSetBits(handle->events, WAV_PLAYER_EV_WRITER_EXIT);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t wav_player_task_create(TaskFunction_t task, const char *name, const wav_player_config_t *config, int priority, wav_player_handle_t handle)
+{
+    BaseType_t res;
+    if (config->task_affinity < 0) {
+        res = xTaskCreate(task, name, config->task_stack, handle, priority, NULL);
+    } else {
+        res = xTaskCreatePinnedToCore(task, name, config->task_stack, handle, priority, NULL, config->task_affinity);
+    }
+    return (res == pdPASS) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+static void wav_player_free(wav_player_handle_t handle)
+{
+    if (handle->ring) {
+        vRingbufferDelete(handle->ring);
+    }
+    if (handle->events) {
+        vEventGroupDelete(handle->events);
+    }
+    wav_player_src_delete(handle->src);
+    free(handle->read_buf);
+    free(handle->silence);
+    free(handle);
+}
+
+esp_err_t wav_player_create(const wav_player_config_t *config, wav_player_handle_t *ret_handle)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(config && ret_handle && config->codec, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->chunk_size > 0 && (config->chunk_size % 4) == 0, ESP_ERR_INVALID_ARG, TAG, "Chunk size must be multiple of 4");
+    ESP_RETURN_ON_FALSE(config->ring_size >= 2 * config->chunk_size, ESP_ERR_INVALID_ARG, TAG, "Ring buffer must hold at least two chunks");
+    ESP_RETURN_ON_FALSE((config->ring_size % 4) == 0, ESP_ERR_INVALID_ARG, TAG, "Ring buffer size must be multiple of 4");
+    ESP_RETURN_ON_FALSE(config->output_rate == 0 || config->output_channels == 1 || config->output_channels == 2, ESP_ERR_INVALID_ARG, TAG,
+                        "Only mono and stereo output is supported");
+
+    wav_player_handle_t handle = calloc(1, sizeof(struct wav_player_s));
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_NO_MEM, TAG, "Not enough memory for player");
+    handle->codec = config->codec;
+    handle->done_cb = config->done_cb;
+    handle->tap_cb = config->tap_cb;
+    handle->user_ctx = config->user_ctx;
+    handle->mclk_multiple = config->mclk_multiple;
+    handle->ring_size = config->ring_size;
+    handle->chunk_size = config->chunk_size;
+    handle->output_rate = config->output_rate;
+    handle->output_channels = config->output_channels;
+    handle->gain_target = wav_player_volume_to_gain(config->volume);
+    handle->gain = handle->gain_target;
+
+    if (config->output_rate) {
+        /* One chunk has the most sample frames with mono files */
+        ESP_GOTO_ON_ERROR(wav_player_src_create(config->chunk_size / sizeof(int16_t), config->output_channels, &handle->src), err, TAG, "Create SRC failed");
+    }
+    handle->ring = xRingbufferCreate(config->ring_size, RINGBUF_TYPE_BYTEBUF);
+    ESP_GOTO_ON_FALSE(handle->ring, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for ring buffer");
+    handle->events = xEventGroupCreate();
+    ESP_GOTO_ON_FALSE(handle->events, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for event group");
+    handle->read_buf = malloc(config->chunk_size);
+    handle->silence = malloc(config->chunk_size);
+    ESP_GOTO_ON_FALSE(handle->read_buf && handle->silence, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for buffers");
+    /* Exit bit is cleared for created task only, the tasks do not exit until running is cleared */
+    xEventGroupSetBits(handle->events, WAV_PLAYER_EV_READER_IDLE | WAV_PLAYER_EV_WRITER_IDLE | WAV_PLAYER_EV_READER_EXIT | WAV_PLAYER_EV_WRITER_EXIT);
+
+    handle->running = true;
+    ESP_GOTO_ON_ERROR(wav_player_task_create(wav_player_reader_task, "wav_reader", config, config->reader_priority, handle), err, TAG, "Create task failed");
+    xEventGroupClearBits(handle->events, WAV_PLAYER_EV_READER_EXIT);
+    ESP_GOTO_ON_ERROR(wav_player_task_create(wav_player_writer_task, "wav_writer", config, config->writer_priority, handle), err, TAG, "Create task failed");
+    xEventGroupClearBits(handle->events, WAV_PLAYER_EV_WRITER_EXIT);
+
+    *ret_handle = handle;
+    return ESP_OK;
+
+err:
+    if (handle->events) {
+        /* Already created task exits */
+        handle->running = false;
+        xEventGroupSetBits(handle->events, WAV_PLAYER_EV_PLAY | WAV_PLAYER_EV_DATA);
+        xEventGroupWaitBits(handle->events, WAV_PLAYER_EV_READER_EXIT | WAV_PLAYER_EV_WRITER_EXIT, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+    wav_player_free(handle);
+    return ret;
+}
+
+esp_err_t wav_player_delete(wav_player_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    wav_player_stop(handle);
+    handle->running = false;
+    xEventGroupSetBits(handle->events, WAV_PLAYER_EV_PLAY | WAV_PLAYER_EV_DATA);
+    xEventGroupWaitBits(handle->events, WAV_PLAYER_EV_READER_EXIT | WAV_PLAYER_EV_WRITER_EXIT, pdFALSE, pdTRUE, portMAX_DELAY);
+    if (handle->codec_open) {
+        esp_codec_dev_close(handle->codec);
+    }
+    wav_player_free(handle);
+    return ESP_OK;
+}
+
+esp_err_t wav_player_play(wav_player_handle_t handle, const char *path, bool repeat)
+{
+    ESP_RETURN_ON_FALSE(handle && path, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(strlen(path) < WAV_PLAYER_PATH_MAX, ESP_ERR_INVALID_ARG, TAG, "Path is too long");
+
+    wav_player_stop(handle);
+    strcpy(handle->path, path);
+    handle->repeat = repeat;
+    handle->stop = false;
+    handle->result = ESP_OK;
+    memset(&handle->stats, 0, sizeof(wav_player_stats_t));
+    handle->stats.ring_level_min = UINT32_MAX;
+
+    xEventGroupClearBits(handle->events, WAV_PLAYER_EV_READER_IDLE | WAV_PLAYER_EV_WRITER_IDLE);
+    xEventGroupSetBits(handle->events, WAV_PLAYER_EV_PLAY);
+    return ESP_OK;
+}
+
+esp_err_t wav_player_stop(wav_player_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    handle->stop = true;
+    xEventGroupWaitBits(handle->events, WAV_PLAYER_EV_READER_IDLE | WAV_PLAYER_EV_WRITER_IDLE, pdFALSE, pdTRUE, portMAX_DELAY);
+    return ESP_OK;
+}
+
+esp_err_t wav_player_set_repeat(wav_player_handle_t handle, bool repeat)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    handle->repeat = repeat;
+    return ESP_OK;
+}
+
+esp_err_t wav_player_set_volume(wav_player_handle_t handle, int volume)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    /* Only the target is changed, the writer task ramps to it in the next chunk */
+    handle->gain_target = wav_player_volume_to_gain(volume);
+    return ESP_OK;
+}
+
+bool wav_player_is_playing(wav_player_handle_t handle)
+{
+    return handle && !(xEventGroupGetBits(handle->events) & WAV_PLAYER_EV_WRITER_IDLE);
+}
+
+esp_err_t wav_player_get_stats(wav_player_handle_t handle, wav_player_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(handle && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    *stats = handle->stats;
+    if (stats->ring_level_min == UINT32_MAX) {
+        stats->ring_level_min = 0;
+    }
+    return ESP_OK;
+}
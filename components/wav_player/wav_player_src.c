@@ -0,0 +1,181 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <sys/param.h>
+#include "esp_check.h"
+#include "wav_player_src.h"
+
+static const char *TAG = "wav_player_src";
+
+/* Taps of each phase of the FIR filter and count of phases (resolution of the fractional position) */
+#define WAV_PLAYER_SRC_TAPS     (16)
+#define WAV_PLAYER_SRC_PHASES   (64)
+/* Cutoff below Nyquist frequency of the lower rate, it leaves space for the filter transition band */
+#define WAV_PLAYER_SRC_CUTOFF   (0.45f)
+
+struct wav_player_src_s {
+    uint8_t in_channels;
+    uint8_t out_channels;
+    size_t max_in_frames;
+    bool same_rate;                     /* Only channels are converted */
+    uint32_t step;                      /* Input frames per one output frame (Q16) */
+    uint32_t pos;                       /* Position of the next output frame in buf (Q16) */
+    size_t fill;                        /* Count of frames in buf */
+    int16_t *buf;                       /* Input history and new input frames, converted to output channels */
+    int16_t *coeffs;                    /* PHASES x TAPS coefficients (Q15) */
+    int16_t *out;
+    size_t out_frames_max;
+};
+
+static inline float wav_player_src_sinc(float x)
+{
+    return (fabsf(x) < 1e-6f) ? 1.0f : sinf(M_PI * x) / (M_PI * x);
+}
+
+/* Windowed sinc low-pass, each phase is normalized to unity DC gain */
+static void wav_player_src_design(int16_t *coeffs, float cutoff)
+{
+    float h[WAV_PLAYER_SRC_TAPS];
+
+    for (int p = 0; p < WAV_PLAYER_SRC_PHASES; p++) {
+        float sum = 0;
+        for (int k = 0; k < WAV_PLAYER_SRC_TAPS; k++) {
+            const float x = k - (WAV_PLAYER_SRC_TAPS / 2 - 1) - (float)p / WAV_PLAYER_SRC_PHASES;
+            /* Blackman window */
+            const float w = 0.42f + 0.5f * cosf(2 * M_PI * x / WAV_PLAYER_SRC_TAPS) + 0.08f * cosf(4 * M_PI * x / WAV_PLAYER_SRC_TAPS);
+            h[k] = 2 * cutoff * wav_player_src_sinc(2 * cutoff * x) * w;
+            sum += h[k];
+        }
+        for (int k = 0; k < WAV_PLAYER_SRC_TAPS; k++) {
+            const int32_t c = lrintf(h[k] / sum * 32768.0f);
+            coeffs[p * WAV_PLAYER_SRC_TAPS + k] = MAX(MIN(c, INT16_MAX), INT16_MIN);
+        }
+    }
+}
+
+static void wav_player_src_convert_channels(const wav_player_src_t *src, const int16_t *in, size_t frames, int16_t *dst)
+{
+    if (src->in_channels == src->out_channels) {
+        memcpy(dst, in, frames * src->out_channels * sizeof(int16_t));
+    } else if (src->in_channels == 1) {
+        for (size_t i = 0; i < frames; i++) {
+            dst[2 * i] = in[i];
+            dst[2 * i + 1] = in[i];
+        }
+    } else {
+        for (size_t i = 0; i < frames; i++) {
+            dst[i] = (in[2 * i] + in[2 * i + 1]) / 2;
+        }
+    }
+}
+
+esp_err_t wav_player_src_create(size_t max_in_frames, uint8_t out_channels, wav_player_src_t **ret_src)
+{
+    ESP_RETURN_ON_FALSE(ret_src && max_in_frames > 0 && (out_channels == 1 || out_channels == 2), ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    wav_player_src_t *src = calloc(1, sizeof(wav_player_src_t));
+    ESP_RETURN_ON_FALSE(src, ESP_ERR_NO_MEM, TAG, "Not enough memory for SRC");
+    src->max_in_frames = max_in_frames;
+    src->out_channels = out_channels;
+    src->buf = malloc((WAV_PLAYER_SRC_TAPS + max_in_frames) * out_channels * sizeof(int16_t));
+    src->coeffs = malloc(WAV_PLAYER_SRC_PHASES * WAV_PLAYER_SRC_TAPS * sizeof(int16_t));
+    if (src->buf == NULL || src->coeffs == NULL) {
+        wav_player_src_delete(src);
+        ESP_LOGE(TAG, "Not enough memory for SRC buffers");
+        return ESP_ERR_NO_MEM;
+    }
+    *ret_src = src;
+    return ESP_OK;
+}
+
+void wav_player_src_delete(wav_player_src_t *src)
+{
+    if (src) {
+        free(src->buf);
+        free(src->coeffs);
+        free(src->out);
+        free(src);
+    }
+}
+
+esp_err_t wav_player_src_reset(wav_player_src_t *src, uint32_t in_rate, uint32_t out_rate, uint8_t in_channels)
+{
+    ESP_RETURN_ON_FALSE(in_rate > 0 && out_rate > 0, ESP_ERR_NOT_SUPPORTED, TAG, "Invalid sample rate");
+    ESP_RETURN_ON_FALSE(in_channels == 1 || in_channels == 2, ESP_ERR_NOT_SUPPORTED, TAG, "Only mono and stereo are supported");
+    ESP_RETURN_ON_FALSE(in_rate <= out_rate * (WAV_PLAYER_SRC_TAPS / 2), ESP_ERR_NOT_SUPPORTED, TAG, "Too high downsampling ratio");
+
+    src->in_channels = in_channels;
+    src->same_rate = (in_rate == out_rate);
+    src->step = ((uint64_t)in_rate << 16) / out_rate;
+    src->pos = 0;
+    /* Half of the filter is zero history, so the first output is centered on the first input */
+    src->fill = WAV_PLAYER_SRC_TAPS / 2;
+    memset(src->buf, 0, src->fill * src->out_channels * sizeof(int16_t));
+
+    /* All frames of the buffer can be converted in one call */
+    const size_t out_frames_max = ((uint64_t)(src->max_in_frames + WAV_PLAYER_SRC_TAPS) * out_rate) / in_rate + 2;
+    if (out_frames_max > src->out_frames_max) {
+        int16_t *out = realloc(src->out, out_frames_max * src->out_channels * sizeof(int16_t));
+        ESP_RETURN_ON_FALSE(out, ESP_ERR_NO_MEM, TAG, "Not enough memory for SRC output");
+        src->out = out;
+        src->out_frames_max = out_frames_max;
+    }
+
+    if (!src->same_rate) {
+        /* Anti-aliasing for downsampling, anti-imaging for upsampling */
+        wav_player_src_design(src->coeffs, WAV_PLAYER_SRC_CUTOFF * MIN(1.0f, (float)out_rate / in_rate));
+    }
+    return ESP_OK;
+}
+
+size_t wav_player_src_process(wav_player_src_t *src, const int16_t *in, size_t in_frames, const int16_t **out)
+{
+    const uint8_t ch = src->out_channels;
+    in_frames = MIN(in_frames, src->max_in_frames);
+
+    if (src->same_rate) {
+        if (src->in_channels == ch) {
+            *out = in;
+        } else {
+            wav_player_src_convert_channels(src, in, in_frames, src->out);
+            *out = src->out;
+        }
+        return in_frames;
+    }
+
+    wav_player_src_convert_channels(src, in, in_frames, &src->buf[src->fill * ch]);
+    src->fill += in_frames;
+
+    size_t n = 0;
+    while ((src->pos >> 16) + WAV_PLAYER_SRC_TAPS <= src->fill && n < src->out_frames_max) {
+        const int16_t *x = &src->buf[(src->pos >> 16) * ch];
+        const int16_t *c = &src->coeffs[(((src->pos & 0xFFFF) * WAV_PLAYER_SRC_PHASES) >> 16) * WAV_PLAYER_SRC_TAPS];
+        for (int j = 0; j < ch; j++) {
+            /* Sum of absolute coefficients is small, the accumulator does not overflow */
+            int32_t acc = 0;
+            for (int k = 0; k < WAV_PLAYER_SRC_TAPS; k++) {
+                acc += x[k * ch + j] * c[k];
+            }
+            acc >>= 15;
+            src->out[n * ch + j] = MAX(MIN(acc, INT16_MAX), INT16_MIN);
+        }
+        n++;
+        src->pos += src->step;
+    }
+
+    /* Keep unused frames as history of the next call */
+    const size_t consumed = MIN(src->pos >> 16, src->fill);
+    memmove(src->buf, &src->buf[consumed * ch], (src->fill - consumed) * ch * sizeof(int16_t));
+    src->fill -= consumed;
+    src->pos -= consumed << 16;
+
+    *out = src->out;
+    return n;
+}
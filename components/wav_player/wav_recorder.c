@@ -0,0 +1,424 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "freertos/ringbuf.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "wav_recorder.h"
+#include "wav_adpcm.h"
+
+static const char *TAG = "wav_recorder";
+
+/* Period of checking the end of capture, when the writer waits for data */
+#define WAV_RECORDER_WAIT_MS        (50)
+#define WAV_RECORDER_HEADER_SIZE    (44)
+/* Extended format chunk and fact chunk of compressed data */
+#define WAV_RECORDER_ADPCM_HEADER_SIZE  (60)
+#define WAV_RECORDER_SECTOR_SIZE    (512)
+
+#define WAV_RECORDER_EV_CAPTURE_DONE    BIT0
+#define WAV_RECORDER_EV_WRITER_DONE     BIT1
+
+struct wav_recorder_s {
+    esp_codec_dev_handle_t codec;
+    wav_recorder_config_t config;
+    RingbufHandle_t ring;                   /* Captured audio data waiting for storage */
+    StaticRingbuffer_t *ring_struct;
+    uint8_t *ring_storage;
+    EventGroupHandle_t events;
+    uint8_t *read_buf;                      /* One codec read */
+    uint8_t *block;                         /* One file write */
+    size_t fill;                            /* Bytes in the block */
+    uint32_t data_size;                     /* Bytes written into the file (with header) */
+    bool write_ok;
+    int16_t *pcm;                           /* Samples of one IMA-ADPCM block */
+    size_t pcm_fill;                        /* Bytes in the pcm buffer */
+    uint8_t *adpcm;                         /* One encoded IMA-ADPCM block */
+    uint16_t adpcm_block;                   /* Size of IMA-ADPCM block, 0 for PCM */
+    wav_adpcm_state_t adpcm_state[2];
+    uint32_t frames;                        /* Encoded sample frames (fact chunk) */
+    FILE *f;
+    esp_codec_dev_sample_info_t fs;         /* Format of the recording */
+    esp_err_t result;
+    wav_recorder_stats_t stats;
+    volatile bool stop;
+    bool recording;
+};
+
+static inline void wav_recorder_put_le16(uint8_t *data, uint16_t value)
+{
+    data[0] = value & 0xFF;
+    data[1] = value >> 8;
+}
+
+static inline void wav_recorder_put_le32(uint8_t *data, uint32_t value)
+{
+    data[0] = value & 0xFF;
+    data[1] = (value >> 8) & 0xFF;
+    data[2] = (value >> 16) & 0xFF;
+    data[3] = value >> 24;
+}
+
+/* IMA-ADPCM header has format chunk with samples per block and fact chunk with count of sample frames */
+static size_t wav_recorder_fill_adpcm_header(wav_recorder_handle_t handle, uint8_t *hdr, uint32_t data_size)
+{
+    const esp_codec_dev_sample_info_t *fs = &handle->fs;
+    const uint32_t block_frames = wav_adpcm_block_frames(handle->adpcm_block, fs->channel);
+
+    memcpy(&hdr[0], "RIFF", 4);
+    wav_recorder_put_le32(&hdr[4], data_size + WAV_RECORDER_ADPCM_HEADER_SIZE - 8);
+    memcpy(&hdr[8], "WAVEfmt ", 8);
+    wav_recorder_put_le32(&hdr[16], 20);
+    wav_recorder_put_le16(&hdr[20], WAV_ADPCM_FORMAT_TAG);
+    wav_recorder_put_le16(&hdr[22], fs->channel);
+    wav_recorder_put_le32(&hdr[24], fs->sample_rate);
+    wav_recorder_put_le32(&hdr[28], (uint64_t)fs->sample_rate * handle->adpcm_block / block_frames);
+    wav_recorder_put_le16(&hdr[32], handle->adpcm_block);
+    wav_recorder_put_le16(&hdr[34], 4);
+    wav_recorder_put_le16(&hdr[36], 2);
+    wav_recorder_put_le16(&hdr[38], block_frames);
+    memcpy(&hdr[40], "fact", 4);
+    wav_recorder_put_le32(&hdr[44], 4);
+    wav_recorder_put_le32(&hdr[48], handle->frames);
+    memcpy(&hdr[52], "data", 4);
+    wav_recorder_put_le32(&hdr[56], data_size);
+    return WAV_RECORDER_ADPCM_HEADER_SIZE;
+}
+
+/* Canonical RIFF WAVE header of PCM data */
+static size_t wav_recorder_fill_header(wav_recorder_handle_t handle, uint8_t *hdr, uint32_t data_size)
+{
+    const esp_codec_dev_sample_info_t *fs = &handle->fs;
+    const uint16_t block_align = fs->channel * fs->bits_per_sample / 8;
+
+    if (handle->adpcm_block) {
+        return wav_recorder_fill_adpcm_header(handle, hdr, data_size);
+    }
+
+    memcpy(&hdr[0], "RIFF", 4);
+    wav_recorder_put_le32(&hdr[4], data_size + WAV_RECORDER_HEADER_SIZE - 8);
+    memcpy(&hdr[8], "WAVEfmt ", 8);
+    wav_recorder_put_le32(&hdr[16], 16);
+    wav_recorder_put_le16(&hdr[20], 1);
+    wav_recorder_put_le16(&hdr[22], fs->channel);
+    wav_recorder_put_le32(&hdr[24], fs->sample_rate);
+    wav_recorder_put_le32(&hdr[28], fs->sample_rate * block_align);
+    wav_recorder_put_le16(&hdr[32], block_align);
+    wav_recorder_put_le16(&hdr[34], fs->bits_per_sample);
+    memcpy(&hdr[36], "data", 4);
+    wav_recorder_put_le32(&hdr[40], data_size);
+    return WAV_RECORDER_HEADER_SIZE;
+}
+
+static void wav_recorder_capture_task(void *arg)
+{
+    wav_recorder_handle_t handle = (wav_recorder_handle_t)arg;
+    const size_t len = handle->config.read_size;
+
+    while (!handle->stop) {
+        if (esp_codec_dev_read(handle->codec, handle->read_buf, len) != ESP_CODEC_DEV_OK) {
+            ESP_LOGE(TAG, "Codec read failed");
+            handle->result = ESP_FAIL;
+            break;
+        }
+        /* Never wait for the storage, I2S DMA would overflow */
+        if (xRingbufferSend(handle->ring, handle->read_buf, len, 0) != pdTRUE) {
+            handle->stats.overrun_cnt++;
+            handle->stats.overrun_bytes += len;
+            continue;
+        }
+        const uint32_t level = handle->config.ring_size - xRingbufferGetCurFreeSize(handle->ring);
+        handle->stats.ring_level_max = MAX(handle->stats.ring_level_max, level);
+    }
+
+    xEventGroupSetBits(handle->events, WAV_RECORDER_EV_CAPTURE_DONE);
+    vTaskDelete(NULL);
+}
+
+static bool wav_recorder_write_block(wav_recorder_handle_t handle, size_t len)
+{
+    const int64_t start = esp_timer_get_time();
+    const size_t written = fwrite(handle->block, 1, len, handle->f);
+    const uint32_t write_time = esp_timer_get_time() - start;
+    handle->stats.write_time_max = MAX(handle->stats.write_time_max, write_time);
+    if (written != len) {
+        ESP_LOGE(TAG, "File write failed (storage full?)");
+        handle->result = ESP_FAIL;
+        handle->stop = true;
+        return false;
+    }
+    return true;
+}
+
+static void wav_recorder_store(wav_recorder_handle_t handle, const uint8_t *data, size_t len)
+{
+    const size_t block_size = handle->config.block_size;
+
+    while (len > 0) {
+        const size_t n = MIN(len, block_size - handle->fill);
+        memcpy(&handle->block[handle->fill], data, n);
+        handle->fill += n;
+        data += n;
+        len -= n;
+        if (handle->fill == block_size) {
+            /* After a write error the data is only drained */
+            handle->write_ok = handle->write_ok && wav_recorder_write_block(handle, block_size);
+            handle->data_size += block_size;
+            handle->fill = 0;
+        }
+    }
+}
+
+static void wav_recorder_encode(wav_recorder_handle_t handle, uint32_t frames)
+{
+    const int64_t start = esp_timer_get_time();
+    wav_adpcm_encode_block(handle->adpcm_state, handle->pcm, handle->fs.channel, handle->adpcm_block, handle->adpcm);
+    const uint32_t encode_time = esp_timer_get_time() - start;
+    handle->stats.encode_time_max = MAX(handle->stats.encode_time_max, encode_time);
+    handle->frames += frames;
+    wav_recorder_store(handle, handle->adpcm, handle->adpcm_block);
+}
+
+static void wav_recorder_writer_task(void *arg)
+{
+    wav_recorder_handle_t handle = (wav_recorder_handle_t)arg;
+    const size_t frame_size = handle->fs.channel * sizeof(int16_t);
+    const size_t pcm_size = handle->adpcm_block ? wav_adpcm_block_frames(handle->adpcm_block, handle->fs.channel) * frame_size : 0;
+
+    /* Header is the start of the first block, so all blocks are written on sector boundaries */
+    const size_t header_size = wav_recorder_fill_header(handle, handle->block, 0);
+    handle->fill = header_size;
+    handle->data_size = 0;
+    handle->write_ok = true;
+    handle->pcm_fill = 0;
+    handle->frames = 0;
+    memset(handle->adpcm_state, 0, sizeof(handle->adpcm_state));
+
+    while (1) {
+        const bool capture_done = (xEventGroupGetBits(handle->events) & WAV_RECORDER_EV_CAPTURE_DONE);
+        /* PCM is copied into the block, IMA-ADPCM is collected for one encoded block first */
+        const size_t max_len = pcm_size ? pcm_size - handle->pcm_fill : handle->config.block_size - handle->fill;
+        size_t len = 0;
+        void *item = xRingbufferReceiveUpTo(handle->ring, &len, pdMS_TO_TICKS(WAV_RECORDER_WAIT_MS), max_len);
+        if (item) {
+            if (pcm_size) {
+                memcpy((uint8_t *)handle->pcm + handle->pcm_fill, item, len);
+                handle->pcm_fill += len;
+            } else {
+                wav_recorder_store(handle, item, len);
+            }
+            vRingbufferReturnItem(handle->ring, item);
+            if (pcm_size && handle->pcm_fill == pcm_size) {
+                wav_recorder_encode(handle, pcm_size / frame_size);
+                handle->pcm_fill = 0;
+            }
+        } else if (capture_done) {
+            break;
+        }
+    }
+    if (pcm_size && handle->pcm_fill >= frame_size) {
+        /* The last block is completed by silence, the fact chunk has the real length */
+        memset((uint8_t *)handle->pcm + handle->pcm_fill, 0, pcm_size - handle->pcm_fill);
+        wav_recorder_encode(handle, handle->pcm_fill / frame_size);
+    }
+    if (handle->fill > 0 && handle->write_ok) {
+        handle->write_ok = wav_recorder_write_block(handle, handle->fill);
+        handle->data_size += handle->fill;
+    }
+    const uint32_t data_size = handle->data_size - header_size;
+
+    /* Data size is known at the end only */
+    if (handle->write_ok) {
+        uint8_t hdr[WAV_RECORDER_ADPCM_HEADER_SIZE];
+        wav_recorder_fill_header(handle, hdr, data_size);
+        if (fseek(handle->f, 0, SEEK_SET) != 0 || fwrite(hdr, 1, header_size, handle->f) != header_size) {
+            ESP_LOGE(TAG, "WAV header update failed");
+            handle->result = ESP_FAIL;
+        }
+    }
+    if (fclose(handle->f) != 0) {
+        handle->result = ESP_FAIL;
+    }
+    handle->f = NULL;
+    handle->stats.bytes_written = data_size;
+
+    xEventGroupSetBits(handle->events, WAV_RECORDER_EV_WRITER_DONE);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t wav_recorder_task_create(TaskFunction_t task, const char *name, int priority, wav_recorder_handle_t handle)
+{
+    BaseType_t res;
+    if (handle->config.task_affinity < 0) {
+        res = xTaskCreate(task, name, handle->config.task_stack, handle, priority, NULL);
+    } else {
+        res = xTaskCreatePinnedToCore(task, name, handle->config.task_stack, handle, priority, NULL, handle->config.task_affinity);
+    }
+    return (res == pdPASS) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+static void wav_recorder_free(wav_recorder_handle_t handle)
+{
+    if (handle->ring) {
+        vRingbufferDelete(handle->ring);
+    }
+    if (handle->events) {
+        vEventGroupDelete(handle->events);
+    }
+    free(handle->ring_struct);
+    free(handle->ring_storage);
+    free(handle->read_buf);
+    free(handle->block);
+    free(handle->pcm);
+    free(handle->adpcm);
+    free(handle);
+}
+
+esp_err_t wav_recorder_create(const wav_recorder_config_t *config, wav_recorder_handle_t *ret_handle)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(config && ret_handle && config->codec, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->read_size > 0 && (config->read_size % 4) == 0, ESP_ERR_INVALID_ARG, TAG, "Read size must be multiple of 4");
+    ESP_RETURN_ON_FALSE(config->block_size > 0 && (config->block_size % WAV_RECORDER_SECTOR_SIZE) == 0, ESP_ERR_INVALID_ARG, TAG,
+                        "Block size must be multiple of %d", WAV_RECORDER_SECTOR_SIZE);
+    ESP_RETURN_ON_FALSE(config->ring_size >= 2 * MAX(config->read_size, config->block_size), ESP_ERR_INVALID_ARG, TAG,
+                        "Ring buffer must hold at least two blocks");
+    ESP_RETURN_ON_FALSE(config->encoding == WAV_RECORDER_ENCODING_PCM || config->encoding == WAV_RECORDER_ENCODING_IMA_ADPCM, ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid encoding");
+
+    wav_recorder_handle_t handle = calloc(1, sizeof(struct wav_recorder_s));
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_NO_MEM, TAG, "Not enough memory for recorder");
+    handle->codec = config->codec;
+    handle->config = *config;
+
+    /* Long recordings need big buffer, PSRAM is fast enough for audio rates */
+    const uint32_t ring_caps = config->flags.ring_spiram ? MALLOC_CAP_SPIRAM : MALLOC_CAP_INTERNAL;
+    handle->ring_storage = heap_caps_malloc(config->ring_size, ring_caps | MALLOC_CAP_8BIT);
+    handle->ring_struct = heap_caps_calloc(1, sizeof(StaticRingbuffer_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    ESP_GOTO_ON_FALSE(handle->ring_storage && handle->ring_struct, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for ring buffer");
+    handle->ring = xRingbufferCreateStatic(config->ring_size, RINGBUF_TYPE_BYTEBUF, handle->ring_storage, handle->ring_struct);
+    ESP_GOTO_ON_FALSE(handle->ring, ESP_ERR_NO_MEM, err, TAG, "Ring buffer create failed");
+    handle->events = xEventGroupCreate();
+    ESP_GOTO_ON_FALSE(handle->events, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for event group");
+    handle->read_buf = malloc(config->read_size);
+    /* Internal DMA capable block can be passed to SD card driver without copying */
+    handle->block = heap_caps_malloc(config->block_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    ESP_GOTO_ON_FALSE(handle->read_buf && handle->block, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for buffers");
+    if (config->encoding == WAV_RECORDER_ENCODING_IMA_ADPCM) {
+        /* Buffers are allocated for stereo */
+        handle->pcm = malloc(wav_adpcm_block_frames(2 * WAV_ADPCM_BLOCK_SIZE, 2) * 2 * sizeof(int16_t));
+        handle->adpcm = malloc(2 * WAV_ADPCM_BLOCK_SIZE);
+        ESP_GOTO_ON_FALSE(handle->pcm && handle->adpcm, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for IMA-ADPCM buffers");
+    }
+    xEventGroupSetBits(handle->events, WAV_RECORDER_EV_CAPTURE_DONE | WAV_RECORDER_EV_WRITER_DONE);
+
+    *ret_handle = handle;
+    return ESP_OK;
+
+err:
+    wav_recorder_free(handle);
+    return ret;
+}
+
+esp_err_t wav_recorder_delete(wav_recorder_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    wav_recorder_stop(handle);
+    wav_recorder_free(handle);
+    return ESP_OK;
+}
+
+esp_err_t wav_recorder_start(wav_recorder_handle_t handle, const char *path, const esp_codec_dev_sample_info_t *fs)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(handle && path && fs, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(fs->channel > 0 && fs->bits_per_sample > 0 && fs->sample_rate > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid format");
+    ESP_RETURN_ON_FALSE(!handle->recording, ESP_ERR_INVALID_STATE, TAG, "Recording is already running");
+    const bool adpcm = (handle->config.encoding == WAV_RECORDER_ENCODING_IMA_ADPCM);
+    ESP_RETURN_ON_FALSE(!adpcm || (fs->bits_per_sample == 16 && fs->channel <= 2), ESP_ERR_NOT_SUPPORTED, TAG,
+                        "IMA-ADPCM needs 16-bit mono or stereo");
+
+    handle->f = fopen(path, "wb");
+    ESP_RETURN_ON_FALSE(handle->f, ESP_ERR_NOT_FOUND, TAG, "File %s cannot be created", path);
+    /* The blocks are written directly, without copying to stdio buffer */
+    setvbuf(handle->f, NULL, _IONBF, 0);
+
+    handle->fs = *fs;
+    handle->adpcm_block = adpcm ? WAV_ADPCM_BLOCK_SIZE * fs->channel : 0;
+    ESP_GOTO_ON_FALSE(esp_codec_dev_open(handle->codec, &handle->fs) == ESP_CODEC_DEV_OK, ESP_FAIL, err, TAG, "Codec open failed");
+    ESP_LOGI(TAG, "Recording %s: %" PRIu32 " Hz, %d bit, %d channels%s", path, fs->sample_rate, fs->bits_per_sample, fs->channel,
+             adpcm ? " (IMA-ADPCM)" : "");
+
+    handle->stop = false;
+    handle->result = ESP_OK;
+    memset(&handle->stats, 0, sizeof(wav_recorder_stats_t));
+    xEventGroupClearBits(handle->events, WAV_RECORDER_EV_WRITER_DONE);
+    if (wav_recorder_task_create(wav_recorder_writer_task, "wav_rec_writer", handle->config.writer_priority, handle) != ESP_OK) {
+        xEventGroupSetBits(handle->events, WAV_RECORDER_EV_WRITER_DONE);
+        ESP_GOTO_ON_ERROR(ESP_ERR_NO_MEM, err_codec, TAG, "Create task failed");
+    }
+    /* Writer finishes the file without capture */
+    xEventGroupClearBits(handle->events, WAV_RECORDER_EV_CAPTURE_DONE);
+    if (wav_recorder_task_create(wav_recorder_capture_task, "wav_rec_capture", handle->config.capture_priority, handle) != ESP_OK) {
+        xEventGroupSetBits(handle->events, WAV_RECORDER_EV_CAPTURE_DONE);
+        xEventGroupWaitBits(handle->events, WAV_RECORDER_EV_WRITER_DONE, pdFALSE, pdTRUE, portMAX_DELAY);
+        esp_codec_dev_close(handle->codec);
+        ESP_LOGE(TAG, "Create task failed");
+        return ESP_ERR_NO_MEM;
+    }
+    handle->recording = true;
+    return ESP_OK;
+
+err_codec:
+    esp_codec_dev_close(handle->codec);
+err:
+    fclose(handle->f);
+    handle->f = NULL;
+    return ret;
+}
+
+esp_err_t wav_recorder_stop(wav_recorder_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    if (!handle->recording) {
+        return ESP_OK;
+    }
+    handle->stop = true;
+    xEventGroupWaitBits(handle->events, WAV_RECORDER_EV_CAPTURE_DONE | WAV_RECORDER_EV_WRITER_DONE, pdFALSE, pdTRUE, portMAX_DELAY);
+    esp_codec_dev_close(handle->codec);
+    handle->recording = false;
+
+    if (handle->stats.overrun_cnt > 0) {
+        ESP_LOGW(TAG, "%" PRIu32 " bytes were dropped, storage was too slow (longest write %" PRIu32 " us)",
+                 handle->stats.overrun_bytes, handle->stats.write_time_max);
+    }
+    return handle->result;
+}
+
+bool wav_recorder_is_recording(wav_recorder_handle_t handle)
+{
+    return handle && handle->recording && !handle->stop;
+}
+
+esp_err_t wav_recorder_get_stats(wav_recorder_handle_t handle, wav_recorder_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(handle && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    *stats = handle->stats;
+    return ESP_OK;
+}
@@ -5,13 +5,17 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <inttypes.h>
 #include <sdkconfig.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "bsp/esp-bsp.h"
+#include "wav_player.h"
+#include "wav_recorder.h"
 
 /* Buffer for reading/writing to I2S driver. Same length as SPIFFS buffer and I2S buffer, for optimal read/write performance.
    Recording audio data path:
@@ -23,6 +27,7 @@
 /* The recording will be RECORDING_LENGTH * BUFFER_SIZE long (in bytes)
    With sampling frequency 16000 Hz and 16bit mono resolution it equals to ~5.12 seconds */
 #define RECORDING_LENGTH (160)
+#define RECORDING_TIME_MS (RECORDING_LENGTH * BUFFER_SIZE * 1000 / (SAMPLE_RATE * 2))
 
 /* Globals */
 static const char *TAG = "example";
@@ -34,19 +39,6 @@ static void btn_handler(void *button_handle, void *usr_data)
     xQueueSend(audio_button_q, &button_pressed, 0);
 }
 
-// Very simple WAV header, ignores most fields
-typedef struct __attribute__((packed))
-{
-    uint8_t ignore_0[22];
-    uint16_t num_channels;
-    uint32_t sample_rate;
-    uint8_t ignore_1[6];
-    uint16_t bits_per_sample;
-    uint8_t ignore_2[4];
-    uint32_t data_size;
-    uint8_t data[];
-} dumb_wav_header_t;
-
 static void audio_task(void *arg)
 {
     esp_codec_dev_handle_t spk_codec_dev = bsp_audio_codec_speaker_init();
@@ -54,6 +46,23 @@ static void audio_task(void *arg)
     esp_codec_dev_set_out_vol(spk_codec_dev, DEFAULT_VOLUME);
     esp_codec_dev_handle_t mic_codec_dev = bsp_audio_codec_microphone_init();
 
+    /* WAV player reads the file ahead in its own task, buttons are handled while playing */
+    wav_player_handle_t player = NULL;
+    wav_player_config_t player_cfg = WAV_PLAYER_CONFIG_DEFAULT(spk_codec_dev);
+    player_cfg.chunk_size = BUFFER_SIZE;
+    ESP_ERROR_CHECK(wav_player_create(&player_cfg, &player));
+
+    /* WAV recorder captures into ring buffer, slow SPIFFS writes do not drop microphone data */
+    wav_recorder_handle_t recorder = NULL;
+    if (mic_codec_dev) {
+        wav_recorder_config_t rec_cfg = WAV_RECORDER_CONFIG_DEFAULT(mic_codec_dev);
+        rec_cfg.read_size = BUFFER_SIZE;
+#ifdef CONFIG_SPIRAM
+        rec_cfg.flags.ring_spiram = 1;
+#endif
+        ESP_ERROR_CHECK(wav_recorder_create(&rec_cfg, &recorder));
+    }
+
     /* Pointer to a file that is going to be played */
     const char music_filename[] = BSP_SPIFFS_MOUNT_POINT"/16bit_mono_22_05khz.wav";
     const char recording_filename[] = BSP_SPIFFS_MOUNT_POINT"/recording.wav";
@@ -68,47 +77,27 @@ static void audio_task(void *arg)
                     ESP_LOGW(TAG, "This board does not support microphone recording!");
                     break;
                 }
-                int16_t *recording_buffer = heap_caps_malloc(BUFFER_SIZE, MALLOC_CAP_DEFAULT);
-                assert(recording_buffer != NULL);
-
-                /* Open file for recording */
-                FILE *record_file = fopen(recording_filename, "wb");
-                assert(record_file != NULL);
-
-                /* Write WAV file header */
-                const dumb_wav_header_t recording_header = {
-                    .bits_per_sample = 16,
-                    .data_size = RECORDING_LENGTH * BUFFER_SIZE,
-                    .num_channels = 1,
-                    .sample_rate = SAMPLE_RATE
-                };
-                if (fwrite((void *)&recording_header, 1, sizeof(dumb_wav_header_t), record_file) != sizeof(dumb_wav_header_t)) {
-                    ESP_LOGW(TAG, "Error in writing to file");
-                    continue;
-                }
-                setvbuf(record_file, NULL, _IOFBF, BUFFER_SIZE);
-
-                esp_codec_dev_sample_info_t fs = {
+                const esp_codec_dev_sample_info_t fs = {
                     .sample_rate = SAMPLE_RATE,
                     .channel = 1,
                     .bits_per_sample = 16,
                 };
                 esp_codec_dev_set_in_gain(mic_codec_dev, 42.0);
-                esp_codec_dev_open(mic_codec_dev, &fs);
+                if (wav_recorder_start(recorder, recording_filename, &fs) != ESP_OK) {
+                    ESP_LOGW(TAG, "Error in writing to file");
+                    break;
+                }
 
                 ESP_LOGI(TAG, "Recording start");
-                size_t bytes_written_to_spiffs = 0;
-                while (bytes_written_to_spiffs < RECORDING_LENGTH * BUFFER_SIZE) {
-                    /* Read data from codec and write it to SPIFFS */
-                    ESP_ERROR_CHECK(esp_codec_dev_read(mic_codec_dev, recording_buffer, BUFFER_SIZE));
-                    size_t data_written = fwrite(recording_buffer, 1, BUFFER_SIZE, record_file);
-                    bytes_written_to_spiffs += data_written;
+                vTaskDelay(pdMS_TO_TICKS(RECORDING_TIME_MS));
+                if (wav_recorder_stop(recorder) != ESP_OK) {
+                    ESP_LOGW(TAG, "Error in writing to file");
                 }
 
-                ESP_LOGI(TAG, "Recording stop, length: %i bytes", bytes_written_to_spiffs);
-                fclose(record_file);
-                free(recording_buffer);
-                esp_codec_dev_close(mic_codec_dev);
+                wav_recorder_stats_t stats;
+                wav_recorder_get_stats(recorder, &stats);
+                ESP_LOGI(TAG, "Recording stop, length: %" PRIu32 " bytes, overruns: %" PRIu32 ", longest write: %" PRIu32 " us",
+                         stats.bytes_written, stats.overrun_cnt, stats.write_time_max);
                 break;
             }
             case BSP_BUTTON_SET: {
@@ -121,45 +110,17 @@ static void audio_task(void *arg)
                 break;
             }
             case BSP_BUTTON_PLAY: {
-                int16_t *wav_bytes = malloc(BUFFER_SIZE);
-                assert(wav_bytes != NULL);
-
-                /* Open WAV file */
-                ESP_LOGI(TAG, "Playing file %s", play_filename);
-                FILE *play_file = fopen(play_filename, "rb");
-                if (play_file == NULL) {
-                    ESP_LOGW(TAG, "%s file does not exist!", play_filename);
+                if (wav_player_is_playing(player)) {
+                    wav_player_stats_t stats;
+                    wav_player_get_stats(player, &stats);
+                    wav_player_stop(player);
+                    ESP_LOGI(TAG, "Playing stopped, underruns: %" PRIu32 ", longest read: %" PRIu32 " us", stats.underrun_cnt, stats.read_time_max);
                     break;
                 }
 
-                /* Read WAV header file */
-                dumb_wav_header_t wav_header;
-                if (fread((void *)&wav_header, 1, sizeof(wav_header), play_file) != sizeof(wav_header)) {
-                    ESP_LOGW(TAG, "Error in reading file");
-                    break;
-                }
-                ESP_LOGI(TAG, "Number of channels: %" PRIu16 "", wav_header.num_channels);
-                ESP_LOGI(TAG, "Bits per sample: %" PRIu16 "", wav_header.bits_per_sample);
-                ESP_LOGI(TAG, "Sample rate: %" PRIu32 "", wav_header.sample_rate);
-                ESP_LOGI(TAG, "Data size: %" PRIu32 "", wav_header.data_size);
-
-                esp_codec_dev_sample_info_t fs = {
-                    .sample_rate = wav_header.sample_rate,
-                    .channel = wav_header.num_channels,
-                    .bits_per_sample = wav_header.bits_per_sample,
-                };
-                esp_codec_dev_open(spk_codec_dev, &fs);
-
-                uint32_t bytes_send_to_i2s = 0;
-                while (bytes_send_to_i2s < wav_header.data_size) {
-                    /* Get data from SPIFFS and send it to codec */
-                    size_t bytes_read_from_spiffs = fread(wav_bytes, 1, BUFFER_SIZE, play_file);
-                    esp_codec_dev_write(spk_codec_dev, wav_bytes, bytes_read_from_spiffs);
-                    bytes_send_to_i2s += bytes_read_from_spiffs;
-                }
-                fclose(play_file);
-                free(wav_bytes);
-                esp_codec_dev_close(spk_codec_dev);
+                /* Playing selected WAV file, next press of PLAY stops it */
+                ESP_LOGI(TAG, "Playing file %s", play_filename);
+                ESP_ERROR_CHECK(wav_player_play(player, play_filename, false));
                 break;
             }
             case BSP_BUTTON_VOLDOWN: {
@@ -186,9 +147,72 @@ static void audio_task(void *arg)
     }
 }
 
+#if CONFIG_EXAMPLE_FS_BENCHMARK
+static int latency_cmp(const void *a, const void *b)
+{
+    const uint32_t x = *(const uint32_t *)a;
+    const uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void latency_print(const char *name, uint32_t *latency_us, size_t cnt)
+{
+    qsort(latency_us, cnt, sizeof(uint32_t), latency_cmp);
+    ESP_LOGI(TAG, "%s latency [us]: min %"PRIu32", median %"PRIu32", p99 %"PRIu32", max %"PRIu32" (%u samples)", name,
+             latency_us[0], latency_us[cnt / 2], latency_us[cnt * 99 / 100], latency_us[cnt - 1], (unsigned)cnt);
+}
+
+/* Latency of opening and reading the preloaded file in chunks of the WAV player */
+static void fs_benchmark(void)
+{
+    const char filename[] = BSP_SPIFFS_MOUNT_POINT"/16bit_mono_22_05khz.wav";
+    const int rounds = CONFIG_EXAMPLE_FS_BENCHMARK_ROUNDS;
+    const size_t max_reads = 4096;
+    uint32_t *open_us = calloc(rounds, sizeof(uint32_t));
+    uint32_t *read_us = calloc(max_reads, sizeof(uint32_t));
+    uint8_t *buf = malloc(BUFFER_SIZE);
+    size_t reads = 0;
+    assert(open_us && read_us && buf);
+
+    for (int i = 0; i < rounds; i++) {
+        int64_t start = esp_timer_get_time();
+        FILE *f = fopen(filename, "rb");
+        open_us[i] = esp_timer_get_time() - start;
+        if (f == NULL) {
+            ESP_LOGE(TAG, "Failed to open %s", filename);
+            goto end;
+        }
+        size_t len;
+        do {
+            start = esp_timer_get_time();
+            len = fread(buf, 1, BUFFER_SIZE, f);
+            if (reads < max_reads) {
+                read_us[reads++] = esp_timer_get_time() - start;
+            }
+        } while (len == BUFFER_SIZE);
+        fclose(f);
+    }
+    latency_print("Open", open_us, rounds);
+    latency_print("Read", read_us, reads);
+
+end:
+    free(buf);
+    free(read_us);
+    free(open_us);
+}
+#endif
+
 void app_main(void)
 {
+    /* SPIFFS or LittleFS, as selected in BSP menuconfig */
+#ifdef BSP_FLASH_FS_MOUNT_POINT
+    ESP_ERROR_CHECK(bsp_flash_fs_mount());
+#else
     ESP_ERROR_CHECK(bsp_spiffs_mount());
+#endif
+#if CONFIG_EXAMPLE_FS_BENCHMARK
+    fs_benchmark();
+#endif
 
     /* Create FreeRTOS tasks and queues */
     audio_button_q = xQueueCreate(10, sizeof(int));
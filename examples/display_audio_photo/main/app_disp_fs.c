@@ -12,16 +12,23 @@
 #include <fcntl.h>
 #include <dirent.h>
 #include <inttypes.h>
+#include <sys/param.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "esp_log.h"
 #include "esp_err.h"
+#include "esp_check.h"
 #include "esp_spiffs.h"
 #include "bsp/esp-bsp.h"
 #include "lvgl.h"
+#include "esp_lvgl_port.h"
 #include "app_disp_fs.h"
-#include "jpeg_decoder.h"
+#include "rom/tjpgd.h"
+#include "wav_player.h"
+#include "wav_recorder.h"
+#include "audio_spectrum.h"
+#include "file_browser.h"
 
 /* SPIFFS mount root */
 #define FS_MNT_PATH  BSP_SPIFFS_MOUNT_POINT
@@ -33,12 +40,27 @@
 #define BUFFER_SIZE     (1024)
 #define SAMPLE_RATE     (22050)
 #define DEFAULT_VOLUME  (70)
+/* Codec output level is fixed, the volume slider attenuates the playback in software */
+#define CODEC_VOLUME    (90)
 /* The recording will be RECORDING_LENGTH * BUFFER_SIZE long (in bytes)
    With sampling frequency 22050 Hz and 16bit mono resolution it equals to ~3.715 seconds */
 #define RECORDING_LENGTH (160)
+#define RECORDING_TIME_MS (RECORDING_LENGTH * BUFFER_SIZE * 1000 / (SAMPLE_RATE * 2))
 
 #define REC_FILENAME    FS_MNT_PATH"/recording.wav"
 
+/* Bars of the spectrum of the played file, they are redrawn at most once per SPECTRUM_PERIOD_MS */
+#define SPECTRUM_BANDS      (16)
+#define SPECTRUM_PERIOD_MS  (33)
+
+/* Work buffer of TJpgDec, the JPEG file is read in small chunks and decoded by MCU blocks */
+#define JPEG_WORK_BUF_SIZE  (3100)
+
+/* Glyph cache of the UI font, glyphs of file names and text files are copied instead of rendering */
+#define FONT_CACHE_SIZE     (48 * 1024)
+#define FONT_CACHE_SYMBOLS  LV_SYMBOL_LIST LV_SYMBOL_AUDIO LV_SYMBOL_SETTINGS LV_SYMBOL_CLOSE LV_SYMBOL_PLAY LV_SYMBOL_STOP \
+                            LV_SYMBOL_LOOP LV_SYMBOL_LEFT LV_SYMBOL_FILE LV_SYMBOL_IMAGE LV_SYMBOL_DIRECTORY
+
 static const char *TAG = "DISP";
 
 static esp_codec_dev_handle_t spk_codec_dev = NULL;
@@ -54,29 +76,26 @@ typedef enum {
     APP_FILE_TYPE_WAV,
 } app_file_type_t;
 
-// Very simple WAV header, ignores most fields
-typedef struct __attribute__((packed))
-{
-    uint8_t ignore_0[22];
-    uint16_t num_channels;
-    uint32_t sample_rate;
-    uint8_t ignore_1[6];
-    uint16_t bits_per_sample;
-    uint8_t ignore_2[4];
-    uint32_t data_size;
-    uint8_t data[];
-} dumb_wav_header_t;
+/* Streamed JPEG decoding, only the scaled output is held in memory */
+typedef struct {
+    FILE *f;
+    uint16_t *outbuf;
+    uint32_t out_w;
+    uint32_t out_h;
+} jpeg_stream_t;
 
 /*******************************************************************************
 * Function definitions
 *******************************************************************************/
+static const lv_font_t *app_disp_font(void);
 static void app_disp_lvgl_show_settings(lv_obj_t *screen, lv_group_t *group);
 static void app_disp_lvgl_show_record(lv_obj_t *screen, lv_group_t *group);
 static void app_disp_lvgl_show_filesystem(lv_obj_t *screen, lv_group_t *group);
-static void app_disp_lvgl_show_files(const char *path);
 static void scroll_begin_event(lv_event_t *e);
 static void tab_changed_event(lv_event_t *e);
 static void set_tab_group(void);
+static void play_file_done(esp_err_t result, void *user_ctx);
+static void play_file_tap(const int16_t *pcm, size_t frames, uint8_t channels, uint32_t sample_rate, void *user_ctx);
 
 /*******************************************************************************
 * Local variables
@@ -89,17 +108,20 @@ static lv_group_t *recording_group = NULL;
 static lv_group_t *settings_group = NULL;
 
 /* FS */
-static lv_obj_t *fs_list = NULL;
+static file_browser_handle_t fs_browser = NULL;
 static lv_obj_t *fs_img = NULL;
-static char fs_current_path[250];
 
 static uint8_t *file_buffer = NULL;
 static size_t file_buffer_size = 0;
 
 /* Audio */
-static SemaphoreHandle_t audio_mux;
+static wav_player_handle_t wav_player = NULL;
+static audio_spectrum_handle_t spectrum = NULL;
+static lv_obj_t *spectrum_chart = NULL;
+static lv_chart_series_t *spectrum_series = NULL;
+static lv_timer_t *spectrum_timer = NULL;
+static wav_recorder_handle_t wav_recorder = NULL;
 static bool play_file_repeat = false;
-static bool play_file_stop = false;
 static char usb_drive_play_file[250];
 static lv_obj_t *play_btn = NULL, *play1_btn = NULL, *rec_btn = NULL, *rec_stop_btn = NULL;
 
@@ -116,7 +138,7 @@ void app_disp_lvgl_show(void)
     lv_tabview_set_tab_bar_size(tabview, 40);
     lv_obj_set_size(tabview, BSP_LCD_H_RES, BSP_LCD_V_RES);
     lv_obj_align(tabview, LV_ALIGN_BOTTOM_MID, 0, 0);
-    lv_obj_set_style_text_font(tabview, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_font(tabview, app_disp_font(), 0);
     /* Change animation time of moving between tabs */
     //lv_obj_add_event_cb(lv_tabview_get_content(tabview), scroll_begin_event, LV_EVENT_SCROLL_BEGIN, NULL);
     lv_obj_add_event_cb(tabview, tab_changed_event, LV_EVENT_VALUE_CHANGED, NULL);
@@ -161,7 +183,23 @@ void app_audio_init(void)
     spk_codec_dev = bsp_audio_codec_speaker_init();
     assert(spk_codec_dev);
     /* Speaker output volume */
-    esp_codec_dev_set_out_vol(spk_codec_dev, DEFAULT_VOLUME);
+    esp_codec_dev_set_out_vol(spk_codec_dev, CODEC_VOLUME);
+
+    /* Spectrum of the played audio, the FFT runs in its own task and the UI only reads the latest levels */
+    audio_spectrum_config_t spectrum_cfg = AUDIO_SPECTRUM_CONFIG_DEFAULT();
+    spectrum_cfg.bands = SPECTRUM_BANDS;
+    ESP_ERROR_CHECK(audio_spectrum_create(&spectrum_cfg, &spectrum));
+
+    /* WAV player, the file is prefetched by reader task and the codec is fed continuously */
+    wav_player_config_t player_cfg = WAV_PLAYER_CONFIG_DEFAULT(spk_codec_dev);
+    player_cfg.chunk_size = BUFFER_SIZE;
+    player_cfg.mclk_multiple = I2S_MCLK_MULTIPLE_384;
+    /* Files are resampled to the rate of recording, the codec is not reconfigured for each file */
+    player_cfg.output_rate = SAMPLE_RATE;
+    player_cfg.volume = DEFAULT_VOLUME;
+    player_cfg.done_cb = play_file_done;
+    player_cfg.tap_cb = play_file_tap;
+    ESP_ERROR_CHECK(wav_player_create(&player_cfg, &wav_player));
 
     /* Initialize microphone */
 #if BSP_CAPS_AUDIO_MIC
@@ -169,6 +207,14 @@ void app_audio_init(void)
     assert(mic_codec_dev);
     /* Microphone input gain */
     esp_codec_dev_set_in_gain(mic_codec_dev, 50.0);
+
+    /* WAV recorder, the codec is read by capture task and the file is written in large blocks by writer task */
+    wav_recorder_config_t rec_cfg = WAV_RECORDER_CONFIG_DEFAULT(mic_codec_dev);
+    rec_cfg.read_size = BUFFER_SIZE;
+#ifdef CONFIG_SPIRAM
+    rec_cfg.flags.ring_spiram = 1;
+#endif
+    ESP_ERROR_CHECK(wav_recorder_create(&rec_cfg, &wav_recorder));
 #endif
 }
 
@@ -177,51 +223,90 @@ void app_disp_fs_init(void)
     file_buffer_size = BSP_LCD_H_RES * BSP_LCD_V_RES * sizeof(lv_color_t);
     file_buffer = heap_caps_calloc(file_buffer_size, 1, MALLOC_CAP_DEFAULT);
     assert(file_buffer);
-
-    /* Initialize root path */
-    strcpy(fs_current_path, FS_MNT_PATH);
-
-    /* Show list of files */
-    app_disp_lvgl_show_files(FS_MNT_PATH);
 }
 
 /*******************************************************************************
 * Private API function
 *******************************************************************************/
 
-static void app_lvgl_add_text(const char *text)
+static void close_window_handler(lv_event_t *e)
 {
-    lv_list_add_text(fs_list, text);
+    lv_event_code_t code = lv_event_get_code(e);
+
+    if (code == LV_EVENT_CLICKED) {
+        memset(file_buffer, 0, file_buffer_size);
+        lv_obj_del(lv_event_get_user_data(e));
+
+        /* Re-set the TAB group */
+        set_tab_group();
+    }
 }
 
-static void folder_handler(lv_event_t *e)
+static uint32_t jpeg_stream_input(JDEC *dec, uint8_t *buf, uint32_t len)
 {
-    lv_event_code_t code = lv_event_get_code(e);
-    lv_obj_t *obj = lv_event_get_target(e);
+    jpeg_stream_t *stream = dec->device;
 
-    if (code == LV_EVENT_CLICKED) {
-        const char *foldername = lv_list_get_btn_text(fs_list, obj);
-        if (foldername != NULL) {
-            strcat(fs_current_path, "/");
-            strcat(fs_current_path, foldername);
-            ESP_LOGI(TAG, "Clicked: \"%s\"", fs_current_path);
-            app_disp_lvgl_show_files(fs_current_path);
-        }
+    /* NULL buffer means skip the data */
+    if (buf == NULL) {
+        return (fseek(stream->f, len, SEEK_CUR) == 0) ? len : 0;
+    }
+    return fread(buf, 1, len, stream->f);
+}
+
+static uint32_t jpeg_stream_output(JDEC *dec, void *bitmap, JRECT *rect)
+{
+    jpeg_stream_t *stream = dec->device;
+    const uint8_t *rgb = bitmap;
 
+    /* RGB888 block is converted into RGB565, pixels out of the display are cropped */
+    for (uint32_t y = rect->top; y <= rect->bottom; y++) {
+        for (uint32_t x = rect->left; x <= rect->right; x++, rgb += 3) {
+            if (x >= stream->out_w || y >= stream->out_h) {
+                continue;
+            }
+            uint16_t color = ((rgb[0] & 0xF8) << 8) | ((rgb[1] & 0xFC) << 3) | (rgb[2] >> 3);
+#if CONFIG_LV_COLOR_16_SWAP
+            color = (color >> 8) | (color << 8);
+#endif
+            stream->outbuf[y * stream->out_w + x] = color;
+        }
     }
+    return 1;
 }
 
-static void close_window_handler(lv_event_t *e)
+static esp_err_t jpeg_stream_decode(const char *path, uint32_t *out_w, uint32_t *out_h)
 {
-    lv_event_code_t code = lv_event_get_code(e);
+    esp_err_t ret = ESP_OK;
+    JDEC dec;
+    jpeg_stream_t stream = {
+        .outbuf = (uint16_t *)file_buffer,
+    };
 
-    if (code == LV_EVENT_CLICKED) {
-        memset(file_buffer, 0, file_buffer_size);
-        lv_obj_del(lv_event_get_user_data(e));
+    void *work = malloc(JPEG_WORK_BUF_SIZE);
+    ESP_GOTO_ON_FALSE(work, ESP_ERR_NO_MEM, end, TAG, "Not enough memory for JPEG decoder!");
+    stream.f = fopen(path, "rb");
+    ESP_GOTO_ON_FALSE(stream.f, ESP_ERR_NOT_FOUND, end, TAG, "File %s not found!", path);
+    ESP_GOTO_ON_FALSE(jd_prepare(&dec, jpeg_stream_input, work, JPEG_WORK_BUF_SIZE, &stream) == JDR_OK, ESP_ERR_NOT_SUPPORTED, end, TAG, "Unsupported JPEG image!");
 
-        /* Re-set the TAB group */
-        set_tab_group();
+    /* Scale down by 1/2, 1/4 or 1/8 during decoding to fit the display, the rest is cropped */
+    uint8_t scale = 0;
+    while (scale < 3 && ((dec.width >> scale) > BSP_LCD_H_RES || (dec.height >> scale) > BSP_LCD_V_RES)) {
+        scale++;
+    }
+    stream.out_w = MIN(dec.width >> scale, BSP_LCD_H_RES);
+    stream.out_h = MIN(dec.height >> scale, BSP_LCD_V_RES);
+    ESP_GOTO_ON_FALSE(jd_decomp(&dec, jpeg_stream_output, scale) == JDR_OK, ESP_FAIL, end, TAG, "JPEG decoding failed!");
+    ESP_LOGI(TAG, "JPEG %ux%u decoded in scale 1/%d", (unsigned int)dec.width, (unsigned int)dec.height, 1 << scale);
+
+    *out_w = stream.out_w;
+    *out_h = stream.out_h;
+
+end:
+    if (stream.f) {
+        fclose(stream.f);
     }
+    free(work);
+    return ret;
 }
 
 static void show_window(const char *path, app_file_type_t type)
@@ -249,7 +334,18 @@ static void show_window(const char *path, app_file_type_t type)
     }
 
     /* Show image or text file */
-    if (type == APP_FILE_TYPE_TXT || type == APP_FILE_TYPE_IMG) {
+    if (type == APP_FILE_TYPE_IMG && fs_img) {
+        /* Image is decoded straight from the file, the whole file and full resolution bitmap are never in RAM */
+        uint32_t img_w = 0, img_h = 0;
+        ESP_LOGI(TAG, "Decoding JPEG image...");
+        if (jpeg_stream_decode(path, &img_w, &img_h) == ESP_OK) {
+            lv_canvas_set_buffer(fs_img, file_buffer, img_w, img_h, LV_COLOR_FORMAT_RGB565);
+            lv_obj_center(fs_img);
+            lv_obj_invalidate(fs_img);
+        } else {
+            lv_label_set_text(label, "Image decoding failed!");
+        }
+    } else if (type == APP_FILE_TYPE_TXT) {
         /* Get file size */
         int f = stat(path, &st);
         if (f == 0) {
@@ -265,32 +361,8 @@ static void show_window(const char *path, app_file_type_t type)
             if (f > 0) {
                 /* Read file */
                 read(f, file_buf, filesize);
-                if (type == APP_FILE_TYPE_TXT && label) {
-                    file_buf[filesize] = 0;
-                    lv_label_set_text(label, file_buf);
-                } else if (fs_img) {
-                    ESP_LOGI(TAG, "Decoding JPEG image...");
-                    /* JPEG decode */
-                    esp_jpeg_image_cfg_t jpeg_cfg = {
-                        .indata = (uint8_t *)file_buf,
-                        .indata_size = filesize,
-                        .outbuf = file_buffer,
-                        .outbuf_size = file_buffer_size,
-                        .out_format = JPEG_IMAGE_FORMAT_RGB565,
-                        .out_scale = JPEG_IMAGE_SCALE_0,
-                        .flags = {
-#if CONFIG_LV_COLOR_16_SWAP
-                            .swap_color_bytes = 1,
-#endif
-                        }
-                    };
-                    esp_jpeg_image_output_t outimg;
-                    esp_jpeg_decode(&jpeg_cfg, &outimg);
-
-                    lv_canvas_set_buffer(fs_img, file_buffer, outimg.width, outimg.height, LV_COLOR_FORMAT_RGB565);
-                    lv_obj_center(fs_img);
-                    lv_obj_invalidate(fs_img);
-                }
+                file_buf[filesize] = 0;
+                lv_label_set_text(label, file_buf);
 
                 close(f);
             } else {
@@ -315,76 +387,12 @@ static void show_window(const char *path, app_file_type_t type)
 
 }
 
-static void play_file(void *arg)
+/* Called from the WAV player task after the playback */
+static void play_file_done(esp_err_t result, void *user_ctx)
 {
-    char *path = arg;
-    FILE *file = NULL;
-    int16_t *wav_bytes = heap_caps_malloc(BUFFER_SIZE, MALLOC_CAP_DEFAULT);
-    if (wav_bytes == NULL) {
-        ESP_LOGE(TAG, "Not enough memory for playing!");
-        goto END;
-    }
-
-    /* Open file */
-    file = fopen(path, "rb");
-    if (file == NULL) {
-        ESP_LOGE(TAG, "%s file does not exist!", path);
-        goto END;
-    }
-
-    /* Read WAV header file */
-    dumb_wav_header_t wav_header;
-    if (fread((void *)&wav_header, 1, sizeof(wav_header), file) != sizeof(wav_header)) {
-        ESP_LOGW(TAG, "Error in reading file");
-        goto END;
-    }
-    ESP_LOGI(TAG, "Number of channels: %" PRIu16 "", wav_header.num_channels);
-    ESP_LOGI(TAG, "Bits per sample: %" PRIu16 "", wav_header.bits_per_sample);
-    ESP_LOGI(TAG, "Sample rate: %" PRIu32 "", wav_header.sample_rate);
-    ESP_LOGI(TAG, "Data size: %" PRIu32 "", wav_header.data_size);
-
-
-    esp_codec_dev_sample_info_t fs = {
-        .sample_rate = wav_header.sample_rate,
-        .channel = wav_header.num_channels,
-        .bits_per_sample = wav_header.bits_per_sample,
-        .mclk_multiple = I2S_MCLK_MULTIPLE_384,
-    };
-    esp_codec_dev_open(spk_codec_dev, &fs);
-
-    uint32_t bytes_send_to_i2s = 0;
-    do {
-        bytes_send_to_i2s = 0;
-        fseek(file, sizeof(wav_header), SEEK_SET);
-        while (bytes_send_to_i2s < wav_header.data_size) {
-            if (play_file_stop) {
-                goto END;
-            }
-            xSemaphoreTake(audio_mux, portMAX_DELAY);
-
-            /* Get data from SPIFFS */
-            size_t bytes_read_from_spiffs = fread(wav_bytes, 1, BUFFER_SIZE, file);
-
-            /* Send it to I2S */
-            esp_codec_dev_write(spk_codec_dev, wav_bytes, bytes_read_from_spiffs);
-            bytes_send_to_i2s += bytes_read_from_spiffs;
-            xSemaphoreGive(audio_mux);
-        }
-        vTaskDelay(pdMS_TO_TICKS(100));
-    } while (play_file_repeat);
-
-
-
-END:
-    esp_codec_dev_close(spk_codec_dev);
-
-    if (file) {
-        fclose(file);
-    }
-
-    if (wav_bytes) {
-        free(wav_bytes);
-    }
+    wav_player_stats_t stats;
+    wav_player_get_stats(wav_player, &stats);
+    ESP_LOGI(TAG, "Playing finished (%s), underruns: %" PRIu32 ", longest read: %" PRIu32 " us", esp_err_to_name(result), stats.underrun_cnt, stats.read_time_max);
 
     if (play_btn) {
         bsp_display_lock(0);
@@ -397,8 +405,29 @@ END:
         lv_obj_clear_state(play1_btn, LV_STATE_DISABLED);
         bsp_display_unlock();
     }
+}
 
-    vTaskDelete(NULL);
+/* Called from the WAV player task with the played audio, the samples are only copied into the ring buffer */
+static void play_file_tap(const int16_t *pcm, size_t frames, uint8_t channels, uint32_t sample_rate, void *user_ctx)
+{
+    audio_spectrum_feed(spectrum, pcm, frames, channels, sample_rate);
+}
+
+/* Called from the LVGL task once per frame period, the chart is redrawn only when a new spectrum is ready */
+static void spectrum_timer_cb(lv_timer_t *timer)
+{
+    static uint32_t last_seq = 0;
+    float levels[SPECTRUM_BANDS];
+    const uint32_t seq = audio_spectrum_get(spectrum, levels, SPECTRUM_BANDS);
+    if (seq == last_seq || spectrum_chart == NULL) {
+        return;
+    }
+    last_seq = seq;
+
+    for (int i = 0; i < SPECTRUM_BANDS; i++) {
+        lv_chart_set_value_by_id(spectrum_chart, spectrum_series, i, (int32_t)(levels[i] * 100));
+    }
+    lv_chart_refresh(spectrum_chart);
 }
 
 /* Play selected audio file */
@@ -408,9 +437,8 @@ static void play_event_cb(lv_event_t *e)
     lv_obj_t *obj = lv_event_get_target(e);
 
     if (code == LV_EVENT_CLICKED) {
-        play_file_stop = false;
         lv_obj_add_state(obj, LV_STATE_DISABLED);
-        xTaskCreate(play_file, "audio_task", 4096, lv_event_get_user_data(e), 6, NULL);
+        wav_player_play(wav_player, lv_event_get_user_data(e), play_file_repeat);
     }
 }
 
@@ -420,7 +448,7 @@ static void stop_event_cb(lv_event_t *e)
     lv_event_code_t code = lv_event_get_code(e);
 
     if (code == LV_EVENT_CLICKED) {
-        play_file_stop = true;
+        wav_player_stop(wav_player);
     }
 }
 
@@ -432,6 +460,7 @@ static void repeat_event_cb(lv_event_t *e)
 
     if (code == LV_EVENT_VALUE_CHANGED) {
         play_file_repeat = ( (lv_obj_get_state(obj) & LV_STATE_CHECKED) ? true : false);
+        wav_player_set_repeat(wav_player, play_file_repeat);
     }
 }
 
@@ -441,10 +470,9 @@ static void volume_event_cb(lv_event_t *e)
 
     assert(slider != NULL);
 
+    /* Gain is ramped by the player task, dragging the slider does not write codec registers */
     int32_t volume = lv_slider_get_value(slider);
-    if (spk_codec_dev) {
-        esp_codec_dev_set_out_vol(spk_codec_dev, volume);
-    }
+    wav_player_set_volume(wav_player, volume);
 }
 
 static void close_window_wav_handler(lv_event_t *e)
@@ -453,11 +481,12 @@ static void close_window_wav_handler(lv_event_t *e)
 
     if (code == LV_EVENT_CLICKED) {
         memset(file_buffer, 0, file_buffer_size);
+        lv_timer_delete(spectrum_timer);
+        spectrum_timer = NULL;
+        spectrum_chart = NULL;
         lv_obj_del(lv_event_get_user_data(e));
-        play_file_stop = true;
-
-        xSemaphoreTake(audio_mux, portMAX_DELAY);
-        vSemaphoreDelete(audio_mux);
+        play_btn = NULL;
+        wav_player_stop(wav_player);
 
         /* Re-set the TAB group */
         set_tab_group();
@@ -475,9 +504,6 @@ static void show_window_wav(const char *path)
 
     play_file_repeat = false;
 
-    audio_mux = xSemaphoreCreateMutex();
-    assert(audio_mux);
-
     /* Close button */
     btn = lv_win_add_button(win, LV_SYMBOL_CLOSE, 60);
     lv_obj_add_event_cb(btn, close_window_wav_handler, LV_EVENT_CLICKED, win);
@@ -529,11 +555,21 @@ static void show_window_wav(const char *path)
     /* Slider */
     lv_obj_t *slider = lv_slider_create(cont_row);
     lv_obj_set_width(slider, BSP_LCD_H_RES - 180);
-    lv_slider_set_range(slider, 0, 90);
+    lv_slider_set_range(slider, 0, 100);
     lv_slider_set_value(slider, DEFAULT_VOLUME, false);
     lv_obj_center(slider);
     lv_obj_add_event_cb(slider, volume_event_cb, LV_EVENT_VALUE_CHANGED, NULL);
 
+    /* Spectrum bars */
+    spectrum_chart = lv_chart_create(cont);
+    lv_obj_set_size(spectrum_chart, BSP_LCD_H_RES - 20, 60);
+    lv_chart_set_type(spectrum_chart, LV_CHART_TYPE_BAR);
+    lv_chart_set_point_count(spectrum_chart, SPECTRUM_BANDS);
+    lv_chart_set_div_line_count(spectrum_chart, 0, 0);
+    spectrum_series = lv_chart_add_series(spectrum_chart, lv_palette_main(LV_PALETTE_BLUE), LV_CHART_AXIS_PRIMARY_Y);
+    lv_chart_set_all_value(spectrum_chart, spectrum_series, 0);
+    spectrum_timer = lv_timer_create(spectrum_timer_cb, SPECTRUM_PERIOD_MS, NULL);
+
     /* Input device group */
     lv_indev_t *indev = bsp_display_get_input_dev();
     if (indev && lv_indev_get_type(indev) == LV_INDEV_TYPE_ENCODER) {
@@ -571,144 +607,34 @@ static app_file_type_t get_file_type(const char *filepath)
     return APP_FILE_TYPE_UNKNOWN;
 }
 
-/* Clicked to file button */
-static void file_handler(lv_event_t *e)
+/* Clicked to file in the browser */
+static void file_select_cb(file_browser_handle_t browser, const char *path, void *user_ctx)
 {
-    lv_event_code_t code = lv_event_get_code(e);
-    lv_obj_t *obj = lv_event_get_target(e);
-
-    if (code == LV_EVENT_CLICKED) {
-        char filepath[250];
-        const char *filename = lv_list_get_btn_text(fs_list, obj);
-
-        strcpy(filepath, fs_current_path);
-        strcat(filepath, "/");
-        strcat(filepath, filename);
-
-        /* Open window by file type (Image, text or music) */
-        ESP_LOGI(TAG, "Clicked: %s", lv_list_get_btn_text(fs_list, obj));
-        app_file_type_t filetype = get_file_type(filepath);
-        if (filetype == APP_FILE_TYPE_WAV) {
-            show_window_wav(filepath);
-        } else {
-            show_window(filepath, filetype);
-        }
-    }
-}
-
-static void remove_last_folder(char *str)
-{
-    assert(str != NULL);
+    char filepath[250];
 
-    for (int i = (strlen(str) - 1); i >= 0; i--) {
-        if (str[i] == '/') {
-            str[i] = '\0';
-            break;
-        }
-    }
-}
-
-/* Clicked to back button */
-static void back_handler(lv_event_t *e)
-{
-    lv_event_code_t code = lv_event_get_code(e);
+    strlcpy(filepath, path, sizeof(filepath));
 
-    if (code == LV_EVENT_CLICKED) {
-        remove_last_folder(fs_current_path);
-        ESP_LOGI(TAG, "Clicked back to: \"%s\"", fs_current_path);
-        app_disp_lvgl_show_files(fs_current_path);
+    /* Open window by file type (Image, text or music) */
+    ESP_LOGI(TAG, "Clicked: %s", filepath);
+    app_file_type_t filetype = get_file_type(filepath);
+    if (filetype == APP_FILE_TYPE_WAV) {
+        show_window_wav(filepath);
+    } else {
+        show_window(filepath, filetype);
     }
 }
 
-static void app_lvgl_add_back(void)
-{
-    lv_obj_t *btn;
-
-    /* Back button */
-    btn = lv_list_add_btn(fs_list, LV_SYMBOL_LEFT, "Back");
-    lv_obj_set_style_bg_color(btn, lv_color_make(0x00, 0x00, 0x00), 0);
-    lv_obj_set_style_text_color(btn, lv_color_make(0xFF, 0xFF, 0xFF), 0);
-    lv_obj_add_event_cb(btn, back_handler, LV_EVENT_CLICKED, NULL);
-}
-
-static void app_lvgl_add_file(const char *filename)
+/* File icon by type */
+static const char *file_icon_cb(const char *name, void *user_ctx)
 {
-    lv_obj_t *btn;
-    char *icon = LV_SYMBOL_FILE;
-    app_file_type_t filetype = get_file_type(filename);
-
-    /* File icon by type */
-    switch (filetype) {
+    switch (get_file_type(name)) {
     case APP_FILE_TYPE_IMG:
-        icon = LV_SYMBOL_IMAGE;
-        break;
+        return LV_SYMBOL_IMAGE;
     case APP_FILE_TYPE_WAV:
-        icon = LV_SYMBOL_AUDIO;
-        break;
+        return LV_SYMBOL_AUDIO;
     default:
-        icon = LV_SYMBOL_FILE;
-    }
-
-    /* File button */
-    btn = lv_list_add_btn(fs_list, icon, filename);
-    lv_obj_set_style_bg_color(btn, lv_color_make(0x00, 0x00, 0x00), 0);
-    lv_obj_set_style_text_color(btn, lv_color_make(0xFF, 0xFF, 0xFF), 0);
-    lv_obj_add_event_cb(btn, file_handler, LV_EVENT_CLICKED, NULL);
-
-    if (filesystem_group) {
-        lv_group_add_obj(filesystem_group, btn);
-    }
-}
-
-static void app_lvgl_add_folder(const char *filename)
-{
-    lv_obj_t *btn;
-
-    /* Directory button */
-    btn = lv_list_add_btn(fs_list, LV_SYMBOL_DIRECTORY, filename);
-    lv_obj_set_style_bg_color(btn, lv_color_make(0x00, 0x00, 0x00), 0);
-    lv_obj_set_style_text_color(btn, lv_color_make(0xFF, 0xFF, 0xFF), 0);
-    lv_obj_add_event_cb(btn, folder_handler, LV_EVENT_CLICKED, NULL);
-
-    if (filesystem_group) {
-        lv_group_add_obj(filesystem_group, btn);
-    }
-}
-
-static void app_disp_lvgl_show_files(const char *path)
-{
-    struct dirent *dir;
-    DIR *d;
-
-    bsp_display_lock(0);
-
-    /* Clean all items in the list */
-    lv_obj_clean(fs_list);
-
-    /* Current path */
-    app_lvgl_add_text(path);
-
-    /* Not root -> Add back button */
-    if (strcmp(path, FS_MNT_PATH) != 0) {
-        app_lvgl_add_back();
-    }
-
-    /* Open directory */
-    d = opendir(path);
-    if (d != NULL) {
-        /* Show button in the list for file of directory (Note: Directories are not supported in SPIFFS) */
-        while ((dir = readdir(d)) != NULL) {
-            if (dir->d_type == DT_DIR) {
-                app_lvgl_add_folder(dir->d_name);
-            } else {
-                app_lvgl_add_file(dir->d_name);
-            }
-        }
-
-        closedir(d);
+        return LV_SYMBOL_FILE;
     }
-
-    bsp_display_unlock();
 }
 
 static void app_disp_lvgl_show_filesystem(lv_obj_t *screen, lv_group_t *group)
@@ -723,8 +649,14 @@ static void app_disp_lvgl_show_filesystem(lv_obj_t *screen, lv_group_t *group)
     lv_obj_set_style_bg_grad_dir(screen, LV_GRAD_DIR_VER, 0);
     lv_obj_set_style_bg_opa(screen, 255, 0);
 
-    /* File list */
-    fs_list = lv_list_create(screen);
+    /* File list, directories are read in background and only visible rows are created */
+    file_browser_config_t browser_cfg = FILE_BROWSER_CONFIG_DEFAULT(screen, FS_MNT_PATH);
+    browser_cfg.group = group;
+    browser_cfg.select_cb = file_select_cb;
+    browser_cfg.icon_cb = file_icon_cb;
+    ESP_ERROR_CHECK(file_browser_create(&browser_cfg, &fs_browser));
+
+    lv_obj_t *fs_list = file_browser_get_obj(fs_browser);
     lv_obj_set_size(fs_list, BSP_LCD_H_RES, BSP_LCD_V_RES - 40);
     lv_obj_set_style_bg_color(fs_list, lv_color_make(0x00, 0x00, 0x00), 0);
     lv_obj_set_style_text_color(fs_list, lv_color_make(0xFF, 0xFF, 0xFF), 0);
@@ -748,11 +680,8 @@ static void rec_play_event_cb(lv_event_t *e)
     lv_obj_t *obj = lv_event_get_target(e);
 
     if (code == LV_EVENT_CLICKED) {
-        audio_mux = xSemaphoreCreateMutex();
-        assert(audio_mux);
-        play_file_stop = false;
         lv_obj_add_state(obj, LV_STATE_DISABLED);
-        xTaskCreate(play_file, "audio_task", 4096, lv_event_get_user_data(e), 6, NULL);
+        wav_player_play(wav_player, lv_event_get_user_data(e), false);
     }
 }
 
@@ -762,7 +691,7 @@ static void rec_stop_event_cb(lv_event_t *e)
     lv_event_code_t code = lv_event_get_code(e);
 
     if (code == LV_EVENT_CLICKED) {
-        play_file_stop = true;
+        wav_player_stop(wav_player);
     }
 }
 
@@ -770,66 +699,33 @@ static void rec_file(void *arg)
 {
 #if BSP_CAPS_AUDIO_MIC
     char *path = arg;
-    FILE *record_file = NULL;
-    int16_t *recording_buffer = heap_caps_malloc(BUFFER_SIZE, MALLOC_CAP_DEFAULT);
-    if (recording_buffer == NULL) {
-        ESP_LOGE(TAG, "Not enough memory for playing!");
-        goto END;
-    }
-
-    /* Open file for recording */
-    record_file = fopen(path, "wb");
-    if (record_file == NULL) {
-        ESP_LOGE(TAG, "%s file does not exist!", path);
-        goto END;
-    }
-
-    /* Write WAV file header */
-    const dumb_wav_header_t recording_header = {
-        .bits_per_sample = 16,
-        .data_size = RECORDING_LENGTH * BUFFER_SIZE,
-        .num_channels = 1,
-        .sample_rate = SAMPLE_RATE
-    };
-    if (fwrite((void *)&recording_header, 1, sizeof(dumb_wav_header_t), record_file) != sizeof(dumb_wav_header_t)) {
-        ESP_LOGW(TAG, "Error in writting to file");
-        goto END;
-    }
-
-    ESP_LOGI(TAG, "Recording start");
-
-    esp_codec_dev_sample_info_t fs = {
+    const esp_codec_dev_sample_info_t fs = {
         .sample_rate = SAMPLE_RATE,
         .channel = 1,
         .bits_per_sample = 16,
         .mclk_multiple = I2S_MCLK_MULTIPLE_384,
     };
-    esp_codec_dev_open(mic_codec_dev, &fs);
-
-    size_t bytes_written_to_spiffs = 0;
-    while (bytes_written_to_spiffs < RECORDING_LENGTH * BUFFER_SIZE) {
-        ESP_ERROR_CHECK(esp_codec_dev_read(mic_codec_dev, recording_buffer, BUFFER_SIZE));
-
-        /* Write WAV file data */
-        size_t data_written = fwrite(recording_buffer, 1, BUFFER_SIZE, record_file);
-        bytes_written_to_spiffs += data_written;
-    }
 
-    ESP_LOGI(TAG, "Recording stop, length: %i bytes", bytes_written_to_spiffs);
-
-END:
-    esp_codec_dev_close(mic_codec_dev);
-
-    if (record_file) {
-        fclose(record_file);
-    }
+    if (wav_recorder_start(wav_recorder, path, &fs) == ESP_OK) {
+        ESP_LOGI(TAG, "Recording start");
+        vTaskDelay(pdMS_TO_TICKS(RECORDING_TIME_MS));
+        /* Buffered data are stored and the WAV header is updated */
+        if (wav_recorder_stop(wav_recorder) != ESP_OK) {
+            ESP_LOGW(TAG, "Error in writting to file");
+        }
 
-    if (recording_buffer) {
-        free(recording_buffer);
+        wav_recorder_stats_t stats;
+        wav_recorder_get_stats(wav_recorder, &stats);
+        ESP_LOGI(TAG, "Recording stop, length: %" PRIu32 " bytes, overruns: %" PRIu32 ", longest write: %" PRIu32 " us",
+                 stats.bytes_written, stats.overrun_cnt, stats.write_time_max);
     }
 
     if (rec_btn && play1_btn && rec_stop_btn) {
         bsp_display_lock(0);
+        /* The recording could be a new file */
+        if (fs_browser) {
+            file_browser_refresh(fs_browser);
+        }
         lv_obj_clear_state(rec_btn, LV_STATE_DISABLED);
         lv_obj_clear_state(play1_btn, LV_STATE_DISABLED);
         lv_obj_clear_state(rec_stop_btn, LV_STATE_DISABLED);
@@ -909,6 +805,36 @@ static void app_disp_lvgl_show_record(lv_obj_t *screen, lv_group_t *group)
     }
 }
 
+/* UI font with glyph cache, the original font is used when the cache cannot be created */
+static const lv_font_t *app_disp_font(void)
+{
+    static lvgl_port_font_cache_handle_t font_cache = NULL;
+    if (font_cache) {
+        return lvgl_port_font_cache_get_font(font_cache);
+    }
+
+    const lvgl_port_font_cache_cfg_t cache_cfg = {
+        .font = &lv_font_montserrat_14,
+        .cache_size = FONT_CACHE_SIZE,
+#ifdef CONFIG_SPIRAM
+        .flags.buff_spiram = true,
+#endif
+    };
+    if (lvgl_port_font_cache_create(&cache_cfg, &font_cache) != ESP_OK) {
+        return &lv_font_montserrat_14;
+    }
+
+    /* Printable ASCII and icons are rendered now, the file list scrolls without glyph rendering */
+    char ascii[96];
+    for (int i = 0; i < 95; i++) {
+        ascii[i] = (char)(' ' + i);
+    }
+    ascii[95] = '\0';
+    lvgl_port_font_cache_prewarm(font_cache, ascii);
+    lvgl_port_font_cache_prewarm(font_cache, FONT_CACHE_SYMBOLS);
+    return lvgl_port_font_cache_get_font(font_cache);
+}
+
 static void app_disp_lvgl_show_settings(lv_obj_t *screen, lv_group_t *group)
 {
     lv_obj_t *cont_row;
@@ -938,7 +864,7 @@ static void app_disp_lvgl_show_settings(lv_obj_t *screen, lv_group_t *group)
 
     /* Label */
     lv_obj_t *lbl = lv_label_create(cont_row);
-    lv_obj_set_style_text_font(lbl, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_font(lbl, app_disp_font(), 0);
     lv_label_set_text_static(lbl, "Brightness: ");
     lv_obj_align(lbl, LV_ALIGN_LEFT_MID, 0, 0);
 
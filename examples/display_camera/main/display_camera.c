@@ -5,7 +5,7 @@
  */
 
 #include <stdio.h>
-#include <string.h>
+#include <inttypes.h>
 #include "sdkconfig.h"
 #include "bsp/esp-bsp.h"
 #include "freertos/FreeRTOS.h"
@@ -17,10 +17,90 @@
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_vendor.h"
 #include "esp_lcd_panel_ops.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#if !CONFIG_IDF_TARGET_ESP32P4
 #include "esp_camera.h"
+#endif
 
 static const char *TAG = "example";
 
+#if CONFIG_IDF_TARGET_ESP32P4
+/* MIPI-CSI camera: PPA scales frames into two canvas buffers, LVGL shows one while the other one is written */
+#define CANVAS_BUF_ALIGN    (64)
+#define CANVAS_BUF_SIZE     ((BSP_LCD_H_RES * BSP_LCD_V_RES * BSP_LCD_BITS_PER_PIXEL / 8 + CANVAS_BUF_ALIGN - 1) & ~(CANVAS_BUF_ALIGN - 1))
+#if BSP_LCD_COLOR_FORMAT == ESP_LCD_COLOR_FORMAT_RGB888
+#define CANVAS_COLOR_FORMAT LV_COLOR_FORMAT_RGB888
+#define CAMERA_COLOR        BSP_CAMERA_COLOR_RGB888
+#else
+#define CANVAS_COLOR_FORMAT LV_COLOR_FORMAT_RGB565
+#define CAMERA_COLOR        BSP_CAMERA_COLOR_RGB565
+#endif
+
+void app_main(void)
+{
+    bsp_display_start();
+    bsp_display_backlight_on(); // Set display brightness to 100%
+
+    const bsp_camera_cfg_t camera_cfg = {
+        .color = CAMERA_COLOR,
+        .fb_count = 3,
+    };
+    esp_err_t err = bsp_camera_start(&camera_cfg);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Camera Init Failed");
+        return;
+    }
+    ESP_LOGI(TAG, "Camera Init done");
+
+    uint8_t *canvas_buf[2];
+    for (int i = 0; i < 2; i++) {
+        canvas_buf[i] = heap_caps_aligned_calloc(CANVAS_BUF_ALIGN, 1, CANVAS_BUF_SIZE, MALLOC_CAP_SPIRAM);
+        assert(canvas_buf[i]);
+    }
+
+    bsp_display_lock(0);
+    lv_obj_t *camera_canvas = lv_canvas_create(lv_scr_act());
+    assert(camera_canvas);
+    lv_obj_center(camera_canvas);
+    bsp_display_unlock();
+
+    int back = 0;
+    int64_t stats_time = esp_timer_get_time();
+    while (1) {
+        bsp_camera_frame_t *frame;
+        if (bsp_camera_frame_get(&frame, 1000) != ESP_OK) {
+            ESP_LOGE(TAG, "Get frame failed");
+            continue;
+        }
+        /* PPA scales and converts the frame into the canvas buffer, which is not shown now (no copy by CPU) */
+        const bsp_camera_dst_t dst = {
+            .buffer = canvas_buf[back],
+            .buffer_size = CANVAS_BUF_SIZE,
+            .width = BSP_LCD_H_RES,
+            .height = BSP_LCD_V_RES,
+            .color = CAMERA_COLOR,
+        };
+        err = bsp_camera_frame_scale(frame, &dst);
+        bsp_camera_frame_return(frame);
+        if (err != ESP_OK) {
+            continue;
+        }
+
+        bsp_display_lock(0);
+        lv_canvas_set_buffer(camera_canvas, canvas_buf[back], BSP_LCD_H_RES, BSP_LCD_V_RES, CANVAS_COLOR_FORMAT);
+        bsp_display_unlock();
+        back ^= 1;
+
+        if (esp_timer_get_time() - stats_time > 5000000) {
+            bsp_camera_stats_t stats;
+            bsp_camera_get_stats(&stats);
+            ESP_LOGI(TAG, "Camera %"PRIu32" fps, %"PRIu32" dropped frames, PPA scaling %"PRIu32" us", stats.fps, stats.drop_cnt, stats.scale_avg_us);
+            stats_time = esp_timer_get_time();
+        }
+    }
+}
+#else
 void app_main(void)
 {
     bsp_i2c_init();
@@ -39,34 +119,40 @@ void app_main(void)
     s->set_hmirror(s, BSP_CAMERA_HMIRROR);
     ESP_LOGI(TAG, "Camera Init done");
 
-    uint32_t cam_buff_size = BSP_LCD_H_RES * BSP_LCD_V_RES * 2;
-    uint8_t *cam_buff = heap_caps_malloc(cam_buff_size, MALLOC_CAP_SPIRAM);
-    assert(cam_buff);
+    /* Frames of any camera resolution are scaled and cropped to the display in one pass into two canvas buffers,
+       LVGL shows one while the other one is written */
+    uint16_t *canvas_buf[2];
+    for (int i = 0; i < 2; i++) {
+        canvas_buf[i] = heap_caps_malloc(BSP_LCD_H_RES * BSP_LCD_V_RES * sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+        assert(canvas_buf[i]);
+    }
 
-    // Create LVGL canvas for camera image
     bsp_display_lock(0);
     lv_obj_t *camera_canvas = lv_canvas_create(lv_scr_act());
-    lv_canvas_set_buffer(camera_canvas, cam_buff, BSP_LCD_H_RES, BSP_LCD_V_RES, LV_COLOR_FORMAT_RGB565);
     assert(camera_canvas);
     lv_obj_center(camera_canvas);
     bsp_display_unlock();
 
-    camera_fb_t *pic;
+    int back = 0;
     while (1) {
-        pic = esp_camera_fb_get();
-        if (pic) {
-            esp_camera_fb_return(pic);
-            bsp_display_lock(0);
-            memcpy(cam_buff, pic->buf, cam_buff_size);
-            if (BSP_LCD_BIGENDIAN) {
-                /* Swap bytes in RGB565 */
-                lv_draw_sw_rgb565_swap(cam_buff, cam_buff_size);
-            }
-            lv_obj_invalidate(camera_canvas);
-            bsp_display_unlock();
-        } else {
+        /* Grab-latest mode (BSP_CAMERA_DEFAULT_CONFIG): the newest frame, no stale frames are queued */
+        camera_fb_t *pic = esp_camera_fb_get();
+        if (pic == NULL) {
             ESP_LOGE(TAG, "Get frame failed");
+            vTaskDelay(1);
+            continue;
         }
+        /* Camera RGB565 is big-endian, canvas is in native order */
+        lvgl_port_transform_rgb565_scale((const uint16_t *)pic->buf, pic->width, pic->height, canvas_buf[back], BSP_LCD_H_RES, BSP_LCD_V_RES,
+                                         true, BSP_LCD_BIGENDIAN);
+        esp_camera_fb_return(pic);
+
+        bsp_display_lock(0);
+        lv_canvas_set_buffer(camera_canvas, canvas_buf[back], BSP_LCD_H_RES, BSP_LCD_V_RES, LV_COLOR_FORMAT_RGB565);
+        lv_obj_center(camera_canvas);
+        bsp_display_unlock();
+        back ^= 1;
         vTaskDelay(1);
     }
 }
+#endif
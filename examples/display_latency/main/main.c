@@ -0,0 +1,258 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "bsp/esp-bsp.h"
+#include "esp_lvgl_port.h"
+#include "lvgl.h"
+
+static const char *TAG = "example";
+
+#define APP_SQUARE_HALF     (CONFIG_EXAMPLE_SQUARE_SIZE / 2)
+
+/* Measured sample moves through the states as the trace stages come */
+typedef enum {
+    APP_STATE_IDLE,     /* Waiting for touch read */
+    APP_STATE_READ,     /* Square moved, waiting for rendering */
+    APP_STATE_RENDER,   /* Waiting for flush of the square area */
+    APP_STATE_FLUSH,    /* Waiting for end of the flush */
+} app_state_t;
+
+/* Timestamps of one touch-to-flush sample */
+typedef enum {
+    APP_TS_IRQ,
+    APP_TS_WAKE,
+    APP_TS_READ,
+    APP_TS_RENDER,
+    APP_TS_FLUSH,
+    APP_TS_DONE,
+    APP_TS_MAX,
+} app_ts_t;
+
+typedef struct {
+    int64_t ts[APP_TS_MAX];     /* [us] */
+} app_sample_t;
+
+static app_state_t state;
+static app_sample_t cur;
+static app_sample_t samples[CONFIG_EXAMPLE_SAMPLES];
+static size_t sample_cnt;
+static uint32_t dropped_cnt;
+static lv_area_t target;        /* Area of the square after the last touch */
+static TaskHandle_t report_task;
+static portMUX_TYPE trace_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t latency_us[CONFIG_EXAMPLE_SAMPLES];
+
+/*******************************************************************************
+* Private functions
+*******************************************************************************/
+
+static inline void app_probe_set(uint32_t level)
+{
+#if CONFIG_EXAMPLE_PROBE_GPIO >= 0
+    gpio_set_level(CONFIG_EXAMPLE_PROBE_GPIO, level);
+#endif
+}
+
+/* lv_area_intersect is not used, flush end can be reported from ISR */
+static inline bool app_area_hits_target(const lv_area_t *area)
+{
+    return area && area->x1 <= target.x2 && area->x2 >= target.x1 && area->y1 <= target.y2 && area->y2 >= target.y1;
+}
+
+static void IRAM_ATTR app_trace_cb(lvgl_port_trace_stage_t stage, int64_t time_us, const lv_area_t *area, void *user_ctx)
+{
+    bool full = false;
+
+    portENTER_CRITICAL_SAFE(&trace_lock);
+    switch (stage) {
+    case LVGL_PORT_TRACE_TOUCH_IRQ:
+        /* The first interrupt after the last sample starts the next one */
+        if (state == APP_STATE_IDLE && cur.ts[APP_TS_IRQ] == 0) {
+            cur.ts[APP_TS_IRQ] = time_us;
+            app_probe_set(1);
+        }
+        break;
+    case LVGL_PORT_TRACE_TASK_WAKE:
+        if (state == APP_STATE_IDLE && cur.ts[APP_TS_IRQ] != 0 && cur.ts[APP_TS_WAKE] == 0) {
+            cur.ts[APP_TS_WAKE] = time_us;
+        }
+        break;
+    case LVGL_PORT_TRACE_TOUCH_READ:
+        if (state == APP_STATE_IDLE) {
+            /* Touch is polled while pressed, the sample starts by reading */
+            if (cur.ts[APP_TS_IRQ] == 0) {
+                cur.ts[APP_TS_IRQ] = time_us;
+                app_probe_set(1);
+            }
+            if (cur.ts[APP_TS_WAKE] == 0) {
+                cur.ts[APP_TS_WAKE] = time_us;
+            }
+            cur.ts[APP_TS_READ] = time_us;
+            state = APP_STATE_READ;
+        }
+        break;
+    case LVGL_PORT_TRACE_RENDER:
+        if (state == APP_STATE_READ) {
+            cur.ts[APP_TS_RENDER] = time_us;
+            state = APP_STATE_RENDER;
+        } else if (state != APP_STATE_IDLE) {
+            /* The square was not redrawn in the previous frame (it did not move) */
+            memset(&cur, 0, sizeof(cur));
+            state = APP_STATE_IDLE;
+            dropped_cnt++;
+            app_probe_set(0);
+        }
+        break;
+    case LVGL_PORT_TRACE_FLUSH:
+        if (state == APP_STATE_RENDER && app_area_hits_target(area)) {
+            cur.ts[APP_TS_FLUSH] = time_us;
+            state = APP_STATE_FLUSH;
+        }
+        break;
+    case LVGL_PORT_TRACE_FLUSH_DONE:
+        if (state == APP_STATE_FLUSH) {
+            app_probe_set(0);
+            cur.ts[APP_TS_DONE] = time_us;
+            if (sample_cnt < CONFIG_EXAMPLE_SAMPLES) {
+                samples[sample_cnt++] = cur;
+                full = (sample_cnt == CONFIG_EXAMPLE_SAMPLES);
+            }
+            memset(&cur, 0, sizeof(cur));
+            state = APP_STATE_IDLE;
+        }
+        break;
+    }
+    portEXIT_CRITICAL_SAFE(&trace_lock);
+
+    if (full) {
+        if (xPortInIsrContext()) {
+            BaseType_t need_yield = pdFALSE;
+            vTaskNotifyGiveFromISR(report_task, &need_yield);
+            if (need_yield) {
+                portYIELD_FROM_ISR();
+            }
+        } else {
+            xTaskNotifyGive(report_task);
+        }
+    }
+}
+
+/* The square follows the touch, the flush of its new area ends the sample */
+static void app_touch_cb(lv_event_t *e)
+{
+    lv_obj_t *square = lv_event_get_user_data(e);
+    lv_point_t point;
+    lv_indev_get_point(lv_indev_active(), &point);
+    lv_obj_set_pos(square, point.x - APP_SQUARE_HALF, point.y - APP_SQUARE_HALF);
+
+    portENTER_CRITICAL(&trace_lock);
+    target.x1 = point.x - APP_SQUARE_HALF;
+    target.y1 = point.y - APP_SQUARE_HALF;
+    target.x2 = target.x1 + CONFIG_EXAMPLE_SQUARE_SIZE - 1;
+    target.y2 = target.y1 + CONFIG_EXAMPLE_SQUARE_SIZE - 1;
+    portEXIT_CRITICAL(&trace_lock);
+}
+
+static void app_lvgl_display(void)
+{
+    bsp_display_lock(0);
+
+    lv_obj_t *scr = lv_scr_act();
+    lv_obj_set_style_bg_color(scr, lv_color_black(), 0);
+    lv_obj_remove_flag(scr, LV_OBJ_FLAG_SCROLLABLE);
+
+    lv_obj_t *lbl = lv_label_create(scr);
+    lv_obj_set_style_text_color(lbl, lv_color_white(), 0);
+    lv_label_set_text(lbl, "Drag finger over the screen");
+    lv_obj_align(lbl, LV_ALIGN_TOP_MID, 0, 10);
+
+    lv_obj_t *square = lv_obj_create(scr);
+    lv_obj_set_size(square, CONFIG_EXAMPLE_SQUARE_SIZE, CONFIG_EXAMPLE_SQUARE_SIZE);
+    lv_obj_set_style_bg_color(square, lv_color_white(), 0);
+    lv_obj_set_style_border_width(square, 0, 0);
+    lv_obj_set_style_radius(square, 0, 0);
+    lv_obj_remove_flag(square, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_center(square);
+
+    lv_obj_add_event_cb(scr, app_touch_cb, LV_EVENT_PRESSING, square);
+
+    bsp_display_unlock();
+}
+
+static int app_latency_cmp(const void *a, const void *b)
+{
+    const uint32_t x = *(const uint32_t *)a;
+    const uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Distribution of time between two timestamps of the samples */
+static void app_latency_print(const char *name, const app_sample_t *list, size_t cnt, app_ts_t from, app_ts_t to)
+{
+    for (size_t i = 0; i < cnt; i++) {
+        latency_us[i] = (uint32_t)(list[i].ts[to] - list[i].ts[from]);
+    }
+    qsort(latency_us, cnt, sizeof(uint32_t), app_latency_cmp);
+    ESP_LOGI(TAG, "%-15s min %6"PRIu32"  p50 %6"PRIu32"  p90 %6"PRIu32"  p99 %6"PRIu32"  max %6"PRIu32" us", name,
+             latency_us[0], latency_us[cnt / 2], latency_us[cnt * 90 / 100], latency_us[cnt * 99 / 100], latency_us[cnt - 1]);
+}
+
+/* Samples are not written while the buffer is full, they are read without copy */
+static void app_report(void)
+{
+    const app_sample_t *list = samples;
+    const size_t cnt = CONFIG_EXAMPLE_SAMPLES;
+    const uint32_t dropped = dropped_cnt;
+
+    ESP_LOGI(TAG, "Touch-to-flush latency, %u samples (%"PRIu32" touches without redraw):", (unsigned)cnt, dropped);
+    app_latency_print("irq -> wake", list, cnt, APP_TS_IRQ, APP_TS_WAKE);
+    app_latency_print("wake -> read", list, cnt, APP_TS_WAKE, APP_TS_READ);
+    app_latency_print("read -> render", list, cnt, APP_TS_READ, APP_TS_RENDER);
+    app_latency_print("render -> flush", list, cnt, APP_TS_RENDER, APP_TS_FLUSH);
+    app_latency_print("flush -> done", list, cnt, APP_TS_FLUSH, APP_TS_DONE);
+    app_latency_print("total", list, cnt, APP_TS_IRQ, APP_TS_DONE);
+
+    portENTER_CRITICAL(&trace_lock);
+    sample_cnt = 0;
+    dropped_cnt = 0;
+    portEXIT_CRITICAL(&trace_lock);
+}
+
+void app_main(void)
+{
+#if CONFIG_EXAMPLE_PROBE_GPIO >= 0
+    const gpio_config_t probe_cfg = {
+        .pin_bit_mask = BIT64(CONFIG_EXAMPLE_PROBE_GPIO),
+        .mode = GPIO_MODE_OUTPUT,
+    };
+    ESP_ERROR_CHECK(gpio_config(&probe_cfg));
+    gpio_set_level(CONFIG_EXAMPLE_PROBE_GPIO, 0);
+#endif
+
+    /* Initialize display and LVGL */
+    lv_display_t *disp = bsp_display_start();
+    assert(disp);
+    bsp_display_backlight_on();
+    app_lvgl_display();
+
+    report_task = xTaskGetCurrentTaskHandle();
+    ESP_ERROR_CHECK(lvgl_port_set_trace_cb(app_trace_cb, NULL));
+    ESP_LOGI(TAG, "Measuring, probe GPIO %d, report after %d samples", CONFIG_EXAMPLE_PROBE_GPIO, CONFIG_EXAMPLE_SAMPLES);
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        app_report();
+    }
+}
@@ -0,0 +1,132 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "bsp/esp-bsp.h"
+#include "lvgl.h"
+
+static const char *TAG = "example";
+
+/* Run time counters of idle tasks from the previous period */
+typedef struct {
+    TaskHandle_t handle;
+    uint32_t run_time;
+} app_idle_counter_t;
+
+static app_idle_counter_t idle_prev[portNUM_PROCESSORS];
+static uint32_t total_prev;
+
+/*******************************************************************************
+* Private functions
+*******************************************************************************/
+
+static void app_lvgl_display(void)
+{
+    bsp_display_lock(0);
+
+    lv_obj_t *scr = lv_scr_act();
+    lv_obj_t *spinner = lv_spinner_create(scr);
+    lv_obj_set_size(spinner, 100, 100);
+    lv_obj_align(spinner, LV_ALIGN_CENTER, 0, -20);
+
+    lv_obj_t *lbl = lv_label_create(scr);
+    lv_label_set_text(lbl, "Light sleep between frames");
+    lv_obj_align(lbl, LV_ALIGN_BOTTOM_MID, 0, -20);
+
+    bsp_display_unlock();
+}
+
+static app_idle_counter_t *app_idle_prev_get(TaskHandle_t handle)
+{
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        if (idle_prev[i].handle == handle || idle_prev[i].handle == NULL) {
+            idle_prev[i].handle = handle;
+            return &idle_prev[i];
+        }
+    }
+    return NULL;
+}
+
+/* Time in light sleep is accounted to the idle tasks, so the SoC is estimated to be active only while not idle */
+static void app_print_stats(void)
+{
+    UBaseType_t count = uxTaskGetNumberOfTasks();
+    TaskStatus_t *tasks = malloc(count * sizeof(TaskStatus_t));
+    if (tasks == NULL) {
+        ESP_LOGE(TAG, "Not enough memory for task statistics");
+        return;
+    }
+
+    uint32_t total;
+    count = uxTaskGetSystemState(tasks, count, &total);
+    const uint32_t elapsed = total - total_prev;
+    total_prev = total;
+
+    uint32_t idle_sum = 0;
+    int idle_num = 0;
+    for (UBaseType_t i = 0; i < count && elapsed > 0; i++) {
+        if (strncmp(tasks[i].pcTaskName, "IDLE", 4) != 0) {
+            continue;
+        }
+        app_idle_counter_t *prev = app_idle_prev_get(tasks[i].xHandle);
+        if (prev == NULL) {
+            continue;
+        }
+        uint32_t idle = tasks[i].ulRunTimeCounter - prev->run_time;
+        prev->run_time = tasks[i].ulRunTimeCounter;
+        if (idle > elapsed) {
+            idle = elapsed;
+        }
+        ESP_LOGI(TAG, "CPU load (%s): %" PRIu32 " %%", tasks[i].pcTaskName, 100 - (uint32_t)(100ULL * idle / elapsed));
+        idle_sum += idle;
+        idle_num++;
+    }
+    free(tasks);
+
+    if (idle_num > 0) {
+        const uint64_t active_permille = 1000 - 1000ULL * idle_sum / ((uint64_t)elapsed * idle_num);
+        const uint64_t current_ua = (active_permille * CONFIG_EXAMPLE_CURRENT_ACTIVE_MA * 1000 +
+                                     (1000 - active_permille) * CONFIG_EXAMPLE_CURRENT_SLEEP_UA) / 1000;
+        ESP_LOGI(TAG, "Estimated SoC average current: %" PRIu64 ".%02" PRIu64 " mA (active %" PRIu64 ".%" PRIu64 " %%)",
+                 current_ua / 1000, (current_ua % 1000) / 10, active_permille / 10, active_permille % 10);
+    }
+
+#if CONFIG_PM_ENABLE
+    esp_pm_dump_locks(stdout);
+#endif
+}
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+void app_main(void)
+{
+    /* Enable DFS and automatic light sleep before the drivers create their locks */
+    esp_err_t ret = bsp_pm_enable(true);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Power management not enabled: %s", esp_err_to_name(ret));
+    }
+
+    bsp_display_start();
+    bsp_display_backlight_on();
+
+    app_lvgl_display();
+
+    ESP_LOGI(TAG, "Example initialization done.");
+
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_EXAMPLE_STATS_PERIOD_S * 1000));
+        app_print_stats();
+    }
+}
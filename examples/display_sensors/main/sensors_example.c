@@ -10,11 +10,10 @@
 #include "fbm320.h"
 #include "mag3110.h"
 #include "bh1750.h"
+#include "sensor_hub.h"
 #include "bsp/esp-bsp.h"
 #include "esp_log.h"
-#include "esp_timer.h"
 #include "sdmmc_cmd.h" // for sdmmc_card_print_info
-#include "esp_idf_version.h" // for backward compatibility of esp-timer
 
 static const char *TAG = "example";
 
@@ -32,9 +31,47 @@ static mag3110_handle_t mag3110_dev = NULL;
 static QueueHandle_t q_page_num;
 static uint8_t g_page_num = 0;
 
-static mpu6050_acce_value_t acce;
-static mpu6050_gyro_value_t gyro;
-static complimentary_angle_t complimentary_angle;
+// Values of the shown page are bound to the main label, it is redrawn only when the shown text changes
+typedef struct {
+    const char *fmt;
+    uint32_t value_count;
+    float epsilon; // One digit of the shown precision, noise in the last digit does not redraw the label
+} page_format_t;
+
+static const page_format_t page_formats[] = {
+    {"Temp: %.1f\nHumi: %.1f\nLumi: %.1f", 3, 0.1f},
+    {"Acce_x: %.2f\nAcce_y: %.2f\nAcce_z: %.2f", 3, 0.01f},
+    {"Gyro_x: %.2f\nGyro_y: %.2f\nGyro_z: %.2f", 3, 0.01f},
+    {"Roll: %.2f\nPitch: %.2f", 2, 0.01f},
+    {"Press: %.1f\nTemp: %.1f", 2, 0.1f},
+    {"Mag_x: %5.0f\nMag_y: %5.0f\nMag_z: %5.0f", 3, 1.0f},
+};
+static lvgl_port_bind_handle_t page_bind = NULL;
+static uint8_t page_bind_num = 0;
+
+// Sensors are sampled by the sensor hub, the display only reads the latest samples
+static sensor_hub_handle_t hub = NULL;
+static sensor_hub_stream_handle_t hts221_stream = NULL;
+static sensor_hub_stream_handle_t bh1750_stream = NULL;
+static sensor_hub_stream_handle_t mpu6050_stream = NULL;
+static sensor_hub_stream_handle_t fbm320_stream = NULL;
+static sensor_hub_stream_handle_t mag3110_stream = NULL;
+
+typedef struct {
+    int16_t temperature;
+    int16_t humidity;
+} hts221_sample_t;
+
+typedef struct {
+    mpu6050_acce_value_t acce;
+    mpu6050_gyro_value_t gyro;
+    complimentary_angle_t complimentary_angle;
+} mpu6050_sample_t;
+
+typedef struct {
+    int32_t temperature;
+    int32_t pressure;
+} fbm320_sample_t;
 
 static void display_show_signs(void)
 {
@@ -84,81 +121,105 @@ static void app_mag3110_init()
     mag3110_dev = mag3110_create(BSP_I2C_NUM);
 }
 
-static void display_show_env_data(void)
+static void display_bind_page(uint8_t page_num)
 {
-    int16_t temp;
-    int16_t humi;
-    float lumi;
+    if (page_bind && page_bind_num == page_num) {
+        return;
+    }
+    if (page_bind) {
+        lvgl_port_bind_delete(page_bind);
+        page_bind = NULL;
+    }
 
-    hts221_get_temperature(hts221_dev, &temp);
-    hts221_get_humidity(hts221_dev, &humi);
-    bh1750_get_data(bh1750_dev, &lumi);
-    ESP_LOGI(TAG, "temperature: %.1f, humidity: %.1f, luminance: %.1f", (float)temp / 10, (float)humi / 10, lumi);
+    const lvgl_port_bind_cfg_t bind_cfg = {
+        .label = main_label,
+        .fmt = page_formats[page_num].fmt,
+        .value_count = page_formats[page_num].value_count,
+        .epsilon = page_formats[page_num].epsilon,
+    };
+    ESP_ERROR_CHECK(lvgl_port_bind_create(&bind_cfg, &page_bind));
+    page_bind_num = page_num;
 
     bsp_display_lock(0);
-    lv_label_set_text_fmt(main_label, "Temp: %.1f\nHumi: %.1f\nLumi: %.1f", (float)temp / 10, (float)humi / 10, lumi);
     lv_obj_set_style_text_align(main_label, LV_TEXT_ALIGN_LEFT, 0);
     bsp_display_unlock();
 }
 
+static void display_show_env_data(void)
+{
+    hts221_sample_t hts221_sample = {0};
+    float lumi = 0;
+
+    sensor_hub_read_latest(hts221_stream, &hts221_sample, NULL);
+    sensor_hub_read_latest(bh1750_stream, &lumi, NULL);
+    const int16_t temp = hts221_sample.temperature;
+    const int16_t humi = hts221_sample.humidity;
+    ESP_LOGI(TAG, "temperature: %.1f, humidity: %.1f, luminance: %.1f", (float)temp / 10, (float)humi / 10, lumi);
+
+    const float values[] = {(float)temp / 10, (float)humi / 10, lumi};
+    lvgl_port_bind_set(page_bind, values, 3);
+}
+
 static void display_show_acce_data(void)
 {
+    mpu6050_sample_t sample = {0};
+    sensor_hub_read_latest(mpu6050_stream, &sample, NULL);
+    const mpu6050_acce_value_t acce = sample.acce;
+
     ESP_LOGI(TAG, "acce_x:%.2f, acce_y:%.2f, acce_z:%.2f", acce.acce_x, acce.acce_y, acce.acce_z);
 
-    bsp_display_lock(0);
-    lv_label_set_text_fmt(main_label, "Acce_x: %.2f\nAcce_y: %.2f\nAcce_z: %.2f", acce.acce_x, acce.acce_y, acce.acce_z);
-    lv_obj_set_style_text_align(main_label, LV_TEXT_ALIGN_LEFT, 0);
-    bsp_display_unlock();
+    const float values[] = {acce.acce_x, acce.acce_y, acce.acce_z};
+    lvgl_port_bind_set(page_bind, values, 3);
 }
 
 static void display_show_gyro_data(void)
 {
+    mpu6050_sample_t sample = {0};
+    sensor_hub_read_latest(mpu6050_stream, &sample, NULL);
+    const mpu6050_gyro_value_t gyro = sample.gyro;
+
     ESP_LOGI(TAG, "gyro_x:%.2f, gyro_y:%.2f, gyro_z:%.2f", gyro.gyro_x, gyro.gyro_y, gyro.gyro_z);
 
-    bsp_display_lock(0);
-    lv_label_set_text_fmt(main_label, "Gyro_x: %.2f\nGyro_y: %.2f\nGyro_z: %.2f", gyro.gyro_x, gyro.gyro_y, gyro.gyro_z);
-    lv_obj_set_style_text_align(main_label, LV_TEXT_ALIGN_LEFT, 0);
-    bsp_display_unlock();
+    const float values[] = {gyro.gyro_x, gyro.gyro_y, gyro.gyro_z};
+    lvgl_port_bind_set(page_bind, values, 3);
 }
 
 static void display_show_complimentary_angle(void)
 {
+    mpu6050_sample_t sample = {0};
+    sensor_hub_read_latest(mpu6050_stream, &sample, NULL);
+    const complimentary_angle_t complimentary_angle = sample.complimentary_angle;
+
     ESP_LOGI(TAG, "roll:%.2f, pitch:%.2f", complimentary_angle.roll, complimentary_angle.pitch);
 
-    bsp_display_lock(0);
-    lv_label_set_text_fmt(main_label, "Roll: %.2f\nPitch: %.2f", complimentary_angle.roll, complimentary_angle.pitch);
-    lv_obj_set_style_text_align(main_label, LV_TEXT_ALIGN_LEFT, 0);
-    bsp_display_unlock();
+    const float values[] = {complimentary_angle.roll, complimentary_angle.pitch};
+    lvgl_port_bind_set(page_bind, values, 2);
 }
 
 static void display_show_barometer_data(void)
 {
-    int32_t real_p, real_t;
+    fbm320_sample_t sample;
     float pressure, temperature;
 
-    if (ESP_OK == fbm320_get_data(fbm320_dev, FBM320_MEAS_PRESS_OSR_1024, &real_t, &real_p)) {
-        pressure = (float)real_p / 1000;
-        temperature = (float)real_t / 100;
+    if (ESP_OK == sensor_hub_read_latest(fbm320_stream, &sample, NULL)) {
+        pressure = (float)sample.pressure / 1000;
+        temperature = (float)sample.temperature / 100;
         ESP_LOGI(TAG, "pressure: %.1f, temperature: %.1f", pressure, temperature);
 
-        bsp_display_lock(0);
-        lv_label_set_text_fmt(main_label, "Press: %.1f\nTemp: %.1f", pressure, temperature);
-        lv_obj_set_style_text_align(main_label, LV_TEXT_ALIGN_LEFT, 0);
-        bsp_display_unlock();
+        const float values[] = {pressure, temperature};
+        lvgl_port_bind_set(page_bind, values, 2);
     }
 }
 
 static void display_show_magmeter_data(void)
 {
-    mag3110_result_t mag_induction;
+    mag3110_result_t mag_induction = {0};
 
-    mag3110_get_magnetic_induction(mag3110_dev, &mag_induction);
+    sensor_hub_read_latest(mag3110_stream, &mag_induction, NULL);
     ESP_LOGI(TAG, "mag_x:%i, mag_y:%i, mag_z:%i", mag_induction.x, mag_induction.y, mag_induction.z);
 
-    bsp_display_lock(0);
-    lv_label_set_text_fmt(main_label, "Mag_x: %5i\nMag_y: %5i\nMag_z: %5i", mag_induction.x, mag_induction.y, mag_induction.z);
-    lv_obj_set_style_text_align(main_label, LV_TEXT_ALIGN_LEFT, 0);
-    bsp_display_unlock();
+    const float values[] = {mag_induction.x, mag_induction.y, mag_induction.z};
+    lvgl_port_bind_set(page_bind, values, 3);
 }
 
 static void display_show_task(void *pvParameters)
@@ -174,6 +235,7 @@ static void display_show_task(void *pvParameters)
             bsp_buzzer_set(true);
         }
 
+        display_bind_page(page_num);
         switch (page_num) {
         case 0:
             display_show_env_data();
@@ -199,11 +261,101 @@ static void display_show_task(void *pvParameters)
     }
 }
 
-static void mpu6050_read(void *pvParameters)
+static esp_err_t hts221_hub_read(void *driver_ctx, void *sample, uint32_t *wait_us)
 {
-    mpu6050_get_acce(mpu6050_dev, &acce);
-    mpu6050_get_gyro(mpu6050_dev, &gyro);
-    mpu6050_complimentory_filter(mpu6050_dev, &acce, &gyro, &complimentary_angle);
+    hts221_sample_t *hts221_sample = (hts221_sample_t *)sample;
+    esp_err_t ret = hts221_get_temperature(hts221_dev, &hts221_sample->temperature);
+    if (ESP_OK != ret) {
+        return ret;
+    }
+    return hts221_get_humidity(hts221_dev, &hts221_sample->humidity);
+}
+
+static esp_err_t bh1750_hub_read(void *driver_ctx, void *sample, uint32_t *wait_us)
+{
+    return bh1750_get_data(bh1750_dev, (float *)sample);
+}
+
+static esp_err_t mpu6050_hub_read(void *driver_ctx, void *sample, uint32_t *wait_us)
+{
+    mpu6050_sample_t *mpu6050_sample = (mpu6050_sample_t *)sample;
+    esp_err_t ret = mpu6050_get_all(mpu6050_dev, &mpu6050_sample->acce, &mpu6050_sample->gyro, NULL);
+    if (ESP_OK != ret) {
+        return ret;
+    }
+    return mpu6050_complimentory_filter(mpu6050_dev, &mpu6050_sample->acce, &mpu6050_sample->gyro, &mpu6050_sample->complimentary_angle);
+}
+
+static esp_err_t fbm320_hub_start(void *driver_ctx, uint32_t *wait_us)
+{
+    *wait_us = 10000; // Temperature conversion
+    return fbm320_start_measurement(fbm320_dev, FBM320_MEAS_PRESS_OSR_1024);
+}
+
+static esp_err_t fbm320_hub_read(void *driver_ctx, void *sample, uint32_t *wait_us)
+{
+    fbm320_sample_t *fbm320_sample = (fbm320_sample_t *)sample;
+    *wait_us = 10000; // Pressure conversion, if the temperature was read now
+    return fbm320_poll_data(fbm320_dev, &fbm320_sample->temperature, &fbm320_sample->pressure);
+}
+
+static esp_err_t mag3110_hub_read(void *driver_ctx, void *sample, uint32_t *wait_us)
+{
+    return mag3110_get_magnetic_induction(mag3110_dev, (mag3110_result_t *)sample);
+}
+
+static void app_sensor_hub_start(void)
+{
+    const sensor_hub_config_t hub_config = SENSOR_HUB_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(sensor_hub_create(&hub_config, &hub));
+
+    const sensor_hub_stream_config_t hts221_config = {
+        .name = "hts221",
+        .driver = { .read = hts221_hub_read },
+        .sample_size = sizeof(hts221_sample_t),
+        .period_ms = 1000,
+        .ring_len = 2,
+    };
+    ESP_ERROR_CHECK(sensor_hub_add_stream(hub, &hts221_config, &hts221_stream));
+
+    const sensor_hub_stream_config_t bh1750_config = {
+        .name = "bh1750",
+        .driver = { .read = bh1750_hub_read },
+        .sample_size = sizeof(float),
+        .period_ms = 1000,
+        .ring_len = 2,
+    };
+    ESP_ERROR_CHECK(sensor_hub_add_stream(hub, &bh1750_config, &bh1750_stream));
+
+    // In order to get accurate calculation of complimentary angle we need fast reading (5ms)
+    const sensor_hub_stream_config_t mpu6050_config = {
+        .name = "mpu6050",
+        .driver = { .read = mpu6050_hub_read },
+        .sample_size = sizeof(mpu6050_sample_t),
+        .period_ms = 5,
+        .ring_len = 2,
+    };
+    ESP_ERROR_CHECK(sensor_hub_add_stream(hub, &mpu6050_config, &mpu6050_stream));
+
+    const sensor_hub_stream_config_t fbm320_config = {
+        .name = "fbm320",
+        .driver = { .start = fbm320_hub_start, .read = fbm320_hub_read },
+        .sample_size = sizeof(fbm320_sample_t),
+        .period_ms = 1000,
+        .ring_len = 2,
+    };
+    ESP_ERROR_CHECK(sensor_hub_add_stream(hub, &fbm320_config, &fbm320_stream));
+
+    const sensor_hub_stream_config_t mag3110_config = {
+        .name = "mag3110",
+        .driver = { .read = mag3110_hub_read },
+        .sample_size = sizeof(mag3110_result_t),
+        .period_ms = 100,
+        .ring_len = 2,
+    };
+    ESP_ERROR_CHECK(sensor_hub_add_stream(hub, &mag3110_config, &mag3110_stream));
+
+    ESP_ERROR_CHECK(sensor_hub_start(hub));
 }
 
 static void btn_handler(void *button_handle, void *usr_data)
@@ -258,25 +410,13 @@ void app_main(void)
     bsp_display_unlock();
     mag3110_start(mag3110_dev, MAG3110_DR_OS_10_128); // Magnetometer is stopped after calibration; it must be started here
 
+    // Sample all sensors by the sensor hub, I2C is not accessed from other tasks after this
+    app_sensor_hub_start();
+
     // Create FreeRTOS tasks and queues
     q_page_num = xQueueCreate(10, sizeof(uint8_t));
     xTaskCreate(display_show_task, "display_show_task", 2048 * 2, NULL, 5, NULL);
 
-    // In order to get accurate calculation of complimentary angle we need fast reading (5ms)
-    // FreeRTOS resolution is 10ms, so esp_timer is used
-    const esp_timer_create_args_t cal_timer_config = {
-        .callback = mpu6050_read,
-        .arg = NULL,
-        .name = "MPU6050 timer",
-#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0)
-        .skip_unhandled_events = true,
-#endif
-        .dispatch_method = ESP_TIMER_TASK
-    };
-    esp_timer_handle_t cal_timer = NULL;
-    esp_timer_create(&cal_timer_config, &cal_timer);
-    esp_timer_start_periodic(cal_timer, 5000); // 5ms
-
     /* Init buttons */
     button_handle_t btns[BSP_BUTTON_NUM];
     ESP_ERROR_CHECK(bsp_iot_button_create(btns, NULL, BSP_BUTTON_NUM));
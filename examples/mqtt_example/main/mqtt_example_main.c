@@ -6,27 +6,39 @@
 
 #include <stdio.h>
 #include <inttypes.h>
+#include <math.h>
 #include "hts221.h"
 #include "fbm320.h"
 #include "bh1750.h"
+#include "sensor_hub.h"
+#include "sensor_batch.h"
+#include "publish_queue.h"
 #include "bsp/esp-bsp.h"
 #include "esp_log.h"
+#include "esp_check.h"
 
 #include "esp_wifi.h"
 #include "esp_system.h"
 #include "nvs_flash.h"
+#include "wifi.h"
+#include "mqtt_session.h"
 #include "esp_event.h"
 #include "esp_netif.h"
 #include "mqtt_client.h"
 
-void wifi_init_sta(void);
 
 static const char *TAG = "Azure";
 
-static bool mqtt_connected = false;
+#define APP_BATCH_TOPIC         "esp-azure/sensors/batch"
+#define APP_LATEST_TOPIC        "esp-azure/sensors/latest"
+#define APP_CMD_TOPIC           "esp-azure/cmd"
+#define APP_BATCH_BUFFER_SIZE   1024
+
+static publish_queue_handle_t publish_queue = NULL;
 static bh1750_handle_t bh1750_dev = NULL;
 static hts221_handle_t hts221_dev = NULL;
 static fbm320_handle_t fbm320_dev = NULL;
+static sensor_hub_stream_handle_t sensors_stream = NULL;
 
 typedef struct {
     int16_t temperature;
@@ -35,6 +47,31 @@ typedef struct {
     int32_t pressure;
 } sensor_data_t;
 
+/* Sample in the batch message, little-endian:
+ * int16 temperature [0.1 C], uint16 humidity [0.1 %], uint16 luminescence [lx], int32 pressure [Pa] */
+#define APP_BATCH_SAMPLE_SIZE   10
+
+static esp_err_t app_sensors_hub_start(void *driver_ctx, uint32_t *wait_us)
+{
+    *wait_us = 10000; // FBM320 temperature conversion
+    return fbm320_start_measurement(fbm320_dev, FBM320_MEAS_PRESS_OSR_2048);
+}
+
+/* HTS221 and BH1750 measure continuously, they are read during FBM320 conversions */
+static esp_err_t app_sensors_hub_read(void *driver_ctx, void *sample, uint32_t *wait_us)
+{
+    sensor_data_t *data = (sensor_data_t *)sample;
+    int32_t temp;
+    esp_err_t ret = fbm320_poll_data(fbm320_dev, &temp, &data->pressure);
+    if (ESP_ERR_NOT_FINISHED == ret) {
+        *wait_us = 10000; // FBM320 pressure conversion
+        hts221_get_humidity(hts221_dev, &data->humidity);
+        hts221_get_temperature(hts221_dev, &data->temperature);
+        bh1750_get_data(bh1750_dev, &data->luminescence);
+    }
+    return ret;
+}
+
 static void app_sensors_init()
 {
     bh1750_dev = bh1750_create(BSP_I2C_NUM, BH1750_I2C_ADDRESS_DEFAULT);
@@ -52,15 +89,60 @@ static void app_sensors_init()
     fbm320_dev = fbm320_create(BSP_I2C_NUM, FBM320_I2C_ADDRESS_1);
     assert(fbm320_dev != NULL);
     ESP_ERROR_CHECK(fbm320_init(fbm320_dev));
+
+    /* Sensors are sampled by the sensor hub, display and MQTT read the latest sample */
+    sensor_hub_handle_t hub;
+    const sensor_hub_config_t hub_config = SENSOR_HUB_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(sensor_hub_create(&hub_config, &hub));
+    const sensor_hub_stream_config_t stream_config = {
+        .name = "sensors",
+        .driver = {
+            .start = app_sensors_hub_start,
+            .read = app_sensors_hub_read,
+        },
+        .sample_size = sizeof(sensor_data_t),
+        .period_ms = 1000,
+        .ring_len = 4,
+    };
+    ESP_ERROR_CHECK(sensor_hub_add_stream(hub, &stream_config, &sensors_stream));
+    ESP_ERROR_CHECK(sensor_hub_start(hub));
 }
 
-static void app_sensors_get(sensor_data_t *data)
+static void app_sensors_encode(const sensor_data_t *data, uint8_t *sample)
 {
-    int32_t temp;
-    hts221_get_humidity(hts221_dev, &data->humidity);
-    hts221_get_temperature(hts221_dev, &data->temperature);
-    bh1750_get_data(bh1750_dev, &data->luminescence);
-    fbm320_get_data(fbm320_dev, FBM320_MEAS_PRESS_OSR_2048, &temp, &data->pressure);
+    const uint16_t humidity = data->humidity;
+    const uint16_t luminescence = fminf(fmaxf(data->luminescence + 0.5f, 0), UINT16_MAX);
+    const uint32_t pressure = data->pressure;
+
+    sample[0] = data->temperature & 0xFF;
+    sample[1] = (uint16_t)data->temperature >> 8;
+    sample[2] = humidity & 0xFF;
+    sample[3] = humidity >> 8;
+    sample[4] = luminescence & 0xFF;
+    sample[5] = luminescence >> 8;
+    sample[6] = pressure & 0xFF;
+    sample[7] = (pressure >> 8) & 0xFF;
+    sample[8] = (pressure >> 16) & 0xFF;
+    sample[9] = pressure >> 24;
+}
+
+/* Called by the publish queue task, the message is sent by the MQTT client task */
+static int app_mqtt_publish(const char *topic, const uint8_t *data, size_t len, int qos, void *user_ctx)
+{
+    esp_mqtt_client_handle_t client = (esp_mqtt_client_handle_t)user_ctx;
+    return esp_mqtt_client_enqueue(client, topic, (const char *)data, len, qos, 0, true);
+}
+
+static esp_err_t app_batch_publish(const uint8_t *data, size_t len, void *user_ctx)
+{
+    /* Samples stay in the batch while the outbox is full */
+    ESP_RETURN_ON_ERROR(publish_queue_add(publish_queue, APP_BATCH_TOPIC, data, len, 1, 0), TAG, "Outbox full");
+
+    publish_queue_stats_t stats;
+    publish_queue_get_stats(publish_queue, &stats);
+    ESP_LOGI(TAG, "Queued batch of %u bytes (outbox: %"PRIu32" messages, %u bytes, %"PRIu32" B/s, %"PRIu32" dropped)",
+             (unsigned)len, stats.depth, (unsigned)stats.used, stats.throughput_bps, stats.dropped);
+    return ESP_OK;
 }
 
 /**
@@ -79,15 +161,23 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
     esp_mqtt_event_handle_t event = event_data;
 
     switch ((esp_mqtt_event_id_t)event_id) {
+    case MQTT_EVENT_BEFORE_CONNECT:
+        mqtt_session_connecting();
+        break;
+
     case MQTT_EVENT_CONNECTED:
         ESP_LOGI(TAG, "MQTT_EVENT_CONNECTED");
-        mqtt_connected = true;
+        /* Subscriptions of a persistent session are kept by the broker */
+        if (mqtt_session_connected(event)) {
+            esp_mqtt_client_subscribe(event->client, APP_CMD_TOPIC, 1);
+        }
+        publish_queue_set_connected(publish_queue, true);
         bsp_led_set(BSP_LED_AZURE, true);
         break;
 
     case MQTT_EVENT_DISCONNECTED:
         ESP_LOGI(TAG, "MQTT_EVENT_DISCONNECTED");
-        mqtt_connected = false;
+        publish_queue_set_connected(publish_queue, false);
         bsp_led_set(BSP_LED_AZURE, false);
         break;
 
@@ -101,6 +191,7 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
 
     case MQTT_EVENT_PUBLISHED:
         ESP_LOGI(TAG, "MQTT_EVENT_PUBLISHED, msg_id=%d", event->msg_id);
+        publish_queue_delivered(publish_queue, event->msg_id);
         break;
 
     case MQTT_EVENT_DATA:
@@ -142,44 +233,67 @@ void app_main(void)
 
     wifi_init_sta();
 
-    const esp_mqtt_client_config_t mqtt_cfg = {
+    esp_mqtt_client_config_t mqtt_cfg = {
 #if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
         .uri = CONFIG_BROKER_URL,
 #else
         .broker.address.uri = CONFIG_BROKER_URL,
 #endif
     };
+    mqtt_session_config(&mqtt_cfg);
 
     esp_mqtt_client_handle_t client = esp_mqtt_client_init(&mqtt_cfg);
+
+    /* Sensor loop only adds messages to the outbox, network stalls don't reach it */
+    const publish_queue_config_t queue_config = PUBLISH_QUEUE_CONFIG_DEFAULT(app_mqtt_publish, client);
+    ESP_ERROR_CHECK(publish_queue_create(&queue_config, &publish_queue));
     /* The last argument may be used to pass data to the event handler, in this example mqtt_event_handler */
     esp_mqtt_client_register_event(client, ESP_EVENT_ANY_ID, mqtt_event_handler, NULL);
     esp_mqtt_client_start(client);
 
+    /* Readings are published in batches, one message per window */
+    sensor_batch_handle_t batch;
+    const sensor_batch_config_t batch_config = {
+        .sample_size = APP_BATCH_SAMPLE_SIZE,
+        .buffer_size = APP_BATCH_BUFFER_SIZE,
+        .max_samples = CONFIG_EXAMPLE_BATCH_MAX_SAMPLES,
+        .window_ms = CONFIG_EXAMPLE_BATCH_WINDOW_S * 1000,
+        .flush_cb = app_batch_publish,
+        .user_ctx = client,
+    };
+    ESP_ERROR_CHECK(sensor_batch_create(&batch_config, &batch));
+    sensor_hub_reader_t reader;
+    ESP_ERROR_CHECK(sensor_hub_reader_init(sensors_stream, &reader));
+
     /* Write labels on display */
     bsp_display_lock(0);
     lv_label_set_text_static(main_label, "Temp:\nHumi:\nLumi:\nPress:");
     lv_obj_set_style_text_align(main_label, LV_TEXT_ALIGN_LEFT, 0);
     bsp_display_unlock();
 
+    sensor_data_t sensor_data = {0};
     while (1) {
-        sensor_data_t sensor_data;
-        app_sensors_get(&sensor_data);
+        /* Add all new samples to the batch, the last one is shown */
+        int64_t timestamp;
+        uint8_t sample[APP_BATCH_SAMPLE_SIZE];
+        bool fresh = false;
+        while (sensor_hub_read(&reader, &sensor_data, &timestamp, NULL) == ESP_OK) {
+            app_sensors_encode(&sensor_data, sample);
+            sensor_batch_add(batch, timestamp / 1000, sample);
+            fresh = true;
+        }
+        /* Only the latest reading is kept in the outbox */
+        if (fresh) {
+            publish_queue_add(publish_queue, APP_LATEST_TOPIC, sample, sizeof(sample), 0, PUBLISH_QUEUE_FLAG_COALESCE);
+        }
 
-        /* Strings to be sent to MQTT and display */
+        /* Strings to be shown on display */
         char t[10], h[10], l[10], p[10];
         sprintf(t, "%4.2f", ((float)sensor_data.temperature) / 10); // In degree Celsius
         sprintf(h, "%4.2f", ((float)sensor_data.humidity) / 10); // In percent
         sprintf(l, "%4.2f", ((float)sensor_data.luminescence)); // In lux
         sprintf(p, "%4.2f", ((float)sensor_data.pressure) / 1000); // in kPa
 
-        /* Publish sensor data, if connected */
-        if (mqtt_connected) {
-            esp_mqtt_client_publish(client, "esp-azure/temperature", t, 0, 1, 0);
-            esp_mqtt_client_publish(client, "esp-azure/humidity", h, 0, 1, 0);
-            esp_mqtt_client_publish(client, "esp-azure/luminescence", l, 0, 1, 0);
-            esp_mqtt_client_publish(client, "esp-azure/pressure", p, 0, 1, 0);
-        }
-
         bsp_display_lock(0);
         lv_label_set_text_fmt(main_label, "Temp: %s\nHumi: %s\nLumi: %s\nPress: %s", t, h, l, p);
         bsp_display_unlock();
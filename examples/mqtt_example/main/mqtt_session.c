@@ -0,0 +1,110 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_mac.h"
+#include "esp_heap_caps.h"
+#include "esp_attr.h"
+#include "esp_idf_version.h"
+#include "mqtt_session.h"
+#if CONFIG_EXAMPLE_MQTT_TLS_SESSION_TICKETS
+#include "esp_transport_ssl.h"
+#if CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+#include "esp_crt_bundle.h"
+#endif
+#endif
+
+static const char *TAG = "mqtt session";
+
+#define MQTT_SESSION_TLS_PORT   8883
+
+/* Minimum free heap is tracked per connection since IDF v5.3, older versions report only the kept heap */
+#define MQTT_SESSION_HEAP_MONITOR (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0))
+
+/* Kept in RTC memory, connections are counted over deep sleep */
+static RTC_DATA_ATTR uint32_t s_connects;
+
+static char s_client_id[24];
+static int64_t s_time_connecting;
+static size_t s_heap_before;
+static mqtt_session_stats_t s_stats;
+
+void mqtt_session_config(esp_mqtt_client_config_t *cfg)
+{
+#if CONFIG_EXAMPLE_MQTT_PERSISTENT_SESSION
+    /* The broker finds the session by the client ID, it must be the same after every reset */
+    uint8_t mac[6];
+    ESP_ERROR_CHECK(esp_read_mac(mac, ESP_MAC_WIFI_STA));
+    snprintf(s_client_id, sizeof(s_client_id), "esp-azure-%02x%02x%02x", mac[3], mac[4], mac[5]);
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
+    cfg->client_id = s_client_id;
+    cfg->disable_clean_session = true;
+#else
+    cfg->credentials.client_id = s_client_id;
+    cfg->session.disable_clean_session = true;
+#endif
+#endif
+
+#if CONFIG_EXAMPLE_MQTT_TLS_SESSION_TICKETS && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+    /* The default SSL transport of the client does not keep the session, own transport with tickets is used.
+     * The ticket is kept by the transport, so it is resumed on reconnection without deep sleep. */
+    if (strncmp(cfg->broker.address.uri, "mqtts://", 8) == 0) {
+        esp_transport_handle_t ssl = esp_transport_ssl_init();
+        if (ssl == NULL) {
+            ESP_LOGW(TAG, "no memory for SSL transport, TLS session is not resumed");
+            return;
+        }
+        esp_transport_set_default_port(ssl, MQTT_SESSION_TLS_PORT);
+        esp_transport_ssl_session_tickets_enable(ssl);
+#if CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+        esp_transport_ssl_crt_bundle_attach(ssl, esp_crt_bundle_attach);
+#endif
+        /* The transport is destroyed with the client */
+        cfg->network.transport = ssl;
+    }
+#endif
+}
+
+void mqtt_session_connecting(void)
+{
+    s_heap_before = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+#if MQTT_SESSION_HEAP_MONITOR
+    heap_caps_monitor_local_minimum_free_size_start();
+#endif
+    s_time_connecting = esp_timer_get_time();
+}
+
+bool mqtt_session_connected(const esp_mqtt_event_t *event)
+{
+    s_stats.handshake_ms = (esp_timer_get_time() - s_time_connecting) / 1000;
+    const size_t heap_after = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    s_stats.heap_kept = s_heap_before > heap_after ? s_heap_before - heap_after : 0;
+#if MQTT_SESSION_HEAP_MONITOR
+    const size_t heap_min = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+    heap_caps_monitor_local_minimum_free_size_stop();
+    s_stats.heap_peak = s_heap_before > heap_min ? s_heap_before - heap_min : 0;
+#else
+    s_stats.heap_peak = s_stats.heap_kept;
+#endif
+    s_stats.session_present = event->session_present;
+    s_stats.connects = ++s_connects;
+
+    ESP_LOGI(TAG, "connected in %"PRIu32" ms, heap peak %u B, kept %u B, session %s (connection %"PRIu32")",
+             s_stats.handshake_ms, (unsigned)s_stats.heap_peak, (unsigned)s_stats.heap_kept,
+             s_stats.session_present ? "resumed" : "new", s_stats.connects);
+
+    /* No session in the broker (clean session, the first connection or the broker lost it), subscriptions are gone */
+    return !s_stats.session_present;
+}
+
+void mqtt_session_get_stats(mqtt_session_stats_t *stats)
+{
+    *stats = s_stats;
+}
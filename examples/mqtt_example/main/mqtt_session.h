@@ -0,0 +1,54 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "mqtt_client.h"
+
+/**
+ * @brief Cost of the last connection to the broker
+ */
+typedef struct {
+    uint32_t handshake_ms;  /*!< TCP, TLS (if any) and MQTT CONNECT until CONNACK */
+    size_t heap_peak;       /*!< Maximum heap used during the connection [bytes] */
+    size_t heap_kept;       /*!< Heap still used after the connection [bytes] */
+    bool session_present;   /*!< Broker kept the session (subscriptions and QoS 1 messages) */
+    uint32_t connects;      /*!< Count of connections since the power-on */
+} mqtt_session_stats_t;
+
+/**
+ * @brief Fill session related parts of the MQTT client configuration
+ *
+ * With persistent session the client ID is derived from the MAC address and the clean session flag is not set,
+ * so the broker keeps the subscriptions. With TLS session tickets, mqtts:// brokers are connected by an SSL transport
+ * which resumes the last TLS session on reconnection (abbreviated handshake).
+ *
+ * @param[inout] cfg Client configuration with the broker URI set
+ */
+void mqtt_session_config(esp_mqtt_client_config_t *cfg);
+
+/**
+ * @brief Start measurement of the connection, call on MQTT_EVENT_BEFORE_CONNECT
+ */
+void mqtt_session_connecting(void);
+
+/**
+ * @brief Finish measurement of the connection, call on MQTT_EVENT_CONNECTED
+ *
+ * @param[in] event Connected event
+ * @return true if the client must subscribe (no session kept by the broker)
+ */
+bool mqtt_session_connected(const esp_mqtt_event_t *event);
+
+/**
+ * @brief Get cost of the last connection
+ *
+ * @param[out] stats Connection statistics
+ */
+void mqtt_session_get_stats(mqtt_session_stats_t *stats);
@@ -5,6 +5,7 @@
  */
 
 #include <string.h>
+#include <inttypes.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
@@ -12,12 +13,16 @@
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_netif.h"
 #include "nvs_flash.h"
+#include "nvs.h"
 
 #include "lwip/err.h"
 #include "lwip/sys.h"
 
 #include "bsp/esp-bsp.h"
+#include "wifi.h"
 
 /* The examples use WiFi configuration that you can set via project configuration menu
 
@@ -41,13 +46,109 @@ static const char *TAG = "wifi station";
 
 static int s_retry_num = 0;
 
+/* Last AP, connecting to its channel and BSSID skips the scan of all channels */
+#define WIFI_CACHE_NVS_NAMESPACE "wifi_cache"
+#define WIFI_CACHE_NVS_KEY       "ap"
+
+typedef struct {
+    uint8_t channel;
+    uint8_t bssid[6];
+} wifi_ap_cache_t;
+
+static wifi_ap_cache_t s_ap_cache;
+static bool s_fast_connect = false;
+static int64_t s_time_start;
+static int64_t s_time_started;
+static int64_t s_time_connected;
+static wifi_connect_time_t s_connect_time;
+
+static bool wifi_cache_load(wifi_ap_cache_t *cache)
+{
+    nvs_handle_t nvs;
+    size_t len = sizeof(wifi_ap_cache_t);
+    if (nvs_open(WIFI_CACHE_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return false;
+    }
+    const esp_err_t err = nvs_get_blob(nvs, WIFI_CACHE_NVS_KEY, cache, &len);
+    nvs_close(nvs);
+    return (err == ESP_OK && len == sizeof(wifi_ap_cache_t) && cache->channel != 0);
+}
+
+static void wifi_cache_store(const wifi_ap_cache_t *cache)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(WIFI_CACHE_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
+        return;
+    }
+    if (cache) {
+        nvs_set_blob(nvs, WIFI_CACHE_NVS_KEY, cache, sizeof(wifi_ap_cache_t));
+    } else {
+        nvs_erase_key(nvs, WIFI_CACHE_NVS_KEY);
+    }
+    nvs_commit(nvs);
+    nvs_close(nvs);
+}
+
+/* Station configuration, with channel and BSSID of the cached AP, if fast is set */
+static void wifi_set_config(bool fast)
+{
+    wifi_config_t wifi_config = {
+        .sta = {
+            .ssid = EXAMPLE_ESP_WIFI_SSID,
+            .password = EXAMPLE_ESP_WIFI_PASS,
+            /* Setting a password implies station will connect to all security modes including WEP/WPA.
+             * However these modes are deprecated and not advisable to be used. Incase your Access point
+             * doesn't support WPA2, these mode can be enabled by commenting below line */
+            .threshold.authmode = WIFI_AUTH_WPA2_PSK,
+
+            .pmf_cfg = {
+                .capable = true,
+                .required = false
+            },
+        },
+    };
+    if (fast) {
+        wifi_config.sta.channel = s_ap_cache.channel;
+        wifi_config.sta.bssid_set = true;
+        memcpy(wifi_config.sta.bssid, s_ap_cache.bssid, sizeof(wifi_config.sta.bssid));
+    }
+    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config) );
+}
+
+#if CONFIG_EXAMPLE_WIFI_STATIC_IP
+static void wifi_set_static_ip(esp_netif_t *netif)
+{
+    esp_netif_ip_info_t ip_info = {0};
+    esp_netif_dns_info_t dns = {0};
+
+    ESP_ERROR_CHECK(esp_netif_dhcpc_stop(netif));
+    ip_info.ip.addr = esp_ip4addr_aton(CONFIG_EXAMPLE_WIFI_STATIC_IP_ADDR);
+    ip_info.netmask.addr = esp_ip4addr_aton(CONFIG_EXAMPLE_WIFI_STATIC_NETMASK);
+    ip_info.gw.addr = esp_ip4addr_aton(CONFIG_EXAMPLE_WIFI_STATIC_GW);
+    ESP_ERROR_CHECK(esp_netif_set_ip_info(netif, &ip_info));
+    dns.ip.u_addr.ip4.addr = esp_ip4addr_aton(CONFIG_EXAMPLE_WIFI_STATIC_DNS);
+    dns.ip.type = ESP_IPADDR_TYPE_V4;
+    ESP_ERROR_CHECK(esp_netif_set_dns_info(netif, ESP_NETIF_DNS_MAIN, &dns));
+}
+#endif
+
 static void event_handler(void *arg, esp_event_base_t event_base,
                           int32_t event_id, void *event_data)
 {
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
+        s_time_started = esp_timer_get_time();
         esp_wifi_connect();
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
+        s_time_connected = esp_timer_get_time();
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        if (s_retry_num < EXAMPLE_ESP_MAXIMUM_RETRY) {
+        if (s_fast_connect) {
+            /* The cached AP is not available anymore (changed channel, other AP), scan all channels */
+            ESP_LOGI(TAG, "cached AP not found, scanning");
+            s_fast_connect = false;
+            wifi_cache_store(NULL);
+            wifi_set_config(false);
+            esp_wifi_connect();
+        } else if (s_retry_num < EXAMPLE_ESP_MAXIMUM_RETRY) {
             esp_wifi_connect();
             s_retry_num++;
             ESP_LOGI(TAG, "retry to connect to the AP");
@@ -58,19 +159,44 @@ static void event_handler(void *arg, esp_event_base_t event_base,
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ip_event_got_ip_t *event = (ip_event_got_ip_t *) event_data;
         ESP_LOGI(TAG, "got ip:" IPSTR, IP2STR(&event->ip_info.ip));
+        const int64_t now = esp_timer_get_time();
+        s_connect_time.start_ms = (s_time_started - s_time_start) / 1000;
+        s_connect_time.connect_ms = (s_time_connected - s_time_started) / 1000;
+        s_connect_time.ip_ms = (now - s_time_connected) / 1000;
+        s_connect_time.fast = s_fast_connect;
+
+        /* Flash is written only when the AP changed */
+        wifi_ap_record_t ap;
+        if (esp_wifi_sta_get_ap_info(&ap) == ESP_OK &&
+                (ap.primary != s_ap_cache.channel || memcmp(ap.bssid, s_ap_cache.bssid, sizeof(ap.bssid)) != 0)) {
+            s_ap_cache.channel = ap.primary;
+            memcpy(s_ap_cache.bssid, ap.bssid, sizeof(s_ap_cache.bssid));
+            wifi_cache_store(&s_ap_cache);
+        }
         s_retry_num = 0;
         xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
     }
 }
 
+void wifi_get_connect_time(wifi_connect_time_t *time)
+{
+    *time = s_connect_time;
+}
+
 void wifi_init_sta(void)
 {
+    s_time_start = esp_timer_get_time();
     s_wifi_event_group = xEventGroupCreate();
 
     ESP_ERROR_CHECK(esp_netif_init());
 
     ESP_ERROR_CHECK(esp_event_loop_create_default());
-    esp_netif_create_default_wifi_sta();
+    esp_netif_t *netif = esp_netif_create_default_wifi_sta();
+#if CONFIG_EXAMPLE_WIFI_STATIC_IP
+    wifi_set_static_ip(netif);
+#else
+    (void)netif;
+#endif
 
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
@@ -88,23 +214,11 @@ void wifi_init_sta(void)
                     NULL,
                     &instance_got_ip));
 
-    wifi_config_t wifi_config = {
-        .sta = {
-            .ssid = EXAMPLE_ESP_WIFI_SSID,
-            .password = EXAMPLE_ESP_WIFI_PASS,
-            /* Setting a password implies station will connect to all security modes including WEP/WPA.
-             * However these modes are deprecated and not advisable to be used. Incase your Access point
-             * doesn't support WPA2, these mode can be enabled by commenting below line */
-            .threshold.authmode = WIFI_AUTH_WPA2_PSK,
-
-            .pmf_cfg = {
-                .capable = true,
-                .required = false
-            },
-        },
-    };
+    /* Wi-Fi configuration is set on every boot, it does not have to be stored in flash */
+    ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA) );
-    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config) );
+    s_fast_connect = wifi_cache_load(&s_ap_cache);
+    wifi_set_config(s_fast_connect);
     ESP_ERROR_CHECK(esp_wifi_start() );
 
     ESP_LOGI(TAG, "wifi_init_sta finished.");
@@ -122,6 +236,10 @@ void wifi_init_sta(void)
     if (bits & WIFI_CONNECTED_BIT) {
         ESP_LOGI(TAG, "connected to ap SSID:%s password:%s",
                  EXAMPLE_ESP_WIFI_SSID, EXAMPLE_ESP_WIFI_PASS);
+        ESP_LOGI(TAG, "connected in %"PRIu32" ms (start %"PRIu32" ms, %s %"PRIu32" ms, IP %"PRIu32" ms)",
+                 s_connect_time.start_ms + s_connect_time.connect_ms + s_connect_time.ip_ms,
+                 s_connect_time.start_ms, s_connect_time.fast ? "cached AP" : "scan and connect",
+                 s_connect_time.connect_ms, s_connect_time.ip_ms);
         bsp_led_set(BSP_LED_WIFI, true);
     } else if (bits & WIFI_FAIL_BIT) {
         ESP_LOGI(TAG, "Failed to connect to SSID:%s, password:%s",
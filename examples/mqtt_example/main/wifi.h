@@ -0,0 +1,37 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Breakdown of the Wi-Fi connection time
+ */
+typedef struct {
+    uint32_t start_ms;      /*!< Wi-Fi driver init and start */
+    uint32_t connect_ms;    /*!< Scan (if any), authentication and association with the AP */
+    uint32_t ip_ms;         /*!< DHCP or static IP */
+    bool fast;              /*!< Connected to the cached AP channel and BSSID without scan */
+} wifi_connect_time_t;
+
+/**
+ * @brief Connect to the configured AP and wait for IP
+ *
+ * The channel and BSSID of the last AP are cached in NVS. Next time the station connects directly to them
+ * without scanning all channels; if it fails, the cache is dropped and the full scan is used.
+ *
+ * @note NVS must be initialized before.
+ */
+void wifi_init_sta(void);
+
+/**
+ * @brief Get breakdown of the last connection time
+ *
+ * @param[out] time Connection time
+ */
+void wifi_get_connect_time(wifi_connect_time_t *time);
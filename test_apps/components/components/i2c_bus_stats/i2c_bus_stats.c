@@ -0,0 +1,231 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "driver/i2c.h"
+#include "i2c_bus_stats.h"
+
+/* Command links being built or executed, bytes are added into the bus counters only when the link is executed */
+#define I2C_BUS_STATS_LINKS     (8)
+
+typedef struct {
+    i2c_cmd_handle_t cmd;
+    uint32_t bytes;
+} i2c_bus_stats_link_t;
+
+static i2c_bus_stats_t bus_stats;
+static i2c_bus_stats_link_t bus_links[I2C_BUS_STATS_LINKS];
+static portMUX_TYPE bus_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Must be called in critical section, NULL when all slots are used (bytes of the link are not counted) */
+static i2c_bus_stats_link_t *i2c_bus_stats_link(i2c_cmd_handle_t cmd, bool add)
+{
+    i2c_bus_stats_link_t *free_link = NULL;
+    for (int i = 0; i < I2C_BUS_STATS_LINKS; i++) {
+        if (bus_links[i].cmd == cmd) {
+            return &bus_links[i];
+        }
+        if (free_link == NULL && bus_links[i].cmd == NULL) {
+            free_link = &bus_links[i];
+        }
+    }
+    if (add && free_link) {
+        free_link->cmd = cmd;
+        free_link->bytes = 0;
+        return free_link;
+    }
+    return NULL;
+}
+
+static void i2c_bus_stats_link_add_bytes(i2c_cmd_handle_t cmd, size_t len)
+{
+    portENTER_CRITICAL(&bus_stats_lock);
+    i2c_bus_stats_link_t *link = i2c_bus_stats_link(cmd, true);
+    if (link) {
+        link->bytes += len;
+    }
+    portEXIT_CRITICAL(&bus_stats_lock);
+}
+
+static void i2c_bus_stats_link_remove(i2c_cmd_handle_t cmd)
+{
+    portENTER_CRITICAL(&bus_stats_lock);
+    i2c_bus_stats_link_t *link = i2c_bus_stats_link(cmd, false);
+    if (link) {
+        link->cmd = NULL;
+    }
+    portEXIT_CRITICAL(&bus_stats_lock);
+}
+
+esp_err_t __real_i2c_master_cmd_begin(i2c_port_t i2c_num, i2c_cmd_handle_t cmd_handle, TickType_t ticks_to_wait);
+esp_err_t __real_i2c_master_write_byte(i2c_cmd_handle_t cmd_handle, uint8_t data, bool ack_en);
+esp_err_t __real_i2c_master_write(i2c_cmd_handle_t cmd_handle, const uint8_t *data, size_t data_len, bool ack_en);
+esp_err_t __real_i2c_master_read_byte(i2c_cmd_handle_t cmd_handle, uint8_t *data, i2c_ack_type_t ack);
+esp_err_t __real_i2c_master_read(i2c_cmd_handle_t cmd_handle, uint8_t *data, size_t data_len, i2c_ack_type_t ack);
+void __real_i2c_cmd_link_delete(i2c_cmd_handle_t cmd_handle);
+void __real_i2c_cmd_link_delete_static(i2c_cmd_handle_t cmd_handle);
+
+/* The only place, where the bus counters are updated */
+esp_err_t __wrap_i2c_master_cmd_begin(i2c_port_t i2c_num, i2c_cmd_handle_t cmd_handle, TickType_t ticks_to_wait)
+{
+    esp_err_t ret = __real_i2c_master_cmd_begin(i2c_num, cmd_handle, ticks_to_wait);
+    portENTER_CRITICAL(&bus_stats_lock);
+    const i2c_bus_stats_link_t *link = i2c_bus_stats_link(cmd_handle, false);
+    bus_stats.transactions++;
+    bus_stats.bytes += (link ? link->bytes : 0);
+    if (ret != ESP_OK) {
+        bus_stats.errors++;
+    }
+    portEXIT_CRITICAL(&bus_stats_lock);
+    return ret;
+}
+
+esp_err_t __wrap_i2c_master_write_byte(i2c_cmd_handle_t cmd_handle, uint8_t data, bool ack_en)
+{
+    i2c_bus_stats_link_add_bytes(cmd_handle, 1);
+    return __real_i2c_master_write_byte(cmd_handle, data, ack_en);
+}
+
+esp_err_t __wrap_i2c_master_write(i2c_cmd_handle_t cmd_handle, const uint8_t *data, size_t data_len, bool ack_en)
+{
+    i2c_bus_stats_link_add_bytes(cmd_handle, data_len);
+    return __real_i2c_master_write(cmd_handle, data, data_len, ack_en);
+}
+
+esp_err_t __wrap_i2c_master_read_byte(i2c_cmd_handle_t cmd_handle, uint8_t *data, i2c_ack_type_t ack)
+{
+    i2c_bus_stats_link_add_bytes(cmd_handle, 1);
+    return __real_i2c_master_read_byte(cmd_handle, data, ack);
+}
+
+esp_err_t __wrap_i2c_master_read(i2c_cmd_handle_t cmd_handle, uint8_t *data, size_t data_len, i2c_ack_type_t ack)
+{
+    i2c_bus_stats_link_add_bytes(cmd_handle, data_len);
+    return __real_i2c_master_read(cmd_handle, data, data_len, ack);
+}
+
+void __wrap_i2c_cmd_link_delete(i2c_cmd_handle_t cmd_handle)
+{
+    i2c_bus_stats_link_remove(cmd_handle);
+    __real_i2c_cmd_link_delete(cmd_handle);
+}
+
+void __wrap_i2c_cmd_link_delete_static(i2c_cmd_handle_t cmd_handle)
+{
+    i2c_bus_stats_link_remove(cmd_handle);
+    __real_i2c_cmd_link_delete_static(cmd_handle);
+}
+
+/*
+ * The device helpers build their command links inside the I2C driver, where the calls are not wrapped by the linker.
+ * They are built here by the wrapped functions, so they are counted by __wrap_i2c_master_cmd_begin() as one transaction.
+ */
+static esp_err_t i2c_bus_stats_device_transfer(i2c_port_t i2c_num, uint8_t device_address, const uint8_t *write_buffer, size_t write_size,
+                                               uint8_t *read_buffer, size_t read_size, TickType_t ticks_to_wait)
+{
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    if (cmd == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = i2c_master_start(cmd);
+    if (ret == ESP_OK && write_size) {
+        ret = i2c_master_write_byte(cmd, (device_address << 1) | I2C_MASTER_WRITE, true);
+        ret = (ret == ESP_OK) ? i2c_master_write(cmd, write_buffer, write_size, true) : ret;
+        ret = (ret == ESP_OK && read_size) ? i2c_master_start(cmd) : ret;
+    }
+    if (ret == ESP_OK && read_size) {
+        ret = i2c_master_write_byte(cmd, (device_address << 1) | I2C_MASTER_READ, true);
+        ret = (ret == ESP_OK) ? i2c_master_read(cmd, read_buffer, read_size, I2C_MASTER_LAST_NACK) : ret;
+    }
+    ret = (ret == ESP_OK) ? i2c_master_stop(cmd) : ret;
+    ret = (ret == ESP_OK) ? i2c_master_cmd_begin(i2c_num, cmd, ticks_to_wait) : ret;
+
+    i2c_cmd_link_delete(cmd);
+    return ret;
+}
+
+esp_err_t __wrap_i2c_master_write_to_device(i2c_port_t i2c_num, uint8_t device_address, const uint8_t *write_buffer, size_t write_size,
+                                            TickType_t ticks_to_wait)
+{
+    return i2c_bus_stats_device_transfer(i2c_num, device_address, write_buffer, write_size, NULL, 0, ticks_to_wait);
+}
+
+esp_err_t __wrap_i2c_master_read_from_device(i2c_port_t i2c_num, uint8_t device_address, uint8_t *read_buffer, size_t read_size,
+                                             TickType_t ticks_to_wait)
+{
+    return i2c_bus_stats_device_transfer(i2c_num, device_address, NULL, 0, read_buffer, read_size, ticks_to_wait);
+}
+
+esp_err_t __wrap_i2c_master_write_read_device(i2c_port_t i2c_num, uint8_t device_address, const uint8_t *write_buffer, size_t write_size,
+                                              uint8_t *read_buffer, size_t read_size, TickType_t ticks_to_wait)
+{
+    return i2c_bus_stats_device_transfer(i2c_num, device_address, write_buffer, write_size, read_buffer, read_size, ticks_to_wait);
+}
+
+void i2c_bus_stats_get(i2c_bus_stats_t *stats, bool reset)
+{
+    portENTER_CRITICAL(&bus_stats_lock);
+    *stats = bus_stats;
+    if (reset) {
+        memset(&bus_stats, 0, sizeof(bus_stats));
+    }
+    portEXIT_CRITICAL(&bus_stats_lock);
+}
+
+static int i2c_bus_perf_cmp(const void *a, const void *b)
+{
+    const uint32_t x = *(const uint32_t *)a;
+    const uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+esp_err_t i2c_bus_perf_run(const char *sensor, const char *op, i2c_bus_perf_op_t fn, void *ctx, uint32_t iterations, uint32_t readings,
+                           i2c_bus_perf_result_t *result)
+{
+    if (sensor == NULL || op == NULL || fn == NULL || iterations == 0 || readings == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t *latency = malloc(iterations * sizeof(uint32_t));
+    if (latency == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = ESP_OK;
+    i2c_bus_stats_t stats;
+    i2c_bus_stats_get(&stats, true);
+    for (uint32_t i = 0; i < iterations && ret == ESP_OK; i++) {
+        const int64_t start = esp_timer_get_time();
+        ret = fn(ctx);
+        latency[i] = (uint32_t)(esp_timer_get_time() - start);
+    }
+    i2c_bus_stats_get(&stats, true);
+
+    if (ret == ESP_OK) {
+        qsort(latency, iterations, sizeof(uint32_t), i2c_bus_perf_cmp);
+        const uint32_t total = iterations * readings;
+        const i2c_bus_perf_result_t res = {
+            .transactions = (float)stats.transactions / total,
+            .bytes = (float)stats.bytes / total,
+            .p50_us = latency[iterations * 50 / 100],
+            .p90_us = latency[iterations * 90 / 100],
+            .p99_us = latency[iterations * 99 / 100],
+            .max_us = latency[iterations - 1],
+        };
+        printf("BENCH;sensor=%s;op=%s;n=%"PRIu32";trans_per_reading=%.2f;bytes_per_reading=%.1f;p50_us=%"PRIu32";p90_us=%"PRIu32";p99_us=%"PRIu32";max_us=%"PRIu32"\n",
+               sensor, op, iterations, res.transactions, res.bytes, res.p50_us, res.p90_us, res.p99_us, res.max_us);
+        if (result) {
+            *result = res;
+        }
+    }
+    free(latency);
+    return ret;
+}
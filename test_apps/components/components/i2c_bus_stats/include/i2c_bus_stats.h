@@ -0,0 +1,88 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Instrumented I2C bus for sensor driver tests
+ *
+ * Command link functions of the legacy I2C driver are wrapped (linker `--wrap`).
+ * The counters are updated only in `i2c_master_cmd_begin()`: each call is one transaction with the bytes added into
+ * its command link (address, register and data bytes). Device helpers (`i2c_master_write_read_device()` etc.) are
+ * built from the wrapped functions, so each call is one transaction too.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Bus counters
+ */
+typedef struct {
+    uint32_t transactions;  /*!< Number of executed command links */
+    uint32_t bytes;         /*!< Number of bytes on the bus (written and read) */
+    uint32_t errors;        /*!< Number of failed command links */
+} i2c_bus_stats_t;
+
+/**
+ * @brief Measured operation
+ *
+ * @param ctx User context
+ * @return Result of the operation, the measurement stops on error
+ */
+typedef esp_err_t (*i2c_bus_perf_op_t)(void *ctx);
+
+/**
+ * @brief Result of the measurement, normalized per reading
+ */
+typedef struct {
+    float transactions;     /*!< Transactions per reading */
+    float bytes;            /*!< Bytes on the bus per reading */
+    uint32_t p50_us;        /*!< Median latency of the operation [us] */
+    uint32_t p90_us;        /*!< 90th percentile of the latency [us] */
+    uint32_t p99_us;        /*!< 99th percentile of the latency [us] */
+    uint32_t max_us;        /*!< Maximum latency [us] */
+} i2c_bus_perf_result_t;
+
+/**
+ * @brief Get bus counters
+ *
+ * @param[out] stats    Counters
+ * @param reset         Clear the counters after reading
+ */
+void i2c_bus_stats_get(i2c_bus_stats_t *stats, bool reset);
+
+/**
+ * @brief Call the operation repeatedly and measure the bus usage and latency
+ *
+ * One machine-readable line is printed:
+ * `BENCH;sensor=<sensor>;op=<op>;n=<iterations>;trans_per_reading=..;bytes_per_reading=..;p50_us=..;p90_us=..;p99_us=..;max_us=..`
+ *
+ * @param sensor        Name of the sensor
+ * @param op            Name of the operation
+ * @param fn            Operation
+ * @param ctx           User context of the operation
+ * @param iterations    Number of calls
+ * @param readings      Number of readings returned by one call (e.g. samples read from FIFO), used for normalization
+ * @param[out] result   Result (optional)
+ * @return
+ *      - ESP_OK                on success
+ *      - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *      - ESP_ERR_NO_MEM        if there is no memory for latencies
+ *      - Error of the operation
+ */
+esp_err_t i2c_bus_perf_run(const char *sensor, const char *op, i2c_bus_perf_op_t fn, void *ctx, uint32_t iterations, uint32_t readings,
+                           i2c_bus_perf_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
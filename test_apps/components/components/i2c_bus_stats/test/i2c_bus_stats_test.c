@@ -0,0 +1,61 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include "unity.h"
+#include "driver/i2c.h"
+#include "i2c_bus_stats.h"
+
+#define I2C_MASTER_SCL_IO 26      /*!< gpio number for I2C master clock */
+#define I2C_MASTER_SDA_IO 25      /*!< gpio number for I2C master data  */
+#define I2C_MASTER_NUM I2C_NUM_0  /*!< I2C port number for master dev */
+#define I2C_MASTER_FREQ_HZ 100000 /*!< I2C master clock frequency */
+#define I2C_TEST_ADDRESS 0x77     /*!< Any address, the transaction is counted also when it is not acknowledged */
+
+TEST_CASE("I2C bus stats count device helper as one transaction", "[i2c_bus_stats]")
+{
+    i2c_config_t conf = {
+        .mode = I2C_MODE_MASTER,
+        .sda_io_num = I2C_MASTER_SDA_IO,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .scl_io_num = I2C_MASTER_SCL_IO,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = I2C_MASTER_FREQ_HZ,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_param_config(I2C_MASTER_NUM, &conf));
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_driver_install(I2C_MASTER_NUM, conf.mode, 0, 0, 0));
+
+    const uint8_t reg = 0x0F;
+    uint8_t data[6];
+    i2c_bus_stats_t stats;
+
+    /* Address and register written, address and data read */
+    i2c_bus_stats_get(&stats, true);
+    i2c_master_write_read_device(I2C_MASTER_NUM, I2C_TEST_ADDRESS, &reg, sizeof(reg), data, sizeof(data), pdMS_TO_TICKS(100));
+    i2c_bus_stats_get(&stats, true);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.transactions);
+    TEST_ASSERT_EQUAL_UINT32(1 + sizeof(reg) + 1 + sizeof(data), stats.bytes);
+
+    i2c_master_write_to_device(I2C_MASTER_NUM, I2C_TEST_ADDRESS, &reg, sizeof(reg), pdMS_TO_TICKS(100));
+    i2c_bus_stats_get(&stats, true);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.transactions);
+    TEST_ASSERT_EQUAL_UINT32(1 + sizeof(reg), stats.bytes);
+
+    /* Bytes of a deleted command link are not counted again */
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    TEST_ASSERT_NOT_NULL(cmd);
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (I2C_TEST_ADDRESS << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_stop(cmd);
+    i2c_master_cmd_begin(I2C_MASTER_NUM, cmd, pdMS_TO_TICKS(100));
+    i2c_cmd_link_delete(cmd);
+    i2c_master_read_from_device(I2C_MASTER_NUM, I2C_TEST_ADDRESS, data, sizeof(data), pdMS_TO_TICKS(100));
+    i2c_bus_stats_get(&stats, true);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.transactions);
+    TEST_ASSERT_EQUAL_UINT32(1 + 1 + sizeof(data), stats.bytes);
+
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_driver_delete(I2C_MASTER_NUM));
+}
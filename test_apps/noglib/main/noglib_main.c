@@ -5,7 +5,12 @@
  */
 
 #include <stdbool.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
 #include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_heap_caps.h"
 #include "esp_lcd_panel_ops.h"
 #include "esp_lcd_panel_io.h"
@@ -18,34 +23,90 @@
 // More means more memory use, but less overhead for setting up / finishing transfers
 #define PARALLEL_LINES (240 / 5)
 #define FRAME_BUF_SIZE (320 * PARALLEL_LINES * BSP_LCD_BITS_PER_PIXEL / 8)
-#define FRAME_BUF_NUM  (2)
+#define FRAME_BUF_NUM  (3)
 
 // The number of frames to show before rotate the graph
 #define ROTATE_FRAME   30
 
-// Simple routine to generate some patterns and send them to the LCD. Because the
-// SPI driver handles transactions in the background, we can calculate the next line
-// while the previous one is being sent.
-static uint16_t *s_lines[FRAME_BUF_NUM];
-static void display_pretty_colors(esp_lcd_panel_handle_t panel_handle)
+// The number of frames calculated by each variant of the effect in the benchmark
+#define BENCHMARK_FRAMES 20
+
+static const char *TAG = "noglib";
+
+static pretty_effect_variant_t effect_variant = PRETTY_EFFECT_SCALAR;
+
+// Calculate whole frames by each variant of the effect into RAM, without the display.
+// All variants must produce the same pixels as the reference one; the fastest one is returned.
+static pretty_effect_variant_t benchmark_pretty_effect(void)
+{
+    pretty_effect_variant_t fastest = PRETTY_EFFECT_SCALAR;
+    int64_t fastest_us = INT64_MAX;
+    uint32_t bus_fps = 0;
+    bsp_display_bus_info_t bus_info;
+    if (bsp_display_get_bus_info(&bus_info) == ESP_OK) {
+        bus_fps = bus_info.throughput / (320 * 240 * BSP_LCD_BITS_PER_PIXEL / 8);
+    }
+
+    uint16_t *reference = heap_caps_malloc(FRAME_BUF_SIZE, MALLOC_CAP_INTERNAL);
+    uint16_t *lines = heap_caps_malloc(FRAME_BUF_SIZE, MALLOC_CAP_INTERNAL);
+    if (reference == NULL || lines == NULL) {
+        ESP_LOGW(TAG, "Not enough memory for benchmark");
+        goto exit;
+    }
+
+    for (pretty_effect_variant_t variant = 0; variant < PRETTY_EFFECT_VARIANT_MAX; variant++) {
+        bool match = true;
+        const int64_t start_us = esp_timer_get_time();
+        for (int frame = 1; frame <= BENCHMARK_FRAMES; frame++) {
+            for (int y = 0; y < 240; y += PARALLEL_LINES) {
+                pretty_effect_calc_lines_variant(variant, lines, y, frame, PARALLEL_LINES);
+            }
+        }
+        const int64_t time_us = esp_timer_get_time() - start_us;
+
+        // Check only the last block of each frame outside of the timed loop
+        for (int frame = 1; frame <= BENCHMARK_FRAMES && match; frame++) {
+            pretty_effect_calc_lines_variant(variant, lines, 240 - PARALLEL_LINES, frame, PARALLEL_LINES);
+            pretty_effect_calc_lines_variant(PRETTY_EFFECT_SCALAR, reference, 240 - PARALLEL_LINES, frame, PARALLEL_LINES);
+            match = memcmp(lines, reference, FRAME_BUF_SIZE) == 0;
+        }
+
+        const uint32_t fps = (uint32_t)(BENCHMARK_FRAMES * 1000000LL / time_us);
+        ESP_LOGI(TAG, "Effect %-9s: %5.2f Mpixel/s, %3" PRIu32 " FPS (bus limit %" PRIu32 " FPS)%s",
+                 pretty_effect_variant_name(variant), (float)BENCHMARK_FRAMES * 320 * 240 / time_us,
+                 fps, bus_fps, match ? "" : ", OUTPUT MISMATCH");
+        if (match && time_us < fastest_us) {
+            fastest_us = time_us;
+            fastest = variant;
+        }
+    }
+
+exit:
+    free(reference);
+    free(lines);
+    return fastest;
+}
+
+// Simple routine to generate some patterns and send them to the LCD. The stream returns a buffer
+// only after its transfer is done, so we can calculate the next lines while the previous ones are being sent.
+static void display_pretty_colors(bsp_display_stream_handle_t stream)
 {
     int frame = 0;
-    // Indexes of the line currently being sent to the LCD and the line we're calculating
-    int sending_line = 0;
-    int calc_line = 0;
 
     // After ROTATE_FRAME frames, the image will be rotated
     while (frame <= ROTATE_FRAME) {
         frame++;
         for (int y = 0; y < 240; y += PARALLEL_LINES) {
+            uint16_t *lines;
+            ESP_ERROR_CHECK(bsp_display_stream_acquire(stream, (void **)&lines, 0));
             // Calculate a line
-            pretty_effect_calc_lines(s_lines[calc_line], y, frame, PARALLEL_LINES);
-            sending_line = calc_line;
-            calc_line = !calc_line;
+            pretty_effect_calc_lines_variant(effect_variant, lines, y, frame, PARALLEL_LINES);
             // Send the calculated data
-            esp_lcd_panel_draw_bitmap(panel_handle, 0, y, 0 + 320, y + PARALLEL_LINES, s_lines[sending_line]);
+            ESP_ERROR_CHECK(bsp_display_stream_submit(stream, 0, y, 0 + 320, y + PARALLEL_LINES, lines));
         }
     }
+    // Mirroring must not change while the frame is being sent
+    ESP_ERROR_CHECK(bsp_display_stream_wait(stream, 0));
 }
 
 void app_main(void)
@@ -54,6 +115,7 @@ void app_main(void)
 
     // Non-graphical API can be used without any restrictions in noglib version
     ESP_ERROR_CHECK(bsp_leds_init());
+    ESP_ERROR_CHECK(pretty_effect_init());
 
     // Only API from bsp/display.h can be used in noglib version
     ESP_ERROR_CHECK(bsp_display_brightness_init());
@@ -71,24 +133,34 @@ void app_main(void)
     ESP_ERROR_CHECK(esp_lcd_panel_swap_xy(lcd_panel, true));
     ESP_ERROR_CHECK(bsp_display_backlight_on());
 
-    // Allocate memory for the pixel buffers
-    for (int i = 0; i < FRAME_BUF_NUM; i++) {
-        s_lines[i] = heap_caps_malloc(FRAME_BUF_SIZE, MALLOC_CAP_DMA);
-        assert(s_lines[i] != NULL);
-    }
+    // Queue of DMA buffers for the pixels
+    bsp_display_stream_handle_t stream;
+    const bsp_display_stream_config_t stream_config = {
+        .panel = lcd_panel,
+        .io = lcd_panel_io,
+        .buffer_size = FRAME_BUF_SIZE,
+        .buffer_num = FRAME_BUF_NUM,
+    };
+    ESP_ERROR_CHECK(bsp_display_stream_new(&stream_config, &stream));
+
+    effect_variant = benchmark_pretty_effect();
+    ESP_LOGI(TAG, "Using %s effect", pretty_effect_variant_name(effect_variant));
 
     // Start and rotate
     while (1) {
         // Set driver configuration to rotate 180 degrees each time
         ESP_ERROR_CHECK(esp_lcd_panel_mirror(lcd_panel, is_rotated, is_rotated));
         // Display
-        display_pretty_colors(lcd_panel);
+        const int64_t start_us = esp_timer_get_time();
+        display_pretty_colors(stream);
+        ESP_LOGI(TAG, "%" PRId64 " FPS on display", (ROTATE_FRAME + 1) * 1000000LL / (esp_timer_get_time() - start_us));
         is_rotated = !is_rotated;
 
         ESP_ERROR_CHECK(bsp_led_set(BSP_LED_BLUE, is_rotated));
     }
 
     // Clean-up with esp_lcd API
+    bsp_display_stream_del(stream);
     esp_lcd_panel_del(lcd_panel);
     esp_lcd_panel_io_del(lcd_panel_io);
     spi_bus_free(BSP_LCD_SPI_NUM);
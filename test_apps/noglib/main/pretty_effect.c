@@ -5,6 +5,9 @@
  */
 
 #include <math.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "pretty_effect.h"
 #include "image.c"
 
@@ -25,31 +28,132 @@ static int prev_frame = -1;
 static int8_t xofs[320], yofs[240];
 static int8_t xcomp[320], ycomp[240];
 
+//Offsets of the frame are folded into one index per column and one per row, so a pixel is a single table lookup:
+//image[(y + xofs[x] + ycomp[y]) * 320 + x + yofs[y] + xcomp[x]] == image[row_base[y] + col_ofs[x]]
+static int32_t col_ofs[320], row_base[240];
+
+static void pretty_effect_prepare_frame(int frame)
+{
+    if (frame == prev_frame) {
+        return;
+    }
+    //We need to calculate a new set of offset coefficients. Take some random sines as offsets to make everything
+    //look pretty and fluid-y.
+    for (int x = 0; x < 320; x++) {
+        xofs[x] = sin(frame * 0.15 + x * 0.06) * 4;
+    }
+    for (int y = 0; y < 240; y++) {
+        yofs[y] = sin(frame * 0.1 + y * 0.05) * 4;
+    }
+    for (int x = 0; x < 320; x++) {
+        xcomp[x] = sin(frame * 0.11 + x * 0.12) * 4;
+    }
+    for (int y = 0; y < 240; y++) {
+        ycomp[y] = sin(frame * 0.07 + y * 0.15) * 4;
+    }
+    for (int x = 0; x < 320; x++) {
+        col_ofs[x] = x + xcomp[x] + xofs[x] * 320;
+    }
+    for (int y = 0; y < 240; y++) {
+        row_base[y] = (y + ycomp[y]) * 320 + yofs[y];
+    }
+    prev_frame = frame;
+}
+
 //Calculate the pixel data for a set of lines (with implied line size of 320). Pixels go in dest, line is the Y-coordinate of the
 //first line to be calculated, linect is the amount of lines to calculate. Frame increases by one every time the entire image
 //is displayed; this is used to go to the next frame of animation.
 void pretty_effect_calc_lines(uint16_t *dest, int line, int frame, int linect)
 {
-    if (frame != prev_frame) {
-        //We need to calculate a new set of offset coefficients. Take some random sines as offsets to make everything
-        //look pretty and fluid-y.
-        for (int x = 0; x < 320; x++) {
-            xofs[x] = sin(frame * 0.15 + x * 0.06) * 4;
-        }
-        for (int y = 0; y < 240; y++) {
-            yofs[y] = sin(frame * 0.1 + y * 0.05) * 4;
-        }
+    pretty_effect_prepare_frame(frame);
+    for (int y = line; y < line + linect; y++) {
         for (int x = 0; x < 320; x++) {
-            xcomp[x] = sin(frame * 0.11 + x * 0.12) * 4;
-        }
-        for (int y = 0; y < 240; y++) {
-            ycomp[y] = sin(frame * 0.07 + y * 0.15) * 4;
+            *dest++ = get_bgnd_pixel(x + yofs[y] + xcomp[x], y + xofs[x] + ycomp[y]);
         }
-        prev_frame = frame;
     }
+}
+
+//Two pixels per 32-bit store, no per-pixel index arithmetic except one add
+static void pretty_effect_calc_lines_fast(uint16_t *dest, int line, int linect)
+{
+    uint32_t *dest32 = (uint32_t *)dest;
     for (int y = line; y < line + linect; y++) {
-        for (int x = 0; x < 320; x++) {
-            *dest++ = get_bgnd_pixel(x + yofs[y] + xcomp[x], y + xofs[x] + ycomp[y]);
+        const uint16_t *row = &image[row_base[y]];
+        for (int x = 0; x < 320; x += 2) {
+            *dest32++ = row[col_ofs[x]] | ((uint32_t)row[col_ofs[x + 1]] << 16);
         }
     }
 }
+
+#if !CONFIG_FREERTOS_UNICORE
+//Worker on the other core calculates the second half of the lines
+static struct {
+    TaskHandle_t worker;
+    TaskHandle_t caller;
+    uint16_t *dest;
+    int line;
+    int linect;
+} split;
+
+static void pretty_effect_worker_task(void *arg)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        pretty_effect_calc_lines_fast(split.dest, split.line, split.linect);
+        xTaskNotifyGive(split.caller);
+    }
+}
+#endif
+
+esp_err_t pretty_effect_init(void)
+{
+#if !CONFIG_FREERTOS_UNICORE
+    if (split.worker == NULL &&
+            xTaskCreatePinnedToCore(pretty_effect_worker_task, "effect", 2048, NULL, uxTaskPriorityGet(NULL), &split.worker, 1) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+#endif
+    return ESP_OK;
+}
+
+void pretty_effect_calc_lines_variant(pretty_effect_variant_t variant, uint16_t *dest, int line, int frame, int linect)
+{
+    switch (variant) {
+    case PRETTY_EFFECT_SCALAR:
+        pretty_effect_calc_lines(dest, line, frame, linect);
+        break;
+    case PRETTY_EFFECT_FAST:
+        pretty_effect_prepare_frame(frame);
+        pretty_effect_calc_lines_fast(dest, line, linect);
+        break;
+    case PRETTY_EFFECT_DUAL_CORE:
+        pretty_effect_prepare_frame(frame);
+#if !CONFIG_FREERTOS_UNICORE
+        if (split.worker && linect > 1) {
+            const int half = linect / 2;
+            split.caller = xTaskGetCurrentTaskHandle();
+            split.dest = dest + half * 320;
+            split.line = line + half;
+            split.linect = linect - half;
+            xTaskNotifyGive(split.worker);
+            pretty_effect_calc_lines_fast(dest, line, half);
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            break;
+        }
+#endif
+        pretty_effect_calc_lines_fast(dest, line, linect);
+        break;
+    default:
+        break;
+    }
+}
+
+const char *pretty_effect_variant_name(pretty_effect_variant_t variant)
+{
+    static const char *const names[PRETTY_EFFECT_VARIANT_MAX] = {
+        [PRETTY_EFFECT_SCALAR] = "scalar",
+        [PRETTY_EFFECT_FAST] = "fast",
+        [PRETTY_EFFECT_DUAL_CORE] = "dual-core",
+    };
+    return (variant < PRETTY_EFFECT_VARIANT_MAX) ? names[variant] : "unknown";
+}
@@ -8,6 +8,23 @@
 #include <stdint.h>
 #include "esp_err.h"
 
+/**
+ * @brief Implementation of the effect
+ */
+typedef enum {
+    PRETTY_EFFECT_SCALAR,       /*!< Reference: gather with per-pixel index calculation */
+    PRETTY_EFFECT_FAST,         /*!< Per-frame folded index tables, 2 pixels per 32-bit store */
+    PRETTY_EFFECT_DUAL_CORE,    /*!< Fast variant, lines split between both cores */
+    PRETTY_EFFECT_VARIANT_MAX,
+} pretty_effect_variant_t;
+
+/**
+ * @brief Initialize the effect (worker task on the second core)
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the task can't be created
+ */
+esp_err_t pretty_effect_init(void);
+
 /**
  * @brief Calculate the effect for a bunch of lines.
  *
@@ -17,3 +34,24 @@
  * @param linect Amount of lines to calculate
  */
 void pretty_effect_calc_lines(uint16_t *dest, int line, int frame, int linect);
+
+/**
+ * @brief Calculate the effect for a bunch of lines with selected implementation
+ *
+ * All variants produce the same pixels.
+ *
+ * @param variant Implementation
+ * @param dest Destination for the pixels. Assumed to be LINECT * 320 16-bit pixel values, aligned to 4 bytes.
+ * @param line Starting line of the chunk of lines.
+ * @param frame Current frame, used for animation
+ * @param linect Amount of lines to calculate
+ */
+void pretty_effect_calc_lines_variant(pretty_effect_variant_t variant, uint16_t *dest, int line, int frame, int linect);
+
+/**
+ * @brief Get name of the implementation
+ *
+ * @param variant Implementation
+ * @return Name
+ */
+const char *pretty_effect_variant_name(pretty_effect_variant_t variant);